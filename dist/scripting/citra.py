@@ -3,23 +3,144 @@ import random
 import enum
 import socket
 
-CURRENT_REQUEST_VERSION = 1
-MAX_REQUEST_DATA_SIZE = 32
-MAX_PACKET_SIZE = 48
+CURRENT_REQUEST_VERSION = 2
+MAX_REQUEST_DATA_SIZE = 1024
+MAX_PACKET_SIZE = 1040
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadFramePercentiles = 3,
+    CaptureTrace = 4,
+    ReadFrameCounters = 5,
+    Batch = 6,
+    Subscribe = 7,
+    Unsubscribe = 8,
+    SubscriptionData = 9,
+    ReadSVCCounts = 10
+
+class FrameMetric(enum.IntEnum):
+    Frametime = 0,
+    CpuTime = 1,
+    GpuSubmitTime = 2,
+    PresentTime = 3,
+    InputLatency = 4
+
+# Names of the values returned by read_frame_counters, in order
+FRAME_COUNTERS = ("draws", "surface_cache_misses", "texture_uploads", "shader_compiles", "svcs",
+                  "ipc_requests")
 
 CITRA_PORT = 45987
 
-class Citra:
-    def __init__(self, address="127.0.0.1", port=CITRA_PORT):
+# Layout of the "citra-rpc" shared memory region, see core/rpc/shared_memory_server.cpp
+SHARED_MEMORY_NAME = "citra-rpc"
+SHARED_MEMORY_MAGIC = 0x43505243
+SHARED_REQUEST_SEQUENCE = 8
+SHARED_REPLY_SEQUENCE = 12
+SHARED_PUSH_COUNT = 16
+SHARED_REQUEST = 24
+SHARED_REPLY = SHARED_REQUEST + MAX_PACKET_SIZE
+SHARED_PUSHES = SHARED_REPLY + MAX_PACKET_SIZE
+SHARED_PUSH_SLOT_SIZE = 4 + MAX_PACKET_SIZE
+SHARED_PUSH_SLOTS = 64
+
+class _UDPTransport:
+    def __init__(self, address, port):
         self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
         self.address = address
+        self.port = port
+
+    def send(self, request):
+        self.socket.sendto(request, (self.address, self.port))
+
+    def receive(self):
+        return self.socket.recv(MAX_PACKET_SIZE)
+
+    def receive_pushes(self):
+        pushes = []
+        self.socket.setblocking(False)
+        try:
+            while True:
+                pushes.append(self.socket.recv(MAX_PACKET_SIZE))
+        except BlockingIOError:
+            pass
+        finally:
+            self.socket.setblocking(True)
+        return pushes
+
+class _SharedMemoryTransport:
+    def __init__(self):
+        from multiprocessing import shared_memory
+        self.memory = shared_memory.SharedMemory(name=SHARED_MEMORY_NAME)
+        try:
+            # The emulator owns the region, so it must not be unlinked when this process exits
+            from multiprocessing import resource_tracker
+            resource_tracker.unregister(self.memory._name, "shared_memory")
+        except Exception:
+            pass
+        self.buffer = self.memory.buf
+        if self._load(0) != SHARED_MEMORY_MAGIC:
+            raise ConnectionError("The shared memory region is not a Citra RPC server")
+        self.sequence = self._load(SHARED_REQUEST_SEQUENCE)
+        self.pushes_read = self._load(SHARED_PUSH_COUNT)
+
+    def _load(self, offset):
+        return struct.unpack_from("I", self.buffer, offset)[0]
+
+    def send(self, request):
+        self.buffer[SHARED_REQUEST:SHARED_REQUEST + len(request)] = request
+        self.sequence = (self.sequence + 1) & 0xFFFFFFFF
+        struct.pack_into("I", self.buffer, SHARED_REQUEST_SEQUENCE, self.sequence)
+
+    def receive(self):
+        while self._load(SHARED_REPLY_SEQUENCE) != self.sequence:
+            pass
+        data_size = self._load(SHARED_REPLY + 12)
+        return bytes(self.buffer[SHARED_REPLY:SHARED_REPLY + 16 + data_size])
+
+    def receive_pushes(self):
+        pushes = []
+        push_count = self._load(SHARED_PUSH_COUNT)
+        # Pushes older than the ring were overwritten
+        for push in range(max(self.pushes_read, push_count - SHARED_PUSH_SLOTS), push_count):
+            slot = SHARED_PUSHES + (push % SHARED_PUSH_SLOTS) * SHARED_PUSH_SLOT_SIZE
+            data_size = self._load(slot + 4 + 12)
+            packet = bytes(self.buffer[slot + 4:slot + 4 + 16 + min(data_size, MAX_REQUEST_DATA_SIZE)])
+            if self._load(slot) == push + 1:
+                pushes.append(packet)
+        self.pushes_read = push_count
+        return pushes
+
+class Citra:
+    def __init__(self, address="127.0.0.1", port=CITRA_PORT, shared_memory=False):
+        """
+        Connects through the "citra-rpc" shared memory region instead of UDP if shared_memory is
+        True, which only works for an emulator running on the same machine.
+        """
+        if shared_memory:
+            self.transport = _SharedMemoryTransport()
+        else:
+            self.transport = _UDPTransport(address, port)
+        # Latest data pushed for each subscription id
+        self.subscription_data = {}
 
     def is_connected(self):
-        return self.socket is not None
+        return self.transport is not None
+
+    def _request(self, request_type, request_data):
+        request, request_id = self._generate_header(request_type, len(request_data))
+        self.transport.send(request + request_data)
+        while True:
+            raw_reply = self.transport.receive()
+            if not self._store_push(raw_reply):
+                return self._read_and_validate_header(raw_reply, request_id, request_type)
+
+    def _store_push(self, raw_packet):
+        reply_version, reply_id, reply_type, reply_data_size = struct.unpack("IIII", raw_packet[:4*4])
+        if reply_type != RequestType.SubscriptionData:
+            return False
+        self.subscription_data[reply_id] = raw_packet[4*4:4*4 + reply_data_size]
+        return True
 
     def _generate_header(self, request_type, data_size):
         request_id = random.getrandbits(32)
@@ -43,12 +164,7 @@ class Citra:
         while read_size > 0:
             temp_read_size = min(read_size, MAX_REQUEST_DATA_SIZE)
             request_data = struct.pack("II", read_address, temp_read_size)
-            request, request_id = self._generate_header(RequestType.ReadMemory, len(request_data))
-            request += request_data
-            self.socket.sendto(request, (self.address, CITRA_PORT))
-
-            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
-            reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.ReadMemory)
+            reply_data = self._request(RequestType.ReadMemory, request_data)
 
             if reply_data:
                 result += reply_data
@@ -75,12 +191,7 @@ class Citra:
             temp_write_size = min(write_size, MAX_REQUEST_DATA_SIZE - 8)
             request_data = struct.pack("II", write_address, temp_write_size)
             request_data += write_contents[:temp_write_size]
-            request, request_id = self._generate_header(RequestType.WriteMemory, len(request_data))
-            request += request_data
-            self.socket.sendto(request, (self.address, CITRA_PORT))
-
-            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
-            reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.WriteMemory)
+            reply_data = self._request(RequestType.WriteMemory, request_data)
 
             if None != reply_data:
                 write_address += temp_write_size
@@ -90,6 +201,134 @@ class Citra:
                 return False
         return True
 
+    def batch(self, operations):
+        """
+        Runs many reads and writes in as few requests as possible. Each operation is either an
+        (address, size) tuple to read or an (address, bytes) tuple to write, and they are applied
+        in order. Returns the data of the reads, in order.
+        >>> c.batch([(0x100000, b"\\xff\\xff"), (0x100000, 4), (0x100000, b"\\x07\\x00")])
+        [b'\\xff\\xff\\x00\\xeb']
+        """
+        results = []
+        request_data = bytes()
+        read_sizes = []
+        for address, operation in operations:
+            if isinstance(operation, int):
+                encoded = struct.pack("III", RequestType.ReadMemory, address, operation)
+                read_size = operation
+            else:
+                encoded = struct.pack("III", RequestType.WriteMemory, address, len(operation))
+                encoded += operation
+                read_size = 0
+            if len(encoded) > MAX_REQUEST_DATA_SIZE or read_size > MAX_REQUEST_DATA_SIZE:
+                raise ValueError("Batched operations are limited to {} bytes".format(
+                    MAX_REQUEST_DATA_SIZE))
+            # Send what does not fit in this request as another one
+            if (len(request_data) + len(encoded) > MAX_REQUEST_DATA_SIZE or
+                sum(read_sizes) + read_size > MAX_REQUEST_DATA_SIZE):
+                if not self._send_batch(request_data, read_sizes, results):
+                    return None
+                request_data = bytes()
+                read_sizes = []
+            request_data += encoded
+            if read_size > 0:
+                read_sizes.append(read_size)
+        if request_data and not self._send_batch(request_data, read_sizes, results):
+            return None
+        return results
+
+    def _send_batch(self, request_data, read_sizes, results):
+        reply_data = self._request(RequestType.Batch, request_data)
+        if reply_data is None or len(reply_data) != sum(read_sizes):
+            return False
+        for read_size in read_sizes:
+            results.append(reply_data[:read_size])
+            reply_data = reply_data[read_size:]
+        return True
+
+    def subscribe(self, address, size):
+        """
+        Asks the emulator to push a memory range at the end of every frame. Returns the id of the
+        subscription, under which poll_subscriptions returns the pushed data.
+        >>> subscription = c.subscribe(0x100000, 4)
+        >>> subscription is not None
+        True
+        >>> c.unsubscribe(subscription)
+        True
+        """
+        reply_data = self._request(RequestType.Subscribe, struct.pack("II", address, size))
+        if not reply_data:
+            return None
+        return struct.unpack("I", reply_data)[0]
+
+    def unsubscribe(self, subscription):
+        reply_data = self._request(RequestType.Unsubscribe, struct.pack("II", subscription, 0))
+        if not reply_data:
+            return False
+        self.subscription_data.pop(subscription, None)
+        return struct.unpack("I", reply_data)[0] == 1
+
+    def poll_subscriptions(self):
+        """
+        Returns the latest data pushed for each subscription, as a dict keyed by subscription id.
+        """
+        for raw_packet in self.transport.receive_pushes():
+            self._store_push(raw_packet)
+        return dict(self.subscription_data)
+
+    def read_frame_percentiles(self, metric=FrameMetric.Frametime):
+        """
+        Returns the p50, p95 and p99 of a frame time metric in microseconds, over the frames since
+        the emulator last updated its performance stats.
+        >>> len(c.read_frame_percentiles(FrameMetric.Frametime))
+        3
+        """
+        request_data = struct.pack("II", metric, 0)
+        reply_data = self._request(RequestType.ReadFramePercentiles, request_data)
+        if not reply_data:
+            return None
+        return struct.unpack("III", reply_data)
+
+    def capture_trace(self, num_frames=300):
+        """
+        Captures the profiler scopes of the next frames into a Chrome trace JSON file, written to
+        the log directory of the emulator. Returns True if the capture started.
+        >>> c.capture_trace(1)
+        True
+        """
+        request_data = struct.pack("II", num_frames, 0)
+        reply_data = self._request(RequestType.CaptureTrace, request_data)
+        if not reply_data:
+            return None
+        return struct.unpack("I", reply_data)[0] == 1
+
+    def read_frame_counters(self):
+        """
+        Returns the hot-path events counted during the previous frame, as a dict keyed by the
+        names in FRAME_COUNTERS.
+        >>> sorted(c.read_frame_counters()) == sorted(FRAME_COUNTERS)
+        True
+        """
+        request_data = struct.pack("II", 0, 0)
+        reply_data = self._request(RequestType.ReadFrameCounters, request_data)
+        if not reply_data:
+            return None
+        return dict(zip(FRAME_COUNTERS, struct.unpack("I" * len(FRAME_COUNTERS), reply_data)))
+
+    def read_svc_counts(self):
+        """
+        Returns how many times the guest has called each SVC since the emulator started, as a
+        dict keyed by SVC number that leaves out the SVCs never called.
+        >>> all(count > 0 for count in c.read_svc_counts().values())
+        True
+        """
+        request_data = struct.pack("II", 0, 0)
+        reply_data = self._request(RequestType.ReadSVCCounts, request_data)
+        if not reply_data:
+            return None
+        counts = struct.unpack("Q" * (len(reply_data) // 8), reply_data)
+        return {svc: count for svc, count in enumerate(counts) if count != 0}
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
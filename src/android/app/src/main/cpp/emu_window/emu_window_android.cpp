@@ -0,0 +1,376 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <dlfcn.h>
+#include <android/looper.h>
+#include <android/native_window.h>
+#include <glad/glad.h>
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/settings.h"
+#include "emu_window/emu_window_android.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace {
+
+// Choreographer is only in the NDK from API 24, above the minimum API, so it is loaded at runtime
+struct AChoreographer;
+using FrameCallback = void (*)(long frame_time_ns, void* data);
+using GetChoreographerInstance = AChoreographer* (*)();
+using PostFrameCallback = void (*)(AChoreographer* choreographer, FrameCallback callback,
+                                   void* data);
+
+struct ChoreographerFunctions {
+    GetChoreographerInstance get_instance = nullptr;
+    PostFrameCallback post_frame_callback = nullptr;
+};
+
+ChoreographerFunctions LoadChoreographer() {
+    ChoreographerFunctions functions;
+    void* const library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) {
+        return functions;
+    }
+    functions.get_instance = reinterpret_cast<GetChoreographerInstance>(
+        dlsym(library, "AChoreographer_getInstance"));
+    functions.post_frame_callback =
+        reinterpret_cast<PostFrameCallback>(dlsym(library, "AChoreographer_postFrameCallback"));
+    return functions;
+}
+
+s64 GetTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // Anonymous namespace
+
+EmuWindow_Android::EmuWindow_Android(ANativeWindow* surface) {
+    egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, nullptr, nullptr)) {
+        LOG_CRITICAL(Frontend, "Failed to initialize EGL: {:#x}", eglGetError());
+        return;
+    }
+
+    static constexpr std::array<EGLint, 13> config_attribs{
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
+        EGL_SURFACE_TYPE,    EGL_WINDOW_BIT | EGL_PBUFFER_BIT,
+        EGL_RED_SIZE,        8,
+        EGL_GREEN_SIZE,      8,
+        EGL_BLUE_SIZE,       8,
+        EGL_DEPTH_SIZE,      0,
+        EGL_NONE};
+    EGLint num_configs = 0;
+    if (!eglChooseConfig(egl_display, config_attribs.data(), &egl_config, 1, &num_configs) ||
+        num_configs == 0) {
+        LOG_CRITICAL(Frontend, "No EGL config for OpenGL ES 3: {:#x}", eglGetError());
+        return;
+    }
+
+    static constexpr std::array<EGLint, 3> context_attribs{EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    static constexpr std::array<EGLint, 5> pbuffer_attribs{EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    eglBindAPI(EGL_OPENGL_ES_API);
+    core_context =
+        eglCreateContext(egl_display, egl_config, EGL_NO_CONTEXT, context_attribs.data());
+    present_context =
+        eglCreateContext(egl_display, egl_config, core_context, context_attribs.data());
+    core_surface = eglCreatePbufferSurface(egl_display, egl_config, pbuffer_attribs.data());
+    if (core_context == EGL_NO_CONTEXT || present_context == EGL_NO_CONTEXT ||
+        core_surface == EGL_NO_SURFACE) {
+        LOG_CRITICAL(Frontend, "Failed to create the EGL contexts: {:#x}", eglGetError());
+        return;
+    }
+
+    egl_presentation_time = reinterpret_cast<PFNEGLPRESENTATIONTIMEANDROIDPROC>(
+        eglGetProcAddress("eglPresentationTimeANDROID"));
+    egl_create_sync =
+        reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+    egl_client_wait_sync =
+        reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(eglGetProcAddress("eglClientWaitSyncKHR"));
+    egl_destroy_sync =
+        reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+
+    eglMakeCurrent(egl_display, core_surface, core_surface, core_context);
+    if (!gladLoadGLES2Loader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+        LOG_CRITICAL(Frontend, "Failed to initialize GL functions");
+    }
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    Settings::values.use_gles = true;
+
+    if (surface != nullptr) {
+        ANativeWindow_acquire(surface);
+        window = surface;
+        UpdateCurrentFramebufferLayout(ANativeWindow_getWidth(surface),
+                                       ANativeWindow_getHeight(surface));
+    }
+    present_thread = std::thread(&EmuWindow_Android::PresentLoop, this);
+}
+
+EmuWindow_Android::~EmuWindow_Android() {
+    is_running = false;
+    if (ALooper* present_looper = looper.load()) {
+        ALooper_wake(present_looper);
+    }
+    if (present_thread.joinable()) {
+        present_thread.join();
+    }
+
+    if (egl_display != EGL_NO_DISPLAY) {
+        eglDestroySurface(egl_display, core_surface);
+        eglDestroyContext(egl_display, present_context);
+        eglDestroyContext(egl_display, core_context);
+        eglTerminate(egl_display);
+    }
+    if (window != nullptr) {
+        ANativeWindow_release(window);
+    }
+    if (new_window != nullptr) {
+        ANativeWindow_release(new_window);
+    }
+}
+
+void EmuWindow_Android::OnSurfaceChanged(ANativeWindow* surface) {
+    if (surface != nullptr) {
+        ANativeWindow_acquire(surface);
+        UpdateCurrentFramebufferLayout(ANativeWindow_getWidth(surface),
+                                       ANativeWindow_getHeight(surface));
+    }
+
+    std::unique_lock lock{surface_mutex};
+    if (surface_changed && new_window != nullptr) {
+        ANativeWindow_release(new_window);
+    }
+    new_window = surface;
+    surface_changed = true;
+    if (ALooper* present_looper = looper.load()) {
+        ALooper_wake(present_looper);
+    }
+    // The UI may release the previous window as soon as this returns
+    surface_applied.wait(lock, [this] { return !surface_changed || !present_thread.joinable(); });
+}
+
+void EmuWindow_Android::SetPresentationOptions(int swap_interval_, int max_queued_frames_) {
+    swap_interval = std::max(swap_interval_, 0);
+    max_queued_frames = std::max(max_queued_frames_, 1);
+}
+
+FramePacingStats EmuWindow_Android::GetAndResetFramePacingStats() {
+    std::scoped_lock lock{stats_mutex};
+    FramePacingStats result = stats;
+    if (result.presented_frames > 0) {
+        result.mean_frame_time_ms = total_frame_time_ms / result.presented_frames;
+    }
+    stats = {};
+    stats.refresh_period_ms = result.refresh_period_ms;
+    total_frame_time_ms = 0.0;
+    return result;
+}
+
+void EmuWindow_Android::PresentLoop() {
+    Common::SetCurrentThreadName("Present");
+    Common::SetCurrentThreadRole(Common::ThreadRole::Present);
+    looper = ALooper_prepare(0);
+    const ChoreographerFunctions choreographer_functions = LoadChoreographer();
+    AChoreographer* const choreographer = choreographer_functions.get_instance
+                                              ? choreographer_functions.get_instance()
+                                              : nullptr;
+    if (choreographer == nullptr) {
+        LOG_WARNING(Frontend, "Choreographer is not available, presenting on eglSwapBuffers");
+    }
+
+    {
+        std::scoped_lock lock{surface_mutex};
+        CreateWindowSurface();
+    }
+
+    while (is_running) {
+        UpdateSurface();
+        if (present_surface == EGL_NO_SURFACE) {
+            ALooper_pollOnce(100, nullptr, nullptr, nullptr);
+            continue;
+        }
+
+        if (choreographer != nullptr && swap_interval > 0) {
+            if (!callback_pending) {
+                callback_pending = true;
+                choreographer_functions.post_frame_callback(
+                    choreographer,
+                    [](long frame_time_ns, void* data) {
+                        OnFrameCallback(static_cast<s64>(frame_time_ns), data);
+                    },
+                    this);
+            }
+            ALooper_pollOnce(100, nullptr, nullptr, nullptr);
+        } else {
+            eglSwapInterval(egl_display, swap_interval);
+            PresentFrame(0);
+        }
+    }
+
+    {
+        std::scoped_lock lock{surface_mutex};
+        DestroyWindowSurface();
+        surface_changed = false;
+    }
+    surface_applied.notify_all();
+    looper = nullptr;
+    Common::ClearCurrentThreadRole();
+}
+
+void EmuWindow_Android::OnFrameCallback(s64 frame_time_ns, void* data) {
+    auto* const emu_window = static_cast<EmuWindow_Android*>(data);
+    emu_window->callback_pending = false;
+    if (emu_window->present_surface == EGL_NO_SURFACE) {
+        return;
+    }
+
+    if (emu_window->last_frame_time_ns != 0) {
+        const s64 period = frame_time_ns - emu_window->last_frame_time_ns;
+        s64& refresh_period = emu_window->refresh_period_ns;
+        // Callbacks that skipped refreshes do not tell the period
+        if (refresh_period == 0 || period < refresh_period * 3 / 2) {
+            refresh_period = refresh_period == 0 ? period : (refresh_period * 7 + period) / 8;
+            Core::System::GetInstance().frame_limiter.SetDisplayRefreshRate(1e9 / refresh_period);
+        }
+    }
+    emu_window->last_frame_time_ns = frame_time_ns;
+
+    if (++emu_window->refreshes_since_present >= emu_window->swap_interval) {
+        emu_window->refreshes_since_present = 0;
+        emu_window->PresentFrame(frame_time_ns);
+    }
+}
+
+void EmuWindow_Android::PresentFrame(s64 frame_time_ns) {
+    WaitForQueuedFrames();
+
+    if (VideoCore::g_renderer != nullptr) {
+        VideoCore::g_renderer->TryPresent(0);
+    }
+
+    s64 present_time_ns = GetTimeNs();
+    if (frame_time_ns != 0 && refresh_period_ns != 0) {
+        // Latched on the next refresh, so that it neither waits a refresh nor is shown early
+        present_time_ns = frame_time_ns + refresh_period_ns;
+        if (egl_presentation_time != nullptr) {
+            egl_presentation_time(egl_display, present_surface, present_time_ns);
+        }
+    }
+    eglSwapBuffers(egl_display, present_surface);
+
+    if (egl_create_sync != nullptr) {
+        const EGLSyncKHR fence = egl_create_sync(egl_display, EGL_SYNC_FENCE_KHR, nullptr);
+        if (fence != EGL_NO_SYNC_KHR) {
+            swap_fences.push_back(fence);
+        }
+    }
+    RecordFrame(present_time_ns);
+}
+
+bool EmuWindow_Android::CreateWindowSurface() {
+    if (window == nullptr || core_context == EGL_NO_CONTEXT) {
+        return false;
+    }
+    present_surface = eglCreateWindowSurface(egl_display, egl_config, window, nullptr);
+    if (present_surface == EGL_NO_SURFACE) {
+        LOG_ERROR(Frontend, "Failed to create the window surface: {:#x}", eglGetError());
+        return false;
+    }
+    eglMakeCurrent(egl_display, present_surface, present_surface, present_context);
+    eglSwapInterval(egl_display, swap_interval > 0 ? 1 : 0);
+    return true;
+}
+
+void EmuWindow_Android::DestroyWindowSurface() {
+    if (present_surface == EGL_NO_SURFACE) {
+        return;
+    }
+    for (const EGLSyncKHR fence : swap_fences) {
+        egl_destroy_sync(egl_display, fence);
+    }
+    swap_fences.clear();
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(egl_display, present_surface);
+    present_surface = EGL_NO_SURFACE;
+    last_frame_time_ns = 0;
+}
+
+void EmuWindow_Android::UpdateSurface() {
+    {
+        std::scoped_lock lock{surface_mutex};
+        if (!surface_changed) {
+            return;
+        }
+        DestroyWindowSurface();
+        if (window != nullptr) {
+            ANativeWindow_release(window);
+        }
+        window = new_window;
+        new_window = nullptr;
+        surface_changed = false;
+        CreateWindowSurface();
+    }
+    surface_applied.notify_all();
+}
+
+void EmuWindow_Android::WaitForQueuedFrames() {
+    while (!swap_fences.empty() &&
+           swap_fences.size() >= static_cast<std::size_t>(max_queued_frames.load())) {
+        egl_client_wait_sync(egl_display, swap_fences.front(), EGL_SYNC_FLUSH_COMMANDS_BIT_KHR,
+                             EGL_FOREVER_KHR);
+        egl_destroy_sync(egl_display, swap_fences.front());
+        swap_fences.pop_front();
+    }
+}
+
+void EmuWindow_Android::RecordFrame(s64 present_time_ns) {
+    std::scoped_lock lock{stats_mutex};
+    if (last_present_time_ns != 0) {
+        const double frame_time_ms = (present_time_ns - last_present_time_ns) / 1e6;
+        total_frame_time_ms += frame_time_ms;
+        stats.max_frame_time_ms = std::max(stats.max_frame_time_ms, frame_time_ms);
+        const double expected_ms = refresh_period_ns * std::max(last_swap_interval, 1) / 1e6;
+        if (refresh_period_ns != 0 && frame_time_ms > expected_ms + refresh_period_ns / 2e6) {
+            stats.late_frames++;
+        }
+        stats.presented_frames++;
+    }
+    stats.refresh_period_ms = refresh_period_ns / 1e6;
+    last_present_time_ns = present_time_ns;
+    last_swap_interval = swap_interval;
+}
+
+void EmuWindow_Android::SwapBuffers() {
+    // The present thread shows the frames
+}
+
+void EmuWindow_Android::PollEvents() {}
+
+void EmuWindow_Android::MakeCurrent() {
+    eglMakeCurrent(egl_display, core_surface, core_surface, core_context);
+}
+
+void EmuWindow_Android::DoneCurrent() {
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+void EmuWindow_Android::SetupFramebuffer() {}
+
+bool EmuWindow_Android::ShouldDeferRendererInit() {
+    return false;
+}
+
+bool EmuWindow_Android::NeedsClearing() const {
+    return true;
+}
+
+bool EmuWindow_Android::IsPresentedOnSeparateThread() const {
+    return true;
+}
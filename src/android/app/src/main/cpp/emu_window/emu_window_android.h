@@ -0,0 +1,131 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "core/frontend/emu_window.h"
+
+struct ALooper;
+struct ANativeWindow;
+
+/// Frame pacing of the presented frames since the last reset
+struct FramePacingStats {
+    u64 presented_frames = 0;
+    /// Frames shown one or more refreshes later than the one after the previous frame
+    u64 late_frames = 0;
+    double mean_frame_time_ms = 0.0;
+    double max_frame_time_ms = 0.0;
+    /// Refresh period of the display, measured from the Choreographer callbacks
+    double refresh_period_ms = 0.0;
+};
+
+/**
+ * Presents on an ANativeWindow from a thread of its own, which shows the newest frame of the
+ * mailbox on each display refresh. With Choreographer, each swap is timed with
+ * EGL_ANDROID_presentation_time for the refresh after the callback. The number of swapped frames
+ * still being rendered is bounded, which keeps the latency that the default triple buffering adds
+ * from building up.
+ */
+class EmuWindow_Android : public Frontend::EmuWindow {
+public:
+    explicit EmuWindow_Android(ANativeWindow* surface);
+    ~EmuWindow_Android();
+
+    /**
+     * Replaces the window presented on, which may be nullptr once the surface is destroyed.
+     * Returns after the present thread stopped using the previous window.
+     */
+    void OnSurfaceChanged(ANativeWindow* surface);
+
+    /**
+     * @param swap_interval Refreshes each presented frame is shown for, 0 to disable vsync
+     * @param max_queued_frames Swapped frames that may still be rendering, at least 1
+     */
+    void SetPresentationOptions(int swap_interval, int max_queued_frames);
+
+    /// Returns the pacing of the frames presented since the previous call
+    FramePacingStats GetAndResetFramePacingStats();
+
+    void SwapBuffers() override;
+    void PollEvents() override;
+    void MakeCurrent() override;
+    void DoneCurrent() override;
+    void SetupFramebuffer() override;
+    bool ShouldDeferRendererInit() override;
+    bool NeedsClearing() const override;
+
+    /// Frames are shown by the present thread
+    bool IsPresentedOnSeparateThread() const override;
+
+private:
+    /// Present thread main loop
+    void PresentLoop();
+
+    /// Called by Choreographer on the present thread at the start of each display refresh
+    static void OnFrameCallback(s64 frame_time_ns, void* data);
+
+    /// Presents the newest frame. frame_time_ns is the start of the refresh, 0 without vsync.
+    void PresentFrame(s64 frame_time_ns);
+
+    /// Creates the window surface of the present context, if there is a window
+    bool CreateWindowSurface();
+    void DestroyWindowSurface();
+
+    /// Applies a window replaced by OnSurfaceChanged
+    void UpdateSurface();
+
+    /// Waits until at most max_queued_frames - 1 swaps are still rendering
+    void WaitForQueuedFrames();
+
+    void RecordFrame(s64 present_time_ns);
+
+    EGLDisplay egl_display = EGL_NO_DISPLAY;
+    EGLConfig egl_config = nullptr;
+    EGLContext core_context = EGL_NO_CONTEXT;
+    EGLSurface core_surface = EGL_NO_SURFACE;
+    EGLContext present_context = EGL_NO_CONTEXT;
+    EGLSurface present_surface = EGL_NO_SURFACE;
+
+    PFNEGLPRESENTATIONTIMEANDROIDPROC egl_presentation_time = nullptr;
+    PFNEGLCREATESYNCKHRPROC egl_create_sync = nullptr;
+    PFNEGLCLIENTWAITSYNCKHRPROC egl_client_wait_sync = nullptr;
+    PFNEGLDESTROYSYNCKHRPROC egl_destroy_sync = nullptr;
+
+    /// Guards the window, which is replaced from the UI thread
+    std::mutex surface_mutex;
+    std::condition_variable surface_applied;
+    ANativeWindow* window = nullptr;
+    ANativeWindow* new_window = nullptr;
+    bool surface_changed = false;
+
+    /// Looper of the present thread, which the Choreographer callbacks run on
+    std::atomic<ALooper*> looper{nullptr};
+    bool callback_pending = false;
+    int refreshes_since_present = 0;
+
+    std::atomic<int> swap_interval{1};
+    std::atomic<int> max_queued_frames{2};
+    s64 refresh_period_ns = 0;
+    s64 last_frame_time_ns = 0;
+    /// Fences of the swaps that may still be rendering, oldest first
+    std::deque<EGLSyncKHR> swap_fences;
+
+    std::mutex stats_mutex;
+    FramePacingStats stats;
+    s64 last_present_time_ns = 0;
+    double total_frame_time_ms = 0.0;
+    /// Swap interval of the previously presented frame, which late frames are measured with
+    int last_swap_interval = 1;
+
+    std::atomic<bool> is_running{true};
+    std::thread present_thread;
+};
@@ -0,0 +1,62 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <android/native_window_jni.h>
+#include "emu_window/emu_window_android.h"
+#include "native_interface.h"
+
+namespace NativeLibrary {
+namespace {
+std::unique_ptr<EmuWindow_Android> emu_window;
+int swap_interval = 1;
+int max_queued_frames = 2;
+} // Anonymous namespace
+
+extern "C" {
+JNICALL void Java_org_citra_1emu_citra_NativeLibrary_surfaceChanged(JNIEnv* env, jclass type,
+                                                                    jobject surface) {
+    ANativeWindow* const window = ANativeWindow_fromSurface(env, surface);
+    if (emu_window) {
+        emu_window->OnSurfaceChanged(window);
+    } else {
+        emu_window = std::make_unique<EmuWindow_Android>(window);
+        emu_window->SetPresentationOptions(swap_interval, max_queued_frames);
+    }
+    // The window holds its own reference
+    if (window != nullptr) {
+        ANativeWindow_release(window);
+    }
+}
+
+JNICALL void Java_org_citra_1emu_citra_NativeLibrary_surfaceDestroyed(JNIEnv* env, jclass type) {
+    if (emu_window) {
+        emu_window->OnSurfaceChanged(nullptr);
+    }
+}
+
+JNICALL void Java_org_citra_1emu_citra_NativeLibrary_setPresentationOptions(
+    JNIEnv* env, jclass type, jint swap_interval_, jint max_queued_frames_) {
+    swap_interval = swap_interval_;
+    max_queued_frames = max_queued_frames_;
+    if (emu_window) {
+        emu_window->SetPresentationOptions(swap_interval, max_queued_frames);
+    }
+}
+
+JNICALL jdoubleArray Java_org_citra_1emu_citra_NativeLibrary_getFramePacingStats(JNIEnv* env,
+                                                                                 jclass type) {
+    const FramePacingStats stats =
+        emu_window ? emu_window->GetAndResetFramePacingStats() : FramePacingStats{};
+    const std::array<jdouble, 5> values{
+        static_cast<jdouble>(stats.presented_frames), static_cast<jdouble>(stats.late_frames),
+        stats.mean_frame_time_ms, stats.max_frame_time_ms, stats.refresh_period_ms};
+
+    jdoubleArray result = env->NewDoubleArray(static_cast<jsize>(values.size()));
+    env->SetDoubleArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+    return result;
+}
+};
+}; // namespace NativeLibrary
@@ -0,0 +1,42 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+package org.citra_emu.citra;
+
+import android.view.Surface;
+
+/**
+ * Native methods of the emulation frontend.
+ */
+public final class NativeLibrary {
+    /** Indices of the values returned by getFramePacingStats */
+    public interface FramePacingStat {
+        int PRESENTED_FRAMES = 0;
+        int LATE_FRAMES = 1;
+        int MEAN_FRAME_TIME_MS = 2;
+        int MAX_FRAME_TIME_MS = 3;
+        int REFRESH_PERIOD_MS = 4;
+    }
+
+    private NativeLibrary() {}
+
+    /** Presents on the surface of a SurfaceView, from SurfaceHolder.Callback.surfaceChanged */
+    public static native void surfaceChanged(Surface surface);
+
+    /** Stops presenting, from SurfaceHolder.Callback.surfaceDestroyed */
+    public static native void surfaceDestroyed();
+
+    /**
+     * @param swapInterval Display refreshes each frame is shown for, 0 to disable vsync
+     * @param maxQueuedFrames Presented frames that may still be rendering, at least 1. 1 gives
+     *                        the lowest latency, and more smooth out GPU time spikes.
+     */
+    public static native void setPresentationOptions(int swapInterval, int maxQueuedFrames);
+
+    /**
+     * Returns the pacing of the frames presented since the previous call, indexed by
+     * FramePacingStat.
+     */
+    public static native double[] getFramePacingStats();
+}
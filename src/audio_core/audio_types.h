@@ -6,7 +6,11 @@
 
 #include <array>
 #include <cstddef>
-#include <deque>
+#include <vector>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
 #include "common/common_types.h"
 
 namespace AudioCore {
@@ -23,8 +27,72 @@ using StereoFrame16 = std::array<std::array<s16, 2>, samples_per_frame>;
 /// The DSP is quadraphonic internally.
 using QuadFrame32 = std::array<std::array<s32, 4>, samples_per_frame>;
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+/**
+ * A variable length buffer of signed PCM16 stereo samples, consumed from the front. Samples are
+ * stored contiguously, consuming them does not move the others, and the storage is reused by the
+ * next buffer decoded into it.
+ */
+class StereoBuffer16 {
+public:
+    using Sample = std::array<s16, 2>;
+
+    bool empty() const {
+        return start == samples.size();
+    }
+
+    std::size_t size() const {
+        return samples.size() - start;
+    }
+
+    Sample& operator[](std::size_t index) {
+        return samples[start + index];
+    }
+
+    const Sample& operator[](std::size_t index) const {
+        return samples[start + index];
+    }
+
+    /// Replaces the contents with `count` samples of unspecified value, to be overwritten
+    Sample* Reset(std::size_t count) {
+        start = 0;
+        samples.resize(count);
+        return samples.data();
+    }
+
+    void clear() {
+        start = 0;
+        samples.clear();
+    }
+
+    /// Removes `count` samples from the front
+    void PopFront(std::size_t count) {
+        start += count;
+        if (start >= samples.size()) {
+            clear();
+        }
+    }
+
+private:
+    std::vector<Sample> samples;
+    std::size_t start = 0;
+
+    // Stored like the std::deque this used to be, which a std::vector is compatible with. See the
+    // implementation level below.
+    template <class Archive>
+    void save(Archive& ar, const unsigned int) const {
+        const std::vector<Sample> remaining(samples.begin() + start, samples.end());
+        ar << remaining;
+    }
+
+    template <class Archive>
+    void load(Archive& ar, const unsigned int) {
+        start = 0;
+        ar >> samples;
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+    friend class boost::serialization::access;
+};
 
 constexpr std::size_t num_dsp_pipe = 8;
 enum class DspPipe {
@@ -41,3 +109,6 @@ enum class DspState {
 };
 
 } // namespace AudioCore
+
+// Like the standard containers, the buffer is stored without class information
+BOOST_CLASS_IMPLEMENTATION(AudioCore::StereoBuffer16, boost::serialization::object_serializable)
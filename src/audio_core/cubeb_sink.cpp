@@ -9,6 +9,8 @@
 #include "audio_core/audio_types.h"
 #include "audio_core/cubeb_sink.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/settings.h"
 
 namespace AudioCore {
 
@@ -47,6 +49,12 @@ CubebSink::CubebSink(std::string_view target_device_name) : impl(std::make_uniqu
         LOG_CRITICAL(Audio_Sink, "Error getting minimum latency");
     }
 
+    // Cubeb has no exclusive mode, but the backends size the device buffers after the requested
+    // latency, so asking for the minimum gets the shortest periods the device supports
+    const u32 latency_frames =
+        Settings::values.audio_low_latency ? minimum_latency : std::max(512u, minimum_latency);
+    LOG_INFO(Audio_Sink, "Opening the cubeb stream with a latency of {} frames", latency_frames);
+
     cubeb_devid output_device = nullptr;
     if (target_device_name != auto_device_name && !target_device_name.empty()) {
         cubeb_device_collection collection;
@@ -67,7 +75,7 @@ CubebSink::CubebSink(std::string_view target_device_name) : impl(std::make_uniqu
     }
 
     int stream_err = cubeb_stream_init(impl->ctx, &impl->stream, "CitraAudio", nullptr, nullptr,
-                                       output_device, &params, std::max(512u, minimum_latency),
+                                       output_device, &params, latency_frames,
                                        &Impl::DataCallback, &Impl::StateCallback, impl.get());
     if (stream_err != CUBEB_OK) {
         switch (stream_err) {
@@ -119,6 +127,7 @@ long CubebSink::Impl::DataCallback(cubeb_stream* stream, void* user_data, const
                                    void* output_buffer, long num_frames) {
     auto* impl = static_cast<Impl*>(user_data);
     auto* buffer = static_cast<s16*>(output_buffer);
+    Common::SetCurrentThreadRole(Common::ThreadRole::Audio);
 
     if (!impl || !impl->cb) {
         LOG_DEBUG(Audio_Sink, "Emitting zeros");
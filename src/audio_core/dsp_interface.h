@@ -100,6 +100,12 @@ public:
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
 
+    /// Returns the number of sample frames the sink had to be given in excess of those queued since
+    /// the last call, and resets it
+    u64 GetAndResetUnderrunFrames();
+    /// Returns the number of sample frames left queued after the last sink callback
+    std::size_t GetQueuedFrames() const;
+
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
@@ -111,7 +117,11 @@ private:
     std::atomic<bool> perform_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
     Common::RingBuffer<s16, 0x2000, 2> fifo;
+    /// Samples popped from the fifo for the time stretcher
+    std::array<s16, 0x2000 * 2> stretch_input;
     std::array<s16, 2> last_frame{};
+    std::atomic<u64> underrun_frames = 0;
+    std::atomic<std::size_t> queued_frames = 0;
     TimeStretcher time_stretcher;
     std::unique_ptr<Sink> sink;
 
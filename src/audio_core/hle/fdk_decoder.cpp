@@ -26,6 +26,9 @@ private:
     Memory::MemorySystem& memory;
 
     HANDLE_AACDECODER decoder = nullptr;
+
+    /// Decoded samples of the current request, kept between requests to reuse their storage
+    std::array<std::vector<s16>, 2> out_streams;
 };
 
 FDKDecoder::Impl::Impl(Memory::MemorySystem& memory) : memory(memory) {
@@ -137,7 +140,9 @@ std::optional<BinaryResponse> FDKDecoder::Impl::Decode(const BinaryRequest& requ
     }
     u8* data = memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR);
 
-    std::array<std::vector<s16>, 2> out_streams;
+    for (auto& stream : out_streams) {
+        stream.clear();
+    }
 
     std::size_t data_size = request.size;
 
@@ -57,6 +57,9 @@ private:
     std::unique_ptr<AVCodecParserContext, AVCodecParserContextDeleter> parser;
     std::unique_ptr<AVPacket, AVPacketDeleter> av_packet;
     std::unique_ptr<AVFrame, AVFrameDeleter> decoded_frame;
+
+    /// Decoded samples of the current request, kept between requests to reuse their storage
+    std::array<std::vector<u8>, 2> out_streams;
 };
 
 FFMPEGDecoder::Impl::Impl(Memory::MemorySystem& memory) : memory(memory) {
@@ -164,7 +167,9 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Decode(const BinaryRequest& r
     }
     u8* data = memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR);
 
-    std::array<std::vector<u8>, 2> out_streams;
+    for (auto& stream : out_streams) {
+        stream.clear();
+    }
 
     std::size_t data_size = request.size;
     while (data_size > 0) {
@@ -2,6 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/shared_ptr.hpp>
@@ -28,8 +34,10 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/settings.h"
 
 SERIALIZE_EXPORT_IMPL(AudioCore::DspHle)
 
@@ -54,6 +62,72 @@ SERIALIZE_IMPL(DspHle)
 // This value has been verified against a rough hardware test with hardware and LLE
 static constexpr u64 audio_frame_ticks = samples_per_frame * 4096 * 2ull; ///< Units: ARM11 cycles
 
+namespace {
+
+/**
+ * Threads sharing the sources of each audio frame with the emulation thread. Sources are assigned
+ * to threads round-robin. Workers sleep between frames, so that they do not keep host cores busy
+ * while emulation is paused, while the end of each frame is awaited by spinning as it is only
+ * ever a fraction of a frame away.
+ */
+class SourceThreads {
+public:
+    explicit SourceThreads(std::size_t num_workers)
+        : start_events(num_workers), done(num_workers + 1) {
+        for (std::size_t i = 0; i < num_workers; i++) {
+            start_events[i] = std::make_unique<Common::Event>();
+            workers.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~SourceThreads() {
+        stop = true;
+        for (auto& event : start_events) {
+            event->Set();
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /// Calls `tick` once for every source index and returns when all calls are done
+    void Run(const std::function<void(std::size_t)>& tick) {
+        job = &tick;
+        for (auto& event : start_events) {
+            event->Set();
+        }
+        RunShare(0, tick);
+        done.Sync();
+    }
+
+private:
+    void RunShare(std::size_t thread_index, const std::function<void(std::size_t)>& tick) const {
+        for (std::size_t i = thread_index; i < HLE::num_sources; i += workers.size() + 1) {
+            tick(i);
+        }
+    }
+
+    void WorkerLoop(std::size_t worker_index) {
+        Common::SetCurrentThreadName("DspHle_Sources");
+        while (true) {
+            start_events[worker_index]->Wait();
+            if (stop) {
+                return;
+            }
+            RunShare(worker_index + 1, *job);
+            done.Sync();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Common::Event>> start_events;
+    Common::SpinBarrier done;
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::atomic<bool> stop{false};
+};
+
+} // Anonymous namespace
+
 struct DspHle::Impl final {
 public:
     explicit Impl(DspHle& parent, Memory::MemorySystem& memory);
@@ -102,6 +176,9 @@ private:
 
     std::unique_ptr<HLE::DecoderBase> decoder{};
 
+    /// Null unless sources are rendered on multiple threads
+    std::unique_ptr<SourceThreads> source_threads{};
+
     std::weak_ptr<DSP_DSP> dsp_dsp{};
 
     template <class Archive>
@@ -148,6 +225,13 @@ DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory) : parent(paren
         decoder = std::make_unique<HLE::NullDecoder>();
     }
 
+    const std::size_t num_workers =
+        std::min<std::size_t>(3, std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    if (Settings::values.enable_dsp_hle_multithread && num_workers > 0) {
+        source_threads = std::make_unique<SourceThreads>(num_workers);
+        LOG_INFO(Audio_DSP, "Rendering sources on {} additional threads", num_workers);
+    }
+
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     tick_event =
         timing.RegisterEvent("AudioCore::DspHle::tick_event", [this](u64, s64 cycles_late) {
@@ -404,10 +488,21 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
 
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
-    // Generate intermediate mixes
-    for (std::size_t i = 0; i < HLE::num_sources; i++) {
+    const auto tick_source = [&](std::size_t i) {
         write.source_statuses.status[i] =
             sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+    };
+    if (source_threads) {
+        source_threads->Run(tick_source);
+    } else {
+        for (std::size_t i = 0; i < HLE::num_sources; i++) {
+            tick_source(i);
+        }
+    }
+
+    // Generate intermediate mixes. Sources are always mixed in the same order, as the sums
+    // would otherwise depend on the threads.
+    for (std::size_t i = 0; i < HLE::num_sources; i++) {
         for (std::size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
@@ -39,6 +39,9 @@ private:
     ADTSData mADTSData{/* MPEG2 */ false, /*profile*/ 2,       /*channels*/ 2,
                        /*channel_idx*/ 2, /*framecount*/ 0,    /*samplerate_idx*/ 3,
                        /*length*/ 0,      /*samplerate*/ 48000};
+
+    /// Decoded samples of the current request, kept between requests to reuse their storage
+    std::array<std::vector<u16>, 2> out_streams;
 };
 
 MediaNDKDecoder::Impl::Impl(Memory::MemorySystem& memory) : mMemory(memory) {
@@ -169,7 +172,9 @@ std::optional<BinaryResponse> MediaNDKDecoder::Impl::Decode(const BinaryRequest&
 
     // output
     AMediaCodecBufferInfo info;
-    std::array<std::vector<u16>, 2> out_streams;
+    for (auto& stream : out_streams) {
+        stream.clear();
+    }
     buffer_index = AMediaCodec_dequeueOutputBuffer(mDecoder.get(), &info, timeout);
     switch (buffer_index) {
     case AMEDIACODEC_INFO_TRY_AGAIN_LATER:
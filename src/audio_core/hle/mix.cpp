@@ -0,0 +1,71 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include "audio_core/hle/mix.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#define MIX_HAVE_SSE2
+#elif defined(ARCHITECTURE_ARM64) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIX_HAVE_NEON
+#endif
+
+namespace AudioCore::HLE {
+
+static_assert(samples_per_frame % 2 == 0, "The vectorized mix processes two samples at a time");
+
+void MixStereoIntoQuadReference(QuadFrame32& dest, const StereoFrame16& src,
+                                const std::array<float, 4>& gains) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * src[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * src[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * src[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * src[samplei][1]);
+    }
+}
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& src,
+                       const std::array<float, 4>& gains) {
+#if defined(MIX_HAVE_SSE2)
+    // The conversions truncate like static_cast does, and products are not fused
+    const __m128 gain = _mm_loadu_ps(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 2) {
+        // L0 R0 L1 R1, sign extended to 32 bits
+        const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&src[samplei]));
+        const __m128i wide = _mm_srai_epi32(_mm_unpacklo_epi16(pair, pair), 16);
+
+        s32* const out = dest[samplei].data();
+        const __m128i first = _mm_shuffle_epi32(wide, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m128i second = _mm_shuffle_epi32(wide, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m128i mixed_first = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(first), gain));
+        const __m128i mixed_second = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(second), gain));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<__m128i*>(out)),
+                                       mixed_first));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4),
+                         _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<__m128i*>(out + 4)),
+                                       mixed_second));
+    }
+#elif defined(MIX_HAVE_NEON)
+    const float32x4_t gain = vld1q_f32(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 2) {
+        // L0 R0 L1 R1, sign extended to 32 bits
+        const int32x4_t wide = vmovl_s16(vld1_s16(src[samplei].data()));
+
+        s32* const out = dest[samplei].data();
+        const int32x4_t first = vcombine_s32(vget_low_s32(wide), vget_low_s32(wide));
+        const int32x4_t second = vcombine_s32(vget_high_s32(wide), vget_high_s32(wide));
+        const int32x4_t mixed_first = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(first), gain));
+        const int32x4_t mixed_second = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(second), gain));
+        vst1q_s32(out, vaddq_s32(vld1q_s32(out), mixed_first));
+        vst1q_s32(out + 4, vaddq_s32(vld1q_s32(out + 4), mixed_second));
+    }
+#else
+    MixStereoIntoQuadReference(dest, src, gains);
+#endif
+}
+
+} // namespace AudioCore::HLE
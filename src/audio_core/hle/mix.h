@@ -0,0 +1,24 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "audio_core/audio_types.h"
+
+namespace AudioCore::HLE {
+
+/**
+ * Adds a stereo frame into a quadraphonic one. The left channel of the source feeds channels 0 and
+ * 2 of the destination and the right channel feeds channels 1 and 3, each scaled by its gain.
+ * Vectorized where the host allows it, with results identical to MixStereoIntoQuadReference.
+ */
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& src,
+                       const std::array<float, 4>& gains);
+
+/// Scalar implementation of MixStereoIntoQuad
+void MixStereoIntoQuadReference(QuadFrame32& dest, const StereoFrame16& src,
+                                const std::array<float, 4>& gains);
+
+} // namespace AudioCore::HLE
@@ -36,6 +36,9 @@ private:
     bool is_valid = false;
     bool mf_started = false;
     bool coinited = false;
+
+    /// Decoded samples of the current request, kept between requests to reuse their storage
+    std::array<std::vector<u8>, 2> out_streams;
 };
 
 WMFDecoder::Impl::Impl(Memory::MemorySystem& memory) : memory(memory) {
@@ -209,7 +212,9 @@ std::optional<BinaryResponse> WMFDecoder::Impl::Decode(const BinaryRequest& requ
     }
     u8* data = memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR);
 
-    std::array<std::vector<u8>, 2> out_streams;
+    for (auto& stream : out_streams) {
+        stream.clear();
+    }
     unique_mfptr<IMFSample> sample;
     MFInputState input_status = MFInputState::OK;
     MFOutputState output_status = MFOutputState::OK;
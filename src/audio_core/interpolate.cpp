@@ -23,7 +23,12 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    // The input is preceded by the two historical samples, which are not copied into it
+    const std::array<s16, 2> history[2] = {state.xn2, state.xn1};
+    const auto sample = [&](std::size_t index) -> const std::array<s16, 2>& {
+        return index >= 2 ? input[index - 2] : history[index];
+    };
+    const std::size_t input_size = input.size() + 2;
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
     u64 fposition = state.fposition;
@@ -32,22 +37,22 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     while (outputi < output.size()) {
         inputi = static_cast<std::size_t>(fposition / scale_factor);
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
+        if (inputi + 2 >= input_size) {
+            inputi = input_size - 2;
             break;
         }
 
         u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+        output[outputi++] = fn(fraction, sample(inputi), sample(inputi + 1), sample(inputi + 2));
 
         fposition += step_size;
     }
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
+    state.xn2 = sample(inputi);
+    state.xn1 = sample(inputi + 1);
     state.fposition = fposition - inputi * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    input.PopFront(inputi);
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
@@ -13,6 +13,7 @@ namespace AudioCore {
 
 struct LibRetroSink::Impl {
     std::function<void(s16*, std::size_t)> cb;
+    std::vector<s16> buffer; ///< Reused for every submission
 };
 
 LibRetroSink::LibRetroSink(std::string target_device_name) : impl(std::make_unique<Impl>()) {}
@@ -28,11 +29,12 @@ void LibRetroSink::SetCallback(std::function<void(s16*, std::size_t)> cb) {
 }
 
 void LibRetroSink::OnAudioSubmission(std::size_t frames) {
-    std::vector<s16> buffer(frames * 2);
+    std::vector<s16>& buffer = impl->buffer;
+    buffer.resize(frames * 2);
 
-    this->impl->cb(buffer.data(), buffer.size() / 2);
+    this->impl->cb(buffer.data(), frames);
 
-    LibRetro::SubmitAudio(buffer.data(), buffer.size() / 2);
+    LibRetro::SubmitAudio(buffer.data(), frames);
 }
 
 std::vector<std::string> ListLibretroSinkDevices() {
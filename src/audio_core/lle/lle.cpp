@@ -149,6 +149,8 @@ struct DspLle::Impl final {
     static constexpr u32 TeakraSlice = 16384;
 
     void TeakraThread() {
+        Common::SetCurrentThreadName("Teakra");
+        Common::SetCurrentThreadRole(Common::ThreadRole::Dsp);
         while (true) {
             teakra.Run(TeakraSlice);
             teakra_slice_barrier.Sync();
@@ -158,6 +160,7 @@ struct DspLle::Impl final {
             }
         }
         stop_signal = false;
+        Common::ClearCurrentThreadRole();
     }
 
     void StopTeakraThread() {
@@ -9,6 +9,8 @@
 #include "audio_core/sdl2_sink.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/settings.h"
 
 namespace AudioCore {
 
@@ -34,7 +36,8 @@ SDL2Sink::SDL2Sink(std::string device_name) : impl(std::make_unique<Impl>()) {
     desired_audiospec.format = AUDIO_S16;
     desired_audiospec.channels = 2;
     desired_audiospec.freq = native_sample_rate;
-    desired_audiospec.samples = 512;
+    // 256 frames are about 8 ms at the native sample rate
+    desired_audiospec.samples = Settings::values.audio_low_latency ? 256 : 512;
     desired_audiospec.userdata = impl.get();
     desired_audiospec.callback = &Impl::Callback;
 
@@ -80,6 +83,7 @@ void SDL2Sink::SetCallback(std::function<void(s16*, std::size_t)> cb) {
 
 void SDL2Sink::Impl::Callback(void* impl_, u8* buffer, int buffer_size_in_bytes) {
     Impl* impl = reinterpret_cast<Impl*>(impl_);
+    Common::SetCurrentThreadRole(Common::ThreadRole::Audio);
     if (!impl || !impl->cb)
         return;
 
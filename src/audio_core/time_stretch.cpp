@@ -19,6 +19,8 @@ TimeStretcher::TimeStretcher()
     sound_touch->setSampleRate(native_sample_rate);
     sound_touch->setPitch(1.0);
     sound_touch->setTempo(1.0);
+    // Considerably cheaper search for the best overlap, at little cost in quality
+    sound_touch->setSetting(SETTING_USE_QUICKSEEK, 1);
 }
 
 TimeStretcher::~TimeStretcher() = default;
@@ -35,7 +37,8 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
 
     const double max_latency = 0.25; // seconds
     const double max_backlog = sample_rate * max_latency;
-    const double backlog_fullness = sound_touch->numSamples() / max_backlog;
+    const double backlog_fullness =
+        (sound_touch->numSamples() + passthrough.size() / 2) / max_backlog;
     if (backlog_fullness > 4.0) {
         // Too many samples in backlog: Don't push anymore on
         num_in = 0;
@@ -57,20 +60,49 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
     // Place a lower limit of 5% speed. When a game boots up, there will be
     // many silence samples. These do not need to be timestretched.
     stretch_ratio = std::max(stretch_ratio, 0.05);
-    sound_touch->setTempo(stretch_ratio);
 
-    LOG_TRACE(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f}", num_in, num_out, stretch_ratio,
-              backlog_fullness);
+    // Stretching by less than half a percent is inaudible, so while emulation runs at full speed
+    // samples are passed through unchanged. The thresholds differ to avoid switching back and
+    // forth, as each switch to passthrough flushes SoundTouch.
+    constexpr double bypass_enter_tolerance = 0.005;
+    constexpr double bypass_exit_tolerance = 0.02;
+    const double deviation = std::abs(stretch_ratio - 1.0);
+    if (!bypass && deviation < bypass_enter_tolerance) {
+        bypass = true;
+        sound_touch->flush();
+    } else if (bypass && deviation > bypass_exit_tolerance) {
+        bypass = false;
+        sound_touch->putSamples(passthrough.data(), static_cast<u32>(passthrough.size() / 2));
+        passthrough.clear();
+    }
+
+    LOG_TRACE(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f} bypass:{}", num_in, num_out,
+              stretch_ratio, backlog_fullness, bypass);
+
+    if (!bypass) {
+        sound_touch->setTempo(stretch_ratio);
+        sound_touch->putSamples(in, static_cast<u32>(num_in));
+        return sound_touch->receiveSamples(out, static_cast<u32>(num_out));
+    }
 
-    sound_touch->putSamples(in, static_cast<u32>(num_in));
-    return sound_touch->receiveSamples(out, static_cast<u32>(num_out));
+    // Samples left in SoundTouch when passthrough started come first
+    const std::size_t num_stretched = sound_touch->receiveSamples(out, static_cast<u32>(num_out));
+    passthrough.insert(passthrough.end(), in, in + num_in * 2);
+    const std::size_t num_passed = std::min(num_out - num_stretched, passthrough.size() / 2);
+    std::copy_n(passthrough.begin(), num_passed * 2, out + num_stretched * 2);
+    passthrough.erase(passthrough.begin(), passthrough.begin() + num_passed * 2);
+    return num_stretched + num_passed;
 }
 
 void TimeStretcher::Clear() {
     sound_touch->clear();
+    passthrough.clear();
 }
 
 void TimeStretcher::Flush() {
+    bypass = false;
+    sound_touch->putSamples(passthrough.data(), static_cast<u32>(passthrough.size() / 2));
+    passthrough.clear();
     sound_touch->flush();
 }
 
@@ -7,6 +7,7 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <vector>
 #include "common/common_types.h"
 
 namespace soundtouch {
@@ -37,6 +38,11 @@ private:
     unsigned int sample_rate;
     std::unique_ptr<soundtouch::SoundTouch> sound_touch;
     double stretch_ratio = 1.0;
+
+    /// True while the stretch ratio is close enough to 1 for samples to be passed through as is
+    bool bypass = false;
+    /// Samples queued for output while bypassing SoundTouch
+    std::vector<s16> passthrough;
 };
 
 } // namespace AudioCore
@@ -2,11 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <string>
 #include <thread>
+#include <vector>
 
 // This needs to be included before getopt.h because the latter #defines symbols used by it
 #include "common/microprofile.h"
@@ -24,6 +28,7 @@
 #include "common/common_paths.h"
 #include "common/detached_tasks.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
@@ -31,6 +36,7 @@
 #include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/dumping/backend.h"
 #include "core/file_sys/cia_container.h"
 #include "core/frontend/applets/default_applets.h"
@@ -40,7 +46,10 @@
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/cfg/cfg.h"
 #include "core/loader/loader.h"
+#include "core/memory.h"
 #include "core/movie.h"
+#include "core/perf_stats.h"
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "network/network.h"
 #include "video_core/renderer_base.h"
@@ -65,11 +74,27 @@ static void PrintHelp(const char* argv0) {
                  "-i, --install=FILE    Installs a specified CIA file\n"
                  "-m, --multiplayer=nick:password@address:port"
                  " Nickname, password, address and port for multiplayer\n"
+                 "-c, --direct-connections With --multiplayer, connect directly to the members\n"
+                 "                     that allow it instead of going through the room\n"
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
                  "-a, --movie-record-author=AUTHOR Sets the author of the movie to be recorded\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
                  "-d, --dump-video=[file]    Dumps audio and video to the given video file\n"
+                 "                     or streams them live to a URL such as srt://host:port\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
+                 "-b, --bench=SECONDS  Run SECONDS of emulated time unthrottled in a hidden\n"
+                 "                     window, then print the performance statistics as JSON.\n"
+                 "                     Stops early when the played movie ends\n"
+                 "-l, --load-state=SLOT Load the savestate in SLOT once the game has booted\n"
+                 "-e, --expect-hash=HASH With --bench, fail unless the FCRAM hash at the end\n"
+                 "                     matches HASH\n"
+                 "-s, --state-hashes=FILE Write hashes of the guest state at the end of every\n"
+                 "                     game frame to FILE\n"
+                 "-k, --compare-state-hashes=FILE With --state-hashes, fail if the hashes differ\n"
+                 "                     from those written to FILE by an earlier run\n"
+                 "-t, --train-state-dictionary=FILE Train a save state compression dictionary\n"
+                 "                     from the save state files given instead of <filename>,\n"
+                 "                     write it to FILE and exit\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
 }
@@ -196,6 +221,13 @@ int main(int argc, char** argv) {
     std::string movie_record_author;
     std::string movie_play;
     std::string dump_video;
+    u32 bench_seconds = 0;
+    std::optional<u32> load_state_slot;
+    std::optional<u64> expected_hash;
+    std::string state_hashes;
+    std::string reference_state_hashes;
+    std::string state_dictionary;
+    std::vector<std::string> positional_args;
 
     InitializeLogging();
 
@@ -212,6 +244,7 @@ int main(int argc, char** argv) {
     std::string filepath;
 
     bool use_multiplayer = false;
+    bool direct_connections = false;
     bool fullscreen = false;
     std::string nickname{};
     std::string password{};
@@ -222,18 +255,26 @@ int main(int argc, char** argv) {
         {"gdbport", required_argument, 0, 'g'},
         {"install", required_argument, 0, 'i'},
         {"multiplayer", required_argument, 0, 'm'},
+        {"direct-connections", no_argument, 0, 'c'},
         {"movie-record", required_argument, 0, 'r'},
         {"movie-record-author", required_argument, 0, 'a'},
         {"movie-play", required_argument, 0, 'p'},
         {"dump-video", required_argument, 0, 'd'},
         {"fullscreen", no_argument, 0, 'f'},
+        {"bench", required_argument, 0, 'b'},
+        {"load-state", required_argument, 0, 'l'},
+        {"expect-hash", required_argument, 0, 'e'},
+        {"state-hashes", required_argument, 0, 's'},
+        {"compare-state-hashes", required_argument, 0, 'k'},
+        {"train-state-dictionary", required_argument, 0, 't'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg =
+            getopt_long(argc, argv, "g:i:m:cr:p:fb:l:e:s:k:t:hv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -299,6 +340,9 @@ int main(int argc, char** argv) {
             case 'p':
                 movie_play = optarg;
                 break;
+            case 'c':
+                direct_connections = true;
+                break;
             case 'd':
                 dump_video = optarg;
                 break;
@@ -306,6 +350,46 @@ int main(int argc, char** argv) {
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
                 break;
+            case 'b':
+                errno = 0;
+                bench_seconds = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || bench_seconds == 0)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--bench");
+                    exit(1);
+                }
+                break;
+            case 'l':
+                errno = 0;
+                load_state_slot = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || *load_state_slot == 0 ||
+                    *load_state_slot > Core::SaveStateSlotCount)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--load-state");
+                    exit(1);
+                }
+                break;
+            case 'e':
+                errno = 0;
+                expected_hash = strtoull(optarg, &endarg, 16);
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--expect-hash");
+                    exit(1);
+                }
+                break;
+            case 's':
+                state_hashes = optarg;
+                break;
+            case 'k':
+                reference_state_hashes = optarg;
+                break;
+            case 't':
+                state_dictionary = optarg;
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -319,6 +403,7 @@ int main(int argc, char** argv) {
 #else
             filepath = argv[optind];
 #endif
+            positional_args.push_back(filepath);
             optind++;
         }
     }
@@ -327,6 +412,10 @@ int main(int argc, char** argv) {
     LocalFree(argv_w);
 #endif
 
+    if (!state_dictionary.empty()) {
+        return Core::TrainSaveStateDictionary(positional_args, state_dictionary) ? 0 : -1;
+    }
+
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
 
@@ -340,6 +429,13 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!reference_state_hashes.empty() && state_hashes.empty()) {
+        LOG_CRITICAL(Frontend, "Comparing state hashes requires writing them with --state-hashes");
+        return -1;
+    }
+    Settings::values.state_hash_log = state_hashes;
+    Settings::values.state_hash_reference = reference_state_hashes;
+
     if (!movie_record.empty()) {
         Core::Movie::GetInstance().PrepareForRecording();
     }
@@ -350,6 +446,10 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    if (bench_seconds != 0) {
+        Settings::values.frame_limit = 0;
+        Settings::values.use_frame_limit_alternate = false;
+    }
     Settings::Apply();
 
     // Register frontend applets
@@ -358,7 +458,8 @@ int main(int argc, char** argv) {
     // Register generic image interface
     Core::System::GetInstance().RegisterImageInterface(std::make_shared<LodePNGImageInterface>());
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen)};
+    std::unique_ptr<EmuWindow_SDL2> emu_window{
+        std::make_unique<EmuWindow_SDL2>(fullscreen, bench_seconds != 0)};
     Frontend::ScopeAcquireContext scope(*emu_window);
     Core::System& system{Core::System::GetInstance()};
 
@@ -401,6 +502,7 @@ int main(int argc, char** argv) {
             member->BindOnStatusMessageReceived(OnStatusMessageReceived);
             member->BindOnStateChanged(OnStateChanged);
             member->BindOnError(OnNetworkError);
+            member->SetDirectConnectionsEnabled(direct_connections);
             LOG_DEBUG(Network, "Start connection to {}:{} with nickname {}", address, port,
                       nickname);
             member->Join(nickname, Service::CFG::GetConsoleIdHash(system), address.c_str(), port, 0,
@@ -436,11 +538,68 @@ int main(int argc, char** argv) {
                       total);
         });
 
-    while (emu_window->IsOpen()) {
+    if (load_state_slot) {
+        // The savestate is loaded by the next RunLoop, before it runs anything
+        system.SendSignal(Core::System::Signal::Load, *load_state_slot);
         system.RunLoop();
     }
+    if (bench_seconds != 0 && !movie_play.empty()) {
+        Core::Movie::GetInstance().SetPlaybackCompletionCallback(
+            [&emu_window] { emu_window->Close(); });
+    }
+
+    const auto bench_start = std::chrono::steady_clock::now();
+    const u64 bench_start_us = system.CoreTiming().GetGlobalTimeUs().count();
+    const u64 bench_end_us = bench_start_us + u64{bench_seconds} * 1000000;
+
+    const auto bench_done = [&] {
+        return bench_seconds != 0 && system.CoreTiming().GetGlobalTimeUs().count() >= bench_end_us;
+    };
+    while (emu_window->IsOpen()) {
+        system.RunUntil([&] { return !emu_window->IsOpen() || bench_done(); });
+        if (bench_done()) {
+            emu_window->Close();
+        }
+    }
     render_thread.join();
 
+    bool bench_failed = false;
+    if (bench_seconds != 0) {
+        const double wall_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - bench_start).count();
+        const double emulated_seconds =
+            (system.CoreTiming().GetGlobalTimeUs().count() - bench_start_us) / 1e6;
+
+        std::vector<double> frametimes = system.perf_stats->GetFrametimes();
+        std::sort(frametimes.begin(), frametimes.end());
+        const auto percentile = [&frametimes](std::size_t percent) {
+            return frametimes.empty() ? 0.0 : frametimes[(frametimes.size() - 1) * percent / 100];
+        };
+
+        const u64 hash =
+            Common::ComputeHash64(system.Memory().GetFCRAMPointer(0), Memory::FCRAM_SIZE);
+
+        std::cout << fmt::format("{{\"wall_time\": {:.3f}, \"emulated_time\": {:.3f}, "
+                                 "\"emulation_speed\": {:.4f}, \"frames\": {}, "
+                                 "\"mean_frametime\": {:.6f}, \"frametime_p50\": {:.6f}, "
+                                 "\"frametime_p90\": {:.6f}, \"frametime_p99\": {:.6f}, "
+                                 "\"frametime_max\": {:.6f}, \"fcram_hash\": \"{:016x}\"}}",
+                                 wall_seconds, emulated_seconds, emulated_seconds / wall_seconds,
+                                 frametimes.size(), system.perf_stats->GetMeanFrametime(),
+                                 percentile(50), percentile(90), percentile(99), percentile(100),
+                                 hash)
+                  << std::endl;
+
+        if (expected_hash && *expected_hash != hash) {
+            LOG_CRITICAL(Frontend, "FCRAM hash {:016x} does not match the expected {:016x}", hash,
+                         *expected_hash);
+            bench_failed = true;
+        }
+    }
+
+    const bool state_diverged =
+        system.StateHashLog() && system.StateHashLog()->GetFirstMismatch().has_value();
+
     Core::Movie::GetInstance().Shutdown();
     if (system.VideoDumper().IsDumping()) {
         system.VideoDumper().StopDumping();
@@ -449,5 +608,5 @@ int main(int argc, char** argv) {
     system.Shutdown();
 
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return bench_failed || state_diverged ? 1 : 0;
 }
@@ -101,11 +101,35 @@ void Config::ReadValues() {
     Settings::values.current_input_profile.udp_input_port =
         static_cast<u16>(sdl2_config->GetInteger("Controls", "udp_input_port",
                                                  InputCommon::CemuhookUDP::DEFAULT_PORT));
+    Settings::values.sync_input_to_vblank =
+        sdl2_config->GetBoolean("Controls", "sync_input_to_vblank", false);
 
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.use_cpu_tiering = sdl2_config->GetBoolean("Core", "use_cpu_tiering", false);
     Settings::values.cpu_clock_percentage =
         sdl2_config->GetInteger("Core", "cpu_clock_percentage", 100);
+    Settings::values.adaptive_cpu_clock =
+        sdl2_config->GetBoolean("Core", "adaptive_cpu_clock", false);
+    Settings::values.cpu_clock_percentage_min =
+        sdl2_config->GetInteger("Core", "cpu_clock_percentage_min", 50);
+    Settings::values.cpu_clock_percentage_max =
+        sdl2_config->GetInteger("Core", "cpu_clock_percentage_max", 200);
+    Settings::values.enable_rewind = sdl2_config->GetBoolean("Core", "enable_rewind", false);
+    Settings::values.rewind_interval =
+        static_cast<u32>(sdl2_config->GetInteger("Core", "rewind_interval", 10));
+    Settings::values.rewind_buffer_size =
+        static_cast<u32>(sdl2_config->GetInteger("Core", "rewind_buffer_size", 512));
+    Settings::values.share_code_pages =
+        sdl2_config->GetBoolean("Core", "share_code_pages", false);
+    Settings::values.boot_snapshot = sdl2_config->GetBoolean("Core", "boot_snapshot", false);
+    Settings::values.boot_snapshot_frame =
+        static_cast<u32>(sdl2_config->GetInteger("Core", "boot_snapshot_frame", 0));
+    Settings::values.auto_title_profiles =
+        sdl2_config->GetBoolean("Core", "auto_title_profiles", false);
+    Settings::values.thread_priority = static_cast<Common::ThreadPriority>(
+        sdl2_config->GetInteger("Core", "thread_priority", 0));
+    Settings::values.thread_affinity = sdl2_config->GetString("Core", "thread_affinity", "");
 
     // Renderer
     Settings::values.use_gles = sdl2_config->GetBoolean("Renderer", "use_gles", false);
@@ -123,6 +147,14 @@ void Config::ReadValues() {
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
+    Settings::values.dynamic_resolution =
+        sdl2_config->GetBoolean("Renderer", "dynamic_resolution", false);
+    Settings::values.min_resolution_factor =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "min_resolution_factor", 1));
+    Settings::values.surface_cache_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "surface_cache_budget", 0));
+    Settings::values.gpu_texture_decoding =
+        sdl2_config->GetBoolean("Renderer", "gpu_texture_decoding", false);
     Settings::values.use_disk_shader_cache =
         sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
     Settings::values.frame_limit =
@@ -131,10 +163,14 @@ void Config::ReadValues() {
         sdl2_config->GetBoolean("Renderer", "use_frame_limit_alternate", false);
     Settings::values.frame_limit_alternate =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_limit_alternate", 200));
+    Settings::values.frame_skip =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_skip", 0));
     Settings::values.use_vsync_new =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "use_vsync_new", 1));
     Settings::values.texture_filter_name =
         sdl2_config->GetString("Renderer", "texture_filter_name", "none");
+    Settings::values.show_frame_counters =
+        sdl2_config->GetBoolean("Renderer", "show_frame_counters", false);
 
     Settings::values.render_3d = static_cast<Settings::StereoRenderOption>(
         sdl2_config->GetInteger("Renderer", "render_3d", 0));
@@ -188,10 +224,14 @@ void Config::ReadValues() {
     Settings::values.enable_dsp_lle = sdl2_config->GetBoolean("Audio", "enable_dsp_lle", false);
     Settings::values.enable_dsp_lle_multithread =
         sdl2_config->GetBoolean("Audio", "enable_dsp_lle_multithread", false);
+    Settings::values.enable_dsp_hle_multithread =
+        sdl2_config->GetBoolean("Audio", "enable_dsp_hle_multithread", false);
     Settings::values.sink_id = sdl2_config->GetString("Audio", "output_engine", "auto");
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
     Settings::values.audio_device_id = sdl2_config->GetString("Audio", "output_device", "auto");
+    Settings::values.audio_low_latency =
+        sdl2_config->GetBoolean("Audio", "audio_low_latency", false);
     Settings::values.volume = static_cast<float>(sdl2_config->GetReal("Audio", "volume", 1));
     Settings::values.mic_input_device =
         sdl2_config->GetString("Audio", "mic_input_device", Frontend::Mic::default_device_name);
@@ -232,6 +272,8 @@ void Config::ReadValues() {
                 std::chrono::system_clock::from_time_t(std::mktime(&t)).time_since_epoch())
                 .count();
     }
+    Settings::values.uds_batch_window =
+        static_cast<u16>(sdl2_config->GetInteger("System", "uds_batch_window", 2));
 
     // Camera
     using namespace Service::CAM;
@@ -260,6 +302,10 @@ void Config::ReadValues() {
     // Debugging
     Settings::values.record_frame_times =
         sdl2_config->GetBoolean("Debugging", "record_frame_times", false);
+    Settings::values.measure_input_latency =
+        sdl2_config->GetBoolean("Debugging", "measure_input_latency", false);
+    Settings::values.ipc_recorder_sample_rate =
+        static_cast<u32>(sdl2_config->GetInteger("Debugging", "ipc_recorder_sample_rate", 0));
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
     Settings::values.gdbstub_port =
         static_cast<u16>(sdl2_config->GetInteger("Debugging", "gdbstub_port", 24689));
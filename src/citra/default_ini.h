@@ -86,17 +86,77 @@ udp_input_port=
 # The pad to request data on. Should be between 0 (Pad 1) and 3 (Pad 4). (Default 0)
 udp_pad_index=
 
+# Aligns the pad and touch screen updates to the screen refresh, so that the input that games read
+# after a VBlank is sampled right before it instead of up to a few milliseconds earlier.
+# Recordings must be played back with the same value. 0 (default): Off, 1: On
+sync_input_to_vblank =
+
 [Core]
 # Whether to use the Just-In-Time (JIT) compiler for CPU emulation
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to interpret code until it has run often enough to be worth compiling. Needs the JIT.
+# Saves compile time on code that only runs a few times, such as loading screens.
+# 0 (default): Compile everything, 1: Interpret rarely run code
+use_cpu_tiering =
+
 # Change the Clock Frequency of the emulated 3DS CPU.
 # Underclocking can increase the performance of the game at the risk of freezing.
 # Overclocking may fix lag that happens on console, but also comes with the risk of freezing.
 # Range is any positive integer (but we suspect 25 - 400 is a good idea) Default is 100
 cpu_clock_percentage =
 
+# Raises the CPU clock while the game is busy and lowers it while it is idle, starting from
+# cpu_clock_percentage. Movies and netplay adjust it from emulated time alone.
+# 0 (default): Off, 1: On
+adaptive_cpu_clock =
+
+# Bounds of the adaptive CPU clock. Defaults are 50 and 200
+cpu_clock_percentage_min =
+cpu_clock_percentage_max =
+
+# Keeps a history of snapshots to step the emulation backwards with
+# 0 (default): Off, 1: On
+enable_rewind =
+
+# Number of frames between rewind snapshots. Default is 10
+rewind_interval =
+
+# Memory used by the rewind snapshots, in MiB. The newest snapshot alone uses as much as the
+# emulated RAM. Default is 512
+rewind_buffer_size =
+
+# Maps the read-only code of applications from a file in the cache directory, so that instances
+# running the same title share its memory. Has no effect on Windows.
+# 0 (default): Off, 1: On
+share_code_pages =
+
+# Saves the state of each application once it has booted, and restores it instead of booting the
+# application again on later runs with the same settings. Meant for repeated automated runs.
+# 0 (default): Off, 1: On
+boot_snapshot =
+
+# The frame at which the boot snapshot is saved. The state must not depend on save data or other
+# files read by the application, so snapshots should be taken before the application reads them.
+# 0 (default): At the first service request of the application, N: After N frames
+boot_snapshot_frame =
+
+# Picks the performance settings of each application without a profile in profiles/ of the config
+# directory from how fast its first run was, and writes them there to apply on later runs.
+# 0 (default): Off, 1: On
+auto_title_profiles =
+
+# Scheduling class of the emulation, GPU, DSP, audio and present threads. Realtime needs the
+# privilege for SCHED_FIFO on Linux, and uses MMCSS on Windows.
+# 0 (default): Normal, 1: High, 2: Realtime
+thread_priority =
+
+# Host cores each thread role may run on, as comma separated role=mask pairs, e.g.
+# emulation=0x2,gpu=0x4. Roles are emulation, gpu, dsp, audio, present, network and background.
+# Empty (default) leaves the placement to the host
+thread_affinity =
+
 [Renderer]
 # Whether to render using GLES or OpenGL
 # 0 (default): OpenGL, 1: GLES
@@ -136,9 +196,33 @@ use_disk_shader_cache =
 # factor for the 3DS resolution
 resolution_factor =
 
+# Lowers the resolution scale factor of render targets while the GPU can't keep up, and raises it
+# back up to resolution_factor when it can. Needs GPU timer queries.
+# 0 (default): Off, 1: On
+dynamic_resolution =
+
+# Lowest resolution scale factor used by dynamic_resolution
+# 1 (default): Native 3DS screen resolution, Otherwise a scale factor for the 3DS resolution
+min_resolution_factor =
+
+# Texture memory the hardware renderer may use for cached surfaces, in MiB. Above it, the surfaces
+# used least recently are written back to 3DS memory and freed. Useful at high resolution factors.
+# 0 (default): No limit
+surface_cache_budget =
+
+# Copies the raw bytes of tiled textures and render targets to the GPU and decodes them there with
+# a compute shader, instead of on the CPU. Needs OpenGL 4.3 or OpenGL ES 3.1.
+# 0 (default): Off, 1: On
+gpu_texture_decoding =
+
 # Texture filter name
 texture_filter_name =
 
+# Draws the draws, surface cache misses, texture uploads, shader compiles, SVCs and IPC requests
+# of each frame in the top-left corner, one row each in that order
+# 0 (default): Off, 1: On
+show_frame_counters =
+
 # Limits the speed of the game to run no faster than this value as a percentage of target speed.
 # Will not have an effect if unthrottled is enabled.
 # 5 - 995: Speed limit as a percentage of target game speed. 0 for unthrottled. 100 (default)
@@ -152,6 +236,11 @@ use_frame_limit_alternate =
 # 5 - 995: Speed limit as a percentage of target game speed. 0 for unthrottled. 200 (default)
 frame_limit_alternate =
 
+# Frames that are emulated but not rendered after each rendered one, while the speed limit in use
+# is above 100% or unthrottled. Draws to memory the CPU reads back are still rendered.
+# 0 (default): Render every frame, Otherwise the number of frames skipped
+frame_skip =
+
 # The clear color for the renderer. What shows up on the sides of the bottom screen.
 # Must be in range of 0.0-1.0. Defaults to 0.0 for all.
 bg_red =
@@ -226,6 +315,10 @@ enable_dsp_lle =
 # 0 (default): No, 1: Yes
 enable_dsp_lle_thread =
 
+# Whether or not to render the DSP HLE audio sources on several threads
+# 0 (default): No, 1: Yes
+enable_dsp_hle_multithread =
+
 
 # Which audio output engine to use.
 # auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available)
@@ -241,6 +334,11 @@ enable_audio_stretching =
 # auto (default): Auto-select
 output_device =
 
+# Whether to ask the output device for the smallest buffer it supports. This keeps audio closer
+# to the picture, but may crackle on slow devices or drivers.
+# 0 (default): No, 1: Yes
+audio_low_latency =
+
 # Output volume.
 # 1.0 (default): 100%, 0.0; mute
 volume =
@@ -276,6 +374,11 @@ init_clock =
 # Note: 3DS can only handle times later then Jan 1 2000
 init_time =
 
+# How many milliseconds of local wireless data frames to send together to the multiplayer room.
+# Fewer, larger packets reach the room, at the cost of that much latency.
+# 0: Send each frame on its own, 2 (default)
+uds_batch_window =
+
 [Camera]
 # Which camera engine to use for the right outer camera
 # blank (default): a dummy camera that always returns black image
@@ -306,6 +409,12 @@ log_filter = *:Info
 [Debugging]
 # Record frame time data, can be found in the log directory. Boolean value
 record_frame_times =
+# Measure the time from an input changing to the game seeing it, reported with the frame time
+# percentiles. 0 (default): Off, 1: On
+measure_input_latency =
+# Keep the last IPC requests in a ring buffer, which is logged when the application breaks.
+# 0 (default): Off, 1: Every request, N: One in every N requests
+ipc_recorder_sample_rate =
 # Port for listening to GDB connections.
 use_gdbstub=false
 gdbstub_port=24689
@@ -29,7 +29,8 @@ private:
 
 class EmuWindow_SDL2 : public Frontend::EmuWindow {
 public:
-    explicit EmuWindow_SDL2(bool fullscreen);
+    /// @param hidden Never shows the window and presents without vsync, for benchmarking
+    explicit EmuWindow_SDL2(bool fullscreen, bool hidden = false);
     ~EmuWindow_SDL2();
 
     void Present();
@@ -54,9 +55,15 @@ public:
     /// Flags that the framebuffer should be cleared.
     bool NeedsClearing() const override;
 
+    /// Frames are shown by the render thread running Present
+    bool IsPresentedOnSeparateThread() const override;
+
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
+    /// Closes the window as if requested by the user
+    void Close();
+
 private:
     /// Called by PollEvents when a key is pressed or released.
     void OnKeyEvent(int key, u8 state);
@@ -91,6 +98,9 @@ private:
     /// Is the window still open?
     bool is_open = true;
 
+    /// Is the window hidden?
+    bool hidden = false;
+
     /// Internal SDL2 render window
     SDL_Window* render_window;
 
@@ -0,0 +1,279 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+#include <glad/glad.h>
+
+// This needs to be included before getopt.h because the latter #defines symbols used by it
+#include "common/microprofile.h"
+
+#include "citra/config.h"
+#include "citra/emu_window/emu_window_sdl2.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "core/core.h"
+#include "core/frontend/scope_acquire_context.h"
+#include "core/settings.h"
+#include "core/tracer/player.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+extern "C" {
+// tells Nvidia drivers to use the dedicated GPU by default on laptops with switchable graphics
+__declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
+}
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <filename>\n"
+                 "Replays a CiTrace (.ctf) as fast as possible in a hidden window and prints the\n"
+                 "CPU and GPU time of its frames as JSON.\n"
+                 "-s, --software       Use the software rasterizer\n"
+                 "-n, --loops=COUNT    Replay the trace COUNT times (default 1)\n"
+                 "-o, --output=FILE    Write the times of every frame to FILE as CSV\n"
+                 "-h, --help           Display this help and exit\n"
+                 "-v, --version        Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+static void InitializeLogging() {
+    Log::Filter log_filter(Log::Level::Debug);
+    log_filter.ParseFilterString(Settings::values.log_filter);
+    Log::SetGlobalFilter(log_filter);
+
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+}
+
+namespace {
+
+/**
+ * Measures the GPU time of each frame with timer queries. Results are read a few frames late, so
+ * that waiting for them does not stall the pipeline.
+ */
+class GPUFrameTimer {
+public:
+    GPUFrameTimer() {
+        glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    }
+
+    ~GPUFrameTimer() {
+        glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    }
+
+    void Begin() {
+        if (num_pending == queries.size()) {
+            ReadOldest();
+        }
+        glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+    }
+
+    void End() {
+        glEndQuery(GL_TIME_ELAPSED);
+        next = (next + 1) % queries.size();
+        num_pending++;
+    }
+
+    /// Returns the GPU times of the frames measured so far, in milliseconds
+    const std::vector<double>& Finish() {
+        while (num_pending > 0) {
+            ReadOldest();
+        }
+        return times;
+    }
+
+private:
+    void ReadOldest() {
+        const std::size_t oldest = (next + queries.size() - num_pending) % queries.size();
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &ns);
+        times.push_back(static_cast<double>(ns) / 1e6);
+        num_pending--;
+    }
+
+    std::array<GLuint, 4> queries{};
+    std::size_t next = 0;
+    std::size_t num_pending = 0;
+    std::vector<double> times;
+};
+
+double Percentile(std::vector<double> values, std::size_t percent) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[(values.size() - 1) * percent / 100];
+}
+
+double Mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (const double value : values) {
+        sum += value;
+    }
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Config config;
+    int option_index = 0;
+    bool software = false;
+    u32 loops = 1;
+    std::string output;
+    std::string filepath;
+
+    InitializeLogging();
+
+    char* endarg;
+    static struct option long_options[] = {
+        {"software", no_argument, 0, 's'},  {"loops", required_argument, 0, 'n'},
+        {"output", required_argument, 0, 'o'}, {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},   {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "sn:o:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 's':
+                software = true;
+                break;
+            case 'n':
+                errno = 0;
+                loops = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || loops == 0)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--loops");
+                    exit(1);
+                }
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            }
+        } else {
+            filepath = argv[optind];
+            optind++;
+        }
+    }
+
+    MicroProfileOnThreadCreate("EmuThread");
+    SCOPE_EXIT({ MicroProfileShutdown(); });
+
+    if (filepath.empty()) {
+        LOG_CRITICAL(Frontend, "No CiTrace specified");
+        return -1;
+    }
+
+    Settings::values.use_hw_renderer = !software;
+    Settings::values.frame_limit = 0;
+    Settings::values.use_frame_limit_alternate = false;
+    // Its timer queries would overlap with the ones of GPUFrameTimer
+    Settings::values.dynamic_resolution = false;
+    // Every frame of the trace is timed, so none may be skipped while running unthrottled
+    Settings::values.frame_skip = 0;
+    Settings::Apply();
+
+    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(false, true)};
+    Frontend::ScopeAcquireContext scope(*emu_window);
+    Core::System& system{Core::System::GetInstance()};
+    if (system.InitWithoutApplication(*emu_window) != Core::System::ResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to initialize the video core");
+        return -1;
+    }
+
+    CiTrace::Player player{system.Memory()};
+    if (!player.Load(filepath)) {
+        system.Shutdown();
+        return -1;
+    }
+    LOG_INFO(Frontend, "Replaying {} frames from {}", player.NumFrames(), filepath);
+
+    std::thread render_thread([&emu_window] { emu_window->Present(); });
+
+    // Every replayed part of the stream is measured, but the commands after the last frame marker
+    // of each loop are not a frame
+    std::vector<double> measured_cpu_times;
+    std::vector<bool> is_frame;
+    std::vector<double> measured_gpu_times;
+    {
+        GPUFrameTimer gpu_timer;
+        for (u32 loop = 0; loop < loops; ++loop) {
+            player.Reset();
+            bool played = true;
+            while (played) {
+                const auto frame_start = std::chrono::steady_clock::now();
+                gpu_timer.Begin();
+                played = player.PlayFrame();
+                gpu_timer.End();
+                measured_cpu_times.push_back(std::chrono::duration<double, std::milli>(
+                                                 std::chrono::steady_clock::now() - frame_start)
+                                                 .count());
+                is_frame.push_back(played);
+            }
+        }
+        measured_gpu_times = gpu_timer.Finish();
+    }
+    emu_window->Close();
+    render_thread.join();
+
+    std::vector<double> cpu_times;
+    std::vector<double> gpu_times;
+    for (std::size_t i = 0; i < is_frame.size(); ++i) {
+        if (is_frame[i]) {
+            cpu_times.push_back(measured_cpu_times[i]);
+            gpu_times.push_back(measured_gpu_times[i]);
+        }
+    }
+
+    if (!output.empty()) {
+        FileUtil::IOFile file(output, "w");
+        file.WriteString("frame,cpu_ms,gpu_ms\n");
+        for (std::size_t i = 0; i < cpu_times.size(); ++i) {
+            file.WriteString(fmt::format("{},{:.4f},{:.4f}\n", i, cpu_times[i], gpu_times[i]));
+        }
+    }
+
+    std::cout << fmt::format("{{\"frames\": {}, \"cpu_mean_ms\": {:.4f}, \"cpu_p50_ms\": {:.4f}, "
+                             "\"cpu_p99_ms\": {:.4f}, \"cpu_max_ms\": {:.4f}, "
+                             "\"gpu_mean_ms\": {:.4f}, \"gpu_p50_ms\": {:.4f}, "
+                             "\"gpu_p99_ms\": {:.4f}, \"gpu_max_ms\": {:.4f}}}",
+                             cpu_times.size(), Mean(cpu_times), Percentile(cpu_times, 50),
+                             Percentile(cpu_times, 99), Percentile(cpu_times, 100),
+                             Mean(gpu_times), Percentile(gpu_times, 50), Percentile(gpu_times, 99),
+                             Percentile(gpu_times, 100))
+              << std::endl;
+
+    system.Shutdown();
+    return 0;
+}
@@ -134,24 +134,43 @@ void LibRetro::OnConfigureEnvironment() {
 
     static const retro_variable values[] = {
         {"citra_use_cpu_jit", "Enable CPU JIT; enabled|disabled"},
+        {"citra_use_cpu_tiering", "Interpret rarely run code (needs JIT); disabled|enabled"},
         {"citra_cpu_scale", cpuScale.c_str()},
+        {"citra_adaptive_cpu_clock", "Adapt CPU clock to the game's load; disabled|enabled"},
+        {"citra_thread_priority", "Priority of the emulation threads; normal|high|realtime"},
+        {"citra_share_code_pages", "Share the code memory of instances running the same game; disabled|enabled"},
+        {"citra_boot_snapshot", "Restore games from a snapshot of their booted state; disabled|enabled"},
         {"citra_use_hw_renderer", "Enable hardware renderer; enabled|disabled"},
         {"citra_use_shader_jit", "Enable shader JIT; enabled|disabled"},
         {"citra_use_hw_shaders", "Enable hardware shaders; enabled|disabled"},
         {"citra_use_hw_shader_cache", "Save hardware shader cache to disk; enabled|disabled"},
+        {"citra_async_shader_compilation", "Compile new shaders in the background (skips draws until ready); disabled|enabled"},
+        {"citra_fragment_ubershader", "Draw with an ubershader while shaders compile in the background; enabled|disabled"},
+        {"citra_use_gpu_thread", "Process GPU commands on a separate thread (only for S/W renderer); disabled|enabled"},
+        {"citra_use_dsp_hle_threads", "Render HLE audio sources on multiple threads; disabled|enabled"},
         {"citra_use_acc_geo_shaders", "Enable accurate geometry shaders (only for H/W shaders); enabled|disabled"},
         {"citra_use_acc_mul", "Enable accurate shaders multiplication (only for H/W shaders); enabled|disabled"},
         {"citra_texture_filter", "Texture filter type; none|Anime4K Ultrafast|Bicubic|ScaleForce|xBRZ freescale"},
         {"citra_custom_textures", "Enable custom textures; disabled|enabled"},
         {"citra_dump_textures", "Dump textures; disabled|enabled"},
+        {"citra_show_frame_counters", "Show per-frame draw, cache, shader, SVC and IPC counts; disabled|enabled"},
         {"citra_resolution_factor",
          "Resolution scale factor; 1x (Native)|2x|3x|4x|5x|6x|7x|8x|9x|10x"},
+        {"citra_dynamic_resolution",
+         "Lower the resolution while the GPU can't keep up, down to; disabled|1x|2x|3x|4x|5x"},
+        {"citra_frame_skip",
+         "Frames skipped after each rendered one while fast-forwarding; disabled|1|2|3|4|5|9"},
+        {"citra_surface_cache_budget",
+         "Texture memory limit of the surface cache; Unlimited|512 MiB|1024 MiB|2048 MiB|4096 MiB"},
+        {"citra_gpu_texture_decoding", "Decode textures in a compute shader; disabled|enabled"},
+        {"citra_track_gl_state", "Restore only the GL state the frontend uses; enabled|disabled"},
         {"citra_layout_option", "Screen layout positioning; Default Top-Bottom Screen|Single "
                                 "Screen Only|Large Screen, Small Screen|Side by Side"},
         {"citra_swap_screen", "Prominent 3DS screen; Top|Bottom"},
         {"citra_swap_screen_mode", "Swap Screen Mode; Toggle|Hold"},
         {"citra_analog_function",
          "Right analog function; C-Stick and Touchscreen Pointer|Touchscreen Pointer|C-Stick"},
+        {"citra_sync_input_to_vblank", "Sample input right before each VBlank; disabled|enabled"},
         {"citra_deadzone", "Emulated pointer deadzone (%); 15|20|25|30|35|0|5|10"},
         {"citra_mouse_touchscreen", "Simulate touchscreen interactions with mouse; enabled|disabled"},
         {"citra_touch_touchscreen", "Simulate touchscreen interactions with touchscreen; disabled|enabled"},
@@ -228,6 +247,8 @@ void UpdateSettings() {
     // For our other settings, import them from LibRetro.
     Settings::values.use_cpu_jit =
         LibRetro::FetchVariable("citra_use_cpu_jit", "enabled") == "enabled";
+    Settings::values.use_cpu_tiering =
+        LibRetro::FetchVariable("citra_use_cpu_tiering", "disabled") == "enabled";
 
     auto cpuScaling = LibRetro::FetchVariable("citra_cpu_scale", "100%");
     auto cpuScalingIndex = cpuScaling.find('%');
@@ -238,6 +259,19 @@ void UpdateSettings() {
         int scale = stoi(cpuScaling.substr(0, cpuScalingIndex));
         Settings::values.cpu_clock_percentage = scale;
     }
+    Settings::values.adaptive_cpu_clock =
+        LibRetro::FetchVariable("citra_adaptive_cpu_clock", "disabled") == "enabled";
+    Settings::values.cpu_clock_percentage_min = 50;
+    Settings::values.cpu_clock_percentage_max = 200;
+
+    const auto thread_priority = LibRetro::FetchVariable("citra_thread_priority", "normal");
+    if (thread_priority == "realtime") {
+        Settings::values.thread_priority = Common::ThreadPriority::Realtime;
+    } else if (thread_priority == "high") {
+        Settings::values.thread_priority = Common::ThreadPriority::High;
+    } else {
+        Settings::values.thread_priority = Common::ThreadPriority::Normal;
+    }
 
     Settings::values.use_hw_renderer =
         LibRetro::FetchVariable("citra_use_hw_renderer", "enabled") == "enabled";
@@ -245,6 +279,10 @@ void UpdateSettings() {
             LibRetro::FetchVariable("citra_use_hw_shaders", "enabled") == "enabled";
     Settings::values.use_shader_jit =
         LibRetro::FetchVariable("citra_use_shader_jit", "enabled") == "enabled";
+    Settings::values.share_code_pages =
+        LibRetro::FetchVariable("citra_share_code_pages", "disabled") == "enabled";
+    Settings::values.boot_snapshot =
+        LibRetro::FetchVariable("citra_boot_snapshot", "disabled") == "enabled";
     Settings::values.shaders_accurate_mul =
             LibRetro::FetchVariable("citra_use_acc_mul", "enabled") == "enabled";
     Settings::values.use_virtual_sd =
@@ -271,6 +309,16 @@ void UpdateSettings() {
     Settings::values.pp_shader_name = "none (builtin)";
     Settings::values.use_disk_shader_cache =
         LibRetro::FetchVariable("citra_use_hw_shader_cache", "enabled") == "enabled";
+    Settings::values.async_shader_compilation =
+        LibRetro::FetchVariable("citra_async_shader_compilation", "disabled") == "enabled";
+    Settings::values.fragment_ubershader =
+        LibRetro::FetchVariable("citra_fragment_ubershader", "enabled") == "enabled";
+    Settings::values.use_gpu_thread =
+        LibRetro::FetchVariable("citra_use_gpu_thread", "disabled") == "enabled";
+    Settings::values.show_frame_counters =
+        LibRetro::FetchVariable("citra_show_frame_counters", "disabled") == "enabled";
+    Settings::values.enable_dsp_hle_multithread =
+        LibRetro::FetchVariable("citra_use_dsp_hle_threads", "disabled") == "enabled";
     Settings::values.use_vsync_new = 1;
     Settings::values.render_3d = Settings::StereoRenderOption::Off;
     Settings::values.factor_3d = 0;
@@ -283,6 +331,8 @@ void UpdateSettings() {
         LibRetro::FetchVariable("citra_touch_touchscreen", "disabled") == "enabled";
     LibRetro::settings.render_touchscreen =
         LibRetro::FetchVariable("citra_render_touchscreen", "disabled") == "enabled";
+    LibRetro::settings.track_gl_state =
+        LibRetro::FetchVariable("citra_track_gl_state", "enabled") == "enabled";
 
     // These values are a bit more hard to define, unfortunately.
     auto scaling = LibRetro::FetchVariable("citra_resolution_factor", "1x (Native)");
@@ -295,6 +345,23 @@ void UpdateSettings() {
         Settings::values.resolution_factor = scale;
     }
 
+    // "disabled" does not parse and is stored as 0
+    const auto min_scale = LibRetro::FetchVariable("citra_dynamic_resolution", "disabled");
+    Settings::values.min_resolution_factor =
+        static_cast<u16>(std::strtoul(min_scale.c_str(), nullptr, 10));
+    Settings::values.dynamic_resolution = Settings::values.min_resolution_factor != 0;
+
+    // "disabled" does not parse and is stored as 0
+    const auto frame_skip = LibRetro::FetchVariable("citra_frame_skip", "disabled");
+    Settings::values.frame_skip = static_cast<u16>(std::strtoul(frame_skip.c_str(), nullptr, 10));
+
+    // "Unlimited" does not parse and is stored as 0
+    auto budget = LibRetro::FetchVariable("citra_surface_cache_budget", "Unlimited");
+    Settings::values.surface_cache_budget =
+        static_cast<u32>(std::strtoul(budget.c_str(), nullptr, 10));
+    Settings::values.gpu_texture_decoding =
+        LibRetro::FetchVariable("citra_gpu_texture_decoding", "disabled") == "enabled";
+
     auto layout = LibRetro::FetchVariable("citra_layout_option", "Default Top-Bottom Screen");
 
     if (layout == "Default Top-Bottom Screen") {
@@ -310,6 +377,9 @@ void UpdateSettings() {
         Settings::values.layout_option = Settings::LayoutOption::Default;
     }
 
+    Settings::values.sync_input_to_vblank =
+        LibRetro::FetchVariable("citra_sync_input_to_vblank", "disabled") == "enabled";
+
     auto deadzone = LibRetro::FetchVariable("citra_deadzone", "15");
     LibRetro::settings.deadzone = (float)std::stoi(deadzone) / 100;
 
@@ -497,12 +567,19 @@ void retro_run() {
     }
 
     // We can't assume that the frontend has been nice and preserved all OpenGL settings. Reset.
-    auto last_state = OpenGL::OpenGLState::GetCurState();
-    ResetGLState();
-    last_state.Apply();
+    if (LibRetro::settings.track_gl_state) {
+        SyncFrontendGLState();
+    } else {
+        auto last_state = OpenGL::OpenGLState::GetCurState();
+        ResetGLState();
+        last_state.Apply();
+    }
+
+    emu_instance->emu_window->SetFastForwarding(LibRetro::IsFastForwarding());
 
     while (!emu_instance->emu_window->HasSubmittedFrame()) {
-        auto result = Core::System::GetInstance().RunLoop();
+        auto result = Core::System::GetInstance().RunUntil(
+            [] { return emu_instance->emu_window->HasSubmittedFrame(); });
 
         if (result != Core::System::ResultStatus::Success) {
             std::string errorContent = Core::System::GetInstance().GetStatusDetails();
@@ -560,7 +637,7 @@ void context_reset() {
                   "Likely memory leak: context_destroy() was not called before context_reset()!");
     }
 
-    VideoCore::g_renderer = std::make_unique<OpenGL::RendererOpenGL>(*emu_instance->emu_window);
+    VideoCore::g_renderer = VideoCore::CreateRenderer(*emu_instance->emu_window);
     if (VideoCore::g_renderer->Init() == VideoCore::ResultStatus::Success) {
         LOG_DEBUG(Render, "initialized OK");
     } else {
@@ -633,6 +710,9 @@ bool retro_load_game(const struct retro_game_info* info) {
             return false;
         }
 
+        // Run-ahead savestates differ in size from frame to frame
+        LibRetro::SetSerializationQuirks(RETRO_SERIALIZATION_QUIRK_CORE_VARIABLE_SIZE);
+
         emu_instance->emu_window = std::make_unique<EmuWindow_LibRetro>();
         emu_instance->gl_setup = true;
     }
@@ -707,7 +787,7 @@ std::optional<std::vector<u8>> savestate = {};
 
 size_t retro_serialize_size() {
     try {
-        savestate = Core::System::GetInstance().SaveStateBuffer();
+        savestate = Core::System::GetInstance().SaveStateBuffer(LibRetro::UsesFastSavestates());
         return savestate.value().size();
     } catch (const std::exception& e) {
         LOG_ERROR(Core, "Error saving savestate: {}", e.what());
@@ -717,9 +797,16 @@ size_t retro_serialize_size() {
 }
 
 bool retro_serialize(void* data, size_t size) {
-    if(!savestate.has_value()) return false;
+    if (!savestate.has_value()) {
+        // The size is not always asked for first
+        retro_serialize_size();
+    }
+    if (!savestate.has_value() || savestate->size() > size) {
+        savestate.reset();
+        return false;
+    }
 
-    memcpy(data, (*savestate).data(), size);
+    memcpy(data, (*savestate).data(), savestate->size());
     savestate.reset();
 
     return true;
@@ -29,6 +29,8 @@ struct CoreSettings {
 
     bool toggle_swap_screen;
 
+    bool track_gl_state;
+
 } extern settings;
 
 } // namespace LibRetro
@@ -7,13 +7,106 @@
 
 #include "audio_core/audio_types.h"
 #include "citra_libretro/citra_libretro.h"
+#include "citra_libretro/core_settings.h"
 #include "citra_libretro/environment.h"
 #include "citra_libretro/input/input_factory.h"
 #include "core/3ds.h"
 #include "core/settings.h"
 #include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+/// Returns the given state with the state the frontend draws with set to what LibRetro expects.
+static OpenGL::OpenGLState MakeFrontendGLState(const OpenGL::OpenGLState& state) {
+    OpenGL::OpenGLState frontend_state = state;
+    const OpenGL::OpenGLState defaults{};
+
+    frontend_state.cull = defaults.cull;
+    frontend_state.depth = defaults.depth;
+    frontend_state.depth.test_enabled = true;
+    frontend_state.color_mask = defaults.color_mask;
+    frontend_state.stencil.test_enabled = false;
+    frontend_state.blend = defaults.blend;
+    frontend_state.logic_op = defaults.logic_op;
+    frontend_state.texture_units[0] = defaults.texture_units[0];
+    frontend_state.draw = defaults.draw;
+    frontend_state.scissor.enabled = false;
+    frontend_state.renderbuffer = defaults.renderbuffer;
+    return frontend_state;
+}
+
+void SyncFrontendGLState() {
+    // The frontend only changes the state reset by MakeFrontendGLState, so only that part of the
+    // cached state has to be issued again.
+    const OpenGL::OpenGLState state = OpenGL::OpenGLState::GetCurState();
+
+    if (state.cull.enabled) {
+        glEnable(GL_CULL_FACE);
+    } else {
+        glDisable(GL_CULL_FACE);
+    }
+    glCullFace(state.cull.mode);
+    glFrontFace(state.cull.front_face);
+
+    if (state.depth.test_enabled) {
+        glEnable(GL_DEPTH_TEST);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+    }
+    glDepthFunc(state.depth.test_func);
+    glDepthMask(state.depth.write_mask);
+
+    glColorMask(state.color_mask.red_enabled, state.color_mask.green_enabled,
+                state.color_mask.blue_enabled, state.color_mask.alpha_enabled);
+
+    if (state.stencil.test_enabled) {
+        glEnable(GL_STENCIL_TEST);
+    } else {
+        glDisable(GL_STENCIL_TEST);
+    }
 
+    if (state.blend.enabled) {
+        glEnable(GL_BLEND);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    // GLES does not support glLogicOp
+    if (!OpenGL::GLES) {
+        if (state.blend.enabled) {
+            glDisable(GL_COLOR_LOGIC_OP);
+        } else {
+            glEnable(GL_COLOR_LOGIC_OP);
+        }
+        glLogicOp(state.logic_op);
+    }
+    glBlendColor(state.blend.color.red, state.blend.color.green, state.blend.color.blue,
+                 state.blend.color.alpha);
+    glBlendFuncSeparate(state.blend.src_rgb_func, state.blend.dst_rgb_func,
+                        state.blend.src_a_func, state.blend.dst_a_func);
+    glBlendEquationSeparate(state.blend.rgb_equation, state.blend.a_equation);
+
+    glActiveTexture(OpenGL::TextureUnits::PicaTexture(0).Enum());
+    glBindTexture(GL_TEXTURE_2D, state.texture_units[0].texture_2d);
+    glBindSampler(0, state.texture_units[0].sampler);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, state.draw.read_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, state.draw.draw_framebuffer);
+    glBindVertexArray(state.draw.vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, state.draw.vertex_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, state.draw.uniform_buffer);
+    glUseProgram(state.draw.shader_program);
+    if (glBindProgramPipeline != nullptr) {
+        glBindProgramPipeline(state.draw.program_pipeline);
+    }
 
+    if (state.scissor.enabled) {
+        glEnable(GL_SCISSOR_TEST);
+    } else {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    glViewport(state.viewport.x, state.viewport.y, state.viewport.width, state.viewport.height);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, state.renderbuffer);
+}
 
 /// LibRetro expects a "default" GL state.
 void ResetGLState() {
@@ -60,20 +153,50 @@ void EmuWindow_LibRetro::SwapBuffers() {
 
     auto current_state = OpenGL::OpenGLState::GetCurState();
 
-    ResetGLState();
+    if (LibRetro::settings.track_gl_state) {
+        // Only the state that differs from what the frontend expects is changed
+        MakeFrontendGLState(current_state).Apply();
+        glActiveTexture(GL_TEXTURE0);
+    } else {
+        ResetGLState();
+    }
 
     if (enableEmulatedPointer) {
         tracker->Render(width, height);
+        if (LibRetro::settings.track_gl_state) {
+            // The tracker leaves blending disabled and its vertex buffer bound
+            glEnable(GL_BLEND);
+            glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
     }
 
     LibRetro::UploadVideoFrame(RETRO_HW_FRAME_BUFFER_VALID, static_cast<unsigned>(width),
                                static_cast<unsigned>(height), 0);
 
-    ResetGLState();
+    if (!LibRetro::settings.track_gl_state) {
+        ResetGLState();
+    }
 
     current_state.Apply();
 }
 
+void EmuWindow_LibRetro::SkipFrame() {
+    submittedFrame = true;
+
+    // Without frame data, the frontend shows the previous frame again
+    LibRetro::UploadVideoFrame(nullptr, static_cast<unsigned>(width),
+                               static_cast<unsigned>(height), 0);
+}
+
+bool EmuWindow_LibRetro::IsFastForwarding() const {
+    return fastForwarding.load(std::memory_order_relaxed);
+}
+
+void EmuWindow_LibRetro::SetFastForwarding(bool enabled) {
+    fastForwarding.store(enabled, std::memory_order_relaxed);
+}
+
 void EmuWindow_LibRetro::SetupFramebuffer() {
     // TODO: Expose interface in renderer_opengl to configure this in it's internal state
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(LibRetro::GetFramebuffer()));
@@ -182,8 +305,7 @@ void EmuWindow_LibRetro::UpdateLayout() {
 
     // Update Libretro with our status
     struct retro_system_av_info info {};
-    info.timing.fps = 60.0;
-    info.timing.sample_rate = AudioCore::native_sample_rate;
+    info.timing = LibRetro::GetSystemTiming();
     info.geometry.aspect_ratio = (float)baseX / (float)baseY;
     info.geometry.base_width = baseX;
     info.geometry.base_height = baseY;
@@ -226,6 +348,9 @@ bool EmuWindow_LibRetro::HasSubmittedFrame() {
 void EmuWindow_LibRetro::CreateContext() {
     tracker = std::make_unique<LibRetro::Input::MouseTracker>();
 
+    // Not part of OpenGLState, and nothing enables it again
+    glDisable(GL_DITHER);
+
     doCleanFrame = true;
 }
 
@@ -6,6 +6,7 @@
 
 #include <glad/glad.h>
 
+#include <atomic>
 #include <memory>
 #include <utility>
 #include "core/frontend/emu_window.h"
@@ -14,6 +15,9 @@
 
 void ResetGLState();
 
+/// Issues the cached state again for the parts of the GL state the frontend may have changed.
+void SyncFrontendGLState();
+
 class EmuWindow_LibRetro : public Frontend::EmuWindow {
 public:
     EmuWindow_LibRetro();
@@ -22,6 +26,15 @@ public:
     /// Swap buffers to display the next frame
     void SwapBuffers() override;
 
+    /// Repeats the previous frame in place of one the renderer skipped
+    void SkipFrame() override;
+
+    /// Returns what the frontend reported in the last SetFastForwarding call
+    bool IsFastForwarding() const override;
+
+    /// Sets whether the frontend is fast-forwarding, once per retro_run
+    void SetFastForwarding(bool enabled);
+
     /// Polls window events
     void PollEvents() override;
 
@@ -61,6 +74,9 @@ private:
 
     bool submittedFrame = false;
 
+    /// Read by the renderer, which may be on the GPU thread
+    std::atomic<bool> fastForwarding = false;
+
     // Hack to ensure stuff runs on the main thread
     bool doCleanFrame = false;
 
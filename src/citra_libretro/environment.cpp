@@ -4,6 +4,8 @@
 
 #include <cstring>
 
+#include "core/core_timing.h"
+#include "core/hw/gpu.h"
 #include "core/settings.h"
 #include "audio_core/audio_types.h"
 #include "audio_core/libretro_sink.h"
@@ -77,6 +79,31 @@ bool Shutdown() {
     return environ_cb(RETRO_ENVIRONMENT_SHUTDOWN, NULL);
 }
 
+bool SetSerializationQuirks(uint64_t quirks) {
+    return environ_cb(RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS, &quirks);
+}
+
+bool UsesFastSavestates() {
+    int flags = 0;
+    // Bit 2 is set when the frontend wants savestates fast rather than small
+    return environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &flags) && (flags & 4) != 0;
+}
+
+bool IsFastForwarding() {
+    bool fast_forwarding = false;
+    bool can_dupe = false;
+    return environ_cb(RETRO_ENVIRONMENT_GET_FASTFORWARDING, &fast_forwarding) && fast_forwarding &&
+           environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &can_dupe) && can_dupe;
+}
+
+retro_system_timing GetSystemTiming() {
+    retro_system_timing timing{};
+    timing.fps = GPU::SCREEN_REFRESH_RATE;
+    // The DSP outputs samples_per_frame samples every samples_per_frame * 4096 * 2 ARM11 cycles
+    timing.sample_rate = static_cast<double>(BASE_CLOCK_RATE_ARM11) / (4096 * 2);
+    return timing;
+}
+
 /// Displays the specified message to the screen.
 bool DisplayMessage(const char* sg) {
     retro_message msg;
@@ -169,9 +196,8 @@ void retro_set_input_state(retro_input_state_t cb) {
 }
 
 void retro_get_system_av_info(struct retro_system_av_info* info) {
+    info->timing = LibRetro::GetSystemTiming();
     // These are placeholders until we get control.
-    info->timing.fps = 60.0;
-    info->timing.sample_rate = AudioCore::native_sample_rate;
     info->geometry.base_width = 400;
     info->geometry.base_height = 480;
     info->geometry.max_width = 400 * 10;
@@ -57,6 +57,18 @@ bool SetFrameTimeCallback(retro_frame_time_callback* cb);
 /// Set the size of the new screen buffer.
 bool SetGeometry(retro_system_av_info* cb);
 
+/// Tells LibRetro about the limitations of our savestates.
+bool SetSerializationQuirks(uint64_t quirks);
+
+/// Returns true if the frontend asks for fast savestates, as those of run-ahead.
+bool UsesFastSavestates();
+
+/// Returns true if the frontend is fast-forwarding and accepts repeated frames in the meantime.
+bool IsFastForwarding();
+
+/// Returns the exact frame and audio sample rates of the 3DS.
+retro_system_timing GetSystemTiming();
+
 /// Tells LibRetro what input buttons are labelled on the 3DS.
 bool SetInputDescriptors(const retro_input_descriptor desc[]);
 
@@ -108,6 +108,54 @@ void EmuThread::run() {
 #endif
 }
 
+PresentThread::PresentThread(QWindow& window, QOpenGLContext& context)
+    : window(window), context(context) {}
+
+void PresentThread::SetExposed(bool exposed_) {
+    {
+        std::scoped_lock lock{mutex};
+        exposed = exposed_;
+    }
+    state_changed.notify_one();
+}
+
+void PresentThread::Stop() {
+    {
+        std::scoped_lock lock{mutex};
+        stop = true;
+    }
+    state_changed.notify_one();
+    wait();
+}
+
+void PresentThread::run() {
+    MicroProfileOnThreadCreate("PresentThread");
+    Common::SetCurrentThreadName("PresentThread");
+
+    while (true) {
+        {
+            std::unique_lock lock{mutex};
+            state_changed.wait(lock, [this] { return exposed || stop; });
+            if (stop) {
+                break;
+            }
+        }
+
+        context.makeCurrent(&window);
+        if (VideoCore::g_renderer) {
+            VideoCore::g_renderer->TryPresent(100);
+        }
+        context.swapBuffers(&window);
+    }
+
+    context.doneCurrent();
+    context.moveToThread(QCoreApplication::instance()->thread());
+
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
+}
+
 OpenGLWindow::OpenGLWindow(QWindow* parent, QWidget* event_handler, QOpenGLContext* shared_context)
     : QWindow(parent), context(std::make_unique<QOpenGLContext>(shared_context->parent())),
       event_handler(event_handler) {
@@ -124,11 +172,20 @@ OpenGLWindow::OpenGLWindow(QWindow* parent, QWidget* event_handler, QOpenGLConte
 
     setSurfaceType(QWindow::OpenGLSurface);
 
+    if (QOpenGLContext::supportsThreadedOpenGL()) {
+        present_thread = std::make_unique<PresentThread>(*this, *context);
+        context->moveToThread(present_thread.get());
+        present_thread->start();
+    }
+
     // TODO: One of these flags might be interesting: WA_OpaquePaintEvent, WA_NoBackground,
     // WA_DontShowOnScreen, WA_DeleteOnClose
 }
 
 OpenGLWindow::~OpenGLWindow() {
+    if (present_thread) {
+        present_thread->Stop();
+    }
     context->doneCurrent();
 }
 
@@ -149,7 +206,9 @@ void OpenGLWindow::Present() {
 bool OpenGLWindow::event(QEvent* event) {
     switch (event->type()) {
     case QEvent::UpdateRequest:
-        Present();
+        if (!present_thread) {
+            Present();
+        }
         return true;
     case QEvent::MouseButtonPress:
     case QEvent::MouseButtonRelease:
@@ -187,7 +246,11 @@ bool OpenGLWindow::event(QEvent* event) {
 }
 
 void OpenGLWindow::exposeEvent(QExposeEvent* event) {
-    QWindow::requestUpdate();
+    if (present_thread) {
+        present_thread->SetExposed(isExposed());
+    } else {
+        QWindow::requestUpdate();
+    }
     QWindow::exposeEvent(event);
 }
 
@@ -237,6 +300,10 @@ bool GRenderWindow::NeedsClearing() const {
     return true;
 }
 
+bool GRenderWindow::IsPresentedOnSeparateThread() const {
+    return true;
+}
+
 // On Qt 5.0+, this correctly gets the size of the framebuffer (pixels).
 //
 // Older versions get the window size (density independent pixels),
@@ -388,18 +455,34 @@ void GRenderWindow::focusOutEvent(QFocusEvent* event) {
 }
 
 void GRenderWindow::resizeEvent(QResizeEvent* event) {
-    QOpenGLWidget::resizeEvent(event);
+    QWidget::resizeEvent(event);
     NotifyClientAreaSizeChanged(std::make_pair(event->size().width(), event->size().height()));
     OnFramebufferSizeChanged();
 }
 
 void GRenderWindow::InitRenderTarget() {
-    // TODO: One of these flags might be interesting: WA_OpaquePaintEvent, WA_NoBackground,
-    // WA_DontShowOnScreen, WA_DeleteOnClose
+    ReleaseRenderTarget();
+
+    child_window = new OpenGLWindow(QWidget::window()->windowHandle(), this,
+                                    QOpenGLContext::globalShareContext());
+    child_window->create();
+    child_widget = createWindowContainer(child_window, this);
+    layout()->addWidget(child_widget);
+
     core_context = CreateSharedContext();
+    OnFramebufferSizeChanged();
     BackupGeometry();
 }
 
+void GRenderWindow::ReleaseRenderTarget() {
+    if (child_widget) {
+        layout()->removeWidget(child_widget);
+        delete child_widget;
+        child_widget = nullptr;
+        child_window = nullptr;
+    }
+}
+
 void GRenderWindow::CaptureScreenshot(u32 res_scale, const QString& screenshot_path) {
     if (res_scale == 0)
         res_scale = VideoCore::GetResolutionScaleFactor();
@@ -430,11 +513,6 @@ void GRenderWindow::OnEmulationStopping() {
     emu_thread = nullptr;
 }
 
-void GRenderWindow::paintGL() {
-    VideoCore::g_renderer->Present();
-    update();
-}
-
 void GRenderWindow::showEvent(QShowEvent* event) {
     QWidget::showEvent(event);
 
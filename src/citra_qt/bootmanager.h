@@ -125,6 +125,35 @@ signals:
     void HideLoadingScreen();
 };
 
+/**
+ * Presents the renderer's frames to a window on its own thread, so that GUI activity can't delay
+ * them. The window's context is moved to this thread while it runs.
+ */
+class PresentThread final : public QThread {
+    Q_OBJECT
+
+public:
+    PresentThread(QWindow& window, QOpenGLContext& context);
+
+    /// Sets whether the window can be drawn to. Presenting pauses while it can't.
+    void SetExposed(bool exposed);
+
+    /// Stops presenting and waits for the thread, which hands the context back to the GUI thread
+    void Stop();
+
+protected:
+    void run() override;
+
+private:
+    QWindow& window;
+    QOpenGLContext& context;
+
+    std::mutex mutex;
+    std::condition_variable state_changed;
+    bool exposed = false;
+    bool stop = false;
+};
+
 class OpenGLWindow : public QWindow {
     Q_OBJECT
 public:
@@ -132,6 +161,7 @@ public:
 
     ~OpenGLWindow();
 
+    /// Presents a frame on the GUI thread, for platforms without threaded OpenGL
     void Present();
 
 protected:
@@ -141,6 +171,9 @@ protected:
 private:
     std::unique_ptr<QOpenGLContext> context;
     QWidget* event_handler;
+    /// Presents the frames when the platform supports threaded OpenGL. Input events are still
+    /// handled on the GUI thread.
+    std::unique_ptr<PresentThread> present_thread;
 };
 
 class GRenderWindow : public QWidget, public Frontend::EmuWindow {
@@ -155,8 +188,7 @@ public:
     void DoneCurrent() override;
     void PollEvents() override;
     std::unique_ptr<Frontend::GraphicsContext> CreateSharedContext() const override;
-
-    void paintGL() override;
+    bool IsPresentedOnSeparateThread() const override;
 
     void BackupGeometry();
     void RestoreGeometry();
@@ -215,6 +247,9 @@ private:
 
     std::unique_ptr<GraphicsContext> core_context;
 
+    QWidget* child_widget = nullptr;
+    OpenGLWindow* child_window = nullptr;
+
     QByteArray geometry;
 
     EmuThread* emu_thread;
@@ -57,8 +57,9 @@ const std::array<std::array<int, 5>, Settings::NativeAnalog::NumAnalogs> Config:
 // This must be in alphabetical order according to action name as it must have the same order as
 // UISetting::values.shortcuts, which is alphabetically ordered.
 // clang-format off
-const std::array<UISettings::Shortcut, 23> default_hotkeys{
+const std::array<UISettings::Shortcut, 25> default_hotkeys{
     {{QStringLiteral("Advance Frame"),            QStringLiteral("Main Window"), {QStringLiteral("\\"), Qt::ApplicationShortcut}},
+     {QStringLiteral("Capture Profiler Trace"),   QStringLiteral("Main Window"), {QStringLiteral("Ctrl+Shift+T"), Qt::ApplicationShortcut}},
      {QStringLiteral("Capture Screenshot"),       QStringLiteral("Main Window"), {QStringLiteral("Ctrl+P"), Qt::ApplicationShortcut}},
      {QStringLiteral("Continue/Pause Emulation"), QStringLiteral("Main Window"), {QStringLiteral("F4"), Qt::WindowShortcut}},
      {QStringLiteral("Decrease Speed Limit"),     QStringLiteral("Main Window"), {QStringLiteral("-"), Qt::ApplicationShortcut}},
@@ -71,6 +72,7 @@ const std::array<UISettings::Shortcut, 23> default_hotkeys{
      {QStringLiteral("Load from Newest Slot"),    QStringLiteral("Main Window"), {QStringLiteral("Ctrl+V"), Qt::WindowShortcut}},
      {QStringLiteral("Remove Amiibo"),            QStringLiteral("Main Window"), {QStringLiteral("F3"), Qt::ApplicationShortcut}},
      {QStringLiteral("Restart Emulation"),        QStringLiteral("Main Window"), {QStringLiteral("F6"), Qt::WindowShortcut}},
+     {QStringLiteral("Rewind"),                   QStringLiteral("Main Window"), {QStringLiteral("Ctrl+R"), Qt::ApplicationShortcut}},
      {QStringLiteral("Rotate Screens Upright"),   QStringLiteral("Main Window"), {QStringLiteral("F8"), Qt::WindowShortcut}},
      {QStringLiteral("Save to Oldest Slot"),      QStringLiteral("Main Window"), {QStringLiteral("Ctrl+C"), Qt::WindowShortcut}},
      {QStringLiteral("Stop Emulation"),           QStringLiteral("Main Window"), {QStringLiteral("F5"), Qt::WindowShortcut}},
@@ -115,6 +117,8 @@ void Config::ReadAudioValues() {
         ReadSetting(QStringLiteral("output_device"), QStringLiteral("auto"))
             .toString()
             .toStdString();
+    Settings::values.audio_low_latency =
+        ReadSetting(QStringLiteral("audio_low_latency"), false).toBool();
     Settings::values.volume = ReadSetting(QStringLiteral("volume"), 1).toFloat();
     Settings::values.mic_input_type = static_cast<Settings::MicInputType>(
         ReadSetting(QStringLiteral("mic_input_type"), 0).toInt());
@@ -273,6 +277,9 @@ void Config::ReadControlValues() {
 
     Settings::LoadProfile(Settings::values.current_input_profile_index);
 
+    Settings::values.sync_input_to_vblank =
+        ReadSetting(QStringLiteral("sync_input_to_vblank"), false).toBool();
+
     qt_config->endGroup();
 }
 
@@ -292,8 +299,31 @@ void Config::ReadCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     Settings::values.use_cpu_jit = ReadSetting(QStringLiteral("use_cpu_jit"), true).toBool();
+    Settings::values.use_cpu_tiering =
+        ReadSetting(QStringLiteral("use_cpu_tiering"), false).toBool();
     Settings::values.cpu_clock_percentage =
         ReadSetting(QStringLiteral("cpu_clock_percentage"), 100).toInt();
+    Settings::values.adaptive_cpu_clock =
+        ReadSetting(QStringLiteral("adaptive_cpu_clock"), false).toBool();
+    Settings::values.cpu_clock_percentage_min =
+        ReadSetting(QStringLiteral("cpu_clock_percentage_min"), 50).toInt();
+    Settings::values.cpu_clock_percentage_max =
+        ReadSetting(QStringLiteral("cpu_clock_percentage_max"), 200).toInt();
+    Settings::values.enable_rewind = ReadSetting(QStringLiteral("enable_rewind"), false).toBool();
+    Settings::values.rewind_interval = ReadSetting(QStringLiteral("rewind_interval"), 10).toUInt();
+    Settings::values.rewind_buffer_size =
+        ReadSetting(QStringLiteral("rewind_buffer_size"), 512).toUInt();
+    Settings::values.share_code_pages =
+        ReadSetting(QStringLiteral("share_code_pages"), false).toBool();
+    Settings::values.boot_snapshot = ReadSetting(QStringLiteral("boot_snapshot"), false).toBool();
+    Settings::values.boot_snapshot_frame =
+        ReadSetting(QStringLiteral("boot_snapshot_frame"), 0).toUInt();
+    Settings::values.auto_title_profiles =
+        ReadSetting(QStringLiteral("auto_title_profiles"), false).toBool();
+    Settings::values.thread_priority = static_cast<Common::ThreadPriority>(
+        ReadSetting(QStringLiteral("thread_priority"), 0).toInt());
+    Settings::values.thread_affinity =
+        ReadSetting(QStringLiteral("thread_affinity"), QString{}).toString().toStdString();
 
     qt_config->endGroup();
 }
@@ -322,6 +352,10 @@ void Config::ReadDebuggingValues() {
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     Settings::values.record_frame_times =
         qt_config->value(QStringLiteral("record_frame_times"), false).toBool();
+    Settings::values.measure_input_latency =
+        qt_config->value(QStringLiteral("measure_input_latency"), false).toBool();
+    Settings::values.ipc_recorder_sample_rate =
+        qt_config->value(QStringLiteral("ipc_recorder_sample_rate"), 0).toUInt();
     Settings::values.use_gdbstub = ReadSetting(QStringLiteral("use_gdbstub"), false).toBool();
     Settings::values.gdbstub_port = ReadSetting(QStringLiteral("gdbstub_port"), 24689).toInt();
 
@@ -404,6 +438,8 @@ void Config::ReadMultiplayerValues() {
     UISettings::values.game_id = ReadSetting(QStringLiteral("game_id"), 0).toULongLong();
     UISettings::values.room_description =
         ReadSetting(QStringLiteral("room_description"), QString{}).toString();
+    UISettings::values.direct_connections =
+        ReadSetting(QStringLiteral("direct_connections"), false).toBool();
     // Read ban list back
     int size = qt_config->beginReadArray(QStringLiteral("username_ban_list"));
     UISettings::values.ban_list.first.resize(size);
@@ -493,11 +529,21 @@ void Config::ReadRendererValues() {
     Settings::values.use_vsync_new = ReadSetting(QStringLiteral("use_vsync_new"), true).toBool();
     Settings::values.resolution_factor =
         static_cast<u16>(ReadSetting(QStringLiteral("resolution_factor"), 1).toInt());
+    Settings::values.dynamic_resolution =
+        ReadSetting(QStringLiteral("dynamic_resolution"), false).toBool();
+    Settings::values.min_resolution_factor =
+        static_cast<u16>(ReadSetting(QStringLiteral("min_resolution_factor"), 1).toInt());
+    Settings::values.surface_cache_budget =
+        ReadSetting(QStringLiteral("surface_cache_budget"), 0).toUInt();
+    Settings::values.gpu_texture_decoding =
+        ReadSetting(QStringLiteral("gpu_texture_decoding"), false).toBool();
     Settings::values.frame_limit = ReadSetting(QStringLiteral("frame_limit"), 100).toInt();
     Settings::values.use_frame_limit_alternate =
         ReadSetting(QStringLiteral("use_frame_limit_alternate"), false).toBool();
     Settings::values.frame_limit_alternate =
         ReadSetting(QStringLiteral("frame_limit_alternate"), 200).toInt();
+    Settings::values.frame_skip =
+        static_cast<u16>(ReadSetting(QStringLiteral("frame_skip"), 0).toInt());
 
     Settings::values.bg_red = ReadSetting(QStringLiteral("bg_red"), 0.0).toFloat();
     Settings::values.bg_green = ReadSetting(QStringLiteral("bg_green"), 0.0).toFloat();
@@ -508,6 +554,9 @@ void Config::ReadRendererValues() {
             .toString()
             .toStdString();
 
+    Settings::values.show_frame_counters =
+        ReadSetting(QStringLiteral("show_frame_counters"), false).toBool();
+
     qt_config->endGroup();
 }
 
@@ -541,6 +590,8 @@ void Config::ReadSystemValues() {
             .toInt());
     Settings::values.init_time =
         ReadSetting(QStringLiteral("init_time"), 946681277ULL).toULongLong();
+    Settings::values.uds_batch_window =
+        static_cast<u16>(ReadSetting(QStringLiteral("uds_batch_window"), 2).toUInt());
 
     qt_config->endGroup();
 }
@@ -739,6 +790,7 @@ void Config::SaveAudioValues() {
                  Settings::values.enable_audio_stretching, true);
     WriteSetting(QStringLiteral("output_device"),
                  QString::fromStdString(Settings::values.audio_device_id), QStringLiteral("auto"));
+    WriteSetting(QStringLiteral("audio_low_latency"), Settings::values.audio_low_latency, false);
     WriteSetting(QStringLiteral("volume"), Settings::values.volume, 1.0f);
     WriteSetting(QStringLiteral("mic_input_device"),
                  QString::fromStdString(Settings::values.mic_input_device),
@@ -835,6 +887,9 @@ void Config::SaveControlValues() {
     }
     qt_config->endArray();
 
+    WriteSetting(QStringLiteral("sync_input_to_vblank"), Settings::values.sync_input_to_vblank,
+                 false);
+
     qt_config->endGroup();
 }
 
@@ -852,8 +907,26 @@ void Config::SaveCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     WriteSetting(QStringLiteral("use_cpu_jit"), Settings::values.use_cpu_jit, true);
+    WriteSetting(QStringLiteral("use_cpu_tiering"), Settings::values.use_cpu_tiering, false);
     WriteSetting(QStringLiteral("cpu_clock_percentage"), Settings::values.cpu_clock_percentage,
                  100);
+    WriteSetting(QStringLiteral("adaptive_cpu_clock"), Settings::values.adaptive_cpu_clock, false);
+    WriteSetting(QStringLiteral("cpu_clock_percentage_min"),
+                 Settings::values.cpu_clock_percentage_min, 50);
+    WriteSetting(QStringLiteral("cpu_clock_percentage_max"),
+                 Settings::values.cpu_clock_percentage_max, 200);
+    WriteSetting(QStringLiteral("enable_rewind"), Settings::values.enable_rewind, false);
+    WriteSetting(QStringLiteral("rewind_interval"), Settings::values.rewind_interval, 10);
+    WriteSetting(QStringLiteral("rewind_buffer_size"), Settings::values.rewind_buffer_size, 512);
+    WriteSetting(QStringLiteral("share_code_pages"), Settings::values.share_code_pages, false);
+    WriteSetting(QStringLiteral("boot_snapshot"), Settings::values.boot_snapshot, false);
+    WriteSetting(QStringLiteral("boot_snapshot_frame"), Settings::values.boot_snapshot_frame, 0);
+    WriteSetting(QStringLiteral("auto_title_profiles"), Settings::values.auto_title_profiles,
+                 false);
+    WriteSetting(QStringLiteral("thread_priority"),
+                 static_cast<int>(Settings::values.thread_priority), 0);
+    WriteSetting(QStringLiteral("thread_affinity"),
+                 QString::fromStdString(Settings::values.thread_affinity), QString{});
 
     qt_config->endGroup();
 }
@@ -877,6 +950,10 @@ void Config::SaveDebuggingValues() {
 
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     qt_config->setValue(QStringLiteral("record_frame_times"), Settings::values.record_frame_times);
+    qt_config->setValue(QStringLiteral("measure_input_latency"),
+                        Settings::values.measure_input_latency);
+    qt_config->setValue(QStringLiteral("ipc_recorder_sample_rate"),
+                        Settings::values.ipc_recorder_sample_rate);
     WriteSetting(QStringLiteral("use_gdbstub"), Settings::values.use_gdbstub, false);
     WriteSetting(QStringLiteral("gdbstub_port"), Settings::values.gdbstub_port, 24689);
 
@@ -941,6 +1018,8 @@ void Config::SaveMultiplayerValues() {
     WriteSetting(QStringLiteral("game_id"), UISettings::values.game_id, 0);
     WriteSetting(QStringLiteral("room_description"), UISettings::values.room_description,
                  QString{});
+    WriteSetting(QStringLiteral("direct_connections"), UISettings::values.direct_connections,
+                 false);
     // Write ban list
     qt_config->beginWriteArray(QStringLiteral("username_ban_list"));
     for (std::size_t i = 0; i < UISettings::values.ban_list.first.size(); ++i) {
@@ -1001,11 +1080,18 @@ void Config::SaveRendererValues() {
                  true);
     WriteSetting(QStringLiteral("use_vsync_new"), Settings::values.use_vsync_new, true);
     WriteSetting(QStringLiteral("resolution_factor"), Settings::values.resolution_factor, 1);
+    WriteSetting(QStringLiteral("dynamic_resolution"), Settings::values.dynamic_resolution, false);
+    WriteSetting(QStringLiteral("min_resolution_factor"), Settings::values.min_resolution_factor,
+                 1);
+    WriteSetting(QStringLiteral("surface_cache_budget"), Settings::values.surface_cache_budget, 0);
+    WriteSetting(QStringLiteral("gpu_texture_decoding"), Settings::values.gpu_texture_decoding,
+                 false);
     WriteSetting(QStringLiteral("frame_limit"), Settings::values.frame_limit, 100);
     WriteSetting(QStringLiteral("use_frame_limit_alternate"),
                  Settings::values.use_frame_limit_alternate, false);
     WriteSetting(QStringLiteral("frame_limit_alternate"), Settings::values.frame_limit_alternate,
                  200);
+    WriteSetting(QStringLiteral("frame_skip"), Settings::values.frame_skip, 0);
 
     // Cast to double because Qt's written float values are not human-readable
     WriteSetting(QStringLiteral("bg_red"), (double)Settings::values.bg_red, 0.0);
@@ -1016,6 +1102,9 @@ void Config::SaveRendererValues() {
                  QString::fromStdString(Settings::values.texture_filter_name),
                  QStringLiteral("none"));
 
+    WriteSetting(QStringLiteral("show_frame_counters"), Settings::values.show_frame_counters,
+                 false);
+
     qt_config->endGroup();
 }
 
@@ -1048,6 +1137,7 @@ void Config::SaveSystemValues() {
                  static_cast<u32>(Settings::InitClock::SystemTime));
     WriteSetting(QStringLiteral("init_time"),
                  static_cast<unsigned long long>(Settings::values.init_time), 946681277ULL);
+    WriteSetting(QStringLiteral("uds_batch_window"), Settings::values.uds_batch_window, 2);
 
     qt_config->endGroup();
 }
@@ -23,6 +23,9 @@ class MicroProfileWidget : public QWidget {
 public:
     MicroProfileWidget(QWidget* parent = nullptr);
 
+    /// Redraws less often while a game runs, as every redraw holds up the GUI thread
+    void SetEmulationRunning(bool running);
+
 protected:
     void paintEvent(QPaintEvent* event) override;
     void showEvent(QShowEvent* event) override;
@@ -37,9 +40,13 @@ protected:
     void keyReleaseEvent(QKeyEvent* event) override;
 
 private:
+    static constexpr int IDLE_UPDATE_INTERVAL = 15;    // ~60 Hz
+    static constexpr int RUNNING_UPDATE_INTERVAL = 50; // 20 Hz
+
     /// This timer is used to redraw the widget's contents continuously. To save resources, it only
     /// runs while the widget is visible.
     QTimer update_timer;
+    int update_interval = IDLE_UPDATE_INTERVAL;
     /// Scale the coordinate system appropriately when dpi != 96.
     qreal x_scale = 1.0, y_scale = 1.0;
 };
@@ -56,7 +63,7 @@ MicroProfileDialog::MicroProfileDialog(QWidget* parent) : QWidget(parent, Qt::Di
 
 #if MICROPROFILE_ENABLED
 
-    MicroProfileWidget* widget = new MicroProfileWidget(this);
+    widget = new MicroProfileWidget(this);
 
     QLayout* layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
@@ -71,6 +78,18 @@ MicroProfileDialog::MicroProfileDialog(QWidget* parent) : QWidget(parent, Qt::Di
 #endif
 }
 
+void MicroProfileDialog::OnEmulationStarting() {
+#if MICROPROFILE_ENABLED
+    widget->SetEmulationRunning(true);
+#endif
+}
+
+void MicroProfileDialog::OnEmulationStopping() {
+#if MICROPROFILE_ENABLED
+    widget->SetEmulationRunning(false);
+#endif
+}
+
 QAction* MicroProfileDialog::toggleViewAction() {
     if (toggle_view_action == nullptr) {
         toggle_view_action = new QAction(windowTitle(), this);
@@ -132,8 +151,13 @@ void MicroProfileWidget::paintEvent([[maybe_unused]] QPaintEvent* event) {
     mp_painter = nullptr;
 }
 
+void MicroProfileWidget::SetEmulationRunning(bool running) {
+    update_interval = running ? RUNNING_UPDATE_INTERVAL : IDLE_UPDATE_INTERVAL;
+    update_timer.setInterval(update_interval);
+}
+
 void MicroProfileWidget::showEvent(QShowEvent* event) {
-    update_timer.start(15); // ~60 Hz
+    update_timer.start(update_interval);
     QWidget::showEvent(event);
 }
 
@@ -7,6 +7,8 @@
 #include <QWidget>
 #include "common/microprofile.h"
 
+class MicroProfileWidget;
+
 class MicroProfileDialog : public QWidget {
     Q_OBJECT
 
@@ -16,10 +18,15 @@ public:
     /// Returns a QAction that can be used to toggle visibility of this dialog.
     QAction* toggleViewAction();
 
+public slots:
+    void OnEmulationStarting();
+    void OnEmulationStopping();
+
 protected:
     void showEvent(QShowEvent* event) override;
     void hideEvent(QHideEvent* event) override;
 
 private:
     QAction* toggle_view_action = nullptr;
+    MicroProfileWidget* widget = nullptr;
 };
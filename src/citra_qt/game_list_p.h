@@ -153,35 +153,20 @@ public:
     static constexpr int LongTitleRole = SortRole + 5;
 
     GameListItemPath() = default;
-    GameListItemPath(const QString& game_path, const std::vector<u8>& smdh_data, u64 program_id,
-                     u64 extdata_id) {
+    GameListItemPath(const QString& game_path, std::vector<u8> smdh_data, u64 program_id,
+                     u64 extdata_id)
+        : icon_smdh(std::move(smdh_data)) {
         setData(type(), TypeRole);
         setData(game_path, FullPathRole);
         setData(qulonglong(program_id), ProgramIdRole);
         setData(qulonglong(extdata_id), ExtdataIdRole);
 
-        if (UISettings::values.game_list_icon_size == UISettings::GameListIconSize::NoIcon) {
-            // Do not display icons
-            setData(QPixmap(), Qt::DecorationRole);
-        }
-
-        bool large =
-            UISettings::values.game_list_icon_size == UISettings::GameListIconSize::LargeIcon;
-
-        if (!Loader::IsValidSMDH(smdh_data)) {
-            // SMDH is not valid, set a default icon
-            if (UISettings::values.game_list_icon_size != UISettings::GameListIconSize::NoIcon)
-                setData(GetDefaultIcon(large), Qt::DecorationRole);
+        if (!Loader::IsValidSMDH(icon_smdh)) {
             return;
         }
 
         Loader::SMDH smdh;
-        memcpy(&smdh, smdh_data.data(), sizeof(Loader::SMDH));
-
-        // Get icon from SMDH
-        if (UISettings::values.game_list_icon_size != UISettings::GameListIconSize::NoIcon) {
-            setData(GetQPixmapFromSMDH(smdh, large), Qt::DecorationRole);
-        }
+        memcpy(&smdh, icon_smdh.data(), sizeof(Loader::SMDH));
 
         // Get title from SMDH
         setData(GetQStringShortTitleFromSMDH(smdh, Loader::SMDH::TitleLanguage::English),
@@ -227,10 +212,53 @@ public:
                 row2 += display_texts.at(row_2_id).simplified();
             }
             return QString(row1 + row2);
+        } else if (role == Qt::DecorationRole) {
+            LoadIcon();
+            return icon;
         } else {
             return GameListItem::data(role);
         }
     }
+
+    QStandardItem* clone() const override {
+        // Copies only keep the data, so the icon is loaded into them
+        QStandardItem* item = GameListItem::clone();
+        item->setData(data(Qt::DecorationRole), Qt::DecorationRole);
+        return item;
+    }
+
+private:
+    /**
+     * Icons are only converted once a view asks for them, which it does for the visible rows.
+     * This also keeps the pixmaps, which are not thread-safe, off the game list worker threads.
+     */
+    void LoadIcon() const {
+        if (icon_loaded) {
+            return;
+        }
+        icon_loaded = true;
+
+        if (UISettings::values.game_list_icon_size == UISettings::GameListIconSize::NoIcon) {
+            // Do not display icons
+            icon = QPixmap();
+        } else {
+            const bool large =
+                UISettings::values.game_list_icon_size == UISettings::GameListIconSize::LargeIcon;
+            if (Loader::IsValidSMDH(icon_smdh)) {
+                Loader::SMDH smdh;
+                memcpy(&smdh, icon_smdh.data(), sizeof(Loader::SMDH));
+                icon = GetQPixmapFromSMDH(smdh, large);
+            } else {
+                // SMDH is not valid, use a default icon
+                icon = GetDefaultIcon(large);
+            }
+        }
+        std::vector<u8>().swap(icon_smdh);
+    }
+
+    mutable std::vector<u8> icon_smdh;
+    mutable QPixmap icon;
+    mutable bool icon_loaded = false;
 };
 
 class GameListItemCompat : public GameListItem {
@@ -4,10 +4,16 @@
 
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
+#include <QDataStream>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
 #include "citra_qt/compatibility_list.h"
 #include "citra_qt/game_list.h"
 #include "citra_qt/game_list_p.h"
@@ -15,6 +21,7 @@
 #include "citra_qt/uisettings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/logging/log.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
@@ -24,6 +31,69 @@ bool HasSupportedFileExtension(const std::string& file_name) {
     const QFileInfo file = QFileInfo(QString::fromStdString(file_name));
     return GameList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
 }
+
+constexpr quint32 CacheMagic = 0x4C474354;
+// Increase when the format or what the loaders read changes
+constexpr quint32 CacheVersion = 1;
+
+QString GetCachePath() {
+    return QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir)) +
+           QStringLiteral("game_list.bin");
+}
+
+/// Returns the installed update of a title, if it can have one
+std::string GetUpdatePath(u64 program_id) {
+    if (program_id & ~0x00040000FFFFFFFF) {
+        return {};
+    }
+    return Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC,
+                                            program_id | 0x0000000E00000000);
+}
+
+/// Gets the size and modification time of a file, or -1 for both if it does not exist
+std::pair<qint64, qint64> Stat(const std::string& path) {
+    const QFileInfo info(QString::fromStdString(path));
+    if (path.empty() || !info.exists()) {
+        return {-1, -1};
+    }
+    return {info.size(), info.lastModified().toMSecsSinceEpoch()};
+}
+
+/// Opens a file with its loader. Called on the loader pool.
+GameListMetadata ReadMetadata(const std::string& physical_name, bool& encrypted) {
+    GameListMetadata metadata;
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
+    if (!loader) {
+        return metadata;
+    }
+
+    bool executable = false;
+    const auto res = loader->IsExecutable(executable);
+    encrypted = res == Loader::ResultStatus::ErrorEncrypted;
+    if (!executable && !encrypted) {
+        return metadata;
+    }
+    metadata.listed = true;
+    metadata.file_type = static_cast<int>(loader->GetFileType());
+
+    loader->ReadProgramId(metadata.program_id);
+    loader->ReadExtdataId(metadata.extdata_id);
+
+    // Look for an update icon if available
+    const std::string update_path = GetUpdatePath(metadata.program_id);
+    if (!update_path.empty() && FileUtil::Exists(update_path)) {
+        std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path);
+        if (update_loader) {
+            update_loader->ReadIcon(metadata.smdh);
+        }
+    }
+
+    if (!Loader::IsValidSMDH(metadata.smdh)) {
+        // Read the original smdh if there is no valid update smdh
+        loader->ReadIcon(metadata.smdh);
+    }
+    return metadata;
+}
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs,
@@ -32,79 +102,163 @@ GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs,
 
 GameListWorker::~GameListWorker() = default;
 
-void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
-                                             GameListDir* parent_dir) {
-    const auto callback = [this, recursion, parent_dir](u64* num_entries_out,
-                                                        const std::string& directory,
-                                                        const std::string& virtual_name) -> bool {
-        if (stop_processing) {
-            // Breaks the callback loop.
-            return false;
+void GameListWorker::LoadCache() {
+    QFile file(GetCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion) {
+        return;
+    }
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        CacheEntry entry;
+        QByteArray smdh;
+        quint64 program_id = 0;
+        quint64 extdata_id = 0;
+        qint32 file_type = 0;
+        stream >> path >> entry.size >> entry.modified >> entry.update_size >>
+            entry.update_modified >> entry.metadata.listed >> program_id >> extdata_id >>
+            file_type >> smdh;
+        entry.metadata.program_id = program_id;
+        entry.metadata.extdata_id = extdata_id;
+        entry.metadata.file_type = file_type;
+        entry.metadata.smdh.assign(smdh.begin(), smdh.end());
+        if (stream.status() == QDataStream::Ok) {
+            cache.emplace(path.toStdString(), std::move(entry));
         }
+    }
+}
 
-        const std::string physical_name = directory + DIR_SEP + virtual_name;
-        const bool is_dir = FileUtil::IsDirectory(physical_name);
-        if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader) {
-                return true;
-            }
+void GameListWorker::SaveCache() const {
+    FileUtil::CreateFullPath(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir));
+    QSaveFile file(GetCachePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(Frontend, "Could not write the game list cache");
+        return;
+    }
+    QDataStream stream(&file);
+    stream << CacheMagic << CacheVersion << static_cast<quint32>(scanned.size());
+    for (const auto& [path, entry] : scanned) {
+        const auto& smdh = entry.metadata.smdh;
+        stream << QString::fromStdString(path) << entry.size << entry.modified
+               << entry.update_size << entry.update_modified << entry.metadata.listed
+               << static_cast<quint64>(entry.metadata.program_id)
+               << static_cast<quint64>(entry.metadata.extdata_id)
+               << static_cast<qint32>(entry.metadata.file_type)
+               << QByteArray(reinterpret_cast<const char*>(smdh.data()),
+                             static_cast<int>(smdh.size()));
+    }
+    file.commit();
+}
 
-            bool executable = false;
-            const auto res = loader->IsExecutable(executable);
-            if (!executable && res != Loader::ResultStatus::ErrorEncrypted) {
-                return true;
-            }
+void GameListWorker::EmitEntry(const std::string& physical_name, const GameListMetadata& metadata,
+                               GameListDir* parent_dir) {
+    if (!Loader::IsValidSMDH(metadata.smdh) && UISettings::values.game_list_hide_no_icon) {
+        // Skip this invalid entry
+        return;
+    }
+
+    auto it = FindMatchingCompatibilityEntry(compatibility_list, metadata.program_id);
+
+    // The game list uses this as compatibility number for untested games
+    QString compatibility(QStringLiteral("99"));
+    if (it != compatibility_list.end())
+        compatibility = it->second.first;
+
+    emit EntryReady(
+        {
+            new GameListItemPath(QString::fromStdString(physical_name), metadata.smdh,
+                                 metadata.program_id, metadata.extdata_id),
+            new GameListItemCompat(compatibility),
+            new GameListItemRegion(metadata.smdh),
+            new GameListItem(QString::fromStdString(
+                Loader::GetFileTypeString(static_cast<Loader::FileType>(metadata.file_type)))),
+            new GameListItemSize(FileUtil::GetSize(physical_name)),
+        },
+        parent_dir);
+}
 
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh;
-            // Look for an update icon if available
-            if (!(program_id & ~0x00040000FFFFFFFF)) {
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id | 0x0000000E00000000);
-                if (FileUtil::Exists(update_path)) {
-                    std::unique_ptr<Loader::AppLoader> update_loader =
-                        Loader::GetLoader(update_path);
-                    if (update_loader) {
-                        update_loader->ReadIcon(smdh);
-                    }
+void GameListWorker::AddFilesToGameList(const std::vector<std::string>& file_paths,
+                                        GameListDir* parent_dir) {
+    struct PendingFile {
+        const std::string* path;
+        CacheEntry entry;
+        bool encrypted = false;
+        QFuture<void> future;
+    };
+    std::vector<PendingFile> pending;
+    pending.reserve(file_paths.size());
+
+    for (const std::string& path : file_paths) {
+        CacheEntry entry;
+        std::tie(entry.size, entry.modified) = Stat(path);
+
+        const auto cached = cache.find(path);
+        if (cached != cache.end() && cached->second.size == entry.size &&
+            cached->second.modified == entry.modified) {
+            const auto [update_size, update_modified] =
+                Stat(GetUpdatePath(cached->second.metadata.program_id));
+            if (cached->second.update_size == update_size &&
+                cached->second.update_modified == update_modified) {
+                if (cached->second.metadata.listed) {
+                    EmitEntry(path, cached->second.metadata, parent_dir);
                 }
+                scanned.insert_or_assign(path, std::move(cached->second));
+                cache.erase(cached);
+                continue;
             }
+        }
+        pending.push_back({&path, std::move(entry)});
+    }
 
-            if (!Loader::IsValidSMDH(smdh)) {
-                // Read the original smdh if there is no valid update smdh
-                loader->ReadIcon(smdh);
-            }
+    // The futures keep pointers into the vector, so it must not grow past this point
+    for (PendingFile& file : pending) {
+        file.future = QtConcurrent::run(&loader_pool, [&file] {
+            file.entry.metadata = ReadMetadata(*file.path, file.encrypted);
+        });
+    }
 
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
-                // Skip this invalid entry
-                return true;
-            }
+    // Entries are emitted in order, while the rest of the files are read in the background
+    for (PendingFile& file : pending) {
+        file.future.waitForFinished();
+        if (stop_processing) {
+            continue;
+        }
+        const std::string& path = *file.path;
+        if (file.entry.metadata.listed) {
+            EmitEntry(path, file.entry.metadata, parent_dir);
+        }
+        // Encrypted files are read again in case the keys have been added since
+        if (!file.encrypted) {
+            std::tie(file.entry.update_size, file.entry.update_modified) =
+                Stat(GetUpdatePath(file.entry.metadata.program_id));
+            scanned.insert_or_assign(path, std::move(file.entry));
+        }
+    }
+}
 
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility(QStringLiteral("99"));
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
+void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
+                                             GameListDir* parent_dir) {
+    std::vector<std::string> file_paths;
+    const auto callback = [this, recursion, parent_dir,
+                           &file_paths](u64* num_entries_out, const std::string& directory,
+                                        const std::string& virtual_name) -> bool {
+        if (stop_processing) {
+            // Breaks the callback loop.
+            return false;
+        }
 
+        const std::string physical_name = directory + DIR_SEP + virtual_name;
+        const bool is_dir = FileUtil::IsDirectory(physical_name);
+        if (!is_dir && HasSupportedFileExtension(physical_name)) {
+            file_paths.push_back(physical_name);
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
             AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir);
@@ -114,10 +268,12 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     };
 
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+    AddFilesToGameList(file_paths, parent_dir);
 }
 
 void GameListWorker::run() {
     stop_processing = false;
+    LoadCache();
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == QStringLiteral("INSTALLED")) {
             QString games_path =
@@ -154,6 +310,10 @@ void GameListWorker::run() {
         }
     }
 
+    // Only a complete scan knows which entries are still in use
+    if (!stop_processing) {
+        SaveCache();
+    }
     emit Finished(watch_list);
 }
 
@@ -9,16 +9,28 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QString>
+#include <QThreadPool>
 #include <QVector>
 #include "citra_qt/compatibility_list.h"
 #include "common/common_types.h"
 
 class QStandardItem;
 
+/// What the game list shows of a file, as read by its loader
+struct GameListMetadata {
+    /// False for files that are not listed, so that they are not opened again
+    bool listed = false;
+    u64 program_id = 0;
+    u64 extdata_id = 0;
+    int file_type = 0;
+    std::vector<u8> smdh;
+};
+
 /**
  * Asynchronous worker object for populating the game list.
  * Communicates with other threads through Qt's signal/slot system.
@@ -53,12 +65,34 @@ signals:
     void Finished(QStringList watch_list);
 
 private:
+    struct CacheEntry {
+        qint64 size = 0;
+        qint64 modified = 0;
+        /// Size and modification time of the installed update, whose icon is preferred
+        qint64 update_size = -1;
+        qint64 update_modified = -1;
+        GameListMetadata metadata;
+    };
+
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                  GameListDir* parent_dir);
+    /// Emits the entries of the files, reading the ones that are not cached on the thread pool
+    void AddFilesToGameList(const std::vector<std::string>& file_paths, GameListDir* parent_dir);
+    void EmitEntry(const std::string& physical_name, const GameListMetadata& metadata,
+                   GameListDir* parent_dir);
+
+    void LoadCache();
+    void SaveCache() const;
 
     QVector<UISettings::GameDir>& game_dirs;
     const CompatibilityList& compatibility_list;
 
+    /// Metadata cache keyed by file path, loaded from and saved to the cache directory
+    std::unordered_map<std::string, CacheEntry> cache;
+    /// The cache entries of the files found by this scan, which replace the cache once it is done
+    std::unordered_map<std::string, CacheEntry> scanned;
+    QThreadPool loader_pool;
+
     QStringList watch_list;
     std::atomic_bool stop_processing;
 };
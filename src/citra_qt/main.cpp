@@ -66,6 +66,7 @@
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
 #include "common/microprofile.h"
+#include "common/microprofile_trace.h"
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
 #ifdef ARCHITECTURE_x86_64
@@ -175,6 +176,9 @@ GMainWindow::GMainWindow()
     discord_rpc->Update();
 
     Network::Init();
+    if (auto member = Network::GetRoomMember().lock()) {
+        member->SetDirectConnectionsEnabled(UISettings::values.direct_connections);
+    }
 
     Core::Movie::GetInstance().SetPlaybackCompletionCallback([this] {
         QMetaObject::invokeMethod(this, "OnMoviePlaybackCompleted", Qt::BlockingQueuedConnection);
@@ -300,7 +304,8 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label = new QLabel();
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
-           "full-speed emulation this should be at most 16.67 ms."));
+           "full-speed emulation this should be at most 16.67 ms. The slowest 1% of the frames "
+           "took at least the p99 time, which shows stutter."));
 
     for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label}) {
         label->setVisible(false);
@@ -332,6 +337,10 @@ void GMainWindow::InitializeDebugWidgets() {
     microProfileDialog = new MicroProfileDialog(this);
     microProfileDialog->hide();
     debug_menu->addAction(microProfileDialog->toggleViewAction());
+    connect(this, &GMainWindow::EmulationStarting, microProfileDialog,
+            &MicroProfileDialog::OnEmulationStarting);
+    connect(this, &GMainWindow::EmulationStopping, microProfileDialog,
+            &MicroProfileDialog::OnEmulationStopping);
 #endif
 
     registersWidget = new RegistersWidget(this);
@@ -447,6 +456,11 @@ void GMainWindow::InitializeSaveStateMenuActions() {
     connect(ui->menu_Save_State->menuAction(), &QAction::hovered, this,
             &GMainWindow::UpdateSaveStates);
 
+    // Save states are written in the background
+    Core::System::GetInstance().SetSaveStateCallback([this](u32, const std::string&) {
+        QMetaObject::invokeMethod(this, "UpdateSaveStates", Qt::QueuedConnection);
+    });
+
     UpdateSaveStates();
 }
 
@@ -591,10 +605,27 @@ void GMainWindow::InitializeHotkeys() {
                     OnCaptureScreenshot();
                 }
             });
+    connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Capture Profiler Trace"), this),
+            &QShortcut::activated, this, [&] {
+                const std::string path = Common::Profiling::GetDefaultTracePath();
+                if (emulation_running && Common::Profiling::StartTraceCapture(
+                                             path, Common::Profiling::DefaultTraceFrameCount)) {
+                    statusBar()->showMessage(
+                        tr("Capturing a profiler trace to %1").arg(QString::fromStdString(path)),
+                        5000);
+                }
+            });
     connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Load from Newest Slot"), this),
             &QShortcut::activated, ui->action_Load_from_Newest_Slot, &QAction::trigger);
     connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Save to Oldest Slot"), this),
             &QShortcut::activated, ui->action_Save_to_Oldest_Slot, &QAction::trigger);
+    connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Rewind"), this),
+            &QShortcut::activated, this, [&] {
+                if (emulation_running) {
+                    Core::System::GetInstance().SendSignal(Core::System::Signal::Rewind);
+                    Core::System::GetInstance().frame_limiter.AdvanceFrame();
+                }
+            });
 }
 
 void GMainWindow::ShowUpdaterWidgets() {
@@ -2078,7 +2109,10 @@ void GMainWindow::UpdateStatusBar() {
                                      .arg(Settings::values.frame_limit));
     }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
-    emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    emu_frametime_label->setText(
+        tr("Frame: %1 ms (p99: %2 ms)")
+            .arg(results.frametime * 1000.0, 0, 'f', 2)
+            .arg(results.frametime_percentiles.p99 * 1000.0, 0, 'f', 2));
 
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
@@ -2403,7 +2437,8 @@ void GMainWindow::RetranslateStatusBar() {
                                   "This will vary from game to game and scene to scene."));
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
-           "full-speed emulation this should be at most 16.67 ms."));
+           "full-speed emulation this should be at most 16.67 ms. The slowest 1% of the frames "
+           "took at least the p99 time, which shows stutter."));
 
     multiplayer_state->retranslateUi();
 }
@@ -155,8 +155,6 @@ private:
      */
     void UpdateRecentFiles();
 
-    void UpdateSaveStates();
-
     /**
      * If the emulation is running,
      * asks the user if he really want to close the emulator
@@ -168,6 +166,7 @@ private:
     void closeEvent(QCloseEvent* event) override;
 
 private slots:
+    void UpdateSaveStates();
     void OnStartGame();
     void OnPauseGame();
     void OnStopGame();
@@ -124,6 +124,7 @@ struct Values {
     uint host_type;
     qulonglong game_id;
     QString room_description;
+    bool direct_connections;
     std::pair<std::vector<std::string>, std::vector<std::string>> ban_list;
 
     // logging
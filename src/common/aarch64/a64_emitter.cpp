@@ -0,0 +1,555 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <optional>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#ifdef __APPLE__
+#include <libkern/OSCacheControl.h>
+#include <pthread.h>
+#endif
+#include "common/aarch64/a64_emitter.h"
+#include "common/assert.h"
+
+namespace Common::A64 {
+
+namespace {
+
+bool IsMask(u64 value) {
+    return value != 0 && ((value + 1) & value) == 0;
+}
+
+bool IsShiftedMask(u64 value) {
+    return value != 0 && IsMask((value - 1) | value);
+}
+
+u32 CountTrailingZeros(u64 value) {
+    u32 count = 0;
+    while (count < 64 && ((value >> count) & 1) == 0) {
+        ++count;
+    }
+    return count;
+}
+
+u32 CountTrailingOnes(u64 value) {
+    return CountTrailingZeros(~value);
+}
+
+u32 CountLeadingOnes(u64 value) {
+    u32 count = 0;
+    while (count < 64 && ((value >> (63 - count)) & 1) != 0) {
+        ++count;
+    }
+    return count;
+}
+
+/// Encodes imm as the N:immr:imms fields of a logical instruction, if it is a valid bitmask
+std::optional<u32> EncodeLogicalImmediate(u64 imm, u32 reg_size) {
+    if (imm == 0 || imm == (~0ULL >> (64 - reg_size)) || (reg_size < 64 && imm >> reg_size != 0)) {
+        return std::nullopt;
+    }
+
+    // Find the smallest element size the value is a repetition of
+    u32 element_size = reg_size;
+    do {
+        element_size /= 2;
+        const u64 mask = (1ULL << element_size) - 1;
+        if ((imm & mask) != ((imm >> element_size) & mask)) {
+            element_size *= 2;
+            break;
+        }
+    } while (element_size > 2);
+
+    // Find the rotation that turns the element into a run of trailing ones
+    const u64 mask = ~0ULL >> (64 - element_size);
+    imm &= mask;
+    u32 rotation;
+    u32 ones;
+    if (IsShiftedMask(imm)) {
+        rotation = CountTrailingZeros(imm);
+        ones = CountTrailingOnes(imm >> rotation);
+    } else {
+        imm |= ~mask;
+        if (!IsShiftedMask(~imm)) {
+            return std::nullopt;
+        }
+        const u32 leading_ones = CountLeadingOnes(imm);
+        rotation = 64 - leading_ones;
+        ones = leading_ones + CountTrailingOnes(imm) - (64 - element_size);
+    }
+
+    const u32 immr = (element_size - rotation) & (element_size - 1);
+    const u32 imms = ((~(element_size - 1) << 1) | (ones - 1)) & 0x7f;
+    const u32 n = ((imms >> 6) & 1) ^ 1;
+    return (n << 12) | (immr << 6) | (imms & 0x3f);
+}
+
+/// Encodes imm as the imm8 field of the floating point move instructions
+u32 EncodeFloatImmediate(float imm) {
+    u32 bits;
+    std::memcpy(&bits, &imm, sizeof(bits));
+    const u32 exponent = (bits >> 23) & 0xff;
+    ASSERT_MSG((bits & 0x7ffff) == 0 && exponent >= 124 && exponent <= 131,
+               "Float immediate is not encodable");
+    return ((bits >> 31) << 7) | ((exponent < 128 ? 1 : 0) << 6) | ((exponent & 3) << 4) |
+           ((bits >> 19) & 0xf);
+}
+
+constexpr u32 LaneImm5(u32 lane) {
+    return (lane << 3) | 4;
+}
+
+} // Anonymous namespace
+
+CodeGenerator::CodeGenerator(std::size_t max_size) : max_size{max_size} {
+#ifdef _WIN32
+    code = static_cast<u8*>(VirtualAlloc(nullptr, max_size, MEM_COMMIT, PAGE_READWRITE));
+    ASSERT_MSG(code != nullptr, "Failed to allocate JIT code memory");
+#elif defined(__APPLE__)
+    void* memory = mmap(nullptr, max_size, PROT_READ | PROT_WRITE | PROT_EXEC,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_JIT, -1, 0);
+    ASSERT_MSG(memory != MAP_FAILED, "Failed to allocate JIT code memory");
+    code = static_cast<u8*>(memory);
+    pthread_jit_write_protect_np(false);
+#else
+    void* memory =
+        mmap(nullptr, max_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_MSG(memory != MAP_FAILED, "Failed to allocate JIT code memory");
+    code = static_cast<u8*>(memory);
+#endif
+}
+
+CodeGenerator::~CodeGenerator() {
+#ifdef _WIN32
+    VirtualFree(code, 0, MEM_RELEASE);
+#else
+    munmap(code, max_size);
+#endif
+}
+
+void CodeGenerator::Ready() {
+#ifdef _WIN32
+    DWORD old_protect;
+    VirtualProtect(code, max_size, PAGE_EXECUTE_READ, &old_protect);
+    FlushInstructionCache(GetCurrentProcess(), code, size);
+#elif defined(__APPLE__)
+    pthread_jit_write_protect_np(true);
+    sys_icache_invalidate(code, size);
+#else
+    mprotect(code, max_size, PROT_READ | PROT_EXEC);
+    __builtin___clear_cache(reinterpret_cast<char*>(code), reinterpret_cast<char*>(code + size));
+#endif
+}
+
+void CodeGenerator::L(Label& label) {
+    ASSERT_MSG(label.address == nullptr, "Label bound twice");
+    label.address = GetCurr();
+    for (const auto& [offset, type] : label.fixups) {
+        Patch(offset, type, label.address);
+    }
+    label.fixups.clear();
+}
+
+void CodeGenerator::Align(std::size_t alignment) {
+    while (size % alignment != 0) {
+        ASSERT_MSG(size < max_size, "JIT code buffer overflow");
+        code[size++] = 0;
+    }
+}
+
+void CodeGenerator::DW(u32 data) {
+    Emit(data);
+}
+
+void CodeGenerator::Emit(u32 instruction) {
+    ASSERT_MSG(size % 4 == 0 && size + 4 <= max_size, "JIT code buffer overflow");
+    std::memcpy(code + size, &instruction, sizeof(instruction));
+    size += sizeof(instruction);
+}
+
+void CodeGenerator::EmitBranch(Label& label, Label::FixupType type, u32 instruction) {
+    const std::size_t offset = size;
+    Emit(instruction);
+    if (label.address != nullptr) {
+        Patch(offset, type, label.address);
+    } else {
+        label.fixups.emplace_back(offset, type);
+    }
+}
+
+void CodeGenerator::Patch(std::size_t offset, Label::FixupType type, const u8* target) {
+    const std::ptrdiff_t distance = (target - (code + offset)) / 4;
+    u32 instruction;
+    std::memcpy(&instruction, code + offset, sizeof(instruction));
+    switch (type) {
+    case Label::FixupType::Branch26:
+        ASSERT_MSG(distance >= -(1 << 25) && distance < (1 << 25), "Branch out of range");
+        instruction |= static_cast<u32>(distance) & 0x3ffffff;
+        break;
+    case Label::FixupType::Branch19:
+        ASSERT_MSG(distance >= -(1 << 18) && distance < (1 << 18), "Branch out of range");
+        instruction |= (static_cast<u32>(distance) & 0x7ffff) << 5;
+        break;
+    }
+    std::memcpy(code + offset, &instruction, sizeof(instruction));
+}
+
+void CodeGenerator::AddSubImmediate(u32 opcode, u32 d, u32 n, u32 imm) {
+    if (imm < 0x1000) {
+        Emit(opcode | (imm << 10) | (n << 5) | d);
+    } else {
+        ASSERT_MSG((imm & 0xfff) == 0 && imm < 0x1000000, "Immediate is not encodable");
+        Emit(opcode | (1 << 22) | ((imm >> 12) << 10) | (n << 5) | d);
+    }
+}
+
+void CodeGenerator::LogicalImmediate(u32 opcode, u32 d, u32 n, u32 imm) {
+    const auto encoded = EncodeLogicalImmediate(imm, 32);
+    ASSERT_MSG(encoded, "Logical immediate is not encodable");
+    Emit(opcode | (*encoded << 10) | (n << 5) | d);
+}
+
+void CodeGenerator::LoadStore(u32 opcode, u32 t, u32 n, u32 offset, u32 scale) {
+    ASSERT_MSG(offset % scale == 0 && offset / scale < 0x1000, "Load/store offset out of range");
+    Emit(opcode | ((offset / scale) << 10) | (n << 5) | t);
+}
+
+void CodeGenerator::LoadStorePair(u32 opcode, u32 t1, u32 t2, u32 n, s32 offset,
+                                  IndexMode mode) {
+    ASSERT_MSG(offset % 8 == 0 && offset >= -512 && offset < 512,
+               "Load/store pair offset out of range");
+    static constexpr u32 mode_bits[] = {0x01000000, 0x01800000, 0x00800000};
+    Emit(opcode | mode_bits[static_cast<int>(mode)] | ((static_cast<u32>(offset / 8) & 0x7f) << 15) |
+         (t2 << 10) | (n << 5) | t1);
+}
+
+void CodeGenerator::mov(XReg d, u64 imm) {
+    if (imm == 0) {
+        Emit(0xd2800000 | d.index);
+        return;
+    }
+    bool first = true;
+    for (u32 hw = 0; hw < 4; ++hw) {
+        const u32 chunk = static_cast<u32>(imm >> (hw * 16)) & 0xffff;
+        if (chunk == 0) {
+            continue;
+        }
+        Emit((first ? 0xd2800000 : 0xf2800000) | (hw << 21) | (chunk << 5) | d.index);
+        first = false;
+    }
+}
+
+void CodeGenerator::mov(WReg d, u32 imm) {
+    const u32 low = imm & 0xffff;
+    const u32 high = imm >> 16;
+    if (high == 0 || low != 0) {
+        Emit(0x52800000 | (low << 5) | d.index);
+        if (high != 0) {
+            Emit(0x72800000 | (1 << 21) | (high << 5) | d.index);
+        }
+    } else {
+        Emit(0x52800000 | (1 << 21) | (high << 5) | d.index);
+    }
+}
+
+void CodeGenerator::mov(XReg d, XReg n) {
+    add(d, n, 0);
+}
+
+void CodeGenerator::add(XReg d, XReg n, u32 imm) {
+    AddSubImmediate(0x91000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::add(WReg d, WReg n, u32 imm) {
+    AddSubImmediate(0x11000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::add(XReg d, XReg n, XReg m) {
+    Emit(0x8b000000 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::sub(XReg d, XReg n, u32 imm) {
+    AddSubImmediate(0xd1000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::sub(WReg d, WReg n, u32 imm) {
+    AddSubImmediate(0x51000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::subs(WReg d, WReg n, u32 imm) {
+    AddSubImmediate(0x71000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::cmp(WReg n, u32 imm) {
+    subs(WZR, n, imm);
+}
+
+void CodeGenerator::and_(WReg d, WReg n, WReg m) {
+    Emit(0x0a000000 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::orr(WReg d, WReg n, WReg m) {
+    Emit(0x2a000000 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::and_(WReg d, WReg n, u32 imm) {
+    LogicalImmediate(0x12000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::orr(WReg d, WReg n, u32 imm) {
+    LogicalImmediate(0x32000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::eor(WReg d, WReg n, u32 imm) {
+    LogicalImmediate(0x52000000, d.index, n.index, imm);
+}
+
+void CodeGenerator::lsl(XReg d, XReg n, u32 shift) {
+    ASSERT(shift > 0 && shift < 64);
+    Emit(0xd3400000 | (((64 - shift) & 63) << 16) | ((63 - shift) << 10) | (n.index << 5) |
+         d.index);
+}
+
+void CodeGenerator::lsr(WReg d, WReg n, u32 shift) {
+    ASSERT(shift < 32);
+    Emit(0x53000000 | (shift << 16) | (31 << 10) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::asr(XReg d, XReg n, u32 shift) {
+    ASSERT(shift < 64);
+    Emit(0x93400000 | (shift << 16) | (63 << 10) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::asr(WReg d, WReg n, u32 shift) {
+    ASSERT(shift < 32);
+    Emit(0x13000000 | (shift << 16) | (31 << 10) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::ldr(XReg t, XReg n, u32 offset) {
+    LoadStore(0xf9400000, t.index, n.index, offset, 8);
+}
+
+void CodeGenerator::ldr(WReg t, XReg n, u32 offset) {
+    LoadStore(0xb9400000, t.index, n.index, offset, 4);
+}
+
+void CodeGenerator::ldr(QReg t, XReg n, u32 offset) {
+    LoadStore(0x3dc00000, t.index, n.index, offset, 16);
+}
+
+void CodeGenerator::ldrb(WReg t, XReg n, u32 offset) {
+    LoadStore(0x39400000, t.index, n.index, offset, 1);
+}
+
+void CodeGenerator::str(XReg t, XReg n, u32 offset) {
+    LoadStore(0xf9000000, t.index, n.index, offset, 8);
+}
+
+void CodeGenerator::str(WReg t, XReg n, u32 offset) {
+    LoadStore(0xb9000000, t.index, n.index, offset, 4);
+}
+
+void CodeGenerator::str(QReg t, XReg n, u32 offset) {
+    LoadStore(0x3d800000, t.index, n.index, offset, 16);
+}
+
+void CodeGenerator::strb(WReg t, XReg n, u32 offset) {
+    LoadStore(0x39000000, t.index, n.index, offset, 1);
+}
+
+void CodeGenerator::ldr(SReg t, Label& label) {
+    EmitBranch(label, Label::FixupType::Branch19, 0x1c000000 | t.index);
+}
+
+void CodeGenerator::ldp(XReg t1, XReg t2, XReg n, s32 offset, IndexMode mode) {
+    LoadStorePair(0xa8400000, t1.index, t2.index, n.index, offset, mode);
+}
+
+void CodeGenerator::stp(XReg t1, XReg t2, XReg n, s32 offset, IndexMode mode) {
+    LoadStorePair(0xa8000000, t1.index, t2.index, n.index, offset, mode);
+}
+
+void CodeGenerator::b(Label& label) {
+    EmitBranch(label, Label::FixupType::Branch26, 0x14000000);
+}
+
+void CodeGenerator::b(Cond cond, Label& label) {
+    EmitBranch(label, Label::FixupType::Branch19, 0x54000000 | static_cast<u32>(cond));
+}
+
+void CodeGenerator::bl(Label& label) {
+    EmitBranch(label, Label::FixupType::Branch26, 0x94000000);
+}
+
+void CodeGenerator::cbz(WReg t, Label& label) {
+    EmitBranch(label, Label::FixupType::Branch19, 0x34000000 | t.index);
+}
+
+void CodeGenerator::cbnz(WReg t, Label& label) {
+    EmitBranch(label, Label::FixupType::Branch19, 0x35000000 | t.index);
+}
+
+void CodeGenerator::cbnz(XReg t, Label& label) {
+    EmitBranch(label, Label::FixupType::Branch19, 0xb5000000 | t.index);
+}
+
+void CodeGenerator::br(XReg n) {
+    Emit(0xd61f0000 | (n.index << 5));
+}
+
+void CodeGenerator::blr(XReg n) {
+    Emit(0xd63f0000 | (n.index << 5));
+}
+
+void CodeGenerator::ret() {
+    Emit(0xd65f03c0);
+}
+
+void CodeGenerator::smov(XReg d, VElem n) {
+    Emit(0x4e002c00 | (LaneImm5(n.lane) << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::umov(WReg d, VElem n) {
+    Emit(0x0e003c00 | (LaneImm5(n.lane) << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmov(SReg d, WReg n) {
+    Emit(0x1e270000 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmov(WReg d, SReg n) {
+    Emit(0x1e260000 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::dup(VReg d, VElem n) {
+    Emit(0x4e000400 | (LaneImm5(n.lane) << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::dup(VReg d, WReg n) {
+    Emit(0x4e000c00 | (LaneImm5(0) << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::ins(VElem d, VElem n) {
+    Emit(0x6e000400 | (LaneImm5(d.lane) << 16) | ((n.lane << 2) << 11) | (n.index << 5) |
+         d.index);
+}
+
+void CodeGenerator::ins(VElem d, WReg n) {
+    Emit(0x4e001c00 | (LaneImm5(d.lane) << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fcvtzs(VReg d, VReg n) {
+    Emit(0x4ea1b800 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fcvtns(WReg d, SReg n) {
+    Emit(0x1e200000 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::scvtf(SReg d, WReg n) {
+    Emit(0x1e220000 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fadd(VReg d, VReg n, VReg m) {
+    Emit(0x4e20d400 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmul(VReg d, VReg n, VReg m) {
+    Emit(0x6e20dc00 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmulx(VReg d, VReg n, VReg m) {
+    Emit(0x4e20dc00 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::faddp(VReg d, VReg n, VReg m) {
+    Emit(0x6e20d400 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fcmeq(VReg d, VReg n, VReg m) {
+    Emit(0x4e20e400 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fcmge(VReg d, VReg n, VReg m) {
+    Emit(0x6e20e400 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fcmgt(VReg d, VReg n, VReg m) {
+    Emit(0x6ea0e400 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fneg(VReg d, VReg n) {
+    Emit(0x6ea0f800 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::frintm(VReg d, VReg n) {
+    Emit(0x4e219800 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmov(VReg d, float imm) {
+    const u32 imm8 = EncodeFloatImmediate(imm);
+    Emit(0x4f00f400 | ((imm8 >> 5) << 16) | ((imm8 & 0x1f) << 5) | d.index);
+}
+
+void CodeGenerator::and_(VReg d, VReg n, VReg m) {
+    Emit(0x4e201c00 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::orr(VReg d, VReg n, VReg m) {
+    Emit(0x4ea01c00 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::orn(VReg d, VReg n, VReg m) {
+    Emit(0x4ee01c00 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::bsl(VReg d, VReg n, VReg m) {
+    Emit(0x6e601c00 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::mvn(VReg d, VReg n) {
+    Emit(0x6e205800 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fadd(SReg d, SReg n, SReg m) {
+    Emit(0x1e202800 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fsub(SReg d, SReg n, SReg m) {
+    Emit(0x1e203800 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmul(SReg d, SReg n, SReg m) {
+    Emit(0x1e200800 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fdiv(SReg d, SReg n, SReg m) {
+    Emit(0x1e201800 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmin(SReg d, SReg n, SReg m) {
+    Emit(0x1e205800 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fmax(SReg d, SReg n, SReg m) {
+    Emit(0x1e204800 | (m.index << 16) | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fsqrt(SReg d, SReg n) {
+    Emit(0x1e21c000 | (n.index << 5) | d.index);
+}
+
+void CodeGenerator::fcmp(SReg n) {
+    Emit(0x1e202008 | (n.index << 5));
+}
+
+void CodeGenerator::fmov(SReg d, float imm) {
+    Emit(0x1e201000 | (EncodeFloatImmediate(imm) << 13) | d.index);
+}
+
+} // namespace Common::A64
@@ -0,0 +1,245 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common::A64 {
+
+/// 64-bit general purpose register. Index 31 is SP or XZR depending on the instruction.
+struct XReg {
+    u32 index;
+};
+
+/// 32-bit view of a general purpose register. Index 31 is WZR.
+struct WReg {
+    u32 index;
+};
+
+/// Single precision scalar view of a SIMD register
+struct SReg {
+    u32 index;
+};
+
+/// 128-bit view of a SIMD register, used by loads and stores
+struct QReg {
+    u32 index;
+};
+
+/// 32-bit lane of a SIMD register
+struct VElem {
+    u32 index;
+    u32 lane;
+};
+
+/// SIMD register. Vector instructions operate on it as four single precision lanes (4S).
+struct VReg {
+    u32 index;
+
+    constexpr SReg S() const {
+        return {index};
+    }
+    constexpr QReg Q() const {
+        return {index};
+    }
+    constexpr VElem operator[](u32 lane) const {
+        return {index, lane};
+    }
+};
+
+// clang-format off
+constexpr XReg X0{0}, X1{1}, X2{2}, X3{3}, X4{4}, X5{5}, X6{6}, X7{7}, X8{8}, X9{9}, X10{10},
+    X11{11}, X12{12}, X13{13}, X14{14}, X15{15}, X16{16}, X17{17}, X18{18}, X19{19}, X20{20},
+    X21{21}, X22{22}, X23{23}, X24{24}, X25{25}, X26{26}, X27{27}, X28{28}, X29{29}, X30{30},
+    SP{31}, XZR{31};
+constexpr WReg W0{0}, W1{1}, W2{2}, W3{3}, W4{4}, W5{5}, W6{6}, W7{7}, W8{8}, W9{9}, W10{10},
+    W11{11}, W12{12}, W13{13}, W14{14}, W15{15}, W16{16}, W17{17}, W18{18}, W19{19}, W20{20},
+    W21{21}, W22{22}, W23{23}, W24{24}, W25{25}, W26{26}, W27{27}, W28{28}, W29{29}, W30{30},
+    WZR{31};
+constexpr VReg V0{0}, V1{1}, V2{2}, V3{3}, V4{4}, V5{5}, V6{6}, V7{7}, V8{8}, V9{9}, V10{10},
+    V11{11}, V12{12}, V13{13}, V14{14}, V15{15}, V16{16}, V17{17}, V18{18}, V19{19}, V20{20},
+    V21{21}, V22{22}, V23{23}, V24{24}, V25{25}, V26{26}, V27{27}, V28{28}, V29{29}, V30{30},
+    V31{31};
+// clang-format on
+
+constexpr WReg ToW(XReg reg) {
+    return {reg.index};
+}
+
+enum class Cond : u32 { EQ, NE, HS, LO, MI, PL, VS, VC, HI, LS, GE, LT, GT, LE, AL };
+
+/// Addressing modes of the load/store pair instructions
+enum class IndexMode { Offset, PreIndex, PostIndex };
+
+/**
+ * Position in the emitted code. A label may be referenced before it is bound, the references are
+ * patched once CodeGenerator::L binds it.
+ */
+class Label {
+public:
+    /// Address of the label in the code buffer; nullptr while unbound
+    const u8* GetAddress() const {
+        return address;
+    }
+
+private:
+    friend class CodeGenerator;
+
+    enum class FixupType { Branch26, Branch19 };
+
+    const u8* address = nullptr;
+    std::vector<std::pair<std::size_t, FixupType>> fixups;
+};
+
+/**
+ * Minimal AArch64 code emitter, covering the instructions used by the JIT compilers. Code is
+ * written to a fixed size executable buffer that is made read-only by Ready.
+ */
+class CodeGenerator : NonCopyable {
+public:
+    explicit CodeGenerator(std::size_t max_size);
+    ~CodeGenerator();
+
+    const u8* GetCurr() const {
+        return code + size;
+    }
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+    /// Makes the code executable. No code can be emitted afterwards.
+    void Ready();
+
+    /// Binds the label to the current position
+    void L(Label& label);
+
+    /// Pads the code with zeros up to a multiple of alignment bytes
+    void Align(std::size_t alignment);
+
+    /// Emits a raw data word
+    void DW(u32 data);
+
+    // Moves
+    void mov(XReg d, u64 imm);
+    void mov(WReg d, u32 imm);
+    /// Register move encoded as ADD #0, so that one of the registers may be SP
+    void mov(XReg d, XReg n);
+
+    // Arithmetic
+    void add(XReg d, XReg n, u32 imm);
+    void add(WReg d, WReg n, u32 imm);
+    void add(XReg d, XReg n, XReg m);
+    void sub(XReg d, XReg n, u32 imm);
+    void sub(WReg d, WReg n, u32 imm);
+    void subs(WReg d, WReg n, u32 imm);
+    void cmp(WReg n, u32 imm);
+
+    // Logical operations
+    void and_(WReg d, WReg n, WReg m);
+    void orr(WReg d, WReg n, WReg m);
+    /// imm must be a valid bitmask immediate
+    void and_(WReg d, WReg n, u32 imm);
+    void orr(WReg d, WReg n, u32 imm);
+    void eor(WReg d, WReg n, u32 imm);
+
+    // Shifts
+    void lsl(XReg d, XReg n, u32 shift);
+    void lsr(WReg d, WReg n, u32 shift);
+    void asr(XReg d, XReg n, u32 shift);
+    void asr(WReg d, WReg n, u32 shift);
+
+    // Loads and stores with an unsigned offset scaled by the access size
+    void ldr(XReg t, XReg n, u32 offset);
+    void ldr(WReg t, XReg n, u32 offset);
+    void ldr(QReg t, XReg n, u32 offset);
+    void ldrb(WReg t, XReg n, u32 offset);
+    void str(XReg t, XReg n, u32 offset);
+    void str(WReg t, XReg n, u32 offset);
+    void str(QReg t, XReg n, u32 offset);
+    void strb(WReg t, XReg n, u32 offset);
+    /// PC-relative literal load
+    void ldr(SReg t, Label& label);
+    void ldp(XReg t1, XReg t2, XReg n, s32 offset, IndexMode mode = IndexMode::Offset);
+    void stp(XReg t1, XReg t2, XReg n, s32 offset, IndexMode mode = IndexMode::Offset);
+
+    // Branches
+    void b(Label& label);
+    void b(Cond cond, Label& label);
+    void bl(Label& label);
+    void cbz(WReg t, Label& label);
+    void cbnz(WReg t, Label& label);
+    void cbnz(XReg t, Label& label);
+    void br(XReg n);
+    void blr(XReg n);
+    void ret();
+
+    // Moves between general purpose and SIMD registers
+    void smov(XReg d, VElem n);
+    void umov(WReg d, VElem n);
+    void fmov(SReg d, WReg n);
+    void fmov(WReg d, SReg n);
+    void dup(VReg d, VElem n);
+    void dup(VReg d, WReg n);
+    void ins(VElem d, VElem n);
+    void ins(VElem d, WReg n);
+
+    // Conversions
+    void fcvtzs(VReg d, VReg n);
+    void fcvtns(WReg d, SReg n);
+    void scvtf(SReg d, WReg n);
+
+    // Vector floating point operations
+    void fadd(VReg d, VReg n, VReg m);
+    void fmul(VReg d, VReg n, VReg m);
+    void fmulx(VReg d, VReg n, VReg m);
+    void faddp(VReg d, VReg n, VReg m);
+    void fcmeq(VReg d, VReg n, VReg m);
+    void fcmge(VReg d, VReg n, VReg m);
+    void fcmgt(VReg d, VReg n, VReg m);
+    void fneg(VReg d, VReg n);
+    void frintm(VReg d, VReg n);
+    /// imm must be representable as an 8-bit floating point immediate
+    void fmov(VReg d, float imm);
+
+    // Vector bitwise operations
+    void and_(VReg d, VReg n, VReg m);
+    void orr(VReg d, VReg n, VReg m);
+    void orn(VReg d, VReg n, VReg m);
+    void bsl(VReg d, VReg n, VReg m);
+    void mvn(VReg d, VReg n);
+
+    // Scalar floating point operations
+    void fadd(SReg d, SReg n, SReg m);
+    void fsub(SReg d, SReg n, SReg m);
+    void fmul(SReg d, SReg n, SReg m);
+    void fdiv(SReg d, SReg n, SReg m);
+    void fmin(SReg d, SReg n, SReg m);
+    void fmax(SReg d, SReg n, SReg m);
+    void fsqrt(SReg d, SReg n);
+    /// Compares against 0.0
+    void fcmp(SReg n);
+    /// imm must be representable as an 8-bit floating point immediate
+    void fmov(SReg d, float imm);
+
+private:
+    void Emit(u32 instruction);
+    void EmitBranch(Label& label, Label::FixupType type, u32 instruction);
+    void Patch(std::size_t offset, Label::FixupType type, const u8* target);
+
+    void AddSubImmediate(u32 opcode, u32 d, u32 n, u32 imm);
+    void LogicalImmediate(u32 opcode, u32 d, u32 n, u32 imm);
+    void LoadStore(u32 opcode, u32 t, u32 n, u32 offset, u32 scale);
+    void LoadStorePair(u32 opcode, u32 t1, u32 t2, u32 n, s32 offset, IndexMode mode);
+
+    u8* code = nullptr;
+    std::size_t size = 0;
+    std::size_t max_size = 0;
+};
+
+} // namespace Common::A64
@@ -21,6 +21,16 @@
 #define INSERT_PADDING_BYTES(num_bytes) u8 CONCAT2(pad, __LINE__)[(num_bytes)]
 #define INSERT_PADDING_WORDS(num_words) u32 CONCAT2(pad, __LINE__)[(num_words)]
 
+// State that belongs to one emulated console. Multi-instance builds keep a copy of it for each
+// thread, so that every thread can run a console of its own. Such a console must be created, run
+// and shut down on the same thread, and its helper threads may not touch this state. Settings, the
+// AES key slots and the HLE lock stay shared by all consoles.
+#ifdef CITRA_MULTI_INSTANCE
+#define INSTANCE_LOCAL thread_local
+#else
+#define INSTANCE_LOCAL
+#endif
+
 // Inlining
 #ifdef _WIN32
 #define FORCE_INLINE __forceinline
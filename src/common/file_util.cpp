@@ -3,15 +3,21 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <condition_variable>
+#include <deque>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 #include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "common/thread.h"
 #include "core/settings.h"
 
 #ifdef _WIN32
@@ -37,13 +43,20 @@
 
 #else
 #ifdef __APPLE__
+#include <copyfile.h>
+#include <sys/clonefile.h>
 #include <sys/param.h>
 #endif
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
 #include <cctype>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <unistd.h>
 #endif
@@ -107,6 +120,9 @@
 // REMEMBER: strdup considered harmful!
 namespace FileUtil {
 
+/// Threads that CopyDir copies files on
+constexpr std::size_t MAX_COPY_WORKERS = 8;
+
 // Remove any ending forward slashes from directory paths
 // Modifies argument.
 static void StripTailDirSlashes(std::string& fname) {
@@ -294,6 +310,57 @@ bool Rename(const std::string& srcFilename, const std::string& destFilename) {
     return false;
 }
 
+#if !defined(_WIN32) && !defined(HAVE_LIBRETRO_VFS)
+/**
+ * Copies the file without moving its data through a userspace buffer, as a clone on filesystems
+ * that share extents and otherwise inside the kernel. Returns false if neither can be done, in
+ * which case the file has to be copied again with stdio.
+ */
+static bool CopyInKernel(const std::string& srcFilename, const std::string& destFilename) {
+#ifdef __APPLE__
+    // clonefile only creates new files, so destinations that exist are copied below
+    if (clonefile(srcFilename.c_str(), destFilename.c_str(), 0) == 0)
+        return true;
+#endif
+
+    const int input = open(srcFilename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (input < 0)
+        return false;
+    SCOPE_EXIT({ close(input); });
+    const int output = open(destFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (output < 0)
+        return false;
+    SCOPE_EXIT({ close(output); });
+
+#if defined(__linux__)
+    if (ioctl(output, FICLONE, input) == 0)
+        return true;
+#ifndef __ANDROID__
+    struct stat input_info;
+    if (fstat(input, &input_info) != 0)
+        return false;
+    // Fails before copying anything on filesystems and kernels that can't do it
+    for (off_t remaining = input_info.st_size; remaining > 0;) {
+        const ssize_t copied = copy_file_range(input, nullptr, output, nullptr,
+                                               static_cast<std::size_t>(remaining), 0);
+        if (copied < 0)
+            return false;
+        if (copied == 0)
+            break;
+        remaining -= copied;
+    }
+    return true;
+#else
+    return false;
+#endif
+#elif defined(__APPLE__)
+    return fcopyfile(input, output, nullptr, COPYFILE_DATA) == 0;
+#else
+    return false;
+#endif
+}
+#endif
+
 bool Copy(const std::string& srcFilename, const std::string& destFilename) {
     LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
 #ifdef _WIN32
@@ -305,6 +372,11 @@ bool Copy(const std::string& srcFilename, const std::string& destFilename) {
               GetLastErrorMsg());
     return false;
 #else
+#ifndef HAVE_LIBRETRO_VFS
+    if (CopyInKernel(srcFilename, destFilename))
+        return true;
+#endif
+
     using CFilePointer = std::unique_ptr<FILE, decltype(&FCLOSE)>;
 
     // Open input file
@@ -324,7 +396,7 @@ bool Copy(const std::string& srcFilename, const std::string& destFilename) {
     }
 
     // copy loop
-    std::array<char, 1024> buffer;
+    std::vector<char> buffer(128 * 1024);
     while (!FEOF(input.get())) {
         // read input
         std::size_t rnum = FREAD(buffer.data(), sizeof(char), buffer.size(), input.get());
@@ -375,6 +447,19 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+s64 GetModificationTime(const std::string& filename) {
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#else
+    if (stat(filename.c_str(), &buf) == 0)
+#endif
+    {
+        return static_cast<s64>(buf.st_mtime);
+    }
+    return -1;
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
@@ -534,40 +619,95 @@ bool DeleteDirRecursively(const std::string& directory, unsigned int recursion)
     return true;
 }
 
+namespace {
+/// Copies files on worker threads, so that walking the tree overlaps with copying the data
+class ParallelCopier : NonCopyable {
+public:
+    explicit ParallelCopier(std::size_t num_workers) {
+        workers.reserve(num_workers);
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    /// Waits for the queued files to be copied
+    ~ParallelCopier() {
+        {
+            std::scoped_lock lock{mutex};
+            stop = true;
+        }
+        job_queued.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void Queue(std::string source, std::string dest) {
+        {
+            std::scoped_lock lock{mutex};
+            jobs.emplace_back(std::move(source), std::move(dest));
+        }
+        job_queued.notify_one();
+    }
+
+private:
+    void WorkerLoop() {
+        Common::SetCurrentThreadName("CopyDir");
+        while (true) {
+            std::pair<std::string, std::string> job;
+            {
+                std::unique_lock lock{mutex};
+                job_queued.wait(lock, [this] { return stop || !jobs.empty(); });
+                if (jobs.empty()) {
+                    break;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            Copy(job.first, job.second);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable job_queued;
+    bool stop = false;
+    std::deque<std::pair<std::string, std::string>> jobs;
+};
+
+void CopyDirEntries(ParallelCopier& copier, const std::string& source_path,
+                    const std::string& dest_path) {
+    if (!Exists(dest_path))
+        CreateFullPath(dest_path);
+
+    ForeachDirectoryEntry(nullptr, source_path,
+                          [&copier, &source_path, &dest_path](u64*, const std::string&,
+                                                              const std::string& virtual_name) {
+                              std::string source = source_path + virtual_name;
+                              std::string dest = dest_path + virtual_name;
+                              if (IsDirectory(source)) {
+                                  source += '/';
+                                  dest += '/';
+                                  CopyDirEntries(copier, source, dest);
+                              } else if (!Exists(dest)) {
+                                  copier.Queue(std::move(source), std::move(dest));
+                              }
+                              return true;
+                          });
+}
+} // Anonymous namespace
+
 void CopyDir(const std::string& source_path, const std::string& dest_path) {
-#ifndef _WIN32
     if (source_path == dest_path)
         return;
     if (!FileUtil::Exists(source_path))
         return;
-    if (!FileUtil::Exists(dest_path))
-        FileUtil::CreateFullPath(dest_path);
-
-    DIR* dirp = opendir(source_path.c_str());
-    if (!dirp)
-        return;
-
-    while (struct dirent* result = readdir(dirp)) {
-        const std::string virtualName(result->d_name);
-        // check for "." and ".."
-        if (((virtualName[0] == '.') && (virtualName[1] == '\0')) ||
-            ((virtualName[0] == '.') && (virtualName[1] == '.') && (virtualName[2] == '\0')))
-            continue;
 
-        std::string source, dest;
-        source = source_path + virtualName;
-        dest = dest_path + virtualName;
-        if (IsDirectory(source)) {
-            source += '/';
-            dest += '/';
-            if (!FileUtil::Exists(dest))
-                FileUtil::CreateFullPath(dest);
-            CopyDir(source, dest);
-        } else if (!FileUtil::Exists(dest))
-            FileUtil::Copy(source, dest);
-    }
-    closedir(dirp);
-#endif
+    // Most of the time goes to opening and closing small files, which overlaps well
+    const std::size_t num_workers =
+        std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, MAX_COPY_WORKERS);
+    ParallelCopier copier(num_workers);
+    CopyDirEntries(copier, source_path, dest_path);
 }
 
 std::optional<std::string> GetCurrentDir() {
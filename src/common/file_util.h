@@ -113,6 +113,9 @@ private:
 // Overloaded GetSize, accepts FILE*
 [[nodiscard]] u64 GetSize(CORE_FILE* f);
 
+// Returns the modification time of filename in seconds since the epoch, or -1 if it has none
+[[nodiscard]] s64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -180,7 +183,8 @@ bool DeleteDirRecursively(const std::string& directory, unsigned int recursion =
 // Returns the current directory
 [[nodiscard]] std::optional<std::string> GetCurrentDir();
 
-// Create directory and copy contents (does not overwrite existing files)
+// Create directory and copy contents (does not overwrite existing files). Files are copied on
+// several threads while the tree is walked.
 void CopyDir(const std::string& source_path, const std::string& dest_path);
 
 // Set the current directory to given directory
@@ -336,6 +340,10 @@ public:
         return nullptr != m_file;
     }
 
+    [[nodiscard]] const std::string& GetFilename() const {
+        return filename;
+    }
+
     // m_good is set to false when a read, write or other function fails
     [[nodiscard]] bool IsGood() const {
         return m_good;
@@ -0,0 +1,241 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// The fast hash follows the design of XXH3: eight 64-bit lanes take a 32x32-bit product of the
+// input mixed with a secret, so that stripes of 64 bytes map onto two or four SIMD multiplies.
+
+#include <algorithm>
+#include "common/hash.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+constexpr u64 PRIME32_1 = 0x9E3779B1;
+constexpr u64 PRIME32_2 = 0x85EBCA77;
+constexpr u64 PRIME32_3 = 0xC2B2AE3D;
+constexpr u64 PRIME64_1 = 0x9E3779B185EBCA87;
+constexpr u64 PRIME64_2 = 0xC2B2AE3D27D4EB4F;
+constexpr u64 PRIME64_3 = 0x165667B19E3779F9;
+constexpr u64 PRIME64_4 = 0x85EBCA77C2B2AE63;
+constexpr u64 PRIME64_5 = 0x27D4EB2F165667C5;
+
+constexpr std::size_t SecretWords = 24;
+constexpr std::size_t StripeWords = 8;
+
+/// Each stripe of a block uses the secret shifted by another word, then the block is scrambled
+constexpr std::size_t StripesPerBlock = SecretWords - StripeWords;
+
+/// Pseudo-random key words mixed into the input, generated with splitmix64
+constexpr std::array<u64, SecretWords> secret = [] {
+    std::array<u64, SecretWords> words{};
+    u64 state = PRIME64_1;
+    for (auto& word : words) {
+        state += 0x9E3779B97F4A7C15;
+        u64 z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        word = z ^ (z >> 31);
+    }
+    return words;
+}();
+
+u64 Read64(const u8* data) {
+    u64 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+u64 Mul128Fold64(u64 lhs, u64 rhs) {
+#if defined(__SIZEOF_INT128__)
+    const auto product = static_cast<unsigned __int128>(lhs) * rhs;
+    return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    u64 high;
+    const u64 low = _umul128(lhs, rhs, &high);
+    return low ^ high;
+#else
+    const u64 lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+    const u64 hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+    const u64 lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+    const u64 hi_hi = (lhs >> 32) * (rhs >> 32);
+    const u64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    const u64 high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    const u64 low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return low ^ high;
+#endif
+}
+
+u64 Avalanche(u64 hash) {
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/**
+ * Mixes count stripes of 64 bytes into the accumulators, shifting the key by a word after each
+ * stripe. The accumulators stay in registers for the whole run.
+ */
+void Accumulate(u64* acc, const u8* input, std::size_t count, const u64* key) {
+#if defined(ARCHITECTURE_x86_64)
+    // Named lanes rather than an array, so that they aren't spilled to the stack
+    auto* const acc_out = reinterpret_cast<__m128i*>(acc);
+    __m128i lane0 = _mm_loadu_si128(acc_out);
+    __m128i lane1 = _mm_loadu_si128(acc_out + 1);
+    __m128i lane2 = _mm_loadu_si128(acc_out + 2);
+    __m128i lane3 = _mm_loadu_si128(acc_out + 3);
+    const auto step = [](__m128i lane, const __m128i* data_in, const __m128i* key_in) {
+        const __m128i data = _mm_loadu_si128(data_in);
+        const __m128i keyed = _mm_xor_si128(data, _mm_loadu_si128(key_in));
+        const __m128i product =
+            _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+        const __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        return _mm_add_epi64(lane, _mm_add_epi64(product, swapped));
+    };
+    for (std::size_t stripe = 0; stripe < count; stripe++) {
+        const auto* data_in = reinterpret_cast<const __m128i*>(input + stripe * 64);
+        const auto* key_in = reinterpret_cast<const __m128i*>(key + stripe);
+        lane0 = step(lane0, data_in, key_in);
+        lane1 = step(lane1, data_in + 1, key_in + 1);
+        lane2 = step(lane2, data_in + 2, key_in + 2);
+        lane3 = step(lane3, data_in + 3, key_in + 3);
+    }
+    _mm_storeu_si128(acc_out, lane0);
+    _mm_storeu_si128(acc_out + 1, lane1);
+    _mm_storeu_si128(acc_out + 2, lane2);
+    _mm_storeu_si128(acc_out + 3, lane3);
+#elif defined(ARCHITECTURE_ARM64)
+    uint64x2_t lanes[StripeWords / 2];
+    for (std::size_t i = 0; i < StripeWords / 2; i++) {
+        lanes[i] = vld1q_u64(acc + i * 2);
+    }
+    for (std::size_t stripe = 0; stripe < count; stripe++) {
+        for (std::size_t i = 0; i < StripeWords / 2; i++) {
+            const uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(input + stripe * 64 + i * 16));
+            const uint64x2_t keyed = veorq_u64(data, vld1q_u64(key + stripe + i * 2));
+            lanes[i] = vaddq_u64(lanes[i], vextq_u64(data, data, 1));
+            lanes[i] = vmlal_u32(lanes[i], vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+        }
+    }
+    for (std::size_t i = 0; i < StripeWords / 2; i++) {
+        vst1q_u64(acc + i * 2, lanes[i]);
+    }
+#else
+    std::array<u64, StripeWords> lanes;
+    std::copy_n(acc, StripeWords, lanes.begin());
+    for (std::size_t stripe = 0; stripe < count; stripe++) {
+        for (std::size_t i = 0; i < StripeWords; i++) {
+            const u64 data = Read64(input + stripe * 64 + i * 8);
+            const u64 keyed = data ^ key[stripe + i];
+            lanes[i ^ 1] += data;
+            lanes[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+        }
+    }
+    std::copy_n(lanes.begin(), StripeWords, acc);
+#endif
+}
+
+/// Spreads the high bits of the accumulators, which the 32-bit products can't reach otherwise
+void Scramble(u64* acc) {
+    const u64* key = secret.data() + SecretWords - StripeWords;
+    for (std::size_t i = 0; i < StripeWords; i++) {
+        u64 lane = acc[i];
+        lane ^= lane >> 47;
+        lane ^= key[i];
+        acc[i] = lane * PRIME32_1;
+    }
+}
+
+/// Hashes up to 16 bytes without going through the accumulators
+u64 HashShort(const u8* data, std::size_t len) {
+    std::array<u8, 16> padded{};
+    std::memcpy(padded.data(), data, len);
+    const u64 low = Read64(padded.data()) ^ secret[0];
+    const u64 high = Read64(padded.data() + 8) ^ (secret[1] - len);
+    return Avalanche(len * PRIME64_1 + low + (high >> 29) + Mul128Fold64(low, high));
+}
+
+} // Anonymous namespace
+
+FastHasher64::FastHasher64() noexcept
+    : accumulators{PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                   PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1} {}
+
+void FastHasher64::Update(const void* data, std::size_t len) noexcept {
+    const u8* input = static_cast<const u8*>(data);
+    total_len += len;
+    if (buffered != 0) {
+        const std::size_t count = std::min(len, StripeSize - buffered);
+        std::memcpy(buffer.data() + buffered, input, count);
+        buffered += count;
+        input += count;
+        len -= count;
+        if (buffered < StripeSize) {
+            return;
+        }
+        ConsumeStripes(buffer.data(), 1);
+        buffered = 0;
+    }
+    const std::size_t stripes = len / StripeSize;
+    ConsumeStripes(input, stripes);
+    buffered = len - stripes * StripeSize;
+    std::memcpy(buffer.data(), input + stripes * StripeSize, buffered);
+}
+
+u64 FastHasher64::Digest() const noexcept {
+    if (total_len <= 16) {
+        // No stripe has been consumed, so the whole input is still in the buffer
+        return HashShort(buffer.data(), buffered);
+    }
+
+    std::array<u64, 8> acc = accumulators;
+    if (buffered != 0) {
+        // The zero padding is told apart from zero input by the length mixed in below
+        std::array<u8, StripeSize> last{};
+        std::memcpy(last.data(), buffer.data(), buffered);
+        Accumulate(acc.data(), last.data(), 1, secret.data() + block_stripe);
+    }
+
+    u64 hash = total_len * PRIME64_1;
+    for (std::size_t i = 0; i < acc.size(); i += 2) {
+        hash += Mul128Fold64(acc[i] ^ secret[i + 1], acc[i + 1] ^ secret[i + 2]);
+    }
+    return Avalanche(hash);
+}
+
+void FastHasher64::ConsumeStripes(const u8* input, std::size_t count) noexcept {
+    while (count != 0) {
+        const std::size_t run = std::min(count, StripesPerBlock - block_stripe);
+        Accumulate(accumulators.data(), input, run, secret.data() + block_stripe);
+        input += run * StripeSize;
+        count -= run;
+        block_stripe += run;
+        if (block_stripe == StripesPerBlock) {
+            Scramble(accumulators.data());
+            block_stripe = 0;
+        }
+    }
+}
+
+u64 ComputeFastHash64(const void* data, std::size_t len) noexcept {
+    if (len <= 16) {
+        return HashShort(static_cast<const u8*>(data), len);
+    }
+    FastHasher64 hasher;
+    hasher.Update(data, len);
+    return hasher.Digest();
+}
+
+} // namespace Common
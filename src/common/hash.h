@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstring>
 #include "common/cityhash.h"
@@ -21,6 +22,42 @@ static inline u64 ComputeHash64(const void* data, std::size_t len) noexcept {
     return CityHash64(static_cast<const char*>(data), len);
 }
 
+/**
+ * Computes a 64-bit hash over the specified block of data, several times faster than
+ * ComputeHash64 on large blocks. Its values may change between versions, so they must never be
+ * written to disk, where ComputeHash64 has to be used instead.
+ * @param data Block of data to compute hash over
+ * @param len Length of data (in bytes) to compute hash over
+ * @returns 64-bit hash value that was computed over the data block
+ */
+u64 ComputeFastHash64(const void* data, std::size_t len) noexcept;
+
+/**
+ * Computes the same hash as ComputeFastHash64 over data given in pieces, such as guest memory
+ * gathered page by page.
+ */
+class FastHasher64 {
+public:
+    FastHasher64() noexcept;
+
+    /// Appends len bytes at data to the hashed data
+    void Update(const void* data, std::size_t len) noexcept;
+
+    /// Returns the hash of the data appended so far
+    u64 Digest() const noexcept;
+
+private:
+    static constexpr std::size_t StripeSize = 64;
+
+    void ConsumeStripes(const u8* input, std::size_t count) noexcept;
+
+    std::array<u64, 8> accumulators;
+    std::array<u8, StripeSize> buffer;
+    std::size_t buffered = 0;     ///< Bytes of the partial stripe held in buffer
+    std::size_t block_stripe = 0; ///< Stripes accumulated since the last scramble
+    u64 total_len = 0;
+};
+
 /**
  * Computes a 64-bit hash of a struct. In addition to being trivially copyable, it is also critical
  * that either the struct includes no padding, or that any padding is initialized to a known value
@@ -33,6 +70,14 @@ static inline u64 ComputeStructHash64(const T& data) noexcept {
     return ComputeHash64(&data, sizeof(data));
 }
 
+/// Computes a ComputeFastHash64 hash of a struct, under the same requirements as above
+template <typename T>
+static inline u64 ComputeFastStructHash64(const T& data) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Type passed to ComputeFastStructHash64 must be trivially copyable");
+    return ComputeFastHash64(&data, sizeof(data));
+}
+
 /// A helper template that ensures the padding in a struct is initialized by memsetting to 0.
 template <typename T>
 struct HashableStruct {
@@ -64,7 +109,7 @@ struct HashableStruct {
     };
 
     std::size_t Hash() const noexcept {
-        return Common::ComputeStructHash64(state);
+        return Common::ComputeFastStructHash64(state);
     }
 };
 
@@ -0,0 +1,60 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "common/histogram.h"
+
+namespace Common {
+
+void Histogram::Record(u64 value) {
+    ++buckets[BucketIndex(std::min(value, MaxValue))];
+    ++count;
+}
+
+void Histogram::Reset() {
+    buckets.fill(0);
+    count = 0;
+}
+
+u64 Histogram::Percentile(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    const auto rank = static_cast<u64>(
+        std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count)));
+    u64 seen = 0;
+    for (std::size_t i = 0; i < BucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= std::max<u64>(rank, 1)) {
+            return BucketValue(i);
+        }
+    }
+    return MaxValue;
+}
+
+std::size_t Histogram::BucketIndex(u64 value) {
+    if (value < SubBucketCount) {
+        return static_cast<std::size_t>(value);
+    }
+    // Find the scale that brings the value in [HalfSubBucketCount, SubBucketCount)
+    u32 shift = 1;
+    while ((value >> shift) >= SubBucketCount) {
+        ++shift;
+    }
+    return SubBucketCount + (shift - 1) * HalfSubBucketCount +
+           static_cast<std::size_t>((value >> shift) - HalfSubBucketCount);
+}
+
+u64 Histogram::BucketValue(std::size_t index) {
+    if (index < SubBucketCount) {
+        return index;
+    }
+    const auto shift = static_cast<u32>((index - SubBucketCount) / HalfSubBucketCount + 1);
+    const u64 sub_bucket = (index - SubBucketCount) % HalfSubBucketCount + HalfSubBucketCount;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+} // namespace Common
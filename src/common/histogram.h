@@ -0,0 +1,54 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Histogram of values with a fixed relative precision, as in an HDR histogram. Values below 128
+ * are counted exactly, and larger ones in buckets spanning 1/64 of their magnitude, which keeps
+ * the percentiles within 1.6% of the recorded values. Recording is a few instructions, so it can
+ * be left on in hot paths.
+ */
+class Histogram {
+public:
+    /// Records a value. Values above MaxValue are counted as MaxValue.
+    void Record(u64 value);
+
+    /// Removes all the recorded values
+    void Reset();
+
+    /// Returns the number of recorded values
+    [[nodiscard]] u64 Count() const {
+        return count;
+    }
+
+    /**
+     * Returns the value below or at which `percentile` percent of the recorded values are, with
+     * the precision of the buckets, or 0 if no values were recorded.
+     */
+    [[nodiscard]] u64 Percentile(double percentile) const;
+
+    static constexpr u64 MaxValue = 0xFFFFFFFF;
+
+private:
+    static constexpr u32 SubBucketCount = 128;
+    static constexpr u32 HalfSubBucketCount = SubBucketCount / 2;
+    /// Buckets of the exact values, then half as many for each magnitude above them
+    static constexpr std::size_t BucketCount = SubBucketCount + (32 - 7) * HalfSubBucketCount;
+
+    static std::size_t BucketIndex(u64 value);
+    /// Returns the largest value counted in a bucket
+    static u64 BucketValue(std::size_t index);
+
+    std::array<u32, BucketCount> buckets{};
+    u64 count = 0;
+};
+
+} // namespace Common
@@ -6,6 +6,7 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <regex>
@@ -22,6 +23,8 @@
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
 #include "common/string_util.h"
+#include "common/swap.h"
+#include "common/thread.h"
 #include "common/threadsafe_queue.h"
 
 namespace Log {
@@ -49,6 +52,16 @@ public:
             CreateEntry(log_class, log_level, filename, line_num, function, std::move(message)));
     }
 
+    void PushDeferredEntry(Class log_class, Level log_level, const char* filename,
+                           unsigned int line_num, const char* function, const char* format,
+                           DeferredFormatter formatter, const void* args, std::size_t args_size) {
+        Entry entry = CreateEntry(log_class, log_level, filename, line_num, function, {});
+        entry.formatter = formatter;
+        entry.format = format;
+        std::memcpy(entry.args.data(), args, args_size);
+        message_queue.Push(std::move(entry));
+    }
+
     void AddBackend(std::unique_ptr<Backend> backend) {
         std::lock_guard lock{writing_mutex};
         backends.push_back(std::move(backend));
@@ -74,8 +87,13 @@ public:
 private:
     Impl() {
         backend_thread = std::thread([&] {
+            Common::SetCurrentThreadRole(Common::ThreadRole::Background);
             Entry entry;
             auto write_logs = [&](Entry& e) {
+                if (e.formatter) {
+                    e.message = e.formatter(e.format, e.args.data());
+                    e.formatter = nullptr;
+                }
                 std::lock_guard lock{writing_mutex};
                 for (const auto& backend : backends) {
                     backend->Write(e);
@@ -96,6 +114,7 @@ private:
             while (logs_written++ < MAX_LOGS_TO_WRITE && message_queue.Pop(entry)) {
                 write_logs(entry);
             }
+            Common::ClearCurrentThreadRole();
         });
     }
 
@@ -170,6 +189,50 @@ void FileBackend::Write(const Entry& entry) {
     }
 }
 
+BinaryFileBackend::BinaryFileBackend(const std::string& filename) {
+    file = FileUtil::IOFile(filename, "wb", _SH_DENYWR);
+    constexpr std::array<char, 4> magic{{'C', 'L', 'O', 'G'}};
+    const u32_le version = 1;
+    bytes_written += file.WriteArray(magic.data(), magic.size());
+    bytes_written += file.WriteObject(version) * sizeof(version);
+}
+
+void BinaryFileBackend::Write(const Entry& entry) {
+    // Same limit as the text log file
+    constexpr std::size_t MAX_BYTES_WRITTEN = 50 * 1024L * 1024L;
+    if (!file.IsOpen() || bytes_written > MAX_BYTES_WRITTEN) {
+        return;
+    }
+
+#pragma pack(push, 1)
+    struct Record {
+        u64_le timestamp;
+        u8 log_class;
+        u8 log_level;
+        u32_le line_num;
+    };
+#pragma pack(pop)
+    const Record record{static_cast<u64>(entry.timestamp.count()),
+                        static_cast<u8>(entry.log_class), static_cast<u8>(entry.log_level),
+                        entry.line_num};
+    const std::string_view filename{entry.filename};
+    const auto filename_size = static_cast<u16_le>(std::min<std::size_t>(filename.size(), 0xFFFF));
+    const auto function_size =
+        static_cast<u16_le>(std::min<std::size_t>(entry.function.size(), 0xFFFF));
+    const auto message_size = static_cast<u32_le>(entry.message.size());
+
+    bytes_written += file.WriteObject(record) * sizeof(record);
+    bytes_written += file.WriteObject(filename_size) * sizeof(filename_size);
+    bytes_written += file.WriteBytes(filename.data(), filename_size);
+    bytes_written += file.WriteObject(function_size) * sizeof(function_size);
+    bytes_written += file.WriteBytes(entry.function.data(), function_size);
+    bytes_written += file.WriteObject(message_size) * sizeof(message_size);
+    bytes_written += file.WriteBytes(entry.message.data(), message_size);
+    if (entry.log_level >= Level::Error) {
+        file.Flush();
+    }
+}
+
 void DebuggerBackend::Write(const Entry& entry) {
 #ifdef _WIN32
     ::OutputDebugStringW(Common::UTF8ToUTF16W(FormatLogMessage(entry).append(1, '\n')).c_str());
@@ -225,6 +288,7 @@ void DebuggerBackend::Write(const Entry& entry) {
     SUB(Service, SOC)                                                                              \
     SUB(Service, IR)                                                                               \
     SUB(Service, Y2R)                                                                              \
+    SUB(Service, MVD)                                                                              \
     SUB(Service, PS)                                                                               \
     CLS(HW)                                                                                        \
     SUB(HW, Memory)                                                                                \
@@ -306,4 +370,11 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
     instance.PushEntry(log_class, log_level, filename, line_num, function,
                        fmt::vformat(format, args));
 }
+
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            DeferredFormatter formatter, const void* args, std::size_t args_size) {
+    Impl::Instance().PushDeferredEntry(log_class, log_level, filename, line_num, function, format,
+                                       formatter, args, args_size);
+}
 } // namespace Log
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -28,6 +29,11 @@ struct Entry {
     std::string message;
     bool final_entry = false;
 
+    /// If set, `message` is yet to be formatted from `format` and the arguments in `args`
+    DeferredFormatter formatter = nullptr;
+    const char* format = nullptr;
+    alignas(u64) std::array<u8, MaxDeferredArgsSize> args;
+
     Entry() = default;
     Entry(Entry&& o) = default;
 
@@ -118,6 +124,32 @@ private:
     std::size_t bytes_written;
 };
 
+/**
+ * Backend that writes the entries to a file as binary records, for processing by other tools.
+ * The file starts with the magic "CLOG" and a u32 version, followed by one record per entry.
+ * A record is the u64 timestamp in microseconds, the u8 class, the u8 level and the u32 line
+ * number, then the file name and the function as a u16 size followed by the characters, and the
+ * message as a u32 size followed by the characters. Everything is little endian.
+ */
+class BinaryFileBackend : public Backend {
+public:
+    explicit BinaryFileBackend(const std::string& filename);
+
+    static const char* Name() {
+        return "binary_file";
+    }
+
+    const char* GetName() const override {
+        return Name();
+    }
+
+    void Write(const Entry& entry) override;
+
+private:
+    FileUtil::IOFile file;
+    std::size_t bytes_written = 0;
+};
+
 /**
  * Backend that writes to Visual Studio's output window
  */
@@ -5,6 +5,10 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <fmt/format.h>
 #include "common/common_types.h"
 
@@ -92,6 +96,7 @@ enum class Class : ClassType {
     Service_SOC,       ///< The SOC (Socket) service
     Service_IR,        ///< The IR service
     Service_Y2R,       ///< The Y2R (YUV to RGB conversion) service
+    Service_MVD,       ///< The MVD (Movie decoder) service
     Service_PS,        ///< The PS (Process) service
     HW,                ///< Low-level hardware emulation
     HW_Memory,         ///< Memory-map and address translation
@@ -160,14 +165,56 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/// Formats a message from its format string and the arguments captured by DeferredLogMessageImpl
+using DeferredFormatter = std::string (*)(const char* format, const void* args);
+
+/// Maximum size of the arguments of a message whose formatting is deferred
+constexpr std::size_t MaxDeferredArgsSize = 64;
+
+/**
+ * Logs a message to the global logger, copying its trivially copyable arguments so that it is
+ * formatted on the logging thread. `format` must outlive the logger, as a string literal does.
+ */
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            DeferredFormatter formatter, const void* args, std::size_t args_size);
+
+namespace Detail {
+
+/// Only values can be formatted later, rather than anything that may point to a temporary
+template <typename T>
+constexpr bool IsDeferrable = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+template <typename... Args>
+std::string FormatDeferred(const char* format, const void* args) {
+    const auto& values = *static_cast<const std::tuple<Args...>*>(args);
+    return std::apply(
+        [format](const auto&... value) {
+            return fmt::vformat(format, fmt::make_format_args(value...));
+        },
+        values);
+}
+
+} // namespace Detail
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
     if (!filter.CheckMessage(log_class, log_level))
         return;
 
-    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
-                      fmt::make_format_args(args...));
+    // Messages without arguments are not deferred, as their format string may be a temporary
+    using Values = std::tuple<Args...>;
+    if constexpr (sizeof...(Args) > 0 && (Detail::IsDeferrable<Args> && ...) &&
+                  sizeof(Values) <= MaxDeferredArgsSize && alignof(Values) <= alignof(u64)) {
+        // Formatting is left to the logging thread, which keeps it off the hot paths that log
+        const Values values{args...};
+        DeferredLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                               &Detail::FormatDeferred<Args...>, &values, sizeof(values));
+    } else {
+        FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                          fmt::make_format_args(args...));
+    }
 }
 
 } // namespace Log
@@ -101,13 +101,20 @@ public:
     MemoryRef& operator+=(u32 offset_by) {
         ASSERT(offset_by < csize);
         offset += offset_by;
-        Init();
+        // Same as Init, without asking the backing memory again
+        cptr += offset_by;
+        csize -= offset_by;
         return *this;
     }
     MemoryRef operator+(u32 offset_by) const {
         ASSERT(offset_by < csize);
         return MemoryRef(backing_mem, offset + offset_by);
     }
+    /// Whether this references the memory distance bytes after previous, or both are null
+    bool Follows(const MemoryRef& previous, u64 distance) const {
+        return backing_mem == previous.backing_mem &&
+               (!backing_mem || offset == previous.offset + distance);
+    }
 
 private:
     std::shared_ptr<BackingMem> backing_mem{};
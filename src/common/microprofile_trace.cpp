@@ -0,0 +1,247 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/microprofile_trace.h"
+
+namespace Common::Profiling {
+
+std::string GetDefaultTracePath() {
+    const std::time_t now = std::time(nullptr);
+    std::array<char, 32> name{};
+    std::strftime(name.data(), name.size(), "trace_%Y%m%d_%H%M%S.json", std::localtime(&now));
+    return FileUtil::GetUserPath(FileUtil::UserPath::LogDir) + name.data();
+}
+
+#if MICROPROFILE_ENABLED
+
+namespace {
+
+struct ThreadTrace {
+    std::string name;
+    std::vector<MicroProfileLogEntry> entries;
+};
+
+struct TraceCapture {
+    std::string path;
+    u32 frames_left = 0;
+    bool started = false;
+    bool previous_force_enable = false;
+    bool previous_all_groups = false;
+
+    /// Tick at which the first captured frame started
+    u64 start_tick = 0;
+    std::vector<u64> frame_ticks;
+    std::array<ThreadTrace, MICROPROFILE_MAX_THREADS> threads;
+};
+
+std::mutex capture_mutex;
+std::unique_ptr<TraceCapture> capture;
+/// Checked before taking the lock, as OnFrameEnd is called every frame
+std::atomic<bool> capturing{false};
+
+void AppendEscaped(fmt::memory_buffer& out, const char* str) {
+    for (; *str != '\0'; ++str) {
+        const char c = *str;
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<int>(c));
+        } else {
+            out.push_back(c);
+        }
+    }
+}
+
+/// Copies the log entries each thread recorded during the frame that just ended
+void CollectFrame(TraceCapture& trace) {
+    MicroProfile& profile = *MicroProfileGet();
+    const u32 frame = profile.nFramePut;
+    const u32 previous_frame =
+        (frame + MICROPROFILE_MAX_FRAME_HISTORY - 1) % MICROPROFILE_MAX_FRAME_HISTORY;
+
+    for (u32 i = 0; i < MICROPROFILE_MAX_THREADS; ++i) {
+        const MicroProfileThreadLog* log = profile.Pool[i];
+        if (!log || log->nGpu) {
+            continue;
+        }
+        ThreadTrace& thread = trace.threads[i];
+        if (thread.name.empty()) {
+            thread.name = log->ThreadName;
+        }
+
+        const u32 begin = profile.Frames[previous_frame].nLogStart[i];
+        const u32 end = profile.Frames[frame].nLogStart[i];
+        if (begin <= end) {
+            thread.entries.insert(thread.entries.end(), log->Log.begin() + begin,
+                                  log->Log.begin() + end);
+        } else {
+            // The log wrapped around during the frame
+            thread.entries.insert(thread.entries.end(), log->Log.begin() + begin, log->Log.end());
+            thread.entries.insert(thread.entries.end(), log->Log.begin(), log->Log.begin() + end);
+        }
+    }
+    trace.frame_ticks.push_back(profile.Frames[frame].nFrameStartCpu);
+}
+
+void WriteTrace(const TraceCapture& trace) {
+    const MicroProfile& profile = *MicroProfileGet();
+    const double us_per_tick = 1e6 / static_cast<double>(MicroProfileTicksPerSecondCpu());
+    const auto to_us = [&](MicroProfileLogEntry entry) {
+        // Log entries only keep the low 48 bits of the tick
+        return static_cast<double>(MicroProfileLogTickDifference(trace.start_tick, entry)) *
+               us_per_tick;
+    };
+
+    fmt::memory_buffer out;
+    const auto append = [&out](auto&&... args) {
+        fmt::format_to(std::back_inserter(out), std::forward<decltype(args)>(args)...);
+    };
+    append("{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    const auto begin_event = [&] {
+        if (!first) {
+            append(",\n");
+        }
+        first = false;
+    };
+
+    // The ends of the frames, as global instant events
+    for (const u64 tick : trace.frame_ticks) {
+        begin_event();
+        append("{{\"name\":\"Flip\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":{:.3f}}}",
+               static_cast<double>(tick - trace.start_tick) * us_per_tick);
+    }
+
+    std::vector<MicroProfileLogEntry> stack;
+    for (std::size_t i = 0; i < trace.threads.size(); ++i) {
+        const ThreadTrace& thread = trace.threads[i];
+        if (thread.entries.empty()) {
+            continue;
+        }
+        begin_event();
+        append("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},", i);
+        append("\"args\":{{\"name\":\"");
+        AppendEscaped(out, thread.name.c_str());
+        append("\"}}}}");
+
+        // Scopes are strictly nested, so leaves match the innermost enter. Leaves of scopes
+        // entered before the capture began and scopes still open at its end are dropped.
+        stack.clear();
+        for (const MicroProfileLogEntry entry : thread.entries) {
+            const int type = MicroProfileLogType(entry);
+            if (type == MP_LOG_ENTER) {
+                stack.push_back(entry);
+            } else if (type == MP_LOG_LEAVE && !stack.empty()) {
+                const MicroProfileLogEntry enter = stack.back();
+                stack.pop_back();
+
+                const auto timer = MicroProfileLogTimerIndex(enter);
+                begin_event();
+                append("{{\"name\":\"");
+                AppendEscaped(out, profile.TimerInfo[timer].pName);
+                append("\",\"cat\":\"");
+                AppendEscaped(out, profile.GroupInfo[profile.TimerToGroup[timer]].pName);
+                append("\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", i,
+                       to_us(enter),
+                       static_cast<double>(MicroProfileLogTickDifference(enter, entry)) *
+                           us_per_tick);
+            }
+        }
+    }
+    append("\n]}}\n");
+
+    FileUtil::IOFile file(trace.path, "wb");
+    if (!file.IsOpen() || file.WriteBytes(out.data(), out.size()) != out.size()) {
+        LOG_ERROR(Common, "Could not write the profiler trace to {}", trace.path);
+        return;
+    }
+    LOG_INFO(Common, "Wrote the profiler trace of {} frames to {}", trace.frame_ticks.size(),
+             trace.path);
+}
+
+} // Anonymous namespace
+
+bool StartTraceCapture(std::string path, u32 num_frames) {
+    std::scoped_lock lock{capture_mutex};
+    if (capture || num_frames == 0) {
+        return false;
+    }
+
+    capture = std::make_unique<TraceCapture>();
+    capture->path = std::move(path);
+    capture->frames_left = num_frames;
+    {
+        // Groups are enabled from the next flip on
+        std::scoped_lock profile_lock{MicroProfileGetMutex()};
+        capture->previous_force_enable = MicroProfileGetForceEnable();
+        capture->previous_all_groups = MicroProfileGetEnableAllGroups();
+        MicroProfileSetForceEnable(true);
+        MicroProfileSetEnableAllGroups(true);
+    }
+    capturing = true;
+    LOG_INFO(Common, "Capturing a profiler trace of {} frames", num_frames);
+    return true;
+}
+
+bool IsCapturingTrace() {
+    return capturing;
+}
+
+void OnFrameEnd() {
+    if (!capturing) {
+        return;
+    }
+
+    std::unique_ptr<TraceCapture> finished;
+    {
+        std::scoped_lock lock{capture_mutex};
+        std::scoped_lock profile_lock{MicroProfileGetMutex()};
+        MicroProfile& profile = *MicroProfileGet();
+        if (!capture->started) {
+            // The groups were enabled by this flip, so the capture begins with the next frame
+            capture->started = true;
+            capture->start_tick = profile.Frames[profile.nFramePut].nFrameStartCpu;
+            return;
+        }
+
+        CollectFrame(*capture);
+        if (--capture->frames_left > 0) {
+            return;
+        }
+
+        MicroProfileSetForceEnable(capture->previous_force_enable);
+        MicroProfileSetEnableAllGroups(capture->previous_all_groups);
+        finished = std::move(capture);
+        capturing = false;
+    }
+    WriteTrace(*finished);
+}
+
+#else
+
+bool StartTraceCapture(std::string path, u32 num_frames) {
+    return false;
+}
+
+bool IsCapturingTrace() {
+    return false;
+}
+
+void OnFrameEnd() {}
+
+#endif
+
+} // namespace Common::Profiling
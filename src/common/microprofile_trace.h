@@ -0,0 +1,36 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+
+/**
+ * Headless capture of the MicroProfile scopes into a Chrome trace JSON file, which chrome://tracing
+ * and the Perfetto UI open. While capturing, all the profiler groups are enabled and the scopes
+ * recorded on every thread are copied out of the MicroProfile logs at each frame, so that no
+ * profiler UI needs to be running.
+ */
+namespace Common::Profiling {
+
+/// Number of frames frontends capture by default, 5 seconds at full speed
+constexpr u32 DefaultTraceFrameCount = 300;
+
+/**
+ * Starts capturing the scopes of the next `num_frames` frames, then writes them to `path`. Does
+ * nothing and returns false if a capture is already running or MicroProfile is disabled.
+ */
+bool StartTraceCapture(std::string path, u32 num_frames);
+
+/// Returns a path in the log directory, named after the current time, to write a trace to
+std::string GetDefaultTracePath();
+
+/// Returns true if a trace is being captured
+bool IsCapturingTrace();
+
+/// Collects the scopes of the frame that ended. Called right after MicroProfileFlip.
+void OnFrameEnd();
+
+} // namespace Common::Profiling
@@ -0,0 +1,71 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * A value that one writer updates while any number of readers read it without locks. The value is
+ * stored as relaxed atomic words around a sequence number that is odd while a write is in
+ * progress, and readers retry if it changed while they copied. Writes never wait, so this suits
+ * small states that are published often and read from time critical threads. Concurrent writers
+ * must be serialized by the caller.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied bytewise");
+
+public:
+    SeqLock() {
+        Store(T{});
+    }
+
+    explicit SeqLock(const T& value) {
+        Store(value);
+    }
+
+    void Store(const T& value) {
+        std::array<u64, NumWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const u32 seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < NumWords; ++i) {
+            data[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    [[nodiscard]] T Load() const {
+        std::array<u64, NumWords> words;
+        u32 seq;
+        do {
+            seq = sequence.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < NumWords; ++i) {
+                words[i] = data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) != 0 || seq != sequence.load(std::memory_order_relaxed));
+
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr std::size_t NumWords = (sizeof(T) + sizeof(u64) - 1) / sizeof(u64);
+
+    std::atomic<u32> sequence{0};
+    std::array<std::atomic<u64>, NumWords> data;
+};
+
+} // namespace Common
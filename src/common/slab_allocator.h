@@ -0,0 +1,111 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Common {
+
+/**
+ * Hands out blocks of a single size from chunks that are kept for reuse rather than returned to
+ * the system, so that objects created and destroyed at a high rate don't go through the general
+ * purpose heap each time.
+ */
+template <std::size_t Size, std::size_t Align>
+class SlabHeap {
+public:
+    static SlabHeap& Instance() {
+        // Leaked on purpose, so that objects freed during static destruction still find it
+        static auto* heap = new SlabHeap;
+        return *heap;
+    }
+
+    void* Allocate() {
+        std::lock_guard lock{mutex};
+        if (free_list == nullptr) {
+            Grow();
+        }
+        Node* const node = free_list;
+        free_list = node->next;
+        return node;
+    }
+
+    void Free(void* block) noexcept {
+        std::lock_guard lock{mutex};
+        Node* const node = static_cast<Node*>(block);
+        node->next = free_list;
+        free_list = node;
+    }
+
+private:
+    union Node {
+        Node* next;
+        alignas(Align) std::byte storage[Size];
+    };
+
+    static constexpr std::size_t NodesPerChunk = 64;
+
+    void Grow() {
+        auto chunk = std::make_unique<Node[]>(NodesPerChunk);
+        for (std::size_t i = 0; i < NodesPerChunk; i++) {
+            chunk[i].next = free_list;
+            free_list = &chunk[i];
+        }
+        chunks.push_back(std::move(chunk));
+    }
+
+    std::mutex mutex;
+    Node* free_list = nullptr;
+    std::vector<std::unique_ptr<Node[]>> chunks;
+};
+
+/// Standard allocator taking single objects from the slab heap of their size
+template <typename T>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    SlabAllocator() noexcept = default;
+
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n != 1) {
+            return std::allocator<T>{}.allocate(n);
+        }
+        return static_cast<T*>(SlabHeap<sizeof(T), alignof(T)>::Instance().Allocate());
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n != 1) {
+            std::allocator<T>{}.deallocate(p, n);
+            return;
+        }
+        SlabHeap<sizeof(T), alignof(T)>::Instance().Free(p);
+    }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const SlabAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+/// Like std::make_shared, but takes the object and its control block from a slab heap
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeSlabShared(Args&&... args) {
+    return std::allocate_shared<T>(SlabAllocator<T>{}, std::forward<Args>(args)...);
+}
+
+} // namespace Common
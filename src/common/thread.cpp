@@ -7,6 +7,7 @@
 #include "common/thread.h"
 #ifdef __APPLE__
 #include <mach/mach.h>
+#include <pthread.h>
 #elif defined(_WIN32)
 #include <windows.h>
 #else
@@ -17,10 +18,23 @@
 #endif
 #include <sched.h>
 #endif
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef __ANDROID__
+#include <dlfcn.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <optional>
 #include <string>
+#include <vector>
+#include <fmt/format.h>
 
 #ifdef __FreeBSD__
 #define cpu_set_t cpuset_t
@@ -83,4 +97,311 @@ void SetCurrentThreadName(const char* name) {
 
 #endif
 
+namespace {
+
+constexpr std::size_t NUM_THREAD_ROLES = static_cast<std::size_t>(ThreadRole::Background) + 1;
+
+std::mutex policies_mutex;
+std::array<ThreadRolePolicy, NUM_THREAD_ROLES> policies;
+
+thread_local std::optional<ThreadRole> current_role;
+/// Whether the scheduling of the current thread was changed from the host default
+thread_local bool priority_changed = false;
+
+#ifdef __linux__
+/// The host CPUs split by their maximum clock
+struct CoreClusters {
+    cpu_set_t fast;
+    cpu_set_t slow;
+    /// False when all the cores run at the same clock, which leaves affinity to the scheduler
+    bool is_heterogeneous = false;
+};
+
+const CoreClusters& GetCoreClusters() {
+    static const CoreClusters clusters = [] {
+        CoreClusters result{};
+        CPU_ZERO(&result.fast);
+        CPU_ZERO(&result.slow);
+
+        std::vector<std::pair<int, u64>> max_clocks;
+        const long num_cpus = std::min<long>(sysconf(_SC_NPROCESSORS_CONF), CPU_SETSIZE);
+        for (int cpu = 0; cpu < num_cpus; ++cpu) {
+            std::ifstream file(
+                fmt::format("/sys/devices/system/cpu/cpu{}/cpufreq/cpuinfo_max_freq", cpu));
+            u64 max_clock = 0;
+            if (file >> max_clock) {
+                max_clocks.emplace_back(cpu, max_clock);
+            }
+        }
+        if (max_clocks.empty()) {
+            return result;
+        }
+
+        const auto [slowest, fastest] = std::minmax_element(
+            max_clocks.begin(), max_clocks.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+        const u64 slowest_clock = slowest->second;
+        if (slowest_clock == fastest->second) {
+            return result;
+        }
+        // Every core faster than the slowest cluster counts as fast, so the emulator threads are
+        // not all packed on the single prime core of 1+3+4 layouts
+        for (const auto& [cpu, max_clock] : max_clocks) {
+            CPU_SET(cpu, max_clock == slowest_clock ? &result.slow : &result.fast);
+        }
+        result.is_heterogeneous = true;
+        return result;
+    }();
+    return clusters;
+}
+
+void SetCurrentThreadAffinity(ThreadRole role, u64 affinity_mask) {
+    if (affinity_mask != 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < std::min(64, CPU_SETSIZE); ++cpu) {
+            if ((affinity_mask >> cpu) & 1) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+            LOG_WARNING(Common, "Failed to set thread affinity to {:#x}: {}", affinity_mask,
+                        GetLastErrorMsg());
+        }
+        return;
+    }
+
+    const CoreClusters& clusters = GetCoreClusters();
+    if (!clusters.is_heterogeneous || role == ThreadRole::Present) {
+        return;
+    }
+    const cpu_set_t& cpus = role == ThreadRole::Background ? clusters.slow : clusters.fast;
+    // Failing leaves the thread to the scheduler, which is the behaviour without a role
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+#endif
+
+#ifdef __ANDROID__
+/// Threads that frames wait for, which share the performance hint session
+bool IsFrameCritical(ThreadRole role) {
+    return role == ThreadRole::Emulation || role == ThreadRole::GpuSubmit ||
+           role == ThreadRole::Dsp || role == ThreadRole::Present;
+}
+
+/**
+ * ADPF session of the threads that frames wait for. The NDK functions are looked up at runtime,
+ * as they were added in API level 33.
+ */
+class PerformanceHint {
+public:
+    static PerformanceHint& Instance() {
+        static PerformanceHint instance;
+        return instance;
+    }
+
+    void AddThread(pid_t tid) {
+        std::lock_guard lock{mutex};
+        threads.push_back(tid);
+        threads_changed = true;
+    }
+
+    void RemoveThread(pid_t tid) {
+        std::lock_guard lock{mutex};
+        threads.erase(std::remove(threads.begin(), threads.end(), tid), threads.end());
+        threads_changed = true;
+    }
+
+    void Report(s64 actual_ns, s64 target_ns) {
+        std::lock_guard lock{mutex};
+        if (manager == nullptr) {
+            return;
+        }
+        // Sessions cannot change their threads before API level 34, so they are recreated
+        if (threads_changed) {
+            threads_changed = false;
+            if (session != nullptr) {
+                close_session(session);
+                session = nullptr;
+            }
+            if (!threads.empty()) {
+                session = create_session(manager, threads.data(), threads.size(), target_ns);
+                session_target_ns = target_ns;
+            }
+        }
+        if (session == nullptr) {
+            return;
+        }
+        if (session_target_ns != target_ns) {
+            update_target(session, target_ns);
+            session_target_ns = target_ns;
+        }
+        report_actual(session, actual_ns);
+    }
+
+private:
+    using GetManager = void* (*)();
+    using CreateSession = void* (*)(void*, const s32*, std::size_t, s64);
+    using UpdateTarget = int (*)(void*, s64);
+    using ReportActual = int (*)(void*, s64);
+    using CloseSession = void (*)(void*);
+
+    PerformanceHint() {
+        void* const library = dlopen("libandroid.so", RTLD_NOW);
+        if (library == nullptr) {
+            return;
+        }
+        const auto get_manager =
+            reinterpret_cast<GetManager>(dlsym(library, "APerformanceHint_getManager"));
+        create_session =
+            reinterpret_cast<CreateSession>(dlsym(library, "APerformanceHint_createSession"));
+        update_target = reinterpret_cast<UpdateTarget>(
+            dlsym(library, "APerformanceHint_updateTargetWorkDuration"));
+        report_actual = reinterpret_cast<ReportActual>(
+            dlsym(library, "APerformanceHint_reportActualWorkDuration"));
+        close_session =
+            reinterpret_cast<CloseSession>(dlsym(library, "APerformanceHint_closeSession"));
+        if (get_manager && create_session && update_target && report_actual && close_session) {
+            manager = get_manager();
+        }
+    }
+
+    CreateSession create_session = nullptr;
+    UpdateTarget update_target = nullptr;
+    ReportActual report_actual = nullptr;
+    CloseSession close_session = nullptr;
+
+    std::mutex mutex;
+    void* manager = nullptr;
+    void* session = nullptr;
+    s64 session_target_ns = 0;
+    std::vector<s32> threads;
+    bool threads_changed = false;
+};
+#endif
+
+#ifdef _WIN32
+/// MMCSS registration of the current thread, see SetCurrentThreadPriority
+thread_local HANDLE mmcss_task = nullptr;
+#endif
+
+/**
+ * Sets the scheduling class of the current thread. Realtime scheduling is usually reserved to
+ * privileged processes, so it falls back to High.
+ */
+void SetCurrentThreadPriority(ThreadPriority priority) {
+    if (priority == ThreadPriority::Normal && !priority_changed) {
+        return;
+    }
+    priority_changed = priority != ThreadPriority::Normal;
+
+#ifdef _WIN32
+    if (mmcss_task != nullptr) {
+        using RevertMmThread = BOOL(WINAPI*)(HANDLE);
+        static const auto revert = reinterpret_cast<RevertMmThread>(GetProcAddress(
+            LoadLibraryW(L"avrt.dll"), "AvRevertMmThreadCharacteristics"));
+        revert(mmcss_task);
+        mmcss_task = nullptr;
+    }
+    if (priority == ThreadPriority::Realtime) {
+        using SetMmThread = HANDLE(WINAPI*)(LPCWSTR, LPDWORD);
+        static const auto set_mm_thread = [] {
+            const HMODULE avrt = LoadLibraryW(L"avrt.dll");
+            return avrt ? reinterpret_cast<SetMmThread>(
+                              GetProcAddress(avrt, "AvSetMmThreadCharacteristicsW"))
+                        : nullptr;
+        }();
+        DWORD task_index = 0;
+        if (set_mm_thread) {
+            mmcss_task = set_mm_thread(L"Games", &task_index);
+        }
+        if (mmcss_task != nullptr) {
+            return;
+        }
+        LOG_WARNING(Common, "Failed to register the thread with MMCSS: {}", GetLastErrorMsg());
+    }
+    SetThreadPriority(GetCurrentThread(), priority == ThreadPriority::Normal
+                                              ? THREAD_PRIORITY_NORMAL
+                                              : THREAD_PRIORITY_HIGHEST);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(priority == ThreadPriority::Normal ? QOS_CLASS_DEFAULT
+                                                                     : QOS_CLASS_USER_INTERACTIVE,
+                                  0);
+#else
+    sched_param param{};
+    if (priority == ThreadPriority::Realtime) {
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) {
+            return;
+        }
+        LOG_WARNING(Common, "Realtime scheduling was denied, using a high priority instead");
+        param.sched_priority = 0;
+    }
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+#ifdef __linux__
+    // Nice values are per thread on Linux, lowering them needs CAP_SYS_NICE
+    const int nice = priority == ThreadPriority::Normal ? 0 : -10;
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) != 0) {
+        LOG_WARNING(Common, "Failed to set the thread nice value to {}: {}", nice,
+                    GetLastErrorMsg());
+    }
+#endif
+#endif
+}
+
+} // Anonymous namespace
+
+void SetThreadRolePolicy(ThreadRole role, const ThreadRolePolicy& policy) {
+    std::lock_guard lock{policies_mutex};
+    policies[static_cast<std::size_t>(role)] = policy;
+}
+
+void SetCurrentThreadRole(ThreadRole role) {
+    if (current_role == role) {
+        return;
+    }
+    ClearCurrentThreadRole();
+    current_role = role;
+
+    ThreadRolePolicy policy;
+    {
+        std::lock_guard lock{policies_mutex};
+        policy = policies[static_cast<std::size_t>(role)];
+    }
+
+#ifdef __linux__
+    SetCurrentThreadAffinity(role, policy.affinity_mask);
+#elif defined(_WIN32)
+    if (policy.affinity_mask != 0) {
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(policy.affinity_mask));
+    }
+#endif
+    SetCurrentThreadPriority(policy.priority);
+#ifdef __ANDROID__
+    if (IsFrameCritical(role)) {
+        PerformanceHint::Instance().AddThread(gettid());
+    }
+#endif
+}
+
+void ClearCurrentThreadRole() {
+    if (!current_role) {
+        return;
+    }
+#ifdef __ANDROID__
+    if (IsFrameCritical(*current_role)) {
+        PerformanceHint::Instance().RemoveThread(gettid());
+    }
+#endif
+    SetCurrentThreadPriority(ThreadPriority::Normal);
+    current_role.reset();
+}
+
+void ReportFrameWorkDuration(std::chrono::nanoseconds actual, std::chrono::nanoseconds target) {
+#ifdef __ANDROID__
+    if (target.count() > 0) {
+        PerformanceHint::Instance().Report(actual.count(), target.count());
+    }
+#endif
+}
+
 } // namespace Common
@@ -10,6 +10,7 @@
 #include <cstddef>
 #include <mutex>
 #include <thread>
+#include "common/common_types.h"
 
 namespace Common {
 
@@ -92,6 +93,88 @@ private:
     std::size_t generation = 0; // Incremented once each time the barrier is used
 };
 
+/**
+ * Like Barrier, but waiting threads spin instead of blocking. Only worth it when every thread is
+ * expected to arrive shortly.
+ */
+class SpinBarrier {
+public:
+    explicit SpinBarrier(std::size_t count_) : count(count_) {}
+
+    /// Spins until all "count" threads have called Sync()
+    void Sync() {
+        const std::size_t current_generation = generation.load(std::memory_order_acquire);
+
+        if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+            waiting.store(0, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+        } else {
+            while (generation.load(std::memory_order_acquire) == current_generation) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    const std::size_t count;
+    std::atomic<std::size_t> waiting{0};
+    std::atomic<std::size_t> generation{0}; // Incremented once each time the barrier is used
+};
+
 void SetCurrentThreadName(const char* name);
 
+/// What a thread of the emulator is used for, which decides the host cores it runs on
+enum class ThreadRole {
+    Emulation,  ///< Runs the emulated CPU and HLE
+    GpuSubmit,  ///< Processes the PICA command lists
+    Dsp,        ///< Runs the LLE DSP
+    Audio,      ///< Feeds the host audio device. Registered from the sink callback, never cleared.
+    Present,    ///< Presents frames to the host window
+    Network,    ///< Runs the loop of a multiplayer room or room member
+    Background, ///< Work that no frame waits for, such as logging
+};
+
+/// Scheduling class of the threads of a role
+enum class ThreadPriority {
+    Normal,   ///< Default priority of the host
+    High,     ///< Ahead of the normal threads of every process
+    Realtime, ///< SCHED_FIFO on Linux and MMCSS on Windows, falls back to High where denied
+};
+
+/// How the threads of a role are scheduled, see SetThreadRolePolicy
+struct ThreadRolePolicy {
+    /// Host cores the threads may run on, one bit per core. Zero keeps the default placement.
+    u64 affinity_mask = 0;
+    ThreadPriority priority = ThreadPriority::Normal;
+};
+
+/**
+ * Sets how threads registering under `role` are scheduled from now on. Threads that are already
+ * registered keep the policy they registered with.
+ */
+void SetThreadRolePolicy(ThreadRole role, const ThreadRolePolicy& policy);
+
+/**
+ * Registers the current thread under `role` and applies the policy of the role. Without an
+ * affinity mask, on hosts whose cores differ in speed, as on big.LITTLE devices, the emulation,
+ * GPU submit and DSP threads are pinned to the faster cores and background threads to the slowest
+ * ones. On Android, the threads that frames wait for also share an ADPF performance hint session.
+ * Calling it again with the same role does nothing.
+ */
+void SetCurrentThreadRole(ThreadRole role);
+
+/**
+ * Unregisters the current thread, which must be done before a registered thread exits. Audio
+ * threads belong to the sink library and may skip it, as no other thread tracks them.
+ */
+void ClearCurrentThreadRole();
+
+/**
+ * Reports the time the previous frame took on the registered threads, so the CPU governor ramps
+ * up with the emulation load rather than with the average utilization. Does nothing without a
+ * performance hint session.
+ * @param target Frame time at the current speed limit
+ */
+void ReportFrameWorkDuration(std::chrono::nanoseconds actual, std::chrono::nanoseconds target);
+
 } // namespace Common
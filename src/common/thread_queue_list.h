@@ -9,6 +9,7 @@
 #include <deque>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
+#include "common/bit_set.h"
 #include "common/common_types.h"
 
 namespace Common {
@@ -23,6 +24,7 @@ struct ThreadQueueList {
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
+    static_assert(NUM_QUEUES <= 64, "The non-empty queues are tracked in a 64-bit mask");
 
     ThreadQueueList() {
         first = nullptr;
@@ -41,54 +43,31 @@ struct ThreadQueueList {
     }
 
     [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+        if (nonempty_mask == 0) {
+            return T();
         }
-
-        return T();
+        return queues[LeastSignificantSetBit(nonempty_mask)].data.front();
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        return pop_from_mask(nonempty_mask);
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        const u64 better_mask = priority >= 64 ? ~u64{0} : (u64{1} << priority) - 1;
+        return pop_from_mask(nonempty_mask & better_mask);
     }
 
     void push_front(Priority priority, const T& thread_id) {
         Queue* cur = &queues[priority];
         cur->data.push_front(thread_id);
+        nonempty_mask |= u64{1} << priority;
     }
 
     void push_back(Priority priority, const T& thread_id) {
         Queue* cur = &queues[priority];
         cur->data.push_back(thread_id);
+        nonempty_mask |= u64{1} << priority;
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
@@ -101,6 +80,9 @@ struct ThreadQueueList {
         Queue* const cur = &queues[priority];
         const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
         cur->data.erase(iter, cur->data.end());
+        if (cur->data.empty()) {
+            nonempty_mask &= ~(u64{1} << priority);
+        }
     }
 
     void rotate(Priority priority) {
@@ -115,6 +97,7 @@ struct ThreadQueueList {
     void clear() {
         queues.fill(Queue());
         first = nullptr;
+        nonempty_mask = 0;
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
@@ -141,6 +124,21 @@ private:
         return reinterpret_cast<Queue*>(1);
     }
 
+    /// Pops the front of the highest priority non-empty queue in the mask
+    T pop_from_mask(u64 mask) {
+        if (mask == 0) {
+            return T();
+        }
+        const Priority priority = LeastSignificantSetBit(mask);
+        Queue* cur = &queues[priority];
+        auto tmp = std::move(cur->data.front());
+        cur->data.pop_front();
+        if (cur->data.empty()) {
+            nonempty_mask &= ~(u64{1} << priority);
+        }
+        return tmp;
+    }
+
     void link(Priority priority) {
         Queue* cur = &queues[priority];
 
@@ -158,6 +156,9 @@ private:
 
     // The first queue that's ever been used.
     Queue* first;
+    // Bit i is set if the queue of priority level i is not empty. The lookups go through it, while
+    // the links between queues are kept for the savestate format.
+    u64 nonempty_mask = 0;
     // The priority level queues of thread ids.
     std::array<Queue, NUM_QUEUES> queues;
 
@@ -203,6 +204,13 @@ private:
             queues[i].next_nonempty = ToPointer(idx);
             ar >> queues[i].data;
         }
+
+        nonempty_mask = 0;
+        for (Priority i = 0; i < NUM_QUEUES; i++) {
+            if (!queues[i].data.empty()) {
+                nonempty_mask |= u64{1} << i;
+            }
+        }
     }
 
     BOOST_SERIALIZATION_SPLIT_MEMBER()
@@ -0,0 +1,95 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdint>
+#include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "common/assert.h"
+#include "common/virtual_buffer.h"
+
+namespace Common {
+
+#if !defined(_WIN32) && (defined(__SWITCH__) || !(defined(__unix__) || defined(__APPLE__)))
+#define VIRTUAL_BUFFER_USE_CALLOC
+#endif
+
+void* AllocateMemoryPages(std::size_t size) noexcept {
+    if (size == 0) {
+        return nullptr;
+    }
+#ifdef _WIN32
+    void* base = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    ASSERT_MSG(base != nullptr, "Failed to allocate {} bytes of memory pages", size);
+#elif defined(VIRTUAL_BUFFER_USE_CALLOC)
+    // Hosts without mmap get the closest thing, calloc usually maps large blocks on demand too
+    void* base = std::calloc(1, size);
+    ASSERT_MSG(base != nullptr, "Failed to allocate {} bytes of memory pages", size);
+#else
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+    // Untouched pages are not charged against the host's commit limit either
+    flags |= MAP_NORESERVE;
+#endif
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    ASSERT_MSG(base != MAP_FAILED, "Failed to allocate {} bytes of memory pages", size);
+#endif
+    return base;
+}
+
+void FreeMemoryPages(void* base, std::size_t size) noexcept {
+    if (base == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(base, 0, MEM_RELEASE);
+#elif defined(VIRTUAL_BUFFER_USE_CALLOC)
+    std::free(base);
+#else
+    munmap(base, size);
+#endif
+}
+
+std::size_t GetHostPageSize() noexcept {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#elif defined(VIRTUAL_BUFFER_USE_CALLOC)
+    return 0x1000;
+#else
+    static const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+#endif
+}
+
+bool MapFilePages(void* base, std::size_t size, const std::string& path,
+                  std::size_t offset) noexcept {
+#if defined(_WIN32) || defined(VIRTUAL_BUFFER_USE_CALLOC)
+    // Views of files cannot replace part of an existing allocation here
+    return false;
+#else
+    const std::size_t page_mask = GetHostPageSize() - 1;
+    if ((reinterpret_cast<std::uintptr_t>(base) & page_mask) != 0 || (size & page_mask) != 0 ||
+        (offset & page_mask) != 0 || size == 0) {
+        return false;
+    }
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    // The pages stay writable, a private mapping copies them on the first write
+    void* mapped = mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd,
+                        static_cast<off_t>(offset));
+    close(fd);
+    return mapped != MAP_FAILED;
+#endif
+}
+
+} // namespace Common
@@ -0,0 +1,72 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Allocates size bytes of zeroed memory straight from the host's virtual memory. The pages are
+ * zero-filled on demand by the host, so the ones that are never written use no physical memory.
+ */
+void* AllocateMemoryPages(std::size_t size) noexcept;
+
+/// Frees memory returned by AllocateMemoryPages
+void FreeMemoryPages(void* base, std::size_t size) noexcept;
+
+/// Returns the page size of the host, which the arguments of MapFilePages must be aligned to
+std::size_t GetHostPageSize() noexcept;
+
+/**
+ * Replaces the pages at base, which must be part of a block from AllocateMemoryPages, with a
+ * private mapping of size bytes of the file at path, from offset. Until they are written, the
+ * pages are the host's cached pages of the file, shared by every process that maps it.
+ * @returns false if the file could not be mapped, in which case the pages are left as they were
+ */
+bool MapFilePages(void* base, std::size_t size, const std::string& path,
+                  std::size_t offset) noexcept;
+
+/**
+ * Zero-initialized array in host virtual memory. Unlike std::vector or new[], allocating it does
+ * not write the memory, so large buffers that are mostly left untouched, like the emulated RAM,
+ * stay cheap.
+ */
+template <typename T>
+class VirtualBuffer final : NonCopyable {
+    static_assert(std::is_trivially_default_constructible_v<T> &&
+                      std::is_trivially_destructible_v<T>,
+                  "T must be trivial, as it is never constructed or destroyed");
+
+public:
+    VirtualBuffer() = default;
+    explicit VirtualBuffer(std::size_t count)
+        : base_ptr{static_cast<T*>(AllocateMemoryPages(count * sizeof(T)))}, count{count} {}
+
+    ~VirtualBuffer() {
+        FreeMemoryPages(base_ptr, count * sizeof(T));
+    }
+
+    T* get() {
+        return base_ptr;
+    }
+
+    const T* get() const {
+        return base_ptr;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+private:
+    T* base_ptr = nullptr;
+    std::size_t count = 0;
+};
+
+} // namespace Common
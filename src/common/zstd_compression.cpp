@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <zdict.h>
 #include <zstd.h>
 
 #include "common/assert.h"
@@ -34,12 +36,15 @@ std::vector<u8> CompressDataZSTDDefault(const u8* source, std::size_t source_siz
 }
 
 std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed) {
-    const std::size_t decompressed_size =
-        ZSTD_getDecompressedSize(compressed.data(), compressed.size());
+    return DecompressDataZSTD(compressed.data(), compressed.size());
+}
+
+std::vector<u8> DecompressDataZSTD(const u8* source, std::size_t source_size) {
+    const std::size_t decompressed_size = ZSTD_getDecompressedSize(source, source_size);
     std::vector<u8> decompressed(decompressed_size);
 
-    const std::size_t uncompressed_result_size = ZSTD_decompress(
-        decompressed.data(), decompressed.size(), compressed.data(), compressed.size());
+    const std::size_t uncompressed_result_size =
+        ZSTD_decompress(decompressed.data(), decompressed.size(), source, source_size);
 
     if (decompressed_size != uncompressed_result_size || ZSTD_isError(uncompressed_result_size)) {
         // Decompression failed
@@ -48,4 +53,173 @@ std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed) {
     return decompressed;
 }
 
+u32 GetDictionaryIDZSTD(const std::vector<u8>& dictionary) {
+    return ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+}
+
+std::vector<u8> TrainDictionaryZSTD(const std::vector<u8>& samples,
+                                    const std::vector<std::size_t>& sample_sizes,
+                                    std::size_t capacity) {
+    std::vector<u8> dictionary(capacity);
+    const std::size_t size =
+        ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(),
+                              sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+    if (ZDICT_isError(size)) {
+        return {};
+    }
+    dictionary.resize(size);
+    return dictionary;
+}
+
+ZSTDCompressBuffer::ZSTDCompressBuffer(Sink sink_)
+    : ZSTDCompressBuffer(std::move(sink_), ZSTD_CLEVEL_DEFAULT) {}
+
+ZSTDCompressBuffer::ZSTDCompressBuffer(Sink sink_, s32 compression_level)
+    : context(ZSTD_createCCtx()), sink(std::move(sink_)), output(ZSTD_CStreamOutSize()) {
+    compression_level = std::clamp(compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, compression_level);
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+ZSTDCompressBuffer::~ZSTDCompressBuffer() {
+    ZSTD_freeCCtx(context);
+}
+
+bool ZSTDCompressBuffer::SetDictionary(const std::vector<u8>& dictionary) {
+    return !ZSTD_isError(ZSTD_CCtx_loadDictionary(context, dictionary.data(), dictionary.size()));
+}
+
+void ZSTDCompressBuffer::SetWorkerCount(u32 num_workers) {
+    // Fails without multithreading support, which leaves compression on the calling thread
+    ZSTD_CCtx_setParameter(context, ZSTD_c_nbWorkers, static_cast<int>(num_workers));
+}
+
+bool ZSTDCompressBuffer::Finish() {
+    const std::size_t size = pptr() - pbase();
+    setp(nullptr, nullptr);
+    return Compress(buffer.data(), size, true) && !failed;
+}
+
+ZSTDCompressBuffer::int_type ZSTDCompressBuffer::overflow(int_type ch) {
+    if (!FlushBuffer()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize ZSTDCompressBuffer::xsputn(const char* data, std::streamsize size) {
+    if (size < static_cast<std::streamsize>(buffer.size())) {
+        return std::streambuf::xsputn(data, size);
+    }
+    if (!FlushBuffer() || !Compress(data, static_cast<std::size_t>(size), false)) {
+        return 0;
+    }
+    return size;
+}
+
+bool ZSTDCompressBuffer::FlushBuffer() {
+    if (pbase() == nullptr) {
+        // Written to after Finish
+        return false;
+    }
+    const std::size_t size = pptr() - pbase();
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return Compress(buffer.data(), size, false);
+}
+
+bool ZSTDCompressBuffer::Compress(const char* data, std::size_t size, bool end) {
+    if (failed) {
+        return false;
+    }
+
+    ZSTD_inBuffer in{data, size, 0};
+    while (true) {
+        ZSTD_outBuffer out{output.data(), output.size(), 0};
+        const std::size_t remaining =
+            ZSTD_compressStream2(context, &out, &in, end ? ZSTD_e_end : ZSTD_e_continue);
+        if (ZSTD_isError(remaining)) {
+            failed = true;
+            return false;
+        }
+        if (out.pos != 0) {
+            sink(output.data(), out.pos);
+        }
+        if (end ? remaining == 0 : in.pos == in.size) {
+            return true;
+        }
+    }
+}
+
+ZSTDDecompressBuffer::ZSTDDecompressBuffer(Source source_)
+    : context(ZSTD_createDCtx()), source(std::move(source_)), input(ZSTD_DStreamInSize()) {
+    setg(buffer.data(), buffer.data(), buffer.data());
+}
+
+ZSTDDecompressBuffer::~ZSTDDecompressBuffer() {
+    ZSTD_freeDCtx(context);
+}
+
+bool ZSTDDecompressBuffer::SetDictionary(const std::vector<u8>& dictionary) {
+    return !ZSTD_isError(ZSTD_DCtx_loadDictionary(context, dictionary.data(), dictionary.size()));
+}
+
+ZSTDDecompressBuffer::int_type ZSTDDecompressBuffer::underflow() {
+    if (gptr() == egptr()) {
+        const std::size_t size = Decompress(buffer.data(), buffer.size());
+        setg(buffer.data(), buffer.data(), buffer.data() + size);
+        if (size == 0) {
+            return traits_type::eof();
+        }
+    }
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize ZSTDDecompressBuffer::xsgetn(char* data, std::streamsize size) {
+    std::streamsize read = 0;
+    while (read < size) {
+        if (gptr() == egptr()) {
+            if (size - read >= static_cast<std::streamsize>(buffer.size())) {
+                return read + Decompress(data + read, static_cast<std::size_t>(size - read));
+            }
+            if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+                break;
+            }
+        }
+        const std::streamsize chunk = std::min<std::streamsize>(egptr() - gptr(), size - read);
+        std::memcpy(data + read, gptr(), static_cast<std::size_t>(chunk));
+        gbump(static_cast<int>(chunk));
+        read += chunk;
+    }
+    return read;
+}
+
+std::size_t ZSTDDecompressBuffer::Decompress(char* data, std::size_t size) {
+    ZSTD_outBuffer out{data, size, 0};
+    while (!failed && out.pos < out.size) {
+        if (input_pos == input_size && !source_ended) {
+            input_size = source(input.data(), input.size());
+            input_pos = 0;
+            source_ended = input_size == 0;
+        }
+
+        ZSTD_inBuffer in{input.data(), input_size, input_pos};
+        const std::size_t previous_pos = out.pos;
+        const std::size_t result = ZSTD_decompressStream(context, &out, &in);
+        if (ZSTD_isError(result)) {
+            failed = true;
+            break;
+        }
+        input_pos = in.pos;
+        if (source_ended && out.pos == previous_pos) {
+            // Everything that was buffered has been produced
+            break;
+        }
+    }
+    return out.pos;
+}
+
 } // namespace Common::Compression
@@ -4,10 +4,16 @@
 
 #pragma once
 
+#include <array>
+#include <functional>
+#include <streambuf>
 #include <vector>
 
 #include "common/common_types.h"
 
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
 namespace Common::Compression {
 
 /**
@@ -42,4 +48,125 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed);
 
+/**
+ * Decompresses a source memory region with Zstandard and returns the uncompressed data in a vector.
+ *
+ * @param source the compressed source memory region.
+ * @param source_size the size in bytes of the compressed source memory region.
+ *
+ * @return the decompressed data.
+ */
+[[nodiscard]] std::vector<u8> DecompressDataZSTD(const u8* source, std::size_t source_size);
+
+/**
+ * Returns the ID of a Zstandard dictionary, which identifies the dictionary data was compressed
+ * with. Returns 0 if the dictionary is empty or not in the format of trained dictionaries.
+ */
+[[nodiscard]] u32 GetDictionaryIDZSTD(const std::vector<u8>& dictionary);
+
+/**
+ * Trains a Zstandard dictionary for data resembling the samples.
+ *
+ * @param samples the samples, one after the other.
+ * @param sample_sizes the size in bytes of each sample.
+ * @param capacity the maximum size in bytes of the dictionary, about 100 KiB works well.
+ *
+ * @return the dictionary, or nothing if there were too few samples to train it.
+ */
+[[nodiscard]] std::vector<u8> TrainDictionaryZSTD(const std::vector<u8>& samples,
+                                                  const std::vector<std::size_t>& sample_sizes,
+                                                  std::size_t capacity);
+
+/**
+ * Output stream buffer that compresses what is written to it with Zstandard, at the default
+ * compression level unless another is given, handing the compressed data to a sink as it is
+ * produced. Large writes are compressed in place instead of being copied through the buffer. As
+ * the frame does not record its size, the output must be decompressed with ZSTDDecompressBuffer.
+ */
+class ZSTDCompressBuffer final : public std::streambuf {
+public:
+    /// Receives compressed data. May throw to abort the compression.
+    using Sink = std::function<void(const u8* data, std::size_t size)>;
+
+    explicit ZSTDCompressBuffer(Sink sink);
+    ZSTDCompressBuffer(Sink sink, s32 compression_level);
+    ~ZSTDCompressBuffer() override;
+
+    ZSTDCompressBuffer(const ZSTDCompressBuffer&) = delete;
+    ZSTDCompressBuffer& operator=(const ZSTDCompressBuffer&) = delete;
+
+    /**
+     * Compresses with a dictionary, which is copied. Must be called before anything is written.
+     * @return false if the dictionary could not be loaded.
+     */
+    [[nodiscard]] bool SetDictionary(const std::vector<u8>& dictionary);
+
+    /**
+     * Compresses on this many threads of Zstandard's own, or on the writing thread if it is 0.
+     * Must be called before anything is written. Has no effect if Zstandard was built without
+     * multithreading.
+     */
+    void SetWorkerCount(u32 num_workers);
+
+    /**
+     * Compresses the buffered data and ends the frame. Nothing may be written afterwards.
+     * @return false if compression failed at any point.
+     */
+    [[nodiscard]] bool Finish();
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize size) override;
+
+private:
+    bool Compress(const char* data, std::size_t size, bool end);
+    bool FlushBuffer();
+
+    ZSTD_CCtx_s* context;
+    Sink sink;
+    bool failed = false;
+    std::array<char, 0x10000> buffer;
+    std::vector<u8> output;
+};
+
+/**
+ * Input stream buffer that decompresses Zstandard data pulled from a source as it is read. Large
+ * reads are decompressed in place instead of being copied through the buffer.
+ */
+class ZSTDDecompressBuffer final : public std::streambuf {
+public:
+    /// Fills up to `size` bytes of compressed data, returning the amount filled or 0 at the end
+    using Source = std::function<std::size_t(u8* data, std::size_t size)>;
+
+    explicit ZSTDDecompressBuffer(Source source);
+    ~ZSTDDecompressBuffer() override;
+
+    ZSTDDecompressBuffer(const ZSTDDecompressBuffer&) = delete;
+    ZSTDDecompressBuffer& operator=(const ZSTDDecompressBuffer&) = delete;
+
+    /**
+     * Decompresses data compressed with a dictionary, which is copied. Must be called before
+     * anything is read.
+     * @return false if the dictionary could not be loaded.
+     */
+    [[nodiscard]] bool SetDictionary(const std::vector<u8>& dictionary);
+
+protected:
+    int_type underflow() override;
+    std::streamsize xsgetn(char* data, std::streamsize size) override;
+
+private:
+    /// Decompresses until `size` bytes are produced or the data ends, returning the amount produced
+    std::size_t Decompress(char* data, std::size_t size);
+
+    ZSTD_DCtx_s* context;
+    Source source;
+    bool failed = false;
+    bool source_ended = false;
+    std::array<char, 0x10000> buffer;
+    std::vector<u8> input;
+    std::size_t input_pos = 0;
+    std::size_t input_size = 0;
+};
+
 } // namespace Common::Compression
@@ -30,8 +30,17 @@ AnnounceMultiplayerSession::AnnounceMultiplayerSession() {
 #endif
 }
 
+AnnounceMultiplayerSession::AnnounceMultiplayerSession(std::weak_ptr<Network::Room> room)
+    : AnnounceMultiplayerSession() {
+    announced_room = std::move(room);
+}
+
+std::shared_ptr<Network::Room> AnnounceMultiplayerSession::LockRoom() const {
+    return announced_room ? announced_room->lock() : Network::GetRoom().lock();
+}
+
 Common::WebResult AnnounceMultiplayerSession::Register() {
-    std::shared_ptr<Network::Room> room = Network::GetRoom().lock();
+    std::shared_ptr<Network::Room> room = LockRoom();
     if (!room) {
         return Common::WebResult{Common::WebResult::Code::LibError, "Network is not initialized"};
     }
@@ -120,7 +129,7 @@ void AnnounceMultiplayerSession::AnnounceMultiplayerLoop() {
     std::future<Common::WebResult> future;
     while (!shutdown_event.WaitUntil(update_time)) {
         update_time += announce_time_interval;
-        std::shared_ptr<Network::Room> room = Network::GetRoom().lock();
+        std::shared_ptr<Network::Room> room = LockRoom();
         if (!room) {
             break;
         }
@@ -8,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <thread>
 #include "common/announce_multiplayer_room.h"
@@ -28,7 +29,10 @@ namespace Core {
 class AnnounceMultiplayerSession : NonCopyable {
 public:
     using CallbackHandle = std::shared_ptr<std::function<void(const Common::WebResult&)>>;
+    /// Announces the room returned by Network::GetRoom
     AnnounceMultiplayerSession();
+    /// Announces the given room, for processes hosting several rooms
+    explicit AnnounceMultiplayerSession(std::weak_ptr<Network::Room> room);
     ~AnnounceMultiplayerSession();
 
     /**
@@ -89,6 +93,10 @@ private:
 
     std::atomic_bool registered = false; ///< Whether the room has been registered
 
+    /// The announced room, if it is not the one returned by Network::GetRoom
+    std::optional<std::weak_ptr<Network::Room>> announced_room;
+
+    std::shared_ptr<Network::Room> LockRoom() const;
     void UpdateBackendData(std::shared_ptr<Network::Room> room);
     void AnnounceMultiplayerLoop();
 };
@@ -151,6 +151,13 @@ public:
      */
     virtual void SetReg(int index, u32 value) = 0;
 
+    /**
+     * Gets the general purpose registers r0-r15 as an array, for callers that access several of
+     * them in a row without going through GetReg and SetReg each time. The array stays valid until
+     * the core runs again, as a tiered core may hand the registers to another engine then.
+     */
+    virtual u32* GetRegisterFile() = 0;
+
     /**
      * Gets the value of a VFP register
      * @param index Register index (0-31)
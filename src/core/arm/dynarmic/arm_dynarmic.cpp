@@ -191,6 +191,10 @@ void ARM_Dynarmic::SetReg(int index, u32 value) {
     jit->Regs()[index] = value;
 }
 
+u32* ARM_Dynarmic::GetRegisterFile() {
+    return jit->Regs().data();
+}
+
 u32 ARM_Dynarmic::GetVFPReg(int index) const {
     return jit->ExtRegs()[index];
 }
@@ -11,6 +11,7 @@
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/memory.h"
 
 class DynComThreadContext final : public ARM_Interface::ThreadContext {
 public:
@@ -71,7 +72,7 @@ private:
 ARM_DynCom::ARM_DynCom(Core::System* system, Memory::MemorySystem& memory,
                        PrivilegeMode initial_mode, u32 id,
                        std::shared_ptr<Core::Timing::Timer> timer)
-    : ARM_Interface(id, timer), system(system) {
+    : ARM_Interface(id, timer), system(system), cache_generation(trans_cache_generation) {
     state = std::make_unique<ARMul_State>(system, memory, initial_mode);
 }
 
@@ -87,16 +88,56 @@ void ARM_DynCom::Step() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
+    // The translation buffer is shared with the other cores, so it is only reclaimed once full
     state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    instruction_caches.clear();
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    // Blocks end at the end of a page, so only blocks that start in the pages of the range can
+    // contain it. The page before is included too, for an instruction straddling a page boundary.
+    const u32 first_page = (start_address >> Memory::PAGE_BITS) - 1;
+    const u32 last_page = static_cast<u32>((start_address + length - 1) >> Memory::PAGE_BITS);
+    auto& cache = state->instruction_cache;
+    for (auto iter = cache.begin(); iter != cache.end();) {
+        const u32 page = iter->first >> Memory::PAGE_BITS;
+        if (page - first_page <= last_page - first_page) {
+            iter = cache.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
 }
 
 void ARM_DynCom::SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) {
-    ClearInstructionCache();
+    SyncCacheGeneration();
+    if (page_table == current_page_table) {
+        return;
+    }
+
+    // Each process has its own code at the same addresses, so its blocks are put aside until it
+    // runs again
+    instruction_caches[current_page_table] = std::move(state->instruction_cache);
+    state->instruction_cache.clear();
+    auto iter = instruction_caches.find(page_table);
+    if (iter != instruction_caches.end()) {
+        state->instruction_cache = std::move(iter->second);
+        instruction_caches.erase(iter);
+    }
+    current_page_table = page_table;
+}
+
+void ARM_DynCom::SyncCacheGeneration() {
+    if (cache_generation == trans_cache_generation) {
+        return;
+    }
+    state->instruction_cache.clear();
+    instruction_caches.clear();
+    cache_generation = trans_cache_generation;
 }
 
 std::shared_ptr<Memory::PageTable> ARM_DynCom::GetPageTable() const {
@@ -121,6 +162,10 @@ void ARM_DynCom::SetReg(int index, u32 value) {
     state->Reg[index] = value;
 }
 
+u32* ARM_DynCom::GetRegisterFile() {
+    return state->Reg.data();
+}
+
 u32 ARM_DynCom::GetVFPReg(int index) const {
     return state->ExtReg[index];
 }
@@ -154,6 +199,7 @@ void ARM_DynCom::SetCP15Register(CP15Register reg, u32 value) {
 }
 
 void ARM_DynCom::ExecuteInstructions(u64 num_instructions) {
+    SyncCacheGeneration();
     state->NumInstrsToExecute = num_instructions;
     unsigned ticks_executed = InterpreterMainLoop(state.get());
     if (system != nullptr) {
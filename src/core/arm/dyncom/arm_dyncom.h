@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <unordered_map>
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
@@ -15,8 +17,9 @@ class System;
 }
 
 namespace Memory {
+struct PageTable;
 class MemorySystem;
-}
+} // namespace Memory
 
 class ARM_DynCom final : public ARM_Interface {
 public:
@@ -35,6 +38,7 @@ public:
     u32 GetPC() const override;
     u32 GetReg(int index) const override;
     void SetReg(int index, u32 value) override;
+    u32* GetRegisterFile() override;
     u32 GetVFPReg(int index) const override;
     void SetVFPReg(int index, u32 value) override;
     u32 GetVFPSystemReg(VFPSystemRegister reg) const override;
@@ -58,6 +62,16 @@ protected:
 private:
     void ExecuteInstructions(u64 num_instructions);
 
+    /// Drops the translated blocks if the shared translation buffer has been reset since
+    void SyncCacheGeneration();
+
     Core::System* system;
     std::unique_ptr<ARMul_State> state;
+
+    std::shared_ptr<Memory::PageTable> current_page_table;
+    /// Translated blocks of the other page tables this core has run
+    std::map<std::shared_ptr<Memory::PageTable>, std::unordered_map<u32, std::size_t>>
+        instruction_caches;
+    /// Value of trans_cache_generation the translated blocks belong to
+    u64 cache_generation;
 };
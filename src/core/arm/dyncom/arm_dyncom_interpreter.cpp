@@ -840,8 +840,21 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     return inst_size;
 }
 
+/// Resets the translation cache once full. The other cores drop their blocks when they next run.
+static void ReserveTranslationSpace(ARMul_State* cpu) {
+#ifdef CITRA_MULTI_INSTANCE
+    AllocateTransCache();
+#endif
+    if (trans_cache_buf_top > TRANS_CACHE_SIZE - TRANS_CACHE_BLOCK_RESERVE) {
+        trans_cache_buf_top = 0;
+        ++trans_cache_generation;
+        cpu->instruction_cache.clear();
+    }
+}
+
 static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
+    ReserveTranslationSpace(cpu);
 
     // Decode instruction, get index
     // Allocate memory and init InsCream
@@ -875,6 +888,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
 
 static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
+    ReserveTranslationSpace(cpu);
 
     ARM_INST_PTR inst_base = nullptr;
     bb_start = trans_cache_buf_top;
@@ -1,4 +1,5 @@
 #include <cstdlib>
+#include <memory>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "core/arm/dyncom/arm_dyncom_trans.h"
@@ -6,8 +7,22 @@
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 
+#ifdef CITRA_MULTI_INSTANCE
+static thread_local std::unique_ptr<char[]> trans_cache_storage;
+thread_local char* trans_cache_buf = nullptr;
+
+void AllocateTransCache() {
+    if (!trans_cache_storage) {
+        // Left uninitialized, so that only the pages in use are committed
+        trans_cache_storage.reset(new char[TRANS_CACHE_SIZE]);
+        trans_cache_buf = trans_cache_storage.get();
+    }
+}
+#else
 char trans_cache_buf[TRANS_CACHE_SIZE];
-size_t trans_cache_buf_top = 0;
+#endif
+INSTANCE_LOCAL size_t trans_cache_buf_top = 0;
+INSTANCE_LOCAL u64 trans_cache_generation = 0;
 
 static void* AllocBuffer(std::size_t size) {
     std::size_t start = trans_cache_buf_top;
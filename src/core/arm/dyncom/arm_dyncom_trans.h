@@ -5,6 +5,7 @@
 #endif
 
 #include <cstddef>
+#include "common/common_funcs.h"
 #include "common/common_types.h"
 
 struct ARMul_State;
@@ -494,5 +495,15 @@ extern const transop_fp_t arm_instruction_trans[];
 extern const std::size_t arm_instruction_trans_len;
 
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
+// Space left free at the end of the cache for a block, which spans at most a page of instructions
+#define TRANS_CACHE_BLOCK_RESERVE (1024 * 1024)
+#ifdef CITRA_MULTI_INSTANCE
+// Each thread has a cache of its own, allocated by its first translation
+extern thread_local char* trans_cache_buf;
+void AllocateTransCache();
+#else
 extern char trans_cache_buf[TRANS_CACHE_SIZE];
-extern std::size_t trans_cache_buf_top;
+#endif
+extern INSTANCE_LOCAL std::size_t trans_cache_buf_top;
+// Incremented each time the cache is reset, invalidating the blocks translated before
+extern INSTANCE_LOCAL u64 trans_cache_generation;
@@ -252,8 +252,7 @@ public:
     unsigned bigendSig;
     unsigned syscallSig;
 
-    // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
-    // process for our purposes), not per ARMul_State (which tracks CPU core state).
+    // Translated blocks of the current process. ARM_DynCom keeps those of the other processes.
     std::unordered_map<u32, std::size_t> instruction_cache;
 
 private:
@@ -0,0 +1,175 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "core/arm/dynarmic/arm_dynarmic.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/skyeye_common/armstate.h"
+#include "core/arm/tiered/arm_tiered.h"
+#include "core/memory.h"
+
+MICROPROFILE_DEFINE(ARM_TierSwitch, "ARM", "Tier Switch", MP_RGB(255, 128, 64));
+
+/// Number of VFP registers in a thread context, as single precision words
+constexpr int NUM_VFP_REGISTERS = 64;
+
+ARM_Tiered::ARM_Tiered(Core::System* system, Memory::MemorySystem& memory, u32 id,
+                       std::shared_ptr<Core::Timing::Timer> timer)
+    : ARM_Interface(id, timer),
+      interpreter(std::make_unique<ARM_DynCom>(system, memory, USER32MODE, id, timer)),
+      jit(std::make_unique<ARM_Dynarmic>(system, memory, id, timer)), active(interpreter.get()) {}
+
+ARM_Tiered::~ARM_Tiered() = default;
+
+void ARM_Tiered::Run() {
+    u32& slices = page_slices[GetPC() >> Memory::PAGE_BITS];
+    if (slices < PROMOTION_THRESHOLD) {
+        ++slices;
+    }
+    SwitchTo(slices < PROMOTION_THRESHOLD ? static_cast<ARM_Interface&>(*interpreter)
+                                          : static_cast<ARM_Interface&>(*jit));
+    active->Run();
+}
+
+void ARM_Tiered::Step() {
+    active->Step();
+}
+
+void ARM_Tiered::ClearInstructionCache() {
+    interpreter->ClearInstructionCache();
+    jit->ClearInstructionCache();
+}
+
+void ARM_Tiered::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    interpreter->InvalidateCacheRange(start_address, length);
+    jit->InvalidateCacheRange(start_address, length);
+}
+
+void ARM_Tiered::SetPC(u32 pc) {
+    active->SetPC(pc);
+}
+
+u32 ARM_Tiered::GetPC() const {
+    return active->GetPC();
+}
+
+u32 ARM_Tiered::GetReg(int index) const {
+    return active->GetReg(index);
+}
+
+void ARM_Tiered::SetReg(int index, u32 value) {
+    active->SetReg(index, value);
+}
+
+u32* ARM_Tiered::GetRegisterFile() {
+    return active->GetRegisterFile();
+}
+
+u32 ARM_Tiered::GetVFPReg(int index) const {
+    return active->GetVFPReg(index);
+}
+
+void ARM_Tiered::SetVFPReg(int index, u32 value) {
+    active->SetVFPReg(index, value);
+}
+
+u32 ARM_Tiered::GetVFPSystemReg(VFPSystemRegister reg) const {
+    return active->GetVFPSystemReg(reg);
+}
+
+void ARM_Tiered::SetVFPSystemReg(VFPSystemRegister reg, u32 value) {
+    active->SetVFPSystemReg(reg, value);
+}
+
+u32 ARM_Tiered::GetCPSR() const {
+    return active->GetCPSR();
+}
+
+void ARM_Tiered::SetCPSR(u32 cpsr) {
+    active->SetCPSR(cpsr);
+}
+
+u32 ARM_Tiered::GetCP15Register(CP15Register reg) const {
+    return active->GetCP15Register(reg);
+}
+
+void ARM_Tiered::SetCP15Register(CP15Register reg, u32 value) {
+    active->SetCP15Register(reg, value);
+}
+
+std::unique_ptr<ARM_Interface::ThreadContext> ARM_Tiered::NewContext() const {
+    return jit->NewContext();
+}
+
+void ARM_Tiered::SaveContext(const std::unique_ptr<ThreadContext>& arg) {
+    if (active == jit.get()) {
+        jit->SaveContext(arg);
+        return;
+    }
+    for (int i = 0; i < 16; ++i) {
+        arg->SetCpuRegister(i, interpreter->GetReg(i));
+    }
+    arg->SetCpsr(interpreter->GetCPSR());
+    for (int i = 0; i < NUM_VFP_REGISTERS; ++i) {
+        arg->SetFpuRegister(i, interpreter->GetVFPReg(i));
+    }
+    arg->SetFpscr(interpreter->GetVFPSystemReg(VFP_FPSCR));
+    arg->SetFpexc(interpreter->GetVFPSystemReg(VFP_FPEXC));
+}
+
+void ARM_Tiered::LoadContext(const std::unique_ptr<ThreadContext>& arg) {
+    if (active == jit.get()) {
+        jit->LoadContext(arg);
+        return;
+    }
+    for (int i = 0; i < 16; ++i) {
+        interpreter->SetReg(i, arg->GetCpuRegister(i));
+    }
+    interpreter->SetCPSR(arg->GetCpsr());
+    for (int i = 0; i < NUM_VFP_REGISTERS; ++i) {
+        interpreter->SetVFPReg(i, arg->GetFpuRegister(i));
+    }
+    interpreter->SetVFPSystemReg(VFP_FPSCR, arg->GetFpscr());
+    interpreter->SetVFPSystemReg(VFP_FPEXC, arg->GetFpexc());
+}
+
+void ARM_Tiered::SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) {
+    current_page_table = page_table;
+    interpreter->SetPageTable(page_table);
+    jit->SetPageTable(page_table);
+}
+
+void ARM_Tiered::PrepareReschedule() {
+    active->PrepareReschedule();
+}
+
+void ARM_Tiered::PurgeState() {
+    interpreter->PurgeState();
+    jit->PurgeState();
+}
+
+std::shared_ptr<Memory::PageTable> ARM_Tiered::GetPageTable() const {
+    return current_page_table;
+}
+
+void ARM_Tiered::SwitchTo(ARM_Interface& engine) {
+    if (active == &engine) {
+        return;
+    }
+    MICROPROFILE_SCOPE(ARM_TierSwitch);
+
+    // The CPSR goes first, as it decides how the engines treat the PC
+    engine.SetCPSR(active->GetCPSR());
+    for (int i = 0; i < 16; ++i) {
+        engine.SetReg(i, active->GetReg(i));
+    }
+    for (int i = 0; i < NUM_VFP_REGISTERS; ++i) {
+        engine.SetVFPReg(i, active->GetVFPReg(i));
+    }
+    engine.SetVFPSystemReg(VFP_FPSCR, active->GetVFPSystemReg(VFP_FPSCR));
+    engine.SetVFPSystemReg(VFP_FPEXC, active->GetVFPSystemReg(VFP_FPEXC));
+    engine.SetCP15Register(CP15_THREAD_UPRW, active->GetCP15Register(CP15_THREAD_UPRW));
+    engine.SetCP15Register(CP15_THREAD_URO, active->GetCP15Register(CP15_THREAD_URO));
+    active = &engine;
+}
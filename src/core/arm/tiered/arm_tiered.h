@@ -0,0 +1,82 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include "common/common_types.h"
+#include "core/arm/arm_interface.h"
+
+namespace Memory {
+struct PageTable;
+class MemorySystem;
+} // namespace Memory
+
+namespace Core {
+class System;
+}
+
+class ARM_DynCom;
+class ARM_Dynarmic;
+
+/**
+ * Runs code in the interpreter until enough slices have started in its page for the JIT to be
+ * worth its compile time, and in the JIT from then on. Code that only runs a few times, such as
+ * init routines and loaders, thus never gets compiled. Both engines share the timer and the thread
+ * contexts, which are the ones of the JIT, and the registers move over when the engine changes.
+ */
+class ARM_Tiered final : public ARM_Interface {
+public:
+    ARM_Tiered(Core::System* system, Memory::MemorySystem& memory, u32 id,
+               std::shared_ptr<Core::Timing::Timer> timer);
+    ~ARM_Tiered() override;
+
+    void Run() override;
+    void Step() override;
+
+    void ClearInstructionCache() override;
+    void InvalidateCacheRange(u32 start_address, std::size_t length) override;
+
+    void SetPC(u32 pc) override;
+    u32 GetPC() const override;
+    u32 GetReg(int index) const override;
+    void SetReg(int index, u32 value) override;
+    u32* GetRegisterFile() override;
+    u32 GetVFPReg(int index) const override;
+    void SetVFPReg(int index, u32 value) override;
+    u32 GetVFPSystemReg(VFPSystemRegister reg) const override;
+    void SetVFPSystemReg(VFPSystemRegister reg, u32 value) override;
+    u32 GetCPSR() const override;
+    void SetCPSR(u32 cpsr) override;
+    u32 GetCP15Register(CP15Register reg) const override;
+    void SetCP15Register(CP15Register reg, u32 value) override;
+
+    std::unique_ptr<ThreadContext> NewContext() const override;
+    void SaveContext(const std::unique_ptr<ThreadContext>& arg) override;
+    void LoadContext(const std::unique_ptr<ThreadContext>& arg) override;
+
+    void SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) override;
+    void PrepareReschedule() override;
+    void PurgeState() override;
+
+protected:
+    std::shared_ptr<Memory::PageTable> GetPageTable() const override;
+
+private:
+    /// Slices that start in a code page before the page runs in the JIT
+    static constexpr u32 PROMOTION_THRESHOLD = 32;
+
+    /// Makes engine the active one, moving the registers over if it wasn't
+    void SwitchTo(ARM_Interface& engine);
+
+    std::unique_ptr<ARM_DynCom> interpreter;
+    std::unique_ptr<ARM_Dynarmic> jit;
+    /// Engine that holds the current registers
+    ARM_Interface* active;
+
+    std::shared_ptr<Memory::PageTable> current_page_table;
+    /// Slices started in each code page, counted up to PROMOTION_THRESHOLD
+    std::unordered_map<u32, u32> page_slices;
+};
@@ -3,9 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
-#include <cmath>
 #include <fstream>
 #include <functional>
+#include <optional>
 #include <string>
 #include <vector>
 #include "common/file_util.h"
@@ -29,7 +29,7 @@ struct State {
 };
 
 template <typename T, typename ReadFunction, typename WriteFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat::CheatLine& line,
+static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat::Instruction& line,
                                                               const State& state,
                                                               ReadFunction read_func,
                                                               WriteFunction write_func,
@@ -43,7 +43,7 @@ static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat
 }
 
 template <typename T, typename ReadFunction, typename CompareFunc>
-static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat::CheatLine& line,
+static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat::Instruction& line,
                                                              State& state, ReadFunction read_func,
                                                              CompareFunc comp) {
     u32 addr = line.address + state.offset;
@@ -53,13 +53,13 @@ static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat:
     }
 }
 
-static inline void LoadOffsetOp(Memory::MemorySystem& memory, const GatewayCheat::CheatLine& line,
+static inline void LoadOffsetOp(Memory::MemorySystem& memory, const GatewayCheat::Instruction& line,
                                 State& state) {
     u32 addr = line.address + state.offset;
     state.offset = memory.Read32(addr);
 }
 
-static inline void LoopOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void LoopOp(const GatewayCheat::Instruction& line, State& state) {
     state.loop_flag = state.loop_count < line.value;
     state.loop_count++;
     state.loop_back_line = state.current_line_nr;
@@ -91,21 +91,21 @@ static inline void FullTerminateOp(State& state) {
     }
 }
 
-static inline void SetOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void SetOffsetOp(const GatewayCheat::Instruction& line, State& state) {
     state.offset = line.value;
 }
 
-static inline void AddValueOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void AddValueOp(const GatewayCheat::Instruction& line, State& state) {
     state.reg += line.value;
 }
 
-static inline void SetValueOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void SetValueOp(const GatewayCheat::Instruction& line, State& state) {
     state.reg = line.value;
 }
 
 template <typename T, typename ReadFunction, typename WriteFunction>
 static inline std::enable_if_t<std::is_integral_v<T>> IncrementiveWriteOp(
-    const GatewayCheat::CheatLine& line, State& state, ReadFunction read_func,
+    const GatewayCheat::Instruction& line, State& state, ReadFunction read_func,
     WriteFunction write_func, Core::System& system) {
     u32 addr = line.value + state.offset;
     T val = read_func(addr);
@@ -117,64 +117,36 @@ static inline std::enable_if_t<std::is_integral_v<T>> IncrementiveWriteOp(
 }
 
 template <typename T, typename ReadFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const GatewayCheat::CheatLine& line,
+static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const GatewayCheat::Instruction& line,
                                                              State& state, ReadFunction read_func) {
 
     u32 addr = line.value + state.offset;
     state.reg = read_func(addr);
 }
 
-static inline void AddOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void AddOffsetOp(const GatewayCheat::Instruction& line, State& state) {
     state.offset += line.value;
 }
 
-static inline void JokerOp(const GatewayCheat::CheatLine& line, State& state,
-                           const Core::System& system) {
-    u32 pad_state = system.ServiceManager()
-                        .GetService<Service::HID::Module::Interface>("hid:USER")
-                        ->GetModule()
-                        ->GetState()
-                        .hex;
+static inline void JokerOp(const GatewayCheat::Instruction& line, State& state, u32 pad_state) {
     bool pressed = (pad_state & line.value) == line.value;
     if (!pressed) {
         state.if_flag++;
     }
 }
 
-static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Core::System& system,
-                           const std::vector<GatewayCheat::CheatLine>& cheat_lines) {
-    if (state.if_flag > 0) {
-        // Skip over the additional patch lines
-        state.current_line_nr += static_cast<int>(std::ceil(line.value / 8.0));
-        return;
-    }
-    u32 num_bytes = line.value;
+static inline void PatchOp(const GatewayCheat::Instruction& line, const State& state,
+                           Core::System& system, const std::vector<u32>& patch_words) {
+    u32 num_bytes = line.patch_size;
     u32 addr = line.address + state.offset;
     system.InvalidateCacheRange(addr, num_bytes);
 
-    bool first = true;
-    u32 bit_offset = 0;
-    if (num_bytes > 0)
-        state.current_line_nr++; // skip over the current code
-    while (num_bytes >= 4) {
-        u32 tmp = first ? cheat_lines[state.current_line_nr].first
-                        : cheat_lines[state.current_line_nr].value;
-        if (!first && num_bytes > 4) {
-            state.current_line_nr++;
-        }
-        first = !first;
-        system.Memory().Write32(addr, tmp);
-        addr += 4;
-        num_bytes -= 4;
+    const u32* word = patch_words.data() + line.patch_offset;
+    for (; num_bytes >= 4; num_bytes -= 4, addr += 4, ++word) {
+        system.Memory().Write32(addr, *word);
     }
-    while (num_bytes > 0) {
-        u32 tmp = (first ? cheat_lines[state.current_line_nr].first
-                         : cheat_lines[state.current_line_nr].value) >>
-                  bit_offset;
-        system.Memory().Write8(addr, tmp);
-        addr += 1;
-        num_bytes -= 1;
-        bit_offset += 8;
+    for (u32 bit_offset = 0; num_bytes > 0; --num_bytes, ++addr, bit_offset += 8) {
+        system.Memory().Write8(addr, static_cast<u8>(*word >> bit_offset));
     }
 }
 
@@ -209,6 +181,7 @@ GatewayCheat::CheatLine::CheatLine(const std::string& line) {
 GatewayCheat::GatewayCheat(std::string name_, std::vector<CheatLine> cheat_lines_,
                            std::string comments_)
     : name(std::move(name_)), cheat_lines(std::move(cheat_lines_)), comments(std::move(comments_)) {
+    Compile();
 }
 
 GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comments_)
@@ -223,10 +196,41 @@ GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comm
             temp_cheat_lines.emplace_back(code_lines[i]);
     }
     cheat_lines = std::move(temp_cheat_lines);
+    Compile();
 }
 
 GatewayCheat::~GatewayCheat() = default;
 
+void GatewayCheat::Compile() {
+    program.clear();
+    patch_words.clear();
+    program.reserve(cheat_lines.size());
+
+    for (std::size_t i = 0; i < cheat_lines.size(); ++i) {
+        const CheatLine& line = cheat_lines[i];
+        Instruction& instruction = program.emplace_back();
+        instruction.type = line.type;
+        instruction.address = line.valid ? line.address : 0;
+        instruction.value = line.valid ? line.value : 0;
+        if (line.type != CheatType::Patch) {
+            continue;
+        }
+
+        // EXXXXXXX YYYYYYYY is followed by ceil(YYYYYYYY / 8) lines of data, which are written
+        // as words in the order they appear. Patches are cut short at the end of the cheat.
+        const std::size_t num_data_lines = static_cast<std::size_t>(
+            std::min<u64>((static_cast<u64>(line.value) + 7) / 8, cheat_lines.size() - i - 1));
+        instruction.patch_offset = static_cast<u32>(patch_words.size());
+        instruction.patch_size = static_cast<u32>(std::min<u64>(line.value, num_data_lines * 8));
+        for (std::size_t data_line = i + 1; data_line <= i + num_data_lines; ++data_line) {
+            const CheatLine& data = cheat_lines[data_line];
+            patch_words.push_back(data.valid ? data.first : 0);
+            patch_words.push_back(data.valid ? data.value : 0);
+        }
+        i += num_data_lines;
+    }
+}
+
 void GatewayCheat::Execute(Core::System& system) const {
     State state;
 
@@ -238,9 +242,17 @@ void GatewayCheat::Execute(Core::System& system) const {
     auto Write16 = [&memory](VAddr addr, u16 value) { memory.Write16(addr, value); };
     auto Write32 = [&memory](VAddr addr, u32 value) { memory.Write32(addr, value); };
 
-    for (state.current_line_nr = 0; state.current_line_nr < cheat_lines.size();
+    std::optional<u32> pad_state;
+    const auto GetPadState = [&system, &pad_state] {
+        if (!pad_state) {
+            pad_state = Service::HID::GetModule(system)->GetState().hex;
+        }
+        return *pad_state;
+    };
+
+    for (state.current_line_nr = 0; state.current_line_nr < program.size();
          state.current_line_nr++) {
-        auto line = cheat_lines[state.current_line_nr];
+        const Instruction& line = program[state.current_line_nr];
         if (state.if_flag > 0) {
             switch (line.type) {
             case CheatType::GreaterThan32:
@@ -255,12 +267,6 @@ void GatewayCheat::Execute(Core::System& system) const {
                 // Increment the if_flag to handle the end if correctly
                 state.if_flag++;
                 break;
-            case CheatType::Patch:
-                // EXXXXXXX YYYYYYYY
-                // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-                // We need to call this here to skip the additional patch lines
-                PatchOp(line, state, system, cheat_lines);
-                break;
             case CheatType::Terminator:
                 // D0000000 00000000 - ENDIF
                 TerminateOp(state);
@@ -409,13 +415,13 @@ void GatewayCheat::Execute(Core::System& system) const {
         }
         case CheatType::Joker: {
             // DD000000 XXXXXXXX – if KEYPAD has value XXXXXXXX execute next block
-            JokerOp(line, state, system);
+            JokerOp(line, state, GetPadState());
             break;
         }
         case CheatType::Patch: {
             // EXXXXXXX YYYYYYYY
             // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-            PatchOp(line, state, system, cheat_lines);
+            PatchOp(line, state, system, patch_words);
             break;
         }
         }
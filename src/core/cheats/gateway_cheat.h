@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 #include "core/cheats/cheat_base.h"
 
 namespace Cheats {
@@ -53,6 +54,16 @@ public:
         bool valid = true;
     };
 
+    /// A cheat line as Execute runs it, with the data of patches gathered at construction
+    struct Instruction {
+        CheatType type;
+        u32 address;
+        u32 value;
+        /// Index of the first patch word and number of bytes to write, for patches
+        u32 patch_offset = 0;
+        u32 patch_size = 0;
+    };
+
     GatewayCheat(std::string name, std::vector<CheatLine> cheat_lines, std::string comments);
     GatewayCheat(std::string name, std::string code, std::string comments);
     ~GatewayCheat();
@@ -78,9 +89,16 @@ public:
     static std::vector<std::unique_ptr<CheatBase>> LoadFile(const std::string& filepath);
 
 private:
+    /// Translates the cheat lines into the program Execute runs
+    void Compile();
+
     std::atomic<bool> enabled = false;
     const std::string name;
     std::vector<CheatLine> cheat_lines;
     const std::string comments;
+
+    std::vector<Instruction> program;
+    /// The data lines of all the patches, as the words they are written as
+    std::vector<u32> patch_words;
 };
 } // namespace Cheats
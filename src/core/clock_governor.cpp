@@ -0,0 +1,89 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/logging/log.h"
+#include "core/clock_governor.h"
+#include "core/core_timing.h"
+#include "core/hw/gpu.h"
+#include "core/perf_stats.h"
+
+namespace Core {
+
+namespace {
+
+/// System frames over which the load is measured before each adjustment
+constexpr u32 WindowFrames = 30;
+
+/// Clock percentage added or removed at each adjustment
+constexpr u32 Step = 25;
+
+/// The guest is overclocked when it idles less than this share of its cycles
+constexpr double BusyIdleShare = 0.05;
+
+/// It is underclocked when it would still idle this share of its cycles at the lower clock
+constexpr double SpareIdleShare = 0.15;
+
+/// Share of the frame length that the host may spend emulating before it stops overclocking
+constexpr double HostHeadroom = 0.85;
+
+/// The application runs on the first core, whose idle time tells whether it waits for the frame
+constexpr std::size_t ApplicationCore = 0;
+
+} // Anonymous namespace
+
+ClockGovernor::ClockGovernor(Timing& timing, const PerfStats& perf_stats, u32 initial_percentage,
+                             u32 min_percentage, u32 max_percentage)
+    : timing(timing), perf_stats(perf_stats),
+      min_percentage(std::min(min_percentage, max_percentage)),
+      max_percentage(std::max(min_percentage, max_percentage)) {
+    percentage = std::clamp(initial_percentage, this->min_percentage, this->max_percentage);
+    timing.UpdateClockSpeed(percentage);
+
+    const auto timer = timing.GetTimer(ApplicationCore);
+    window_start_ticks = timer->GetTicks();
+    window_start_idle_ticks = timer->GetTotalIdleTicks();
+}
+
+void ClockGovernor::EndSystemFrame(bool deterministic) {
+    window_host_time += perf_stats.GetLastFrametime();
+    if (++window_frames < WindowFrames) {
+        return;
+    }
+
+    const auto timer = timing.GetTimer(ApplicationCore);
+    const u64 ticks = timer->GetTicks() - window_start_ticks;
+    const u64 idle_ticks = timer->GetTotalIdleTicks() - window_start_idle_ticks;
+    const double idle_share = ticks == 0 ? 0.0 : static_cast<double>(idle_ticks) / ticks;
+    const double host_load = window_host_time * GPU::SCREEN_REFRESH_RATE / window_frames;
+
+    window_frames = 0;
+    window_start_ticks = timer->GetTicks();
+    window_start_idle_ticks = timer->GetTotalIdleTicks();
+    window_host_time = 0.0;
+
+    u32 new_percentage = percentage;
+    if (idle_share < BusyIdleShare) {
+        if (deterministic || host_load < HostHeadroom) {
+            new_percentage = std::min(percentage + Step, max_percentage);
+        }
+    } else if (percentage > min_percentage) {
+        // The busy cycles take a larger share of the clock once it is lowered
+        const u32 lower = std::max(percentage - std::min(percentage, Step), min_percentage);
+        const double lower_idle_share = 1.0 - (1.0 - idle_share) * percentage / lower;
+        if (lower_idle_share >= SpareIdleShare) {
+            new_percentage = lower;
+        }
+    }
+
+    // The clock is applied again, in case the settings were applied in the meantime
+    if (new_percentage != percentage) {
+        LOG_DEBUG(Core, "CPU clock {}% -> {}% (idle {:.1f}%, host load {:.1f}%)", percentage,
+                  new_percentage, idle_share * 100.0, host_load * 100.0);
+        percentage = new_percentage;
+    }
+    timing.UpdateClockSpeed(percentage);
+}
+
+} // namespace Core
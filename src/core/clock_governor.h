@@ -0,0 +1,49 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Core {
+
+class PerfStats;
+class Timing;
+
+/**
+ * Adjusts the emulated CPU clock to the load of the guest. Over each window of system frames, the
+ * share of cycles that the application core spent idle is measured. A guest that hardly idles is
+ * overclocked, as long as the host keeps up, and a guest that idles a lot is brought back down,
+ * within the configured bounds. When the run has to be deterministic, as when playing a movie or
+ * in netplay, the clock only follows the guest measurements, which every run shares.
+ */
+class ClockGovernor {
+public:
+    ClockGovernor(Timing& timing, const PerfStats& perf_stats, u32 initial_percentage,
+                  u32 min_percentage, u32 max_percentage);
+
+    /**
+     * Measures the system frame that just ended, and adjusts the clock at the end of a window.
+     * @param deterministic Whether the host performance must not affect the clock
+     */
+    void EndSystemFrame(bool deterministic);
+
+    [[nodiscard]] u32 GetClockPercentage() const {
+        return percentage;
+    }
+
+private:
+    Timing& timing;
+    const PerfStats& perf_stats;
+    u32 percentage;
+    u32 min_percentage;
+    u32 max_percentage;
+
+    u32 window_frames = 0;
+    u64 window_start_ticks;
+    u64 window_start_idle_ticks;
+    double window_host_time = 0.0;
+};
+
+} // namespace Core
@@ -12,12 +12,15 @@
 #include "audio_core/lle/lle.h"
 #include "common/logging/log.h"
 #include "common/texture.h"
+#include "common/thread.h"
 #include "core/arm/arm_interface.h"
 #if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
 #include "core/arm/dynarmic/arm_dynarmic.h"
+#include "core/arm/tiered/arm_tiered.h"
 #endif
 #include "core/arm/dyncom/arm_dyncom.h"
 #include "core/cheats/cheats.h"
+#include "core/clock_governor.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/dumping/backend.h"
@@ -42,16 +45,20 @@
 #include "core/hw/hw.h"
 #include "core/hw/lcd.h"
 #include "core/loader/loader.h"
+#include "core/memory_watch.h"
 #include "core/movie.h"
+#include "core/rewind_buffer.h"
 #include "core/rpc/rpc_server.h"
 #include "core/settings.h"
+#include "core/state_hash_log.h"
+#include "core/title_profile.h"
 #include "network/network.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 namespace Core {
 
-/*static*/ System System::s_instance;
+/*static*/ INSTANCE_LOCAL System System::s_instance;
 
 template <>
 Core::System& Global() {
@@ -68,21 +75,45 @@ Core::Timing& Global() {
     return System::GetInstance().CoreTiming();
 }
 
-System::~System() = default;
+System::~System() {
+    WaitForSaveState();
+}
 
 System::ResultStatus System::RunLoop(bool tight_loop) {
     status = ResultStatus::Success;
+    // The frontend decides which thread emulates, so it is registered on its first frame
+    Common::SetCurrentThreadRole(Common::ThreadRole::Emulation);
+    if (std::any_of(cpu_cores.begin(), cpu_cores.end(),
+                    [](std::shared_ptr<ARM_Interface> ptr) { return ptr == nullptr; })) {
+        return ResultStatus::ErrorNotInitialized;
+    }
+    return RunSlice(tight_loop);
+}
+
+System::ResultStatus System::RunUntil(const std::function<bool()>& done) {
+    Common::SetCurrentThreadRole(Common::ThreadRole::Emulation);
     if (std::any_of(cpu_cores.begin(), cpu_cores.end(),
                     [](std::shared_ptr<ARM_Interface> ptr) { return ptr == nullptr; })) {
         return ResultStatus::ErrorNotInitialized;
     }
 
+    ResultStatus result = ResultStatus::Success;
+    do {
+        status = ResultStatus::Success;
+        result = RunSlice(true);
+    } while (result == ResultStatus::Success && !GDBStub::IsServerEnabled() && !done());
+    return result;
+}
+
+System::ResultStatus System::RunSlice(bool tight_loop) {
     if (GDBStub::IsServerEnabled()) {
-        Kernel::Thread* thread = kernel->GetCurrentThreadManager().GetCurrentThread();
-        if (thread && running_core) {
-            running_core->SaveContext(thread->context);
+        if (GDBStub::HasPendingPacket()) {
+            Kernel::Thread* thread = kernel->GetCurrentThreadManager().GetCurrentThread();
+            if (thread && running_core) {
+                running_core->SaveContext(thread->context);
+            }
+            GDBStub::HandlePacket();
         }
-        GDBStub::HandlePacket();
 
         // If the loop is halted and we want to step, use a tiny (1) number of instructions to
         // execute. Otherwise, get out of the loop function.
@@ -95,15 +126,14 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         }
     }
 
+    // Signals are rare, so the mutex is only taken once one has been sent
     Signal signal{Signal::None};
     u32 param{};
-    {
+    if (current_signal.load(std::memory_order_acquire) != Signal::None) {
         std::lock_guard lock{signal_mutex};
-        if (current_signal != Signal::None) {
-            signal = current_signal;
-            param = signal_param;
-            current_signal = Signal::None;
-        }
+        signal = current_signal.load(std::memory_order_relaxed);
+        param = signal_param;
+        current_signal.store(Signal::None, std::memory_order_relaxed);
     }
     switch (signal) {
     case Signal::Reset:
@@ -124,6 +154,19 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         frame_limiter.WaitOnce();
         return ResultStatus::Success;
     }
+    case Signal::Rewind: {
+        try {
+            if (!System::Rewind()) {
+                LOG_INFO(Core, "No rewind snapshot left");
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error rewinding: {}", e.what());
+            status_details = e.what();
+            return ResultStatus::ErrorSavestate;
+        }
+        frame_limiter.WaitOnce();
+        return ResultStatus::Success;
+    }
     case Signal::Save: {
         LOG_INFO(Core, "Begin save");
         try {
@@ -137,10 +180,50 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         frame_limiter.WaitOnce();
         return ResultStatus::Success;
     }
+    case Signal::SaveDelta: {
+        LOG_INFO(Core, "Begin delta save");
+        try {
+            System::SaveDeltaState(param);
+            LOG_INFO(Core, "Delta save completed");
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error saving: {}", e.what());
+            status_details = e.what();
+            return ResultStatus::ErrorSavestate;
+        }
+        frame_limiter.WaitOnce();
+        return ResultStatus::Success;
+    }
     default:
         break;
     }
 
+    if (!boot_snapshot_path.empty() &&
+        (Settings::values.boot_snapshot_frame == 0
+             ? service_request_seen
+             : perf_stats->GetSystemFrameCount() >= Settings::values.boot_snapshot_frame)) {
+        try {
+            SaveBootSnapshot();
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error saving the boot snapshot: {}", e.what());
+        }
+    }
+
+    if (rewind_buffer &&
+        perf_stats->GetSystemFrameCount() - rewind_frame >= Settings::values.rewind_interval) {
+        rewind_frame = perf_stats->GetSystemFrameCount();
+        CaptureRewindState();
+    }
+
+    if (clock_governor && perf_stats->GetSystemFrameCount() != clock_governor_frame) {
+        clock_governor_frame = perf_stats->GetSystemFrameCount();
+        // Movies and netplay need every run to pick the same clock for the same inputs
+        const auto room_member = Network::GetRoomMember().lock();
+        const bool deterministic =
+            Movie::GetInstance().GetPlayMode() != Movie::PlayMode::None ||
+            (room_member && room_member->IsConnected());
+        clock_governor->EndSystemFrame(deterministic);
+    }
+
     // All cores should have executed the same amount of ticks. If this is not the case an event was
     // scheduled with a cycles_into_future smaller then the current downcount.
     // So we have to get those cores to the same global time first
@@ -179,11 +262,13 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             current_core_to_execute->GetTimer().Idle();
             PrepareReschedule();
         } else {
+            const auto run_start = PerfStats::Clock::now();
             if (tight_loop) {
                 current_core_to_execute->Run();
             } else {
                 current_core_to_execute->Step();
             }
+            perf_stats->AddCpuTime(PerfStats::Clock::now() - run_start);
         }
     } else {
         // Now all cores are at the same global time. So we will run them one after the other
@@ -211,11 +296,13 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
                 cpu_core->GetTimer().Idle();
                 PrepareReschedule();
             } else {
+                const auto run_start = PerfStats::Clock::now();
                 if (tight_loop) {
                     cpu_core->Run();
                 } else {
                     cpu_core->Step();
                 }
+                perf_stats->AddCpuTime(PerfStats::Clock::now() - run_start);
             }
             max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
         }
@@ -233,12 +320,13 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
 
 bool System::SendSignal(System::Signal signal, u32 param) {
     std::lock_guard lock{signal_mutex};
-    if (current_signal != signal && current_signal != Signal::None) {
-        LOG_ERROR(Core, "Unable to {} as {} is ongoing", signal, current_signal);
+    const Signal ongoing = current_signal.load(std::memory_order_relaxed);
+    if (ongoing != signal && ongoing != Signal::None) {
+        LOG_ERROR(Core, "Unable to {} as {} is ongoing", signal, ongoing);
         return false;
     }
-    current_signal = signal;
     signal_param = param;
+    current_signal.store(signal, std::memory_order_release);
     return true;
 }
 
@@ -253,6 +341,10 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
         LOG_CRITICAL(Core, "Failed to obtain loader for {}!", filepath);
         return ResultStatus::ErrorGetLoader;
     }
+    if (u64 program_id = 0;
+        app_loader->ReadProgramId(program_id) == Loader::ResultStatus::Success) {
+        ApplyTitleProfile(program_id);
+    }
     std::pair<std::optional<u32>, Loader::ResultStatus> system_mode =
         app_loader->LoadKernelSystemMode();
 
@@ -316,6 +408,10 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
         FileUtil::CreateFullPath(fmt::format(
             "{}textures/{:016X}/", FileUtil::GetUserPath(FileUtil::UserPath::LoadDir), program_id));
         custom_tex_cache->FindCustomTextures(program_id);
+        // Preloading already decodes all of them up front
+        if (!Settings::values.preload_textures) {
+            custom_tex_cache->EnablePrefetching(program_id, GetImageInterface());
+        }
     }
     if (Settings::values.preload_textures) {
         custom_tex_cache->PreloadTextures(*GetImageInterface());
@@ -325,20 +421,86 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     m_emu_window = &emu_window;
     m_filepath = filepath;
 
+    if (Settings::values.boot_snapshot && !RestoreBootSnapshot()) {
+        // The system is left partially restored, so the application is booted from scratch
+        System::Shutdown();
+        return Load(emu_window, filepath);
+    }
+
+    if (Settings::values.enable_rewind) {
+        rewind_buffer = std::make_unique<RewindBuffer>(
+            static_cast<std::size_t>(Settings::values.rewind_buffer_size) << 20);
+        rewind_frame = 0;
+    }
+
+    if (Settings::values.adaptive_cpu_clock) {
+        clock_governor = std::make_unique<Core::ClockGovernor>(
+            *timing, *perf_stats, static_cast<u32>(Settings::values.cpu_clock_percentage),
+            static_cast<u32>(Settings::values.cpu_clock_percentage_min),
+            static_cast<u32>(Settings::values.cpu_clock_percentage_max));
+        clock_governor_frame = 0;
+    }
+
+    if (!Settings::values.state_hash_log.empty()) {
+        state_hash_log = std::make_unique<Core::StateHashLog>(
+            *this, Settings::values.state_hash_log, Settings::values.state_hash_reference);
+    }
+
     // Reset counters and set time origin to current frame
     GetAndResetPerfStats();
     perf_stats->BeginSystemFrame();
     return status;
 }
 
+void System::ApplyTitleProfile(u64 program_id) {
+    // A load that failed before initializing the system didn't shut it down
+    RestoreTitleProfile();
+
+    profile_program_id = program_id;
+    if (const auto profile = Core::TitleProfile::Load(program_id)) {
+        LOG_INFO(Core, "Applying the performance profile of {:016X}", program_id);
+        overridden_settings =
+            std::make_unique<Core::TitleProfile>(profile->Apply(Settings::values));
+        Settings::Apply();
+    } else if (Settings::values.auto_title_profiles) {
+        title_profile_tuner = std::make_unique<Core::TitleProfileTuner>();
+    }
+}
+
+void System::RestoreTitleProfile() {
+    if (title_profile_tuner) {
+        const auto profile = title_profile_tuner->PickProfile(Settings::values);
+        if (profile && !profile->Save(profile_program_id)) {
+            LOG_ERROR(Core, "Could not save the performance profile of {:016X}",
+                      profile_program_id);
+        }
+        title_profile_tuner.reset();
+    }
+    if (overridden_settings) {
+        overridden_settings->Apply(Settings::values);
+        overridden_settings.reset();
+        Settings::Apply();
+    }
+}
+
 void System::PrepareReschedule() {
     running_core->PrepareReschedule();
     reschedule_pending = true;
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return (perf_stats && timing) ? perf_stats->GetAndResetStats(timing->GetGlobalTimeUs())
-                                  : PerfStats::Results{};
+    PerfStats::Results results = (perf_stats && timing)
+                                     ? perf_stats->GetAndResetStats(timing->GetGlobalTimeUs())
+                                     : PerfStats::Results{};
+    if (dsp_core) {
+        results.audio_latency =
+            static_cast<double>(dsp_core->GetQueuedFrames()) / AudioCore::native_sample_rate;
+        results.audio_underrun_frames = dsp_core->GetAndResetUnderrunFrames();
+    }
+    if (title_profile_tuner) {
+        title_profile_tuner->AddSample(results);
+    }
+    return results;
 }
 
 void System::Reschedule() {
@@ -358,6 +520,7 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
     LOG_DEBUG(HW_Memory, "initialized OK");
 
     memory = std::make_unique<Memory::MemorySystem>();
+    memory_watch = std::make_unique<Core::MemoryWatch>(*memory);
 
     timing = std::make_unique<Timing>(num_cores, Settings::values.cpu_clock_percentage);
 
@@ -367,8 +530,13 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
     if (Settings::values.use_cpu_jit) {
 #if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
         for (u32 i = 0; i < num_cores; ++i) {
-            cpu_cores.push_back(
-                std::make_shared<ARM_Dynarmic>(this, *memory, i, timing->GetTimer(i)));
+            if (Settings::values.use_cpu_tiering) {
+                cpu_cores.push_back(
+                    std::make_shared<ARM_Tiered>(this, *memory, i, timing->GetTimer(i)));
+            } else {
+                cpu_cores.push_back(
+                    std::make_shared<ARM_Dynarmic>(this, *memory, i, timing->GetTimer(i)));
+            }
         }
 #else
         for (u32 i = 0; i < num_cores; ++i) {
@@ -438,6 +606,24 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
     return ResultStatus::Success;
 }
 
+System::ResultStatus System::InitWithoutApplication(Frontend::EmuWindow& emu_window) {
+    // Memory mode 0 is the 64MB mode of Old 3DS applications
+    ResultStatus init_result{Init(emu_window, 0, 0, 1)};
+    if (init_result != ResultStatus::Success) {
+        LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                     static_cast<u32>(init_result));
+        System::Shutdown();
+        return init_result;
+    }
+
+    title_id = 0;
+    perf_stats = std::make_unique<PerfStats>(title_id);
+    custom_tex_cache = std::make_unique<Core::CustomTexCache>();
+    status = ResultStatus::Success;
+    m_emu_window = &emu_window;
+    return status;
+}
+
 RendererBase& System::Renderer() {
     return *VideoCore::g_renderer;
 }
@@ -498,6 +684,16 @@ const VideoDumper::Backend& System::VideoDumper() const {
     return *video_dumper;
 }
 
+Core::MemoryWatch& System::MemoryWatch() {
+    return *memory_watch;
+}
+
+#ifdef HAVE_RPC
+RPC::RPCServer& System::RPCServer() {
+    return *rpc_server;
+}
+#endif
+
 Core::CustomTexCache& System::CustomTexCache() {
     return *custom_tex_cache;
 }
@@ -519,6 +715,8 @@ void System::RegisterImageInterface(std::shared_ptr<Frontend::ImageInterface> im
 }
 
 void System::Shutdown(bool is_deserializing) {
+    Common::ClearCurrentThreadRole();
+
     // Log last frame performance stats
     const auto perf_results = GetAndResetPerfStats();
     constexpr auto performance = Common::Telemetry::FieldType::Performance;
@@ -529,6 +727,16 @@ void System::Shutdown(bool is_deserializing) {
     telemetry_session->AddField(performance, "Shutdown_Frametime", perf_results.frametime * 1000.0);
     telemetry_session->AddField(performance, "Mean_Frametime_MS", perf_stats->GetMeanFrametime());
 
+    if (!is_deserializing) {
+        WaitForSaveState();
+        last_save_state_size = 0;
+        rewind_buffer.reset();
+        rewind_state = {};
+        state_hash_log.reset();
+        clock_governor.reset();
+        boot_snapshot_path.clear();
+    }
+
     // Shutdown emulation session
     VideoCore::Shutdown();
     HW::Shutdown();
@@ -558,8 +766,13 @@ void System::Shutdown(bool is_deserializing) {
         room_member->SendGameInfo(game_info);
     }
 
+    memory_watch.reset();
     memory.reset();
 
+    if (!is_deserializing) {
+        RestoreTitleProfile();
+    }
+
     LOG_DEBUG(Core, "Shutdown OK");
 }
 
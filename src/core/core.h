@@ -4,10 +4,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <boost/serialization/version.hpp>
+#include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "core/custom_tex_cache.h"
 #include "core/frontend/applets/mii_selector.h"
@@ -62,11 +67,19 @@ class RendererBase;
 namespace Core {
 
 class Timing;
+class MemoryWatch;
+class RewindBuffer;
+class StateHashLog;
+class ClockGovernor;
+struct TitleProfile;
+class TitleProfileTuner;
+struct CSTHeader;
 
 class System {
 public:
     /**
-     * Gets the instance of the System singleton class.
+     * Gets the instance of the System singleton class. Multi-instance builds have one instance for
+     * each thread, which must create, run and shut down its console on its own.
      * @returns Reference to the instance of the System singleton class.
      */
     [[nodiscard]] static System& GetInstance() {
@@ -108,6 +121,15 @@ public:
      */
     [[nodiscard]] ResultStatus RunLoop(bool tight_loop = true);
 
+    /**
+     * Runs the core CPU loop until done returns true, which is checked after every slice, so that
+     * frontends don't have to call RunLoop once per slice. Returns early if a slice doesn't
+     * succeed, or after a single slice while the GDB stub is enabled, as debugging needs the
+     * frontend to look at every slice.
+     * @return the result of the last slice
+     */
+    [[nodiscard]] ResultStatus RunUntil(const std::function<bool()>& done);
+
     /**
      * Step the CPU one instruction
      * @return Result status, indicating whethor or not the operation succeeded.
@@ -120,7 +142,7 @@ public:
     /// Shutdown and then load again
     void Reset();
 
-    enum class Signal : u32 { None, Shutdown, Reset, Save, Load };
+    enum class Signal : u32 { None, Shutdown, Reset, Save, SaveDelta, Load, Rewind };
 
     bool SendSignal(Signal signal, u32 param = 0);
 
@@ -143,6 +165,14 @@ public:
      */
     [[nodiscard]] ResultStatus Load(Frontend::EmuWindow& emu_window, const std::string& filepath);
 
+    /**
+     * Powers on the emulated system without loading an application, for tools that drive the
+     * emulated hardware directly (e.g. replaying CiTraces). No CPU code is run afterwards.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    [[nodiscard]] ResultStatus InitWithoutApplication(Frontend::EmuWindow& emu_window);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -261,6 +291,19 @@ public:
     /// Gets a const reference to the video dumper backend
     [[nodiscard]] const VideoDumper::Backend& VideoDumper() const;
 
+    /// Gets a reference to the ranges of memory copied at the end of every game frame
+    [[nodiscard]] Core::MemoryWatch& MemoryWatch();
+
+    /// Gets the log of the state hashes of each game frame, or nullptr if it isn't enabled
+    [[nodiscard]] Core::StateHashLog* StateHashLog() {
+        return state_hash_log.get();
+    }
+
+#ifdef HAVE_RPC
+    /// Gets a reference to the RPC server for scripting support
+    [[nodiscard]] RPC::RPCServer& RPCServer();
+#endif
+
     std::unique_ptr<PerfStats> perf_stats;
     FrameLimiter frame_limiter;
 
@@ -301,12 +344,49 @@ public:
         return registered_image_interface;
     }
 
+    /**
+     * Saves the state to a slot. The state is captured right away, while it is compressed and
+     * written to the file on a background thread, after which the save state callback is called.
+     */
     void SaveState(u32 slot) const;
 
+    /**
+     * Saves only the emulated memory pages that changed since the last full save state was saved
+     * or loaded, which becomes the base of the delta. Loading a delta loads its base first.
+     */
+    void SaveDeltaState(u32 slot) const;
+
     void LoadState(u32 slot);
 
+    /// Called on the writer thread once a save state is written, with an empty error on success
+    using SaveStateCallback = std::function<void(u32 slot, const std::string& error)>;
+
+    void SetSaveStateCallback(SaveStateCallback callback) {
+        save_state_callback = std::move(callback);
+    }
+
+    /// Waits until the save state being written in the background, if any, is done
+    void WaitForSaveState() const;
+
+    /// Called on every service request of the application, the default boot snapshot point
+    void NotifyServiceRequest() {
+        service_request_seen = true;
+    }
+
+    /**
+     * Restores the newest rewind snapshot and removes it from the history. While rewinding is
+     * enabled, a snapshot is taken every Settings::values.rewind_interval frames.
+     * @return false if there is no snapshot left.
+     */
+    bool Rewind();
+
 #ifdef __LIBRETRO__
-    std::vector<u8> SaveStateBuffer() const;
+    /**
+     * Saves the state to a buffer. A run-ahead state is not compressed and does not store RAM,
+     * which stays in a copy updated with only the changed pages, but only the newest one can be
+     * loaded.
+     */
+    std::vector<u8> SaveStateBuffer(bool run_ahead = false) const;
 
     bool LoadStateBuffer(std::vector<u8> buffer);
 #endif
@@ -368,11 +448,14 @@ private:
     std::unique_ptr<Service::FS::ArchiveManager> archive_manager;
 
     std::unique_ptr<Memory::MemorySystem> memory;
+
+    /// Ranges of memory copied at the end of every game frame
+    std::unique_ptr<Core::MemoryWatch> memory_watch;
     std::unique_ptr<Kernel::KernelSystem> kernel;
     std::unique_ptr<Timing> timing;
 
 private:
-    static System s_instance;
+    static INSTANCE_LOCAL System s_instance;
 
     bool initalized = false;
 
@@ -383,10 +466,65 @@ private:
     std::string m_filepath;
     u64 title_id;
 
+    /// Runs one slice of RunLoop, after the checks that only have to be done once per call
+    ResultStatus RunSlice(bool tight_loop);
+
+    /// Serializes SendSignal. RunLoop checks for signals without taking it.
     std::mutex signal_mutex;
-    Signal current_signal;
+    /// Written after signal_param with release semantics, and cleared by the emulation thread
+    std::atomic<Signal> current_signal{Signal::None};
     u32 signal_param;
 
+    /// Slot and creation time of the full save state that delta save states are based on
+    mutable u32 delta_base_slot = 0;
+    mutable u64 delta_base_time = 0;
+
+    /// Size of the last serialized save state, reserved up front for the next one
+    mutable std::size_t last_save_state_size = 0;
+    mutable std::thread save_state_thread;
+    SaveStateCallback save_state_callback;
+
+    /// Captures the state and writes it to a file in the background, then calls on_written
+    void WriteState(std::string path, const CSTHeader& header,
+                    std::function<void(const std::string& error)> on_written) const;
+    void WriteState(u32 slot, const CSTHeader& header) const;
+    void ReadState(const std::string& path);
+
+    /// Path the boot snapshot is saved to once the capture point is reached, empty if none is due
+    std::string boot_snapshot_path;
+    bool service_request_seen = false;
+
+    /**
+     * Restores the boot snapshot of the loaded application if there is one, otherwise prepares
+     * to capture it.
+     * @return false if restoring failed midway, which leaves the system to be loaded again.
+     */
+    bool RestoreBootSnapshot();
+    void SaveBootSnapshot();
+
+    std::unique_ptr<RewindBuffer> rewind_buffer;
+    /// Buffer the rewind snapshots are serialized to, kept to reuse its allocation
+    std::vector<u8> rewind_state;
+    u64 rewind_frame = 0;
+
+    void CaptureRewindState();
+
+    std::unique_ptr<Core::StateHashLog> state_hash_log;
+
+    std::unique_ptr<Core::ClockGovernor> clock_governor;
+    /// System frame that the clock governor measured last
+    u64 clock_governor_frame = 0;
+
+    /// Applies the performance profile of a title over the global settings, or starts picking one
+    void ApplyTitleProfile(u64 program_id);
+    /// Restores the global settings, saving the picked profile if there is one
+    void RestoreTitleProfile();
+
+    u64 profile_program_id = 0;
+    /// Global values of the settings overridden by the profile of the running title
+    std::unique_ptr<Core::TitleProfile> overridden_settings;
+    std::unique_ptr<Core::TitleProfileTuner> title_profile_tuner;
+
     friend class boost::serialization::access;
     template <typename Archive>
     void serialize(Archive& ar, const unsigned int file_version);
@@ -77,20 +77,33 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
     }
 }
 
+template <typename Predicate>
+void Timing::Timer::RemoveEventsIf(Predicate pred) {
+    auto itr = std::find_if(event_queue.begin(), event_queue.end(), pred);
+    while (itr != event_queue.end()) {
+        // Fill the hole with the last event and sift that into place. Only the ancestors or the
+        // descendants of the hole are touched, so this avoids rebuilding the whole heap.
+        const std::size_t index = static_cast<std::size_t>(itr - event_queue.begin());
+        if (index + 1 != event_queue.size()) {
+            *itr = std::move(event_queue.back());
+            event_queue.pop_back();
+            SiftEvent(index);
+        } else {
+            event_queue.pop_back();
+        }
+
+        // Sifting up may have moved an unchecked event in front of the hole
+        itr = std::find_if(event_queue.begin(), event_queue.end(), pred);
+    }
+}
+
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
+    for (const auto& timer : timers) {
+        timer->RemoveEventsIf(
             [&](const Event& e) { return e.type == event_type && e.userdata == userdata; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
     }
     // TODO:remove events from ts_queue
 }
@@ -99,15 +112,8 @@ void Timing::RemoveEvent(const TimingEventType* event_type) {
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+    for (const auto& timer : timers) {
+        timer->RemoveEventsIf([&](const Event& e) { return e.type == event_type; });
     }
     // TODO:remove events from ts_queue
 }
@@ -174,6 +180,33 @@ void Timing::Timer::MoveEvents() {
     }
 }
 
+void Timing::Timer::SiftEvent(std::size_t index) {
+    // The queue is a min-heap ordered with std::greater, as in std::push_heap/pop_heap
+    while (index > 0) {
+        const std::size_t parent = (index - 1) / 2;
+        if (!(event_queue[parent] > event_queue[index])) {
+            break;
+        }
+        std::swap(event_queue[parent], event_queue[index]);
+        index = parent;
+    }
+
+    while (true) {
+        std::size_t child = 2 * index + 1;
+        if (child >= event_queue.size()) {
+            break;
+        }
+        if (child + 1 < event_queue.size() && event_queue[child] > event_queue[child + 1]) {
+            ++child;
+        }
+        if (!(event_queue[index] > event_queue[child])) {
+            break;
+        }
+        std::swap(event_queue[index], event_queue[child]);
+        index = child;
+    }
+}
+
 s64 Timing::Timer::GetMaxSliceLength() const {
     const auto& next_event = event_queue.begin();
     if (next_event != event_queue.end()) {
@@ -222,6 +255,7 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
 
 void Timing::Timer::Idle() {
     idled_cycles += downcount;
+    total_idled_cycles += downcount;
     downcount = 0;
 }
 
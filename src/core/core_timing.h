@@ -195,6 +195,11 @@ public:
         u64 GetTicks() const;
         u64 GetIdleTicks() const;
 
+        /// Returns the ticks skipped by idling since the timer was created
+        u64 GetTotalIdleTicks() const {
+            return total_idled_cycles;
+        }
+
         void AddTicks(u64 ticks);
 
         s64 GetDowncount() const;
@@ -205,6 +210,14 @@ public:
 
     private:
         friend class Timing;
+
+        /// Removes the events matching the predicate, repairing the heap around each removal
+        template <typename Predicate>
+        void RemoveEventsIf(Predicate pred);
+
+        /// Moves the event at the index up or down the heap to its place
+        void SiftEvent(std::size_t index);
+
         // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
         // We don't use std::priority_queue because we need to be able to serialize, unserialize and
         // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
@@ -227,6 +240,7 @@ public:
         s64 downcount = MAX_SLICE_LENGTH;
         s64 executed_ticks = 0;
         u64 idled_cycles = 0;
+        u64 total_idled_cycles = 0;
         // Stores a scaling for the internal clockspeed. Changing this number results in
         // under/overclocking the guest cpu
         double cpu_clock_scale = 1.0;
@@ -2,16 +2,169 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <optional>
+#include <thread>
 #include <fmt/format.h>
+#include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/string_util.h"
+#include "common/swap.h"
 #include "common/texture.h"
+#include "common/thread.h"
 #include "core.h"
 #include "core/custom_tex_cache.h"
 
 namespace Core {
+namespace {
+/// Identifies the texture group log and the version of its layout
+constexpr u32 GROUPS_MAGIC = 0x50475843;
+constexpr u32 GROUPS_VERSION = 1;
+
+constexpr u32 MakeFourCC(char a, char b, char c, char d) {
+    return static_cast<u32>(a) | static_cast<u32>(b) << 8 | static_cast<u32>(c) << 16 |
+           static_cast<u32>(d) << 24;
+}
+
+/// The parts of the DDS header that are read, at their offsets from the start of the file
+struct DDSHeader {
+    u32_le magic;
+    u32_le size;
+    u32_le flags;
+    u32_le height;
+    u32_le width;
+    u32_le pitch_or_linear_size;
+    u32_le depth;
+    u32_le mip_map_count;
+    std::array<u32_le, 11> reserved;
+    u32_le pixel_format_size;
+    u32_le pixel_format_flags;
+    u32_le four_cc;
+    std::array<u32_le, 10> rest;
+};
+static_assert(sizeof(DDSHeader) == 128, "DDSHeader has incorrect size");
+
+constexpr u32 DDS_MAGIC = MakeFourCC('D', 'D', 'S', ' ');
+constexpr u32 DDSD_MIPMAPCOUNT = 0x20000;
+constexpr u32 DDPF_FOURCC = 0x4;
+// DXGI_FORMAT values of the DX10 header extension
+constexpr u32 DXGI_FORMAT_BC1_UNORM = 71;
+constexpr u32 DXGI_FORMAT_BC3_UNORM = 77;
+constexpr u32 DXGI_FORMAT_BC7_UNORM = 98;
+
+bool IsDDSPath(const std::string& path) {
+    std::string extension;
+    Common::SplitPath(path, nullptr, nullptr, &extension);
+    return Common::ToLower(extension) == ".dds";
+}
+
+std::optional<CustomTexInfo> LoadDDS(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    DDSHeader header;
+    if (!file.IsOpen() || file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != DDS_MAGIC) {
+        LOG_ERROR(Render_OpenGL, "{} is not a DDS file", path);
+        return std::nullopt;
+    }
+
+    CustomTexInfo tex_info;
+    tex_info.width = header.width;
+    tex_info.height = header.height;
+    tex_info.levels = header.flags & DDSD_MIPMAPCOUNT ? std::max<u32>(header.mip_map_count, 1) : 1;
+    u32 dxgi_format = 0;
+    if (!(header.pixel_format_flags & DDPF_FOURCC)) {
+        header.four_cc = 0;
+    } else if (header.four_cc == MakeFourCC('D', 'X', '1', '0') &&
+               file.ReadArray(&dxgi_format, 1) != 1) {
+        header.four_cc = 0;
+    }
+    if (header.four_cc == MakeFourCC('D', 'X', 'T', '1') || dxgi_format == DXGI_FORMAT_BC1_UNORM) {
+        tex_info.format = CustomTexFormat::BC1;
+    } else if (header.four_cc == MakeFourCC('D', 'X', 'T', '5') ||
+               dxgi_format == DXGI_FORMAT_BC3_UNORM) {
+        tex_info.format = CustomTexFormat::BC3;
+    } else if (dxgi_format == DXGI_FORMAT_BC7_UNORM) {
+        tex_info.format = CustomTexFormat::BC7;
+    } else {
+        LOG_ERROR(Render_OpenGL, "{} does not hold BC1, BC3 or BC7 blocks", path);
+        return std::nullopt;
+    }
+
+    std::size_t size = 0;
+    for (u32 level = 0; level < tex_info.levels; ++level) {
+        size += GetCompressedLevelSize(tex_info.format, std::max(tex_info.width >> level, 1u),
+                                       std::max(tex_info.height >> level, 1u));
+    }
+    if (size > file.GetSize()) {
+        LOG_ERROR(Render_OpenGL, "{} is truncated", path);
+        return std::nullopt;
+    }
+    tex_info.tex.resize(size);
+    if (file.ReadBytes(tex_info.tex.data(), size) != size) {
+        LOG_ERROR(Render_OpenGL, "Failed to read {}", path);
+        return std::nullopt;
+    }
+    return tex_info;
+}
+} // Anonymous namespace
+
+std::size_t GetCompressedLevelSize(CustomTexFormat format, u32 width, u32 height) {
+    const std::size_t block_size = format == CustomTexFormat::BC1 ? 8 : 16;
+    return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * block_size;
+}
+
+std::optional<CustomTexInfo> LoadCustomTexture(Frontend::ImageInterface& image_interface,
+                                               const std::string& path) {
+    std::optional<CustomTexInfo> tex_info;
+    if (IsDDSPath(path)) {
+        // The blocks are uploaded as they are, so they must already be in the bottom-up row
+        // order of the surfaces
+        tex_info = LoadDDS(path);
+    } else {
+        tex_info.emplace();
+        if (!image_interface.DecodePNG(tex_info->tex, tex_info->width, tex_info->height, path)) {
+            LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path);
+            return std::nullopt;
+        }
+        Common::FlipRGBA8Texture(tex_info->tex, tex_info->width, tex_info->height);
+    }
+    if (!tex_info) {
+        return std::nullopt;
+    }
+
+    // Make sure the texture size is a power of 2
+    std::bitset<32> width_bits(tex_info->width);
+    std::bitset<32> height_bits(tex_info->height);
+    if (width_bits.count() != 1 || height_bits.count() != 1) {
+        LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path);
+        return std::nullopt;
+    }
+
+    LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path);
+    return tex_info;
+}
+
 CustomTexCache::CustomTexCache() = default;
 
-CustomTexCache::~CustomTexCache() = default;
+CustomTexCache::~CustomTexCache() {
+    if (prefetch_thread.joinable()) {
+        {
+            std::scoped_lock lock{prefetch_mutex};
+            stop_prefetching = true;
+        }
+        prefetch_queued.notify_one();
+        prefetch_thread.join();
+    }
+    if (!groups_path.empty()) {
+        CloseTextureGroup();
+        if (texture_groups_changed) {
+            SaveTextureGroups();
+        }
+    }
+}
 
 bool CustomTexCache::IsTextureDumped(u64 hash) const {
     return dumped_textures.count(hash);
@@ -25,12 +178,45 @@ bool CustomTexCache::IsTextureCached(u64 hash) const {
     return custom_textures.count(hash);
 }
 
-const CustomTexInfo& CustomTexCache::LookupTexture(u64 hash) const {
+const CustomTexInfo& CustomTexCache::LookupTexture(u64 hash) {
+    const auto position = on_demand_positions.find(hash);
+    if (position != on_demand_positions.end()) {
+        on_demand_textures.splice(on_demand_textures.begin(), on_demand_textures,
+                                  position->second);
+    }
     return custom_textures.at(hash);
 }
 
-void CustomTexCache::CacheTexture(u64 hash, const std::vector<u8>& tex, u32 width, u32 height) {
-    custom_textures[hash] = {width, height, tex};
+void CustomTexCache::CacheTexture(u64 hash, CustomTexInfo tex_info) {
+    InsertTexture(hash, std::move(tex_info), false);
+}
+
+void CustomTexCache::InsertTexture(u64 hash, CustomTexInfo tex_info, bool preloaded) {
+    const auto position = on_demand_positions.find(hash);
+    if (position != on_demand_positions.end()) {
+        on_demand_size -= custom_textures.at(hash).tex.size();
+        on_demand_textures.erase(position->second);
+        on_demand_positions.erase(position);
+    }
+
+    const std::size_t size = tex_info.tex.size();
+    custom_textures[hash] = std::move(tex_info);
+    if (preloaded) {
+        return;
+    }
+
+    on_demand_textures.push_front(hash);
+    on_demand_positions.emplace(hash, on_demand_textures.begin());
+    on_demand_size += size;
+
+    // Evict the least recently used textures, but never the one just loaded
+    while (on_demand_size > ON_DEMAND_MEMORY_BUDGET && on_demand_textures.size() > 1) {
+        const u64 evicted = on_demand_textures.back();
+        on_demand_textures.pop_back();
+        on_demand_positions.erase(evicted);
+        on_demand_size -= custom_textures.at(evicted).tex.size();
+        custom_textures.erase(evicted);
+    }
 }
 
 void CustomTexCache::AddTexturePath(u64 hash, const std::string& path) {
@@ -59,38 +245,61 @@ void CustomTexCache::FindCustomTextures(u64 program_id) {
                 continue;
             if (file.virtualName.substr(0, 5) != "tex1_")
                 continue;
+            const bool is_dds = IsDDSPath(file.virtualName);
 
             u32 width;
             u32 height;
             u64 hash;
             u32 format; // unused
             // TODO: more modern way of doing this
-            if (std::sscanf(file.virtualName.c_str(), "tex1_%ux%u_%llX_%u.png", &width, &height,
-                            &hash, &format) == 4) {
-                AddTexturePath(hash, file.physicalName);
+            if (std::sscanf(file.virtualName.c_str(), "tex1_%ux%u_%llX_%u.", &width, &height,
+                            &hash, &format) != 4) {
+                continue;
+            }
+            // A compressed payload takes the place of the PNG of the same texture
+            const auto existing = custom_texture_paths.find(hash);
+            if (existing != custom_texture_paths.end() &&
+                IsDDSPath(existing->second.path) != is_dds) {
+                if (is_dds) {
+                    existing->second.path = file.physicalName;
+                }
+                continue;
             }
+            AddTexturePath(hash, file.physicalName);
         }
     }
 }
 
 void CustomTexCache::PreloadTextures(Frontend::ImageInterface& image_interface) {
+    std::vector<const CustomTexPathInfo*> paths;
+    paths.reserve(custom_texture_paths.size());
     for (const auto& path : custom_texture_paths) {
-        const auto& path_info = path.second;
-        Core::CustomTexInfo tex_info;
-        if (image_interface.DecodePNG(tex_info.tex, tex_info.width, tex_info.height,
-                                      path_info.path)) {
-            // Make sure the texture size is a power of 2
-            std::bitset<32> width_bits(tex_info.width);
-            std::bitset<32> height_bits(tex_info.height);
-            if (width_bits.count() == 1 && height_bits.count() == 1) {
-                LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
-                Common::FlipRGBA8Texture(tex_info.tex, tex_info.width, tex_info.height);
-                CacheTexture(path_info.hash, tex_info.tex, tex_info.width, tex_info.height);
-            } else {
-                LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
-            }
-        } else {
-            LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path_info.path);
+        paths.push_back(&path.second);
+    }
+
+    // Decoding dominates, so spread it over the host's cores
+    std::vector<std::optional<CustomTexInfo>> decoded(paths.size());
+    std::atomic<std::size_t> next_path{0};
+    const auto decode = [&] {
+        for (std::size_t i = next_path++; i < paths.size(); i = next_path++) {
+            decoded[i] = LoadCustomTexture(image_interface, paths[i]->path);
+        }
+    };
+
+    const std::size_t num_workers =
+        std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u), paths.size());
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < num_workers; ++i) {
+        workers.emplace_back(decode);
+    }
+    decode();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (decoded[i]) {
+            InsertTexture(paths[i]->hash, std::move(*decoded[i]), true);
         }
     }
 }
@@ -106,4 +315,157 @@ const CustomTexPathInfo& CustomTexCache::LookupTexturePathInfo(u64 hash) const {
 bool CustomTexCache::IsTexturePathMapEmpty() const {
     return custom_texture_paths.size() == 0;
 }
+
+void CustomTexCache::EnablePrefetching(u64 program_id,
+                                       std::shared_ptr<Frontend::ImageInterface> image_interface_) {
+    image_interface = std::move(image_interface_);
+    groups_path = fmt::format("{}custom_textures" DIR_SEP "{:016X}_groups.bin",
+                              FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), program_id);
+
+    FileUtil::IOFile file(groups_path, "rb");
+    u32 header[3]{};
+    if (!file.IsOpen() || file.ReadArray(header, 3) != 3 || header[0] != GROUPS_MAGIC ||
+        header[1] != GROUPS_VERSION) {
+        return;
+    }
+    for (u32 i = 0; i < header[2]; ++i) {
+        u32 size = 0;
+        if (file.ReadArray(&size, 1) != 1 || size == 0 || size > MAX_GROUP_SIZE) {
+            break;
+        }
+        std::vector<u64> group(size);
+        if (file.ReadArray(group.data(), size) != size) {
+            break;
+        }
+        const u64 first = group.front();
+        texture_groups.insert_or_assign(first, std::move(group));
+    }
+    LOG_INFO(Render_OpenGL, "Loaded {} custom texture groups", texture_groups.size());
+}
+
+void CustomTexCache::RecordTextureLoad(u64 hash) {
+    if (groups_path.empty()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_load > GROUP_GAP || current_group.size() >= MAX_GROUP_SIZE) {
+        CloseTextureGroup();
+    }
+    last_load = now;
+    current_group.push_back(hash);
+
+    const auto group = texture_groups.find(hash);
+    if (group == texture_groups.end()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{prefetch_mutex};
+        // Drops what the surfaces loaded themselves while it was being decoded
+        for (auto itr = prefetched_textures.begin(); itr != prefetched_textures.end();) {
+            if (custom_textures.count(itr->first)) {
+                prefetched_size -= itr->second.tex.size();
+                prefetch_requested.erase(itr->first);
+                itr = prefetched_textures.erase(itr);
+            } else {
+                ++itr;
+            }
+        }
+        for (const u64 member : group->second) {
+            if (member != hash && !custom_textures.count(member) && CustomTextureExists(member) &&
+                prefetch_requested.insert(member).second) {
+                prefetch_queue.push_back(custom_texture_paths.at(member));
+            }
+        }
+    }
+    if (!prefetch_thread.joinable()) {
+        prefetch_thread = std::thread([this] { PrefetchLoop(); });
+    }
+    prefetch_queued.notify_one();
+}
+
+std::optional<CustomTexInfo> CustomTexCache::TakePrefetchedTexture(u64 hash) {
+    std::scoped_lock lock{prefetch_mutex};
+    const auto itr = prefetched_textures.find(hash);
+    if (itr == prefetched_textures.end()) {
+        return std::nullopt;
+    }
+    CustomTexInfo tex_info = std::move(itr->second);
+    prefetched_textures.erase(itr);
+    prefetch_requested.erase(hash);
+    prefetched_size -= tex_info.tex.size();
+    return tex_info;
+}
+
+void CustomTexCache::CloseTextureGroup() {
+    // A texture loaded on its own predicts nothing
+    if (current_group.size() > 1) {
+        auto& group = texture_groups[current_group.front()];
+        if (group != current_group) {
+            group = std::move(current_group);
+            texture_groups_changed = true;
+        }
+    }
+    current_group.clear();
+}
+
+void CustomTexCache::SaveTextureGroups() const {
+    if (!FileUtil::CreateFullPath(groups_path)) {
+        return;
+    }
+
+    // Written under a temporary name first, so that an interrupted write leaves the old log
+    const std::string temp_path = groups_path + ".tmp";
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        const u32 header[3]{GROUPS_MAGIC, GROUPS_VERSION, static_cast<u32>(texture_groups.size())};
+        file.WriteArray(header, 3);
+        for (const auto& [first, group] : texture_groups) {
+            file.WriteObject(static_cast<u32>(group.size()));
+            file.WriteArray(group.data(), group.size());
+        }
+        if (!file.IsGood()) {
+            file.Close();
+            FileUtil::Delete(temp_path);
+            LOG_WARNING(Render_OpenGL, "Could not write the custom texture groups");
+            return;
+        }
+    }
+    FileUtil::Delete(groups_path);
+    if (!FileUtil::Rename(temp_path, groups_path)) {
+        FileUtil::Delete(temp_path);
+    }
+}
+
+void CustomTexCache::PrefetchLoop() {
+    Common::SetCurrentThreadName("CustomTexPrefetch");
+    Common::SetCurrentThreadRole(Common::ThreadRole::Background);
+    while (true) {
+        CustomTexPathInfo path_info;
+        {
+            std::unique_lock lock{prefetch_mutex};
+            prefetch_queued.wait(lock,
+                                 [this] { return stop_prefetching || !prefetch_queue.empty(); });
+            if (stop_prefetching) {
+                break;
+            }
+            path_info = std::move(prefetch_queue.front());
+            prefetch_queue.pop_front();
+            if (prefetched_size > PREFETCH_MEMORY_BUDGET) {
+                prefetch_requested.erase(path_info.hash);
+                continue;
+            }
+        }
+
+        std::optional<CustomTexInfo> tex_info = LoadCustomTexture(*image_interface, path_info.path);
+        std::scoped_lock lock{prefetch_mutex};
+        if (!tex_info) {
+            prefetch_requested.erase(path_info.hash);
+            continue;
+        }
+        prefetched_size += tex_info->tex.size();
+        prefetched_textures.emplace(path_info.hash, std::move(*tex_info));
+    }
+    Common::ClearCurrentThreadRole();
+}
 } // namespace Core
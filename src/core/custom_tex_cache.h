@@ -4,7 +4,15 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -15,12 +23,33 @@ class ImageInterface;
 } // namespace Frontend
 
 namespace Core {
+/// Layout of the pixels of a custom texture
+enum class CustomTexFormat : u32 {
+    RGBA8,
+    BC1,
+    BC3,
+    BC7,
+};
+
 struct CustomTexInfo {
     u32 width;
     u32 height;
+    /// RGBA8 pixels, or the blocks of each mipmap level one after the other
     std::vector<u8> tex;
+    CustomTexFormat format = CustomTexFormat::RGBA8;
+    u32 levels = 1;
 };
 
+/// Returns the size of a mipmap level of a block compressed texture
+std::size_t GetCompressedLevelSize(CustomTexFormat format, u32 width, u32 height);
+
+/**
+ * Loads a custom texture, either a PNG that is decoded to RGBA8 or a DDS holding BC1, BC3 or BC7
+ * blocks. Returns nothing if the file can't be read or its size isn't a power of 2.
+ */
+std::optional<CustomTexInfo> LoadCustomTexture(Frontend::ImageInterface& image_interface,
+                                               const std::string& path);
+
 // This is to avoid parsing the filename multiple times
 struct CustomTexPathInfo {
     std::string path;
@@ -37,8 +66,8 @@ public:
     void SetTextureDumped(u64 hash);
 
     bool IsTextureCached(u64 hash) const;
-    const CustomTexInfo& LookupTexture(u64 hash) const;
-    void CacheTexture(u64 hash, const std::vector<u8>& tex, u32 width, u32 height);
+    const CustomTexInfo& LookupTexture(u64 hash);
+    void CacheTexture(u64 hash, CustomTexInfo tex_info);
 
     void AddTexturePath(u64 hash, const std::string& path);
     void FindCustomTextures(u64 program_id);
@@ -47,9 +76,62 @@ public:
     const CustomTexPathInfo& LookupTexturePathInfo(u64 hash) const;
     bool IsTexturePathMapEmpty() const;
 
+    /**
+     * Loads the groups of textures that the title loaded together in previous runs, and starts
+     * decoding the rest of a group on a worker thread once its first texture is loaded.
+     */
+    void EnablePrefetching(u64 program_id,
+                           std::shared_ptr<Frontend::ImageInterface> image_interface);
+
+    /// Notes that a texture that was not cached was loaded, to learn which load together
+    void RecordTextureLoad(u64 hash);
+
+    /// Takes a texture that the worker decoded ahead of time, if there is one
+    std::optional<CustomTexInfo> TakePrefetchedTexture(u64 hash);
+
 private:
+    /// Memory that textures loaded on demand may use before the least recently used are evicted.
+    /// Preloaded textures are kept regardless.
+    static constexpr std::size_t ON_DEMAND_MEMORY_BUDGET = 512 * 1024 * 1024;
+
+    /// Textures loaded without a pause this long in between belong to the same group
+    static constexpr std::chrono::milliseconds GROUP_GAP{1000};
+    /// Textures after which a group is closed
+    static constexpr std::size_t MAX_GROUP_SIZE = 512;
+    /// Memory that decoded textures may use while nothing takes them
+    static constexpr std::size_t PREFETCH_MEMORY_BUDGET = 128 * 1024 * 1024;
+
+    void InsertTexture(u64 hash, CustomTexInfo tex_info, bool preloaded);
+
+    void CloseTextureGroup();
+    void SaveTextureGroups() const;
+    void PrefetchLoop();
+
     std::unordered_set<u64> dumped_textures;
     std::unordered_map<u64, CustomTexInfo> custom_textures;
     std::unordered_map<u64, CustomTexPathInfo> custom_texture_paths;
+
+    std::list<u64> on_demand_textures; ///< Textures loaded on demand, most recently used first
+    std::unordered_map<u64, std::list<u64>::iterator> on_demand_positions;
+    std::size_t on_demand_size = 0;
+
+    /// Path of the texture group log, empty while prefetching is disabled
+    std::string groups_path;
+    std::shared_ptr<Frontend::ImageInterface> image_interface;
+    /// Textures that were loaded together, by the first one of them
+    std::unordered_map<u64, std::vector<u64>> texture_groups;
+    bool texture_groups_changed = false;
+    std::vector<u64> current_group;
+    std::chrono::steady_clock::time_point last_load;
+
+    std::thread prefetch_thread;
+    std::mutex prefetch_mutex;
+    std::condition_variable prefetch_queued;
+    bool stop_prefetching = false;
+    std::deque<CustomTexPathInfo> prefetch_queue;
+    /// Textures that are queued, being decoded or decoded
+    std::unordered_set<u64> prefetch_requested;
+    std::unordered_map<u64, CustomTexInfo> prefetched_textures;
+    std::size_t prefetched_size = 0;
 };
 } // namespace Core
@@ -8,18 +8,24 @@
 namespace VideoDumper {
 
 VideoFrame::VideoFrame(std::size_t width_, std::size_t height_, u8* data_)
-    : width(width_), height(height_), stride(width * 4), data(width * height * 4) {
-    // While copying, rotate the image to put the pixels in correct order
+    : width(width_), height(height_), stride(static_cast<u32>(width * 4)),
+      data(width * height * 4) {
+    // While copying, flip the rows to put the pixels in correct order
     // (As OpenGL returns pixel data starting from the lowest position)
     for (std::size_t i = 0; i < height; i++) {
-        for (std::size_t j = 0; j < width; j++) {
-            for (std::size_t k = 0; k < 4; k++) {
-                data[i * stride + j * 4 + k] = data_[(height - i - 1) * stride + j * 4 + k];
-            }
-        }
+        std::memcpy(data.data() + i * stride, data_ + (height - i - 1) * stride, stride);
     }
 }
 
+VideoFrame VideoFrame::Repeat(std::size_t width, std::size_t height) {
+    VideoFrame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.stride = static_cast<u32>(width * 4);
+    frame.repeat = true;
+    return frame;
+}
+
 Backend::~Backend() = default;
 NullBackend::~NullBackend() = default;
 
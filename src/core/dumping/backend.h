@@ -21,8 +21,13 @@ public:
     std::size_t height;
     u32 stride;
     std::vector<u8> data;
+    /// Set when the frame shows the same as the previous one, data is then left empty
+    bool repeat = false;
 
     VideoFrame(std::size_t width_ = 0, std::size_t height_ = 0, u8* data_ = nullptr);
+
+    /// Returns a frame that repeats the previous one
+    static VideoFrame Repeat(std::size_t width, std::size_t height);
 };
 
 class Backend {
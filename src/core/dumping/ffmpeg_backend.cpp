@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <string_view>
 #include <unordered_set>
 #include "common/assert.h"
 #include "common/file_util.h"
@@ -50,6 +52,7 @@ bool FFmpegStream::Init(FFmpegMuxer& muxer) {
 
     format_context = muxer.format_context.get();
     format_context_mutex = &muxer.format_context_mutex;
+    live = muxer.live;
 
     return true;
 }
@@ -67,7 +70,13 @@ void FFmpegStream::WritePacket(AVPacket& packet) {
     packet.stream_index = stream->index;
     {
         std::lock_guard lock{*format_context_mutex};
-        av_interleaved_write_frame(format_context, &packet);
+        // Interleaving holds packets back until every stream has caught up, which live streams
+        // can't afford. Their receivers reorder the streams themselves.
+        if (live) {
+            av_write_frame(format_context, &packet);
+        } else {
+            av_interleaved_write_frame(format_context, &packet);
+        }
     }
 }
 
@@ -134,10 +143,38 @@ bool FFmpegVideoStream::Init(FFmpegMuxer& muxer, const Layout::FramebufferLayout
     codec_context->time_base.den = static_cast<int>(BASE_CLOCK_RATE_ARM11);
     codec_context->gop_size = 12;
     codec_context->pix_fmt = codec->pix_fmts ? codec->pix_fmts[0] : AV_PIX_FMT_YUV420P;
+    scaled_pixel_format = codec_context->pix_fmt;
+
+    const AVPixFmtDescriptor* descriptor = av_pix_fmt_desc_get(codec_context->pix_fmt);
+    if (descriptor && (descriptor->flags & AV_PIX_FMT_FLAG_HWACCEL) &&
+        !InitHardwareFrames(codec, codec_context->pix_fmt)) {
+        // Fall back to the first software format the encoder takes
+        const AVPixelFormat* format = codec->pix_fmts;
+        while (*format != AV_PIX_FMT_NONE &&
+               (av_pix_fmt_desc_get(*format)->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+            ++format;
+        }
+        if (*format == AV_PIX_FMT_NONE) {
+            LOG_ERROR(Render, "Could not set up the hardware frames of the video encoder");
+            return false;
+        }
+        codec_context->pix_fmt = scaled_pixel_format = *format;
+    }
     if (format_context->oformat->flags & AVFMT_GLOBALHEADER)
         codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
     AVDictionary* options = ToAVDictionary(Settings::values.video_encoder_options);
+    if (live) {
+        // Frames leave the encoder as soon as they are in, unless the options say otherwise
+        codec_context->max_b_frames = 0;
+        codec_context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        if (av_opt_find(codec_context->priv_data, "zerolatency", nullptr, 0, 0)) {
+            av_dict_set(&options, "zerolatency", "1", AV_DICT_DONTOVERWRITE);
+        } else if (std::strcmp(codec->name, "libx264") == 0 ||
+                   std::strcmp(codec->name, "libx265") == 0) {
+            av_dict_set(&options, "tune", "zerolatency", AV_DICT_DONTOVERWRITE);
+        }
+    }
     if (avcodec_open2(codec_context.get(), codec, &options) < 0) {
         LOG_ERROR(Render, "Could not open video codec");
         return false;
@@ -158,31 +195,95 @@ bool FFmpegVideoStream::Init(FFmpegMuxer& muxer, const Layout::FramebufferLayout
 
     // Allocate frames
     current_frame.reset(av_frame_alloc());
-    scaled_frame.reset(av_frame_alloc());
-    scaled_frame->format = codec_context->pix_fmt;
-    scaled_frame->width = layout.width;
-    scaled_frame->height = layout.height;
-    if (av_frame_get_buffer(scaled_frame.get(), 0) < 0) {
+    scaled_frames.clear();
+    if (!GetWritableFrame()) {
         LOG_ERROR(Render, "Could not allocate frame buffer");
         return false;
     }
+    if (codec_context->hw_frames_ctx) {
+        hw_frame.reset(av_frame_alloc());
+    }
 
     // Create SWS Context
     auto* context = sws_getCachedContext(
         sws_context.get(), layout.width, layout.height, pixel_format, layout.width, layout.height,
-        codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
+        scaled_pixel_format, SWS_BICUBIC, nullptr, nullptr, nullptr);
     if (context != sws_context.get())
         sws_context.reset(context);
 
     return true;
 }
 
+bool FFmpegVideoStream::InitHardwareFrames(const AVCodec* codec, AVPixelFormat hardware_format) {
+    for (int i = 0;; ++i) {
+        const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+        if (!config) {
+            return false;
+        }
+        if (config->pix_fmt != hardware_format ||
+            !(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_FRAMES_CTX)) {
+            continue;
+        }
+
+        AVBufferRef* device = nullptr;
+        if (av_hwdevice_ctx_create(&device, config->device_type, nullptr, nullptr, 0) < 0) {
+            LOG_WARNING(Render, "Could not create the {} device of the video encoder",
+                        av_hwdevice_get_type_name(config->device_type));
+            return false;
+        }
+        hw_device_context.reset(device);
+
+        std::unique_ptr<AVBufferRef, AVBufferRefDeleter> frames{av_hwframe_ctx_alloc(device)};
+        if (!frames) {
+            return false;
+        }
+        auto* frames_context = reinterpret_cast<AVHWFramesContext*>(frames->data);
+        frames_context->format = hardware_format;
+        frames_context->sw_format = AV_PIX_FMT_NV12;
+        frames_context->width = layout.width;
+        frames_context->height = layout.height;
+        frames_context->initial_pool_size = 20;
+        if (av_hwframe_ctx_init(frames.get()) < 0) {
+            LOG_WARNING(Render, "Could not initialize the hardware frames of the video encoder");
+            return false;
+        }
+
+        codec_context->hw_frames_ctx = frames.release();
+        scaled_pixel_format = AV_PIX_FMT_NV12;
+        LOG_INFO(Render, "Encoding video on a {} device",
+                 av_hwdevice_get_type_name(config->device_type));
+        return true;
+    }
+}
+
+AVFrame* FFmpegVideoStream::GetWritableFrame() {
+    for (const auto& frame : scaled_frames) {
+        if (av_frame_is_writable(frame.get())) {
+            return frame.get();
+        }
+    }
+
+    std::unique_ptr<AVFrame, AVFrameDeleter> frame{av_frame_alloc()};
+    if (!frame) {
+        return nullptr;
+    }
+    frame->format = scaled_pixel_format;
+    frame->width = layout.width;
+    frame->height = layout.height;
+    if (av_frame_get_buffer(frame.get(), 0) < 0) {
+        return nullptr;
+    }
+    return scaled_frames.emplace_back(std::move(frame)).get();
+}
+
 void FFmpegVideoStream::Free() {
     FFmpegStream::Free();
 
     current_frame.reset();
-    scaled_frame.reset();
+    scaled_frames.clear();
     sws_context.reset();
+    hw_frame.reset();
+    hw_device_context.reset();
 }
 
 void FFmpegVideoStream::ProcessFrame(VideoFrame& frame) {
@@ -190,6 +291,11 @@ void FFmpegVideoStream::ProcessFrame(VideoFrame& frame) {
         LOG_ERROR(Render, "Frame dropped: resolution does not match");
         return;
     }
+    if (frame.repeat) {
+        // Nothing is encoded, the previous frame is shown until the pts of the next one
+        frame_count++;
+        return;
+    }
     // Prepare frame
     current_frame->data[0] = frame.data.data();
     current_frame->linesize[0] = frame.stride;
@@ -198,7 +304,8 @@ void FFmpegVideoStream::ProcessFrame(VideoFrame& frame) {
     current_frame->height = layout.height;
 
     // Scale the frame
-    if (av_frame_make_writable(scaled_frame.get()) < 0) {
+    AVFrame* scaled_frame = GetWritableFrame();
+    if (!scaled_frame) {
         LOG_ERROR(Render, "Video frame dropped: Could not prepare frame");
         return;
     }
@@ -206,10 +313,21 @@ void FFmpegVideoStream::ProcessFrame(VideoFrame& frame) {
         sws_scale(sws_context.get(), current_frame->data, current_frame->linesize, 0, layout.height,
                   scaled_frame->data, scaled_frame->linesize);
     }
+
+    if (hw_frame) {
+        // Upload the frame to the encoder's device
+        av_frame_unref(hw_frame.get());
+        if (av_hwframe_get_buffer(codec_context->hw_frames_ctx, hw_frame.get(), 0) < 0 ||
+            av_hwframe_transfer_data(hw_frame.get(), scaled_frame, 0) < 0) {
+            LOG_ERROR(Render, "Video frame dropped: Could not upload frame");
+            return;
+        }
+        scaled_frame = hw_frame.get();
+    }
     scaled_frame->pts = frame_count++;
 
     // Encode frame
-    SendFrame(scaled_frame.get());
+    SendFrame(scaled_frame);
 }
 
 FFmpegAudioStream::~FFmpegAudioStream() {
@@ -410,12 +528,18 @@ bool FFmpegMuxer::Init(const std::string& path, const Layout::FramebufferLayout&
 
     InitializeFFmpegLibraries();
 
-    if (!FileUtil::CreateFullPath(path)) {
+    const char* protocol = avio_find_protocol_name(path.c_str());
+    live = protocol != nullptr && std::strcmp(protocol, "file") != 0;
+    if (!live && !FileUtil::CreateFullPath(path)) {
         return false;
     }
 
-    // Get output format
-    const auto format = Settings::values.output_format;
+    // Get output format. Live streams use the container their protocol is usually received in.
+    std::string format = Settings::values.output_format;
+    if (live) {
+        const std::string_view name{protocol};
+        format = name == "rtp" ? "rtp_mpegts" : name.substr(0, 4) == "rtmp" ? "flv" : "mpegts";
+    }
     auto* output_format = av_guess_format(format.c_str(), path.c_str(), nullptr);
     if (!output_format) {
         LOG_ERROR(Render, "Could not get format {}", format);
@@ -437,6 +561,12 @@ bool FFmpegMuxer::Init(const std::string& path, const Layout::FramebufferLayout&
     if (!audio_stream.Init(*this))
         return false;
 
+    if (live) {
+        // Sends every packet right away, without the default muxing delay
+        format_context->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+        format_context->max_delay = 0;
+    }
+
     AVDictionary* options = ToAVDictionary(Settings::values.format_options);
     // Open video file
     if (avio_open(&format_context->pb, path.c_str(), AVIO_FLAG_WRITE) < 0 ||
@@ -510,14 +640,10 @@ bool FFmpegBackend::StartDumping(const std::string& path, const Layout::Framebuf
     if (video_processing_thread.joinable())
         video_processing_thread.join();
     video_processing_thread = std::thread([&] {
-        event1.Set();
         while (true) {
-            event2.Wait();
-            current_buffer = (current_buffer + 1) % 2;
-            next_buffer = (current_buffer + 1) % 2;
-            event1.Set();
+            VideoFrame frame = video_frame_queue.PopWait();
+            video_frame_popped.Set();
             // Process this frame
-            auto& frame = video_frame_buffers[current_buffer];
             if (frame.width == 0 && frame.height == 0) {
                 // An empty frame marks the end of frame data
                 ffmpeg.FlushVideo();
@@ -554,9 +680,16 @@ bool FFmpegBackend::StartDumping(const std::string& path, const Layout::Framebuf
 }
 
 void FFmpegBackend::AddVideoFrame(VideoFrame frame) {
-    event1.Wait();
-    video_frame_buffers[next_buffer] = std::move(frame);
-    event2.Set();
+    // Only wait for the encoder when it has fallen too far behind. Live streams must not hold the
+    // emulation back, so they drop the frame and repeat the previous one to keep the timing.
+    if (ffmpeg.IsLive() && frame.width != 0 && video_frame_queue.Size() >= MaxQueuedVideoFrames) {
+        video_frame_queue.Push(VideoFrame::Repeat(frame.width, frame.height));
+        return;
+    }
+    while (video_frame_queue.Size() >= MaxQueuedVideoFrames) {
+        video_frame_popped.Wait();
+    }
+    video_frame_queue.Push(std::move(frame));
 }
 
 void FFmpegBackend::AddAudioFrame(AudioCore::StereoFrame16 frame) {
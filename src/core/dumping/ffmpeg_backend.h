@@ -20,6 +20,7 @@
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libavutil/hwcontext.h>
 #include <libavutil/opt.h>
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
@@ -65,6 +66,8 @@ protected:
     std::mutex* format_context_mutex{};
     std::unique_ptr<AVCodecContext, AVCodecContextDeleter> codec_context{};
     AVStream* stream{};
+    /// Copied from the muxer
+    bool live{};
 };
 
 /**
@@ -86,13 +89,33 @@ private:
         }
     };
 
+    struct AVBufferRefDeleter {
+        void operator()(AVBufferRef* buffer) const {
+            av_buffer_unref(&buffer);
+        }
+    };
+
+    /// Sets up the device frames for an encoder that only takes frames in hardware_format
+    bool InitHardwareFrames(const AVCodec* codec, AVPixelFormat hardware_format);
+
+    /// Returns a scaled frame the encoder holds no reference to, allocating one if there is none
+    AVFrame* GetWritableFrame();
+
     u64 frame_count{};
 
     std::unique_ptr<AVFrame, AVFrameDeleter> current_frame{};
-    std::unique_ptr<AVFrame, AVFrameDeleter> scaled_frame{};
+    /// Frames are scaled into whichever of these the encoder has released, so that frames it
+    /// still references never have to be copied
+    std::vector<std::unique_ptr<AVFrame, AVFrameDeleter>> scaled_frames{};
+    /// The pixel format the frames are scaled to
+    AVPixelFormat scaled_pixel_format{};
     std::unique_ptr<SwsContext, SwsContextDeleter> sws_context{};
     Layout::FramebufferLayout layout;
 
+    /// Device of the hardware encoder, if one is used. Its frames context is owned by the codec.
+    std::unique_ptr<AVBufferRef, AVBufferRefDeleter> hw_device_context{};
+    std::unique_ptr<AVFrame, AVFrameDeleter> hw_frame{};
+
     /// The pixel format the frames are stored in
     static constexpr AVPixelFormat pixel_format = AVPixelFormat::AV_PIX_FMT_BGRA;
 };
@@ -144,6 +167,11 @@ public:
     void FlushAudio();
     void WriteTrailer();
 
+    /// Returns true if the output is a network stream rather than a file
+    bool IsLive() const {
+        return live;
+    }
+
 private:
     struct AVFormatContextDeleter {
         void operator()(AVFormatContext* format_context) const {
@@ -156,13 +184,16 @@ private:
     FFmpegVideoStream video_stream{};
     std::unique_ptr<AVFormatContext, AVFormatContextDeleter> format_context{};
     std::mutex format_context_mutex;
+    /// Set for outputs such as srt://, udp:// or rtmp://, which are streamed with low latency
+    bool live = false;
 
     friend class FFmpegStream;
 };
 
 /**
  * FFmpeg video dumping backend.
- * This class implements a double buffer.
+ * Frames are queued to the encoding thread, which only blocks the renderer when it has fallen
+ * MaxQueuedVideoFrames frames behind. Live streams repeat the previous frame instead.
  */
 class FFmpegBackend : public Backend {
 public:
@@ -183,10 +214,11 @@ private:
 
     FFmpegMuxer ffmpeg{};
 
+    static constexpr std::size_t MaxQueuedVideoFrames = 4;
+
     Layout::FramebufferLayout video_layout;
-    std::array<VideoFrame, 2> video_frame_buffers;
-    u32 current_buffer = 0, next_buffer = 1;
-    Common::Event event1, event2;
+    Common::SPSCQueue<VideoFrame> video_frame_queue;
+    Common::Event video_frame_popped;
     std::thread video_processing_thread;
 
     std::array<Common::SPSCQueue<VariableAudioFrame>, 2> audio_frame_queues;
@@ -4,7 +4,10 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include "common/archives.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -20,13 +23,76 @@ SERIALIZE_EXPORT_IMPL(FileSys::DiskDirectory)
 
 namespace FileSys {
 
+/// The disk files alive, to keep the cached writes of handles of the same host file coherent
+static std::vector<const DiskFile*> disk_files;
+
+/**
+ * Guards disk_files and the cached writes of all disk files. Files are accessed from both the
+ * emulation thread and the FS I/O thread, and a handle writes back the caches of other handles.
+ */
+static std::recursive_mutex disk_files_mutex;
+
+DiskFile::DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
+                   std::unique_ptr<DelayGenerator> delay_generator_)
+    : file(new FileUtil::IOFile(std::move(file_))) {
+    delay_generator = std::move(delay_generator_);
+    mode.hex = mode_.hex;
+    std::scoped_lock lock{disk_files_mutex};
+    disk_files.push_back(this);
+}
+
+DiskFile::DiskFile() {
+    std::scoped_lock lock{disk_files_mutex};
+    disk_files.push_back(this);
+}
+
+DiskFile::~DiskFile() {
+    std::scoped_lock lock{disk_files_mutex};
+    if (file && file->IsOpen()) {
+        WriteBack();
+    }
+    disk_files.erase(std::find(disk_files.begin(), disk_files.end(), this));
+}
+
 ResultVal<std::size_t> DiskFile::Read(const u64 offset, const std::size_t length,
                                       u8* buffer) const {
     if (!mode.read_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
+    std::scoped_lock lock{disk_files_mutex};
+    WriteBackOtherHandles();
+
     file->Seek(offset, SEEK_SET);
-    return MakeResult<std::size_t>(file->ReadBytes(buffer, length));
+    if (cached_writes.empty()) {
+        return MakeResult<std::size_t>(file->ReadBytes(buffer, length));
+    }
+
+    const u64 size = GetSize();
+    if (offset >= size) {
+        return MakeResult<std::size_t>(0);
+    }
+    const std::size_t read_length = static_cast<std::size_t>(std::min<u64>(length, size - offset));
+    const std::size_t host_length = std::min(file->ReadBytes(buffer, read_length), read_length);
+
+    // Cached writes may extend the file past the host file, leaving a gap read as zeroes
+    std::memset(buffer + host_length, 0, read_length - host_length);
+
+    const u64 end = offset + read_length;
+    auto it = cached_writes.upper_bound(offset);
+    if (it != cached_writes.begin()) {
+        --it;
+    }
+    for (; it != cached_writes.end() && it->first < end; ++it) {
+        const u64 range_end = it->first + it->second.size();
+        if (range_end <= offset) {
+            continue;
+        }
+        const u64 copy_begin = std::max(offset, it->first);
+        const u64 copy_end = std::min(end, range_end);
+        std::memcpy(buffer + (copy_begin - offset), it->second.data() + (copy_begin - it->first),
+                    static_cast<std::size_t>(copy_end - copy_begin));
+    }
+    return MakeResult<std::size_t>(read_length);
 }
 
 ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t length, const bool flush,
@@ -34,27 +100,118 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
     if (!mode.write_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
-    file->Seek(offset, SEEK_SET);
-    std::size_t written = file->WriteBytes(buffer, length);
-    if (flush)
-        file->Flush();
-    return MakeResult<std::size_t>(written);
+    std::scoped_lock lock{disk_files_mutex};
+    WriteBackOtherHandles();
+    CacheWrite(offset, length, buffer);
+    if (flush) {
+        Flush();
+    } else if (cached_write_size > MaxCachedWriteSize) {
+        WriteBack();
+    }
+    return MakeResult<std::size_t>(length);
 }
 
 u64 DiskFile::GetSize() const {
-    return file->GetSize();
+    std::scoped_lock lock{disk_files_mutex};
+    const u64 host_size = file->GetSize();
+    if (cached_writes.empty()) {
+        return host_size;
+    }
+    const auto& [last_offset, last_data] = *cached_writes.rbegin();
+    return std::max<u64>(host_size, last_offset + last_data.size());
 }
 
 bool DiskFile::SetSize(const u64 size) const {
+    std::scoped_lock lock{disk_files_mutex};
+    WriteBack();
     file->Resize(size);
     file->Flush();
     return true;
 }
 
 bool DiskFile::Close() const {
+    std::scoped_lock lock{disk_files_mutex};
+    WriteBack();
     return file->Close();
 }
 
+void DiskFile::Flush() const {
+    std::scoped_lock lock{disk_files_mutex};
+    WriteBack();
+    file->Flush();
+}
+
+void DiskFile::CacheWrite(const u64 offset, const std::size_t length, const u8* buffer) {
+    if (length == 0) {
+        return;
+    }
+    const u64 end = offset + length;
+
+    // The first range that overlaps or touches the write
+    auto first = cached_writes.upper_bound(offset);
+    if (first != cached_writes.begin()) {
+        const auto previous = std::prev(first);
+        if (previous->first + previous->second.size() >= offset) {
+            first = previous;
+        }
+    }
+    auto last = first;
+    while (last != cached_writes.end() && last->first <= end) {
+        ++last;
+    }
+
+    if (first != cached_writes.end() && std::next(first) == last && first->first <= offset) {
+        // Overwrites or appends to a single range, the usual case of sequential writes
+        std::vector<u8>& data = first->second;
+        const std::size_t new_size = std::max<std::size_t>(data.size(), end - first->first);
+        cached_write_size += new_size - data.size();
+        data.resize(new_size);
+        std::memcpy(data.data() + (offset - first->first), buffer, length);
+        return;
+    }
+
+    u64 merged_offset = offset;
+    u64 merged_end = end;
+    if (first != last) {
+        merged_offset = std::min(offset, first->first);
+        const auto& [last_offset, last_data] = *std::prev(last);
+        merged_end = std::max<u64>(end, last_offset + last_data.size());
+    }
+    std::vector<u8> merged(static_cast<std::size_t>(merged_end - merged_offset));
+    for (auto it = first; it != last; ++it) {
+        std::memcpy(merged.data() + (it->first - merged_offset), it->second.data(),
+                    it->second.size());
+        cached_write_size -= it->second.size();
+    }
+    std::memcpy(merged.data() + (offset - merged_offset), buffer, length);
+    cached_write_size += merged.size();
+
+    cached_writes.erase(first, last);
+    cached_writes.emplace(merged_offset, std::move(merged));
+}
+
+void DiskFile::WriteBack() const {
+    std::scoped_lock lock{disk_files_mutex};
+    for (const auto& [offset, data] : cached_writes) {
+        file->Seek(offset, SEEK_SET);
+        if (file->WriteBytes(data.data(), data.size()) != data.size()) {
+            LOG_ERROR(Service_FS, "Could not write {} bytes at offset {} to {}", data.size(),
+                      offset, file->GetFilename());
+        }
+    }
+    cached_writes.clear();
+    cached_write_size = 0;
+}
+
+void DiskFile::WriteBackOtherHandles() const {
+    for (const DiskFile* other : disk_files) {
+        if (other != this && !other->cached_writes.empty() &&
+            other->file->GetFilename() == file->GetFilename()) {
+            other->Flush();
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 DiskDirectory::DiskDirectory(const std::string& path) {
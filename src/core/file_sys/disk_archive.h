@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -23,14 +24,23 @@
 
 namespace FileSys {
 
+/**
+ * A file of the host file system. Writes are cached in memory and written to the host file in
+ * coalesced ranges when the file is flushed, closed, resized or destroyed, when a write is made
+ * with the flush flag, or when the cached data grows past MaxCachedWriteSize. Another handle of
+ * the same host file writes back the cache of this one before accessing the file.
+ *
+ * Crash consistency: if the emulator exits without destroying its files, for example by
+ * crashing, writes made since the last write-back are lost, while earlier ones are in the host
+ * file. Applications keep their save data consistent the same way as on hardware, by writing
+ * with the flush flag or flushing the file, and a write-back does not reorder writes of the same
+ * range. Write errors of cached writes are logged at write-back, not returned to the application.
+ */
 class DiskFile : public FileBackend {
 public:
     DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
-             std::unique_ptr<DelayGenerator> delay_generator_)
-        : file(new FileUtil::IOFile(std::move(file_))) {
-        delay_generator = std::move(delay_generator_);
-        mode.hex = mode_.hex;
-    }
+             std::unique_ptr<DelayGenerator> delay_generator_);
+    ~DiskFile() override;
 
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
@@ -38,20 +48,36 @@ public:
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
     bool Close() const override;
-
-    void Flush() const override {
-        file->Flush();
-    }
+    void Flush() const override;
 
 protected:
     Mode mode;
     std::unique_ptr<FileUtil::IOFile> file;
 
 private:
-    DiskFile() = default;
+    /// Size of the cached writes of a file past which they are written to the host file
+    static constexpr std::size_t MaxCachedWriteSize = 1024 * 1024;
+
+    DiskFile();
+
+    /// Caches a write, merging it with the cached writes it overlaps or touches
+    void CacheWrite(u64 offset, std::size_t length, const u8* buffer);
+
+    /// Writes the cached writes to the host file
+    void WriteBack() const;
+
+    /// Writes back the cached writes of the other handles of the same host file
+    void WriteBackOtherHandles() const;
+
+    /// Cached writes as disjoint, non-adjacent ranges of data, keyed by their offset
+    mutable std::map<u64, std::vector<u8>> cached_writes;
+    mutable std::size_t cached_write_size = 0;
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
+        if (Archive::is_saving::value) {
+            WriteBack();
+        }
         ar& boost::serialization::base_object<FileBackend>(*this);
         ar& mode.hex;
         ar& file;
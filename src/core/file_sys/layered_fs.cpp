@@ -68,10 +68,21 @@ void LayeredFS::Load() {
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
 
+    // Read the metadata tables at once rather than entry by entry
+    original_directory_metadata.resize(header.directory_metadata_table.length);
+    romfs->ReadFile(header.directory_metadata_table.offset, original_directory_metadata.size(),
+                    original_directory_metadata.data());
+    original_file_metadata.resize(header.file_metadata_table.length);
+    romfs->ReadFile(header.file_metadata_table.offset, original_file_metadata.size(),
+                    original_file_metadata.data());
+
     // TODO: is root always the first directory in table?
     root.parent = &root;
     LoadDirectory(root, 0);
 
+    original_directory_metadata = {};
+    original_file_metadata = {};
+
     if (load_relocations) {
         LoadRelocations();
         LoadExtRelocations();
@@ -84,11 +95,12 @@ LayeredFS::~LayeredFS() = default;
 
 u32 LayeredFS::LoadDirectory(Directory& current, u32 offset) {
     DirectoryMetadata metadata;
-    romfs->ReadFile(header.directory_metadata_table.offset + offset, sizeof(metadata),
-                    reinterpret_cast<u8*>(&metadata));
+    ASSERT_MSG(offset + sizeof(metadata) <= original_directory_metadata.size(),
+               "Directory metadata is out of bounds");
+    std::memcpy(&metadata, original_directory_metadata.data() + offset, sizeof(metadata));
 
-    current.name = ReadName(header.directory_metadata_table.offset + offset + sizeof(metadata),
-                            metadata.name_length);
+    current.name = ReadName(original_directory_metadata,
+                            offset + static_cast<u32>(sizeof(metadata)), metadata.name_length);
     current.path = current.parent->path + current.name + DIR_SEP;
     directory_path_map.emplace(current.path, &current);
 
@@ -111,11 +123,12 @@ u32 LayeredFS::LoadDirectory(Directory& current, u32 offset) {
 
 u32 LayeredFS::LoadFile(Directory& parent, u32 offset) {
     FileMetadata metadata;
-    romfs->ReadFile(header.file_metadata_table.offset + offset, sizeof(metadata),
-                    reinterpret_cast<u8*>(&metadata));
+    ASSERT_MSG(offset + sizeof(metadata) <= original_file_metadata.size(),
+               "File metadata is out of bounds");
+    std::memcpy(&metadata, original_file_metadata.data() + offset, sizeof(metadata));
 
     auto file = std::make_unique<File>();
-    file->name = ReadName(header.file_metadata_table.offset + offset + sizeof(metadata),
+    file->name = ReadName(original_file_metadata, offset + static_cast<u32>(sizeof(metadata)),
                           metadata.name_length);
     file->path = parent.path + file->name;
     file->relocation.original_offset = header.file_data_offset + metadata.file_data_offset;
@@ -128,9 +141,10 @@ u32 LayeredFS::LoadFile(Directory& parent, u32 offset) {
     return metadata.next_sibling_offset;
 }
 
-std::string LayeredFS::ReadName(u32 offset, u32 name_length) {
+std::string LayeredFS::ReadName(const std::vector<u8>& table, u32 offset, u32 name_length) {
+    ASSERT_MSG(std::size_t{offset} + name_length <= table.size(), "Name is out of bounds");
     std::vector<u16_le> buffer(name_length / sizeof(u16_le));
-    romfs->ReadFile(offset, name_length, reinterpret_cast<u8*>(buffer.data()));
+    std::memcpy(buffer.data(), table.data() + offset, buffer.size() * sizeof(u16_le));
 
     std::u16string name(buffer.size(), 0);
     std::transform(buffer.begin(), buffer.end(), name.begin(), [](u16_le character) {
@@ -328,6 +342,17 @@ static std::size_t WriteName(u8* dest, std::u16string name) {
 void LayeredFS::BuildDirectories() {
     directory_metadata_table.resize(current_directory_offset, 0xFF);
 
+    // Find the next sibling of every directory in one pass, as directories can be large
+    std::unordered_map<const Directory*, u32> next_sibling_offsets;
+    for (const auto& directory : directory_list) {
+        u32 next_offset = 0xFFFFFFFF;
+        for (auto child = directory->directories.rbegin(); child != directory->directories.rend();
+             ++child) {
+            next_sibling_offsets.emplace(child->get(), next_offset);
+            next_offset = directory_metadata_offset_map.at(child->get());
+        }
+    }
+
     std::size_t written = 0;
     for (const auto& directory : directory_list) {
         DirectoryMetadata metadata;
@@ -335,15 +360,7 @@ void LayeredFS::BuildDirectories() {
         metadata.parent_directory_offset = directory_metadata_offset_map.at(directory->parent);
 
         if (directory->parent != directory) {
-            bool flag = false;
-            for (const auto& sibling : directory->parent->directories) {
-                if (flag) {
-                    metadata.next_sibling_offset = directory_metadata_offset_map.at(sibling.get());
-                    break;
-                } else if (sibling.get() == directory) {
-                    flag = true;
-                }
-            }
+            metadata.next_sibling_offset = next_sibling_offsets.at(directory);
         }
 
         if (!directory->directories.empty()) {
@@ -378,25 +395,26 @@ void LayeredFS::BuildDirectories() {
 void LayeredFS::BuildFiles() {
     file_metadata_table.resize(current_file_offset, 0xFF);
 
+    // Find the next sibling of every file in one pass, skipping removed files
+    std::unordered_map<const File*, u32> next_sibling_offsets;
+    for (const auto& directory : directory_list) {
+        u32 next_offset = 0xFFFFFFFF;
+        for (auto child = directory->files.rbegin(); child != directory->files.rend(); ++child) {
+            if ((*child)->relocation.type == 3) {
+                continue;
+            }
+            next_sibling_offsets.emplace(child->get(), next_offset);
+            next_offset = file_metadata_offset_map.at(child->get());
+        }
+    }
+
     std::size_t written = 0;
     for (const auto& file : file_list) {
         FileMetadata metadata;
         std::memset(&metadata, 0xFF, sizeof(metadata));
 
         metadata.parent_directory_offset = directory_metadata_offset_map.at(file->parent);
-
-        bool flag = false;
-        for (const auto& sibling : file->parent->files) {
-            if (sibling->relocation.type == 3) { // removed file
-                continue;
-            }
-            if (flag) {
-                metadata.next_sibling_offset = file_metadata_offset_map.at(sibling.get());
-                break;
-            } else if (sibling.get() == file) {
-                flag = true;
-            }
-        }
+        metadata.next_sibling_offset = next_sibling_offsets.at(file);
 
         metadata.file_data_offset = current_data_offset;
         metadata.file_data_length = file->relocation.size;
@@ -490,6 +508,8 @@ std::size_t LayeredFS::GetSize() const {
 std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     ASSERT_MSG(offset + length <= GetSize(), "Out of bound");
 
+    std::scoped_lock lock{read_mutex};
+
     std::size_t read_size = 0;
     if (offset < metadata.size()) {
         // First read the metadata
@@ -522,7 +542,10 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
             romfs->ReadFile(relocation.original_offset + relative_offset, to_read,
                             buffer + read_size);
         } else if (relocation.type == 1) { // replace
-            FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
+            if (replace_file_owner != current->second) {
+                replace_file = FileUtil::IOFile(relocation.replace_file_path, "rb");
+                replace_file_owner = current->second;
+            }
             if (replace_file) {
                 replace_file.Seek(relative_offset, SEEK_SET);
                 replace_file.ReadBytes(buffer + read_size, to_read);
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -63,7 +64,8 @@ private:
         Directory* parent;
     };
 
-    std::string ReadName(u32 offset, u32 name_length);
+    // Reads a name from a metadata table of the original RomFS
+    static std::string ReadName(const std::vector<u8>& table, u32 offset, u32 name_length);
 
     // Loads the current directory, then its children.
     // Returns offset of the next sibling directory to load (0xFFFFFFFF if the last directory)
@@ -106,6 +108,9 @@ private:
     bool load_relocations;
 
     RomFSHeader header;
+    // Metadata tables of the original RomFS, only kept while loading
+    std::vector<u8> original_directory_metadata;
+    std::vector<u8> original_file_metadata;
     Directory root;
     std::unordered_map<std::string, File*> file_path_map;
     std::unordered_map<std::string, Directory*> directory_path_map;
@@ -128,6 +133,11 @@ private:
     std::vector<u8> file_metadata_table; // rebuilt file metadata table
     u64 current_data_offset{};           // current assigned data offset
 
+    // Replacement file last read from, kept open as files tend to be read in several parts
+    FileUtil::IOFile replace_file;
+    const File* replace_file_owner{};
+    std::mutex read_mutex;
+
     LayeredFS();
 
     template <class Archive>
@@ -8,8 +8,12 @@
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include <cryptopp/sha.h>
+#include "common/common_paths.h"
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/swap.h"
 #include "core/core.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/ncch_container.h"
@@ -26,6 +30,55 @@ namespace FileSys {
 static const int kMaxSections = 8;   ///< Maximum number of sections (files) in an ExeFs
 static const int kBlockSize = 0x200; ///< Size of ExeFS blocks (in bytes)
 
+/// Header of the files caching the decrypted and decompressed .code section of an ExeFS
+struct CodeCacheHeader {
+    std::array<u8, 4> magic;
+    u32_le size; ///< Size of the code following the header
+    u64_le hash; ///< Hash of the code, to detect a damaged file
+};
+static_assert(sizeof(CodeCacheHeader) == 16, "CodeCacheHeader has an unexpected size");
+
+constexpr std::array<u8, 4> CODE_CACHE_MAGIC{{'C', 'C', 'O', 'D'}};
+
+/// Reads code cached by SaveCachedCode, returning false if there is none or it is damaged
+static bool LoadCachedCode(const std::string& path, std::vector<u8>& code) {
+    FileUtil::IOFile file(path, "rb");
+    CodeCacheHeader header;
+    if (!file || file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != CODE_CACHE_MAGIC || file.GetSize() != sizeof(header) + header.size) {
+        return false;
+    }
+    code.resize(header.size);
+    return file.ReadBytes(code.data(), code.size()) == code.size() &&
+           Common::ComputeHash64(code.data(), code.size()) == header.hash;
+}
+
+static void SaveCachedCode(const std::string& path, const std::vector<u8>& code) {
+    if (!FileUtil::CreateFullPath(path)) {
+        return;
+    }
+
+    CodeCacheHeader header;
+    header.magic = CODE_CACHE_MAGIC;
+    header.size = static_cast<u32>(code.size());
+    header.hash = Common::ComputeHash64(code.data(), code.size());
+
+    // Written under a temporary name first, so that a partial file is never read
+    const std::string temp_path = path + ".tmp";
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file || file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
+            file.WriteBytes(code.data(), code.size()) != code.size()) {
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return;
+        }
+    }
+    if (!FileUtil::Rename(temp_path, path)) {
+        FileUtil::Delete(temp_path);
+    }
+}
+
 u64 GetModId(u64 program_id) {
     constexpr u64 UPDATE_MASK = 0x0000000e'00000000;
     if ((program_id & 0x000000ff'00000000) == UPDATE_MASK) { // Apply the mods to updates
@@ -535,6 +588,29 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                                                               exefs_ctr.data());
             dec.Seek(section.offset + sizeof(ExeFs_Header));
 
+            // Decrypting and decompressing the code takes a while for large titles, so its result
+            // is kept in the cache directory. The headers hold the hashes of the ExeFS sections,
+            // so together with the key they identify the code.
+            const bool is_cached_code =
+                strcmp(section.name, ".code") == 0 && (is_compressed || is_encrypted);
+            std::string cache_path;
+            if (is_cached_code) {
+                u64 headers_hash = Common::ComputeHash64(&ncch_header, sizeof(ncch_header));
+                headers_hash = Common::CityHash64WithSeed(
+                    reinterpret_cast<const char*>(&exefs_header), sizeof(exefs_header),
+                    headers_hash);
+                headers_hash = Common::CityHash64WithSeed(
+                    reinterpret_cast<const char*>(key.data()), key.size(), headers_hash);
+                cache_path = fmt::format(
+                    "{}exefs_code" DIR_SEP "{:016X}_{:016X}.bin",
+                    FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                    static_cast<u64>(ncch_header.program_id), headers_hash);
+                if (LoadCachedCode(cache_path, buffer)) {
+                    LOG_DEBUG(Service_FS, "Loaded the .code section from {}", cache_path);
+                    return Loader::ResultStatus::Success;
+                }
+            }
+
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
                 // Section is compressed, read compressed .code section...
                 std::unique_ptr<u8[]> temp_buffer;
@@ -567,6 +643,9 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 }
             }
 
+            if (is_cached_code) {
+                SaveCachedCode(cache_path, buffer);
+            }
             return Loader::ResultStatus::Success;
         }
     }
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "common/archives.h"
@@ -8,16 +9,101 @@ SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
 
 namespace FileSys {
 
+struct DirectRomFSReader::Decryptor {
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption context;
+};
+
+DirectRomFSReader::DirectRomFSReader() = default;
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size, const std::array<u8, 16>& key,
+                                     const std::array<u8, 16>& ctr, std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size) {}
+
+DirectRomFSReader::~DirectRomFSReader() = default;
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
-        return 0; // Crypto++ does not like zero size buffer
+    if (length == 0 || offset >= data_size)
+        return 0;
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+
+    std::scoped_lock lock{mutex};
+
+    // Large reads would only evict the cache
+    if (length >= PREFETCH_BLOCKS * CACHE_BLOCK_SIZE) {
+        return ReadUncached(offset, length, buffer);
+    }
+
+    std::size_t read_length = 0;
+    while (read_length < length) {
+        const std::size_t position = offset + read_length;
+        const CacheBlock& block = GetBlock(position / CACHE_BLOCK_SIZE);
+        const std::size_t block_offset = position % CACHE_BLOCK_SIZE;
+        if (block_offset >= block.size) {
+            break;
+        }
+        const std::size_t copy_length = std::min(length - read_length, block.size - block_offset);
+        std::memcpy(buffer + read_length, block.data.data() + block_offset, copy_length);
+        read_length += copy_length;
+    }
+    return read_length;
+}
+
+const DirectRomFSReader::CacheBlock& DirectRomFSReader::GetBlock(u64 index) {
+    if (cache.empty()) {
+        cache.resize(CACHE_NUM_BLOCKS);
+    }
+    ++cache_tick;
+
+    for (CacheBlock& block : cache) {
+        if (block.last_use != 0 && block.index == index) {
+            block.last_use = cache_tick;
+            return block;
+        }
+    }
+
+    const u64 num_blocks = (data_size + CACHE_BLOCK_SIZE - 1) / CACHE_BLOCK_SIZE;
+    const u64 count = std::min<u64>(index == last_miss + 1 ? PREFETCH_BLOCKS : 1,
+                                    num_blocks - index);
+    last_miss = index + count - 1;
+
+    std::vector<u8> data(count * CACHE_BLOCK_SIZE);
+    const std::size_t read_length =
+        ReadUncached(index * CACHE_BLOCK_SIZE, data.size(), data.data());
+
+    // Replace the least recently used blocks, the requested one being the most recent
+    CacheBlock* requested = nullptr;
+    for (u64 i = count; i-- > 0;) {
+        CacheBlock& block = *std::min_element(
+            cache.begin(), cache.end(),
+            [](const CacheBlock& a, const CacheBlock& b) { return a.last_use < b.last_use; });
+        const std::size_t start = i * CACHE_BLOCK_SIZE;
+        block.index = index + i;
+        block.last_use = i == 0 ? cache_tick : cache_tick - 1;
+        block.size = read_length > start ? std::min(read_length - start, CACHE_BLOCK_SIZE) : 0;
+        block.data.assign(data.begin() + start, data.begin() + start + CACHE_BLOCK_SIZE);
+        requested = &block;
+    }
+    return *requested;
+}
+
+std::size_t DirectRomFSReader::ReadUncached(std::size_t offset, std::size_t length, u8* buffer) {
     file.Seek(file_offset + offset, SEEK_SET);
     std::size_t read_length = std::min(length, static_cast<std::size_t>(data_size) - offset);
     read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    if (is_encrypted && read_length > 0) { // Crypto++ does not like zero size buffer
+        // Seeking restarts the counter from the initial one, so the key schedule can be reused
+        if (!decryptor) {
+            decryptor = std::make_unique<Decryptor>();
+            decryptor->context.SetKeyWithIV(key.data(), key.size(), ctr.data());
+        }
+        decryptor->context.Seek(crypto_offset + offset);
+        decryptor->context.ProcessData(buffer, buffer, read_length);
     }
     return read_length;
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
@@ -26,21 +29,19 @@ private:
 };
 
 /**
- * A RomFS reader that directly reads the RomFS file.
+ * A RomFS reader that directly reads the RomFS file. Small reads go through a cache of decrypted
+ * blocks, as games tend to issue many small reads close to each other, and misses that follow the
+ * previous one also load the next few blocks.
  */
 class DirectRomFSReader : public RomFSReader {
 public:
-    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                      std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                      std::size_t crypto_offset);
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -49,6 +50,34 @@ public:
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override;
 
 private:
+    static constexpr std::size_t CACHE_BLOCK_SIZE = 0x4000;
+    static constexpr std::size_t CACHE_NUM_BLOCKS = 32;
+    /// Number of blocks loaded at once by a sequential miss
+    static constexpr std::size_t PREFETCH_BLOCKS = 4;
+
+    struct CacheBlock {
+        u64 index = 0;
+        u64 last_use = 0; ///< Zero if the block is unused
+        std::size_t size = 0;
+        std::vector<u8> data;
+    };
+
+    /// Reads and decrypts data from the file, bypassing the cache
+    std::size_t ReadUncached(std::size_t offset, std::size_t length, u8* buffer);
+    /// Returns the cached block with the given index, loading it if needed
+    const CacheBlock& GetBlock(u64 index);
+
+    /// Keyed decryption context, created on first use
+    struct Decryptor;
+    std::unique_ptr<Decryptor> decryptor;
+
+    /// Not serialized, as it only caches the contents of the file
+    std::vector<CacheBlock> cache;
+    u64 cache_tick = 0;
+    u64 last_miss = ~0ULL;
+    /// The reader is shared by the files opened from the RomFS, and read from the FS I/O thread
+    std::mutex mutex;
+
     bool is_encrypted;
     FileUtil::IOFile file;
     std::array<u8, 16> key;
@@ -57,7 +86,7 @@ private:
     u64 crypto_offset;
     u64 data_size;
 
-    DirectRomFSReader() = default;
+    DirectRomFSReader();
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
@@ -0,0 +1,42 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/frame_counters.h"
+
+namespace Core {
+
+namespace Detail {
+std::array<std::atomic<u32>, NumFrameCounters> frame_counters{};
+}
+
+const char* GetFrameCounterName(FrameCounter counter) {
+    switch (counter) {
+    case FrameCounter::Draws:
+        return "Draws";
+    case FrameCounter::SurfaceCacheMisses:
+        return "Surface cache misses";
+    case FrameCounter::TextureUploads:
+        return "Texture uploads";
+    case FrameCounter::LUTUploads:
+        return "LUT uploads";
+    case FrameCounter::ShaderCompiles:
+        return "Shader compiles";
+    case FrameCounter::SVCs:
+        return "SVCs";
+    case FrameCounter::IPCRequests:
+        return "IPC requests";
+    default:
+        return "Unknown";
+    }
+}
+
+FrameCounterValues TakeFrameCounters() {
+    FrameCounterValues values;
+    for (std::size_t i = 0; i < NumFrameCounters; ++i) {
+        values[i] = Detail::frame_counters[i].exchange(0, std::memory_order_relaxed);
+    }
+    return values;
+}
+
+} // namespace Core
@@ -0,0 +1,46 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Core {
+
+/// Events on the hot paths that are counted per system frame
+enum class FrameCounter : u32 {
+    Draws,              ///< Draw calls issued by the hardware rasterizer
+    SurfaceCacheMisses, ///< Surfaces created by the rasterizer cache for lack of a match
+    TextureUploads,     ///< Uploads of surface data to the host GPU
+    LUTUploads,         ///< LUTs written to the uniform buffer, not counting rebound copies
+    ShaderCompiles,     ///< Host shaders compiled, synchronously or by the async compiler
+    SVCs,               ///< Supervisor calls made by the guest
+    IPCRequests,        ///< Sync requests handled by HLE services
+    Count,
+};
+
+constexpr std::size_t NumFrameCounters = static_cast<std::size_t>(FrameCounter::Count);
+
+using FrameCounterValues = std::array<u32, NumFrameCounters>;
+
+/// Returns a short name of the counter, for display
+const char* GetFrameCounterName(FrameCounter counter);
+
+namespace Detail {
+extern std::array<std::atomic<u32>, NumFrameCounters> frame_counters;
+}
+
+/// Counts an event in the current system frame. Can be called from any thread.
+inline void CountFrameEvent(FrameCounter counter, u32 count = 1) {
+    Detail::frame_counters[static_cast<std::size_t>(counter)].fetch_add(count,
+                                                                        std::memory_order_relaxed);
+}
+
+/// Returns the counts since the previous call and resets them. Called by PerfStats every frame.
+FrameCounterValues TakeFrameCounters();
+
+} // namespace Core
@@ -55,6 +55,14 @@ EmuWindow::~EmuWindow() {
     Input::UnregisterFactory<Input::TouchDevice>("emu_window");
 }
 
+bool EmuWindow::IsFastForwarding() const {
+    const u16 frame_limit = Settings::values.use_frame_limit_alternate
+                                ? Settings::values.frame_limit_alternate
+                                : Settings::values.frame_limit;
+    // A limit of 0 is unthrottled
+    return frame_limit == 0 || frame_limit > 100;
+}
+
 /**
  * Check if the given x/y coordinates are within the touchpad specified by the framebuffer layout
  * @param layout FramebufferLayout object describing the framebuffer size and screen positions
@@ -141,6 +149,7 @@ bool EmuWindow::TouchPressed(unsigned framebuffer_x, unsigned framebuffer_y) {
     }
 
     touch_state->touch_pressed = true;
+    Input::NotifyStateChange();
     return true;
 }
 
@@ -149,6 +158,7 @@ void EmuWindow::TouchReleased() {
     touch_state->touch_pressed = false;
     touch_state->touch_x = 0;
     touch_state->touch_y = 0;
+    Input::NotifyStateChange();
 }
 
 void EmuWindow::TouchMoved(unsigned framebuffer_x, unsigned framebuffer_y) {
@@ -12,6 +12,33 @@
 
 namespace Frontend {
 
+/// Rendered frame, defined by the renderer
+struct Frame;
+
+/**
+ * Hands rendered frames from the emulation thread to the thread presenting them. The renderer
+ * draws into a free frame while the presenter shows the newest finished one. A finished frame that
+ * is replaced before it could be presented is dropped, so the emulation never waits for the
+ * presenter and the displayed frame is at most one refresh old.
+ */
+class TextureMailbox {
+public:
+    virtual ~TextureMailbox() = default;
+
+    /// Returns a frame to draw into. Never blocks. Emulation thread only.
+    virtual Frame* GetRenderFrame() = 0;
+
+    /// Queues a frame obtained from GetRenderFrame for presentation. Emulation thread only.
+    virtual void ReleaseRenderFrame(Frame* frame) = 0;
+
+    /**
+     * Waits up to timeout_ms for a new frame. Present thread only.
+     * @returns The newest queued frame, or the previously presented one if none arrived in time
+     *          (nullptr before the first frame)
+     */
+    virtual Frame* TryGetPresentFrame(int timeout_ms) = 0;
+};
+
 /**
  * Abstraction class used to provide an interface between emulation code and the frontend
  * (e.g. SDL, QGLWidget, GLFW, etc...).
@@ -114,6 +141,26 @@ public:
     /// Flags that the framebuffer should be cleared.
     virtual bool NeedsClearing() const = 0;
 
+    /**
+     * Flags that frames are shown by a thread other than the emulation thread. The renderer then
+     * draws into the mailbox instead of the window, and the present thread shows its frames.
+     */
+    virtual bool IsPresentedOnSeparateThread() const {
+        return false;
+    }
+
+    /// Returns true if the emulation is allowed to run faster than the 3DS would
+    virtual bool IsFastForwarding() const;
+
+    /**
+     * Called instead of SwapBuffers for the frames the renderer skips while fast-forwarding.
+     * Frontends that have to hand over a frame for every emulated one can repeat the last one.
+     */
+    virtual void SkipFrame() {}
+
+    /// Frame handoff to the present thread, created by the renderer if IsPresentedOnSeparateThread
+    std::unique_ptr<TextureMailbox> mailbox;
+
 protected:
     EmuWindow();
     virtual ~EmuWindow();
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -11,10 +13,14 @@
 #include <utility>
 #include "common/logging/log.h"
 #include "common/param_package.h"
+#include "common/seqlock.h"
 #include "common/vector_math.h"
 
 namespace Input {
 
+/// Clock that input state is timestamped with
+using Clock = std::chrono::steady_clock;
+
 /// An abstract class template for an input device (a button, an analog input, etc.).
 template <typename StatusType>
 class InputDevice {
@@ -46,8 +52,51 @@ struct FactoryList {
 template <typename InputDeviceType>
 FactoryListType<InputDeviceType> FactoryList<InputDeviceType>::list;
 
+inline std::atomic<Clock::rep> last_state_change{0};
+
 } // namespace Impl
 
+/**
+ * The state that a device published last, with the time it was published. Devices publish from
+ * their own threads, one writer per slot, and HID reads the latest state without locks.
+ */
+template <typename T>
+class StateSlot {
+public:
+    void Publish(const T& value) {
+        state.Store({value, Clock::now().time_since_epoch().count()});
+    }
+
+    [[nodiscard]] T Get() const {
+        return state.Load().value;
+    }
+
+    [[nodiscard]] Clock::time_point GetTimestamp() const {
+        return Clock::time_point{Clock::duration{state.Load().timestamp}};
+    }
+
+private:
+    struct Timestamped {
+        T value;
+        Clock::rep timestamp;
+    };
+    Common::SeqLock<Timestamped> state;
+};
+
+/**
+ * Records that a button, analog or touch device changed state, so that the time until HID writes
+ * it to shared memory can be measured. Motion devices change continuously and do not report.
+ */
+inline void NotifyStateChange(Clock::time_point time = Clock::now()) {
+    Impl::last_state_change.store(time.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+/// Returns the time of the latest NotifyStateChange, or the clock epoch if there was none
+inline Clock::time_point GetLastStateChange() {
+    return Clock::time_point{
+        Clock::duration{Impl::last_state_change.load(std::memory_order_relaxed)}};
+}
+
 /**
  * Registers an input device factory.
  * @tparam InputDeviceType the type of input devices the factory can create
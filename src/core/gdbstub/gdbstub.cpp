@@ -5,7 +5,9 @@
 // Originally written by Sven Peter <sven@fail0verflow.com> for anergistic.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <climits>
 #include <csignal>
 #include <cstdarg>
@@ -41,7 +43,10 @@
 
 namespace GDBStub {
 namespace {
-constexpr int GDB_BUFFER_SIZE = 10000;
+/// Largest packet payload, advertised to the client as PacketSize so memory transfers need fewer
+/// round trips. Leaves room for the framing and a terminating zero.
+constexpr int GDB_PACKET_SIZE = 0x4000;
+constexpr int GDB_BUFFER_SIZE = GDB_PACKET_SIZE + 5;
 
 constexpr char GDB_STUB_START = '$';
 constexpr char GDB_STUB_END = '#';
@@ -56,10 +61,6 @@ constexpr u32 SIGTRAP = 5;
 constexpr u32 SIGTERM = 15;
 #endif
 
-#ifndef MSG_WAITALL
-constexpr u32 MSG_WAITALL = 8;
-#endif
-
 constexpr u32 SP_REGISTER = 13;
 constexpr u32 LR_REGISTER = 14;
 constexpr u32 PC_REGISTER = 15;
@@ -126,6 +127,18 @@ bool defer_start = false;
 u8 command_buffer[GDB_BUFFER_SIZE];
 u32 command_length;
 
+/// Bytes received from the client that have not been read yet
+static std::array<u8, 4096> receive_buffer;
+static std::size_t receive_pos = 0;
+static std::size_t receive_size = 0;
+
+/// How often the socket is polled while the CPU is running. Keeps an idle connection from costing
+/// a syscall and a context save on every run loop iteration.
+constexpr std::chrono::milliseconds POLL_INTERVAL{5};
+/// How long to wait for the client while the CPU is halted, so the run loop doesn't spin
+constexpr long HALTED_WAIT_US = 10000;
+static std::chrono::steady_clock::time_point next_poll;
+
 u32 latest_signal = 0;
 bool memory_break = false;
 
@@ -365,14 +378,21 @@ static u64 GdbHexToLong(const u8* src) {
 
 /// Read a byte from the gdb client.
 static u8 ReadByte() {
-    u8 c;
-    std::size_t received_size = recv(gdbserver_socket, reinterpret_cast<char*>(&c), 1, MSG_WAITALL);
-    if (received_size != 1) {
-        LOG_ERROR(Debug_GDBStub, "recv failed : {}", received_size);
-        Shutdown();
+    if (receive_pos == receive_size) {
+        // Takes whatever has arrived, so a packet usually needs a single recv
+        const int received_size =
+            static_cast<int>(recv(gdbserver_socket, reinterpret_cast<char*>(receive_buffer.data()),
+                                  static_cast<int>(receive_buffer.size()), 0));
+        if (received_size <= 0) {
+            LOG_ERROR(Debug_GDBStub, "recv failed : {}", received_size);
+            Shutdown();
+            return 0;
+        }
+        receive_pos = 0;
+        receive_size = static_cast<std::size_t>(received_size);
     }
 
-    return c;
+    return receive_buffer[receive_pos++];
 }
 
 /// Calculate the checksum of the current command buffer.
@@ -496,16 +516,15 @@ static void SendPacket(const char packet) {
  * Send reply to gdb client.
  *
  * @param reply Reply to be sent to client.
+ * @param length Length of the reply, which may hold binary data.
  */
-static void SendReply(const char* reply) {
+static void SendReply(const u8* reply, std::size_t length) {
     if (!IsConnected()) {
         return;
     }
 
-    memset(command_buffer, 0, sizeof(command_buffer));
-
-    command_length = static_cast<u32>(strlen(reply));
-    if (command_length + 4 > sizeof(command_buffer)) {
+    command_length = static_cast<u32>(length);
+    if (length + 4 > sizeof(command_buffer)) {
         LOG_ERROR(Debug_GDBStub, "command_buffer overflow in SendReply");
         return;
     }
@@ -532,6 +551,15 @@ static void SendReply(const char* reply) {
     }
 }
 
+/**
+ * Send reply to gdb client.
+ *
+ * @param reply Reply to be sent to client.
+ */
+static void SendReply(const char* reply) {
+    SendReply(reinterpret_cast<const u8*>(reply), strlen(reply));
+}
+
 /// Handle query command from gdb client.
 static void HandleQuery() {
     LOG_DEBUG(Debug_GDBStub, "gdb: query '{}'\n", command_buffer + 1);
@@ -542,7 +570,10 @@ static void HandleQuery() {
         SendReply("T0");
     } else if (strncmp(query, "Supported", strlen("Supported")) == 0) {
         // PacketSize needs to be large enough for target xml
-        SendReply("PacketSize=2000;qXfer:features:read+;qXfer:threads:read+");
+        const std::string supported = fmt::format(
+            "PacketSize={:x};qXfer:features:read+;qXfer:threads:read+;binary-upload+",
+            GDB_PACKET_SIZE);
+        SendReply(supported.c_str());
     } else if (strncmp(query, "Xfer:features:read:target.xml:",
                        strlen("Xfer:features:read:target.xml:")) == 0) {
         SendReply(target_xml);
@@ -651,7 +682,7 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
 /// Read command from gdb client.
 static void ReadCommand() {
     command_length = 0;
-    memset(command_buffer, 0, sizeof(command_buffer));
+    command_buffer[0] = 0;
 
     u8 c = ReadByte();
     if (c == '+') {
@@ -668,13 +699,16 @@ static void ReadCommand() {
     }
 
     while ((c = ReadByte()) != GDB_STUB_END) {
-        if (command_length >= sizeof(command_buffer)) {
+        if (command_length >= sizeof(command_buffer) - 1) {
             LOG_ERROR(Debug_GDBStub, "gdb: command_buffer overflow\n");
+            command_length = 0;
             SendPacket(GDB_STUB_NACK);
             return;
         }
         command_buffer[command_length++] = c;
     }
+    // Queries are parsed as strings
+    command_buffer[command_length] = 0;
 
     u8 checksum_received = HexCharToValue(ReadByte()) << 4;
     checksum_received |= HexCharToValue(ReadByte());
@@ -697,10 +731,13 @@ static void ReadCommand() {
 }
 
 /// Check if there is data to be read from the gdb client.
-static bool IsDataAvailable() {
+static bool IsDataAvailable(long timeout_us = 0) {
     if (!IsConnected()) {
         return false;
     }
+    if (receive_pos < receive_size) {
+        return true;
+    }
 
     fd_set fd_socket;
 
@@ -709,7 +746,7 @@ static bool IsDataAvailable() {
 
     struct timeval t;
     t.tv_sec = 0;
-    t.tv_usec = 0;
+    t.tv_usec = timeout_us;
 
     if (select(gdbserver_socket + 1, &fd_socket, nullptr, nullptr, &t) < 0) {
         LOG_ERROR(Debug_GDBStub, "select failed");
@@ -846,7 +883,7 @@ static void ReadMemory() {
     LOG_DEBUG(Debug_GDBStub, "gdb: addr: {:08x} len: {:08x}\n", addr, len);
 
     if (len * 2 > sizeof(reply)) {
-        SendReply("E01");
+        return SendReply("E01");
     }
 
     if (!Memory::IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
@@ -863,6 +900,50 @@ static void ReadMemory() {
     SendReply(reinterpret_cast<char*>(reply));
 }
 
+/**
+ * Read location in memory specified by gdb client, replying with escaped binary data instead of
+ * hex. Characters that have a meaning in the protocol are sent as '}' followed by the character
+ * xor 0x20, so the reply holds at most twice as many bytes as were read.
+ */
+static void ReadMemoryBinary() {
+    static u8 reply[GDB_BUFFER_SIZE - 4];
+
+    auto start_offset = command_buffer + 1;
+    auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
+    VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
+
+    start_offset = addr_pos + 1;
+    u32 len =
+        HexToInt(start_offset, static_cast<u32>((command_buffer + command_length) - start_offset));
+
+    LOG_DEBUG(Debug_GDBStub, "gdb: addr: {:08x} len: {:08x}\n", addr, len);
+
+    if (len * 2 + 1 > sizeof(reply)) {
+        return SendReply("E01");
+    }
+
+    if (!Memory::IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
+                                       addr)) {
+        return SendReply("E00");
+    }
+
+    std::vector<u8> data(len);
+    Core::System::GetInstance().Memory().ReadBlock(
+        *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, data.data(), len);
+
+    std::size_t reply_length = 0;
+    reply[reply_length++] = 'b';
+    for (const u8 c : data) {
+        if (c == GDB_STUB_START || c == GDB_STUB_END || c == '}' || c == '*') {
+            reply[reply_length++] = '}';
+            reply[reply_length++] = c ^ 0x20;
+        } else {
+            reply[reply_length++] = c;
+        }
+    }
+    SendReply(reply, reply_length);
+}
+
 /// Modify location in memory with data received from the gdb client.
 static void WriteMemory() {
     auto start_offset = command_buffer + 1;
@@ -887,18 +968,54 @@ static void WriteMemory() {
     SendReply("OK");
 }
 
+/// Modify location in memory with escaped binary data received from the gdb client.
+static void WriteMemoryBinary() {
+    auto start_offset = command_buffer + 1;
+    auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
+    VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
+
+    start_offset = addr_pos + 1;
+    auto len_pos = std::find(start_offset, command_buffer + command_length, ':');
+    u32 len = HexToInt(start_offset, static_cast<u32>(len_pos - start_offset));
+
+    // gdb sends an empty write to find out whether the packet is supported
+    if (len == 0) {
+        return SendReply("OK");
+    }
+
+    if (!Memory::IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
+                                       addr)) {
+        return SendReply("E00");
+    }
+
+    std::vector<u8> data;
+    data.reserve(len);
+    const u8* const end = command_buffer + command_length;
+    for (const u8* src = len_pos + 1; src < end && data.size() < len; ++src) {
+        if (*src == '}' && src + 1 < end) {
+            data.push_back(*++src ^ 0x20);
+        } else {
+            data.push_back(*src);
+        }
+    }
+    if (data.size() != len) {
+        return SendReply("E01");
+    }
+
+    Core::System::GetInstance().Memory().WriteBlock(
+        *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, data.data(), len);
+    Core::GetRunningCore().ClearInstructionCache();
+    SendReply("OK");
+}
+
 void Break(bool is_memory_break) {
     send_trap = true;
 
     memory_break = is_memory_break;
 }
 
-/// Tell the CPU that it should perform a single step.
-static void Step() {
-    if (command_length > 1) {
-        RegWrite(PC_REGISTER, GdbHexToInt(command_buffer + 1), current_thread);
-        Core::GetRunningCore().LoadContext(current_thread->context);
-    }
+/// Tell the CPU that it should perform a single step from the current PC.
+static void SingleStep() {
     step_loop = true;
     halt_loop = true;
     send_trap = true;
@@ -921,6 +1038,46 @@ static void Continue() {
     Core::GetRunningCore().ClearInstructionCache();
 }
 
+/// Tell the CPU that it should perform a single step, from the address given by the client if any.
+static void Step() {
+    if (command_length > 1) {
+        RegWrite(PC_REGISTER, GdbHexToInt(command_buffer + 1), current_thread);
+        Core::GetRunningCore().LoadContext(current_thread->context);
+    }
+    SingleStep();
+}
+
+/**
+ * Handle a v command from the gdb client. Only the all-stop form of vCont is supported: the first
+ * action is applied to the whole CPU, whatever thread it names.
+ *
+ * @return True if the CPU was resumed.
+ */
+static bool HandleVCommand() {
+    const char* command = reinterpret_cast<const char*>(command_buffer + 1);
+
+    if (strcmp(command, "Cont?") == 0) {
+        SendReply("vCont;c;C;s;S");
+    } else if (strncmp(command, "Cont;", strlen("Cont;")) == 0) {
+        switch (command[strlen("Cont;")]) {
+        case 'c':
+        case 'C':
+            Continue();
+            return true;
+        case 's':
+        case 'S':
+            SingleStep();
+            return true;
+        default:
+            SendReply("E01");
+            break;
+        }
+    } else {
+        SendReply("");
+    }
+    return false;
+}
+
 /**
  * Commit breakpoint to list of breakpoints.
  *
@@ -1042,23 +1199,12 @@ static void RemoveBreakpoint() {
     SendReply("OK");
 }
 
-void HandlePacket() {
-    if (!IsConnected()) {
-        if (defer_start) {
-            ToggleServer(true);
-        }
-        return;
-    }
-
-    if (!IsDataAvailable()) {
-        return;
-    }
-
-    ReadCommand();
-    if (command_length == 0) {
-        return;
-    }
-
+/**
+ * Handle the command in the command buffer.
+ *
+ * @return False if the CPU was resumed or the connection was closed.
+ */
+static bool HandleCommand() {
     LOG_DEBUG(Debug_GDBStub, "Packet: {}", command_buffer);
 
     switch (command_buffer[0]) {
@@ -1074,7 +1220,7 @@ void HandlePacket() {
     case 'k':
         Shutdown();
         LOG_INFO(Debug_GDBStub, "killed by gdb");
-        return;
+        return false;
     case 'g':
         ReadRegisters();
         break;
@@ -1093,13 +1239,21 @@ void HandlePacket() {
     case 'M':
         WriteMemory();
         break;
+    case 'x':
+        ReadMemoryBinary();
+        break;
+    case 'X':
+        WriteMemoryBinary();
+        break;
+    case 'v':
+        return !HandleVCommand();
     case 's':
         Step();
-        return;
+        return false;
     case 'C':
     case 'c':
         Continue();
-        return;
+        return false;
     case 'z':
         RemoveBreakpoint();
         break;
@@ -1113,6 +1267,46 @@ void HandlePacket() {
         SendReply("");
         break;
     }
+    return IsConnected();
+}
+
+bool HasPendingPacket() {
+    if (!IsConnected()) {
+        return defer_start;
+    }
+    if (receive_pos < receive_size) {
+        return true;
+    }
+    if (halt_loop) {
+        return IsDataAvailable(step_loop ? 0 : HALTED_WAIT_US);
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now < next_poll) {
+        return false;
+    }
+    next_poll = now + POLL_INTERVAL;
+    return IsDataAvailable();
+}
+
+void HandlePacket() {
+    if (!IsConnected()) {
+        if (defer_start) {
+            ToggleServer(true);
+        }
+        return;
+    }
+
+    // gdb usually sends several packets in a row, which are all handled before returning
+    while (IsDataAvailable()) {
+        ReadCommand();
+        if (command_length == 0) {
+            continue;
+        }
+        if (!HandleCommand()) {
+            return;
+        }
+    }
 }
 
 void SetServerPort(u16 port) {
@@ -1231,6 +1425,8 @@ void Shutdown() {
         shutdown(gdbserver_socket, SHUT_RDWR);
         gdbserver_socket = -1;
     }
+    receive_pos = 0;
+    receive_size = 0;
 
 #ifdef _WIN32
     WSACleanup();
@@ -68,7 +68,13 @@ void Break(bool is_memory_break = false);
 /// Determine if there was a memory breakpoint.
 bool IsMemoryBreak();
 
-/// Read and handle packet from gdb client.
+/**
+ * Check whether HandlePacket has anything to do. The socket is only polled every few milliseconds
+ * while the CPU runs, and waits briefly for the client while it is halted.
+ */
+bool HasPendingPacket();
+
+/// Read and handle the packets sent by the gdb client.
 void HandlePacket();
 
 /**
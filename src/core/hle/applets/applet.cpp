@@ -36,9 +36,9 @@ struct hash<Service::APT::AppletId> {
 
 namespace HLE::Applets {
 
-static std::unordered_map<Service::APT::AppletId, std::shared_ptr<Applet>> applets;
+static INSTANCE_LOCAL std::unordered_map<Service::APT::AppletId, std::shared_ptr<Applet>> applets;
 /// The CoreTiming event identifier for the Applet update callback.
-static Core::TimingEventType* applet_update_event = nullptr;
+static INSTANCE_LOCAL Core::TimingEventType* applet_update_event = nullptr;
 /// The interval at which the Applet update callback will be called, 16.6ms
 static const u64 applet_update_interval_us = 16666;
 
@@ -65,6 +65,12 @@ inline u32 MakeHeader(u16 command_id, unsigned int normal_params_size,
     return header.raw;
 }
 
+/// Returns the number of words of the command with the header, including the header itself.
+inline std::size_t CommandSize(u32 header_raw) {
+    const Header header{header_raw};
+    return 1 + header.normal_params_size + header.translate_params_size;
+}
+
 constexpr u32 MoveHandleDesc(u32 num_handles = 1) {
     return MoveHandle | ((num_handles - 1) << 26);
 }
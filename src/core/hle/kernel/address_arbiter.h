@@ -5,11 +5,13 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/string.hpp>
+#include <boost/serialization/unordered_map.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/version.hpp>
 #include "common/common_types.h"
@@ -74,8 +76,20 @@ private:
     /// the resumed thread.
     std::shared_ptr<Thread> ResumeHighestPriorityThread(VAddr address);
 
-    /// Threads waiting for the address arbiter to be signaled.
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /**
+     * Threads waiting for the address arbiter to be signaled, by the address they wait on and in
+     * the order they started waiting. Emptied lists are kept so that waiting on the same address
+     * again doesn't allocate.
+     */
+    std::unordered_map<VAddr, std::vector<std::shared_ptr<Thread>>> waiting_threads;
+
+    using WaitList = decltype(waiting_threads)::iterator;
+
+    /// Number of wait lists after which emptied ones are removed
+    static constexpr std::size_t MAX_IDLE_WAIT_LISTS = 64;
+
+    /// Removes the wait list if it is empty and too many lists are kept around.
+    void ReleaseWaitList(WaitList list);
 
     std::shared_ptr<Callback> timeout_callback;
 
@@ -101,7 +115,16 @@ private:
             ar& boost::serialization::base_object<WakeupCallback>(x);
         }
         ar& name;
-        ar& waiting_threads;
+        if (file_version > 2) {
+            ar& waiting_threads;
+        } else {
+            std::vector<std::shared_ptr<Thread>> threads;
+            ar& threads;
+            waiting_threads.clear();
+            for (auto& thread : threads) {
+                waiting_threads[thread->wait_address].push_back(std::move(thread));
+            }
+        }
         if (file_version > 1) {
             ar& timeout_callback;
         }
@@ -112,5 +135,5 @@ private:
 
 BOOST_CLASS_EXPORT_KEY(Kernel::AddressArbiter)
 BOOST_CLASS_EXPORT_KEY(Kernel::AddressArbiter::Callback)
-BOOST_CLASS_VERSION(Kernel::AddressArbiter, 2)
+BOOST_CLASS_VERSION(Kernel::AddressArbiter, 3)
 CONSTRUCT_KERNEL_OBJECT(Kernel::AddressArbiter)
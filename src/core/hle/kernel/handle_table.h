@@ -4,11 +4,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <stdexcept>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/result.h"
@@ -89,6 +93,27 @@ public:
         return DynamicObjectCast<T>(GetGeneric(handle));
     }
 
+    /**
+     * Looks up a handle without taking a reference to the object, for callers that don't keep it
+     * past the call. The object stays alive as long as the handle isn't closed.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid.
+     */
+    Object* GetGenericRaw(Handle handle) const;
+
+    /**
+     * Looks up a handle without taking a reference to the object, while verifying its type.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid or its
+     *         type differs from the requested one.
+     */
+    template <class T>
+    T* GetRaw(Handle handle) const {
+        Object* const object = GetGenericRaw(handle);
+        if (object != nullptr && object->GetHandleType() == T::HANDLE_TYPE) {
+            return static_cast<T*>(object);
+        }
+        return nullptr;
+    }
+
     /// Closes all handles held in this table.
     void Clear();
 
@@ -121,12 +146,49 @@ private:
 
     friend class boost::serialization::access;
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int file_version) {
-        ar& objects;
-        ar& generations;
-        ar& next_generation;
-        ar& next_free_slot;
+    void save(Archive& ar, const unsigned int) const {
+        // Most slots are empty, so only the objects are stored, each after its slot index
+        const u32 num_objects = static_cast<u32>(
+            std::count_if(objects.begin(), objects.end(), [](const auto& o) { return o; }));
+        ar << num_objects;
+        for (u32 slot = 0; slot < MAX_COUNT; ++slot) {
+            if (objects[slot]) {
+                ar << slot;
+                ar << objects[slot];
+            }
+        }
+        ar << generations;
+        ar << next_generation;
+        ar << next_free_slot;
+    }
+
+    template <class Archive>
+    void load(Archive& ar, const unsigned int file_version) {
+        if (file_version == 0) {
+            ar >> objects;
+        } else {
+            for (auto& object : objects) {
+                object.reset();
+            }
+            u32 num_objects;
+            ar >> num_objects;
+            for (u32 i = 0; i < num_objects; ++i) {
+                u32 slot;
+                ar >> slot;
+                if (slot >= MAX_COUNT) {
+                    throw std::runtime_error("Invalid handle table in savestate");
+                }
+                ar >> objects[slot];
+            }
+        }
+        ar >> generations;
+        ar >> next_generation;
+        ar >> next_free_slot;
     }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 };
 
 } // namespace Kernel
+
+BOOST_CLASS_VERSION(Kernel::HandleTable, 1)
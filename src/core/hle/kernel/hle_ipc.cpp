@@ -40,9 +40,9 @@ public:
         memory.ReadBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
                          cmd_buff.size() * sizeof(u32));
         context->WriteToOutgoingCommandBuffer(cmd_buff.data(), *process);
-        // Copy the translated command buffer back into the thread's command buffer area.
+        // Copy the translated reply back into the thread's command buffer area.
         memory.WriteBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                          cmd_buff.size() * sizeof(u32));
+                          IPC::CommandSize(cmd_buff[0]) * sizeof(u32));
     }
 
 private:
@@ -136,13 +136,6 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(
 
     std::copy_n(src_cmdbuf, untranslated_size, cmd_buf.begin());
 
-    const bool should_record = kernel.GetIPCRecorder().IsEnabled();
-
-    std::vector<u32> untranslated_cmdbuf;
-    if (should_record) {
-        untranslated_cmdbuf = std::vector<u32>{src_cmdbuf, src_cmdbuf + command_size};
-    }
-
     std::size_t i = untranslated_size;
     while (i < command_size) {
         u32 descriptor = cmd_buf[i] = src_cmdbuf[i];
@@ -196,10 +189,9 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(
         }
     }
 
-    if (should_record) {
-        std::vector<u32> translated_cmdbuf{cmd_buf.begin(), cmd_buf.begin() + command_size};
-        kernel.GetIPCRecorder().SetRequestInfo(thread, std::move(untranslated_cmdbuf),
-                                               std::move(translated_cmdbuf));
+    // The source buffer is left untouched by the translation
+    if (kernel.GetIPCRecorder().IsEnabled()) {
+        kernel.GetIPCRecorder().SetRequestInfo(thread, src_cmdbuf, cmd_buf.data(), command_size);
     }
 
     return RESULT_SUCCESS;
@@ -215,13 +207,6 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
 
     std::copy_n(cmd_buf.begin(), untranslated_size, dst_cmdbuf);
 
-    const bool should_record = kernel.GetIPCRecorder().IsEnabled();
-
-    std::vector<u32> untranslated_cmdbuf;
-    if (should_record) {
-        untranslated_cmdbuf = std::vector<u32>{cmd_buf.begin(), cmd_buf.begin() + command_size};
-    }
-
     std::size_t i = untranslated_size;
     while (i < command_size) {
         u32 descriptor = dst_cmdbuf[i] = cmd_buf[i];
@@ -274,10 +259,8 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
         }
     }
 
-    if (should_record) {
-        std::vector<u32> translated_cmdbuf{dst_cmdbuf, dst_cmdbuf + command_size};
-        kernel.GetIPCRecorder().SetReplyInfo(thread, std::move(untranslated_cmdbuf),
-                                             std::move(translated_cmdbuf));
+    if (kernel.GetIPCRecorder().IsEnabled()) {
+        kernel.GetIPCRecorder().SetReplyInfo(thread, cmd_buf.data(), dst_cmdbuf, command_size);
     }
 
     return RESULT_SUCCESS;
@@ -316,6 +299,11 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     memory->WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+u8* MappedBuffer::GetContiguousPointer(std::size_t offset, std::size_t size) {
+    ASSERT(offset + size <= this->size);
+    return memory->GetContiguousPointer(*process, address + static_cast<VAddr>(offset), size);
+}
+
 } // namespace Kernel
 
 SERIALIZE_EXPORT_IMPL(Kernel::HLERequestContext::ThreadCallback)
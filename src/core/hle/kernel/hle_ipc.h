@@ -132,6 +132,11 @@ public:
     // interface for service
     void Read(void* dest_buffer, std::size_t offset, std::size_t size);
     void Write(const void* src_buffer, std::size_t offset, std::size_t size);
+    /**
+     * Returns a host pointer to a part of the buffer, or nullptr if it is not contiguous in host
+     * memory. Data can then be accessed in place instead of through Read and Write.
+     */
+    u8* GetContiguousPointer(std::size_t offset, std::size_t size);
     std::size_t GetSize() const {
         return size;
     }
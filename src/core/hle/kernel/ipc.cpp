@@ -43,9 +43,9 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
 
     const bool should_record = kernel.GetIPCRecorder().IsEnabled();
 
-    std::vector<u32> untranslated_cmdbuf;
+    std::array<u32, IPC::COMMAND_BUFFER_LENGTH> untranslated_cmdbuf;
     if (should_record) {
-        untranslated_cmdbuf = std::vector<u32>{cmd_buf.begin(), cmd_buf.begin() + command_size};
+        std::copy_n(cmd_buf.begin(), command_size, untranslated_cmdbuf.begin());
     }
 
     std::size_t i = untranslated_size;
@@ -231,13 +231,12 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
     }
 
     if (should_record) {
-        std::vector<u32> translated_cmdbuf{cmd_buf.begin(), cmd_buf.begin() + command_size};
         if (reply) {
-            kernel.GetIPCRecorder().SetReplyInfo(dst_thread, std::move(untranslated_cmdbuf),
-                                                 std::move(translated_cmdbuf));
+            kernel.GetIPCRecorder().SetReplyInfo(dst_thread, untranslated_cmdbuf.data(),
+                                                 cmd_buf.data(), command_size);
         } else {
-            kernel.GetIPCRecorder().SetRequestInfo(src_thread, std::move(untranslated_cmdbuf),
-                                                   std::move(translated_cmdbuf), dst_thread);
+            kernel.GetIPCRecorder().SetRequestInfo(src_thread, untranslated_cmdbuf.data(),
+                                                   cmd_buf.data(), command_size, dst_thread);
         }
     }
 
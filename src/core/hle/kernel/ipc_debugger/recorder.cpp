@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/core.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/ipc_debugger/recorder.h"
@@ -13,6 +15,8 @@
 #include "core/hle/kernel/session.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/service/service.h"
+#include "core/hle/service/sm/sm.h"
+#include "core/settings.h"
 
 namespace IPCDebugger {
 
@@ -37,21 +41,65 @@ ObjectInfo GetObjectInfo(const Kernel::Process* process) {
     }
     return {process->GetTypeName(), process->GetName(), static_cast<int>(process->process_id)};
 }
+
+const char* GetStatusName(RequestStatus status) {
+    switch (status) {
+    case RequestStatus::Sent:
+        return "Sent";
+    case RequestStatus::Handling:
+        return "Handling";
+    case RequestStatus::Handled:
+        return "Handled";
+    case RequestStatus::HLEUnimplemented:
+        return "HLE Unimplemented";
+    default:
+        return "Invalid";
+    }
+}
 } // namespace
 
-Recorder::Recorder() = default;
+Recorder::Recorder() {
+    SetSampleRate(Settings::values.ipc_recorder_sample_rate);
+}
+
 Recorder::~Recorder() = default;
 
 bool Recorder::IsEnabled() const {
-    return enabled.load(std::memory_order_relaxed);
+    return enabled.load(std::memory_order_relaxed) || sampling.load(std::memory_order_relaxed);
 }
 
 void Recorder::RegisterRequest(const std::shared_ptr<Kernel::ClientSession>& client_session,
                                const std::shared_ptr<Kernel::Thread>& client_thread) {
+    const bool decode = has_callbacks.load(std::memory_order_relaxed);
+    if (!decode && (sample_rate == 0 || ++sample_counter < sample_rate)) {
+        return;
+    }
+    sample_counter = 0;
+
     const u32 thread_id = client_thread->GetThreadId();
 
     if (auto owner_process = client_thread->owner_process.lock()) {
-        RequestRecord record = {/* id */ ++record_count,
+        auto& request = pending_requests[thread_id];
+        request.active = true;
+
+        RingEntry& entry = request.entry;
+        entry = {};
+        entry.id = ++record_count;
+        entry.status = RequestStatus::Sent;
+        entry.client_process = static_cast<int>(owner_process->process_id);
+        entry.client_thread = static_cast<int>(thread_id);
+        entry.client_session = static_cast<int>(client_session->GetObjectId());
+        if (client_session->parent->port) {
+            entry.client_port = static_cast<int>(client_session->parent->port->GetObjectId());
+        }
+
+        if (!decode) {
+            request.record.reset();
+            request.client_session.reset();
+            return;
+        }
+
+        RequestRecord record = {/* id */ entry.id,
                                 /* status */ RequestStatus::Sent,
                                 /* client_process */ GetObjectInfo(owner_process.get()),
                                 /* client_thread */ GetObjectInfo(client_thread.get()),
@@ -60,28 +108,40 @@ void Recorder::RegisterRequest(const std::shared_ptr<Kernel::ClientSession>& cli
                                 /* server_process */ {},
                                 /* server_thread */ {},
                                 /* server_session */ GetObjectInfo(client_session->parent->server)};
-        record_map.insert_or_assign(thread_id, std::make_unique<RequestRecord>(record));
-        client_session_map.insert_or_assign(thread_id, client_session);
+        request.record = std::make_unique<RequestRecord>(std::move(record));
+        request.client_session = client_session;
 
-        InvokeCallbacks(record);
+        InvokeCallbacks(*request.record);
     }
 }
 
 void Recorder::SetRequestInfo(const std::shared_ptr<Kernel::Thread>& client_thread,
-                              std::vector<u32> untranslated_cmdbuf,
-                              std::vector<u32> translated_cmdbuf,
+                              const u32* untranslated_cmdbuf, const u32* translated_cmdbuf,
+                              std::size_t size,
                               const std::shared_ptr<Kernel::Thread>& server_thread) {
-    const u32 thread_id = client_thread->GetThreadId();
-    if (!record_map.count(thread_id)) {
-        // This is possible when the recorder is enabled after application started
-        LOG_ERROR(Kernel, "No request is assoicated with the thread");
+    // Requests that were not sampled, or were sent before the recorder was enabled, are skipped
+    PendingRequest* request = GetPendingRequest(client_thread);
+    if (!request) {
+        return;
+    }
+
+    RingEntry& entry = request->entry;
+    entry.status = RequestStatus::Handling;
+    entry.is_hle = !server_thread;
+    if (server_thread) {
+        entry.server_thread = static_cast<int>(server_thread->GetThreadId());
+    }
+    entry.request_size = static_cast<u32>(size);
+    std::copy_n(untranslated_cmdbuf, std::min(size, RingEntry::MAX_WORDS), entry.request.begin());
+
+    if (!request->record) {
         return;
     }
 
-    auto& record = *record_map[thread_id];
+    auto& record = *request->record;
     record.status = RequestStatus::Handling;
-    record.untranslated_request_cmdbuf = std::move(untranslated_cmdbuf);
-    record.translated_request_cmdbuf = std::move(translated_cmdbuf);
+    record.untranslated_request_cmdbuf.assign(untranslated_cmdbuf, untranslated_cmdbuf + size);
+    record.translated_request_cmdbuf.assign(translated_cmdbuf, translated_cmdbuf + size);
 
     if (server_thread) {
         if (auto owner_process = server_thread->owner_process.lock()) {
@@ -93,8 +153,8 @@ void Recorder::SetRequestInfo(const std::shared_ptr<Kernel::Thread>& client_thre
     }
 
     // Function name
-    ASSERT_MSG(client_session_map.count(thread_id), "Client session is missing");
-    const auto& client_session = client_session_map[thread_id];
+    ASSERT_MSG(request->client_session, "Client session is missing");
+    const auto& client_session = request->client_session;
     if (client_session->parent->port &&
         client_session->parent->port->GetServerPort()->hle_handler) {
 
@@ -102,55 +162,113 @@ void Recorder::SetRequestInfo(const std::shared_ptr<Kernel::Thread>& client_thre
                                    client_session->parent->port->GetServerPort()->hle_handler)
                                    ->GetFunctionName(record.untranslated_request_cmdbuf[0]);
     }
-    client_session_map.erase(thread_id);
+    request->client_session.reset();
 
     InvokeCallbacks(record);
 }
 
 void Recorder::SetReplyInfo(const std::shared_ptr<Kernel::Thread>& client_thread,
-                            std::vector<u32> untranslated_cmdbuf,
-                            std::vector<u32> translated_cmdbuf) {
-    const u32 thread_id = client_thread->GetThreadId();
-    if (!record_map.count(thread_id)) {
-        // This is possible when the recorder is enabled after application started
-        LOG_ERROR(Kernel, "No request is assoicated with the thread");
+                            const u32* untranslated_cmdbuf, const u32* translated_cmdbuf,
+                            std::size_t size) {
+    PendingRequest* request = GetPendingRequest(client_thread);
+    if (!request) {
         return;
     }
+    request->active = false;
 
-    auto& record = *record_map[thread_id];
-    if (record.status != RequestStatus::HLEUnimplemented) {
-        record.status = RequestStatus::Handled;
+    RingEntry& entry = request->entry;
+    if (entry.status != RequestStatus::HLEUnimplemented) {
+        entry.status = RequestStatus::Handled;
     }
+    entry.reply_size = static_cast<u32>(size);
+    std::copy_n(translated_cmdbuf, std::min(size, RingEntry::MAX_WORDS), entry.reply.begin());
+    ring[ring_next++ % RING_SIZE] = entry;
 
-    record.untranslated_reply_cmdbuf = std::move(untranslated_cmdbuf);
-    record.translated_reply_cmdbuf = std::move(translated_cmdbuf);
+    if (!request->record) {
+        return;
+    }
+
+    auto& record = *request->record;
+    record.status = entry.status;
+    record.untranslated_reply_cmdbuf.assign(untranslated_cmdbuf, untranslated_cmdbuf + size);
+    record.translated_reply_cmdbuf.assign(translated_cmdbuf, translated_cmdbuf + size);
     InvokeCallbacks(record);
 
-    record_map.erase(thread_id);
+    request->record.reset();
 }
 
 void Recorder::SetHLEUnimplemented(const std::shared_ptr<Kernel::Thread>& client_thread) {
-    const u32 thread_id = client_thread->GetThreadId();
-    if (!record_map.count(thread_id)) {
-        // This is possible when the recorder is enabled after application started
-        LOG_ERROR(Kernel, "No request is assoicated with the thread");
+    PendingRequest* request = GetPendingRequest(client_thread);
+    if (!request) {
         return;
     }
 
-    auto& record = *record_map[thread_id];
-    record.status = RequestStatus::HLEUnimplemented;
+    request->entry.status = RequestStatus::HLEUnimplemented;
+    if (request->record) {
+        request->record->status = RequestStatus::HLEUnimplemented;
+    }
+}
+
+std::vector<RingEntry> Recorder::GetRecentRequests() const {
+    const std::size_t count = std::min(ring_next, RING_SIZE);
+    std::vector<RingEntry> entries;
+    entries.reserve(count);
+    for (std::size_t i = ring_next - count; i < ring_next; ++i) {
+        entries.push_back(ring[i % RING_SIZE]);
+    }
+    return entries;
+}
+
+void Recorder::LogRecentRequests() const {
+    const auto log_entry = [](const RingEntry& entry) {
+        std::string service;
+        if (entry.client_port != -1 && Core::System::GetInstance().IsPoweredOn()) {
+            service = Core::System::GetInstance().ServiceManager().GetServiceNameByPortId(
+                static_cast<u32>(entry.client_port));
+        }
+        const u32 result = entry.reply_size > 1 ? entry.reply[1] : 0;
+        LOG_ERROR(Kernel,
+                  "IPC request {}: {} service={} ({}) header={:#010x} result={:#010x} "
+                  "process={} thread={} session={} server_thread={}",
+                  entry.id, GetStatusName(entry.status), service.empty() ? "?" : service,
+                  entry.is_hle ? "HLE" : "LLE", entry.request_size > 0 ? entry.request[0] : 0,
+                  result, entry.client_process, entry.client_thread, entry.client_session,
+                  entry.server_thread);
+    };
+
+    const auto entries = GetRecentRequests();
+    LOG_ERROR(Kernel, "Last {} recorded IPC requests:", entries.size());
+    for (const auto& entry : entries) {
+        log_entry(entry);
+    }
+    for (const auto& [thread_id, request] : pending_requests) {
+        if (request.active) {
+            log_entry(request.entry);
+        }
+    }
 }
 
 CallbackHandle Recorder::BindCallback(CallbackType callback) {
     std::unique_lock lock(callback_mutex);
     CallbackHandle handle = std::make_shared<CallbackType>(callback);
     callbacks.emplace(handle);
+    has_callbacks.store(true, std::memory_order_relaxed);
     return handle;
 }
 
 void Recorder::UnbindCallback(const CallbackHandle& handle) {
     std::unique_lock lock(callback_mutex);
     callbacks.erase(handle);
+    has_callbacks.store(!callbacks.empty(), std::memory_order_relaxed);
+}
+
+Recorder::PendingRequest* Recorder::GetPendingRequest(
+    const std::shared_ptr<Kernel::Thread>& client_thread) {
+    const auto iter = pending_requests.find(client_thread->GetThreadId());
+    if (iter == pending_requests.end() || !iter->second.active) {
+        return nullptr;
+    }
+    return &iter->second;
 }
 
 void Recorder::InvokeCallbacks(const RequestRecord& request) {
@@ -166,4 +284,10 @@ void Recorder::SetEnabled(bool enabled_) {
     enabled.store(enabled_, std::memory_order_relaxed);
 }
 
+void Recorder::SetSampleRate(u32 rate) {
+    sample_rate = rate;
+    sample_counter = 0;
+    sampling.store(rate != 0, std::memory_order_relaxed);
+}
+
 } // namespace IPCDebugger
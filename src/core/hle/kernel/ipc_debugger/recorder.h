@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <set>
@@ -64,16 +66,47 @@ struct RequestRecord {
     std::vector<u32> translated_reply_cmdbuf;
 };
 
+/**
+ * Compact record of an IPC request, as kept in the recorder's ring buffer. Objects are only
+ * referred to by id, and only the first command buffer words are kept, so recording stays cheap
+ * enough to leave on. Ids that are not available are -1.
+ */
+struct RingEntry {
+    /// Command buffer words kept for the request and the reply
+    static constexpr std::size_t MAX_WORDS = 8;
+
+    int id = 0;
+    RequestStatus status = RequestStatus::Invalid;
+    bool is_hle = false;
+    int client_process = -1;
+    int client_thread = -1;
+    int client_session = -1;
+    int client_port = -1;
+    int server_thread = -1;
+    u32 request_size = 0; ///< Size of the untranslated request, which may exceed MAX_WORDS
+    u32 reply_size = 0;   ///< Size of the translated reply, which may exceed MAX_WORDS
+    std::array<u32, MAX_WORDS> request{};
+    std::array<u32, MAX_WORDS> reply{};
+};
+
 using CallbackType = std::function<void(const RequestRecord&)>;
 using CallbackHandle = std::shared_ptr<CallbackType>;
 
+/**
+ * Records IPC requests. Finished requests are kept in a fixed-size ring buffer, either all of them
+ * or one in every few when sampling. The full RequestRecords, with their names and command
+ * buffers, are only built while callbacks are bound.
+ */
 class Recorder {
 public:
+    /// Number of finished requests kept in the ring buffer
+    static constexpr std::size_t RING_SIZE = 1024;
+
     explicit Recorder();
     ~Recorder();
 
     /**
-     * Returns whether the recorder is enabled.
+     * Returns whether the recorder is enabled, either by SetEnabled or by a sample rate.
      */
     bool IsEnabled() const;
 
@@ -85,18 +118,21 @@ public:
 
     /**
      * Sets the request information of the request record associated with the client thread.
-     * When the server thread is empty, the request will be considered HLE.
+     * When the server thread is empty, the request will be considered HLE. Both command buffers
+     * hold size words.
      */
     void SetRequestInfo(const std::shared_ptr<Kernel::Thread>& client_thread,
-                        std::vector<u32> untranslated_cmdbuf, std::vector<u32> translated_cmdbuf,
+                        const u32* untranslated_cmdbuf, const u32* translated_cmdbuf,
+                        std::size_t size,
                         const std::shared_ptr<Kernel::Thread>& server_thread = {});
 
     /**
      * Sets the reply information of the request record assoicated with the client thread.
-     * The request is then unlinked from the client thread.
+     * The request is then unlinked from the client thread and stored in the ring buffer.
      */
     void SetReplyInfo(const std::shared_ptr<Kernel::Thread>& client_thread,
-                      std::vector<u32> untranslated_cmdbuf, std::vector<u32> translated_cmdbuf);
+                      const u32* untranslated_cmdbuf, const u32* translated_cmdbuf,
+                      std::size_t size);
 
     /**
      * Set the status of a record to HLEUnimplemented.
@@ -108,21 +144,53 @@ public:
      */
     void SetEnabled(bool enabled);
 
+    /**
+     * Records one in every `rate` requests into the ring buffer even when the recorder is not
+     * enabled. 0 turns sampling off. Requests are always recorded while callbacks are bound.
+     */
+    void SetSampleRate(u32 rate);
+
+    /**
+     * Returns the finished requests in the ring buffer, oldest first.
+     */
+    std::vector<RingEntry> GetRecentRequests() const;
+
+    /**
+     * Logs the finished requests in the ring buffer and the requests that are still in flight.
+     */
+    void LogRecentRequests() const;
+
     CallbackHandle BindCallback(CallbackType callback);
     void UnbindCallback(const CallbackHandle& handle);
 
 private:
+    struct PendingRequest {
+        bool active = false;
+        RingEntry entry;
+        // Only set while callbacks are bound
+        std::unique_ptr<RequestRecord> record;
+        // Kept for function name handling while callbacks are bound
+        std::shared_ptr<Kernel::ClientSession> client_session;
+    };
+
+    /// Returns the request in flight on the client thread, or nullptr if it isn't recorded
+    PendingRequest* GetPendingRequest(const std::shared_ptr<Kernel::Thread>& client_thread);
     void InvokeCallbacks(const RequestRecord& request);
 
-    std::unordered_map<u32, std::unique_ptr<RequestRecord>> record_map;
+    // Entries are reused rather than erased, so a thread's requests don't allocate.
+    std::unordered_map<u32, PendingRequest> pending_requests;
     int record_count{};
 
-    // Temporary client session map for function name handling
-    std::unordered_map<u32, std::shared_ptr<Kernel::ClientSession>> client_session_map;
+    std::array<RingEntry, RING_SIZE> ring;
+    std::size_t ring_next{};
+    u32 sample_rate{};
+    u32 sample_counter{};
 
     std::atomic_bool enabled{false};
+    std::atomic_bool sampling{false};
 
     std::set<CallbackHandle> callbacks;
+    std::atomic_bool has_callbacks{false};
     mutable std::shared_mutex callback_mutex;
 };
 
@@ -3,15 +3,22 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
+#include <optional>
+#include <random>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/bitset.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_funcs.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/serialization/boost_vector.hpp"
+#include "common/virtual_buffer.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
@@ -19,6 +26,7 @@
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 SERIALIZE_EXPORT_IMPL(Kernel::Process)
 SERIALIZE_EXPORT_IMPL(Kernel::CodeSet)
@@ -161,14 +169,80 @@ void Process::Set3dsxKernelCaps() {
     kernel_version = 0x234;
 }
 
+/**
+ * Returns the path of a file in the cache directory holding the memory of the code set, named
+ * after its contents, and writes the file if no instance did yet.
+ */
+static std::optional<std::string> GetSharedCodePath(const CodeSet& codeset) {
+    const std::vector<u8>& memory = codeset.memory;
+    const std::string dir =
+        FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "shared_code" DIR_SEP;
+    const std::string path =
+        fmt::format("{}{:016X}_{:016X}.bin", dir, codeset.program_id,
+                    Common::ComputeHash64(memory.data(), memory.size()));
+    if (FileUtil::Exists(path) && FileUtil::GetSize(path) == memory.size()) {
+        return path;
+    }
+    if (!FileUtil::CreateFullPath(dir)) {
+        return std::nullopt;
+    }
+
+    // Written under a temporary name first, so that other instances never map a partial file
+    const std::string temp_path = fmt::format("{}.{:08X}", path, std::random_device{}());
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file.IsOpen() || file.WriteBytes(memory.data(), memory.size()) != memory.size()) {
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return std::nullopt;
+        }
+    }
+    if (!FileUtil::Rename(temp_path, path)) {
+        FileUtil::Delete(temp_path);
+        // Another instance may have renamed its copy into place first
+        if (!FileUtil::Exists(path)) {
+            return std::nullopt;
+        }
+    }
+    return path;
+}
+
 void Process::Run(s32 main_thread_priority, u32 stack_size) {
     memory_region = kernel.GetMemoryRegion(flags.memory_region);
 
+    std::optional<std::string> shared_code_path;
+    if (Settings::values.share_code_pages) {
+        shared_code_path = GetSharedCodePath(*codeset);
+        if (!shared_code_path) {
+            LOG_WARNING(Kernel, "Could not write the shared code of {}, copying it instead",
+                        codeset->name);
+        }
+    }
+
     auto MapSegment = [&](CodeSet::Segment& segment, VMAPermission permissions,
                           MemoryState memory_state) {
         HeapAllocate(segment.addr, segment.size, permissions, memory_state, true);
-        kernel.memory.WriteBlock(*this, segment.addr, codeset->memory.data() + segment.offset,
-                                 segment.size);
+        if (!shared_code_path || permissions == VMAPermission::ReadWrite) {
+            kernel.memory.WriteBlock(*this, segment.addr,
+                                     codeset->memory.data() + segment.offset, segment.size);
+            return;
+        }
+
+        // Read-only segments are mapped from the shared file block by block. A private mapping
+        // is copied on write, so applications that modify their code still get their own pages.
+        VAddr addr = segment.addr;
+        const VAddr end = segment.addr + segment.size;
+        while (addr < end) {
+            const auto& vma = vm_manager.FindVMA(addr)->second;
+            const u32 size = std::min(end, vma.base + vma.size) - addr;
+            MemoryRef backing_memory = vma.backing_memory;
+            u8* host_ptr = backing_memory.GetPtr() + (addr - vma.base);
+            const std::size_t file_offset = segment.offset + (addr - segment.addr);
+            if (!Common::MapFilePages(host_ptr, size, *shared_code_path, file_offset)) {
+                std::memcpy(host_ptr, codeset->memory.data() + file_offset, size);
+            }
+            addr += size;
+        }
     };
 
     // Map CodeSet segments
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cinttypes>
 #include <map>
 #include <fmt/format.h>
@@ -13,6 +14,7 @@
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/frame_counters.h"
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
@@ -111,10 +113,42 @@ private:
 
     friend class SVCWrapper<SVC>;
 
+    /// Number of polls in a row after which a thread is considered to be busy-waiting
+    static constexpr u32 BUSY_WAIT_POLL_COUNT = 16;
+    /// Polls further apart than this many ticks are not part of a tight loop
+    static constexpr u64 BUSY_WAIT_MAX_TICKS = 1000;
+
+    /// Tracks consecutive polls of the kernel made by the same thread from the same place
+    struct BusyWaitState {
+        const Thread* thread = nullptr;
+        u32 pc = 0;
+        u64 ticks = 0;
+        u32 count = 0;
+    } busy_wait;
+
+    /// Set by NotePoll during the current SVC
+    bool polled = false;
+
+    /**
+     * Records that the current SVC returned without changing any state, as when a thread reads the
+     * system tick or yields with nothing else to run. When the same call keeps coming back in a
+     * tight loop, the thread can only be waiting for an event or another core, so the rest of the
+     * time slice is skipped.
+     */
+    void NotePoll();
+
     // ARM interfaces
 
-    u32 GetReg(std::size_t n);
-    void SetReg(std::size_t n, u32 value);
+    /// Register file of the core running the current SVC, which the wrappers read directly
+    u32* regs = nullptr;
+
+    u32 GetReg(std::size_t n) {
+        return regs[n];
+    }
+
+    void SetReg(std::size_t n, u32 value) {
+        regs[n] = value;
+    }
 
     // SVC interfaces
 
@@ -183,7 +217,7 @@ private:
         const char* name;
     };
 
-    static const std::array<FunctionDef, 126> SVC_Table;
+    static const std::array<FunctionDef, NumSVCs> SVC_Table;
     static const FunctionDef* GetSVCInfo(u32 func_num);
 };
 
@@ -388,6 +422,7 @@ ResultCode SVC::SendSyncRequest(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}({})", handle, session->GetName());
 
     system.PrepareReschedule();
+    system.NotifyServiceRequest();
 
     auto thread = SharedFrom(kernel.GetCurrentThreadManager().GetCurrentThread());
 
@@ -786,8 +821,8 @@ ResultCode SVC::ArbitrateAddress(Handle handle, u32 address, u32 type, u32 value
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}, address=0x{:08X}, type=0x{:08X}, value=0x{:08X}",
               handle, address, type, value);
 
-    std::shared_ptr<AddressArbiter> arbiter =
-        kernel.GetCurrentProcess()->handle_table.Get<AddressArbiter>(handle);
+    AddressArbiter* arbiter =
+        kernel.GetCurrentProcess()->handle_table.GetRaw<AddressArbiter>(handle);
     if (arbiter == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -795,6 +830,12 @@ ResultCode SVC::ArbitrateAddress(Handle handle, u32 address, u32 type, u32 value
         arbiter->ArbitrateAddress(SharedFrom(kernel.GetCurrentThreadManager().GetCurrentThread()),
                                   static_cast<ArbitrationType>(type), address, value, nanoseconds);
 
+    // A wait that returned right away leaves the thread spinning on the arbiter
+    if (static_cast<ArbitrationType>(type) != ArbitrationType::Signal &&
+        kernel.GetCurrentThreadManager().GetCurrentThread()->status == ThreadStatus::Running) {
+        NotePoll();
+    }
+
     // TODO(Subv): Identify in which specific cases this call should cause a reschedule.
     system.PrepareReschedule();
 
@@ -819,6 +860,9 @@ void SVC::Break(u8 break_reason) {
         break;
     }
     LOG_CRITICAL(Debug_Emulated, "Break reason: {}", reason_str);
+    if (kernel.GetIPCRecorder().IsEnabled()) {
+        kernel.GetIPCRecorder().LogRecentRequests();
+    }
 }
 
 /// Used to output a message on a debug hardware unit - does nothing on a retail unit
@@ -1012,7 +1056,7 @@ ResultCode SVC::CreateMutex(Handle* out_handle, u32 initial_locked) {
 ResultCode SVC::ReleaseMutex(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}", handle);
 
-    std::shared_ptr<Mutex> mutex = kernel.GetCurrentProcess()->handle_table.Get<Mutex>(handle);
+    Mutex* mutex = kernel.GetCurrentProcess()->handle_table.GetRaw<Mutex>(handle);
     if (mutex == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1078,8 +1122,7 @@ ResultCode SVC::CreateSemaphore(Handle* out_handle, s32 initial_count, s32 max_c
 ResultCode SVC::ReleaseSemaphore(s32* count, Handle handle, s32 release_count) {
     LOG_TRACE(Kernel_SVC, "called release_count={}, handle=0x{:08X}", release_count, handle);
 
-    std::shared_ptr<Semaphore> semaphore =
-        kernel.GetCurrentProcess()->handle_table.Get<Semaphore>(handle);
+    Semaphore* semaphore = kernel.GetCurrentProcess()->handle_table.GetRaw<Semaphore>(handle);
     if (semaphore == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1156,7 +1199,7 @@ ResultCode SVC::DuplicateHandle(Handle* out, Handle handle) {
 ResultCode SVC::SignalEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcess()->handle_table.GetRaw<Event>(handle);
     if (evt == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1169,7 +1212,7 @@ ResultCode SVC::SignalEvent(Handle handle) {
 ResultCode SVC::ClearEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcess()->handle_table.GetRaw<Event>(handle);
     if (evt == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1193,7 +1236,7 @@ ResultCode SVC::CreateTimer(Handle* out_handle, u32 reset_type) {
 ResultCode SVC::ClearTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.GetRaw<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1209,7 +1252,7 @@ ResultCode SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
         return ERR_OUT_OF_RANGE_KERNEL;
     }
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.GetRaw<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1222,7 +1265,7 @@ ResultCode SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
 ResultCode SVC::CancelTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.GetRaw<Timer>(handle);
     if (timer == nullptr)
         return ERR_INVALID_HANDLE;
 
@@ -1239,8 +1282,10 @@ void SVC::SleepThread(s64 nanoseconds) {
 
     // Don't attempt to yield execution if there are no available threads to run,
     // this way we avoid a useless reschedule to the idle thread.
-    if (nanoseconds == 0 && !thread_manager.HaveReadyThreads())
+    if (nanoseconds == 0 && !thread_manager.HaveReadyThreads()) {
+        NotePoll();
         return;
+    }
 
     // Sleep current thread and check for next thread to schedule
     thread_manager.WaitCurrentThread_Sleep();
@@ -1258,6 +1303,7 @@ s64 SVC::GetSystemTick() {
     // Advance time to defeat dumb games (like Cubic Ninja) that busy-wait for the frame to end.
     // Measured time between two calls on a 9.2 o3DS with Ninjhax 1.1b
     system.GetRunningCore().GetTimer().AddTicks(150);
+    NotePoll();
     return result;
 }
 
@@ -1458,7 +1504,7 @@ ResultCode SVC::GetProcessInfo(s64* out, Handle process_handle, u32 type) {
     return RESULT_SUCCESS;
 }
 
-const std::array<SVC::FunctionDef, 126> SVC::SVC_Table{{
+const std::array<SVC::FunctionDef, NumSVCs> SVC::SVC_Table{{
     {0x00, nullptr, "Unknown"},
     {0x01, &SVC::Wrap<&SVC::ControlMemory>, "ControlMemory"},
     {0x02, &SVC::Wrap<&SVC::QueryMemory>, "QueryMemory"},
@@ -1597,8 +1643,22 @@ const SVC::FunctionDef* SVC::GetSVCInfo(u32 func_num) {
 
 MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
 
+namespace {
+/// Only written under the HLE lock, so the increments don't need to be atomic read-modify-writes
+std::array<std::atomic<u64>, NumSVCs> svc_call_counts{};
+} // Anonymous namespace
+
+SVCCallCounts GetSVCCallCounts() {
+    SVCCallCounts counts;
+    for (std::size_t i = 0; i < NumSVCs; i++) {
+        counts[i] = svc_call_counts[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
 void SVC::CallSVC(u32 immediate) {
     MICROPROFILE_SCOPE(Kernel_SVC);
+    Core::CountFrameEvent(Core::FrameCounter::SVCs);
 
     // Lock the global kernel mutex when we enter the kernel HLE.
     std::lock_guard lock{HLE::g_hle_lock};
@@ -1608,24 +1668,49 @@ void SVC::CallSVC(u32 immediate) {
 
     const FunctionDef* info = GetSVCInfo(immediate);
     LOG_TRACE(Kernel_SVC, "calling {}", info->name);
+    polled = false;
     if (info) {
+        auto& count = svc_call_counts[immediate];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        regs = system.GetRunningCore().GetRegisterFile();
         if (info->func) {
             (this->*(info->func))();
         } else {
             LOG_ERROR(Kernel_SVC, "unimplemented SVC function {}(..)", info->name);
         }
     }
+
+    // Any other call may have changed what the thread is waiting for
+    if (!polled) {
+        busy_wait.count = 0;
+    }
 }
 
-SVC::SVC(Core::System& system) : system(system), kernel(system.Kernel()), memory(system.Memory()) {}
+void SVC::NotePoll() {
+    polled = true;
+
+    ARM_Interface& cpu = system.GetRunningCore();
+    const Thread* thread = kernel.GetCurrentThreadManager().GetCurrentThread();
+    const u32 pc = cpu.GetPC();
+    const u64 ticks = cpu.GetTimer().GetTicks();
+    const bool same_loop = thread == busy_wait.thread && pc == busy_wait.pc &&
+                           busy_wait.count > 0 && ticks - busy_wait.ticks <= BUSY_WAIT_MAX_TICKS;
+    busy_wait.thread = thread;
+    busy_wait.pc = pc;
+    busy_wait.ticks = ticks;
+    busy_wait.count = same_loop ? busy_wait.count + 1 : 1;
+
+    if (busy_wait.count < BUSY_WAIT_POLL_COUNT) {
+        return;
+    }
 
-u32 SVC::GetReg(std::size_t n) {
-    return system.GetRunningCore().GetReg(static_cast<int>(n));
+    LOG_TRACE(Kernel_SVC, "thread busy-waiting at 0x{:08X}, skipping to the next event", pc);
+    busy_wait.count = 0;
+    cpu.GetTimer().Idle();
+    system.PrepareReschedule();
 }
 
-void SVC::SetReg(std::size_t n, u32 value) {
-    system.GetRunningCore().SetReg(static_cast<int>(n), value);
-}
+SVC::SVC(Core::System& system) : system(system), kernel(system.Kernel()), memory(system.Memory()) {}
 
 SVCContext::SVCContext(Core::System& system) : impl(std::make_unique<SVC>(system)) {}
 SVCContext::~SVCContext() = default;
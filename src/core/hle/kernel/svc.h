@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <boost/serialization/export.hpp>
 #include "common/common_types.h"
@@ -16,6 +18,14 @@ namespace Kernel {
 
 class SVC;
 
+/// Number of SVC numbers in the dispatch table, 0x00-0x7D
+constexpr std::size_t NumSVCs = 0x7E;
+
+using SVCCallCounts = std::array<u64, NumSVCs>;
+
+/// Returns how many times the guest has called each SVC since the emulator started
+SVCCallCounts GetSVCCallCounts();
+
 class SVCContext {
 public:
     SVCContext(Core::System& system);
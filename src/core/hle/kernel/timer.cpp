@@ -7,6 +7,7 @@
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/slab_allocator.h"
 #include "core/core.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/object.h"
@@ -25,7 +26,7 @@ Timer::~Timer() {
 }
 
 std::shared_ptr<Timer> KernelSystem::CreateTimer(ResetType reset_type, std::string name) {
-    auto timer{std::make_shared<Timer>(*this)};
+    auto timer{Common::MakeSlabShared<Timer>(*this)};
 
     timer->reset_type = reset_type;
     timer->signaled = false;
@@ -48,6 +48,7 @@ void VMManager::Reset() {
     ASSERT(!is_locked);
 
     vma_map.clear();
+    last_found_vma = vma_map.end();
 
     // Initialize the map with a single free region covering the entire managed space.
     VirtualMemoryArea initial_vma;
@@ -62,9 +63,18 @@ void VMManager::Reset() {
 VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
     if (target >= MAX_ADDRESS) {
         return vma_map.end();
-    } else {
-        return std::prev(vma_map.upper_bound(target));
     }
+
+    // Lookups mostly hit the area found last, as callers walk ranges block by block and services
+    // query the same buffers over and over
+    if (last_found_vma != vma_map.end()) {
+        const VirtualMemoryArea& vma = last_found_vma->second;
+        if (target >= vma.base && target - vma.base < vma.size) {
+            return last_found_vma;
+        }
+    }
+    last_found_vma = std::prev(vma_map.upper_bound(target));
+    return last_found_vma;
 }
 
 ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size, MemoryRef memory,
@@ -356,6 +366,9 @@ VMManager::VMAIter VMManager::MergeAdjacent(VMAIter iter) {
     const VMAIter next_vma = std::next(iter);
     if (next_vma != vma_map.end() && iter->second.CanBeMergedWith(next_vma->second)) {
         iter->second.size += next_vma->second.size;
+        if (last_found_vma == next_vma) {
+            last_found_vma = vma_map.end();
+        }
         vma_map.erase(next_vma);
     }
 
@@ -363,6 +376,9 @@ VMManager::VMAIter VMManager::MergeAdjacent(VMAIter iter) {
         VMAIter prev_vma = std::prev(iter);
         if (prev_vma->second.CanBeMergedWith(iter->second)) {
             prev_vma->second.size += iter->second.size;
+            if (last_found_vma == iter) {
+                last_found_vma = vma_map.end();
+            }
             vma_map.erase(iter);
             iter = prev_vma;
         }
@@ -259,12 +259,16 @@ private:
     // assert. VMManager locks itself after deserialization.
     bool is_locked{};
 
+    /// VMA returned by the last FindVMA, or `vma_map.end()`. Reset when that VMA is erased.
+    mutable VMAHandle last_found_vma;
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
         ar& vma_map;
         ar& page_table;
         if (Archive::is_loading::value) {
             is_locked = true;
+            last_found_vma = vma_map.end();
         }
     }
     friend class boost::serialization::access;
@@ -8,6 +8,7 @@
 #include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
 #include "common/common_paths.h"
 #include "common/file_util.h"
@@ -81,6 +82,16 @@ static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong")
 class CIAFile::DecryptionState {
 public:
     std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+
+    /// Content file being written, kept open across writes, and its index
+    FileUtil::IOFile file;
+    std::size_t file_index = 0;
+    /// Scratch buffer in which content data is decrypted
+    std::vector<u8> buffer;
+
+    /// SHA-256 of the decrypted contents, checked against the TMD once they are all written
+    std::vector<CryptoPP::SHA256> hash;
+    bool hash_checked = false;
 };
 
 CIAFile::CIAFile(Service::FS::MediaType media_type)
@@ -133,6 +144,7 @@ ResultCode CIAFile::WriteTitleMetadata() {
 
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
+    decryption_state->hash.resize(content_count);
 
     if (auto title_key = container.GetTicket().GetTitleKey()) {
         decryption_state->content.resize(content_count);
@@ -171,22 +183,29 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // Since the incoming TMD has already been written, we can use GetTitleContentPath
             // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            FileUtil::IOFile file(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
-                                  content_written[i] ? "ab" : "wb");
+            const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
+            auto& file = decryption_state->file;
+            if (!file.IsOpen() || decryption_state->file_index != i) {
+                file = FileUtil::IOFile(
+                    GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
+                    content_written[i] ? "ab" : "wb");
+                decryption_state->file_index = i;
+            }
 
             if (!file.IsOpen()) {
                 return FileSys::ERROR_INSUFFICIENT_SPACE;
             }
 
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-
+            const u8* content_data = buffer + (range_min - offset);
             if ((tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) != 0) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+                auto& temp = decryption_state->buffer;
+                temp.resize(available_to_write);
+                decryption_state->content[i].ProcessData(temp.data(), content_data, temp.size());
+                content_data = temp.data();
             }
 
-            file.WriteBytes(temp.data(), temp.size());
+            file.WriteBytes(content_data, available_to_write);
+            decryption_state->hash[i].Update(content_data, available_to_write);
 
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
@@ -279,6 +298,8 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
+    decryption_state->file.Close();
+
     bool complete = true;
     for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
@@ -292,6 +313,19 @@ bool CIAFile::Close() const {
         return true;
     }
 
+    if (!decryption_state->hash_checked) {
+        decryption_state->hash_checked = true;
+        const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
+        for (std::size_t i = 0; i < tmd.GetContentCount(); i++) {
+            std::array<u8, CryptoPP::SHA256::DIGESTSIZE> hash;
+            decryption_state->hash[i].Final(hash.data());
+            if (hash != tmd.GetContentHashByIndex(i)) {
+                LOG_ERROR(Service_AM, "Content {} of title {:016X} does not match its hash", i,
+                          tmd.GetTitleID());
+            }
+        }
+    }
+
     // Clean up older content data if we installed newer content on top
     std::string old_tmd_path =
         GetTitleMetadataPath(media_type, container.GetTitleMetadata().GetTitleID(), false);
@@ -357,7 +391,7 @@ InstallStatus InstallCIA(const std::string& path,
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
 
-        std::array<u8, 0x10000> buffer;
+        std::vector<u8> buffer(0x100000);
         std::size_t total_bytes_read = 0;
         while (total_bytes_read != file.GetSize()) {
             std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
@@ -544,8 +578,23 @@ std::string GetMediaTitlePath(Service::FS::MediaType media_type) {
     return "";
 }
 
-void Module::ScanForTitles(Service::FS::MediaType media_type) {
+/// Identifies the title index file and the version of its layout
+constexpr u32 TITLE_INDEX_MAGIC = 0x58444954;
+constexpr u32 TITLE_INDEX_VERSION = 1;
+
+static std::string GetTitleIndexPath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "am_title_index.bin";
+}
+
+/// Returns the size of a content, or 0 if it does not exist
+static u64 GetContentSize(const std::string& path) {
+    return FileUtil::Exists(path) ? FileUtil::GetSize(path) : 0;
+}
+
+bool Module::ScanForTitles(Service::FS::MediaType media_type,
+                           std::unordered_set<std::string>& found) {
     am_title_list[static_cast<u32>(media_type)].clear();
+    bool index_changed = false;
 
     std::string title_path = GetMediaTitlePath(media_type);
 
@@ -558,17 +607,126 @@ void Module::ScanForTitles(Service::FS::MediaType media_type) {
             if (tid_string.length() == TITLE_ID_VALID_LENGTH) {
                 const u64 tid = std::stoull(tid_string, nullptr, 16);
 
-                FileSys::NCCHContainer container(GetTitleContentPath(media_type, tid));
-                if (container.Load() == Loader::ResultStatus::Success)
+                // Adding or removing a TMD or content changes the directory, and installs that
+                // overwrite the boot content change that file
+                std::string content_dir = GetTitlePath(media_type, tid) + "content";
+                const s64 directory_modified = FileUtil::GetModificationTime(content_dir);
+                auto entry = title_index.find(content_dir);
+                if (entry == title_index.end() ||
+                    entry->second.directory_modified != directory_modified ||
+                    entry->second.content_modified !=
+                        FileUtil::GetModificationTime(entry->second.content_path) ||
+                    entry->second.content_size != GetContentSize(entry->second.content_path)) {
+                    std::string content_path = GetTitleContentPath(media_type, tid);
+                    FileSys::NCCHContainer container(content_path);
+                    const bool loadable = container.Load() == Loader::ResultStatus::Success;
+                    TitleIndexEntry new_entry{directory_modified, content_path,
+                                              GetContentSize(content_path),
+                                              FileUtil::GetModificationTime(content_path),
+                                              loadable};
+                    entry = title_index.insert_or_assign(content_dir, std::move(new_entry)).first;
+                    index_changed = true;
+                }
+                found.insert(std::move(content_dir));
+
+                if (entry->second.loadable)
                     am_title_list[static_cast<u32>(media_type)].push_back(tid);
             }
         }
     }
+    return index_changed;
 }
 
 void Module::ScanForAllTitles() {
-    ScanForTitles(Service::FS::MediaType::NAND);
-    ScanForTitles(Service::FS::MediaType::SDMC);
+    std::unordered_set<std::string> found;
+    bool index_changed = ScanForTitles(Service::FS::MediaType::NAND, found);
+    index_changed |= ScanForTitles(Service::FS::MediaType::SDMC, found);
+
+    // Forgets the titles that were deleted
+    for (auto itr = title_index.begin(); itr != title_index.end();) {
+        if (found.count(itr->first) == 0) {
+            itr = title_index.erase(itr);
+            index_changed = true;
+        } else {
+            ++itr;
+        }
+    }
+    if (index_changed) {
+        SaveTitleIndex();
+    }
+}
+
+void Module::LoadTitleIndex() {
+    FileUtil::IOFile file(GetTitleIndexPath(), "rb");
+    const auto Read = [&file](auto& value) { return file.ReadArray(&value, 1) == 1; };
+    u32 magic = 0;
+    u32 version = 0;
+    u32 count = 0;
+    if (!file.IsOpen() || !Read(magic) || !Read(version) || !Read(count) ||
+        magic != TITLE_INDEX_MAGIC || version != TITLE_INDEX_VERSION) {
+        return;
+    }
+
+    const auto ReadString = [&file, &Read](std::string& str) {
+        u32 length = 0;
+        if (!Read(length) || length > file.GetSize()) {
+            return false;
+        }
+        str.resize(length);
+        return file.ReadBytes(str.data(), length) == length;
+    };
+    for (u32 i = 0; i < count; ++i) {
+        std::string content_dir;
+        TitleIndexEntry entry;
+        u8 loadable = 0;
+        if (!ReadString(content_dir) || !Read(entry.directory_modified) ||
+            !ReadString(entry.content_path) || !Read(entry.content_size) ||
+            !Read(entry.content_modified) || !Read(loadable)) {
+            LOG_WARNING(Service_AM, "Title index is truncated, rescanning the titles");
+            title_index.clear();
+            return;
+        }
+        entry.loadable = loadable != 0;
+        title_index.emplace(std::move(content_dir), std::move(entry));
+    }
+}
+
+void Module::SaveTitleIndex() const {
+    const std::string path = GetTitleIndexPath();
+    if (!FileUtil::CreateFullPath(path)) {
+        return;
+    }
+
+    // Written under a temporary name first, so that an interrupted write leaves the old index
+    const std::string temp_path = path + ".tmp";
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        const auto WriteString = [&file](const std::string& str) {
+            file.WriteObject(static_cast<u32>(str.size()));
+            file.WriteString(str);
+        };
+        file.WriteObject(TITLE_INDEX_MAGIC);
+        file.WriteObject(TITLE_INDEX_VERSION);
+        file.WriteObject(static_cast<u32>(title_index.size()));
+        for (const auto& [content_dir, entry] : title_index) {
+            WriteString(content_dir);
+            file.WriteObject(entry.directory_modified);
+            WriteString(entry.content_path);
+            file.WriteObject(entry.content_size);
+            file.WriteObject(entry.content_modified);
+            file.WriteObject(static_cast<u8>(entry.loadable));
+        }
+        if (!file.IsGood()) {
+            file.Close();
+            FileUtil::Delete(temp_path);
+            LOG_WARNING(Service_AM, "Could not write the title index");
+            return;
+        }
+    }
+    FileUtil::Delete(path);
+    if (!FileUtil::Rename(temp_path, path)) {
+        FileUtil::Delete(temp_path);
+    }
 }
 
 Module::Interface::Interface(std::shared_ptr<Module> am, const char* name, u32 max_session)
@@ -1146,11 +1304,13 @@ public:
         : file(std::move(file)), file_offset(offset), file_size(size) {}
 
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override {
+        std::scoped_lock lock{file->backend_mutex};
         return file->backend->Read(offset + file_offset, length, buffer);
     }
 
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override {
+        std::scoped_lock lock{file->backend_mutex};
         return file->backend->Write(offset + file_offset, length, flush, buffer);
     }
 
@@ -1491,6 +1651,7 @@ void Module::Interface::GetMetaDataFromCia(Kernel::HLERequestContext& ctx) {
 }
 
 Module::Module(Core::System& system) : kernel(system.Kernel()) {
+    LoadTitleIndex();
     ScanForAllTitles();
     system_updater_mutex = system.Kernel().CreateMutex(false, "AM::SystemUpdaterMutex");
 }
@@ -8,6 +8,8 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/shared_ptr.hpp>
@@ -569,20 +571,43 @@ public:
 private:
     explicit Module(Kernel::KernelSystem& kernel);
 
+    /// What the title index remembers of the content directory of a title
+    struct TitleIndexEntry {
+        s64 directory_modified;
+        std::string content_path;
+        u64 content_size;
+        s64 content_modified;
+        bool loadable;
+    };
+
     /**
      * Scans the for titles in a storage medium for listing.
      * @param media_type the storage medium to scan
+     * @param found receives the content directories of the titles that were found
+     * @return whether titles were parsed again and the title index changed
      */
-    void ScanForTitles(Service::FS::MediaType media_type);
+    bool ScanForTitles(Service::FS::MediaType media_type, std::unordered_set<std::string>& found);
 
     /**
      * Scans all storage mediums for titles for listing.
      */
     void ScanForAllTitles();
 
+    /// Reads the title index of the previous runs from the cache directory
+    void LoadTitleIndex();
+
+    /// Writes the title index to the cache directory
+    void SaveTitleIndex() const;
+
     Kernel::KernelSystem& kernel;
     bool cia_installing = false;
     std::array<std::vector<u64_le>, 3> am_title_list;
+
+    /**
+     * Titles seen by the scans, by their content directory. Titles whose directory and boot
+     * content did not change since are listed without parsing them again.
+     */
+    std::unordered_map<std::string, TitleIndexEntry> title_index;
     std::shared_ptr<Kernel::Mutex> system_updater_mutex;
 
     template <class Archive>
@@ -3,6 +3,10 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "common/archives.h"
 #include "common/bit_set.h"
 #include "common/logging/log.h"
@@ -103,6 +107,54 @@ void Module::PortConfig::Clear() {
     transfer_bytes = 256;
 }
 
+class Module::CaptureThread {
+public:
+    using Task = std::packaged_task<std::vector<u16>()>;
+
+    CaptureThread() : thread([this] { Run(); }) {}
+
+    ~CaptureThread() {
+        {
+            std::lock_guard lock{mutex};
+            stop = true;
+        }
+        task_ready.notify_one();
+        thread.join();
+    }
+
+    std::future<std::vector<u16>> Queue(Task task) {
+        auto result = task.get_future();
+        {
+            std::lock_guard lock{mutex};
+            tasks.push_back(std::move(task));
+        }
+        task_ready.notify_one();
+        return result;
+    }
+
+private:
+    void Run() {
+        std::unique_lock lock{mutex};
+        while (true) {
+            task_ready.wait(lock, [this] { return stop || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            Task task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable task_ready;
+    std::deque<Task> tasks;
+    bool stop = false;
+    std::thread thread;
+};
+
 void Module::CompletionEventCallBack(u64 port_id, s64) {
     PortConfig& port = ports[port_id];
     const CameraConfig& camera = cameras[port.camera_id];
@@ -191,15 +243,16 @@ void Module::StartReceiving(int port_id) {
 
     // launches a capture task asynchronously
     CameraConfig& camera = cameras[port.camera_id];
-    port.capture_result = std::async(std::launch::async, [&camera, &port, this] {
-        if (is_camera_reload_pending.exchange(false)) {
-            // reinitialize the camera according to new settings
-            camera.impl->StopCapture();
-            LoadCameraImplementation(camera, port.camera_id);
-            camera.impl->StartCapture();
-        }
-        return camera.impl->ReceiveFrame();
-    });
+    port.capture_result = capture_threads[port_id]->Queue(
+        CaptureThread::Task{[&camera, &port, this] {
+            if (is_camera_reload_pending.exchange(false)) {
+                // reinitialize the camera according to new settings
+                camera.impl->StopCapture();
+                LoadCameraImplementation(camera, port.camera_id);
+                camera.impl->StartCapture();
+            }
+            return camera.impl->ReceiveFrame();
+        }});
 
     // schedules a completion event according to the frame rate. The event will block on the
     // capture task if it is not finished within the expected time
@@ -1109,6 +1162,9 @@ void Module::Interface::DriverFinalize(Kernel::HLERequestContext& ctx) {
 
 Module::Module(Core::System& system) : system(system) {
     using namespace Kernel;
+    for (auto& capture_thread : capture_threads) {
+        capture_thread = std::make_unique<CaptureThread>();
+    }
     for (PortConfig& port : ports) {
         port.completion_event =
             system.Kernel().CreateEvent(ResetType::Sticky, "CAM::completion_event");
@@ -756,10 +756,14 @@ private:
 
     void LoadCameraImplementation(CameraConfig& camera, int camera_id);
 
+    /// Runs the frame captures of a port, so that receiving a frame doesn't start a new thread
+    class CaptureThread;
+
     Core::System& system;
     bool initialized{};
     std::array<CameraConfig, NumCameras> cameras;
     std::array<PortConfig, 2> ports;
+    std::array<std::unique_ptr<CaptureThread>, 2> capture_threads;
     Core::TimingEventType* completion_event_callback;
     Core::TimingEventType* vsync_interrupt_event_callback;
     std::atomic<bool> is_camera_reload_pending{false};
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/unique_ptr.hpp>
 #include <cryptopp/base64.h>
@@ -38,6 +39,9 @@ void Module::serialize(Archive& ar, const unsigned int) {
     ar& cecd_system_save_data_archive;
     ar& cecinfo_event;
     ar& change_state_event;
+    if (Archive::is_loading::value) {
+        LoadIndex();
+    }
 }
 SERIALIZE_IMPL(Module)
 
@@ -45,6 +49,40 @@ using CecDataPathType = Module::CecDataPathType;
 using CecOpenMode = Module::CecOpenMode;
 using CecSystemInfoType = Module::CecSystemInfoType;
 
+namespace {
+
+/// Returns the path of the directory holding the entry at the given path
+std::string GetParentPath(const std::string& path) {
+    return path.substr(0, path.rfind('/'));
+}
+
+/// Returns the name of the entry at the given path
+std::string GetEntryName(const std::string& path) {
+    return path.substr(path.rfind('/') + 1);
+}
+
+/// Returns whether the entry at the given path is a message of an InBox or OutBox
+bool IsMessagePath(const std::string& path) {
+    const std::string parent = GetParentPath(path);
+    const std::string box = GetEntryName(parent);
+    return GetEntryName(path).rfind('_', 0) == 0 && (box == "InBox___" || box == "OutBox__");
+}
+
+/// Returns whether the path type is the one of a directory
+bool IsDirectoryPathType(CecDataPathType path_type) {
+    switch (path_type) {
+    case CecDataPathType::RootDir:
+    case CecDataPathType::MboxDir:
+    case CecDataPathType::InboxDir:
+    case CecDataPathType::OutboxDir:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // Anonymous namespace
+
 void Module::Interface::Open(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x01, 3, 2);
     const u32 ncch_program_id = rp.Pop<u32>();
@@ -65,43 +103,38 @@ void Module::Interface::Open(Kernel::HLERequestContext& ctx) {
     session_data->data_path_type = path_type;
     session_data->path = path;
 
+    const std::string path_string = path.AsString();
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    switch (path_type) {
-    case CecDataPathType::RootDir:
-    case CecDataPathType::MboxDir:
-    case CecDataPathType::InboxDir:
-    case CecDataPathType::OutboxDir: {
-        auto dir_result = cecd->cecd_system_save_data_archive->OpenDirectory(path);
-        if (dir_result.Failed()) {
+    if (IsDirectoryPathType(path_type)) {
+        const auto* directory = cecd->GetIndexedDirectory(path_string);
+        if (directory == nullptr) {
             if (open_mode.create) {
-                cecd->cecd_system_save_data_archive->CreateDirectory(path);
+                cecd->CreateIndexedDirectory(path_string);
                 rb.Push(RESULT_SUCCESS);
             } else {
-                LOG_DEBUG(Service_CECD, "Failed to open directory: {}", path.AsString());
+                LOG_DEBUG(Service_CECD, "Failed to open directory: {}", path_string);
                 rb.Push(ResultCode(ErrorDescription::NoData, ErrorModule::CEC,
                                    ErrorSummary::NotFound, ErrorLevel::Status));
             }
             rb.Push<u32>(0); // Zero entries
         } else {
             constexpr u32 max_entries = 32; // reasonable value, just over max boxes 24
-            auto directory = std::move(dir_result).Unwrap();
-
-            // Actual reading into vector seems to be required for entry count
-            std::vector<FileSys::Entry> entries(max_entries);
-            const u32 entry_count = directory->Read(max_entries, entries.data());
+            const u32 entry_count = std::min(static_cast<u32>(directory->size()), max_entries);
 
             LOG_DEBUG(Service_CECD, "Number of entries found: {}", entry_count);
 
             rb.Push(RESULT_SUCCESS);
             rb.Push<u32>(entry_count); // Entry count
-            directory->Close();
         }
-        break;
-    }
-    default: { // If not directory, then it is a file
+    } else if (const auto* data = cecd->GetIndexedFile(path_string);
+               data != nullptr && !IsMessagePath(path_string)) {
+        // Reads and writes of the session go through the index
+        rb.Push(RESULT_SUCCESS);
+        rb.Push<u32>(static_cast<u32>(data->size())); // Return file size
+    } else { // If not indexed, then it is a message or a file that does not exist yet
         auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
         if (file_result.Failed()) {
-            LOG_DEBUG(Service_CECD, "Failed to open file: {}", path.AsString());
+            LOG_DEBUG(Service_CECD, "Failed to open file: {}", path_string);
             rb.Push(ResultCode(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
                                ErrorLevel::Status));
             rb.Push<u32>(0); // No file size
@@ -109,16 +142,20 @@ void Module::Interface::Open(Kernel::HLERequestContext& ctx) {
             session_data->file = std::move(file_result).Unwrap();
             rb.Push(RESULT_SUCCESS);
             rb.Push<u32>(static_cast<u32>(session_data->file->GetSize())); // Return file size
-        }
-
-        if (path_type == CecDataPathType::MboxProgramId) {
-            std::vector<u8> program_id(8);
-            u64_le le_program_id = cecd->system.Kernel().GetCurrentProcess()->codeset->program_id;
-            std::memcpy(program_id.data(), &le_program_id, sizeof(u64));
-            session_data->file->Write(0, sizeof(u64), true, program_id.data());
-            session_data->file->Close();
+            if (!IsMessagePath(path_string) && session_data->file->GetSize() == 0) {
+                // The file was just created
+                cecd->IndexFile(path_string, {});
+                session_data->file->Close();
+                session_data->file = nullptr;
+            }
         }
     }
+
+    if (path_type == CecDataPathType::MboxProgramId) {
+        std::vector<u8> program_id(8);
+        u64_le le_program_id = cecd->system.Kernel().GetCurrentProcess()->codeset->program_id;
+        std::memcpy(program_id.data(), &le_program_id, sizeof(u64));
+        cecd->WriteFile(path_string, program_id);
     }
 
     LOG_DEBUG(Service_CECD,
@@ -155,11 +192,17 @@ void Module::Interface::Read(Kernel::HLERequestContext& ctx) {
         break;
     default: // If not directory, then it is a file
         std::vector<u8> buffer(write_buffer_size);
-        const u32 bytes_read = static_cast<u32>(
-            session_data->file->Read(0, write_buffer_size, buffer.data()).Unwrap());
+        u32 bytes_read = 0;
+        if (session_data->file) {
+            bytes_read = static_cast<u32>(
+                session_data->file->Read(0, write_buffer_size, buffer.data()).Unwrap());
+            session_data->file->Close();
+        } else if (const auto* data = cecd->GetIndexedFile(session_data->path.AsString())) {
+            bytes_read = std::min(write_buffer_size, static_cast<u32>(data->size()));
+            std::memcpy(buffer.data(), data->data(), bytes_read);
+        }
 
         write_buffer.Write(buffer.data(), 0, write_buffer_size);
-        session_data->file->Close();
 
         rb.Push(RESULT_SUCCESS);
         rb.Push<u32>(bytes_read);
@@ -361,18 +404,16 @@ void Module::Interface::Write(Kernel::HLERequestContext& ctx) {
         std::vector<u8> buffer(read_buffer_size);
         read_buffer.Read(buffer.data(), 0, read_buffer_size);
 
-        if (session_data->file->GetSize() != read_buffer_size) {
-            session_data->file->SetSize(read_buffer_size);
-        }
-
         if (session_data->open_mode.check) {
             cecd->CheckAndUpdateFile(session_data->data_path_type, session_data->ncch_program_id,
                                      buffer);
         }
 
-        [[maybe_unused]] const u32 bytes_written = static_cast<u32>(
-            session_data->file->Write(0, buffer.size(), true, buffer.data()).Unwrap());
-        session_data->file->Close();
+        if (session_data->file) {
+            session_data->file->Close();
+            session_data->file = nullptr;
+        }
+        cecd->WriteFile(session_data->path.AsString(), buffer);
 
         rb.Push(RESULT_SUCCESS);
     }
@@ -390,10 +431,6 @@ void Module::Interface::WriteMessage(Kernel::HLERequestContext& ctx) {
     auto& read_buffer = rp.PopMappedBuffer();
     auto& message_id_buffer = rp.PopMappedBuffer();
 
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
-
     std::vector<u8> id_buffer(message_id_size);
     message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
 
@@ -403,39 +440,31 @@ void Module::Interface::WriteMessage(Kernel::HLERequestContext& ctx) {
                                          ncch_program_id, id_buffer)
             .data();
 
-    auto message_result = cecd->cecd_system_save_data_archive->OpenFile(message_path, mode);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 4);
-    if (message_result.Succeeded()) {
-        auto message = std::move(message_result).Unwrap();
-
-        std::vector<u8> buffer(buffer_size);
-        read_buffer.Read(buffer.data(), 0, buffer_size);
-
-        CecMessageHeader msg_header;
-        std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
-
-        LOG_DEBUG(Service_CECD,
-                  "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
-                  "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
-                  "batch_id={:#010x}",
-                  msg_header.magic, msg_header.message_size, msg_header.header_size,
-                  msg_header.body_size, msg_header.title_id, msg_header.title_id2,
-                  msg_header.batch_id);
-        LOG_DEBUG(Service_CECD,
-                  "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
-                  "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
-                  "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
-                  "forward_count={:#04x}, user_data={:#06x}, ",
-                  msg_header.unknown_id, msg_header.version, msg_header.flag,
-                  msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
-                  msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
-                  msg_header.forward_count, msg_header.user_data);
+    std::vector<u8> buffer(buffer_size);
+    read_buffer.Read(buffer.data(), 0, buffer_size);
 
-        [[maybe_unused]] const u32 bytes_written =
-            static_cast<u32>(message->Write(0, buffer_size, true, buffer.data()).Unwrap());
-        message->Close();
+    CecMessageHeader msg_header;
+    std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
 
+    LOG_DEBUG(Service_CECD,
+              "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
+              "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
+              "batch_id={:#010x}",
+              msg_header.magic, msg_header.message_size, msg_header.header_size,
+              msg_header.body_size, msg_header.title_id, msg_header.title_id2,
+              msg_header.batch_id);
+    LOG_DEBUG(Service_CECD,
+              "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
+              "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
+              "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
+              "forward_count={:#04x}, user_data={:#06x}, ",
+              msg_header.unknown_id, msg_header.version, msg_header.flag,
+              msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
+              msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
+              msg_header.forward_count, msg_header.user_data);
+
+    if (cecd->WriteFile(message_path.AsString(), buffer).IsSuccess()) {
         rb.Push(RESULT_SUCCESS);
     } else {
         rb.Push(ResultCode(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
@@ -461,10 +490,6 @@ void Module::Interface::WriteMessageWithHMAC(Kernel::HLERequestContext& ctx) {
     auto& hmac_key_buffer = rp.PopMappedBuffer();
     auto& message_id_buffer = rp.PopMappedBuffer();
 
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
-
     std::vector<u8> id_buffer(message_id_size);
     message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
 
@@ -474,55 +499,47 @@ void Module::Interface::WriteMessageWithHMAC(Kernel::HLERequestContext& ctx) {
                                          ncch_program_id, id_buffer)
             .data();
 
-    auto message_result = cecd->cecd_system_save_data_archive->OpenFile(message_path, mode);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 6);
-    if (message_result.Succeeded()) {
-        auto message = std::move(message_result).Unwrap();
+    std::vector<u8> buffer(buffer_size);
+    read_buffer.Read(buffer.data(), 0, buffer_size);
 
-        std::vector<u8> buffer(buffer_size);
-        read_buffer.Read(buffer.data(), 0, buffer_size);
+    CecMessageHeader msg_header;
+    std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
 
-        CecMessageHeader msg_header;
-        std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
-
-        LOG_DEBUG(Service_CECD,
-                  "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
-                  "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
-                  "batch_id={:#010x}",
-                  msg_header.magic, msg_header.message_size, msg_header.header_size,
-                  msg_header.body_size, msg_header.title_id, msg_header.title_id2,
-                  msg_header.batch_id);
-        LOG_DEBUG(Service_CECD,
-                  "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
-                  "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
-                  "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
-                  "forward_count={:#04x}, user_data={:#06x}, ",
-                  msg_header.unknown_id, msg_header.version, msg_header.flag,
-                  msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
-                  msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
-                  msg_header.forward_count, msg_header.user_data);
-
-        const u32 hmac_offset = msg_header.header_size + msg_header.body_size;
-        const u32 hmac_size = 0x20;
-
-        std::vector<u8> hmac_digest(hmac_size);
-        std::vector<u8> message_body(msg_header.body_size);
-        std::memcpy(message_body.data(), buffer.data() + msg_header.header_size,
-                    msg_header.body_size);
-
-        using namespace CryptoPP;
-        SecByteBlock key(hmac_size);
-        hmac_key_buffer.Read(key.data(), 0, hmac_size);
+    LOG_DEBUG(Service_CECD,
+              "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
+              "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
+              "batch_id={:#010x}",
+              msg_header.magic, msg_header.message_size, msg_header.header_size,
+              msg_header.body_size, msg_header.title_id, msg_header.title_id2,
+              msg_header.batch_id);
+    LOG_DEBUG(Service_CECD,
+              "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
+              "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
+              "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
+              "forward_count={:#04x}, user_data={:#06x}, ",
+              msg_header.unknown_id, msg_header.version, msg_header.flag,
+              msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
+              msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
+              msg_header.forward_count, msg_header.user_data);
+
+    const u32 hmac_offset = msg_header.header_size + msg_header.body_size;
+    const u32 hmac_size = 0x20;
+
+    std::vector<u8> hmac_digest(hmac_size);
+    std::vector<u8> message_body(msg_header.body_size);
+    std::memcpy(message_body.data(), buffer.data() + msg_header.header_size,
+                msg_header.body_size);
 
-        HMAC<SHA256> hmac(key, hmac_size);
-        hmac.CalculateDigest(hmac_digest.data(), message_body.data(), msg_header.body_size);
-        std::memcpy(buffer.data() + hmac_offset, hmac_digest.data(), hmac_size);
+    using namespace CryptoPP;
+    SecByteBlock key(hmac_size);
+    hmac_key_buffer.Read(key.data(), 0, hmac_size);
 
-        [[maybe_unused]] const u32 bytes_written =
-            static_cast<u32>(message->Write(0, buffer_size, true, buffer.data()).Unwrap());
-        message->Close();
+    HMAC<SHA256> hmac(key, hmac_size);
+    hmac.CalculateDigest(hmac_digest.data(), message_body.data(), msg_header.body_size);
+    std::memcpy(buffer.data() + hmac_offset, hmac_digest.data(), hmac_size);
 
+    if (cecd->WriteFile(message_path.AsString(), buffer).IsSuccess()) {
         rb.Push(RESULT_SUCCESS);
     } else {
         rb.Push(ResultCode(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
@@ -557,11 +574,11 @@ void Module::Interface::Delete(Kernel::HLERequestContext& ctx) {
     case CecDataPathType::MboxDir:
     case CecDataPathType::InboxDir:
     case CecDataPathType::OutboxDir:
-        rb.Push(cecd->cecd_system_save_data_archive->DeleteDirectoryRecursively(path));
+        rb.Push(cecd->DeleteIndexedDirectory(path.AsString()));
         break;
     default: // If not directory, then it is a file
         if (message_id_size == 0) {
-            rb.Push(cecd->cecd_system_save_data_archive->DeleteFile(path));
+            rb.Push(cecd->DeleteIndexedFile(path.AsString()));
         } else {
             std::vector<u8> id_buffer(message_id_size);
             message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
@@ -571,7 +588,7 @@ void Module::Interface::Delete(Kernel::HLERequestContext& ctx) {
                                                            : CecDataPathType::InboxMsg,
                                                  ncch_program_id, id_buffer)
                     .data();
-            rb.Push(cecd->cecd_system_save_data_archive->DeleteFile(message_path));
+            rb.Push(cecd->DeleteIndexedFile(message_path.AsString()));
         }
     }
 
@@ -591,23 +608,14 @@ void Module::Interface::SetData(Kernel::HLERequestContext& ctx) {
     auto& read_buffer = rp.PopMappedBuffer();
 
     if (option == 2 && buffer_size > 0) { // update obindex?
-        FileSys::Path path(
-            cecd->GetCecDataPathTypeAsString(CecDataPathType::OutboxIndex, ncch_program_id).data());
-        FileSys::Mode mode;
-        mode.write_flag.Assign(1);
-        mode.create_flag.Assign(1);
-
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
-            std::vector<u8> buffer(buffer_size);
-            read_buffer.Read(buffer.data(), 0, buffer_size);
+        const std::string path =
+            cecd->GetCecDataPathTypeAsString(CecDataPathType::OutboxIndex, ncch_program_id);
+        std::vector<u8> buffer(buffer_size);
+        read_buffer.Read(buffer.data(), 0, buffer_size);
 
-            cecd->CheckAndUpdateFile(CecDataPathType::OutboxIndex, ncch_program_id, buffer);
+        cecd->CheckAndUpdateFile(CecDataPathType::OutboxIndex, ncch_program_id, buffer);
 
-            file->Write(0, buffer.size(), true, buffer.data());
-            file->Close();
-        }
+        cecd->WriteFile(path, buffer);
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
@@ -732,9 +740,6 @@ void Module::Interface::OpenAndWrite(Kernel::HLERequestContext& ctx) {
     auto& read_buffer = rp.PopMappedBuffer();
 
     FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
     switch (path_type) {
@@ -745,32 +750,22 @@ void Module::Interface::OpenAndWrite(Kernel::HLERequestContext& ctx) {
         rb.Push(ResultCode(ErrorDescription::NotAuthorized, ErrorModule::CEC,
                            ErrorSummary::NotFound, ErrorLevel::Status));
         break;
-    default: // If not directory, then it is a file
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
-
-            std::vector<u8> buffer(buffer_size);
-            read_buffer.Read(buffer.data(), 0, buffer_size);
-
-            if (file->GetSize() != buffer_size) {
-                file->SetSize(buffer_size);
-            }
-
-            if (open_mode.check) {
-                cecd->CheckAndUpdateFile(path_type, ncch_program_id, buffer);
-            }
+    default: { // If not directory, then it is a file
+        std::vector<u8> buffer(buffer_size);
+        read_buffer.Read(buffer.data(), 0, buffer_size);
 
-            [[maybe_unused]] const u32 bytes_written =
-                static_cast<u32>(file->Write(0, buffer.size(), true, buffer.data()).Unwrap());
-            file->Close();
+        if (open_mode.check) {
+            cecd->CheckAndUpdateFile(path_type, ncch_program_id, buffer);
+        }
 
+        if (cecd->WriteFile(path.AsString(), buffer).IsSuccess()) {
             rb.Push(RESULT_SUCCESS);
         } else {
             rb.Push(ResultCode(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
                                ErrorLevel::Status));
         }
     }
+    }
     rb.PushMappedBuffer(read_buffer);
 
     LOG_DEBUG(Service_CECD,
@@ -792,8 +787,6 @@ void Module::Interface::OpenAndRead(Kernel::HLERequestContext& ctx) {
     auto& write_buffer = rp.PopMappedBuffer();
 
     FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.read_flag.Assign(1);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
     switch (path_type) {
@@ -806,15 +799,12 @@ void Module::Interface::OpenAndRead(Kernel::HLERequestContext& ctx) {
         rb.Push<u32>(0); // No entries read
         break;
     default: // If not directory, then it is a file
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
+        if (const auto* data = cecd->GetIndexedFile(path.AsString())) {
             std::vector<u8> buffer(buffer_size);
 
-            const u32 bytes_read =
-                static_cast<u32>(file->Read(0, buffer_size, buffer.data()).Unwrap());
+            const u32 bytes_read = std::min(buffer_size, static_cast<u32>(data->size()));
+            std::memcpy(buffer.data(), data->data(), bytes_read);
             write_buffer.Write(buffer.data(), 0, buffer_size);
-            file->Close();
 
             rb.Push(RESULT_SUCCESS);
             rb.Push<u32>(bytes_read);
@@ -1010,27 +1000,20 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
                 /// We need to read the /CEC directory to find out which titles, if any,
                 /// are activated. The num_of_titles = (total_read_count) - 1, to adjust for
                 /// the MBoxList____ file that is present in the directory as well.
-                FileSys::Path root_path(
-                    GetCecDataPathTypeAsString(CecDataPathType::RootDir, 0).data());
-
-                auto dir_result = cecd_system_save_data_archive->OpenDirectory(root_path);
-
-                auto root_dir = std::move(dir_result).Unwrap();
-                std::vector<FileSys::Entry> entries(max_num_boxes + 1); // + 1 mboxlist
-                const u32 entry_count = root_dir->Read(max_num_boxes + 1, entries.data());
-                root_dir->Close();
+                const auto* root_dir =
+                    GetIndexedDirectory(GetCecDataPathTypeAsString(CecDataPathType::RootDir, 0));
+                std::vector<std::string> entries;
+                if (root_dir != nullptr) {
+                    entries.assign(root_dir->begin(), root_dir->end());
+                }
+                entries.resize(std::min<std::size_t>(entries.size(), max_num_boxes + 1));
 
-                LOG_DEBUG(Service_CECD, "Number of entries found in /CEC: {}", entry_count);
+                LOG_DEBUG(Service_CECD, "Number of entries found in /CEC: {}", entries.size());
 
                 std::string mbox_list_name("MBoxList____");
-                std::string file_name;
-                std::u16string u16_filename;
 
                 // Loop through entries but don't add mboxlist____ to itself.
-                for (u32 i = 0; i < entry_count; i++) {
-                    u16_filename = std::u16string(entries[i].filename);
-                    file_name = Common::UTF16ToUTF8(u16_filename);
-
+                for (const std::string& file_name : entries) {
                     if (mbox_list_name.compare(file_name) != 0) {
                         LOG_DEBUG(Service_CECD, "Adding title to mboxlist____: {}", file_name);
                         std::memcpy(&mbox_list_header.box_names[mbox_list_header.num_boxes++],
@@ -1199,48 +1182,32 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
         /// We need to read the /CEC/<id>/OutBox directory to find out which messages, if any,
         /// are present. The num_of_messages = (total_read_count) - 2, to adjust for
         /// the BoxInfo____ and OBIndex_____files that are present in the directory as well.
-        FileSys::Path outbox_path(
-            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id).data());
-
-        auto dir_result = cecd_system_save_data_archive->OpenDirectory(outbox_path);
-
-        auto outbox_dir = std::move(dir_result).Unwrap();
-        std::vector<FileSys::Entry> entries(outbox_info_header.max_message_num + 2);
-        const u32 entry_count =
-            outbox_dir->Read(outbox_info_header.max_message_num + 2, entries.data());
-        outbox_dir->Close();
+        const std::string outbox_path =
+            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id);
+        const auto* outbox_dir = GetIndexedDirectory(outbox_path);
+        std::vector<std::string> entries;
+        if (outbox_dir != nullptr) {
+            entries.assign(outbox_dir->begin(), outbox_dir->end());
+        }
+        entries.resize(
+            std::min<std::size_t>(entries.size(), outbox_info_header.max_message_num + 2));
 
-        LOG_DEBUG(Service_CECD, "Number of entries found in /OutBox: {}", entry_count);
+        LOG_DEBUG(Service_CECD, "Number of entries found in /OutBox: {}", entries.size());
         std::array<CecMessageHeader, 8> message_headers;
 
         std::string boxinfo_name("BoxInfo_____");
         std::string obindex_name("OBIndex_____");
-        std::string file_name;
-        std::u16string u16_filename;
-
-        for (u32 i = 0; i < entry_count; i++) {
-            u16_filename = std::u16string(entries[i].filename);
-            file_name = Common::UTF16ToUTF8(u16_filename);
 
+        for (const std::string& file_name : entries) {
             if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0) {
                 LOG_DEBUG(Service_CECD, "Adding message to BoxInfo_____: {}", file_name);
 
-                FileSys::Path message_path(
-                    (GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
-                     file_name)
-                        .data());
-
-                FileSys::Mode mode;
-                mode.read_flag.Assign(1);
-
-                auto message_result = cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-                auto message = std::move(message_result).Unwrap();
-                const u32 message_size = static_cast<u32>(message->GetSize());
-                std::vector<u8> buffer(message_size);
-
-                message->Read(0, message_size, buffer.data()).Unwrap();
-                message->Close();
+                // Only the header of messages is indexed
+                std::vector<u8> buffer(sizeof(CecMessageHeader));
+                if (const auto* header = GetIndexedFile(outbox_path + "/" + file_name)) {
+                    std::memcpy(buffer.data(), header->data(),
+                                std::min(buffer.size(), header->size()));
+                }
 
                 std::memcpy(&message_headers[outbox_info_header.message_num++], buffer.data(),
                             sizeof(CecMessageHeader));
@@ -1292,45 +1259,29 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
         /// We need to read the /CEC/<id>/OutBox directory to find out which messages, if any,
         /// are present. The num_of_messages = (total_read_count) - 2, to adjust for
         /// the BoxInfo____ and OBIndex_____files that are present in the directory as well.
-        FileSys::Path outbox_path(
-            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id).data());
-
-        auto dir_result = cecd_system_save_data_archive->OpenDirectory(outbox_path);
-
-        auto outbox_dir = std::move(dir_result).Unwrap();
-        std::vector<FileSys::Entry> entries(8);
-        const u32 entry_count = outbox_dir->Read(8, entries.data());
-        outbox_dir->Close();
+        const std::string outbox_path =
+            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id);
+        const auto* outbox_dir = GetIndexedDirectory(outbox_path);
+        std::vector<std::string> entries;
+        if (outbox_dir != nullptr) {
+            entries.assign(outbox_dir->begin(), outbox_dir->end());
+        }
+        entries.resize(std::min<std::size_t>(entries.size(), 8));
 
-        LOG_DEBUG(Service_CECD, "Number of entries found in /OutBox: {}", entry_count);
+        LOG_DEBUG(Service_CECD, "Number of entries found in /OutBox: {}", entries.size());
         std::array<std::array<u8, 8>, 8> message_ids;
 
         std::string boxinfo_name("BoxInfo_____");
         std::string obindex_name("OBIndex_____");
-        std::string file_name;
-        std::u16string u16_filename;
-
-        for (u32 i = 0; i < entry_count; i++) {
-            u16_filename = std::u16string(entries[i].filename);
-            file_name = Common::UTF16ToUTF8(u16_filename);
 
+        for (const std::string& file_name : entries) {
             if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0) {
-                FileSys::Path message_path(
-                    (GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
-                     file_name)
-                        .data());
-
-                FileSys::Mode mode;
-                mode.read_flag.Assign(1);
-
-                auto message_result = cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-                auto message = std::move(message_result).Unwrap();
-                const u32 message_size = static_cast<u32>(message->GetSize());
-                std::vector<u8> buffer(message_size);
-
-                message->Read(0, message_size, buffer.data()).Unwrap();
-                message->Close();
+                // Only the header of messages is indexed
+                std::vector<u8> buffer(sizeof(CecMessageHeader));
+                if (const auto* header = GetIndexedFile(outbox_path + "/" + file_name)) {
+                    std::memcpy(buffer.data(), header->data(),
+                                std::min(buffer.size(), header->size()));
+                }
 
                 // Message id is at offset 0x20, and is 8 bytes
                 std::memcpy(&message_ids[obindex_header.message_num++], buffer.data() + 0x20, 8);
@@ -1364,6 +1315,147 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
     }
 }
 
+void Module::LoadIndex() {
+    index = {};
+    LoadIndexedDirectory(GetCecDataPathTypeAsString(CecDataPathType::RootDir, 0));
+}
+
+void Module::LoadIndexedDirectory(const std::string& path) {
+    auto dir_result = cecd_system_save_data_archive->OpenDirectory(FileSys::Path(path.data()));
+    if (dir_result.Failed()) {
+        return;
+    }
+    auto directory = std::move(dir_result).Unwrap();
+    auto& names = index.directories[path];
+
+    constexpr u32 batch_size = 32;
+    std::vector<FileSys::Entry> entries(batch_size);
+    std::vector<std::string> subdirectories;
+    while (const u32 entry_count = directory->Read(batch_size, entries.data())) {
+        for (u32 i = 0; i < entry_count; i++) {
+            const std::string name = Common::UTF16ToUTF8(std::u16string(entries[i].filename));
+            names.insert(name);
+            const std::string entry_path = path + "/" + name;
+            if (entries[i].is_directory) {
+                subdirectories.push_back(entry_path);
+                continue;
+            }
+
+            FileSys::Mode mode;
+            mode.read_flag.Assign(1);
+            auto file_result =
+                cecd_system_save_data_archive->OpenFile(FileSys::Path(entry_path.data()), mode);
+            if (file_result.Failed()) {
+                continue;
+            }
+            auto file = std::move(file_result).Unwrap();
+            u64 size = file->GetSize();
+            if (IsMessagePath(entry_path)) {
+                size = std::min<u64>(size, sizeof(CecMessageHeader));
+            }
+            std::vector<u8> data(size);
+            file->Read(0, size, data.data());
+            file->Close();
+            index.files[entry_path] = std::move(data);
+        }
+    }
+    directory->Close();
+
+    for (const std::string& subdirectory : subdirectories) {
+        LoadIndexedDirectory(subdirectory);
+    }
+}
+
+const std::set<std::string>* Module::GetIndexedDirectory(const std::string& path) const {
+    const auto it = index.directories.find(path);
+    return it != index.directories.end() ? &it->second : nullptr;
+}
+
+const std::vector<u8>* Module::GetIndexedFile(const std::string& path) const {
+    const auto it = index.files.find(path);
+    return it != index.files.end() ? &it->second : nullptr;
+}
+
+void Module::IndexFile(const std::string& path, const std::vector<u8>& data) {
+    const std::string parent = GetParentPath(path);
+    if (!parent.empty()) {
+        index.directories[parent].insert(GetEntryName(path));
+    }
+    if (IsMessagePath(path)) {
+        const auto header_size = std::min(data.size(), sizeof(CecMessageHeader));
+        index.files[path].assign(data.begin(), data.begin() + header_size);
+    } else {
+        index.files[path] = data;
+    }
+}
+
+ResultCode Module::WriteFile(const std::string& path, const std::vector<u8>& data) {
+    FileSys::Mode mode;
+    mode.write_flag.Assign(1);
+    mode.create_flag.Assign(1);
+
+    auto file_result = cecd_system_save_data_archive->OpenFile(FileSys::Path(path.data()), mode);
+    if (file_result.Failed()) {
+        LOG_DEBUG(Service_CECD, "Failed to open file: {}", path);
+        return file_result.Code();
+    }
+    auto file = std::move(file_result).Unwrap();
+    if (file->GetSize() != data.size()) {
+        file->SetSize(data.size());
+    }
+    file->Write(0, data.size(), true, data.data());
+    file->Close();
+
+    IndexFile(path, data);
+    return RESULT_SUCCESS;
+}
+
+ResultCode Module::CreateIndexedDirectory(const std::string& path) {
+    const ResultCode result =
+        cecd_system_save_data_archive->CreateDirectory(FileSys::Path(path.data()));
+    if (result.IsSuccess()) {
+        index.directories[path];
+        const std::string parent = GetParentPath(path);
+        if (!parent.empty()) {
+            index.directories[parent].insert(GetEntryName(path));
+        }
+    }
+    return result;
+}
+
+ResultCode Module::DeleteIndexedFile(const std::string& path) {
+    const ResultCode result = cecd_system_save_data_archive->DeleteFile(FileSys::Path(path.data()));
+    if (result.IsSuccess()) {
+        index.files.erase(path);
+        if (const auto it = index.directories.find(GetParentPath(path));
+            it != index.directories.end()) {
+            it->second.erase(GetEntryName(path));
+        }
+    }
+    return result;
+}
+
+ResultCode Module::DeleteIndexedDirectory(const std::string& path) {
+    const ResultCode result =
+        cecd_system_save_data_archive->DeleteDirectoryRecursively(FileSys::Path(path.data()));
+    if (result.IsSuccess()) {
+        const auto is_within = [&path](const std::string& entry_path) {
+            return entry_path == path || entry_path.rfind(path + "/", 0) == 0;
+        };
+        for (auto it = index.files.begin(); it != index.files.end();) {
+            it = is_within(it->first) ? index.files.erase(it) : std::next(it);
+        }
+        for (auto it = index.directories.begin(); it != index.directories.end();) {
+            it = is_within(it->first) ? index.directories.erase(it) : std::next(it);
+        }
+        if (const auto it = index.directories.find(GetParentPath(path));
+            it != index.directories.end()) {
+            it->second.erase(GetEntryName(path));
+        }
+    }
+    return result;
+}
+
 Module::SessionData::SessionData() {}
 
 Module::SessionData::~SessionData() {
@@ -1451,6 +1543,8 @@ Module::Module(Core::System& system) : system(system) {
         mboxlist->Write(0, mboxlist_size, true, mboxlist_buffer.data());
         mboxlist->Close();
     }
+
+    LoadIndex();
 }
 
 Module::~Module() = default;
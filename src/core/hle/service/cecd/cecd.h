@@ -4,7 +4,12 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "common/bit_field.h"
 #include "common/common_funcs.h"
 #include "core/hle/kernel/event.h"
@@ -620,8 +625,47 @@ private:
     void CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_program_id,
                             std::vector<u8>& file_buffer);
 
+    /// Rebuilds the index from the contents of the save data archive
+    void LoadIndex();
+
+    /// Adds a directory of the archive, and everything below it, to the index
+    void LoadIndexedDirectory(const std::string& path);
+
+    /// Returns the names of the entries of an indexed directory, or nullptr if it does not exist
+    const std::set<std::string>* GetIndexedDirectory(const std::string& path) const;
+
+    /**
+     * Returns the contents of an indexed file, or nullptr if it does not exist. Only the header of
+     * messages is indexed.
+     */
+    const std::vector<u8>* GetIndexedFile(const std::string& path) const;
+
+    /// Records the contents of a file in the index, and the file in the entries of its directory
+    void IndexFile(const std::string& path, const std::vector<u8>& data);
+
+    /// Writes a whole file of the archive, creating it if needed, and updates the index
+    ResultCode WriteFile(const std::string& path, const std::vector<u8>& data);
+
+    /// Creates a directory in the archive and in the index
+    ResultCode CreateIndexedDirectory(const std::string& path);
+
+    /// Deletes a file from the archive and from the index
+    ResultCode DeleteIndexedFile(const std::string& path);
+
+    /// Deletes a directory and its contents from the archive and from the index
+    ResultCode DeleteIndexedDirectory(const std::string& path);
+
     std::unique_ptr<FileSys::ArchiveBackend> cecd_system_save_data_archive;
 
+    /// Index of the CEC save data, loaded when the module starts and updated by every write and
+    /// delete made through the module, so that requests do not scan the host directories
+    struct SaveDataIndex {
+        /// Names of the entries of each directory below /CEC, and of /CEC itself
+        std::map<std::string, std::set<std::string>> directories;
+        /// Contents of the files, except for messages of which only the header is kept
+        std::unordered_map<std::string, std::vector<u8>> files;
+    } index;
+
     std::shared_ptr<Kernel::Event> cecinfo_event;
     std::shared_ptr<Kernel::Event> change_state_event;
 
@@ -2,9 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <condition_variable>
+#include <functional>
+#include <thread>
 #include <boost/serialization/unique_ptr.hpp>
+#include <boost/serialization/vector.hpp>
 #include "common/archives.h"
+#include "common/common_funcs.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
+#include "common/threadsafe_queue.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
@@ -20,10 +27,129 @@ SERIALIZE_EXPORT_IMPL(Service::FS::FileSessionSlot)
 
 namespace Service::FS {
 
+namespace {
+
+/**
+ * Thread on which the host side of guest file reads is performed, so that slow storage does not
+ * stall emulation. A single thread keeps the reads in submission order.
+ */
+class IOThread {
+public:
+    ~IOThread() {
+        if (thread.joinable()) {
+            tasks.Push(std::function<void()>{});
+            thread.join();
+        }
+    }
+
+    /// Queues a task. Only called from the emulation thread.
+    void Push(std::function<void()> task) {
+        if (!thread.joinable()) {
+            thread = std::thread(&IOThread::Loop, this);
+        }
+        tasks.Push(std::move(task));
+    }
+
+private:
+    void Loop() {
+        Common::SetCurrentThreadName("FS I/O");
+        while (auto task = tasks.PopWait()) {
+            task();
+        }
+    }
+
+    std::thread thread;
+    Common::SPSCQueue<std::function<void()>> tasks;
+};
+
+/// Returns the I/O thread of the console, as the queue only takes one producer
+IOThread& GetIOThread() {
+    static INSTANCE_LOCAL IOThread io_thread;
+    return io_thread;
+}
+
+/// Result of a read performed on the I/O thread
+struct PendingRead {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+
+    ResultCode result = RESULT_SUCCESS;
+    u32 length = 0;
+    std::vector<u8> data;
+
+    void Finish(ResultVal<std::size_t> read) {
+        {
+            std::scoped_lock lock{mutex};
+            result = read.Code();
+            length = read.Succeeded() ? static_cast<u32>(*read) : 0;
+            done = true;
+        }
+        cv.notify_one();
+    }
+
+    void Wait() {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [this] { return done; });
+    }
+};
+
+} // Anonymous namespace
+
+/**
+ * Completes a File::Read when the client thread wakes up. The data only reaches guest memory at
+ * this point, which is decided by the delay generator alone, so emulation stays deterministic
+ * however long the host read takes.
+ */
+class File::ReadCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    ReadCallback(std::shared_ptr<PendingRead> pending_, u32 buffer_id_)
+        : pending(std::move(pending_)), buffer_id(buffer_id_) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        // Only blocks if the host is slower than the emulated storage
+        pending->Wait();
+
+        auto& buffer = ctx.GetMappedBuffer(buffer_id);
+        IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+        if (pending->result.IsError()) {
+            rb.Push(pending->result);
+            rb.Push<u32>(0);
+        } else {
+            buffer.Write(pending->data.data(), 0, pending->length);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push<u32>(pending->length);
+        }
+        rb.PushMappedBuffer(buffer);
+    }
+
+private:
+    std::shared_ptr<PendingRead> pending;
+    u32 buffer_id = 0;
+
+    ReadCallback() : pending(std::make_shared<PendingRead>()) {}
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& boost::serialization::base_object<Kernel::HLERequestContext::WakeupCallback>(*this);
+        ar& buffer_id;
+        if (Archive::is_saving::value) {
+            pending->Wait();
+        }
+        ar& pending->result.raw;
+        ar& pending->length;
+        ar& pending->data;
+        pending->done = true;
+    }
+    friend class boost::serialization::access;
+};
+
 template <class Archive>
 void File::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
     ar& path;
+    std::scoped_lock lock{backend_mutex};
     ar& backend;
 }
 
@@ -70,28 +196,53 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     // This file session might have a specific offset from where to start reading, apply it.
     offset += file->offset;
 
+    std::unique_lock lock{backend_mutex};
     if (offset + length > backend->GetSize()) {
         LOG_ERROR(Service_FS,
                   "Reading from out of bounds offset=0x{:x} length=0x{:08X} file_size=0x{:x}",
                   offset, length, backend->GetSize());
     }
 
+    const std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
+    if (read_timeout_ns.count() > 0) {
+        // Perform the host read while the client thread sleeps, and reply once it wakes up
+        lock.unlock();
+        auto pending = std::make_shared<PendingRead>();
+        pending->data.resize(length);
+        GetIOThread().Push([self = std::static_pointer_cast<File>(shared_from_this()), pending,
+                            offset] {
+            std::scoped_lock backend_lock{self->backend_mutex};
+            pending->Finish(
+                self->backend->Read(offset, pending->data.size(), pending->data.data()));
+        });
+        ctx.SleepClientThread("file::read", read_timeout_ns,
+                              std::make_shared<ReadCallback>(pending, buffer.GetId()));
+        return;
+    }
+
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
 
-    std::vector<u8> data(length);
-    ResultVal<std::size_t> read = backend->Read(offset, data.size(), data.data());
+    // Read straight into the guest buffer when possible, saving a copy
+    u8* const buffer_ptr = length <= buffer.GetSize()
+                               ? buffer.GetContiguousPointer(0, length)
+                               : nullptr;
+    std::vector<u8> data;
+    if (buffer_ptr == nullptr) {
+        data.resize(length);
+    }
+    ResultVal<std::size_t> read =
+        backend->Read(offset, length, buffer_ptr != nullptr ? buffer_ptr : data.data());
     if (read.Failed()) {
         rb.Push(read.Code());
         rb.Push<u32>(0);
     } else {
-        buffer.Write(data.data(), 0, *read);
+        if (buffer_ptr == nullptr) {
+            buffer.Write(data.data(), 0, *read);
+        }
         rb.Push(RESULT_SUCCESS);
         rb.Push<u32>(static_cast<u32>(*read));
     }
     rb.PushMappedBuffer(buffer);
-
-    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
-    ctx.SleepClientThread("file::read", read_timeout_ns, nullptr);
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
@@ -115,9 +266,18 @@ void File::Write(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    std::vector<u8> data(length);
-    buffer.Read(data.data(), 0, data.size());
-    ResultVal<std::size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
+    // Write straight from the guest buffer when possible, saving a copy
+    const u8* buffer_ptr = length <= buffer.GetSize()
+                               ? buffer.GetContiguousPointer(0, length)
+                               : nullptr;
+    std::vector<u8> data;
+    if (buffer_ptr == nullptr) {
+        data.resize(length);
+        buffer.Read(data.data(), 0, data.size());
+        buffer_ptr = data.data();
+    }
+    std::scoped_lock lock{backend_mutex};
+    ResultVal<std::size_t> written = backend->Write(offset, length, flush != 0, buffer_ptr);
 
     // Update file size
     file->size = backend->GetSize();
@@ -157,6 +317,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
     }
 
     file->size = size;
+    std::scoped_lock lock{backend_mutex};
     backend->SetSize(size);
     rb.Push(RESULT_SUCCESS);
 }
@@ -169,7 +330,10 @@ void File::Close(Kernel::HLERequestContext& ctx) {
         LOG_WARNING(Service_FS, "Closing File backend but {} clients still connected",
                     connected_sessions.size());
 
-    backend->Close();
+    {
+        std::scoped_lock lock{backend_mutex};
+        backend->Close();
+    }
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 }
@@ -187,6 +351,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    std::scoped_lock lock{backend_mutex};
     backend->Flush();
     rb.Push(RESULT_SUCCESS);
 }
@@ -224,6 +389,7 @@ void File::OpenLinkFile(Kernel::HLERequestContext& ctx) {
 
     slot->priority = original_file->priority;
     slot->offset = 0;
+    std::scoped_lock lock{backend_mutex};
     slot->size = backend->GetSize();
     slot->subfile = false;
 
@@ -282,6 +448,7 @@ std::shared_ptr<Kernel::ClientSession> File::Connect() {
     FileSessionSlot* slot = GetSessionData(std::move(server));
     slot->priority = 0;
     slot->offset = 0;
+    std::scoped_lock lock{backend_mutex};
     slot->size = backend->GetSize();
     slot->subfile = false;
 
@@ -301,3 +468,5 @@ std::size_t File::GetSessionFileSize(std::shared_ptr<Kernel::ServerSession> sess
 }
 
 } // namespace Service::FS
+
+SERIALIZE_EXPORT_IMPL(Service::FS::File::ReadCallback)
@@ -10,7 +10,7 @@
 
 namespace Service::GSP {
 
-static std::weak_ptr<GSP_GPU> gsp_gpu;
+static INSTANCE_LOCAL std::weak_ptr<GSP_GPU> gsp_gpu;
 
 void SignalInterrupt(InterruptId interrupt_id) {
     auto gpu = gsp_gpu.lock();
@@ -18,6 +18,12 @@ void SignalInterrupt(InterruptId interrupt_id) {
     return gpu->SignalInterrupt(interrupt_id);
 }
 
+void SignalVBlankInterrupts() {
+    auto gpu = gsp_gpu.lock();
+    ASSERT(gpu != nullptr);
+    gpu->SignalVBlankInterrupts();
+}
+
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
     auto gpu = std::make_shared<GSP_GPU>(system);
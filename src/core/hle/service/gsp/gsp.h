@@ -22,6 +22,9 @@ namespace Service::GSP {
  */
 void SignalInterrupt(InterruptId interrupt_id);
 
+/// Signals the PDC0 and PDC1 interrupts of a VBlank to all registered threads
+void SignalVBlankInterrupts();
+
 void InstallInterfaces(Core::System& system);
 
 void SetGlobalModule(Core::System& system);
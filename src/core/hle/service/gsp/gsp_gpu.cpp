@@ -2,10 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <iterator>
 #include <vector>
 #include "common/archives.h"
 #include "common/bit_field.h"
 #include "common/microprofile.h"
+#include "common/microprofile_trace.h"
 #include "common/swap.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
@@ -19,6 +22,11 @@
 #include "core/hw/hw.h"
 #include "core/hw/lcd.h"
 #include "core/memory.h"
+#include "core/memory_watch.h"
+#include "core/state_hash_log.h"
+#ifdef HAVE_RPC
+#include "core/rpc/rpc_server.h"
+#endif
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/gpu_debugger.h"
 
@@ -87,9 +95,9 @@ u32 GSP_GPU::GetUnusedThreadId() const {
 }
 
 /// Gets a pointer to a thread command buffer in GSP shared memory
-static inline u8* GetCommandBuffer(std::shared_ptr<Kernel::SharedMemory> shared_memory,
-                                   u32 thread_id) {
-    return shared_memory->GetPointer(0x800 + (thread_id * sizeof(CommandBuffer)));
+static inline CommandBuffer* GetCommandBuffer(u8* shared_memory_base, u32 thread_id) {
+    u8* ptr = shared_memory_base + 0x800 + thread_id * sizeof(CommandBuffer);
+    return reinterpret_cast<CommandBuffer*>(ptr);
 }
 
 FrameBufferUpdate* GSP_GPU::GetFrameBufferInfo(u32 thread_id, u32 screen_index) {
@@ -97,14 +105,12 @@ FrameBufferUpdate* GSP_GPU::GetFrameBufferInfo(u32 thread_id, u32 screen_index)
 
     // For each thread there are two FrameBufferUpdate fields
     u32 offset = 0x200 + (2 * thread_id + screen_index) * sizeof(FrameBufferUpdate);
-    u8* ptr = shared_memory->GetPointer(offset);
-    return reinterpret_cast<FrameBufferUpdate*>(ptr);
+    return reinterpret_cast<FrameBufferUpdate*>(shared_memory_base + offset);
 }
 
 /// Gets a pointer to the interrupt relay queue for a given thread index
-static inline InterruptRelayQueue* GetInterruptRelayQueue(
-    std::shared_ptr<Kernel::SharedMemory> shared_memory, u32 thread_id) {
-    u8* ptr = shared_memory->GetPointer(sizeof(InterruptRelayQueue) * thread_id);
+static inline InterruptRelayQueue* GetInterruptRelayQueue(u8* shared_memory_base, u32 thread_id) {
+    u8* ptr = shared_memory_base + sizeof(InterruptRelayQueue) * thread_id;
     return reinterpret_cast<InterruptRelayQueue*>(ptr);
 }
 
@@ -313,7 +319,16 @@ ResultCode SetBufferSwap(u32 screen_id, const FrameBufferInfo& info) {
 
     if (screen_id == 0) {
         MicroProfileFlip();
+        Common::Profiling::OnFrameEnd();
         Core::System::GetInstance().perf_stats->EndGameFrame();
+        Core::System::GetInstance().MemoryWatch().Capture(
+            *Core::System::GetInstance().Kernel().GetCurrentProcess());
+        if (auto state_hash_log = Core::System::GetInstance().StateHashLog()) {
+            state_hash_log->EndGameFrame();
+        }
+#ifdef HAVE_RPC
+        Core::System::GetInstance().RPCServer().OnFrameEnd();
+#endif
     }
 
     return RESULT_SUCCESS;
@@ -411,17 +426,16 @@ void GSP_GPU::UnregisterInterruptRelayQueue(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_GSP, "called");
 }
 
-void GSP_GPU::SignalInterruptForThread(InterruptId interrupt_id, u32 thread_id) {
-    SessionData* session_data = FindRegisteredThreadData(thread_id);
-    if (session_data == nullptr)
-        return;
-
-    auto interrupt_event = session_data->interrupt_event;
+void GSP_GPU::SignalInterruptForThread(InterruptId interrupt_id, const SessionData& session_data) {
+    // Borrow the event from the session rather than copying the shared_ptr on every interrupt
+    Kernel::Event* interrupt_event = session_data.interrupt_event.get();
     if (interrupt_event == nullptr) {
         LOG_WARNING(Service_GSP, "cannot synchronize until GSP event has been created!");
         return;
     }
-    InterruptRelayQueue* interrupt_relay_queue = GetInterruptRelayQueue(shared_memory, thread_id);
+    const u32 thread_id = session_data.thread_id;
+    InterruptRelayQueue* interrupt_relay_queue =
+        GetInterruptRelayQueue(shared_memory_base, thread_id);
     u8 next = interrupt_relay_queue->index;
     next += interrupt_relay_queue->number_interrupts;
     next = next % 0x34; // 0x34 is the number of interrupt slots
@@ -464,8 +478,11 @@ void GSP_GPU::SignalInterrupt(InterruptId interrupt_id) {
     // Normal interrupts are only signaled for the active thread (ie, the thread that has the GPU
     // right), but the PDC0/1 interrupts are signaled for every registered thread.
     if (interrupt_id == InterruptId::PDC0 || interrupt_id == InterruptId::PDC1) {
-        for (u32 thread_id = 0; thread_id < MaxGSPThreads; ++thread_id) {
-            SignalInterruptForThread(interrupt_id, thread_id);
+        for (auto& session_info : connected_sessions) {
+            const auto* data = static_cast<const SessionData*>(session_info.data.get());
+            if (data->registered) {
+                SignalInterruptForThread(interrupt_id, *data);
+            }
         }
         return;
     }
@@ -475,7 +492,24 @@ void GSP_GPU::SignalInterrupt(InterruptId interrupt_id) {
         return;
     }
 
-    SignalInterruptForThread(interrupt_id, active_thread_id);
+    if (const SessionData* session_data = FindRegisteredThreadData(active_thread_id)) {
+        SignalInterruptForThread(interrupt_id, *session_data);
+    }
+}
+
+void GSP_GPU::SignalVBlankInterrupts() {
+    if (nullptr == shared_memory) {
+        LOG_WARNING(Service_GSP, "cannot synchronize until GSP shared memory has been created!");
+        return;
+    }
+
+    for (auto& session_info : connected_sessions) {
+        const auto* data = static_cast<const SessionData*>(session_info.data.get());
+        if (data->registered) {
+            SignalInterruptForThread(InterruptId::PDC0, *data);
+            SignalInterruptForThread(InterruptId::PDC1, *data);
+        }
+    }
 }
 
 MICROPROFILE_DEFINE(GPU_GSP_DMA, "GPU", "GSP DMA", MP_RGB(100, 0, 255));
@@ -635,19 +669,20 @@ void GSP_GPU::TriggerCmdReqQueue(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0xC, 0, 0);
 
     // Iterate through each thread's command queue...
-    for (unsigned thread_id = 0; thread_id < 0x4; ++thread_id) {
-        CommandBuffer* command_buffer = (CommandBuffer*)GetCommandBuffer(shared_memory, thread_id);
-
-        // Iterate through each command...
-        for (unsigned i = 0; i < command_buffer->number_commands; ++i) {
+    for (unsigned thread_id = 0; thread_id < MaxGSPThreads; ++thread_id) {
+        CommandBuffer* command_buffer = GetCommandBuffer(shared_memory_base, thread_id);
+
+        // Execute every command that is pending in the queue as one batch, then mark them all as
+        // completed with a single write to the header
+        const u32 num_commands = std::min<u32>(command_buffer->number_commands,
+                                               std::size(command_buffer->commands));
+        for (u32 i = 0; i < num_commands; ++i) {
             g_debugger.GXCommandProcessed((u8*)&command_buffer->commands[i]);
 
             // Decode and execute command
             ExecuteCommand(command_buffer->commands[i], thread_id);
-
-            // Indicates that command has completed
-            command_buffer->number_commands.Assign(command_buffer->number_commands - 1);
         }
+        command_buffer->number_commands.Assign(0);
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -818,6 +853,7 @@ GSP_GPU::GSP_GPU(Core::System& system) : ServiceFramework("gsp::Gpu", 2), system
                                             MemoryPermission::ReadWrite, 0,
                                             Kernel::MemoryRegion::BASE, "GSP:SharedMemory")
                         .Unwrap();
+    shared_memory_base = shared_memory->GetPointer();
 
     first_initialization = true;
 };
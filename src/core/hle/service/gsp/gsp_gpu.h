@@ -228,6 +228,9 @@ public:
      */
     void SignalInterrupt(InterruptId interrupt_id);
 
+    /// Signals the PDC0 and PDC1 interrupts of a VBlank to every registered thread in one pass
+    void SignalVBlankInterrupts();
+
     /**
      * Retrieves the framebuffer info stored in the GSP shared memory for the
      * specified screen index and thread id.
@@ -243,9 +246,9 @@ private:
      * Signals that the specified interrupt type has occurred to userland code for the specified GSP
      * thread id.
      * @param interrupt_id ID of interrupt that is being signalled.
-     * @param thread_id GSP thread that will receive the interrupt.
+     * @param session_data Registered session of the GSP thread that will receive the interrupt.
      */
-    void SignalInterruptForThread(InterruptId interrupt_id, u32 thread_id);
+    void SignalInterruptForThread(InterruptId interrupt_id, const SessionData& session_data);
 
     /**
      * GSP_GPU::WriteHWRegs service function
@@ -433,6 +436,9 @@ private:
     /// GSP shared memory
     std::shared_ptr<Kernel::SharedMemory> shared_memory;
 
+    /// Host pointer to the start of the shared memory block, which is contiguous
+    u8* shared_memory_base = nullptr;
+
     /// Thread id that currently has GPU rights or UINT32_MAX if none.
     u32 active_thread_id = UINT32_MAX;
 
@@ -450,6 +456,9 @@ private:
     void serialize(Archive& ar, const unsigned int) {
         ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
         ar& shared_memory;
+        if (Archive::is_loading::value) {
+            shared_memory_base = shared_memory->GetPointer();
+        }
         ar& active_thread_id;
         ar& first_initialization;
         ar& used_thread_ids;
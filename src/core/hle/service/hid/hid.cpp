@@ -21,7 +21,9 @@
 #include "core/hle/service/hid/hid_spvr.h"
 #include "core/hle/service/hid/hid_user.h"
 #include "core/hle/service/service.h"
+#include "core/hw/gpu.h"
 #include "core/movie.h"
+#include "core/perf_stats.h"
 #include "video_core/video_core.h"
 
 SERVICE_CONSTRUCT_IMPL(Service::HID::Module)
@@ -49,11 +51,20 @@ void Module::serialize(Archive& ar, const unsigned int file_version) {
     if (file_version >= 1) {
         ar& state.hex;
     }
+    if (file_version >= 2) {
+        ar& pad_synced_to_vblank;
+        ar& vblank_pad_updates_left;
+    }
     // Update events are set in the constructor
     // Devices are set from the implementation (and are stateless afaik)
 }
 SERIALIZE_IMPL(Module)
 
+// Pad updates per frame while they are synced to the VBlanks, about the rate of the free running
+// updates
+constexpr u32 vblank_pad_updates = 4;
+constexpr u64 vblank_pad_update_ticks = GPU::frame_ticks / vblank_pad_updates;
+
 constexpr float accelerometer_coef = 512.0f; // measured from hw test result
 constexpr float gyroscope_coef = 14.375f; // got from hwtest GetGyroscopeLowRawToDpsCoefficient call
 
@@ -105,7 +116,7 @@ void Module::LoadInputDevices() {
     }
 }
 
-void Module::UpdatePadCallback(u64 userdata, s64 cycles_late) {
+void Module::UpdatePad() {
     SharedMem* mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
     if (is_device_reload_pending.exchange(false))
@@ -212,17 +223,56 @@ void Module::UpdatePadCallback(u64 userdata, s64 cycles_late) {
         mem->touch.index_reset_ticks = (s64)system.CoreTiming().GetTicks();
     }
 
+    if (Settings::values.measure_input_latency && system.perf_stats) {
+        // Each state change is measured up to the first update that could have seen it
+        const auto input_change = Input::GetLastStateChange();
+        if (input_change != last_measured_input_change) {
+            last_measured_input_change = input_change;
+            system.perf_stats->RecordInputLatency(Input::Clock::now() - input_change);
+        }
+    }
+
     // Signal both handles when there's an update to Pad or touch
     event_pad_or_touch_1->Signal();
     event_pad_or_touch_2->Signal();
 
     // TODO(xperia64): How the 3D Slider is updated by the HID module needs to be RE'd
     // and possibly moved to its own Core::Timing event.
-    mem->pad.sliderstate_3d = (Settings::values.factor_3d / 100.0f);
-    system.Kernel().GetSharedPageHandler().Set3DSlider(Settings::values.factor_3d / 100.0f);
+    const float slider_state = Settings::Get3DSliderState();
+    mem->pad.sliderstate_3d = slider_state;
+    system.Kernel().GetSharedPageHandler().Set3DSlider(slider_state);
+}
 
-    // Reschedule recurrent event
-    system.CoreTiming().ScheduleEvent(pad_update_ticks - cycles_late, pad_update_event);
+void Module::UpdatePadCallback(u64 userdata, s64 cycles_late) {
+    UpdatePad();
+
+    // Reschedule recurrent event. While synced, the VBlank performs the last update of the frame.
+    if (!pad_synced_to_vblank) {
+        system.CoreTiming().ScheduleEvent(pad_update_ticks - cycles_late, pad_update_event);
+    } else if (vblank_pad_updates_left > 0 && --vblank_pad_updates_left > 0) {
+        system.CoreTiming().ScheduleEvent(vblank_pad_update_ticks - cycles_late,
+                                          pad_update_event);
+    }
+}
+
+void Module::OnVBlank(s64 cycles_late) {
+    Core::Timing& timing = system.CoreTiming();
+    if (!Settings::values.sync_input_to_vblank) {
+        if (pad_synced_to_vblank) {
+            pad_synced_to_vblank = false;
+            timing.UnscheduleEvent(pad_update_event, 0);
+            timing.ScheduleEvent(pad_update_ticks - cycles_late, pad_update_event);
+        }
+        return;
+    }
+
+    // Everything is driven by the emulated clock, so recordings stay deterministic as long as
+    // they are played back with the same setting
+    pad_synced_to_vblank = true;
+    timing.UnscheduleEvent(pad_update_event, 0);
+    UpdatePad();
+    vblank_pad_updates_left = vblank_pad_updates - 1;
+    timing.ScheduleEvent(vblank_pad_update_ticks - cycles_late, pad_update_event);
 }
 
 void Module::UpdateAccelerometerCallback(u64 userdata, s64 cycles_late) {
@@ -298,6 +298,14 @@ public:
 
     void ReloadInputDevices();
 
+    /**
+     * Called at every VBlank. While Settings::values.sync_input_to_vblank is set, the pad is
+     * updated right away and the following pad updates of the frame are spread evenly up to the
+     * next VBlank, so games reading the pad once they are woken by the VBlank interrupt see the
+     * latest input.
+     */
+    void OnVBlank(s64 cycles_late);
+
     const PadState& GetState() const;
 
     // Updating period for each HID device. These empirical values are measured from a 11.2 3DS.
@@ -307,6 +315,7 @@ public:
 
 private:
     void LoadInputDevices();
+    void UpdatePad();
     void UpdatePadCallback(u64 userdata, s64 cycles_late);
     void UpdateAccelerometerCallback(u64 userdata, s64 cycles_late);
     void UpdateGyroscopeCallback(u64 userdata, s64 cycles_late);
@@ -347,6 +356,14 @@ private:
     Core::TimingEventType* accelerometer_update_event;
     Core::TimingEventType* gyroscope_update_event;
 
+    /// Whether the pad updates are currently scheduled from the VBlanks
+    bool pad_synced_to_vblank = false;
+    /// Pad updates left before the next VBlank, while synced to it
+    u32 vblank_pad_updates_left = 0;
+
+    /// Input state change that the latency was last measured for
+    Input::Clock::time_point last_measured_input_change{};
+
     std::atomic<bool> is_device_reload_pending{true};
     std::array<std::unique_ptr<Input::ButtonDevice>, Settings::NativeButton::NUM_BUTTONS_HID>
         buttons;
@@ -367,4 +384,4 @@ void InstallInterfaces(Core::System& system);
 
 SERVICE_CONSTRUCT(Service::HID::Module)
 BOOST_CLASS_EXPORT_KEY(Service::HID::Module)
-BOOST_CLASS_VERSION(Service::HID::Module, 1)
+BOOST_CLASS_VERSION(Service::HID::Module, 2)
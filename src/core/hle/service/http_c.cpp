@@ -2,15 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
+#include <thread>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <fmt/format.h>
 #include "common/archives.h"
 #include "common/assert.h"
+#include "common/scope_exit.h"
+#include "common/thread.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/file_sys/archive_ncch.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/ipc.h"
 #include "core/hle/romfs.h"
 #include "core/hle/service/fs/archive.h"
@@ -18,13 +26,16 @@
 #include "core/hw/aes/key.h"
 
 SERIALIZE_EXPORT_IMPL(Service::HTTP::HTTP_C)
+SERIALIZE_EXPORT_IMPL(Service::HTTP::HTTP_C::SuspendedCallCallback)
 SERIALIZE_EXPORT_IMPL(Service::HTTP::SessionData)
+SERVICE_CONSTRUCT_IMPL(Service::HTTP::HTTP_C)
 
 namespace Service::HTTP {
 
 namespace ErrCodes {
 enum {
     InvalidRequestState = 22,
+    DownloadPending = 43,
     TooManyContexts = 26,
     InvalidRequestMethod = 32,
     ContextNotFound = 100,
@@ -33,6 +44,7 @@ enum {
     /// already-initialized session, or when using the wrong context handle in a context-bound
     /// session
     SessionStateError = 102,
+    Timeout = 105,
     TooManyClientCerts = 203,
     NotImplemented = 1012,
 };
@@ -53,25 +65,179 @@ const ResultCode ERROR_WRONG_CERT_HANDLE = // 0xD8A0A0C9
     ResultCode(201, ErrorModule::HTTP, ErrorSummary::InvalidState, ErrorLevel::Permanent);
 const ResultCode ERROR_CERT_ALREADY_SET = // 0xD8A0A03D
     ResultCode(61, ErrorModule::HTTP, ErrorSummary::InvalidState, ErrorLevel::Permanent);
+const ResultCode ERROR_DOWNLOAD_PENDING = // 0xD840A02B
+    ResultCode(ErrCodes::DownloadPending, ErrorModule::HTTP, ErrorSummary::WouldBlock,
+               ErrorLevel::Permanent);
+const ResultCode ERROR_TIMEOUT = // 0xD820A069
+    ResultCode(ErrCodes::Timeout, ErrorModule::HTTP, ErrorSummary::NothingHappened,
+               ErrorLevel::Permanent);
+
+namespace {
+
+/// Number of requests running at the same time, like the worker threads of the HTTP sysmodule
+constexpr std::size_t NumRequestWorkers = 3;
+
+/// Amount of response data buffered for the guest before a request stops receiving
+constexpr std::size_t MaxBufferedData = 1024 * 1024;
+
+/// How often, in emulated time, suspended calls are checked while any call is suspended
+constexpr s64 WakeCheckPeriod = msToCycles(1);
+
+/**
+ * Runs HTTP requests on a few worker threads, so that neither the emulation thread nor a thread
+ * per request waits for the network.
+ */
+class RequestWorkers {
+public:
+    ~RequestWorkers() {
+        {
+            std::scoped_lock lock{mutex};
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::future<void> Push(std::function<void()> request) {
+        std::packaged_task<void()> task{std::move(request)};
+        auto future = task.get_future();
+        {
+            std::scoped_lock lock{mutex};
+            tasks.push_back(std::move(task));
+            while (threads.size() < NumRequestWorkers) {
+                threads.emplace_back(&RequestWorkers::Loop, this);
+            }
+        }
+        cv.notify_one();
+        return future;
+    }
+
+private:
+    void Loop() {
+        Common::SetCurrentThreadName("HTTP worker");
+        std::unique_lock lock{mutex};
+        while (true) {
+            cv.wait(lock, [this] { return stop || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::packaged_task<void()>> tasks;
+    bool stop = false;
+};
+
+RequestWorkers& GetRequestWorkers() {
+    static RequestWorkers workers;
+    return workers;
+}
+
+#ifdef ENABLE_WEB_SERVICE
+/// Maximum number of idle connections kept open
+constexpr std::size_t MaxIdleClients = 8;
+
+/// Keeps the connections of finished requests open, for the next requests to the same host
+class ClientPool {
+public:
+    std::unique_ptr<httplib::Client> Acquire(const std::string& key) {
+        std::scoped_lock lock{mutex};
+        const auto itr = idle_clients.find(key);
+        if (itr == idle_clients.end()) {
+            return nullptr;
+        }
+        auto client = std::move(itr->second);
+        idle_clients.erase(itr);
+        return client;
+    }
+
+    void Release(const std::string& key, std::unique_ptr<httplib::Client> client) {
+        std::scoped_lock lock{mutex};
+        if (idle_clients.size() < MaxIdleClients) {
+            idle_clients.emplace(key, std::move(client));
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_multimap<std::string, std::unique_ptr<httplib::Client>> idle_clients;
+};
+
+ClientPool& GetClientPool() {
+    static ClientPool pool;
+    return pool;
+}
+
+/// Returns the scheme, host and port part of the URL
+std::string GetSchemeHostPort(const std::string& url) {
+    const std::size_t scheme_end = url.find("://");
+    const std::size_t host_begin = scheme_end == std::string::npos ? 0 : scheme_end + 3;
+    return url.substr(0, url.find_first_of("/?#", host_begin));
+}
+#endif
+
+} // Anonymous namespace
+
+Context::~Context() {
+    Cancel();
+    if (request_future.valid()) {
+        request_future.wait();
+    }
+}
+
+void Context::Cancel() {
+    {
+        std::scoped_lock lock{data_mutex};
+        cancelled = true;
+    }
+    data_cv.notify_all();
+}
 
 void Context::MakeRequest() {
     ASSERT(state == RequestState::NotStarted);
 
 #ifdef ENABLE_WEB_SERVICE
-    std::unique_ptr<httplib::Client> client = std::make_unique<httplib::Client>(url.c_str());
-    SSL_CTX* ctx = client->ssl_context();
-    if (ctx) {
-        if (auto client_cert = ssl_config.client_cert_ctx.lock()) {
-            SSL_CTX_use_certificate_ASN1(ctx, static_cast<int>(client_cert->certificate.size()),
-                                         client_cert->certificate.data());
-            SSL_CTX_use_PrivateKey_ASN1(EVP_PKEY_RSA, ctx, client_cert->private_key.data(),
-                                        static_cast<long>(client_cert->private_key.size()));
-        }
+    if (cancelled) {
+        state = RequestState::TimedOut;
+        download_finished = true;
+        return;
+    }
 
-        // TODO(B3N30): Check for SSLOptions-Bits and set the verify method accordingly
-        // https://www.3dbrew.org/wiki/SSL_Services#SSLOpt
-        // Hack: Since for now RootCerts are not implemented we set the VerifyMode to None.
-        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+    // Connections are only shared between requests with the same client certificate
+    const std::string scheme_host_port = GetSchemeHostPort(url);
+    const auto client_cert = ssl_config.client_cert_ctx.lock();
+    const std::string pool_key =
+        client_cert ? fmt::format("{}#{}", scheme_host_port, client_cert->handle)
+                    : scheme_host_port;
+    std::unique_ptr<httplib::Client> client = GetClientPool().Acquire(pool_key);
+    if (!client) {
+        client = std::make_unique<httplib::Client>(scheme_host_port.c_str());
+        client->set_keep_alive(true);
+        SSL_CTX* ctx = client->ssl_context();
+        if (ctx) {
+            if (client_cert) {
+                SSL_CTX_use_certificate_ASN1(ctx,
+                                             static_cast<int>(client_cert->certificate.size()),
+                                             client_cert->certificate.data());
+                SSL_CTX_use_PrivateKey_ASN1(EVP_PKEY_RSA, ctx, client_cert->private_key.data(),
+                                            static_cast<long>(client_cert->private_key.size()));
+            }
+
+            // TODO(B3N30): Check for SSLOptions-Bits and set the verify method accordingly
+            // https://www.3dbrew.org/wiki/SSL_Services#SSLOpt
+            // Hack: Since for now RootCerts are not implemented we set the VerifyMode to None.
+            SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+        }
     }
 
     state = RequestState::InProgress;
@@ -88,10 +254,22 @@ void Context::MakeRequest() {
     request.method = request_method_strings.at(method);
     request.path = url;
     // TODO(B3N30): Add post data body
-    request.progress = [this](u64 current, u64 total) -> bool {
-        // TODO(B3N30): Is there a state that shows response header are available
-        current_download_size_bytes = current;
-        total_download_size_bytes = total;
+    request.response_handler = [this](const httplib::Response&) -> bool {
+        // TODO(B3N30): Verify this state on HW
+        state = RequestState::ReadyToDownloadContent;
+        return !cancelled;
+    };
+    // The guest reads the content while it is downloaded
+    request.content_receiver = [this](const char* data, std::size_t data_length, u64 offset,
+                                      u64 total_length) -> bool {
+        std::unique_lock lock{data_mutex};
+        data_cv.wait(lock, [this] { return cancelled || received_data.size() < MaxBufferedData; });
+        if (cancelled) {
+            return false;
+        }
+        received_data.insert(received_data.end(), data, data + data_length);
+        current_download_size_bytes = offset + data_length;
+        total_download_size_bytes = total_length;
         return true;
     };
 
@@ -106,11 +284,121 @@ void Context::MakeRequest() {
         LOG_DEBUG(Service_HTTP, "Request successful");
         // TODO(B3N30): Verify this state on HW
         state = RequestState::ReadyToDownloadContent;
+        GetClientPool().Release(pool_key, std::move(client));
     }
 #else
     LOG_ERROR(Service_HTTP, "Tried to make request but WebServices is not enabled in this build");
     state = RequestState::TimedOut;
 #endif
+    download_finished = true;
+}
+
+/// Replies to a suspended call once its client thread woke up
+class HTTP_C::SuspendedCallCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    explicit SuspendedCallCallback(std::shared_ptr<HTTP_C> http_) : http(std::move(http_)) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        http->ResumeCall(ctx, event);
+    }
+
+    /// The event the client thread sleeps on
+    std::shared_ptr<Kernel::Event> event;
+
+private:
+    std::shared_ptr<HTTP_C> http;
+
+    SuspendedCallCallback() = default;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& boost::serialization::base_object<Kernel::HLERequestContext::WakeupCallback>(*this);
+        ar& http;
+        ar& event;
+    }
+    friend class boost::serialization::access;
+};
+
+template <class Archive>
+void HTTP_C::SuspendedCall::serialize(Archive& ar, const unsigned int) {
+    ar& context_handle;
+    ar& wanted_data;
+    ar& event;
+}
+
+void HTTP_C::SuspendCall(Kernel::HLERequestContext& ctx, const char* reason,
+                         Context::Handle context_handle, u32 wanted_data,
+                         std::chrono::nanoseconds timeout) {
+    if (suspended_calls.empty()) {
+        system.CoreTiming().UnscheduleEvent(wake_event, 0);
+        system.CoreTiming().ScheduleEvent(WakeCheckPeriod, wake_event);
+    }
+    auto callback = std::make_shared<SuspendedCallCallback>(
+        std::static_pointer_cast<HTTP_C>(shared_from_this()));
+    callback->event = ctx.SleepClientThread(reason, timeout, callback);
+    suspended_calls.push_back({context_handle, wanted_data, callback->event});
+}
+
+void HTTP_C::ResumeCall(Kernel::HLERequestContext& ctx,
+                        const std::shared_ptr<Kernel::Event>& event) {
+    // A call that timed out is still in the list
+    suspended_calls.erase(std::remove_if(suspended_calls.begin(), suspended_calls.end(),
+                                         [&event](const SuspendedCall& call) {
+                                             return call.event == event;
+                                         }),
+                          suspended_calls.end());
+
+    resuming = true;
+    SCOPE_EXIT({ resuming = false; });
+    switch (ctx.CommandBuffer()[0] >> 16) {
+    case 0x9:
+        BeginRequest(ctx);
+        break;
+    case 0xB:
+        ReceiveData(ctx);
+        break;
+    case 0xC:
+        ReceiveDataTimeout(ctx);
+        break;
+    default:
+        UNREACHABLE_MSG("Unexpected suspended call 0x{:08X}", ctx.CommandBuffer()[0]);
+    }
+}
+
+bool HTTP_C::IsReady(const SuspendedCall& call) {
+    const auto itr = contexts.find(call.context_handle);
+    if (itr == contexts.end() || itr->second.download_finished) {
+        return true;
+    }
+    Context& http_context = itr->second;
+    if (call.wanted_data == 0) {
+        return http_context.state == RequestState::ReadyToDownloadContent;
+    }
+    std::scoped_lock lock{http_context.data_mutex};
+    return http_context.received_data.size() >= call.wanted_data;
+}
+
+void HTTP_C::WakeReadyCalls(u64 userdata, s64 cycles_late) {
+    // Signaling runs the wakeup callbacks, so the ready calls are taken out of the list first
+    std::vector<std::shared_ptr<Kernel::Event>> ready_events;
+    std::vector<SuspendedCall> still_suspended;
+    for (auto& call : suspended_calls) {
+        if (IsReady(call)) {
+            ready_events.push_back(std::move(call.event));
+        } else {
+            still_suspended.push_back(std::move(call));
+        }
+    }
+    suspended_calls = std::move(still_suspended);
+
+    for (const auto& event : ready_events) {
+        event->Signal();
+    }
+
+    if (!suspended_calls.empty()) {
+        system.CoreTiming().ScheduleEvent(WakeCheckPeriod - cycles_late, wake_event);
+    }
 }
 
 void HTTP_C::Initialize(Kernel::HLERequestContext& ctx) {
@@ -182,6 +470,12 @@ void HTTP_C::BeginRequest(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x9, 1, 0);
     const Context::Handle context_handle = rp.Pop<u32>();
 
+    if (resuming) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+        rb.Push(RESULT_SUCCESS);
+        return;
+    }
+
     LOG_WARNING(Service_HTTP, "(STUBBED) called, context_id={}", context_handle);
 
     auto* session_data = GetSessionData(ctx.Session());
@@ -222,13 +516,11 @@ void HTTP_C::BeginRequest(Kernel::HLERequestContext& ctx) {
     // trying to enqueue any more will either fail (BeginRequestAsync), or block (BeginRequest)
     // Note that you only can have 8 Contexts at a time. So this difference shouldn't matter
     // Then there are 3? worker threads that pop the requests from the queue and send them
-    // For now make every request async in it's own thread.
-
     itr->second.request_future =
-        std::async(std::launch::async, &Context::MakeRequest, std::ref(itr->second));
+        GetRequestWorkers().Push([&http_context = itr->second] { http_context.MakeRequest(); });
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(RESULT_SUCCESS);
+    // BeginRequest returns once the response headers arrived, only the client thread waits
+    SuspendCall(ctx, "http::begin_request", context_handle, 0, std::chrono::nanoseconds{0});
 }
 
 void HTTP_C::BeginRequestAsync(Kernel::HLERequestContext& ctx) {
@@ -275,15 +567,119 @@ void HTTP_C::BeginRequestAsync(Kernel::HLERequestContext& ctx) {
     // trying to enqueue any more will either fail (BeginRequestAsync), or block (BeginRequest)
     // Note that you only can have 8 Contexts at a time. So this difference shouldn't matter
     // Then there are 3? worker threads that pop the requests from the queue and send them
-    // For now make every request async in it's own thread.
-
     itr->second.request_future =
-        std::async(std::launch::async, &Context::MakeRequest, std::ref(itr->second));
+        GetRequestWorkers().Push([&http_context = itr->second] { http_context.MakeRequest(); });
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 }
 
+void HTTP_C::ReceiveData(Kernel::HLERequestContext& ctx) {
+    ReceiveDataImpl(ctx, false);
+}
+
+void HTTP_C::ReceiveDataTimeout(Kernel::HLERequestContext& ctx) {
+    ReceiveDataImpl(ctx, true);
+}
+
+void HTTP_C::ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout) {
+    IPC::RequestParser rp(ctx, timeout ? 0xC : 0xB, timeout ? 4 : 2, 2);
+    const Context::Handle context_handle = rp.Pop<u32>();
+    const u32 buffer_size = rp.Pop<u32>();
+    const u64 timeout_nanos = timeout ? rp.Pop<u64>() : 0;
+    auto& buffer = rp.PopMappedBuffer();
+
+    LOG_DEBUG(Service_HTTP, "called, context_id={} buffer_size={} timeout={}", context_handle,
+              buffer_size, timeout_nanos);
+
+    auto itr = contexts.find(context_handle);
+    if (itr == contexts.end()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(ResultCode(ErrCodes::ContextNotFound, ErrorModule::HTTP, ErrorSummary::InvalidState,
+                           ErrorLevel::Permanent));
+        rb.PushMappedBuffer(buffer);
+        return;
+    }
+    Context& http_context = itr->second;
+
+    if (http_context.state == RequestState::NotStarted) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(ResultCode(ErrCodes::InvalidRequestState, ErrorModule::HTTP,
+                           ErrorSummary::InvalidState, ErrorLevel::Permanent));
+        rb.PushMappedBuffer(buffer);
+        return;
+    }
+
+    std::unique_lock lock{http_context.data_mutex};
+    const bool finished = http_context.download_finished;
+    auto& received_data = http_context.received_data;
+    if (!resuming && !finished && received_data.size() < buffer_size &&
+        (!timeout || timeout_nanos > 0)) {
+        // Wait for the data with the client thread suspended
+        lock.unlock();
+        SuspendCall(ctx, timeout ? "http::receive_data_timeout" : "http::receive_data",
+                    context_handle, buffer_size, std::chrono::nanoseconds{timeout_nanos});
+        return;
+    }
+
+    // Hand over the data received so far, which lets the request receive more
+    const std::size_t size = std::min<std::size_t>(buffer_size, received_data.size());
+    buffer.Write(received_data.data(), 0, size);
+    received_data.erase(received_data.begin(), received_data.begin() + size);
+    const bool all_received = finished && received_data.empty();
+    lock.unlock();
+    http_context.data_cv.notify_all();
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+    if (all_received) {
+        rb.Push(RESULT_SUCCESS);
+    } else if (size == buffer_size) {
+        rb.Push(ERROR_DOWNLOAD_PENDING);
+    } else {
+        rb.Push(ERROR_TIMEOUT);
+    }
+    rb.PushMappedBuffer(buffer);
+}
+
+void HTTP_C::GetRequestState(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x5, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_id={}", context_handle);
+
+    auto itr = contexts.find(context_handle);
+    if (itr == contexts.end()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+        rb.Push(ResultCode(ErrCodes::ContextNotFound, ErrorModule::HTTP, ErrorSummary::InvalidState,
+                           ErrorLevel::Permanent));
+        return;
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
+    rb.Push(RESULT_SUCCESS);
+    rb.PushEnum<RequestState>(itr->second.state);
+}
+
+void HTTP_C::GetDownloadSizeState(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x6, 1, 0);
+    const Context::Handle context_handle = rp.Pop<u32>();
+
+    LOG_DEBUG(Service_HTTP, "called, context_id={}", context_handle);
+
+    auto itr = contexts.find(context_handle);
+    if (itr == contexts.end()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+        rb.Push(ResultCode(ErrCodes::ContextNotFound, ErrorModule::HTTP, ErrorSummary::InvalidState,
+                           ErrorLevel::Permanent));
+        return;
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(3, 0);
+    rb.Push(RESULT_SUCCESS);
+    rb.Push(static_cast<u32>(itr->second.current_download_size_bytes));
+    rb.Push(static_cast<u32>(itr->second.total_download_size_bytes));
+}
+
 void HTTP_C::CreateContext(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x2, 2, 2);
     const u32 url_size = rp.Pop<u32>();
@@ -389,7 +785,7 @@ void HTTP_C::CloseContext(Kernel::HLERequestContext& ctx) {
     // TODO(Subv): What happens if you try to close a context that's currently being used?
     // TODO(Subv): Make sure that only the session that created the context can close it.
 
-    // Note that this will block if a request is still in progress
+    // Note that this waits for a request in progress to stop at its next chunk of data
     contexts.erase(itr);
     session_data->num_http_contexts--;
 
@@ -866,20 +1262,20 @@ void HTTP_C::DecryptClCertA() {
     ClCertA.init = true;
 }
 
-HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
+HTTP_C::HTTP_C(Core::System& system) : ServiceFramework("http:C", 32), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010044, &HTTP_C::Initialize, "Initialize"},
         {0x00020082, &HTTP_C::CreateContext, "CreateContext"},
         {0x00030040, &HTTP_C::CloseContext, "CloseContext"},
         {0x00040040, nullptr, "CancelConnection"},
-        {0x00050040, nullptr, "GetRequestState"},
-        {0x00060040, nullptr, "GetDownloadSizeState"},
+        {0x00050040, &HTTP_C::GetRequestState, "GetRequestState"},
+        {0x00060040, &HTTP_C::GetDownloadSizeState, "GetDownloadSizeState"},
         {0x00070040, nullptr, "GetRequestError"},
         {0x00080042, &HTTP_C::InitializeConnectionSession, "InitializeConnectionSession"},
         {0x00090040, &HTTP_C::BeginRequest, "BeginRequest"},
         {0x000A0040, &HTTP_C::BeginRequestAsync, "BeginRequestAsync"},
-        {0x000B0082, nullptr, "ReceiveData"},
-        {0x000C0102, nullptr, "ReceiveDataTimeout"},
+        {0x000B0082, &HTTP_C::ReceiveData, "ReceiveData"},
+        {0x000C0102, &HTTP_C::ReceiveDataTimeout, "ReceiveDataTimeout"},
         {0x000D0146, nullptr, "SetProxy"},
         {0x000E0040, nullptr, "SetProxyDefault"},
         {0x000F00C4, nullptr, "SetBasicAuthorization"},
@@ -927,11 +1323,15 @@ HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
     };
     RegisterHandlers(functions);
 
+    wake_event = system.CoreTiming().RegisterEvent(
+        "HTTP_C::WakeReadyCalls",
+        [this](u64 userdata, s64 cycles_late) { WakeReadyCalls(userdata, cycles_late); });
+
     DecryptClCertA();
 }
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<HTTP_C>()->InstallAsService(service_manager);
+    std::make_shared<HTTP_C>(system)->InstallAsService(service_manager);
 }
 } // namespace Service::HTTP
@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -28,6 +32,11 @@
 
 namespace Core {
 class System;
+struct TimingEventType;
+} // namespace Core
+
+namespace Kernel {
+class Event;
 }
 
 namespace Service::HTTP {
@@ -121,8 +130,14 @@ public:
     Context(const Context&) = delete;
     Context& operator=(const Context&) = delete;
 
+    /// Cancels the request, and waits for the worker running it to let go of the context
+    ~Context();
+
     void MakeRequest();
 
+    /// Makes the request stop at the next chunk of data it receives
+    void Cancel();
+
     struct Proxy {
         std::string url;
         std::string username;
@@ -213,6 +228,16 @@ public:
     std::future<void> request_future;
     std::atomic<u64> current_download_size_bytes;
     std::atomic<u64> total_download_size_bytes;
+
+    /// Set once the request completed or failed, after which no more data is received
+    std::atomic<bool> download_finished = false;
+    std::atomic<bool> cancelled = false;
+
+    /// Response data received from the host and not read by the guest yet. The request waits on
+    /// data_cv while too much of it is buffered.
+    std::mutex data_mutex;
+    std::condition_variable data_cv;
+    std::vector<u8> received_data;
 #ifdef ENABLE_WEB_SERVICE
     httplib::Response response;
 #endif
@@ -250,9 +275,24 @@ private:
 
 class HTTP_C final : public ServiceFramework<HTTP_C, SessionData> {
 public:
-    HTTP_C();
+    explicit HTTP_C(Core::System& system);
+
+    class SuspendedCallCallback;
 
 private:
+    /// A guest thread waiting for a request in progress, and the event that resumes it
+    struct SuspendedCall {
+        Context::Handle context_handle;
+        /// Amount of received data the call waits for, or 0 to wait for the response headers
+        u32 wanted_data;
+        std::shared_ptr<Kernel::Event> event;
+
+    private:
+        template <class Archive>
+        void serialize(Archive& ar, const unsigned int);
+        friend class boost::serialization::access;
+    };
+
     /**
      * HTTP_C::Initialize service function
      *  Inputs:
@@ -317,6 +357,62 @@ private:
      */
     void BeginRequestAsync(Kernel::HLERequestContext& ctx);
 
+    /**
+     * HTTP_C::ReceiveData service function
+     *  Inputs:
+     *      1 : Context handle
+     *      2 : Buffer size
+     *      3 : (OutSize<<4) | 12
+     *      4 : Buffer address
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : (OutSize<<4) | 12
+     *      3 : Buffer address
+     */
+    void ReceiveData(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::ReceiveDataTimeout service function
+     *  Inputs:
+     *      1 : Context handle
+     *      2 : Buffer size
+     *    3-4 : u64 nanoseconds timeout
+     *      5 : (OutSize<<4) | 12
+     *      6 : Buffer address
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : (OutSize<<4) | 12
+     *      3 : Buffer address
+     */
+    void ReceiveDataTimeout(Kernel::HLERequestContext& ctx);
+
+    /**
+     * ReceiveDataImpl:
+     * Implements ReceiveData and ReceiveDataTimeout service functions
+     */
+    void ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout);
+
+    /**
+     * HTTP_C::GetRequestState service function
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : Request state
+     */
+    void GetRequestState(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::GetDownloadSizeState service function
+     *  Inputs:
+     *      1 : Context handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     *      2 : Total content data downloaded so far
+     *      3 : Total content size from the "Content-Length" response header
+     */
+    void GetDownloadSizeState(Kernel::HLERequestContext& ctx);
+
     /**
      * HTTP_C::AddRequestHeader service function
      *  Inputs:
@@ -410,6 +506,32 @@ private:
 
     void DecryptClCertA();
 
+    /**
+     * Suspends the client thread until the request of the context received wanted_data bytes,
+     * its response headers if wanted_data is 0, or finished. A zero timeout waits forever. The
+     * request handler then runs again, with resuming set, to reply.
+     */
+    void SuspendCall(Kernel::HLERequestContext& ctx, const char* reason,
+                     Context::Handle context_handle, u32 wanted_data,
+                     std::chrono::nanoseconds timeout);
+
+    /// Runs the request handler of a suspended call again, once its client thread woke up
+    void ResumeCall(Kernel::HLERequestContext& ctx, const std::shared_ptr<Kernel::Event>& event);
+
+    /// Returns whether the request a suspended call waits for got far enough
+    bool IsReady(const SuspendedCall& call);
+
+    /// Signals the suspended calls whose request got far enough
+    void WakeReadyCalls(u64 userdata, s64 cycles_late);
+
+    Core::System& system;
+    Core::TimingEventType* wake_event;
+
+    std::vector<SuspendedCall> suspended_calls;
+
+    /// Set while the handler of a suspended call runs again, which must then not wait
+    bool resuming = false;
+
     std::shared_ptr<Kernel::SharedMemory> shared_memory = nullptr;
 
     /// The next number to use when a new HTTP session is initalized.
@@ -446,6 +568,7 @@ private:
         ar& context_counter;
         ar& client_certs_counter;
         ar& client_certs;
+        ar& suspended_calls;
         // NOTE: `contexts` is not serialized because it contains non-serializable data. (i.e.
         // handles to ongoing HTTP requests.) Serializing across HTTP contexts will break.
     }
@@ -457,4 +580,6 @@ void InstallInterfaces(Core::System& system);
 } // namespace Service::HTTP
 
 BOOST_CLASS_EXPORT_KEY(Service::HTTP::HTTP_C)
+BOOST_CLASS_EXPORT_KEY(Service::HTTP::HTTP_C::SuspendedCallCallback)
 BOOST_CLASS_EXPORT_KEY(Service::HTTP::SessionData)
+SERVICE_CONSTRUCT(Service::HTTP::HTTP_C)
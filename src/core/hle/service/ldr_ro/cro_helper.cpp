@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/alignment.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
@@ -21,6 +22,51 @@ static ResultCode CROFormatError(u32 description) {
                       ErrorSummary::WrongArgument, ErrorLevel::Permanent);
 }
 
+namespace {
+
+/**
+ * Merges the CPU cache invalidations of relocated words into runs of contiguous words. Words inside
+ * the deferred range are skipped.
+ */
+class InvalidationBatch {
+public:
+    InvalidationBatch(Core::System& system, VAddr deferred_begin, VAddr deferred_end)
+        : system(system), deferred_begin(deferred_begin), deferred_end(deferred_end) {}
+
+    ~InvalidationBatch() {
+        Flush();
+    }
+
+    void Add(VAddr address) {
+        if (address >= deferred_begin && address < deferred_end) {
+            return;
+        }
+        if (size != 0 && address == start + size) {
+            size += sizeof(u32);
+            return;
+        }
+        Flush();
+        start = address;
+        size = sizeof(u32);
+    }
+
+private:
+    void Flush() {
+        if (size != 0) {
+            system.InvalidateCacheRange(start, size);
+            size = 0;
+        }
+    }
+
+    Core::System& system;
+    const VAddr deferred_begin;
+    const VAddr deferred_end;
+    VAddr start = 0;
+    u32 size = 0;
+};
+
+} // Anonymous namespace
+
 const std::array<int, 17> CROHelper::ENTRY_SIZE{{
     1, // code
     1, // data
@@ -49,13 +95,12 @@ const std::array<CROHelper::HeaderField, 4> CROHelper::FIX_BARRIERS{{
 }};
 
 VAddr CROHelper::SegmentTagToAddress(SegmentTag segment_tag) const {
-    u32 segment_num = GetField(SegmentNum);
+    const std::vector<SegmentEntry>& segment_table = GetSegments();
 
-    if (segment_tag.segment_index >= segment_num)
+    if (segment_tag.segment_index >= segment_table.size())
         return 0;
 
-    SegmentEntry entry;
-    GetEntry(system.Memory(), segment_tag.segment_index, entry);
+    const SegmentEntry& entry = segment_table[segment_tag.segment_index];
 
     if (segment_tag.offset_into_segment >= entry.size)
         return 0;
@@ -63,6 +108,16 @@ VAddr CROHelper::SegmentTagToAddress(SegmentTag segment_tag) const {
     return entry.offset + segment_tag.offset_into_segment;
 }
 
+const std::vector<CROHelper::SegmentEntry>& CROHelper::GetSegments() const {
+    u32 segment_num = GetField(SegmentNum);
+    if (segments.size() != segment_num) {
+        segments.resize(segment_num);
+        system.Memory().ReadBlock(process, GetField(SegmentTableOffset), segments.data(),
+                                  segment_num * sizeof(SegmentEntry));
+    }
+    return segments;
+}
+
 ResultCode CROHelper::ApplyRelocation(VAddr target_address, RelocationType relocation_type,
                                       u32 addend, u32 symbol_address, u32 target_future_address) {
 
@@ -72,11 +127,9 @@ ResultCode CROHelper::ApplyRelocation(VAddr target_address, RelocationType reloc
     case RelocationType::AbsoluteAddress:
     case RelocationType::AbsoluteAddress2:
         system.Memory().Write32(target_address, symbol_address + addend);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
         break;
     case RelocationType::RelativeAddress:
         system.Memory().Write32(target_address, symbol_address + addend - target_future_address);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -99,7 +152,6 @@ ResultCode CROHelper::ClearRelocation(VAddr target_address, RelocationType reloc
     case RelocationType::AbsoluteAddress2:
     case RelocationType::RelativeAddress:
         system.Memory().Write32(target_address, 0);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -118,28 +170,38 @@ ResultCode CROHelper::ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool
     if (symbol_address == 0 && !reset)
         return CROFormatError(0x10);
 
+    // Reads the batch in chunks that end at page boundaries, which the batch may not cross from
+    // a mapped page into an unmapped one. An entry straddling a boundary is read on its own.
+    std::array<RelocationEntry, Memory::PAGE_SIZE / sizeof(RelocationEntry)> relocations;
+    InvalidationBatch invalidation(system, deferred_begin, deferred_end);
     VAddr relocation_address = batch;
-    while (true) {
-        RelocationEntry relocation;
-        system.Memory().ReadBlock(process, relocation_address, &relocation,
-                                  sizeof(RelocationEntry));
+    bool batch_end = false;
+    while (!batch_end) {
+        u32 page_left = Memory::PAGE_SIZE - (relocation_address & Memory::PAGE_MASK);
+        std::size_t count = std::max<std::size_t>(page_left / sizeof(RelocationEntry), 1);
+        system.Memory().ReadBlock(process, relocation_address, relocations.data(),
+                                  count * sizeof(RelocationEntry));
+
+        for (std::size_t i = 0; i < count && !batch_end; ++i) {
+            const RelocationEntry& relocation = relocations[i];
+            VAddr relocation_target = SegmentTagToAddress(relocation.target_position);
+            if (relocation_target == 0) {
+                return CROFormatError(0x12);
+            }
 
-        VAddr relocation_target = SegmentTagToAddress(relocation.target_position);
-        if (relocation_target == 0) {
-            return CROFormatError(0x12);
-        }
+            ResultCode result = ApplyRelocation(relocation_target, relocation.type,
+                                                relocation.addend, symbol_address,
+                                                relocation_target);
+            if (result.IsError()) {
+                LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
+                return result;
+            }
+            invalidation.Add(relocation_target);
 
-        ResultCode result = ApplyRelocation(relocation_target, relocation.type, relocation.addend,
-                                            symbol_address, relocation_target);
-        if (result.IsError()) {
-            LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
-            return result;
+            batch_end = relocation.is_batch_end != 0;
         }
 
-        if (relocation.is_batch_end)
-            break;
-
-        relocation_address += sizeof(RelocationEntry);
+        relocation_address += static_cast<u32>(count * sizeof(RelocationEntry));
     }
 
     RelocationEntry relocation;
@@ -153,46 +215,26 @@ VAddr CROHelper::FindExportNamedSymbol(const std::string& name) const {
     if (!GetField(ExportTreeNum))
         return 0;
 
-    std::size_t len = name.size();
-    ExportTreeEntry entry;
-    GetEntry(system.Memory(), 0, entry);
-    ExportTreeEntry::Child next;
-    next.raw = entry.left.raw;
-    u32 found_id;
-
-    while (true) {
-        GetEntry(system.Memory(), next.next_index, entry);
-
-        if (next.is_end) {
-            found_id = entry.export_table_index;
-            break;
-        }
-
-        u16 test_byte = entry.test_bit >> 3;
-        u16 test_bit_in_byte = entry.test_bit & 7;
-
-        if (test_byte >= len) {
-            next.raw = entry.left.raw;
-        } else if ((name[test_byte] >> test_bit_in_byte) & 1) {
-            next.raw = entry.right.raw;
-        } else {
-            next.raw = entry.left.raw;
+    auto cached = export_cache.find(module_address);
+    if (cached == export_cache.end()) {
+        // The export tree only indexes the export table, and a name found in the tree is checked
+        // against its table entry, so looking the name up in the table gives the same symbol
+        std::unordered_map<std::string, VAddr> symbols;
+        u32 export_strings_size = GetField(ExportStringsSize);
+        u32 export_named_symbol_num = GetField(ExportNamedSymbolNum);
+        symbols.reserve(export_named_symbol_num);
+        for (u32 i = 0; i < export_named_symbol_num; ++i) {
+            ExportNamedSymbolEntry symbol_entry;
+            GetEntry(system.Memory(), i, symbol_entry);
+            symbols.emplace(
+                system.Memory().ReadCString(symbol_entry.name_offset, export_strings_size),
+                SegmentTagToAddress(symbol_entry.symbol_position));
         }
+        cached = export_cache.emplace(module_address, std::move(symbols)).first;
     }
 
-    u32 export_named_symbol_num = GetField(ExportNamedSymbolNum);
-
-    if (found_id >= export_named_symbol_num)
-        return 0;
-
-    u32 export_strings_size = GetField(ExportStringsSize);
-    ExportNamedSymbolEntry symbol_entry;
-    GetEntry(system.Memory(), found_id, symbol_entry);
-
-    if (system.Memory().ReadCString(symbol_entry.name_offset, export_strings_size) != name)
-        return 0;
-
-    return SegmentTagToAddress(symbol_entry.symbol_position);
+    auto symbol = cached->second.find(name);
+    return symbol != cached->second.end() ? symbol->second : 0;
 }
 
 ResultCode CROHelper::RebaseHeader(u32 cro_size) {
@@ -301,6 +343,7 @@ ResultVal<VAddr> CROHelper::RebaseSegmentTable(u32 cro_size, VAddr data_segment_
         }
         SetEntry(system.Memory(), i, segment);
     }
+    segments.clear();
     return MakeResult<u32>(prev_data_segment + module_address);
 }
 
@@ -549,7 +592,7 @@ ResultCode CROHelper::ApplyStaticAnonymousSymbolToCRS(VAddr crs_address) {
         static_relocation_table_offset +
         GetField(StaticRelocationNum) * sizeof(StaticRelocationEntry);
 
-    CROHelper crs(crs_address, process, system);
+    CROHelper crs(crs_address, process, system, export_cache);
     u32 offset_export_num = GetField(StaticAnonymousSymbolNum);
     LOG_INFO(Service_LDR, "CRO \"{}\" exports {} static anonymous symbols", ModuleName(),
              offset_export_num);
@@ -576,8 +619,9 @@ ResultCode CROHelper::ApplyStaticAnonymousSymbolToCRS(VAddr crs_address) {
 }
 
 ResultCode CROHelper::ApplyInternalRelocations(u32 old_data_segment_address) {
-    u32 segment_num = GetField(SegmentNum);
+    const std::vector<SegmentEntry>& segment_table = GetSegments();
     u32 internal_relocation_num = GetField(InternalRelocationNum);
+    InvalidationBatch invalidation(system, deferred_begin, deferred_end);
     for (u32 i = 0; i < internal_relocation_num; ++i) {
         InternalRelocationEntry relocation;
         GetEntry(system.Memory(), i, relocation);
@@ -587,8 +631,8 @@ ResultCode CROHelper::ApplyInternalRelocations(u32 old_data_segment_address) {
         }
 
         VAddr target_address;
-        SegmentEntry target_segment;
-        GetEntry(system.Memory(), relocation.target_position.segment_index, target_segment);
+        const SegmentEntry& target_segment =
+            segment_table[relocation.target_position.segment_index];
 
         if (target_segment.type == SegmentType::Data) {
             // If the relocation is to the .data segment, we need to relocate it in the old buffer
@@ -598,12 +642,11 @@ ResultCode CROHelper::ApplyInternalRelocations(u32 old_data_segment_address) {
             target_address = target_addressB;
         }
 
-        if (relocation.symbol_segment >= segment_num) {
+        if (relocation.symbol_segment >= segment_table.size()) {
             return CROFormatError(0x15);
         }
 
-        SegmentEntry symbol_segment;
-        GetEntry(system.Memory(), relocation.symbol_segment, symbol_segment);
+        const SegmentEntry& symbol_segment = segment_table[relocation.symbol_segment];
         LOG_TRACE(Service_LDR, "Internally relocates 0x{:08X} with 0x{:08X}", target_address,
                   symbol_segment.offset);
         ResultCode result = ApplyRelocation(target_address, relocation.type, relocation.addend,
@@ -612,12 +655,14 @@ ResultCode CROHelper::ApplyInternalRelocations(u32 old_data_segment_address) {
             LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
             return result;
         }
+        invalidation.Add(target_address);
     }
     return RESULT_SUCCESS;
 }
 
 ResultCode CROHelper::ClearInternalRelocations() {
     u32 internal_relocation_num = GetField(InternalRelocationNum);
+    InvalidationBatch invalidation(system, deferred_begin, deferred_end);
     for (u32 i = 0; i < internal_relocation_num; ++i) {
         InternalRelocationEntry relocation;
         GetEntry(system.Memory(), i, relocation);
@@ -632,6 +677,7 @@ ResultCode CROHelper::ClearInternalRelocations() {
             LOG_ERROR(Service_LDR, "Error clearing relocation {:08X}", result.raw);
             return result;
         }
+        invalidation.Add(target_address);
     }
     return RESULT_SUCCESS;
 }
@@ -732,6 +778,7 @@ void CROHelper::UnrebaseSegmentTable() {
 
         SetEntry(system.Memory(), i, segment);
     }
+    segments.clear();
 }
 
 void CROHelper::UnrebaseHeader() {
@@ -759,10 +806,11 @@ ResultCode CROHelper::ApplyImportNamedSymbol(VAddr crs_address) {
                                   sizeof(ExternalRelocationEntry));
 
         if (!relocation_entry.is_batch_resolved) {
+            const std::string symbol_name =
+                system.Memory().ReadCString(entry.name_offset, import_strings_size);
             ResultCode result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
-                    std::string symbol_name =
-                        system.Memory().ReadCString(entry.name_offset, import_strings_size);
+                process, system, export_cache, crs_address,
+                [&](CROHelper source) -> ResultVal<bool> {
                     u32 symbol_address = source.FindExportNamedSymbol(symbol_name);
 
                     if (symbol_address != 0) {
@@ -863,7 +911,8 @@ ResultCode CROHelper::ApplyModuleImport(VAddr crs_address) {
             system.Memory().ReadCString(entry.name_offset, import_strings_size);
 
         ResultCode result = ForEachAutoLinkCRO(
-            process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
+            process, system, export_cache, crs_address,
+            [&](CROHelper source) -> ResultVal<bool> {
                 if (want_cro_name == source.ModuleName()) {
                     LOG_INFO(Service_LDR, "CRO \"{}\" imports {} indexed symbols from \"{}\"",
                              ModuleName(), entry.import_indexed_symbol_num, source.ModuleName());
@@ -1076,7 +1125,8 @@ ResultCode CROHelper::ApplyExitRelocations(VAddr crs_address) {
         if (system.Memory().ReadCString(entry.name_offset, import_strings_size) ==
             "__aeabi_atexit") {
             ResultCode result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
+                process, system, export_cache, crs_address,
+                [&](CROHelper source) -> ResultVal<bool> {
                     u32 symbol_address = source.FindExportNamedSymbol("nnroAeabiAtexit_");
 
                     if (symbol_address != 0) {
@@ -1125,6 +1175,8 @@ ResultCode CROHelper::Rebase(VAddr crs_address, u32 cro_size, VAddr data_segment
                              u32 data_segment_size, VAddr bss_segment_address, u32 bss_segment_size,
                              bool is_crs) {
 
+    export_cache.erase(module_address);
+
     ResultCode result = RebaseHeader(cro_size);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error rebasing header {:08X}", result.raw);
@@ -1231,6 +1283,8 @@ ResultCode CROHelper::Rebase(VAddr crs_address, u32 cro_size, VAddr data_segment
 }
 
 void CROHelper::Unrebase(bool is_crs) {
+    export_cache.erase(module_address);
+
     UnrebaseImportAnonymousSymbolTable();
     UnrebaseImportIndexedSymbolTable();
     UnrebaseImportNamedSymbolTable();
@@ -1307,7 +1361,7 @@ ResultCode CROHelper::Link(VAddr crs_address, bool link_on_load_bug_fix) {
     }
 
     // Exports symbols to other modules
-    result = ForEachAutoLinkCRO(process, system, crs_address,
+    result = ForEachAutoLinkCRO(process, system, export_cache, crs_address,
                                 [this](CROHelper target) -> ResultVal<bool> {
                                     ResultCode result = ApplyExportNamedSymbol(target);
                                     if (result.IsError())
@@ -1352,7 +1406,7 @@ ResultCode CROHelper::Unlink(VAddr crs_address) {
 
     // Resets all symbols in other modules imported from this module
     // Note: the RO service seems only searching in auto-link modules
-    result = ForEachAutoLinkCRO(process, system, crs_address,
+    result = ForEachAutoLinkCRO(process, system, export_cache, crs_address,
                                 [this](CROHelper target) -> ResultVal<bool> {
                                     ResultCode result = ResetExportNamedSymbol(target);
                                     if (result.IsError())
@@ -1393,13 +1447,14 @@ void CROHelper::InitCRS() {
 }
 
 void CROHelper::Register(VAddr crs_address, bool auto_link) {
-    CROHelper crs(crs_address, process, system);
-    CROHelper head(auto_link ? crs.NextModule() : crs.PreviousModule(), process, system);
+    CROHelper crs(crs_address, process, system, export_cache);
+    CROHelper head(auto_link ? crs.NextModule() : crs.PreviousModule(), process, system,
+                   export_cache);
 
     if (head.module_address) {
         // there are already CROs registered
         // register as the new tail
-        CROHelper tail(head.PreviousModule(), process, system);
+        CROHelper tail(head.PreviousModule(), process, system, export_cache);
 
         // link with the old tail
         ASSERT(tail.NextModule() == 0);
@@ -1425,11 +1480,11 @@ void CROHelper::Register(VAddr crs_address, bool auto_link) {
 }
 
 void CROHelper::Unregister(VAddr crs_address) {
-    CROHelper crs(crs_address, process, system);
-    CROHelper next_head(crs.NextModule(), process, system);
-    CROHelper previous_head(crs.PreviousModule(), process, system);
-    CROHelper next(NextModule(), process, system);
-    CROHelper previous(PreviousModule(), process, system);
+    CROHelper crs(crs_address, process, system, export_cache);
+    CROHelper next_head(crs.NextModule(), process, system, export_cache);
+    CROHelper previous_head(crs.PreviousModule(), process, system, export_cache);
+    CROHelper next(NextModule(), process, system, export_cache);
+    CROHelper previous(PreviousModule(), process, system, export_cache);
 
     if (module_address == next_head.module_address ||
         module_address == previous_head.module_address) {
@@ -1533,4 +1588,13 @@ std::tuple<VAddr, u32> CROHelper::GetExecutablePages() const {
     return std::make_tuple(0, 0);
 }
 
+std::tuple<VAddr, u32> CROHelper::GetCodeSegment() const {
+    for (const SegmentEntry& entry : GetSegments()) {
+        if (entry.type == SegmentType::Code && entry.size != 0) {
+            return std::make_tuple(entry.offset, entry.size);
+        }
+    }
+    return std::make_tuple(0, 0);
+}
+
 } // namespace Service::LDR
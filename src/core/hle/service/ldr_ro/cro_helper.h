@@ -5,7 +5,11 @@
 #pragma once
 
 #include <array>
+#include <map>
+#include <string>
 #include <tuple>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/result.h"
@@ -29,12 +33,34 @@ namespace Service::LDR {
 static constexpr u32 CRO_HEADER_SIZE = 0x138;
 static constexpr u32 CRO_HASH_SIZE = 0x80;
 
+/**
+ * Host-side tables of the named symbols exported by the loaded modules of a process, keyed by the
+ * module address. A table is built the first time a symbol is looked up in its module, and dropped
+ * when the module is rebased or unrebased.
+ */
+using ExportSymbolCache = std::unordered_map<VAddr, std::unordered_map<std::string, VAddr>>;
+
+/// Code segment of an unloaded module, whose compiled code the CPU cache still holds
+struct RetiredCode {
+    u32 size;
+    u64 hash; ///< hash of the relocated code at the time it was unloaded
+};
+
+/**
+ * Code segments of the unloaded modules of a process, keyed by their address. They are left in the
+ * CPU cache until another module is loaded over them, so that a module reloaded at the same
+ * address keeps its compiled code if its relocated code hashes the same.
+ */
+using RetiredCodeTable = std::map<VAddr, RetiredCode>;
+
 /// Represents a loaded module (CRO) with interfaces manipulating it.
 class CROHelper final {
 public:
     // TODO (wwylele): pass in the process handle for memory access
-    explicit CROHelper(VAddr cro_address, Kernel::Process& process, Core::System& system)
-        : module_address(cro_address), process(process), system(system) {}
+    explicit CROHelper(VAddr cro_address, Kernel::Process& process, Core::System& system,
+                       ExportSymbolCache& export_cache)
+        : module_address(cro_address), process(process), system(system),
+          export_cache(export_cache) {}
 
     std::string ModuleName() const {
         return system.Memory().ReadCString(GetField(ModuleNameOffset), GetField(ModuleNameSize));
@@ -140,10 +166,29 @@ public:
      */
     std::tuple<VAddr, u32> GetExecutablePages() const;
 
+    /**
+     * Gets the address and size of the code segment, which must have been rebased.
+     * @returns a tuple of (address, size); (0, 0) if the code segment doesn't exist.
+     */
+    std::tuple<VAddr, u32> GetCodeSegment() const;
+
+    /**
+     * Leaves the CPU cache invalidations of the words relocated inside the given range to the
+     * caller, which invalidates the range at most once when the module is loaded or unloaded.
+     */
+    void DeferInvalidation(VAddr address, u32 size) {
+        deferred_begin = address;
+        deferred_end = address + size;
+    }
+
 private:
     const VAddr module_address; ///< the virtual address of this module
     Kernel::Process& process;   ///< the owner process of this module
     Core::System& system;
+    ExportSymbolCache& export_cache; ///< the export tables of the modules of the process
+
+    VAddr deferred_begin = 0; ///< start of the range whose invalidations are left to the caller
+    VAddr deferred_end = 0;
 
     /**
      * Each item in this enum represents a u32 field in the header begin from address+0x80,
@@ -443,6 +488,9 @@ private:
      */
     VAddr SegmentTagToAddress(SegmentTag segment_tag) const;
 
+    /// Returns the segment table of this module, reading it from memory if not yet cached
+    const std::vector<SegmentEntry>& GetSegments() const;
+
     VAddr NextModule() const {
         return GetField(NextCRO);
     }
@@ -473,10 +521,11 @@ private:
      */
     template <typename FunctionObject>
     static ResultCode ForEachAutoLinkCRO(Kernel::Process& process, Core::System& system,
-                                         VAddr crs_address, FunctionObject func) {
+                                         ExportSymbolCache& export_cache, VAddr crs_address,
+                                         FunctionObject func) {
         VAddr current = crs_address;
         while (current != 0) {
-            CROHelper cro(current, process, system);
+            CROHelper cro(current, process, system, export_cache);
             CASCADE_RESULT(bool next, func(cro));
             if (!next)
                 break;
@@ -517,7 +566,8 @@ private:
     ResultCode ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool reset = false);
 
     /**
-     * Finds an exported named symbol in this module.
+     * Finds an exported named symbol in this module, through the cached export table of the
+     * module.
      * @param name the name of the symbol to find
      * @return VAddr the virtual address of the symbol; 0 if not found.
      */
@@ -715,6 +765,9 @@ private:
      * @returns ResultCode RESULT_SUCCESS on success, otherwise error code.
      */
     ResultCode ApplyExitRelocations(VAddr crs_address);
+
+    /// The segment table of this module, read on first use
+    mutable std::vector<SegmentEntry> segments;
 };
 
 } // namespace Service::LDR
@@ -5,6 +5,7 @@
 #include "common/alignment.h"
 #include "common/archives.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -19,6 +20,50 @@ SERIALIZE_EXPORT_IMPL(Service::LDR::ClientSlot)
 
 namespace Service::LDR {
 
+namespace {
+
+u64 HashCode(Core::System& system, const Kernel::Process& process, VAddr address, u32 size) {
+    std::vector<u8> code(size);
+    system.Memory().ReadBlock(process, address, code.data(), size);
+    return Common::ComputeFastHash64(code.data(), size);
+}
+
+/**
+ * Invalidates the CPU cache for a module loaded over the given range. Its code segment keeps the
+ * compiled code if it hashes the same as the code retired at its address, and the other retired
+ * code it overlaps is invalidated.
+ */
+void InvalidateLoadedModule(Core::System& system, const Kernel::Process& process,
+                            RetiredCodeTable& retired_code, VAddr address, u32 size,
+                            const CROHelper& cro) {
+    const auto [code_address, code_size] = cro.GetCodeSegment();
+    bool reused = false;
+    if (code_size != 0) {
+        const auto retired = retired_code.find(code_address);
+        reused = retired != retired_code.end() && retired->second.size == code_size &&
+                 retired->second.hash == HashCode(system, process, code_address, code_size);
+    }
+
+    for (auto it = retired_code.begin(); it != retired_code.end();) {
+        if (it->first >= address + size || it->first + it->second.size <= address) {
+            ++it;
+            continue;
+        }
+        if (!reused || it->first != code_address) {
+            system.InvalidateCacheRange(it->first, it->second.size);
+        }
+        it = retired_code.erase(it);
+    }
+
+    if (reused) {
+        LOG_DEBUG(Service_LDR, "CRO \"{}\" reuses its compiled code", cro.ModuleName());
+    } else if (code_size != 0) {
+        system.InvalidateCacheRange(code_address, code_size);
+    }
+}
+
+} // Anonymous namespace
+
 static const ResultCode ERROR_ALREADY_INITIALIZED = // 0xD9612FF9
     ResultCode(ErrorDescription::AlreadyInitialized, ErrorModule::RO, ErrorSummary::Internal,
                ErrorLevel::Permanent);
@@ -127,7 +172,7 @@ void RO::Initialize(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    CROHelper crs(crs_address, *process, system);
+    CROHelper crs(crs_address, *process, system, slot->export_cache);
     crs.InitCRS();
 
     result = crs.Rebase(0, crs_size, 0, 0, 0, 0, true);
@@ -261,7 +306,8 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
         return;
     }
 
-    CROHelper cro(cro_address, *process, system);
+    CROHelper cro(cro_address, *process, system, slot->export_cache);
+    cro.DeferInvalidation(cro_address, cro_size);
 
     result = cro.VerifyHash(cro_size, crr_address);
     if (result.IsError()) {
@@ -325,7 +371,7 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
         }
     }
 
-    system.InvalidateCacheRange(cro_address, cro_size);
+    InvalidateLoadedModule(system, *process, slot->retired_code, cro_address, cro_size, cro);
 
     LOG_INFO(Service_LDR, "CRO \"{}\" loaded at 0x{:08X}, fixed_end=0x{:08X}", cro.ModuleName(),
              cro_address, cro_address + fix_size);
@@ -343,11 +389,10 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}, zero={}, cro_buffer_ptr=0x{:08X}",
               cro_address, zero, cro_buffer_ptr);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
+    CROHelper cro(cro_address, *process, system, slot->export_cache);
     if (slot->loaded_crs == 0) {
         LOG_ERROR(Service_LDR, "Not initialized");
         rb.Push(ERROR_NOT_INITIALIZED);
@@ -370,11 +415,17 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
 
     u32 fixed_size = cro.GetFixedSize();
 
+    // The compiled code is kept for the module to be loaded again at the same address
+    const auto [code_address, code_size] = cro.GetCodeSegment();
+    const u64 code_hash = code_size != 0 ? HashCode(system, *process, code_address, code_size) : 0;
+    cro.DeferInvalidation(cro_address, fixed_size);
+
     cro.Unregister(slot->loaded_crs);
 
     ResultCode result = cro.Unlink(slot->loaded_crs);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error unlinking CRO {:08X}", result.raw);
+        system.InvalidateCacheRange(cro_address, fixed_size);
         rb.Push(result);
         return;
     }
@@ -385,6 +436,7 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
         result = cro.ClearRelocations();
         if (result.IsError()) {
             LOG_ERROR(Service_LDR, "Error clearing relocations {:08X}", result.raw);
+            system.InvalidateCacheRange(cro_address, fixed_size);
             rb.Push(result);
             return;
         }
@@ -398,7 +450,9 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
         LOG_ERROR(Service_LDR, "Error unmapping CRO {:08X}", result.raw);
     }
 
-    system.InvalidateCacheRange(cro_address, fixed_size);
+    if (code_size != 0) {
+        slot->retired_code[code_address] = {code_size, code_hash};
+    }
 
     rb.Push(result);
 }
@@ -410,11 +464,10 @@ void RO::LinkCRO(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}", cro_address);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
+    CROHelper cro(cro_address, *process, system, slot->export_cache);
     if (slot->loaded_crs == 0) {
         LOG_ERROR(Service_LDR, "Not initialized");
         rb.Push(ERROR_NOT_INITIALIZED);
@@ -450,11 +503,10 @@ void RO::UnlinkCRO(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}", cro_address);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
+    CROHelper cro(cro_address, *process, system, slot->export_cache);
     if (slot->loaded_crs == 0) {
         LOG_ERROR(Service_LDR, "Not initialized");
         rb.Push(ERROR_NOT_INITIALIZED);
@@ -499,7 +551,7 @@ void RO::Shutdown(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    CROHelper crs(slot->loaded_crs, *process, system);
+    CROHelper crs(slot->loaded_crs, *process, system, slot->export_cache);
     crs.Unrebase(true);
 
     ResultCode result = RESULT_SUCCESS;
@@ -511,6 +563,7 @@ void RO::Shutdown(Kernel::HLERequestContext& ctx) {
     }
 
     slot->loaded_crs = 0;
+    slot->export_cache.clear();
     rb.Push(result);
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "core/hle/service/ldr_ro/cro_helper.h"
 #include "core/hle/service/service.h"
 
 namespace Core {
@@ -15,6 +16,13 @@ namespace Service::LDR {
 struct ClientSlot : public Kernel::SessionRequestHandler::SessionDataBase {
     VAddr loaded_crs = 0; ///< the virtual address of the static module
 
+    /// Export tables of the loaded modules. Not serialized, as they are rebuilt on demand.
+    ExportSymbolCache export_cache;
+
+    /// Code of the unloaded modules still held by the CPU cache. Not serialized, as loading a
+    /// state clears the CPU cache.
+    RetiredCodeTable retired_code;
+
 private:
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
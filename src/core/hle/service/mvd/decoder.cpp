@@ -0,0 +1,25 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "core/hle/service/mvd/decoder.h"
+#ifdef ENABLE_FFMPEG_VIDEO_DUMPER
+#include "core/hle/service/mvd/ffmpeg_decoder.h"
+#endif
+
+namespace Service::MVD {
+
+std::unique_ptr<Decoder> CreateDecoder() {
+#ifdef ENABLE_FFMPEG_VIDEO_DUMPER
+    auto decoder = std::make_unique<FFmpegDecoder>();
+    if (decoder->Initialize()) {
+        return decoder;
+    }
+#else
+    LOG_WARNING(Service_MVD, "Built without FFmpeg, videos will not be decoded");
+#endif
+    return nullptr;
+}
+
+} // namespace Service::MVD
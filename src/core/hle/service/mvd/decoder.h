@@ -0,0 +1,60 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "common/common_types.h"
+
+namespace Service::MVD {
+
+enum class InputFormat : u32 {
+    YUYV422 = 0x00010001, ///< Color conversion of an image in memory
+    H264 = 0x00020001,    ///< H.264 decoding of NAL units
+};
+
+enum class OutputFormat : u32 {
+    YUYV422 = 0x00010001,
+    BGR565 = 0x00040002,
+    RGB565 = 0x00040004,
+};
+
+/// Every output format is 16-bit
+constexpr u32 OUTPUT_BYTES_PER_PIXEL = 2;
+
+/**
+ * Host side of the MVD hardware. Calls are made from the decoder thread of mvd:std only, and
+ * write their output straight into guest memory.
+ */
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+
+    /**
+     * Decodes an H.264 NAL unit, with or without its start code.
+     * @returns True if a picture was completed.
+     */
+    virtual bool DecodeNALUnit(const u8* data, std::size_t size) = 0;
+
+    /**
+     * Writes the last completed picture to output, scaled to width x height in the given format.
+     * @returns False if no picture was completed yet.
+     */
+    virtual bool RenderPicture(OutputFormat format, u32 width, u32 height, u8* output) = 0;
+
+    /**
+     * Converts a YUYV422 image of in_width x in_height to the given format and size.
+     */
+    virtual bool ConvertImage(const u8* input, u32 in_width, u32 in_height, OutputFormat format,
+                              u32 width, u32 height, u8* output) = 0;
+};
+
+/**
+ * Creates the decoder of the host, which uses a hardware decoding device where FFmpeg has one.
+ * @returns nullptr if the emulator was built without FFmpeg or no H.264 decoder is available.
+ */
+std::unique_ptr<Decoder> CreateDecoder();
+
+} // namespace Service::MVD
@@ -0,0 +1,219 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include "common/logging/log.h"
+#include "core/hle/service/mvd/ffmpeg_decoder.h"
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+namespace Service::MVD {
+
+namespace {
+AVPixelFormat ToPixelFormat(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::YUYV422:
+        return AV_PIX_FMT_YUYV422;
+    case OutputFormat::BGR565:
+        return AV_PIX_FMT_BGR565LE;
+    case OutputFormat::RGB565:
+        return AV_PIX_FMT_RGB565LE;
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+bool HasStartCode(const u8* data, std::size_t size) {
+    return (size >= 3 && data[0] == 0 && data[1] == 0 && data[2] == 1) ||
+           (size >= 4 && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1);
+}
+} // namespace
+
+FFmpegDecoder::FFmpegDecoder() = default;
+FFmpegDecoder::~FFmpegDecoder() = default;
+
+bool FFmpegDecoder::Initialize() {
+#ifdef ANDROID
+    // MediaCodec is a decoder of its own rather than a device of the native one
+    const AVCodec* codec = avcodec_find_decoder_by_name("h264_mediacodec");
+    if (!codec) {
+        codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    }
+#else
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+#endif
+    if (!codec) {
+        LOG_ERROR(Service_MVD, "FFmpeg has no H.264 decoder");
+        return false;
+    }
+
+    codec_context.reset(avcodec_alloc_context3(codec));
+    parser.reset(av_parser_init(AV_CODEC_ID_H264));
+    packet.reset(av_packet_alloc());
+    decoded_frame.reset(av_frame_alloc());
+    picture.reset(av_frame_alloc());
+    if (!codec_context || !parser || !packet || !decoded_frame || !picture) {
+        LOG_ERROR(Service_MVD, "Could not allocate the video decoder");
+        return false;
+    }
+
+    // Pictures are wanted as soon as they are complete, as the hardware has no reordering delay
+    codec_context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    codec_context->thread_type = FF_THREAD_SLICE;
+    if (!InitHardwareDevice(codec)) {
+        LOG_INFO(Service_MVD, "Decoding video in software");
+    }
+
+    if (avcodec_open2(codec_context.get(), codec, nullptr) < 0) {
+        LOG_ERROR(Service_MVD, "Could not open the video decoder");
+        return false;
+    }
+    return true;
+}
+
+bool FFmpegDecoder::InitHardwareDevice(const AVCodec* codec) {
+    for (int i = 0;; ++i) {
+        const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+        if (!config) {
+            return false;
+        }
+        if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)) {
+            continue;
+        }
+
+        AVBufferRef* device = nullptr;
+        if (av_hwdevice_ctx_create(&device, config->device_type, nullptr, nullptr, 0) < 0) {
+            LOG_DEBUG(Service_MVD, "Could not create the {} device of the video decoder",
+                      av_hwdevice_get_type_name(config->device_type));
+            continue;
+        }
+
+        // The codec context takes the reference
+        codec_context->hw_device_ctx = device;
+        codec_context->opaque = this;
+        codec_context->get_format = &FFmpegDecoder::GetFormat;
+        hardware_format = config->pix_fmt;
+        LOG_INFO(Service_MVD, "Decoding video on a {} device",
+                 av_hwdevice_get_type_name(config->device_type));
+        return true;
+    }
+}
+
+AVPixelFormat FFmpegDecoder::GetFormat(AVCodecContext* codec_context,
+                                       const AVPixelFormat* formats) {
+    const auto* decoder = static_cast<const FFmpegDecoder*>(codec_context->opaque);
+    for (const AVPixelFormat* format = formats; *format != AV_PIX_FMT_NONE; ++format) {
+        if (*format == decoder->hardware_format) {
+            return *format;
+        }
+    }
+    for (const AVPixelFormat* format = formats; *format != AV_PIX_FMT_NONE; ++format) {
+        if (!(av_pix_fmt_desc_get(*format)->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+            LOG_WARNING(Service_MVD, "The hardware device can't decode this video");
+            return *format;
+        }
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+bool FFmpegDecoder::DecodeNALUnit(const u8* data, std::size_t size) {
+    // The parser wants start codes between the NAL units and padding after the last one
+    std::vector<u8> input;
+    input.reserve(size + 4 + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!HasStartCode(data, size)) {
+        input.insert(input.end(), {0, 0, 0, 1});
+    }
+    input.insert(input.end(), data, data + size);
+    const int input_size = static_cast<int>(input.size());
+    input.resize(input.size() + AV_INPUT_BUFFER_PADDING_SIZE, 0);
+
+    bool completed = false;
+    const u8* position = input.data();
+    int remaining = input_size;
+    while (remaining > 0) {
+        u8* access_unit = nullptr;
+        int access_unit_size = 0;
+        const int used =
+            av_parser_parse2(parser.get(), codec_context.get(), &access_unit, &access_unit_size,
+                             position, remaining, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+        if (used < 0) {
+            LOG_ERROR(Service_MVD, "Could not parse NAL unit");
+            break;
+        }
+        position += used;
+        remaining -= used;
+
+        if (access_unit_size > 0) {
+            packet->data = access_unit;
+            packet->size = access_unit_size;
+            completed |= DecodePacket();
+        }
+    }
+    return completed;
+}
+
+bool FFmpegDecoder::DecodePacket() {
+    if (avcodec_send_packet(codec_context.get(), packet.get()) < 0) {
+        LOG_WARNING(Service_MVD, "Could not decode access unit");
+        return false;
+    }
+
+    bool completed = false;
+    while (avcodec_receive_frame(codec_context.get(), decoded_frame.get()) == 0) {
+        av_frame_unref(picture.get());
+        if (decoded_frame->format == hardware_format) {
+            // Pictures of the hardware device are copied back to system memory for scaling
+            if (av_hwframe_transfer_data(picture.get(), decoded_frame.get(), 0) < 0) {
+                LOG_ERROR(Service_MVD, "Could not download picture from the hardware device");
+                av_frame_unref(decoded_frame.get());
+                continue;
+            }
+        } else {
+            av_frame_move_ref(picture.get(), decoded_frame.get());
+        }
+        av_frame_unref(decoded_frame.get());
+        has_picture = true;
+        completed = true;
+    }
+    return completed;
+}
+
+bool FFmpegDecoder::RenderPicture(OutputFormat format, u32 width, u32 height, u8* output) {
+    if (!has_picture) {
+        return false;
+    }
+    return Scale(picture->data, picture->linesize, picture->width, picture->height,
+                 static_cast<AVPixelFormat>(picture->format), format, width, height, output);
+}
+
+bool FFmpegDecoder::ConvertImage(const u8* input, u32 in_width, u32 in_height,
+                                 OutputFormat format, u32 width, u32 height, u8* output) {
+    const u8* const data[4] = {input};
+    const int linesize[4] = {static_cast<int>(in_width * 2)};
+    return Scale(data, linesize, static_cast<int>(in_width), static_cast<int>(in_height),
+                 AV_PIX_FMT_YUYV422, format, width, height, output);
+}
+
+bool FFmpegDecoder::Scale(const u8* const* data, const int* linesize, int in_width, int in_height,
+                          AVPixelFormat in_format, OutputFormat format, u32 width, u32 height,
+                          u8* output) {
+    // sws_getCachedContext frees the context it is given when it has to create a new one
+    sws_context.reset(sws_getCachedContext(sws_context.release(), in_width, in_height, in_format,
+                                           static_cast<int>(width), static_cast<int>(height),
+                                           ToPixelFormat(format), SWS_BILINEAR, nullptr, nullptr,
+                                           nullptr));
+    if (!sws_context) {
+        LOG_ERROR(Service_MVD, "Could not convert {}x{} picture to {}x{} format {:08x}", in_width,
+                  in_height, width, height, static_cast<u32>(format));
+        return false;
+    }
+
+    u8* const planes[4] = {output};
+    const int strides[4] = {static_cast<int>(width * OUTPUT_BYTES_PER_PIXEL)};
+    sws_scale(sws_context.get(), data, linesize, 0, in_height, planes, strides);
+    return true;
+}
+
+} // namespace Service::MVD
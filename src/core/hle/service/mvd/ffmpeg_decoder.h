@@ -0,0 +1,89 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include "core/hle/service/mvd/decoder.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+#include <libswscale/swscale.h>
+}
+
+namespace Service::MVD {
+
+/**
+ * Decoder backed by FFmpeg. NAL units go through the H.264 parser, so pictures are completed once
+ * the first NAL unit of the next one arrives.
+ */
+class FFmpegDecoder final : public Decoder {
+public:
+    FFmpegDecoder();
+    ~FFmpegDecoder() override;
+
+    /// Opens the H.264 decoder, returning false if there is none
+    bool Initialize();
+
+    bool DecodeNALUnit(const u8* data, std::size_t size) override;
+    bool RenderPicture(OutputFormat format, u32 width, u32 height, u8* output) override;
+    bool ConvertImage(const u8* input, u32 in_width, u32 in_height, OutputFormat format,
+                      u32 width, u32 height, u8* output) override;
+
+private:
+    struct AVCodecContextDeleter {
+        void operator()(AVCodecContext* codec_context) const {
+            avcodec_free_context(&codec_context);
+        }
+    };
+
+    struct AVCodecParserContextDeleter {
+        void operator()(AVCodecParserContext* parser) const {
+            av_parser_close(parser);
+        }
+    };
+
+    struct AVPacketDeleter {
+        void operator()(AVPacket* packet) const {
+            av_packet_free(&packet);
+        }
+    };
+
+    struct AVFrameDeleter {
+        void operator()(AVFrame* frame) const {
+            av_frame_free(&frame);
+        }
+    };
+
+    struct SwsContextDeleter {
+        void operator()(SwsContext* sws_context) const {
+            sws_freeContext(sws_context);
+        }
+    };
+
+    /// Attaches the first hardware device the codec supports, returning false if there is none
+    bool InitHardwareDevice(const AVCodec* codec);
+    /// Sends a complete access unit to the decoder, returning true if a picture came out
+    bool DecodePacket();
+    bool Scale(const u8* const* data, const int* linesize, int in_width, int in_height,
+               AVPixelFormat in_format, OutputFormat format, u32 width, u32 height, u8* output);
+
+    /// Chooses the hardware format when the decoder offers it, and a software one otherwise
+    static AVPixelFormat GetFormat(AVCodecContext* codec_context, const AVPixelFormat* formats);
+
+    std::unique_ptr<AVCodecContext, AVCodecContextDeleter> codec_context{};
+    std::unique_ptr<AVCodecParserContext, AVCodecParserContextDeleter> parser{};
+    std::unique_ptr<AVPacket, AVPacketDeleter> packet{};
+    std::unique_ptr<AVFrame, AVFrameDeleter> decoded_frame{};
+    /// Last completed picture, in system memory
+    std::unique_ptr<AVFrame, AVFrameDeleter> picture{};
+    bool has_picture = false;
+    std::unique_ptr<SwsContext, SwsContextDeleter> sws_context{};
+
+    /// Pixel format of the hardware device, AV_PIX_FMT_NONE when decoding in software
+    AVPixelFormat hardware_format = AV_PIX_FMT_NONE;
+};
+
+} // namespace Service::MVD
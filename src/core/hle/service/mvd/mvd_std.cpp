@@ -2,33 +2,412 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <utility>
+#include <boost/serialization/binary_object.hpp>
 #include "common/archives.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/service/mvd/mvd_std.h"
+#include "core/memory.h"
 
 SERIALIZE_EXPORT_IMPL(Service::MVD::MVD_STD)
+SERIALIZE_EXPORT_IMPL(Service::MVD::MVD_STD::DecodeCallback)
+SERVICE_CONSTRUCT_IMPL(Service::MVD::MVD_STD)
 
 namespace Service::MVD {
 
-MVD_STD::MVD_STD() : ServiceFramework("mvd:std", 1) {
+/// Size of the work buffer libctru allocates, which is enough for any stream the hardware takes
+constexpr u32 DEFAULT_WORK_BUFFER_SIZE = 0x9006C8;
+
+/// How long the CPU emulation runs alongside the decoder thread before the client is woken up
+constexpr s64 WakeCheckPeriod = msToCycles(1);
+
+template <class Archive>
+void MVD_STD::serialize(Archive& ar, const unsigned int) {
+    // NOTE: The state of the decoder and the job in flight are not saved. A call that was
+    // suspended resumes with MVD_STATUS_BUSY, and pictures come out again from the next keyframe.
+    ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
+    ar& initialized;
+    ar& boost::serialization::make_binary_object(&config, sizeof(config));
+    ar& suspended_event;
+}
+SERIALIZE_IMPL(MVD_STD)
+
+/// Replies to a suspended call once its client thread woke up
+class MVD_STD::DecodeCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    explicit DecodeCallback(std::shared_ptr<MVD_STD> mvd_) : mvd(std::move(mvd_)) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        mvd->ResumeCall(ctx);
+    }
+
+private:
+    std::shared_ptr<MVD_STD> mvd;
+
+    DecodeCallback() = default;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& boost::serialization::base_object<Kernel::HLERequestContext::WakeupCallback>(*this);
+        ar& mvd;
+    }
+    friend class boost::serialization::access;
+};
+
+void MVD_STD::Initialize(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x1, 2, 2);
+    const VAddr work_buffer = rp.Pop<u32>();
+    const u32 work_buffer_size = rp.Pop<u32>();
+    auto process = rp.PopObject<Kernel::Process>();
+
+    initialized = true;
+    StartDecoderThread();
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(RESULT_SUCCESS);
+
+    LOG_DEBUG(Service_MVD, "called work_buffer=0x{:08X} work_buffer_size=0x{:X}", work_buffer,
+              work_buffer_size);
+}
+
+void MVD_STD::Shutdown(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x2, 0, 0);
+
+    initialized = false;
+    StopDecoderThread();
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(RESULT_SUCCESS);
+
+    LOG_DEBUG(Service_MVD, "called");
+}
+
+void MVD_STD::CalculateWorkBufSize(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x3, 12, 0);
+
+    // The host decoder keeps its state on its own
+    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
+    rb.Push(RESULT_SUCCESS);
+    rb.Push(DEFAULT_WORK_BUFFER_SIZE);
+
+    LOG_DEBUG(Service_MVD, "called");
+}
+
+void MVD_STD::ProcessNALUnit(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x8, 5, 2);
+    const VAddr address = rp.Pop<u32>();
+    const PAddr physical_address = rp.Pop<u32>();
+    const u32 size = rp.Pop<u32>();
+    const u8 flag = rp.Pop<u8>();
+    rp.Skip(1, false);
+    auto process = rp.PopObject<Kernel::Process>();
+
+    std::shared_ptr<Job> job;
+    if (resuming) {
+        job = TakeFinishedJob();
+    } else if (!current_job && process) {
+        job = std::make_shared<Job>();
+        job->type = Job::Type::DecodeNALUnit;
+        job->input.resize(size);
+        system.Memory().ReadBlock(*process, address, job->input.data(), size);
+        SubmitJob(ctx, "mvd::process_nal_unit", std::move(job));
+
+        LOG_TRACE(Service_MVD, "called address=0x{:08X} size=0x{:X} flag={}", address, size,
+                  flag);
+        return;
+    }
+
+    // The whole NAL unit is always consumed
+    IPC::RequestBuilder rb = rp.MakeBuilder(4, 0);
+    rb.Push(ResultCode(job ? job->status : MVD_STATUS_BUSY));
+    rb.Push<u32>(address + size);
+    rb.Push<u32>(physical_address + size);
+    rb.Push<u32>(0);
+}
+
+void MVD_STD::ControlFrameRendering(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x9, 1, 2);
+    const s8 value = rp.Pop<s8>();
+    auto process = rp.PopObject<Kernel::Process>();
+
+    std::shared_ptr<Job> job;
+    if (resuming) {
+        job = TakeFinishedJob();
+    } else if (!current_job) {
+        const bool convert = config.input_type == InputFormat::YUYV422;
+        const u32 input_size = config.input_width * config.input_height * 2;
+        const u32 output_size =
+            config.output_width * config.output_height * OUTPUT_BYTES_PER_PIXEL;
+
+        job = std::make_shared<Job>();
+        job->type = convert ? Job::Type::ConvertImage : Job::Type::RenderPicture;
+        job->config = config;
+        job->output = GetPhysicalRange(config.output_address0, output_size);
+        job->output_address = config.output_address0;
+        job->output_size = output_size;
+        if (convert) {
+            job->image = GetPhysicalRange(config.colorconv_input_address, input_size);
+        }
+
+        if (job->output && (!convert || job->image)) {
+            if (convert) {
+                Memory::RasterizerFlushRegion(config.colorconv_input_address, input_size);
+            }
+            Memory::RasterizerFlushAndInvalidateRegion(config.output_address0, output_size);
+            SubmitJob(ctx, "mvd::control_frame_rendering", std::move(job));
+
+            LOG_TRACE(Service_MVD, "called value={}", value);
+            return;
+        }
+
+        LOG_ERROR(Service_MVD, "Invalid buffers, input=0x{:08X} output=0x{:08X} {}x{}",
+                  config.colorconv_input_address, config.output_address0, config.output_width,
+                  config.output_height);
+        job->status = MVD_STATUS_OK;
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(ResultCode(job ? job->status : MVD_STATUS_BUSY));
+}
+
+void MVD_STD::GetConfig(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x1D, 1, 2);
+    const u32 size = rp.Pop<u32>();
+    auto& buffer = rp.PopMappedBuffer();
+
+    buffer.Write(&config, 0, std::min<std::size_t>(size, sizeof(config)));
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+    rb.Push(RESULT_SUCCESS);
+    rb.PushMappedBuffer(buffer);
+
+    LOG_DEBUG(Service_MVD, "called size=0x{:X}", size);
+}
+
+void MVD_STD::SetConfig(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x1E, 1, 4);
+    const u32 size = rp.Pop<u32>();
+    auto process = rp.PopObject<Kernel::Process>();
+    auto& buffer = rp.PopMappedBuffer();
+
+    buffer.Read(&config, 0, std::min<std::size_t>(size, sizeof(config)));
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+    rb.Push(RESULT_SUCCESS);
+    rb.PushMappedBuffer(buffer);
+
+    LOG_DEBUG(Service_MVD,
+              "called input_type=0x{:08X} input={}x{} output_type=0x{:08X} output={}x{} "
+              "output_address=0x{:08X}",
+              static_cast<u32>(config.input_type), config.input_width, config.input_height,
+              static_cast<u32>(config.output_type), config.output_width, config.output_height,
+              config.output_address0);
+}
+
+void MVD_STD::SetOutputBuffer(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x1F, 36, 2);
+    const u32 num_entries = rp.Pop<u32>();
+
+    // Pictures are only ever written to the output address of the config
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(RESULT_SUCCESS);
+
+    LOG_DEBUG(Service_MVD, "(STUBBED) called num_entries={}", num_entries);
+}
+
+void MVD_STD::OverrideOutputBuffers(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x21, 4, 0);
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(RESULT_SUCCESS);
+
+    LOG_DEBUG(Service_MVD, "(STUBBED) called");
+}
+
+void MVD_STD::SubmitJob(Kernel::HLERequestContext& ctx, const char* reason,
+                        std::shared_ptr<Job> job) {
+    StartDecoderThread();
+    current_job = job;
+    {
+        std::scoped_lock lock{job_mutex};
+        submitted_job = std::move(job);
+    }
+    job_submitted.notify_one();
+
+    system.CoreTiming().UnscheduleEvent(wake_event, 0);
+    system.CoreTiming().ScheduleEvent(WakeCheckPeriod, wake_event);
+    auto callback =
+        std::make_shared<DecodeCallback>(std::static_pointer_cast<MVD_STD>(shared_from_this()));
+    suspended_event = ctx.SleepClientThread(reason, std::chrono::nanoseconds{-1}, callback);
+}
+
+void MVD_STD::ResumeCall(Kernel::HLERequestContext& ctx) {
+    suspended_event.reset();
+
+    resuming = true;
+    SCOPE_EXIT({ resuming = false; });
+    switch (ctx.CommandBuffer()[0] >> 16) {
+    case 0x8:
+        ProcessNALUnit(ctx);
+        break;
+    case 0x9:
+        ControlFrameRendering(ctx);
+        break;
+    default:
+        UNREACHABLE_MSG("Unexpected suspended call 0x{:08X}", ctx.CommandBuffer()[0]);
+    }
+}
+
+std::shared_ptr<MVD_STD::Job> MVD_STD::TakeFinishedJob() {
+    return std::exchange(current_job, nullptr);
+}
+
+void MVD_STD::WakeFinishedCall(u64 userdata, s64 cycles_late) {
+    if (current_job) {
+        {
+            std::unique_lock lock{job_mutex};
+            job_finished.wait(lock, [this] { return current_job->done; });
+        }
+        if (current_job->output_size != 0) {
+            // The decoder thread wrote behind the back of the rasterizer cache
+            Memory::RasterizerInvalidateRegion(current_job->output_address,
+                                               current_job->output_size);
+        }
+    }
+
+    // Signaling runs the wakeup callback, which replies
+    if (suspended_event) {
+        const auto event = suspended_event;
+        event->Signal();
+    }
+}
+
+u8* MVD_STD::GetPhysicalRange(PAddr address, u32 size) {
+    if (size == 0) {
+        return nullptr;
+    }
+    u8* const begin = system.Memory().GetPhysicalPointer(address);
+    if (!begin || system.Memory().GetPhysicalPointer(address + size - 1) != begin + size - 1) {
+        return nullptr;
+    }
+    return begin;
+}
+
+void MVD_STD::StartDecoderThread() {
+    if (decoder_thread.joinable()) {
+        return;
+    }
+    stop_decoder = false;
+    decoder_thread = std::thread([this] { DecoderLoop(); });
+}
+
+void MVD_STD::StopDecoderThread() {
+    if (!decoder_thread.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{job_mutex};
+        stop_decoder = true;
+    }
+    job_submitted.notify_one();
+    decoder_thread.join();
+}
+
+void MVD_STD::DecoderLoop() {
+    Common::SetCurrentThreadName("MVDDecoder");
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock lock{job_mutex};
+            job_submitted.wait(lock, [this] { return stop_decoder || submitted_job; });
+            // A job submitted right before stopping still runs
+            if (!submitted_job) {
+                break;
+            }
+            job = std::move(submitted_job);
+        }
+
+        RunJob(*job);
+        {
+            std::scoped_lock lock{job_mutex};
+            job->done = true;
+        }
+        job_finished.notify_one();
+    }
+
+    // FFmpeg is only used from this thread
+    decoder.reset();
+    decoder_created = false;
+}
+
+void MVD_STD::RunJob(Job& job) {
+    if (!decoder_created) {
+        decoder = CreateDecoder();
+        decoder_created = true;
+    }
+    if (!decoder) {
+        job.status = MVD_STATUS_OK;
+        return;
+    }
+
+    const Config& job_config = job.config;
+    switch (job.type) {
+    case Job::Type::DecodeNALUnit:
+        job.status = decoder->DecodeNALUnit(job.input.data(), job.input.size())
+                         ? MVD_STATUS_FRAMEREADY
+                         : MVD_STATUS_OK;
+        break;
+    case Job::Type::RenderPicture:
+        decoder->RenderPicture(job_config.output_type, job_config.output_width,
+                               job_config.output_height, job.output);
+        job.status = MVD_STATUS_OK;
+        break;
+    case Job::Type::ConvertImage:
+        decoder->ConvertImage(job.image, job_config.input_width, job_config.input_height,
+                              job_config.output_type, job_config.output_width,
+                              job_config.output_height, job.output);
+        job.status = MVD_STATUS_OK;
+        break;
+    }
+}
+
+MVD_STD::MVD_STD(Core::System& system) : ServiceFramework("mvd:std", 1), system(system) {
     static const FunctionInfo functions[] = {
         // clang-format off
-        {0x00010082, nullptr, "Initialize"},
-        {0x00020000, nullptr, "Shutdown"},
-        {0x00030300, nullptr, "CalculateWorkBufSize"},
+        {0x00010082, &MVD_STD::Initialize, "Initialize"},
+        {0x00020000, &MVD_STD::Shutdown, "Shutdown"},
+        {0x00030300, &MVD_STD::CalculateWorkBufSize, "CalculateWorkBufSize"},
         {0x000400C0, nullptr, "CalculateImageSize"},
-        {0x00080142, nullptr, "ProcessNALUnit"},
-        {0x00090042, nullptr, "ControlFrameRendering"},
+        {0x00080142, &MVD_STD::ProcessNALUnit, "ProcessNALUnit"},
+        {0x00090042, &MVD_STD::ControlFrameRendering, "ControlFrameRendering"},
         {0x000A0000, nullptr, "GetStatus"},
         {0x000B0000, nullptr, "GetStatusOther"},
-        {0x001D0042, nullptr, "GetConfig"},
-        {0x001E0044, nullptr, "SetConfig"},
-        {0x001F0902, nullptr, "SetOutputBuffer"},
-        {0x00210100, nullptr, "OverrideOutputBuffers"}
+        {0x001D0042, &MVD_STD::GetConfig, "GetConfig"},
+        {0x001E0044, &MVD_STD::SetConfig, "SetConfig"},
+        {0x001F0902, &MVD_STD::SetOutputBuffer, "SetOutputBuffer"},
+        {0x00210100, &MVD_STD::OverrideOutputBuffers, "OverrideOutputBuffers"}
         // clang-format on
     };
 
     RegisterHandlers(functions);
-};
+
+    wake_event = system.CoreTiming().RegisterEvent(
+        "MVD_STD::WakeFinishedCall",
+        [this](u64 userdata, s64 cycles_late) { WakeFinishedCall(userdata, cycles_late); });
+}
+
+MVD_STD::~MVD_STD() {
+    StopDecoderThread();
+}
 
 } // namespace Service::MVD
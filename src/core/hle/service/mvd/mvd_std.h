@@ -4,19 +4,147 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/serialization/shared_ptr.hpp>
+#include "common/common_funcs.h"
+#include "core/hle/service/mvd/decoder.h"
 #include "core/hle/service/service.h"
 
+namespace Core {
+class System;
+struct TimingEventType;
+} // namespace Core
+
+namespace Kernel {
+class Event;
+}
+
 namespace Service::MVD {
 
+/// Statuses returned by the decoding functions, which are not errors
+constexpr u32 MVD_STATUS_OK = 0x17000;
+constexpr u32 MVD_STATUS_PARAMSET = 0x17001;
+constexpr u32 MVD_STATUS_BUSY = 0x17002;
+constexpr u32 MVD_STATUS_FRAMEREADY = 0x17003;
+
+/// Configuration set by SetConfig. The fields that aren't named are kept but unused.
+struct Config {
+    InputFormat input_type;
+    INSERT_PADDING_WORDS(2);
+    u32 input_width;
+    u32 input_height;
+    u32 colorconv_input_address; ///< Physical address of the image in color conversion mode
+    INSERT_PADDING_WORDS(10);
+    u32 enable_cropping;
+    u32 crop_x;
+    u32 crop_y;
+    u32 crop_height;
+    u32 crop_width;
+    INSERT_PADDING_WORDS(1);
+    OutputFormat output_type;
+    u32 output_width;
+    u32 output_height;
+    u32 output_address0; ///< Physical address the pictures are written to
+    u32 output_address1;
+    INSERT_PADDING_WORDS(38);
+    u32 flag_x104;
+    u32 output_rotation;
+    INSERT_PADDING_WORDS(3);
+};
+static_assert(sizeof(Config) == 0x118, "Config has incorrect size");
+
 class MVD_STD final : public ServiceFramework<MVD_STD> {
 public:
-    MVD_STD();
-    ~MVD_STD() = default;
+    explicit MVD_STD(Core::System& system);
+    ~MVD_STD();
+
+    class DecodeCallback;
 
 private:
-    SERVICE_SERIALIZATION_SIMPLE
+    /// Work handed to the decoder thread. Only done is shared with it, under job_mutex.
+    struct Job {
+        enum class Type { DecodeNALUnit, RenderPicture, ConvertImage };
+
+        Type type;
+        std::vector<u8> input;
+        const u8* image = nullptr;
+        Config config;
+        u8* output = nullptr;
+        PAddr output_address = 0;
+        u32 output_size = 0;
+        u32 status = MVD_STATUS_OK;
+        bool done = false;
+    };
+
+    void Initialize(Kernel::HLERequestContext& ctx);
+    void Shutdown(Kernel::HLERequestContext& ctx);
+    void CalculateWorkBufSize(Kernel::HLERequestContext& ctx);
+    void ProcessNALUnit(Kernel::HLERequestContext& ctx);
+    void ControlFrameRendering(Kernel::HLERequestContext& ctx);
+    void GetConfig(Kernel::HLERequestContext& ctx);
+    void SetConfig(Kernel::HLERequestContext& ctx);
+    void SetOutputBuffer(Kernel::HLERequestContext& ctx);
+    void OverrideOutputBuffers(Kernel::HLERequestContext& ctx);
+
+    /**
+     * Hands the job to the decoder thread and suspends the client thread until it is done. The
+     * request handler then runs again, with resuming set, to reply.
+     */
+    void SubmitJob(Kernel::HLERequestContext& ctx, const char* reason, std::shared_ptr<Job> job);
+
+    /// Runs the request handler of the suspended call again once its client thread woke up
+    void ResumeCall(Kernel::HLERequestContext& ctx);
+
+    /// Takes the finished job of the resumed call, which is missing after loading a save state
+    std::shared_ptr<Job> TakeFinishedJob();
+
+    /**
+     * Wakes the suspended client thread. The decoder thread had the CPU emulation's head start to
+     * finish the job, and is waited for when it still needs longer.
+     */
+    void WakeFinishedCall(u64 userdata, s64 cycles_late);
+
+    /// Returns a pointer to size bytes of guest memory at address, or nullptr if not all mapped
+    u8* GetPhysicalRange(PAddr address, u32 size);
+
+    void StartDecoderThread();
+    void StopDecoderThread();
+    void DecoderLoop();
+    void RunJob(Job& job);
+
+    Core::System& system;
+    Core::TimingEventType* wake_event;
+
+    bool initialized = false;
+    Config config{};
+
+    /// Event the client thread of the suspended call sleeps on
+    std::shared_ptr<Kernel::Event> suspended_event;
+    std::shared_ptr<Job> current_job;
+    bool resuming = false;
+
+    /// Only used by the decoder thread
+    std::unique_ptr<Decoder> decoder;
+    bool decoder_created = false;
+
+    std::thread decoder_thread;
+    std::mutex job_mutex;
+    std::condition_variable job_submitted;
+    std::condition_variable job_finished;
+    std::shared_ptr<Job> submitted_job;
+    bool stop_decoder = false;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int);
+    friend class boost::serialization::access;
 };
 
 } // namespace Service::MVD
 
 BOOST_CLASS_EXPORT_KEY(Service::MVD::MVD_STD)
+BOOST_CLASS_EXPORT_KEY(Service::MVD::MVD_STD::DecodeCallback)
+SERVICE_CONSTRUCT(Service::MVD::MVD_STD)
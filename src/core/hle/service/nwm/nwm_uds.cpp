@@ -23,6 +23,7 @@
 #include "core/hle/service/nwm/uds_connection.h"
 #include "core/hle/service/nwm/uds_data.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 SERIALIZE_EXPORT_IMPL(Service::NWM::NWM_UDS)
 SERVICE_CONSTRUCT_IMPL(Service::NWM::NWM_UDS)
@@ -55,6 +56,10 @@ constexpr u16 BroadcastNetworkNodeId = 0xFFFF;
 // The Host has always dest_node_id 1
 constexpr u16 HostDestNodeId = 1;
 
+// Maximum size of the data frames sent together in a DataBatch packet, including their size
+// prefixes. This is a couple of full-sized data frames.
+constexpr std::size_t MaxDataBatchSize = 0x1000;
+
 std::list<Network::WifiPacket> NWM_UDS::GetReceivedBeacons(const MacAddress& sender) {
     std::lock_guard lock(beacon_mutex);
     if (sender != Network::BroadcastMac) {
@@ -85,6 +90,94 @@ void SendPacket(Network::WifiPacket& packet) {
     }
 }
 
+void NWM_UDS::HandleBeaconRepeat(const Network::WifiPacket& packet) {
+    u64 hash;
+    if (packet.data.size() != sizeof(hash)) {
+        return;
+    }
+    std::memcpy(&hash, packet.data.data(), sizeof(hash));
+
+    Network::WifiPacket beacon = packet;
+    {
+        std::lock_guard lock(beacon_mutex);
+        const auto full_beacon = full_beacons.find(packet.transmitter_address);
+        if (full_beacon == full_beacons.end() || full_beacon->second.hash != hash) {
+            // We did not receive the full beacon yet, the host will send it again shortly
+            return;
+        }
+        beacon.data = full_beacon->second.frame;
+    }
+    beacon.type = Network::WifiPacket::PacketType::Beacon;
+    HandleBeaconFrame(beacon);
+}
+
+void NWM_UDS::HandleDataBatch(const Network::WifiPacket& packet) {
+    Network::WifiPacket frame_packet;
+    frame_packet.type = Network::WifiPacket::PacketType::Data;
+    frame_packet.channel = packet.channel;
+    frame_packet.transmitter_address = packet.transmitter_address;
+    frame_packet.destination_address = packet.destination_address;
+    for (auto& frame : UnpackDataFrames(packet.data)) {
+        frame_packet.data = std::move(frame);
+        HandleDataFrame(frame_packet);
+    }
+}
+
+void NWM_UDS::SendDataFrame(Network::WifiPacket packet) {
+    const u16 batch_window = Settings::values.uds_batch_window;
+    if (batch_window == 0) {
+        SendPacket(packet);
+        return;
+    }
+
+    const std::size_t frame_size = sizeof(u16_le) + packet.data.size();
+    auto batch = std::find_if(data_batches.begin(), data_batches.end(),
+                              [&packet](const DataBatch& batch) {
+                                  return batch.destination == packet.destination_address &&
+                                         batch.channel == packet.channel;
+                              });
+    if (batch != data_batches.end() && batch->size + frame_size > MaxDataBatchSize) {
+        SendDataBatch(*batch);
+        data_batches.erase(batch);
+        batch = data_batches.end();
+    }
+    if (batch == data_batches.end()) {
+        if (data_batches.empty()) {
+            system.CoreTiming().ScheduleEvent(msToCycles(batch_window), data_batch_event, 0);
+        }
+        batch = data_batches.insert(data_batches.end(),
+                                    {packet.destination_address, packet.channel, 0, {}});
+    }
+    batch->size += frame_size;
+    batch->frames.push_back(std::move(packet.data));
+}
+
+void NWM_UDS::SendDataBatch(DataBatch& batch) {
+    Network::WifiPacket packet;
+    packet.destination_address = batch.destination;
+    packet.channel = batch.channel;
+    if (batch.frames.size() == 1) {
+        packet.type = Network::WifiPacket::PacketType::Data;
+        packet.data = std::move(batch.frames.front());
+    } else {
+        packet.type = Network::WifiPacket::PacketType::DataBatch;
+        packet.data = PackDataFrames(batch.frames);
+    }
+    SendPacket(packet);
+}
+
+void NWM_UDS::FlushDataFrames() {
+    system.CoreTiming().UnscheduleEvent(data_batch_event, 0);
+    for (auto& batch : data_batches) {
+        SendDataBatch(batch);
+    }
+    data_batches.clear();
+}
+
+void NWM_UDS::DataBatchCallback(u64 userdata, s64 cycles_late) {
+    FlushDataFrames();
+}
+
 u16 NWM_UDS::GetNextAvailableNodeId() {
     for (u16 index = 0; index < connection_status.max_nodes; ++index) {
         if ((connection_status.node_bitmask & (1 << index)) == 0)
@@ -145,6 +238,8 @@ void NWM_UDS::HandleNodeMapPacket(const Network::WifiPacket& packet) {
 
 void NWM_UDS::HandleBeaconFrame(const Network::WifiPacket& packet) {
     std::lock_guard lock(beacon_mutex);
+    full_beacons[packet.transmitter_address] = {HashBeaconFrame(packet.data), packet.data};
+
     const auto unique_beacon =
         std::find_if(received_beacons.begin(), received_beacons.end(),
                      [&packet](const Network::WifiPacket& new_packet) {
@@ -541,6 +636,12 @@ void NWM_UDS::OnWifiPacketReceived(const Network::WifiPacket& packet) {
     case Network::WifiPacket::PacketType::NodeMap:
         HandleNodeMapPacket(packet);
         break;
+    case Network::WifiPacket::PacketType::DataBatch:
+        HandleDataBatch(packet);
+        break;
+    case Network::WifiPacket::PacketType::BeaconRepeat:
+        HandleBeaconRepeat(packet);
+        break;
     }
 }
 
@@ -575,6 +676,9 @@ void NWM_UDS::Shutdown(Kernel::HLERequestContext& ctx) {
     channel_data.clear();
     node_map.clear();
 
+    system.CoreTiming().UnscheduleEvent(data_batch_event, 0);
+    data_batches.clear();
+
     recv_buffer_memory.reset();
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -901,6 +1005,7 @@ ResultCode NWM_UDS::BeginHostingNetwork(const u8* network_info_buffer,
     connection_status_event->Signal();
 
     // Start broadcasting the network, send a beacon frame every 102.4ms.
+    beacon_deduplicator->Reset();
     system.CoreTiming().ScheduleEvent(msToCycles(DefaultBeaconInterval * MillisecondsPerTU),
                                       beacon_broadcast_event, 0);
 
@@ -1020,6 +1125,8 @@ void NWM_UDS::DestroyNetwork(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    FlushDataFrames();
+
     // TODO(B3N30): Send 3 Deauth packets
 
     u16_le tmp_node_id = connection_status.network_node_id;
@@ -1075,6 +1182,7 @@ void NWM_UDS::DisconnectNetwork(Kernel::HLERequestContext& ctx) {
         deauth.type = WifiPacket::PacketType::Deauthentication;
     }
 
+    FlushDataFrames();
     SendPacket(deauth);
 
     for (auto& bind_node : channel_data) {
@@ -1154,7 +1262,7 @@ void NWM_UDS::SendTo(Kernel::HLERequestContext& ctx) {
     packet.data = std::move(data_payload);
     packet.type = Network::WifiPacket::PacketType::Data;
 
-    SendPacket(packet);
+    SendDataFrame(std::move(packet));
 
     rb.Push(RESULT_SUCCESS);
 }
@@ -1443,8 +1551,14 @@ void NWM_UDS::BeaconBroadcastCallback(u64 userdata, s64 cycles_late) {
 
     using Network::WifiPacket;
     WifiPacket packet;
-    packet.type = WifiPacket::PacketType::Beacon;
-    packet.data = std::move(frame);
+    if (const auto hash = beacon_deduplicator->Deduplicate(frame)) {
+        packet.type = WifiPacket::PacketType::BeaconRepeat;
+        packet.data.resize(sizeof(*hash));
+        std::memcpy(packet.data.data(), &*hash, sizeof(*hash));
+    } else {
+        packet.type = WifiPacket::PacketType::Beacon;
+        packet.data = std::move(frame);
+    }
     packet.destination_address = Network::BroadcastMac;
     packet.channel = network_channel;
 
@@ -1496,6 +1610,10 @@ NWM_UDS::NWM_UDS(Core::System& system) : ServiceFramework("nwm::UDS"), system(sy
     beacon_broadcast_event = system.CoreTiming().RegisterEvent(
         "UDS::BeaconBroadcastCallback",
         [this](u64 userdata, s64 cycles_late) { BeaconBroadcastCallback(userdata, cycles_late); });
+    data_batch_event = system.CoreTiming().RegisterEvent(
+        "UDS::DataBatchCallback",
+        [this](u64 userdata, s64 cycles_late) { DataBatchCallback(userdata, cycles_late); });
+    beacon_deduplicator = std::make_unique<BeaconDeduplicator>();
 
     CryptoPP::AutoSeededRandomPool rng;
     auto mac = SharedPage::DefaultMac;
@@ -1524,6 +1642,7 @@ NWM_UDS::~NWM_UDS() {
         room_member->Unbind(wifi_packet_received);
 
     system.CoreTiming().UnscheduleEvent(beacon_broadcast_event, 0);
+    system.CoreTiming().UnscheduleEvent(data_batch_event, 0);
 }
 
 } // namespace Service::NWM
@@ -129,6 +129,8 @@ enum class TagId : u8 {
     VendorSpecific = 221
 };
 
+class BeaconDeduplicator;
+
 class NWM_UDS final : public ServiceFramework<NWM_UDS> {
 public:
     explicit NWM_UDS(Core::System& system);
@@ -461,6 +463,20 @@ private:
 
     void BeaconBroadcastCallback(u64 userdata, s64 cycles_late);
 
+    /**
+     * Sends a data frame to the room, or queues it with the other data frames to the same
+     * destination until the batching window closes.
+     */
+    void SendDataFrame(Network::WifiPacket packet);
+
+    /// Sends the data frames queued during the batching window, one room packet per destination.
+    void FlushDataFrames();
+
+    void DataBatchCallback(u64 userdata, s64 cycles_late);
+
+    struct DataBatch;
+    void SendDataBatch(DataBatch& batch);
+
     /**
      * Returns a list of received 802.11 beacon frames from the specified sender since the last
      * call.
@@ -476,6 +492,8 @@ private:
     void BroadcastNodeMap();
     void HandleNodeMapPacket(const Network::WifiPacket& packet);
     void HandleBeaconFrame(const Network::WifiPacket& packet);
+    void HandleBeaconRepeat(const Network::WifiPacket& packet);
+    void HandleDataBatch(const Network::WifiPacket& packet);
     void HandleAssociationResponseFrame(const Network::WifiPacket& packet);
     void HandleEAPoLPacket(const Network::WifiPacket& packet);
     void HandleSecureDataPacket(const Network::WifiPacket& packet);
@@ -568,6 +586,22 @@ private:
     // Event that will generate and send the 802.11 beacon frames.
     Core::TimingEventType* beacon_broadcast_event;
 
+    // Replaces the beacons we send that did not change with their hash.
+    std::unique_ptr<BeaconDeduplicator> beacon_deduplicator;
+
+    struct DataBatch {
+        MacAddress destination; ///< Destination of the frames.
+        u8 channel;             ///< WiFi channel of the frames.
+        std::size_t size;       ///< Size of the frames, including their size prefixes.
+        std::vector<std::vector<u8>> frames;
+    };
+
+    // Data frames waiting for the end of the batching window, in the order of their first frame.
+    std::vector<DataBatch> data_batches;
+
+    // Event that sends the batched data frames at the end of the batching window.
+    Core::TimingEventType* data_batch_event;
+
     // Callback identifier for the OnWifiPacketReceived event.
     Network::RoomMember::CallbackHandle<Network::WifiPacket> wifi_packet_received;
 
@@ -584,6 +618,13 @@ private:
     // List of the last <MaxBeaconFrames> beacons received from the network.
     std::list<Network::WifiPacket> received_beacons;
 
+    // Last full beacon received from each host, which BeaconRepeat packets refer to.
+    struct FullBeacon {
+        u64 hash;
+        std::vector<u8> frame;
+    };
+    std::map<MacAddress, FullBeacon> full_beacons;
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int);
     friend class boost::serialization::access;
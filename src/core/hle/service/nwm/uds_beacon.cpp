@@ -10,6 +10,7 @@
 #include <cryptopp/modes.h>
 #include <cryptopp/sha.h>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "core/hle/service/nwm/nwm_uds.h"
 #include "core/hle/service/nwm/uds_beacon.h"
 
@@ -328,4 +329,24 @@ std::vector<u8> GenerateBeaconFrame(const NetworkInfo& network_info, const NodeL
     return buffer;
 }
 
+u64 HashBeaconFrame(const std::vector<u8>& frame) {
+    return Common::ComputeHash64(frame.data(), frame.size());
+}
+
+std::optional<u64> BeaconDeduplicator::Deduplicate(const std::vector<u8>& frame) {
+    const u64 hash = HashBeaconFrame(frame);
+    if (hash == last_hash && repeats < FullBeaconInterval - 1) {
+        repeats++;
+        return hash;
+    }
+    last_hash = hash;
+    repeats = 0;
+    return std::nullopt;
+}
+
+void BeaconDeduplicator::Reset() {
+    last_hash.reset();
+    repeats = 0;
+}
+
 } // namespace Service::NWM
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <deque>
+#include <optional>
 #include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
@@ -135,4 +136,32 @@ void DecryptBeacon(const NetworkInfo& network_info, std::vector<u8>& buffer);
  */
 std::vector<u8> GenerateBeaconFrame(const NetworkInfo& network_info, const NodeList& nodes);
 
+/// Number of beacons after which an unchanged beacon is sent in full again, so that the members
+/// that joined the room since it was last sent learn of the network.
+constexpr u32 FullBeaconInterval = 10;
+
+/// Returns the hash that identifies a beacon frame in BeaconRepeat packets.
+u64 HashBeaconFrame(const std::vector<u8>& frame);
+
+/**
+ * Deduplicates the beacon frames a host sends to the room. A beacon only changes when the network
+ * or its nodes do, so a beacon equal to the previous one is replaced by its hash, which receivers
+ * look up among the full beacons they have received.
+ */
+class BeaconDeduplicator {
+public:
+    /**
+     * Returns the hash to send in place of `frame`, or nothing if it has to be sent in full because
+     * it changed or was last sent in full FullBeaconInterval beacons ago.
+     */
+    std::optional<u64> Deduplicate(const std::vector<u8>& frame);
+
+    /// Makes the next beacon be sent in full.
+    void Reset();
+
+private:
+    std::optional<u64> last_hash;
+    u32 repeats = 0;
+};
+
 } // namespace Service::NWM
@@ -380,4 +380,41 @@ EAPoLLogoffPacket ParseEAPoLLogoffFrame(const std::vector<u8>& frame) {
     return eapol_logoff;
 }
 
+std::vector<u8> PackDataFrames(const std::vector<std::vector<u8>>& frames) {
+    std::size_t total_size = 0;
+    for (const auto& frame : frames) {
+        total_size += sizeof(u16_le) + frame.size();
+    }
+
+    std::vector<u8> payload(total_size);
+    std::size_t offset = 0;
+    for (const auto& frame : frames) {
+        ASSERT(frame.size() <= 0xFFFF);
+        const u16_le size = static_cast<u16>(frame.size());
+        std::memcpy(payload.data() + offset, &size, sizeof(size));
+        std::memcpy(payload.data() + offset + sizeof(size), frame.data(), frame.size());
+        offset += sizeof(size) + frame.size();
+    }
+    return payload;
+}
+
+std::vector<std::vector<u8>> UnpackDataFrames(const std::vector<u8>& payload) {
+    std::vector<std::vector<u8>> frames;
+    std::size_t offset = 0;
+    while (offset < payload.size()) {
+        u16_le size;
+        if (payload.size() - offset < sizeof(size)) {
+            return {};
+        }
+        std::memcpy(&size, payload.data() + offset, sizeof(size));
+        offset += sizeof(size);
+        if (payload.size() - offset < size) {
+            return {};
+        }
+        frames.emplace_back(payload.begin() + offset, payload.begin() + offset + size);
+        offset += size;
+    }
+    return frames;
+}
+
 } // namespace Service::NWM
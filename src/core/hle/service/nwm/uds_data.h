@@ -168,4 +168,17 @@ std::vector<u8> GenerateEAPoLLogoffFrame(const MacAddress& mac_address, u16 netw
  */
 EAPoLLogoffPacket ParseEAPoLLogoffFrame(const std::vector<u8>& frame);
 
+/*
+ * Packs several 802.11 data frames into the payload of a single DataBatch WifiPacket, each
+ * prefixed by its size.
+ * @returns The generated payload.
+ */
+std::vector<u8> PackDataFrames(const std::vector<std::vector<u8>>& frames);
+
+/*
+ * Returns the 802.11 data frames packed in the payload of a DataBatch WifiPacket, or an empty
+ * list if the payload is malformed.
+ */
+std::vector<std::vector<u8>> UnpackDataFrames(const std::vector<u8>& payload);
+
 } // namespace Service::NWM
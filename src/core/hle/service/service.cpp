@@ -7,6 +7,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/frame_counters.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/handle_table.h"
@@ -143,6 +144,22 @@ void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* function
         // Usually this array is sorted by id already, so hint to insert at the end
         handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
     }
+
+    // Inserting into the flat_map moves its elements, so the table is rebuilt from scratch
+    static constexpr u32 MAX_TABLE_COMMAND_ID = 0x2000;
+    handler_table.clear();
+    for (const auto& [header, info] : handlers) {
+        const u32 command_id = header >> 16;
+        if (command_id >= MAX_TABLE_COMMAND_ID) {
+            continue;
+        }
+        if (command_id >= handler_table.size()) {
+            handler_table.resize(command_id + 1, nullptr);
+        }
+        if (handler_table[command_id] == nullptr) {
+            handler_table[command_id] = &info;
+        }
+    }
 }
 
 void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const FunctionInfoBase* info) {
@@ -167,9 +184,17 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const Funct
 }
 
 void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
+    Core::CountFrameEvent(Core::FrameCounter::IPCRequests);
     u32 header_code = context.CommandBuffer()[0];
-    auto itr = handlers.find(header_code);
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
+    const u32 command_id = header_code >> 16;
+    const FunctionInfoBase* info = nullptr;
+    if (command_id < handler_table.size() && handler_table[command_id] != nullptr &&
+        handler_table[command_id]->expected_header == header_code) {
+        info = handler_table[command_id];
+    } else {
+        auto itr = handlers.find(header_code);
+        info = itr == handlers.end() ? nullptr : &itr->second;
+    }
     if (info == nullptr || info->handler_callback == nullptr) {
         context.ReportUnimplemented();
         return ReportUnimplementedFunction(context.CommandBuffer(), info);
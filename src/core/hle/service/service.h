@@ -9,6 +9,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/shared_ptr.hpp>
@@ -103,6 +104,11 @@ private:
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
     boost::container::flat_map<u32, FunctionInfoBase> handlers;
+    /**
+     * Handlers indexed by command id, to dispatch without searching `handlers`. When several
+     * headers share a command id, only the first is found here.
+     */
+    std::vector<const FunctionInfoBase*> handler_table;
 };
 
 /**
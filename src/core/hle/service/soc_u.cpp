@@ -3,9 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <mutex>
+#include <thread>
 #include <type_traits>
 #include <vector>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -13,8 +19,11 @@
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
 #include "common/swap.h"
+#include "common/thread.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/result.h"
 #include "core/hle/service/soc_u.h"
@@ -55,6 +64,8 @@
 #endif
 
 SERIALIZE_EXPORT_IMPL(Service::SOC::SOC_U)
+SERIALIZE_EXPORT_IMPL(Service::SOC::SOC_U::BlockingCallCallback)
+SERVICE_CONSTRUCT_IMPL(Service::SOC::SOC_U)
 
 namespace Service::SOC {
 
@@ -355,10 +366,295 @@ struct CTRAddrInfo {
 
 static_assert(sizeof(CTRAddrInfo) == 0x130, "Size of CTRAddrInfo is not correct");
 
+/// Host sockets a suspended guest call waits on
+struct PendingWait {
+    std::vector<pollfd> fds;
+    std::atomic<bool> ready{false};
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        u32 count = static_cast<u32>(fds.size());
+        ar& count;
+        fds.resize(count);
+        for (auto& fd : fds) {
+            u64 handle = static_cast<u64>(fd.fd);
+            ar& handle;
+            fd.fd = static_cast<decltype(fd.fd)>(handle);
+            ar& fd.events;
+        }
+        bool is_ready = ready;
+        ar& is_ready;
+        ready = is_ready;
+    }
+};
+
+namespace {
+
+/// How long the reactor waits before it picks up the sockets of newly suspended calls
+constexpr int ReactorPollSliceMs = 5;
+
+/// How often, in emulated time, ready calls are looked for while any call is suspended
+constexpr s64 WakeCheckPeriod = msToCycles(1);
+
+/// Returns whether poll() reports any of the sockets as ready or failed, without waiting
+bool IsAnyReady(std::vector<pollfd> fds) {
+    s32 ret = ::poll(fds.data(), static_cast<unsigned long>(fds.size()), 0);
+    return ret != 0;
+}
+
+/// Returns a wait for the given events of the socket
+std::shared_ptr<PendingWait> MakeWait(u32 socket_handle, short events) {
+    auto wait = std::make_shared<PendingWait>();
+    pollfd fd{};
+    fd.fd = socket_handle;
+    fd.events = events;
+    wait->fds.push_back(fd);
+    return wait;
+}
+
+/// Switches the host socket between blocking and non-blocking calls
+void SetNonBlocking(u32 socket_handle, bool non_blocking) {
+#ifdef _WIN32
+    unsigned long tmp = non_blocking ? 1 : 0;
+    ioctlsocket(socket_handle, FIONBIO, &tmp);
+#else
+    const int flags = ::fcntl(socket_handle, F_GETFL, 0);
+    ::fcntl(socket_handle, F_SETFL, non_blocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+#endif
+}
+
+/**
+ * Waits for the host sockets of suspended guest calls on an I/O thread, so that a blocking guest
+ * call only suspends its own thread. A single poll() covers the sockets of every suspended call.
+ */
+class SocketReactor {
+public:
+    ~SocketReactor() {
+        {
+            std::scoped_lock lock{mutex};
+            stop = true;
+        }
+        cv.notify_one();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    void Add(std::shared_ptr<PendingWait> wait) {
+        {
+            std::scoped_lock lock{mutex};
+            waits.push_back(std::move(wait));
+            if (!thread.joinable()) {
+                thread = std::thread(&SocketReactor::Loop, this);
+            }
+        }
+        cv.notify_one();
+    }
+
+    void Remove(const std::shared_ptr<PendingWait>& wait) {
+        std::scoped_lock lock{mutex};
+        waits.erase(std::remove(waits.begin(), waits.end(), wait), waits.end());
+    }
+
+private:
+    void Loop() {
+        Common::SetCurrentThreadName("SOC I/O");
+        std::unique_lock lock{mutex};
+        while (true) {
+            cv.wait(lock, [this] { return stop || !waits.empty(); });
+            if (stop) {
+                return;
+            }
+
+            // Waits can be added and removed while the lock is released, so the polled ones are
+            // kept alive here
+            const std::vector<std::shared_ptr<PendingWait>> polled = waits;
+            lock.unlock();
+            std::vector<pollfd> fds;
+            for (const auto& wait : polled) {
+                fds.insert(fds.end(), wait->fds.begin(), wait->fds.end());
+            }
+            s32 ret = ::poll(fds.data(), static_cast<unsigned long>(fds.size()),
+                             ReactorPollSliceMs);
+
+            std::vector<std::shared_ptr<PendingWait>> ready;
+            auto fd = fds.begin();
+            for (const auto& wait : polled) {
+                const auto end = fd + wait->fds.size();
+                // A failed poll() can stem from a socket closed by another guest thread, which
+                // polling the waits one by one finds
+                const bool is_ready =
+                    ret == SOCKET_ERROR_VALUE ? IsAnyReady(wait->fds)
+                                              : std::any_of(fd, end, [](const pollfd& entry) {
+                                                    return entry.revents != 0;
+                                                });
+                if (is_ready) {
+                    ready.push_back(wait);
+                }
+                fd = end;
+            }
+
+            lock.lock();
+            for (const auto& wait : ready) {
+                wait->ready = true;
+                waits.erase(std::remove(waits.begin(), waits.end(), wait), waits.end());
+            }
+        }
+    }
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<PendingWait>> waits;
+    bool stop = false;
+};
+
+SocketReactor& GetSocketReactor() {
+    static SocketReactor reactor;
+    return reactor;
+}
+
+} // Anonymous namespace
+
+/// Replies to a suspended blocking call once its client thread woke up
+class SOC_U::BlockingCallCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    BlockingCallCallback(std::shared_ptr<SOC_U> soc_, std::shared_ptr<PendingWait> wait_)
+        : soc(std::move(soc_)), wait(std::move(wait_)) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        soc->ResumeBlockingCall(ctx, wait);
+    }
+
+private:
+    std::shared_ptr<SOC_U> soc;
+    std::shared_ptr<PendingWait> wait;
+
+    BlockingCallCallback() = default;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& boost::serialization::base_object<Kernel::HLERequestContext::WakeupCallback>(*this);
+        ar& soc;
+        ar& wait;
+    }
+    friend class boost::serialization::access;
+};
+
+template <class Archive>
+void SOC_U::SuspendedCall::serialize(Archive& ar, const unsigned int) {
+    ar& wait;
+    ar& event;
+}
+
+template <class Archive>
+void SOC_U::serialize(Archive& ar, const unsigned int) {
+    ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
+    ar& open_sockets;
+    ar& suspended_calls;
+    if (Archive::is_loading::value) {
+        for (const auto& call : suspended_calls) {
+            if (!call.wait->ready && !call.wait->fds.empty()) {
+                GetSocketReactor().Add(call.wait);
+            }
+        }
+    }
+}
+SERIALIZE_IMPL(SOC_U)
+
 void SOC_U::CleanupSockets() {
     for (auto sock : open_sockets)
         closesocket(sock.second.socket_fd);
     open_sockets.clear();
+
+    // Calls waiting on the closed sockets fail once they resume
+    for (const auto& call : suspended_calls) {
+        GetSocketReactor().Remove(call.wait);
+        call.wait->ready = true;
+    }
+}
+
+bool SOC_U::IsBlocking(u32 socket_handle) const {
+#ifdef _WIN32
+    const auto iter = open_sockets.find(socket_handle);
+    return iter == open_sockets.end() || iter->second.blocking;
+#else
+    const int flags = ::fcntl(socket_handle, F_GETFL, 0);
+    return flags != SOCKET_ERROR_VALUE && (flags & O_NONBLOCK) == 0;
+#endif
+}
+
+void SOC_U::SuspendBlockingCall(Kernel::HLERequestContext& ctx, const char* reason,
+                                std::shared_ptr<PendingWait> wait,
+                                std::chrono::nanoseconds timeout) {
+    if (suspended_calls.empty()) {
+        system.CoreTiming().UnscheduleEvent(wake_event, 0);
+        system.CoreTiming().ScheduleEvent(WakeCheckPeriod, wake_event);
+    }
+    if (!wait->fds.empty()) {
+        GetSocketReactor().Add(wait);
+    }
+    auto callback = std::make_shared<BlockingCallCallback>(
+        std::static_pointer_cast<SOC_U>(shared_from_this()), wait);
+    auto event = ctx.SleepClientThread(reason, timeout, std::move(callback));
+    suspended_calls.push_back({std::move(wait), std::move(event)});
+}
+
+void SOC_U::ResumeBlockingCall(Kernel::HLERequestContext& ctx,
+                               const std::shared_ptr<PendingWait>& wait) {
+    // The call may have timed out rather than become ready
+    GetSocketReactor().Remove(wait);
+    suspended_calls.erase(std::remove_if(suspended_calls.begin(), suspended_calls.end(),
+                                         [&wait](const SuspendedCall& call) {
+                                             return call.wait == wait;
+                                         }),
+                          suspended_calls.end());
+
+    resuming = true;
+    SCOPE_EXIT({ resuming = false; });
+    switch (ctx.CommandBuffer()[0] >> 16) {
+    case 0x04:
+        Accept(ctx);
+        break;
+    case 0x06:
+        Connect(ctx);
+        break;
+    case 0x07:
+        RecvFromOther(ctx);
+        break;
+    case 0x08:
+        RecvFrom(ctx);
+        break;
+    case 0x14:
+        Poll(ctx);
+        break;
+    default:
+        UNREACHABLE_MSG("Unexpected suspended call 0x{:08X}", ctx.CommandBuffer()[0]);
+    }
+}
+
+void SOC_U::WakeReadyCalls(u64 userdata, s64 cycles_late) {
+    // Signaling runs the wakeup callbacks, which remove their call, so the ready ones are taken
+    // out of the list first
+    std::vector<std::shared_ptr<Kernel::Event>> ready_events;
+    std::vector<SuspendedCall> still_suspended;
+    for (auto& call : suspended_calls) {
+        if (call.wait->ready) {
+            ready_events.push_back(std::move(call.event));
+        } else {
+            still_suspended.push_back(std::move(call));
+        }
+    }
+    suspended_calls = std::move(still_suspended);
+
+    for (const auto& event : ready_events) {
+        event->Signal();
+    }
+
+    if (!suspended_calls.empty()) {
+        system.CoreTiming().ScheduleEvent(WakeCheckPeriod - cycles_late, wake_event);
+    }
 }
 
 void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
@@ -504,13 +800,19 @@ void SOC_U::Listen(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x04, 2, 2);
     const auto socket_handle = rp.Pop<u32>();
     [[maybe_unused]] const auto max_addr_len = static_cast<socklen_t>(rp.Pop<u32>());
     rp.PopPID();
+
+    if (!resuming && IsBlocking(socket_handle)) {
+        auto wait = MakeWait(socket_handle, POLLIN);
+        if (!IsAnyReady(wait->fds)) {
+            SuspendBlockingCall(ctx, "soc::accept", std::move(wait), std::chrono::nanoseconds{0});
+            return;
+        }
+    }
+
     sockaddr addr;
     socklen_t addr_len = sizeof(addr);
     u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
@@ -610,6 +912,15 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     rp.PopPID();
     auto& buffer = rp.PopMappedBuffer();
 
+    if (!resuming && IsBlocking(socket_handle)) {
+        auto wait = MakeWait(socket_handle, POLLIN);
+        if (!IsAnyReady(wait->fds)) {
+            SuspendBlockingCall(ctx, "soc::recvfrom", std::move(wait),
+                                std::chrono::nanoseconds{0});
+            return;
+        }
+    }
+
     CTRSockAddr ctr_src_addr;
     std::vector<u8> output_buff(len);
     std::vector<u8> addr_buff(sizeof(ctr_src_addr));
@@ -644,9 +955,6 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x08, 4, 2);
     u32 socket_handle = rp.Pop<u32>();
     u32 len = rp.Pop<u32>();
@@ -654,6 +962,15 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
 
+    if (!resuming && IsBlocking(socket_handle)) {
+        auto wait = MakeWait(socket_handle, POLLIN);
+        if (!IsAnyReady(wait->fds)) {
+            SuspendBlockingCall(ctx, "soc::recvfrom", std::move(wait),
+                                std::chrono::nanoseconds{0});
+            return;
+        }
+    }
+
     CTRSockAddr ctr_src_addr;
     std::vector<u8> output_buff(len);
     std::vector<u8> addr_buff(sizeof(ctr_src_addr));
@@ -708,7 +1025,16 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
     std::vector<pollfd> platform_pollfd(nfds);
     std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd.begin(), CTRPollFD::ToPlatform);
 
-    s32 ret = ::poll(platform_pollfd.data(), nfds, timeout);
+    // Waiting happens on the reactor, with the client thread suspended, instead of in poll()
+    s32 ret = ::poll(platform_pollfd.data(), nfds, 0);
+    if (ret == 0 && timeout != 0 && !resuming) {
+        auto wait = std::make_shared<PendingWait>();
+        wait->fds = std::move(platform_pollfd);
+        const std::chrono::nanoseconds sleep_timeout =
+            timeout > 0 ? std::chrono::milliseconds{timeout} : std::chrono::nanoseconds{0};
+        SuspendBlockingCall(ctx, "soc::poll", std::move(wait), sleep_timeout);
+        return;
+    }
 
     // Now update the output pollfd structure
     std::transform(platform_pollfd.begin(), platform_pollfd.end(), ctr_fds.begin(),
@@ -789,9 +1115,6 @@ void SOC_U::GetPeerName(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x06, 2, 4);
     const auto socket_handle = rp.Pop<u32>();
     [[maybe_unused]] const auto input_addr_len = rp.Pop<u32>();
@@ -802,9 +1125,36 @@ void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
     std::memcpy(&ctr_input_addr, input_addr_buf.data(), sizeof(ctr_input_addr));
 
     sockaddr input_addr = CTRSockAddr::ToPlatform(ctr_input_addr);
-    s32 ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
-    if (ret != 0)
-        ret = TranslateError(GET_ERRNO);
+    s32 ret = 0;
+    if (resuming) {
+        // The connection was started before the client thread was suspended
+        int error = 0;
+        socklen_t error_len = sizeof(error);
+        ret = ::getsockopt(socket_handle, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error),
+                           &error_len);
+        if (ret != 0) {
+            ret = TranslateError(GET_ERRNO);
+        } else if (error != 0) {
+            ret = TranslateError(error);
+        }
+    } else if (IsBlocking(socket_handle)) {
+        // Start the connection without blocking, and suspend the client thread until it is done
+        SetNonBlocking(socket_handle, true);
+        ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
+        const int error = GET_ERRNO;
+        SetNonBlocking(socket_handle, false);
+        if (ret != 0 && (error == ERRNO(EINPROGRESS) || error == ERRNO(EWOULDBLOCK))) {
+            SuspendBlockingCall(ctx, "soc::connect", MakeWait(socket_handle, POLLOUT),
+                                std::chrono::nanoseconds{0});
+            return;
+        }
+        if (ret != 0)
+            ret = TranslateError(error);
+    } else {
+        ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
+        if (ret != 0)
+            ret = TranslateError(GET_ERRNO);
+    }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
     rb.Push(RESULT_SUCCESS);
@@ -984,7 +1334,7 @@ void SOC_U::GetNameInfoImpl(Kernel::HLERequestContext& ctx) {
     rb.PushStaticBuffer(std::move(serv), 1);
 }
 
-SOC_U::SOC_U() : ServiceFramework("soc:U") {
+SOC_U::SOC_U(Core::System& system) : ServiceFramework("soc:U"), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010044, &SOC_U::InitializeSockets, "InitializeSockets"},
         {0x000200C2, &SOC_U::Socket, "Socket"},
@@ -1023,6 +1373,10 @@ SOC_U::SOC_U() : ServiceFramework("soc:U") {
 
     RegisterHandlers(functions);
 
+    wake_event = system.CoreTiming().RegisterEvent(
+        "SOC_U::WakeReadyCalls",
+        [this](u64 userdata, s64 cycles_late) { WakeReadyCalls(userdata, cycles_late); });
+
 #ifdef _WIN32
     WSADATA data;
     WSAStartup(MAKEWORD(2, 2), &data);
@@ -1038,7 +1392,7 @@ SOC_U::~SOC_U() {
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<SOC_U>()->InstallAsService(service_manager);
+    std::make_shared<SOC_U>(system)->InstallAsService(service_manager);
 }
 
 } // namespace Service::SOC
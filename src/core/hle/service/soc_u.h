@@ -4,17 +4,27 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include <boost/serialization/unordered_map.hpp>
 #include "core/hle/service/service.h"
 
 namespace Core {
 class System;
+struct TimingEventType;
+} // namespace Core
+
+namespace Kernel {
+class Event;
 }
 
 namespace Service::SOC {
 
 /// Holds information about a particular socket
+struct PendingWait;
+
 struct SocketHolder {
     u32 socket_fd; ///< The socket descriptor
     bool blocking; ///< Whether the socket is blocking or not, it is only read on Windows.
@@ -30,10 +40,23 @@ private:
 
 class SOC_U final : public ServiceFramework<SOC_U> {
 public:
-    SOC_U();
+    explicit SOC_U(Core::System& system);
     ~SOC_U();
 
+    class BlockingCallCallback;
+
 private:
+    /// A guest thread suspended in a blocking call, and the event that resumes it
+    struct SuspendedCall {
+        std::shared_ptr<PendingWait> wait;
+        std::shared_ptr<Kernel::Event> event;
+
+    private:
+        template <class Archive>
+        void serialize(Archive& ar, const unsigned int);
+        friend class boost::serialization::access;
+    };
+
     void Socket(Kernel::HLERequestContext& ctx);
     void Bind(Kernel::HLERequestContext& ctx);
     void Fcntl(Kernel::HLERequestContext& ctx);
@@ -62,14 +85,37 @@ private:
     /// Close all open sockets
     void CleanupSockets();
 
+    /// Returns whether calls on the socket block until they can complete
+    bool IsBlocking(u32 socket_handle) const;
+
+    /**
+     * Suspends the client thread until one of the sockets of the wait is ready or the timeout
+     * expires (a zero timeout waits forever). The request handler then runs again, with resuming
+     * set, to reply.
+     */
+    void SuspendBlockingCall(Kernel::HLERequestContext& ctx, const char* reason,
+                             std::shared_ptr<PendingWait> wait, std::chrono::nanoseconds timeout);
+
+    /// Runs the request handler of a suspended call again, once its client thread woke up
+    void ResumeBlockingCall(Kernel::HLERequestContext& ctx,
+                            const std::shared_ptr<PendingWait>& wait);
+
+    /// Signals the suspended calls whose sockets became ready
+    void WakeReadyCalls(u64 userdata, s64 cycles_late);
+
+    Core::System& system;
+    Core::TimingEventType* wake_event;
+
     /// Holds info about the currently open sockets
     std::unordered_map<u32, SocketHolder> open_sockets;
 
+    std::vector<SuspendedCall> suspended_calls;
+
+    /// Set while the handler of a suspended call runs again, which must then not block
+    bool resuming = false;
+
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
-        ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
-        ar& open_sockets;
-    }
+    void serialize(Archive& ar, const unsigned int);
     friend class boost::serialization::access;
 };
 
@@ -78,3 +124,5 @@ void InstallInterfaces(Core::System& system);
 } // namespace Service::SOC
 
 BOOST_CLASS_EXPORT_KEY(Service::SOC::SOC_U)
+BOOST_CLASS_EXPORT_KEY(Service::SOC::SOC_U::BlockingCallCallback)
+SERVICE_CONSTRUCT(Service::SOC::SOC_U)
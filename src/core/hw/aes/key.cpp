@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -495,16 +496,16 @@ void LoadPresetKeys() {
 } // namespace
 
 void InitKeys() {
-    static bool initialized = false;
-    if (initialized)
-        return;
-    initialized = true;
-    HW::RSA::InitSlots();
-    LoadBootromKeys();
-    LoadNativeFirmKeysOld3DS();
-    LoadSafeModeNativeFirmKeysOld3DS();
-    LoadNativeFirmKeysNew3DS();
-    LoadPresetKeys();
+    // Loaders may be opened from several threads at once, e.g. by the game list
+    static std::once_flag initialized;
+    std::call_once(initialized, [] {
+        HW::RSA::InitSlots();
+        LoadBootromKeys();
+        LoadNativeFirmKeysOld3DS();
+        LoadSafeModeNativeFirmKeysOld3DS();
+        LoadNativeFirmKeysNew3DS();
+        LoadPresetKeys();
+    });
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstring>
 #include <numeric>
 #include <type_traits>
+#include <utility>
 #include "common/alignment.h"
 #include "common/color.h"
 #include "common/common_types.h"
@@ -14,12 +16,13 @@
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp.h"
+#include "core/hle/service/hid/hid.h"
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
 #include "core/tracer/recorder.h"
-#include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/utils.h"
@@ -27,11 +30,16 @@
 
 namespace GPU {
 
-Regs g_regs;
-Memory::MemorySystem* g_memory;
+INSTANCE_LOCAL Regs g_regs;
+INSTANCE_LOCAL Memory::MemorySystem* g_memory;
 
 /// Event id for CoreTiming
-static Core::TimingEventType* vblank_event;
+static INSTANCE_LOCAL Core::TimingEventType* vblank_event;
+/// Event id for CoreTiming, fires when command lists processed on the GPU thread are expected done
+static INSTANCE_LOCAL Core::TimingEventType* command_list_event;
+
+/// Emulated time given to the GPU thread before a submitted command list must have completed
+constexpr u64 command_list_ticks = BASE_CLOCK_RATE_ARM11 / 1000;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -70,9 +78,126 @@ static Common::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* sr
     }
 }
 
+/// Converts texels between two formats that only differ in their byte layout
+using TexelCopyFn = void (*)(const u8* src, u8* dst, u32 count);
+
+template <u32 bytes_per_pixel>
+static void CopyTexels(const u8* src, u8* dst, u32 count) {
+    std::memcpy(dst, src, count * bytes_per_pixel);
+}
+
+static void CopyTexelsRGBA8ToRGB8(const u8* src, u8* dst, u32 count) {
+    // Drops the alpha, which is stored in the first byte
+    for (u32 i = 0; i < count; ++i) {
+        std::memcpy(dst + i * 3, src + i * 4 + 1, 3);
+    }
+}
+
+/// Returns the function converting texels between the formats without decoding them, if any
+static TexelCopyFn GetTexelCopyFn(Regs::PixelFormat input_format, Regs::PixelFormat output_format) {
+    if (input_format == output_format) {
+        switch (Regs::BytesPerPixel(input_format)) {
+        case 2:
+            return CopyTexels<2>;
+        case 3:
+            return CopyTexels<3>;
+        case 4:
+            return CopyTexels<4>;
+        }
+    } else if (input_format == Regs::PixelFormat::RGBA8 &&
+               output_format == Regs::PixelFormat::RGB8) {
+        return CopyTexelsRGBA8ToRGB8;
+    }
+    return nullptr;
+}
+
+/// Returns the offsets of the input and output texels of a display transfer at the given position
+static std::pair<u32, u32> GetTransferOffsets(const Regs::DisplayTransferConfig& config,
+                                              u32 input_x, u32 input_y, u32 x, u32 output_y,
+                                              u32 output_width) {
+    const u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+    const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+
+    if (config.input_linear) {
+        const u32 src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+        if (!config.dont_swizzle) {
+            // Interpret the input as linear and the output as tiled
+            const u32 coarse_y = output_y & ~7;
+            const u32 stride = output_width * dst_bytes_per_pixel;
+            return {src_offset,
+                    VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                        coarse_y * stride};
+        }
+        // Both input and output are linear
+        return {src_offset, (x + output_y * output_width) * dst_bytes_per_pixel};
+    }
+
+    const u32 in_coarse_y = input_y & ~7;
+    const u32 in_stride = config.input_width * src_bytes_per_pixel;
+    const u32 src_offset =
+        VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) + in_coarse_y * in_stride;
+    if (!config.dont_swizzle) {
+        // Interpret the input as tiled and the output as linear
+        return {src_offset, (x + output_y * output_width) * dst_bytes_per_pixel};
+    }
+    // Both input and output are tiled
+    const u32 out_coarse_y = output_y & ~7;
+    const u32 out_stride = output_width * dst_bytes_per_pixel;
+    return {src_offset,
+            VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                out_coarse_y * out_stride};
+}
+
+/**
+ * Display transfer without scaling between formats that only differ in byte layout, the case most
+ * transfers hit. Texels are moved without decoding, two at a time where the tiling keeps them
+ * next to each other.
+ */
+static void CopyDisplayTransfer(const Regs::DisplayTransferConfig& config, TexelCopyFn copy,
+                                const u8* src_pointer, u8* dst_pointer, u32 output_width,
+                                u32 output_height) {
+    const u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+    const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+
+    for (u32 y = 0; y < output_height; ++y) {
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+        if (config.input_linear && config.dont_swizzle) {
+            copy(src_pointer + y * config.input_width * src_bytes_per_pixel,
+                 dst_pointer + output_y * output_width * dst_bytes_per_pixel, output_width);
+            continue;
+        }
+
+        // Horizontal pairs of texels are adjacent in the Morton order
+        for (u32 x = 0; x < output_width; x += 2) {
+            const auto [src_offset, dst_offset] =
+                GetTransferOffsets(config, x, y, x, output_y, output_width);
+            copy(src_pointer + src_offset, dst_pointer + dst_offset, 2);
+        }
+    }
+}
+
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
 
+/**
+ * Fills the memory with copies of a value. The value is repeated into a block first, so that the
+ * fill is done by a few large copies, which use the widest stores of the host.
+ */
+static void FillPattern(u8* dst, std::size_t size, const void* value, std::size_t value_size) {
+    // Holds a whole number of 2, 3 and 4 byte values
+    std::array<u8, 192> block;
+    for (std::size_t i = 0; i < block.size(); i += value_size) {
+        std::memcpy(block.data() + i, value, value_size);
+    }
+
+    std::size_t offset = 0;
+    for (; offset + block.size() <= size; offset += block.size()) {
+        std::memcpy(dst + offset, block.data(), block.size());
+    }
+    std::memcpy(dst + offset, block.data(), size - offset);
+}
+
 static void MemoryFill(const Regs::MemoryFillConfig& config) {
     const PAddr start_addr = config.GetStartAddress();
     const PAddr end_addr = config.GetEndAddress();
@@ -103,26 +228,21 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     Memory::RasterizerInvalidateRegion(config.GetStartAddress(),
                                        config.GetEndAddress() - config.GetStartAddress());
 
+    const std::size_t length = end - start;
     if (config.fill_24bit) {
-        // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
+        // fill with 24-bit values, the last of which may extend past the end
+        const std::array<u8, 3> value{static_cast<u8>(config.value_24bit_r),
+                                      static_cast<u8>(config.value_24bit_g),
+                                      static_cast<u8>(config.value_24bit_b)};
+        FillPattern(start, Common::AlignUp(length, 3), value.data(), value.size());
     } else if (config.fill_32bit) {
         // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
+        const u32 value = config.value_32bit;
+        FillPattern(start, Common::AlignDown(length, sizeof(u32)), &value, sizeof(u32));
     } else {
-        // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
+        // fill with 16-bit values, the last of which may extend past the end
+        const u16 value = config.value_16bit.Value();
+        FillPattern(start, Common::AlignUp(length, sizeof(u16)), &value, sizeof(u16));
     }
 }
 
@@ -193,6 +313,15 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
+    const bool both_linear = config.input_linear && config.dont_swizzle;
+    if (config.scaling == config.NoScale && (both_linear || output_width % 2 == 0)) {
+        if (const auto copy = GetTexelCopyFn(config.input_format, config.output_format)) {
+            CopyDisplayTransfer(config, copy, src_pointer, dst_pointer, output_width,
+                                output_height);
+            return;
+        }
+    }
+
     for (u32 y = 0; y < output_height; ++y) {
         for (u32 x = 0; x < output_width; ++x) {
             Common::Vec4<u8> src_color;
@@ -212,48 +341,9 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
                 output_y = y;
             }
 
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
+            const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+            const auto [src_offset, dst_offset] =
+                GetTransferOffsets(config, input_x, input_y, x, output_y, output_width);
 
             const u8* src_pixel = src_pointer + src_offset;
             src_color = DecodePixel(config.input_format, src_pixel);
@@ -470,7 +560,14 @@ inline void Write(u32 addr, const T data) {
         if (config.trigger & 1) {
             MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
 
-            Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(), config.size);
+            const auto submit_start = Core::PerfStats::Clock::now();
+            VideoCore::GPUThread::SubmitCommandList(config.GetPhysicalAddress(), config.size);
+            Core::System::GetInstance().perf_stats->AddGpuSubmitTime(
+                Core::PerfStats::Clock::now() - submit_start);
+            if (VideoCore::GPUThread::IsActive()) {
+                Core::System::GetInstance().CoreTiming().ScheduleEvent(command_list_ticks,
+                                                                       command_list_event);
+            }
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -502,17 +599,27 @@ template void Write<u32>(u32 addr, const u32 data);
 template void Write<u16>(u32 addr, const u16 data);
 template void Write<u8>(u32 addr, const u8 data);
 
+/// Delivers the interrupts of command lists processed on the GPU thread
+static void CommandListCallback(u64 userdata, s64 cycles_late) {
+    VideoCore::GPUThread::Synchronize();
+}
+
 /// Update hardware
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
+    VideoCore::GPUThread::Synchronize();
     VideoCore::g_renderer->SwapBuffers();
 
+    // Sample the input for the guest woken by the interrupts below
+    if (const auto hid = Service::HID::GetModule(Core::System::GetInstance())) {
+        hid->OnVBlank(cycles_late);
+    }
+
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
     // screen, or if both use the same interrupts and these two instead determine the
     // beginning and end of the VBlank period. If needed, split the interrupt firing into
     // two different intervals.
-    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC0);
-    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC1);
+    Service::GSP::SignalVBlankInterrupts();
 
     // Reschedule recurrent event
     Core::System::GetInstance().CoreTiming().ScheduleEvent(frame_ticks - cycles_late, vblank_event);
@@ -551,6 +658,7 @@ void Init(Memory::MemorySystem& memory) {
 
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     vblank_event = timing.RegisterEvent("GPU::VBlankCallback", VBlankCallback);
+    command_list_event = timing.RegisterEvent("GPU::CommandListCallback", CommandListCallback);
     timing.ScheduleEvent(frame_ticks, vblank_event);
 
     LOG_DEBUG(HW_GPU, "initialized OK");
@@ -12,7 +12,7 @@
 
 namespace LCD {
 
-Regs g_regs;
+INSTANCE_LOCAL Regs g_regs;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -80,7 +80,7 @@ ASSERT_REG_POSITION(backlight_bottom, 0x290);
 #undef ASSERT_REG_POSITION
 #endif // !defined(_MSC_VER)
 
-extern Regs g_regs;
+extern INSTANCE_LOCAL Regs g_regs;
 
 template <typename T>
 void Read(T& var, const u32 addr);
@@ -2,16 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <boost/container/static_vector.hpp>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
+#include <boost/serialization/vector.hpp>
 #include "audio_core/dsp_interface.h"
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
+#include "common/virtual_buffer.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/global.h"
@@ -32,7 +39,9 @@ namespace Memory {
 
 void PageTable::Clear() {
     pointers.raw.fill(nullptr);
-    pointers.refs.fill(MemoryRef());
+    for (auto& block : pointers.refs) {
+        block.reset();
+    }
     attributes.fill(PageType::Unmapped);
 }
 
@@ -44,6 +53,13 @@ public:
             *p = cached;
     }
 
+    /// Marks num_pages pages from addr, which must all be in the same region
+    void MarkRange(VAddr addr, u32 num_pages, bool cached) {
+        bool* p = At(addr);
+        if (p)
+            std::fill_n(p, num_pages, cached);
+    }
+
     bool IsCached(VAddr addr) {
         bool* p = At(addr);
         if (p)
@@ -79,13 +95,34 @@ private:
     }
 };
 
+namespace {
+
+/// State of the delta savestate being saved or loaded, if any
+struct DeltaSerialization {
+    bool active = false;
+    /// Base RAM contents, laid out like the page hashes. Only used when loading.
+    std::unique_ptr<u8[]> base_ram;
+    std::vector<u64> base_page_hashes;
+    /// Set for a run-ahead savestate, which does not store RAM
+    bool run_ahead = false;
+} delta_serialization;
+
+/// RAM contents at the newest run-ahead save, laid out like the page hashes. Kept apart from the
+/// MemorySystem, which is recreated when a savestate is loaded.
+struct RunAheadReference {
+    std::unique_ptr<Common::VirtualBuffer<u8>> ram;
+    u64 generation = 0;
+} run_ahead_reference;
+
+} // Anonymous namespace
+
 class MemorySystem::Impl {
 public:
-    // Visual Studio would try to allocate these on compile time if they are std::array, which would
-    // exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    // The RAM is allocated from host virtual memory, so the pages the application never touches,
+    // most of FCRAM for many titles, take no physical memory.
+    Common::VirtualBuffer<u8> fcram{Memory::FCRAM_N3DS_SIZE};
+    Common::VirtualBuffer<u8> vram{Memory::VRAM_SIZE};
+    Common::VirtualBuffer<u8> n3ds_extra_ram{Memory::N3DS_EXTRA_RAM_SIZE};
 
     std::shared_ptr<PageTable> current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
@@ -98,6 +135,15 @@ public:
     std::shared_ptr<BackingMem> n3ds_extra_ram_mem;
     std::shared_ptr<BackingMem> dsp_mem;
 
+    /// Hash of every page of VRAM, FCRAM and N3DS extra RAM, in that order. Empty if none taken.
+    std::vector<u64> page_hashes;
+
+    static constexpr std::size_t VRAM_FIRST_PAGE = 0;
+    static constexpr std::size_t FCRAM_FIRST_PAGE = VRAM_FIRST_PAGE + VRAM_SIZE / PAGE_SIZE;
+    static constexpr std::size_t N3DS_FIRST_PAGE = FCRAM_FIRST_PAGE + FCRAM_N3DS_SIZE / PAGE_SIZE;
+    static constexpr std::size_t NUM_HASHED_PAGES =
+        N3DS_FIRST_PAGE + N3DS_EXTRA_RAM_SIZE / PAGE_SIZE;
+
     Impl();
 
     const u8* GetPtr(Region r) const {
@@ -145,17 +191,106 @@ public:
         }
     }
 
+    void SnapshotPageHashes() {
+        page_hashes.resize(NUM_HASHED_PAGES);
+        const auto hash_region = [this](const u8* data, std::size_t size, std::size_t first_page) {
+            for (std::size_t page = 0; page < size / PAGE_SIZE; page++) {
+                page_hashes[first_page + page] =
+                    Common::ComputeFastHash64(data + page * PAGE_SIZE, PAGE_SIZE);
+            }
+        };
+        hash_region(vram.get(), VRAM_SIZE, VRAM_FIRST_PAGE);
+        hash_region(fcram.get(), FCRAM_N3DS_SIZE, FCRAM_FIRST_PAGE);
+        hash_region(n3ds_extra_ram.get(), N3DS_EXTRA_RAM_SIZE, N3DS_FIRST_PAGE);
+    }
+
 private:
+    /// Serializes a region of RAM whole, or only the pages that changed since the snapshot
+    template <class Archive>
+    void SerializeRegion(Archive& ar, u8* data, std::size_t size, std::size_t first_page) {
+        if (delta_serialization.run_ahead) {
+            SyncRunAheadRegion(data, size, first_page, Archive::is_loading::value);
+            return;
+        }
+        if (!delta_serialization.active) {
+            ar& boost::serialization::make_binary_object(data, size);
+            return;
+        }
+
+        std::vector<u32> changed_pages;
+        if (Archive::is_loading::value) {
+            std::memcpy(data, delta_serialization.base_ram.get() + first_page * PAGE_SIZE, size);
+        } else {
+            for (u32 page = 0; page < size / PAGE_SIZE; page++) {
+                const u64 hash = Common::ComputeFastHash64(data + page * PAGE_SIZE, PAGE_SIZE);
+                if (hash != page_hashes[first_page + page]) {
+                    changed_pages.push_back(page);
+                }
+            }
+        }
+        ar& changed_pages;
+        for (const u32 page : changed_pages) {
+            if (page >= size / PAGE_SIZE) {
+                throw std::runtime_error("Invalid page in delta savestate");
+            }
+            ar& boost::serialization::make_binary_object(data + page * PAGE_SIZE, PAGE_SIZE);
+        }
+    }
+
+    /**
+     * Saving copies the pages of a region that differ from the run-ahead reference to it, and
+     * loading copies the reference back. As the RAM was just recreated when loading, the pages
+     * that are still zero in the reference are skipped.
+     */
+    static void SyncRunAheadRegion(u8* data, std::size_t size, std::size_t first_page,
+                                   bool loading) {
+        static const std::array<u8, PAGE_SIZE> zero_page{};
+        u8* const reference = run_ahead_reference.ram->get() + first_page * PAGE_SIZE;
+        for (std::size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            if (loading) {
+                if (std::memcmp(reference + offset, zero_page.data(), PAGE_SIZE) != 0) {
+                    std::memcpy(data + offset, reference + offset, PAGE_SIZE);
+                }
+            } else if (std::memcmp(data + offset, reference + offset, PAGE_SIZE) != 0) {
+                std::memcpy(reference + offset, data + offset, PAGE_SIZE);
+            }
+        }
+    }
+
+    /// Checks that a run-ahead savestate being loaded is the newest one, whose RAM is kept
+    template <class Archive>
+    static void SerializeRunAheadGeneration(Archive& ar) {
+        if (Archive::is_loading::value) {
+            u64 generation = 0;
+            ar& generation;
+            if (!run_ahead_reference.ram || generation != run_ahead_reference.generation) {
+                throw std::runtime_error("Only the newest run-ahead savestate can be loaded");
+            }
+            return;
+        }
+
+        if (!run_ahead_reference.ram) {
+            run_ahead_reference.ram =
+                std::make_unique<Common::VirtualBuffer<u8>>(NUM_HASHED_PAGES * PAGE_SIZE);
+        }
+        u64 generation = ++run_ahead_reference.generation;
+        ar& generation;
+    }
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int file_version) {
         bool save_n3ds_ram = Settings::values.is_new_3ds;
         ar& save_n3ds_ram;
-        ar& boost::serialization::make_binary_object(vram.get(), Memory::VRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+        if (delta_serialization.run_ahead) {
+            SerializeRunAheadGeneration(ar);
+        }
+        SerializeRegion(ar, vram.get(), Memory::VRAM_SIZE, VRAM_FIRST_PAGE);
+        SerializeRegion(ar, fcram.get(),
+                        save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE,
+                        FCRAM_FIRST_PAGE);
+        SerializeRegion(ar, n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0,
+                        N3DS_FIRST_PAGE);
         ar& cache_marker;
         ar& page_table_list;
         // dsp is set from Core::System at startup
@@ -164,6 +299,9 @@ private:
         ar& vram_mem;
         ar& n3ds_extra_ram_mem;
         ar& dsp_mem;
+        if (Archive::is_loading::value && delta_serialization.active) {
+            page_hashes = delta_serialization.base_page_hashes;
+        }
     }
 };
 
@@ -210,6 +348,41 @@ void MemorySystem::serialize(Archive& ar, const unsigned int file_version) {
 
 SERIALIZE_IMPL(MemorySystem)
 
+void MemorySystem::SnapshotPageHashes() {
+    impl->SnapshotPageHashes();
+}
+
+bool MemorySystem::HasPageHashSnapshot() const {
+    return !impl->page_hashes.empty();
+}
+
+void MemorySystem::BeginDeltaSave() {
+    delta_serialization.active = true;
+}
+
+void MemorySystem::BeginDeltaLoad(const MemorySystem& base) {
+    const Impl& base_impl = *base.impl;
+    ASSERT(!base_impl.page_hashes.empty());
+
+    delta_serialization.active = true;
+    delta_serialization.base_ram = std::make_unique<u8[]>(Impl::NUM_HASHED_PAGES * PAGE_SIZE);
+    u8* const base_ram = delta_serialization.base_ram.get();
+    std::memcpy(base_ram + Impl::VRAM_FIRST_PAGE * PAGE_SIZE, base_impl.vram.get(), VRAM_SIZE);
+    std::memcpy(base_ram + Impl::FCRAM_FIRST_PAGE * PAGE_SIZE, base_impl.fcram.get(),
+                FCRAM_N3DS_SIZE);
+    std::memcpy(base_ram + Impl::N3DS_FIRST_PAGE * PAGE_SIZE, base_impl.n3ds_extra_ram.get(),
+                N3DS_EXTRA_RAM_SIZE);
+    delta_serialization.base_page_hashes = base_impl.page_hashes;
+}
+
+void MemorySystem::BeginRunAheadSerialization() {
+    delta_serialization.run_ahead = true;
+}
+
+void MemorySystem::EndDeltaSerialization() {
+    delta_serialization = {};
+}
+
 void MemorySystem::SetCurrentPageTable(std::shared_ptr<PageTable> page_table) {
     impl->current_page_table = page_table;
 }
@@ -226,22 +399,21 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
     RasterizerFlushVirtualRegion(base << PAGE_BITS, size * PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
 
-    u32 end = base + size;
-    while (base != end) {
-        ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
+    const u32 end = base + size;
+    ASSERT_MSG(end >= base && end <= PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}",
+               base);
 
-        page_table.attributes[base] = type;
-        page_table.pointers[base] = memory;
+    // The whole range is written at once, then the pages that are rasterizer-cached are marked
+    std::fill(page_table.attributes.begin() + base, page_table.attributes.begin() + end, type);
+    page_table.pointers.SetRange(base, size, std::move(memory));
 
-        // If the memory to map is already rasterizer-cached, mark the page
-        if (type == PageType::Memory && impl->cache_marker.IsCached(base * PAGE_SIZE)) {
-            page_table.attributes[base] = PageType::RasterizerCachedMemory;
-            page_table.pointers[base] = nullptr;
+    if (type == PageType::Memory) {
+        for (u32 page = base; page != end; ++page) {
+            if (impl->cache_marker.IsCached(page * PAGE_SIZE)) {
+                page_table.attributes[page] = PageType::RasterizerCachedMemory;
+                page_table.pointers[page] = nullptr;
+            }
         }
-
-        base += 1;
-        if (memory != nullptr && memory.GetSize() > PAGE_SIZE)
-            memory += PAGE_SIZE;
     }
 }
 
@@ -504,24 +676,51 @@ MemoryRef MemorySystem::GetPhysicalRef(PAddr address) const {
 }
 
 /// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
-static std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr) {
-    if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
-        return {addr - VRAM_PADDR + VRAM_VADDR};
-    }
-    if (addr >= FCRAM_PADDR && addr < FCRAM_PADDR_END) {
-        return {addr - FCRAM_PADDR + LINEAR_HEAP_VADDR, addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
-    }
-    if (addr >= FCRAM_PADDR_END && addr < FCRAM_N3DS_PADDR_END) {
-        return {addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
-    }
+/// Consecutive virtual pages that back a physical range
+struct RasterizerSpan {
+    VAddr vaddr;
+    u32 num_pages;
+};
+
+/**
+ * Returns where the pages of a physical range are visible to the rasterizer cache. FCRAM is
+ * visible both in the old and the new linear heap, so a range may have several spans.
+ */
+static boost::container::static_vector<RasterizerSpan, 4> PhysicalToVirtualSpansForRasterizer(
+    PAddr start, u32 num_pages) {
+    boost::container::static_vector<RasterizerSpan, 4> spans;
+    const u64 start_page = start >> PAGE_BITS;
+    const u64 end_page = start_page + num_pages;
+    u64 num_found = 0;
+    const auto add_region = [&](PAddr region_start, PAddr region_end,
+                                std::initializer_list<VAddr> vaddrs) {
+        const u64 first = std::max<u64>(start_page, region_start >> PAGE_BITS);
+        const u64 last = std::min<u64>(end_page, region_end >> PAGE_BITS);
+        if (first >= last) {
+            return;
+        }
+        num_found += last - first;
+        for (const VAddr vaddr : vaddrs) {
+            spans.push_back({static_cast<VAddr>(vaddr + ((first << PAGE_BITS) - region_start)),
+                             static_cast<u32>(last - first)});
+        }
+    };
+    add_region(VRAM_PADDR, VRAM_PADDR_END, {VRAM_VADDR});
+    add_region(FCRAM_PADDR, FCRAM_PADDR_END, {LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_VADDR});
+    add_region(FCRAM_PADDR_END, FCRAM_N3DS_PADDR_END,
+               {NEW_LINEAR_HEAP_VADDR + (FCRAM_PADDR_END - FCRAM_PADDR)});
+
     // While the physical <-> virtual mapping is 1:1 for the regions supported by the cache,
     // some games (like Pokemon Super Mystery Dungeon) will try to use textures that go beyond
     // the end address of VRAM, causing the Virtual->Physical translation to fail when flushing
     // parts of the texture.
-    LOG_ERROR(HW_Memory,
-              "Trying to use invalid physical address for rasterizer: {:08X} at PC 0x{:08X}", addr,
-              Core::GetRunningCore().GetPC());
-    return {};
+    if (num_found != num_pages) {
+        LOG_ERROR(HW_Memory,
+                  "Trying to use invalid physical address for rasterizer: {:08X} ({} pages) at PC "
+                  "0x{:08X}",
+                  start, num_pages, Core::GetRunningCore().GetPC());
+    }
+    return spans;
 }
 
 void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
@@ -529,46 +728,36 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
-    u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
-    PAddr paddr = start;
-
-    for (unsigned i = 0; i < num_pages; ++i, paddr += PAGE_SIZE) {
-        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
-            impl->cache_marker.Mark(vaddr, cached);
-            for (auto page_table : impl->page_table_list) {
-                PageType& page_type = page_table->attributes[vaddr >> PAGE_BITS];
-
-                if (cached) {
-                    // Switch page type to cached if now cached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::Memory:
-                        page_type = PageType::RasterizerCachedMemory;
-                        page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
-                        break;
-                    default:
-                        UNREACHABLE();
-                    }
+    const u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
+    const PageType from = cached ? PageType::Memory : PageType::RasterizerCachedMemory;
+    const PageType to = cached ? PageType::RasterizerCachedMemory : PageType::Memory;
+
+    for (const auto& span : PhysicalToVirtualSpansForRasterizer(start, num_pages)) {
+        impl->cache_marker.MarkRange(span.vaddr, span.num_pages, cached);
+
+        const std::size_t first_page = span.vaddr >> PAGE_BITS;
+        const std::size_t end_page = first_page + span.num_pages;
+        for (auto& page_table : impl->page_table_list) {
+            auto& attributes = page_table->attributes;
+            // Pages are switched in runs of the same type, which are mapped consecutively
+            for (std::size_t page = first_page; page < end_page;) {
+                const PageType type = attributes[page];
+                const std::size_t run_end =
+                    std::find_if_not(attributes.begin() + page, attributes.begin() + end_page,
+                                     [type](PageType other) { return other == type; }) -
+                    attributes.begin();
+                if (type == from) {
+                    const VAddr vaddr = static_cast<VAddr>(page << PAGE_BITS);
+                    std::fill(attributes.begin() + page, attributes.begin() + run_end, to);
+                    page_table->pointers.SetRange(
+                        page, run_end - page,
+                        cached ? MemoryRef{} : GetPointerForRasterizerCache(vaddr));
                 } else {
-                    // Switch page type to uncached if now uncached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::RasterizerCachedMemory: {
-                        page_type = PageType::Memory;
-                        page_table->pointers[vaddr >> PAGE_BITS] =
-                            GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
-                        break;
-                    }
-                    default:
-                        UNREACHABLE();
-                    }
+                    // It is not necessary for a process to have this region mapped into its
+                    // address space, for example, a system module need not have a VRAM mapping.
+                    ASSERT(type == PageType::Unmapped);
                 }
+                page = run_end;
             }
         }
     }
@@ -665,6 +854,32 @@ u64 MemorySystem::Read64(const VAddr addr) {
     return Read<u64_le>(addr);
 }
 
+u8* MemorySystem::GetContiguousPointer(const Kernel::Process& process, const VAddr vaddr,
+                                      const std::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    auto& page_table = *process.vm_manager.page_table;
+    const std::size_t first_page = vaddr >> PAGE_BITS;
+    const std::size_t last_page = (vaddr + size - 1) >> PAGE_BITS;
+    if (last_page >= PAGE_TABLE_NUM_ENTRIES) {
+        return nullptr;
+    }
+
+    // Pages without a pointer are unmapped, MMIO or cached by the rasterizer
+    u8* const start = page_table.pointers[first_page];
+    if (start == nullptr) {
+        return nullptr;
+    }
+    for (std::size_t page = first_page + 1; page <= last_page; ++page) {
+        if (page_table.pointers[page] != start + (page - first_page) * PAGE_SIZE) {
+            return nullptr;
+        }
+    }
+    return start + (vaddr & PAGE_MASK);
+}
+
 void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_addr,
                              void* dest_buffer, const std::size_t size) {
     auto& page_table = *process.vm_manager.page_table;
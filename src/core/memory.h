@@ -4,12 +4,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <boost/serialization/array.hpp>
+#include <boost/serialization/is_bitwise_serializable.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 #include <boost/serialization/vector.hpp>
 #include "common/common_types.h"
 #include "common/memory_ref.h"
@@ -87,7 +92,7 @@ struct PageTable {
 
             Entry& operator=(MemoryRef value) {
                 pointers.raw[idx] = value.GetPtr();
-                pointers.refs[idx] = std::move(value);
+                pointers.SetRef(idx, std::move(value));
                 return *this;
             }
 
@@ -104,10 +109,58 @@ struct PageTable {
             return Entry(*this, static_cast<VAddr>(idx));
         }
 
+        /**
+         * Points `count` pages from `first` at consecutive pages of `memory`, or at nothing if it
+         * is null. The references are only written to blocks that are allocated or needed.
+         */
+        void SetRange(std::size_t first, std::size_t count, MemoryRef memory) {
+            const std::size_t end = first + count;
+            if (!memory) {
+                std::fill(raw.begin() + first, raw.begin() + end, nullptr);
+                for (std::size_t idx = first; idx < end;) {
+                    const std::size_t block_end =
+                        std::min(end, (idx / REFS_BLOCK_SIZE + 1) * REFS_BLOCK_SIZE);
+                    if (auto& block = refs[idx / REFS_BLOCK_SIZE]) {
+                        std::fill(block->begin() + idx % REFS_BLOCK_SIZE,
+                                  block->begin() + (block_end - 1) % REFS_BLOCK_SIZE + 1,
+                                  MemoryRef{});
+                    }
+                    idx = block_end;
+                }
+                return;
+            }
+            for (std::size_t idx = first; idx < end; ++idx) {
+                raw[idx] = memory.GetPtr();
+                SetRef(idx, memory);
+                if (memory.GetSize() > PAGE_SIZE) {
+                    memory += PAGE_SIZE;
+                }
+            }
+        }
+
     private:
+        /// Number of pages in each block of `refs`
+        static constexpr std::size_t REFS_BLOCK_SIZE = 1024;
+        using RefsBlock = std::array<MemoryRef, REFS_BLOCK_SIZE>;
+
+        void SetRef(std::size_t idx, MemoryRef value) {
+            auto& block = refs[idx / REFS_BLOCK_SIZE];
+            if (!block) {
+                if (!value) {
+                    return;
+                }
+                block = std::make_unique<RefsBlock>();
+            }
+            (*block)[idx % REFS_BLOCK_SIZE] = std::move(value);
+        }
+
         std::array<u8*, PAGE_TABLE_NUM_ENTRIES> raw;
 
-        std::array<MemoryRef, PAGE_TABLE_NUM_ENTRIES> refs;
+        /**
+         * Blocks of references to the memory backing each page. A block is only allocated once a
+         * page in it is mapped, as most of the address space of a process is usually unmapped.
+         */
+        std::array<std::unique_ptr<RefsBlock>, PAGE_TABLE_NUM_ENTRIES / REFS_BLOCK_SIZE> refs;
 
         friend struct PageTable;
     };
@@ -132,15 +185,93 @@ struct PageTable {
     void Clear();
 
 private:
+    /**
+     * Pages are mapped in ranges of consecutive memory, so a block of references is stored as runs
+     * of them, each written as its length and its first reference. A reference on its own costs a
+     * lookup of its backing memory in the archive.
+     */
+    template <class Archive>
+    static void SaveRefsBlock(Archive& ar, const Pointers::RefsBlock& block) {
+        for (std::size_t first = 0; first < block.size();) {
+            u32 length = 1;
+            while (first + length < block.size() &&
+                   block[first + length].Follows(block[first], length * PAGE_SIZE)) {
+                ++length;
+            }
+            ar << length;
+            ar << block[first];
+            first += length;
+        }
+    }
+
+    template <class Archive>
+    static void LoadRefsBlock(Archive& ar, Pointers::RefsBlock& block) {
+        for (std::size_t first = 0; first < block.size();) {
+            u32 length;
+            MemoryRef ref;
+            ar >> length;
+            ar >> ref;
+            if (length == 0 || length > block.size() - first) {
+                throw std::runtime_error("Invalid page table in savestate");
+            }
+            for (u32 i = 0; i < length; ++i) {
+                block[first + i] = ref ? ref + i * PAGE_SIZE : MemoryRef{};
+            }
+            first += length;
+        }
+    }
+
+    template <class Archive>
+    void save(Archive& ar, const unsigned int) const {
+        for (const auto& block : pointers.refs) {
+            const bool allocated = block != nullptr;
+            ar << allocated;
+            if (allocated) {
+                SaveRefsBlock(ar, *block);
+            }
+        }
+        ar << special_regions;
+        ar << attributes;
+    }
+
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
-        ar& pointers.refs;
-        ar& special_regions;
-        ar& attributes;
+    void load(Archive& ar, const unsigned int file_version) {
+        if (file_version == 0) {
+            // Older savestates store a reference for every page
+            auto refs = std::make_unique<std::array<MemoryRef, PAGE_TABLE_NUM_ENTRIES>>();
+            ar >> *refs;
+            for (auto& block : pointers.refs) {
+                block.reset();
+            }
+            for (std::size_t i = 0; i < PAGE_TABLE_NUM_ENTRIES; i++) {
+                pointers.SetRef(i, std::move((*refs)[i]));
+            }
+        } else {
+            for (auto& block : pointers.refs) {
+                bool allocated;
+                ar >> allocated;
+                if (allocated) {
+                    block = std::make_unique<Pointers::RefsBlock>();
+                    if (file_version == 1) {
+                        ar >> *block;
+                    } else {
+                        LoadRefsBlock(ar, *block);
+                    }
+                } else {
+                    block.reset();
+                }
+            }
+        }
+        ar >> special_regions;
+        ar >> attributes;
+
         for (std::size_t i = 0; i < PAGE_TABLE_NUM_ENTRIES; i++) {
-            pointers.raw[i] = pointers.refs[i].GetPtr();
+            const auto& block = pointers.refs[i / Pointers::REFS_BLOCK_SIZE];
+            pointers.raw[i] = block ? (*block)[i % Pointers::REFS_BLOCK_SIZE].GetPtr() : nullptr;
         }
     }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
     friend class boost::serialization::access;
 };
 
@@ -350,6 +481,13 @@ public:
     u8* GetPointer(VAddr vaddr);
     const u8* GetPointer(VAddr vaddr) const;
 
+    /**
+     * Gets a pointer to a region of the address space of the process, if it is made of regular
+     * memory pages that are contiguous in host memory. Returns nullptr otherwise, in which case the
+     * region has to be accessed through ReadBlock and WriteBlock.
+     */
+    u8* GetContiguousPointer(const Kernel::Process& process, VAddr vaddr, std::size_t size);
+
     bool IsValidPhysicalAddress(PAddr paddr) const;
 
     /// Gets offset in FCRAM from a pointer inside FCRAM range
@@ -377,6 +515,37 @@ public:
 
     void SetDSP(AudioCore::DspInterface& dsp);
 
+    /**
+     * Records a hash of every page of emulated RAM. Delta savestates only store the pages that
+     * differ from the recorded contents.
+     */
+    void SnapshotPageHashes();
+
+    /// Returns true if page hashes have been recorded
+    bool HasPageHashSnapshot() const;
+
+    /**
+     * Until EndDeltaSerialization, makes saving a MemorySystem only store the pages of RAM that
+     * differ from its page hash snapshot.
+     */
+    static void BeginDeltaSave();
+
+    /**
+     * Until EndDeltaSerialization, makes loading a MemorySystem expect only the changed pages of
+     * RAM. The others, and the page hash snapshot, are copied from `base` beforehand, as the system
+     * memory is recreated while loading.
+     */
+    static void BeginDeltaLoad(const MemorySystem& base);
+
+    /**
+     * Until EndDeltaSerialization, makes saving and loading a MemorySystem keep its RAM in a copy
+     * held by the core instead of the savestate. Saving only updates the pages that changed since
+     * the previous run-ahead save, and only the newest run-ahead savestate can be loaded.
+     */
+    static void BeginRunAheadSerialization();
+
+    static void EndDeltaSerialization();
+
 private:
     template <typename T>
     T Read(const VAddr vaddr);
@@ -412,6 +581,13 @@ bool IsValidVirtualAddress(const Kernel::Process& process, VAddr vaddr);
 
 } // namespace Memory
 
+BOOST_CLASS_VERSION(Memory::PageTable, 2)
+
+// Lets page attributes be stored as one block. Each is still written as an int, as it was when
+// they were stored one at a time.
+static_assert(sizeof(Memory::PageType) == sizeof(int));
+BOOST_IS_BITWISE_SERIALIZABLE(Memory::PageType)
+
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::FCRAM>)
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::VRAM>)
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::DSP>)
@@ -0,0 +1,93 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "core/memory.h"
+#include "core/memory_watch.h"
+
+namespace Core {
+
+MemoryWatch::MemoryWatch(Memory::MemorySystem& memory) : memory(memory) {}
+
+MemoryWatch::~MemoryWatch() = default;
+
+u32 MemoryWatch::AddWatch(VAddr address, u32 size) {
+    std::scoped_lock lock{watches_mutex};
+    if (size == 0 || size > MaxWatchedBytes - watched_bytes) {
+        return 0;
+    }
+
+    const u32 id = next_id++;
+    watches.push_back({id, address, size, 0});
+    watched_bytes += size;
+    layout_version++;
+    has_watches = true;
+    return id;
+}
+
+bool MemoryWatch::RemoveWatch(u32 id) {
+    std::scoped_lock lock{watches_mutex};
+    const auto it = std::find_if(watches.begin(), watches.end(),
+                                 [id](const Watch& watch) { return watch.id == id; });
+    if (it == watches.end()) {
+        return false;
+    }
+
+    watched_bytes -= it->size;
+    watches.erase(it);
+    layout_version++;
+    has_watches = !watches.empty();
+    return true;
+}
+
+void MemoryWatch::Capture(const Kernel::Process& process) {
+    if (!has_watches && !published_watches) {
+        return;
+    }
+
+    {
+        // The back buffer holds the layout of the frame before the previous one
+        std::scoped_lock lock{watches_mutex};
+        if (back.layout_version != layout_version) {
+            back.watches = watches;
+            std::size_t offset = 0;
+            for (Watch& watch : back.watches) {
+                watch.offset = offset;
+                offset += watch.size;
+            }
+            back.data.resize(offset);
+            back.layout_version = layout_version;
+        }
+    }
+
+    for (const Watch& watch : back.watches) {
+        memory.ReadBlock(process, watch.address, back.data.data() + watch.offset, watch.size);
+    }
+    back.frame = ++frame_count;
+    published_watches = !back.watches.empty();
+
+    std::scoped_lock lock{front_mutex};
+    std::swap(front, back);
+}
+
+bool MemoryWatch::Read(u32 id, u8* dest) const {
+    std::scoped_lock lock{front_mutex};
+    // Ids are handed out in increasing order, so the watches are sorted by them
+    const auto it = std::lower_bound(front.watches.begin(), front.watches.end(), id,
+                                     [](const Watch& watch, u32 id) { return watch.id < id; });
+    if (it == front.watches.end() || it->id != id) {
+        return false;
+    }
+
+    std::memcpy(dest, front.data.data() + it->offset, it->size);
+    return true;
+}
+
+u64 MemoryWatch::GetFrameCount() const {
+    std::scoped_lock lock{front_mutex};
+    return front.frame;
+}
+
+} // namespace Core
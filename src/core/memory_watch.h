@@ -0,0 +1,97 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Kernel {
+class Process;
+}
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace Core {
+
+/**
+ * Ranges of emulated memory that are copied at the end of every game frame, so that scripting
+ * clients read a consistent view of them without racing the emulated CPU. All ranges are copied in
+ * one pass into a back buffer, which is then swapped with the one readers see.
+ */
+class MemoryWatch {
+public:
+    /// Bytes that may be watched in total, which bounds the time spent copying per frame
+    static constexpr std::size_t MaxWatchedBytes = 1024 * 1024;
+
+    explicit MemoryWatch(Memory::MemorySystem& memory);
+    ~MemoryWatch();
+
+    /**
+     * Registers a range to copy from the next frame on.
+     * @return The id of the watch, or 0 if the range is empty or too large.
+     */
+    u32 AddWatch(VAddr address, u32 size);
+
+    /// Stops watching a range. Returns false if there was no such watch
+    bool RemoveWatch(u32 id);
+
+    /// Copies the watched ranges of the process. Called by the emulation thread at each frame end
+    void Capture(const Kernel::Process& process);
+
+    /**
+     * Copies a watched range as of the last captured frame to `dest`, which must hold the size it
+     * was registered with.
+     * @return false if the watch was not captured yet.
+     */
+    bool Read(u32 id, u8* dest) const;
+
+    /// Returns the number of frames captured so far
+    u64 GetFrameCount() const;
+
+private:
+    struct Watch {
+        u32 id;
+        VAddr address;
+        u32 size;
+        /// Position of the range in the snapshot data
+        std::size_t offset;
+    };
+
+    struct Snapshot {
+        /// Sorted by id
+        std::vector<Watch> watches;
+        std::vector<u8> data;
+        u64 frame = 0;
+        /// Value of layout_version that the watches were copied at
+        u64 layout_version = 0;
+    };
+
+    Memory::MemorySystem& memory;
+
+    mutable std::mutex watches_mutex;
+    std::vector<Watch> watches;
+    std::size_t watched_bytes = 0;
+    u32 next_id = 1;
+    /// Incremented whenever the watches change
+    u64 layout_version = 0;
+    std::atomic<bool> has_watches{false};
+
+    /// Only accessed by the emulation thread
+    Snapshot back;
+    u64 frame_count = 0;
+    /// Whether the front buffer holds any watch, which is cleared on the frame after the last one
+    /// is removed
+    bool published_watches = false;
+
+    mutable std::mutex front_mutex;
+    Snapshot front;
+};
+
+} // namespace Core
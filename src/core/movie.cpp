@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include <boost/optional.hpp>
+#include <boost/serialization/vector.hpp>
 #include <cryptopp/hex.h>
 #include <cryptopp/osrng.h>
 #include "common/bit_field.h"
@@ -129,17 +130,38 @@ struct CTMHeader {
 static_assert(sizeof(CTMHeader) == 256, "CTMHeader should be 256 bytes");
 #pragma pack(pop)
 
-static u64 GetInputCount(const std::vector<u8>& input) {
+/// Inputs are read and written in chunks of this many bytes, a whole number of controller states
+constexpr std::size_t INPUT_CHUNK_SIZE = sizeof(ControllerState) * 8192;
+
+/// FNV-1a, whose values never change, so that savestates keep matching the movies they were made of
+constexpr u64 INPUT_HASH_SEED = 0xCBF29CE484222325;
+static u64 HashInput(u64 hash, const u8* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3;
+    }
+    return hash;
+}
+
+/// Counts the pad states in the size bytes of input that follow the header of file
+static u64 GetInputCount(FileUtil::IOFile& file, u64 size) {
+    file.Seek(sizeof(CTMHeader), SEEK_SET);
+    std::vector<u8> chunk(INPUT_CHUNK_SIZE);
     u64 input_count = 0;
-    for (std::size_t pos = 0; pos < input.size(); pos += sizeof(ControllerState)) {
-        if (input.size() < pos + sizeof(ControllerState)) {
+    for (u64 pos = 0; pos + sizeof(ControllerState) <= size; pos += chunk.size()) {
+        const std::size_t chunk_size = static_cast<std::size_t>(
+            std::min<u64>(INPUT_CHUNK_SIZE, size - pos) / sizeof(ControllerState) *
+            sizeof(ControllerState));
+        chunk.resize(chunk_size);
+        if (file.ReadBytes(chunk.data(), chunk_size) != chunk_size) {
             break;
         }
 
-        ControllerState state;
-        std::memcpy(&state, input.data() + pos, sizeof(ControllerState));
-        if (state.type == ControllerStateType::PadAndCircle) {
-            input_count++;
+        for (std::size_t offset = 0; offset < chunk_size; offset += sizeof(ControllerState)) {
+            ControllerState state;
+            std::memcpy(&state, chunk.data() + offset, sizeof(ControllerState));
+            if (state.type == ControllerStateType::PadAndCircle) {
+                input_count++;
+            }
         }
     }
     return input_count;
@@ -156,8 +178,16 @@ void Movie::serialize(Archive& ar, const unsigned int file_version) {
         ar& current_input;
     }
 
-    std::vector<u8> recorded_input_ = recorded_input;
-    ar& recorded_input_;
+    // The inputs themselves stay in the movie file, which the savestate must be a prefix of
+    u64 state_hash = input_hash;
+    if (file_version > 1) {
+        ar& state_hash;
+    } else {
+        std::vector<u8> recorded_input_;
+        ar& recorded_input_;
+        state_hash = HashInput(INPUT_HASH_SEED, recorded_input_.data(),
+                               std::min<std::size_t>(current_byte, recorded_input_.size()));
+    }
 
     ar& init_time;
 
@@ -184,32 +214,34 @@ void Movie::serialize(Archive& ar, const unsigned int file_version) {
     }
 
     if (Archive::is_loading::value && id != 0) {
-        if (!read_only) {
-            recorded_input = std::move(recorded_input_);
-        }
-
         if (post_movie) {
             play_mode = PlayMode::MovieFinished;
             return;
         }
 
-        if (read_only) {
-            if (play_mode == PlayMode::Recording) {
-                SaveMovie();
-            }
-            if (recorded_input_.size() >= recorded_input.size()) {
-                throw std::runtime_error("Future event savestate not allowed in R/O mode");
-            }
-            // Ensure that the current movie and savestate movie are in the same timeline
-            if (std::mismatch(recorded_input_.begin(), recorded_input_.end(),
-                              recorded_input.begin())
-                    .first != recorded_input_.end()) {
-                throw std::runtime_error("Timeline mismatch not allowed in R/O mode");
-            }
+        if (play_mode == PlayMode::Recording) {
+            SaveMovie();
+        }
+        if (read_only && current_byte >= input_size) {
+            throw std::runtime_error("Future event savestate not allowed in R/O mode");
+        }
+        // Ensure that the current movie and savestate movie are in the same timeline
+        if (current_byte > input_size || HashInputPrefix(current_byte) != state_hash) {
+            throw std::runtime_error("Timeline mismatch");
+        }
+        input_hash = state_hash;
+        input_chunk.clear();
 
+        if (read_only) {
             play_mode = PlayMode::Playing;
-            total_input = GetInputCount(recorded_input);
+            total_input = GetInputCount(input_file, input_size);
         } else {
+            // Rerecording continues from the savestate, dropping the inputs recorded after it
+            if (play_mode != PlayMode::Recording && !OpenInputFile("r+b")) {
+                throw std::runtime_error("Unable to reopen the movie for recording");
+            }
+            input_file.Resize(sizeof(CTMHeader) + current_byte);
+            input_size = current_byte;
             play_mode = PlayMode::Recording;
             rerecord_count++;
         }
@@ -230,17 +262,34 @@ u64 Movie::GetTotalInputCount() const {
 }
 
 void Movie::CheckInputEnd() {
-    if (current_byte + sizeof(ControllerState) > recorded_input.size()) {
+    if (current_byte + sizeof(ControllerState) > input_size) {
         LOG_INFO(Movie, "Playback finished");
         play_mode = PlayMode::MovieFinished;
         playback_completion_callback();
     }
 }
 
+void Movie::ReadControllerState(ControllerState& controller_state) {
+    if (current_byte < chunk_begin ||
+        current_byte + sizeof(ControllerState) > chunk_begin + input_chunk.size()) {
+        chunk_begin = current_byte;
+        input_chunk.resize(
+            static_cast<std::size_t>(std::min<u64>(INPUT_CHUNK_SIZE, input_size - current_byte)));
+        input_file.Seek(sizeof(CTMHeader) + current_byte, SEEK_SET);
+        if (input_file.ReadBytes(input_chunk.data(), input_chunk.size()) != input_chunk.size()) {
+            LOG_ERROR(Movie, "Unable to read the movie inputs at {}", current_byte);
+        }
+    }
+
+    const u8* data = input_chunk.data() + (current_byte - chunk_begin);
+    std::memcpy(&controller_state, data, sizeof(ControllerState));
+    input_hash = HashInput(input_hash, data, sizeof(ControllerState));
+    current_byte += sizeof(ControllerState);
+}
+
 void Movie::Play(Service::HID::PadState& pad_state, s16& circle_pad_x, s16& circle_pad_y) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadControllerState(s);
     current_input++;
 
     if (s.type != ControllerStateType::PadAndCircle) {
@@ -271,8 +320,7 @@ void Movie::Play(Service::HID::PadState& pad_state, s16& circle_pad_x, s16& circ
 
 void Movie::Play(Service::HID::TouchDataEntry& touch_data) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadControllerState(s);
 
     if (s.type != ControllerStateType::Touch) {
         LOG_ERROR(Movie,
@@ -288,8 +336,7 @@ void Movie::Play(Service::HID::TouchDataEntry& touch_data) {
 
 void Movie::Play(Service::HID::AccelerometerDataEntry& accelerometer_data) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadControllerState(s);
 
     if (s.type != ControllerStateType::Accelerometer) {
         LOG_ERROR(Movie,
@@ -305,8 +352,7 @@ void Movie::Play(Service::HID::AccelerometerDataEntry& accelerometer_data) {
 
 void Movie::Play(Service::HID::GyroscopeDataEntry& gyroscope_data) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadControllerState(s);
 
     if (s.type != ControllerStateType::Gyroscope) {
         LOG_ERROR(Movie,
@@ -322,8 +368,7 @@ void Movie::Play(Service::HID::GyroscopeDataEntry& gyroscope_data) {
 
 void Movie::Play(Service::IR::PadState& pad_state, s16& c_stick_x, s16& c_stick_y) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadControllerState(s);
 
     if (s.type != ControllerStateType::IrRst) {
         LOG_ERROR(Movie,
@@ -340,8 +385,7 @@ void Movie::Play(Service::IR::PadState& pad_state, s16& c_stick_x, s16& c_stick_
 
 void Movie::Play(Service::IR::ExtraHIDResponse& extra_hid_response) {
     ControllerState s;
-    std::memcpy(&s, &recorded_input[current_byte], sizeof(ControllerState));
-    current_byte += sizeof(ControllerState);
+    ReadControllerState(s);
 
     if (s.type != ControllerStateType::ExtraHidResponse) {
         LOG_ERROR(Movie,
@@ -362,9 +406,14 @@ void Movie::Play(Service::IR::ExtraHIDResponse& extra_hid_response) {
 }
 
 void Movie::Record(const ControllerState& controller_state) {
-    recorded_input.resize(current_byte + sizeof(ControllerState));
-    std::memcpy(&recorded_input[current_byte], &controller_state, sizeof(ControllerState));
+    const u8* data = reinterpret_cast<const u8*>(&controller_state);
+    pending_input.insert(pending_input.end(), data, data + sizeof(ControllerState));
+    input_hash = HashInput(input_hash, data, sizeof(ControllerState));
     current_byte += sizeof(ControllerState);
+
+    if (pending_input.size() >= INPUT_CHUNK_SIZE) {
+        FlushInput();
+    }
 }
 
 void Movie::Record(const Service::HID::PadState& pad_state, const s16& circle_pad_x,
@@ -475,21 +524,27 @@ Movie::ValidationResult Movie::ValidateHeader(const CTMHeader& header) const {
     return ValidationResult::OK;
 }
 
-Movie::ValidationResult Movie::ValidateInput(const std::vector<u8>& input,
-                                             u64 expected_count) const {
-    return GetInputCount(input) == expected_count ? ValidationResult::OK
-                                                  : ValidationResult::InputCountDismatch;
+bool Movie::OpenInputFile(const char* openmode) {
+    input_file = FileUtil::IOFile(record_movie_file, openmode);
+    const u64 size = input_file.GetSize();
+    input_size = size > sizeof(CTMHeader) ? size - sizeof(CTMHeader) : 0;
+    input_chunk.clear();
+    pending_input.clear();
+    return input_file.IsGood();
 }
 
-void Movie::SaveMovie() {
-    LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
-    FileUtil::IOFile save_record(record_movie_file, "wb");
+void Movie::FlushInput() {
+    input_file.Seek(sizeof(CTMHeader) + input_size, SEEK_SET);
+    input_file.WriteBytes(pending_input.data(), pending_input.size());
+    input_size += pending_input.size();
+    pending_input.clear();
 
-    if (!save_record.IsGood()) {
-        LOG_ERROR(Movie, "Unable to open file to save movie");
-        return;
-    }
+    // Keeps the file valid as a movie of the inputs so far, should recording stop unexpectedly
+    WriteHeader();
+    input_file.Flush();
+}
 
+void Movie::WriteHeader() {
     CTMHeader header = {};
     header.filetype = header_magic_bytes;
     header.program_id = program_id;
@@ -500,17 +555,43 @@ void Movie::SaveMovie() {
                 std::min(header.author.size(), record_movie_author.size()));
 
     header.rerecord_count = rerecord_count;
-    header.input_count = GetInputCount(recorded_input);
+    // Recording always happens at the end of the movie
+    header.input_count = current_input;
 
     std::string rev_bytes;
     CryptoPP::StringSource(Common::g_scm_rev, true,
                            new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
     std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(CTMHeader::revision));
 
-    save_record.WriteBytes(&header, sizeof(CTMHeader));
-    save_record.WriteBytes(recorded_input.data(), recorded_input.size());
+    input_file.Seek(0, SEEK_SET);
+    input_file.WriteBytes(&header, sizeof(CTMHeader));
+}
+
+u64 Movie::HashInputPrefix(u64 size) {
+    input_file.Seek(sizeof(CTMHeader), SEEK_SET);
+    std::vector<u8> chunk(INPUT_CHUNK_SIZE);
+    u64 hash = INPUT_HASH_SEED;
+    for (u64 pos = 0; pos < size; pos += chunk.size()) {
+        chunk.resize(static_cast<std::size_t>(std::min<u64>(INPUT_CHUNK_SIZE, size - pos)));
+        if (input_file.ReadBytes(chunk.data(), chunk.size()) != chunk.size()) {
+            break;
+        }
+        hash = HashInput(hash, chunk.data(), chunk.size());
+    }
+    return hash;
+}
+
+void Movie::SaveMovie() {
+    LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
+    if (!input_file.IsOpen()) {
+        LOG_ERROR(Movie, "Unable to open file to save movie");
+        return;
+    }
+
+    FlushInput();
+    total_input = current_input;
 
-    if (!save_record.IsGood()) {
+    if (!input_file.IsGood()) {
         LOG_ERROR(Movie, "Error saving movie");
     }
 }
@@ -527,6 +608,7 @@ void Movie::StartPlayback(const std::string& movie_file) {
     if (save_record.IsGood() && size > sizeof(CTMHeader)) {
         CTMHeader header;
         save_record.ReadArray(&header, 1);
+        save_record.Close();
         if (ValidateHeader(header) != ValidationResult::Invalid) {
             play_mode = PlayMode::Playing;
             record_movie_file = movie_file;
@@ -538,8 +620,9 @@ void Movie::StartPlayback(const std::string& movie_file) {
             rerecord_count = header.rerecord_count;
             total_input = header.input_count;
 
-            recorded_input.resize(size - sizeof(CTMHeader));
-            save_record.ReadArray(recorded_input.data(), recorded_input.size());
+            // The inputs are read a chunk at a time as the playback reaches them
+            OpenInputFile("rb");
+            input_hash = INPUT_HASH_SEED;
 
             current_byte = 0;
             current_input = 0;
@@ -567,6 +650,19 @@ void Movie::StartRecording(const std::string& movie_file, const std::string& aut
     program_id = 0;
     Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id);
 
+    // The header is written first, inputs are then appended as each chunk of them is complete
+    input_file = FileUtil::IOFile(movie_file, "w+b");
+    input_size = 0;
+    input_chunk.clear();
+    pending_input.clear();
+    input_hash = INPUT_HASH_SEED;
+    current_byte = 0;
+    current_input = 0;
+    WriteHeader();
+    if (!input_file.IsGood()) {
+        LOG_ERROR(Movie, "Unable to open file to save movie");
+    }
+
     LOG_INFO(Movie, "Enabling Movie recording, ID: {:016X}", id);
 }
 
@@ -632,9 +728,9 @@ Movie::ValidationResult Movie::ValidateMovie(const std::string& movie_file) cons
         return ValidationResult::OK;
     }
 
-    std::vector<u8> input(size - sizeof(header));
-    save_record.ReadArray(input.data(), input.size());
-    return ValidateInput(input, header.input_count);
+    return GetInputCount(save_record, size - sizeof(header)) == header.input_count
+               ? ValidationResult::OK
+               : ValidationResult::InputCountDismatch;
 }
 
 Movie::MovieMetadata Movie::GetMovieMetadata(const std::string& movie_file) const {
@@ -655,7 +751,13 @@ void Movie::Shutdown() {
     }
 
     play_mode = PlayMode::None;
-    recorded_input.resize(0);
+    input_file.Close();
+    input_size = 0;
+    input_chunk.clear();
+    input_chunk.shrink_to_fit();
+    pending_input.clear();
+    pending_input.shrink_to_fit();
+    input_hash = 0;
     record_movie_file.clear();
     current_byte = 0;
     current_input = 0;
@@ -666,7 +768,7 @@ void Movie::Shutdown() {
 template <typename... Targs>
 void Movie::Handle(Targs&... Fargs) {
     if (play_mode == PlayMode::Playing) {
-        ASSERT(current_byte + sizeof(ControllerState) <= recorded_input.size());
+        ASSERT(current_byte + sizeof(ControllerState) <= input_size);
         Play(Fargs...);
         CheckInputEnd();
     } else if (play_mode == PlayMode::Recording) {
@@ -5,8 +5,10 @@
 #pragma once
 
 #include <functional>
-#include <boost/serialization/vector.hpp>
+#include <string>
+#include <vector>
 #include "common/common_types.h"
+#include "common/file_util.h"
 
 namespace Service {
 namespace HID {
@@ -126,7 +128,8 @@ public:
     u64 GetTotalInputCount() const;
 
     /**
-     * Saves the movie immediately, in its current state.
+     * Saves the movie immediately, in its current state. Recordings are also written out each
+     * time a chunk of inputs is complete, so this only writes the inputs since then.
      * This is called in Shutdown.
      */
     void SaveMovie();
@@ -136,6 +139,21 @@ private:
 
     void CheckInputEnd();
 
+    /// Reads the controller state at current_byte of the playback and moves past it
+    void ReadControllerState(ControllerState& controller_state);
+
+    /// Opens the movie file at record_movie_file, which must have a header already
+    bool OpenInputFile(const char* openmode);
+
+    /// Appends the pending inputs to the movie file and updates its header
+    void FlushInput();
+
+    /// Writes the header of the movie file from the current movie
+    void WriteHeader();
+
+    /// Hashes the first size bytes of input in the movie file, as input_hash would be after them
+    u64 HashInputPrefix(u64 size);
+
     template <typename... Targs>
     void Handle(Targs&... Fargs);
 
@@ -156,7 +174,6 @@ private:
     void Record(const Service::IR::ExtraHIDResponse& extra_hid_response);
 
     ValidationResult ValidateHeader(const CTMHeader& header) const;
-    ValidationResult ValidateInput(const std::vector<u8>& input, u64 expected_count) const;
 
     PlayMode play_mode;
 
@@ -165,7 +182,16 @@ private:
 
     u64 init_time; // Clock init time override for RNG consistency
 
-    std::vector<u8> recorded_input;
+    /// The movie being played or recorded. Its inputs are streamed through input_chunk or
+    /// pending_input, so that they never have to be held in memory as a whole.
+    FileUtil::IOFile input_file;
+    u64 input_size = 0;            ///< Bytes of input in input_file
+    std::vector<u8> input_chunk;   ///< Inputs of the playback starting at chunk_begin
+    u64 chunk_begin = 0;
+    std::vector<u8> pending_input; ///< Recorded inputs not written to input_file yet
+    /// Hash of the inputs before current_byte, which savestates keep in place of the inputs
+    u64 input_hash = 0;
+
     std::size_t current_byte = 0;
     u64 current_input = 0;
     // Total input count of the current movie being played. Not used for recording.
@@ -184,4 +210,4 @@ private:
 };
 } // namespace Core
 
-BOOST_CLASS_VERSION(Core::Movie, 1)
+BOOST_CLASS_VERSION(Core::Movie, 2)
@@ -4,13 +4,24 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iterator>
 #include <mutex>
 #include <numeric>
 #include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+#if defined(ARCHITECTURE_x86_64) && !defined(_MSC_VER)
+#include <immintrin.h>
+#elif defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+#include <intrin.h>
+#endif
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
+#include "common/thread.h"
 #include "core/hw/gpu.h"
 #include "core/perf_stats.h"
 #include "core/settings.h"
@@ -62,11 +73,47 @@ void PerfStats::EndSystemFrame() {
     }
     accumulated_frametime += frame_time;
     system_frames += 1;
+    ++total_system_frames;
+
+    frametime_histogram.Record(duration_cast<microseconds>(frame_time).count());
+    cpu_time_histogram.Record(duration_cast<microseconds>(frame_cpu_time).count());
+    gpu_submit_histogram.Record(duration_cast<microseconds>(frame_gpu_submit_time).count());
+    frame_cpu_time = Clock::duration::zero();
+    frame_gpu_submit_time = Clock::duration::zero();
+
+    const u16 frame_limit = Settings::values.use_frame_limit_alternate
+                                ? Settings::values.frame_limit_alternate
+                                : Settings::values.frame_limit;
+    if (frame_limit != 0) {
+        const auto target = std::chrono::duration<double>(100.0 / frame_limit /
+                                                          GPU::SCREEN_REFRESH_RATE);
+        Common::ReportFrameWorkDuration(frame_time,
+                                        duration_cast<std::chrono::nanoseconds>(target));
+    }
+
+    last_frame_counters = TakeFrameCounters();
+    for (std::size_t i = 0; i < NumFrameCounters; ++i) {
+        accumulated_frame_counters[i] += last_frame_counters[i];
+        max_frame_counters[i] = std::max(max_frame_counters[i], last_frame_counters[i]);
+    }
 
     previous_frame_length = frame_end - previous_frame_end;
+    previous_frame_time = frame_time;
     previous_frame_end = frame_end;
 }
 
+void PerfStats::RecordPresentTime(Clock::duration time) {
+    std::lock_guard lock{object_mutex};
+
+    present_histogram.Record(duration_cast<microseconds>(time).count());
+}
+
+void PerfStats::RecordInputLatency(std::chrono::nanoseconds latency) {
+    std::lock_guard lock{object_mutex};
+
+    input_latency_histogram.Record(duration_cast<microseconds>(latency).count());
+}
+
 void PerfStats::EndGameFrame() {
     std::lock_guard lock{object_mutex};
 
@@ -85,6 +132,15 @@ double PerfStats::GetMeanFrametime() const {
     return sum / static_cast<double>(current_index - IgnoreFrames);
 }
 
+std::vector<double> PerfStats::GetFrametimes() const {
+    std::lock_guard lock{object_mutex};
+
+    if (current_index <= IgnoreFrames) {
+        return {};
+    }
+    return {perf_history.begin() + IgnoreFrames, perf_history.begin() + current_index};
+}
+
 PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::lock_guard lock(object_mutex);
 
@@ -100,6 +156,12 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    GetPercentilesLocked(results);
+    for (std::size_t i = 0; i < NumFrameCounters; ++i) {
+        results.frame_counter_means[i] = static_cast<double>(accumulated_frame_counters[i]) /
+                                         static_cast<double>(system_frames);
+    }
+    results.frame_counter_max = max_frame_counters;
 
     // Reset counters
     reset_point = now;
@@ -107,10 +169,43 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    frametime_histogram.Reset();
+    cpu_time_histogram.Reset();
+    gpu_submit_histogram.Reset();
+    present_histogram.Reset();
+    input_latency_histogram.Reset();
+    accumulated_frame_counters.fill(0);
+    max_frame_counters.fill(0);
 
     return results;
 }
 
+void PerfStats::GetPercentiles(Results& results) const {
+    std::lock_guard lock{object_mutex};
+
+    GetPercentilesLocked(results);
+}
+
+void PerfStats::GetPercentilesLocked(Results& results) const {
+    const auto get = [](const Common::Histogram& histogram) {
+        constexpr double SecondsPerUnit = 1e-6;
+        return Percentiles{static_cast<double>(histogram.Percentile(50)) * SecondsPerUnit,
+                           static_cast<double>(histogram.Percentile(95)) * SecondsPerUnit,
+                           static_cast<double>(histogram.Percentile(99)) * SecondsPerUnit};
+    };
+    results.frametime_percentiles = get(frametime_histogram);
+    results.cpu_time_percentiles = get(cpu_time_histogram);
+    results.gpu_submit_percentiles = get(gpu_submit_histogram);
+    results.present_percentiles = get(present_histogram);
+    results.input_latency_percentiles = get(input_latency_histogram);
+}
+
+FrameCounterValues PerfStats::GetLastFrameCounters() const {
+    std::lock_guard lock{object_mutex};
+
+    return last_frame_counters;
+}
+
 double PerfStats::GetLastFrameTimeScale() const {
     std::lock_guard lock{object_mutex};
 
@@ -118,6 +213,11 @@ double PerfStats::GetLastFrameTimeScale() const {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
+double PerfStats::GetLastFrametime() const {
+    std::lock_guard lock{object_mutex};
+    return duration_cast<DoubleSecs>(previous_frame_time).count();
+}
+
 void FrameLimiter::WaitOnce() {
     if (frame_advancing_enabled) {
         // Frame advancing is enabled: wait on event instead of doing framelimiting
@@ -126,6 +226,58 @@ void FrameLimiter::WaitOnce() {
     }
 }
 
+FrameLimiter::FrameLimiter() {
+#ifdef _WIN32
+    // Windows sleeps in steps of 15.6 ms by default
+    timeBeginPeriod(1);
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FrameLimiter::WaitUntil(Clock::time_point time) {
+    constexpr auto SpinTime = 1ms;
+    if (time - Clock::now() > SpinTime) {
+        std::this_thread::sleep_until(time - SpinTime);
+    }
+    while (Clock::now() < time) {
+#if defined(ARCHITECTURE_x86_64)
+        _mm_pause();
+#elif defined(ARCHITECTURE_ARM64) && defined(_MSC_VER)
+        __yield();
+#elif defined(ARCHITECTURE_ARM64)
+        asm volatile("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+}
+
+void FrameLimiter::SetDisplayRefreshRate(double refresh_rate_hz) {
+    display_refresh_rate_hz = refresh_rate_hz;
+}
+
+double FrameLimiter::GetDisplayPacingScale(double speed_scale) const {
+    const double refresh_rate = display_refresh_rate_hz;
+    const double frame_rate = GPU::SCREEN_REFRESH_RATE * speed_scale;
+    if (refresh_rate <= 0.0) {
+        return 1.0;
+    }
+    const double refreshes_per_frame = std::round(refresh_rate / frame_rate);
+    if (refreshes_per_frame < 1.0) {
+        return 1.0;
+    }
+    const double display_frame_rate = refresh_rate / refreshes_per_frame;
+    if (std::abs(display_frame_rate - frame_rate) > frame_rate * 0.01) {
+        return 1.0;
+    }
+    return display_frame_rate / frame_rate;
+}
+
 void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     if (frame_advancing_enabled) {
         // Frame advancing is enabled: wait on event instead of doing framelimiting
@@ -145,6 +297,7 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     } else if (Settings::values.frame_limit == 0) {
         return;
     }
+    sleep_scale *= GetDisplayPacingScale(sleep_scale);
 
     // Max lag caused by slow frames. Shouldn't be more than the length of a frame at the current
     // speed percent or it will clamp too much and prevent this from properly limiting to that
@@ -159,7 +312,7 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
         std::clamp(frame_limiting_delta_err, -max_lag_time_us, max_lag_time_us);
 
     if (frame_limiting_delta_err > microseconds::zero()) {
-        std::this_thread::sleep_for(frame_limiting_delta_err);
+        WaitUntil(now + frame_limiting_delta_err);
         auto now_after_sleep = Clock::now();
         frame_limiting_delta_err -= duration_cast<microseconds>(now_after_sleep - now);
         now = now_after_sleep;
@@ -9,8 +9,11 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
+#include "common/histogram.h"
 #include "common/thread.h"
+#include "core/frame_counters.h"
 
 namespace Core {
 
@@ -25,6 +28,13 @@ public:
 
     using Clock = std::chrono::high_resolution_clock;
 
+    /// Percentiles of a duration over the system frames since the last reset, in seconds
+    struct Percentiles {
+        double p50;
+        double p95;
+        double p99;
+    };
+
     struct Results {
         /// System FPS (LCD VBlanks) in Hz
         double system_fps;
@@ -34,26 +44,79 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Audio buffered for the sink after its last callback, in seconds
+        double audio_latency;
+        /// Number of audio sample frames the sink ran short of, which replayed the last frame
+        u64 audio_underrun_frames;
+        /// Walltime per system frame, excluding any waits
+        Percentiles frametime_percentiles;
+        /// Walltime running the emulated CPU, including HLE, per system frame
+        Percentiles cpu_time_percentiles;
+        /// Walltime submitting GPU command lists per system frame
+        Percentiles gpu_submit_percentiles;
+        /// Walltime presenting each system frame to the frontend
+        Percentiles present_percentiles;
+        /// Walltime from an input device changing state to HID writing it to shared memory, when
+        /// Settings::values.measure_input_latency is set
+        Percentiles input_latency_percentiles;
+        /// Mean and largest number of each FrameCounter event per system frame
+        std::array<double, NumFrameCounters> frame_counter_means;
+        FrameCounterValues frame_counter_max;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
+    /// Adds to the time that the current system frame ran the emulated CPU. Emulation thread only
+    void AddCpuTime(Clock::duration time) {
+        frame_cpu_time += time;
+    }
+
+    /// Adds to the time that the current system frame submitted GPU commands. Emulation thread only
+    void AddGpuSubmitTime(Clock::duration time) {
+        frame_gpu_submit_time += time;
+    }
+
+    /// Records the time that the previous system frame took to present
+    void RecordPresentTime(Clock::duration time);
+
+    /// Records the time from an input state change until HID wrote it to shared memory
+    void RecordInputLatency(std::chrono::nanoseconds latency);
+
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
+    /// Returns the percentiles of the frame times since the last reset, as in GetAndResetStats
+    void GetPercentiles(Results& results) const;
+
     /**
      * Returns the arithmetic mean of all frametime values stored in the performance history.
      */
     double GetMeanFrametime() const;
 
+    /// Returns the frametime of every system frame in the performance history, in seconds
+    std::vector<double> GetFrametimes() const;
+
     /**
      * Gets the ratio between walltime and the emulated time of the previous system frame. This is
      * useful for scaling inputs or outputs moving between the two time domains.
      */
     double GetLastFrameTimeScale() const;
 
+    /// Returns the walltime that the previous system frame took, excluding any waits, in seconds
+    double GetLastFrametime() const;
+
+    /// Returns the FrameCounter events counted during the previous system frame
+    FrameCounterValues GetLastFrameCounters() const;
+
+    /// Returns the number of system frames presented since the game started
+    u64 GetSystemFrameCount() const {
+        return total_system_frames;
+    }
+
 private:
+    void GetPercentilesLocked(Results& results) const;
+
     mutable std::mutex object_mutex;
 
     /// Title ID for the game that is running. 0 if there is no game running yet
@@ -75,6 +138,24 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Number of system frames presented since the game started
+    std::atomic<u64> total_system_frames{0};
+
+    /// Distributions of the frame times since last reset, in microseconds
+    Common::Histogram frametime_histogram;
+    Common::Histogram cpu_time_histogram;
+    Common::Histogram gpu_submit_histogram;
+    Common::Histogram present_histogram;
+    Common::Histogram input_latency_histogram;
+    /// Times accumulated during the current system frame
+    Clock::duration frame_cpu_time = Clock::duration::zero();
+    Clock::duration frame_gpu_submit_time = Clock::duration::zero();
+
+    /// FrameCounter events of the previous system frame
+    FrameCounterValues last_frame_counters{};
+    /// Sums and maxima of the FrameCounter events per frame since last reset
+    std::array<u64, NumFrameCounters> accumulated_frame_counters{};
+    FrameCounterValues max_frame_counters{};
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -82,14 +163,27 @@ private:
     Clock::time_point frame_begin = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+    /// Walltime of the previous system frame, excluding any waits
+    Clock::duration previous_frame_time = Clock::duration::zero();
 };
 
 class FrameLimiter {
 public:
-    using Clock = std::chrono::high_resolution_clock;
+    using Clock = std::chrono::steady_clock;
+
+    FrameLimiter();
+    ~FrameLimiter();
 
     void DoFrameLimiting(std::chrono::microseconds current_system_time_us);
 
+    /**
+     * Sets the refresh rate of the display the frames are shown on, or 0 when it is unknown or
+     * variable (VRR). When a whole number of refreshes lasts within 1% of a frame at the current
+     * speed limit, frames are paced to the display instead of to the emulated clock, so each
+     * frame is shown for the same number of refreshes.
+     */
+    void SetDisplayRefreshRate(double refresh_rate_hz);
+
     bool IsFrameAdvancing() const;
     /**
      * Sets whether frame advancing is enabled or not.
@@ -101,6 +195,15 @@ public:
     void WaitOnce();
 
 private:
+    /**
+     * Sleeps until shortly before `time` and spins for the rest, as sleeps can wake up a whole
+     * scheduler tick late
+     */
+    static void WaitUntil(Clock::time_point time);
+
+    /// Returns the factor that paces frames at the speed scale to a whole number of refreshes
+    double GetDisplayPacingScale(double speed_scale) const;
+
     /// Emulated system time (in microseconds) at the last limiter invocation
     std::chrono::microseconds previous_system_time_us{0};
     /// Walltime at the last limiter invocation
@@ -109,6 +212,8 @@ private:
     /// Accumulated difference between walltime and emulated time
     std::chrono::microseconds frame_limiting_delta_err{0};
 
+    std::atomic<double> display_refresh_rate_hz{0.0};
+
     /// Whether to use frame advancing (i.e. frame by frame)
     std::atomic_bool frame_advancing_enabled;
 
@@ -0,0 +1,144 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/rewind_buffer.h"
+
+namespace Core {
+
+namespace {
+
+/// Fast level, as a snapshot is compressed every few frames during emulation
+constexpr s32 CompressionLevel = 1;
+
+/// Granularity at which unchanged parts of the states are skipped
+constexpr std::size_t BlockSize = 0x1000;
+
+void XorInto(u8* dest, const u8* source, std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+        dest[i] ^= source[i];
+    }
+}
+
+} // Anonymous namespace
+
+RewindBuffer::RewindBuffer(std::size_t budget) : budget(budget) {}
+
+void RewindBuffer::Push(std::vector<u8>& state) {
+    if (has_newest) {
+        const std::size_t state_size = state.size();
+        Entry entry{newest.size(), std::max(newest.size(), state_size), {}, {}};
+        // The smaller state is compared as if padded with zeros
+        newest.resize(entry.xor_size, 0);
+        state.resize(entry.xor_size, 0);
+
+        // Turn the previous newest state into its XOR against the new one, and compress the blocks
+        // where it is not zero
+        Common::Compression::ZSTDCompressBuffer buffer{
+            [&entry](const u8* data, std::size_t size) {
+                entry.data.insert(entry.data.end(), data, data + size);
+            },
+            CompressionLevel};
+        bool compressed = true;
+        for (std::size_t offset = 0; offset < entry.xor_size; offset += BlockSize) {
+            const std::size_t size = std::min(BlockSize, entry.xor_size - offset);
+            u8* const block = newest.data() + offset;
+            if (std::memcmp(block, state.data() + offset, size) == 0) {
+                continue;
+            }
+            XorInto(block, state.data() + offset, size);
+            entry.changed_blocks.push_back(static_cast<u32>(offset / BlockSize));
+            compressed &= buffer.sputn(reinterpret_cast<const char*>(block),
+                                       static_cast<std::streamsize>(size)) ==
+                          static_cast<std::streamsize>(size);
+        }
+        compressed &= buffer.Finish();
+        state.resize(state_size);
+
+        if (compressed) {
+            entry.changed_blocks.shrink_to_fit();
+            entry.data.shrink_to_fit();
+            entries_size += EntrySize(entry);
+            entries.push_back(std::move(entry));
+        } else {
+            // The older states can no longer be reached
+            LOG_ERROR(Core, "Could not compress rewind state");
+            entries.clear();
+            entries_size = 0;
+        }
+    }
+
+    std::swap(newest, state);
+    has_newest = true;
+
+    while (!entries.empty() && MemoryUsage() > budget) {
+        entries_size -= EntrySize(entries.front());
+        entries.pop_front();
+    }
+}
+
+bool RewindBuffer::Pop(std::vector<u8>& state) {
+    if (!has_newest) {
+        return false;
+    }
+    state = newest;
+
+    if (entries.empty()) {
+        has_newest = false;
+        newest.clear();
+        return true;
+    }
+
+    // Undo the XOR of the next older state against the newest one
+    const Entry& entry = entries.back();
+    newest.resize(entry.xor_size, 0);
+    std::size_t pos = 0;
+    Common::Compression::ZSTDDecompressBuffer buffer{[&entry, &pos](u8* data, std::size_t size) {
+        size = std::min(size, entry.data.size() - pos);
+        std::copy_n(entry.data.data() + pos, size, data);
+        pos += size;
+        return size;
+    }};
+    std::array<u8, BlockSize> block;
+    for (const u32 index : entry.changed_blocks) {
+        const std::size_t offset = index * BlockSize;
+        const std::size_t size = std::min(BlockSize, entry.xor_size - offset);
+        const std::streamsize read =
+            buffer.sgetn(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(size));
+        ASSERT_MSG(read == static_cast<std::streamsize>(size), "Could not decompress rewind state");
+        XorInto(newest.data() + offset, block.data(), size);
+    }
+    newest.resize(entry.size);
+
+    entries_size -= EntrySize(entry);
+    entries.pop_back();
+    return true;
+}
+
+std::size_t RewindBuffer::EntrySize(const Entry& entry) {
+    return entry.changed_blocks.size() * sizeof(u32) + entry.data.size();
+}
+
+void RewindBuffer::Clear() {
+    has_newest = false;
+    newest.clear();
+    entries.clear();
+    entries_size = 0;
+}
+
+std::size_t RewindBuffer::Count() const {
+    return has_newest ? entries.size() + 1 : 0;
+}
+
+std::size_t RewindBuffer::MemoryUsage() const {
+    return newest.size() + entries_size;
+}
+
+} // namespace Core
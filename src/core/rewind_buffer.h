@@ -0,0 +1,65 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * History of serialized states for rewinding, within a memory budget. Only the newest state is
+ * kept whole; each older one is stored as its XOR against the next newer state, of which only the
+ * blocks that differ are kept, compressed with Zstandard. As most of the emulated memory does not
+ * change between two snapshots, this is a small fraction of a state. The oldest states are dropped
+ * to stay within the budget.
+ */
+class RewindBuffer {
+public:
+    /// @param budget Maximum memory used by the stored states, in bytes
+    explicit RewindBuffer(std::size_t budget);
+
+    /**
+     * Adds a state as the newest one.
+     * @param state The state to add. Its contents are replaced with unspecified data, so that its
+     *              allocation can be reused for the next state.
+     */
+    void Push(std::vector<u8>& state);
+
+    /**
+     * Removes the newest state, and moves it to `state`.
+     * @return false if there are no states left.
+     */
+    bool Pop(std::vector<u8>& state);
+
+    /// Removes all the states
+    void Clear();
+
+    /// Returns the number of stored states
+    [[nodiscard]] std::size_t Count() const;
+
+    /// Returns the memory used by the stored states, in bytes
+    [[nodiscard]] std::size_t MemoryUsage() const;
+
+private:
+    struct Entry {
+        std::size_t size;                ///< Size of the state
+        std::size_t xor_size;            ///< Size of the XOR, as large as the larger of the states
+        std::vector<u32> changed_blocks; ///< Blocks where the XOR is not zero
+        std::vector<u8> data;            ///< Compressed XOR of the changed blocks
+    };
+
+    static std::size_t EntrySize(const Entry& entry);
+
+    std::size_t budget;
+    bool has_newest = false;
+    std::vector<u8> newest;
+    std::deque<Entry> entries;
+    std::size_t entries_size = 0;
+};
+
+} // namespace Core
@@ -0,0 +1,70 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include "common/assert.h"
+#include "core/rollback_input.h"
+
+namespace Core {
+
+RollbackInputLog::RollbackInputLog(std::size_t num_members) : members(num_members) {}
+
+const RollbackInputLog::Input& RollbackInputLog::GetInput(std::size_t member, u64 frame) {
+    ASSERT(member < members.size());
+    History& history = members[member];
+    auto next = history.confirmed.upper_bound(frame);
+    if (next != history.confirmed.begin() && std::prev(next)->first == frame) {
+        return std::prev(next)->second;
+    }
+
+    Input prediction;
+    if (next != history.confirmed.begin()) {
+        prediction = std::prev(next)->second;
+    }
+    return history.predicted.insert_or_assign(frame, std::move(prediction)).first->second;
+}
+
+void RollbackInputLog::Confirm(std::size_t member, u64 frame, Input input) {
+    ASSERT(member < members.size());
+    History& history = members[member];
+    const auto prediction = history.predicted.find(frame);
+    if (prediction != history.predicted.end()) {
+        if (prediction->second != input) {
+            rollback_frame = std::min(rollback_frame.value_or(frame), frame);
+        }
+        history.predicted.erase(prediction);
+    }
+    history.confirmed.insert_or_assign(frame, std::move(input));
+}
+
+std::optional<u64> RollbackInputLog::TakeRollbackFrame() {
+    return std::exchange(rollback_frame, std::nullopt);
+}
+
+std::optional<u64> RollbackInputLog::GetConfirmedFrame() const {
+    std::optional<u64> confirmed_frame;
+    for (const History& history : members) {
+        if (history.confirmed.empty()) {
+            return std::nullopt;
+        }
+        const u64 newest = history.confirmed.rbegin()->first;
+        confirmed_frame = std::min(confirmed_frame.value_or(newest), newest);
+    }
+    return confirmed_frame;
+}
+
+void RollbackInputLog::DiscardBefore(u64 frame) {
+    for (History& history : members) {
+        auto first_kept = history.confirmed.lower_bound(frame);
+        if (first_kept != history.confirmed.begin()) {
+            // Keep the newest dropped input, which predicts the frames until the next one arrives
+            history.confirmed.erase(history.confirmed.begin(), std::prev(first_kept));
+        }
+        history.predicted.erase(history.predicted.begin(), history.predicted.lower_bound(frame));
+    }
+}
+
+} // namespace Core
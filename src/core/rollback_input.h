@@ -0,0 +1,59 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Inputs of the members of a rollback session, in which the inputs of the remote members arrive a
+ * few frames late. Until the input of a member arrives, its last known input is used in its place,
+ * so that the local console doesn't have to wait for it. When an input arrives that differs from
+ * the one that was used for its frame, the frames from then on have to be emulated again from a
+ * snapshot, and the earliest such frame is recorded.
+ */
+class RollbackInputLog {
+public:
+    using Input = std::vector<u8>;
+
+    explicit RollbackInputLog(std::size_t num_members);
+
+    /**
+     * Returns the input of a member for a frame. If it hasn't arrived yet, the newest input that
+     * arrived before it is used as a prediction, or an empty input if there is none.
+     */
+    const Input& GetInput(std::size_t member, u64 frame);
+
+    /// Records the actual input of a member for a frame
+    void Confirm(std::size_t member, u64 frame, Input input);
+
+    /// Returns the earliest frame that was emulated with a wrong prediction since the last call
+    [[nodiscard]] std::optional<u64> TakeRollbackFrame();
+
+    /// Returns the newest frame for which the inputs of all the members have arrived
+    [[nodiscard]] std::optional<u64> GetConfirmedFrame() const;
+
+    /**
+     * Drops the inputs of the frames before `frame`, once they won't be emulated again. The newest
+     * of them is kept for each member, as a prediction of the next ones.
+     */
+    void DiscardBefore(u64 frame);
+
+private:
+    struct History {
+        std::map<u64, Input> confirmed;
+        std::map<u64, Input> predicted; ///< Predictions used for frames that haven't arrived yet
+    };
+
+    std::vector<History> members;
+    std::optional<u64> rollback_frame;
+};
+
+} // namespace Core
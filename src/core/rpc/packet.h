@@ -14,6 +14,24 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    ReadFramePercentiles,
+    CaptureTrace,
+    ReadFrameCounters,
+    Batch,
+    Subscribe,
+    Unsubscribe,
+    SubscriptionData,
+    ReadSVCCounts,
+};
+
+/// Frame time distributions that ReadFramePercentiles reads, passed in place of the address
+enum class FrameMetric : u32 {
+    Frametime = 0,
+    CpuTime,
+    GpuSubmitTime,
+    PresentTime,
+    /// Only recorded while measure_input_latency is enabled
+    InputLatency,
 };
 
 struct PacketHeader {
@@ -23,11 +41,20 @@ struct PacketHeader {
     u32 packet_size;
 };
 
-constexpr u32 CURRENT_VERSION = 1;
+/// Header of each operation in a Batch request, followed by the data to write for WriteMemory
+struct BatchOperation {
+    PacketType operation_type;
+    u32 address;
+    u32 data_size;
+};
+
+constexpr u32 CURRENT_VERSION = 2;
 constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
-constexpr u32 MAX_PACKET_DATA_SIZE = 32;
+constexpr u32 MAX_PACKET_DATA_SIZE = 1024;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
+/// Memory ranges pushed every frame across all the clients
+constexpr u32 MAX_SUBSCRIPTIONS = 256;
 
 class Packet {
 public:
@@ -61,6 +88,14 @@ public:
         header.packet_size = size;
     }
 
+    void SetId(u32 id) {
+        header.id = id;
+    }
+
+    void SetPacketType(PacketType packet_type) {
+        header.packet_type = packet_type;
+    }
+
     void SendReply() {
         send_reply_callback(*this);
     }
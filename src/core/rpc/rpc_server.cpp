@@ -1,13 +1,38 @@
+#include <array>
+#include <cstring>
 #include "common/logging/log.h"
+#include "common/microprofile_trace.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/frame_counters.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/svc.h"
 #include "core/memory.h"
+#include "core/memory_watch.h"
 #include "core/rpc/packet.h"
 #include "core/rpc/rpc_server.h"
 
 namespace RPC {
 
+namespace {
+
+void WriteMemory(u32 address, const u8* data, u32 data_size) {
+    // Only allow writing to certain memory regions
+    if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
+        (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
+        (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END)) {
+        // Note: Memory write occurs asynchronously from the state of the emulator
+        Core::System::GetInstance().Memory().WriteBlock(
+            *Core::System::GetInstance().Kernel().GetCurrentProcess(), address, data, data_size);
+        // If the memory happens to be executable code, make sure the changes become visible
+
+        // Is current core correct here?
+        Core::System::GetInstance().InvalidateCacheRange(address, data_size);
+    }
+}
+
+} // Anonymous namespace
+
 RPCServer::RPCServer() : server(*this) {
     LOG_INFO(RPC_Server, "Starting RPC server ...");
 
@@ -38,27 +63,199 @@ void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
 }
 
 void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size) {
-    // Only allow writing to certain memory regions
-    if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
-        (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
-        (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END)) {
-        // Note: Memory write occurs asynchronously from the state of the emulator
-        Core::System::GetInstance().Memory().WriteBlock(
-            *Core::System::GetInstance().Kernel().GetCurrentProcess(), address, data, data_size);
-        // If the memory happens to be executable code, make sure the changes become visible
+    WriteMemory(address, data, data_size);
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
 
-        // Is current core correct here?
-        Core::System::GetInstance().InvalidateCacheRange(address, data_size);
+void RPCServer::HandleReadFramePercentiles(Packet& packet, u32 metric) {
+    // Reply with the p50, p95 and p99 of the metric since the stats were last reset, in
+    // microseconds
+    Core::PerfStats::Results results{};
+    if (const auto& perf_stats = Core::System::GetInstance().perf_stats) {
+        perf_stats->GetPercentiles(results);
     }
-    packet.SetPacketDataSize(0);
+
+    Core::PerfStats::Percentiles percentiles{};
+    switch (static_cast<FrameMetric>(metric)) {
+    case FrameMetric::Frametime:
+        percentiles = results.frametime_percentiles;
+        break;
+    case FrameMetric::CpuTime:
+        percentiles = results.cpu_time_percentiles;
+        break;
+    case FrameMetric::GpuSubmitTime:
+        percentiles = results.gpu_submit_percentiles;
+        break;
+    case FrameMetric::PresentTime:
+        percentiles = results.present_percentiles;
+        break;
+    case FrameMetric::InputLatency:
+        percentiles = results.input_latency_percentiles;
+        break;
+    default:
+        packet.SetPacketDataSize(0);
+        packet.SendReply();
+        return;
+    }
+
+    const std::array<u32, 3> values{static_cast<u32>(percentiles.p50 * 1e6),
+                                    static_cast<u32>(percentiles.p95 * 1e6),
+                                    static_cast<u32>(percentiles.p99 * 1e6)};
+    std::memcpy(packet.GetPacketData().data(), values.data(), sizeof(values));
+    packet.SetPacketDataSize(sizeof(values));
+    packet.SendReply();
+}
+
+void RPCServer::HandleCaptureTrace(Packet& packet, u32 num_frames) {
+    // Reply with 1 if the capture started. The trace is written to the log directory.
+    const u32 started = Common::Profiling::StartTraceCapture(
+        Common::Profiling::GetDefaultTracePath(), num_frames);
+    std::memcpy(packet.GetPacketData().data(), &started, sizeof(started));
+    packet.SetPacketDataSize(sizeof(started));
+    packet.SendReply();
+}
+
+void RPCServer::HandleReadFrameCounters(Packet& packet) {
+    // Reply with the FrameCounter events of the previous system frame, in enum order
+    Core::FrameCounterValues counters{};
+    if (const auto& perf_stats = Core::System::GetInstance().perf_stats) {
+        counters = perf_stats->GetLastFrameCounters();
+    }
+    static_assert(sizeof(counters) <= MAX_PACKET_DATA_SIZE);
+    std::memcpy(packet.GetPacketData().data(), counters.data(), sizeof(counters));
+    packet.SetPacketDataSize(sizeof(counters));
+    packet.SendReply();
+}
+
+void RPCServer::HandleReadSVCCounts(Packet& packet) {
+    // Reply with the 64-bit call count of every SVC since the emulator started, by SVC number
+    const Kernel::SVCCallCounts counts = Kernel::GetSVCCallCounts();
+    static_assert(sizeof(counts) <= MAX_PACKET_DATA_SIZE);
+    std::memcpy(packet.GetPacketData().data(), counts.data(), sizeof(counts));
+    packet.SetPacketDataSize(sizeof(counts));
     packet.SendReply();
 }
 
+bool RPCServer::HandleBatch(Packet& packet) {
+    // The reply is written over the request, so work on a copy of it
+    const u32 request_size = packet.GetPacketDataSize();
+    const std::array<u8, MAX_PACKET_DATA_SIZE> request = packet.GetPacketData();
+
+    // Check the whole batch first, so that it is either applied entirely or not at all
+    u32 reply_size = 0;
+    for (u32 offset = 0; offset < request_size;) {
+        if (request_size - offset < sizeof(BatchOperation)) {
+            return false;
+        }
+        BatchOperation operation;
+        std::memcpy(&operation, request.data() + offset, sizeof(operation));
+        offset += sizeof(operation);
+
+        switch (operation.operation_type) {
+        case PacketType::ReadMemory:
+            if (operation.data_size > MAX_READ_SIZE - reply_size) {
+                return false;
+            }
+            reply_size += operation.data_size;
+            break;
+        case PacketType::WriteMemory:
+            if (operation.data_size > request_size - offset) {
+                return false;
+            }
+            offset += operation.data_size;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    // Reply with the data of the reads, in order
+    auto& system = Core::System::GetInstance();
+    const auto& process = *system.Kernel().GetCurrentProcess();
+    reply_size = 0;
+    for (u32 offset = 0; offset < request_size;) {
+        BatchOperation operation;
+        std::memcpy(&operation, request.data() + offset, sizeof(operation));
+        offset += sizeof(operation);
+
+        if (operation.operation_type == PacketType::ReadMemory) {
+            // Note: Memory read occurs asynchronously from the state of the emulator
+            system.Memory().ReadBlock(process, operation.address,
+                                      packet.GetPacketData().data() + reply_size,
+                                      operation.data_size);
+            reply_size += operation.data_size;
+        } else {
+            WriteMemory(operation.address, request.data() + offset, operation.data_size);
+            offset += operation.data_size;
+        }
+    }
+    packet.SetPacketDataSize(reply_size);
+    packet.SendReply();
+    return true;
+}
+
+bool RPCServer::HandleSubscribe(std::unique_ptr<Packet>& packet, u32 address, u32 data_size) {
+    if (data_size == 0 || data_size > MAX_READ_SIZE ||
+        subscriptions.size() >= MAX_SUBSCRIPTIONS) {
+        return false;
+    }
+    const u32 subscription_id =
+        Core::System::GetInstance().MemoryWatch().AddWatch(address, data_size);
+    if (subscription_id == 0) {
+        return false;
+    }
+
+    // Reply with the id of the subscription, which its pushes carry in place of a request id
+    std::memcpy(packet->GetPacketData().data(), &subscription_id, sizeof(subscription_id));
+    packet->SetPacketDataSize(sizeof(subscription_id));
+    packet->SendReply();
+
+    packet->SetId(subscription_id);
+    packet->SetPacketType(PacketType::SubscriptionData);
+    subscriptions.emplace(subscription_id, Subscription{data_size, std::move(packet)});
+    has_subscriptions = true;
+    return true;
+}
+
+void RPCServer::HandleUnsubscribe(Packet& packet, u32 subscription_id) {
+    // Reply with 1 if the subscription existed
+    const u32 removed = static_cast<u32>(subscriptions.erase(subscription_id));
+    if (removed) {
+        Core::System::GetInstance().MemoryWatch().RemoveWatch(subscription_id);
+    }
+    has_subscriptions = !subscriptions.empty();
+    std::memcpy(packet.GetPacketData().data(), &removed, sizeof(removed));
+    packet.SetPacketDataSize(sizeof(removed));
+    packet.SendReply();
+}
+
+void RPCServer::PushSubscriptions() {
+    frame_end_pending = false;
+
+    // The ranges were copied at the end of the frame, so all pushes show the same frame
+    const auto& memory_watch = Core::System::GetInstance().MemoryWatch();
+    for (auto& [id, subscription] : subscriptions) {
+        Packet& packet = *subscription.packet;
+        if (memory_watch.Read(id, packet.GetPacketData().data())) {
+            packet.SetPacketDataSize(subscription.data_size);
+            packet.SendReply();
+        }
+    }
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
         case PacketType::ReadMemory:
         case PacketType::WriteMemory:
+        case PacketType::ReadFramePercentiles:
+        case PacketType::CaptureTrace:
+        case PacketType::ReadFrameCounters:
+        case PacketType::ReadSVCCounts:
+        case PacketType::Batch:
+        case PacketType::Subscribe:
+        case PacketType::Unsubscribe:
             if (packet_header.packet_size >= (sizeof(u32) * 2)) {
                 return true;
             }
@@ -74,7 +271,7 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
+        // All request types but Batch use the address/data_size wire format
         u32 address = 0;
         u32 data_size = 0;
         std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
@@ -95,6 +292,33 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
                 success = true;
             }
             break;
+        case PacketType::ReadFramePercentiles:
+            HandleReadFramePercentiles(*request_packet, address);
+            success = true;
+            break;
+        case PacketType::CaptureTrace:
+            HandleCaptureTrace(*request_packet, address);
+            success = true;
+            break;
+        case PacketType::ReadFrameCounters:
+            HandleReadFrameCounters(*request_packet);
+            success = true;
+            break;
+        case PacketType::ReadSVCCounts:
+            HandleReadSVCCounts(*request_packet);
+            success = true;
+            break;
+        case PacketType::Batch:
+            success = HandleBatch(*request_packet);
+            break;
+        case PacketType::Subscribe:
+            // Keeps the packet to push the range through on success
+            success = HandleSubscribe(request_packet, address, data_size);
+            break;
+        case PacketType::Unsubscribe:
+            HandleUnsubscribe(*request_packet, address);
+            success = true;
+            break;
         default:
             break;
         }
@@ -108,17 +332,29 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
 }
 
 void RPCServer::HandleRequestsLoop() {
-    std::unique_ptr<RPC::Packet> request_packet;
-
     LOG_INFO(RPC_Server, "Request handler started.");
 
-    while ((request_packet = request_queue.PopWait())) {
-        HandleSingleRequest(std::move(request_packet));
+    while (true) {
+        Request request = request_queue.PopWait();
+        if (request.frame_end) {
+            PushSubscriptions();
+        } else if (request.packet) {
+            HandleSingleRequest(std::move(request.packet));
+        } else {
+            break;
+        }
     }
 }
 
 void RPCServer::QueueRequest(std::unique_ptr<RPC::Packet> request) {
-    request_queue.Push(std::move(request));
+    request_queue.Push(Request{std::move(request)});
+}
+
+void RPCServer::OnFrameEnd() {
+    if (!has_subscriptions || frame_end_pending.exchange(true)) {
+        return;
+    }
+    request_queue.Push(Request{nullptr, true});
 }
 
 void RPCServer::Start() {
@@ -128,8 +364,15 @@ void RPCServer::Start() {
 }
 
 void RPCServer::Stop() {
-    server.Stop();
+    // Subscriptions reply through the transports, so they are only destroyed once the request
+    // handler ended
+    QueueRequest(nullptr);
     request_handler_thread.join();
+    for (const auto& [id, subscription] : subscriptions) {
+        Core::System::GetInstance().MemoryWatch().RemoveWatch(id);
+    }
+    subscriptions.clear();
+    server.Stop();
 }
 
 }; // namespace RPC
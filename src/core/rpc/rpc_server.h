@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -23,18 +25,49 @@ public:
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
+    /// Pushes the subscribed memory ranges to their clients. Called at the end of each game frame.
+    void OnFrameEnd();
+
 private:
+    /// Work for the request handler thread. A null packet that is not a frame end stops it.
+    struct Request {
+        std::unique_ptr<Packet> packet;
+        bool frame_end = false;
+    };
+
+    /// Pushes a memory watch of the core, which has the same id
+    struct Subscription {
+        u32 data_size;
+        /// Reused for every push, replies through the transport the subscription came from
+        std::unique_ptr<Packet> packet;
+    };
+
     void Start();
     void Stop();
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size);
+    void HandleReadFramePercentiles(Packet& packet, u32 metric);
+    void HandleCaptureTrace(Packet& packet, u32 num_frames);
+    void HandleReadFrameCounters(Packet& packet);
+    void HandleReadSVCCounts(Packet& packet);
+    bool HandleBatch(Packet& packet);
+    bool HandleSubscribe(std::unique_ptr<Packet>& packet, u32 address, u32 data_size);
+    void HandleUnsubscribe(Packet& packet, u32 subscription_id);
+    void PushSubscriptions();
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop();
 
     Server server;
-    Common::SPSCQueue<std::unique_ptr<Packet>> request_queue;
+    /// Fed by the transports and the emulation thread
+    Common::MPSCQueue<Request> request_queue;
     std::thread request_handler_thread;
+
+    /// Only accessed by the request handler thread
+    std::map<u32, Subscription> subscriptions;
+    std::atomic<bool> has_subscriptions{false};
+    /// Set while a frame end is queued, so that a stalled handler does not accumulate them
+    std::atomic<bool> frame_end_pending{false};
 };
 
 } // namespace RPC
@@ -1,8 +1,10 @@
 #include <functional>
+#include <stdexcept>
 #include "core/core.h"
 #include "core/rpc/packet.h"
 #include "core/rpc/rpc_server.h"
 #include "core/rpc/server.h"
+#include "core/rpc/shared_memory_server.h"
 #include "core/rpc/udp_server.h"
 
 namespace RPC {
@@ -21,18 +23,24 @@ void Server::Start() {
     } catch (...) {
         LOG_ERROR(RPC_Server, "Error starting UDP server");
     }
+
+    try {
+        shared_memory_server = std::make_unique<SharedMemoryServer>(callback);
+    } catch (const std::exception& e) {
+        LOG_ERROR(RPC_Server, "Error starting shared memory server: {}", e.what());
+    }
 }
 
 void Server::Stop() {
     udp_server.reset();
-    NewRequestCallback(nullptr); // Notify the RPC server to end
+    shared_memory_server.reset();
 }
 
 void Server::NewRequestCallback(std::unique_ptr<RPC::Packet> new_request) {
     if (new_request) {
-        LOG_INFO(RPC_Server, "Received request version={} id={} type={} size={}",
-                 new_request->GetVersion(), new_request->GetId(), new_request->GetPacketType(),
-                 new_request->GetPacketDataSize());
+        LOG_TRACE(RPC_Server, "Received request version={} id={} type={} size={}",
+                  new_request->GetVersion(), new_request->GetId(), new_request->GetPacketType(),
+                  new_request->GetPacketDataSize());
     } else {
         LOG_INFO(RPC_Server, "Received end packet");
     }
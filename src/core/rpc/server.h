@@ -9,6 +9,7 @@
 namespace RPC {
 
 class RPCServer;
+class SharedMemoryServer;
 class UDPServer;
 class Packet;
 
@@ -23,6 +24,7 @@ public:
 private:
     RPCServer& rpc_server;
     std::unique_ptr<UDPServer> udp_server;
+    std::unique_ptr<SharedMemoryServer> shared_memory_server;
 };
 
 } // namespace RPC
@@ -0,0 +1,214 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include "common/common_types.h"
+#include "common/logging/log.h"
+#include "core/rpc/packet.h"
+#include "core/rpc/shared_memory_server.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace RPC {
+
+namespace {
+
+constexpr u32 SharedMemoryMagic = 0x43505243; // "CRPC"
+constexpr std::size_t NumPushSlots = 64;
+/// Iterations the server yields for before it starts sleeping between polls
+constexpr u32 SpinIterations = 1000;
+
+#ifdef _WIN32
+constexpr wchar_t SharedMemoryName[] = L"citra-rpc";
+#else
+constexpr char SharedMemoryName[] = "/citra-rpc";
+#endif
+
+static_assert(std::atomic<u32>::is_always_lock_free, "Shared atomics must not use locks");
+
+struct PushSlot {
+    /// Number of the push held by the slot plus one, or 0 while it is being written
+    std::atomic<u32> sequence;
+    std::array<u8, MAX_PACKET_SIZE> packet;
+};
+
+/**
+ * Layout of the shared memory region, mirrored by dist/scripting/citra.py. The client writes a
+ * packet to `request` and increments `request_sequence`, then waits for `reply_sequence` to match
+ * it. Subscription pushes are appended to the `pushes` ring, where slow readers miss the oldest.
+ */
+struct SharedRegion {
+    u32 magic;
+    u32 version;
+    std::atomic<u32> request_sequence;
+    std::atomic<u32> reply_sequence;
+    std::atomic<u32> push_count;
+    u32 reserved;
+    std::array<u8, MAX_PACKET_SIZE> request;
+    std::array<u8, MAX_PACKET_SIZE> reply;
+    std::array<PushSlot, NumPushSlots> pushes;
+};
+
+} // Anonymous namespace
+
+class SharedMemoryServer::Impl {
+public:
+    explicit Impl(std::function<void(std::unique_ptr<Packet>)> new_request_callback)
+        : new_request_callback(std::move(new_request_callback)) {
+        void* memory = Map();
+        // Clears whatever a previous session left in the region
+        region = new (memory) SharedRegion();
+        region->magic = SharedMemoryMagic;
+        region->version = CURRENT_VERSION;
+
+        worker_thread = std::thread([this] { Run(); });
+    }
+
+    ~Impl() {
+        stop = true;
+        worker_thread.join();
+        Unmap();
+    }
+
+private:
+#ifdef _WIN32
+    void* Map() {
+        mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                     sizeof(SharedRegion), SharedMemoryName);
+        if (!mapping) {
+            throw std::runtime_error("CreateFileMappingW failed");
+        }
+        void* memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedRegion));
+        if (!memory) {
+            CloseHandle(mapping);
+            throw std::runtime_error("MapViewOfFile failed");
+        }
+        return memory;
+    }
+
+    void Unmap() {
+        UnmapViewOfFile(region);
+        CloseHandle(mapping);
+    }
+
+    HANDLE mapping = nullptr;
+#elif defined(__ANDROID__)
+    void* Map() {
+        throw std::runtime_error("Shared memory is not supported");
+    }
+
+    void Unmap() {}
+#else
+    void* Map() {
+        const int fd = shm_open(SharedMemoryName, O_CREAT | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("shm_open failed");
+        }
+        void* memory = MAP_FAILED;
+        if (ftruncate(fd, sizeof(SharedRegion)) == 0) {
+            memory = mmap(nullptr, sizeof(SharedRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (memory == MAP_FAILED) {
+            shm_unlink(SharedMemoryName);
+            throw std::runtime_error("mmap failed");
+        }
+        return memory;
+    }
+
+    void Unmap() {
+        munmap(region, sizeof(SharedRegion));
+        shm_unlink(SharedMemoryName);
+    }
+#endif
+
+    void Run() {
+        u32 handled_sequence = 0;
+        u32 idle_iterations = 0;
+        while (!stop) {
+            const u32 sequence = region->request_sequence.load(std::memory_order_acquire);
+            if (sequence == handled_sequence) {
+                // Clients usually send their next request right after a reply, so spin briefly
+                if (++idle_iterations < SpinIterations) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                continue;
+            }
+            idle_iterations = 0;
+            handled_sequence = sequence;
+            HandleRequest(sequence);
+        }
+    }
+
+    void HandleRequest(u32 sequence) {
+        PacketHeader header;
+        std::memcpy(&header, region->request.data(), sizeof(header));
+        if (header.packet_size > MAX_PACKET_DATA_SIZE) {
+            LOG_WARNING(RPC_Server, "Received message with wrong size: {}", header.packet_size);
+            // Reply anyway, as the client waits for it
+            header.packet_size = 0;
+            std::memcpy(region->reply.data(), &header, sizeof(header));
+            region->reply_sequence.store(sequence, std::memory_order_release);
+            return;
+        }
+
+        u8* data = region->request.data() + MIN_PACKET_SIZE;
+        std::function<void(Packet&)> send_reply_callback =
+            std::bind(&Impl::SendReply, this, sequence, std::placeholders::_1);
+        new_request_callback(std::make_unique<Packet>(header, data, send_reply_callback));
+    }
+
+    /// Called from the request handler thread only, so writes to the region never race
+    void SendReply(u32 sequence, Packet& reply_packet) {
+        const auto& reply_header = reply_packet.GetHeader();
+        if (reply_header.packet_type == PacketType::SubscriptionData) {
+            const u32 push = region->push_count.load(std::memory_order_relaxed);
+            PushSlot& slot = region->pushes[push % NumPushSlots];
+            slot.sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            WritePacket(slot.packet, reply_packet);
+            slot.sequence.store(push + 1, std::memory_order_release);
+            region->push_count.store(push + 1, std::memory_order_release);
+            return;
+        }
+
+        WritePacket(region->reply, reply_packet);
+        region->reply_sequence.store(sequence, std::memory_order_release);
+    }
+
+    static void WritePacket(std::array<u8, MAX_PACKET_SIZE>& buffer, Packet& packet) {
+        const auto& header = packet.GetHeader();
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        std::memcpy(buffer.data() + MIN_PACKET_SIZE, packet.GetPacketData().data(),
+                    packet.GetPacketDataSize());
+    }
+
+    SharedRegion* region = nullptr;
+    std::atomic<bool> stop{false};
+    std::thread worker_thread;
+
+    std::function<void(std::unique_ptr<Packet>)> new_request_callback;
+};
+
+SharedMemoryServer::SharedMemoryServer(
+    std::function<void(std::unique_ptr<Packet>)> new_request_callback)
+    : impl(std::make_unique<Impl>(new_request_callback)) {}
+
+SharedMemoryServer::~SharedMemoryServer() = default;
+
+} // namespace RPC
@@ -0,0 +1,29 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+namespace RPC {
+
+class Packet;
+
+/**
+ * Serves requests through a shared memory region named "citra-rpc", for clients on the same
+ * machine that cannot afford a socket round trip per request. The region is a single request slot,
+ * a single reply slot and a ring of pushed subscription packets, so one client uses it at a time.
+ */
+class SharedMemoryServer {
+public:
+    explicit SharedMemoryServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback);
+    ~SharedMemoryServer();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace RPC
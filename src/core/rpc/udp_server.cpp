@@ -72,9 +72,9 @@ private:
         if (error) {
             LOG_WARNING(RPC_Server, "Failed to send reply: {}", error.message());
         } else {
-            LOG_INFO(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
-                     reply_packet.GetVersion(), reply_packet.GetId(), reply_packet.GetPacketType(),
-                     reply_packet.GetPacketDataSize());
+            LOG_TRACE(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
+                      reply_packet.GetVersion(), reply_packet.GetId(), reply_packet.GetPacketType(),
+                      reply_packet.GetPacketDataSize());
         }
     }
 
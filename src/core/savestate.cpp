@@ -2,17 +2,28 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
+#include <mutex>
+#include <thread>
 #include <boost/serialization/binary_object.hpp>
 #include <cryptopp/hex.h>
 #include "common/archives.h"
+#include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/thread.h"
 #include "common/zstd_compression.h"
 #include "core/cheats/cheats.h"
 #include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
 #include "core/movie.h"
+#include "core/rewind_buffer.h"
 #include "core/savestate.h"
+#include "core/settings.h"
 #include "network/network.h"
 #include "video_core/video_core.h"
 
@@ -25,7 +36,15 @@ struct CSTHeader {
     std::array<u8, 20> revision; /// Git hash of the revision this savestate was created with
     u64_le time;                 /// The time when this save state was created
 
-    std::array<u8, 216> reserved; /// Make heading 256 bytes so it has consistent size
+    u8 is_delta;        /// Non-zero if only the memory pages that changed since the base are stored
+    u32_le base_slot;   /// Slot of the full save state a delta is based on
+    u64_le base_time;   /// Creation time of the base, to check it has not been replaced since
+
+    u8 is_run_ahead; /// Non-zero if uncompressed, with the RAM kept by the core that saved it
+
+    u32_le dictionary_id; /// ID of the zstd dictionary the state is compressed with, 0 if none
+
+    std::array<u8, 198> reserved; /// Make heading 256 bytes so it has consistent size
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
@@ -97,29 +116,94 @@ std::vector<SaveStateInfo> ListSaveStates(u64 program_id) {
     return result;
 }
 
-void System::SaveState(u32 slot) const {
-    std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
+/**
+ * Returns the path of the boot snapshot of an application. The name identifies what the booted
+ * state depends on: the code of the application, and the settings the system is set up with.
+ */
+static std::string GetBootSnapshotPath(u64 program_id, const Kernel::CodeSet& codeset) {
+    const auto& values = Settings::values;
+    const std::string settings =
+        fmt::format("{}:{}:{}:{}:{}:{}:{}", values.is_new_3ds, values.region_value,
+                    static_cast<int>(values.init_clock), values.init_time,
+                    values.cpu_clock_percentage, values.enable_dsp_lle, values.boot_snapshot_frame);
+    return fmt::format("{}boot/{:016X}_{:016X}_{:016X}.cst",
+                       FileUtil::GetUserPath(FileUtil::UserPath::StatesDir), program_id,
+                       Common::ComputeHash64(codeset.memory.data(), codeset.memory.size()),
+                       Common::ComputeHash64(settings.data(), settings.size()));
+}
 
-    const std::string& str{sstream.str()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(
-        reinterpret_cast<const u8*>(str.data()), str.size());
+/// Save states at least this large are compressed on several threads
+constexpr std::size_t MULTITHREADED_COMPRESSION_SIZE = 32 * 1024 * 1024;
 
-    const auto path = GetSaveStatePath(title_id, slot);
-    if (!FileUtil::CreateFullPath(path)) {
-        throw std::runtime_error("Could not create path " + path);
+/// Size of the pieces of save states that dictionaries are trained from
+constexpr std::size_t DICTIONARY_SAMPLE_SIZE = 4096;
+/// Most bytes of save states that a dictionary is trained from, spread over all of them
+constexpr std::size_t MAX_DICTIONARY_SAMPLES_SIZE = 128 * 1024 * 1024;
+constexpr std::size_t DICTIONARY_CAPACITY = 112 * 1024;
+
+static std::string GetDictionaryPath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::StatesDir) + "savestates.zdict";
+}
+
+/**
+ * Returns the dictionary that save states are compressed with, which is empty if there is none.
+ * It is read once, as save states are written from their own thread.
+ */
+static const std::vector<u8>& GetDictionary() {
+    static std::once_flag loaded;
+    static std::vector<u8> dictionary;
+    std::call_once(loaded, [] {
+        const std::string path = GetDictionaryPath();
+        if (!FileUtil::Exists(path)) {
+            return;
+        }
+        FileUtil::IOFile file(path, "rb");
+        std::vector<u8> data(file.GetSize());
+        if (!file || file.ReadBytes(data.data(), data.size()) != data.size() ||
+            Common::Compression::GetDictionaryIDZSTD(data) == 0) {
+            LOG_ERROR(Core, "Ignoring the invalid save state dictionary {}", path);
+            return;
+        }
+        dictionary = std::move(data);
+        LOG_INFO(Core, "Compressing save states with the dictionary {}", path);
+    });
+    return dictionary;
+}
+
+/// Sets up decompression of a save state with the dictionary given in its header
+static void SetDictionary(Common::Compression::ZSTDDecompressBuffer& buffer,
+                          const CSTHeader& header) {
+    if (header.dictionary_id == 0) {
+        return;
+    }
+    const std::vector<u8>& dictionary = GetDictionary();
+    if (Common::Compression::GetDictionaryIDZSTD(dictionary) != header.dictionary_id ||
+        !buffer.SetDictionary(dictionary)) {
+        throw std::runtime_error(fmt::format(
+            "The save state needs the dictionary {:08X} at {}", header.dictionary_id,
+            GetDictionaryPath()));
     }
+}
 
-    FileUtil::IOFile file(path, "wb");
-    if (!file) {
-        throw std::runtime_error("Could not open file " + path);
+/// Sets up compression of a save state with the dictionary in header, and on several threads
+static void SetCompression(Common::Compression::ZSTDCompressBuffer& buffer,
+                           const CSTHeader& header, std::size_t size) {
+    if (header.dictionary_id != 0 && !buffer.SetDictionary(GetDictionary())) {
+        throw std::runtime_error("Could not load the save state dictionary");
+    }
+    if (size >= MULTITHREADED_COMPRESSION_SIZE) {
+        buffer.SetWorkerCount(std::clamp(std::thread::hardware_concurrency(), 1u, 4u));
     }
+}
+
+static bool IsCurrentRevision(const CSTHeader& header) {
+    return fmt::format("{:02x}", fmt::join(header.revision, "")) == Common::g_scm_rev;
+}
 
+static CSTHeader MakeHeader(u64 program_id) {
     CSTHeader header{};
     header.filetype = header_magic_bytes;
-    header.program_id = title_id;
+    header.program_id = program_id;
     std::string rev_bytes;
     CryptoPP::StringSource(Common::g_scm_rev, true,
                            new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
@@ -127,66 +211,391 @@ void System::SaveState(u32 slot) const {
     header.time = std::chrono::duration_cast<std::chrono::seconds>(
                       std::chrono::system_clock::now().time_since_epoch())
                       .count();
+    header.dictionary_id = Common::Compression::GetDictionaryIDZSTD(GetDictionary());
+    return header;
+}
+
+static CSTHeader ReadHeader(const std::string& path) {
+    CSTHeader header;
+    FileUtil::IOFile file(path, "rb");
+    if (!file || file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+    if (header.filetype != header_magic_bytes) {
+        throw std::runtime_error("Invalid save state file " + path);
+    }
+    return header;
+}
+
+namespace {
+
+/// Output stream buffer appending to a vector, keeping its allocation
+class VectorStreamBuffer final : public std::streambuf {
+public:
+    explicit VectorStreamBuffer(std::vector<u8>& data_) : data(data_) {
+        data.clear();
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            data.push_back(static_cast<u8>(traits_type::to_char_type(ch)));
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        data.insert(data.end(), s, s + n);
+        return n;
+    }
 
-    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
-        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
-        throw std::runtime_error("Could not write to file " + path);
+private:
+    std::vector<u8>& data;
+};
+
+/// Input stream buffer reading from memory
+class MemoryStreamBuffer final : public std::streambuf {
+public:
+    MemoryStreamBuffer(const u8* data, std::size_t size) {
+        // The get area is only read from
+        char* const begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+};
+
+void WriteStateFile(const std::string& path, const CSTHeader& header,
+                    const std::vector<u8>& data) {
+    if (!FileUtil::CreateFullPath(path)) {
+        throw std::runtime_error("Could not create path " + path);
+    }
+
+    // Written next to the previous save state, so that it is kept if saving fails
+    const auto temp_path = path + ".tmp";
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file) {
+            throw std::runtime_error("Could not open file " + temp_path);
+        }
+        if (file.WriteBytes(&header, sizeof(header)) != sizeof(header)) {
+            throw std::runtime_error("Could not write to file " + temp_path);
+        }
+
+        // Compressed and written in chunks
+        Common::Compression::ZSTDCompressBuffer buffer{[&](const u8* chunk, std::size_t size) {
+            if (file.WriteBytes(chunk, size) != size) {
+                throw std::runtime_error("Could not write to file " + temp_path);
+            }
+        }};
+        SetCompression(buffer, header, data.size());
+        const auto size = static_cast<std::streamsize>(data.size());
+        if (buffer.sputn(reinterpret_cast<const char*>(data.data()), size) != size ||
+            !buffer.Finish()) {
+            throw std::runtime_error("Could not compress save state");
+        }
+    }
+
+    if (FileUtil::Exists(path) && !FileUtil::Delete(path)) {
+        throw std::runtime_error("Could not replace file " + path);
+    }
+    if (!FileUtil::Rename(temp_path, path)) {
+        throw std::runtime_error("Could not rename file " + temp_path);
     }
 }
 
+} // Anonymous namespace
+
+bool TrainSaveStateDictionary(const std::vector<std::string>& state_paths,
+                              const std::string& output_path) {
+    if (state_paths.empty()) {
+        LOG_ERROR(Core, "No save states to train a dictionary from");
+        return false;
+    }
+
+    std::vector<u8> samples;
+    std::vector<std::size_t> sample_sizes;
+    const std::size_t budget = MAX_DICTIONARY_SAMPLES_SIZE / state_paths.size();
+    for (const auto& path : state_paths) {
+        std::vector<u8> data;
+        try {
+            FileUtil::IOFile file(path, "rb");
+            CSTHeader header;
+            if (!file || file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+                header.filetype != header_magic_bytes || header.is_run_ahead) {
+                throw std::runtime_error("not a save state file");
+            }
+            Common::Compression::ZSTDDecompressBuffer buffer{
+                [&file](u8* chunk, std::size_t size) { return file.ReadBytes(chunk, size); }};
+            SetDictionary(buffer, header);
+
+            constexpr std::size_t READ_SIZE = 1024 * 1024;
+            std::streamsize read;
+            do {
+                const std::size_t offset = data.size();
+                data.resize(offset + READ_SIZE);
+                read = buffer.sgetn(reinterpret_cast<char*>(data.data() + offset), READ_SIZE);
+                data.resize(offset + static_cast<std::size_t>(read));
+            } while (read == static_cast<std::streamsize>(READ_SIZE));
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Skipping {}: {}", path, e.what());
+            continue;
+        }
+
+        // Pieces spread evenly over the state, other than the empty ones that need no dictionary
+        const std::size_t num_pieces = data.size() / DICTIONARY_SAMPLE_SIZE;
+        const std::size_t step = std::max<std::size_t>(
+            1, num_pieces * DICTIONARY_SAMPLE_SIZE / std::max<std::size_t>(budget, 1));
+        for (std::size_t piece = 0; piece < num_pieces; piece += step) {
+            const u8* const begin = data.data() + piece * DICTIONARY_SAMPLE_SIZE;
+            const u8* const end = begin + DICTIONARY_SAMPLE_SIZE;
+            if (std::all_of(begin, end, [](u8 byte) { return byte == 0; })) {
+                continue;
+            }
+            samples.insert(samples.end(), begin, end);
+            sample_sizes.push_back(DICTIONARY_SAMPLE_SIZE);
+        }
+        LOG_INFO(Core, "Sampled {} bytes of {}", data.size(), path);
+    }
+
+    const std::vector<u8> dictionary =
+        Common::Compression::TrainDictionaryZSTD(samples, sample_sizes, DICTIONARY_CAPACITY);
+    if (dictionary.empty()) {
+        LOG_ERROR(Core, "Could not train a dictionary from {} samples", sample_sizes.size());
+        return false;
+    }
+
+    FileUtil::IOFile file(output_path, "wb");
+    if (!file || file.WriteBytes(dictionary.data(), dictionary.size()) != dictionary.size()) {
+        LOG_ERROR(Core, "Could not write the dictionary to {}", output_path);
+        return false;
+    }
+    LOG_INFO(Core, "Wrote the dictionary {:08X} of {} bytes to {}",
+             Common::Compression::GetDictionaryIDZSTD(dictionary), dictionary.size(),
+             output_path);
+    return true;
+}
+
+void System::WriteState(std::string path, const CSTHeader& header,
+                        std::function<void(const std::string& error)> on_written) const {
+    WaitForSaveState();
+
+    // Only the serialization, which mostly copies memory, is done on the emulation thread.
+    // Reserving the previous size spares the regrowth without keeping the last state around.
+    std::vector<u8> data;
+    data.reserve(last_save_state_size);
+    {
+        VectorStreamBuffer buffer{data};
+        oarchive oa{buffer};
+        oa&* this;
+    }
+    last_save_state_size = data.size();
+
+    // The writer owns the state and frees it as soon as the file is written
+    save_state_thread = std::thread([header, data = std::move(data), path = std::move(path),
+                                     on_written = std::move(on_written)]() mutable {
+        Common::SetCurrentThreadName("SaveState");
+        std::string error;
+        try {
+            WriteStateFile(path, header, data);
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error writing save state: {}", e.what());
+            error = e.what();
+        }
+        data = {};
+        on_written(error);
+    });
+}
+
+void System::WriteState(u32 slot, const CSTHeader& header) const {
+    WriteState(GetSaveStatePath(title_id, slot), header, [this, slot](const std::string& error) {
+        if (error.empty()) {
+            LOG_INFO(Core, "Save state written to slot {}", slot);
+        }
+        if (save_state_callback) {
+            save_state_callback(slot, error);
+        }
+    });
+}
+
+void System::WaitForSaveState() const {
+    if (save_state_thread.joinable()) {
+        save_state_thread.join();
+    }
+}
+
+void System::ReadState(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    CSTHeader header;
+    if (!file || file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+
+    // Read and decompressed while deserializing
+    Common::Compression::ZSTDDecompressBuffer buffer{
+        [&file](u8* data, std::size_t size) { return file.ReadBytes(data, size); }};
+    SetDictionary(buffer, header);
+    iarchive ia{buffer};
+    ia&* this;
+}
+
+void System::SaveState(u32 slot) const {
+    const CSTHeader header = MakeHeader(title_id);
+    WriteState(slot, header);
+
+    memory->SnapshotPageHashes();
+    delta_base_slot = slot;
+    delta_base_time = header.time;
+}
+
+void System::SaveDeltaState(u32 slot) const {
+    if (delta_base_slot == 0 || !memory->HasPageHashSnapshot()) {
+        throw std::runtime_error("A full save state must be saved or loaded first");
+    }
+    if (slot == delta_base_slot) {
+        throw std::runtime_error("A delta save state cannot replace its base");
+    }
+
+    CSTHeader header = MakeHeader(title_id);
+    header.is_delta = 1;
+    header.base_slot = delta_base_slot;
+    header.base_time = delta_base_time;
+
+    Memory::MemorySystem::BeginDeltaSave();
+    SCOPE_EXIT({ Memory::MemorySystem::EndDeltaSerialization(); });
+    WriteState(slot, header);
+}
+
 void System::LoadState(u32 slot) {
     if (Network::GetRoomMember().lock()->IsConnected()) {
         throw std::runtime_error("Unable to load while connected to multiplayer");
     }
+    WaitForSaveState();
 
-    const auto path = GetSaveStatePath(title_id, slot);
+    const CSTHeader header = ReadHeader(GetSaveStatePath(title_id, slot));
+    if (!header.is_delta) {
+        ReadState(GetSaveStatePath(title_id, slot));
 
-    std::vector<u8> decompressed;
-    {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
+        memory->SnapshotPageHashes();
+        delta_base_slot = slot;
+        delta_base_time = header.time;
+        return;
+    }
 
-        FileUtil::IOFile file(path, "rb");
-        file.Seek(sizeof(CSTHeader), SEEK_SET); // Skip header
-        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
-            throw std::runtime_error("Could not read from file at " + path);
+    const u32 base_slot = header.base_slot;
+    const CSTHeader base_header = ReadHeader(GetSaveStatePath(title_id, base_slot));
+    if (base_header.is_delta || base_header.time != header.base_time) {
+        throw std::runtime_error(
+            fmt::format("The base of this delta save state in slot {} was replaced", base_slot));
+    }
+
+    LoadState(base_slot);
+    Memory::MemorySystem::BeginDeltaLoad(*memory);
+    SCOPE_EXIT({ Memory::MemorySystem::EndDeltaSerialization(); });
+    ReadState(GetSaveStatePath(title_id, slot));
+}
+
+bool System::RestoreBootSnapshot() {
+    const std::string path = GetBootSnapshotPath(title_id, *kernel->GetCurrentProcess()->codeset);
+    service_request_seen = false;
+    boot_snapshot_path.clear();
+
+    if (FileUtil::Exists(path)) {
+        try {
+            // Checked first, so that an outdated snapshot is replaced without booting again
+            if (!IsCurrentRevision(ReadHeader(path))) {
+                throw std::runtime_error("created from a different revision");
+            }
+        } catch (const std::exception& e) {
+            LOG_WARNING(Core, "Replacing the boot snapshot {}: {}", path, e.what());
+            FileUtil::Delete(path);
+            boot_snapshot_path = path;
+            return true;
+        }
+
+        try {
+            ReadState(path);
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error restoring the boot snapshot {}: {}", path, e.what());
+            FileUtil::Delete(path);
+            return false;
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
+        LOG_INFO(Core, "Restored the boot snapshot {}", path);
+        return true;
     }
-    std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
-        std::ios_base::binary};
-    decompressed.clear();
 
-    // Deserialize
-    iarchive ia{sstream};
-    ia&* this;
+    boot_snapshot_path = path;
+    return true;
 }
 
-#ifdef __LIBRETRO__
-std::vector<u8> System::SaveStateBuffer() const {
-    std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
+void System::SaveBootSnapshot() {
+    std::string path = std::move(boot_snapshot_path);
+    boot_snapshot_path.clear();
+    WriteState(path, MakeHeader(title_id), [path](const std::string& error) {
+        if (error.empty()) {
+            LOG_INFO(Core, "Boot snapshot written to {}", path);
+        }
+    });
+}
 
-    const std::string& str{sstream.str()};
+void System::CaptureRewindState() {
+    {
+        VectorStreamBuffer buffer{rewind_state};
+        oarchive oa{buffer};
+        oa&* this;
+    }
+    rewind_buffer->Push(rewind_state);
+}
 
-    CSTHeader header{};
-    header.filetype = header_magic_bytes;
-    header.program_id = title_id;
-    std::string rev_bytes;
-    CryptoPP::StringSource(Common::g_scm_rev, true,
-                           new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
-    std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(header.revision));
-    header.time = std::chrono::duration_cast<std::chrono::seconds>(
-                      std::chrono::system_clock::now().time_since_epoch())
-                      .count();
+bool System::Rewind() {
+    if (Network::GetRoomMember().lock()->IsConnected()) {
+        throw std::runtime_error("Unable to rewind while connected to multiplayer");
+    }
+    if (!rewind_buffer || !rewind_buffer->Pop(rewind_state)) {
+        return false;
+    }
+
+    {
+        MemoryStreamBuffer buffer{rewind_state.data(), rewind_state.size()};
+        iarchive ia{buffer};
+        ia&* this;
+    }
+    // Rewinding again goes further back instead of to a snapshot of the restored state
+    rewind_frame = perf_stats->GetSystemFrameCount();
+    return true;
+}
 
-    auto compressed = Common::Compression::CompressDataZSTDDefault(
-        reinterpret_cast<const u8*>(str.data()), str.size());
+#ifdef __LIBRETRO__
+std::vector<u8> System::SaveStateBuffer(bool run_ahead) const {
+    CSTHeader header = MakeHeader(title_id);
+    if (run_ahead) {
+        header.is_run_ahead = 1;
+        header.dictionary_id = 0;
+
+        std::vector<u8> buffer;
+        VectorStreamBuffer stream_buffer{buffer};
+        stream_buffer.sputn(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        Memory::MemorySystem::BeginRunAheadSerialization();
+        SCOPE_EXIT({ Memory::MemorySystem::EndDeltaSerialization(); });
+        oarchive oa{stream_buffer};
+        oa&* this;
+        return buffer;
+    }
 
-    std::vector<u8> buffer((u8*)&header, (u8*)&header + sizeof(header));
-    std::copy(compressed.begin(), compressed.end(), std::back_inserter(buffer));
+    std::vector<u8> buffer(reinterpret_cast<const u8*>(&header),
+                           reinterpret_cast<const u8*>(&header) + sizeof(header));
+
+    Common::Compression::ZSTDCompressBuffer compress_buffer{
+        [&buffer](const u8* data, std::size_t size) {
+            buffer.insert(buffer.end(), data, data + size);
+        }};
+    SetCompression(compress_buffer, header, 0);
+    {
+        oarchive oa{compress_buffer};
+        oa&* this;
+    }
+    if (!compress_buffer.Finish()) {
+        throw std::runtime_error("Could not compress save state");
+    }
 
     return buffer;
 }
@@ -216,16 +625,33 @@ bool System::LoadStateBuffer(std::vector<u8> buffer) {
         return false;
     }
 
-    std::vector<u8> state(buffer.begin() + sizeof(CSTHeader), buffer.end()); 
-    auto decompressed = Common::Compression::DecompressDataZSTD(state);
+    if (header.is_run_ahead) {
+        Memory::MemorySystem::BeginRunAheadSerialization();
+        SCOPE_EXIT({ Memory::MemorySystem::EndDeltaSerialization(); });
+        MemoryStreamBuffer stream_buffer{buffer.data() + sizeof(CSTHeader),
+                                         buffer.size() - sizeof(CSTHeader)};
+        iarchive ia{stream_buffer};
+        ia&* this;
+        return true;
+    }
 
-    std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
-        std::ios_base::binary};
-    decompressed.clear();
+    std::size_t pos = sizeof(CSTHeader);
+    Common::Compression::ZSTDDecompressBuffer decompress_buffer{
+        [&buffer, &pos](u8* data, std::size_t size) {
+            size = std::min(size, buffer.size() - pos);
+            std::memcpy(data, buffer.data() + pos, size);
+            pos += size;
+            return size;
+        }};
+    try {
+        SetDictionary(decompress_buffer, header);
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "{}", e.what());
+        return false;
+    }
 
     // Deserialize
-    iarchive ia{sstream};
+    iarchive ia{decompress_buffer};
     ia&* this;
 
     return true;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include "common/common_types.h"
 
@@ -24,4 +25,13 @@ constexpr u32 SaveStateSlotCount = 10; // Maximum count of savestate slots
 
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id);
 
+/**
+ * Trains a zstd dictionary from the given save states and writes it to output_path. Save states
+ * are compressed with the dictionary once it is placed at savestates.zdict in the states
+ * directory, and cannot be loaded without it afterwards.
+ * @return false if no dictionary could be trained or written.
+ */
+bool TrainSaveStateDictionary(const std::vector<std::string>& state_paths,
+                              const std::string& output_path);
+
 } // namespace Core
@@ -2,9 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 #include "audio_core/dsp_interface.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
 #include "core/core.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/shared_page.h"
@@ -21,7 +28,54 @@ namespace Settings {
 
 Values values = {};
 
+/// Sets the scheduling of the thread roles, which their threads pick up when they start
+static void ApplyThreadPolicies() {
+    using Common::ThreadRole;
+    static constexpr std::array<std::pair<std::string_view, ThreadRole>, 7> roles{{
+        {"emulation", ThreadRole::Emulation},
+        {"gpu", ThreadRole::GpuSubmit},
+        {"dsp", ThreadRole::Dsp},
+        {"audio", ThreadRole::Audio},
+        {"present", ThreadRole::Present},
+        {"network", ThreadRole::Network},
+        {"background", ThreadRole::Background},
+    }};
+
+    std::array<Common::ThreadRolePolicy, roles.size()> policies{};
+    for (std::size_t i = 0; i < roles.size(); ++i) {
+        // Network and background threads never hold up a frame
+        const ThreadRole role = roles[i].second;
+        if (role != ThreadRole::Network && role != ThreadRole::Background) {
+            policies[i].priority = values.thread_priority;
+        }
+    }
+
+    std::vector<std::string> pairs;
+    Common::SplitString(values.thread_affinity, ',', pairs);
+    for (const auto& pair : pairs) {
+        const std::size_t separator = pair.find('=');
+        const std::string name = Common::StripSpaces(pair.substr(0, separator));
+        const auto role = std::find_if(roles.begin(), roles.end(),
+                                       [&](const auto& entry) { return entry.first == name; });
+        if (separator == std::string::npos || role == roles.end()) {
+            LOG_ERROR(Config, "Invalid thread affinity '{}'", pair);
+            continue;
+        }
+        try {
+            policies[role - roles.begin()].affinity_mask =
+                std::stoull(pair.substr(separator + 1), nullptr, 0);
+        } catch (const std::logic_error&) {
+            LOG_ERROR(Config, "Invalid thread affinity '{}'", pair);
+        }
+    }
+
+    for (std::size_t i = 0; i < roles.size(); ++i) {
+        Common::SetThreadRolePolicy(roles[i].second, policies[i]);
+    }
+}
+
 void Apply() {
+    ApplyThreadPolicies();
 
     GDBStub::SetServerPort(values.gdbstub_port);
     GDBStub::ToggleServer(values.use_gdbstub);
@@ -78,22 +132,46 @@ void LogSettings() {
     };
 
     LOG_INFO(Config, "Citra Configuration:");
+    log_setting("Controls_SyncInputToVBlank", values.sync_input_to_vblank);
     log_setting("Core_UseCpuJit", values.use_cpu_jit);
+    log_setting("Core_UseCpuTiering", values.use_cpu_tiering);
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage);
+    log_setting("Core_AdaptiveCPUClock", values.adaptive_cpu_clock);
+    log_setting("Core_CPUClockPercentageMin", values.cpu_clock_percentage_min);
+    log_setting("Core_CPUClockPercentageMax", values.cpu_clock_percentage_max);
+    log_setting("Core_EnableRewind", values.enable_rewind);
+    log_setting("Core_RewindInterval", values.rewind_interval);
+    log_setting("Core_AutoTitleProfiles", values.auto_title_profiles);
+    log_setting("Threads_Priority", static_cast<int>(values.thread_priority));
+    log_setting("Threads_Affinity", values.thread_affinity);
+    log_setting("Core_RewindBufferSize", values.rewind_buffer_size);
+    log_setting("Core_ShareCodePages", values.share_code_pages);
+    log_setting("Core_BootSnapshot", values.boot_snapshot);
+    log_setting("Core_BootSnapshotFrame", values.boot_snapshot_frame);
+    log_setting("Renderer_GraphicsAPI", static_cast<u32>(values.graphics_api));
     log_setting("Renderer_UseGLES", values.use_gles);
     log_setting("Renderer_UseHwRenderer", values.use_hw_renderer);
     log_setting("Renderer_UseHwShader", values.use_hw_shader);
     log_setting("Renderer_SeparableShader", values.separable_shader);
+    log_setting("Renderer_AsyncShaderCompilation", values.async_shader_compilation);
+    log_setting("Renderer_FragmentUbershader", values.fragment_ubershader);
+    log_setting("Renderer_UseGpuThread", values.use_gpu_thread);
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul);
     log_setting("Renderer_UseShaderJit", values.use_shader_jit);
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor);
+    log_setting("Renderer_DynamicResolution", values.dynamic_resolution);
+    log_setting("Renderer_MinResolutionFactor", values.min_resolution_factor);
+    log_setting("Renderer_SurfaceCacheBudget", values.surface_cache_budget);
+    log_setting("Renderer_GpuTextureDecoding", values.gpu_texture_decoding);
     log_setting("Renderer_FrameLimit", values.frame_limit);
     log_setting("Renderer_UseFrameLimitAlternate", values.use_frame_limit_alternate);
     log_setting("Renderer_FrameLimitAlternate", values.frame_limit_alternate);
+    log_setting("Renderer_FrameSkip", values.frame_skip);
     log_setting("Renderer_VSyncNew", values.use_vsync_new);
     log_setting("Renderer_PostProcessingShader", values.pp_shader_name);
     log_setting("Renderer_FilterMode", values.filter_mode);
     log_setting("Renderer_TextureFilterName", values.texture_filter_name);
+    log_setting("Renderer_ShowFrameCounters", values.show_frame_counters);
     log_setting("Stereoscopy_Render3d", values.render_3d);
     log_setting("Stereoscopy_Factor3d", values.factor_3d);
     log_setting("Layout_LayoutOption", values.layout_option);
@@ -104,9 +182,11 @@ void LogSettings() {
     log_setting("Utility_UseDiskShaderCache", values.use_disk_shader_cache);
     log_setting("Audio_EnableDspLle", values.enable_dsp_lle);
     log_setting("Audio_EnableDspLleMultithread", values.enable_dsp_lle_multithread);
+    log_setting("Audio_EnableDspHleMultithread", values.enable_dsp_hle_multithread);
     log_setting("Audio_OutputEngine", values.sink_id);
     log_setting("Audio_EnableAudioStretching", values.enable_audio_stretching);
     log_setting("Audio_OutputDevice", values.audio_device_id);
+    log_setting("Audio_LowLatency", values.audio_low_latency);
     log_setting("Audio_InputDeviceType", values.mic_input_type);
     log_setting("Audio_InputDevice", values.mic_input_device);
     using namespace Service::CAM;
@@ -124,10 +204,22 @@ void LogSettings() {
     log_setting("DataStorage_NandDir", values.nand_dir);
     log_setting("System_IsNew3ds", values.is_new_3ds);
     log_setting("System_RegionValue", values.region_value);
+    log_setting("System_UdsBatchWindow", values.uds_batch_window);
+    log_setting("Debugging_MeasureInputLatency", values.measure_input_latency);
+    log_setting("Debugging_IpcRecorderSampleRate", values.ipc_recorder_sample_rate);
+    log_setting("Debugging_StateHashLog", values.state_hash_log);
+    log_setting("Debugging_StateHashReference", values.state_hash_reference);
     log_setting("Debugging_UseGdbstub", values.use_gdbstub);
     log_setting("Debugging_GdbstubPort", values.gdbstub_port);
 }
 
+float Get3DSliderState() {
+    if (values.render_3d == StereoRenderOption::Off) {
+        return 0.0f;
+    }
+    return values.factor_3d / 100.0f;
+}
+
 void LoadProfile(int index) {
     Settings::values.current_input_profile = Settings::values.input_profiles[index];
     Settings::values.current_input_profile_index = index;
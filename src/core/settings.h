@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
+#include "common/thread.h"
 #include "core/hle/service/cam/cam_params.h"
 
 namespace Settings {
@@ -19,6 +20,11 @@ enum class InitClock {
     FixedTime = 1,
 };
 
+enum class GraphicsAPI {
+    OpenGL = 0,
+    Vulkan = 1,
+};
+
 enum class LayoutOption {
     Default,
     SingleScreen,
@@ -148,10 +154,31 @@ struct Values {
     int current_input_profile_index;          ///< The current input profile index
     std::vector<InputProfile> input_profiles; ///< The list of input profiles
     std::vector<TouchFromButtonMap> touch_from_button_maps;
+    bool sync_input_to_vblank; ///< Samples the pad and touch screen right before each VBlank
 
     // Core
     bool use_cpu_jit;
+    /// Runs code in the interpreter until it is hot enough to be compiled. Needs use_cpu_jit.
+    bool use_cpu_tiering;
     int cpu_clock_percentage;
+    /// Adjusts the CPU clock to the load of the guest, within the two bounds below
+    bool adaptive_cpu_clock;
+    int cpu_clock_percentage_min;
+    int cpu_clock_percentage_max;
+    bool enable_rewind;
+    u32 rewind_interval;     ///< Number of frames between rewind snapshots
+    u32 rewind_buffer_size;  ///< Memory budget of the rewind snapshots, in MiB
+    bool share_code_pages;   ///< Map read-only code from a file shared by all instances
+    bool boot_snapshot;      ///< Restore the state of applications at boot from a saved snapshot
+    u32 boot_snapshot_frame; ///< Frame to capture the boot snapshot at, 0 for the first request
+    /// Picks a performance profile for titles without one from the statistics of their first run
+    bool auto_title_profiles;
+
+    // Threads
+    /// Scheduling class of the threads that frames wait for, applied when they start
+    Common::ThreadPriority thread_priority;
+    /// Host cores of the thread roles as comma separated pairs, such as "emulation=0x3,gpu=0xc"
+    std::string thread_affinity;
 
     // Data Storage
     bool use_virtual_sd;
@@ -162,20 +189,35 @@ struct Values {
     int region_value;
     InitClock init_clock;
     u64 init_time;
+    u16 uds_batch_window; ///< Milliseconds of local wireless data frames sent together, 0 for none
 
     // Renderer
+    GraphicsAPI graphics_api;
     bool use_gles;
     bool use_hw_renderer;
     bool use_hw_shader;
     bool separable_shader;
     bool use_disk_shader_cache;
+    bool async_shader_compilation;
+    bool fragment_ubershader;
+    bool use_gpu_thread;
     bool shaders_accurate_mul;
     bool use_shader_jit;
     u16 resolution_factor;
+    /// Lowers the resolution of the render targets, down to min_resolution_factor, when the GPU
+    /// takes longer than a frame
+    bool dynamic_resolution;
+    u16 min_resolution_factor;
+    u32 surface_cache_budget;  ///< Texture memory of the surface cache in MiB, 0 for no limit
+    bool gpu_texture_decoding; ///< De-tile and decode tiled surface uploads in a compute shader
     bool use_frame_limit_alternate;
     u16 frame_limit;
     u16 frame_limit_alternate;
+    /// Frames that are emulated but neither rendered nor presented after each rendered one, while
+    /// the frame limit is above 100% or off
+    u16 frame_skip;
     std::string texture_filter_name;
+    bool show_frame_counters;
 
     LayoutOption layout_option;
     bool swap_screen;
@@ -213,9 +255,11 @@ struct Values {
     // Audio
     bool enable_dsp_lle;
     bool enable_dsp_lle_multithread;
+    bool enable_dsp_hle_multithread;
     std::string sink_id;
     bool enable_audio_stretching;
     std::string audio_device_id;
+    bool audio_low_latency;
     float volume;
     MicInputType mic_input_type;
     std::string mic_input_device;
@@ -227,6 +271,13 @@ struct Values {
 
     // Debugging
     bool record_frame_times;
+    bool measure_input_latency;
+    /// Record one in every this many IPC requests for crash reports, 0 to turn recording off
+    u32 ipc_recorder_sample_rate;
+    /// File to write the hashes of the guest state at the end of every game frame to, if not empty
+    std::string state_hash_log;
+    /// State hash log of an earlier run to compare the hashes to, if not empty
+    std::string state_hash_reference;
     bool use_gdbstub;
     u16 gdbstub_port;
     std::string log_filter;
@@ -258,6 +309,14 @@ static constexpr int REGION_VALUE_AUTO_SELECT = -1;
 void Apply();
 void LogSettings();
 
+/**
+ * Returns the 3D slider position reported to the game, from 0 to 1. It is 0 while stereo output
+ * is off, so that games render a single eye rather than a right eye that is never shown.
+ * While stereo output is on, the eyes are still drawn one after the other: the game submits them
+ * as separate command lists, so there are no draw pairs to merge into one layered draw.
+ */
+float Get3DSliderState();
+
 // Input profiles
 void LoadProfile(int index);
 void SaveProfile(int index);
@@ -0,0 +1,109 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <sstream>
+#include <fmt/format.h>
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+#include "core/state_hash_log.h"
+#include "video_core/pica_state.h"
+
+namespace Core {
+
+StateHashLog::StateHashLog(System& system, const std::string& output_path,
+                           const std::string& reference_path)
+    : system(system), file(output_path, "w") {
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Could not open the state hash log {}", output_path);
+    }
+    if (reference_path.empty()) {
+        return;
+    }
+
+    std::string contents;
+    if (FileUtil::ReadFileToString(true, reference_path, contents) == 0) {
+        LOG_ERROR(Core, "Could not read the reference state hash log {}", reference_path);
+        return;
+    }
+    std::istringstream stream(contents);
+    u64 line_frame;
+    FrameHashes hashes;
+    while (stream >> std::dec >> line_frame >> std::hex >> hashes.memory >> hashes.pica >>
+           hashes.threads) {
+        if (line_frame != reference.size()) {
+            LOG_ERROR(Core, "Reference state hash log {} skips frame {}", reference_path,
+                      reference.size());
+            break;
+        }
+        reference.push_back(hashes);
+    }
+    LOG_INFO(Core, "Comparing the state hashes to {} frames of {}", reference.size(),
+             reference_path);
+}
+
+StateHashLog::~StateHashLog() {
+    if (!reference.empty() && !first_mismatch) {
+        LOG_INFO(Core, "State matched the reference for {} frames",
+                 std::min<u64>(frame, reference.size()));
+    }
+}
+
+void StateHashLog::EndGameFrame() {
+    const FrameHashes hashes = HashState();
+    if (file.IsOpen()) {
+        file.WriteString(fmt::format("{} {:016x} {:016x} {:016x}\n", frame, hashes.memory,
+                                     hashes.pica, hashes.threads));
+    }
+
+    if (!first_mismatch && frame < reference.size()) {
+        const FrameHashes& expected = reference[frame];
+        if (hashes.memory != expected.memory || hashes.pica != expected.pica ||
+            hashes.threads != expected.threads) {
+            first_mismatch = frame;
+            LOG_ERROR(Core, "State diverges from the reference at frame {}:{}{}{}", frame,
+                      hashes.memory != expected.memory ? " memory" : "",
+                      hashes.pica != expected.pica ? " PICA" : "",
+                      hashes.threads != expected.threads ? " threads" : "");
+        }
+    }
+    frame++;
+}
+
+StateHashLog::FrameHashes StateHashLog::HashState() {
+    FrameHashes hashes;
+
+    Memory::MemorySystem& memory = system.Memory();
+    Common::FastHasher64 memory_hasher;
+    memory_hasher.Update(memory.GetFCRAMPointer(0), Memory::FCRAM_SIZE);
+    memory_hasher.Update(memory.GetPhysicalPointer(Memory::VRAM_PADDR), Memory::VRAM_SIZE);
+    hashes.memory = memory_hasher.Digest();
+
+    const auto& pica_regs = Pica::g_state.regs.reg_array;
+    hashes.pica = Common::ComputeFastHash64(pica_regs.data(), sizeof(pica_regs));
+
+    // The context of the running thread is the one saved at its last switch
+    Common::FastHasher64 thread_hasher;
+    for (u32 core_id = 0; core_id < system.GetNumCores(); core_id++) {
+        for (const auto& thread : system.Kernel().GetThreadManager(core_id).GetThreadList()) {
+            const u32 status = static_cast<u32>(thread->status);
+            thread_hasher.Update(&thread->thread_id, sizeof(thread->thread_id));
+            thread_hasher.Update(&status, sizeof(status));
+            for (std::size_t i = 0; i < 16; i++) {
+                const u32 reg = thread->context->GetCpuRegister(i);
+                thread_hasher.Update(&reg, sizeof(reg));
+            }
+            const u32 cpsr = thread->context->GetCpsr();
+            thread_hasher.Update(&cpsr, sizeof(cpsr));
+        }
+    }
+    hashes.threads = thread_hasher.Digest();
+    return hashes;
+}
+
+} // namespace Core
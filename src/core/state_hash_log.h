@@ -0,0 +1,57 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+namespace Core {
+
+class System;
+
+/**
+ * Log of hashes of the guest-visible state at the end of every game frame. Two runs that play the
+ * same movie, possibly with different builds, can be compared to find the first frame at which
+ * they diverge. Each line holds the frame number, then the hashes of the FCRAM and VRAM, of the
+ * PICA registers and of the kernel threads.
+ */
+class StateHashLog {
+public:
+    struct FrameHashes {
+        u64 memory;
+        u64 pica;
+        u64 threads;
+    };
+
+    /**
+     * @param output_path File the hashes are written to
+     * @param reference_path Log of an earlier run to compare the hashes to, or empty for none
+     */
+    StateHashLog(System& system, const std::string& output_path,
+                 const std::string& reference_path);
+    ~StateHashLog();
+
+    /// Hashes the state at the end of a game frame. Emulation thread only
+    void EndGameFrame();
+
+    /// Returns the first frame whose hashes differ from the reference, if any did so far
+    [[nodiscard]] std::optional<u64> GetFirstMismatch() const {
+        return first_mismatch;
+    }
+
+private:
+    FrameHashes HashState();
+
+    System& system;
+    FileUtil::IOFile file;
+    std::vector<FrameHashes> reference;
+    u64 frame = 0;
+    std::optional<u64> first_mismatch;
+};
+
+} // namespace Core
@@ -0,0 +1,183 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "core/settings.h"
+#include "core/title_profile.h"
+
+namespace Core {
+
+namespace {
+
+/// Periods at the start of the session, spent booting and compiling shaders, that are not counted
+constexpr u64 WarmupSamples = 10;
+
+/// Periods that have to be measured after the warmup to pick a profile
+constexpr u64 MeasuredSamples = 30;
+
+/// Emulation speed under which a title is considered to be slow
+constexpr double SlowSpeed = 0.97;
+
+std::string GetProfilePath(u64 program_id) {
+    return fmt::format("{}profiles/{:016X}.ini",
+                       FileUtil::GetUserPath(FileUtil::UserPath::ConfigDir), program_id);
+}
+
+template <typename T>
+bool ParseValue(std::string_view text, std::optional<T>& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        if (text == "true" || text == "1") {
+            value = true;
+        } else if (text == "false" || text == "0") {
+            value = false;
+        } else {
+            return false;
+        }
+        return true;
+    } else {
+        T parsed{};
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        if (result.ec != std::errc{} || result.ptr != text.data() + text.size()) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+}
+
+/// Calls `visit(name, member)` for each setting of a profile
+template <typename Profile, typename Visitor>
+void VisitSettings(Profile& profile, Visitor&& visit) {
+    visit("use_hw_shader", profile.use_hw_shader);
+    visit("shaders_accurate_mul", profile.shaders_accurate_mul);
+    visit("use_disk_shader_cache", profile.use_disk_shader_cache);
+    visit("resolution_factor", profile.resolution_factor);
+    visit("enable_dsp_lle", profile.enable_dsp_lle);
+    visit("cpu_clock_percentage", profile.cpu_clock_percentage);
+    visit("adaptive_cpu_clock", profile.adaptive_cpu_clock);
+    visit("cpu_clock_percentage_min", profile.cpu_clock_percentage_min);
+    visit("cpu_clock_percentage_max", profile.cpu_clock_percentage_max);
+}
+
+template <typename T>
+void Override(const std::optional<T>& profile_value, T& value, std::optional<T>& previous) {
+    if (profile_value) {
+        previous = value;
+        value = *profile_value;
+    }
+}
+
+} // Anonymous namespace
+
+std::optional<TitleProfile> TitleProfile::Load(u64 program_id) {
+    const std::string path = GetProfilePath(program_id);
+    std::string contents;
+    if (!FileUtil::Exists(path) || FileUtil::ReadFileToString(true, path, contents) == 0) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> lines;
+    Common::SplitString(contents, '\n', lines);
+
+    TitleProfile profile;
+    for (const std::string& line : lines) {
+        const std::string trimmed = Common::StripSpaces(line);
+        if (trimmed.empty() || trimmed[0] == '#') {
+            continue;
+        }
+        const std::size_t separator = trimmed.find('=');
+        if (separator == std::string::npos) {
+            LOG_WARNING(Core, "Invalid line in title profile {}: {}", path, trimmed);
+            continue;
+        }
+        const std::string name = Common::StripSpaces(trimmed.substr(0, separator));
+        const std::string text = Common::StripSpaces(trimmed.substr(separator + 1));
+
+        bool known = false;
+        VisitSettings(profile, [&](std::string_view setting, auto& value) {
+            if (setting == name) {
+                known = true;
+                if (!ParseValue(text, value)) {
+                    LOG_WARNING(Core, "Invalid value of {} in title profile {}", name, path);
+                }
+            }
+        });
+        if (!known) {
+            LOG_WARNING(Core, "Unknown setting {} in title profile {}", name, path);
+        }
+    }
+    return profile;
+}
+
+bool TitleProfile::Save(u64 program_id) const {
+    std::string contents;
+    VisitSettings(*this, [&contents](std::string_view name, const auto& value) {
+        if (value) {
+            contents += fmt::format("{} = {}\n", name, *value);
+        }
+    });
+
+    const std::string path = GetProfilePath(program_id);
+    return FileUtil::CreateFullPath(path) &&
+           FileUtil::WriteStringToFile(true, path, contents) == contents.size();
+}
+
+TitleProfile TitleProfile::Apply(Settings::Values& values) const {
+    TitleProfile previous;
+    Override(use_hw_shader, values.use_hw_shader, previous.use_hw_shader);
+    Override(shaders_accurate_mul, values.shaders_accurate_mul, previous.shaders_accurate_mul);
+    Override(use_disk_shader_cache, values.use_disk_shader_cache, previous.use_disk_shader_cache);
+    Override(resolution_factor, values.resolution_factor, previous.resolution_factor);
+    Override(enable_dsp_lle, values.enable_dsp_lle, previous.enable_dsp_lle);
+    Override(cpu_clock_percentage, values.cpu_clock_percentage, previous.cpu_clock_percentage);
+    Override(adaptive_cpu_clock, values.adaptive_cpu_clock, previous.adaptive_cpu_clock);
+    Override(cpu_clock_percentage_min, values.cpu_clock_percentage_min,
+             previous.cpu_clock_percentage_min);
+    Override(cpu_clock_percentage_max, values.cpu_clock_percentage_max,
+             previous.cpu_clock_percentage_max);
+    return previous;
+}
+
+void TitleProfileTuner::AddSample(const PerfStats::Results& results) {
+    if (results.emulation_speed == 0.0) {
+        return; // Nothing ran in this period, as when paused
+    }
+    samples++;
+    if (samples <= WarmupSamples) {
+        return;
+    }
+    speed_sum += results.emulation_speed;
+    cpu_time_sum += results.cpu_time_percentiles.p50;
+    gpu_time_sum += results.gpu_submit_percentiles.p50;
+}
+
+std::optional<TitleProfile> TitleProfileTuner::PickProfile(const Settings::Values& values) const {
+    if (samples < WarmupSamples + MeasuredSamples) {
+        return std::nullopt;
+    }
+    TitleProfile profile;
+    if (speed_sum / (samples - WarmupSamples) >= SlowSpeed) {
+        return profile;
+    }
+
+    if (gpu_time_sum > cpu_time_sum) {
+        if (values.use_hw_shader && values.shaders_accurate_mul) {
+            profile.shaders_accurate_mul = false;
+        } else if (values.resolution_factor > 1) {
+            profile.resolution_factor = static_cast<u16>(values.resolution_factor - 1);
+        }
+    } else if (values.use_hw_renderer && !values.use_hw_shader) {
+        profile.use_hw_shader = true;
+    }
+    return profile;
+}
+
+} // namespace Core
@@ -0,0 +1,70 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include "common/common_types.h"
+#include "core/perf_stats.h"
+
+namespace Settings {
+struct Values;
+}
+
+namespace Core {
+
+/**
+ * Settings that affect performance, overridden for a single title. A profile is stored in the
+ * config directory as profiles/<program id>.ini, with one `name = value` line for each setting
+ * that it overrides, and is applied on top of the global settings while its title runs.
+ */
+struct TitleProfile {
+    std::optional<bool> use_hw_shader;
+    std::optional<bool> shaders_accurate_mul;
+    std::optional<bool> use_disk_shader_cache;
+    std::optional<u16> resolution_factor;
+    std::optional<bool> enable_dsp_lle;
+    std::optional<int> cpu_clock_percentage;
+    std::optional<bool> adaptive_cpu_clock;
+    std::optional<int> cpu_clock_percentage_min;
+    std::optional<int> cpu_clock_percentage_max;
+
+    /// Returns the profile of a title, or nothing if it doesn't have one
+    static std::optional<TitleProfile> Load(u64 program_id);
+
+    /// Writes the profile of a title, returning false if it couldn't be written
+    bool Save(u64 program_id) const;
+
+    /**
+     * Overrides the settings that the profile sets.
+     * @return The previous values of the overridden settings, to restore them afterwards
+     */
+    TitleProfile Apply(Settings::Values& values) const;
+};
+
+/**
+ * Picks the profile of a title from the performance statistics of its first session. When the
+ * emulation runs below full speed, the most expensive setting on the side that takes longer per
+ * frame is relaxed: the GPU drops accurate shader multiplication, then a step of resolution, and
+ * the CPU moves vertex shaders to the GPU.
+ */
+class TitleProfileTuner {
+public:
+    /// Adds the statistics of a period of emulation
+    void AddSample(const PerfStats::Results& results);
+
+    /**
+     * Returns the profile to use from the next session on, given the settings of this one, or
+     * nothing if the session was too short to tell.
+     */
+    [[nodiscard]] std::optional<TitleProfile> PickProfile(const Settings::Values& values) const;
+
+private:
+    u64 samples = 0;
+    double speed_sum = 0.0;
+    double cpu_time_sum = 0.0;
+    double gpu_time_sum = 0.0;
+};
+
+} // namespace Core
@@ -0,0 +1,186 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/tracer/player.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace CiTrace {
+
+Player::Player(Memory::MemorySystem& memory) : memory(memory) {}
+
+bool Player::Load(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Could not open CiTrace {}", filename);
+        return false;
+    }
+    file_data.resize(file.GetSize());
+    if (file.ReadBytes(file_data.data(), file_data.size()) != file_data.size()) {
+        LOG_ERROR(HW_GPU, "Could not read CiTrace {}", filename);
+        return false;
+    }
+
+    if (file_data.size() < sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "{} is not a CiTrace", filename);
+        return false;
+    }
+    std::memcpy(&header, file_data.data(), sizeof(CTHeader));
+    if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), sizeof(header.magic)) != 0 ||
+        header.version != CTHeader::ExpectedVersion()) {
+        LOG_ERROR(HW_GPU, "{} is not a CiTrace of a supported version", filename);
+        return false;
+    }
+
+    const u64 stream_end =
+        u64{header.stream_offset} + u64{header.stream_size} * sizeof(CTStreamElement);
+    if (stream_end > file_data.size()) {
+        LOG_ERROR(HW_GPU, "CiTrace {} is truncated", filename);
+        return false;
+    }
+    stream.resize(header.stream_size);
+    std::memcpy(stream.data(), file_data.data() + header.stream_offset,
+                stream.size() * sizeof(CTStreamElement));
+    num_frames = std::count_if(stream.begin(), stream.end(), [](const CTStreamElement& element) {
+        return element.type == FrameMarker;
+    });
+    position = 0;
+    return true;
+}
+
+const u32* Player::GetInitialState(u32 offset, u32 size) const {
+    if (size == 0 || u64{offset} + u64{size} * sizeof(u32) > file_data.size()) {
+        return nullptr;
+    }
+    return reinterpret_cast<const u32*>(file_data.data() + offset);
+}
+
+void Player::Reset() {
+    VideoCore::GPUThread::Synchronize();
+
+    const auto& initial = header.initial_state_offsets;
+    const auto restore = [this](void* dest, std::size_t dest_size, u32 offset, u32 size) {
+        if (const u32* data = GetInitialState(offset, size)) {
+            std::memcpy(dest, data, std::min<std::size_t>(dest_size, size * sizeof(u32)));
+        }
+    };
+    // Floating point values are stored as raw float24
+    const auto restore_float24 = [this](Common::Vec4<Pica::float24>* dest, std::size_t count,
+                                        u32 offset, u32 size) {
+        if (const u32* data = GetInitialState(offset, size)) {
+            for (std::size_t i = 0; i < std::min<std::size_t>(count * 4, size); ++i) {
+                dest[i / 4][i % 4] = Pica::float24::FromRaw(data[i]);
+            }
+        }
+    };
+
+    restore(&GPU::g_regs, sizeof(GPU::g_regs), initial.gpu_registers, initial.gpu_registers_size);
+    restore(&LCD::g_regs, sizeof(LCD::g_regs), initial.lcd_registers, initial.lcd_registers_size);
+
+    auto& state = Pica::g_state;
+    restore(&state.regs, sizeof(state.regs), initial.pica_registers, initial.pica_registers_size);
+    restore_float24(state.input_default_attributes.attr, 16, initial.default_attributes,
+                    initial.default_attributes_size);
+
+    restore(state.vs.program_code.data(), sizeof(state.vs.program_code),
+            initial.vs_program_binary, initial.vs_program_binary_size);
+    restore(state.vs.swizzle_data.data(), sizeof(state.vs.swizzle_data), initial.vs_swizzle_data,
+            initial.vs_swizzle_data_size);
+    restore_float24(state.vs.uniforms.f, 96, initial.vs_float_uniforms,
+                    initial.vs_float_uniforms_size);
+    state.vs.MarkProgramCodeDirty();
+    state.vs.MarkSwizzleDataDirty();
+
+    restore(state.gs.program_code.data(), sizeof(state.gs.program_code),
+            initial.gs_program_binary, initial.gs_program_binary_size);
+    restore(state.gs.swizzle_data.data(), sizeof(state.gs.swizzle_data), initial.gs_swizzle_data,
+            initial.gs_swizzle_data_size);
+    restore_float24(state.gs.uniforms.f, 96, initial.gs_float_uniforms,
+                    initial.gs_float_uniforms_size);
+    state.gs.MarkProgramCodeDirty();
+    state.gs.MarkSwizzleDataDirty();
+
+    // The registers were replaced behind the rasterizer's back
+    VideoCore::g_renderer->Rasterizer()->SyncEntireState();
+    position = 0;
+}
+
+bool Player::PlayFrame() {
+    while (position < stream.size()) {
+        const CTStreamElement element = stream[position++];
+        switch (element.type) {
+        case FrameMarker:
+            // Present the frame as the VBlank does
+            VideoCore::GPUThread::Synchronize();
+            VideoCore::g_renderer->SwapBuffers();
+            return true;
+        case MemoryLoad:
+            LoadMemory(element.memory_load);
+            break;
+        case RegisterWrite:
+            WriteRegister(element.register_write);
+            break;
+        default:
+            LOG_WARNING(HW_GPU, "Unknown CiTrace stream element {:#x}",
+                        static_cast<u32>(element.type));
+            break;
+        }
+    }
+    return false;
+}
+
+void Player::LoadMemory(const CTMemoryLoad& load) {
+    if (load.size == 0) {
+        return;
+    }
+    if (u64{load.file_offset} + load.size > file_data.size() ||
+        !memory.IsValidPhysicalAddress(load.physical_address) ||
+        !memory.IsValidPhysicalAddress(load.physical_address + load.size - 1)) {
+        LOG_ERROR(HW_GPU, "Invalid CiTrace memory load of {:#x} bytes to {:#010x}", load.size,
+                  load.physical_address);
+        return;
+    }
+
+    // The command lists in flight and the cached surfaces may read the region
+    VideoCore::GPUThread::Synchronize();
+    VideoCore::g_renderer->Rasterizer()->InvalidateRegion(load.physical_address, load.size);
+    std::memcpy(memory.GetPhysicalPointer(load.physical_address),
+                file_data.data() + load.file_offset, load.size);
+}
+
+void Player::WriteRegister(const CTRegisterWrite& write) {
+    // Registers are recorded by their physical address
+    const u32 addr = write.physical_address - Memory::IO_AREA_PADDR + Memory::IO_AREA_VADDR;
+    switch (write.size) {
+    case CTRegisterWrite::SIZE_8:
+        HW::Write<u8>(addr, static_cast<u8>(write.value));
+        break;
+    case CTRegisterWrite::SIZE_16:
+        HW::Write<u16>(addr, static_cast<u16>(write.value));
+        break;
+    case CTRegisterWrite::SIZE_32:
+        HW::Write<u32>(addr, static_cast<u32>(write.value));
+        break;
+    case CTRegisterWrite::SIZE_64:
+        HW::Write<u64>(addr, write.value);
+        break;
+    default:
+        LOG_WARNING(HW_GPU, "Unknown CiTrace register write size {:#x}",
+                    static_cast<u32>(write.size));
+        break;
+    }
+}
+
+} // namespace CiTrace
@@ -0,0 +1,64 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/tracer/citrace.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace CiTrace {
+
+/**
+ * Replays a recorded CiTrace into the emulated GPU. Memory loads are written to the emulated
+ * memory and register writes go through the regular MMIO handlers, so the video core renders the
+ * recorded frames without any CPU emulation.
+ */
+class Player {
+public:
+    explicit Player(Memory::MemorySystem& memory);
+
+    /**
+     * Reads the trace from the given file
+     * @returns false if the file could not be read or is not a valid CiTrace
+     */
+    bool Load(const std::string& filename);
+
+    /// Restores the GPU state the recording started from and rewinds to the first frame
+    void Reset();
+
+    /**
+     * Replays the stream up to the end of the next frame, then presents that frame
+     * @returns false if the end of the stream was reached before the end of a frame
+     */
+    bool PlayFrame();
+
+    /// Returns the number of frames in the trace
+    std::size_t NumFrames() const {
+        return num_frames;
+    }
+
+private:
+    void LoadMemory(const CTMemoryLoad& load);
+    void WriteRegister(const CTRegisterWrite& write);
+
+    /// Returns the initial state array at the given file offset, or nullptr if it is out of range
+    const u32* GetInitialState(u32 offset, u32 size) const;
+
+    Memory::MemorySystem& memory;
+
+    std::vector<u8> file_data;
+    CTHeader header{};
+    std::vector<CTStreamElement> stream;
+    std::size_t num_frames = 0;
+    /// Index of the stream element replayed next
+    std::size_t position = 0;
+};
+
+} // namespace CiTrace
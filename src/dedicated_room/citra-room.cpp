@@ -2,14 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 #include <cryptopp/base64.h>
+#include <fmt/format.h>
 #include <glad/glad.h>
 
 #ifdef _WIN32
@@ -35,6 +40,7 @@
 #include "network/verify_user.h"
 
 #ifdef ENABLE_WEB_SERVICE
+#include <httplib.h>
 #include "web_service/verify_user_jwt.h"
 #endif
 
@@ -60,6 +66,14 @@ static void PrintHelp(const char* argv0) {
                  "--ban-list-file     The file for storing the room ban list\n"
                  "--log-file          The file for storing the room log\n"
                  "--enable-citra-mods Allow Citra Community Moderators to moderate on your room\n"
+                 "--metrics-port      Serve Prometheus metrics of the rooms at /metrics on this\n"
+                 "                    port\n"
+                 "--max-packet-rate   The Wi-Fi packets each member may send per second\n"
+                 "--max-byte-rate     The Wi-Fi bytes each member may send per second\n"
+                 "--rooms-file        Host every room described in the file instead of the one\n"
+                 "                    given by the room options. Each room is a [name] section\n"
+                 "                    with description, port, max_members, password,\n"
+                 "                    preferred_game, preferred_game_id and ban_list_file keys\n"
                  "-h, --help          Display this help and exit\n"
                  "-v, --version       Output version information and exit\n";
 }
@@ -152,6 +166,241 @@ static void SaveBanList(const Network::Room::BanList& ban_list, const std::strin
     file.flush();
 }
 
+/// The settings of one hosted room
+struct RoomConfig {
+    std::string name;
+    std::string description;
+    std::string password;
+    std::string preferred_game;
+    u64 preferred_game_id = 0;
+    u32 port = Network::DefaultRoomPort;
+    u32 max_members = 16;
+    std::string ban_list_file;
+};
+
+static bool LoadRoomsFile(const std::string& path, std::vector<RoomConfig>& rooms) {
+    std::ifstream file;
+    OpenFStream(file, path, std::ios_base::in);
+    if (!file) {
+        std::cout << "Could not open rooms file!\n\n";
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = Common::StripSpaces(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+        if (line.front() == '[' && line.back() == ']') {
+            rooms.emplace_back().name = Common::StripSpaces(line.substr(1, line.size() - 2));
+            continue;
+        }
+
+        const std::size_t separator = line.find('=');
+        if (rooms.empty() || separator == std::string::npos) {
+            std::cout << "Invalid line in rooms file: " << line << "\n\n";
+            return false;
+        }
+        RoomConfig& room = rooms.back();
+        const std::string key = Common::StripSpaces(line.substr(0, separator));
+        const std::string value = Common::StripSpaces(line.substr(separator + 1));
+        if (key == "description") {
+            room.description = value;
+        } else if (key == "port") {
+            room.port = static_cast<u32>(std::strtoul(value.c_str(), nullptr, 0));
+        } else if (key == "max_members") {
+            room.max_members = static_cast<u32>(std::strtoul(value.c_str(), nullptr, 0));
+        } else if (key == "password") {
+            room.password = value;
+        } else if (key == "preferred_game") {
+            room.preferred_game = value;
+        } else if (key == "preferred_game_id") {
+            room.preferred_game_id = std::strtoull(value.c_str(), nullptr, 16);
+        } else if (key == "ban_list_file") {
+            room.ban_list_file = value;
+        } else {
+            std::cout << "Unknown key in rooms file: " << key << "\n\n";
+            return false;
+        }
+    }
+
+    if (rooms.empty()) {
+        std::cout << "The rooms file does not describe any room!\n\n";
+        return false;
+    }
+    return true;
+}
+
+static bool ValidateRoomConfig(const RoomConfig& room) {
+    if (room.name.empty()) {
+        std::cout << "room name is empty!\n\n";
+        return false;
+    }
+    if (room.preferred_game.empty()) {
+        std::cout << "preferred game is empty!\n\n";
+        return false;
+    }
+    if (room.preferred_game_id == 0) {
+        std::cout << "preferred-game-id not set!\nThis should get set to allow users to find your "
+                     "room.\nSet with --preferred-game-id id\n\n";
+    }
+    if (room.max_members > Network::MaxConcurrentConnections || room.max_members < 2) {
+        std::cout << "max_members needs to be in the range 2 - "
+                  << Network::MaxConcurrentConnections << "!\n\n";
+        return false;
+    }
+    if (room.port > 65535) {
+        std::cout << "port needs to be in the range 0 - 65535!\n\n";
+        return false;
+    }
+    if (room.ban_list_file.empty()) {
+        std::cout << "Ban list file not set!\nThis should get set to load and save room ban "
+                     "list.\nSet with --ban-list-file <file>\n\n";
+    }
+    return true;
+}
+
+static const char* MessageTypeName(std::size_t type) {
+    switch (type) {
+    case Network::IdJoinRequest:
+        return "join_request";
+    case Network::IdSetGameInfo:
+        return "set_game_info";
+    case Network::IdWifiPacket:
+        return "wifi";
+    case Network::IdChatMessage:
+        return "chat";
+    case Network::IdModKick:
+        return "mod_kick";
+    case Network::IdModBan:
+        return "mod_ban";
+    case Network::IdModUnban:
+        return "mod_unban";
+    case Network::IdModGetBanList:
+        return "mod_get_ban_list";
+    case Network::IdDirectConnectRequest:
+        return "direct_connect_request";
+    case Network::IdRoomInformationRequest:
+        return "room_information_request";
+    case Network::IdRollbackInput:
+        return "rollback_input";
+    default:
+        return "other";
+    }
+}
+
+/// Escapes a label value of the Prometheus text format
+static std::string EscapeLabel(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+struct RoomStatistics {
+    std::string name;
+    u32 port;
+    Network::Room::Statistics statistics;
+};
+
+/// Formats the statistics of the rooms in the Prometheus text format
+static std::string FormatMetrics(const std::vector<RoomStatistics>& rooms) {
+    std::string out;
+    const auto family = [&out](const char* name, const char* type, const char* help) {
+        out += fmt::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+    };
+    const auto sample = [&out](const char* name, const RoomStatistics& room,
+                               const std::string& labels, auto value) {
+        out += fmt::format("{}{{room=\"{}\",port=\"{}\"{}}} {}\n", name, EscapeLabel(room.name),
+                           room.port, labels, value);
+    };
+    const auto by_type = [&](const char* name, const char* help, bool relayed, bool bytes) {
+        family(name, "counter", help);
+        for (const auto& room : rooms) {
+            const auto& counters = relayed ? room.statistics.relayed : room.statistics.received;
+            // Each name may cover several types, which are summed
+            std::map<std::string_view, u64> totals;
+            for (std::size_t type = 0; type < counters.size(); ++type) {
+                const u64 value = bytes ? counters[type].bytes : counters[type].packets;
+                if (value != 0) {
+                    totals[MessageTypeName(type)] += value;
+                }
+            }
+            for (const auto& [type_name, value] : totals) {
+                sample(name, room, fmt::format(",type=\"{}\"", type_name), value);
+            }
+        }
+    };
+    const auto by_member = [&](const char* name, const char* type, const char* help,
+                               auto value) {
+        family(name, type, help);
+        for (const auto& room : rooms) {
+            for (const auto& member : room.statistics.members) {
+                sample(name, room, fmt::format(",member=\"{}\"", EscapeLabel(member.nickname)),
+                       value(member));
+            }
+        }
+    };
+
+    family("citra_room_members", "gauge", "Members in the room");
+    for (const auto& room : rooms) {
+        sample("citra_room_members", room, "", room.statistics.members.size());
+    }
+    by_type("citra_room_received_packets_total", "Packets received from the members", false,
+            false);
+    by_type("citra_room_received_bytes_total", "Bytes received from the members", false, true);
+    by_type("citra_room_relayed_packets_total", "Packets relayed to the members", true, false);
+    by_type("citra_room_relayed_bytes_total", "Bytes relayed to the members", true, true);
+
+    family("citra_room_rate_limited_packets_total", "counter",
+           "Wi-Fi packets dropped because their sender exceeded the rate limit");
+    for (const auto& room : rooms) {
+        sample("citra_room_rate_limited_packets_total", room, "",
+               room.statistics.rate_limited.packets);
+    }
+    family("citra_room_rate_limited_bytes_total", "counter",
+           "Wi-Fi bytes dropped because their sender exceeded the rate limit");
+    for (const auto& room : rooms) {
+        sample("citra_room_rate_limited_bytes_total", room, "",
+               room.statistics.rate_limited.bytes);
+    }
+    family("citra_room_broadcasts_total", "counter", "Wi-Fi packets sent to every member");
+    for (const auto& room : rooms) {
+        sample("citra_room_broadcasts_total", room, "", room.statistics.broadcasts);
+    }
+    family("citra_room_broadcast_seconds_total", "counter",
+           "Time spent queueing broadcasts to the members");
+    for (const auto& room : rooms) {
+        sample("citra_room_broadcast_seconds_total", room, "",
+               room.statistics.broadcast_time_us / 1e6);
+    }
+
+    using Member = Network::Room::MemberStatistics;
+    by_member("citra_room_member_round_trip_seconds", "gauge",
+              "Mean round trip time of the connection to the member",
+              [](const Member& member) { return member.round_trip_time / 1e3; });
+    by_member("citra_room_member_packet_loss_ratio", "gauge",
+              "Packet loss of the connection to the member",
+              [](const Member& member) { return member.packet_loss / 65536.0; });
+    by_member("citra_room_member_reliable_bytes_in_transit", "gauge",
+              "Reliable bytes sent to the member that were not acknowledged yet",
+              [](const Member& member) { return member.reliable_data_in_transit; });
+    by_member("citra_room_member_rate_limited_packets_total", "counter",
+              "Wi-Fi packets of the member that were dropped by the rate limit",
+              [](const Member& member) { return member.rate_limited_packets; });
+    return out;
+}
+
 static void InitializeLogging(const std::string& log_file) {
     Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
 
@@ -181,11 +430,14 @@ int main(int argc, char** argv) {
     std::string token;
     std::string web_api_url;
     std::string ban_list_file;
+    std::string rooms_file;
     std::string log_file = "citra-room.log";
     u64 preferred_game_id = 0;
     u32 port = Network::DefaultRoomPort;
     u32 max_members = 16;
     bool enable_citra_mods = false;
+    u32 metrics_port = 0;
+    Network::Room::RateLimit rate_limit;
 
     static struct option long_options[] = {
         {"room-name", required_argument, 0, 'n'},
@@ -201,13 +453,18 @@ int main(int argc, char** argv) {
         {"ban-list-file", required_argument, 0, 'b'},
         {"log-file", required_argument, 0, 'l'},
         {"enable-citra-mods", no_argument, 0, 'e'},
+        {"rooms-file", required_argument, 0, 'r'},
+        {"metrics-port", required_argument, 0, 'M'},
+        {"max-packet-rate", required_argument, 0, 'P'},
+        {"max-byte-rate", required_argument, 0, 'B'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "n:d:p:m:w:g:u:t:a:i:l:hv", long_options, &option_index);
+        int arg =
+            getopt_long(argc, argv, "n:d:p:m:w:g:u:t:a:i:l:r:hv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'n':
@@ -249,6 +506,18 @@ int main(int argc, char** argv) {
             case 'e':
                 enable_citra_mods = true;
                 break;
+            case 'r':
+                rooms_file.assign(optarg);
+                break;
+            case 'M':
+                metrics_port = strtoul(optarg, &endarg, 0);
+                break;
+            case 'P':
+                rate_limit.packets_per_second = strtoul(optarg, &endarg, 0);
+                break;
+            case 'B':
+                rate_limit.bytes_per_second = strtoul(optarg, &endarg, 0);
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -259,34 +528,18 @@ int main(int argc, char** argv) {
         }
     }
 
-    if (room_name.empty()) {
-        std::cout << "room name is empty!\n\n";
-        PrintHelp(argv[0]);
-        return -1;
-    }
-    if (preferred_game.empty()) {
-        std::cout << "preferred game is empty!\n\n";
-        PrintHelp(argv[0]);
-        return -1;
-    }
-    if (preferred_game_id == 0) {
-        std::cout << "preferred-game-id not set!\nThis should get set to allow users to find your "
-                     "room.\nSet with --preferred-game-id id\n\n";
-    }
-    if (max_members > Network::MaxConcurrentConnections || max_members < 2) {
-        std::cout << "max_members needs to be in the range 2 - "
-                  << Network::MaxConcurrentConnections << "!\n\n";
-        PrintHelp(argv[0]);
+    std::vector<RoomConfig> rooms;
+    if (rooms_file.empty()) {
+        rooms.push_back({room_name, room_description, password, preferred_game, preferred_game_id,
+                         port, max_members, ban_list_file});
+    } else if (!LoadRoomsFile(rooms_file, rooms)) {
         return -1;
     }
-    if (port > 65535) {
-        std::cout << "port needs to be in the range 0 - 65535!\n\n";
-        PrintHelp(argv[0]);
-        return -1;
-    }
-    if (ban_list_file.empty()) {
-        std::cout << "Ban list file not set!\nThis should get set to load and save room ban "
-                     "list.\nSet with --ban-list-file <file>\n\n";
+    for (const auto& room : rooms) {
+        if (!ValidateRoomConfig(room)) {
+            PrintHelp(argv[0]);
+            return -1;
+        }
     }
     bool announce = true;
     if (token.empty() && announce) {
@@ -311,6 +564,11 @@ int main(int argc, char** argv) {
             Settings::values.citra_token = token;
         }
     }
+    if (metrics_port > 65535) {
+        std::cout << "metrics-port needs to be in the range 0 - 65535!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
     if (!announce && enable_citra_mods) {
         enable_citra_mods = false;
         std::cout << "Can not enable Citra Moderators for private rooms\n\n";
@@ -318,56 +576,121 @@ int main(int argc, char** argv) {
 
     InitializeLogging(log_file);
 
-    // Load the ban list
-    Network::Room::BanList ban_list;
-    if (!ban_list_file.empty()) {
-        ban_list = LoadBanList(ban_list_file);
-    }
+    // Each room runs its own ENet host on its own thread
+    struct HostedRoom {
+        const RoomConfig* config;
+        std::shared_ptr<Network::Room> room;
+        std::unique_ptr<Core::AnnounceMultiplayerSession> announce_session;
+    };
+    std::vector<HostedRoom> hosted_rooms;
+    const auto close_rooms = [&hosted_rooms, announce] {
+        for (auto& hosted : hosted_rooms) {
+            if (announce) {
+                hosted.announce_session->Stop();
+            }
+            hosted.announce_session.reset();
+            // Save the ban list
+            if (!hosted.config->ban_list_file.empty()) {
+                SaveBanList(hosted.room->GetBanList(), hosted.config->ban_list_file);
+            }
+            hosted.room->Destroy();
+        }
+        hosted_rooms.clear();
+    };
 
-    std::unique_ptr<Network::VerifyUser::Backend> verify_backend;
-    if (announce) {
+    Network::Init();
+    for (const auto& config : rooms) {
+        // Load the ban list
+        Network::Room::BanList ban_list;
+        if (!config.ban_list_file.empty()) {
+            ban_list = LoadBanList(config.ban_list_file);
+        }
+
+        std::unique_ptr<Network::VerifyUser::Backend> verify_backend;
+        if (announce) {
 #ifdef ENABLE_WEB_SERVICE
-        verify_backend = std::make_unique<WebService::VerifyUserJWT>(Settings::values.web_api_url);
+            verify_backend =
+                std::make_unique<WebService::VerifyUserJWT>(Settings::values.web_api_url);
 #else
-        std::cout
-            << "Citra Web Services is not available with this build: validation is disabled.\n\n";
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
+            std::cout << "Citra Web Services is not available with this build: validation is "
+                         "disabled.\n\n";
+            verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
 #endif
-    } else {
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
-    }
+        } else {
+            verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
+        }
 
-    Network::Init();
-    if (std::shared_ptr<Network::Room> room = Network::GetRoom().lock()) {
-        if (!room->Create(room_name, room_description, "", port, password, max_members, username,
-                          preferred_game, preferred_game_id, std::move(verify_backend), ban_list,
+        auto room = std::make_shared<Network::Room>();
+        room->SetRateLimit(rate_limit);
+        if (!room->Create(config.name, config.description, "", config.port, config.password,
+                          config.max_members, username, config.preferred_game,
+                          config.preferred_game_id, std::move(verify_backend), ban_list,
                           enable_citra_mods)) {
-            std::cout << "Failed to create room: \n\n";
+            std::cout << "Failed to create room " << config.name << ": \n\n";
+            close_rooms();
+            Network::Shutdown();
             return -1;
         }
-        std::cout << "Room is open. Close with Q+Enter...\n\n";
-        auto announce_session = std::make_unique<Core::AnnounceMultiplayerSession>();
+        auto announce_session = std::make_unique<Core::AnnounceMultiplayerSession>(room);
         if (announce) {
             announce_session->Start();
         }
-        while (room->GetState() == Network::Room::State::Open) {
-            std::string in;
-            std::cin >> in;
-            if (in.size() > 0) {
-                break;
+        hosted_rooms.push_back({&config, std::move(room), std::move(announce_session)});
+    }
+
+#ifdef ENABLE_WEB_SERVICE
+    httplib::Server metrics_server;
+    std::thread metrics_thread;
+    if (metrics_port != 0) {
+        metrics_server.Get("/metrics", [&hosted_rooms](const httplib::Request&,
+                                                       httplib::Response& response) {
+            std::vector<RoomStatistics> statistics;
+            statistics.reserve(hosted_rooms.size());
+            for (const auto& hosted : hosted_rooms) {
+                statistics.push_back(
+                    {hosted.config->name, hosted.config->port, hosted.room->GetStatistics()});
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-        if (announce) {
-            announce_session->Stop();
+            response.set_content(FormatMetrics(statistics), "text/plain; version=0.0.4");
+        });
+        if (metrics_server.bind_to_port("0.0.0.0", static_cast<int>(metrics_port))) {
+            metrics_thread = std::thread([&metrics_server] { metrics_server.listen_after_bind(); });
+            std::cout << "Serving metrics on port " << metrics_port << "\n\n";
+        } else {
+            std::cout << "Could not serve metrics on port " << metrics_port << "\n\n";
         }
-        announce_session.reset();
-        // Save the ban list
-        if (!ban_list_file.empty()) {
-            SaveBanList(room->GetBanList(), ban_list_file);
+    }
+#else
+    if (metrics_port != 0) {
+        std::cout << "Metrics are not available with this build\n\n";
+    }
+#endif
+
+    if (hosted_rooms.size() == 1) {
+        std::cout << "Room is open. Close with Q+Enter...\n\n";
+    } else {
+        std::cout << hosted_rooms.size() << " rooms are open. Close with Q+Enter...\n\n";
+    }
+    const auto any_room_open = [&hosted_rooms] {
+        return std::any_of(hosted_rooms.begin(), hosted_rooms.end(), [](const HostedRoom& hosted) {
+            return hosted.room->GetState() == Network::Room::State::Open;
+        });
+    };
+    while (any_room_open()) {
+        std::string in;
+        std::cin >> in;
+        if (in.size() > 0) {
+            break;
         }
-        room->Destroy();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+#ifdef ENABLE_WEB_SERVICE
+    // The metrics handler reads the hosted rooms, so it is stopped before they are closed
+    if (metrics_thread.joinable()) {
+        metrics_server.stop();
+        metrics_thread.join();
     }
+#endif
+    close_rooms();
     Network::Shutdown();
     detached_tasks.WaitForAllTasks();
     return 0;
@@ -12,6 +12,7 @@
 #include <unordered_map>
 #include "common/common_types.h"
 #include "common/threadsafe_queue.h"
+#include "core/frontend/input.h"
 
 struct libusb_context;
 struct libusb_device;
@@ -87,8 +88,8 @@ public:
     Common::SPSCQueue<GCPadStatus>& GetPadQueue();
     const Common::SPSCQueue<GCPadStatus>& GetPadQueue() const;
 
-    GCController& GetPadState(std::size_t port);
-    const GCController& GetPadState(std::size_t port) const;
+    /// Returns the state last read from the controller on port, without locking
+    GCController GetPadState(std::size_t port) const;
 
     /// Returns true if there is a device connected to port
     bool DeviceConnected(std::size_t port) const;
@@ -103,6 +104,8 @@ private:
     void UpdateSettings(std::size_t port);
     void UpdateStateButtons(std::size_t port, u8 b1, u8 b2);
     void UpdateStateAxes(std::size_t port, const AdapterPayload& adapter_payload);
+    /// Makes the state of a controller visible to the input devices
+    void PublishPadState(std::size_t port);
 
     void AdapterInputThread();
 
@@ -133,7 +136,9 @@ private:
     void ClearLibusbHandle();
 
     libusb_device_handle* usb_adapter_handle = nullptr;
+    /// Only accessed by the adapter threads, which publish it to pad_slots for the readers
     std::array<GCController, 4> pads;
+    std::array<Input::StateSlot<GCController>, 4> pad_slots;
     Common::SPSCQueue<GCPadStatus> pad_queue;
 
     std::thread adapter_input_thread;
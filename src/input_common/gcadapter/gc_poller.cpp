@@ -4,7 +4,6 @@
 
 #include <atomic>
 #include <list>
-#include <mutex>
 #include <utility>
 #include "common/assert.h"
 #include "common/threadsafe_queue.h"
@@ -175,7 +174,6 @@ public:
 
     float GetAxis(u32 axis) const {
         if (gcadapter->DeviceConnected(port)) {
-            std::lock_guard lock{mutex};
             const auto axis_value =
                 static_cast<float>(gcadapter->GetPadState(port).axis_values.at(axis));
             return (axis_value) / 50.0f;
@@ -214,7 +212,6 @@ private:
     const u32 axis_y;
     const float deadzone;
     const GCAdapter::Adapter* gcadapter;
-    mutable std::mutex mutex;
 };
 
 /// An analog device factory that creates analog devices from GC Adapter
@@ -52,6 +52,7 @@ public:
             if (pair.key_code == key_code)
                 pair.status.store(pressed);
         }
+        Input::NotifyStateChange();
     }
 
     void ChangeAllKeyStatus(bool pressed) {
@@ -59,6 +60,7 @@ public:
         for (KeyButtonPair& pair : list) {
             pair.status.store(pressed);
         }
+        Input::NotifyStateChange();
     }
 
 private:
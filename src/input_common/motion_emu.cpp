@@ -11,6 +11,7 @@
 #include "common/quaternion.h"
 #include "common/thread.h"
 #include "common/vector_math.h"
+#include "core/frontend/input.h"
 #include "input_common/motion_emu.h"
 
 namespace InputCommon {
@@ -58,8 +59,8 @@ public:
     }
 
     std::tuple<Common::Vec3<float>, Common::Vec3<float>> GetStatus() {
-        std::lock_guard guard{status_mutex};
-        return status;
+        const MotionState state = status.Get();
+        return std::make_tuple(state.gravity, state.angular_rate);
     }
 
 private:
@@ -78,8 +79,12 @@ private:
 
     Common::Event shutdown_event;
 
-    std::tuple<Common::Vec3<float>, Common::Vec3<float>> status;
-    std::mutex status_mutex;
+    struct MotionState {
+        Common::Vec3<float> gravity;
+        Common::Vec3<float> angular_rate;
+    };
+    /// Published by motion_emu_thread
+    Input::StateSlot<MotionState> status;
 
     // Note: always keep the thread declaration at the end so that other objects are initialized
     // before this!
@@ -116,10 +121,7 @@ private:
             angular_rate = QuaternionRotate(inv_q, angular_rate);
 
             // Update the sensor state
-            {
-                std::lock_guard guard{status_mutex};
-                status = std::make_tuple(gravity, angular_rate);
-            }
+            status.Publish({gravity, angular_rate});
         }
     }
 };
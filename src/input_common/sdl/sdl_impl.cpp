@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <functional>
@@ -128,23 +129,37 @@ public:
         : guid{std::move(guid_)}, port{port_}, sdl_joystick{joystick} {}
 
     void SetButton(int button, bool value) {
+        if (button < 0 || button >= MaxButtons) {
+            return;
+        }
         std::lock_guard lock{mutex};
         state.buttons[button] = value;
+        published_state.Publish(state);
+        Input::NotifyStateChange();
     }
 
     bool GetButton(int button) const {
-        std::lock_guard lock{mutex};
-        return state.buttons.at(button);
+        if (button < 0 || button >= MaxButtons) {
+            return false;
+        }
+        return published_state.Get().buttons[button];
     }
 
     void SetAxis(int axis, Sint16 value) {
+        if (axis < 0 || axis >= MaxAxes) {
+            return;
+        }
         std::lock_guard lock{mutex};
         state.axes[axis] = value;
+        published_state.Publish(state);
+        Input::NotifyStateChange();
     }
 
     float GetAxis(int axis) const {
-        std::lock_guard lock{mutex};
-        return state.axes.at(axis) / 32767.0f;
+        if (axis < 0 || axis >= MaxAxes) {
+            return 0.0f;
+        }
+        return published_state.Get().axes[axis] / 32767.0f;
     }
 
     std::tuple<float, float> GetAnalog(int axis_x, int axis_y) const {
@@ -165,13 +180,20 @@ public:
     }
 
     void SetHat(int hat, Uint8 direction) {
+        if (hat < 0 || hat >= MaxHats) {
+            return;
+        }
         std::lock_guard lock{mutex};
         state.hats[hat] = direction;
+        published_state.Publish(state);
+        Input::NotifyStateChange();
     }
 
     bool GetHatDirection(int hat, Uint8 direction) const {
-        std::lock_guard lock{mutex};
-        return (state.hats.at(hat) & direction) != 0;
+        if (hat < 0 || hat >= MaxHats) {
+            return false;
+        }
+        return (published_state.Get().hats[hat] & direction) != 0;
     }
 
     void SetAccel(const float x, const float y, const float z) {
@@ -179,16 +201,18 @@ public:
         state.accel.x = x;
         state.accel.y = y;
         state.accel.z = z;
+        published_state.Publish(state);
     }
     void SetGyro(const float pitch, const float yaw, const float roll) {
         std::lock_guard lock{mutex};
         state.gyro.x = pitch;
         state.gyro.y = yaw;
         state.gyro.z = roll;
+        published_state.Publish(state);
     }
     std::tuple<Common::Vec3<float>, Common::Vec3<float>> GetMotion() const {
-        std::lock_guard lock{mutex};
-        return std::make_tuple(state.accel, state.gyro);
+        const State current = published_state.Get();
+        return std::make_tuple(current.accel, current.gyro);
     }
 
     /**
@@ -218,17 +242,24 @@ public:
     }
 
 private:
+    static constexpr int MaxButtons = 64;
+    static constexpr int MaxAxes = 16;
+    static constexpr int MaxHats = 8;
+
     struct State {
-        std::unordered_map<int, bool> buttons;
-        std::unordered_map<int, Sint16> axes;
-        std::unordered_map<int, Uint8> hats;
-        Common::Vec3<float> accel;
-        Common::Vec3<float> gyro;
-    } state;
+        std::array<bool, MaxButtons> buttons{};
+        std::array<Sint16, MaxAxes> axes{};
+        std::array<Uint8, MaxHats> hats{};
+        Common::Vec3<float> accel{};
+        Common::Vec3<float> gyro{};
+    };
+    /// Only accessed by the writers, which the mutex serializes. Readers use published_state.
+    State state;
+    std::mutex mutex;
+    Input::StateSlot<State> published_state;
     std::string guid;
     int port;
     std::unique_ptr<SDL_Joystick, SDLJoystickDeleter> sdl_joystick;
-    mutable std::mutex mutex;
 };
 
 struct SDLGameControllerDeleter {
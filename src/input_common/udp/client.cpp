@@ -175,7 +175,7 @@ void Client::OnPadData(Response::PadData data) {
     {
         std::lock_guard guard(status->update_mutex);
 
-        status->motion_status = {accel, gyro};
+        status->motion_status.Publish({accel, gyro});
 
         // TODO: add a setting for "click" touch. Click touch refers to a device that differentiates
         // between a simple "tap" and a hard press that causes the touch screen to click.
@@ -196,7 +196,11 @@ void Client::OnPadData(Response::PadData data) {
                 static_cast<float>(max_y - min_y);
         }
 
-        status->touch_status = {x, y, is_active};
+        const DeviceStatus::TouchStatus previous = status->touch_status.Get();
+        status->touch_status.Publish({x, y, is_active});
+        if (previous.x != x || previous.y != y || previous.pressed != is_active) {
+            Input::NotifyStateChange();
+        }
     }
 }
 
@@ -14,6 +14,7 @@
 #include "common/common_types.h"
 #include "common/thread.h"
 #include "common/vector_math.h"
+#include "core/frontend/input.h"
 
 namespace InputCommon::CemuhookUDP {
 
@@ -29,9 +30,21 @@ struct Version;
 } // namespace Response
 
 struct DeviceStatus {
+    struct MotionStatus {
+        Common::Vec3<float> accel;
+        Common::Vec3<float> gyro;
+    };
+    struct TouchStatus {
+        float x;
+        float y;
+        bool pressed;
+    };
+    /// Published by the socket thread of the client
+    Input::StateSlot<MotionStatus> motion_status;
+    Input::StateSlot<TouchStatus> touch_status;
+
+    /// Guards the calibration
     std::mutex update_mutex;
-    std::tuple<Common::Vec3<float>, Common::Vec3<float>> motion_status;
-    std::tuple<float, float, bool> touch_status;
 
     // calibration data for scaling the device's touch area to 3ds
     struct CalibrationData {
@@ -17,8 +17,8 @@ class UDPTouchDevice final : public Input::TouchDevice {
 public:
     explicit UDPTouchDevice(std::shared_ptr<DeviceStatus> status_) : status(std::move(status_)) {}
     std::tuple<float, float, bool> GetStatus() const override {
-        std::lock_guard guard(status->update_mutex);
-        return status->touch_status;
+        const DeviceStatus::TouchStatus touch = status->touch_status.Get();
+        return {touch.x, touch.y, touch.pressed};
     }
 
 private:
@@ -29,8 +29,8 @@ class UDPMotionDevice final : public Input::MotionDevice {
 public:
     explicit UDPMotionDevice(std::shared_ptr<DeviceStatus> status_) : status(std::move(status_)) {}
     std::tuple<Common::Vec3<float>, Common::Vec3<float>> GetStatus() const override {
-        std::lock_guard guard(status->update_mutex);
-        return status->motion_status;
+        const DeviceStatus::MotionStatus motion = status->motion_status.Get();
+        return {motion.accel, motion.gyro};
     }
 
 private:
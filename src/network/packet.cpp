@@ -9,6 +9,7 @@
 #endif
 #include <cstring>
 #include <string>
+#include <utility>
 #include "network/packet.h"
 
 namespace Network {
@@ -25,6 +26,10 @@ u64 ntohll(u64 x) {
 }
 #endif
 
+Packet::Packet(std::vector<char> buffer) : data(std::move(buffer)) {
+    data.clear();
+}
+
 void Packet::Append(const void* in_data, std::size_t size_in_bytes) {
     if (in_data && (size_in_bytes > 0)) {
         std::size_t start = data.size();
@@ -58,6 +63,12 @@ std::size_t Packet::GetDataSize() const {
     return data.size();
 }
 
+std::vector<char> Packet::TakeData() {
+    std::vector<char> taken = std::move(data);
+    Clear();
+    return taken;
+}
+
 bool Packet::EndOfPacket() const {
     return read_pos >= data.size();
 }
@@ -16,6 +16,12 @@ public:
     Packet() = default;
     ~Packet() = default;
 
+    /**
+     * Creates an empty packet that writes into the given buffer, keeping its capacity
+     * @param buffer Buffer to reuse, its contents are discarded
+     */
+    explicit Packet(std::vector<char> buffer);
+
     /**
      * Append data to the end of the packet
      * @param data        Pointer to the sequence of bytes to append
@@ -55,6 +61,12 @@ public:
      */
     std::size_t GetDataSize() const;
 
+    /**
+     * Moves the data out of the packet, leaving it empty
+     * @return The buffer holding the data of the packet
+     */
+    std::vector<char> TakeData();
+
     /**
      * This function is useful to know if there is some data
      * left to be read, without actually reading it.
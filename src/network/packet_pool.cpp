@@ -0,0 +1,70 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "network/packet_pool.h"
+
+namespace Network {
+
+namespace {
+
+/// Buffers kept for reuse at most. Rooms relay many small packets, not a few large ones.
+constexpr std::size_t MaxPooledBuffers = 256;
+/// Larger buffers are freed rather than pooled
+constexpr std::size_t MaxPooledCapacity = 0x10000;
+
+struct BufferPool {
+    std::mutex mutex;
+    std::vector<std::vector<char>> buffers;
+};
+
+BufferPool& GetPool() {
+    // Never destroyed, as ENet may release packets of hosts that outlive static destruction
+    static BufferPool* pool = new BufferPool;
+    return *pool;
+}
+
+/// Called by ENet from the thread of the host that destroys the packet
+void ReleaseBuffer(ENetPacket* enet_packet) {
+    const std::unique_ptr<std::vector<char>> buffer{
+        static_cast<std::vector<char>*>(enet_packet->userData)};
+    if (buffer->capacity() > MaxPooledCapacity) {
+        return;
+    }
+    BufferPool& pool = GetPool();
+    std::lock_guard lock(pool.mutex);
+    if (pool.buffers.size() < MaxPooledBuffers) {
+        pool.buffers.push_back(std::move(*buffer));
+    }
+}
+
+} // Anonymous namespace
+
+Packet AcquirePacket() {
+    BufferPool& pool = GetPool();
+    std::lock_guard lock(pool.mutex);
+    if (pool.buffers.empty()) {
+        return Packet{};
+    }
+    Packet packet{std::move(pool.buffers.back())};
+    pool.buffers.pop_back();
+    return packet;
+}
+
+ENetPacket* CreateENetPacket(Packet&& packet, u32 flags) {
+    auto buffer = std::make_unique<std::vector<char>>(packet.TakeData());
+    ENetPacket* enet_packet = enet_packet_create(buffer->data(), buffer->size(),
+                                                 flags | ENET_PACKET_FLAG_NO_ALLOCATE);
+    if (!enet_packet) {
+        return nullptr;
+    }
+    enet_packet->userData = buffer.release();
+    enet_packet->freeCallback = ReleaseBuffer;
+    return enet_packet;
+}
+
+} // namespace Network
@@ -0,0 +1,28 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "enet/enet.h"
+#include "network/packet.h"
+
+namespace Network {
+
+/**
+ * Returns an empty packet whose buffer comes from the pool of buffers that ENet has released, so
+ * that filling it does not allocate once the traffic is steady.
+ */
+Packet AcquirePacket();
+
+/**
+ * Creates an ENet packet that takes over the buffer of `packet` instead of copying it. The buffer
+ * goes back to the pool once ENet has sent the packet to every peer it was queued for.
+ * @param packet Packet to send, left empty
+ * @param flags ENet packet flags, e.g. ENET_PACKET_FLAG_RELIABLE
+ * @return The ENet packet, or nullptr if it could not be allocated
+ */
+ENetPacket* CreateENetPacket(Packet&& packet, u32 flags);
+
+} // namespace Network
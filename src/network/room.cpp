@@ -4,23 +4,40 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iomanip>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <regex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #ifdef HAVE_LIBNX
 #include <sys/select.h>
 #endif
 #include "common/logging/log.h"
+#include "common/thread.h"
+#include "common/zstd_compression.h"
 #include "enet/enet.h"
 #include "network/packet.h"
+#include "network/packet_pool.h"
 #include "network/room.h"
 #include "network/verify_user.h"
 
 namespace Network {
 
+/// Interval at which the game changes of the members are sent, so that bursts of them are merged
+constexpr std::chrono::milliseconds MemberChangeInterval{250};
+/// Room information snapshots larger than this are compressed
+constexpr std::size_t CompressedRoomInformationSize = 1024;
+
+/// Number of RoomMessageTypes that traffic is counted for
+constexpr std::size_t NumCountedMessageTypes = IdRollbackInput + 1;
+
 class Room::RoomImpl {
 public:
     // This MAC address is used to generate a 'Nintendo' like Mac address.
@@ -37,6 +54,23 @@ public:
 
     std::string password; ///< The password required to connect to this room.
 
+    /// Sequence number of the last change to the member list. The members apply the changes in
+    /// order and ask for a snapshot of the list when they miss one.
+    u32 room_information_sequence = 0;
+    /// Members whose game changed since the last member update, only used from the server thread
+    std::vector<MacAddress> pending_member_changes;
+    std::chrono::steady_clock::time_point last_member_changes;
+
+    /// Wi-Fi traffic of a member, for the rate limit
+    struct MemberTraffic {
+        /// Packets and bytes that the member may still send, only used from the server thread
+        double packet_allowance = 0;
+        double byte_allowance = 0;
+        /// Starts at the epoch, so that the allowance of a new member is full
+        std::chrono::steady_clock::time_point last_refill{};
+        std::atomic<u64> rate_limited_packets{0};
+    };
+
     struct Member {
         std::string nickname;        ///< The nickname of the member.
         std::string console_id_hash; ///< A hash of the console ID of the member.
@@ -44,13 +78,66 @@ public:
         MacAddress mac_address;      ///< The assigned mac address of the member.
         /// Data of the user, often including authenticated forum username.
         VerifyUser::UserData user_data;
-        ENetPeer* peer; ///< The remote peer.
+        ENetPeer* peer;                  ///< The remote peer.
+        bool direct_connections = false; ///< Whether the member accepts direct connections.
+        std::shared_ptr<MemberTraffic> traffic = std::make_shared<MemberTraffic>();
     };
     using MemberList = std::vector<Member>;
     MemberList members;              ///< Information about the members of this room
     mutable std::mutex member_mutex; ///< Mutex for locking the members list
     /// This should be a std::shared_mutex as soon as C++17 is supported
 
+    struct MacAddressHash {
+        std::size_t operator()(const MacAddress& address) const {
+            u64 value = 0;
+            std::memcpy(&value, address.data(), address.size());
+            return std::hash<u64>()(value);
+        }
+    };
+
+    /**
+     * Where the Wi-Fi packets are relayed to. Each membership change publishes a new table, so
+     * that relaying only needs to take a reference to the current one instead of locking and
+     * searching the members list.
+     */
+    struct RoutingTable {
+        std::vector<ENetPeer*> peers;
+        std::unordered_map<MacAddress, ENetPeer*, MacAddressHash> peers_by_mac;
+        std::unordered_map<const ENetPeer*, std::shared_ptr<MemberTraffic>> traffic_by_peer;
+    };
+    /// Only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<const RoutingTable> routing_table = std::make_shared<RoutingTable>();
+
+    /// Publishes the routing table of the current members. member_mutex must be held.
+    void UpdateRoutingTable();
+
+    /// Counters that are written by the server thread and read by GetStatistics
+    struct TrafficCounter {
+        std::atomic<u64> packets{0};
+        std::atomic<u64> bytes{0};
+
+        void Add(u64 count, u64 size) {
+            packets.fetch_add(count, std::memory_order_relaxed);
+            bytes.fetch_add(count * size, std::memory_order_relaxed);
+        }
+
+        Room::TrafficCounter Load() const {
+            return {packets.load(std::memory_order_relaxed),
+                    bytes.load(std::memory_order_relaxed)};
+        }
+    };
+    std::array<TrafficCounter, NumCountedMessageTypes> received_traffic;
+    std::array<TrafficCounter, NumCountedMessageTypes> relayed_traffic;
+    TrafficCounter rate_limited_traffic;
+    std::atomic<u64> broadcasts{0};
+    std::atomic<u64> broadcast_time_us{0};
+
+    std::atomic<u32> packets_per_second_limit{0};
+    std::atomic<u32> bytes_per_second_limit{0};
+
+    /// Takes a packet of the given size from the allowance of a member, if it isn't exhausted
+    bool ConsumeRateLimit(MemberTraffic& traffic, std::size_t size);
+
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
     mutable std::mutex ban_list_mutex; ///< Mutex for the ban lists
@@ -99,6 +186,12 @@ public:
      */
     void HandleModGetBanListPacket(const ENetEvent* event);
 
+    /**
+     * Marks a client as accepting direct connections. The addresses of the client and of the
+     * other members that accept them are exchanged, so that they can connect to each other.
+     */
+    void HandleDirectConnectRequest(const ENetEvent* event);
+
     /**
      * Returns whether the nickname is valid, ie. isn't already taken by someone else in the room.
      */
@@ -190,6 +283,12 @@ public:
      */
     void SendModBanListResponse(ENetPeer* client);
 
+    /**
+     * Sends the address of a member, as seen by the room, to a client that will connect to it
+     * directly.
+     */
+    void SendDirectConnectEndpoint(ENetPeer* client, const Member& member);
+
     /**
      * Notifies the members that the room is closed,
      */
@@ -202,22 +301,51 @@ public:
                            const std::string& username, const std::string& ip);
 
     /**
-     * Sends the information about the room, along with the list of members
-     * to every connected client in the room.
+     * Sends a snapshot of the information about the room, along with the list of members, to a
+     * client. Snapshots larger than CompressedRoomInformationSize are compressed with zstd.
      * The packet has the structure:
      * <MessageID>ID_ROOM_INFORMATION
+     * <u32> sequence: the sequence number of the last change to the member list
+     * <u8> compressed: whether the rest of the packet is a zstd frame of the following
      * <String> room_name
      * <String> room_description
      * <u32> member_slots: The max number of clients allowed in this room
-     * <String> uid
      * <u16> port
+     * <String> preferred_game
+     * <String> host_username
      * <u32> num_members: the number of currently joined clients
-     * This is followed by the following three values for each member:
-     * <String> nickname of that member
-     * <MacAddress> mac_address of that member
-     * <String> game_name of that member
+     * This is followed by the information of each member, as written by WriteMember.
+     */
+    void SendRoomInformation(ENetPeer* client);
+
+    /// Writes the information of a member that the other members receive.
+    static void WriteMember(Packet& packet, const Member& member);
+
+    struct MemberUpdate {
+        MemberUpdateTypes type;
+        MacAddress mac_address;
+    };
+
+    /**
+     * Sends changes of the member list, with the next sequence number, to every member but
+     * `excluded`. Members that were added or changed are sent as they are now.
+     * The packet has the structure:
+     * <MessageID>ID_ROOM_MEMBER_UPDATE
+     * <u32> sequence
+     * <u32> num_updates
+     * This is followed by, for each update:
+     * <u8> type
+     * <MacAddress> mac_address
+     * The information of the member, unless it was removed
      */
-    void BroadcastRoomInformation();
+    void BroadcastMemberUpdates(const std::vector<MemberUpdate>& updates,
+                                ENetPeer* excluded = nullptr);
+
+    /// Sends the game changes of the last MemberChangeInterval, if any
+    void FlushMemberChanges();
+
+    /// Answers the request of a member that missed an update for a snapshot of the member list
+    void HandleRoomInformationRequest(const ENetEvent* event);
 
     /**
      * Generates a free MAC address to assign to a new client.
@@ -237,6 +365,13 @@ public:
      */
     void HandleChatPacket(const ENetEvent* event);
 
+    /**
+     * Broadcasts the input of a rollback session to all members except the sender, stamped with
+     * the MAC address of the sender.
+     * @param event The ENet event that was received.
+     */
+    void HandleRollbackInputPacket(const ENetEvent* event);
+
     /**
      * Extracts the game name from a received ENet packet and broadcasts it.
      * @param event The ENet event that was received.
@@ -251,12 +386,53 @@ public:
 };
 
 // RoomImpl
+void Room::RoomImpl::UpdateRoutingTable() {
+    auto table = std::make_shared<RoutingTable>();
+    table->peers.reserve(members.size());
+    for (const auto& member : members) {
+        table->peers.push_back(member.peer);
+        table->peers_by_mac.emplace(member.mac_address, member.peer);
+        table->traffic_by_peer.emplace(member.peer, member.traffic);
+    }
+    std::atomic_store(&routing_table, std::shared_ptr<const RoutingTable>(std::move(table)));
+}
+
+bool Room::RoomImpl::ConsumeRateLimit(MemberTraffic& traffic, std::size_t size) {
+    const u32 max_packets = packets_per_second_limit.load(std::memory_order_relaxed);
+    const u32 max_bytes = bytes_per_second_limit.load(std::memory_order_relaxed);
+    if (max_packets == 0 && max_bytes == 0) {
+        return true;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - traffic.last_refill).count();
+    traffic.last_refill = now;
+    traffic.packet_allowance =
+        std::min<double>(max_packets, traffic.packet_allowance + elapsed * max_packets);
+    traffic.byte_allowance =
+        std::min<double>(max_bytes, traffic.byte_allowance + elapsed * max_bytes);
+
+    // Packets larger than the byte limit still pass once the allowance is full
+    const double packet_size = std::min<double>(static_cast<double>(size), max_bytes);
+    if ((max_packets != 0 && traffic.packet_allowance < 1) ||
+        (max_bytes != 0 && traffic.byte_allowance < packet_size)) {
+        return false;
+    }
+    traffic.packet_allowance -= 1;
+    traffic.byte_allowance -= packet_size;
+    return true;
+}
+
 void Room::RoomImpl::ServerLoop() {
+    Common::SetCurrentThreadRole(Common::ThreadRole::Network);
     while (state != State::Closed) {
         ENetEvent event;
         if (enet_host_service(server, &event, 16) > 0) {
             switch (event.type) {
             case ENET_EVENT_TYPE_RECEIVE:
+                if (event.packet->data[0] < NumCountedMessageTypes) {
+                    received_traffic[event.packet->data[0]].Add(1, event.packet->dataLength);
+                }
                 switch (event.packet->data[0]) {
                 case IdJoinRequest:
                     HandleJoinRequest(&event);
@@ -270,6 +446,9 @@ void Room::RoomImpl::ServerLoop() {
                 case IdChatMessage:
                     HandleChatPacket(&event);
                     break;
+                case IdRollbackInput:
+                    HandleRollbackInputPacket(&event);
+                    break;
                 // Moderation
                 case IdModKick:
                     HandleModKickPacket(&event);
@@ -283,8 +462,17 @@ void Room::RoomImpl::ServerLoop() {
                 case IdModGetBanList:
                     HandleModGetBanListPacket(&event);
                     break;
+                case IdDirectConnectRequest:
+                    HandleDirectConnectRequest(&event);
+                    break;
+                case IdRoomInformationRequest:
+                    HandleRoomInformationRequest(&event);
+                    break;
+                }
+                // Relayed packets are freed by ENet once they have been sent
+                if (event.packet->referenceCount == 0) {
+                    enet_packet_destroy(event.packet);
                 }
-                enet_packet_destroy(event.packet);
                 break;
             case ENET_EVENT_TYPE_DISCONNECT:
                 HandleClientDisconnection(event.peer);
@@ -294,9 +482,11 @@ void Room::RoomImpl::ServerLoop() {
                 break;
             }
         }
+        FlushMemberChanges();
     }
     // Close the connection to all members:
     SendCloseMessage();
+    Common::ClearCurrentThreadRole();
 }
 
 void Room::RoomImpl::StartLoop() {
@@ -404,13 +594,16 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     // Notify everyone that the user has joined.
     SendStatusMessage(IdMemberJoin, member.nickname, member.user_data.username, ip);
 
+    const MacAddress mac_address = member.mac_address;
     {
         std::lock_guard lock(member_mutex);
         members.push_back(std::move(member));
+        UpdateRoutingTable();
     }
 
-    // Notify everyone that the room information has changed.
-    BroadcastRoomInformation();
+    // Notify everyone that the room information has changed. The new member gets all of it.
+    BroadcastMemberUpdates({{IdMemberAdded, mac_address}}, event->peer);
+    SendRoomInformation(event->peer);
     if (HasModPermission(event->peer)) {
         SendJoinSuccessAsMod(event->peer, preferred_mac);
     } else {
@@ -432,6 +625,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
     packet >> nickname;
 
     std::string username, ip;
+    MacAddress mac_address;
     {
         std::lock_guard lock(member_mutex);
         const auto target_member =
@@ -446,6 +640,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         SendUserKicked(target_member->peer);
 
         username = target_member->user_data.username;
+        mac_address = target_member->mac_address;
 
         char ip_raw[256];
         enet_address_get_host_ip(&target_member->peer->address, ip_raw, sizeof(ip_raw) - 1);
@@ -453,11 +648,12 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
 
         enet_peer_disconnect(target_member->peer, 0);
         members.erase(target_member);
+        UpdateRoutingTable();
     }
 
     // Announce the change to all clients.
     SendStatusMessage(IdMemberKicked, nickname, username, ip);
-    BroadcastRoomInformation();
+    BroadcastMemberUpdates({{IdMemberRemoved, mac_address}});
 }
 
 void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
@@ -474,6 +670,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
     packet >> nickname;
 
     std::string username, ip;
+    MacAddress mac_address;
     {
         std::lock_guard lock(member_mutex);
         const auto target_member =
@@ -489,6 +686,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
 
         nickname = target_member->nickname;
         username = target_member->user_data.username;
+        mac_address = target_member->mac_address;
 
         char ip_raw[256];
         enet_address_get_host_ip(&target_member->peer->address, ip_raw, sizeof(ip_raw) - 1);
@@ -496,6 +694,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
 
         enet_peer_disconnect(target_member->peer, 0);
         members.erase(target_member);
+        UpdateRoutingTable();
     }
 
     {
@@ -518,7 +717,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
 
     // Announce the change to all clients.
     SendStatusMessage(IdMemberBanned, nickname, username, ip);
-    BroadcastRoomInformation();
+    BroadcastMemberUpdates({{IdMemberRemoved, mac_address}});
 }
 
 void Room::RoomImpl::HandleModUnbanPacket(const ENetEvent* event) {
@@ -567,6 +766,25 @@ void Room::RoomImpl::HandleModGetBanListPacket(const ENetEvent* event) {
     SendModBanListResponse(event->peer);
 }
 
+void Room::RoomImpl::HandleDirectConnectRequest(const ENetEvent* event) {
+    std::lock_guard lock(member_mutex);
+    const auto requester =
+        std::find_if(members.begin(), members.end(),
+                     [event](const Member& member) { return member.peer == event->peer; });
+    if (requester == members.end() || requester->direct_connections) {
+        return;
+    }
+    requester->direct_connections = true;
+
+    for (const auto& member : members) {
+        if (member.direct_connections && member.peer != requester->peer) {
+            SendDirectConnectEndpoint(requester->peer, member);
+            SendDirectConnectEndpoint(member.peer, *requester);
+        }
+    }
+    enet_host_flush(server);
+}
+
 bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
     // A nickname is valid if it matches the regex and is not already taken by anybody else in the
     // room.
@@ -619,8 +837,7 @@ void Room::RoomImpl::SendNameCollision(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdNameCollision);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -629,8 +846,7 @@ void Room::RoomImpl::SendMacCollision(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdMacCollision);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -639,8 +855,7 @@ void Room::RoomImpl::SendConsoleIdCollision(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdConsoleIdCollision);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -649,8 +864,7 @@ void Room::RoomImpl::SendWrongPassword(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdWrongPassword);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -659,8 +873,7 @@ void Room::RoomImpl::SendRoomIsFull(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdRoomIsFull);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -670,8 +883,7 @@ void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
     packet << static_cast<u8>(IdVersionMismatch);
     packet << network_version;
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -680,8 +892,7 @@ void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccess);
     packet << mac_address;
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -690,8 +901,7 @@ void Room::RoomImpl::SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_addre
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccessAsMod);
     packet << mac_address;
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -700,8 +910,7 @@ void Room::RoomImpl::SendUserKicked(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdHostKicked);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -710,8 +919,7 @@ void Room::RoomImpl::SendUserBanned(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdHostBanned);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -720,8 +928,7 @@ void Room::RoomImpl::SendModPermissionDenied(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdModPermissionDenied);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -730,8 +937,7 @@ void Room::RoomImpl::SendModNoSuchUser(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdModNoSuchUser);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
@@ -745,19 +951,28 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
         packet << ip_ban_list;
     }
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
 
+void Room::RoomImpl::SendDirectConnectEndpoint(ENetPeer* client, const Member& member) {
+    Packet packet;
+    packet << static_cast<u8>(IdDirectConnectEndpoint);
+    packet << member.mac_address;
+    packet << member.peer->address.host;
+    packet << member.peer->address.port;
+
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(client, 0, enet_packet);
+}
+
 void Room::RoomImpl::SendCloseMessage() {
     Packet packet;
     packet << static_cast<u8>(IdCloseRoom);
     std::lock_guard lock(member_mutex);
     if (!members.empty()) {
-        ENetPacket* enet_packet =
-            enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+        ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
         for (auto& member : members) {
             enet_peer_send(member.peer, 0, enet_packet);
         }
@@ -777,8 +992,7 @@ void Room::RoomImpl::SendStatusMessage(StatusMessageTypes type, const std::strin
     packet << username;
     std::lock_guard lock(member_mutex);
     if (!members.empty()) {
-        ENetPacket* enet_packet =
-            enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+        ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
         for (auto& member : members) {
             enet_peer_send(member.peer, 0, enet_packet);
         }
@@ -807,36 +1021,112 @@ void Room::RoomImpl::SendStatusMessage(StatusMessageTypes type, const std::strin
     }
 }
 
-void Room::RoomImpl::BroadcastRoomInformation() {
-    Packet packet;
-    packet << static_cast<u8>(IdRoomInformation);
-    packet << room_information.name;
-    packet << room_information.description;
-    packet << room_information.member_slots;
-    packet << room_information.port;
-    packet << room_information.preferred_game;
-    packet << room_information.host_username;
-
-    packet << static_cast<u32>(members.size());
+void Room::RoomImpl::WriteMember(Packet& packet, const Member& member) {
+    packet << member.nickname;
+    packet << member.mac_address;
+    packet << member.game_info.name;
+    packet << member.game_info.id;
+    packet << member.user_data.username;
+    packet << member.user_data.display_name;
+    packet << member.user_data.avatar_url;
+}
+
+void Room::RoomImpl::SendRoomInformation(ENetPeer* client) {
+    Packet body;
+    body << room_information.name;
+    body << room_information.description;
+    body << room_information.member_slots;
+    body << room_information.port;
+    body << room_information.preferred_game;
+    body << room_information.host_username;
     {
         std::lock_guard lock(member_mutex);
+        body << static_cast<u32>(members.size());
         for (const auto& member : members) {
-            packet << member.nickname;
-            packet << member.mac_address;
-            packet << member.game_info.name;
-            packet << member.game_info.id;
-            packet << member.user_data.username;
-            packet << member.user_data.display_name;
-            packet << member.user_data.avatar_url;
+            WriteMember(body, member);
         }
     }
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
-    enet_host_broadcast(server, 0, enet_packet);
+    Packet packet;
+    packet << static_cast<u8>(IdRoomInformation);
+    packet << room_information_sequence;
+    const bool compressed = body.GetDataSize() > CompressedRoomInformationSize;
+    packet << compressed;
+    if (compressed) {
+        const std::vector<u8> frame = Common::Compression::CompressDataZSTDDefault(
+            static_cast<const u8*>(body.GetData()), body.GetDataSize());
+        packet.Append(frame.data(), frame.size());
+    } else {
+        packet.Append(body.GetData(), body.GetDataSize());
+    }
+
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(client, 0, enet_packet);
     enet_host_flush(server);
 }
 
+void Room::RoomImpl::BroadcastMemberUpdates(const std::vector<MemberUpdate>& updates,
+                                            ENetPeer* excluded) {
+    Packet packet = AcquirePacket();
+    packet << static_cast<u8>(IdRoomMemberUpdate);
+    packet << ++room_information_sequence;
+    packet << static_cast<u32>(updates.size());
+
+    std::lock_guard lock(member_mutex);
+    for (const auto& update : updates) {
+        const auto member = std::find_if(
+            members.begin(), members.end(),
+            [&update](const Member& member) { return member.mac_address == update.mac_address; });
+        // A member that left since it changed is removed by an update of its own
+        const bool removed = update.type == IdMemberRemoved || member == members.end();
+        packet << static_cast<u8>(removed ? IdMemberRemoved : update.type);
+        packet << update.mac_address;
+        if (!removed) {
+            WriteMember(packet, *member);
+        }
+    }
+
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
+    bool sent_packet = false;
+    for (const auto& member : members) {
+        if (member.peer != excluded) {
+            sent_packet = true;
+            enet_peer_send(member.peer, 0, enet_packet);
+        }
+    }
+    if (!sent_packet) {
+        enet_packet_destroy(enet_packet);
+    }
+    enet_host_flush(server);
+}
+
+void Room::RoomImpl::FlushMemberChanges() {
+    const auto now = std::chrono::steady_clock::now();
+    if (pending_member_changes.empty() || now - last_member_changes < MemberChangeInterval) {
+        return;
+    }
+    last_member_changes = now;
+
+    std::vector<MemberUpdate> updates;
+    updates.reserve(pending_member_changes.size());
+    for (const auto& mac_address : pending_member_changes) {
+        updates.push_back({IdMemberChanged, mac_address});
+    }
+    pending_member_changes.clear();
+    BroadcastMemberUpdates(updates);
+}
+
+void Room::RoomImpl::HandleRoomInformationRequest(const ENetEvent* event) {
+    {
+        std::lock_guard lock(member_mutex);
+        if (std::none_of(members.begin(), members.end(),
+                         [event](const Member& member) { return member.peer == event->peer; })) {
+            return;
+        }
+    }
+    SendRoomInformation(event->peer);
+}
+
 MacAddress Room::RoomImpl::GenerateMacAddress() {
     MacAddress result_mac =
         NintendoOUI; // The first three bytes of each MAC address will be the NintendoOUI
@@ -850,53 +1140,101 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // The received packet is relayed as is, so only its destination is parsed
+    constexpr std::size_t destination_offset = 3 * sizeof(u8) + sizeof(MacAddress);
+    ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < destination_offset + sizeof(MacAddress)) {
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
-
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    std::memcpy(destination_address.data(), enet_packet->data + destination_offset,
+                sizeof(MacAddress));
+
+    const auto table = std::atomic_load(&routing_table);
+    const auto sender = table->traffic_by_peer.find(event->peer);
+    if (sender != table->traffic_by_peer.end() &&
+        !ConsumeRateLimit(*sender->second, enet_packet->dataLength)) {
+        sender->second->rate_limited_packets.fetch_add(1, std::memory_order_relaxed);
+        rate_limited_traffic.Add(1, enet_packet->dataLength);
+        return;
+    }
 
+    TrafficCounter& relayed = relayed_traffic[IdWifiPacket];
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
-        for (const auto& member : members) {
-            if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
+        const auto start = std::chrono::steady_clock::now();
+        u64 sent = 0;
+        for (ENetPeer* peer : table->peers) {
+            if (peer != event->peer) {
+                enet_peer_send(peer, 0, enet_packet);
+                ++sent;
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
+        const auto time = std::chrono::steady_clock::now() - start;
+        relayed.Add(sent, enet_packet->dataLength);
+        broadcasts.fetch_add(1, std::memory_order_relaxed);
+        broadcast_time_us.fetch_add(
+            std::chrono::duration_cast<std::chrono::microseconds>(time).count(),
+            std::memory_order_relaxed);
     } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
+        const auto peer = table->peers_by_mac.find(destination_address);
+        if (peer != table->peers_by_mac.end()) {
+            enet_peer_send(peer->second, 0, enet_packet);
+            relayed.Add(1, enet_packet->dataLength);
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
     enet_host_flush(server);
 }
 
+void Room::RoomImpl::HandleRollbackInputPacket(const ENetEvent* event) {
+    Packet in_packet;
+    in_packet.Append(event->packet->data, event->packet->dataLength);
+
+    in_packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
+    u64 frame;
+    std::vector<u8> input;
+    in_packet >> frame;
+    in_packet >> input;
+    if (!in_packet) {
+        return;
+    }
+
+    std::lock_guard lock(member_mutex);
+    const auto sending_member =
+        std::find_if(members.begin(), members.end(),
+                     [event](const Member& member) { return member.peer == event->peer; });
+    if (sending_member == members.end()) {
+        return; // Received an input from a unknown sender
+    }
+
+    Packet out_packet = AcquirePacket();
+    out_packet << static_cast<u8>(IdRollbackInput);
+    out_packet << sending_member->mac_address;
+    out_packet << frame;
+    out_packet << input;
+
+    ENetPacket* enet_packet = CreateENetPacket(std::move(out_packet), ENET_PACKET_FLAG_RELIABLE);
+    bool sent_packet = false;
+    for (const auto& member : members) {
+        if (member.peer != event->peer) {
+            sent_packet = true;
+            relayed_traffic[IdRollbackInput].Add(1, enet_packet->dataLength);
+            enet_peer_send(member.peer, 0, enet_packet);
+        }
+    }
+
+    if (!sent_packet) {
+        enet_packet_destroy(enet_packet);
+    }
+
+    enet_host_flush(server);
+}
+
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
     Packet in_packet;
     in_packet.Append(event->packet->data, event->packet->dataLength);
@@ -917,18 +1255,18 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
     // Limit the size of chat messages to MaxMessageSize
     message.resize(std::min(static_cast<u32>(message.size()), MaxMessageSize));
 
-    Packet out_packet;
+    Packet out_packet = AcquirePacket();
     out_packet << static_cast<u8>(IdChatMessage);
     out_packet << sending_member->nickname;
     out_packet << sending_member->user_data.username;
     out_packet << message;
 
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(out_packet), ENET_PACKET_FLAG_RELIABLE);
     bool sent_packet = false;
     for (const auto& member : members) {
         if (member.peer != event->peer) {
             sent_packet = true;
+            relayed_traffic[IdChatMessage].Add(1, enet_packet->dataLength);
             enet_peer_send(member.peer, 0, enet_packet);
         }
     }
@@ -964,6 +1302,10 @@ void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
             });
         if (member != members.end()) {
             member->game_info = game_info;
+            if (std::find(pending_member_changes.begin(), pending_member_changes.end(),
+                          member->mac_address) == pending_member_changes.end()) {
+                pending_member_changes.push_back(member->mac_address);
+            }
 
             const std::string display_name =
                 member->user_data.username.empty()
@@ -977,12 +1319,13 @@ void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
             }
         }
     }
-    BroadcastRoomInformation();
+    FlushMemberChanges();
 }
 
 void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
     // Remove the client from the members list.
     std::string nickname, username, ip;
+    std::optional<MacAddress> mac_address;
     {
         std::lock_guard lock(member_mutex);
         auto member = std::find_if(members.begin(), members.end(), [client](const Member& member) {
@@ -991,12 +1334,14 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
         if (member != members.end()) {
             nickname = member->nickname;
             username = member->user_data.username;
+            mac_address = member->mac_address;
 
             char ip_raw[256];
             enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
             ip = ip_raw;
 
             members.erase(member);
+            UpdateRoutingTable();
         }
     }
 
@@ -1004,7 +1349,9 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
     enet_peer_disconnect(client, 0);
     if (!nickname.empty())
         SendStatusMessage(IdMemberLeave, nickname, username, ip);
-    BroadcastRoomInformation();
+    if (mac_address) {
+        BroadcastMemberUpdates({{IdMemberRemoved, *mac_address}});
+    }
 }
 
 // Room
@@ -1084,6 +1431,36 @@ std::vector<Room::Member> Room::GetRoomMemberList() const {
     return member_list;
 }
 
+Room::Statistics Room::GetStatistics() const {
+    Statistics statistics{};
+    for (std::size_t i = 0; i < NumCountedMessageTypes; ++i) {
+        statistics.received[i] = room_impl->received_traffic[i].Load();
+        statistics.relayed[i] = room_impl->relayed_traffic[i].Load();
+    }
+    statistics.rate_limited = room_impl->rate_limited_traffic.Load();
+    statistics.broadcasts = room_impl->broadcasts.load(std::memory_order_relaxed);
+    statistics.broadcast_time_us = room_impl->broadcast_time_us.load(std::memory_order_relaxed);
+
+    std::lock_guard lock(room_impl->member_mutex);
+    for (const auto& member : room_impl->members) {
+        // The peer statistics are updated by the server thread, but a stale value is good enough
+        statistics.members.push_back({
+            member.nickname,
+            member.mac_address,
+            member.peer->roundTripTime,
+            member.peer->packetLoss,
+            member.peer->reliableDataInTransit,
+            member.traffic->rate_limited_packets.load(std::memory_order_relaxed),
+        });
+    }
+    return statistics;
+}
+
+void Room::SetRateLimit(const RateLimit& limit) {
+    room_impl->packets_per_second_limit = limit.packets_per_second;
+    room_impl->bytes_per_second_limit = limit.bytes_per_second;
+}
+
 bool Room::HasPassword() const {
     return !room_impl->password.empty();
 }
@@ -1098,15 +1475,17 @@ void Room::Destroy() {
     room_impl->room_thread->join();
     room_impl->room_thread.reset();
 
+    // The members are cleared first, as GetStatistics reads their peers
+    {
+        std::lock_guard lock(room_impl->member_mutex);
+        room_impl->members.clear();
+        room_impl->UpdateRoutingTable();
+    }
     if (room_impl->server) {
         enet_host_destroy(room_impl->server);
     }
     room_impl->room_information = {};
     room_impl->server = nullptr;
-    {
-        std::lock_guard lock(room_impl->member_mutex);
-        room_impl->members.clear();
-    }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
 }
@@ -13,7 +13,7 @@
 
 namespace Network {
 
-constexpr u32 network_version = 4; ///< The version of this Room and RoomMember
+constexpr u32 network_version = 5; ///< The version of this Room and RoomMember
 
 constexpr u16 DefaultRoomPort = 24872;
 
@@ -76,6 +76,21 @@ enum RoomMessageTypes : u8 {
     IdModPermissionDenied,
     IdModNoSuchUser,
     IdJoinSuccessAsMod,
+    // Direct connections between members
+    IdDirectConnectRequest,
+    IdDirectConnectEndpoint,
+    // Updates of the member list
+    IdRoomMemberUpdate,
+    IdRoomInformationRequest,
+    // Input of a frame, exchanged by the members of a rollback session
+    IdRollbackInput,
+};
+
+/// Types of the changes to the member list sent in an IdRoomMemberUpdate
+enum MemberUpdateTypes : u8 {
+    IdMemberAdded,   ///< A member joined the room
+    IdMemberChanged, ///< A member changed its game
+    IdMemberRemoved, ///< A member left the room
 };
 
 /// Types of system status messages
@@ -104,6 +119,40 @@ public:
         MacAddress mac_address;   ///< The assigned mac address of the member.
     };
 
+    /// Packets and bytes of one kind of traffic
+    struct TrafficCounter {
+        u64 packets = 0;
+        u64 bytes = 0;
+    };
+
+    struct MemberStatistics {
+        std::string nickname;
+        MacAddress mac_address;
+        u32 round_trip_time;          ///< Mean round trip time measured by ENet, in ms
+        u32 packet_loss;              ///< Lost packets measured by ENet, out of 65536
+        u32 reliable_data_in_transit; ///< Reliable bytes that were sent but not acknowledged yet
+        u64 rate_limited_packets;     ///< Wi-Fi packets of the member that were dropped
+    };
+
+    /// Counters of the traffic since the room was created
+    struct Statistics {
+        /// Received packets, indexed by RoomMessageTypes
+        std::array<TrafficCounter, IdRollbackInput + 1> received;
+        /// Packets relayed to members, counting each destination, indexed by RoomMessageTypes
+        std::array<TrafficCounter, IdRollbackInput + 1> relayed;
+        /// Wi-Fi packets that were dropped because their sender exceeded the rate limit
+        TrafficCounter rate_limited;
+        u64 broadcasts;        ///< Wi-Fi packets that were sent to every member
+        u64 broadcast_time_us; ///< Total time spent queueing broadcasts to the members
+        std::vector<MemberStatistics> members;
+    };
+
+    /// Limits the Wi-Fi traffic of each member. A limit of 0 means unlimited.
+    struct RateLimit {
+        u32 packets_per_second = 0;
+        u32 bytes_per_second = 0;
+    };
+
     Room();
     ~Room();
 
@@ -160,6 +209,19 @@ public:
      */
     BanList GetBanList() const;
 
+    /**
+     * Gets the traffic counters of the room and the connection statistics of its members. Can be
+     * called from any thread.
+     */
+    Statistics GetStatistics() const;
+
+    /**
+     * Sets how much Wi-Fi traffic each member may send. Packets over the limit are dropped instead
+     * of being relayed, so that a member flooding the room doesn't slow down everyone else. A
+     * member may burst up to one second worth of traffic.
+     */
+    void SetRateLimit(const RateLimit& limit);
+
     /**
      * Destroys the socket
      */
@@ -4,22 +4,42 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <list>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <thread>
 #ifdef HAVE_LIBNX
 #include <sys/select.h>
 #endif
 #include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "common/zstd_compression.h"
 #include "enet/enet.h"
 #include "network/packet.h"
+#include "network/packet_pool.h"
 #include "network/room_member.h"
 
 namespace Network {
 
 constexpr u32 ConnectionTimeoutMs = 5000;
 
+/// Most members of a room that we connect to directly
+constexpr std::size_t MaxDirectLinks = 31;
+/// Time after which a direct connection that was not made is given up, and the room relays
+constexpr std::chrono::milliseconds DirectConnectTimeout{10000};
+/// Interval of the datagrams that open our NAT to a member that connects to us
+constexpr std::chrono::milliseconds HolePunchInterval{500};
+
+static std::string MacToString(const MacAddress& mac) {
+    return fmt::format("{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}", mac[0], mac[1], mac[2], mac[3],
+                       mac[4], mac[5]);
+}
+
 class RoomMember::RoomMemberImpl {
 public:
     ENetHost* client = nullptr; ///< ENet network interface.
@@ -29,6 +49,10 @@ public:
     MemberList member_information;
     /// Information about the room we're connected to.
     RoomInformation room_information;
+    /// Sequence number of the last member list change we applied, none before the first snapshot
+    std::optional<u32> room_information_sequence;
+    /// Whether we asked the room for a snapshot after missing a change
+    bool room_information_requested = false;
 
     /// The current game name, id and version
     GameInfo current_game_info;
@@ -48,8 +72,29 @@ public:
     std::mutex network_mutex; ///< Mutex that controls access to the `client` variable.
     /// Thread that receives and dispatches network packets
     std::unique_ptr<std::thread> loop_thread;
-    std::mutex send_list_mutex;  ///< Mutex that controls access to the `send_list` variable.
-    std::list<Packet> send_list; ///< A list that stores all packets to send the async
+
+    struct OutgoingPacket {
+        Packet packet;
+        /// Member that the packet goes to directly if we are connected to it, otherwise the room
+        std::optional<MacAddress> direct_destination;
+    };
+    std::mutex send_list_mutex; ///< Mutex that controls access to the `send_list` variable.
+    std::list<OutgoingPacket> send_list; ///< A list that stores all packets to send the async
+
+    /// Whether to connect directly to the members of the rooms we join that allow it
+    std::atomic<bool> direct_connections_enabled{false};
+
+    /// Connection to another member of the room that WiFi packets to it take instead of the room.
+    /// The member with the lower MAC address connects, while the other one opens its NAT to it.
+    struct DirectLink {
+        ENetAddress address;      ///< Address of the member, as seen by the room.
+        ENetPeer* peer = nullptr; ///< Peer of the connection, once it has been made.
+        bool connected = false;
+        std::chrono::steady_clock::time_point start_time;
+        std::chrono::steady_clock::time_point last_hole_punch;
+    };
+    /// Direct links by the MAC address of the member, only used from the loop thread
+    std::map<MacAddress, DirectLink> direct_links;
 
     template <typename T>
     using CallbackSet = std::set<CallbackHandle<T>>;
@@ -68,6 +113,7 @@ public:
         CallbackSet<State> callback_set_state;
         CallbackSet<Error> callback_set_error;
         CallbackSet<Room::BanList> callback_set_ban_list;
+        CallbackSet<RollbackInput> callback_set_rollback_input;
     };
     Callbacks callbacks; ///< All CallbackSets to all events
 
@@ -81,6 +127,12 @@ public:
      */
     void Send(Packet&& packet);
 
+    /**
+     * Sends a WiFi packet directly to its destination if we are connected to it, otherwise to the
+     * room.
+     */
+    void SendWifi(Packet&& packet, const MacAddress& destination);
+
     /**
      * Sends a request to the server, asking for permission to join a room with the specified
      * nickname and preferred mac.
@@ -105,6 +157,13 @@ public:
      */
     void HandleRoomInformationPacket(const ENetEvent* event);
 
+    /**
+     * Applies the changes to the member list in a received ENet packet, or asks the room for a
+     * snapshot if we missed some.
+     * @param event The ENet event that was received.
+     */
+    void HandleRoomMemberUpdatePacket(const ENetEvent* event);
+
     /**
      * Extracts a WifiPacket from a received ENet packet.
      * @param event The  ENet event that was received.
@@ -117,6 +176,12 @@ public:
      */
     void HandleChatPacket(const ENetEvent* event);
 
+    /**
+     * Extracts the input of another member of a rollback session from a received ENet packet.
+     * @param event The ENet event that was received.
+     */
+    void HandleRollbackInputPacket(const ENetEvent* event);
+
     /**
      * Extracts a system message entry from a received ENet packet and adds it to the system message
      * queue.
@@ -130,6 +195,30 @@ public:
      */
     void HandleModBanListResponsePacket(const ENetEvent* event);
 
+    /**
+     * Starts connecting directly to the member whose address the room sent.
+     * @param event The ENet event that was received.
+     */
+    void HandleDirectConnectEndpointPacket(const ENetEvent* event);
+
+    /// Handles the packets received from members we are connected to directly.
+    void HandleDirectPacket(const ENetEvent* event);
+
+    /// Handles a new connection, which may only come from a member we expect to connect to us.
+    void HandleDirectConnect(ENetPeer* peer);
+
+    /// Forgets the direct link to a member that disconnected from us.
+    void HandleDirectDisconnect(ENetPeer* peer);
+
+    /**
+     * Opens our NAT to the members that connect to us, gives up the links that were not made in
+     * time and closes those to the members that left the room.
+     */
+    void UpdateDirectLinks();
+
+    /// Closes all the direct links.
+    void CloseDirectLinks();
+
     /**
      * Disconnects the RoomMember from the Room
      */
@@ -159,6 +248,7 @@ bool RoomMember::RoomMemberImpl::IsConnected() const {
 }
 
 void RoomMember::RoomMemberImpl::MemberLoop() {
+    Common::SetCurrentThreadRole(Common::ThreadRole::Network);
     // Receive packets while the connection is open
     while (IsConnected()) {
         std::lock_guard lock(network_mutex);
@@ -166,6 +256,11 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
         if (enet_host_service(client, &event, 16) > 0) {
             switch (event.type) {
             case ENET_EVENT_TYPE_RECEIVE:
+                if (event.peer != server) {
+                    HandleDirectPacket(&event);
+                    enet_packet_destroy(event.packet);
+                    break;
+                }
                 switch (event.packet->data[0]) {
                 case IdWifiPacket:
                     HandleWifiPackets(&event);
@@ -173,12 +268,18 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
                 case IdChatMessage:
                     HandleChatPacket(&event);
                     break;
+                case IdRollbackInput:
+                    HandleRollbackInputPacket(&event);
+                    break;
                 case IdStatusMessage:
                     HandleStatusMessagePacket(&event);
                     break;
                 case IdRoomInformation:
                     HandleRoomInformationPacket(&event);
                     break;
+                case IdRoomMemberUpdate:
+                    HandleRoomMemberUpdatePacket(&event);
+                    break;
                 case IdJoinSuccess:
                 case IdJoinSuccessAsMod:
                     // The join request was successful, we are now in the room.
@@ -191,6 +292,14 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
                     } else {
                         SetState(State::Joined);
                     }
+                    if (direct_connections_enabled) {
+                        Packet packet;
+                        packet << static_cast<u8>(IdDirectConnectRequest);
+                        Send(std::move(packet));
+                    }
+                    break;
+                case IdDirectConnectEndpoint:
+                    HandleDirectConnectEndpointPacket(&event);
                     break;
                 case IdModBanListResponse:
                     HandleModBanListResponsePacket(&event);
@@ -241,7 +350,9 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
                 enet_packet_destroy(event.packet);
                 break;
             case ENET_EVENT_TYPE_DISCONNECT:
-                if (state == State::Joined || state == State::Moderator) {
+                if (event.peer != server) {
+                    HandleDirectDisconnect(event.peer);
+                } else if (state == State::Joined || state == State::Moderator) {
                     SetState(State::Idle);
                     SetError(Error::LostConnection);
                 }
@@ -249,26 +360,34 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
             case ENET_EVENT_TYPE_NONE:
                 break;
             case ENET_EVENT_TYPE_CONNECT:
-                // The ENET_EVENT_TYPE_CONNECT event can not possibly happen here because we're
-                // already connected
-                ASSERT_MSG(false, "Received unexpected connect event while already connected");
+                // We are already connected to the room, so this is another member
+                HandleDirectConnect(event.peer);
                 break;
             }
         }
+        UpdateDirectLinks();
 
-        std::list<Packet> packets;
+        std::list<OutgoingPacket> packets;
         {
             std::lock_guard lock(send_list_mutex);
             packets.swap(send_list);
         }
-        for (const auto& packet : packets) {
-            ENetPacket* enetPacket = enet_packet_create(packet.GetData(), packet.GetDataSize(),
-                                                        ENET_PACKET_FLAG_RELIABLE);
-            enet_peer_send(server, 0, enetPacket);
+        for (auto& outgoing : packets) {
+            ENetPeer* peer = server;
+            if (outgoing.direct_destination) {
+                const auto link = direct_links.find(*outgoing.direct_destination);
+                if (link != direct_links.end() && link->second.connected) {
+                    peer = link->second.peer;
+                }
+            }
+            ENetPacket* enetPacket =
+                CreateENetPacket(std::move(outgoing.packet), ENET_PACKET_FLAG_RELIABLE);
+            enet_peer_send(peer, 0, enetPacket);
         }
         enet_host_flush(client);
     }
     Disconnect();
+    Common::ClearCurrentThreadRole();
 };
 
 void RoomMember::RoomMemberImpl::StartLoop() {
@@ -277,7 +396,17 @@ void RoomMember::RoomMemberImpl::StartLoop() {
 
 void RoomMember::RoomMemberImpl::Send(Packet&& packet) {
     std::lock_guard lock(send_list_mutex);
-    send_list.push_back(std::move(packet));
+    send_list.push_back({std::move(packet), std::nullopt});
+}
+
+void RoomMember::RoomMemberImpl::SendWifi(Packet&& packet, const MacAddress& destination) {
+    std::lock_guard lock(send_list_mutex);
+    // Broadcasts go through the room, which sends them to everyone at once
+    if (destination == BroadcastMac) {
+        send_list.push_back({std::move(packet), std::nullopt});
+    } else {
+        send_list.push_back({std::move(packet), destination});
+    }
 }
 
 void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
@@ -296,12 +425,41 @@ void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
     Send(std::move(packet));
 }
 
+static void ReadMember(Packet& packet, RoomMember::MemberInformation& member) {
+    packet >> member.nickname;
+    packet >> member.mac_address;
+    packet >> member.game_info.name;
+    packet >> member.game_info.id;
+    packet >> member.username;
+    packet >> member.display_name;
+    packet >> member.avatar_url;
+}
+
 void RoomMember::RoomMemberImpl::HandleRoomInformationPacket(const ENetEvent* event) {
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet header;
+    header.Append(event->packet->data, event->packet->dataLength);
 
     // Ignore the first byte, which is the message id.
-    packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
+    header.IgnoreBytes(sizeof(u8)); // Ignore the message type
+
+    u32 sequence;
+    bool compressed;
+    header >> sequence;
+    header >> compressed;
+    if (!header) {
+        return;
+    }
+
+    constexpr std::size_t body_offset = sizeof(u8) + sizeof(u32) + sizeof(u8);
+    const u8* body_data = event->packet->data + body_offset;
+    const std::size_t body_size = event->packet->dataLength - body_offset;
+    Packet packet;
+    if (compressed) {
+        const std::vector<u8> body = Common::Compression::DecompressDataZSTD(body_data, body_size);
+        packet.Append(body.data(), body.size());
+    } else {
+        packet.Append(body_data, body_size);
+    }
 
     RoomInformation info{};
     packet >> info.name;
@@ -322,13 +480,7 @@ void RoomMember::RoomMemberImpl::HandleRoomInformationPacket(const ENetEvent* ev
     member_information.resize(num_members);
 
     for (auto& member : member_information) {
-        packet >> member.nickname;
-        packet >> member.mac_address;
-        packet >> member.game_info.name;
-        packet >> member.game_info.id;
-        packet >> member.username;
-        packet >> member.display_name;
-        packet >> member.avatar_url;
+        ReadMember(packet, member);
 
         {
             std::lock_guard lock(username_mutex);
@@ -337,6 +489,57 @@ void RoomMember::RoomMemberImpl::HandleRoomInformationPacket(const ENetEvent* ev
             }
         }
     }
+    room_information_sequence = sequence;
+    room_information_requested = false;
+    Invoke(room_information);
+}
+
+void RoomMember::RoomMemberImpl::HandleRoomMemberUpdatePacket(const ENetEvent* event) {
+    Packet packet;
+    packet.Append(event->packet->data, event->packet->dataLength);
+
+    // Ignore the first byte, which is the message id.
+    packet.IgnoreBytes(sizeof(u8));
+
+    u32 sequence;
+    packet >> sequence;
+    if (!room_information_sequence || sequence != *room_information_sequence + 1) {
+        // Until a snapshot arrives, the changes can not be applied
+        if (room_information_sequence && !room_information_requested) {
+            room_information_requested = true;
+            Packet request;
+            request << static_cast<u8>(IdRoomInformationRequest);
+            Send(std::move(request));
+        }
+        return;
+    }
+
+    u32 num_updates;
+    packet >> num_updates;
+    for (u32 i = 0; i < num_updates && packet; ++i) {
+        u8 type;
+        MacAddress mac;
+        packet >> type;
+        packet >> mac;
+        const auto member = std::find_if(
+            member_information.begin(), member_information.end(),
+            [&mac](const MemberInformation& member) { return member.mac_address == mac; });
+        if (type == IdMemberRemoved) {
+            if (member != member_information.end()) {
+                member_information.erase(member);
+            }
+            continue;
+        }
+
+        MemberInformation information;
+        ReadMember(packet, information);
+        if (member != member_information.end()) {
+            *member = std::move(information);
+        } else {
+            member_information.push_back(std::move(information));
+        }
+    }
+    room_information_sequence = sequence;
     Invoke(room_information);
 }
 
@@ -373,6 +576,20 @@ void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
     Invoke<WifiPacket>(wifi_packet);
 }
 
+void RoomMember::RoomMemberImpl::HandleRollbackInputPacket(const ENetEvent* event) {
+    Packet packet;
+    packet.Append(event->packet->data, event->packet->dataLength);
+
+    // Ignore the first byte, which is the message id.
+    packet.IgnoreBytes(sizeof(u8));
+
+    RollbackInput rollback_input{};
+    packet >> rollback_input.source_address;
+    packet >> rollback_input.frame;
+    packet >> rollback_input.data;
+    Invoke<RollbackInput>(rollback_input);
+}
+
 void RoomMember::RoomMemberImpl::HandleChatPacket(const ENetEvent* event) {
     Packet packet;
     packet.Append(event->packet->data, event->packet->dataLength);
@@ -417,8 +634,144 @@ void RoomMember::RoomMemberImpl::HandleModBanListResponsePacket(const ENetEvent*
     Invoke<Room::BanList>(ban_list);
 }
 
+void RoomMember::RoomMemberImpl::HandleDirectConnectEndpointPacket(const ENetEvent* event) {
+    Packet packet;
+    packet.Append(event->packet->data, event->packet->dataLength);
+
+    // Ignore the first byte, which is the message id.
+    packet.IgnoreBytes(sizeof(u8));
+
+    MacAddress member_mac;
+    ENetAddress address{};
+    packet >> member_mac;
+    packet >> address.host;
+    packet >> address.port;
+    if (!packet || member_mac == mac_address || direct_links.count(member_mac) != 0 ||
+        direct_links.size() >= MaxDirectLinks) {
+        return;
+    }
+
+    DirectLink link;
+    link.address = address;
+    link.start_time = std::chrono::steady_clock::now();
+    if (mac_address < member_mac) {
+        // ENet resends the connection request until the other member has opened its NAT to us
+        link.peer = enet_host_connect(client, &address, NumChannels, 0);
+        if (!link.peer) {
+            return;
+        }
+    }
+    direct_links.emplace(member_mac, link);
+    LOG_INFO(Network, "Connecting directly to {}", MacToString(member_mac));
+}
+
+void RoomMember::RoomMemberImpl::HandleDirectPacket(const ENetEvent* event) {
+    const auto link =
+        std::find_if(direct_links.begin(), direct_links.end(),
+                     [event](const auto& link) { return link.second.peer == event->peer; });
+    if (link == direct_links.end() || !link->second.connected) {
+        return;
+    }
+
+    // Members may only send us their own WiFi packets
+    constexpr std::size_t transmitter_offset = 3 * sizeof(u8);
+    const ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < transmitter_offset + sizeof(MacAddress) ||
+        enet_packet->data[0] != IdWifiPacket ||
+        std::memcmp(enet_packet->data + transmitter_offset, link->first.data(),
+                    sizeof(MacAddress)) != 0) {
+        return;
+    }
+    HandleWifiPackets(event);
+}
+
+void RoomMember::RoomMemberImpl::HandleDirectConnect(ENetPeer* peer) {
+    // Either one of our connection requests was accepted, or a member we expect connected to us.
+    // The latter is matched by its address, or only by its host if its NAT changed the port.
+    auto link = std::find_if(direct_links.begin(), direct_links.end(),
+                             [peer](const auto& link) { return link.second.peer == peer; });
+    if (link == direct_links.end()) {
+        link = std::find_if(direct_links.begin(), direct_links.end(), [peer](const auto& link) {
+            return !link.second.peer && link.second.address.host == peer->address.host &&
+                   link.second.address.port == peer->address.port;
+        });
+    }
+    if (link == direct_links.end()) {
+        link = std::find_if(direct_links.begin(), direct_links.end(), [peer](const auto& link) {
+            return !link.second.peer && link.second.address.host == peer->address.host;
+        });
+    }
+    if (link == direct_links.end()) {
+        enet_peer_disconnect_now(peer, 0);
+        return;
+    }
+
+    link->second.peer = peer;
+    link->second.connected = true;
+    LOG_INFO(Network, "Connected directly to {}", MacToString(link->first));
+}
+
+void RoomMember::RoomMemberImpl::HandleDirectDisconnect(ENetPeer* peer) {
+    const auto link = std::find_if(direct_links.begin(), direct_links.end(),
+                                   [peer](const auto& link) { return link.second.peer == peer; });
+    if (link == direct_links.end()) {
+        return;
+    }
+    LOG_INFO(Network, "Lost the direct connection to {}, relaying through the room",
+             MacToString(link->first));
+    direct_links.erase(link);
+}
+
+void RoomMember::RoomMemberImpl::UpdateDirectLinks() {
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = direct_links.begin(); it != direct_links.end();) {
+        const MacAddress& member_mac = it->first;
+        DirectLink& link = it->second;
+        const bool in_room =
+            std::any_of(member_information.begin(), member_information.end(),
+                        [&member_mac](const auto& member) {
+                            return member.mac_address == member_mac;
+                        });
+        const bool timed_out = !link.connected && now - link.start_time > DirectConnectTimeout;
+        if (!in_room || timed_out) {
+            if (timed_out) {
+                LOG_INFO(Network, "Could not connect directly to {}, relaying through the room",
+                         MacToString(member_mac));
+            }
+            if (link.peer) {
+                enet_peer_disconnect_now(link.peer, 0);
+            }
+            it = direct_links.erase(it);
+            continue;
+        }
+
+        if (!link.peer && now - link.last_hole_punch >= HolePunchInterval) {
+            // Any datagram opens our NAT, and ENet discards those that it cannot parse
+            u8 hole_punch = 0;
+            ENetBuffer buffer;
+            buffer.data = &hole_punch;
+            buffer.dataLength = sizeof(hole_punch);
+            enet_socket_send(client->socket, &link.address, &buffer, 1);
+            link.last_hole_punch = now;
+        }
+        ++it;
+    }
+}
+
+void RoomMember::RoomMemberImpl::CloseDirectLinks() {
+    for (auto& link : direct_links) {
+        if (link.second.peer) {
+            enet_peer_disconnect_now(link.second.peer, 0);
+        }
+    }
+    direct_links.clear();
+}
+
 void RoomMember::RoomMemberImpl::Disconnect() {
+    CloseDirectLinks();
     member_information.clear();
+    room_information_sequence.reset();
+    room_information_requested = false;
     room_information.member_slots = 0;
     room_information.name.clear();
 
@@ -433,10 +786,15 @@ void RoomMember::RoomMemberImpl::Disconnect() {
             enet_packet_destroy(event.packet); // Ignore all incoming data
             break;
         case ENET_EVENT_TYPE_DISCONNECT:
+            if (event.peer != server) {
+                break;
+            }
             server = nullptr;
             return;
-        case ENET_EVENT_TYPE_NONE:
         case ENET_EVENT_TYPE_CONNECT:
+            enet_peer_disconnect_now(event.peer, 0);
+            break;
+        case ENET_EVENT_TYPE_NONE:
             break;
         }
     }
@@ -485,6 +843,12 @@ RoomMember::RoomMemberImpl::Callbacks::Get() {
     return callback_set_ban_list;
 }
 
+template <>
+RoomMember::RoomMemberImpl::CallbackSet<RollbackInput>&
+RoomMember::RoomMemberImpl::Callbacks::Get() {
+    return callback_set_rollback_input;
+}
+
 template <typename T>
 void RoomMember::RoomMemberImpl::Invoke(const T& data) {
     std::lock_guard lock(callback_mutex);
@@ -553,7 +917,13 @@ void RoomMember::Join(const std::string& nick, const std::string& console_id_has
     }
 
     if (!room_member_impl->client) {
-        room_member_impl->client = enet_host_create(nullptr, 1, NumChannels, 0, 0);
+        // Bound to a port, so that the members we connect to directly reach us through the same
+        // socket, and thus the same NAT mapping, as the room
+        ENetAddress client_address{};
+        client_address.host = ENET_HOST_ANY;
+        client_address.port = client_port;
+        room_member_impl->client =
+            enet_host_create(&client_address, 1 + MaxDirectLinks, NumChannels, 0, 0);
         ASSERT_MSG(room_member_impl->client != nullptr, "Could not create client");
     }
 
@@ -590,14 +960,14 @@ bool RoomMember::IsConnected() const {
 }
 
 void RoomMember::SendWifiPacket(const WifiPacket& wifi_packet) {
-    Packet packet;
+    Packet packet = AcquirePacket();
     packet << static_cast<u8>(IdWifiPacket);
     packet << static_cast<u8>(wifi_packet.type);
     packet << wifi_packet.channel;
     packet << wifi_packet.transmitter_address;
     packet << wifi_packet.destination_address;
     packet << wifi_packet.data;
-    room_member_impl->Send(std::move(packet));
+    room_member_impl->SendWifi(std::move(packet), wifi_packet.destination_address);
 }
 
 void RoomMember::SendChatMessage(const std::string& message) {
@@ -607,6 +977,14 @@ void RoomMember::SendChatMessage(const std::string& message) {
     room_member_impl->Send(std::move(packet));
 }
 
+void RoomMember::SendRollbackInput(u64 frame, const std::vector<u8>& data) {
+    Packet packet = AcquirePacket();
+    packet << static_cast<u8>(IdRollbackInput);
+    packet << frame;
+    packet << data;
+    room_member_impl->Send(std::move(packet));
+}
+
 void RoomMember::SendGameInfo(const GameInfo& game_info) {
     room_member_impl->current_game_info = game_info;
     if (!IsConnected())
@@ -631,6 +1009,10 @@ void RoomMember::SendModerationRequest(RoomMessageTypes type, const std::string&
     room_member_impl->Send(std::move(packet));
 }
 
+void RoomMember::SetDirectConnectionsEnabled(bool enabled) {
+    room_member_impl->direct_connections_enabled = enabled;
+}
+
 void RoomMember::RequestBanList() {
     if (!IsConnected())
         return;
@@ -675,6 +1057,11 @@ RoomMember::CallbackHandle<Room::BanList> RoomMember::BindOnBanListReceived(
     return room_member_impl->Bind(callback);
 }
 
+RoomMember::CallbackHandle<RollbackInput> RoomMember::BindOnRollbackInputReceived(
+    std::function<void(const RollbackInput&)> callback) {
+    return room_member_impl->Bind(callback);
+}
+
 template <typename T>
 void RoomMember::Unbind(CallbackHandle<T> handle) {
     std::lock_guard lock(room_member_impl->callback_mutex);
@@ -697,5 +1084,6 @@ template void RoomMember::Unbind(CallbackHandle<RoomInformation>);
 template void RoomMember::Unbind(CallbackHandle<ChatEntry>);
 template void RoomMember::Unbind(CallbackHandle<StatusMessageEntry>);
 template void RoomMember::Unbind(CallbackHandle<Room::BanList>);
+template void RoomMember::Unbind(CallbackHandle<RollbackInput>);
 
 } // namespace Network
@@ -23,7 +23,9 @@ struct WifiPacket {
         Authentication,
         AssociationResponse,
         Deauthentication,
-        NodeMap
+        NodeMap,
+        DataBatch,    ///< Several data frames to the same destination, sent together.
+        BeaconRepeat, ///< Hash of the last full beacon of the transmitter, which did not change.
     };
     PacketType type;      ///< The type of 802.11 frame.
     std::vector<u8> data; ///< Raw 802.11 frame data, starting at the management frame header
@@ -52,6 +54,13 @@ struct ChatEntry {
     std::string message; ///< Body of the message.
 };
 
+/// Input of one frame of a rollback session.
+struct RollbackInput {
+    MacAddress source_address; ///< Mac address of the member whose input this is.
+    u64 frame;                 ///< Frame the input was sampled for.
+    std::vector<u8> data;      ///< Input state, as serialized by the frontend.
+};
+
 /// Represents a system status message.
 struct StatusMessageEntry {
     StatusMessageTypes type; ///< Type of the message
@@ -167,7 +176,15 @@ public:
               const std::string& password = "", const std::string& token = "");
 
     /**
-     * Sends a WiFi packet to the room.
+     * Sets whether to connect directly to the members of the rooms joined from now on that allow
+     * it too, so that WiFi packets to them do not go through the room. Our address is shared with
+     * those members. Packets go through the room until a connection is made, and again if it is
+     * lost or cannot be made.
+     */
+    void SetDirectConnectionsEnabled(bool enabled);
+
+    /**
+     * Sends a WiFi packet to the room, or directly to its destination if we are connected to it.
      * @param packet The WiFi packet to send.
      */
     void SendWifiPacket(const WifiPacket& packet);
@@ -178,6 +195,13 @@ public:
      */
     void SendChatMessage(const std::string& message);
 
+    /**
+     * Sends the input of a frame to the other members of the room, for a rollback session.
+     * @param frame The frame the input was sampled for.
+     * @param data The input state.
+     */
+    void SendRollbackInput(u64 frame, const std::vector<u8>& data);
+
     /**
      * Sends the current game info to the room.
      * @param game_info The game information.
@@ -265,6 +289,16 @@ public:
     CallbackHandle<Room::BanList> BindOnBanListReceived(
         std::function<void(const Room::BanList&)> callback);
 
+    /**
+     * Binds a function to an event that will be triggered every time the input of another member
+     * of a rollback session is received. The callback function must not bind or unbind a
+     * function. Doing so will cause a deadlock
+     * @param callback The function to call
+     * @return A handle used for removing the function from the registered list
+     */
+    CallbackHandle<RollbackInput> BindOnRollbackInputReceived(
+        std::function<void(const RollbackInput&)> callback);
+
     /**
      * Leaves the current room.
      */
@@ -0,0 +1,76 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "audio_core/codec.h"
+#include "audio_core/interpolate.h"
+#include "tests/benchmark.h"
+
+using namespace AudioCore;
+
+TEST_CASE("Codec benchmark", "[.][benchmark][audio_core]") {
+    // ADPCM frames are 8 bytes long and hold 14 samples
+    constexpr std::size_t sample_count = 14 * 1024;
+
+    std::mt19937 rng(0xADC4);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<u8> adpcm(sample_count / 14 * 8);
+    for (u8& value : adpcm) {
+        value = static_cast<u8>(byte(rng));
+    }
+    std::vector<u8> pcm16(sample_count * 2 * sizeof(s16));
+    for (u8& value : pcm16) {
+        value = static_cast<u8>(byte(rng));
+    }
+    const std::array<s16, 16> coeffs{0x0800, -0x0400, 0x0C00, -0x0600, 0x0400, 0x0000,
+                                     0x0A00, -0x0200, 0x0600, -0x0100, 0x0E00, -0x0700,
+                                     0x0200, 0x0100,  0x0900, -0x0500};
+
+    StereoBuffer16 buffer;
+    Benchmark::Run("DecodeADPCM 14336 samples", 2000, [&] {
+        Codec::ADPCMState state{};
+        Codec::DecodeADPCM(adpcm.data(), sample_count, coeffs, state, buffer);
+        return buffer[sample_count - 1][0];
+    });
+    Benchmark::Run("DecodePCM16 stereo 14336 samples", 2000, [&] {
+        Codec::DecodePCM16(2, pcm16.data(), sample_count, buffer);
+        return buffer[sample_count - 1][0];
+    });
+}
+
+TEST_CASE("AudioInterp benchmark", "[.][benchmark][audio_core]") {
+    std::mt19937 rng(0x1A7E);
+    std::uniform_int_distribution<int> sample(-32768, 32767);
+    // Enough input for a whole frame at every rate
+    std::array<StereoBuffer16::Sample, samples_per_frame * 2 + 4> samples;
+    for (auto& value : samples) {
+        value = {static_cast<s16>(sample(rng)), static_cast<s16>(sample(rng))};
+    }
+
+    for (const float rate : {0.5f, 1.0f, 1.7f}) {
+        for (const bool linear : {false, true}) {
+            AudioInterp::State state;
+            StereoBuffer16 input;
+            StereoFrame16 output;
+            const auto fill_frame = [&] {
+                StereoBuffer16::Sample* data = input.Reset(samples.size());
+                std::copy(samples.begin(), samples.end(), data);
+                std::size_t outputi = 0;
+                if (linear) {
+                    AudioInterp::Linear(state, input, rate, output, outputi);
+                } else {
+                    AudioInterp::None(state, input, rate, output, outputi);
+                }
+                return output[outputi - 1][0] + outputi;
+            };
+            Benchmark::Run(fmt::format("AudioInterp {} rate {}", linear ? "Linear" : "None", rate),
+                           20000, fill_frame);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+#include "audio_core/time_stretch.h"
+#include "core/memory.h"
+
+// Counts the allocations made by the whole test binary, so the benchmark can report how many
+// happen per audio frame.
+namespace {
+std::atomic<u64> num_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    ++num_allocations;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace AudioCore;
+using namespace AudioCore::HLE;
+
+// Not run by default, as it only measures. Run with `tests "[benchmark]"`.
+TEST_CASE("DSP HLE sources benchmark", "[.][benchmark][audio_core][hle]") {
+    constexpr u32 buffer_length = 0x10000; // In samples
+    constexpr int num_frames = 20000;
+
+    Memory::MemorySystem memory;
+
+    // Stereo PCM16 noise, looped by every source
+    std::mt19937 rng(0xBE4C);
+    std::uniform_int_distribution<int> sample(-32768, 32767);
+    u8* const fcram = memory.GetFCRAMPointer(0);
+    for (u32 i = 0; i < buffer_length * 2; i++) {
+        const s16 value = static_cast<s16>(sample(rng));
+        std::memcpy(fcram + i * sizeof(s16), &value, sizeof(s16));
+    }
+
+    std::array<Source, num_sources> sources{{
+        Source(0),  Source(1),  Source(2),  Source(3),  Source(4),  Source(5),
+        Source(6),  Source(7),  Source(8),  Source(9),  Source(10), Source(11),
+        Source(12), Source(13), Source(14), Source(15), Source(16), Source(17),
+        Source(18), Source(19), Source(20), Source(21), Source(22), Source(23),
+    }};
+    std::array<SourceConfiguration::Configuration, num_sources> configs{};
+    const s16_le adpcm_coeffs[16]{};
+
+    for (std::size_t i = 0; i < num_sources; i++) {
+        sources[i].SetMemory(memory);
+
+        auto& config = configs[i];
+        config.enable = 1;
+        config.enable_dirty.Assign(1);
+        config.rate_multiplier = 0.5f + 0.1f * static_cast<float>(i);
+        config.rate_multiplier_dirty.Assign(1);
+        config.interpolation_mode = SourceConfiguration::Configuration::InterpolationMode::Linear;
+        config.interpolation_dirty.Assign(1);
+        for (std::size_t mix = 0; mix < 3; mix++) {
+            for (std::size_t channel = 0; channel < 4; channel++) {
+                config.gain[mix][channel] = 0.25f;
+            }
+        }
+        config.gain_0_dirty.Assign(1);
+        config.gain_1_dirty.Assign(1);
+        config.gain_2_dirty.Assign(1);
+        config.biquad_filter_enabled.Assign(i % 2);
+        config.biquad_filter.b0 = 0x4000;
+        config.filters_enabled_dirty.Assign(1);
+        config.biquad_filter_dirty.Assign(1);
+        config.physical_address = Memory::FCRAM_PADDR;
+        config.length = buffer_length;
+        config.mono_or_stereo.Assign(SourceConfiguration::Configuration::MonoOrStereo::Stereo);
+        config.format.Assign(SourceConfiguration::Configuration::Format::PCM16);
+        config.is_looping.Assign(1);
+        config.embedded_buffer_dirty.Assign(1);
+    }
+
+    TimeStretcher time_stretcher;
+    std::array<s16, samples_per_frame * 2> stretched{};
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const u64 start_allocations = num_allocations;
+
+    s64 checksum = 0;
+    for (int frame = 0; frame < num_frames; frame++) {
+        std::array<QuadFrame32, 3> intermediate_mixes{};
+        for (std::size_t i = 0; i < num_sources; i++) {
+            sources[i].Tick(configs[i], adpcm_coeffs);
+            for (std::size_t mix = 0; mix < 3; mix++) {
+                sources[i].MixInto(intermediate_mixes[mix], mix);
+            }
+        }
+
+        StereoFrame16 output;
+        for (std::size_t i = 0; i < output.size(); i++) {
+            output[i] = {static_cast<s16>(intermediate_mixes[0][i][0] >> 8),
+                         static_cast<s16>(intermediate_mixes[0][i][1] >> 8)};
+        }
+        time_stretcher.Process(&output[0][0], output.size(), stretched.data(), samples_per_frame);
+        checksum += stretched[0];
+    }
+
+    const u64 allocations = num_allocations - start_allocations;
+    const auto elapsed = std::chrono::steady_clock::now() - start_time;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    fmt::print("{} sources, {} frames: {} ns/frame, {:.2f} allocations/frame (checksum {})\n",
+               num_sources, num_frames, ns / num_frames,
+               static_cast<double>(allocations) / num_frames, checksum);
+}
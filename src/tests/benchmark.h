@@ -0,0 +1,36 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <string_view>
+#include <fmt/format.h>
+#include "common/common_types.h"
+
+namespace Benchmark {
+
+/**
+ * Times `iterations` calls of func and prints the mean time of a call. Benchmarks are Catch test
+ * cases tagged [.][benchmark], so that they only run when asked for, e.g. with `tests
+ * "[benchmark]"` or the citra_bench target.
+ * @param func Called once to warm up first. Returns a value that all the results are summed into,
+ *             which keeps the compiler from optimizing the work away.
+ */
+template <typename Func>
+void Run(std::string_view name, u64 iterations, Func&& func) {
+    u64 checksum = static_cast<u64>(func());
+
+    const auto start_time = std::chrono::steady_clock::now();
+    for (u64 i = 0; i < iterations; ++i) {
+        checksum += static_cast<u64>(func());
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start_time;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    fmt::print("{}: {:.1f} ns/iteration (checksum {})\n", name,
+               static_cast<double>(ns) / static_cast<double>(iterations), checksum);
+}
+
+} // namespace Benchmark
@@ -0,0 +1,41 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "common/file_util.h"
+
+namespace FileUtil {
+
+TEST_CASE("CopyDir copies the tree without overwriting", "[common]") {
+    const std::string source = "copy_dir_test_source/";
+    const std::string dest = "copy_dir_test_dest/";
+    REQUIRE(CreateFullPath(source + "nested/deeper/"));
+    for (int i = 0; i < 64; ++i) {
+        const std::string name = fmt::format("{}{}file{}.bin", source, i % 2 ? "nested/" : "", i);
+        REQUIRE(WriteStringToFile(false, name, fmt::format("contents {}", i)) > 0);
+    }
+    REQUIRE(WriteStringToFile(false, source + "nested/deeper/last.bin", "last") > 0);
+    REQUIRE(CreateFullPath(dest));
+    REQUIRE(WriteStringToFile(false, dest + "file0.bin", "kept") > 0);
+
+    CopyDir(source, dest);
+
+    std::string contents;
+    ReadFileToString(false, dest + "file0.bin", contents);
+    REQUIRE(contents == "kept");
+    for (int i = 1; i < 64; ++i) {
+        const std::string name = fmt::format("{}{}file{}.bin", dest, i % 2 ? "nested/" : "", i);
+        ReadFileToString(false, name, contents);
+        REQUIRE(contents == fmt::format("contents {}", i));
+    }
+    ReadFileToString(false, dest + "nested/deeper/last.bin", contents);
+    REQUIRE(contents == "last");
+
+    DeleteDirRecursively(source);
+    DeleteDirRecursively(dest);
+}
+
+} // namespace FileUtil
@@ -0,0 +1,48 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/hash.h"
+
+namespace Common {
+
+TEST_CASE("FastHasher64 matches ComputeFastHash64", "[common]") {
+    std::vector<u8> data(5000);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<u8>(i * 131 + (i >> 7));
+    }
+
+    // Covers the short inputs, partial stripes and several scrambled blocks
+    for (std::size_t len = 0; len < data.size(); len += 37) {
+        FastHasher64 hasher;
+        std::size_t offset = 0;
+        std::size_t piece = 1;
+        while (offset < len) {
+            const std::size_t count = std::min(piece, len - offset);
+            hasher.Update(data.data() + offset, count);
+            offset += count;
+            piece = piece * 3 % 200 + 1;
+        }
+        REQUIRE(hasher.Digest() == ComputeFastHash64(data.data(), len));
+    }
+}
+
+TEST_CASE("ComputeFastHash64 tells apart lengths and contents", "[common]") {
+    std::vector<u8> data(300);
+    std::vector<u64> hashes;
+    for (std::size_t len = 0; len <= data.size(); len++) {
+        hashes.push_back(ComputeFastHash64(data.data(), len));
+    }
+    for (std::size_t byte = 0; byte < data.size(); byte++) {
+        data[byte] = 1;
+        hashes.push_back(ComputeFastHash64(data.data(), data.size()));
+        data[byte] = 0;
+    }
+    std::sort(hashes.begin(), hashes.end());
+    REQUIRE(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+}
+
+} // namespace Common
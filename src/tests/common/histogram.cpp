@@ -0,0 +1,43 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "common/histogram.h"
+
+namespace Common {
+
+TEST_CASE("Histogram percentiles", "[common]") {
+    Histogram histogram;
+    REQUIRE(histogram.Percentile(50) == 0);
+
+    // 1..1000, plus a few outliers
+    for (u64 value = 1; value <= 1000; value++) {
+        histogram.Record(value);
+    }
+    for (int i = 0; i < 5; i++) {
+        histogram.Record(250000);
+    }
+    REQUIRE(histogram.Count() == 1005);
+
+    const auto require_near = [](u64 value, u64 expected) {
+        REQUIRE(value >= expected);
+        REQUIRE(value <= expected + expected / 64);
+    };
+    require_near(histogram.Percentile(50), 503);
+    require_near(histogram.Percentile(95), 955);
+    require_near(histogram.Percentile(99), 995);
+    require_near(histogram.Percentile(100), 250000);
+
+    // Small values are exact
+    histogram.Reset();
+    histogram.Record(3);
+    histogram.Record(7);
+    REQUIRE(histogram.Percentile(50) == 3);
+    REQUIRE(histogram.Percentile(99) == 7);
+
+    histogram.Record(~u64{0});
+    REQUIRE(histogram.Percentile(100) == Histogram::MaxValue);
+}
+
+} // namespace Common
@@ -0,0 +1,60 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "common/seqlock.h"
+
+namespace Common {
+
+namespace {
+struct Sample {
+    std::array<u32, 5> values;
+    bool flag;
+};
+} // Anonymous namespace
+
+TEST_CASE("SeqLock round trip", "[common]") {
+    SeqLock<Sample> lock;
+    REQUIRE(lock.Load().values == std::array<u32, 5>{});
+    REQUIRE(!lock.Load().flag);
+
+    lock.Store({{1, 2, 3, 4, 5}, true});
+    const Sample sample = lock.Load();
+    REQUIRE(sample.values == std::array<u32, 5>{1, 2, 3, 4, 5});
+    REQUIRE(sample.flag);
+}
+
+TEST_CASE("SeqLock readers never see torn writes", "[common]") {
+    SeqLock<Sample> lock;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for (u32 i = 1; i <= 100000; ++i) {
+            lock.Store({{i, i, i, i, i}, (i & 1) != 0});
+        }
+        done = true;
+    });
+
+    bool consistent = true;
+    u32 last = 0;
+    while (!done) {
+        const Sample sample = lock.Load();
+        for (const u32 value : sample.values) {
+            consistent &= value == sample.values[0];
+        }
+        consistent &= sample.values[0] == 0 || sample.flag == ((sample.values[0] & 1) != 0);
+        // A single writer's values are seen in order
+        consistent &= sample.values[0] >= last;
+        last = sample.values[0];
+    }
+    writer.join();
+
+    REQUIRE(consistent);
+    REQUIRE(lock.Load().values[0] == 100000);
+}
+
+} // namespace Common
@@ -0,0 +1,43 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdint>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/slab_allocator.h"
+
+namespace Common {
+
+namespace {
+struct Counted {
+    explicit Counted(int& live) : live(live) {
+        ++live;
+    }
+    ~Counted() {
+        --live;
+    }
+    int& live;
+    alignas(16) char payload[40];
+};
+} // Anonymous namespace
+
+TEST_CASE("MakeSlabShared reuses freed blocks", "[common]") {
+    int live = 0;
+    std::vector<std::shared_ptr<Counted>> objects;
+    for (int i = 0; i < 200; i++) {
+        objects.push_back(MakeSlabShared<Counted>(live));
+        REQUIRE(reinterpret_cast<std::uintptr_t>(objects.back()->payload) % 16 == 0);
+    }
+    REQUIRE(live == 200);
+
+    const Counted* const freed = objects[10].get();
+    objects[10].reset();
+    REQUIRE(live == 199);
+    REQUIRE(MakeSlabShared<Counted>(live).get() == freed);
+
+    objects.clear();
+    REQUIRE(live == 0);
+}
+
+} // namespace Common
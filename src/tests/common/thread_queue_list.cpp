@@ -0,0 +1,40 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "common/thread_queue_list.h"
+
+TEST_CASE("ThreadQueueList", "[common]") {
+    Common::ThreadQueueList<int, 64> queue;
+    for (unsigned int priority : {63u, 0u, 30u, 31u}) {
+        queue.prepare(priority);
+    }
+
+    REQUIRE(queue.get_first() == 0);
+
+    queue.push_back(31, 1);
+    queue.push_back(63, 2);
+    queue.push_back(30, 3);
+    queue.push_front(30, 4);
+    queue.push_back(0, 5);
+
+    REQUIRE(queue.get_first() == 5);
+    REQUIRE(queue.pop_first_better(0) == 0);
+    REQUIRE(queue.pop_first() == 5);
+    REQUIRE(queue.empty(0));
+
+    // Nothing runs before priority 30, and the front of its queue goes first
+    REQUIRE(queue.pop_first_better(30) == 0);
+    REQUIRE(queue.pop_first_better(31) == 4);
+
+    queue.rotate(30);
+    queue.remove(30, 3);
+    REQUIRE(queue.empty(30));
+    REQUIRE(queue.get_first() == 1);
+
+    queue.move(1, 31, 63);
+    REQUIRE(queue.pop_first() == 2);
+    REQUIRE(queue.pop_first() == 1);
+    REQUIRE(queue.get_first() == 0);
+}
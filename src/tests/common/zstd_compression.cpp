@@ -0,0 +1,76 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/zstd_compression.h"
+
+namespace Common::Compression {
+
+TEST_CASE("ZSTD stream buffers round trip", "[common]") {
+    std::mt19937 rng(0x25D);
+    std::vector<char> large(0x123456);
+    for (std::size_t i = 0; i < large.size(); i += 3) {
+        large[i] = static_cast<char>(rng());
+    }
+    const std::string small = "small write";
+
+    std::vector<u8> compressed;
+    ZSTDCompressBuffer compress{[&compressed](const u8* data, std::size_t size) {
+        compressed.insert(compressed.end(), data, data + size);
+    }};
+    // Small writes go through the buffer, large ones are compressed in place
+    REQUIRE(compress.sputn(small.data(), small.size()) ==
+            static_cast<std::streamsize>(small.size()));
+    REQUIRE(compress.sputn(large.data(), large.size()) ==
+            static_cast<std::streamsize>(large.size()));
+    REQUIRE(compress.sputc('!') == '!');
+    REQUIRE(compress.Finish());
+    REQUIRE(compressed.size() < large.size());
+
+    std::size_t pos = 0;
+    ZSTDDecompressBuffer decompress{[&compressed, &pos](u8* data, std::size_t size) {
+        // Hand out the compressed data in uneven pieces
+        size = std::min({size, compressed.size() - pos, std::size_t{1000}});
+        std::memcpy(data, compressed.data() + pos, size);
+        pos += size;
+        return size;
+    }};
+    std::string small_read(small.size(), '\0');
+    std::vector<char> large_read(large.size());
+    REQUIRE(decompress.sgetn(small_read.data(), small_read.size()) ==
+            static_cast<std::streamsize>(small.size()));
+    REQUIRE(decompress.sgetn(large_read.data(), large_read.size()) ==
+            static_cast<std::streamsize>(large.size()));
+    REQUIRE(decompress.sbumpc() == '!');
+    REQUIRE(decompress.sbumpc() == std::char_traits<char>::eof());
+    REQUIRE(small_read == small);
+    REQUIRE(large_read == large);
+}
+
+TEST_CASE("ZSTD stream buffer reads single-shot frames", "[common]") {
+    const std::vector<u8> data(0x20000, 0x5A);
+    const std::vector<u8> compressed = CompressDataZSTDDefault(data.data(), data.size());
+
+    bool given = false;
+    ZSTDDecompressBuffer decompress{[&](u8* out, std::size_t size) -> std::size_t {
+        if (given) {
+            return 0;
+        }
+        given = true;
+        REQUIRE(size >= compressed.size());
+        std::memcpy(out, compressed.data(), compressed.size());
+        return compressed.size();
+    }};
+    std::vector<u8> read(data.size() + 1);
+    REQUIRE(decompress.sgetn(reinterpret_cast<char*>(read.data()), read.size()) ==
+            static_cast<std::streamsize>(data.size()));
+    read.pop_back();
+    REQUIRE(read == data);
+}
+
+} // namespace Common::Compression
@@ -0,0 +1,53 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/zstd_compression.h"
+#include "tests/benchmark.h"
+
+namespace Common::Compression {
+
+TEST_CASE("ZSTD save state compression benchmark", "[.][benchmark][common]") {
+    // Save states are mostly zeroed memory with some noise, like this
+    std::mt19937 rng(0x5A7E);
+    std::vector<u8> state(32 * 1024 * 1024);
+    for (std::size_t i = 0; i < state.size(); i += 64 * 1024) {
+        const std::size_t length = std::min<std::size_t>(rng() % 0x8000, state.size() - i);
+        std::generate_n(state.begin() + i, length, [&rng] { return static_cast<u8>(rng()); });
+    }
+
+    // Compressed as SaveState does, through the stream buffer on 4 worker threads
+    std::vector<u8> compressed;
+    Benchmark::Run("ZSTDCompressBuffer 32 MiB", 10, [&] {
+        compressed.clear();
+        ZSTDCompressBuffer buffer{[&compressed](const u8* data, std::size_t size) {
+            compressed.insert(compressed.end(), data, data + size);
+        }};
+        buffer.SetWorkerCount(4);
+        buffer.sputn(reinterpret_cast<const char*>(state.data()),
+                     static_cast<std::streamsize>(state.size()));
+        REQUIRE(buffer.Finish());
+        return compressed.size();
+    });
+
+    std::vector<u8> decompressed(state.size());
+    Benchmark::Run("ZSTDDecompressBuffer 32 MiB", 10, [&] {
+        std::size_t pos = 0;
+        ZSTDDecompressBuffer buffer{[&](u8* data, std::size_t size) {
+            size = std::min(size, compressed.size() - pos);
+            std::memcpy(data, compressed.data() + pos, size);
+            pos += size;
+            return size;
+        }};
+        return buffer.sgetn(reinterpret_cast<char*>(decompressed.data()),
+                            static_cast<std::streamsize>(decompressed.size()));
+    });
+    REQUIRE(decompressed == state);
+}
+
+} // namespace Common::Compression
@@ -10,8 +10,6 @@
 
 namespace ArmTests {
 
-static std::shared_ptr<Memory::PageTable> page_table = nullptr;
-
 TestEnvironment::TestEnvironment(bool mutable_memory_)
     : mutable_memory(mutable_memory_), test_memory(std::make_shared<TestMemory>(this)) {
 
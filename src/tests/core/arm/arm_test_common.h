@@ -87,6 +87,7 @@ private:
     std::unique_ptr<Core::Timing> timing;
     std::unique_ptr<Memory::MemorySystem> memory;
     std::unique_ptr<Kernel::KernelSystem> kernel;
+    std::shared_ptr<Memory::PageTable> page_table;
 };
 
 } // namespace ArmTests
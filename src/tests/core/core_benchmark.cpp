@@ -0,0 +1,181 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+#include "core/mmio.h"
+#include "tests/benchmark.h"
+
+namespace {
+
+class TestMMIORegion final : public Memory::MMIORegion {
+public:
+    bool IsValidAddress(VAddr addr) override {
+        return true;
+    }
+    u8 Read8(VAddr addr) override {
+        return static_cast<u8>(addr);
+    }
+    u16 Read16(VAddr addr) override {
+        return static_cast<u16>(addr);
+    }
+    u32 Read32(VAddr addr) override {
+        return addr;
+    }
+    u64 Read64(VAddr addr) override {
+        return addr;
+    }
+    bool ReadBlock(VAddr src_addr, void* dest_buffer, std::size_t size) override {
+        return false;
+    }
+    void Write8(VAddr addr, u8 data) override {}
+    void Write16(VAddr addr, u16 data) override {}
+    void Write32(VAddr addr, u32 data) override {}
+    void Write64(VAddr addr, u64 data) override {}
+    bool WriteBlock(VAddr dest_addr, const void* src_buffer, std::size_t size) override {
+        return false;
+    }
+};
+
+u64 events_fired = 0;
+
+void CountEvent(u64 userdata, s64 cycles_late) {
+    ++events_fired;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Memory::Read32 benchmark", "[.][benchmark][core][memory]") {
+    constexpr u32 num_reads = 0x10000;
+
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+    auto& page_table = *process->vm_manager.page_table;
+    memory.MapIoRegion(page_table, Memory::IO_AREA_VADDR, Memory::PAGE_SIZE,
+                       std::make_shared<TestMMIORegion>());
+    memory.SetCurrentPageTable(process->vm_manager.page_table);
+
+    // Strided across pages, so that it doesn't only measure the same cache lines
+    Benchmark::Run("Read32 memory", 200, [&] {
+        u32 sum = 0;
+        for (u32 i = 0; i < num_reads; ++i) {
+            sum += memory.Read32(Memory::VRAM_VADDR + i * 0x44);
+        }
+        return sum;
+    });
+    Benchmark::Run("Read32 MMIO", 200, [&] {
+        u32 sum = 0;
+        for (u32 i = 0; i < num_reads; ++i) {
+            sum += memory.Read32(Memory::IO_AREA_VADDR + (i * 4 & Memory::PAGE_MASK));
+        }
+        return sum;
+    });
+}
+
+TEST_CASE("CoreTiming benchmark", "[.][benchmark][core]") {
+    constexpr u64 num_events = 16;
+
+    Core::Timing timing(1, 100);
+    Core::TimingEventType* event = timing.RegisterEvent("benchmark", CountEvent);
+    auto* timer = timing.GetTimer(0).get();
+    timer->Advance();
+    timer->SetNextSlice();
+
+    // Schedules events in no particular order, then runs the timer until all of them fired
+    Benchmark::Run("ScheduleEvent and Advance 16 events", 100000, [&] {
+        for (u64 i = 0; i < num_events; ++i) {
+            timing.ScheduleEvent(static_cast<s64>(i * 7919 % 20000), event, i);
+        }
+        const u64 target = events_fired + num_events;
+        while (events_fired < target) {
+            timer->AddTicks(timer->GetDowncount());
+            timer->Advance();
+            timer->SetNextSlice();
+        }
+        return events_fired;
+    });
+}
+
+TEST_CASE("HandleTable::Get benchmark", "[.][benchmark][core][kernel]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    Kernel::HandleTable handle_table(kernel);
+
+    std::vector<Kernel::Handle> handles;
+    for (int i = 0; i < 64; ++i) {
+        auto event = kernel.CreateEvent(Kernel::ResetType::OneShot);
+        handles.push_back(handle_table.Create(std::move(event)).Unwrap());
+    }
+
+    Benchmark::Run("HandleTable::Get<Event> 64 handles", 100000, [&] {
+        u32 sum = 0;
+        for (const Kernel::Handle handle : handles) {
+            sum += handle_table.Get<Kernel::Event>(handle) != nullptr;
+        }
+        return sum;
+    });
+}
+
+TEST_CASE("AddressArbiter benchmark", "[.][benchmark][core][kernel]") {
+    constexpr u32 num_threads = 64;
+
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto cpu = std::make_shared<ARM_DynCom>(nullptr, memory, USER32MODE, 0, timing.GetTimer(0));
+    kernel.SetCPUs({cpu});
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+    memory.SetCurrentPageTable(process->vm_manager.page_table);
+    auto arbiter = kernel.CreateAddressArbiter("benchmark");
+
+    // VRAM reads as 0, so every thread waits on an address of its own
+    std::vector<std::shared_ptr<Kernel::Thread>> threads;
+    for (u32 i = 0; i < num_threads; ++i) {
+        const VAddr address = Memory::VRAM_VADDR + i * 4;
+        auto thread = kernel
+                          .CreateThread("benchmark", Memory::VRAM_VADDR, Kernel::ThreadPrioLowest,
+                                        0, 0, Memory::VRAM_VADDR, process)
+                          .Unwrap();
+        arbiter->ArbitrateAddress(thread, Kernel::ArbitrationType::WaitIfLessThan, address, 1, 0);
+        threads.push_back(std::move(thread));
+    }
+
+    Benchmark::Run("Signal with 64 busy addresses", 10000, [&] {
+        u32 sum = 0;
+        for (u32 i = 0; i < num_threads; ++i) {
+            const VAddr address = Memory::VRAM_VADDR + i * 4;
+            sum += arbiter->ArbitrateAddress(threads[i], Kernel::ArbitrationType::Signal, address,
+                                             1, 0) == RESULT_SUCCESS;
+            arbiter->ArbitrateAddress(threads[i], Kernel::ArbitrationType::WaitIfLessThan, address,
+                                      1, 0);
+        }
+        return sum;
+    });
+    Benchmark::Run("Signal with no waiters", 100000, [&] {
+        const VAddr address = Memory::VRAM_VADDR + num_threads * 4;
+        return arbiter->ArbitrateAddress(nullptr, Kernel::ArbitrationType::Signal, address, -1,
+                                         0) == RESULT_SUCCESS;
+    });
+}
@@ -77,6 +77,42 @@ TEST_CASE("CoreTiming[BasicOrder]", "[core]") {
     AdvanceAndCheck(timing, 4, MAX_SLICE_LENGTH);
 }
 
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    Core::TimingEventType* cb_c = timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+    Core::TimingEventType* cb_d = timing.RegisterEvent("callbackD", CallbackTemplate<3>);
+    Core::TimingEventType* cb_e = timing.RegisterEvent("callbackE", CallbackTemplate<4>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    timing.ScheduleEvent(1000, cb_a, CB_IDS[0], 0);
+    timing.ScheduleEvent(500, cb_b, CB_IDS[1], 0);
+    timing.ScheduleEvent(800, cb_c, CB_IDS[2], 0);
+    timing.ScheduleEvent(100, cb_d, CB_IDS[3], 0);
+    timing.ScheduleEvent(1200, cb_e, CB_IDS[4], 0);
+
+    // Events with other userdata are kept
+    timing.UnscheduleEvent(cb_a, CB_IDS[1]);
+    timing.UnscheduleEvent(cb_b, CB_IDS[1]);
+    timing.RemoveEvent(cb_d);
+
+    // Nothing is left to run when D was due
+    timing.GetTimer(0)->AddTicks(timing.GetTimer(0)->GetDowncount());
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(700 == timing.GetTimer(0)->GetDowncount());
+
+    // C -> A -> E
+    AdvanceAndCheck(timing, 2, 200);
+    AdvanceAndCheck(timing, 0, 200);
+    AdvanceAndCheck(timing, 4, MAX_SLICE_LENGTH);
+}
+
 namespace SharedSlotTest {
 static unsigned int counter = 0;
 
@@ -0,0 +1,66 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/disk_archive.h"
+
+namespace FileSys {
+
+namespace {
+
+std::unique_ptr<DiskFile> OpenDiskFile(const std::string& path, const char* openmode) {
+    Mode mode{};
+    mode.read_flag.Assign(1);
+    mode.write_flag.Assign(1);
+    return std::make_unique<DiskFile>(FileUtil::IOFile(path, openmode), mode, nullptr);
+}
+
+std::vector<u8> ReadAll(const DiskFile& file) {
+    std::vector<u8> data(file.GetSize());
+    REQUIRE(*file.Read(0, data.size(), data.data()) == data.size());
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DiskFile caches writes", "[core][file_sys]") {
+    const std::string path = "disk_file_test.bin";
+    {
+        auto file = OpenDiskFile(path, "w+b");
+        const std::array<u8, 4> data{1, 2, 3, 4};
+
+        // Sequential writes are merged and are not in the host file before a flush
+        for (u64 offset = 0; offset < 8; offset += 2) {
+            REQUIRE(*file->Write(offset, 2, false, data.data()) == 2);
+        }
+        REQUIRE(FileUtil::GetSize(path) == 0);
+        REQUIRE(ReadAll(*file) == std::vector<u8>{1, 2, 1, 2, 1, 2, 1, 2});
+
+        // A write past the end leaves a gap of zeroes, and a write bridging two ranges merges them
+        REQUIRE(*file->Write(10, 4, false, data.data()) == 4);
+        REQUIRE(ReadAll(*file) == std::vector<u8>{1, 2, 1, 2, 1, 2, 1, 2, 0, 0, 1, 2, 3, 4});
+        REQUIRE(*file->Write(7, 4, false, data.data()) == 4);
+        REQUIRE(ReadAll(*file) == std::vector<u8>{1, 2, 1, 2, 1, 2, 1, 1, 2, 3, 4, 2, 3, 4});
+
+        file->Flush();
+        REQUIRE(FileUtil::GetSize(path) == 14);
+
+        // Another handle of the same file sees the writes cached by the first one
+        REQUIRE(*file->Write(0, 1, false, &data[3]) == 1);
+        auto other = OpenDiskFile(path, "r+b");
+        u8 first_byte = 0;
+        REQUIRE(*other->Read(0, 1, &first_byte) == 1);
+        REQUIRE(first_byte == 4);
+
+        // Destroying the file writes back the cached writes
+        REQUIRE(*file->Write(13, 2, false, data.data()) == 2);
+    }
+    REQUIRE(FileUtil::GetSize(path) == 15);
+    FileUtil::Delete(path);
+}
+
+} // namespace FileSys
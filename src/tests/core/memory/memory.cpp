@@ -55,3 +55,33 @@ TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
         CHECK(Memory::IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("Memory::RasterizerMarkRegionCached", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+    auto& page_table = *process->vm_manager.page_table;
+    const std::size_t first_page = Memory::VRAM_VADDR >> Memory::PAGE_BITS;
+
+    // Pages 1 to 3, as the range only touches the first byte of page 3
+    memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR + Memory::PAGE_SIZE,
+                                      2 * Memory::PAGE_SIZE + 1, true);
+    CHECK(page_table.attributes[first_page] == Memory::PageType::Memory);
+    for (std::size_t page = first_page + 1; page < first_page + 4; ++page) {
+        CHECK(page_table.attributes[page] == Memory::PageType::RasterizerCachedMemory);
+        CHECK(page_table.GetPointerArray()[page] == nullptr);
+    }
+    CHECK(page_table.attributes[first_page + 4] == Memory::PageType::Memory);
+
+    memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR + Memory::PAGE_SIZE,
+                                      3 * Memory::PAGE_SIZE, false);
+    for (std::size_t page = 1; page < 4; ++page) {
+        CHECK(page_table.attributes[first_page + page] == Memory::PageType::Memory);
+        CHECK(page_table.GetPointerArray()[first_page + page] ==
+              memory.GetPhysicalPointer(Memory::VRAM_PADDR + page * Memory::PAGE_SIZE));
+    }
+}
@@ -0,0 +1,67 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+#include "core/memory_watch.h"
+
+TEST_CASE("MemoryWatch copies the ranges at capture", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.MapSharedPages(process->vm_manager);
+
+    const auto write = [&](u32 value) {
+        memory.WriteBlock(*process, Memory::SHARED_PAGE_VADDR, &value, sizeof(value));
+    };
+    const auto read = [](const Core::MemoryWatch& watch, u32 id) {
+        u32 value = 0;
+        REQUIRE(watch.Read(id, reinterpret_cast<u8*>(&value)));
+        return value;
+    };
+
+    Core::MemoryWatch watch(memory);
+    CHECK(watch.AddWatch(Memory::SHARED_PAGE_VADDR, 0) == 0);
+    CHECK(watch.AddWatch(Memory::SHARED_PAGE_VADDR,
+                         static_cast<u32>(Core::MemoryWatch::MaxWatchedBytes + 1)) == 0);
+
+    write(0x12345678);
+    const u32 id = watch.AddWatch(Memory::SHARED_PAGE_VADDR, sizeof(u32));
+    REQUIRE(id != 0);
+    u32 value = 0;
+    CHECK(!watch.Read(id, reinterpret_cast<u8*>(&value)));
+
+    watch.Capture(*process);
+    CHECK(watch.GetFrameCount() == 1);
+    CHECK(read(watch, id) == 0x12345678);
+
+    SECTION("reads return the last captured frame") {
+        write(0xCAFEBABE);
+        CHECK(read(watch, id) == 0x12345678);
+        watch.Capture(*process);
+        CHECK(read(watch, id) == 0xCAFEBABE);
+    }
+
+    SECTION("ranges added later are captured with the others") {
+        const u32 other = watch.AddWatch(Memory::SHARED_PAGE_VADDR + 2, sizeof(u16));
+        REQUIRE(other != 0);
+        watch.Capture(*process);
+        CHECK(read(watch, id) == 0x12345678);
+        u16 half = 0;
+        REQUIRE(watch.Read(other, reinterpret_cast<u8*>(&half)));
+        CHECK(half == 0x1234);
+    }
+
+    SECTION("removed ranges are no longer captured") {
+        CHECK(watch.RemoveWatch(id));
+        CHECK(!watch.RemoveWatch(id));
+        watch.Capture(*process);
+        CHECK(!watch.Read(id, reinterpret_cast<u8*>(&value)));
+    }
+}
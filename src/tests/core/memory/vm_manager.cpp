@@ -138,3 +138,58 @@ TEST_CASE("Memory Basics", "[kernel][memory]") {
         REQUIRE(code == RESULT_SUCCESS);
     }
 }
+
+TEST_CASE("Memory area lookups", "[kernel][memory]") {
+    auto mem = std::make_shared<BufferMem>(4 * Memory::PAGE_SIZE);
+    MemoryRef block{mem};
+    Memory::MemorySystem memory;
+    // Because of the PageTable, Kernel::VMManager is too big to be created on the stack.
+    auto manager = std::make_unique<Kernel::VMManager>(memory);
+
+    const u32 half_size = 2 * Memory::PAGE_SIZE;
+    auto result = manager->MapBackingMemory(Memory::HEAP_VADDR + half_size, block + half_size,
+                                            half_size, Kernel::MemoryState::Private);
+    REQUIRE(result.Code() == RESULT_SUCCESS);
+
+    SECTION("after the area found last is merged away") {
+        auto vma = manager->FindVMA(Memory::HEAP_VADDR + half_size);
+        REQUIRE(vma->second.base == Memory::HEAP_VADDR + half_size);
+
+        result = manager->MapBackingMemory(Memory::HEAP_VADDR, block, half_size,
+                                           Kernel::MemoryState::Private);
+        REQUIRE(result.Code() == RESULT_SUCCESS);
+
+        vma = manager->FindVMA(Memory::HEAP_VADDR + half_size);
+        CHECK(vma->second.base == Memory::HEAP_VADDR);
+        CHECK(vma->second.size == block.GetSize());
+        CHECK(manager->FindVMA(Memory::HEAP_VADDR) == vma);
+    }
+
+    SECTION("after the area found last is split") {
+        auto vma = manager->FindVMA(Memory::HEAP_VADDR + half_size);
+        REQUIRE(vma->second.size == half_size);
+
+        const VAddr second_page = Memory::HEAP_VADDR + half_size + Memory::PAGE_SIZE;
+        ResultCode code = manager->ReprotectRange(second_page, Memory::PAGE_SIZE,
+                                                  Kernel::VMAPermission::Read);
+        REQUIRE(code == RESULT_SUCCESS);
+
+        vma = manager->FindVMA(second_page);
+        CHECK(vma->second.base == second_page);
+        CHECK(vma->second.permissions == Kernel::VMAPermission::Read);
+    }
+
+    SECTION("mapping the pages of an area") {
+        auto& page_table = *manager->page_table;
+        const auto& pointers = page_table.GetPointerArray();
+        const u32 first_page = (Memory::HEAP_VADDR + half_size) >> Memory::PAGE_BITS;
+        CHECK(pointers[first_page] == block.GetPtr() + half_size);
+        CHECK(pointers[first_page + 1] == block.GetPtr() + half_size + Memory::PAGE_SIZE);
+        CHECK(page_table.attributes[first_page + 1] == Memory::PageType::Memory);
+
+        ResultCode code = manager->UnmapRange(Memory::HEAP_VADDR + half_size, half_size);
+        REQUIRE(code == RESULT_SUCCESS);
+        CHECK(pointers[first_page] == nullptr);
+        CHECK(page_table.attributes[first_page + 1] == Memory::PageType::Unmapped);
+    }
+}
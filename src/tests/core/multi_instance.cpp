@@ -0,0 +1,147 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef CITRA_MULTI_INSTANCE
+
+#include <array>
+#include <functional>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "common/thread.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
+#include "tests/core/arm/arm_test_common.h"
+#include "tests/video_core/shader/shader_test_common.h"
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/video_core.h"
+
+namespace {
+
+using namespace ShaderTests;
+
+constexpr std::size_t NumInstances = 2;
+
+/// What a thread saw of its console, checked once the threads have finished
+struct InstanceResult {
+    u32 pica_register = 0;
+    bool memory_kept = false;
+    Pica::Shader::ShaderEngine* engine = nullptr;
+    Pica::Shader::ShaderEngine* engine_after_shutdown = nullptr;
+    float shader_output = 0.f;
+    float shader_output_after_shutdown = 0.f;
+    u32 arm_result = 0;
+    bool trans_cache_kept = false;
+};
+
+Common::Vec4<Pica::float24> Splat(float value) {
+    const auto f24 = Pica::float24::FromFloat32(value);
+    return {f24, f24, f24, f24};
+}
+
+float RunShader(Pica::Shader::ShaderEngine& engine, const Pica::Shader::ShaderSetup& setup) {
+    Pica::Shader::UnitState state;
+    state.registers = {};
+    std::fill(std::begin(state.address_registers), std::end(state.address_registers), 0);
+    state.registers.input[0] = Splat(3.f);
+    engine.Run(setup, state);
+    return state.registers.output[0].x.ToFloat32();
+}
+
+/**
+ * Runs a console on the calling thread. The threads take turns at the barrier, so that each step
+ * of one console happens between two steps of the other.
+ */
+void RunInstance(std::size_t index, const Pica::Shader::ShaderSetup& program,
+                 Common::Barrier& barrier, InstanceResult& result) {
+    ArmTests::TestEnvironment test_env(false);
+    test_env.SetMemory32(0, 0xE3A00001 + static_cast<u32>(index)); // mov r0, #(index + 1)
+    test_env.SetMemory32(4, 0xEAFFFFFE);                           // b +#0
+    ARM_DynCom dyncom(nullptr, test_env.GetMemory(), USER32MODE, 0, nullptr);
+
+    Pica::g_state.regs.reg_array[0] = static_cast<u32>(index + 1);
+    VideoCore::g_memory = &test_env.GetMemory();
+
+    Pica::Shader::ShaderSetup setup = program;
+    result.engine = Pica::Shader::GetEngine();
+    result.engine->SetupBatch(setup, 0);
+    result.shader_output = RunShader(*result.engine, setup);
+    barrier.Sync();
+
+    // The first console translates its code, then checks the second one did not use its cache
+    std::size_t trans_cache_top = 0;
+    if (index == 0) {
+        dyncom.SetPC(0);
+        dyncom.Step();
+        trans_cache_top = trans_cache_buf_top;
+    }
+    barrier.Sync();
+    if (index == 1) {
+        dyncom.SetPC(0);
+        dyncom.Step();
+    }
+    barrier.Sync();
+    result.arm_result = dyncom.GetReg(0);
+    result.trans_cache_kept = index != 0 || trans_cache_buf_top == trans_cache_top;
+
+    // The first console shuts down, which must leave the shader engine of the second one alone
+    if (index == 0) {
+        Pica::Shader::Shutdown();
+    }
+    barrier.Sync();
+    result.engine_after_shutdown = Pica::Shader::GetEngine();
+    if (index == 1) {
+        result.shader_output_after_shutdown = RunShader(*result.engine_after_shutdown, setup);
+    }
+
+    result.pica_register = Pica::g_state.regs.reg_array[0];
+    result.memory_kept = VideoCore::g_memory == &test_env.GetMemory();
+    Pica::Shader::Shutdown();
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Each thread runs a console of its own", "[core][multi_instance]") {
+    const bool jit_enabled = VideoCore::g_shader_jit_enabled.exchange(true);
+
+    // The first console multiplies the input by the uniform, the second one adds them
+    std::array<Common::Vec4<Pica::float24>, 96> uniforms{};
+    uniforms[0] = Splat(2.f);
+    std::array<Pica::Shader::ShaderSetup, NumInstances> programs;
+    std::array<OpCode::Id, NumInstances> opcodes{OpCode::Id::MUL, OpCode::Id::ADD};
+    for (std::size_t i = 0; i < NumInstances; ++i) {
+        ProgramBuilder program;
+        const u32 desc = program.Descriptor("xyzw");
+        program.Arithmetic(opcodes[i], Output(0), Uniform(0), Input(0), desc);
+        program.End();
+        programs[i] = program.Build(uniforms);
+    }
+
+    Common::Barrier barrier{NumInstances};
+    std::array<InstanceResult, NumInstances> results;
+    std::array<std::thread, NumInstances> threads;
+    for (std::size_t i = 0; i < NumInstances; ++i) {
+        threads[i] = std::thread(RunInstance, i, std::cref(programs[i]), std::ref(barrier),
+                                 std::ref(results[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    VideoCore::g_shader_jit_enabled = jit_enabled;
+
+    for (std::size_t i = 0; i < NumInstances; ++i) {
+        INFO("instance " << i);
+        REQUIRE(results[i].pica_register == i + 1);
+        REQUIRE(results[i].memory_kept);
+        REQUIRE(results[i].arm_result == i + 1);
+        REQUIRE(results[i].trans_cache_kept);
+    }
+    REQUIRE(results[0].engine != results[1].engine);
+    REQUIRE(results[0].shader_output == 6.f);
+    REQUIRE(results[1].shader_output == 5.f);
+    REQUIRE(results[1].engine_after_shutdown == results[1].engine);
+    REQUIRE(results[1].shader_output_after_shutdown == 5.f);
+}
+
+#endif
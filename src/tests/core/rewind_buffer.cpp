@@ -0,0 +1,69 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/rewind_buffer.h"
+
+namespace Core {
+
+TEST_CASE("RewindBuffer restores states newest first", "[core]") {
+    std::mt19937 rng(0x4E3);
+    std::vector<u8> state(0x40000);
+    for (u8& value : state) {
+        value = static_cast<u8>(rng());
+    }
+
+    RewindBuffer buffer(0x1000000);
+    std::vector<std::vector<u8>> pushed;
+    for (int i = 0; i < 6; i++) {
+        for (int change = 0; change < 100; change++) {
+            state[rng() % state.size()] = static_cast<u8>(rng());
+        }
+        // States don't all have the same size
+        if (i == 2) {
+            state.resize(state.size() + 0x1234, 0xAA);
+        } else if (i == 4) {
+            state.resize(state.size() - 0x4321);
+        }
+        pushed.push_back(state);
+        std::vector<u8> copy = state;
+        buffer.Push(copy);
+    }
+    REQUIRE(buffer.Count() == pushed.size());
+    // Only the newest state is stored whole
+    REQUIRE(buffer.MemoryUsage() < state.size() * 2);
+
+    std::vector<u8> popped;
+    while (!pushed.empty()) {
+        REQUIRE(buffer.Pop(popped));
+        REQUIRE(popped == pushed.back());
+        pushed.pop_back();
+    }
+    REQUIRE(!buffer.Pop(popped));
+    REQUIRE(buffer.Count() == 0);
+}
+
+TEST_CASE("RewindBuffer drops the oldest states over its budget", "[core]") {
+    std::vector<u8> state(0x10000, 0);
+    RewindBuffer buffer(state.size() + 0x100);
+    for (int i = 0; i < 4; i++) {
+        // Random data does not compress, so each older state costs a whole state
+        std::mt19937 rng(i);
+        for (u8& value : state) {
+            value = static_cast<u8>(rng());
+        }
+        std::vector<u8> copy = state;
+        buffer.Push(copy);
+    }
+    REQUIRE(buffer.Count() == 1);
+    REQUIRE(buffer.MemoryUsage() <= state.size() + 0x100);
+
+    std::vector<u8> popped;
+    REQUIRE(buffer.Pop(popped));
+    REQUIRE(popped == state);
+}
+
+} // namespace Core
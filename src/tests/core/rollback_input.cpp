@@ -0,0 +1,41 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/rollback_input.h"
+
+namespace Core {
+
+TEST_CASE("RollbackInputLog predicts late inputs and finds mispredictions", "[core]") {
+    RollbackInputLog log(2);
+    const RollbackInputLog::Input held{1, 2};
+    const RollbackInputLog::Input released{0, 0};
+
+    log.Confirm(0, 0, held);
+    log.Confirm(1, 0, held);
+    REQUIRE(log.GetConfirmedFrame() == 0);
+
+    // The remote member's input is predicted from its last one
+    for (u64 frame = 1; frame <= 3; frame++) {
+        log.Confirm(0, frame, held);
+        REQUIRE(log.GetInput(1, frame) == held);
+    }
+    REQUIRE(log.GetConfirmedFrame() == 0);
+
+    log.Confirm(1, 1, held);
+    REQUIRE(!log.TakeRollbackFrame());
+    log.Confirm(1, 2, released);
+    log.Confirm(1, 3, released);
+    REQUIRE(log.TakeRollbackFrame() == 2);
+    REQUIRE(!log.TakeRollbackFrame());
+    REQUIRE(log.GetConfirmedFrame() == 3);
+    REQUIRE(log.GetInput(1, 3) == released);
+
+    // Discarded frames still predict the next ones
+    log.DiscardBefore(4);
+    REQUIRE(log.GetInput(1, 4) == released);
+    REQUIRE(log.GetConfirmedFrame() == 3);
+}
+
+} // namespace Core
@@ -0,0 +1,40 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "network/packet.h"
+#include "tests/benchmark.h"
+
+namespace Network {
+
+TEST_CASE("Packet serialization benchmark", "[.][benchmark][network]") {
+    // Roughly what a room's wifi packet carries
+    const std::string nickname = "benchmark";
+    const std::array<u8, 6> mac{0x40, 0xF4, 0x07, 0x12, 0x34, 0x56};
+    const std::vector<u8> payload(1400, 0xA5);
+
+    std::vector<char> buffer;
+    Benchmark::Run("Packet write and read 1400 bytes", 100000, [&] {
+        Packet packet{std::move(buffer)};
+        packet << static_cast<u8>(1) << nickname << mac << static_cast<u32>(payload.size())
+               << payload;
+
+        Packet read;
+        read.Append(packet.GetData(), packet.GetDataSize());
+        u8 type;
+        std::string read_nickname;
+        std::array<u8, 6> read_mac;
+        u32 size;
+        std::vector<u8> read_payload;
+        read >> type >> read_nickname >> read_mac >> size >> read_payload;
+
+        buffer = packet.TakeData();
+        return type + read_payload.size();
+    });
+}
+
+} // namespace Network
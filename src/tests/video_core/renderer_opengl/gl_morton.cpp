@@ -0,0 +1,98 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/renderer_opengl/gl_morton.h"
+#include "video_core/utils.h"
+
+using namespace OpenGL;
+
+namespace {
+
+constexpr std::array<MortonTileKind, 4> kinds = {
+    MortonTileKind::Copy16,
+    MortonTileKind::Copy32,
+    MortonTileKind::SwapBytes32,
+    MortonTileKind::D24S8,
+};
+
+constexpr std::array<MortonBackend, 3> vector_backends = {
+    MortonBackend::SSSE3,
+    MortonBackend::AVX2,
+    MortonBackend::NEON,
+};
+
+constexpr u32 BytesPerTexel(MortonTileKind kind) {
+    return kind == MortonTileKind::Copy16 ? 2 : 4;
+}
+
+std::vector<u8> RandomBytes(std::size_t size, std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<u8> bytes(size);
+    for (auto& byte : bytes) {
+        byte = static_cast<u8>(dist(rng));
+    }
+    return bytes;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MortonTile scalar layout", "[video_core][morton]") {
+    // Stride of two tiles, with the tile copied into the second one
+    constexpr u32 stride = 16;
+    std::array<u8, 64 * 4> tile{};
+    for (u32 i = 0; i < 64; ++i) {
+        tile[i * 4] = static_cast<u8>(i);
+    }
+    std::vector<u8> gl(stride * 8 * 4);
+    GetMortonTileFn(MortonTileKind::Copy32, true, MortonBackend::Scalar)(stride, tile.data(),
+                                                                        gl.data() + 8 * 4);
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            REQUIRE(gl[((7 - y) * stride + 8 + x) * 4] == VideoCore::MortonInterleave(x, y));
+        }
+    }
+}
+
+TEST_CASE("MortonTile vector kernels match scalar", "[video_core][morton]") {
+    std::mt19937 rng(1234);
+    for (const u32 stride : {8u, 24u, 64u}) {
+        for (const MortonTileKind kind : kinds) {
+            const std::size_t tile_size = 64 * BytesPerTexel(kind);
+            const std::size_t gl_size = stride * 8 * BytesPerTexel(kind);
+            const std::vector<u8> tile = RandomBytes(tile_size, rng);
+            const std::vector<u8> gl = RandomBytes(gl_size, rng);
+
+            std::vector<u8> expected_gl = gl;
+            std::vector<u8> scalar_tile = tile;
+            GetMortonTileFn(kind, true, MortonBackend::Scalar)(stride, scalar_tile.data(),
+                                                               expected_gl.data());
+            std::vector<u8> expected_tile = tile;
+            std::vector<u8> scalar_gl = gl;
+            GetMortonTileFn(kind, false, MortonBackend::Scalar)(stride, expected_tile.data(),
+                                                                scalar_gl.data());
+
+            for (const MortonBackend backend : vector_backends) {
+                if (!IsMortonBackendSupported(backend)) {
+                    continue;
+                }
+
+                std::vector<u8> result_tile = tile;
+                std::vector<u8> result_gl = gl;
+                GetMortonTileFn(kind, true, backend)(stride, result_tile.data(), result_gl.data());
+                REQUIRE(result_gl == expected_gl);
+                REQUIRE(result_tile == tile);
+
+                result_tile = tile;
+                result_gl = gl;
+                GetMortonTileFn(kind, false, backend)(stride, result_tile.data(), result_gl.data());
+                REQUIRE(result_tile == expected_tile);
+                REQUIRE(result_gl == gl);
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "tests/benchmark.h"
+#include "video_core/renderer_opengl/gl_morton.h"
+
+using namespace OpenGL;
+
+TEST_CASE("MortonTile benchmark", "[.][benchmark][video_core][morton]") {
+    // A 256x256 surface, swizzled tile by tile as the rasterizer cache's MortonCopy does. The
+    // kinds cover every format with a vector path.
+    constexpr u32 width = 256;
+    constexpr u32 height = 256;
+
+    constexpr std::array<std::pair<MortonTileKind, std::string_view>, 4> kinds{{
+        {MortonTileKind::Copy16, "Copy16"},
+        {MortonTileKind::Copy32, "Copy32"},
+        {MortonTileKind::SwapBytes32, "SwapBytes32"},
+        {MortonTileKind::D24S8, "D24S8"},
+    }};
+    constexpr std::array<std::pair<MortonBackend, std::string_view>, 4> backends{{
+        {MortonBackend::Scalar, "Scalar"},
+        {MortonBackend::SSSE3, "SSSE3"},
+        {MortonBackend::AVX2, "AVX2"},
+        {MortonBackend::NEON, "NEON"},
+    }};
+
+    for (const auto& [kind, kind_name] : kinds) {
+        const u32 bytes_per_texel = kind == MortonTileKind::Copy16 ? 2 : 4;
+        std::vector<u8> morton(width * height * bytes_per_texel, 0x5A);
+        std::vector<u8> gl(width * height * bytes_per_texel, 0xA5);
+
+        for (const auto& [backend, backend_name] : backends) {
+            if (!IsMortonBackendSupported(backend)) {
+                continue;
+            }
+            for (const bool morton_to_gl : {true, false}) {
+                const MortonTileFn swizzle = GetMortonTileFn(kind, morton_to_gl, backend);
+                const auto copy_surface = [&] {
+                    u8* tile = morton.data();
+                    for (u32 y = 0; y < height; y += 8) {
+                        for (u32 x = 0; x < width; x += 8) {
+                            const u32 offset = ((height - 8 - y) * width + x) * bytes_per_texel;
+                            swizzle(width, tile, gl.data() + offset);
+                            tile += 64 * bytes_per_texel;
+                        }
+                    }
+                    return gl[0] + morton[0];
+                };
+                Benchmark::Run(fmt::format("MortonTile {} {} {} {}x{}", kind_name, backend_name,
+                                           morton_to_gl ? "to GL" : "to Morton", width, height),
+                               1000, copy_surface);
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch.hpp>
+#include "tests/video_core/shader/shader_test_common.h"
+#include "video_core/renderer_opengl/gl_shader_decompiler.h"
+
+using namespace ShaderTests;
+
+namespace {
+
+/// Decompiles the program with accurate multiplication, returning whether the instruction at
+/// offset multiplies through sanitize_mul. The instruction must not be the last one.
+bool IsSanitized(const ProgramBuilder& program, u32 offset) {
+    const auto setup = program.Build();
+    const auto result = OpenGL::ShaderDecompiler::DecompileProgram(
+        setup.program_code, setup.swizzle_data, 0,
+        [](u32 index) { return "vs_in_reg" + std::to_string(index); },
+        [](u32 index) { return "vs_out_attr" + std::to_string(index); }, true, false);
+    REQUIRE(result);
+
+    const std::string& code = result->code;
+    const std::string marker = "// " + std::to_string(offset) + ": ";
+    const std::size_t begin = code.find(marker);
+    REQUIRE(begin != std::string::npos);
+    const std::size_t end = code.find("// ", begin + marker.size());
+    REQUIRE(end != std::string::npos);
+    return code.substr(begin, end - begin).find("sanitize_mul(") != std::string::npos;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("sanitize_mul is kept for inputs", "[video_core][shader][gl_shader_decompiler]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    // Temporaries start at (0, 0, 0, 1), while inputs may be infinite
+    program.Arithmetic(OpCode::Id::MUL, Output(0), Input(0), Temp(1), desc);
+    program.Arithmetic(OpCode::Id::MUL, Output(1), Temp(1), Temp(2), desc);
+    program.End();
+
+    REQUIRE(IsSanitized(program, 0));
+    REQUIRE_FALSE(IsSanitized(program, 1));
+}
+
+TEST_CASE("sanitize_mul is kept for RCP of a range that includes zero",
+          "[video_core][shader][gl_shader_decompiler]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    program.Arithmetic(OpCode::Id::SGE, Temp(0), Input(0), Input(1), desc);
+    program.Arithmetic(OpCode::Id::RCP, Temp(1), Temp(0), 0, desc);
+    program.Arithmetic(OpCode::Id::MUL, Output(0), Temp(1), Temp(0), desc);
+    // The reciprocal of the initial w component is 1
+    program.Arithmetic(OpCode::Id::RCP, Temp(2), Temp(3), 0, program.Descriptor("xyzw", "wwww"));
+    program.Arithmetic(OpCode::Id::MUL, Output(1), Temp(2), Temp(0), desc);
+    program.End();
+
+    REQUIRE(IsSanitized(program, 2));
+    REQUIRE_FALSE(IsSanitized(program, 4));
+}
+
+TEST_CASE("sanitize_mul is kept for a widened loop counter",
+          "[video_core][shader][gl_shader_decompiler]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    // r0.w grows by one on each iteration, so its range is widened to infinity
+    program.Flow(OpCode::Id::LOOP, 1, 0, 0);
+    program.Arithmetic(OpCode::Id::ADD, Temp(0), Temp(0), Temp(1), desc);
+    program.Arithmetic(OpCode::Id::SGE, Temp(2), Input(0), Input(1), desc);
+    program.Arithmetic(OpCode::Id::MUL, Output(0), Temp(0), Temp(2), desc);
+    program.End();
+
+    REQUIRE(IsSanitized(program, 3));
+}
+
+TEST_CASE("sanitize_mul is kept for MIN and MAX with a NaN operand",
+          "[video_core][shader][gl_shader_decompiler]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    // r2 is in [0, 1] unless it is NaN, while r3 may be infinite. GPUs may return r3 when r2 is
+    // NaN, so neither result is bounded.
+    program.Arithmetic(OpCode::Id::EX2, Temp(1), Input(0), 0, desc);
+    program.Arithmetic(OpCode::Id::EX2, Temp(2), Temp(1), 0, program.Descriptor("xyzw", "-xyzw"));
+    program.Arithmetic(OpCode::Id::EX2, Temp(3), Input(1), 0, desc);
+    program.Arithmetic(OpCode::Id::MIN, Temp(4), Temp(2), Temp(3), desc);
+    program.Arithmetic(OpCode::Id::MUL, Output(0), Temp(4), Temp(0), desc);
+    program.Arithmetic(OpCode::Id::MAX, Temp(5), Temp(2), Temp(3),
+                       program.Descriptor("xyzw", "xyzw", "-xyzw"));
+    program.Arithmetic(OpCode::Id::MUL, Output(1), Temp(5), Temp(0), desc);
+    program.End();
+
+    REQUIRE(IsSanitized(program, 4));
+    REQUIRE(IsSanitized(program, 6));
+}
+
+TEST_CASE("sanitize_mul is dropped for SGE and SLT factors",
+          "[video_core][shader][gl_shader_decompiler]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    program.Arithmetic(OpCode::Id::SGE, Temp(0), Uniform(0), Input(0), desc);
+    program.Arithmetic(OpCode::Id::SLT, Temp(1), Input(0), Input(1), desc);
+    program.Arithmetic(OpCode::Id::SGEI, Temp(2), Input(1), Uniform(1), desc);
+    program.Arithmetic(OpCode::Id::MUL, Output(0), Temp(0), Temp(1), desc);
+    program.Arithmetic(OpCode::Id::DP4, Output(1), Temp(0), Temp(2), desc);
+    // The addend of MAD is not multiplied
+    program.Mad(false, Output(2), Temp(1), Temp(2), Input(0), desc);
+    // Unlike a product with an input
+    program.Arithmetic(OpCode::Id::MUL, Output(3), Input(0), Temp(1), desc);
+    program.End();
+
+    REQUIRE_FALSE(IsSanitized(program, 3));
+    REQUIRE_FALSE(IsSanitized(program, 4));
+    REQUIRE_FALSE(IsSanitized(program, 5));
+    REQUIRE(IsSanitized(program, 6));
+}
@@ -0,0 +1,75 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/renderer_opengl/gl_surface_page_index.h"
+
+using namespace OpenGL;
+
+namespace {
+
+struct TestSurface {
+    u32 addr;
+    u32 end;
+};
+
+using TestSurfacePtr = std::shared_ptr<TestSurface>;
+using PageRuns = std::vector<std::pair<u32, u32>>;
+
+std::vector<TestSurfacePtr> Overlapping(const SurfacePageIndex<TestSurfacePtr>& index, u32 start,
+                                        u32 end) {
+    std::vector<TestSurfacePtr> result;
+    index.ForEachOverlapping(start, end,
+                             [&](const TestSurfacePtr& surface) { result.push_back(surface); });
+    return result;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SurfacePageIndex reports each overlapping surface once", "[video_core]") {
+    SurfacePageIndex<TestSurfacePtr> index;
+    const auto ignore = [](u32, u32) {};
+    const auto small = std::make_shared<TestSurface>(TestSurface{0x1800, 0x1900});
+    const auto large = std::make_shared<TestSurface>(TestSurface{0x1000, 0x5000});
+    index.Add(small, ignore);
+    index.Add(large, ignore);
+
+    REQUIRE(Overlapping(index, 0x0, 0x1000).empty());
+    REQUIRE(Overlapping(index, 0x1900, 0x2000) == std::vector<TestSurfacePtr>{large});
+    REQUIRE(Overlapping(index, 0x4000, 0x4100) == std::vector<TestSurfacePtr>{large});
+    REQUIRE(Overlapping(index, 0x5000, 0x6000).empty());
+
+    const auto all = Overlapping(index, 0x0, 0xFFFFFFFF);
+    REQUIRE(all.size() == 2);
+
+    index.Remove(large, ignore);
+    REQUIRE(Overlapping(index, 0x1000, 0x5000) == std::vector<TestSurfacePtr>{small});
+    REQUIRE(index.Front() == small);
+}
+
+TEST_CASE("SurfacePageIndex reports runs of cached pages", "[video_core]") {
+    SurfacePageIndex<TestSurfacePtr> index;
+    PageRuns cached;
+    PageRuns uncached;
+    const auto on_cached = [&](u32 addr, u32 size) { cached.emplace_back(addr, size); };
+    const auto on_uncached = [&](u32 addr, u32 size) { uncached.emplace_back(addr, size); };
+
+    const auto middle = std::make_shared<TestSurface>(TestSurface{0x2000, 0x3000});
+    const auto wide = std::make_shared<TestSurface>(TestSurface{0x1000, 0x4800});
+    index.Add(middle, on_cached);
+    index.Add(wide, on_cached);
+    REQUIRE(cached == PageRuns{{0x2000, 0x1000}, {0x1000, 0x1000}, {0x3000, 0x2000}});
+
+    index.Remove(wide, on_uncached);
+    REQUIRE(uncached == PageRuns{{0x1000, 0x1000}, {0x3000, 0x2000}});
+
+    uncached.clear();
+    index.Add(wide, on_cached);
+    index.Clear(on_uncached);
+    REQUIRE(uncached == PageRuns{{0x1000, 0x4000}});
+    REQUIRE(index.Empty());
+}
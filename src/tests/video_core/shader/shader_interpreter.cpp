@@ -0,0 +1,98 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/shader/shader_interpreter.h"
+
+using float24 = Pica::float24;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+namespace {
+
+class ShaderTest {
+public:
+    explicit ShaderTest(std::initializer_list<nihstro::InlineAsm> code) {
+        const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+        std::transform(shbin.program.begin(), shbin.program.end(),
+                       shader_setup.program_code.begin(), [](const auto& x) { return x.hex; });
+        std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                       shader_setup.swizzle_data.begin(), [](const auto& x) { return x.hex; });
+        engine.SetupBatch(shader_setup, 0);
+    }
+
+    float Run(float a, float b) {
+        Pica::Shader::UnitState shader_unit;
+        shader_unit.registers.input[0].x = float24::FromFloat32(a);
+        shader_unit.registers.input[1].x = float24::FromFloat32(b);
+        engine.Run(shader_setup, shader_unit);
+        return shader_unit.registers.output[0].x.ToFloat32();
+    }
+
+private:
+    Pica::Shader::ShaderSetup shader_setup{};
+    Pica::Shader::InterpreterEngine engine;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("MUL", "[video_core][shader][shader_interpreter]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MUL, sh_output, sh_input1, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run(2.f, 3.f) == 6.f);
+    // PICA gives 0 instead of NaN when multiplying by inf
+    REQUIRE(shader.Run(0.f, INFINITY) == 0.f);
+    REQUIRE(shader.Run(INFINITY, 0.f) == 0.f);
+    REQUIRE(std::isnan(shader.Run(NAN, 1.f)));
+}
+
+TEST_CASE("MAX", "[video_core][shader][shader_interpreter]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MAX, sh_output, sh_input1, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run(1.f, 2.f) == 2.f);
+    REQUIRE(shader.Run(2.f, 1.f) == 2.f);
+    REQUIRE(std::isnan(shader.Run(0.f, NAN)));
+    REQUIRE(shader.Run(NAN, 0.f) == 0.f);
+}
+
+TEST_CASE("SGE", "[video_core][shader][shader_interpreter]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::SGE, sh_output, sh_input1, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run(2.f, 1.f) == 1.f);
+    REQUIRE(shader.Run(1.f, 1.f) == 1.f);
+    REQUIRE(shader.Run(0.f, 1.f) == 0.f);
+    REQUIRE(shader.Run(NAN, 1.f) == 0.f);
+}
@@ -0,0 +1,519 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/shader/shader_interpreter.h"
+#include "video_core/shader/shader_jit_a64.h"
+#include "tests/video_core/shader/shader_test_common.h"
+#include "video_core/shader/shader_jit_a64_compiler.h"
+
+using float24 = Pica::float24;
+using JitShader = Pica::Shader::JitShader;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::InlineAsm> code) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+    std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
+    std::array<u32, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH> swizzle_data{};
+
+    std::transform(shbin.program.begin(), shbin.program.end(), program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
+                   [](const auto& x) { return x.hex; });
+
+    auto shader = std::make_unique<JitShader>();
+    shader->Compile(&program_code, &swizzle_data);
+
+    return shader;
+}
+
+class ShaderTest {
+public:
+    explicit ShaderTest(std::initializer_list<nihstro::InlineAsm> code)
+        : shader(CompileShader(code)) {}
+
+    float Run(float input, float uniform = 0.f) {
+        Pica::Shader::ShaderSetup shader_setup;
+        Pica::Shader::UnitState shader_unit;
+
+        shader_setup.uniforms.f[0].x = float24::FromFloat32(uniform);
+        shader_unit.registers.input[0].x = float24::FromFloat32(input);
+        shader->Run(shader_setup, shader_unit, 0);
+        return shader_unit.registers.output[0].x.ToFloat32();
+    }
+
+public:
+    std::unique_ptr<JitShader> shader;
+};
+
+TEST_CASE("LG2", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::LG2, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(std::isnan(shader.Run(NAN)));
+    REQUIRE(std::isnan(shader.Run(-1.f)));
+    REQUIRE(std::isinf(shader.Run(0.f)));
+    REQUIRE(shader.Run(4.f) == Approx(2.f));
+    REQUIRE(shader.Run(64.f) == Approx(6.f));
+    REQUIRE(shader.Run(1.e24f) == Approx(79.7262742773f));
+}
+
+TEST_CASE("EX2", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::EX2, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(std::isnan(shader.Run(NAN)));
+    REQUIRE(shader.Run(-800.f) == Approx(0.f));
+    REQUIRE(shader.Run(0.f) == Approx(1.f));
+    REQUIRE(shader.Run(2.f) == Approx(4.f));
+    REQUIRE(shader.Run(6.f) == Approx(64.f));
+    REQUIRE(shader.Run(79.7262742773f) == Approx(1.e24f));
+    REQUIRE(std::isinf(shader.Run(800.f)));
+}
+
+TEST_CASE("MUL", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_uniform = SourceRegister::MakeFloat(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MUL, sh_output, sh_input, sh_uniform},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run(2.f, 3.f) == Approx(6.f));
+    // The PICA returns zero instead of NaN when multiplying zero by infinity
+    REQUIRE(shader.Run(0.f, INFINITY) == 0.f);
+    REQUIRE(shader.Run(INFINITY, 0.f) == 0.f);
+    REQUIRE(std::isinf(shader.Run(INFINITY, 1.f)));
+    REQUIRE(std::isnan(shader.Run(NAN, 1.f)));
+}
+
+TEST_CASE("MAX", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_uniform = SourceRegister::MakeFloat(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MAX, sh_output, sh_input, sh_uniform},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run(1.f, 2.f) == 2.f);
+    REQUIRE(shader.Run(2.f, 1.f) == 2.f);
+    // The second source is returned if either of them is NaN
+    REQUIRE(shader.Run(NAN, 1.f) == 1.f);
+    REQUIRE(std::isnan(shader.Run(1.f, NAN)));
+}
+
+namespace {
+
+using namespace ShaderTests;
+
+using Vec4f24 = Common::Vec4<float24>;
+using Registers = std::array<Vec4f24, 16>;
+
+Vec4f24 MakeVec4(float x, float y, float z, float w) {
+    return {float24::FromFloat32(x), float24::FromFloat32(y), float24::FromFloat32(z),
+            float24::FromFloat32(w)};
+}
+
+bool SameValue(float24 lhs, float24 rhs) {
+    const float a = lhs.ToFloat32();
+    const float b = rhs.ToFloat32();
+    return std::isnan(a) ? std::isnan(b) : a == b;
+}
+
+void RequireVec4(const Vec4f24& value, float x, float y, float z, float w) {
+    const std::array<float, 4> expected{x, y, z, w};
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(SameValue(value[i], float24::FromFloat32(expected[i])));
+    }
+}
+
+/**
+ * Runs the program from offset 0 on the interpreter and on the JIT, and requires the same output
+ * and temporary registers from both. Returns the outputs of the interpreter.
+ */
+Registers RunOnBothEngines(const Pica::Shader::ShaderSetup& setup, const Registers& inputs) {
+    Pica::Shader::ShaderSetup interpreter_setup = setup;
+    Pica::Shader::ShaderSetup jit_setup = setup;
+    Pica::Shader::InterpreterEngine interpreter;
+    Pica::Shader::JitA64Engine jit;
+    interpreter.SetupBatch(interpreter_setup, 0);
+    jit.SetupBatch(jit_setup, 0);
+
+    Pica::Shader::UnitState expected;
+    Pica::Shader::UnitState result;
+    for (Pica::Shader::UnitState* state : {&expected, &result}) {
+        state->registers = {};
+        std::copy(inputs.begin(), inputs.end(), state->registers.input);
+        std::fill(std::begin(state->address_registers), std::end(state->address_registers), 0);
+    }
+    interpreter.Run(interpreter_setup, expected);
+    jit.Run(jit_setup, result);
+
+    Registers outputs;
+    for (std::size_t reg = 0; reg < outputs.size(); ++reg) {
+        for (std::size_t i = 0; i < 4; ++i) {
+            INFO("register " << reg << " component " << i);
+            REQUIRE(SameValue(expected.registers.output[reg][i], result.registers.output[reg][i]));
+            REQUIRE(SameValue(expected.registers.temporary[reg][i],
+                              result.registers.temporary[reg][i]));
+        }
+        outputs[reg] = expected.registers.output[reg];
+    }
+    return outputs;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CALL, CALLU and CALLC match the interpreter", "[video_core][shader][shader_jit]") {
+    const auto all = "xyzw";
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor(all);
+    program.Arithmetic(OpCode::Id::MOV, Output(0), Uniform(0), 0, desc);
+    program.Flow(OpCode::Id::CALL, 6, 2);
+    program.Flow(OpCode::Id::CALLU, 8, 1, 0);
+    program.Cmp(Compare::GreaterThan, Compare::Equal, Uniform(0), Input(0), desc);
+    program.FlowIf(OpCode::Id::CALLC, Condition::And, true, false, 9, 1);
+    program.End();
+    // 6: o1 = c0 * (c1 + v0)
+    program.Arithmetic(OpCode::Id::ADD, Temp(0), Uniform(1), Input(0), desc);
+    program.Arithmetic(OpCode::Id::MUL, Output(1), Uniform(0), Temp(0), desc);
+    // 8: o2 = c1
+    program.Arithmetic(OpCode::Id::MOV, Output(2), Uniform(1), 0, desc);
+    // 9: o3 = v0
+    program.Arithmetic(OpCode::Id::MOV, Output(3), Input(0), 0, desc);
+
+    std::array<Vec4f24, 96> uniforms{};
+    uniforms[0] = MakeVec4(1.f, 2.f, 3.f, 4.f);
+    uniforms[1] = MakeVec4(10.f, 20.f, 30.f, 40.f);
+
+    for (const bool b0 : {false, true}) {
+        for (const auto& v0 : {MakeVec4(0.f, 3.f, 5.f, 7.f), MakeVec4(0.f, 2.f, 5.f, 7.f),
+                               MakeVec4(4.f, 3.f, -5.f, 0.5f)}) {
+            auto setup = program.Build(uniforms);
+            setup.uniforms.b[0] = b0;
+            const Registers outputs = RunOnBothEngines(setup, {v0});
+
+            const float x = v0.x.ToFloat32();
+            const float y = v0.y.ToFloat32();
+            RequireVec4(outputs[0], 1.f, 2.f, 3.f, 4.f);
+            RequireVec4(outputs[1], 10.f + x, 2.f * (20.f + y), 3.f * (30.f + v0.z.ToFloat32()),
+                        4.f * (40.f + v0.w.ToFloat32()));
+            if (b0) {
+                RequireVec4(outputs[2], 10.f, 20.f, 30.f, 40.f);
+            } else {
+                RequireVec4(outputs[2], 0.f, 0.f, 0.f, 0.f);
+            }
+            if (x < 1.f && y != 2.f) {
+                RequireVec4(outputs[3], x, y, v0.z.ToFloat32(), v0.w.ToFloat32());
+            } else {
+                RequireVec4(outputs[3], 0.f, 0.f, 0.f, 0.f);
+            }
+        }
+    }
+}
+
+TEST_CASE("IFU, IFC, JMPU and JMPC match the interpreter", "[video_core][shader][shader_jit]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    // 0: if b0 { o0 = c0; o1 = c0 } else { o0 = c1 }
+    program.Flow(OpCode::Id::IFU, 3, 1, 0);
+    program.Arithmetic(OpCode::Id::MOV, Output(0), Uniform(0), 0, desc);
+    program.Arithmetic(OpCode::Id::MOV, Output(1), Uniform(0), 0, desc);
+    program.Arithmetic(OpCode::Id::MOV, Output(0), Uniform(1), 0, desc);
+    // 4: if c0.x <= v0.x || c0.y != v0.y { o2 = v0 } else { o2 = c1 }
+    program.Cmp(Compare::LessEqual, Compare::NotEqual, Uniform(0), Input(0), desc);
+    program.FlowIf(OpCode::Id::IFC, Condition::Or, true, true, 7, 1);
+    program.Arithmetic(OpCode::Id::MOV, Output(2), Input(0), 0, desc);
+    program.Arithmetic(OpCode::Id::MOV, Output(2), Uniform(1), 0, desc);
+    // 8: o3 = c0 unless b1
+    program.Flow(OpCode::Id::JMPU, 10, 0, 1);
+    program.Arithmetic(OpCode::Id::MOV, Output(3), Uniform(0), 0, desc);
+    // 10: o4 = c1 unless c0.y == v0.y
+    program.FlowIf(OpCode::Id::JMPC, Condition::JustY, false, false, 12);
+    program.Arithmetic(OpCode::Id::MOV, Output(4), Uniform(1), 0, desc);
+    program.End();
+
+    std::array<Vec4f24, 96> uniforms{};
+    uniforms[0] = MakeVec4(1.f, 2.f, 3.f, 4.f);
+    uniforms[1] = MakeVec4(10.f, 20.f, 30.f, 40.f);
+
+    for (const bool b0 : {false, true}) {
+        for (const bool b1 : {false, true}) {
+            for (const auto& v0 : {MakeVec4(0.f, 2.f, 0.f, 0.f), MakeVec4(1.f, 2.f, 0.f, 0.f),
+                                   MakeVec4(0.f, 3.f, 0.f, 0.f)}) {
+                auto setup = program.Build(uniforms);
+                setup.uniforms.b[0] = b0;
+                setup.uniforms.b[1] = b1;
+                const Registers outputs = RunOnBothEngines(setup, {v0});
+
+                const float x = v0.x.ToFloat32();
+                const float y = v0.y.ToFloat32();
+                REQUIRE(outputs[0].x.ToFloat32() == (b0 ? 1.f : 10.f));
+                REQUIRE(outputs[1].x.ToFloat32() == (b0 ? 1.f : 0.f));
+                REQUIRE(outputs[2].x.ToFloat32() == (1.f <= x || 2.f != y ? x : 10.f));
+                REQUIRE(outputs[3].x.ToFloat32() == (b1 ? 0.f : 1.f));
+                REQUIRE(outputs[4].x.ToFloat32() == (y == 2.f ? 0.f : 10.f));
+            }
+        }
+    }
+}
+
+TEST_CASE("CMP conditions match the interpreter", "[video_core][shader][shader_jit]") {
+    const auto compare = [](Compare op, float a, float b) {
+        switch (op) {
+        case Compare::Equal:
+            return a == b;
+        case Compare::NotEqual:
+            return a != b;
+        case Compare::LessThan:
+            return a < b;
+        case Compare::LessEqual:
+            return a <= b;
+        case Compare::GreaterThan:
+            return a > b;
+        case Compare::GreaterEqual:
+            return a >= b;
+        }
+        return false;
+    };
+
+    std::array<Vec4f24, 96> uniforms{};
+    uniforms[0] = MakeVec4(1.f, 2.f, 0.f, 0.f);
+    uniforms[1] = MakeVec4(10.f, 10.f, 10.f, 10.f);
+
+    for (u32 x_op = 0; x_op < 6; ++x_op) {
+        for (u32 y_op = 0; y_op < 6; ++y_op) {
+            ProgramBuilder program;
+            const u32 desc = program.Descriptor("xyzw");
+            program.Cmp(static_cast<Compare>(x_op), static_cast<Compare>(y_op), Uniform(0),
+                        Input(0), desc);
+            // Each output is set unless its condition holds
+            program.FlowIf(OpCode::Id::JMPC, Condition::Or, true, true, 3);
+            program.Arithmetic(OpCode::Id::MOV, Output(0), Uniform(1), 0, desc);
+            program.FlowIf(OpCode::Id::JMPC, Condition::And, true, true, 5);
+            program.Arithmetic(OpCode::Id::MOV, Output(1), Uniform(1), 0, desc);
+            program.FlowIf(OpCode::Id::JMPC, Condition::JustX, false, false, 7);
+            program.Arithmetic(OpCode::Id::MOV, Output(2), Uniform(1), 0, desc);
+            program.FlowIf(OpCode::Id::JMPC, Condition::JustY, false, false, 9);
+            program.Arithmetic(OpCode::Id::MOV, Output(3), Uniform(1), 0, desc);
+            program.End();
+            const auto setup = program.Build(uniforms);
+
+            for (const auto& v0 : {MakeVec4(0.f, 2.f, 0.f, 0.f), MakeVec4(1.f, 3.f, 0.f, 0.f),
+                                   MakeVec4(2.f, 1.f, 0.f, 0.f), MakeVec4(NAN, 2.f, 0.f, 0.f),
+                                   MakeVec4(-INFINITY, INFINITY, 0.f, 0.f)}) {
+                INFO("x op " << x_op << " y op " << y_op);
+                const Registers outputs = RunOnBothEngines(setup, {v0});
+
+                const bool cx = compare(static_cast<Compare>(x_op), 1.f, v0.x.ToFloat32());
+                const bool cy = compare(static_cast<Compare>(y_op), 2.f, v0.y.ToFloat32());
+                REQUIRE(outputs[0].x.ToFloat32() == (cx || cy ? 0.f : 10.f));
+                REQUIRE(outputs[1].x.ToFloat32() == (cx && cy ? 0.f : 10.f));
+                REQUIRE(outputs[2].x.ToFloat32() == (!cx ? 0.f : 10.f));
+                REQUIRE(outputs[3].x.ToFloat32() == (!cy ? 0.f : 10.f));
+            }
+        }
+    }
+}
+
+TEST_CASE("LOOP and aL indexing match the interpreter", "[video_core][shader][shader_jit]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    // 0: r0 += c[aL] for the first loop, r1 += c[aL] + v0 for the second one
+    program.Flow(OpCode::Id::LOOP, 1, 0, 0);
+    program.Arithmetic(OpCode::Id::ADD, Temp(0), Uniform(0), Temp(0), desc, AddressOffset::AL);
+    program.Flow(OpCode::Id::LOOP, 4, 0, 1);
+    program.Arithmetic(OpCode::Id::ADD, Temp(1), Uniform(0), Temp(1), desc, AddressOffset::AL);
+    program.Arithmetic(OpCode::Id::ADD, Temp(1), Temp(1), Input(0), desc);
+    program.Arithmetic(OpCode::Id::MOV, Output(0), Temp(0), 0, desc);
+    program.Arithmetic(OpCode::Id::MOV, Output(1), Temp(1), 0, desc);
+    program.End();
+
+    std::array<Vec4f24, 96> uniforms{};
+    for (u32 i = 0; i < 16; ++i) {
+        const float value = static_cast<float>(i + 1);
+        uniforms[i] = MakeVec4(value, 2.f * value, -value, 0.5f * value);
+    }
+
+    // Count minus one, initial aL and aL increment of both loops
+    const std::array<std::array<Common::Vec4<u8>, 2>, 3> loops{{
+        {Common::Vec4<u8>{3, 0, 1, 0}, Common::Vec4<u8>{4, 1, 2, 0}},
+        {Common::Vec4<u8>{0, 5, 1, 0}, Common::Vec4<u8>{2, 0, 3, 0}},
+        {Common::Vec4<u8>{15, 0, 1, 0}, Common::Vec4<u8>{0, 15, 0, 0}},
+    }};
+    for (const auto& [first, second] : loops) {
+        auto setup = program.Build(uniforms);
+        setup.uniforms.i[0] = first;
+        setup.uniforms.i[1] = second;
+        const Registers outputs = RunOnBothEngines(setup, {MakeVec4(0.25f, 0.f, 1.f, -1.f)});
+
+        float first_sum = 0.f;
+        for (u32 i = 0; i <= first.x; ++i) {
+            first_sum += static_cast<float>(first.y + i * first.z + 1);
+        }
+        float second_sum = 0.f;
+        for (u32 i = 0; i <= second.x; ++i) {
+            second_sum += static_cast<float>(second.y + i * second.z + 1) + 0.25f;
+        }
+        REQUIRE(outputs[0].x.ToFloat32() == first_sum);
+        REQUIRE(outputs[1].x.ToFloat32() == second_sum);
+    }
+}
+
+TEST_CASE("MOVA and relative addressing match the interpreter",
+          "[video_core][shader][shader_jit]") {
+    ProgramBuilder program;
+    const u32 desc = program.Descriptor("xyzw");
+    program.Mova(Input(0), program.Descriptor("xy"));
+    program.Arithmetic(OpCode::Id::MOV, Output(0), Uniform(8), 0, desc, AddressOffset::A0X);
+    program.Arithmetic(OpCode::Id::MOV, Output(1), Uniform(8), 0, desc, AddressOffset::A0Y);
+    program.Arithmetic(OpCode::Id::ADD, Output(2), Uniform(8), Input(1), desc,
+                       AddressOffset::A0X);
+    // The inverted opcodes offset their second source
+    program.Arithmetic(OpCode::Id::SGEI, Output(3), Input(1), Uniform(8), desc,
+                       AddressOffset::A0Y);
+    program.End();
+
+    std::array<Vec4f24, 96> uniforms{};
+    for (u32 i = 0; i < 16; ++i) {
+        uniforms[i] = MakeVec4(static_cast<float>(i), 0.f, 0.f, 0.f);
+    }
+    const auto setup = program.Build(uniforms);
+
+    for (const auto& [x, y] : std::array<std::pair<float, float>, 4>{
+             {{0.f, 0.f}, {2.7f, -1.2f}, {3.9f, 5.5f}, {-3.5f, 1.f}}}) {
+        const Registers outputs =
+            RunOnBothEngines(setup, {MakeVec4(x, y, 0.f, 0.f), MakeVec4(5.f, 0.f, 0.f, 0.f)});
+
+        const float a0x = static_cast<float>(8 + static_cast<s32>(x));
+        const float a0y = static_cast<float>(8 + static_cast<s32>(y));
+        REQUIRE(outputs[0].x.ToFloat32() == a0x);
+        REQUIRE(outputs[1].x.ToFloat32() == a0y);
+        REQUIRE(outputs[2].x.ToFloat32() == a0x + 5.f);
+        REQUIRE(outputs[3].x.ToFloat32() == (5.f >= a0y ? 1.f : 0.f));
+    }
+}
+
+TEST_CASE("Random arithmetic programs match the interpreter", "[video_core][shader][shader_jit]") {
+    // LG2 and EX2 are left out, as the JIT approximates them
+    constexpr std::array opcodes{
+        OpCode::Id::ADD, OpCode::Id::DP3,  OpCode::Id::DP4,  OpCode::Id::DPH,  OpCode::Id::DPHI,
+        OpCode::Id::MUL, OpCode::Id::SGE,  OpCode::Id::SGEI, OpCode::Id::SLT,  OpCode::Id::SLTI,
+        OpCode::Id::FLR, OpCode::Id::MAX,  OpCode::Id::MIN,  OpCode::Id::RCP,  OpCode::Id::RSQ,
+        OpCode::Id::MOV, OpCode::Id::MAD,  OpCode::Id::MADI, OpCode::Id::CMP,
+    };
+    constexpr std::array special_values{0.f,  -0.f,     1.f,       -1.f,      0.5f, -2.5f,
+                                        1e10f, -1e10f, INFINITY, -INFINITY, NAN};
+    constexpr std::string_view components = "xyzw";
+
+    std::mt19937 rng{0x5A5A};
+    const auto random = [&rng](u32 bound) {
+        return std::uniform_int_distribution<u32>{0, bound - 1}(rng);
+    };
+    const auto random_value = [&] {
+        return random(2) == 0 ? special_values[random(special_values.size())]
+                              : std::uniform_real_distribution<float>{-8.f, 8.f}(rng);
+    };
+    const auto random_vec4 = [&] {
+        return MakeVec4(random_value(), random_value(), random_value(), random_value());
+    };
+    const auto random_swizzle = [&] {
+        std::string swizzle = random(4) == 0 ? "-" : "";
+        for (int i = 0; i < 4; ++i) {
+            swizzle += components[random(4)];
+        }
+        return swizzle;
+    };
+    // Sources that fit the 5 bit fields, and those that may also be a uniform
+    const auto narrow_source = [&] { return random(2) == 0 ? Input(random(4)) : Temp(random(8)); };
+    const auto wide_source = [&] { return random(3) == 0 ? Uniform(random(16)) : narrow_source(); };
+    const auto dest = [&] { return random(2) == 0 ? Output(random(4)) : Temp(random(8)); };
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        INFO("program " << iteration);
+        ProgramBuilder program;
+        std::vector<u32> descriptors;
+        for (int i = 0; i < 32; ++i) {
+            std::string mask;
+            while (mask.empty()) {
+                for (const char component : components) {
+                    if (random(2) == 0) {
+                        mask += component;
+                    }
+                }
+            }
+            descriptors.push_back(
+                program.Descriptor(mask, random_swizzle(), random_swizzle(), random_swizzle()));
+        }
+
+        const u32 length = 8 + random(24);
+        while (program.Here() < length) {
+            const OpCode::Id opcode = opcodes[random(opcodes.size())];
+            const u32 desc = descriptors[random(descriptors.size())];
+            if (opcode == OpCode::Id::MAD || opcode == OpCode::Id::MADI) {
+                const bool inverted = opcode == OpCode::Id::MADI;
+                program.Mad(inverted, dest(), narrow_source(),
+                            inverted ? narrow_source() : wide_source(),
+                            inverted ? wide_source() : narrow_source(), desc);
+            } else if (opcode == OpCode::Id::CMP) {
+                if (program.Here() + 2 > length) {
+                    continue;
+                }
+                // Skips up to two of the instructions after the JMPC, depending on the result
+                const u32 target = std::min(program.Here() + 2 + random(3), length);
+                program.Cmp(static_cast<Compare>(random(6)), static_cast<Compare>(random(6)),
+                            wide_source(), narrow_source(), desc);
+                program.FlowIf(OpCode::Id::JMPC, static_cast<Condition>(random(4)),
+                               random(2) == 0, random(2) == 0, target);
+            } else if (opcode == OpCode::Id::DPHI || opcode == OpCode::Id::SGEI ||
+                       opcode == OpCode::Id::SLTI) {
+                program.Arithmetic(opcode, dest(), narrow_source(), wide_source(), desc);
+            } else {
+                program.Arithmetic(opcode, dest(), wide_source(), narrow_source(), desc);
+            }
+        }
+        program.End();
+
+        std::array<Vec4f24, 96> uniforms{};
+        std::generate_n(uniforms.begin(), 16, random_vec4);
+        const auto setup = program.Build(uniforms);
+        for (int run = 0; run < 4; ++run) {
+            RunOnBothEngines(setup, {random_vec4(), random_vec4(), random_vec4(), random_vec4()});
+        }
+    }
+}
@@ -7,16 +7,20 @@
 #include <memory>
 #include <catch2/catch.hpp>
 #include <nihstro/inline_assembly.h>
+#include "common/x64/cpu_detect.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
+#include "video_core/shader/shader_jit_x64_pair_compiler.h"
 
 using float24 = Pica::float24;
 using JitShader = Pica::Shader::JitShader;
+using JitPairShader = Pica::Shader::JitPairShader;
 
 using DestRegister = nihstro::DestRegister;
 using OpCode = nihstro::OpCode;
 using SourceRegister = nihstro::SourceRegister;
 
-static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::InlineAsm> code) {
+template <typename Shader = JitShader>
+static std::unique_ptr<Shader> CompileShader(std::initializer_list<nihstro::InlineAsm> code) {
     const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
 
     std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
@@ -27,7 +31,7 @@ static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::I
     std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
                    [](const auto& x) { return x.hex; });
 
-    auto shader = std::make_unique<JitShader>();
+    auto shader = std::make_unique<Shader>();
     shader->Compile(&program_code, &swizzle_data);
 
     return shader;
@@ -89,3 +93,49 @@ TEST_CASE("EX2", "[video_core][shader][shader_jit]") {
     REQUIRE(shader.Run(79.7262742773f) == Approx(1.e24f));
     REQUIRE(std::isinf(shader.Run(800.f)));
 }
+
+TEST_CASE("Pair shader matches the scalar shader", "[video_core][shader][shader_jit]") {
+    if (!Common::GetCPUCaps().avx2) {
+        return;
+    }
+
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_output1 = DestRegister::MakeOutput(0);
+    const auto sh_output2 = DestRegister::MakeOutput(1);
+    const std::initializer_list<nihstro::InlineAsm> code = {
+        // clang-format off
+        {OpCode::Id::MUL, sh_output1, sh_input1, sh_input2},
+        {OpCode::Id::DP4, sh_output2, sh_input1, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    };
+    const auto shader = CompileShader(code);
+    const auto pair_shader = CompileShader<JitPairShader>(code);
+
+    // Includes 0 * inf, which the PICA multiplies to 0
+    const std::array<float, 8> values = {0.f, INFINITY, -2.f, 3.5f, 1.e20f, NAN, 0.25f, -0.f};
+    Pica::Shader::ShaderSetup shader_setup;
+    Pica::Shader::UnitState shader_unit;
+    Pica::Shader::PairUnitState pair_unit(shader_unit);
+    for (std::size_t i = 0; i < 4; ++i) {
+        for (std::size_t vertex = 0; vertex < 2; ++vertex) {
+            pair_unit.registers.input[0][vertex][i] = float24::FromFloat32(values[i + vertex]);
+            pair_unit.registers.input[1][vertex][i] = float24::FromFloat32(values[7 - i]);
+        }
+    }
+    REQUIRE(pair_shader->Run(shader_setup, pair_unit, 0));
+
+    for (std::size_t vertex = 0; vertex < 2; ++vertex) {
+        shader_unit.registers.input[0] = pair_unit.registers.input[0][vertex];
+        shader_unit.registers.input[1] = pair_unit.registers.input[1][vertex];
+        shader->Run(shader_setup, shader_unit, 0);
+        for (std::size_t reg = 0; reg < 2; ++reg) {
+            for (std::size_t i = 0; i < 4; ++i) {
+                const float expected = shader_unit.registers.output[reg][i].ToFloat32();
+                const float result = pair_unit.registers.output[reg][vertex][i].ToFloat32();
+                REQUIRE((std::isnan(expected) ? std::isnan(result) : result == expected));
+            }
+        }
+    }
+}
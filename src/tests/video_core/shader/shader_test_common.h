@@ -0,0 +1,143 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <nihstro/shader_bytecode.h>
+#include "common/common_types.h"
+#include "video_core/shader/shader.h"
+
+namespace ShaderTests {
+
+using OpCode = nihstro::OpCode;
+
+// Register fields as the instructions encode them
+constexpr u32 Input(u32 index) {
+    return index;
+}
+constexpr u32 Temp(u32 index) {
+    return 0x10 + index;
+}
+constexpr u32 Uniform(u32 index) {
+    return 0x20 + index;
+}
+constexpr u32 Output(u32 index) {
+    return index;
+}
+
+enum class AddressOffset : u32 { None, A0X, A0Y, AL };
+enum class Compare : u32 { Equal, NotEqual, LessThan, LessEqual, GreaterThan, GreaterEqual };
+enum class Condition : u32 { Or, And, JustX, JustY };
+
+/**
+ * Encodes programs word by word. The inline assembler only covers arithmetic on whole registers,
+ * while these tests also need flow control, comparisons, MAD, swizzles and relative addressing.
+ */
+class ProgramBuilder {
+public:
+    /// Adds an operand descriptor. Swizzles are written as in assembly, with an optional '-'.
+    u32 Descriptor(std::string_view dest_mask, std::string_view src1 = "xyzw",
+                   std::string_view src2 = "xyzw", std::string_view src3 = "xyzw") {
+        u32 hex = EncodeSwizzle(src1) << 4 | EncodeSwizzle(src2) << 13 | EncodeSwizzle(src3) << 22;
+        for (const char component : dest_mask) {
+            hex |= 1u << (3 - ComponentIndex(component));
+        }
+        const auto it = std::find(swizzle_data.begin(), swizzle_data.end(), hex);
+        if (it != swizzle_data.end()) {
+            return static_cast<u32>(it - swizzle_data.begin());
+        }
+        swizzle_data.push_back(hex);
+        return static_cast<u32>(swizzle_data.size() - 1);
+    }
+
+    /// Offset of the next instruction
+    u32 Here() const {
+        return static_cast<u32>(program_code.size());
+    }
+
+    /// Only the first source, or the second one of DPHI, SGEI and SLTI, can be a uniform
+    void Arithmetic(OpCode::Id opcode, u32 dest, u32 src1, u32 src2, u32 desc,
+                    AddressOffset offset = AddressOffset::None) {
+        const bool inverted = opcode == OpCode::Id::DPHI || opcode == OpCode::Id::SGEI ||
+                              opcode == OpCode::Id::SLTI;
+        Emit(Op(opcode) | dest << 21 | static_cast<u32>(offset) << 19 |
+             (inverted ? src1 << 14 : src1 << 12) | src2 << 7 | desc);
+    }
+
+    /// Only the second source of MAD, or the third one of MADI, can be a uniform
+    void Mad(bool inverted, u32 dest, u32 src1, u32 src2, u32 src3, u32 desc) {
+        REQUIRE(desc < 0x20);
+        Emit(Op(inverted ? OpCode::Id::MADI : OpCode::Id::MAD) | dest << 24 | src1 << 17 |
+             (inverted ? src2 << 12 : src2 << 10) | src3 << 5 | desc);
+    }
+
+    /// Only the first source can be a uniform
+    void Cmp(Compare x, Compare y, u32 src1, u32 src2, u32 desc) {
+        Emit(Op(OpCode::Id::CMP) | static_cast<u32>(x) << 24 | static_cast<u32>(y) << 21 |
+             src1 << 12 | src2 << 7 | desc);
+    }
+
+    void Mova(u32 src1, u32 desc) {
+        Emit(Op(OpCode::Id::MOVA) | src1 << 12 | desc);
+    }
+
+    /// CALL, LOOP, and the CALLU, IFU and JMPU instructions along with their uniform
+    void Flow(OpCode::Id opcode, u32 dest_offset, u32 num_instructions = 0, u32 uniform = 0) {
+        Emit(Op(opcode) | uniform << 22 | dest_offset << 10 | num_instructions);
+    }
+
+    /// CALLC, IFC and JMPC, which test the results of the last CMP
+    void FlowIf(OpCode::Id opcode, Condition condition, bool refx, bool refy, u32 dest_offset,
+                u32 num_instructions = 0) {
+        Emit(Op(opcode) | static_cast<u32>(refx) << 25 | static_cast<u32>(refy) << 24 |
+             static_cast<u32>(condition) << 22 | dest_offset << 10 | num_instructions);
+    }
+
+    void End() {
+        Emit(Op(OpCode::Id::END));
+    }
+
+    Pica::Shader::ShaderSetup Build(
+        const std::array<Common::Vec4<Pica::float24>, 96>& float_uniforms = {}) const {
+        Pica::Shader::ShaderSetup setup{};
+        std::copy(program_code.begin(), program_code.end(), setup.program_code.begin());
+        std::copy(swizzle_data.begin(), swizzle_data.end(), setup.swizzle_data.begin());
+        std::copy(float_uniforms.begin(), float_uniforms.end(), setup.uniforms.f);
+        return setup;
+    }
+
+private:
+    static u32 Op(OpCode::Id opcode) {
+        return static_cast<u32>(opcode) << 26;
+    }
+
+    static u32 ComponentIndex(char component) {
+        return static_cast<u32>(std::string_view{"xyzw"}.find(component));
+    }
+
+    /// Negation flag followed by the selectors, the first one in the top bits
+    static u32 EncodeSwizzle(std::string_view swizzle) {
+        const bool negate = !swizzle.empty() && swizzle[0] == '-';
+        swizzle.remove_prefix(negate ? 1 : 0);
+        u32 hex = negate ? 1 : 0;
+        for (u32 i = 0; i < 4; ++i) {
+            hex |= ComponentIndex(swizzle[i]) << (7 - 2 * i);
+        }
+        return hex;
+    }
+
+    void Emit(u32 instruction) {
+        program_code.push_back(instruction);
+    }
+
+    std::vector<u32> program_code;
+    std::vector<u32> swizzle_data;
+};
+
+} // namespace ShaderTests
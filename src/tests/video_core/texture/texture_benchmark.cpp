@@ -0,0 +1,91 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "tests/benchmark.h"
+#include "video_core/texture/texture_decode.h"
+
+using namespace Pica::Texture;
+using TextureFormat = Pica::TexturingRegs::TextureFormat;
+
+TEST_CASE("Texture decode benchmark", "[.][benchmark][video_core][texture]") {
+    constexpr u32 size = 128;
+
+    std::mt19937 rng(0x7E3B);
+    std::uniform_int_distribution<unsigned> byte(0, 255);
+    // Large enough for the 4 bytes per texel of RGBA8
+    std::vector<u8> texture(size * size * 4);
+    for (u8& value : texture) {
+        value = static_cast<u8>(byte(rng));
+    }
+
+    constexpr std::array<std::pair<TextureFormat, std::string_view>, 14> formats{{
+        {TextureFormat::RGBA8, "RGBA8"},
+        {TextureFormat::RGB8, "RGB8"},
+        {TextureFormat::RGB5A1, "RGB5A1"},
+        {TextureFormat::RGB565, "RGB565"},
+        {TextureFormat::RGBA4, "RGBA4"},
+        {TextureFormat::IA8, "IA8"},
+        {TextureFormat::RG8, "RG8"},
+        {TextureFormat::I8, "I8"},
+        {TextureFormat::A8, "A8"},
+        {TextureFormat::IA4, "IA4"},
+        {TextureFormat::I4, "I4"},
+        {TextureFormat::A4, "A4"},
+        {TextureFormat::ETC1, "ETC1"},
+        {TextureFormat::ETC1A4, "ETC1A4"},
+    }};
+
+    for (const auto& [format, name] : formats) {
+        TextureInfo info{};
+        info.width = size;
+        info.height = size;
+        info.format = format;
+        info.SetDefaultStride();
+        const std::size_t tile_size = CalculateTileSize(format);
+
+        Benchmark::Run(fmt::format("LookupTexture {} {}x{}", name, size, size), 100, [&] {
+            u32 sum = 0;
+            for (u32 y = 0; y < size; ++y) {
+                for (u32 x = 0; x < size; ++x) {
+                    sum += LookupTexture(texture.data(), x, y, info).r();
+                }
+            }
+            return sum;
+        });
+
+        Benchmark::Run(fmt::format("DecodeTile {} {}x{}", name, size, size), 100, [&] {
+            std::array<Common::Vec4<u8>, 64> texels;
+            u32 sum = 0;
+            for (u32 tile = 0; tile < size * size / 64; ++tile) {
+                DecodeTile(texture.data() + tile * tile_size, info, texels);
+                sum += texels[0].r();
+            }
+            return sum;
+        });
+    }
+
+    // The ETC1 decoder on its own, without the format dispatch of DecodeTile
+    for (const bool has_alpha : {false, true}) {
+        const std::size_t tile_size = has_alpha ? 128 : 64;
+        const auto decode_texture = [&] {
+            std::array<Common::Vec4<u8>, 64> texels;
+            u32 sum = 0;
+            for (u32 tile = 0; tile < size * size / 64; ++tile) {
+                DecodeETC1Tile(texture.data() + tile * tile_size, has_alpha, texels);
+                sum += texels[0].r();
+            }
+            return sum;
+        };
+        Benchmark::Run(
+            fmt::format("DecodeETC1Tile {} {}x{}", has_alpha ? "ETC1A4" : "ETC1", size, size), 100,
+            decode_texture);
+    }
+}
@@ -0,0 +1,49 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <catch2/catch.hpp>
+#include "video_core/texture/texture_decode.h"
+
+using namespace Pica::Texture;
+using TextureFormat = Pica::TexturingRegs::TextureFormat;
+
+TEST_CASE("DecodeTile matches LookupTexelInTile", "[video_core][texture]") {
+    std::mt19937 rng(0xE7C1);
+    std::uniform_int_distribution<unsigned> byte(0, 255);
+
+    for (const TextureFormat format :
+         {TextureFormat::RGBA8, TextureFormat::RGB8, TextureFormat::RGB5A1, TextureFormat::RGB565,
+          TextureFormat::RGBA4, TextureFormat::IA8, TextureFormat::RG8, TextureFormat::I8,
+          TextureFormat::A8, TextureFormat::IA4, TextureFormat::I4, TextureFormat::A4,
+          TextureFormat::ETC1, TextureFormat::ETC1A4}) {
+        TextureInfo info{};
+        info.width = 8;
+        info.height = 8;
+        info.format = format;
+        info.SetDefaultStride();
+
+        for (int iteration = 0; iteration < 64; ++iteration) {
+            std::array<u8, 256> tile;
+            for (u8& value : tile) {
+                value = static_cast<u8>(byte(rng));
+            }
+
+            std::array<Common::Vec4<u8>, 64> texels;
+            DecodeTile(tile.data(), info, texels);
+
+            for (unsigned y = 0; y < 8; ++y) {
+                for (unsigned x = 0; x < 8; ++x) {
+                    const auto expected = LookupTexelInTile(tile.data(), x, y, info, false);
+                    const auto& texel = texels[x + 8 * y];
+                    REQUIRE(texel.r() == expected.r());
+                    REQUIRE(texel.g() == expected.g());
+                    REQUIRE(texel.b() == expected.b());
+                    REQUIRE(texel.a() == expected.a());
+                }
+            }
+        }
+    }
+}
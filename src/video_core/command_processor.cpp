@@ -2,11 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstring>
 #include <memory>
+#include <tuple>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -17,6 +20,7 @@
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
 #include "video_core/primitive_assembly.h"
@@ -39,6 +43,65 @@ constexpr std::array<u32, 16> expand_bits_to_bytes{
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+/// Number of vertices that are loaded and shaded together
+constexpr unsigned int VERTEX_BATCH_SIZE = 64;
+
+/**
+ * Holds the vertex shader output of every vertex of an indexed draw, so that no vertex is shaded
+ * twice. Vertex ids are at most 16 bits wide, so they index the lookup tables directly.
+ */
+class PostTransformCache {
+public:
+    /// Forgets the vertices of the previous draw
+    void Reset() {
+        outputs.clear();
+        vertices.clear();
+        if (++generation == 0) {
+            // Stale entries from 2^32 draws ago could alias the new generation
+            std::fill(vertex_generations.begin(), vertex_generations.end(), 0);
+            generation = 1;
+        }
+    }
+
+    /**
+     * Looks up the cache slot of a vertex, allocating the next free slot if it is missing.
+     * @returns The slot, and whether it already holds the output of the vertex
+     */
+    std::pair<u32, bool> Lookup(u32 vertex) {
+        if (vertex_generations[vertex] == generation) {
+            return {vertex_slots[vertex], true};
+        }
+        vertex_generations[vertex] = generation;
+        vertex_slots[vertex] = Size();
+        outputs.emplace_back();
+        vertices.emplace_back();
+        return {vertex_slots[vertex], false};
+    }
+
+    u32 Size() const {
+        return static_cast<u32>(outputs.size());
+    }
+
+    /// Storage of the slots. Invalidated by Lookup.
+    Shader::AttributeBuffer* Data() {
+        return outputs.data();
+    }
+
+    /// Rasterizer vertices of the slots, converted once for all references. Invalidated by Lookup.
+    Shader::OutputVertex* Vertices() {
+        return vertices.data();
+    }
+
+private:
+    std::vector<u32> vertex_generations = std::vector<u32>(0x10000);
+    std::vector<u32> vertex_slots = std::vector<u32>(0x10000);
+    u32 generation = 0;
+    std::vector<Shader::AttributeBuffer> outputs;
+    std::vector<Shader::OutputVertex> vertices;
+};
+
+static INSTANCE_LOCAL PostTransformCache post_transform_cache;
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -113,6 +176,29 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
+/**
+ * Data port registers, whose every write appends the value to a uniform, program or LUT buffer.
+ * The rasterizer only sets dirty flags or flushes its batch when they are written, the same way
+ * for each value.
+ */
+constexpr std::array<bool, Regs::NUM_REGS> stream_regs = [] {
+    std::array<bool, Regs::NUM_REGS> regs{};
+    for (std::size_t i = 0; i < 8; ++i) {
+        regs[PICA_REG_INDEX(gs.uniform_setup.set_value[0]) + i] = true;
+        regs[PICA_REG_INDEX(gs.program.set_word[0]) + i] = true;
+        regs[PICA_REG_INDEX(gs.swizzle_patterns.set_word[0]) + i] = true;
+        regs[PICA_REG_INDEX(vs.uniform_setup.set_value[0]) + i] = true;
+        regs[PICA_REG_INDEX(vs.program.set_word[0]) + i] = true;
+        regs[PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]) + i] = true;
+        regs[PICA_REG_INDEX(lighting.lut_data[0]) + i] = true;
+        regs[PICA_REG_INDEX(texturing.fog_lut_data[0]) + i] = true;
+        regs[PICA_REG_INDEX(texturing.proctex_lut_data[0]) + i] = true;
+    }
+    return regs;
+}();
+
+static void ProcessPicaRegWrite(u32 id, u32 value);
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -128,8 +214,11 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     u32 old_value = regs.reg_array[id];
 
     const u32 write_mask = expand_bits_to_bytes[mask];
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
 
-    regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterWrite(id, new_value);
+
+    regs.reg_array[id] = new_value;
 
     // Double check for is_pica_tracing to avoid call overhead
     if (DebugUtils::IsPicaTracing()) {
@@ -140,10 +229,54 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         g_debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded,
                                  reinterpret_cast<void*>(&id));
 
+    ProcessPicaRegWrite(id, value);
+
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+
+    if (g_debug_context)
+        g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
+                                 reinterpret_cast<void*>(&id));
+}
+
+/**
+ * Writes a run of values to one data port register. The rasterizer is notified once for the whole
+ * run, unless a debugger has to see each write.
+ */
+static void WritePicaRegStream(u32 id, const u32* values, u32 count, u32 mask) {
+    if (count == 0) {
+        return;
+    }
+    if (id >= Regs::NUM_REGS || !stream_regs[id] || g_debug_context ||
+        DebugUtils::IsPicaTracing()) {
+        for (u32 i = 0; i < count; ++i) {
+            WritePicaReg(id, values[i], mask);
+        }
+        return;
+    }
+
+    u32& reg = g_state.regs.reg_array[id];
+    const u32 write_mask = expand_bits_to_bytes[mask];
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterWrite(
+        id, (reg & ~write_mask) | (values[0] & write_mask));
+    for (u32 i = 0; i < count; ++i) {
+        reg = (reg & ~write_mask) | (values[i] & write_mask);
+        ProcessPicaRegWrite(id, values[i]);
+    }
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+}
+
+/// Runs the work triggered by a register write, once the new value is stored
+static void ProcessPicaRegWrite(u32 id, u32 value) {
+    auto& regs = g_state.regs;
+
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        if (VideoCore::GPUThread::IsGPUThread()) {
+            VideoCore::GPUThread::DeferInterrupt();
+        } else {
+            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        }
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
@@ -241,9 +374,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     g_state.geometry_pipeline.Setup(shader_engine);
                     g_state.geometry_pipeline.SubmitVertex(output);
 
-                    // TODO: If drawing after every immediate mode triangle kills performance,
-                    // change it to flush triangles whenever a drawing config register changes
-                    // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
+                    // The hardware renderer batches these until a drawing config register
+                    // changes. See: https://github.com/citra-emu/citra/pull/2866
                     VideoCore::g_renderer->Rasterizer()->DrawTriangles();
                     if (g_debug_context) {
                         g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch,
@@ -285,6 +417,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         bool accelerate_draw = VideoCore::g_hw_shader_enabled && primitive_assembler.IsEmpty();
 
+        // With a geometry shader, the rasterizer checks whether it can translate the shader
         if (regs.pipeline.use_gs == PipelineRegs::UseGS::No) {
             auto topology = primitive_assembler.GetTopology();
             if (topology == PipelineRegs::TriangleTopology::Shader ||
@@ -297,8 +430,6 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
             // or disable accelerate draw completely. However, there is not game found yet that does
             // this, so this is left unimplemented for now. Revisit this when an issue is found in
             // games.
-        } else {
-            accelerate_draw = false;
         }
 
         bool is_indexed = (id == PICA_REG_INDEX(pipeline.trigger_draw_indexed));
@@ -343,16 +474,6 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         DebugUtils::MemoryAccessTracker memory_accesses;
 
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const std::size_t VERTEX_CACHE_SIZE = 32;
-        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-        Shader::AttributeBuffer vs_output;
-
-        unsigned int vertex_cache_pos = 0;
-
         auto* shader_engine = Shader::GetEngine();
         Shader::UnitState shader_unit;
 
@@ -363,58 +484,116 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         if (g_state.geometry_pipeline.NeedIndexInput())
             ASSERT(is_indexed);
 
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
-
-            bool vertex_cache_hit = false;
+        // Indices are only fed to the geometry shader, which loads the vertices itself
+        if (is_indexed && g_state.geometry_pipeline.NeedIndexInput()) {
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                g_state.geometry_pipeline.SubmitIndex(index_u16 ? index_address_16[index]
+                                                                : index_address_8[index]);
+            }
+        } else if (is_indexed) {
+            post_transform_cache.Reset();
+        }
 
-            if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
+        // Without a geometry shader, the outputs of a batch go to the primitive assembler together
+        const bool assemble_batches = !g_state.geometry_pipeline.IsEnabled();
+        const PrimitiveAssembler<Shader::OutputVertex>::TriangleHandler add_triangle =
+            [](const Shader::OutputVertex& v0, const Shader::OutputVertex& v1,
+               const Shader::OutputVertex& v2) {
+                VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
+            };
+
+        // Vertices are loaded and shaded in batches. Each vertex of an indexed draw is only
+        // shaded once, as the post-transform cache holds the output of every vertex of the draw.
+        const bool submit_vertices = !(is_indexed && g_state.geometry_pipeline.NeedIndexInput());
+        for (unsigned int batch_start = 0;
+             submit_vertices && batch_start < regs.pipeline.num_vertices;
+             batch_start += VERTEX_BATCH_SIZE) {
+            const unsigned int batch_size =
+                std::min<unsigned int>(VERTEX_BATCH_SIZE, regs.pipeline.num_vertices - batch_start);
+
+            std::array<u32, VERTEX_BATCH_SIZE> load_indices;
+            std::array<u32, VERTEX_BATCH_SIZE> load_vertices;
+            std::array<u32, VERTEX_BATCH_SIZE> cache_slots;
+            const u32 first_new_slot = post_transform_cache.Size();
+            std::size_t num_loads = 0;
+
+            // Fetch the vertex ids of the batch in one pass, widening the indices of indexed draws
+            std::array<u32, VERTEX_BATCH_SIZE> batch_vertices;
+            if (!is_indexed) {
+                // Indexed rendering doesn't use the start offset
+                for (unsigned int i = 0; i < batch_size; ++i) {
+                    batch_vertices[i] = batch_start + i + regs.pipeline.vertex_offset;
                 }
+            } else if (index_u16) {
+                std::copy_n(index_address_16 + batch_start, batch_size, batch_vertices.begin());
+            } else {
+                std::copy_n(index_address_8 + batch_start, batch_size, batch_vertices.begin());
+            }
 
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
-                }
+            for (unsigned int i = 0; i < batch_size; ++i) {
+                const unsigned int index = batch_start + i;
+                const unsigned int vertex = batch_vertices[i];
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
+                if (is_indexed) {
+                    if (g_debug_context && Pica::g_debug_context->recorder) {
+                        int size = index_u16 ? 2 : 1;
+                        memory_accesses.AddAccess(base_address + index_info.offset + size * index,
+                                                  size);
+                    }
+
+                    bool cache_hit;
+                    std::tie(cache_slots[i], cache_hit) = post_transform_cache.Lookup(vertex);
+                    if (cache_hit) {
+                        continue;
                     }
                 }
+                load_indices[num_loads] = index;
+                load_vertices[num_loads] = vertex;
+                ++num_loads;
             }
 
-            if (!vertex_cache_hit) {
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+            // Initialize data for the vertices missing from the cache
+            std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> inputs;
+            loader.LoadVertices(base_address, load_indices.data(), load_vertices.data(), num_loads,
+                                inputs.data(), memory_accesses);
 
-                // Send to vertex shader
-                if (g_debug_context)
+            // Send to vertex shader. The cache slots of the vertices missing from it are allocated
+            // consecutively, so indexed draws can write the outputs into the cache directly.
+            if (g_debug_context) {
+                for (std::size_t i = 0; i < num_loads; ++i) {
                     g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                             (void*)&input);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
-
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                                             (void*)&inputs[i]);
                 }
             }
+            std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> outputs;
+            Shader::AttributeBuffer* batch_outputs =
+                is_indexed ? post_transform_cache.Data() + first_new_slot : outputs.data();
+            shader_engine->RunBatch(g_state.vs, regs.vs, shader_unit, inputs.data(),
+                                    batch_outputs, num_loads);
+
+            if (!assemble_batches) {
+                // Send to geometry pipeline
+                for (unsigned int i = 0; i < batch_size; ++i) {
+                    g_state.geometry_pipeline.SubmitVertex(
+                        is_indexed ? post_transform_cache.Data()[cache_slots[i]] : outputs[i]);
+                }
+                continue;
+            }
 
-            // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
+            // Convert the new outputs for the rasterizer and assemble the triangles of the batch
+            std::array<Shader::OutputVertex, VERTEX_BATCH_SIZE> vertices;
+            Shader::OutputVertex* const batch_vertex_outputs =
+                is_indexed ? post_transform_cache.Vertices() + first_new_slot : vertices.data();
+            for (std::size_t i = 0; i < num_loads; ++i) {
+                batch_vertex_outputs[i] =
+                    Shader::OutputVertex::FromAttributeBuffer(regs.rasterizer, batch_outputs[i]);
+            }
+            std::array<const Shader::OutputVertex*, VERTEX_BATCH_SIZE> assembled;
+            for (unsigned int i = 0; i < batch_size; ++i) {
+                assembled[i] = is_indexed ? &post_transform_cache.Vertices()[cache_slots[i]]
+                                          : &vertices[i];
+            }
+            g_state.primitive_assembler.SubmitVertices(assembled.data(), batch_size, add_triangle);
         }
 
         for (auto& range : memory_accesses.ranges) {
@@ -637,12 +816,6 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     default:
         break;
     }
-
-    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
-
-    if (g_debug_context)
-        g_debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed,
-                                 reinterpret_cast<void*>(&id));
 }
 
 void ProcessCommandList(PAddr list, u32 size) {
@@ -668,8 +841,16 @@ void ProcessCommandList(PAddr list, u32 size) {
 
         WritePicaReg(header.cmd_id, value, header.parameter_mask);
 
+        if (!header.group_commands) {
+            // Uploads of uniforms, shader programs and LUTs write one register many times
+            WritePicaRegStream(header.cmd_id, g_state.cmd_list.current_ptr,
+                               header.extra_data_length, header.parameter_mask);
+            g_state.cmd_list.current_ptr += header.extra_data_length;
+            continue;
+        }
+
         for (unsigned i = 0; i < header.extra_data_length; ++i) {
-            u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
+            u32 cmd = header.cmd_id + i + 1;
             WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
         }
     }
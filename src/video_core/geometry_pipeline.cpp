@@ -350,6 +350,10 @@ void GeometryPipeline::Reconfigure() {
     }
 }
 
+bool GeometryPipeline::IsEnabled() const {
+    return backend != nullptr;
+}
+
 bool GeometryPipeline::NeedIndexInput() const {
     if (!backend)
         return false;
@@ -35,6 +35,9 @@ public:
     /// Reconfigures the pipeline according to current register settings
     void Reconfigure();
 
+    /// Checks if the geometry shader is in use, otherwise vertices go to the primitive assembler
+    bool IsEnabled() const;
+
     /// Checks if the pipeline needs a direct input from index buffer
     bool NeedIndexInput() const;
 
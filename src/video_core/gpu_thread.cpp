@@ -0,0 +1,128 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "common/threadsafe_queue.h"
+#include "core/hle/service/gsp/gsp.h"
+#include "video_core/command_processor.h"
+#include "video_core/gpu_thread.h"
+
+MICROPROFILE_DEFINE(GPU_ThreadSync, "GPU", "Wait for GPU thread", MP_RGB(255, 100, 100));
+
+namespace VideoCore::GPUThread {
+
+namespace {
+
+struct CommandList {
+    PAddr address = 0;
+    u32 size = 0;
+    bool stop = false; ///< Asks the thread to exit
+};
+
+// Multi-instance builds never start the thread, the console state it would use is per thread
+INSTANCE_LOCAL std::thread thread;
+INSTANCE_LOCAL Common::SPSCQueue<CommandList> queue;
+thread_local bool is_gpu_thread = false;
+
+/// Number of command lists pushed by the CPU thread. CPU thread only.
+INSTANCE_LOCAL u64 num_submitted = 0;
+/// Number of command lists the GPU thread has finished
+INSTANCE_LOCAL std::atomic<u64> num_completed{0};
+INSTANCE_LOCAL std::mutex completed_mutex;
+INSTANCE_LOCAL std::condition_variable completed_cv;
+
+INSTANCE_LOCAL std::atomic<u32> pending_interrupts{0};
+
+void ThreadLoop() {
+    Common::SetCurrentThreadName("GPU");
+    Common::SetCurrentThreadRole(Common::ThreadRole::GpuSubmit);
+    is_gpu_thread = true;
+
+    while (true) {
+        const CommandList command = queue.PopWait();
+        if (command.stop) {
+            break;
+        }
+
+        Pica::CommandProcessor::ProcessCommandList(command.address, command.size);
+
+        {
+            std::scoped_lock lock{completed_mutex};
+            ++num_completed;
+        }
+        completed_cv.notify_one();
+    }
+    Common::ClearCurrentThreadRole();
+}
+
+} // Anonymous namespace
+
+void Start() {
+#ifdef CITRA_MULTI_INSTANCE
+    UNREACHABLE_MSG("GPU thread is not supported by multi-instance builds");
+#endif
+    ASSERT(!thread.joinable());
+    num_submitted = 0;
+    num_completed = 0;
+    pending_interrupts = 0;
+    thread = std::thread(ThreadLoop);
+    LOG_INFO(HW_GPU, "Processing command lists on the GPU thread");
+}
+
+void Stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+    Synchronize();
+    queue.Push(CommandList{0, 0, true});
+    thread.join();
+}
+
+bool IsActive() {
+    return thread.joinable();
+}
+
+bool IsGPUThread() {
+    return is_gpu_thread;
+}
+
+void SubmitCommandList(PAddr list, u32 size) {
+    if (!IsActive()) {
+        Pica::CommandProcessor::ProcessCommandList(list, size);
+        return;
+    }
+
+    ++num_submitted;
+    queue.Push(CommandList{list, size, false});
+}
+
+void DeferInterrupt() {
+    ++pending_interrupts;
+}
+
+void Synchronize() {
+    if (!IsActive() || is_gpu_thread) {
+        return;
+    }
+
+    if (num_completed.load() != num_submitted) {
+        MICROPROFILE_SCOPE(GPU_ThreadSync);
+        std::unique_lock lock{completed_mutex};
+        completed_cv.wait(lock, [] { return num_completed.load() == num_submitted; });
+    }
+
+    for (u32 count = pending_interrupts.exchange(0); count > 0; --count) {
+        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+    }
+}
+
+} // namespace VideoCore::GPUThread
@@ -0,0 +1,48 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+/**
+ * Optional thread that processes PICA command lists, so that the emulated CPU keeps running while
+ * the GPU draws. Command lists are queued in order through a lock-free FIFO. Everything else the
+ * GPU does (memory fills, display transfers, presentation) stays on the CPU thread and first waits
+ * for the queue to drain, as do the rasterizer flush and invalidate hooks through which the CPU
+ * side accesses memory the GPU may be rendering to.
+ *
+ * The thread is only used with the software renderer, as the OpenGL context belongs to the
+ * frontend thread.
+ */
+namespace VideoCore::GPUThread {
+
+/// Starts the thread. Until then, and after Stop, command lists are processed when submitted.
+void Start();
+
+/// Waits for the queued command lists, then stops the thread
+void Stop();
+
+/// Returns true if command lists are processed on the GPU thread
+bool IsActive();
+
+/// Returns true if called from the GPU thread
+bool IsGPUThread();
+
+/// Processes the command list on the GPU thread, or right away if it is not active
+void SubmitCommandList(PAddr list, u32 size);
+
+/**
+ * Records a P3D interrupt requested by a command list running on the GPU thread. Kernel objects
+ * may only be signaled from the CPU thread, so it is delivered by the next Synchronize.
+ */
+void DeferInterrupt();
+
+/**
+ * Blocks until all submitted command lists have been processed and signals the interrupts they
+ * requested. Does nothing on the GPU thread itself.
+ */
+void Synchronize();
+
+} // namespace VideoCore::GPUThread
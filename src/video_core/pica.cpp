@@ -20,7 +20,7 @@ Pica::State& Global() {
 
 namespace Pica {
 
-State g_state;
+INSTANCE_LOCAL State g_state;
 
 void Init() {
     g_state.Reset();
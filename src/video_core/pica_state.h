@@ -8,6 +8,7 @@
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/split_member.hpp>
 #include "common/bit_field.h"
+#include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
@@ -37,15 +38,67 @@ struct State {
     State();
     void Reset();
 
+    // The members are ordered by how often they are accessed. The registers and the command list
+    // state come first, as every command writes them, followed by the vertex pipeline state that
+    // draws use. Shader setups and the LUTs, which are only written by uploads, start on their own
+    // cache lines so that they don't share any with the hot state.
+
     /// Pica registers
     Regs regs;
 
-    Shader::ShaderSetup vs;
+    /// Current Pica command list
+    struct {
+        PAddr addr; // This exists only for serialization
+        const u32* head_ptr;
+        const u32* current_ptr;
+        u32 length;
+    } cmd_list;
+
+    int vs_float_regs_counter = 0;
+    std::array<u32, 4> vs_uniform_write_buffer{};
+
+    int gs_float_regs_counter = 0;
+    std::array<u32, 4> gs_uniform_write_buffer{};
+
+    int default_attr_counter = 0;
+    std::array<u32, 3> default_attr_write_buffer{};
+
+    /// Struct used to describe immediate mode rendering state
+    struct ImmediateModeState {
+        // Used to buffer partial vertices for immediate-mode rendering.
+        Shader::AttributeBuffer input_vertex;
+        // Index of the next attribute to be loaded into `input_vertex`.
+        u32 current_attribute = 0;
+        // Indicates the immediate mode just started and the geometry pipeline needs to reconfigure
+        bool reset_geometry_pipeline = true;
+
+    private:
+        friend class boost::serialization::access;
+        template <class Archive>
+        void serialize(Archive& ar, const unsigned int file_version) {
+            ar& input_vertex;
+            ar& current_attribute;
+            ar& reset_geometry_pipeline;
+        }
+
+    } immediate;
+
+    GeometryPipeline geometry_pipeline;
+
+    // This is constructed with a dummy triangle topology
+    PrimitiveAssembler<Shader::OutputVertex> primitive_assembler;
+
+    // the geometry shader needs to be kept in the global state because some shaders relie on
+    // preserved register value across shader invocation.
+    // TODO: also bring the three vertex shader units here and implement the shader scheduler.
+    Shader::GSUnitState gs_unit;
+
+    alignas(64) Shader::ShaderSetup vs;
     Shader::ShaderSetup gs;
 
     Shader::AttributeBuffer input_default_attributes;
 
-    struct ProcTex {
+    struct alignas(64) ProcTex {
         union ValueEntry {
             u32 raw;
 
@@ -159,57 +212,11 @@ struct State {
         UnionArray<LutEntry, 128> lut;
     } fog;
 
-    /// Current Pica command list
-    struct {
-        PAddr addr; // This exists only for serialization
-        const u32* head_ptr;
-        const u32* current_ptr;
-        u32 length;
-    } cmd_list;
-
-    /// Struct used to describe immediate mode rendering state
-    struct ImmediateModeState {
-        // Used to buffer partial vertices for immediate-mode rendering.
-        Shader::AttributeBuffer input_vertex;
-        // Index of the next attribute to be loaded into `input_vertex`.
-        u32 current_attribute = 0;
-        // Indicates the immediate mode just started and the geometry pipeline needs to reconfigure
-        bool reset_geometry_pipeline = true;
-
-    private:
-        friend class boost::serialization::access;
-        template <class Archive>
-        void serialize(Archive& ar, const unsigned int file_version) {
-            ar& input_vertex;
-            ar& current_attribute;
-            ar& reset_geometry_pipeline;
-        }
-
-    } immediate;
-
-    // the geometry shader needs to be kept in the global state because some shaders relie on
-    // preserved register value across shader invocation.
-    // TODO: also bring the three vertex shader units here and implement the shader scheduler.
-    Shader::GSUnitState gs_unit;
-
-    GeometryPipeline geometry_pipeline;
-
-    // This is constructed with a dummy triangle topology
-    PrimitiveAssembler<Shader::OutputVertex> primitive_assembler;
-
-    int vs_float_regs_counter = 0;
-    std::array<u32, 4> vs_uniform_write_buffer{};
-
-    int gs_float_regs_counter = 0;
-    std::array<u32, 4> gs_uniform_write_buffer{};
-
-    int default_attr_counter = 0;
-    std::array<u32, 3> default_attr_write_buffer{};
-
 private:
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int file_version) {
+        // Savestates keep the order the members had before they were sorted by how hot they are
         ar& regs.reg_array;
         ar& vs;
         ar& gs;
@@ -250,6 +257,6 @@ private:
     }
 };
 
-extern State g_state; ///< Current Pica state
+extern INSTANCE_LOCAL State g_state; ///< Current Pica state
 
 } // namespace Pica
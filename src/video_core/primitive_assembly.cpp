@@ -53,6 +53,58 @@ void PrimitiveAssembler<VertexType>::SubmitVertex(const VertexType& vtx,
     }
 }
 
+template <typename VertexType>
+void PrimitiveAssembler<VertexType>::SubmitVertices(const VertexType* const* vertices,
+                                                    std::size_t count,
+                                                    const TriangleHandler& triangle_handler) {
+    // Stands in for the vertex queue, pointing either into it or to the vertices of this run
+    std::array<const VertexType*, 2> queue{&buffer[0], &buffer[1]};
+
+    switch (topology) {
+    case PipelineRegs::TriangleTopology::List:
+    case PipelineRegs::TriangleTopology::Shader:
+        for (std::size_t i = 0; i < count; ++i) {
+            if (buffer_index < 2) {
+                queue[buffer_index++] = vertices[i];
+            } else {
+                buffer_index = 0;
+                if (topology == PipelineRegs::TriangleTopology::Shader && winding) {
+                    triangle_handler(*queue[1], *queue[0], *vertices[i]);
+                    winding = false;
+                } else {
+                    triangle_handler(*queue[0], *queue[1], *vertices[i]);
+                }
+            }
+        }
+        break;
+
+    case PipelineRegs::TriangleTopology::Strip:
+    case PipelineRegs::TriangleTopology::Fan:
+        for (std::size_t i = 0; i < count; ++i) {
+            if (strip_ready)
+                triangle_handler(*queue[0], *queue[1], *vertices[i]);
+
+            queue[buffer_index] = vertices[i];
+
+            strip_ready |= (buffer_index == 1);
+
+            if (topology == PipelineRegs::TriangleTopology::Strip)
+                buffer_index = !buffer_index;
+            else
+                buffer_index = 1;
+        }
+        break;
+
+    default:
+        LOG_ERROR(HW_GPU, "Unknown triangle topology {:x}:", (int)topology);
+        return;
+    }
+
+    // Queue entries still pointing into the buffer are assigned to themselves
+    buffer[0] = *queue[0];
+    buffer[1] = *queue[1];
+}
+
 template <typename VertexType>
 void PrimitiveAssembler<VertexType>::SetWinding() {
     winding = true;
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <functional>
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/array.hpp>
@@ -32,6 +33,13 @@ struct PrimitiveAssembler {
      */
     void SubmitVertex(const VertexType& vtx, const TriangleHandler& triangle_handler);
 
+    /**
+     * Queues a run of vertices, the same as calling SubmitVertex for each of them. Triangles are
+     * built from the vertices in place, only the last two are copied into the vertex queue.
+     */
+    void SubmitVertices(const VertexType* const* vertices, std::size_t count,
+                        const TriangleHandler& triangle_handler);
+
     /**
      * Invert the vertex order of the next triangle. Called by geometry shader emitter.
      * This only takes effect for TriangleTopology::Shader.
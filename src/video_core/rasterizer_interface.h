@@ -39,6 +39,10 @@ public:
     /// Draw the current batch of triangles
     virtual void DrawTriangles() = 0;
 
+    /// Notify rasterizer that the specified PICA register is about to be written with the given
+    /// value
+    virtual void NotifyPicaRegisterWrite(u32 id, u32 value) = 0;
+
     /// Notify rasterizer that the specified PICA register has been changed
     virtual void NotifyPicaRegisterChanged(u32 id) = 0;
 
@@ -58,6 +62,15 @@ public:
     /// Removes as much state as possible from the rasterizer in preparation for a save/load state
     virtual void ClearAll(bool flush) = 0;
 
+    /// Called once per presented frame, lets the rasterizer trim its caches
+    virtual void TickFrame() {}
+
+    /**
+     * Sets whether the frame being emulated will be presented. The draws of frames that are not
+     * may be dropped, as long as the memory they render to is not read back by the CPU.
+     */
+    virtual void SetFrameSkipped(bool skipped) {}
+
     /// Attempt to use a faster method to perform a display transfer with is_texture_copy = 0
     virtual bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
         return false;
@@ -24,6 +24,12 @@ public:
     /// Swap buffers (render frame)
     virtual void SwapBuffers() = 0;
 
+    /**
+     * Draws the newest frame of the window's mailbox to the current framebuffer of the present
+     * thread, waiting at most timeout_ms for a new one
+     */
+    virtual void TryPresent(int timeout_ms) = 0;
+
     /// Initialize the renderer
     virtual VideoCore::ResultStatus Init() = 0;
 
@@ -0,0 +1,177 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/frame_counters.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
+
+MICROPROFILE_DEFINE(OpenGL_AsyncShaderGen, "OpenGL", "Async Shader Generation",
+                    MP_RGB(100, 100, 255));
+MICROPROFILE_DEFINE(OpenGL_AsyncShaderSubmit, "OpenGL", "Async Shader Submission",
+                    MP_RGB(100, 160, 255));
+
+namespace OpenGL {
+
+bool AsyncShaderCompiler::HasParallelShaderCompile() {
+    return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+}
+
+AsyncShaderCompiler::AsyncShaderCompiler(std::size_t num_workers) {
+    // Let the driver pick the number of its own compiler threads
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    } else if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+AsyncShaderCompiler::~AsyncShaderCompiler() {
+    {
+        std::scoped_lock lock{mutex};
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const auto& job : compiling_jobs) {
+        if (job->shader != 0) {
+            glDeleteShader(job->shader);
+        }
+        glDeleteProgram(job->program);
+    }
+}
+
+void AsyncShaderCompiler::Queue(GLenum type, CodeGenerator generate, ReadyCallback on_ready) {
+    auto job = std::make_unique<Job>();
+    job->type = type;
+    job->generate = std::move(generate);
+    job->on_ready = std::move(on_ready);
+    {
+        std::scoped_lock lock{mutex};
+        queued_jobs.push_back(std::move(job));
+    }
+    ++num_pending;
+    Core::CountFrameEvent(Core::FrameCounter::ShaderCompiles);
+    cv.notify_one();
+}
+
+void AsyncShaderCompiler::QueueBinary(GLenum binary_format, const std::vector<u8>& binary,
+                                      ReadyCallback on_ready) {
+    auto job = std::make_unique<Job>();
+    job->on_ready = std::move(on_ready);
+    job->program = glCreateProgram();
+    glProgramParameteri(job->program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramBinary(job->program, binary_format, binary.data(),
+                    static_cast<GLsizei>(binary.size()));
+    compiling_jobs.push_back(std::move(job));
+    ++num_pending;
+}
+
+void AsyncShaderCompiler::Poll() {
+    if (num_pending == 0) {
+        return;
+    }
+
+    std::vector<std::unique_ptr<Job>> jobs;
+    {
+        std::scoped_lock lock{mutex};
+        jobs.swap(generated_jobs);
+    }
+
+    if (!jobs.empty()) {
+        MICROPROFILE_SCOPE(OpenGL_AsyncShaderSubmit);
+        for (auto& job : jobs) {
+            if (!job->result) {
+                Finish(*job);
+                continue;
+            }
+            job->shader = StartShaderCompile(job->result->code.c_str(), job->type);
+            job->program = StartProgramLink(true, {job->shader});
+            compiling_jobs.push_back(std::move(job));
+        }
+    }
+
+    // Without parallel compile support the status queries below block until the program is ready
+    const bool parallel = HasParallelShaderCompile();
+    const auto done = std::stable_partition(
+        compiling_jobs.begin(), compiling_jobs.end(), [parallel](const auto& job) {
+            if (!parallel) {
+                return false;
+            }
+            GLint completed = GL_FALSE;
+            glGetProgramiv(job->program, GL_COMPLETION_STATUS_KHR, &completed);
+            return completed == GL_FALSE;
+        });
+    std::vector<std::unique_ptr<Job>> finished(std::make_move_iterator(done),
+                                               std::make_move_iterator(compiling_jobs.end()));
+    compiling_jobs.erase(done, compiling_jobs.end());
+    for (auto& job : finished) {
+        Finish(*job);
+    }
+}
+
+void AsyncShaderCompiler::WorkerLoop() {
+    Common::SetCurrentThreadName("ShaderCompiler");
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock lock{mutex};
+            cv.wait(lock, [this] { return stop || !queued_jobs.empty(); });
+            if (stop) {
+                return;
+            }
+            job = std::move(queued_jobs.front());
+            queued_jobs.pop_front();
+        }
+
+        {
+            MICROPROFILE_SCOPE(OpenGL_AsyncShaderGen);
+            job->result = job->generate();
+        }
+
+        std::scoped_lock lock{mutex};
+        generated_jobs.push_back(std::move(job));
+    }
+}
+
+void AsyncShaderCompiler::Finish(Job& job) {
+    OGLProgram program;
+    if (job.program != 0 && job.shader == 0) {
+        // Loaded from a binary, which has nothing to compile
+        GLint link_status = GL_FALSE;
+        glGetProgramiv(job.program, GL_LINK_STATUS, &link_status);
+        if (link_status == GL_TRUE) {
+            program.handle = job.program;
+        } else {
+            glDeleteProgram(job.program);
+        }
+    } else if (job.program != 0) {
+        const bool compiled = CheckShaderCompile(job.shader, job.result->code.c_str(), job.type);
+        if (compiled && CheckProgramLink(job.program)) {
+            glDetachShader(job.program, job.shader);
+            program.handle = job.program;
+        } else {
+            glDeleteProgram(job.program);
+        }
+        glDeleteShader(job.shader);
+    }
+
+    ASSERT(num_pending > 0);
+    --num_pending;
+    job.on_ready(std::move(program), std::move(job.result));
+}
+
+} // namespace OpenGL
@@ -0,0 +1,83 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_shader_decompiler.h"
+
+namespace OpenGL {
+
+/**
+ * Builds separable shader programs without stalling the thread that owns the GL context. Worker
+ * threads generate the GLSL code, then the GL thread hands it to the driver. When the driver
+ * supports KHR_parallel_shader_compile the compile and link also happen in the background and are
+ * only collected once they completed.
+ */
+class AsyncShaderCompiler : private NonCopyable {
+public:
+    using CodeGenerator = std::function<std::optional<ShaderDecompiler::ProgramResult>()>;
+
+    /**
+     * Called on the GL thread with the linked program and the code it was built from. The program
+     * is empty if code generation or compilation failed, in which case result may be empty too.
+     */
+    using ReadyCallback = std::function<void(
+        OGLProgram program, std::optional<ShaderDecompiler::ProgramResult> result)>;
+
+    explicit AsyncShaderCompiler(std::size_t num_workers);
+    ~AsyncShaderCompiler();
+
+    /// Queues a program of the given stage, which is reported to on_ready from a later Poll
+    void Queue(GLenum type, CodeGenerator generate, ReadyCallback on_ready);
+
+    /**
+     * Hands a separable program binary to the driver, which is reported to on_ready from a later
+     * Poll without any code. The program is empty if the driver rejected the binary. GL thread
+     * only.
+     */
+    void QueueBinary(GLenum binary_format, const std::vector<u8>& binary, ReadyCallback on_ready);
+
+    /// Whether the driver compiles and links in the background, so that Poll never waits for it
+    static bool HasParallelShaderCompile();
+
+    /// Submits generated code to the driver and reports the finished programs. GL thread only.
+    void Poll();
+
+private:
+    struct Job {
+        GLenum type;
+        CodeGenerator generate;
+        ReadyCallback on_ready;
+        std::optional<ShaderDecompiler::ProgramResult> result;
+        GLuint shader = 0;
+        GLuint program = 0;
+    };
+
+    void WorkerLoop();
+    void Finish(Job& job);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop = false;
+    std::deque<std::unique_ptr<Job>> queued_jobs;
+    std::vector<std::unique_ptr<Job>> generated_jobs;
+
+    /// Jobs submitted to the driver, and the number of jobs not reported yet. GL thread only.
+    std::vector<std::unique_ptr<Job>> compiling_jobs;
+    std::size_t num_pending = 0;
+};
+
+} // namespace OpenGL
@@ -0,0 +1,113 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <glad/glad.h>
+#include "common/logging/log.h"
+#include "core/settings.h"
+#include "video_core/renderer_opengl/gl_dynamic_resolution.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+namespace OpenGL {
+
+/// Above this share of the frame time, the scale is lowered
+constexpr double DOWNSCALE_THRESHOLD = 0.9;
+/// The scale is raised when the frame would take at most this share of the frame time at it
+constexpr double UPSCALE_THRESHOLD = 0.75;
+
+DynamicResolution::DynamicResolution(u16 min_scale, u16 max_scale)
+    : min_scale(std::clamp<u16>(min_scale, 1, max_scale)), max_scale(max_scale),
+      scale(max_scale) {
+    for (auto& query : queries) {
+        query.Create();
+    }
+}
+
+DynamicResolution::~DynamicResolution() {
+    if (measuring) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+}
+
+bool DynamicResolution::IsSupported() {
+    return !GLES || GLAD_GL_EXT_disjoint_timer_query;
+}
+
+void DynamicResolution::TickFrame() {
+    if (measuring) {
+        glEndQuery(GL_TIME_ELAPSED);
+        next_query = (next_query + 1) % NUM_QUERIES;
+        ++num_pending;
+    }
+    ReadResults();
+    glBeginQuery(GL_TIME_ELAPSED, queries[next_query].handle);
+    measuring = true;
+}
+
+void DynamicResolution::SetMaxScale(u16 new_max_scale) {
+    max_scale = new_max_scale;
+    min_scale = std::min(min_scale, max_scale);
+    scale = std::clamp(scale, min_scale, max_scale);
+}
+
+void DynamicResolution::ReadResults() {
+    while (num_pending > 0) {
+        const GLuint query = queries[(next_query + NUM_QUERIES - num_pending) % NUM_QUERIES].handle;
+        // Only waits for the oldest frame when every query is in flight
+        if (num_pending < NUM_QUERIES) {
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == GL_FALSE) {
+                return;
+            }
+        }
+
+        GLuint64 time_ns = 0;
+        if (GLES) {
+            glGetQueryObjectui64vEXT(query, GL_QUERY_RESULT, &time_ns);
+        } else {
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &time_ns);
+        }
+        --num_pending;
+
+        // The results are meaningless when the GPU changed its clock while measuring
+        GLint disjoint = GL_FALSE;
+        if (GLES) {
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        }
+        if (disjoint == GL_FALSE) {
+            AddSample(static_cast<double>(time_ns) / 1e6);
+        }
+    }
+}
+
+void DynamicResolution::AddSample(double gpu_time_ms) {
+    total_time_ms += gpu_time_ms;
+    if (++num_samples < SAMPLE_FRAMES) {
+        return;
+    }
+    const double average_ms = total_time_ms / static_cast<double>(num_samples);
+    total_time_ms = 0;
+    num_samples = 0;
+
+    const u16 frame_limit = Settings::values.frame_limit != 0 ? Settings::values.frame_limit : 100;
+    const double frame_time_ms = 1000.0 / 60.0 * 100.0 / frame_limit;
+
+    // The GPU time grows with the number of pixels, ie. with the square of the scale
+    const double next_scale = scale + 1;
+    const double upscaled_ms = average_ms * next_scale * next_scale / (scale * scale);
+    u16 new_scale = scale;
+    if (average_ms > frame_time_ms * DOWNSCALE_THRESHOLD && scale > min_scale) {
+        new_scale = scale - 1;
+    } else if (upscaled_ms < frame_time_ms * UPSCALE_THRESHOLD && scale < max_scale) {
+        new_scale = scale + 1;
+    }
+    if (new_scale != scale) {
+        LOG_DEBUG(Render_OpenGL, "GPU time {:.2f} ms of {:.2f} ms, resolution scale {} -> {}",
+                  average_ms, frame_time_ms, scale, new_scale);
+        scale = new_scale;
+    }
+}
+
+} // namespace OpenGL
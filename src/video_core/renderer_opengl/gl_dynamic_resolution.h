@@ -0,0 +1,59 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Picks the resolution scale of new framebuffer surfaces from the GPU time of the last frames,
+ * so that rendering fits in the frame time. The GPU time is measured with timer queries, whose
+ * results are read a few frames late so that they don't stall the pipeline.
+ */
+class DynamicResolution : private NonCopyable {
+public:
+    DynamicResolution(u16 min_scale, u16 max_scale);
+    ~DynamicResolution();
+
+    /// Returns whether the driver can measure GPU time
+    static bool IsSupported();
+
+    /// Ends the measurement of the frame that was just presented and starts the next one
+    void TickFrame();
+
+    /// Changes the highest scale, e.g. when the resolution factor setting changes
+    void SetMaxScale(u16 max_scale);
+
+    u16 GetScale() const {
+        return scale;
+    }
+
+private:
+    /// Frames that may be in flight before reading a result waits for the GPU
+    static constexpr std::size_t NUM_QUERIES = 4;
+    /// Frames whose GPU time is averaged before the scale may change
+    static constexpr std::size_t SAMPLE_FRAMES = 30;
+
+    void ReadResults();
+    void AddSample(double gpu_time_ms);
+
+    std::array<OGLQuery, NUM_QUERIES> queries;
+    std::size_t next_query = 0;
+    std::size_t num_pending = 0;
+    bool measuring = false;
+
+    double total_time_ms = 0;
+    std::size_t num_samples = 0;
+
+    u16 min_scale;
+    u16 max_scale;
+    u16 scale;
+};
+
+} // namespace OpenGL
@@ -2,10 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <memory>
+#include <fmt/format.h>
 #include "common/assert.h"
 #include "common/scope_exit.h"
 #include "video_core/renderer_opengl/gl_format_reinterpreter.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/texture_filters/texture_filterer.h"
@@ -283,9 +287,10 @@ void main() {
         state.Apply();
 
         // Nvidia seem to be the only one to support D24S8 views, at least on windows
-        // so for everyone else it will do an intermediate copy before running through the shader
+        // so for everyone else it will do an intermediate copy before running through the shader.
+        // The view aliases the immutable storage of the source surface, so no texels are copied.
         std::string_view vendor{reinterpret_cast<const char*>(glGetString(GL_VENDOR))};
-        if (vendor.find("NVIDIA") != vendor.npos) {
+        if (!GLES && GLAD_GL_ARB_texture_view && vendor.find("NVIDIA") != vendor.npos) {
             use_texture_view = true;
         } else {
             LOG_INFO(Render_OpenGL,
@@ -362,6 +367,220 @@ private:
     Common::Rectangle<u32> temp_rect{0, 0, 0, 0};
 };
 
+/**
+ * Program that reads each texel of any color or depth format as the raw bits the 3DS would store
+ * in memory, then writes those bits out in another format of the same size. Depth destinations
+ * are written through gl_FragDepth, color ones through the first color attachment.
+ */
+class RawBitsProgram {
+public:
+    explicit RawBitsProgram(bool depth_output) : depth_output(depth_output) {
+        constexpr std::string_view vs_source = R"(
+out vec2 dst_coord;
+
+uniform mediump ivec2 dst_size;
+
+const vec2 vertices[4] =
+    vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+void main() {
+    gl_Position = vec4(vertices[gl_VertexID], 0.0, 1.0);
+    dst_coord = (vertices[gl_VertexID] / 2.0 + 0.5) * vec2(dst_size);
+}
+)";
+
+        std::string fs_source = GLES ? fragment_shader_precision_OES : "";
+        if (depth_output) {
+            fs_source += "#define DEPTH_OUTPUT\n";
+        }
+        fs_source += fmt::format(R"(
+#define RGB8 {}
+#define RGB5A1 {}
+#define RGB565 {}
+#define RGBA4 {}
+#define IA8 {}
+#define RG8 {}
+#define D16 {}
+#define D24 {}
+)",
+                                 static_cast<int>(PixelFormat::RGB8),
+                                 static_cast<int>(PixelFormat::RGB5A1),
+                                 static_cast<int>(PixelFormat::RGB565),
+                                 static_cast<int>(PixelFormat::RGBA4),
+                                 static_cast<int>(PixelFormat::IA8),
+                                 static_cast<int>(PixelFormat::RG8),
+                                 static_cast<int>(PixelFormat::D16),
+                                 static_cast<int>(PixelFormat::D24));
+        fs_source += R"(
+in mediump vec2 dst_coord;
+
+#ifndef DEPTH_OUTPUT
+out lowp vec4 frag_color;
+#endif
+
+uniform highp sampler2D source;
+uniform mediump ivec2 dst_size;
+uniform mediump ivec2 src_size;
+uniform mediump ivec2 src_offset;
+uniform int src_format;
+uniform int dst_format;
+
+highp uint Quantize(highp float value, int bits) {
+    return uint(value * (exp2(float(bits)) - 1.0) + 0.5);
+}
+
+highp float Unquantize(highp uint value, int bits) {
+    return float(value & ((1u << uint(bits)) - 1u)) / (exp2(float(bits)) - 1.0);
+}
+
+// Packs the texel the way the 3DS stores it, in a little endian word
+highp uint Decode(highp vec4 texel) {
+    switch (src_format) {
+    case RGB8:
+        return (Quantize(texel.r, 8) << 16) | (Quantize(texel.g, 8) << 8) | Quantize(texel.b, 8);
+    case RGB5A1:
+        return (Quantize(texel.r, 5) << 11) | (Quantize(texel.g, 5) << 6) |
+               (Quantize(texel.b, 5) << 1) | Quantize(texel.a, 1);
+    case RGB565:
+        return (Quantize(texel.r, 5) << 11) | (Quantize(texel.g, 6) << 5) | Quantize(texel.b, 5);
+    case RGBA4:
+        return (Quantize(texel.r, 4) << 12) | (Quantize(texel.g, 4) << 8) |
+               (Quantize(texel.b, 4) << 4) | Quantize(texel.a, 4);
+    case IA8:
+        return (Quantize(texel.r, 8) << 8) | Quantize(texel.a, 8);
+    case RG8:
+        return (Quantize(texel.r, 8) << 8) | Quantize(texel.g, 8);
+    case D16:
+        return Quantize(texel.r, 16);
+    case D24:
+        return Quantize(texel.r, 24);
+    }
+    return 0u;
+}
+
+highp vec4 Encode(highp uint raw) {
+    switch (dst_format) {
+    case RGB8:
+        return vec4(Unquantize(raw >> 16, 8), Unquantize(raw >> 8, 8), Unquantize(raw, 8), 1.0);
+    case RGB5A1:
+        return vec4(Unquantize(raw >> 11, 5), Unquantize(raw >> 6, 5), Unquantize(raw >> 1, 5),
+                    Unquantize(raw, 1));
+    case RGB565:
+        return vec4(Unquantize(raw >> 11, 5), Unquantize(raw >> 5, 6), Unquantize(raw, 5), 1.0);
+    case RGBA4:
+        return vec4(Unquantize(raw >> 12, 4), Unquantize(raw >> 8, 4), Unquantize(raw >> 4, 4),
+                    Unquantize(raw, 4));
+    case IA8:
+        return vec4(vec3(Unquantize(raw >> 8, 8)), Unquantize(raw, 8));
+    case RG8:
+        return vec4(Unquantize(raw >> 8, 8), Unquantize(raw, 8), 0.0, 1.0);
+    case D16:
+        return vec4(Unquantize(raw, 16));
+    case D24:
+        return vec4(Unquantize(raw, 24));
+    }
+    return vec4(0.0);
+}
+
+void main() {
+    mediump ivec2 tex_coord;
+    if (src_size == dst_size) {
+        tex_coord = ivec2(dst_coord);
+    } else {
+        highp int tex_index = int(dst_coord.y) * dst_size.x + int(dst_coord.x);
+        mediump int y = tex_index / src_size.x;
+        tex_coord = ivec2(tex_index - y * src_size.x, y);
+    }
+    tex_coord -= src_offset;
+
+    highp vec4 result = Encode(Decode(texelFetch(source, tex_coord, 0)));
+#ifdef DEPTH_OUTPUT
+    gl_FragDepth = result.r;
+#else
+    frag_color = result;
+#endif
+}
+)";
+
+        program.Create(vs_source.data(), fs_source.c_str());
+        dst_size_loc = glGetUniformLocation(program.handle, "dst_size");
+        src_size_loc = glGetUniformLocation(program.handle, "src_size");
+        src_offset_loc = glGetUniformLocation(program.handle, "src_offset");
+        src_format_loc = glGetUniformLocation(program.handle, "src_format");
+        dst_format_loc = glGetUniformLocation(program.handle, "dst_format");
+        vao.Create();
+    }
+
+    void Reinterpret(PixelFormat src_format, GLuint src_tex, const Common::Rectangle<u32>& src_rect,
+                     PixelFormat dst_format, GLuint dst_tex, const Common::Rectangle<u32>& dst_rect,
+                     GLuint draw_fb_handle) {
+        OpenGLState prev_state = OpenGLState::GetCurState();
+        SCOPE_EXIT({ prev_state.Apply(); });
+
+        OpenGLState state;
+        state.texture_units[0].texture_2d = src_tex;
+        state.draw.draw_framebuffer = draw_fb_handle;
+        state.draw.shader_program = program.handle;
+        state.draw.vertex_array = vao.handle;
+        state.viewport = {static_cast<GLint>(dst_rect.left), static_cast<GLint>(dst_rect.bottom),
+                          static_cast<GLsizei>(dst_rect.GetWidth()),
+                          static_cast<GLsizei>(dst_rect.GetHeight())};
+        if (depth_output) {
+            state.depth.test_enabled = true;
+            state.depth.test_func = GL_ALWAYS;
+            state.depth.write_mask = GL_TRUE;
+        }
+        state.Apply();
+
+        if (depth_output) {
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
+                                   0, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dst_tex,
+                                   0);
+        } else {
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                                   dst_tex, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
+                                   0, 0);
+        }
+
+        glUniform2i(dst_size_loc, dst_rect.GetWidth(), dst_rect.GetHeight());
+        glUniform2i(src_size_loc, src_rect.GetWidth(), src_rect.GetHeight());
+        glUniform2i(src_offset_loc, src_rect.left, src_rect.bottom);
+        glUniform1i(src_format_loc, static_cast<GLint>(src_format));
+        glUniform1i(dst_format_loc, static_cast<GLint>(dst_format));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+private:
+    bool depth_output;
+    OGLProgram program;
+    GLint dst_size_loc{-1}, src_size_loc{-1}, src_offset_loc{-1};
+    GLint src_format_loc{-1}, dst_format_loc{-1};
+    OGLVertexArray vao;
+};
+
+/// Reinterprets one pair of formats with the raw bits program shared by all pairs
+class RawBitsReinterpreter final : public FormatReinterpreterBase {
+public:
+    RawBitsReinterpreter(std::shared_ptr<RawBitsProgram> program, PixelFormat src_format,
+                         PixelFormat dst_format)
+        : program(std::move(program)), src_format(src_format), dst_format(dst_format) {}
+
+    void Reinterpret(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint read_fb_handle,
+                     GLuint dst_tex, const Common::Rectangle<u32>& dst_rect,
+                     GLuint draw_fb_handle) override {
+        program->Reinterpret(src_format, src_tex, src_rect, dst_format, dst_tex, dst_rect,
+                             draw_fb_handle);
+    }
+
+private:
+    std::shared_ptr<RawBitsProgram> program;
+    PixelFormat src_format;
+    PixelFormat dst_format;
+};
+
 FormatReinterpreterOpenGL::FormatReinterpreterOpenGL() {
     const std::string_view vendor{reinterpret_cast<const char*>(glGetString(GL_VENDOR))};
     const std::string_view version{reinterpret_cast<const char*>(glGetString(GL_VERSION))};
@@ -383,6 +602,31 @@ FormatReinterpreterOpenGL::FormatReinterpreterOpenGL() {
     }
     reinterpreters.emplace(PixelFormatPair{PixelFormat::RGB5A1, PixelFormat::RGBA4},
                            std::make_unique<RGBA4toRGB5A1>());
+
+    // Every other pair of render target or depth formats of the same size is converted through
+    // its raw bits. D24S8 is left out, as writing stencil from a shader is not widely supported.
+    static constexpr std::array<PixelFormat, 8> raw_formats{
+        PixelFormat::RGB8, PixelFormat::RGB5A1, PixelFormat::RGB565, PixelFormat::RGBA4,
+        PixelFormat::IA8,  PixelFormat::RG8,    PixelFormat::D16,    PixelFormat::D24,
+    };
+    const auto color_program = std::make_shared<RawBitsProgram>(false);
+    const auto depth_program = std::make_shared<RawBitsProgram>(true);
+    for (const PixelFormat dst_format : raw_formats) {
+        const bool depth_output =
+            SurfaceParams::GetFormatType(dst_format) == SurfaceParams::SurfaceType::Depth;
+        for (const PixelFormat src_format : raw_formats) {
+            const bool same_size =
+                SurfaceParams::GetFormatBpp(src_format) == SurfaceParams::GetFormatBpp(dst_format);
+            if (src_format == dst_format || !same_size) {
+                continue;
+            }
+            // Keeps the dedicated reinterpreters emplaced above
+            reinterpreters.emplace(PixelFormatPair{dst_format, src_format},
+                                   std::make_unique<RawBitsReinterpreter>(
+                                       depth_output ? depth_program : color_program, src_format,
+                                       dst_format));
+        }
+    }
 }
 
 FormatReinterpreterOpenGL::~FormatReinterpreterOpenGL() = default;
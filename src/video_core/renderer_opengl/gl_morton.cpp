@@ -0,0 +1,427 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include "common/assert.h"
+#include "video_core/renderer_opengl/gl_morton.h"
+#include "video_core/utils.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#define MORTON_HAVE_X64
+#elif defined(ARCHITECTURE_ARM64) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MORTON_HAVE_NEON
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MORTON_TARGET(isa)
+#else
+#define MORTON_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace OpenGL {
+
+namespace {
+
+constexpr u32 BytesPerTexel(MortonTileKind kind) {
+    return kind == MortonTileKind::Copy16 ? 2 : 4;
+}
+
+template <bool morton_to_gl, MortonTileKind kind>
+void ConvertTexel(u8* tile_ptr, u8* gl_ptr) {
+    if constexpr (kind == MortonTileKind::SwapBytes32) {
+        u8* dst = morton_to_gl ? gl_ptr : tile_ptr;
+        const u8* src = morton_to_gl ? tile_ptr : gl_ptr;
+        dst[0] = src[3];
+        dst[1] = src[2];
+        dst[2] = src[1];
+        dst[3] = src[0];
+    } else if constexpr (kind == MortonTileKind::D24S8) {
+        if constexpr (morton_to_gl) {
+            gl_ptr[0] = tile_ptr[3];
+            std::memcpy(gl_ptr + 1, tile_ptr, 3);
+        } else {
+            std::memcpy(tile_ptr, gl_ptr + 1, 3);
+            tile_ptr[3] = gl_ptr[0];
+        }
+    } else if constexpr (morton_to_gl) {
+        std::memcpy(gl_ptr, tile_ptr, BytesPerTexel(kind));
+    } else {
+        std::memcpy(tile_ptr, gl_ptr, BytesPerTexel(kind));
+    }
+}
+
+template <bool morton_to_gl, MortonTileKind kind>
+void MortonCopyTileScalar(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    constexpr u32 bytes_per_pixel = BytesPerTexel(kind);
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
+            u8* gl_ptr = gl_buffer + ((7 - y) * stride + x) * bytes_per_pixel;
+            ConvertTexel<morton_to_gl, kind>(tile_ptr, gl_ptr);
+        }
+    }
+}
+
+// The vector kernels below rely on the recursive structure of the Morton order. Each 8x8 tile
+// consists of four 4x4 quadrants of 16 consecutive texels, ordered (x2, y2) = (0,0), (1,0),
+// (0,1), (1,1). Within a quadrant, every run of two consecutive texels is a horizontal pair, so
+// two rows of a quadrant can be separated with 64-bit unpacks (4-byte texels) or a 32-bit
+// shuffle (2-byte texels).
+
+#ifdef MORTON_HAVE_X64
+
+template <bool morton_to_gl, MortonTileKind kind>
+MORTON_TARGET("ssse3")
+__m128i ConvertSSE(__m128i v) {
+    if constexpr (kind == MortonTileKind::SwapBytes32) {
+        const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+        return _mm_shuffle_epi8(v, mask);
+    } else if constexpr (kind == MortonTileKind::D24S8) {
+        if constexpr (morton_to_gl) {
+            return _mm_or_si128(_mm_slli_epi32(v, 8), _mm_srli_epi32(v, 24));
+        } else {
+            return _mm_or_si128(_mm_srli_epi32(v, 8), _mm_slli_epi32(v, 24));
+        }
+    } else {
+        return v;
+    }
+}
+
+template <bool morton_to_gl, MortonTileKind kind>
+MORTON_TARGET("ssse3")
+void MortonCopyTile32SSSE3(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    const std::size_t row_pitch = stride * 4;
+    for (u32 quadrant = 0; quadrant < 4; ++quadrant) {
+        u8* tile_ptr = tile_buffer + quadrant * 64;
+        const u32 x = (quadrant & 1) * 4;
+        const u32 y = (quadrant >> 1) * 4;
+        u8* gl_ptr = gl_buffer + (7 - y) * row_pitch + x * 4;
+        auto row = [&](u32 i) { return reinterpret_cast<__m128i*>(gl_ptr - i * row_pitch); };
+        auto texels = [&](u32 i) { return reinterpret_cast<__m128i*>(tile_ptr + i * 16); };
+
+        if constexpr (morton_to_gl) {
+            const __m128i t0 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(texels(0)));
+            const __m128i t1 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(texels(1)));
+            const __m128i t2 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(texels(2)));
+            const __m128i t3 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(texels(3)));
+            _mm_storeu_si128(row(0), _mm_unpacklo_epi64(t0, t1));
+            _mm_storeu_si128(row(1), _mm_unpackhi_epi64(t0, t1));
+            _mm_storeu_si128(row(2), _mm_unpacklo_epi64(t2, t3));
+            _mm_storeu_si128(row(3), _mm_unpackhi_epi64(t2, t3));
+        } else {
+            const __m128i r0 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(row(0)));
+            const __m128i r1 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(row(1)));
+            const __m128i r2 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(row(2)));
+            const __m128i r3 = ConvertSSE<morton_to_gl, kind>(_mm_loadu_si128(row(3)));
+            _mm_storeu_si128(texels(0), _mm_unpacklo_epi64(r0, r1));
+            _mm_storeu_si128(texels(1), _mm_unpackhi_epi64(r0, r1));
+            _mm_storeu_si128(texels(2), _mm_unpacklo_epi64(r2, r3));
+            _mm_storeu_si128(texels(3), _mm_unpackhi_epi64(r2, r3));
+        }
+    }
+}
+
+template <bool morton_to_gl>
+MORTON_TARGET("ssse3")
+void MortonCopyTile16SSSE3(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    const std::size_t row_pitch = stride * 2;
+    // Swaps the middle two dwords, turning [r0 x0-1, r1 x0-1, r0 x2-3, r1 x2-3] into two rows
+    constexpr int split_rows = _MM_SHUFFLE(3, 1, 2, 0);
+    for (u32 half = 0; half < 2; ++half) {
+        u8* left = tile_buffer + half * 64;
+        u8* right = left + 32;
+        u8* gl_ptr = gl_buffer + (7 - half * 4) * row_pitch;
+        auto row = [&](u32 i) { return reinterpret_cast<__m128i*>(gl_ptr - i * row_pitch); };
+
+        for (u32 i = 0; i < 2; ++i) {
+            auto* l = reinterpret_cast<__m128i*>(left + i * 16);
+            auto* r = reinterpret_cast<__m128i*>(right + i * 16);
+            if constexpr (morton_to_gl) {
+                const __m128i lo = _mm_shuffle_epi32(_mm_loadu_si128(l), split_rows);
+                const __m128i hi = _mm_shuffle_epi32(_mm_loadu_si128(r), split_rows);
+                _mm_storeu_si128(row(i * 2), _mm_unpacklo_epi64(lo, hi));
+                _mm_storeu_si128(row(i * 2 + 1), _mm_unpackhi_epi64(lo, hi));
+            } else {
+                const __m128i r0 = _mm_loadu_si128(row(i * 2));
+                const __m128i r1 = _mm_loadu_si128(row(i * 2 + 1));
+                _mm_storeu_si128(l, _mm_shuffle_epi32(_mm_unpacklo_epi64(r0, r1), split_rows));
+                _mm_storeu_si128(r, _mm_shuffle_epi32(_mm_unpackhi_epi64(r0, r1), split_rows));
+            }
+        }
+    }
+}
+
+template <bool morton_to_gl, MortonTileKind kind>
+MORTON_TARGET("avx2")
+__m256i ConvertAVX2(__m256i v) {
+    if constexpr (kind == MortonTileKind::SwapBytes32) {
+        const __m256i mask =
+            _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15,
+                            8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+        return _mm256_shuffle_epi8(v, mask);
+    } else if constexpr (kind == MortonTileKind::D24S8) {
+        if constexpr (morton_to_gl) {
+            return _mm256_or_si256(_mm256_slli_epi32(v, 8), _mm256_srli_epi32(v, 24));
+        } else {
+            return _mm256_or_si256(_mm256_srli_epi32(v, 8), _mm256_slli_epi32(v, 24));
+        }
+    } else {
+        return v;
+    }
+}
+
+template <bool morton_to_gl, MortonTileKind kind>
+MORTON_TARGET("avx2")
+void MortonCopyTile32AVX2(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    const std::size_t row_pitch = stride * 4;
+    // Reorders the qwords of eight texels into [row 0 x0-3, row 1 x0-3]; it is its own inverse
+    constexpr int split_rows = _MM_SHUFFLE(3, 1, 2, 0);
+    for (u32 half = 0; half < 2; ++half) {
+        u8* left = tile_buffer + half * 128;
+        u8* right = left + 64;
+        u8* gl_ptr = gl_buffer + (7 - half * 4) * row_pitch;
+        auto row = [&](u32 i) { return reinterpret_cast<__m256i*>(gl_ptr - i * row_pitch); };
+
+        for (u32 i = 0; i < 2; ++i) {
+            auto* l = reinterpret_cast<__m256i*>(left + i * 32);
+            auto* r = reinterpret_cast<__m256i*>(right + i * 32);
+            if constexpr (morton_to_gl) {
+                const __m256i tl = ConvertAVX2<morton_to_gl, kind>(_mm256_loadu_si256(l));
+                const __m256i tr = ConvertAVX2<morton_to_gl, kind>(_mm256_loadu_si256(r));
+                const __m256i lo = _mm256_permute4x64_epi64(tl, split_rows);
+                const __m256i hi = _mm256_permute4x64_epi64(tr, split_rows);
+                _mm256_storeu_si256(row(i * 2), _mm256_permute2x128_si256(lo, hi, 0x20));
+                _mm256_storeu_si256(row(i * 2 + 1), _mm256_permute2x128_si256(lo, hi, 0x31));
+            } else {
+                const __m256i r0 = ConvertAVX2<morton_to_gl, kind>(_mm256_loadu_si256(row(i * 2)));
+                const __m256i r1 =
+                    ConvertAVX2<morton_to_gl, kind>(_mm256_loadu_si256(row(i * 2 + 1)));
+                const __m256i lo = _mm256_permute2x128_si256(r0, r1, 0x20);
+                const __m256i hi = _mm256_permute2x128_si256(r0, r1, 0x31);
+                _mm256_storeu_si256(l, _mm256_permute4x64_epi64(lo, split_rows));
+                _mm256_storeu_si256(r, _mm256_permute4x64_epi64(hi, split_rows));
+            }
+        }
+    }
+}
+
+#endif // MORTON_HAVE_X64
+
+#ifdef MORTON_HAVE_NEON
+
+template <bool morton_to_gl, MortonTileKind kind>
+uint8x16_t ConvertNEON(uint8x16_t v) {
+    if constexpr (kind == MortonTileKind::SwapBytes32) {
+        return vrev32q_u8(v);
+    } else if constexpr (kind == MortonTileKind::D24S8) {
+        const uint32x4_t texels = vreinterpretq_u32_u8(v);
+        if constexpr (morton_to_gl) {
+            return vreinterpretq_u8_u32(vorrq_u32(vshlq_n_u32(texels, 8), vshrq_n_u32(texels, 24)));
+        } else {
+            return vreinterpretq_u8_u32(vorrq_u32(vshrq_n_u32(texels, 8), vshlq_n_u32(texels, 24)));
+        }
+    } else {
+        return v;
+    }
+}
+
+uint8x16_t CombineLow(uint8x16_t a, uint8x16_t b) {
+    return vcombine_u8(vget_low_u8(a), vget_low_u8(b));
+}
+
+uint8x16_t CombineHigh(uint8x16_t a, uint8x16_t b) {
+    return vcombine_u8(vget_high_u8(a), vget_high_u8(b));
+}
+
+/// Swaps the middle two 32-bit lanes; the NEON counterpart of _MM_SHUFFLE(3, 1, 2, 0)
+uint8x16_t SplitRows16(uint8x16_t v) {
+    const uint32x4_t lanes = vreinterpretq_u32_u8(v);
+    const uint32x2x2_t zipped = vzip_u32(vget_low_u32(lanes), vget_high_u32(lanes));
+    return vreinterpretq_u8_u32(vcombine_u32(zipped.val[0], zipped.val[1]));
+}
+
+template <bool morton_to_gl, MortonTileKind kind>
+void MortonCopyTile32NEON(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    const std::size_t row_pitch = stride * 4;
+    for (u32 quadrant = 0; quadrant < 4; ++quadrant) {
+        u8* tile_ptr = tile_buffer + quadrant * 64;
+        const u32 x = (quadrant & 1) * 4;
+        const u32 y = (quadrant >> 1) * 4;
+        u8* gl_ptr = gl_buffer + (7 - y) * row_pitch + x * 4;
+        auto row = [&](u32 i) { return gl_ptr - i * row_pitch; };
+        auto texels = [&](u32 i) { return tile_ptr + i * 16; };
+
+        if constexpr (morton_to_gl) {
+            const uint8x16_t t0 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(texels(0)));
+            const uint8x16_t t1 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(texels(1)));
+            const uint8x16_t t2 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(texels(2)));
+            const uint8x16_t t3 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(texels(3)));
+            vst1q_u8(row(0), CombineLow(t0, t1));
+            vst1q_u8(row(1), CombineHigh(t0, t1));
+            vst1q_u8(row(2), CombineLow(t2, t3));
+            vst1q_u8(row(3), CombineHigh(t2, t3));
+        } else {
+            const uint8x16_t r0 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(row(0)));
+            const uint8x16_t r1 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(row(1)));
+            const uint8x16_t r2 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(row(2)));
+            const uint8x16_t r3 = ConvertNEON<morton_to_gl, kind>(vld1q_u8(row(3)));
+            vst1q_u8(texels(0), CombineLow(r0, r1));
+            vst1q_u8(texels(1), CombineHigh(r0, r1));
+            vst1q_u8(texels(2), CombineLow(r2, r3));
+            vst1q_u8(texels(3), CombineHigh(r2, r3));
+        }
+    }
+}
+
+template <bool morton_to_gl>
+void MortonCopyTile16NEON(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    const std::size_t row_pitch = stride * 2;
+    for (u32 half = 0; half < 2; ++half) {
+        u8* left = tile_buffer + half * 64;
+        u8* right = left + 32;
+        u8* gl_ptr = gl_buffer + (7 - half * 4) * row_pitch;
+        auto row = [&](u32 i) { return gl_ptr - i * row_pitch; };
+
+        for (u32 i = 0; i < 2; ++i) {
+            u8* l = left + i * 16;
+            u8* r = right + i * 16;
+            if constexpr (morton_to_gl) {
+                const uint8x16_t lo = SplitRows16(vld1q_u8(l));
+                const uint8x16_t hi = SplitRows16(vld1q_u8(r));
+                vst1q_u8(row(i * 2), CombineLow(lo, hi));
+                vst1q_u8(row(i * 2 + 1), CombineHigh(lo, hi));
+            } else {
+                const uint8x16_t r0 = vld1q_u8(row(i * 2));
+                const uint8x16_t r1 = vld1q_u8(row(i * 2 + 1));
+                vst1q_u8(l, SplitRows16(CombineLow(r0, r1)));
+                vst1q_u8(r, SplitRows16(CombineHigh(r0, r1)));
+            }
+        }
+    }
+}
+
+#endif // MORTON_HAVE_NEON
+
+template <bool morton_to_gl>
+MortonTileFn GetScalarTileFn(MortonTileKind kind) {
+    switch (kind) {
+    case MortonTileKind::Copy16:
+        return MortonCopyTileScalar<morton_to_gl, MortonTileKind::Copy16>;
+    case MortonTileKind::Copy32:
+        return MortonCopyTileScalar<morton_to_gl, MortonTileKind::Copy32>;
+    case MortonTileKind::SwapBytes32:
+        return MortonCopyTileScalar<morton_to_gl, MortonTileKind::SwapBytes32>;
+    case MortonTileKind::D24S8:
+        return MortonCopyTileScalar<morton_to_gl, MortonTileKind::D24S8>;
+    }
+    UNREACHABLE();
+}
+
+#ifdef MORTON_HAVE_X64
+template <bool morton_to_gl>
+MortonTileFn GetSSSE3TileFn(MortonTileKind kind) {
+    switch (kind) {
+    case MortonTileKind::Copy16:
+        return MortonCopyTile16SSSE3<morton_to_gl>;
+    case MortonTileKind::Copy32:
+        return MortonCopyTile32SSSE3<morton_to_gl, MortonTileKind::Copy32>;
+    case MortonTileKind::SwapBytes32:
+        return MortonCopyTile32SSSE3<morton_to_gl, MortonTileKind::SwapBytes32>;
+    case MortonTileKind::D24S8:
+        return MortonCopyTile32SSSE3<morton_to_gl, MortonTileKind::D24S8>;
+    }
+    UNREACHABLE();
+}
+
+template <bool morton_to_gl>
+MortonTileFn GetAVX2TileFn(MortonTileKind kind) {
+    switch (kind) {
+    case MortonTileKind::Copy16:
+        // A row of 2-byte texels only fills half of a ymm register, the SSSE3 kernel is as fast
+        return MortonCopyTile16SSSE3<morton_to_gl>;
+    case MortonTileKind::Copy32:
+        return MortonCopyTile32AVX2<morton_to_gl, MortonTileKind::Copy32>;
+    case MortonTileKind::SwapBytes32:
+        return MortonCopyTile32AVX2<morton_to_gl, MortonTileKind::SwapBytes32>;
+    case MortonTileKind::D24S8:
+        return MortonCopyTile32AVX2<morton_to_gl, MortonTileKind::D24S8>;
+    }
+    UNREACHABLE();
+}
+#endif // MORTON_HAVE_X64
+
+#ifdef MORTON_HAVE_NEON
+template <bool morton_to_gl>
+MortonTileFn GetNEONTileFn(MortonTileKind kind) {
+    switch (kind) {
+    case MortonTileKind::Copy16:
+        return MortonCopyTile16NEON<morton_to_gl>;
+    case MortonTileKind::Copy32:
+        return MortonCopyTile32NEON<morton_to_gl, MortonTileKind::Copy32>;
+    case MortonTileKind::SwapBytes32:
+        return MortonCopyTile32NEON<morton_to_gl, MortonTileKind::SwapBytes32>;
+    case MortonTileKind::D24S8:
+        return MortonCopyTile32NEON<morton_to_gl, MortonTileKind::D24S8>;
+    }
+    UNREACHABLE();
+}
+#endif // MORTON_HAVE_NEON
+
+} // Anonymous namespace
+
+bool IsMortonBackendSupported(MortonBackend backend) {
+    switch (backend) {
+    case MortonBackend::Scalar:
+        return true;
+#ifdef MORTON_HAVE_X64
+    case MortonBackend::SSSE3:
+        return Common::GetCPUCaps().ssse3;
+    case MortonBackend::AVX2:
+        return Common::GetCPUCaps().avx2;
+#endif
+#ifdef MORTON_HAVE_NEON
+    case MortonBackend::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+MortonBackend GetHostMortonBackend() {
+    static const MortonBackend backend = [] {
+        for (const auto candidate :
+             {MortonBackend::AVX2, MortonBackend::SSSE3, MortonBackend::NEON}) {
+            if (IsMortonBackendSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return MortonBackend::Scalar;
+    }();
+    return backend;
+}
+
+MortonTileFn GetMortonTileFn(MortonTileKind kind, bool morton_to_gl, MortonBackend backend) {
+    switch (backend) {
+    case MortonBackend::Scalar:
+        return morton_to_gl ? GetScalarTileFn<true>(kind) : GetScalarTileFn<false>(kind);
+#ifdef MORTON_HAVE_X64
+    case MortonBackend::SSSE3:
+        return morton_to_gl ? GetSSSE3TileFn<true>(kind) : GetSSSE3TileFn<false>(kind);
+    case MortonBackend::AVX2:
+        return morton_to_gl ? GetAVX2TileFn<true>(kind) : GetAVX2TileFn<false>(kind);
+#endif
+#ifdef MORTON_HAVE_NEON
+    case MortonBackend::NEON:
+        return morton_to_gl ? GetNEONTileFn<true>(kind) : GetNEONTileFn<false>(kind);
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace OpenGL
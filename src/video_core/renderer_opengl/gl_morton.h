@@ -0,0 +1,52 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace OpenGL {
+
+/**
+ * Per-texel conversion applied while swizzling a tile between the 3DS Morton layout and the
+ * linear, bottom-up row layout expected by OpenGL. Formats that need a conversion other than
+ * these (RGB8 and D24) always go through the scalar path in the rasterizer cache.
+ */
+enum class MortonTileKind {
+    Copy16,      ///< 2 bytes per texel, copied as is (RGB5A1, RGB565, RGBA4, D16)
+    Copy32,      ///< 4 bytes per texel, copied as is (RGBA8)
+    SwapBytes32, ///< 4 bytes per texel, byte order reversed (RGBA8 on GLES)
+    D24S8,       ///< 4 bytes per texel, stencil byte moved from the top to the bottom
+};
+
+/// Implementations of the tile swizzlers, in order of preference within an architecture
+enum class MortonBackend {
+    Scalar,
+    SSSE3,
+    AVX2,
+    NEON,
+};
+
+/**
+ * Copies one 8x8 tile between Morton order and the OpenGL layout.
+ * @param stride Width of the destination/source OpenGL surface in texels
+ * @param tile_buffer Pointer to the Morton-ordered tile
+ * @param gl_buffer Pointer to the first texel of the tile in the OpenGL buffer, whose rows run
+ *                  bottom-up
+ */
+using MortonTileFn = void (*)(u32 stride, u8* tile_buffer, u8* gl_buffer);
+
+/// Returns true if the backend was compiled in and is supported by the host CPU
+bool IsMortonBackendSupported(MortonBackend backend);
+
+/// Returns the fastest backend supported by the host CPU. The result is computed only once.
+MortonBackend GetHostMortonBackend();
+
+/**
+ * Returns the tile swizzler of the given backend, or nullptr if the backend is not compiled in.
+ * The scalar backend is always available and serves as the reference for the other ones.
+ */
+MortonTileFn GetMortonTileFn(MortonTileKind kind, bool morton_to_gl, MortonBackend backend);
+
+} // namespace OpenGL
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -10,11 +11,13 @@
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/vector_math.h"
+#include "core/frame_counters.h"
 #include "core/hw/gpu.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
@@ -23,6 +26,7 @@
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/gl_vars.h"
+#include "video_core/renderer_opengl/gl_vertex_buffer_cache.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
@@ -51,9 +55,7 @@ static bool IsVendorIntel() {
 RasterizerOpenGL::RasterizerOpenGL()
     : is_amd(IsVendorAmd()), vertex_buffer(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, is_amd),
       uniform_buffer(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, false),
-      index_buffer(GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, false),
-      texture_buffer(GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE, false),
-      texture_lf_buffer(GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE, false) {
+      index_buffer(GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, false) {
 
     allow_shadow = GLES || (GLAD_GL_ARB_shader_image_load_store && GLAD_GL_ARB_shader_image_size &&
                             GLAD_GL_ARB_framebuffer_no_attachments);
@@ -106,8 +108,13 @@ RasterizerOpenGL::RasterizerOpenGL()
     uniform_block_data.proctex_diff_lut_dirty = true;
 
     glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_buffer_alignment);
+    // The LUTs uploaded along with the uniform blocks are addressed in units of their texels
+    uniform_buffer_alignment =
+        std::max(uniform_buffer_alignment, static_cast<GLint>(sizeof(GLvec4)));
     uniform_size_aligned_vs =
         Common::AlignUp<std::size_t>(sizeof(VSUniformData), uniform_buffer_alignment);
+    uniform_size_aligned_gs =
+        Common::AlignUp<std::size_t>(sizeof(GSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs =
         Common::AlignUp<std::size_t>(sizeof(UniformData), uniform_buffer_alignment);
 
@@ -158,11 +165,11 @@ RasterizerOpenGL::RasterizerOpenGL()
     state.texture_buffer_lut_rgba.texture_buffer = texture_buffer_lut_rgba.handle;
     state.Apply();
     glActiveTexture(TextureUnits::TextureBufferLUT_LF.Enum());
-    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, texture_lf_buffer.GetHandle());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, uniform_buffer.GetHandle());
     glActiveTexture(TextureUnits::TextureBufferLUT_RG.Enum());
-    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, texture_buffer.GetHandle());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, uniform_buffer.GetHandle());
     glActiveTexture(TextureUnits::TextureBufferLUT_RGBA.Enum());
-    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, texture_buffer.GetHandle());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, uniform_buffer.GetHandle());
 
     // Bind index buffer for hardware shader path
     state.draw.vertex_array = hw_vao.handle;
@@ -196,6 +203,8 @@ void RasterizerOpenGL::LoadDiskResources(const std::atomic_bool& stop_loading,
 }
 
 void RasterizerOpenGL::SyncEntireState() {
+    vs_dirty = true;
+
     // Sync fixed function OpenGL state
     SyncClipEnabled();
     SyncCullMode();
@@ -321,24 +330,50 @@ RasterizerOpenGL::VertexArrayInfo RasterizerOpenGL::AnalyzeVertexArray(bool is_i
     return {vertex_min, vertex_max, vs_input_size};
 }
 
-void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
-                                        GLuint vs_input_index_min, GLuint vs_input_index_max) {
+std::size_t RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
+                                               GLuint vs_input_index_min,
+                                               GLuint vs_input_index_max) {
     MICROPROFILE_SCOPE(OpenGL_VAO);
     const auto& regs = Pica::g_state.regs;
     const auto& vertex_attributes = regs.pipeline.vertex_attributes;
     PAddr base_address = vertex_attributes.GetPhysicalBaseAddress();
+    auto& vertex_buffer_cache = res_cache.GetVertexBufferCache();
 
     state.draw.vertex_array = hw_vao.handle;
-    state.draw.vertex_buffer = vertex_buffer.GetHandle();
-    state.Apply();
 
     std::array<bool, 16> enable_attributes{};
+    std::size_t streamed_size = 0;
 
     for (const auto& loader : vertex_attributes.attribute_loaders) {
         if (loader.component_count == 0 || loader.byte_count == 0) {
             continue;
         }
 
+        PAddr data_addr =
+            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
+
+        u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
+        u32 data_size = loader.byte_count * vertex_num;
+
+        res_cache.FlushRegion(data_addr, data_size, nullptr);
+
+        // Arrays that stay the same across frames are read from their cached buffer, the others
+        // are copied to the stream buffer
+        GLintptr array_offset;
+        if (const auto cached = vertex_buffer_cache.Get(data_addr, data_size)) {
+            state.draw.vertex_buffer = cached->buffer;
+            array_offset = cached->offset;
+        } else {
+            std::memcpy(array_ptr, VideoCore::g_memory->GetPhysicalPointer(data_addr), data_size);
+            state.draw.vertex_buffer = vertex_buffer.GetHandle();
+            array_offset = buffer_offset;
+
+            array_ptr += data_size;
+            buffer_offset += data_size;
+            streamed_size += data_size;
+        }
+        state.Apply();
+
         u32 offset = 0;
         for (u32 comp = 0; comp < loader.component_count && comp < 12; ++comp) {
             u32 attribute_index = loader.GetComponent(comp);
@@ -353,7 +388,7 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                         vertex_attributes.GetFormat(attribute_index))];
                     GLsizei stride = loader.byte_count;
                     glVertexAttribPointer(input_reg, size, type, GL_FALSE, stride,
-                                          reinterpret_cast<GLvoid*>(buffer_offset + offset));
+                                          reinterpret_cast<GLvoid*>(array_offset + offset));
                     enable_attributes[input_reg] = true;
 
                     offset += vertex_attributes.GetStride(attribute_index);
@@ -365,18 +400,6 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                 offset += (attribute_index - 11) * 4;
             }
         }
-
-        PAddr data_addr =
-            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
-
-        u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
-        u32 data_size = loader.byte_count * vertex_num;
-
-        res_cache.FlushRegion(data_addr, data_size, nullptr);
-        std::memcpy(array_ptr, VideoCore::g_memory->GetPhysicalPointer(data_addr), data_size);
-
-        array_ptr += data_size;
-        buffer_offset += data_size;
     }
 
     for (std::size_t i = 0; i < enable_attributes.size(); ++i) {
@@ -398,12 +421,18 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
             }
         }
     }
+    return streamed_size;
 }
 
 bool RasterizerOpenGL::SetupVertexShader() {
     MICROPROFILE_SCOPE(OpenGL_VS);
-    return shader_program_manager->UseProgrammableVertexShader(Pica::g_state.regs,
-                                                               Pica::g_state.vs);
+    if (!vs_dirty && shader_program_manager->UseLastProgrammableVertexShader()) {
+        return true;
+    }
+    // Stays dirty while the shader is compiled in the background
+    vs_dirty = !shader_program_manager->UseProgrammableVertexShader(Pica::g_state.regs,
+                                                                    Pica::g_state.vs);
+    return !vs_dirty;
 }
 
 bool RasterizerOpenGL::SetupGeometryShader() {
@@ -411,8 +440,7 @@ bool RasterizerOpenGL::SetupGeometryShader() {
     const auto& regs = Pica::g_state.regs;
 
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
-        LOG_ERROR(Render_OpenGL, "Accelerate draw doesn't support geometry shader");
-        return false;
+        return shader_program_manager->UseProgrammableGeometryShader(regs, Pica::g_state.gs);
     }
 
     shader_program_manager->UseFixedGeometryShader(regs);
@@ -420,9 +448,18 @@ bool RasterizerOpenGL::SetupGeometryShader() {
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
+    FlushTriangles();
+    if (IsDrawSkipped()) {
+        return true;
+    }
+
     const auto& regs = Pica::g_state.regs;
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
-        if (regs.pipeline.gs_config.mode != Pica::PipelineRegs::GSMode::Point) {
+        // Variable primitive mode and vertex counts without a GL input primitive are left to
+        // the software geometry pipeline
+        const u32 vertices_per_primitive = GetGSVerticesPerPrimitive(regs);
+        if (vertices_per_primitive == 0 ||
+            regs.pipeline.num_vertices % vertices_per_primitive != 0) {
             return false;
         }
         if (regs.pipeline.triangle_topology != Pica::PipelineRegs::TriangleTopology::Shader) {
@@ -441,6 +478,21 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
 
 static GLenum GetCurrentPrimitiveMode() {
     const auto& regs = Pica::g_state.regs;
+    if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
+        // The vertices are grouped like the geometry shader reads them
+        switch (GetGSVerticesPerPrimitive(regs)) {
+        case 1:
+            return GL_POINTS;
+        case 2:
+            return GL_LINES;
+        case 4:
+            return GL_LINES_ADJACENCY;
+        case 6:
+            return GL_TRIANGLES_ADJACENCY;
+        default:
+            return GL_TRIANGLES;
+        }
+    }
     switch (regs.pipeline.triangle_topology) {
     case Pica::PipelineRegs::TriangleTopology::Shader:
     case Pica::PipelineRegs::TriangleTopology::List:
@@ -471,8 +523,12 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
     u8* buffer_ptr;
     GLintptr buffer_offset;
     std::tie(buffer_ptr, buffer_offset, std::ignore) = vertex_buffer.Map(vs_input_size, 4);
-    SetupVertexArray(buffer_ptr, buffer_offset, vs_input_index_min, vs_input_index_max);
-    vertex_buffer.Unmap(vs_input_size);
+    const std::size_t streamed_size =
+        SetupVertexArray(buffer_ptr, buffer_offset, vs_input_index_min, vs_input_index_max);
+    // Cached arrays may have been bound or uploaded since the stream buffer was mapped
+    state.draw.vertex_buffer = vertex_buffer.GetHandle();
+    state.Apply();
+    vertex_buffer.Unmap(streamed_size);
 
     shader_program_manager->ApplyTo(state);
     state.Apply();
@@ -493,26 +549,63 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
         std::memcpy(buffer_ptr, index_data, index_buffer_size);
         index_buffer.Unmap(index_buffer_size);
 
+        Core::CountFrameEvent(Core::FrameCounter::Draws);
         glDrawRangeElementsBaseVertex(
             primitive_mode, vs_input_index_min, vs_input_index_max, regs.pipeline.num_vertices,
             index_u16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
             reinterpret_cast<const void*>(buffer_offset), -static_cast<GLint>(vs_input_index_min));
     } else {
+        Core::CountFrameEvent(Core::FrameCounter::Draws);
         glDrawArrays(primitive_mode, 0, regs.pipeline.num_vertices);
     }
     return true;
 }
 
 void RasterizerOpenGL::DrawTriangles() {
+    // Consecutive draws are merged into a single vertex stream upload and draw call, which is
+    // flushed once state that affects how they are rasterized changes, see
+    // NotifyPicaRegisterWrite. This mostly helps immediate mode, which draws every triangle.
+}
+
+void RasterizerOpenGL::FlushTriangles() {
     if (vertex_batch.empty())
         return;
     Draw(false, false);
+    // Also drop the triangles of a draw skipped while its shader compiles
+    vertex_batch.clear();
+}
+
+bool RasterizerOpenGL::IsDrawSkipped() const {
+    if (!frame_skipped) {
+        return false;
+    }
+    const auto& framebuffer = Pica::g_state.regs.framebuffer.framebuffer;
+    const u32 pixels = framebuffer.GetWidth() * framebuffer.GetHeight();
+    const u32 color_size =
+        pixels * Pica::FramebufferRegs::BytesPerColorPixel(framebuffer.color_format);
+    const u32 depth_size =
+        pixels * Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
+    return !res_cache.IsReadBack(framebuffer.GetColorBufferPhysicalAddress(), color_size) &&
+           !res_cache.IsReadBack(framebuffer.GetDepthBufferPhysicalAddress(), depth_size);
 }
 
 bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(OpenGL_Drawing);
     const auto& regs = Pica::g_state.regs;
 
+    if (IsDrawSkipped()) {
+        return true;
+    }
+
+    // Sync and bind the shader. Draws are skipped while it is being compiled in the background,
+    // unless the ubershader can stand in for it until the specialized shader is ready.
+    if (shader_dirty) {
+        if (!SetShader()) {
+            return true;
+        }
+        shader_dirty = shader_program_manager->IsUsingFragmentUbershader();
+    }
+
     bool shadow_rendering = regs.framebuffer.output_merger.fragment_operation_mode ==
                             Pica::FramebufferRegs::FragmentOperationMode::Shadow;
 
@@ -575,7 +668,21 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     state.draw.draw_framebuffer = framebuffer.handle;
     state.Apply();
 
-    if (shadow_rendering) {
+    // With framebuffer fetch, the shadow map is read and written as the color attachment instead
+    // of an image, which needs neither atomics nor a memory barrier
+    const bool fetch_shadow = shadow_rendering && framebuffer_fetch != FramebufferFetch::None;
+    if (fetch_shadow) {
+        if (color_surface == nullptr) {
+            return true;
+        }
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               color_surface->texture.handle, 0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
+                               0);
+        // Every channel holds part of the shadow value, written as is
+        state.blend.enabled = false;
+        state.color_mask = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+    } else if (shadow_rendering) {
         if (!allow_shadow || color_surface == nullptr) {
             return true;
         }
@@ -782,7 +889,15 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     }
 
     OGLTexture temp_tex;
-    if (need_duplicate_texture && (GLAD_GL_ARB_copy_image || GLES)) {
+    if (need_duplicate_texture && texture_barrier) {
+        // Makes what earlier draws rendered visible to the texture fetches of this one, which is
+        // defined as long as the draw does not sample the texels it writes
+        if (GLAD_GL_ARB_texture_barrier) {
+            glTextureBarrier();
+        } else {
+            glTextureBarrierNV();
+        }
+    } else if (need_duplicate_texture && (GLAD_GL_ARB_copy_image || GLES)) {
         // The game is trying to use a surface as a texture and framebuffer at the same time
         // which causes unpredictable behavior on the host.
         // Making a copy to sample from eliminates this issue and seems to be fairly cheap.
@@ -818,17 +933,7 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         }
     }
 
-    // Sync and bind the shader
-    if (shader_dirty) {
-        SetShader();
-        shader_dirty = false;
-    }
-
-    // Sync the LUTs within the texture buffer
-    SyncAndUploadLUTs();
-    SyncAndUploadLUTsLF();
-
-    // Sync the uniform data
+    // Sync the LUTs and the uniform data
     UploadUniforms(accelerate);
 
     // Viewport can have negative offsets or larger
@@ -865,6 +970,7 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
                 vertex_buffer.Map(vertex_size, sizeof(HardwareVertex));
             std::memcpy(vbo, vertex_batch.data() + base_vertex, vertex_size);
             vertex_buffer.Unmap(vertex_size);
+            Core::CountFrameEvent(Core::FrameCounter::Draws);
             glDrawArrays(GL_TRIANGLES, static_cast<GLint>(offset / sizeof(HardwareVertex)),
                          static_cast<GLsizei>(vertices));
         }
@@ -886,9 +992,14 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         state.image_shadow_texture_nz = 0;
         state.image_shadow_buffer = 0;
     }
+    if (fetch_shadow) {
+        SyncBlendEnabled();
+        SyncColorWriteMask();
+        SyncLogicOp();
+    }
     state.Apply();
 
-    if (shadow_rendering) {
+    if (shadow_rendering && !fetch_shadow) {
         glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
                         GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
     }
@@ -912,10 +1023,77 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     return succeeded;
 }
 
+void RasterizerOpenGL::NotifyPicaRegisterWrite(u32 id, u32 value) {
+    // Batched triangles have already been through the vertex pipeline, so only the state read
+    // when drawing them has to stay the same until they are flushed
+    if (vertex_batch.empty() || id >= PICA_REG_INDEX(pipeline)) {
+        return;
+    }
+
+    switch (id) {
+    // These take effect whenever they are written, even with the same value
+    case PICA_REG_INDEX(trigger_irq):
+    case PICA_REG_INDEX(lighting.lut_data[0]):
+    case PICA_REG_INDEX(lighting.lut_data[1]):
+    case PICA_REG_INDEX(lighting.lut_data[2]):
+    case PICA_REG_INDEX(lighting.lut_data[3]):
+    case PICA_REG_INDEX(lighting.lut_data[4]):
+    case PICA_REG_INDEX(lighting.lut_data[5]):
+    case PICA_REG_INDEX(lighting.lut_data[6]):
+    case PICA_REG_INDEX(lighting.lut_data[7]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[0]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[1]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[2]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[3]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[4]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[5]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[6]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[7]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[0]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[1]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[2]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[3]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[4]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[5]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[6]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[7]):
+        FlushTriangles();
+        break;
+    default:
+        // Games often set up the same state again before every draw
+        if (Pica::g_state.regs.reg_array[id] != value) {
+            FlushTriangles();
+        }
+        break;
+    }
+}
+
 void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     const auto& regs = Pica::g_state.regs;
 
     switch (id) {
+    // Vertex shader config
+    case PICA_REG_INDEX(vs.main_offset):
+    case PICA_REG_INDEX(vs.output_mask):
+    case PICA_REG_INDEX(vs.program.set_word[0]):
+    case PICA_REG_INDEX(vs.program.set_word[1]):
+    case PICA_REG_INDEX(vs.program.set_word[2]):
+    case PICA_REG_INDEX(vs.program.set_word[3]):
+    case PICA_REG_INDEX(vs.program.set_word[4]):
+    case PICA_REG_INDEX(vs.program.set_word[5]):
+    case PICA_REG_INDEX(vs.program.set_word[6]):
+    case PICA_REG_INDEX(vs.program.set_word[7]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[1]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[2]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[3]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[4]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[5]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[6]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[7]):
+        vs_dirty = true;
+        break;
+
     // Culling
     case PICA_REG_INDEX(rasterizer.cull_mode):
         SyncCullMode();
@@ -1412,30 +1590,47 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
 
 void RasterizerOpenGL::FlushAll() {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushTriangles();
     res_cache.FlushAll();
 }
 
 void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushTriangles();
+    res_cache.MarkReadBack(addr, size);
     res_cache.FlushRegion(addr, size);
 }
 
 void RasterizerOpenGL::InvalidateRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushTriangles();
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushTriangles();
+    res_cache.MarkReadBack(addr, size);
     res_cache.FlushRegion(addr, size);
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
 void RasterizerOpenGL::ClearAll(bool flush) {
+    FlushTriangles();
     res_cache.ClearAll(flush);
 }
 
+void RasterizerOpenGL::TickFrame() {
+    res_cache.TickFrame();
+}
+
+void RasterizerOpenGL::SetFrameSkipped(bool skipped) {
+    frame_skipped = skipped;
+}
+
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
+    FlushTriangles();
+
     MICROPROFILE_SCOPE(OpenGL_Blits);
 
     SurfaceParams src_params;
@@ -1457,6 +1652,11 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
     dst_params.pixel_format = SurfaceParams::PixelFormatFromGPUPixelFormat(config.output_format);
     dst_params.UpdateParams();
 
+    // The source still has to be drawn in skipped frames when the copy is read back
+    if (res_cache.IsReadBack(dst_params.addr, dst_params.size)) {
+        res_cache.MarkReadBack(src_params.addr, src_params.size);
+    }
+
     Common::Rectangle<u32> src_rect;
     Surface src_surface;
     std::tie(src_surface, src_rect) =
@@ -1487,6 +1687,8 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
 }
 
 bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) {
+    FlushTriangles();
+
     u32 copy_size = Common::AlignDown(config.texture_copy.size, 16);
     if (copy_size == 0) {
         return false;
@@ -1549,6 +1751,10 @@ bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferCon
     dst_params.res_scale = src_surface->res_scale;
     dst_params.UpdateParams();
 
+    if (res_cache.IsReadBack(dst_params.addr, dst_params.size)) {
+        res_cache.MarkReadBack(src_params.addr, src_params.size);
+    }
+
     // Since we are going to invalidate the gap if there is one, we will have to load it first
     const bool load_gap = output_gap != 0;
     Common::Rectangle<u32> dst_rect;
@@ -1572,6 +1778,8 @@ bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferCon
 }
 
 bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config) {
+    FlushTriangles();
+
     Surface dst_surface = res_cache.GetFillSurface(config);
     if (dst_surface == nullptr)
         return false;
@@ -1583,6 +1791,8 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
 bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& config,
                                          PAddr framebuffer_addr, u32 pixel_stride,
                                          ScreenInfo& screen_info) {
+    FlushTriangles();
+
     if (framebuffer_addr == 0) {
         return false;
     }
@@ -1614,6 +1824,7 @@ bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& con
         (float)src_rect.top / (float)scaled_height, (float)src_rect.right / (float)scaled_width);
 
     screen_info.display_texture = src_surface->texture.handle;
+    screen_info.display_write_tick = src_surface->write_tick;
 
     return true;
 }
@@ -1693,8 +1904,8 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(
     }
 }
 
-void RasterizerOpenGL::SetShader() {
-    shader_program_manager->UseFragmentShader(Pica::g_state.regs);
+bool RasterizerOpenGL::SetShader() {
+    return shader_program_manager->UseFragmentShader(Pica::g_state.regs);
 }
 
 void RasterizerOpenGL::SyncClipEnabled() {
@@ -2039,20 +2250,24 @@ void RasterizerOpenGL::SyncShadowTextureBias() {
     }
 }
 
-void RasterizerOpenGL::SyncAndUploadLUTsLF() {
-    constexpr std::size_t max_size =
-        sizeof(GLvec2) * 256 * Pica::LightingRegs::NumLightingSampler + sizeof(GLvec2) * 128; // fog
-
-    if (!uniform_block_data.lighting_lut_dirty_any && !uniform_block_data.fog_lut_dirty) {
-        return;
+template <typename T, std::size_t N>
+GLint RasterizerOpenGL::UploadLUT(const std::array<T, N>& data, u8* buffer, GLintptr offset,
+                                  std::size_t& bytes_used) {
+    // Games often switch between a few LUT sets, whose earlier copies are rebound by offset
+    constexpr std::size_t size = sizeof(T) * N;
+    const u64 hash = Common::ComputeFastHash64(data.data(), size);
+    const auto [it, inserted] = uploaded_luts.try_emplace(hash, offset + bytes_used);
+    if (inserted) {
+        std::memcpy(buffer + bytes_used, data.data(), size);
+        bytes_used += size;
+        Core::CountFrameEvent(Core::FrameCounter::LUTUploads);
     }
+    uniform_block_data.dirty = true;
+    return static_cast<GLint>(it->second / sizeof(T));
+}
 
-    u8* buffer;
-    GLintptr offset;
-    bool invalidate;
+std::size_t RasterizerOpenGL::SyncAndUploadLUTsLF(u8* buffer, GLintptr offset, bool invalidate) {
     std::size_t bytes_used = 0;
-    glBindBuffer(GL_TEXTURE_BUFFER, texture_lf_buffer.GetHandle());
-    std::tie(buffer, offset, invalidate) = texture_lf_buffer.Map(max_size, sizeof(GLvec4));
 
     // Sync the lighting luts
     if (uniform_block_data.lighting_lut_dirty_any || invalidate) {
@@ -2067,12 +2282,8 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
 
                 if (new_data != lighting_lut_data[index] || invalidate) {
                     lighting_lut_data[index] = new_data;
-                    std::memcpy(buffer + bytes_used, new_data.data(),
-                                new_data.size() * sizeof(GLvec2));
                     uniform_block_data.data.lighting_lut_offset[index / 4][index % 4] =
-                        static_cast<GLint>((offset + bytes_used) / sizeof(GLvec2));
-                    uniform_block_data.dirty = true;
-                    bytes_used += new_data.size() * sizeof(GLvec2);
+                        UploadLUT(new_data, buffer, offset, bytes_used);
                 }
                 uniform_block_data.lighting_lut_dirty[index] = false;
             }
@@ -2091,36 +2302,17 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
 
         if (new_data != fog_lut_data || invalidate) {
             fog_lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec2));
             uniform_block_data.data.fog_lut_offset =
-                static_cast<GLint>((offset + bytes_used) / sizeof(GLvec2));
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec2);
+                UploadLUT(new_data, buffer, offset, bytes_used);
         }
         uniform_block_data.fog_lut_dirty = false;
     }
 
-    texture_lf_buffer.Unmap(bytes_used);
+    return bytes_used;
 }
 
-void RasterizerOpenGL::SyncAndUploadLUTs() {
-    constexpr std::size_t max_size = sizeof(GLvec2) * 128 * 3 + // proctex: noise + color + alpha
-                                     sizeof(GLvec4) * 256 +     // proctex
-                                     sizeof(GLvec4) * 256;      // proctex diff
-
-    if (!uniform_block_data.proctex_noise_lut_dirty &&
-        !uniform_block_data.proctex_color_map_dirty &&
-        !uniform_block_data.proctex_alpha_map_dirty && !uniform_block_data.proctex_lut_dirty &&
-        !uniform_block_data.proctex_diff_lut_dirty) {
-        return;
-    }
-
-    u8* buffer;
-    GLintptr offset;
-    bool invalidate;
+std::size_t RasterizerOpenGL::SyncAndUploadLUTs(u8* buffer, GLintptr offset, bool invalidate) {
     std::size_t bytes_used = 0;
-    glBindBuffer(GL_TEXTURE_BUFFER, texture_buffer.GetHandle());
-    std::tie(buffer, offset, invalidate) = texture_buffer.Map(max_size, sizeof(GLvec4));
 
     // helper function for SyncProcTexNoiseLUT/ColorMap/AlphaMap
     auto SyncProcTexValueLUT = [this, buffer, offset, invalidate, &bytes_used](
@@ -2133,10 +2325,7 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
 
         if (new_data != lut_data || invalidate) {
             lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec2));
-            lut_offset = static_cast<GLint>((offset + bytes_used) / sizeof(GLvec2));
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec2);
+            lut_offset = UploadLUT(new_data, buffer, offset, bytes_used);
         }
     };
 
@@ -2174,11 +2363,8 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
 
         if (new_data != proctex_lut_data || invalidate) {
             proctex_lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec4));
             uniform_block_data.data.proctex_lut_offset =
-                static_cast<GLint>((offset + bytes_used) / sizeof(GLvec4));
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec4);
+                UploadLUT(new_data, buffer, offset, bytes_used);
         }
         uniform_block_data.proctex_lut_dirty = false;
     }
@@ -2196,31 +2382,65 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
 
         if (new_data != proctex_diff_lut_data || invalidate) {
             proctex_diff_lut_data = new_data;
-            std::memcpy(buffer + bytes_used, new_data.data(), new_data.size() * sizeof(GLvec4));
             uniform_block_data.data.proctex_diff_lut_offset =
-                static_cast<GLint>((offset + bytes_used) / sizeof(GLvec4));
-            uniform_block_data.dirty = true;
-            bytes_used += new_data.size() * sizeof(GLvec4);
+                UploadLUT(new_data, buffer, offset, bytes_used);
         }
         uniform_block_data.proctex_diff_lut_dirty = false;
     }
 
-    texture_buffer.Unmap(bytes_used);
+    return bytes_used;
 }
 
 void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
+    constexpr std::size_t max_lut_size =
+        sizeof(GLvec2) * 256 * Pica::LightingRegs::NumLightingSampler + // lighting
+        sizeof(GLvec2) * 128 +                                          // fog
+        sizeof(GLvec2) * 128 * 3 + // proctex: noise + color + alpha
+        sizeof(GLvec4) * 256 +     // proctex
+        sizeof(GLvec4) * 256;      // proctex diff
+
     // glBindBufferRange below also changes the generic buffer binding point, so we sync the state
     // first
     state.draw.uniform_buffer = uniform_buffer.GetHandle();
     state.Apply();
 
-    bool sync_vs = accelerate_draw;
-    bool sync_fs = uniform_block_data.dirty;
-
-    if (!sync_vs && !sync_fs)
+    // The vertex shader uniforms are gathered for every accelerated draw, but most draws use the
+    // same ones as the previous draw
+    VSUniformData vs_uniforms;
+    bool sync_vs = false;
+    if (accelerate_draw) {
+        // Clear the padding, which is hashed too
+        std::memset(&vs_uniforms, 0, sizeof(vs_uniforms));
+        vs_uniforms.uniforms.SetFromRegs(Pica::g_state.regs.vs, Pica::g_state.vs);
+        const u64 hash = Common::ComputeFastStructHash64(vs_uniforms);
+        sync_vs = hash != vs_uniforms_hash;
+        vs_uniforms_hash = hash;
+    }
+
+    GSUniformData gs_uniforms;
+    bool sync_gs = false;
+    const bool use_gs =
+        accelerate_draw && Pica::g_state.regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No;
+    if (use_gs) {
+        std::memset(&gs_uniforms, 0, sizeof(gs_uniforms));
+        gs_uniforms.uniforms.SetFromRegs(Pica::g_state.regs.gs, Pica::g_state.gs);
+        const u64 hash = Common::ComputeFastStructHash64(gs_uniforms);
+        sync_gs = hash != gs_uniforms_hash;
+        gs_uniforms_hash = hash;
+    }
+
+    const bool sync_luts =
+        uniform_block_data.lighting_lut_dirty_any || uniform_block_data.fog_lut_dirty ||
+        uniform_block_data.proctex_noise_lut_dirty || uniform_block_data.proctex_color_map_dirty ||
+        uniform_block_data.proctex_alpha_map_dirty || uniform_block_data.proctex_lut_dirty ||
+        uniform_block_data.proctex_diff_lut_dirty;
+
+    if (!sync_vs && !sync_gs && !sync_luts && !uniform_block_data.dirty)
         return;
 
-    std::size_t uniform_size = uniform_size_aligned_vs + uniform_size_aligned_fs;
+    // Everything that changed goes into a single chunk of the buffer
+    std::size_t uniform_size = uniform_size_aligned_vs + uniform_size_aligned_gs + max_lut_size +
+                               uniform_buffer_alignment + uniform_size_aligned_fs;
     std::size_t used_bytes = 0;
     u8* uniforms;
     GLintptr offset;
@@ -2228,16 +2448,37 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     std::tie(uniforms, offset, invalidate) =
         uniform_buffer.Map(uniform_size, uniform_buffer_alignment);
 
-    if (sync_vs) {
-        VSUniformData vs_uniforms;
-        vs_uniforms.uniforms.SetFromRegs(Pica::g_state.regs.vs, Pica::g_state.vs);
+    // Reallocating the buffer discards the blocks and LUTs that were not uploaded again
+    if (invalidate && !accelerate_draw) {
+        vs_uniforms_hash = 0;
+    }
+    if (invalidate && !use_gs) {
+        gs_uniforms_hash = 0;
+    }
+    if (invalidate) {
+        uploaded_luts.clear();
+    }
+
+    if (sync_vs || (invalidate && accelerate_draw)) {
         std::memcpy(uniforms + used_bytes, &vs_uniforms, sizeof(vs_uniforms));
         glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::VS),
                           uniform_buffer.GetHandle(), offset + used_bytes, sizeof(VSUniformData));
         used_bytes += uniform_size_aligned_vs;
     }
 
-    if (sync_fs || invalidate) {
+    if (sync_gs || (invalidate && use_gs)) {
+        std::memcpy(uniforms + used_bytes, &gs_uniforms, sizeof(gs_uniforms));
+        glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::GS),
+                          uniform_buffer.GetHandle(), offset + used_bytes, sizeof(GSUniformData));
+        used_bytes += uniform_size_aligned_gs;
+    }
+
+    // The LUTs are placed before the fragment uniforms, which hold their offsets
+    used_bytes += SyncAndUploadLUTsLF(uniforms + used_bytes, offset + used_bytes, invalidate);
+    used_bytes += SyncAndUploadLUTs(uniforms + used_bytes, offset + used_bytes, invalidate);
+
+    if (uniform_block_data.dirty || invalidate) {
+        used_bytes = Common::AlignUp<std::size_t>(used_bytes, uniform_buffer_alignment);
         std::memcpy(uniforms + used_bytes, &uniform_block_data.data, sizeof(UniformData));
         glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::Common),
                           uniform_buffer.GetHandle(), offset + used_bytes, sizeof(UniformData));
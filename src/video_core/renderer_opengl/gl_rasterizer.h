@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <glad/glad.h>
 #include "common/bit_field.h"
@@ -47,12 +48,15 @@ public:
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
     void DrawTriangles() override;
+    void NotifyPicaRegisterWrite(u32 id, u32 value) override;
     void NotifyPicaRegisterChanged(u32 id) override;
     void FlushAll() override;
     void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override;
     void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
     void ClearAll(bool flush) override;
+    void TickFrame() override;
+    void SetFrameSkipped(bool skipped) override;
     bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
@@ -140,8 +144,9 @@ private:
     /// Syncs the clip coefficients to match the PICA register
     void SyncClipCoef();
 
-    /// Sets the OpenGL shader in accordance with the current PICA register state
-    void SetShader();
+    /// Sets the OpenGL shader in accordance with the current PICA register state. Returns false if
+    /// the shader is not compiled yet.
+    bool SetShader();
 
     /// Syncs the cull mode to match the PICA register
     void SyncCullMode();
@@ -231,16 +236,38 @@ private:
     /// Syncs the shadow texture bias to match the PICA register
     void SyncShadowTextureBias();
 
-    /// Syncs and uploads the lighting, fog and proctex LUTs
-    void SyncAndUploadLUTs();
-    void SyncAndUploadLUTsLF();
-
-    /// Upload the uniform blocks to the uniform buffer object
+    /**
+     * Syncs the lighting, fog and proctex LUTs, writing the ones that changed to the uniform buffer
+     * @param buffer Mapped chunk of the uniform buffer to write to
+     * @param offset Offset of the chunk within the buffer
+     * @param invalidate Writes all the LUTs, as the previous uploads were discarded
+     * @returns The number of bytes written
+     */
+    std::size_t SyncAndUploadLUTs(u8* buffer, GLintptr offset, bool invalidate);
+    std::size_t SyncAndUploadLUTsLF(u8* buffer, GLintptr offset, bool invalidate);
+
+    /**
+     * Writes the LUT to the uniform buffer at buffer + bytes_used, unless the same data was
+     * written since the buffer was last invalidated.
+     * @returns the offset of the LUT in the texture buffers, in elements
+     */
+    template <typename T, std::size_t N>
+    GLint UploadLUT(const std::array<T, N>& data, u8* buffer, GLintptr offset,
+                    std::size_t& bytes_used);
+
+    /// Upload the LUTs and uniform blocks that changed to the uniform buffer object
     void UploadUniforms(bool accelerate_draw);
 
-    /// Generic draw function for DrawTriangles and AccelerateDrawBatch
+    /// Generic draw function for FlushTriangles and AccelerateDrawBatch
     bool Draw(bool accelerate, bool is_indexed);
 
+    /// Draws the triangles collected from the software vertex pipeline in one batch
+    void FlushTriangles();
+
+    /// Returns true if the current draw can be dropped, as the frame is skipped and nothing reads
+    /// back the framebuffer it renders to
+    bool IsDrawSkipped() const;
+
     /// Internal implementation for AccelerateDrawBatch
     bool AccelerateDrawBatchInternal(bool is_indexed);
 
@@ -253,9 +280,13 @@ private:
     /// Retrieve the range and the size of the input vertex
     VertexArrayInfo AnalyzeVertexArray(bool is_indexed);
 
-    /// Setup vertex array for AccelerateDrawBatch
-    void SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
-                          GLuint vs_input_index_max);
+    /**
+     * Setup vertex array for AccelerateDrawBatch. Arrays that are not in the vertex buffer cache
+     * are copied to array_ptr.
+     * @returns the number of bytes written to array_ptr
+     */
+    std::size_t SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
+                                 GLuint vs_input_index_max);
 
     /// Setup vertex shader for AccelerateDrawBatch
     bool SetupVertexShader();
@@ -274,6 +305,12 @@ private:
 
     bool shader_dirty = true;
 
+    /// Set while the current frame will not be presented
+    bool frame_skipped = false;
+
+    /// Set when a register the vertex shader config is built from has been written
+    bool vs_dirty = true;
+
     struct {
         UniformData data;
         std::array<bool, Pica::LightingRegs::NumLightingSampler> lighting_lut_dirty;
@@ -293,7 +330,6 @@ private:
     static constexpr std::size_t VERTEX_BUFFER_SIZE = 16 * 1024 * 1024;
     static constexpr std::size_t INDEX_BUFFER_SIZE = 1 * 1024 * 1024;
     static constexpr std::size_t UNIFORM_BUFFER_SIZE = 2 * 1024 * 1024;
-    static constexpr std::size_t TEXTURE_BUFFER_SIZE = 1 * 1024 * 1024;
 
     OGLVertexArray sw_vao; // VAO for software shader draw
     OGLVertexArray hw_vao; // VAO for hardware shader / accelerate draw
@@ -301,14 +337,15 @@ private:
 
     std::array<SamplerInfo, 3> texture_samplers;
     OGLStreamBuffer vertex_buffer;
-    OGLStreamBuffer uniform_buffer;
+    OGLStreamBuffer uniform_buffer; // Also holds the LUTs read through the texture buffers
     OGLStreamBuffer index_buffer;
-    OGLStreamBuffer texture_buffer;
-    OGLStreamBuffer texture_lf_buffer;
     OGLFramebuffer framebuffer;
     GLint uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs;
+    std::size_t uniform_size_aligned_gs;
     std::size_t uniform_size_aligned_fs;
+    u64 vs_uniforms_hash = 0; ///< Hash of the vertex shader uniforms bound last
+    u64 gs_uniforms_hash = 0; ///< Hash of the geometry shader uniforms bound last
 
     SamplerInfo texture_cube_sampler;
 
@@ -324,6 +361,9 @@ private:
     std::array<GLvec4, 256> proctex_lut_data{};
     std::array<GLvec4, 256> proctex_diff_lut_data{};
 
+    /// Byte offsets of the LUTs in the uniform buffer since it was last invalidated, by hash
+    std::unordered_map<u64, GLintptr> uploaded_luts;
+
     bool allow_shadow;
 };
 
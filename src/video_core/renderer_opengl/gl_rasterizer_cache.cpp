@@ -11,6 +11,8 @@
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <thread>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -19,6 +21,7 @@
 #include "common/alignment.h"
 #include "common/bit_field.h"
 #include "common/color.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
@@ -27,16 +30,22 @@
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/custom_tex_cache.h"
+#include "core/frame_counters.h"
 #include "core/frontend/emu_window.h"
 #include "core/hle/kernel/process.h"
 #include "core/memory.h"
 #include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_dynamic_resolution.h"
 #include "video_core/renderer_opengl/gl_format_reinterpreter.h"
+#include "video_core/renderer_opengl/gl_morton.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
+#include "video_core/renderer_opengl/gl_texture_dumper.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_vars.h"
+#include "video_core/renderer_opengl/gl_vertex_buffer_cache.h"
 #include "video_core/renderer_opengl/texture_downloader_es.h"
 #include "video_core/renderer_opengl/texture_filters/texture_filterer.h"
 #include "video_core/utils.h"
@@ -87,6 +96,26 @@ static constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
     return boost::make_iterator_range(map.equal_range(interval));
 }
 
+/// Calls func for every cached surface overlapping the interval, possibly more than once
+template <typename Func>
+static void ForEachSurfaceInRegion(const SurfaceCache& surface_cache,
+                                   const SurfaceInterval& interval, Func&& func) {
+#ifdef USE_ICL_SURFACE_CACHE
+    for (const auto& pair : RangeFromInterval(surface_cache, interval)) {
+        for (const auto& surface : pair.second) {
+            func(surface);
+        }
+    }
+#else
+    surface_cache.ForEachOverlapping(interval.lower(), interval.upper(), func);
+#endif
+}
+
+#ifndef USE_ICL_SURFACE_CACHE
+static_assert(SurfaceCache::PAGE_BITS == Memory::PAGE_BITS,
+              "surface cache pages must match the pages marked as cached");
+#endif
+
 template <bool morton_to_gl, PixelFormat format>
 static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
@@ -136,6 +165,29 @@ static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     }
 }
 
+/// Returns the vectorized tile swizzler for the format, or nullptr to use MortonCopyTile
+template <bool morton_to_gl, PixelFormat format>
+static MortonTileFn GetVectorTileFn() {
+    const MortonBackend backend = GetHostMortonBackend();
+    if (backend == MortonBackend::Scalar) {
+        return nullptr;
+    }
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return GetMortonTileFn(GLES ? MortonTileKind::SwapBytes32 : MortonTileKind::Copy32,
+                               morton_to_gl, backend);
+    case PixelFormat::RGB5A1:
+    case PixelFormat::RGB565:
+    case PixelFormat::RGBA4:
+    case PixelFormat::D16:
+        return GetMortonTileFn(MortonTileKind::Copy16, morton_to_gl, backend);
+    case PixelFormat::D24S8:
+        return GetMortonTileFn(MortonTileKind::D24S8, morton_to_gl, backend);
+    default:
+        return nullptr;
+    }
+}
+
 template <bool morton_to_gl, PixelFormat format>
 static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr start, PAddr end) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
@@ -166,11 +218,20 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
         }
     };
 
+    const MortonTileFn vector_tile_fn = GetVectorTileFn<morton_to_gl, format>();
+    auto copy_tile = [&](u8* tile) {
+        if (vector_tile_fn) {
+            vector_tile_fn(stride, tile, gl_buffer);
+        } else {
+            MortonCopyTile<morton_to_gl, format>(stride, tile, gl_buffer);
+        }
+    };
+
     u8* tile_buffer = VideoCore::g_memory->GetPhysicalPointer(start);
 
     if (start < aligned_start && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
+        copy_tile(&tmp_buf[0]);
         std::memcpy(tile_buffer, &tmp_buf[start - aligned_down_start],
                     std::min(aligned_start, end) - start);
 
@@ -188,7 +249,7 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
             LOG_ERROR(Render_OpenGL, "Out of bound texture");
             break;
         }
-        MortonCopyTile<morton_to_gl, format>(stride, tile_buffer, gl_buffer);
+        copy_tile(tile_buffer);
         tile_buffer += tile_size;
         current_paddr += tile_size;
         glbuf_next_tile();
@@ -196,7 +257,7 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
 
     if (end > std::max(aligned_start, aligned_end) && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
+        copy_tile(&tmp_buf[0]);
         std::memcpy(tile_buffer, &tmp_buf[0], end - aligned_end);
     }
 }
@@ -243,12 +304,72 @@ static constexpr std::array<void (*)(u32, u32, u8*, PAddr, PAddr, PAddr), 18> gl
     MortonCopy<false, PixelFormat::D24S8> // 17
 };
 
+/**
+ * Whether surfaces get immutable storage. Immutable textures are validated once when allocated
+ * instead of on every upload, and are the only ones that texture views can alias.
+ */
+static bool HasTextureStorage() {
+    return GLES || GLAD_GL_ARB_texture_storage;
+}
+
+constexpr FormatTuple bc1_tuple = {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_RGBA, GL_UNSIGNED_BYTE};
+constexpr FormatTuple bc3_tuple = {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_RGBA, GL_UNSIGNED_BYTE};
+constexpr FormatTuple bc7_tuple = {GL_COMPRESSED_RGBA_BPTC_UNORM_ARB, GL_RGBA, GL_UNSIGNED_BYTE};
+
+static const FormatTuple& GetCustomFormatTuple(Core::CustomTexFormat format) {
+    switch (format) {
+    case Core::CustomTexFormat::BC1:
+        return bc1_tuple;
+    case Core::CustomTexFormat::BC3:
+        return bc3_tuple;
+    case Core::CustomTexFormat::BC7:
+        return bc7_tuple;
+    default:
+        return GetFormatTuple(PixelFormat::RGBA8);
+    }
+}
+
+static bool IsCustomFormatSupported(Core::CustomTexFormat format) {
+    switch (format) {
+    case Core::CustomTexFormat::BC1:
+    case Core::CustomTexFormat::BC3:
+        return GLAD_GL_EXT_texture_compression_s3tc;
+    case Core::CustomTexFormat::BC7:
+        return GLAD_GL_ARB_texture_compression_bptc || GLAD_GL_EXT_texture_compression_bptc;
+    default:
+        return true;
+    }
+}
+
+/// Approximate GPU memory of a texture in bytes. Drivers pad RGB8 and D24 to 4 bytes per pixel.
+static std::size_t GetTagMemory(const HostTextureTag& tag) {
+    std::size_t bytes_per_pixel = 4;
+    switch (tag.format_tuple.internal_format) {
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        return static_cast<std::size_t>(tag.width) * tag.height / 2;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+        bytes_per_pixel = 1;
+        break;
+    case GL_RGB5_A1:
+    case GL_RGB565:
+    case GL_RGBA4:
+    case GL_DEPTH_COMPONENT16:
+        bytes_per_pixel = 2;
+        break;
+    default:
+        break;
+    }
+    return static_cast<std::size_t>(tag.width) * tag.height * bytes_per_pixel;
+}
+
 // Allocate an uninitialized texture of appropriate size and format for the surface
 OGLTexture RasterizerCacheOpenGL::AllocateSurfaceTexture(const FormatTuple& format_tuple, u32 width,
                                                          u32 height) {
     auto recycled_tex = host_texture_recycler.find({format_tuple, width, height});
     if (recycled_tex != host_texture_recycler.end()) {
         OGLTexture texture = std::move(recycled_tex->second);
+        recycled_texture_memory -= GetTagMemory(recycled_tex->first);
         host_texture_recycler.erase(recycled_tex);
         return texture;
     }
@@ -262,7 +383,7 @@ OGLTexture RasterizerCacheOpenGL::AllocateSurfaceTexture(const FormatTuple& form
     cur_state.Apply();
     glActiveTexture(GL_TEXTURE0);
 
-    if (GL_ARB_texture_storage) {
+    if (HasTextureStorage()) {
         // Allocate all possible mipmap levels upfront
         auto levels = std::log2(std::max(width, height)) + 1;
         glTexStorage2D(GL_TEXTURE_2D, levels, format_tuple.internal_format, width, height);
@@ -291,7 +412,7 @@ static void AllocateTextureCube(GLuint texture, const FormatTuple& format_tuple,
     cur_state.texture_cube_unit.texture_cube = texture;
     cur_state.Apply();
     glActiveTexture(TextureUnits::TextureCube.Enum());
-    if (GL_ARB_texture_storage) {
+    if (HasTextureStorage()) {
         // Allocate all possible mipmap levels in case the game uses them later
         auto levels = std::log2(width) + 1;
         glTexStorage2D(GL_TEXTURE_CUBE_MAP, levels, format_tuple.internal_format, width, width);
@@ -450,15 +571,21 @@ static bool FillSurface(const Surface& surface, const u8* fill_data,
 
 CachedSurface::~CachedSurface() {
     if (texture.handle) {
-        auto tag = is_custom ? HostTextureTag{GetFormatTuple(PixelFormat::RGBA8),
-                                              custom_tex_info.width, custom_tex_info.height}
-                             : HostTextureTag{GetFormatTuple(pixel_format), GetScaledWidth(),
-                                              GetScaledHeight()};
-
-        owner.host_texture_recycler.emplace(tag, std::move(texture));
+        owner.RecycleTexture(GetTextureTag(), std::move(texture));
     }
 }
 
+HostTextureTag CachedSurface::GetTextureTag() const {
+    return HasCustomTextureStorage()
+               ? HostTextureTag{GetCustomFormatTuple(custom_tex_info.format),
+                                custom_tex_info.width, custom_tex_info.height}
+               : HostTextureTag{GetFormatTuple(pixel_format), GetScaledWidth(), GetScaledHeight()};
+}
+
+std::size_t CachedSurface::GetTextureMemory() const {
+    return texture.handle ? GetTagMemory(GetTextureTag()) : 0;
+}
+
 bool CachedSurface::CanFill(const SurfaceParams& dest_surface,
                             SurfaceInterval fill_interval) const {
     if (type == SurfaceType::Fill && IsRegionValid(fill_interval) &&
@@ -535,7 +662,7 @@ void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surfac
 }
 
 MICROPROFILE_DEFINE(OpenGL_SurfaceLoad, "OpenGL", "Surface Load", MP_RGB(128, 192, 64));
-void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
+void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end, u8* gl_dst) {
     ASSERT(type != SurfaceType::Fill);
     const bool need_swap =
         GLES && (pixel_format == PixelFormat::RGBA8 || pixel_format == PixelFormat::RGB8);
@@ -544,10 +671,6 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
     if (texture_src_data == nullptr)
         return;
 
-    if (gl_buffer.empty()) {
-        gl_buffer.resize(width * height * GetGLBytesPerPixel(pixel_format));
-    }
-
     // TODO: Should probably be done in ::Memory:: and check for other regions too
     if (load_start < Memory::VRAM_VADDR_END && load_end > Memory::VRAM_VADDR_END)
         load_end = Memory::VRAM_VADDR_END;
@@ -567,20 +690,20 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             // cannot fully test this
             if (pixel_format == PixelFormat::RGBA8) {
                 for (std::size_t i = start_offset; i < load_end - addr; i += 4) {
-                    gl_buffer[i] = texture_src_data[i + 3];
-                    gl_buffer[i + 1] = texture_src_data[i + 2];
-                    gl_buffer[i + 2] = texture_src_data[i + 1];
-                    gl_buffer[i + 3] = texture_src_data[i];
+                    gl_dst[i] = texture_src_data[i + 3];
+                    gl_dst[i + 1] = texture_src_data[i + 2];
+                    gl_dst[i + 2] = texture_src_data[i + 1];
+                    gl_dst[i + 3] = texture_src_data[i];
                 }
             } else if (pixel_format == PixelFormat::RGB8) {
                 for (std::size_t i = start_offset; i < load_end - addr; i += 3) {
-                    gl_buffer[i] = texture_src_data[i + 2];
-                    gl_buffer[i + 1] = texture_src_data[i + 1];
-                    gl_buffer[i + 2] = texture_src_data[i];
+                    gl_dst[i] = texture_src_data[i + 2];
+                    gl_dst[i + 1] = texture_src_data[i + 1];
+                    gl_dst[i + 2] = texture_src_data[i];
                 }
             }
         } else {
-            std::memcpy(&gl_buffer[start_offset], texture_src_data + start_offset,
+            std::memcpy(gl_dst + start_offset, texture_src_data + start_offset,
                         load_end - load_start);
         }
     } else {
@@ -596,16 +719,34 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
+            // Decode whole tiles, which is much faster than looking up every texel. Rows are
+            // flipped, so the first tile row in memory is the top of the surface.
+            const std::size_t tile_size = Pica::Texture::CalculateTileSize(tex_info.format);
+            const unsigned tile_y_begin = (height - rect.top) / 8;
+            const unsigned tile_y_end = (height - rect.bottom + 7) / 8;
+            std::array<Common::Vec4<u8>, 64> texels;
+
+            for (unsigned tile_y = tile_y_begin; tile_y < tile_y_end; ++tile_y) {
+                for (unsigned tile_x = rect.left / 8; tile_x < (rect.right + 7) / 8; ++tile_x) {
+                    Pica::Texture::DecodeTile(
+                        texture_src_data + tile_y * tex_info.stride + tile_x * tile_size, tex_info,
+                        texels);
+                    for (unsigned fine_y = 0; fine_y < 8; ++fine_y) {
+                        const unsigned y = height - 1 - (tile_y * 8 + fine_y);
+                        if (y < rect.bottom || y >= rect.top)
+                            continue;
+                        for (unsigned fine_x = 0; fine_x < 8; ++fine_x) {
+                            const unsigned x = tile_x * 8 + fine_x;
+                            if (x < rect.left || x >= rect.right)
+                                continue;
+                            const std::size_t offset = (x + (width * y)) * 4;
+                            std::memcpy(gl_dst + offset, texels[fine_x + 8 * fine_y].AsArray(), 4);
+                        }
+                    }
                 }
             }
         } else {
-            morton_to_gl_fns[static_cast<std::size_t>(pixel_format)](stride, height, &gl_buffer[0],
+            morton_to_gl_fns[static_cast<std::size_t>(pixel_format)](stride, height, gl_dst,
                                                                      addr, load_start, load_end);
         }
     }
@@ -666,6 +807,8 @@ void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
             std::memcpy(dst_buffer + start_offset, &gl_buffer[start_offset],
                         flush_end - flush_start);
         }
+    } else if (gl_buffer_tiled) {
+        std::memcpy(dst_buffer + start_offset, &gl_buffer[start_offset], end_offset - start_offset);
     } else {
         gl_to_morton_fns[static_cast<std::size_t>(pixel_format)](stride, height, &gl_buffer[0],
                                                                  addr, flush_start, flush_end);
@@ -685,24 +828,23 @@ bool CachedSurface::LoadCustomTexture(u64 tex_hash) {
         return false;
     }
 
-    const auto& path_info = custom_tex_cache.LookupTexturePathInfo(tex_hash);
-    if (!image_interface->DecodePNG(custom_tex_info.tex, custom_tex_info.width,
-                                    custom_tex_info.height, path_info.path)) {
-        LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path_info.path);
+    custom_tex_cache.RecordTextureLoad(tex_hash);
+    auto loaded = custom_tex_cache.TakePrefetchedTexture(tex_hash);
+    if (!loaded) {
+        const auto& path_info = custom_tex_cache.LookupTexturePathInfo(tex_hash);
+        loaded = Core::LoadCustomTexture(*image_interface, path_info.path);
+    }
+    if (!loaded) {
         return false;
     }
-
-    const std::bitset<32> width_bits(custom_tex_info.width);
-    const std::bitset<32> height_bits(custom_tex_info.height);
-    if (width_bits.count() != 1 || height_bits.count() != 1) {
-        LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
+    if (!IsCustomFormatSupported(loaded->format)) {
+        LOG_WARNING(Render_OpenGL, "Custom texture {:016X} uses an unsupported compressed format",
+                    tex_hash);
         return false;
     }
 
-    LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
-    Common::FlipRGBA8Texture(custom_tex_info.tex, custom_tex_info.width, custom_tex_info.height);
-    custom_tex_cache.CacheTexture(tex_hash, custom_tex_info.tex, custom_tex_info.width,
-                                  custom_tex_info.height);
+    custom_tex_info = *loaded;
+    custom_tex_cache.CacheTexture(tex_hash, std::move(*loaded));
     return true;
 }
 
@@ -717,9 +859,13 @@ void CachedSurface::DumpTexture(GLuint target_tex, u64 tex_hash) {
         return;
     }
 
-    // Dump texture to RGBA8 and encode as PNG
-    const auto& image_interface = Core::System::GetInstance().GetImageInterface();
+    // Checked first, as textures are uploaded again far more often than new ones appear
     auto& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
+    if (custom_tex_cache.IsTextureDumped(tex_hash)) {
+        return;
+    }
+
+    // Dump texture to RGBA8 and encode as PNG
     std::string dump_path =
         fmt::format("{}textures/{:016X}/", FileUtil::GetUserPath(FileUtil::UserPath::DumpDir),
                     Core::System::GetInstance().Kernel().GetCurrentProcess()->codeset->program_id);
@@ -729,15 +875,9 @@ void CachedSurface::DumpTexture(GLuint target_tex, u64 tex_hash) {
     }
 
     dump_path += fmt::format("tex1_{}x{}_{:016X}_{}.png", width, height, tex_hash, pixel_format);
-    if (!custom_tex_cache.IsTextureDumped(tex_hash) && !FileUtil::Exists(dump_path)) {
-        custom_tex_cache.SetTextureDumped(tex_hash);
-
+    custom_tex_cache.SetTextureDumped(tex_hash);
+    if (!FileUtil::Exists(dump_path)) {
         LOG_INFO(Render_OpenGL, "Dumping texture to {}", dump_path);
-        std::vector<u8> decoded_texture;
-        decoded_texture.resize(width * height * 4);
-        OpenGLState state = OpenGLState::GetCurState();
-        GLuint old_texture = state.texture_units[0].texture_2d;
-        state.Apply();
         /*
            GetTexImageOES is used even if not using OpenGL ES to work around a small issue that
            happens if using custom textures with texture dumping at the same.
@@ -753,28 +893,36 @@ void CachedSurface::DumpTexture(GLuint target_tex, u64 tex_hash) {
         // if the backend isn't OpenGL ES, this won't be initialized yet
         if (!owner.texture_downloader_es)
             owner.texture_downloader_es = std::make_unique<TextureDownloaderES>(false);
-        owner.texture_downloader_es->GetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                                                 height, width, &decoded_texture[0]);
-        state.texture_units[0].texture_2d = old_texture;
-        state.Apply();
-        Common::FlipRGBA8Texture(decoded_texture, width, height);
-        if (!image_interface->EncodePNG(dump_path, decoded_texture, width, height))
-            LOG_ERROR(Render_OpenGL, "Failed to save decoded texture");
+        if (!owner.texture_dumper) {
+            const std::size_t num_workers =
+                std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+            owner.texture_dumper = std::make_unique<TextureDumper>(
+                Core::System::GetInstance().GetImageInterface(), num_workers);
+        }
+        owner.texture_dumper->Dump(*owner.texture_downloader_es, width, height,
+                                   std::move(dump_path));
     }
 }
 
 MICROPROFILE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 192, 64));
 void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_handle,
-                                    GLuint draw_fb_handle) {
+                                    GLuint draw_fb_handle, GLuint unpack_buffer,
+                                    GLintptr unpack_offset) {
     if (type == SurfaceType::Fill)
         return;
 
     MICROPROFILE_SCOPE(OpenGL_TextureUL);
-
-    ASSERT(gl_buffer.size() == width * height * GetGLBytesPerPixel(pixel_format));
+    Core::CountFrameEvent(Core::FrameCounter::TextureUploads);
 
     u64 tex_hash = 0;
 
+    if (unpack_buffer == 0) {
+        ASSERT(gl_buffer.size() == width * height * GetGLBytesPerPixel(pixel_format));
+    } else {
+        // Texture hashes are computed over gl_buffer, which staged uploads do not fill
+        ASSERT(!Settings::values.dump_textures && !Settings::values.custom_textures);
+    }
+
     if (Settings::values.dump_textures || Settings::values.custom_textures) {
         tex_hash = Common::ComputeHash64(gl_buffer.data(), gl_buffer.size());
     }
@@ -794,7 +942,7 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
     // If not 1x scale, create 1x texture that we will blit from to replace texture subrect in
     // surface
     OGLTexture unscaled_tex;
-    if (res_scale != 1) {
+    if (res_scale != 1 && !IsCustomCompressed()) {
         x0 = 0;
         y0 = 0;
 
@@ -815,7 +963,36 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
 
     // Ensure no bad interactions with GL_UNPACK_ALIGNMENT
     ASSERT(stride * GetGLBytesPerPixel(pixel_format) % 4 == 0);
-    if (is_custom) {
+    if (IsCustomCompressed()) {
+        // Blocks can't be filtered or blitted, so they replace the texture at every scale along
+        // with the mipmaps that they came with
+        const FormatTuple& custom_tuple = GetCustomFormatTuple(custom_tex_info.format);
+        texture = owner.AllocateSurfaceTexture(custom_tuple, custom_tex_info.width,
+                                               custom_tex_info.height);
+        cur_state.texture_units[0].texture_2d = texture.handle;
+        cur_state.Apply();
+
+        glActiveTexture(GL_TEXTURE0);
+        std::size_t offset = 0;
+        for (u32 level = 0; level < custom_tex_info.levels; ++level) {
+            const u32 level_width = std::max(custom_tex_info.width >> level, 1u);
+            const u32 level_height = std::max(custom_tex_info.height >> level, 1u);
+            const std::size_t size =
+                Core::GetCompressedLevelSize(custom_tex_info.format, level_width, level_height);
+            const u8* data = custom_tex_info.tex.data() + offset;
+            // Without immutable storage only the base level has been allocated
+            if (level == 0 || HasTextureStorage()) {
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, level_width, level_height,
+                                          custom_tuple.internal_format,
+                                          static_cast<GLsizei>(size), data);
+            } else {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, custom_tuple.internal_format,
+                                       level_width, level_height, 0, static_cast<GLsizei>(size),
+                                       data);
+            }
+            offset += size;
+        }
+    } else if (is_custom) {
         if (res_scale == 1) {
             texture = owner.AllocateSurfaceTexture(GetFormatTuple(PixelFormat::RGBA8),
                                                    custom_tex_info.width, custom_tex_info.height);
@@ -828,6 +1005,15 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
         glActiveTexture(GL_TEXTURE0);
         glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, custom_tex_info.width, custom_tex_info.height,
                         GL_RGBA, GL_UNSIGNED_BYTE, custom_tex_info.tex.data());
+    } else if (unpack_buffer != 0) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(stride));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpack_buffer);
+
+        glActiveTexture(GL_TEXTURE0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, static_cast<GLsizei>(rect.GetWidth()),
+                        static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
+                        reinterpret_cast<const void*>(unpack_offset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     } else {
         glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(stride));
 
@@ -844,7 +1030,7 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
     cur_state.texture_units[0].texture_2d = old_tex;
     cur_state.Apply();
 
-    if (res_scale != 1) {
+    if (res_scale != 1 && !IsCustomCompressed()) {
         auto scaled_rect = rect;
         scaled_rect.left *= res_scale;
         scaled_rect.top *= res_scale;
@@ -853,8 +1039,17 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
         auto from_rect =
             is_custom ? Common::Rectangle<u32>{0, custom_tex_info.height, custom_tex_info.width, 0}
                       : Common::Rectangle<u32>{0, rect.GetHeight(), rect.GetWidth(), 0};
-        if (!owner.texture_filterer->Filter(unscaled_tex.handle, from_rect, texture.handle,
-                                            scaled_rect, type, read_fb_handle, draw_fb_handle)) {
+        // Only textures are filtered. Render targets are scaled plainly, as filtering them would
+        // blur what the game draws on top of them.
+        std::optional<TextureFilterer::SourceKey> source_key;
+        if (!is_custom && !boost::icl::is_empty(uploaded_interval)) {
+            source_key = TextureFilterer::SourceKey{uploaded_hash, pixel_format,
+                                                    tuple.internal_format};
+        }
+        if (!owner.filter_uploads ||
+            !owner.texture_filterer->Filter(unscaled_tex.handle, from_rect, texture.handle,
+                                            scaled_rect, type, read_fb_handle, draw_fb_handle,
+                                            source_key)) {
             BlitTextures(unscaled_tex.handle, from_rect, texture.handle, scaled_rect, type,
                          read_fb_handle, draw_fb_handle);
         }
@@ -863,6 +1058,38 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
     InvalidateAllWatcher();
 }
 
+/// Attaches the texture to the bound read framebuffer as the attachment matching its type
+static void AttachReadTexture(SurfaceType type, GLuint handle) {
+    if (type == SurfaceType::Color || type == SurfaceType::Texture) {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, handle,
+                               0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
+                               0);
+    } else if (type == SurfaceType::Depth) {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, handle, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    } else {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
+                               handle, 0);
+    }
+    switch (glCheckFramebufferStatus(GL_FRAMEBUFFER)) {
+    case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
+        LOG_WARNING(Render_OpenGL, "Framebuffer incomplete attachment");
+        break;
+    case GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS:
+        LOG_WARNING(Render_OpenGL, "Framebuffer incomplete dimensions");
+        break;
+    case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
+        LOG_WARNING(Render_OpenGL, "Framebuffer incomplete missing attachment");
+        break;
+    case GL_FRAMEBUFFER_UNSUPPORTED:
+        LOG_WARNING(Render_OpenGL, "Framebuffer unsupported");
+        break;
+    }
+}
+
 MICROPROFILE_DEFINE(OpenGL_TextureDL, "OpenGL", "Texture Download", MP_RGB(128, 192, 64));
 void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
                                       GLuint draw_fb_handle) {
@@ -882,6 +1109,11 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
 
     const FormatTuple& tuple = GetFormatTuple(pixel_format);
 
+    gl_buffer_tiled = DownloadTiledGLTexture(rect, read_fb_handle, draw_fb_handle);
+    if (gl_buffer_tiled) {
+        return;
+    }
+
     // Ensure no bad interactions with GL_PACK_ALIGNMENT
     ASSERT(stride * GetGLBytesPerPixel(pixel_format) % 4 == 0);
     glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(stride));
@@ -918,35 +1150,7 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
         state.draw.read_framebuffer = read_fb_handle;
         state.Apply();
 
-        if (type == SurfaceType::Color || type == SurfaceType::Texture) {
-            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                                   texture.handle, 0);
-            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
-                                   0, 0);
-        } else if (type == SurfaceType::Depth) {
-            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
-                                   texture.handle, 0);
-            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
-        } else {
-            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
-                                   texture.handle, 0);
-        }
-        switch (glCheckFramebufferStatus(GL_FRAMEBUFFER)) {
-        case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
-            LOG_WARNING(Render_OpenGL, "Framebuffer incomplete attachment");
-            break;
-        case GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS:
-            LOG_WARNING(Render_OpenGL, "Framebuffer incomplete dimensions");
-            break;
-        case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
-            LOG_WARNING(Render_OpenGL, "Framebuffer incomplete missing attachment");
-            break;
-        case GL_FRAMEBUFFER_UNSUPPORTED:
-            LOG_WARNING(Render_OpenGL, "Framebuffer unsupported");
-            break;
-        }
+        AttachReadTexture(type, texture.handle);
         glReadPixels(static_cast<GLint>(rect.left), static_cast<GLint>(rect.bottom),
                      static_cast<GLsizei>(rect.GetWidth()), static_cast<GLsizei>(rect.GetHeight()),
                      tuple.format, tuple.type, &gl_buffer[buffer_offset]);
@@ -955,6 +1159,101 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
     glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 }
 
+bool CachedSurface::DownloadTiledGLTexture(const Common::Rectangle<u32>& rect,
+                                           GLuint read_fb_handle, GLuint draw_fb_handle) {
+    const auto& downloader = owner.texture_downloader_es;
+    if (!is_tiled || !downloader || !downloader->CanDownloadTiled()) {
+        return false;
+    }
+    // The tiles of the rect have to be contiguous in memory, which is the case for whole tile rows
+    // and single tile rows, the only rects flushes download
+    if (rect.left % 8 != 0 || rect.GetWidth() % 8 != 0 || rect.GetHeight() % 8 != 0 ||
+        (rect.GetWidth() != stride && rect.GetHeight() != 8)) {
+        return false;
+    }
+    const u32 tile_size = 64 * GetFormatBpp() / 8;
+    const std::size_t offset =
+        (static_cast<std::size_t>(height - rect.top) / 8 * (stride / 8) + rect.left / 8) *
+        tile_size;
+    const std::size_t size = static_cast<std::size_t>(rect.GetWidth() / 8) *
+                             (rect.GetHeight() / 8) * tile_size;
+    if (offset + size > gl_buffer.size()) {
+        return false;
+    }
+
+    if (res_scale == 1) {
+        downloader->DownloadTiled(texture.handle, pixel_format, rect, &gl_buffer[offset]);
+        return true;
+    }
+
+    auto scaled_rect = rect;
+    scaled_rect.left *= res_scale;
+    scaled_rect.top *= res_scale;
+    scaled_rect.right *= res_scale;
+    scaled_rect.bottom *= res_scale;
+
+    const Common::Rectangle<u32> unscaled_tex_rect{0, rect.GetHeight(), rect.GetWidth(), 0};
+    OGLTexture unscaled_tex = owner.AllocateSurfaceTexture(
+        GetFormatTuple(pixel_format), rect.GetWidth(), rect.GetHeight());
+    BlitTextures(texture.handle, scaled_rect, unscaled_tex.handle, unscaled_tex_rect, type,
+                 read_fb_handle, draw_fb_handle);
+    downloader->DownloadTiled(unscaled_tex.handle, pixel_format, unscaled_tex_rect,
+                              &gl_buffer[offset]);
+    return true;
+}
+
+bool CachedSurface::CanDownloadAsync() const {
+    // GLES can only read depth back through TextureDownloaderES, which is synchronous
+    return type != SurfaceType::Fill && (!GLES || type == SurfaceType::Color);
+}
+
+MICROPROFILE_DEFINE(OpenGL_TextureDLAsync, "OpenGL", "Texture Download (Async)",
+                    MP_RGB(128, 192, 64));
+void CachedSurface::DownloadGLTextureAsync(const Common::Rectangle<u32>& rect,
+                                           GLuint read_fb_handle, GLuint draw_fb_handle) {
+    ASSERT(CanDownloadAsync());
+    MICROPROFILE_SCOPE(OpenGL_TextureDLAsync);
+
+    OpenGLState state = OpenGLState::GetCurState();
+    OpenGLState prev_state = state;
+    SCOPE_EXIT({ prev_state.Apply(); });
+
+    const FormatTuple& tuple = GetFormatTuple(pixel_format);
+
+    // Unlike DownloadGLTexture, scaled surfaces are always read through the framebuffer since
+    // glGetTexImage is not available on GLES
+    GLuint read_tex = texture.handle;
+    Common::Rectangle<u32> read_rect = rect;
+    OGLTexture unscaled_tex;
+    if (res_scale != 1) {
+        auto scaled_rect = rect;
+        scaled_rect.left *= res_scale;
+        scaled_rect.top *= res_scale;
+        scaled_rect.right *= res_scale;
+        scaled_rect.bottom *= res_scale;
+
+        read_rect = {0, rect.GetHeight(), rect.GetWidth(), 0};
+        unscaled_tex = owner.AllocateSurfaceTexture(tuple, rect.GetWidth(), rect.GetHeight());
+        BlitTextures(texture.handle, scaled_rect, unscaled_tex.handle, read_rect, type,
+                     read_fb_handle, draw_fb_handle);
+        read_tex = unscaled_tex.handle;
+    }
+
+    state.ResetTexture(read_tex);
+    state.draw.read_framebuffer = read_fb_handle;
+    state.Apply();
+
+    ASSERT(stride * GetGLBytesPerPixel(pixel_format) % 4 == 0);
+    glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(stride));
+
+    AttachReadTexture(type, read_tex);
+    glReadPixels(static_cast<GLint>(read_rect.left), static_cast<GLint>(read_rect.bottom),
+                 static_cast<GLsizei>(read_rect.GetWidth()),
+                 static_cast<GLsizei>(read_rect.GetHeight()), tuple.format, tuple.type, nullptr);
+
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+}
+
 enum MatchFlags {
     Invalid = 1,      // Flag that can be applied to other match types, invalid matches require
                       // validation before they can be used
@@ -979,95 +1278,119 @@ static Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams&
     u32 match_scale = 0;
     SurfaceInterval match_interval{};
 
-    for (const auto& pair : RangeFromInterval(surface_cache, params.GetInterval())) {
-        for (const auto& surface : pair.second) {
-            const bool res_scale_matched = match_scale_type == ScaleMatch::Exact
-                                               ? (params.res_scale == surface->res_scale)
-                                               : (params.res_scale <= surface->res_scale);
-            // validity will be checked in GetCopyableInterval
-            bool is_valid =
-                find_flags & MatchFlags::Copy
-                    ? true
-                    : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
-
-            if (!(find_flags & MatchFlags::Invalid) && !is_valid)
-                continue;
+    ForEachSurfaceInRegion(surface_cache, params.GetInterval(), [&](const Surface& surface) {
+        const bool res_scale_matched = match_scale_type == ScaleMatch::Exact
+                                           ? (params.res_scale == surface->res_scale)
+                                           : (params.res_scale <= surface->res_scale);
+        // validity will be checked in GetCopyableInterval
+        bool is_valid =
+            find_flags & MatchFlags::Copy
+                ? true
+                : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
+
+        if (!(find_flags & MatchFlags::Invalid) && !is_valid)
+            return;
+
+        auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
+            if (!(find_flags & check_type))
+                return;
+
+            bool matched;
+            SurfaceInterval surface_interval;
+            std::tie(matched, surface_interval) = match_fn();
+            if (!matched)
+                return;
+
+            if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
+                surface->type != SurfaceType::Fill)
+                return;
+
+            // Found a match, update only if this is better than the previous one
+            auto UpdateMatch = [&] {
+                match_surface = surface;
+                match_valid = is_valid;
+                match_scale = surface->res_scale;
+                match_interval = surface_interval;
+            };
 
-            auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
-                if (!(find_flags & check_type))
-                    return;
-
-                bool matched;
-                SurfaceInterval surface_interval;
-                std::tie(matched, surface_interval) = match_fn();
-                if (!matched)
-                    return;
-
-                if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
-                    surface->type != SurfaceType::Fill)
-                    return;
-
-                // Found a match, update only if this is better than the previous one
-                auto UpdateMatch = [&] {
-                    match_surface = surface;
-                    match_valid = is_valid;
-                    match_scale = surface->res_scale;
-                    match_interval = surface_interval;
-                };
-
-                if (surface->res_scale > match_scale) {
-                    UpdateMatch();
-                    return;
-                } else if (surface->res_scale < match_scale) {
-                    return;
-                }
+            if (surface->res_scale > match_scale) {
+                UpdateMatch();
+                return;
+            } else if (surface->res_scale < match_scale) {
+                return;
+            }
 
-                if (is_valid && !match_valid) {
-                    UpdateMatch();
-                    return;
-                } else if (is_valid != match_valid) {
-                    return;
-                }
+            if (is_valid && !match_valid) {
+                UpdateMatch();
+                return;
+            } else if (is_valid != match_valid) {
+                return;
+            }
 
-                if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
-                    UpdateMatch();
-                }
-            };
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
-                return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
-                return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
-                ASSERT(validate_interval);
-                auto copy_interval =
-                    params.FromInterval(*validate_interval).GetCopyableInterval(surface);
-                bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
-                               surface->CanCopy(params, copy_interval);
-                return std::make_pair(matched, copy_interval);
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
-                return std::make_pair(surface->CanExpand(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
-                return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
-            });
-        }
-    }
+            if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
+                UpdateMatch();
+            }
+        };
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
+            return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
+            return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
+            ASSERT(validate_interval);
+            auto copy_interval =
+                params.FromInterval(*validate_interval).GetCopyableInterval(surface);
+            bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
+                           surface->CanCopy(params, copy_interval);
+            return std::make_pair(matched, copy_interval);
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
+            return std::make_pair(surface->CanExpand(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
+            return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
+        });
+    });
     return match_surface;
 }
 
+/// Size of the staging buffer for surface uploads, enough for several full size textures
+static constexpr GLsizeiptr UPLOAD_BUFFER_SIZE = 32 * 1024 * 1024;
+
+/// Physical range tracked by the dirty page flags, which holds every cached surface
+constexpr PAddr DIRTY_PAGES_BEGIN = Memory::VRAM_PADDR;
+constexpr PAddr DIRTY_PAGES_END = Memory::FCRAM_N3DS_PADDR_END;
+constexpr std::size_t DIRTY_PAGE_COUNT = (DIRTY_PAGES_END - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS;
+
 RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
+    dirty_pages = std::make_unique<std::atomic<bool>[]>(DIRTY_PAGE_COUNT);
+    read_back_pages = std::make_unique<std::atomic<u32>[]>(DIRTY_PAGE_COUNT);
     resolution_scale_factor = VideoCore::GetResolutionScaleFactor();
     texture_filterer = std::make_unique<TextureFilterer>(Settings::values.texture_filter_name,
                                                          resolution_scale_factor);
     format_reinterpreter = std::make_unique<FormatReinterpreterOpenGL>();
+    vertex_buffer_cache = std::make_unique<VertexBufferCache>(*this);
+    if (Settings::values.gpu_texture_decoding && TextureDecoderOpenGL::IsSupported()) {
+        texture_decoder = std::make_unique<TextureDecoderOpenGL>();
+        if (!texture_decoder->IsAvailable()) {
+            texture_decoder.reset();
+        }
+    }
     if (GLES)
         texture_downloader_es = std::make_unique<TextureDownloaderES>(false);
+    if (Settings::values.dynamic_resolution && DynamicResolution::IsSupported()) {
+        dynamic_resolution = std::make_unique<DynamicResolution>(
+            Settings::values.min_resolution_factor, resolution_scale_factor);
+    }
 
     read_framebuffer.Create();
     draw_framebuffer.Create();
+
+    upload_buffer = std::make_unique<OGLStreamBuffer>(GL_PIXEL_UNPACK_BUFFER, UPLOAD_BUFFER_SIZE,
+                                                      false);
+    // Client memory uploads elsewhere expect no pixel unpack buffer to be bound
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
 RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
@@ -1089,6 +1412,32 @@ bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
 
     dst_surface->InvalidateAllWatcher();
 
+    if (src_surface == dst_surface) {
+        // Blitting between overlapping regions of a texture is undefined, so such transfers go
+        // through a temporary copy of the source region
+        // Rectangles are flipped to flip blits, so compare their extents
+        const auto normalize = [](const Common::Rectangle<u32>& rect) {
+            return Common::Rectangle<u32>{
+                std::min(rect.left, rect.right), std::max(rect.bottom, rect.top),
+                std::max(rect.left, rect.right), std::min(rect.bottom, rect.top)};
+        };
+        const auto src = normalize(src_rect);
+        const auto dst = normalize(dst_rect);
+        if (src.left < dst.right && dst.left < src.right && src.bottom < dst.top &&
+            dst.bottom < src.top) {
+            const FormatTuple& tuple = GetFormatTuple(src_surface->pixel_format);
+            const Common::Rectangle<u32> tmp_rect{0, src_rect.GetHeight(), src_rect.GetWidth(), 0};
+            OGLTexture tmp_tex = AllocateSurfaceTexture(tuple, tmp_rect.right, tmp_rect.top);
+            const bool blitted =
+                BlitTextures(src_surface->texture.handle, src_rect, tmp_tex.handle, tmp_rect,
+                             src_surface->type, read_framebuffer.handle, draw_framebuffer.handle) &&
+                BlitTextures(tmp_tex.handle, tmp_rect, dst_surface->texture.handle, dst_rect,
+                             src_surface->type, read_framebuffer.handle, draw_framebuffer.handle);
+            RecycleTexture(HostTextureTag{tuple, tmp_rect.right, tmp_rect.top}, std::move(tmp_tex));
+            return blitted;
+        }
+    }
+
     return BlitTextures(src_surface->texture.handle, src_rect, dst_surface->texture.handle,
                         dst_rect, src_surface->type, read_framebuffer.handle,
                         draw_framebuffer.handle);
@@ -1133,12 +1482,14 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
         new_params.res_scale = target_res_scale;
         surface = CreateSurface(new_params);
         RegisterSurface(surface);
+        Core::CountFrameEvent(Core::FrameCounter::SurfaceCacheMisses);
     }
 
     if (load_if_create) {
         ValidateSurface(surface, params.addr, params.size);
     }
 
+    surface->last_used_frame = current_frame;
     return surface;
 }
 
@@ -1218,6 +1569,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetSurfaceSubRect(const SurfaceParams&
         ValidateSurface(surface, aligned_params.addr, aligned_params.size);
     }
 
+    surface->last_used_frame = current_frame;
     return std::make_tuple(surface, surface->GetScaledSubRect(params));
 }
 
@@ -1234,6 +1586,9 @@ Surface RasterizerCacheOpenGL::GetTextureSurface(const Pica::Texture::TextureInf
         return nullptr;
     }
 
+    filter_uploads = true;
+    SCOPE_EXIT({ filter_uploads = false; });
+
     SurfaceParams params;
     params.addr = info.physical_address;
     params.width = info.width;
@@ -1274,6 +1629,16 @@ Surface RasterizerCacheOpenGL::GetTextureSurface(const Pica::Texture::TextureInf
         SCOPE_EXIT({ prev_state.Apply(); });
         auto format_tuple = GetFormatTuple(params.pixel_format);
 
+        // Compressed custom textures brought their own mipmaps, which can't be generated
+        if (surface->IsCustomCompressed() && surface->max_level < max_level) {
+            state.texture_units[0].texture_2d = surface->texture.handle;
+            state.Apply();
+            glActiveTexture(GL_TEXTURE0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                            std::min(max_level, surface->custom_tex_info.levels - 1));
+            surface->max_level = max_level;
+        }
+
         // Allocate more mipmap level if necessary
         if (surface->max_level < max_level) {
             state.texture_units[0].texture_2d = surface->texture.handle;
@@ -1289,9 +1654,8 @@ Surface RasterizerCacheOpenGL::GetTextureSurface(const Pica::Texture::TextureInf
                 width = surface->GetScaledWidth();
                 height = surface->GetScaledHeight();
             }
-            // If we are using ARB_texture_storage then we've already allocated all of the mipmap
-            // levels
-            if (!GL_ARB_texture_storage) {
+            // Immutable storage already has all of the mipmap levels allocated
+            if (!HasTextureStorage()) {
                 for (u32 level = surface->max_level + 1; level <= max_level; ++level) {
                     glTexImage2D(GL_TEXTURE_2D, level, format_tuple.internal_format, width >> level,
                                  height >> level, 0, format_tuple.format, format_tuple.type,
@@ -1463,9 +1827,17 @@ SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
         (VideoCore::g_texture_filter_update_requested.exchange(false) &&
          texture_filterer->Reset(Settings::values.texture_filter_name, resolution_scale_factor))) {
         resolution_scale_factor = VideoCore::GetResolutionScaleFactor();
+        if (dynamic_resolution) {
+            dynamic_resolution->SetMaxScale(resolution_scale_factor);
+        }
         FlushAll();
+#ifdef USE_ICL_SURFACE_CACHE
         while (!surface_cache.empty())
             UnregisterSurface(*surface_cache.begin()->second.begin());
+#else
+        while (!surface_cache.Empty())
+            UnregisterSurface(surface_cache.Front());
+#endif
         texture_cube_cache.clear();
     }
 
@@ -1479,7 +1851,9 @@ SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
     // get color and depth surfaces
     SurfaceParams color_params;
     color_params.is_tiled = true;
-    color_params.res_scale = resolution_scale_factor;
+    // Surfaces of the previous scale are copied from when the dynamic resolution changes it
+    color_params.res_scale =
+        dynamic_resolution ? dynamic_resolution->GetScale() : resolution_scale_factor;
     color_params.width = config.GetWidth();
     color_params.height = config.GetHeight();
     SurfaceParams depth_params = color_params;
@@ -1542,6 +1916,8 @@ SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
         depth_surface->InvalidateAllWatcher();
     }
 
+    UpdateBoundFramebuffers(color_surface, depth_surface);
+
     return std::make_tuple(color_surface, depth_surface, fb_rect);
 }
 
@@ -1575,6 +1951,7 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetTexCopySurface(const SurfaceParams&
 
     if (match_surface != nullptr) {
         ValidateSurface(match_surface, params.addr, params.size);
+        match_surface->last_used_frame = current_frame;
 
         SurfaceParams match_subrect;
         if (params.width != params.stride) {
@@ -1603,6 +1980,9 @@ void RasterizerCacheOpenGL::DuplicateSurface(const Surface& src_surface,
 
     dest_surface->invalid_regions -= src_surface->GetInterval();
     dest_surface->invalid_regions += src_surface->invalid_regions;
+    dest_surface->pending_download.reset();
+    dest_surface->uploaded_interval = {};
+    dest_surface->write_tick = ++write_counter;
 
     SurfaceRegions regions;
     for (const auto& pair : RangeFromInterval(dirty_regions, src_surface->GetInterval())) {
@@ -1612,6 +1992,7 @@ void RasterizerCacheOpenGL::DuplicateSurface(const Surface& src_surface,
     }
     for (const auto& interval : regions) {
         dirty_regions.set({interval, dest_surface});
+        UpdateDirtyPages(interval);
     }
 }
 
@@ -1628,6 +2009,9 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
     }
 
     auto validate_regions = surface->invalid_regions & validate_interval;
+    if (!validate_regions.empty()) {
+        surface->write_tick = ++write_counter;
+    }
     auto notify_validated = [&](SurfaceInterval interval) {
         surface->invalid_regions.erase(interval);
         validate_regions.erase(interval);
@@ -1647,6 +2031,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         if (copy_surface != nullptr) {
             SurfaceInterval copy_interval = params.GetCopyableInterval(copy_surface);
             CopySurface(copy_surface, surface, copy_interval);
+            surface->uploaded_interval = {};
             notify_validated(copy_interval);
             continue;
         }
@@ -1654,6 +2039,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         // Try to find surface in cache with different format
         // that can can be reinterpreted to the requested format.
         if (ValidateByReinterpretation(surface, params, interval)) {
+            surface->uploaded_interval = {};
             notify_validated(interval);
             continue;
         }
@@ -1674,9 +2060,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
 
         // Load data from 3DS memory
         FlushRegion(params.addr, params.size);
-        surface->LoadGLBuffer(params.addr, params.end);
-        surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                 draw_framebuffer.handle);
+        LoadAndUploadSurface(surface, params);
         notify_validated(params.GetInterval());
     }
 }
@@ -1713,13 +2097,14 @@ bool RasterizerCacheOpenGL::NoUnimplementedReinterpretations(const Surface& surf
 bool RasterizerCacheOpenGL::IntervalHasInvalidPixelFormat(SurfaceParams& params,
                                                           const SurfaceInterval& interval) {
     params.pixel_format = PixelFormat::Invalid;
-    for (const auto& set : RangeFromInterval(surface_cache, interval))
-        for (const auto& surface : set.second)
-            if (surface->pixel_format == PixelFormat::Invalid) {
-                LOG_WARNING(Render_OpenGL, "Surface found with invalid pixel format");
-                return true;
-            }
-    return false;
+    bool found_invalid = false;
+    ForEachSurfaceInRegion(surface_cache, interval, [&](const Surface& surface) {
+        if (!found_invalid && surface->pixel_format == PixelFormat::Invalid) {
+            LOG_WARNING(Render_OpenGL, "Surface found with invalid pixel format");
+            found_invalid = true;
+        }
+    });
+    return found_invalid;
 }
 
 bool RasterizerCacheOpenGL::ValidateByReinterpretation(const Surface& surface,
@@ -1772,11 +2157,14 @@ bool RasterizerCacheOpenGL::ValidateByReinterpretation(const Surface& surface,
 }
 
 void RasterizerCacheOpenGL::ClearAll(bool flush) {
-    const auto flush_interval = PageMap::interval_type::right_open(0x0, 0xFFFFFFFF);
     // Force flush all surfaces from the cache
     if (flush) {
         FlushRegion(0x0, 0xFFFFFFFF);
     }
+    // The vertex arrays release their pages first, as the marked pages are cleared wholesale
+    vertex_buffer_cache->Clear();
+#ifdef USE_ICL_SURFACE_CACHE
+    const auto flush_interval = PageMap::interval_type::right_open(0x0, 0xFFFFFFFF);
     // Unmark all of the marked pages
     for (auto& pair : RangeFromInterval(cached_pages, flush_interval)) {
         const auto interval = pair.first & flush_interval;
@@ -1790,17 +2178,111 @@ void RasterizerCacheOpenGL::ClearAll(bool flush) {
 
     // Remove the whole cache without really looking at it.
     cached_pages -= flush_interval;
-    dirty_regions -= SurfaceInterval(0x0, 0xFFFFFFFF);
     surface_cache -= SurfaceInterval(0x0, 0xFFFFFFFF);
+#else
+    surface_cache.Clear([this](PAddr addr, u32 size) {
+        UpdatePagesCachedCount(addr, size, -1);
+    });
+#endif
+    dirty_regions -= SurfaceInterval(0x0, 0xFFFFFFFF);
+    UpdateDirtyPages(SurfaceInterval(DIRTY_PAGES_BEGIN, DIRTY_PAGES_END));
     remove_surfaces.clear();
+    registered_surfaces.clear();
 }
 
-void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surface) {
+void RasterizerCacheOpenGL::RecycleTexture(const HostTextureTag& tag, OGLTexture&& texture) {
+    recycled_texture_memory += GetTagMemory(tag);
+    host_texture_recycler.emplace(tag, std::move(texture));
+}
+
+void RasterizerCacheOpenGL::TrimRecycledTextures(std::size_t surface_memory, std::size_t budget) {
+    while (!host_texture_recycler.empty() && surface_memory + recycled_texture_memory > budget) {
+        const auto it = host_texture_recycler.begin();
+        recycled_texture_memory -= GetTagMemory(it->first);
+        host_texture_recycler.erase(it);
+    }
+}
+
+bool RasterizerCacheOpenGL::IsSurfaceDirty(const Surface& surface) const {
+    const auto range = dirty_regions.equal_range(surface->GetInterval());
+    return std::any_of(range.first, range.second,
+                       [&surface](const auto& pair) { return pair.second == surface; });
+}
+
+void RasterizerCacheOpenGL::TickFrame() {
     std::lock_guard lock{mutex};
+    current_frame++;
+    read_back_frame.fetch_add(1, std::memory_order_relaxed);
+    vertex_buffer_cache->TickFrame();
+    if (texture_dumper) {
+        texture_dumper->Poll();
+    }
+    if (dynamic_resolution) {
+        dynamic_resolution->TickFrame();
+    }
 
-    if (size == 0)
+    const std::size_t budget = static_cast<std::size_t>(Settings::values.surface_cache_budget)
+                               << 20;
+    if (budget == 0) {
+        return;
+    }
+
+    std::size_t surface_memory = 0;
+    for (const auto& surface : registered_surfaces) {
+        surface_memory += surface->GetTextureMemory();
+    }
+    // Recycled textures are the cheapest to give up
+    TrimRecycledTextures(surface_memory, budget);
+    if (surface_memory <= budget) {
+        return;
+    }
+
+    // Surfaces used by the last couple of frames are likely to be used by the next ones too
+    constexpr u64 MinEvictionAge = 2;
+    struct Candidate {
+        Surface surface;
+        bool dirty;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& surface : registered_surfaces) {
+        if (surface->GetTextureMemory() > 0 &&
+            current_frame - surface->last_used_frame >= MinEvictionAge) {
+            candidates.push_back({surface, IsSurfaceDirty(surface)});
+        }
+    }
+    // Clean surfaces go first, as dirty ones have to be written back to 3DS memory
+    std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.dirty, lhs.surface->last_used_frame) <
+               std::tie(rhs.dirty, rhs.surface->last_used_frame);
+    });
+
+    std::size_t num_evicted = 0;
+    for (const auto& [surface, dirty] : candidates) {
+        if (surface_memory <= budget) {
+            break;
+        }
+        if (dirty) {
+            FlushRegion(surface->addr, surface->size, surface);
+        }
+        surface_memory -= surface->GetTextureMemory();
+        UnregisterSurface(surface);
+        num_evicted++;
+    }
+    LOG_DEBUG(Render_OpenGL, "Evicted {} surfaces, {} MiB left in use", num_evicted,
+              surface_memory >> 20);
+
+    // The textures of the evicted surfaces are recycled as they are destroyed, free them as well
+    candidates.clear();
+    TrimRecycledTextures(surface_memory, budget);
+}
+
+void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surface) {
+    // CPU accesses to clean pages of cached surfaces return without waiting for the GPU thread
+    if (size == 0 || !IsRegionDirty(addr, size))
         return;
 
+    std::lock_guard lock{mutex};
+
     const SurfaceInterval flush_interval(addr, addr + size);
     SurfaceRegions flushed_intervals;
 
@@ -1819,26 +2301,292 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surf
 
         if (surface->type != SurfaceType::Fill) {
             SurfaceParams params = surface->FromInterval(interval);
-            surface->DownloadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                       draw_framebuffer.handle);
+            const auto rect = surface->GetSubRect(params);
+            if (!ResolvePrefetchedDownload(surface, rect)) {
+                surface->DownloadGLTexture(rect, read_framebuffer.handle, draw_framebuffer.handle);
+            }
+            surface->prefetch_downloads = true;
         }
         surface->FlushGLBuffer(boost::icl::first(interval), boost::icl::last_next(interval));
         flushed_intervals += interval;
     }
     // Reset dirty regions
     dirty_regions -= flushed_intervals;
+    for (const auto& interval : flushed_intervals) {
+        UpdateDirtyPages(interval);
+    }
+}
+
+bool RasterizerCacheOpenGL::IsRegionDirty(PAddr addr, u32 size) const {
+    if (addr < DIRTY_PAGES_BEGIN || addr >= DIRTY_PAGES_END || size > DIRTY_PAGES_END - addr) {
+        return true;
+    }
+    const std::size_t first = (addr - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS;
+    const std::size_t last = (addr + size - 1 - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS;
+    for (std::size_t page = first; page <= last; ++page) {
+        if (dirty_pages[page].load(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RasterizerCacheOpenGL::MarkReadBack(PAddr addr, u32 size) {
+    if (size == 0 || addr < DIRTY_PAGES_BEGIN || addr >= DIRTY_PAGES_END) {
+        return;
+    }
+    const u32 frame = read_back_frame.load(std::memory_order_relaxed);
+    const std::size_t first = (addr - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS;
+    const PAddr end = size > DIRTY_PAGES_END - addr ? DIRTY_PAGES_END : addr + size;
+    const std::size_t last = (end - 1 - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS;
+    for (std::size_t page = first; page <= last; ++page) {
+        read_back_pages[page].store(frame, std::memory_order_relaxed);
+    }
+}
+
+bool RasterizerCacheOpenGL::IsReadBack(PAddr addr, u32 size) const {
+    if (size == 0 || addr < DIRTY_PAGES_BEGIN || addr >= DIRTY_PAGES_END) {
+        return false;
+    }
+    const u32 frame = read_back_frame.load(std::memory_order_relaxed);
+    const std::size_t first = (addr - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS;
+    const PAddr end = size > DIRTY_PAGES_END - addr ? DIRTY_PAGES_END : addr + size;
+    const std::size_t last = (end - 1 - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS;
+    for (std::size_t page = first; page <= last; ++page) {
+        if (read_back_pages[page].load(std::memory_order_relaxed) + 1 >= frame) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RasterizerCacheOpenGL::UpdateDirtyPages(const SurfaceInterval& interval) {
+    const PAddr begin = std::max(boost::icl::first(interval), DIRTY_PAGES_BEGIN);
+    const PAddr end = std::min(boost::icl::last_next(interval), DIRTY_PAGES_END);
+    for (PAddr page = Common::AlignDown(begin, Memory::PAGE_SIZE); page < end;
+         page += Memory::PAGE_SIZE) {
+        const bool dirty =
+            boost::icl::intersects(dirty_regions, SurfaceInterval(page, page + Memory::PAGE_SIZE));
+        dirty_pages[(page - DIRTY_PAGES_BEGIN) >> Memory::PAGE_BITS].store(
+            dirty, std::memory_order_release);
+    }
 }
 
 void RasterizerCacheOpenGL::FlushAll() {
     FlushRegion(0, 0xFFFFFFFF);
 }
 
+void RasterizerCacheOpenGL::PrefetchSurface(const Surface& surface) {
+    if (!surface->CanDownloadAsync()) {
+        return;
+    }
+
+    // Bounding rectangle of everything this surface may be asked to flush
+    std::optional<Common::Rectangle<u32>> rect;
+    for (const auto& pair : RangeFromInterval(dirty_regions, surface->GetInterval())) {
+        if (pair.second != surface) {
+            continue;
+        }
+        const auto sub_rect =
+            surface->GetSubRect(surface->FromInterval(pair.first & surface->GetInterval()));
+        if (!rect) {
+            rect = sub_rect;
+            continue;
+        }
+        rect->left = std::min(rect->left, sub_rect.left);
+        rect->bottom = std::min(rect->bottom, sub_rect.bottom);
+        rect->right = std::max(rect->right, sub_rect.right);
+        rect->top = std::max(rect->top, sub_rect.top);
+    }
+    if (!rect) {
+        return;
+    }
+
+    const std::size_t buffer_index = next_download_buffer;
+    next_download_buffer = (next_download_buffer + 1) % download_buffers.size();
+
+    DownloadBuffer& download = download_buffers[buffer_index];
+    if (const Surface previous = download.surface.lock()) {
+        // Drop the previous prefetch if its data has not been consumed yet
+        if (previous->pending_download && !previous->pending_download->resolved &&
+            previous->pending_download->buffer_index == buffer_index) {
+            previous->pending_download.reset();
+        }
+    }
+
+    const GLsizeiptr size =
+        static_cast<GLsizeiptr>((rect->GetHeight() - 1) * surface->stride + rect->GetWidth()) *
+        CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+
+    download.buffer.Create();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, download.buffer.handle);
+    if (size > download.size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        download.size = size;
+    }
+    surface->DownloadGLTextureAsync(*rect, read_framebuffer.handle, draw_framebuffer.handle);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    download.fence.Release();
+    download.fence.Create();
+    download.surface = surface;
+
+    surface->pending_download = CachedSurface::PendingDownload{*rect, buffer_index, false};
+    surface->prefetch_downloads = false;
+}
+
+MICROPROFILE_DEFINE(OpenGL_TextureDLWait, "OpenGL", "Texture Download Wait", MP_RGB(192, 64, 64));
+bool RasterizerCacheOpenGL::ResolvePrefetchedDownload(const Surface& surface,
+                                                      const Common::Rectangle<u32>& rect) {
+    auto& pending = surface->pending_download;
+    if (!pending || rect.left < pending->rect.left || rect.right > pending->rect.right ||
+        rect.bottom < pending->rect.bottom || rect.top > pending->rect.top) {
+        return false;
+    }
+    if (pending->resolved) {
+        return true;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_TextureDLWait);
+
+    DownloadBuffer& download = download_buffers[pending->buffer_index];
+    ASSERT(download.surface.lock() == surface);
+
+    // Waits in 1 second slices so that a lost context does not hang the emulation thread forever
+    GLenum wait_result;
+    do {
+        wait_result =
+            glClientWaitSync(download.fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    } while (wait_result == GL_TIMEOUT_EXPIRED);
+    download.fence.Release();
+    download.surface.reset();
+
+    if (wait_result == GL_WAIT_FAILED) {
+        pending.reset();
+        return false;
+    }
+
+    const u32 bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    const Common::Rectangle<u32>& pending_rect = pending->rect;
+    const std::size_t row_pitch = surface->stride * bytes_per_pixel;
+    const std::size_t row_size = pending_rect.GetWidth() * bytes_per_pixel;
+    const std::size_t size = (pending_rect.GetHeight() - 1) * row_pitch + row_size;
+
+    if (surface->gl_buffer.empty()) {
+        surface->gl_buffer.resize(surface->width * surface->height * bytes_per_pixel);
+    }
+    surface->gl_buffer_tiled = false;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, download.buffer.handle);
+    const u8* data = static_cast<const u8*>(glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+    if (data == nullptr) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending.reset();
+        return false;
+    }
+
+    u8* dst = &surface->gl_buffer[(pending_rect.bottom * surface->stride + pending_rect.left) *
+                                  bytes_per_pixel];
+    for (u32 y = 0; y < pending_rect.GetHeight(); ++y) {
+        std::memcpy(dst + y * row_pitch, data + y * row_pitch, row_size);
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    pending->resolved = true;
+    return true;
+}
+
+void RasterizerCacheOpenGL::UpdateBoundFramebuffers(const Surface& color_surface,
+                                                    const Surface& depth_surface) {
+    for (const auto& bound : {bound_color_surface.lock(), bound_depth_surface.lock()}) {
+        if (bound == nullptr || bound == color_surface || bound == depth_surface) {
+            continue;
+        }
+        if (bound->registered && bound->prefetch_downloads) {
+            PrefetchSurface(bound);
+        }
+    }
+    bound_color_surface = color_surface;
+    bound_depth_surface = depth_surface;
+}
+
+MICROPROFILE_DEFINE(OpenGL_SurfaceHash, "OpenGL", "Surface Upload Hash", MP_RGB(64, 192, 128));
+void RasterizerCacheOpenGL::LoadAndUploadSurface(const Surface& surface,
+                                                 const SurfaceParams& params) {
+    // Games often copy the same data again over a texture. If the memory still holds what was
+    // last uploaded to this region, the texture is already up to date.
+    u64 hash = 0;
+    const auto source = VideoCore::g_memory->GetPhysicalRef(params.addr);
+    const bool can_hash = source && source.GetSize() >= params.size;
+    if (can_hash) {
+        MICROPROFILE_SCOPE(OpenGL_SurfaceHash);
+        hash = Common::ComputeFastHash64(source, params.size);
+        if (surface->uploaded_interval == params.GetInterval() && surface->uploaded_hash == hash) {
+            MICROPROFILE_META_CPU("Hits", 1);
+            return;
+        }
+        MICROPROFILE_META_CPU("Misses", 1);
+    }
+    surface->uploaded_interval = can_hash ? params.GetInterval() : SurfaceInterval{};
+    surface->uploaded_hash = hash;
+
+    const auto rect = surface->GetSubRect(params);
+    const u32 bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    const std::size_t rect_offset = (rect.bottom * surface->stride + rect.left) * bytes_per_pixel;
+    const std::size_t rect_size =
+        ((rect.GetHeight() - 1) * surface->stride + rect.GetWidth()) * bytes_per_pixel;
+
+    // Texture dumping and custom textures hash the whole of gl_buffer, so they keep using it
+    const bool hashes_gl_buffer =
+        Settings::values.dump_textures || Settings::values.custom_textures;
+
+    // The decoder reads the tiles of rect in a row from memory, which they are for whole tile rows
+    // and single tile rows
+    if (texture_decoder && surface->is_tiled && can_hash && !hashes_gl_buffer &&
+        surface->pixel_format != PixelFormat::Invalid && rect.left % 8 == 0 &&
+        rect.GetWidth() % 8 == 0 && rect.GetHeight() % 8 == 0 &&
+        (rect.GetWidth() == surface->stride || rect.GetHeight() == 8)) {
+        const GLuint texels =
+            texture_decoder->Decode(source, surface->pixel_format, rect, surface->stride);
+        surface->UploadGLTexture(rect, read_framebuffer.handle, draw_framebuffer.handle, texels, 0);
+        return;
+    }
+
+    const bool use_staging =
+        !hashes_gl_buffer && rect_size <= static_cast<std::size_t>(upload_buffer->GetSize());
+    if (!use_staging) {
+        if (surface->gl_buffer.empty()) {
+            surface->gl_buffer.resize(surface->width * surface->height * bytes_per_pixel);
+        }
+        surface->LoadGLBuffer(params.addr, params.end, surface->gl_buffer.data());
+        surface->UploadGLTexture(rect, read_framebuffer.handle, draw_framebuffer.handle);
+        return;
+    }
+
+    // Decode straight into the mapped staging memory. LoadGLBuffer addresses it with the layout of
+    // gl_buffer, so offset the pointer back by the position of the first texel of rect.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_buffer->GetHandle());
+    auto [staging_ptr, staging_offset, invalidate] =
+        upload_buffer->Map(static_cast<GLsizeiptr>(rect_size), 4);
+    surface->LoadGLBuffer(params.addr, params.end, staging_ptr - rect_offset);
+    upload_buffer->Unmap(static_cast<GLsizeiptr>(rect_size));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    surface->UploadGLTexture(rect, read_framebuffer.handle, draw_framebuffer.handle,
+                             upload_buffer->GetHandle(), staging_offset);
+}
+
 void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner) {
     std::lock_guard lock{mutex};
 
     if (size == 0)
         return;
 
+    vertex_buffer_cache->InvalidateRegion(addr, size);
+
     const SurfaceInterval invalid_interval(addr, addr + size);
 
     if (region_owner != nullptr) {
@@ -1847,37 +2595,40 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
         region_owner->invalid_regions.erase(invalid_interval);
-    }
-
-    for (const auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
-        for (const auto& cached_surface : pair.second) {
-            if (cached_surface == region_owner)
-                continue;
-
-            // If cpu is invalidating this region we want to remove it
-            // to (likely) mark the memory pages as uncached
-            if (region_owner == nullptr && size <= 8) {
-                FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
-                remove_surfaces.emplace(cached_surface);
-                continue;
-            }
+        // The texture has been written to, so any data prefetched or hashed from it is stale
+        region_owner->pending_download.reset();
+        region_owner->uploaded_interval = {};
+        region_owner->write_tick = ++write_counter;
+    }
+
+    ForEachSurfaceInRegion(surface_cache, invalid_interval, [&](const Surface& cached_surface) {
+        if (cached_surface == region_owner)
+            return;
+
+        // If cpu is invalidating this region we want to remove it
+        // to (likely) mark the memory pages as uncached
+        if (region_owner == nullptr && size <= 8) {
+            FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
+            remove_surfaces.emplace(cached_surface);
+            return;
+        }
 
-            const auto interval = cached_surface->GetInterval() & invalid_interval;
-            cached_surface->invalid_regions.insert(interval);
-            cached_surface->InvalidateAllWatcher();
+        const auto interval = cached_surface->GetInterval() & invalid_interval;
+        cached_surface->invalid_regions.insert(interval);
+        cached_surface->InvalidateAllWatcher();
 
-            // If the surface has no salvageable data it should be removed from the cache to avoid
-            // clogging the data structure
-            if (cached_surface->IsSurfaceFullyInvalid()) {
-                remove_surfaces.emplace(cached_surface);
-            }
+        // If the surface has no salvageable data it should be removed from the cache to avoid
+        // clogging the data structure
+        if (cached_surface->IsSurfaceFullyInvalid()) {
+            remove_surfaces.emplace(cached_surface);
         }
-    }
+    });
 
     if (region_owner != nullptr)
         dirty_regions.set({invalid_interval, region_owner});
     else
         dirty_regions.erase(invalid_interval);
+    UpdateDirtyPages(invalid_interval);
 
     for (const auto& remove_surface : remove_surfaces) {
         if (remove_surface == region_owner) {
@@ -1917,8 +2668,16 @@ void RasterizerCacheOpenGL::RegisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = true;
+    surface->last_used_frame = current_frame;
+    registered_surfaces.insert(surface);
+#ifdef USE_ICL_SURFACE_CACHE
     surface_cache.add({surface->GetInterval(), SurfaceSet{surface}});
     UpdatePagesCachedCount(surface->addr, surface->size, 1);
+#else
+    surface_cache.Add(surface, [this](PAddr addr, u32 size) {
+        UpdatePagesCachedCount(addr, size, 1);
+    });
+#endif
 }
 
 void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
@@ -1928,10 +2687,18 @@ void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = false;
+    registered_surfaces.erase(surface);
+#ifdef USE_ICL_SURFACE_CACHE
     UpdatePagesCachedCount(surface->addr, surface->size, -1);
     surface_cache.subtract({surface->GetInterval(), SurfaceSet{surface}});
+#else
+    surface_cache.Remove(surface, [this](PAddr addr, u32 size) {
+        UpdatePagesCachedCount(addr, size, -1);
+    });
+#endif
 }
 
+#ifdef USE_ICL_SURFACE_CACHE
 void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
     const u32 num_pages =
         ((addr + size - 1) >> Memory::PAGE_BITS) - (addr >> Memory::PAGE_BITS) + 1;
@@ -1965,5 +2732,49 @@ void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int del
     if (delta < 0)
         cached_pages.add({pages_interval, delta});
 }
+#else
+void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
+    const u32 page_start = addr >> Memory::PAGE_BITS;
+    const u32 page_end = ((addr + size - 1) >> Memory::PAGE_BITS) + 1;
+
+    // Runs of pages whose count starts or stops being 0 are marked together
+    u32 run_start = page_start;
+    u32 run_length = 0;
+    const auto mark_run = [&] {
+        if (run_length != 0) {
+            VideoCore::g_memory->RasterizerMarkRegionCached(
+                run_start << Memory::PAGE_BITS, run_length << Memory::PAGE_BITS, delta > 0);
+            run_length = 0;
+        }
+    };
+
+    for (u32 page = page_start; page < page_end; ++page) {
+        bool changed;
+        if (delta > 0) {
+            int& count = cached_page_counts[page];
+            changed = count == 0;
+            count += delta;
+        } else {
+            const auto it = cached_page_counts.find(page);
+            ASSERT(it != cached_page_counts.end() && it->second >= -delta);
+            it->second += delta;
+            changed = it->second == 0;
+            if (changed) {
+                cached_page_counts.erase(it);
+            }
+        }
+
+        if (!changed) {
+            mark_run();
+            continue;
+        }
+        if (run_length == 0) {
+            run_start = page;
+        }
+        ++run_length;
+    }
+    mark_run();
+}
+#endif
 
 } // namespace OpenGL
@@ -5,9 +5,11 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <tuple>
 #ifdef __GNUC__
@@ -28,6 +30,8 @@
 #include "common/math_util.h"
 #include "core/custom_tex_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_stream_buffer.h"
+#include "video_core/renderer_opengl/gl_surface_page_index.h"
 #include "video_core/renderer_opengl/gl_surface_params.h"
 #include "video_core/texture/texture_decode.h"
 
@@ -36,6 +40,7 @@ namespace OpenGL {
 class RasterizerCacheOpenGL;
 class TextureFilterer;
 class FormatReinterpreterOpenGL;
+class VertexBufferCache;
 
 struct FormatTuple {
     GLint internal_format;
@@ -118,6 +123,7 @@ using SurfaceRegions = boost::icl::interval_set<PAddr, std::less, SurfaceInterva
 using SurfaceMap =
     boost::icl::interval_map<PAddr, Surface, boost::icl::partial_absorber, std::less,
                              boost::icl::inplace_plus, boost::icl::inter_section, SurfaceInterval>;
+#ifdef USE_ICL_SURFACE_CACHE
 using SurfaceCache =
     boost::icl::interval_map<PAddr, SurfaceSet, boost::icl::partial_absorber, std::less,
                              boost::icl::inplace_plus, boost::icl::inter_section, SurfaceInterval>;
@@ -125,6 +131,12 @@ using SurfaceCache =
 static_assert(std::is_same<SurfaceRegions::interval_type, SurfaceCache::interval_type>() &&
                   std::is_same<SurfaceMap::interval_type, SurfaceCache::interval_type>(),
               "incorrect interval types");
+#else
+using SurfaceCache = SurfacePageIndex<Surface>;
+
+static_assert(std::is_same<SurfaceRegions::interval_type, SurfaceMap::interval_type>(),
+              "incorrect interval types");
+#endif
 
 using SurfaceRect_Tuple = std::tuple<Surface, Common::Rectangle<u32>>;
 using SurfaceSurfaceRect_Tuple = std::tuple<Surface, Surface, Common::Rectangle<u32>>;
@@ -189,9 +201,18 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
         return *invalid_regions.equal_range(interval).first == interval;
     }
 
+    /// Tag of the texture, which the texture is recycled under once the surface is destroyed
+    HostTextureTag GetTextureTag() const;
+
+    /// Approximate GPU memory of the texture in bytes
+    std::size_t GetTextureMemory() const;
+
     bool registered = false;
     SurfaceRegions invalid_regions;
 
+    /// Frame at which the surface was last looked up, for evicting the least recently used ones
+    u64 last_used_frame = 0;
+
     u32 fill_size = 0; /// Number of bytes to read from fill_data
     std::array<u8, 4> fill_data;
 
@@ -205,6 +226,16 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     bool is_custom = false;
     Core::CustomTexInfo custom_tex_info;
 
+    /// Whether the custom texture holds blocks, which are uploaded at every resolution scale
+    bool IsCustomCompressed() const {
+        return is_custom && custom_tex_info.format != Core::CustomTexFormat::RGBA8;
+    }
+
+    /// Whether texture was swapped for one of the size and format of the custom texture
+    bool HasCustomTextureStorage() const {
+        return is_custom && (res_scale == 1 || IsCustomCompressed());
+    }
+
     static constexpr unsigned int GetGLBytesPerPixel(PixelFormat format) {
         // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
         return format == PixelFormat::Invalid
@@ -215,20 +246,58 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     }
 
     std::vector<u8> gl_buffer;
+    /// Whether the last download left gl_buffer in the tiled layout of 3DS memory
+    bool gl_buffer_tiled = false;
+
+    /// Readback of a texture region into one of the owner's pixel pack buffers
+    struct PendingDownload {
+        Common::Rectangle<u32> rect;
+        std::size_t buffer_index;
+        bool resolved; ///< Whether the data has already been copied into gl_buffer
+    };
+    std::optional<PendingDownload> pending_download;
+
+    /// Set when the CPU read this surface back, so that the next unbind starts a prefetch
+    bool prefetch_downloads = false;
 
-    // Read/Write data in 3DS memory to/from gl_buffer
-    void LoadGLBuffer(PAddr load_start, PAddr load_end);
+    /// Hash of the 3DS memory last uploaded to the texture and the interval it covers. Cleared
+    /// whenever the texture is written by anything other than an upload.
+    SurfaceInterval uploaded_interval{};
+    u64 uploaded_hash = 0;
+
+    /// Value of the cache's write counter when the texture was last written, which tells whether
+    /// a displayed surface changed since the previous frame
+    u64 write_tick = 0;
+
+    // Read/Write data in 3DS memory to/from gl_buffer. LoadGLBuffer writes to gl_dst, which has the
+    // layout of gl_buffer but only needs to be backed for the texels of the loaded region.
+    void LoadGLBuffer(PAddr load_start, PAddr load_end, u8* gl_dst);
     void FlushGLBuffer(PAddr flush_start, PAddr flush_end);
 
     // Custom texture loading and dumping
     bool LoadCustomTexture(u64 tex_hash);
     void DumpTexture(GLuint target_tex, u64 tex_hash);
 
-    // Upload/Download data in gl_buffer in/to this surface's texture
-    void UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_handle, GLuint draw_fb_handle);
+    // Upload/Download data in gl_buffer in/to this surface's texture. When unpack_buffer is set,
+    // the texels of rect are instead read from it at unpack_offset, in the row layout of gl_buffer
+    void UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_handle, GLuint draw_fb_handle,
+                         GLuint unpack_buffer = 0, GLintptr unpack_offset = 0);
     void DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
                            GLuint draw_fb_handle);
 
+    // Download the region of this tiled surface straight into the tiled layout of gl_buffer with
+    // the compute shader of TextureDownloaderES. Returns false if that is not possible.
+    bool DownloadTiledGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
+                                GLuint draw_fb_handle);
+
+    /// Whether DownloadGLTextureAsync can read this surface back on the current driver
+    bool CanDownloadAsync() const;
+
+    // Read the region of this surface's texture into the bound GL_PIXEL_PACK_BUFFER at offset 0,
+    // using the row layout of gl_buffer starting at the first texel of rect
+    void DownloadGLTextureAsync(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
+                                GLuint draw_fb_handle);
+
     std::shared_ptr<SurfaceWatcher> CreateWatcher() {
         auto watcher = std::make_shared<SurfaceWatcher>(weak_from_this());
         watchers.push_front(watcher);
@@ -276,7 +345,10 @@ static constexpr std::array<FormatTuple, 4> depth_format_tuples = {{
     {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8}, // D24S8
 }};
 
+class TextureDecoderOpenGL;
 class TextureDownloaderES;
+class TextureDumper;
+class DynamicResolution;
 
 class RasterizerCacheOpenGL : NonCopyable {
 public:
@@ -329,11 +401,42 @@ public:
     /// Clear all cached resources tracked by this cache manager
     void ClearAll(bool flush);
 
+    /**
+     * Called once per frame. Evicts the surfaces used least recently, and frees recycled textures,
+     * while the texture memory is over Settings::values.surface_cache_budget.
+     */
+    void TickFrame();
+
+    /// Notes that something other than the rasterizer read the region. Doesn't need the lock.
+    void MarkReadBack(PAddr addr, u32 size);
+
+    /**
+     * Returns true if the region was read back during this or the previous frame, so that draws
+     * to it can't be skipped. Doesn't need the lock.
+     */
+    bool IsReadBack(PAddr addr, u32 size) const;
+
+    /**
+     * Increase/decrease the number of cached objects in pages touching the specified region. The
+     * pages are marked as cached in the memory system while the count is not 0.
+     */
+    void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
+
+    /// Returns the cache of vertex arrays, whose pages share the count of the surfaces
+    VertexBufferCache& GetVertexBufferCache() {
+        return *vertex_buffer_cache;
+    }
+
+    /// Keeps a texture that is no longer used, to hand it out again in AllocateSurfaceTexture
+    void RecycleTexture(const HostTextureTag& tag, OGLTexture&& texture);
+
     // Textures from destroyed surfaces are stored here to be recyled to reduce allocation overhead
     // in the driver
     // this must be placed above the surface_cache to ensure all cached surfaces are destroyed
     // before destroying the recycler
     std::unordered_multimap<HostTextureTag, OGLTexture> host_texture_recycler;
+    /// Texture memory held by host_texture_recycler in bytes
+    std::size_t recycled_texture_memory = 0;
 
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
@@ -362,18 +465,75 @@ private:
     /// Remove surface from the cache
     void UnregisterSurface(const Surface& surface);
 
-    /// Increase/decrease the number of surface in pages touching the specified region
-    void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
+    /// Returns true if the surface holds data that has not been written back to 3DS memory
+    bool IsSurfaceDirty(const Surface& surface) const;
+
+    /// Returns true if a page overlapping the region may be dirty. Doesn't need the lock.
+    bool IsRegionDirty(PAddr addr, u32 size) const;
+
+    /// Updates the dirty page flags of the interval after dirty_regions changed over it
+    void UpdateDirtyPages(const SurfaceInterval& interval);
+
+    /// Frees recycled textures until the texture memory is at most budget
+    void TrimRecycledTextures(std::size_t surface_memory, std::size_t budget);
+
+    /// Starts reading the dirty regions of a surface back without waiting for the GPU
+    void PrefetchSurface(const Surface& surface);
+
+    /// Copies a finished prefetch covering rect into gl_buffer. Returns false if there is none.
+    bool ResolvePrefetchedDownload(const Surface& surface, const Common::Rectangle<u32>& rect);
+
+    /// Prefetches the framebuffer surfaces that are no longer bound and were read back before
+    void UpdateBoundFramebuffers(const Surface& color_surface, const Surface& depth_surface);
+
+    /// Loads the region of params from 3DS memory and uploads it to the surface texture
+    void LoadAndUploadSurface(const Surface& surface, const SurfaceParams& params);
 
     SurfaceCache surface_cache;
+#ifdef USE_ICL_SURFACE_CACHE
     PageMap cached_pages;
+#else
+    /// Number of cached objects in each page that holds any
+    std::unordered_map<u32, int> cached_page_counts;
+#endif
     SurfaceMap dirty_regions;
+    /// Whether each page from VRAM to the end of FCRAM overlaps dirty_regions, so that the CPU can
+    /// read the clean pages without taking the lock
+    std::unique_ptr<std::atomic<bool>[]> dirty_pages;
+    /// Value of read_back_frame when each page of the same range was last read back, 0 if never.
+    /// It starts at 2 so that pages that were never read back are not within a frame of it.
+    std::unique_ptr<std::atomic<u32>[]> read_back_pages;
+    std::atomic<u32> read_back_frame{2};
     SurfaceSet remove_surfaces;
 
+    /// All registered surfaces, which are the candidates for eviction
+    SurfaceSet registered_surfaces;
+    u64 current_frame = 0;
+    /// Incremented whenever the texture of a surface is written
+    u64 write_counter = 0;
+
     OGLFramebuffer read_framebuffer;
     OGLFramebuffer draw_framebuffer;
 
+    /// Pixel pack buffers used round-robin by surface prefetches
+    struct DownloadBuffer {
+        OGLBuffer buffer;
+        GLsizeiptr size = 0;
+        OGLSync fence;
+        std::weak_ptr<CachedSurface> surface;
+    };
+    std::array<DownloadBuffer, 8> download_buffers;
+    std::size_t next_download_buffer = 0;
+
+    std::weak_ptr<CachedSurface> bound_color_surface;
+    std::weak_ptr<CachedSurface> bound_depth_surface;
+
+    /// Pixel unpack buffer that surface loads decode into, so that uploads need no extra copy
+    std::unique_ptr<OGLStreamBuffer> upload_buffer;
+
     u16 resolution_scale_factor;
+    /// Picks the scale of new framebuffer surfaces, when the dynamic resolution is enabled
+    std::unique_ptr<DynamicResolution> dynamic_resolution;
 
     std::unordered_map<TextureCubeConfig, CachedTextureCube> texture_cube_cache;
 
@@ -383,8 +543,13 @@ public:
     OGLTexture AllocateSurfaceTexture(const FormatTuple& format_tuple, u32 width, u32 height);
 
     std::unique_ptr<TextureFilterer> texture_filterer;
+    /// Set while surfaces are loaded for sampling, the only uploads that are filtered
+    bool filter_uploads = false;
     std::unique_ptr<FormatReinterpreterOpenGL> format_reinterpreter;
+    std::unique_ptr<TextureDecoderOpenGL> texture_decoder;
     std::unique_ptr<TextureDownloaderES> texture_downloader_es;
+    std::unique_ptr<TextureDumper> texture_dumper;
+    std::unique_ptr<VertexBufferCache> vertex_buffer_cache;
 };
 
 } // namespace OpenGL
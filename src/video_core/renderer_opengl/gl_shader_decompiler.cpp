@@ -2,7 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <exception>
+#include <limits>
 #include <map>
 #include <set>
 #include <string>
@@ -262,16 +266,334 @@ constexpr auto GetSelectorSrc1 = GetSelectorSrc<&SwizzlePattern::GetSelectorSrc1
 constexpr auto GetSelectorSrc2 = GetSelectorSrc<&SwizzlePattern::GetSelectorSrc2>;
 constexpr auto GetSelectorSrc3 = GetSelectorSrc<&SwizzlePattern::GetSelectorSrc3>;
 
+/**
+ * Finds the multiplications that need sanitize_mul. PICA multiplies 0 by inf to 0, while GPUs give
+ * NaN, but that can only happen when one factor may be infinite while the other may be zero. This
+ * tracks the range of each temporary register component over the whole program. Inputs and
+ * uniforms can hold anything, but comparisons, clamps and the initial register values give ranges
+ * that often carry through to the factors.
+ */
+class MulRangeAnalyzer {
+public:
+    MulRangeAnalyzer(const std::set<Subroutine>& subroutines,
+                     const Pica::Shader::ProgramCode& program_code,
+                     const Pica::Shader::SwizzleData& swizzle_data)
+        : program_code(program_code), swizzle_data(swizzle_data) {
+
+        // Every instruction from the start of a subroutine or of a label to the next END
+        std::set<u32> offsets;
+        for (const auto& subroutine : subroutines) {
+            std::set<u32> starts = subroutine.labels;
+            starts.insert(subroutine.begin);
+            for (const u32 start : starts) {
+                for (u32 offset = start; offset != subroutine.end && offset < PROGRAM_END;
+                     ++offset) {
+                    offsets.insert(offset);
+                    const Instruction instr = {program_code[offset]};
+                    if (instr.opcode.Value() == OpCode::Id::END) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        for (auto& reg : temporaries) {
+            reg = {ValueRange{0.0f, 0.0f, false}, {0.0f, 0.0f, false}, {0.0f, 0.0f, false},
+                   {1.0f, 1.0f, false}};
+        }
+
+        // Joins the results into the registers until nothing changes. Ranges that still grow after
+        // a few passes, such as loop counters, are widened to infinity so that this ends.
+        for (u32 pass = 0;; ++pass) {
+            bool changed = false;
+            for (const u32 offset : offsets) {
+                changed |= Analyze(offset, pass >= WIDENING_PASS);
+            }
+            if (!changed) {
+                break;
+            }
+        }
+    }
+
+    std::set<u32> MoveSanitizedMuls() {
+        return std::move(sanitized_muls);
+    }
+
+private:
+    static constexpr u32 WIDENING_PASS = 4;
+    static constexpr float INF = std::numeric_limits<float>::infinity();
+
+    /// Bounds of a component whenever it is not NaN
+    struct ValueRange {
+        float min;
+        float max;
+        bool may_be_nan;
+
+        bool MayBeInfinite() const {
+            return std::isinf(min) || std::isinf(max);
+        }
+
+        /// Denormals count as zero, as GPUs may flush them
+        bool MayBeZero() const {
+            return min <= std::numeric_limits<float>::min() &&
+                   max >= -std::numeric_limits<float>::min();
+        }
+
+        bool operator==(const ValueRange& rhs) const {
+            return min == rhs.min && max == rhs.max && may_be_nan == rhs.may_be_nan;
+        }
+    };
+    using Vec4Range = std::array<ValueRange, 4>;
+
+    static constexpr ValueRange ANY{-INF, INF, true};
+
+    /// Replaces the NaN bounds that adding opposite infinities gives
+    static ValueRange Bound(float min, float max, bool may_be_nan) {
+        return {std::isnan(min) ? -INF : min, std::isnan(max) ? INF : max, may_be_nan};
+    }
+
+    /// Widens the range by an ulp for functions that GPUs only approximate
+    static ValueRange Approximate(float min, float max, bool may_be_nan) {
+        return Bound(std::nextafter(min, -INF), std::nextafter(max, INF), may_be_nan);
+    }
+
+    static ValueRange Join(ValueRange a, ValueRange b) {
+        return {std::min(a.min, b.min), std::max(a.max, b.max), a.may_be_nan || b.may_be_nan};
+    }
+
+    static ValueRange Add(ValueRange a, ValueRange b) {
+        return Bound(a.min + b.min, a.max + b.max,
+                     a.may_be_nan || b.may_be_nan || (a.MayBeInfinite() && b.MayBeInfinite()));
+    }
+
+    /// GPUs may return the other operand when one is NaN, instead of NaN
+    static ValueRange MinMax(ValueRange a, ValueRange b, bool is_max) {
+        ValueRange result = is_max
+                                ? ValueRange{std::max(a.min, b.min), std::max(a.max, b.max), false}
+                                : ValueRange{std::min(a.min, b.min), std::min(a.max, b.max), false};
+        if (a.may_be_nan) {
+            result = Join(result, b);
+        }
+        if (b.may_be_nan) {
+            result = Join(result, a);
+        }
+        return result;
+    }
+
+    /// Products use the PICA rule, as the factors are either sanitized or proven not to need it
+    static ValueRange Mul(ValueRange a, ValueRange b) {
+        const auto mul = [](float lhs, float rhs) {
+            const float product = lhs * rhs;
+            return std::isnan(product) ? 0.0f : product;
+        };
+        const std::array<float, 4> products{mul(a.min, b.min), mul(a.min, b.max),
+                                            mul(a.max, b.min), mul(a.max, b.max)};
+        return {*std::min_element(products.begin(), products.end()),
+                *std::max_element(products.begin(), products.end()),
+                a.may_be_nan || b.may_be_nan};
+    }
+
+    static bool CanMultiply(ValueRange a, ValueRange b) {
+        return !(a.MayBeInfinite() && b.MayBeZero()) && !(b.MayBeInfinite() && a.MayBeZero());
+    }
+
+    template <SwizzlePattern::Selector (SwizzlePattern::*getter)(int) const>
+    Vec4Range GetSource(const SourceRegister& source_reg, const SwizzlePattern& swizzle,
+                        bool negate) const {
+        Vec4Range result;
+        for (int i = 0; i < 4; ++i) {
+            const ValueRange value =
+                source_reg.GetRegisterType() == RegisterType::Temporary
+                    ? temporaries[source_reg.GetIndex()][static_cast<int>((swizzle.*getter)(i))]
+                    : ANY;
+            result[i] = negate ? ValueRange{-value.max, -value.min, value.may_be_nan} : value;
+        }
+        return result;
+    }
+
+    /// Analyzes the instruction at offset, returning true if a register range grew
+    bool Analyze(u32 offset, bool widen) {
+        const Instruction instr = {program_code[offset]};
+        const OpCode::Info info = instr.opcode.Value().GetInfo();
+        const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+        if (info.type != OpCode::Type::Arithmetic && info.type != OpCode::Type::MultiplyAdd) {
+            return false;
+        }
+
+        const bool is_mad = info.type == OpCode::Type::MultiplyAdd;
+        if (is_mad && opcode != OpCode::Id::MAD && opcode != OpCode::Id::MADI) {
+            return false;
+        }
+        const SwizzlePattern swizzle = {
+            swizzle_data[is_mad ? instr.mad.operand_desc_id : instr.common.operand_desc_id]};
+        const auto is_enabled = [&](int i) { return swizzle.DestComponentEnabled(i); };
+
+        Vec4Range src1, src2;
+        int dest_index = -1;
+        if (is_mad) {
+            const bool is_inverted = opcode == OpCode::Id::MADI;
+            src1 = GetSource<&SwizzlePattern::GetSelectorSrc1>(instr.mad.GetSrc1(is_inverted),
+                                                               swizzle, swizzle.negate_src1);
+            src2 = GetSource<&SwizzlePattern::GetSelectorSrc2>(instr.mad.GetSrc2(is_inverted),
+                                                               swizzle, swizzle.negate_src2);
+            if (instr.mad.dest.Value() >= 0x10 && instr.mad.dest.Value() < 0x20) {
+                dest_index = static_cast<int>(instr.mad.dest.Value().GetIndex());
+            }
+        } else {
+            const bool is_inverted = (info.subtype & OpCode::Info::SrcInversed) != 0;
+            src1 = GetSource<&SwizzlePattern::GetSelectorSrc1>(instr.common.GetSrc1(is_inverted),
+                                                               swizzle, swizzle.negate_src1);
+            src2 = GetSource<&SwizzlePattern::GetSelectorSrc2>(instr.common.GetSrc2(is_inverted),
+                                                               swizzle, swizzle.negate_src2);
+            if (instr.common.dest.Value().GetRegisterType() == RegisterType::Temporary) {
+                dest_index = static_cast<int>(instr.common.dest.Value().GetIndex());
+            }
+        }
+
+        Vec4Range result;
+        bool needs_sanitize = false;
+        const auto dot = [&](int components) {
+            ValueRange sum{0.0f, 0.0f, false};
+            for (int i = 0; i < components; ++i) {
+                needs_sanitize |= !CanMultiply(src1[i], src2[i]);
+                sum = Add(sum, Mul(src1[i], src2[i]));
+            }
+            result.fill(sum);
+        };
+
+        switch (opcode) {
+        case OpCode::Id::ADD:
+            for (int i = 0; i < 4; ++i) {
+                result[i] = Add(src1[i], src2[i]);
+            }
+            break;
+        case OpCode::Id::MUL:
+        case OpCode::Id::MAD:
+        case OpCode::Id::MADI: {
+            const Vec4Range src3 =
+                is_mad ? GetSource<&SwizzlePattern::GetSelectorSrc3>(
+                             instr.mad.GetSrc3(opcode == OpCode::Id::MADI), swizzle,
+                             swizzle.negate_src3)
+                       : Vec4Range{};
+            for (int i = 0; i < 4; ++i) {
+                needs_sanitize |= is_enabled(i) && !CanMultiply(src1[i], src2[i]);
+                result[i] = Mul(src1[i], src2[i]);
+                if (is_mad) {
+                    result[i] = Add(result[i], src3[i]);
+                }
+            }
+            break;
+        }
+        case OpCode::Id::DP3:
+            dot(3);
+            break;
+        case OpCode::Id::DP4:
+            dot(4);
+            break;
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI:
+            src1[3] = {1.0f, 1.0f, false};
+            dot(4);
+            break;
+        case OpCode::Id::FLR:
+            for (int i = 0; i < 4; ++i) {
+                result[i] = {std::floor(src1[i].min), std::floor(src1[i].max), src1[i].may_be_nan};
+            }
+            break;
+        case OpCode::Id::MAX:
+            for (int i = 0; i < 4; ++i) {
+                result[i] = MinMax(src1[i], src2[i], true);
+            }
+            break;
+        case OpCode::Id::MIN:
+            for (int i = 0; i < 4; ++i) {
+                result[i] = MinMax(src1[i], src2[i], false);
+            }
+            break;
+        case OpCode::Id::RCP: {
+            const ValueRange x = src1[0];
+            result.fill(x.MayBeZero() ? ValueRange{-INF, INF, x.may_be_nan}
+                                      : Approximate(1.0f / x.max, 1.0f / x.min, x.may_be_nan));
+            break;
+        }
+        case OpCode::Id::RSQ: {
+            const ValueRange x = src1[0];
+            result.fill(x.min > std::numeric_limits<float>::min()
+                            ? Approximate(1.0f / std::sqrt(x.max), 1.0f / std::sqrt(x.min),
+                                          x.may_be_nan)
+                            : ANY);
+            break;
+        }
+        case OpCode::Id::EX2: {
+            const ValueRange x = src1[0];
+            result.fill(Approximate(std::exp2(x.min), std::exp2(x.max), x.may_be_nan));
+            break;
+        }
+        case OpCode::Id::LG2: {
+            const ValueRange x = src1[0];
+            result.fill(x.min > std::numeric_limits<float>::min()
+                            ? Approximate(std::log2(x.min), std::log2(x.max), x.may_be_nan)
+                            : ANY);
+            break;
+        }
+        case OpCode::Id::MOV:
+            result = src1;
+            break;
+        case OpCode::Id::SGE:
+        case OpCode::Id::SGEI:
+        case OpCode::Id::SLT:
+        case OpCode::Id::SLTI:
+            result.fill({0.0f, 1.0f, false});
+            break;
+        default:
+            result.fill(ANY);
+            break;
+        }
+
+        if (needs_sanitize) {
+            sanitized_muls.insert(offset);
+        }
+        if (dest_index < 0) {
+            return false;
+        }
+
+        bool changed = false;
+        Vec4Range& dest = temporaries[dest_index];
+        for (int i = 0; i < 4; ++i) {
+            if (!is_enabled(i)) {
+                continue;
+            }
+            ValueRange joined = Join(dest[i], result[i]);
+            if (joined == dest[i]) {
+                continue;
+            }
+            if (widen) {
+                joined.min = joined.min < dest[i].min ? -INF : joined.min;
+                joined.max = joined.max > dest[i].max ? INF : joined.max;
+            }
+            dest[i] = joined;
+            changed = true;
+        }
+        return changed;
+    }
+
+    const Pica::Shader::ProgramCode& program_code;
+    const Pica::Shader::SwizzleData& swizzle_data;
+    std::array<Vec4Range, 16> temporaries;
+    std::set<u32> sanitized_muls;
+};
+
 class GLSLGenerator {
 public:
     GLSLGenerator(const std::set<Subroutine>& subroutines,
                   const Pica::Shader::ProgramCode& program_code,
                   const Pica::Shader::SwizzleData& swizzle_data, u32 main_offset,
                   const RegGetter& inputreg_getter, const RegGetter& outputreg_getter,
-                  bool sanitize_mul)
+                  bool sanitize_mul, const std::set<u32>& sanitized_muls, bool is_gs)
         : subroutines(subroutines), program_code(program_code), swizzle_data(swizzle_data),
           main_offset(main_offset), inputreg_getter(inputreg_getter),
-          outputreg_getter(outputreg_getter), sanitize_mul(sanitize_mul) {
+          outputreg_getter(outputreg_getter), sanitize_mul(sanitize_mul),
+          sanitized_muls(sanitized_muls), is_gs(is_gs) {
 
         Generate();
     }
@@ -433,6 +755,7 @@ private:
                 ? ((std::size_t)instr.mad.operand_desc_id)
                 : ((std::size_t)instr.common.operand_desc_id);
         const SwizzlePattern swizzle = {swizzle_data[swizzle_offset]};
+        const bool sanitize = sanitized_muls.count(offset) != 0;
 
         shader.AddLine("// {}: {}", offset, instr.opcode.Value().GetInfo().name);
 
@@ -460,7 +783,7 @@ private:
             }
 
             case OpCode::Id::MUL: {
-                if (sanitize_mul) {
+                if (sanitize) {
                     SetDest(swizzle, dest_reg, fmt::format("sanitize_mul({}, {})", src1, src2), 4,
                             4);
                 } else {
@@ -491,13 +814,13 @@ private:
                 OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
                 std::string dot;
                 if (opcode == OpCode::Id::DP3) {
-                    if (sanitize_mul) {
+                    if (sanitize) {
                         dot = fmt::format("dot(vec3(sanitize_mul({}, {})), vec3(1.0))", src1, src2);
                     } else {
                         dot = fmt::format("dot(vec3({}), vec3({}))", src1, src2);
                     }
                 } else {
-                    if (sanitize_mul) {
+                    if (sanitize) {
                         const std::string src1_ =
                             (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
                                 ? fmt::format("vec4({}.xyz, 1.0)", src1)
@@ -634,7 +957,7 @@ private:
                               ? "reg_tmp" + std::to_string(instr.mad.dest.Value().GetIndex())
                               : "";
 
-                if (sanitize_mul) {
+                if (sanitize) {
                     SetDest(swizzle, dest_reg,
                             fmt::format("sanitize_mul({}, {}) + {}", src1, src2, src3), 4, 4);
                 } else {
@@ -781,10 +1104,26 @@ private:
                 break;
             }
 
-            case OpCode::Id::EMIT:
-            case OpCode::Id::SETEMIT:
-                LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+            case OpCode::Id::EMIT: {
+                if (!is_gs) {
+                    LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                    break;
+                }
+                shader.AddLine("emit();");
                 break;
+            }
+
+            case OpCode::Id::SETEMIT: {
+                if (!is_gs) {
+                    LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                    break;
+                }
+                ASSERT(instr.setemit.vertex_id < 3);
+                shader.AddLine("setemit({}u, {}, {});", instr.setemit.vertex_id.Value(),
+                               instr.setemit.prim_emit.Value() != 0 ? "true" : "false",
+                               instr.setemit.winding.Value() != 0 ? "true" : "false");
+                break;
+            }
 
             default: {
                 LOG_ERROR(HW_GPU, "Unhandled instruction: 0x{:02x} ({}): 0x{:08x}",
@@ -816,7 +1155,7 @@ private:
     }
 
     void Generate() {
-        if (sanitize_mul) {
+        if (!sanitized_muls.empty()) {
 #ifdef ANDROID
             // Use a cheaper sanitize_mul on Android, as mobile GPUs struggle here
             // This seems to be sufficient at least for Ocarina of Time and Attack on Titan accurate
@@ -916,6 +1255,9 @@ private:
     const RegGetter& inputreg_getter;
     const RegGetter& outputreg_getter;
     const bool sanitize_mul;
+    /// Offsets of the multiplications that may multiply 0 by inf
+    const std::set<u32>& sanitized_muls;
+    const bool is_gs;
 
     ShaderWriter shader;
 };
@@ -937,12 +1279,18 @@ std::optional<ProgramResult> DecompileProgram(const Pica::Shader::ProgramCode& p
                                               const Pica::Shader::SwizzleData& swizzle_data,
                                               u32 main_offset, const RegGetter& inputreg_getter,
                                               const RegGetter& outputreg_getter,
-                                              bool sanitize_mul) {
+                                              bool sanitize_mul, bool is_gs) {
 
     try {
         auto subroutines = ControlFlowAnalyzer(program_code, main_offset).MoveSubroutines();
+        std::set<u32> sanitized_muls;
+        if (sanitize_mul) {
+            sanitized_muls =
+                MulRangeAnalyzer(subroutines, program_code, swizzle_data).MoveSanitizedMuls();
+        }
         GLSLGenerator generator(subroutines, program_code, swizzle_data, main_offset,
-                                inputreg_getter, outputreg_getter, sanitize_mul);
+                                inputreg_getter, outputreg_getter, sanitize_mul, sanitized_muls,
+                                is_gs);
         return {ProgramResult{generator.MoveShaderCode()}};
     } catch (const DecompileFail& exception) {
         LOG_INFO(HW_GPU, "Shader decompilation failed: {}", exception.what());
@@ -24,6 +24,7 @@ std::string GetCommonDeclarations();
 std::optional<ProgramResult> DecompileProgram(const Pica::Shader::ProgramCode& program_code,
                                               const Pica::Shader::SwizzleData& swizzle_data,
                                               u32 main_offset, const RegGetter& inputreg_getter,
-                                              const RegGetter& outputreg_getter, bool sanitize_mul);
+                                              const RegGetter& outputreg_getter, bool sanitize_mul,
+                                              bool is_gs);
 
 } // namespace OpenGL::ShaderDecompiler
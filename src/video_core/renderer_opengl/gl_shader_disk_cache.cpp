@@ -3,12 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <type_traits>
 #include <fmt/format.h>
 
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
 #include "common/zstd_compression.h"
@@ -29,9 +31,26 @@ enum class TransferableEntryKind : u32 {
 enum class PrecompiledEntryKind : u32 {
     Decompiled,
     Dump,
+    /// Hash of the driver that built the dumps, written right after the version hash
+    Driver,
 };
 
-constexpr u32 NativeVersion = 1;
+/// Header of each transferable entry, followed by the zstd compressed ShaderDiskCacheRaw
+struct TransferableEntryHeader {
+    u64 unique_identifier;
+    TransferableEntryKind kind;
+    u32 uncompressed_size;
+    u32 compressed_size;
+    u32 padding;
+};
+static_assert(sizeof(TransferableEntryHeader) == 24, "TransferableEntryHeader has wrong size");
+static_assert(std::is_trivially_copyable_v<TransferableEntryHeader>,
+              "TransferableEntryHeader must be trivially copyable");
+
+constexpr u32 NativeVersion = 2;
+/// Last version that stored the transferable entries uncompressed, which is migrated on load
+constexpr u32 UncompressedVersion = 1;
+constexpr u32 UsageVersion = 1;
 
 ShaderCacheVersionHash GetShaderCacheVersionHash() {
     ShaderCacheVersionHash hash{};
@@ -75,34 +94,175 @@ bool ShaderDiskCacheRaw::Load(FileUtil::IOFile& file) {
     return true;
 }
 
-bool ShaderDiskCacheRaw::Save(FileUtil::IOFile& file) const {
-    if (file.WriteObject(unique_identifier) != 1 ||
-        file.WriteObject(static_cast<u32>(program_type)) != 1) {
+bool ShaderDiskCacheRaw::Load(const u8* data, std::size_t size) {
+    std::size_t offset = 0;
+    const auto read = [&](void* dest, std::size_t length) {
+        if (size - offset < length) {
+            return false;
+        }
+        std::memcpy(dest, data + offset, length);
+        offset += length;
+        return true;
+    };
+
+    u64 reg_array_len{};
+    if (!read(&unique_identifier, sizeof(u64)) || !read(&program_type, sizeof(u32)) ||
+        !read(&reg_array_len, sizeof(u64)) || reg_array_len > config.reg_array.size() ||
+        !read(config.reg_array.data(), reg_array_len * sizeof(u32))) {
         return false;
     }
 
+    if (program_type == ProgramType::VS) {
+        u64 code_len{};
+        if (!read(&code_len, sizeof(u64)) || code_len > (size - offset) / sizeof(u32)) {
+            return false;
+        }
+        program_code.resize(code_len);
+        if (!read(program_code.data(), code_len * sizeof(u32))) {
+            return false;
+        }
+    }
+
+    return offset == size;
+}
+
+std::vector<u8> ShaderDiskCacheRaw::Serialize() const {
+    std::vector<u8> data;
+    const auto write = [&data](const void* source, std::size_t length) {
+        const auto bytes = static_cast<const u8*>(source);
+        data.insert(data.end(), bytes, bytes + length);
+    };
+
+    const u32 type = static_cast<u32>(program_type);
+    write(&unique_identifier, sizeof(u64));
+    write(&type, sizeof(u32));
+
     // Just for future proofing, save the sizes of the array to the file
-    const std::size_t reg_array_len = Pica::Regs::NUM_REGS;
-    if (file.WriteObject(static_cast<u64>(reg_array_len)) != 1) {
+    const u64 reg_array_len = Pica::Regs::NUM_REGS;
+    write(&reg_array_len, sizeof(u64));
+    write(config.reg_array.data(), reg_array_len * sizeof(u32));
+
+    if (program_type == ProgramType::VS) {
+        const u64 code_len = program_code.size();
+        write(&code_len, sizeof(u64));
+        write(program_code.data(), code_len * sizeof(u32));
+    }
+    return data;
+}
+
+static bool WriteTransferableEntry(FileUtil::IOFile& file, const ShaderDiskCacheRaw& entry) {
+    const std::vector<u8> data = entry.Serialize();
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTDDefault(data.data(), data.size());
+    if (compressed.empty()) {
         return false;
     }
-    if (file.WriteArray(config.reg_array.data(), reg_array_len) != reg_array_len) {
+
+    TransferableEntryHeader header{};
+    header.unique_identifier = entry.GetUniqueIdentifier();
+    header.kind = TransferableEntryKind::Raw;
+    header.uncompressed_size = static_cast<u32>(data.size());
+    header.compressed_size = static_cast<u32>(compressed.size());
+    return file.WriteObject(header) == 1 &&
+           file.WriteBytes(compressed.data(), compressed.size()) == compressed.size();
+}
+
+/**
+ * Reads the entries of a transferable file in the uncompressed format, from the current position
+ * of the file. Entries whose identifier is already known are skipped.
+ */
+static bool ReadUncompressedEntries(FileUtil::IOFile& file, std::unordered_set<u64>& known,
+                                    std::vector<ShaderDiskCacheRaw>& raws) {
+    while (file.Tell() < file.GetSize()) {
+        TransferableEntryKind kind{};
+        if (file.ReadBytes(&kind, sizeof(u32)) != sizeof(u32)) {
+            LOG_ERROR(Render_OpenGL, "Failed to read transferable file - skipping");
+            return false;
+        }
+        if (kind != TransferableEntryKind::Raw) {
+            LOG_ERROR(Render_OpenGL, "Unknown transferable shader cache entry kind={} - skipping",
+                      kind);
+            return false;
+        }
+
+        ShaderDiskCacheRaw entry;
+        if (!entry.Load(file)) {
+            LOG_ERROR(Render_OpenGL, "Failed to load transferable raw entry - skipping");
+            return false;
+        }
+        if (known.insert(entry.GetUniqueIdentifier()).second) {
+            raws.push_back(std::move(entry));
+        }
+    }
+    return true;
+}
+
+/**
+ * Reads the entries of a transferable file in the native format, from the current position of
+ * the file. Entries whose identifier is already known are skipped.
+ */
+static bool ReadNativeEntries(FileUtil::IOFile& file, std::unordered_set<u64>& known,
+                              std::vector<ShaderDiskCacheRaw>& raws) {
+    // Read the whole file in one go, the entries are then decompressed straight from memory
+    std::vector<u8> contents(file.GetSize() - file.Tell());
+    if (file.ReadBytes(contents.data(), contents.size()) != contents.size()) {
+        LOG_ERROR(Render_OpenGL, "Failed to read transferable file - skipping");
         return false;
     }
 
-    if (program_type == ProgramType::VS) {
-        const std::size_t code_len = program_code.size();
-        if (file.WriteObject(static_cast<u64>(code_len)) != 1) {
+    std::size_t offset = 0;
+    while (offset < contents.size()) {
+        TransferableEntryHeader header;
+        if (contents.size() - offset < sizeof(header)) {
+            LOG_ERROR(Render_OpenGL, "Failed to read transferable file - skipping");
             return false;
         }
-        if (file.WriteArray(program_code.data(), code_len) != code_len) {
+        std::memcpy(&header, contents.data() + offset, sizeof(header));
+        offset += sizeof(header);
+
+        if (contents.size() - offset < header.compressed_size) {
+            LOG_ERROR(Render_OpenGL, "Transferable entry is truncated - skipping");
             return false;
         }
+        const u8* const payload = contents.data() + offset;
+        offset += header.compressed_size;
+
+        if (header.kind != TransferableEntryKind::Raw) {
+            LOG_ERROR(Render_OpenGL, "Unknown transferable shader cache entry kind={} - skipping",
+                      header.kind);
+            return false;
+        }
+
+        // The header carries the identifier, so duplicated entries are skipped undecompressed
+        if (!known.insert(header.unique_identifier).second) {
+            continue;
+        }
+
+        const std::vector<u8> decompressed =
+            Common::Compression::DecompressDataZSTD(payload, header.compressed_size);
+        ShaderDiskCacheRaw entry;
+        if (decompressed.size() != header.uncompressed_size ||
+            !entry.Load(decompressed.data(), decompressed.size()) ||
+            entry.GetUniqueIdentifier() != header.unique_identifier) {
+            LOG_ERROR(Render_OpenGL, "Failed to load transferable raw entry - skipping");
+            return false;
+        }
+        raws.push_back(std::move(entry));
     }
     return true;
 }
 
-ShaderDiskCache::ShaderDiskCache(bool separable) : separable{separable} {}
+ShaderDiskCache::ShaderDiskCache(bool separable) : separable{separable} {
+    // Program binaries are only valid for the driver that built them
+    std::string driver;
+    for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        if (const auto value = reinterpret_cast<const char*>(glGetString(name))) {
+            driver += value;
+        }
+        driver += '\n';
+    }
+    driver_hash = Common::ComputeHash64(driver.data(), driver.size());
+}
 
 std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable() {
     const bool has_title_id = GetProgramID() != 0;
@@ -112,13 +272,28 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
     }
     tried_to_load = true;
 
+    std::vector<ShaderDiskCacheRaw> raws;
     FileUtil::IOFile file(GetTransferablePath(), "rb");
-    if (!file.IsOpen()) {
+    if (file.IsOpen()) {
+        auto loaded = LoadTransferableFile(file);
+        if (!loaded) {
+            return std::nullopt;
+        }
+        raws = std::move(*loaded);
+    } else {
         LOG_INFO(Render_OpenGL, "No transferable shader cache found for game with title id={}",
                  GetTitleID());
+    }
+
+    ImportTransferable(raws);
+    if (raws.empty() && !file.IsOpen()) {
         return std::nullopt;
     }
+    return {std::move(raws)};
+}
 
+std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferableFile(
+    FileUtil::IOFile& file) {
     u32 version{};
     if (file.ReadBytes(&version, sizeof(version)) != sizeof(version)) {
         LOG_ERROR(Render_OpenGL,
@@ -127,6 +302,9 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
         return std::nullopt;
     }
 
+    if (version == UncompressedVersion) {
+        return MigrateTransferableFile(file);
+    }
     if (version < NativeVersion) {
         LOG_INFO(Render_OpenGL, "Transferable shader cache is old - removing");
         file.Close();
@@ -139,35 +317,106 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
         return std::nullopt;
     }
 
-    // Version is valid, load the shaders
     std::vector<ShaderDiskCacheRaw> raws;
-    while (file.Tell() < file.GetSize()) {
-        TransferableEntryKind kind{};
-        if (file.ReadBytes(&kind, sizeof(u32)) != sizeof(u32)) {
-            LOG_ERROR(Render_OpenGL, "Failed to read transferable file - skipping");
-            return std::nullopt;
+    if (!ReadNativeEntries(file, transferable, raws)) {
+        return std::nullopt;
+    }
+    LOG_INFO(Render_OpenGL, "Found a transferable disk cache with {} entries", raws.size());
+    return {std::move(raws)};
+}
+
+std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::MigrateTransferableFile(
+    FileUtil::IOFile& file) {
+    std::vector<ShaderDiskCacheRaw> raws;
+    if (!ReadUncompressedEntries(file, transferable, raws)) {
+        return std::nullopt;
+    }
+    file.Close();
+
+    LOG_INFO(Render_OpenGL, "Compressing an uncompressed transferable disk cache with {} entries",
+             raws.size());
+    if (!FileUtil::Delete(GetTransferablePath())) {
+        LOG_ERROR(Render_OpenGL, "Failed to remove old transferable file={}",
+                  GetTransferablePath());
+        return std::nullopt;
+    }
+    FileUtil::IOFile new_file = AppendTransferableFile();
+    for (const auto& raw : raws) {
+        if (!new_file.IsOpen() || !WriteTransferableEntry(new_file, raw)) {
+            LOG_ERROR(Render_OpenGL, "Failed to save raw transferable cache entry - removing");
+            new_file.Close();
+            InvalidateAll();
+            break;
         }
+    }
+    return {std::move(raws)};
+}
 
-        switch (kind) {
-        case TransferableEntryKind::Raw: {
-            ShaderDiskCacheRaw entry;
-            if (!entry.Load(file)) {
-                LOG_ERROR(Render_OpenGL, "Failed to load transferable raw entry - skipping");
-                return std::nullopt;
+void ShaderDiskCache::ImportTransferable(std::vector<ShaderDiskCacheRaw>& raws) {
+    const std::string import_dir = GetImportDir();
+    if (!FileUtil::IsDirectory(import_dir)) {
+        return;
+    }
+
+    // Any <title id>*.bin file, so that caches of several sources can be dropped in at once
+    std::vector<std::string> paths;
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, import_dir,
+        [this, &paths](u64*, const std::string& directory, const std::string& name) {
+            const std::string& title = GetTitleID();
+            if (name.size() >= title.size() + 4 && name.compare(0, title.size(), title) == 0 &&
+                name.compare(name.size() - 4, 4, ".bin") == 0) {
+                paths.push_back(directory + DIR_SEP + name);
             }
-            transferable.emplace(entry.GetUniqueIdentifier(), ShaderDiskCacheRaw{});
-            raws.push_back(std::move(entry));
-            break;
+            return true;
+        });
+
+    for (const auto& path : paths) {
+        FileUtil::IOFile file(path, "rb");
+        u32 version{};
+        if (!file.IsOpen() || file.ReadBytes(&version, sizeof(version)) != sizeof(version)) {
+            LOG_ERROR(Render_OpenGL, "Failed to read imported shader cache {}", path);
+            continue;
         }
-        default:
-            LOG_ERROR(Render_OpenGL, "Unknown transferable shader cache entry kind={} - skipping",
-                      kind);
-            return std::nullopt;
+
+        // The identifiers are only marked as known once the entries are saved
+        std::unordered_set<u64> known = transferable;
+        std::vector<ShaderDiskCacheRaw> imported;
+        bool read = false;
+        if (version == UncompressedVersion) {
+            read = ReadUncompressedEntries(file, known, imported);
+        } else if (version == NativeVersion) {
+            read = ReadNativeEntries(file, known, imported);
+        } else {
+            LOG_WARNING(Render_OpenGL, "Imported shader cache {} has version {} - skipping", path,
+                        version);
+        }
+        file.Close();
+        if (!read) {
+            continue;
         }
-    }
 
-    LOG_INFO(Render_OpenGL, "Found a transferable disk cache with {} entries", raws.size());
-    return {std::move(raws)};
+        FileUtil::IOFile own_file = AppendTransferableFile();
+        std::size_t num_saved = 0;
+        for (auto& raw : imported) {
+            if (!own_file.IsOpen() || !WriteTransferableEntry(own_file, raw)) {
+                break;
+            }
+            transferable.insert(raw.GetUniqueIdentifier());
+            raws.push_back(std::move(raw));
+            ++num_saved;
+        }
+        if (num_saved != imported.size()) {
+            LOG_ERROR(Render_OpenGL, "Failed to merge imported shader cache {}", path);
+            return;
+        }
+
+        LOG_INFO(Render_OpenGL, "Merged {} new entries of imported shader cache {}", num_saved,
+                 path);
+        if (!FileUtil::Delete(path)) {
+            LOG_ERROR(Render_OpenGL, "Failed to remove imported shader cache {}", path);
+        }
+    }
 }
 
 std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>, ShaderDumpsMap>
@@ -214,6 +463,7 @@ ShaderDiskCache::LoadPrecompiledFile(FileUtil::IOFile& file) {
 
     std::unordered_map<u64, ShaderDiskCacheDecompiled> decompiled;
     ShaderDumpsMap dumps;
+    bool driver_changed = false;
     while (decompressed_precompiled_cache_offset < decompressed_precompiled_cache.size()) {
         PrecompiledEntryKind kind{};
         if (!LoadObjectFromPrecompiled(kind)) {
@@ -258,11 +508,30 @@ ShaderDiskCache::LoadPrecompiledFile(FileUtil::IOFile& file) {
             dumps.insert({unique_identifier, dump});
             break;
         }
+        case PrecompiledEntryKind::Driver: {
+            u64 hash{};
+            if (!LoadObjectFromPrecompiled(hash)) {
+                return std::nullopt;
+            }
+            driver_changed = hash != driver_hash;
+            break;
+        }
         default:
             return std::nullopt;
         }
     }
 
+    if (driver_changed) {
+        // The decompiled shaders don't depend on the driver, so only the dumps are rebuilt, from
+        // the decompiled shaders, while the game runs
+        LOG_INFO(Render_OpenGL,
+                 "Precompiled cache was built by another driver - rebuilding {} programs",
+                 dumps.size());
+        dumps.clear();
+        file.Close();
+        InvalidatePrecompiled();
+    }
+
     LOG_INFO(Render_OpenGL,
              "Found a precompiled disk cache with {} decompiled entries and {} binary entries",
              decompiled.size(), dumps.size());
@@ -336,13 +605,13 @@ void ShaderDiskCache::SaveRaw(const ShaderDiskCacheRaw& entry) {
     FileUtil::IOFile file = AppendTransferableFile();
     if (!file.IsOpen())
         return;
-    if (file.WriteObject(TransferableEntryKind::Raw) != 1 || !entry.Save(file)) {
+    if (!WriteTransferableEntry(file, entry)) {
         LOG_ERROR(Render_OpenGL, "Failed to save raw transferable cache entry - removing");
         file.Close();
         InvalidateAll();
         return;
     }
-    transferable.insert({id, entry});
+    transferable.insert(id);
 }
 
 void ShaderDiskCache::SaveDecompiled(u64 unique_identifier,
@@ -420,7 +689,9 @@ FileUtil::IOFile ShaderDiskCache::AppendTransferableFile() {
 
 void ShaderDiskCache::SavePrecompiledHeaderToVirtualPrecompiledCache() {
     const auto hash{GetShaderCacheVersionHash()};
-    if (!SaveArrayToPrecompiled(hash.data(), hash.size())) {
+    if (!SaveArrayToPrecompiled(hash.data(), hash.size()) ||
+        !SaveObjectToPrecompiled(static_cast<u32>(PrecompiledEntryKind::Driver)) ||
+        !SaveObjectToPrecompiled(driver_hash)) {
         LOG_ERROR(
             Render_OpenGL,
             "Failed to write precompiled cache version hash to virtual precompiled cache file");
@@ -454,6 +725,65 @@ void ShaderDiskCache::SaveVirtualPrecompiledFile() {
     }
 }
 
+ShaderUsageCounts ShaderDiskCache::LoadUsageCounts() {
+    if (!IsUsable())
+        return {};
+
+    FileUtil::IOFile file(GetUsagePath(), "rb");
+    if (!file.IsOpen()) {
+        return {};
+    }
+
+    u32 version{};
+    if (file.ReadBytes(&version, sizeof(version)) != sizeof(version) || version != UsageVersion) {
+        LOG_INFO(Render_OpenGL, "Ignoring shader usage counts of another version");
+        return {};
+    }
+
+    ShaderUsageCounts counts;
+    while (file.Tell() < file.GetSize()) {
+        u64 unique_identifier{};
+        u32 count{};
+        if (file.ReadBytes(&unique_identifier, sizeof(u64)) != sizeof(u64) ||
+            file.ReadBytes(&count, sizeof(u32)) != sizeof(u32)) {
+            LOG_ERROR(Render_OpenGL, "Failed to read shader usage counts - skipping");
+            return {};
+        }
+        counts.insert_or_assign(unique_identifier, count);
+    }
+    return counts;
+}
+
+void ShaderDiskCache::SaveUsageCounts(const ShaderUsageCounts& counts) {
+    if (!IsUsable() || !EnsureDirectories())
+        return;
+
+    const auto usage_path{GetUsagePath()};
+
+#ifdef HAVE_LIBRETRO_VFS
+    if (!FileUtil::Exists(usage_path)) {
+        FileUtil::CreateEmptyFile(usage_path);
+    }
+#endif
+
+    FileUtil::IOFile file(usage_path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_OpenGL, "Failed to open shader usage counts in path={}", usage_path);
+        return;
+    }
+    if (file.WriteObject(UsageVersion) != 1) {
+        LOG_ERROR(Render_OpenGL, "Failed to write shader usage counts in path={}", usage_path);
+        return;
+    }
+    for (const auto& [unique_identifier, count] : counts) {
+        if (file.WriteObject(unique_identifier) != 1 || file.WriteObject(count) != 1) {
+            LOG_ERROR(Render_OpenGL, "Failed to write shader usage counts in path={}",
+                      usage_path);
+            return;
+        }
+    }
+}
+
 bool ShaderDiskCache::EnsureDirectories() const {
     const auto CreateDir = [](const std::string& dir) {
         if (!FileUtil::CreateDir(dir)) {
@@ -476,6 +806,10 @@ std::string ShaderDiskCache::GetPrecompiledPath() {
     return FileUtil::SanitizePath(GetPrecompiledDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
 }
 
+std::string ShaderDiskCache::GetUsagePath() {
+    return FileUtil::SanitizePath(GetTransferableDir() + DIR_SEP_CHR + GetTitleID() + ".usage");
+}
+
 std::string ShaderDiskCache::GetTransferableDir() const {
     return GetBaseDir() + DIR_SEP "transferable";
 }
@@ -484,6 +818,10 @@ std::string ShaderDiskCache::GetPrecompiledDir() const {
     return GetBaseDir() + DIR_SEP "precompiled";
 }
 
+std::string ShaderDiskCache::GetImportDir() const {
+    return GetBaseDir() + DIR_SEP "import";
+}
+
 std::string ShaderDiskCache::GetBaseDir() const {
     return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "opengl";
 }
@@ -40,6 +40,7 @@ using RawShaderConfig = Pica::Regs;
 using ProgramCode = std::vector<u32>;
 using ShaderDecompiledMap = std::unordered_map<u64, ShaderDiskCacheDecompiled>;
 using ShaderDumpsMap = std::unordered_map<u64, ShaderDiskCacheDump>;
+using ShaderUsageCounts = std::unordered_map<u64, u32>;
 
 /// Describes a shader how it's used by the guest GPU
 class ShaderDiskCacheRaw {
@@ -49,9 +50,13 @@ public:
     ShaderDiskCacheRaw() = default;
     ~ShaderDiskCacheRaw() = default;
 
+    /// Reads an entry of the uncompressed transferable file format
     bool Load(FileUtil::IOFile& file);
 
-    bool Save(FileUtil::IOFile& file) const;
+    /// Reads an entry serialized by Serialize, failing unless it spans exactly size bytes
+    bool Load(const u8* data, std::size_t size);
+
+    std::vector<u8> Serialize() const;
 
     u64 GetUniqueIdentifier() const {
         return unique_identifier;
@@ -90,13 +95,23 @@ struct ShaderDiskCacheDump {
 
 class ShaderDiskCache {
 public:
+    /// Must be constructed on a thread with a GL context, to identify the driver
     explicit ShaderDiskCache(bool separable);
     ~ShaderDiskCache() = default;
 
-    /// Loads transferable cache. If file has a old version or on failure, it deletes the file.
+    /**
+     * Loads transferable cache. If file has a old version or on failure, it deletes the file.
+     * Transferable caches of the game found in the import directory (shaders/opengl/import),
+     * e.g. copied from another machine, are merged into it first. Entries are deduplicated by
+     * their unique identifier, and merged files are removed.
+     */
     std::optional<std::vector<ShaderDiskCacheRaw>> LoadTransferable();
 
-    /// Loads current game's precompiled cache. Invalidates on failure.
+    /**
+     * Loads current game's precompiled cache. Invalidates on failure. If the cache was built by
+     * another driver, only the decompiled entries are returned, and the precompiled file is
+     * invalidated so that it is rebuilt from them.
+     */
     std::pair<ShaderDecompiledMap, ShaderDumpsMap> LoadPrecompiled();
 
     /// Removes the transferable (and precompiled) cache file.
@@ -118,7 +133,25 @@ public:
     /// Serializes virtual precompiled shader cache file to real file
     void SaveVirtualPrecompiledFile();
 
+    /// Loads how many times each entry was used in the last session. Returns empty on failure.
+    ShaderUsageCounts LoadUsageCounts();
+
+    /// Replaces the usage counts of the current game with the ones of this session
+    void SaveUsageCounts(const ShaderUsageCounts& counts);
+
 private:
+    /// Loads the entries of the transferable file of the current game
+    std::optional<std::vector<ShaderDiskCacheRaw>> LoadTransferableFile(FileUtil::IOFile& file);
+
+    /// Merges the imported transferable files of the current game and appends their new entries
+    void ImportTransferable(std::vector<ShaderDiskCacheRaw>& raws);
+
+    /**
+     * Loads the entries of a transferable file written before they were compressed and rewrites
+     * it in the current format
+     */
+    std::optional<std::vector<ShaderDiskCacheRaw>> MigrateTransferableFile(FileUtil::IOFile& file);
+
     /// Loads the transferable cache. Returns empty on failure.
     std::optional<std::pair<ShaderDecompiledMap, ShaderDumpsMap>> LoadPrecompiledFile(
         FileUtil::IOFile& file);
@@ -149,12 +182,18 @@ private:
     /// Gets current game's precompiled file path
     std::string GetPrecompiledPath();
 
+    /// Gets current game's usage counts file path
+    std::string GetUsagePath();
+
     /// Get user's transferable directory path
     std::string GetTransferableDir() const;
 
     /// Get user's precompiled directory path
     std::string GetPrecompiledDir() const;
 
+    /// Get user's directory path of transferable files to merge
+    std::string GetImportDir() const;
+
     /// Get user's shader directory path
     std::string GetBaseDir() const;
 
@@ -203,14 +242,17 @@ private:
     // Stores the current offset of the precompiled cache file for IO purposes
     std::size_t decompressed_precompiled_cache_offset = 0;
 
-    // Stored transferable shaders
-    std::unordered_map<u64, ShaderDiskCacheRaw> transferable;
+    // Unique identifiers of the stored transferable shaders
+    std::unordered_set<u64> transferable;
 
     // The cache has been loaded at boot
     bool tried_to_load{};
 
     bool separable{};
 
+    /// Hash of the GL vendor, renderer and version strings
+    u64 driver_hash{};
+
     u64 program_id{};
     std::string title_id;
 };
@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <string_view>
 #include <fmt/format.h>
 #include "common/assert.h"
@@ -24,6 +26,7 @@
 
 using Pica::FramebufferRegs;
 using Pica::LightingRegs;
+using Pica::PipelineRegs;
 using Pica::RasterizerRegs;
 using Pica::TexturingRegs;
 using TevStageConfig = TexturingRegs::TevStageConfig;
@@ -31,6 +34,16 @@ using VSOutputAttributes = RasterizerRegs::VSOutputAttributes;
 
 namespace OpenGL {
 
+/// Appends formatted text to a shader source without building a temporary string
+template <typename... Args>
+static void AppendFormat(std::string& out, Args&&... args) {
+    fmt::format_to(std::back_inserter(out), std::forward<Args>(args)...);
+}
+
+/// Largest sources generated on this thread so far, which the following ones preallocate
+static thread_local std::size_t fragment_shader_capacity = 32 * 1024;
+static thread_local std::size_t vertex_shader_capacity = 16 * 1024;
+
 constexpr std::string_view UniformBlockDef = R"(
 #define NUM_TEV_STAGES 6
 #define NUM_LIGHTS 8
@@ -84,9 +97,9 @@ static std::string GetVertexInterfaceDeclaration(bool is_output, bool separable_
 
     const auto append_variable = [&](std::string_view var, int location) {
         if (separable_shader) {
-            out += fmt::format("layout (location={}) ", location);
+            AppendFormat(out, "layout (location={}) ", location);
         }
-        out += fmt::format("{}{};\n", is_output ? "out " : "in ", var);
+        AppendFormat(out, "{}{};\n", is_output ? "out " : "in ", var);
     };
 
     append_variable("vec4 primary_color", ATTRIBUTE_COLOR);
@@ -297,6 +310,63 @@ void PicaGSConfigCommonRaw::Init(const Pica::Regs& regs) {
     }
 }
 
+u32 GetGSVerticesPerPrimitive(const Pica::Regs& regs) {
+    const u32 attributes_per_vertex = regs.pipeline.vs_outmap_total_minus_1_a + 1;
+    u32 num_vertices = 0;
+    switch (regs.pipeline.gs_config.mode) {
+    case PipelineRegs::GSMode::Point: {
+        // Consecutive vertices are packed into the input registers of one invocation
+        const u32 num_inputs = regs.gs.max_input_attribute_index + 1;
+        if (regs.gs.input_to_uniform != 0 || num_inputs % attributes_per_vertex != 0) {
+            return 0;
+        }
+        num_vertices = num_inputs / attributes_per_vertex;
+        break;
+    }
+    case PipelineRegs::GSMode::FixedPrimitive:
+        if (regs.gs.input_to_uniform == 0 ||
+            regs.pipeline.gs_config.stride_minus_1 + 1 != attributes_per_vertex) {
+            return 0;
+        }
+        num_vertices = regs.pipeline.gs_config.fixed_vertex_num_minus_1 + 1;
+        break;
+    default:
+        // The vertex count of each variable primitive is read from the index stream, which GL
+        // input primitives can't express
+        return 0;
+    }
+
+    // Only these counts have a GL input primitive
+    switch (num_vertices) {
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+    case 6:
+        return num_vertices;
+    default:
+        return 0;
+    }
+}
+
+void PicaGSConfigRaw::Init(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
+    PicaShaderConfigCommon::Init(regs.gs, setup);
+    PicaGSConfigCommonRaw::Init(regs);
+
+    attributes_per_vertex = regs.pipeline.vs_outmap_total_minus_1_a + 1;
+    vertices_per_primitive = GetGSVerticesPerPrimitive(regs);
+    inputs_in_uniforms = regs.pipeline.gs_config.mode == PipelineRegs::GSMode::FixedPrimitive;
+    uniform_start_index = inputs_in_uniforms ? regs.pipeline.gs_config.start_index.Value() : 0;
+
+    num_inputs = inputs_in_uniforms ? 0 : regs.gs.max_input_attribute_index + 1;
+    input_map.fill(16);
+    for (u32 attr = 0; attr < num_inputs; ++attr) {
+        input_map[regs.gs.GetRegisterForAttribute(attr)] = attr;
+    }
+
+    gs_output_attributes = num_outputs;
+}
+
 /// Detects if a TEV stage is configured to be skipped (to avoid generating unnecessary code)
 static bool IsPassThroughTevStage(const TevStageConfig& stage) {
     return (stage.color_op == TevStageConfig::Operation::Replace &&
@@ -510,28 +580,28 @@ static void AppendColorCombiner(std::string& out, TevStageConfig::Operation oper
     using Operation = TevStageConfig::Operation;
     switch (operation) {
     case Operation::Replace:
-        out += fmt::format("{}[0]", variable_name);
+        AppendFormat(out, "{}[0]", variable_name);
         break;
     case Operation::Modulate:
-        out += fmt::format("{0}[0] * {0}[1]", variable_name);
+        AppendFormat(out, "{0}[0] * {0}[1]", variable_name);
         break;
     case Operation::Add:
-        out += fmt::format("{0}[0] + {0}[1]", variable_name);
+        AppendFormat(out, "{0}[0] + {0}[1]", variable_name);
         break;
     case Operation::AddSigned:
-        out += fmt::format("{0}[0] + {0}[1] - vec3(0.5)", variable_name);
+        AppendFormat(out, "{0}[0] + {0}[1] - vec3(0.5)", variable_name);
         break;
     case Operation::Lerp:
-        out += fmt::format("{0}[0] * {0}[2] + {0}[1] * (vec3(1.0) - {0}[2])", variable_name);
+        AppendFormat(out, "{0}[0] * {0}[2] + {0}[1] * (vec3(1.0) - {0}[2])", variable_name);
         break;
     case Operation::Subtract:
-        out += fmt::format("{0}[0] - {0}[1]", variable_name);
+        AppendFormat(out, "{0}[0] - {0}[1]", variable_name);
         break;
     case Operation::MultiplyThenAdd:
-        out += fmt::format("{0}[0] * {0}[1] + {0}[2]", variable_name);
+        AppendFormat(out, "{0}[0] * {0}[1] + {0}[2]", variable_name);
         break;
     case Operation::AddThenMultiply:
-        out += fmt::format("min({0}[0] + {0}[1], vec3(1.0)) * {0}[2]", variable_name);
+        AppendFormat(out, "min({0}[0] + {0}[1], vec3(1.0)) * {0}[2]", variable_name);
         break;
     case Operation::Dot3_RGB:
     case Operation::Dot3_RGBA:
@@ -553,28 +623,28 @@ static void AppendAlphaCombiner(std::string& out, TevStageConfig::Operation oper
     using Operation = TevStageConfig::Operation;
     switch (operation) {
     case Operation::Replace:
-        out += fmt::format("{}[0]", variable_name);
+        AppendFormat(out, "{}[0]", variable_name);
         break;
     case Operation::Modulate:
-        out += fmt::format("{0}[0] * {0}[1]", variable_name);
+        AppendFormat(out, "{0}[0] * {0}[1]", variable_name);
         break;
     case Operation::Add:
-        out += fmt::format("{0}[0] + {0}[1]", variable_name);
+        AppendFormat(out, "{0}[0] + {0}[1]", variable_name);
         break;
     case Operation::AddSigned:
-        out += fmt::format("{0}[0] + {0}[1] - 0.5", variable_name);
+        AppendFormat(out, "{0}[0] + {0}[1] - 0.5", variable_name);
         break;
     case Operation::Lerp:
-        out += fmt::format("{0}[0] * {0}[2] + {0}[1] * (1.0 - {0}[2])", variable_name);
+        AppendFormat(out, "{0}[0] * {0}[2] + {0}[1] * (1.0 - {0}[2])", variable_name);
         break;
     case Operation::Subtract:
-        out += fmt::format("{0}[0] - {0}[1]", variable_name);
+        AppendFormat(out, "{0}[0] - {0}[1]", variable_name);
         break;
     case Operation::MultiplyThenAdd:
-        out += fmt::format("{0}[0] * {0}[1] + {0}[2]", variable_name);
+        AppendFormat(out, "{0}[0] * {0}[1] + {0}[2]", variable_name);
         break;
     case Operation::AddThenMultiply:
-        out += fmt::format("min({0}[0] + {0}[1], 1.0) * {0}[2]", variable_name);
+        AppendFormat(out, "min({0}[0] + {0}[1], 1.0) * {0}[2]", variable_name);
         break;
     default:
         out += "0.0";
@@ -602,7 +672,7 @@ static void AppendAlphaTestCondition(std::string& out, FramebufferRegs::CompareF
     case CompareFunc::GreaterThanOrEqual: {
         static constexpr std::array op{"!=", "==", ">=", ">", "<=", "<"};
         const auto index = static_cast<u32>(func) - static_cast<u32>(CompareFunc::Equal);
-        out += fmt::format("int(last_tex_env_out.a * 255.0) {} alphatest_ref", op[index]);
+        AppendFormat(out, "int(last_tex_env_out.a * 255.0) {} alphatest_ref", op[index]);
         break;
     }
 
@@ -620,26 +690,26 @@ static void WriteTevStage(std::string& out, const PicaFSConfig& config, unsigned
     if (!IsPassThroughTevStage(stage)) {
         const std::string index_name = std::to_string(index);
 
-        out += fmt::format("vec3 color_results_{}_1 = ", index_name);
+        AppendFormat(out, "vec3 color_results_{}_1 = ", index_name);
         AppendColorModifier(out, config, stage.color_modifier1, stage.color_source1, index_name);
-        out += fmt::format(";\nvec3 color_results_{}_2 = ", index_name);
+        AppendFormat(out, ";\nvec3 color_results_{}_2 = ", index_name);
         AppendColorModifier(out, config, stage.color_modifier2, stage.color_source2, index_name);
-        out += fmt::format(";\nvec3 color_results_{}_3 = ", index_name);
+        AppendFormat(out, ";\nvec3 color_results_{}_3 = ", index_name);
         AppendColorModifier(out, config, stage.color_modifier3, stage.color_source3, index_name);
-        out += fmt::format(";\nvec3 color_results_{}[3] = vec3[3](color_results_{}_1, "
-                           "color_results_{}_2, color_results_{}_3);\n",
-                           index_name, index_name, index_name, index_name);
+        AppendFormat(out, ";\nvec3 color_results_{}[3] = vec3[3](color_results_{}_1, "
+                     "color_results_{}_2, color_results_{}_3);\n",
+                     index_name, index_name, index_name, index_name);
 
         // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
-        out += fmt::format("vec3 color_output_{} = byteround(", index_name);
+        AppendFormat(out, "vec3 color_output_{} = byteround(", index_name);
         AppendColorCombiner(out, stage.color_op, "color_results_" + index_name);
         out += ");\n";
 
         if (stage.color_op == TevStageConfig::Operation::Dot3_RGBA) {
             // result of Dot3_RGBA operation is also placed to the alpha component
-            out += fmt::format("float alpha_output_{0} = color_output_{0}[0];\n", index_name);
+            AppendFormat(out, "float alpha_output_{0} = color_output_{0}[0];\n", index_name);
         } else {
-            out += fmt::format("float alpha_results_{}[3] = float[3](", index_name);
+            AppendFormat(out, "float alpha_results_{}[3] = float[3](", index_name);
             AppendAlphaModifier(out, config, stage.alpha_modifier1, stage.alpha_source1,
                                 index_name);
             out += ", ";
@@ -650,16 +720,16 @@ static void WriteTevStage(std::string& out, const PicaFSConfig& config, unsigned
                                 index_name);
             out += ");\n";
 
-            out += fmt::format("float alpha_output_{} = byteround(", index_name);
+            AppendFormat(out, "float alpha_output_{} = byteround(", index_name);
             AppendAlphaCombiner(out, stage.alpha_op, "alpha_results_" + index_name);
             out += ");\n";
         }
 
-        out += fmt::format("last_tex_env_out = vec4("
-                           "clamp(color_output_{} * {}.0, vec3(0.0), vec3(1.0)), "
-                           "clamp(alpha_output_{} * {}.0, 0.0, 1.0));\n",
-                           index_name, stage.GetColorMultiplier(), index_name,
-                           stage.GetAlphaMultiplier());
+        AppendFormat(out, "last_tex_env_out = vec4("
+                     "clamp(color_output_{} * {}.0, vec3(0.0), vec3(1.0)), "
+                     "clamp(alpha_output_{} * {}.0, 0.0, 1.0));\n",
+                     index_name, stage.GetColorMultiplier(), index_name,
+                     stage.GetAlphaMultiplier());
     }
 
     out += "combiner_buffer = next_combiner_buffer;\n";
@@ -692,21 +762,21 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
     };
     if (lighting.bump_mode == LightingRegs::LightingBumpMode::NormalMap) {
         // Bump mapping is enabled using a normal map
-        out += fmt::format("vec3 surface_normal = {};\n", Perturbation());
+        AppendFormat(out, "vec3 surface_normal = {};\n", Perturbation());
 
         // Recompute Z-component of perturbation if 'renorm' is enabled, this provides a higher
         // precision result
         if (lighting.bump_renorm) {
             constexpr std::string_view val =
                 "(1.0 - (surface_normal.x*surface_normal.x + surface_normal.y*surface_normal.y))";
-            out += fmt::format("surface_normal.z = sqrt(max({}, 0.0));\n", val);
+            AppendFormat(out, "surface_normal.z = sqrt(max({}, 0.0));\n", val);
         }
 
         // The tangent vector is not perturbed by the normal map and is just a unit vector.
         out += "vec3 surface_tangent = vec3(1.0, 0.0, 0.0);\n";
     } else if (lighting.bump_mode == LightingRegs::LightingBumpMode::TangentMap) {
         // Bump mapping is enabled using a tangent map
-        out += fmt::format("vec3 surface_tangent = {};\n", Perturbation());
+        AppendFormat(out, "vec3 surface_tangent = {};\n", Perturbation());
         // Mathematically, recomputing Z-component of the tangent vector won't affect the relevant
         // computation below, which is also confirmed on 3DS. So we don't bother recomputing here
         // even if 'renorm' is enabled.
@@ -728,9 +798,9 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
     if (lighting.enable_shadow) {
         std::string shadow_texture = SampleTexture(config, lighting.shadow_selector);
         if (lighting.shadow_invert) {
-            out += fmt::format("vec4 shadow = vec4(1.0) - {};\n", shadow_texture);
+            AppendFormat(out, "vec4 shadow = vec4(1.0) - {};\n", shadow_texture);
         } else {
-            out += fmt::format("vec4 shadow = {};\n", shadow_texture);
+            AppendFormat(out, "vec4 shadow = {};\n", shadow_texture);
         }
     } else {
         out += "vec4 shadow = vec4(1.0);\n";
@@ -805,12 +875,12 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
 
         // Compute light vector (directional or positional)
         if (light_config.directional) {
-            out += fmt::format("light_vector = normalize({}.position);\n", light_src);
+            AppendFormat(out, "light_vector = normalize({}.position);\n", light_src);
         } else {
-            out += fmt::format("light_vector = normalize({}.position + view);\n", light_src);
+            AppendFormat(out, "light_vector = normalize({}.position + view);\n", light_src);
         }
 
-        out += fmt::format("spot_dir = {}.spot_direction;\n", light_src);
+        AppendFormat(out, "spot_dir = {}.spot_direction;\n", light_src);
         out += "half_vector = normalize(view) + light_vector;\n";
 
         // Compute dot product of light_vector and normal, adjust if lighting is one-sided or
@@ -875,7 +945,7 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
                 GetLutValue(LightingRegs::LightingSampler::ReflectRed, light_config.num,
                             lighting.lut_rr.type, lighting.lut_rr.abs_input);
             value = fmt::format("({:#} * {})", lighting.lut_rr.scale, value);
-            out += fmt::format("refl_value.r = {};\n", value);
+            AppendFormat(out, "refl_value.r = {};\n", value);
         } else {
             out += "refl_value.r = 1.0;\n";
         }
@@ -888,7 +958,7 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
                 GetLutValue(LightingRegs::LightingSampler::ReflectGreen, light_config.num,
                             lighting.lut_rg.type, lighting.lut_rg.abs_input);
             value = fmt::format("({:#} * {})", lighting.lut_rg.scale, value);
-            out += fmt::format("refl_value.g = {};\n", value);
+            AppendFormat(out, "refl_value.g = {};\n", value);
         } else {
             out += "refl_value.g = refl_value.r;\n";
         }
@@ -901,7 +971,7 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
                 GetLutValue(LightingRegs::LightingSampler::ReflectBlue, light_config.num,
                             lighting.lut_rb.type, lighting.lut_rb.abs_input);
             value = fmt::format("({:#} * {})", lighting.lut_rb.scale, value);
-            out += fmt::format("refl_value.b = {};\n", value);
+            AppendFormat(out, "refl_value.b = {};\n", value);
         } else {
             out += "refl_value.b = refl_value.r;\n";
         }
@@ -936,12 +1006,12 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
 
             // Enabled for diffuse lighting alpha component
             if (lighting.enable_primary_alpha) {
-                out += fmt::format("diffuse_sum.a = {};\n", value);
+                AppendFormat(out, "diffuse_sum.a = {};\n", value);
             }
 
             // Enabled for the specular lighting alpha component
             if (lighting.enable_secondary_alpha) {
-                out += fmt::format("specular_sum.a = {};\n", value);
+                AppendFormat(out, "specular_sum.a = {};\n", value);
             }
         }
 
@@ -951,13 +1021,13 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
         std::string shadow_secondary = shadow_secondary_enable ? " * shadow.rgb" : "";
 
         // Compute primary fragment color (diffuse lighting) function
-        out += fmt::format(
-            "diffuse_sum.rgb += (({}.diffuse * dot_product) + {}.ambient) * {} * {}{};\n",
+        AppendFormat(
+            out, "diffuse_sum.rgb += (({}.diffuse * dot_product) + {}.ambient) * {} * {}{};\n",
             light_src, light_src, dist_atten, spot_atten, shadow_primary);
 
         // Compute secondary fragment color (specular lighting) function
-        out += fmt::format("specular_sum.rgb += ({} + {}) * clamp_highlights * {} * {}{};\n",
-                           specular_0, specular_1, dist_atten, spot_atten, shadow_secondary);
+        AppendFormat(out, "specular_sum.rgb += ({} + {}) * clamp_highlights * {} * {}{};\n",
+                     specular_0, specular_1, dist_atten, spot_atten, shadow_secondary);
     }
 
     // Apply shadow attenuation to alpha components if enabled
@@ -989,10 +1059,10 @@ static void AppendProcTexShiftOffset(std::string& out, std::string_view v, ProcT
         out += "0.0";
         break;
     case ProcTexShift::Odd:
-        out += fmt::format("{} * float((int({}) / 2) % 2)", offset, v);
+        AppendFormat(out, "{} * float((int({}) / 2) % 2)", offset, v);
         break;
     case ProcTexShift::Even:
-        out += fmt::format("{} * float(((int({}) + 1) / 2) % 2)", offset, v);
+        AppendFormat(out, "{} * float(((int({}) + 1) / 2) % 2)", offset, v);
         break;
     default:
         LOG_CRITICAL(HW_GPU, "Unknown shift mode {}", mode);
@@ -1004,24 +1074,24 @@ static void AppendProcTexShiftOffset(std::string& out, std::string_view v, ProcT
 static void AppendProcTexClamp(std::string& out, std::string_view var, ProcTexClamp mode) {
     switch (mode) {
     case ProcTexClamp::ToZero:
-        out += fmt::format("{0} = {0} > 1.0 ? 0 : {0};\n", var);
+        AppendFormat(out, "{0} = {0} > 1.0 ? 0 : {0};\n", var);
         break;
     case ProcTexClamp::ToEdge:
-        out += fmt::format("{0} = min({0}, 1.0);\n", var);
+        AppendFormat(out, "{0} = min({0}, 1.0);\n", var);
         break;
     case ProcTexClamp::SymmetricalRepeat:
-        out += fmt::format("{0} = fract({0});\n", var);
+        AppendFormat(out, "{0} = fract({0});\n", var);
         break;
     case ProcTexClamp::MirroredRepeat: {
-        out += fmt::format("{0} = int({0}) % 2 == 0 ? fract({0}) : 1.0 - fract({0});\n", var);
+        AppendFormat(out, "{0} = int({0}) % 2 == 0 ? fract({0}) : 1.0 - fract({0});\n", var);
         break;
     }
     case ProcTexClamp::Pulse:
-        out += fmt::format("{0} = {0} > 0.5 ? 1.0 : 0.0;\n", var);
+        AppendFormat(out, "{0} = {0} > 0.5 ? 1.0 : 0.0;\n", var);
         break;
     default:
         LOG_CRITICAL(HW_GPU, "Unknown clamp mode {}", mode);
-        out += fmt::format("{0} = min({0}, 1.0);\n", var);
+        AppendFormat(out, "{0} = min({0}, 1.0);\n", var);
         break;
     }
 }
@@ -1056,7 +1126,7 @@ static void AppendProcTexCombineAndMap(std::string& out, ProcTexCombiner combine
         }
     }();
 
-    out += fmt::format("ProcTexLookupLUT({}, {})", offset, combined);
+    AppendFormat(out, "ProcTexLookupLUT({}, {})", offset, combined);
 }
 
 static void AppendProcTexSampler(std::string& out, const PicaFSConfig& config) {
@@ -1116,11 +1186,11 @@ float ProcTexNoiseCoef(vec2 x) {
     }
 
     out += "vec4 SampleProcTexColor(float lut_coord, int level) {\n";
-    out += fmt::format("int lut_width = {} >> level;\n", config.state.proctex.lut_width);
+    AppendFormat(out, "int lut_width = {} >> level;\n", config.state.proctex.lut_width);
     // Offsets for level 4-7 seem to be hardcoded
-    out += fmt::format("int lut_offsets[8] = int[]({}, {}, {}, {}, 0xF0, 0xF8, 0xFC, 0xFE);\n",
-                       config.state.proctex.lut_offset0, config.state.proctex.lut_offset1,
-                       config.state.proctex.lut_offset2, config.state.proctex.lut_offset3);
+    AppendFormat(out, "int lut_offsets[8] = int[]({}, {}, {}, {}, 0xF0, 0xF8, 0xFC, 0xFE);\n",
+                 config.state.proctex.lut_offset0, config.state.proctex.lut_offset1,
+                 config.state.proctex.lut_offset2, config.state.proctex.lut_offset3);
     out += "int lut_offset = lut_offsets[level];\n";
     // For the color lut, coord=0.0 is lut[offset] and coord=1.0 is lut[offset+width-1]
     out += "lut_coord *= float(lut_width - 1);\n";
@@ -1149,7 +1219,7 @@ float ProcTexNoiseCoef(vec2 x) {
 
     out += "vec4 ProcTex() {\n";
     if (config.state.proctex.coord < 3) {
-        out += fmt::format("vec2 uv = abs(texcoord{});\n", config.state.proctex.coord);
+        AppendFormat(out, "vec2 uv = abs(texcoord{});\n", config.state.proctex.coord);
     } else {
         LOG_CRITICAL(Render_OpenGL, "Unexpected proctex.coord >= 3");
         out += "vec2 uv = abs(texcoord0);\n";
@@ -1161,12 +1231,12 @@ float ProcTexNoiseCoef(vec2 x) {
     // Note: this is different from the one normal 2D textures use.
     out += "vec2 duv = max(abs(dFdx(uv)), abs(dFdy(uv)));\n";
     // unlike normal texture, the bias is inside the log2
-    out += fmt::format("float lod = log2(abs(float({}) * proctex_bias) * (duv.x + duv.y));\n",
-                       config.state.proctex.lut_width);
+    AppendFormat(out, "float lod = log2(abs(float({}) * proctex_bias) * (duv.x + duv.y));\n",
+                 config.state.proctex.lut_width);
     out += "if (proctex_bias == 0.0) lod = 0.0;\n";
-    out += fmt::format("lod = clamp(lod, {:#}, {:#});\n",
-                       std::max(0.0f, static_cast<float>(config.state.proctex.lod_min)),
-                       std::min(7.0f, static_cast<float>(config.state.proctex.lod_max)));
+    AppendFormat(out, "lod = clamp(lod, {:#}, {:#});\n",
+                 std::max(0.0f, static_cast<float>(config.state.proctex.lod_min)),
+                 std::min(7.0f, static_cast<float>(config.state.proctex.lod_max)));
     // Get shift offset before noise generation
     out += "float u_shift = ";
     AppendProcTexShiftOffset(out, "uv.y", config.state.proctex.u_shift,
@@ -1228,9 +1298,31 @@ float ProcTexNoiseCoef(vec2 x) {
     }
 }
 
-ShaderDecompiler::ProgramResult GenerateFragmentShader(const PicaFSConfig& config,
-                                                       bool separable_shader) {
-    const auto& state = config.state;
+/// Returns true if the logic operation combines the fragment color with the framebuffer color
+static bool LogicOpReadsFramebuffer(FramebufferRegs::LogicOp logic_op) {
+    switch (logic_op) {
+    case FramebufferRegs::LogicOp::Clear:
+    case FramebufferRegs::LogicOp::Set:
+    case FramebufferRegs::LogicOp::Copy:
+    case FramebufferRegs::LogicOp::CopyInverted:
+    case FramebufferRegs::LogicOp::NoOp:
+        return false;
+    default:
+        return true;
+    }
+}
+
+/// Returns true if the shader of the config reads the color attachment with framebuffer fetch
+static bool UsesFramebufferFetch(const PicaFSConfigState& state) {
+    if (!GLES || framebuffer_fetch == FramebufferFetch::None) {
+        return false;
+    }
+    return state.shadow_rendering ||
+           (!state.alphablend_enable && LogicOpReadsFramebuffer(state.logic_op));
+}
+
+/// Writes the declarations and helper functions shared by all generated fragment shaders
+static std::string GetFragmentShaderCommon(bool separable_shader, bool fetch_color = false) {
     std::string out;
 
     if (GLES) {
@@ -1249,6 +1341,14 @@ ShaderDecompiler::ProgramResult GenerateFragmentShader(const PicaFSConfig& confi
         out += "#extension GL_ARB_separate_shader_objects : enable\n";
     }
 
+    // Declaring the color as inout may cost even when it is not read, so only the shaders that
+    // read it do
+    if (fetch_color && framebuffer_fetch == FramebufferFetch::EXT) {
+        out += "#extension GL_EXT_shader_framebuffer_fetch : require\n";
+    } else if (fetch_color && framebuffer_fetch == FramebufferFetch::ARM) {
+        out += "#extension GL_ARM_shader_framebuffer_fetch : require\n";
+    }
+
     if (GLES) {
         out += fragment_shader_precision_OES;
     }
@@ -1259,8 +1359,17 @@ ShaderDecompiler::ProgramResult GenerateFragmentShader(const PicaFSConfig& confi
 #ifndef CITRA_GLES
 in vec4 gl_FragCoord;
 #endif // CITRA_GLES
+)";
 
-out vec4 color;
+    if (fetch_color && framebuffer_fetch == FramebufferFetch::EXT) {
+        out += "inout vec4 color;\n#define LAST_FRAG_COLOR color\n";
+    } else if (fetch_color && framebuffer_fetch == FramebufferFetch::ARM) {
+        out += "out vec4 color;\n#define LAST_FRAG_COLOR gl_LastFragColorARM\n";
+    } else {
+        out += "out vec4 color;\n";
+    }
+
+    out += R"(
 
 uniform sampler2D tex0;
 uniform sampler2D tex1;
@@ -1331,7 +1440,21 @@ float getLod(vec2 coord) {
     vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
     return log2(max(d.x, d.y));
 }
+)";
+
+    return out;
+}
+
+ShaderDecompiler::ProgramResult GenerateFragmentShader(const PicaFSConfig& config,
+                                                       bool separable_shader) {
+    const auto& state = config.state;
+    std::string out;
+    out.reserve(fragment_shader_capacity);
 
+    const bool fetch_color = UsesFramebufferFetch(state);
+    out += GetFragmentShaderCommon(separable_shader, fetch_color);
+
+    out += R"(
 #if ALLOW_SHADOW
 
 uvec2 DecodeShadow(uint pixel) {
@@ -1557,7 +1680,25 @@ vec4 secondary_fragment_color = vec4(0.0);
         return {std::move(out)};
     }
 
-    if (state.shadow_rendering) {
+    if (state.shadow_rendering && fetch_color) {
+        // The shadow map is the color attachment, whose RGBA8 texels unpack to the same value as
+        // the r32ui image view. Framebuffer fetch orders the fragments, so no atomics are needed.
+        out += R"(
+uint d = uint(clamp(depth, 0.0, 1.0) * float(0xFFFFFF));
+uint s = uint(last_tex_env_out.g * float(0xFF));
+
+uvec2 ref = DecodeShadow(packUnorm4x8(LAST_FRAG_COLOR));
+if (d < ref.x) {
+    if (s == 0u) {
+        ref.x = d;
+    } else {
+        s = uint(float(s) / (shadow_bias_constant + shadow_bias_linear * float(d) / float(ref.x)));
+        ref.y = min(s, ref.y);
+    }
+}
+color = unpackUnorm4x8(EncodeShadow(ref));
+)";
+    } else if (state.shadow_rendering) {
         out += R"(
 #if ALLOW_SHADOW
 uint d = uint(clamp(depth, 0.0, 1.0) * float(0xFFFFFF));
@@ -1586,11 +1727,57 @@ do {
 )";
     } else {
         out += "gl_FragDepth = depth;\n";
+        if (fetch_color) {
+            // Read before the color is written, as with the EXT extension they are the same
+            out += "uvec4 dst_bits = uvec4(round(LAST_FRAG_COLOR * 255.0));\n";
+        }
         // Round the final fragment color to maintain the PICA's 8 bits of precision
         out += "color = byteround(last_tex_env_out);\n";
     }
 
-    if (GLES) {
+    if (fetch_color && !state.shadow_rendering) {
+        std::string_view op;
+        switch (state.logic_op) {
+        case FramebufferRegs::LogicOp::And:
+            op = "src_bits & dst_bits";
+            break;
+        case FramebufferRegs::LogicOp::AndReverse:
+            op = "src_bits & ~dst_bits";
+            break;
+        case FramebufferRegs::LogicOp::Invert:
+            op = "~dst_bits";
+            break;
+        case FramebufferRegs::LogicOp::Nand:
+            op = "~(src_bits & dst_bits)";
+            break;
+        case FramebufferRegs::LogicOp::Or:
+            op = "src_bits | dst_bits";
+            break;
+        case FramebufferRegs::LogicOp::Nor:
+            op = "~(src_bits | dst_bits)";
+            break;
+        case FramebufferRegs::LogicOp::Xor:
+            op = "src_bits ^ dst_bits";
+            break;
+        case FramebufferRegs::LogicOp::Equiv:
+            op = "~(src_bits ^ dst_bits)";
+            break;
+        case FramebufferRegs::LogicOp::AndInverted:
+            op = "~src_bits & dst_bits";
+            break;
+        case FramebufferRegs::LogicOp::OrReverse:
+            op = "src_bits | ~dst_bits";
+            break;
+        case FramebufferRegs::LogicOp::OrInverted:
+            op = "~src_bits | dst_bits";
+            break;
+        default:
+            UNREACHABLE();
+        }
+        AppendFormat(out, "uvec4 src_bits = uvec4(round(color * 255.0));\n"
+                     "color = vec4(({}) & 0xFFu) / 255.0;\n",
+                     op);
+    } else if (GLES) {
         if (!state.alphablend_enable) {
             switch (state.logic_op) {
             case FramebufferRegs::LogicOp::Clear:
@@ -1618,6 +1805,575 @@ do {
 
     out += '}';
 
+    fragment_shader_capacity = std::max(fragment_shader_capacity, out.size());
+    return {std::move(out)};
+}
+
+std::optional<FSUbershaderConfig> BuildFSUbershaderConfig(const PicaFSConfig& config) {
+    const auto& state = config.state;
+    const auto& lighting = state.lighting;
+
+    using TextureType = TexturingRegs::TextureConfig::TextureType;
+    if (state.proctex.enable || state.shadow_rendering ||
+        state.texture0_type == TextureType::Shadow2D ||
+        state.texture0_type == TextureType::ShadowCube ||
+        state.fog_mode == TexturingRegs::FogMode::Gas) {
+        return std::nullopt;
+    }
+    // Logic operations other than these are emulated with per-config code on GLES
+    if (GLES && !state.alphablend_enable && state.logic_op != FramebufferRegs::LogicOp::Copy &&
+        state.logic_op != FramebufferRegs::LogicOp::NoOp) {
+        return std::nullopt;
+    }
+
+    FSUbershaderConfig uber{};
+    for (std::size_t i = 0; i < state.tev_stages.size(); ++i) {
+        const auto& stage = state.tev_stages[i];
+        uber.tev_stages[i] = {stage.sources_raw, stage.modifiers_raw, stage.ops_raw,
+                              stage.scales_raw};
+    }
+
+    // 0-2: alpha test function, 3-4: scissor mode, 5-7: texture 0 type, 8: texture 2 uses
+    // coordinate 1, 9: W buffering, 10: fog, 11: fog flip, 12-19: combiner buffer updates,
+    // 20: lighting
+    uber.fs_config =
+        static_cast<u32>(state.alpha_test_func) | static_cast<u32>(state.scissor_test_mode) << 3 |
+        static_cast<u32>(state.texture0_type) << 5 | state.texture2_use_coord1 << 8 |
+        (state.depthmap_enable == RasterizerRegs::DepthBuffering::WBuffering) << 9 |
+        (state.fog_mode == TexturingRegs::FogMode::Fog) << 10 | state.fog_flip << 11 |
+        static_cast<u32>(state.combiner_buffer_input) << 12 | lighting.enable << 20;
+
+    if (!lighting.enable) {
+        return uber;
+    }
+
+    // 0-3: number of lights, 4-5: bump mode, 6-7: bump selector, 8: bump renormalization,
+    // 9: clamp highlights, 10-11: primary/secondary alpha, 12: shadow, 13-14: primary/secondary
+    // shadow, 15: shadow invert, 16: shadow alpha, 17-18: shadow selector, 19: configuration 7
+    uber.lighting_config =
+        lighting.src_num | static_cast<u32>(lighting.bump_mode) << 4 |
+        lighting.bump_selector << 6 | lighting.bump_renorm << 8 |
+        lighting.clamp_highlights << 9 | lighting.enable_primary_alpha << 10 |
+        lighting.enable_secondary_alpha << 11 | lighting.enable_shadow << 12 |
+        lighting.shadow_primary << 13 | lighting.shadow_secondary << 14 |
+        lighting.shadow_invert << 15 | lighting.shadow_alpha << 16 |
+        lighting.shadow_selector << 17 |
+        (lighting.config == LightingRegs::LightingConfig::Config7) << 19;
+
+    const auto is_supported = [&lighting](LightingRegs::LightingSampler sampler) {
+        return LightingRegs::IsLightingSamplerSupported(lighting.config, sampler);
+    };
+
+    // 0-2: light source, 3: directional, 4: two sided diffuse, 5: distance attenuation,
+    // 6: spot attenuation, 7-8: geometric factors, 9: shadow, 10: absolute LUT inputs are two
+    // sided. Like the specialized shader, the last one is taken from the light slot with the index
+    // of the light source.
+    for (unsigned i = 0; i < lighting.src_num; ++i) {
+        const auto& light = lighting.light[i];
+        const bool spot_atten =
+            light.spot_atten_enable &&
+            is_supported(LightingRegs::LightingSampler::SpotlightAttenuation);
+        uber.light_configs[i] =
+            light.num | light.directional << 3 | light.two_sided_diffuse << 4 |
+            light.dist_atten_enable << 5 | spot_atten << 6 | light.geometric_factor_0 << 7 |
+            light.geometric_factor_1 << 8 | light.shadow_enable << 9 |
+            lighting.light[light.num].two_sided_diffuse << 10;
+    }
+
+    // 0: enabled, 1: absolute input, 2-4: input
+    const auto pack_lut = [&](std::size_t index, const auto& lut, bool enable) {
+        uber.lut_configs[index] =
+            enable | lut.abs_input << 1 | static_cast<u32>(lut.type) << 2;
+        uber.lut_scales[index] = lut.scale;
+    };
+    using Sampler = LightingRegs::LightingSampler;
+    pack_lut(0, lighting.lut_d0, lighting.lut_d0.enable && is_supported(Sampler::Distribution0));
+    pack_lut(1, lighting.lut_d1, lighting.lut_d1.enable && is_supported(Sampler::Distribution1));
+    pack_lut(2, lighting.lut_sp, true);
+    pack_lut(3, lighting.lut_fr, lighting.lut_fr.enable && is_supported(Sampler::Fresnel));
+    pack_lut(4, lighting.lut_rr, lighting.lut_rr.enable && is_supported(Sampler::ReflectRed));
+    pack_lut(5, lighting.lut_rg, lighting.lut_rg.enable && is_supported(Sampler::ReflectGreen));
+    pack_lut(6, lighting.lut_rb, lighting.lut_rb.enable && is_supported(Sampler::ReflectBlue));
+
+    return uber;
+}
+
+ShaderDecompiler::ProgramResult GenerateFragmentUbershader(bool separable_shader) {
+    std::string out = GetFragmentShaderCommon(separable_shader);
+
+    out += R"(
+#define LUT_D0 0
+#define LUT_D1 1
+#define LUT_SP 2
+#define LUT_FR 3
+#define LUT_RR 4
+#define LUT_RG 5
+#define LUT_RB 6
+
+uniform uvec4 tev_configs[NUM_TEV_STAGES];
+uniform uint fs_config;
+uniform uint lighting_config;
+uniform uint light_configs[NUM_LIGHTS];
+uniform uint lut_configs[7];
+uniform float lut_scales[7];
+
+vec4 tex_colors[4];
+vec4 rounded_primary_color;
+vec4 primary_fragment_color;
+vec4 secondary_fragment_color;
+vec4 combiner_buffer;
+vec4 last_tex_env_out;
+
+uint configBits(uint value, int offset, int count) {
+    return (value >> uint(offset)) & ((1u << uint(count)) - 1u);
+}
+
+bool configFlag(uint value, int offset) {
+    return ((value >> uint(offset)) & 1u) != 0u;
+}
+
+void SampleTextures() {
+    uint texture0_type = configBits(fs_config, 5, 3);
+    if (texture0_type == 0u) {
+        tex_colors[0] = textureLod(tex0, texcoord0, getLod(texcoord0 * vec2(textureSize(tex0, 0))));
+    } else if (texture0_type == 1u) {
+        tex_colors[0] = texture(tex_cube, vec3(texcoord0, texcoord0_w));
+    } else if (texture0_type == 3u) {
+        tex_colors[0] = textureProj(tex0, vec3(texcoord0, texcoord0_w));
+    } else {
+        tex_colors[0] = vec4(0.0);
+    }
+    tex_colors[1] = textureLod(tex1, texcoord1, getLod(texcoord1 * vec2(textureSize(tex1, 0))));
+    vec2 texcoord = configFlag(fs_config, 8) ? texcoord1 : texcoord2;
+    tex_colors[2] = textureLod(tex2, texcoord, getLod(texcoord * vec2(textureSize(tex2, 0))));
+    tex_colors[3] = vec4(0.0);
+}
+
+float GetLightingLutValue(int lut, int lut_index, uint light, vec3 normal, vec3 tangent,
+                          vec3 light_vector, vec3 spot_dir, vec3 half_vector) {
+    uint lut_config = lut_configs[lut];
+    float index = 0.0;
+    switch (int(configBits(lut_config, 2, 3))) {
+    case 0: // NH
+        index = dot(normal, normalize(half_vector));
+        break;
+    case 1: // VH
+        index = dot(normalize(view), normalize(half_vector));
+        break;
+    case 2: // NV
+        index = dot(normal, normalize(view));
+        break;
+    case 3: // LN
+        index = dot(light_vector, normal);
+        break;
+    case 4: // SP
+        index = dot(light_vector, spot_dir);
+        break;
+    case 5: // CP, only available with configuration 7
+        if (configFlag(lighting_config, 19)) {
+            vec3 half_angle = normalize(half_vector);
+            index = dot(half_angle - normal * dot(normal, half_angle), tangent);
+        }
+        break;
+    }
+
+    float value;
+    if (configFlag(lut_config, 1)) {
+        index = configFlag(light, 10) ? abs(index) : max(index, 0.0);
+        value = LookupLightingLUTUnsigned(lut_index, index);
+    } else {
+        value = LookupLightingLUTSigned(lut_index, index);
+    }
+    return lut_scales[lut] * value;
+}
+
+void ComputeLighting() {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec3 refl_value = vec3(0.0);
+    float clamp_highlights = 1.0;
+    float geo_factor = 1.0;
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    uint bump_mode = configBits(lighting_config, 4, 2);
+    vec3 perturbation = 2.0 * tex_colors[int(configBits(lighting_config, 6, 2))].rgb - 1.0;
+    if (bump_mode == 1u) {
+        surface_normal = perturbation;
+        if (configFlag(lighting_config, 8)) {
+            float xy = surface_normal.x * surface_normal.x + surface_normal.y * surface_normal.y;
+            surface_normal.z = sqrt(max(1.0 - xy, 0.0));
+        }
+    } else if (bump_mode == 2u) {
+        surface_tangent = perturbation;
+    }
+
+    vec4 normalized_normquat = normalize(normquat);
+    vec3 normal = quaternion_rotate(normalized_normquat, surface_normal);
+    vec3 tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if (configFlag(lighting_config, 12)) {
+        shadow = tex_colors[int(configBits(lighting_config, 17, 2))];
+        if (configFlag(lighting_config, 15)) {
+            shadow = vec4(1.0) - shadow;
+        }
+    }
+
+    int src_num = int(configBits(lighting_config, 0, 4));
+    for (int i = 0; i < NUM_LIGHTS; ++i) {
+        if (i >= src_num) {
+            break;
+        }
+        uint light = light_configs[i];
+        int num = int(configBits(light, 0, 3));
+
+        vec3 light_vector = configFlag(light, 3) ? normalize(light_src[num].position)
+                                                 : normalize(light_src[num].position + view);
+        vec3 spot_dir = light_src[num].spot_direction;
+        vec3 half_vector = normalize(view) + light_vector;
+
+        float dot_product = configFlag(light, 4) ? abs(dot(light_vector, normal))
+                                                 : max(dot(light_vector, normal), 0.0);
+        if (configFlag(lighting_config, 9)) {
+            clamp_highlights = sign(dot_product);
+        }
+
+        float spot_atten = 1.0;
+        if (configFlag(light, 6)) {
+            spot_atten = GetLightingLutValue(LUT_SP, 8 + num, light, normal, tangent,
+                                             light_vector, spot_dir, half_vector);
+        }
+
+        float dist_atten = 1.0;
+        if (configFlag(light, 5)) {
+            float index = clamp(light_src[num].dist_atten_scale *
+                                length(-view - light_src[num].position) +
+                                light_src[num].dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(16 + num, index);
+        }
+
+        if (configFlag(light, 7) || configFlag(light, 8)) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        float d0_lut_value = 1.0;
+        if (configFlag(lut_configs[LUT_D0], 0)) {
+            d0_lut_value = GetLightingLutValue(LUT_D0, 0, light, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        vec3 specular_0 = d0_lut_value * light_src[num].specular_0;
+        if (configFlag(light, 7)) {
+            specular_0 *= geo_factor;
+        }
+
+        refl_value.r = 1.0;
+        if (configFlag(lut_configs[LUT_RR], 0)) {
+            refl_value.r = GetLightingLutValue(LUT_RR, 6, light, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        refl_value.g = refl_value.r;
+        if (configFlag(lut_configs[LUT_RG], 0)) {
+            refl_value.g = GetLightingLutValue(LUT_RG, 5, light, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        refl_value.b = refl_value.r;
+        if (configFlag(lut_configs[LUT_RB], 0)) {
+            refl_value.b = GetLightingLutValue(LUT_RB, 4, light, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+
+        float d1_lut_value = 1.0;
+        if (configFlag(lut_configs[LUT_D1], 0)) {
+            d1_lut_value = GetLightingLutValue(LUT_D1, 1, light, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        vec3 specular_1 = d1_lut_value * refl_value * light_src[num].specular_1;
+        if (configFlag(light, 8)) {
+            specular_1 *= geo_factor;
+        }
+
+        // Only the last entry in the light slots applies the Fresnel factor
+        if (i == src_num - 1 && configFlag(lut_configs[LUT_FR], 0)) {
+            float value = GetLightingLutValue(LUT_FR, 3, light, normal, tangent, light_vector,
+                                              spot_dir, half_vector);
+            if (configFlag(lighting_config, 10)) {
+                diffuse_sum.a = value;
+            }
+            if (configFlag(lighting_config, 11)) {
+                specular_sum.a = value;
+            }
+        }
+
+        bool light_shadow = configFlag(light, 9);
+        vec3 shadow_primary =
+            light_shadow && configFlag(lighting_config, 13) ? shadow.rgb : vec3(1.0);
+        vec3 shadow_secondary =
+            light_shadow && configFlag(lighting_config, 14) ? shadow.rgb : vec3(1.0);
+
+        diffuse_sum.rgb += ((light_src[num].diffuse * dot_product) + light_src[num].ambient) *
+                           dist_atten * spot_atten * shadow_primary;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten *
+                            spot_atten * shadow_secondary;
+    }
+
+    if (configFlag(lighting_config, 16)) {
+        if (configFlag(lighting_config, 10)) {
+            diffuse_sum.a *= shadow.a;
+        }
+        if (configFlag(lighting_config, 11)) {
+            specular_sum.a *= shadow.a;
+        }
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+vec4 GetSource(uint source, int stage) {
+    switch (int(source)) {
+    case 0:
+        return rounded_primary_color;
+    case 1:
+        return primary_fragment_color;
+    case 2:
+        return secondary_fragment_color;
+    case 3:
+    case 4:
+    case 5:
+    case 6:
+        return tex_colors[int(source) - 3];
+    case 13:
+        return combiner_buffer;
+    case 14:
+        return const_color[stage];
+    case 15:
+        return last_tex_env_out;
+    }
+    return vec4(0.0);
+}
+
+vec3 GetColorModifier(uint modifier, vec4 value) {
+    vec3 result;
+    switch (int(modifier >> 1)) {
+    case 0:
+        result = value.rgb;
+        break;
+    case 1:
+        result = value.aaa;
+        break;
+    case 2:
+        result = value.rrr;
+        break;
+    case 4:
+        result = value.ggg;
+        break;
+    case 6:
+        result = value.bbb;
+        break;
+    default:
+        return vec3(0.0);
+    }
+    return (modifier & 1u) != 0u ? vec3(1.0) - result : result;
+}
+
+float GetAlphaModifier(uint modifier, vec4 value) {
+    float result;
+    switch (int(modifier >> 1)) {
+    case 0:
+        result = value.a;
+        break;
+    case 1:
+        result = value.r;
+        break;
+    case 2:
+        result = value.g;
+        break;
+    default:
+        result = value.b;
+        break;
+    }
+    return (modifier & 1u) != 0u ? 1.0 - result : result;
+}
+
+vec3 CombineColor(uint op, vec3 i[3]) {
+    vec3 result;
+    switch (int(op)) {
+    case 0:
+        result = i[0];
+        break;
+    case 1:
+        result = i[0] * i[1];
+        break;
+    case 2:
+        result = i[0] + i[1];
+        break;
+    case 3:
+        result = i[0] + i[1] - vec3(0.5);
+        break;
+    case 4:
+        result = i[0] * i[2] + i[1] * (vec3(1.0) - i[2]);
+        break;
+    case 5:
+        result = i[0] - i[1];
+        break;
+    case 6:
+    case 7:
+        result = vec3(dot(i[0] - vec3(0.5), i[1] - vec3(0.5)) * 4.0);
+        break;
+    case 8:
+        result = i[0] * i[1] + i[2];
+        break;
+    case 9:
+        result = min(i[0] + i[1], vec3(1.0)) * i[2];
+        break;
+    default:
+        result = vec3(0.0);
+        break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float CombineAlpha(uint op, float i[3]) {
+    float result;
+    switch (int(op)) {
+    case 0:
+        result = i[0];
+        break;
+    case 1:
+        result = i[0] * i[1];
+        break;
+    case 2:
+        result = i[0] + i[1];
+        break;
+    case 3:
+        result = i[0] + i[1] - 0.5;
+        break;
+    case 4:
+        result = i[0] * i[2] + i[1] * (1.0 - i[2]);
+        break;
+    case 5:
+        result = i[0] - i[1];
+        break;
+    case 8:
+        result = i[0] * i[1] + i[2];
+        break;
+    case 9:
+        result = min(i[0] + i[1], 1.0) * i[2];
+        break;
+    default:
+        result = 0.0;
+        break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+float GetMultiplier(uint scale) {
+    return scale < 3u ? float(1u << scale) : 1.0;
+}
+
+bool PassesAlphaTest(int alpha) {
+    switch (int(configBits(fs_config, 0, 3))) {
+    case 0:
+        return false;
+    case 2:
+        return alpha == alphatest_ref;
+    case 3:
+        return alpha != alphatest_ref;
+    case 4:
+        return alpha < alphatest_ref;
+    case 5:
+        return alpha <= alphatest_ref;
+    case 6:
+        return alpha > alphatest_ref;
+    case 7:
+        return alpha >= alphatest_ref;
+    }
+    return true;
+}
+
+void main() {
+rounded_primary_color = byteround(primary_color);
+primary_fragment_color = vec4(0.0);
+secondary_fragment_color = vec4(0.0);
+
+// Sample the textures up front, while the derivatives of all fragments are still defined
+SampleTextures();
+
+uint scissor_mode = configBits(fs_config, 3, 2);
+if (scissor_mode != 0u) {
+    bool inside = gl_FragCoord.x >= float(scissor_x1) && gl_FragCoord.y >= float(scissor_y1) &&
+                  gl_FragCoord.x < float(scissor_x2) && gl_FragCoord.y < float(scissor_y2);
+    // Include keeps the pixels inside the scissor box, Exclude the ones outside of it
+    if (inside != (scissor_mode == 3u)) discard;
+}
+
+float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+float depth = z_over_w * depth_scale + depth_offset;
+if (configFlag(fs_config, 9)) {
+    depth /= gl_FragCoord.w;
+}
+
+if (configFlag(fs_config, 20)) {
+    ComputeLighting();
+}
+
+combiner_buffer = vec4(0.0);
+vec4 next_combiner_buffer = tev_combiner_buffer_color;
+last_tex_env_out = vec4(0.0);
+
+for (int stage = 0; stage < NUM_TEV_STAGES; ++stage) {
+    uvec4 tev = tev_configs[stage];
+    vec3 color_results[3];
+    float alpha_results[3];
+    for (int i = 0; i < 3; ++i) {
+        color_results[i] = GetColorModifier(configBits(tev.y, 4 * i, 4),
+                                            GetSource(configBits(tev.x, 4 * i, 4), stage));
+        alpha_results[i] = GetAlphaModifier(configBits(tev.y, 12 + 4 * i, 3),
+                                            GetSource(configBits(tev.x, 16 + 4 * i, 4), stage));
+    }
+
+    // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
+    uint color_op = configBits(tev.z, 0, 4);
+    vec3 color_output = byteround(CombineColor(color_op, color_results));
+    // The result of the Dot3_RGBA operation is also placed in the alpha component
+    float alpha_output = color_op == 7u
+                             ? color_output.r
+                             : byteround(CombineAlpha(configBits(tev.z, 16, 4), alpha_results));
+    last_tex_env_out =
+        vec4(clamp(color_output * GetMultiplier(configBits(tev.w, 0, 2)), vec3(0.0), vec3(1.0)),
+             clamp(alpha_output * GetMultiplier(configBits(tev.w, 16, 2)), 0.0, 1.0));
+
+    combiner_buffer = next_combiner_buffer;
+    if (stage < 4) {
+        if (configFlag(fs_config, 12 + stage)) {
+            next_combiner_buffer.rgb = last_tex_env_out.rgb;
+        }
+        if (configFlag(fs_config, 16 + stage)) {
+            next_combiner_buffer.a = last_tex_env_out.a;
+        }
+    }
+}
+
+if (!PassesAlphaTest(int(last_tex_env_out.a * 255.0))) discard;
+
+if (configFlag(fs_config, 10)) {
+    float fog_index = configFlag(fs_config, 11) ? (1.0 - depth) * 128.0 : depth * 128.0;
+    float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+    float fog_f = fog_index - fog_i;
+    vec2 fog_lut_entry = texelFetch(texture_buffer_lut_lf, int(fog_i) + fog_lut_offset).rg;
+    float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+    last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+}
+
+gl_FragDepth = depth;
+// Round the final fragment color to maintain the PICA's 8 bits of precision
+color = byteround(last_tex_env_out);
+}
+)";
+
     return {std::move(out)};
 }
 
@@ -1667,6 +2423,7 @@ void main() {
 std::optional<ShaderDecompiler::ProgramResult> GenerateVertexShader(
     const Pica::Shader::ShaderSetup& setup, const PicaVSConfig& config, bool separable_shader) {
     std::string out;
+    out.reserve(vertex_shader_capacity);
     if (separable_shader && !GLES) {
         out += "#extension GL_ARB_separate_shader_objects : enable\n";
     }
@@ -1690,7 +2447,7 @@ std::optional<ShaderDecompiler::ProgramResult> GenerateVertexShader(
 
     auto program_source_opt = ShaderDecompiler::DecompileProgram(
         setup.program_code, setup.swizzle_data, config.state.main_offset, get_input_reg,
-        get_output_reg, config.state.sanitize_mul);
+        get_output_reg, config.state.sanitize_mul, false);
 
     if (!program_source_opt)
         return std::nullopt;
@@ -1707,7 +2464,7 @@ layout (std140) uniform vs_config {
     // input attributes declaration
     for (std::size_t i = 0; i < used_regs.size(); ++i) {
         if (used_regs[i]) {
-            out += fmt::format("layout(location = {0}) in vec4 vs_in_reg{0};\n", i);
+            AppendFormat(out, "layout(location = {0}) in vec4 vs_in_reg{0};\n", i);
         }
     }
     out += '\n';
@@ -1720,12 +2477,13 @@ layout (std140) uniform vs_config {
 
     out += "\nvoid main() {\n";
     for (u32 i = 0; i < config.state.num_outputs; ++i) {
-        out += fmt::format("    vs_out_attr{} = vec4(0.0, 0.0, 0.0, 1.0);\n", i);
+        AppendFormat(out, "    vs_out_attr{} = vec4(0.0, 0.0, 0.0, 1.0);\n", i);
     }
     out += "\n    exec_shader();\n}\n\n";
 
     out += program_source;
 
+    vertex_shader_capacity = std::max(vertex_shader_capacity, out.size());
     return {{std::move(out)}};
 }
 
@@ -1743,7 +2501,7 @@ static std::string GetGSCommonSource(const PicaGSConfigCommonRaw& config, bool s
     out += R"(
 struct Vertex {
 )";
-    out += fmt::format("    vec4 attributes[{}];\n", config.gs_output_attributes);
+    AppendFormat(out, "    vec4 attributes[{}];\n", config.gs_output_attributes);
     out += "};\n\n";
 
     const auto semantic = [&config](VSOutputAttributes::Semantic slot_semantic) -> std::string {
@@ -1834,10 +2592,10 @@ void main() {
     Vertex prim_buffer[3];
 )";
     for (u32 vtx = 0; vtx < 3; ++vtx) {
-        out += fmt::format("    prim_buffer[{}].attributes = vec4[{}](", vtx,
-                           config.state.gs_output_attributes);
+        AppendFormat(out, "    prim_buffer[{}].attributes = vec4[{}](", vtx,
+                     config.state.gs_output_attributes);
         for (u32 i = 0; i < config.state.vs_output_attributes; ++i) {
-            out += fmt::format("{}vs_out_attr{}[{}]", i == 0 ? "" : ", ", i, vtx);
+            AppendFormat(out, "{}vs_out_attr{}[{}]", i == 0 ? "" : ", ", i, vtx);
         }
         out += ");\n";
     }
@@ -1846,4 +2604,133 @@ void main() {
 
     return {std::move(out)};
 }
+
+std::optional<ShaderDecompiler::ProgramResult> GenerateGeometryShader(
+    const Pica::Shader::ShaderSetup& setup, const PicaGSConfig& config, bool separable_shader) {
+    const auto& state = config.state;
+    std::string out;
+    if (separable_shader && !GLES) {
+        out += "#extension GL_ARB_separate_shader_objects : enable\n\n";
+    }
+
+    switch (state.vertices_per_primitive) {
+    case 1:
+        out += "layout(points) in;\n";
+        break;
+    case 2:
+        out += "layout(lines) in;\n";
+        break;
+    case 3:
+        out += "layout(triangles) in;\n";
+        break;
+    case 4:
+        out += "layout(lines_adjacency) in;\n";
+        break;
+    case 6:
+        out += "layout(triangles_adjacency) in;\n";
+        break;
+    default:
+        return std::nullopt;
+    }
+    // The PICA GS has no limit on the vertices it emits. This fits the minimum output components
+    // of GL within the varyings of a vertex.
+    out += "layout(triangle_strip, max_vertices = 30) out;\n\n";
+
+    out += GetGSCommonSource(state, separable_shader);
+
+    const auto get_input_reg = [&state](u32 reg) -> std::string {
+        ASSERT(reg < 16);
+        const u32 attr = state.input_map[reg];
+        const u32 vertex = attr / state.attributes_per_vertex;
+        const u32 vertex_attr = attr % state.attributes_per_vertex;
+        if (attr < state.num_inputs && vertex_attr < state.vs_output_attributes) {
+            return fmt::format("vs_out_attr{}[{}]", vertex_attr, vertex);
+        }
+        return "vec4(0.0, 0.0, 0.0, 1.0)";
+    };
+
+    const auto get_output_reg = [&state](u32 reg) -> std::string {
+        ASSERT(reg < 16);
+        if (state.output_map[reg] < state.num_outputs) {
+            return fmt::format("output_buffer.attributes[{}]", state.output_map[reg]);
+        }
+        return "";
+    };
+
+    auto program_source_opt = ShaderDecompiler::DecompileProgram(
+        setup.program_code, setup.swizzle_data, state.main_offset, get_input_reg, get_output_reg,
+        state.sanitize_mul, true);
+    if (!program_source_opt) {
+        return std::nullopt;
+    }
+
+    if (state.inputs_in_uniforms) {
+        // The vertices are written to the float uniforms the program reads them from, so the
+        // uniforms are a copy of the block
+        out += R"(
+layout (std140) uniform gs_config {
+    pica_uniforms gs_uniforms;
+};
+pica_uniforms uniforms;
+)";
+    } else {
+        out += R"(
+#define uniforms gs_uniforms
+layout (std140) uniform gs_config {
+    pica_uniforms uniforms;
+};
+)";
+    }
+
+    out += R"(
+Vertex output_buffer;
+Vertex prim_buffer[3];
+uint vertex_id = 0u;
+bool prim_emit = false;
+bool winding = false;
+
+void setemit(uint vertex_id_, bool prim_emit_, bool winding_) {
+    vertex_id = vertex_id_;
+    prim_emit = prim_emit_;
+    winding = winding_;
+}
+
+void emit() {
+    prim_buffer[vertex_id] = output_buffer;
+
+    if (prim_emit) {
+        if (winding) {
+            EmitPrim(prim_buffer[1], prim_buffer[0], prim_buffer[2]);
+            winding = false;
+        } else {
+            EmitPrim(prim_buffer[0], prim_buffer[1], prim_buffer[2]);
+        }
+    }
+}
+
+void main() {
+)";
+    if (state.inputs_in_uniforms) {
+        out += "    uniforms = gs_uniforms;\n";
+        for (u32 vtx = 0; vtx < state.vertices_per_primitive; ++vtx) {
+            for (u32 i = 0; i < state.vs_output_attributes && i < state.attributes_per_vertex;
+                 ++i) {
+                const u32 index =
+                    state.uniform_start_index + vtx * state.attributes_per_vertex + i;
+                if (index < 96) {
+                    AppendFormat(out, "    uniforms.f[{}] = vs_out_attr{}[{}];\n", index, i,
+                                 vtx);
+                }
+            }
+        }
+    }
+    for (u32 i = 0; i < state.num_outputs; ++i) {
+        AppendFormat(out, "    output_buffer.attributes[{}] = vec4(0.0, 0.0, 0.0, 1.0);\n", i);
+    }
+    out += "\n    exec_shader();\n}\n\n";
+
+    out += program_source_opt->code;
+
+    return {{std::move(out)}};
+}
 } // namespace OpenGL
@@ -192,6 +192,37 @@ struct PicaGSConfigCommonRaw {
     std::array<SemanticMap, 24> semantic_maps;
 };
 
+/**
+ * Returns the number of vertices the PICA geometry shader reads per invocation, which decides the
+ * GL input primitive; 0 if the GS mode can't be run on the host
+ */
+u32 GetGSVerticesPerPrimitive(const Pica::Regs& regs);
+
+struct PicaGSConfigRaw : PicaShaderConfigCommon, PicaGSConfigCommonRaw {
+    void Init(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup);
+
+    u32 num_inputs;
+    u32 attributes_per_vertex;
+    u32 vertices_per_primitive;
+
+    // In fixed primitive mode, the inputs are read from the float uniforms starting here
+    bool inputs_in_uniforms;
+    u32 uniform_start_index;
+
+    // input_map[input register index] -> input attribute index
+    std::array<u32, 16> input_map;
+};
+
+/**
+ * This struct contains information to identify a GL geometry shader generated from PICA geometry
+ * shader.
+ */
+struct PicaGSConfig : Common::HashableStruct<PicaGSConfigRaw> {
+    explicit PicaGSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
+        state.Init(regs, setup);
+    }
+};
+
 /**
  * This struct contains information to identify a GL geometry shader generated from PICA no-geometry
  * shader pipeline
@@ -224,6 +255,14 @@ std::optional<ShaderDecompiler::ProgramResult> GenerateVertexShader(
 ShaderDecompiler::ProgramResult GenerateFixedGeometryShader(const PicaFixedGSConfig& config,
                                                             bool separable_shader);
 
+/**
+ * Generates the GLSL geometry shader program source code for the given GS program, in point or
+ * fixed primitive mode
+ * @returns String of the shader source code; std::nullopt on failure
+ */
+std::optional<ShaderDecompiler::ProgramResult> GenerateGeometryShader(
+    const Pica::Shader::ShaderSetup& setup, const PicaGSConfig& config, bool separable_shader);
+
 /**
  * Generates the GLSL fragment shader program source code for the current Pica state
  * @param config ShaderCacheKey object generated for the current Pica state, used for the shader
@@ -234,6 +273,34 @@ ShaderDecompiler::ProgramResult GenerateFixedGeometryShader(const PicaFixedGSCon
 ShaderDecompiler::ProgramResult GenerateFragmentShader(const PicaFSConfig& config,
                                                        bool separable_shader);
 
+/**
+ * Uniform values that make the fragment ubershader emulate a PicaFSConfig. The bit layout of the
+ * packed words is documented in BuildFSUbershaderConfig and must match the GLSL code.
+ */
+struct FSUbershaderConfig {
+    std::array<std::array<u32, 4>, 6> tev_stages;
+    u32 fs_config;
+    u32 lighting_config;
+    std::array<u32, 8> light_configs;
+    std::array<u32, 7> lut_configs;
+    std::array<float, 7> lut_scales;
+};
+
+/**
+ * Packs the given fragment shader config into ubershader uniforms
+ * @returns The uniform values; std::nullopt if the config uses state the ubershader does not
+ *          emulate (procedural textures, shadows or gas fog) and needs its specialized shader
+ */
+std::optional<FSUbershaderConfig> BuildFSUbershaderConfig(const PicaFSConfig& config);
+
+/**
+ * Generates the GLSL fragment ubershader, which reads the TEV combiners, alpha test, fog and
+ * lighting configuration from the uniforms in FSUbershaderConfig instead of baking them in
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+ShaderDecompiler::ProgramResult GenerateFragmentUbershader(bool separable_shader);
+
 } // namespace OpenGL
 
 namespace std {
@@ -251,6 +318,13 @@ struct hash<OpenGL::PicaVSConfig> {
     }
 };
 
+template <>
+struct hash<OpenGL::PicaGSConfig> {
+    std::size_t operator()(const OpenGL::PicaGSConfig& k) const noexcept {
+        return k.Hash();
+    }
+};
+
 template <>
 struct hash<OpenGL::PicaFixedGSConfig> {
     std::size_t operator()(const OpenGL::PicaFixedGSConfig& k) const noexcept {
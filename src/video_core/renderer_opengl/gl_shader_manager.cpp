@@ -3,11 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
+#include <optional>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/functional/hash.hpp>
 #include <boost/variant.hpp>
 #include "core/core.h"
+#include "core/frame_counters.h"
+#include "core/settings.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 #include "video_core/video_core.h"
@@ -94,6 +100,7 @@ static void SetShaderUniformBlockBindings(GLuint shader) {
     SetShaderUniformBlockBinding(shader, "shader_data", UniformBindings::Common,
                                  sizeof(UniformData));
     SetShaderUniformBlockBinding(shader, "vs_config", UniformBindings::VS, sizeof(VSUniformData));
+    SetShaderUniformBlockBinding(shader, "gs_config", UniformBindings::GS, sizeof(GSUniformData));
 }
 
 static void SetShaderSamplerBinding(GLuint shader, const char* name,
@@ -169,6 +176,7 @@ public:
     }
 
     void Create(const char* source, GLenum type) {
+        Core::CountFrameEvent(Core::FrameCounter::ShaderCompiles);
         if (shader_or_program.which() == 0) {
             boost::get<OGLShader>(shader_or_program).Create(source, type);
         } else {
@@ -215,6 +223,59 @@ private:
     OGLShaderStage program;
 };
 
+/**
+ * Single fragment program that emulates most PicaFSConfigs through uniforms. It is drawn with
+ * while the specialized shader of a config is compiled in the background.
+ */
+class FragmentUbershader {
+public:
+    FragmentUbershader() : program(true) {
+        program.Create(GenerateFragmentUbershader(true).code.c_str(), GL_FRAGMENT_SHADER);
+        const GLuint handle = program.GetHandle();
+        tev_configs_location = glGetUniformLocation(handle, "tev_configs");
+        fs_config_location = glGetUniformLocation(handle, "fs_config");
+        lighting_config_location = glGetUniformLocation(handle, "lighting_config");
+        light_configs_location = glGetUniformLocation(handle, "light_configs");
+        lut_configs_location = glGetUniformLocation(handle, "lut_configs");
+        lut_scales_location = glGetUniformLocation(handle, "lut_scales");
+    }
+
+    /// Sets the uniforms up to emulate the given config and returns the program handle
+    GLuint Use(const PicaFSConfig& config, const FSUbershaderConfig& uniforms) {
+        const GLuint handle = program.GetHandle();
+        if (current_config && *current_config == config) {
+            return handle;
+        }
+        current_config = config;
+
+        glProgramUniform4uiv(handle, tev_configs_location,
+                             static_cast<GLsizei>(uniforms.tev_stages.size()),
+                             uniforms.tev_stages[0].data());
+        glProgramUniform1ui(handle, fs_config_location, uniforms.fs_config);
+        glProgramUniform1ui(handle, lighting_config_location, uniforms.lighting_config);
+        glProgramUniform1uiv(handle, light_configs_location,
+                             static_cast<GLsizei>(uniforms.light_configs.size()),
+                             uniforms.light_configs.data());
+        glProgramUniform1uiv(handle, lut_configs_location,
+                             static_cast<GLsizei>(uniforms.lut_configs.size()),
+                             uniforms.lut_configs.data());
+        glProgramUniform1fv(handle, lut_scales_location,
+                            static_cast<GLsizei>(uniforms.lut_scales.size()),
+                            uniforms.lut_scales.data());
+        return handle;
+    }
+
+private:
+    OGLShaderStage program;
+    std::optional<PicaFSConfig> current_config;
+    GLint tev_configs_location;
+    GLint fs_config_location;
+    GLint lighting_config_location;
+    GLint light_configs_location;
+    GLint lut_configs_location;
+    GLint lut_scales_location;
+};
+
 template <typename KeyConfigType,
           ShaderDecompiler::ProgramResult (*CodeGenerator)(const KeyConfigType&, bool),
           GLenum ShaderType>
@@ -233,12 +294,25 @@ public:
         return {cached_shader.GetHandle(), std::move(result)};
     }
 
+    /// Builds the shader of a config from its previously generated source
+    GLuint Create(const KeyConfigType& config, const std::string& code) {
+        auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
+        if (new_shader) {
+            iter->second.Create(code.c_str(), ShaderType);
+        }
+        return iter->second.GetHandle();
+    }
+
     void Inject(const KeyConfigType& key, OGLProgram&& program) {
         OGLShaderStage stage{separable};
         stage.Inject(std::move(program));
         shaders.emplace(key, std::move(stage));
     }
 
+    bool Contains(const KeyConfigType& key) const {
+        return shaders.find(key) != shaders.end();
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage> shaders;
@@ -286,6 +360,17 @@ public:
         return {map_it->second->GetHandle(), std::nullopt};
     }
 
+    /// Builds the shader of a config from its previously generated source
+    GLuint Create(const KeyConfigType& key, std::string code) {
+        auto [iter, new_shader] = shader_cache.emplace(std::move(code), OGLShaderStage{separable});
+        OGLShaderStage& cached_shader = iter->second;
+        if (new_shader) {
+            cached_shader.Create(iter->first.c_str(), ShaderType);
+        }
+        shader_map.insert_or_assign(key, &cached_shader);
+        return cached_shader.GetHandle();
+    }
+
     void Inject(const KeyConfigType& key, std::string decomp, OGLProgram&& program) {
         OGLShaderStage stage{separable};
         stage.Inject(std::move(program));
@@ -294,6 +379,10 @@ public:
         shader_map.insert_or_assign(key, &cached_shader);
     }
 
+    bool Contains(const KeyConfigType& key) const {
+        return shader_map.find(key) != shader_map.end();
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage*> shader_map;
@@ -303,19 +392,94 @@ private:
 using ProgrammableVertexShaders =
     ShaderDoubleCache<PicaVSConfig, &GenerateVertexShader, GL_VERTEX_SHADER>;
 
+using ProgrammableGeometryShaders =
+    ShaderDoubleCache<PicaGSConfig, &GenerateGeometryShader, GL_GEOMETRY_SHADER>;
+
 using FixedGeometryShaders =
     ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER>;
 
 using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER>;
 
+/// Disk cache entry waiting to be loaded
+struct DiskCacheEntry {
+    ShaderDiskCacheRaw raw;
+    const ShaderDiskCacheDecompiled* decompiled;
+    const ShaderDiskCacheDump* dump;
+    bool loaded;
+};
+
+/// Unique identifier of a shader config in the disk cache and how many times it was bound
+struct ShaderUsage {
+    u64 unique_identifier;
+    u32 count;
+};
+
 class ShaderProgramManager::Impl {
 public:
     explicit Impl(bool separable, bool is_amd)
         : is_amd(is_amd), separable(separable), programmable_vertex_shaders(separable),
-          trivial_vertex_shader(separable), fixed_geometry_shaders(separable),
+          trivial_vertex_shader(separable), programmable_geometry_shaders(separable),
+          fixed_geometry_shaders(separable),
           fragment_shaders(separable), disk_cache(separable) {
         if (separable)
             pipeline.Create();
+
+        // Async compilation builds separable programs, which the linked program cache can't use
+        if (separable && Settings::values.async_shader_compilation) {
+            const std::size_t num_workers =
+                std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+            async_compiler = std::make_unique<AsyncShaderCompiler>(num_workers);
+            if (Settings::values.fragment_ubershader) {
+                fragment_ubershader = std::make_unique<FragmentUbershader>();
+            }
+        }
+    }
+
+    ~Impl() {
+        // Keep what was built so far if the game is closed before the disk cache finished loading
+        if (precompiled_cache_altered) {
+            disk_cache.SaveVirtualPrecompiledFile();
+        }
+        if (track_usage) {
+            ShaderUsageCounts counts;
+            const auto add_counts = [&counts](const auto& usage_map) {
+                for (const auto& [config, usage] : usage_map) {
+                    if (usage.count != 0) {
+                        counts.insert_or_assign(usage.unique_identifier, usage.count);
+                    }
+                }
+            };
+            add_counts(vs_usage);
+            add_counts(fs_usage);
+            disk_cache.SaveUsageCounts(counts);
+        }
+    }
+
+    bool IsLoadingDiskCache() const {
+        return !disk_cache_entries.empty();
+    }
+
+    /// Returns the usage entry of the config, so that later binds can count on it directly
+    template <typename Config>
+    ShaderUsage* CountUse(std::unordered_map<Config, ShaderUsage>& usage_map,
+                          const Config& config) {
+        if (!track_usage) {
+            return nullptr;
+        }
+        const auto it = usage_map.find(config);
+        if (it == usage_map.end()) {
+            return nullptr;
+        }
+        ++it->second.count;
+        return &it->second;
+    }
+
+    template <typename Config>
+    void AddUsage(std::unordered_map<Config, ShaderUsage>& usage_map, const Config& config,
+                  u64 unique_identifier) {
+        if (track_usage) {
+            usage_map.try_emplace(config, ShaderUsage{unique_identifier, 0});
+        }
     }
 
     struct ShaderTuple {
@@ -350,12 +514,45 @@ public:
     ProgrammableVertexShaders programmable_vertex_shaders;
     TrivialVertexShader trivial_vertex_shader;
 
+    /// Vertex shader bound by the last successful UseProgrammableVertexShader call
+    GLuint last_vs = 0;
+    bool last_vs_sanitize_mul = false;
+    ShaderUsage* last_vs_usage = nullptr;
+
+    ProgrammableGeometryShaders programmable_geometry_shaders;
     FixedGeometryShaders fixed_geometry_shaders;
 
     FragmentShaders fragment_shaders;
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
     ShaderDiskCache disk_cache;
+
+    /// Configs queued on async_compiler, which are not in the caches yet
+    std::unique_ptr<AsyncShaderCompiler> async_compiler;
+    std::unordered_set<PicaVSConfig> pending_vs;
+    std::unordered_set<PicaFSConfig> pending_fs;
+
+    /// Stands in for pending fragment shaders, if enabled
+    std::unique_ptr<FragmentUbershader> fragment_ubershader;
+    bool using_fragment_ubershader = false;
+
+    /// Disk cache entries in load order, and the ones of them a draw may ask for before their turn
+    std::vector<DiskCacheEntry> disk_cache_entries;
+    std::size_t next_disk_cache_entry = 0;
+    std::size_t num_disk_cache_jobs = 0;
+    std::unordered_map<PicaVSConfig, std::size_t> disk_cache_vs;
+    std::unordered_map<PicaFSConfig, std::size_t> disk_cache_fs;
+    ShaderDecompiledMap disk_cache_decompiled;
+    ShaderDumpsMap disk_cache_dumps;
+    std::set<GLenum> supported_formats;
+    bool precompiled_cache_rejected = false;
+    bool precompiled_cache_altered = false;
+    std::chrono::steady_clock::time_point next_disk_cache_slice{};
+
+    /// Bind counts of the shaders in the disk cache, saved to order the next session's load
+    bool track_usage = false;
+    std::unordered_map<PicaVSConfig, ShaderUsage> vs_usage;
+    std::unordered_map<PicaFSConfig, ShaderUsage> fs_usage;
 };
 
 ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
@@ -363,31 +560,131 @@ ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
+static ShaderDiskCacheRaw BuildVSRaw(const Pica::Regs& regs,
+                                     const Pica::Shader::ShaderSetup& setup) {
+    ProgramCode program_code{setup.program_code.begin(), setup.program_code.end()};
+    program_code.insert(program_code.end(), setup.swizzle_data.begin(), setup.swizzle_data.end());
+    const u64 unique_identifier = GetUniqueIdentifier(regs, program_code);
+    return ShaderDiskCacheRaw{unique_identifier, ProgramType::VS, regs, std::move(program_code)};
+}
+
 bool ShaderProgramManager::UseProgrammableVertexShader(const Pica::Regs& regs,
                                                        Pica::Shader::ShaderSetup& setup) {
+    impl->last_vs = 0;
     PicaVSConfig config{regs.vs, setup};
+    if (impl->IsLoadingDiskCache()) {
+        StreamDiskCache();
+        // Load the cached program right away if a draw needs it before its turn
+        const auto it = impl->disk_cache_vs.find(config);
+        if (it != impl->disk_cache_vs.end()) {
+            LoadDiskCacheEntry(it->second, true);
+        }
+    }
+    if (impl->async_compiler) {
+        impl->async_compiler->Poll();
+        if (!impl->programmable_vertex_shaders.Contains(config)) {
+            // Vertices are processed on the CPU until the shader is ready
+            QueueAsyncVertexShader(regs, setup, config);
+            return false;
+        }
+    }
+
     auto [handle, result] = impl->programmable_vertex_shaders.Get(config, setup);
     if (handle == 0)
         return false;
     impl->current.vs = handle;
     // Save VS to the disk cache if its a new shader
     if (result) {
-        auto& disk_cache = impl->disk_cache;
-        ProgramCode program_code{setup.program_code.begin(), setup.program_code.end()};
-        program_code.insert(program_code.end(), setup.swizzle_data.begin(),
-                            setup.swizzle_data.end());
-        const u64 unique_identifier = GetUniqueIdentifier(regs, program_code);
-        const ShaderDiskCacheRaw raw{unique_identifier, ProgramType::VS, regs,
-                                     std::move(program_code)};
-        disk_cache.SaveRaw(raw);
+        const ShaderDiskCacheRaw raw = BuildVSRaw(regs, setup);
+        impl->disk_cache.SaveRaw(raw);
+        impl->AddUsage(impl->vs_usage, config, raw.GetUniqueIdentifier());
+    }
+    impl->last_vs = handle;
+    impl->last_vs_sanitize_mul = config.state.sanitize_mul;
+    impl->last_vs_usage = impl->CountUse(impl->vs_usage, config);
+    return true;
+}
+
+bool ShaderProgramManager::UseLastProgrammableVertexShader() {
+    // The disk cache is streamed from the full path, and the accurate multiplication setting isn't
+    // a PICA register, so both send the draw through a new lookup
+    if (impl->last_vs == 0 || impl->IsLoadingDiskCache() ||
+        impl->last_vs_sanitize_mul != VideoCore::g_hw_shader_accurate_mul) {
+        return false;
+    }
+    impl->current.vs = impl->last_vs;
+    if (impl->last_vs_usage) {
+        ++impl->last_vs_usage->count;
     }
     return true;
 }
 
+void ShaderProgramManager::QueueAsyncVertexShader(
+    const Pica::Regs& regs, const Pica::Shader::ShaderSetup& setup, const PicaVSConfig& config,
+    bool from_disk_cache, std::optional<ShaderDecompiler::ProgramResult> source) {
+    if (!impl->pending_vs.insert(config).second) {
+        return;
+    }
+    if (from_disk_cache) {
+        ++impl->num_disk_cache_jobs;
+    }
+
+    // The emulated shader setup keeps changing, so the workers get their own copy of the code
+    auto setup_copy = std::make_shared<Pica::Shader::ShaderSetup>();
+    setup_copy->program_code = setup.program_code;
+    setup_copy->swizzle_data = setup.swizzle_data;
+    auto raw = std::make_shared<ShaderDiskCacheRaw>(BuildVSRaw(regs, setup));
+
+    impl->async_compiler->Queue(
+        GL_VERTEX_SHADER,
+        [setup_copy, config, separable = impl->separable, source = std::move(source)] {
+            if (source) {
+                return source;
+            }
+            return GenerateVertexShader(*setup_copy, config, separable);
+        },
+        [this, setup_copy, config, raw, from_disk_cache](
+            OGLProgram program, std::optional<ShaderDecompiler::ProgramResult> result) {
+            impl->pending_vs.erase(config);
+            if (from_disk_cache) {
+                --impl->num_disk_cache_jobs;
+            }
+            if (program.handle == 0) {
+                // Let the synchronous path report the failure and cache the unsupported config
+                impl->programmable_vertex_shaders.Get(config, *setup_copy);
+                return;
+            }
+            const u64 unique_identifier = raw->GetUniqueIdentifier();
+            if (from_disk_cache) {
+                impl->disk_cache.SaveDecompiled(unique_identifier, *result,
+                                                config.state.sanitize_mul);
+                impl->disk_cache.SaveDump(unique_identifier, program.handle);
+                impl->precompiled_cache_altered = true;
+            } else {
+                impl->disk_cache.SaveRaw(*raw);
+                impl->AddUsage(impl->vs_usage, config, unique_identifier);
+            }
+            impl->programmable_vertex_shaders.Inject(config, std::move(result->code),
+                                                     std::move(program));
+        });
+}
+
 void ShaderProgramManager::UseTrivialVertexShader() {
     impl->current.vs = impl->trivial_vertex_shader.Get();
 }
 
+bool ShaderProgramManager::UseProgrammableGeometryShader(const Pica::Regs& regs,
+                                                         Pica::Shader::ShaderSetup& setup) {
+    // These are rare enough to be built synchronously and left out of the disk cache
+    PicaGSConfig config{regs, setup};
+    auto [handle, _] = impl->programmable_geometry_shaders.Get(config, setup);
+    if (handle == 0) {
+        return false;
+    }
+    impl->current.gs = handle;
+    return true;
+}
+
 void ShaderProgramManager::UseFixedGeometryShader(const Pica::Regs& regs) {
     PicaFixedGSConfig gs_config(regs);
     auto [handle, _] = impl->fixed_geometry_shaders.Get(gs_config);
@@ -398,8 +695,34 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
     impl->current.gs = 0;
 }
 
-void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
+bool ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
     PicaFSConfig config = PicaFSConfig::BuildFromRegs(regs);
+    impl->using_fragment_ubershader = false;
+    if (impl->IsLoadingDiskCache()) {
+        StreamDiskCache();
+        // Load the cached program right away if a draw needs it before its turn
+        const auto it = impl->disk_cache_fs.find(config);
+        if (it != impl->disk_cache_fs.end()) {
+            LoadDiskCacheEntry(it->second, true);
+        }
+    }
+    if (impl->async_compiler) {
+        impl->async_compiler->Poll();
+        if (!impl->fragment_shaders.Contains(config)) {
+            QueueAsyncFragmentShader(regs, config);
+            if (!impl->fragment_ubershader) {
+                return false;
+            }
+            const auto uniforms = BuildFSUbershaderConfig(config);
+            if (!uniforms) {
+                return false;
+            }
+            impl->current.fs = impl->fragment_ubershader->Use(config, *uniforms);
+            impl->using_fragment_ubershader = true;
+            return true;
+        }
+    }
+
     auto [handle, result] = impl->fragment_shaders.Get(config);
     impl->current.fs = handle;
     // Save FS to the disk cache if its a new shader
@@ -409,7 +732,60 @@ void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
         ShaderDiskCacheRaw raw{unique_identifier, ProgramType::FS, regs, {}};
         disk_cache.SaveRaw(raw);
         disk_cache.SaveDecompiled(unique_identifier, *result, false);
+        impl->AddUsage(impl->fs_usage, config, unique_identifier);
     }
+    impl->CountUse(impl->fs_usage, config);
+    return true;
+}
+
+bool ShaderProgramManager::IsUsingFragmentUbershader() const {
+    return impl->using_fragment_ubershader;
+}
+
+void ShaderProgramManager::QueueAsyncFragmentShader(
+    const Pica::Regs& regs, const PicaFSConfig& config, bool from_disk_cache,
+    std::optional<ShaderDecompiler::ProgramResult> source) {
+    if (!impl->pending_fs.insert(config).second) {
+        return;
+    }
+    if (from_disk_cache) {
+        ++impl->num_disk_cache_jobs;
+    }
+
+    const u64 unique_identifier = GetUniqueIdentifier(regs, {});
+    auto raw = std::make_shared<ShaderDiskCacheRaw>(unique_identifier, ProgramType::FS, regs,
+                                                    ProgramCode{});
+    impl->async_compiler->Queue(
+        GL_FRAGMENT_SHADER,
+        [config, separable = impl->separable,
+         source = std::move(source)]() -> std::optional<ShaderDecompiler::ProgramResult> {
+            if (source) {
+                return source;
+            }
+            return GenerateFragmentShader(config, separable);
+        },
+        [this, config, raw, from_disk_cache](
+            OGLProgram program, std::optional<ShaderDecompiler::ProgramResult> result) {
+            impl->pending_fs.erase(config);
+            if (from_disk_cache) {
+                --impl->num_disk_cache_jobs;
+            }
+            if (program.handle == 0) {
+                // Let the synchronous path report the failure
+                impl->fragment_shaders.Get(config);
+                return;
+            }
+            const u64 unique_identifier = raw->GetUniqueIdentifier();
+            if (from_disk_cache) {
+                impl->disk_cache.SaveDump(unique_identifier, program.handle);
+                impl->precompiled_cache_altered = true;
+            } else {
+                impl->disk_cache.SaveRaw(*raw);
+                impl->AddUsage(impl->fs_usage, config, unique_identifier);
+            }
+            impl->disk_cache.SaveDecompiled(unique_identifier, *result, false);
+            impl->fragment_shaders.Inject(config, std::move(program));
+        });
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
@@ -453,181 +829,295 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
     }
 
     auto& disk_cache = impl->disk_cache;
-    const auto transferable = disk_cache.LoadTransferable();
+    auto transferable = disk_cache.LoadTransferable();
+    impl->track_usage = true;
     if (!transferable) {
         return;
     }
-    const auto& raws = *transferable;
+    auto& raws = *transferable;
 
-    auto [decompiled, dumps] = disk_cache.LoadPrecompiled();
+    std::tie(impl->disk_cache_decompiled, impl->disk_cache_dumps) = disk_cache.LoadPrecompiled();
 
     if (stop_loading) {
         return;
     }
 
-    std::set<GLenum> supported_formats = GetSupportedFormats();
+    if (callback) {
+        callback(VideoCore::LoadCallbackStage::Prepare, 0, raws.size());
+    }
 
-    // Track if precompiled cache was altered during loading to know if we have to serialize the
-    // virtual precompiled cache file back to the hard drive
-    bool precompiled_cache_altered = false;
+    const ShaderUsageCounts usage_counts = disk_cache.LoadUsageCounts();
+    const auto get_usage_count = [&usage_counts](const ShaderDiskCacheRaw& raw) {
+        const auto it = usage_counts.find(raw.GetUniqueIdentifier());
+        return it != usage_counts.end() ? it->second : 0;
+    };
+
+    for (const auto& raw : raws) {
+        const u64 calculated_hash =
+            GetUniqueIdentifier(raw.GetRawShaderConfig(), raw.GetProgramCode());
+        if (raw.GetUniqueIdentifier() != calculated_hash) {
+            LOG_ERROR(Render_OpenGL,
+                      "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing "
+                      "shader cache",
+                      raw.GetUniqueIdentifier(), calculated_hash);
+            disk_cache.InvalidateAll();
+            return;
+        }
+        if (raw.GetProgramType() != ProgramType::VS && raw.GetProgramType() != ProgramType::FS) {
+            // Unsupported shader type got stored somehow so nuke the cache
+            LOG_ERROR(Frontend, "failed to load raw programtype {}", raw.GetProgramType());
+            disk_cache.InvalidateAll();
+            return;
+        }
+    }
+
+    // Load the shaders the last session used the most first, so they are likely ready in time
+    std::stable_sort(raws.begin(), raws.end(), [&](const auto& lhs, const auto& rhs) {
+        return get_usage_count(lhs) > get_usage_count(rhs);
+    });
+
+    impl->supported_formats = GetSupportedFormats();
+    auto& entries = impl->disk_cache_entries;
+    entries.reserve(raws.size());
+    for (auto& raw : raws) {
+        const u64 unique_identifier = raw.GetUniqueIdentifier();
+        const auto decomp = impl->disk_cache_decompiled.find(unique_identifier);
+        const auto dump = impl->disk_cache_dumps.find(unique_identifier);
+        const std::size_t index = entries.size();
+        if (raw.GetProgramType() == ProgramType::VS) {
+            const PicaVSConfig config = std::get<0>(BuildVSConfigFromRaw(raw));
+            impl->disk_cache_vs.emplace(config, index);
+            impl->AddUsage(impl->vs_usage, config, unique_identifier);
+        } else {
+            const PicaFSConfig config = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
+            impl->disk_cache_fs.emplace(config, index);
+            impl->AddUsage(impl->fs_usage, config, unique_identifier);
+        }
+        entries.push_back({
+            std::move(raw),
+            decomp != impl->disk_cache_decompiled.end() ? &decomp->second : nullptr,
+            dump != impl->disk_cache_dumps.end() ? &dump->second : nullptr,
+            false,
+        });
+    }
 
-    std::mutex mutex;
-    std::atomic_bool compilation_failed = false;
+    if (entries.empty()) {
+        FinishDiskCacheLoad();
+        return;
+    }
+    // The callback is not kept: the caller reports Complete once this returns, and the entries
+    // streamed in during the game must not drive the loading screen after that
     if (callback) {
-        callback(VideoCore::LoadCallbackStage::Decompile, 0, raws.size());
-    }
-    std::vector<std::size_t> load_raws_index;
-    // Loads both decompiled and precompiled shaders from the cache. If either one is missing for
-    const auto LoadPrecompiledWorker =
-        [&](std::size_t begin, std::size_t end, const std::vector<ShaderDiskCacheRaw>& raw_cache,
-            const ShaderDecompiledMap& decompiled_map, const ShaderDumpsMap& dump_map) {
-            for (std::size_t i = 0; i < end; ++i) {
-                if (stop_loading || compilation_failed) {
-                    return;
-                }
-                const auto& raw{raw_cache[i]};
-                const u64 unique_identifier{raw.GetUniqueIdentifier()};
-
-                const u64 calculated_hash =
-                    GetUniqueIdentifier(raw.GetRawShaderConfig(), raw.GetProgramCode());
-                if (unique_identifier != calculated_hash) {
-                    LOG_ERROR(Render_OpenGL,
-                              "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing "
-                              "shader cache",
-                              raw.GetUniqueIdentifier(), calculated_hash);
-                    disk_cache.InvalidateAll();
-                    return;
-                }
+        callback(VideoCore::LoadCallbackStage::Build, 0, entries.size());
+    }
+    LOG_INFO(Render_OpenGL, "Loading {} disk cache entries in the background", entries.size());
+}
 
-                const auto dump{dump_map.find(unique_identifier)};
-                const auto decomp{decompiled_map.find(unique_identifier)};
+void ShaderProgramManager::StreamDiskCache() {
+    // Spend at most 2 ms of every 16 ms on the disk cache
+    constexpr auto slice_length = std::chrono::milliseconds{2};
+    constexpr auto slice_interval = std::chrono::milliseconds{16};
 
-                OGLProgram shader;
+    const auto now = std::chrono::steady_clock::now();
+    if (now < impl->next_disk_cache_slice) {
+        return;
+    }
+    impl->next_disk_cache_slice = now + slice_interval;
 
-                if (dump != dump_map.end() && decomp != decompiled_map.end()) {
-                    // Only load this shader if its sanitize_mul setting matches
-                    if (raw.GetProgramType() == ProgramType::VS &&
-                        decomp->second.sanitize_mul != VideoCore::g_hw_shader_accurate_mul) {
-                        continue;
-                    }
+    if (impl->async_compiler) {
+        impl->async_compiler->Poll();
+    }
 
-                    // If the shader is dumped, attempt to load it
-                    shader = GeneratePrecompiledProgram(dump->second, supported_formats);
-                    if (shader.handle == 0) {
-                        // If any shader failed, stop trying to compile, delete the cache, and start
-                        // loading from raws
-                        compilation_failed = true;
-                        return;
-                    }
-                    // we have both the binary shader and the decompiled, so inject it into the
-                    // cache
-                    if (raw.GetProgramType() == ProgramType::VS) {
-                        auto [conf, setup] = BuildVSConfigFromRaw(raw);
-                        std::scoped_lock lock(mutex);
-
-                        impl->programmable_vertex_shaders.Inject(conf, decomp->second.result.code,
-                                                                 std::move(shader));
-                    } else if (raw.GetProgramType() == ProgramType::FS) {
-                        PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
-                        std::scoped_lock lock(mutex);
-                        impl->fragment_shaders.Inject(conf, std::move(shader));
-                    } else {
-                        // Unsupported shader type got stored somehow so nuke the cache
-
-                        LOG_CRITICAL(Frontend, "failed to load raw programtype {}",
-                                     raw.GetProgramType());
-                        compilation_failed = true;
-                        return;
-                    }
-                } else {
-                    // Since precompiled didn't have the dump, we'll load them in the next phase
-                    std::scoped_lock lock(mutex);
-                    load_raws_index.push_back(i);
-                }
-                if (callback) {
-                    callback(VideoCore::LoadCallbackStage::Decompile, i, raw_cache.size());
-                }
-            }
-        };
+    const std::size_t num_entries = impl->disk_cache_entries.size();
+    while (impl->next_disk_cache_entry < num_entries &&
+           std::chrono::steady_clock::now() < now + slice_length) {
+        LoadDiskCacheEntry(impl->next_disk_cache_entry++, false);
+    }
 
-    LoadPrecompiledWorker(0, raws.size(), raws, decompiled, dumps);
+    if (impl->next_disk_cache_entry == num_entries && impl->num_disk_cache_jobs == 0) {
+        FinishDiskCacheLoad();
+    }
+}
 
-    if (compilation_failed) {
-        // Invalidate the precompiled cache if a shader dumped shader was rejected
-        disk_cache.InvalidatePrecompiled();
-        dumps.clear();
-        precompiled_cache_altered = true;
+void ShaderProgramManager::LoadDiskCacheEntry(std::size_t index, bool sync) {
+    auto& entry = impl->disk_cache_entries[index];
+    if (entry.loaded) {
+        return;
     }
+    entry.loaded = true;
 
-    if (callback) {
-        callback(VideoCore::LoadCallbackStage::Build, 0, raws.size());
+    const auto& raw = entry.raw;
+    const u64 unique_identifier = raw.GetUniqueIdentifier();
+    const bool has_precompiled =
+        entry.decompiled && entry.dump && !impl->precompiled_cache_rejected;
+
+    // Returns the program dumped to the precompiled file, or an empty one if it must be built
+    const auto load_precompiled = [&]() -> OGLProgram {
+        if (!has_precompiled) {
+            return {};
+        }
+        OGLProgram program = GeneratePrecompiledProgram(*entry.dump, impl->supported_formats);
+        if (program.handle == 0) {
+            // If any shader failed, delete the precompiled cache and build the rest from raws
+            impl->precompiled_cache_rejected = true;
+            impl->precompiled_cache_altered = true;
+            impl->disk_cache.InvalidatePrecompiled();
+        }
+        return program;
+    };
+
+    // The generated GLSL doesn't depend on the driver, so it is still used when the driver
+    // rejects the dumped binary, e.g. after a driver update
+    const auto cached_source = [&](bool sanitize_mul)
+        -> std::optional<ShaderDecompiler::ProgramResult> {
+        if (!entry.decompiled || entry.decompiled->sanitize_mul != sanitize_mul) {
+            return std::nullopt;
+        }
+        return entry.decompiled->result;
+    };
+
+    // Drivers with parallel shader compile link the dumped binaries of the entries in the
+    // background, which keeps the GL thread from waiting on each of them in turn
+    const bool link_in_background =
+        has_precompiled && !sync && impl->async_compiler &&
+        AsyncShaderCompiler::HasParallelShaderCompile() &&
+        impl->supported_formats.count(entry.dump->binary_format) != 0;
+
+    GLuint handle = 0;
+    std::optional<ShaderDecompiler::ProgramResult> result;
+    bool sanitize_mul = false;
+    if (raw.GetProgramType() == ProgramType::VS) {
+        auto [config, setup] = BuildVSConfigFromRaw(raw);
+        impl->disk_cache_vs.erase(config);
+        if (impl->programmable_vertex_shaders.Contains(config)) {
+            return;
+        }
+        // Only load this shader if its sanitize_mul setting matches
+        if (has_precompiled &&
+            entry.decompiled->sanitize_mul != VideoCore::g_hw_shader_accurate_mul) {
+            return;
+        }
+        if (link_in_background) {
+            QueuePrecompiledShader(index);
+            return;
+        }
+        if (OGLProgram program = load_precompiled(); program.handle != 0) {
+            impl->programmable_vertex_shaders.Inject(config, entry.decompiled->result.code,
+                                                     std::move(program));
+            return;
+        }
+        sanitize_mul = config.state.sanitize_mul;
+        auto source = cached_source(sanitize_mul);
+        if (!sync && impl->async_compiler) {
+            QueueAsyncVertexShader(raw.GetRawShaderConfig(), setup, config, true,
+                                   std::move(source));
+            return;
+        }
+        if (source) {
+            handle = impl->programmable_vertex_shaders.Create(config, source->code);
+            result = std::move(source);
+        } else {
+            std::tie(handle, result) = impl->programmable_vertex_shaders.Get(config, setup);
+        }
+    } else {
+        const PicaFSConfig config = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
+        impl->disk_cache_fs.erase(config);
+        if (impl->fragment_shaders.Contains(config)) {
+            return;
+        }
+        if (link_in_background) {
+            QueuePrecompiledShader(index);
+            return;
+        }
+        if (OGLProgram program = load_precompiled(); program.handle != 0) {
+            impl->fragment_shaders.Inject(config, std::move(program));
+            return;
+        }
+        auto source = cached_source(false);
+        if (!sync && impl->async_compiler) {
+            QueueAsyncFragmentShader(raw.GetRawShaderConfig(), config, true, std::move(source));
+            return;
+        }
+        if (source) {
+            handle = impl->fragment_shaders.Create(config, source->code);
+            result = std::move(source);
+        } else {
+            std::tie(handle, result) = impl->fragment_shaders.Get(config);
+        }
     }
 
-    compilation_failed = false;
+    if (handle == 0) {
+        LOG_ERROR(Frontend, "compilation from raw failed in entry={:016x}", unique_identifier);
+        return;
+    }
+    // Add the newly built shader to the precompiled cache
+    if (result) {
+        impl->disk_cache.SaveDecompiled(unique_identifier, *result, sanitize_mul);
+        impl->disk_cache.SaveDump(unique_identifier, handle);
+        impl->precompiled_cache_altered = true;
+    }
+}
 
-    const auto LoadTransferable = [&](std::size_t begin, std::size_t end,
-                                      const std::vector<ShaderDiskCacheRaw>& raw_cache) {
-        for (std::size_t i = 0; i < end; ++i) {
-            if (stop_loading || compilation_failed) {
-                return;
+void ShaderProgramManager::QueuePrecompiledShader(std::size_t index) {
+    const auto& entry = impl->disk_cache_entries[index];
+    std::function<void(OGLProgram)> inject;
+    if (entry.raw.GetProgramType() == ProgramType::VS) {
+        const PicaVSConfig config = std::get<0>(BuildVSConfigFromRaw(entry.raw));
+        impl->pending_vs.insert(config);
+        inject = [this, config, code = entry.decompiled->result.code](OGLProgram program) {
+            impl->pending_vs.erase(config);
+            if (program.handle != 0) {
+                impl->programmable_vertex_shaders.Inject(config, code, std::move(program));
             }
-            const auto& raw{raw_cache[i]};
-            const u64 unique_identifier{raw.GetUniqueIdentifier()};
-
-            bool sanitize_mul = false;
-            GLuint handle{0};
-            std::optional<ShaderDecompiler::ProgramResult> result;
-            // Otherwise decompile and build the shader at boot and save the result to the
-            // precompiled file
-            if (raw.GetProgramType() == ProgramType::VS) {
-                // TODO: This isn't the ideal place to lock, since we really only want to
-                // lock access to the shared cache
-                auto [conf, setup] = BuildVSConfigFromRaw(raw);
-                std::scoped_lock lock(mutex);
-                auto [h, r] = impl->programmable_vertex_shaders.Get(conf, setup);
-                handle = h;
-                result = std::move(r);
-                sanitize_mul = conf.state.sanitize_mul;
-            } else if (raw.GetProgramType() == ProgramType::FS) {
-                PicaFSConfig conf = PicaFSConfig::BuildFromRegs(raw.GetRawShaderConfig());
-                std::scoped_lock lock(mutex);
-                auto [h, r] = impl->fragment_shaders.Get(conf);
-                handle = h;
-                result = std::move(r);
-            } else {
-                // Unsupported shader type got stored somehow so nuke the cache
-                LOG_ERROR(Frontend, "failed to load raw programtype {}", raw.GetProgramType());
-                compilation_failed = true;
-                return;
+        };
+    } else {
+        const PicaFSConfig config = PicaFSConfig::BuildFromRegs(entry.raw.GetRawShaderConfig());
+        impl->pending_fs.insert(config);
+        inject = [this, config](OGLProgram program) {
+            impl->pending_fs.erase(config);
+            if (program.handle != 0) {
+                impl->fragment_shaders.Inject(config, std::move(program));
             }
-            if (handle == 0) {
-                LOG_ERROR(Frontend, "compilation from raw failed {:x} {:x}",
-                          raw.GetProgramCode().at(0), raw.GetProgramCode().at(1));
-                compilation_failed = true;
+        };
+    }
+
+    ++impl->num_disk_cache_jobs;
+    impl->async_compiler->QueueBinary(
+        entry.dump->binary_format, entry.dump->binary,
+        [this, index, inject](OGLProgram program, std::optional<ShaderDecompiler::ProgramResult>) {
+            --impl->num_disk_cache_jobs;
+            const bool linked = program.handle != 0;
+            inject(std::move(program));
+            if (linked) {
                 return;
             }
-            // If this is a new shader, add it the precompiled cache
-            if (result) {
-                disk_cache.SaveDecompiled(unique_identifier, *result, sanitize_mul);
-                disk_cache.SaveDump(unique_identifier, handle);
-                precompiled_cache_altered = true;
-            }
 
-            if (callback) {
-                callback(VideoCore::LoadCallbackStage::Build, i, raw_cache.size());
+            // If any shader failed, delete the precompiled cache and build the rest from raws
+            LOG_INFO(Render_OpenGL, "Precompiled cache rejected by the driver - removing");
+            if (!impl->precompiled_cache_rejected) {
+                impl->precompiled_cache_rejected = true;
+                impl->precompiled_cache_altered = true;
+                impl->disk_cache.InvalidatePrecompiled();
             }
-        }
-    };
-
-    LoadTransferable(0, raws.size(), raws);
-
-    if (compilation_failed) {
-        disk_cache.InvalidateAll();
-    }
+            impl->disk_cache_entries[index].loaded = false;
+            LoadDiskCacheEntry(index, false);
+        });
+}
 
-    if (precompiled_cache_altered) {
-        disk_cache.SaveVirtualPrecompiledFile();
+void ShaderProgramManager::FinishDiskCacheLoad() {
+    if (impl->precompiled_cache_altered) {
+        impl->disk_cache.SaveVirtualPrecompiledFile();
+        impl->precompiled_cache_altered = false;
     }
+    LOG_INFO(Render_OpenGL, "Finished loading {} disk cache entries",
+             impl->disk_cache_entries.size());
+
+    impl->disk_cache_entries = {};
+    impl->next_disk_cache_entry = 0;
+    impl->disk_cache_vs = {};
+    impl->disk_cache_fs = {};
+    impl->disk_cache_decompiled = {};
+    impl->disk_cache_dumps = {};
 }
 
 } // namespace OpenGL
@@ -5,10 +5,12 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <glad/glad.h>
 #include "video_core/rasterizer_interface.h"
 #include "video_core/regs_lighting.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_shader_decompiler.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
@@ -96,28 +98,86 @@ static_assert(
 static_assert(sizeof(VSUniformData) < 16384,
               "VSUniformData structure must be less than 16kb as per the OpenGL spec");
 
+struct GSUniformData {
+    PicaUniformsData uniforms;
+};
+static_assert(
+    sizeof(GSUniformData) == 1856,
+    "The size of the GSUniformData structure has changed, update the structure in the shader");
+
 /// A class that manage different shader stages and configures them with given config data.
 class ShaderProgramManager {
 public:
     ShaderProgramManager(bool separable, bool is_amd);
     ~ShaderProgramManager();
 
+    /**
+     * Reads the disk cache and queues its entries, most used first. They are loaded a few at a
+     * time while the game runs. callback only reports the reading, as the caller reports completion
+     * once this returns.
+     */
     void LoadDiskCache(const std::atomic_bool& stop_loading,
                        const VideoCore::DiskResourceLoadCallback& callback);
 
     bool UseProgrammableVertexShader(const Pica::Regs& config, Pica::Shader::ShaderSetup& setup);
 
+    /**
+     * Binds the vertex shader of the last successful UseProgrammableVertexShader call again,
+     * without building its config. The caller must know that no register it depends on has been
+     * written since. Returns false if the shader has to be looked up again.
+     */
+    bool UseLastProgrammableVertexShader();
+
     void UseTrivialVertexShader();
 
+    /// Returns false if the PICA geometry shader can't be translated, and must run on the CPU
+    bool UseProgrammableGeometryShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup);
+
     void UseFixedGeometryShader(const Pica::Regs& regs);
 
     void UseTrivialGeometryShader();
 
-    void UseFragmentShader(const Pica::Regs& config);
+    /**
+     * Returns false if the fragment shader is still being compiled in the background and the
+     * ubershader can't stand in for it
+     */
+    bool UseFragmentShader(const Pica::Regs& config);
+
+    /// Returns true if the last UseFragmentShader call bound the ubershader
+    bool IsUsingFragmentUbershader() const;
 
     void ApplyTo(OpenGLState& state);
 
 private:
+    /**
+     * Queues a shader on the async compiler. Shaders from the disk cache are saved to the
+     * precompiled file once built, new ones to the transferable file. The source is generated on
+     * the worker unless it was already generated by a previous session.
+     */
+    void QueueAsyncVertexShader(
+        const Pica::Regs& regs, const Pica::Shader::ShaderSetup& setup, const PicaVSConfig& config,
+        bool from_disk_cache = false,
+        std::optional<ShaderDecompiler::ProgramResult> source = std::nullopt);
+    void QueueAsyncFragmentShader(
+        const Pica::Regs& regs, const PicaFSConfig& config, bool from_disk_cache = false,
+        std::optional<ShaderDecompiler::ProgramResult> source = std::nullopt);
+
+    /**
+     * Queues the binary of a disk cache entry on the async compiler, so that the driver links it
+     * in the background. Entries whose binary is rejected are built from their raw config instead.
+     */
+    void QueuePrecompiledShader(std::size_t index);
+
+    /// Loads disk cache entries for a short time slice, at most once per frame interval
+    void StreamDiskCache();
+
+    /// Loads one disk cache entry. Programs missing from the precompiled file are built on the
+    /// async compiler unless sync is set, which is used when a draw needs the program right away.
+    void LoadDiskCacheEntry(std::size_t index, bool sync);
+
+    /// Writes the precompiled file once all disk cache entries are loaded
+    void FinishDiskCacheLoad();
+
     class Impl;
     std::unique_ptr<Impl> impl;
 };
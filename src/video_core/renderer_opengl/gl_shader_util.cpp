@@ -13,8 +13,8 @@
 
 namespace OpenGL {
 
-GLuint LoadShader(const char* source, GLenum type) {
-    const std::string version = GLES ? R"(#version 320 es
+static std::string GetShaderVersion() {
+    return GLES ? R"(#version 320 es
 
 #define CITRA_GLES
 
@@ -26,29 +26,35 @@ GLuint LoadShader(const char* source, GLenum type) {
 #extension GL_EXT_clip_cull_distance : enable
 #endif // defined(GL_EXT_clip_cull_distance)
 )"
-                                     : "#version 330\n";
+                : "#version 330\n";
+}
 
-    const char* debug_type;
+static const char* GetShaderDebugType(GLenum type) {
     switch (type) {
     case GL_VERTEX_SHADER:
-        debug_type = "vertex";
-        break;
+        return "vertex";
     case GL_GEOMETRY_SHADER:
-        debug_type = "geometry";
-        break;
+        return "geometry";
     case GL_FRAGMENT_SHADER:
-        debug_type = "fragment";
-        break;
+        return "fragment";
+    case GL_COMPUTE_SHADER:
+        return "compute";
     default:
         UNREACHABLE();
     }
+}
 
+GLuint StartShaderCompile(const char* source, GLenum type) {
+    const std::string version = GetShaderVersion();
     std::array<const char*, 2> src_arr{version.data(), source};
     GLuint shader_id = glCreateShader(type);
     glShaderSource(shader_id, static_cast<GLsizei>(src_arr.size()), src_arr.data(), nullptr);
-    LOG_DEBUG(Render_OpenGL, "Compiling {} shader...", debug_type);
+    LOG_DEBUG(Render_OpenGL, "Compiling {} shader...", GetShaderDebugType(type));
     glCompileShader(shader_id);
+    return shader_id;
+}
 
+bool CheckShaderCompile(GLuint shader_id, const char* source, GLenum type) {
     GLint result = GL_FALSE;
     GLint info_log_length;
     glGetShaderiv(shader_id, GL_COMPILE_STATUS, &result);
@@ -60,15 +66,21 @@ GLuint LoadShader(const char* source, GLenum type) {
         if (result == GL_TRUE) {
             LOG_DEBUG(Render_OpenGL, "{}", &shader_error[0]);
         } else {
-            LOG_ERROR(Render_OpenGL, "Error compiling {} shader:\n{}", debug_type,
+            LOG_ERROR(Render_OpenGL, "Error compiling {} shader:\n{}", GetShaderDebugType(type),
                       &shader_error[0]);
-            LOG_ERROR(Render_OpenGL, "Shader source code:\n{}{}", src_arr[0], src_arr[1]);
+            LOG_ERROR(Render_OpenGL, "Shader source code:\n{}{}", GetShaderVersion(), source);
         }
     }
+    return result == GL_TRUE;
+}
+
+GLuint LoadShader(const char* source, GLenum type) {
+    const GLuint shader_id = StartShaderCompile(source, type);
+    CheckShaderCompile(shader_id, source, type);
     return shader_id;
 }
 
-GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
+GLuint StartProgramLink(bool separable_program, const std::vector<GLuint>& shaders) {
     // Link the program
     LOG_DEBUG(Render_OpenGL, "Linking program...");
 
@@ -85,7 +97,10 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
     }
 
     glLinkProgram(program_id);
+    return program_id;
+}
 
+bool CheckProgramLink(GLuint program_id) {
     // Check the program
     GLint result = GL_FALSE;
     GLint info_log_length;
@@ -101,8 +116,13 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
             LOG_ERROR(Render_OpenGL, "Error linking shader:\n{}", &program_error[0]);
         }
     }
+    return result == GL_TRUE;
+}
 
-    ASSERT_MSG(result == GL_TRUE, "Shader not linked");
+GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
+    const GLuint program_id = StartProgramLink(separable_program, shaders);
+    const bool linked = CheckProgramLink(program_id);
+    ASSERT_MSG(linked, "Shader not linked");
 
     for (GLuint shader : shaders) {
         if (shader != 0) {
@@ -31,6 +31,25 @@ precision mediump uimage2D;
  */
 GLuint LoadShader(const char* source, GLenum type);
 
+/**
+ * Creates a shader and starts compiling it without waiting for the result, which must be checked
+ * with CheckShaderCompile. With KHR_parallel_shader_compile the driver compiles it in the
+ * background.
+ */
+GLuint StartShaderCompile(const char* source, GLenum type);
+
+/// Returns whether the shader compiled, logging the errors if it did not. Waits for the compile.
+bool CheckShaderCompile(GLuint shader_id, const char* source, GLenum type);
+
+/**
+ * Creates a program from the shaders and starts linking it without waiting for the result, which
+ * must be checked with CheckProgramLink. The shaders stay attached.
+ */
+GLuint StartProgramLink(bool separable_program, const std::vector<GLuint>& shaders);
+
+/// Returns whether the program linked, logging the errors if it did not. Waits for the link.
+bool CheckProgramLink(GLuint program_id);
+
 /**
  * Utility function to create and link an OpenGL GLSL shader program
  * @param separable_program whether to create a separable program
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <glad/glad.h>
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
@@ -10,7 +11,16 @@
 
 namespace OpenGL {
 
-OpenGLState OpenGLState::cur_state;
+INSTANCE_LOCAL OpenGLState OpenGLState::cur_state;
+
+/**
+ * Compares a group of fields at once, so that Apply can skip the groups a call did not change.
+ * Padding bytes may make equal groups compare different, the fields are then compared one by one.
+ */
+template <typename T>
+static bool Changed(const T& group, const T& current) {
+    return std::memcmp(&group, &current, sizeof(T)) != 0;
+}
 
 OpenGLState::OpenGLState() {
     // These all match default OpenGL values
@@ -90,42 +100,48 @@ OpenGLState::OpenGLState() {
     viewport.height = 0;
 
     clip_distance = {};
+
+    renderbuffer = 0;
 }
 
 void OpenGLState::Apply() const {
     // Culling
-    if (cull.enabled != cur_state.cull.enabled) {
-        if (cull.enabled) {
-            glEnable(GL_CULL_FACE);
-        } else {
-            glDisable(GL_CULL_FACE);
+    if (Changed(cull, cur_state.cull)) {
+        if (cull.enabled != cur_state.cull.enabled) {
+            if (cull.enabled) {
+                glEnable(GL_CULL_FACE);
+            } else {
+                glDisable(GL_CULL_FACE);
+            }
         }
-    }
 
-    if (cull.mode != cur_state.cull.mode) {
-        glCullFace(cull.mode);
-    }
+        if (cull.mode != cur_state.cull.mode) {
+            glCullFace(cull.mode);
+        }
 
-    if (cull.front_face != cur_state.cull.front_face) {
-        glFrontFace(cull.front_face);
+        if (cull.front_face != cur_state.cull.front_face) {
+            glFrontFace(cull.front_face);
+        }
     }
 
     // Depth test
-    if (depth.test_enabled != cur_state.depth.test_enabled) {
-        if (depth.test_enabled) {
-            glEnable(GL_DEPTH_TEST);
-        } else {
-            glDisable(GL_DEPTH_TEST);
+    if (Changed(depth, cur_state.depth)) {
+        if (depth.test_enabled != cur_state.depth.test_enabled) {
+            if (depth.test_enabled) {
+                glEnable(GL_DEPTH_TEST);
+            } else {
+                glDisable(GL_DEPTH_TEST);
+            }
         }
-    }
 
-    if (depth.test_func != cur_state.depth.test_func) {
-        glDepthFunc(depth.test_func);
-    }
+        if (depth.test_func != cur_state.depth.test_func) {
+            glDepthFunc(depth.test_func);
+        }
 
-    // Depth mask
-    if (depth.write_mask != cur_state.depth.write_mask) {
-        glDepthMask(depth.write_mask);
+        // Depth mask
+        if (depth.write_mask != cur_state.depth.write_mask) {
+            glDepthMask(depth.write_mask);
+        }
     }
 
     // Color mask
@@ -138,94 +154,119 @@ void OpenGLState::Apply() const {
     }
 
     // Stencil test
-    if (stencil.test_enabled != cur_state.stencil.test_enabled) {
-        if (stencil.test_enabled) {
-            glEnable(GL_STENCIL_TEST);
-        } else {
-            glDisable(GL_STENCIL_TEST);
+    if (Changed(stencil, cur_state.stencil)) {
+        if (stencil.test_enabled != cur_state.stencil.test_enabled) {
+            if (stencil.test_enabled) {
+                glEnable(GL_STENCIL_TEST);
+            } else {
+                glDisable(GL_STENCIL_TEST);
+            }
         }
-    }
 
-    if (stencil.test_func != cur_state.stencil.test_func ||
-        stencil.test_ref != cur_state.stencil.test_ref ||
-        stencil.test_mask != cur_state.stencil.test_mask) {
-        glStencilFunc(stencil.test_func, stencil.test_ref, stencil.test_mask);
-    }
+        if (stencil.test_func != cur_state.stencil.test_func ||
+            stencil.test_ref != cur_state.stencil.test_ref ||
+            stencil.test_mask != cur_state.stencil.test_mask) {
+            glStencilFunc(stencil.test_func, stencil.test_ref, stencil.test_mask);
+        }
 
-    if (stencil.action_depth_fail != cur_state.stencil.action_depth_fail ||
-        stencil.action_depth_pass != cur_state.stencil.action_depth_pass ||
-        stencil.action_stencil_fail != cur_state.stencil.action_stencil_fail) {
-        glStencilOp(stencil.action_stencil_fail, stencil.action_depth_fail,
-                    stencil.action_depth_pass);
-    }
+        if (stencil.action_depth_fail != cur_state.stencil.action_depth_fail ||
+            stencil.action_depth_pass != cur_state.stencil.action_depth_pass ||
+            stencil.action_stencil_fail != cur_state.stencil.action_stencil_fail) {
+            glStencilOp(stencil.action_stencil_fail, stencil.action_depth_fail,
+                        stencil.action_depth_pass);
+        }
 
-    // Stencil mask
-    if (stencil.write_mask != cur_state.stencil.write_mask) {
-        glStencilMask(stencil.write_mask);
+        // Stencil mask
+        if (stencil.write_mask != cur_state.stencil.write_mask) {
+            glStencilMask(stencil.write_mask);
+        }
     }
 
     // Blending
-    if (blend.enabled != cur_state.blend.enabled) {
-        if (blend.enabled) {
-            glEnable(GL_BLEND);
-        } else {
-            glDisable(GL_BLEND);
-        }
-
-        // GLES does not support glLogicOp
-        if (!GLES) {
+    if (Changed(blend, cur_state.blend) || logic_op != cur_state.logic_op) {
+        if (blend.enabled != cur_state.blend.enabled) {
             if (blend.enabled) {
-                glDisable(GL_COLOR_LOGIC_OP);
+                glEnable(GL_BLEND);
             } else {
-                glEnable(GL_COLOR_LOGIC_OP);
+                glDisable(GL_BLEND);
+            }
+
+            // GLES does not support glLogicOp
+            if (!GLES) {
+                if (blend.enabled) {
+                    glDisable(GL_COLOR_LOGIC_OP);
+                } else {
+                    glEnable(GL_COLOR_LOGIC_OP);
+                }
             }
         }
-    }
 
-    if (blend.color.red != cur_state.blend.color.red ||
-        blend.color.green != cur_state.blend.color.green ||
-        blend.color.blue != cur_state.blend.color.blue ||
-        blend.color.alpha != cur_state.blend.color.alpha) {
-        glBlendColor(blend.color.red, blend.color.green, blend.color.blue, blend.color.alpha);
-    }
+        if (blend.color.red != cur_state.blend.color.red ||
+            blend.color.green != cur_state.blend.color.green ||
+            blend.color.blue != cur_state.blend.color.blue ||
+            blend.color.alpha != cur_state.blend.color.alpha) {
+            glBlendColor(blend.color.red, blend.color.green, blend.color.blue, blend.color.alpha);
+        }
 
-    if (blend.src_rgb_func != cur_state.blend.src_rgb_func ||
-        blend.dst_rgb_func != cur_state.blend.dst_rgb_func ||
-        blend.src_a_func != cur_state.blend.src_a_func ||
-        blend.dst_a_func != cur_state.blend.dst_a_func) {
-        glBlendFuncSeparate(blend.src_rgb_func, blend.dst_rgb_func, blend.src_a_func,
-                            blend.dst_a_func);
-    }
+        if (blend.src_rgb_func != cur_state.blend.src_rgb_func ||
+            blend.dst_rgb_func != cur_state.blend.dst_rgb_func ||
+            blend.src_a_func != cur_state.blend.src_a_func ||
+            blend.dst_a_func != cur_state.blend.dst_a_func) {
+            glBlendFuncSeparate(blend.src_rgb_func, blend.dst_rgb_func, blend.src_a_func,
+                                blend.dst_a_func);
+        }
 
-    if (blend.rgb_equation != cur_state.blend.rgb_equation ||
-        blend.a_equation != cur_state.blend.a_equation) {
-        glBlendEquationSeparate(blend.rgb_equation, blend.a_equation);
-    }
+        if (blend.rgb_equation != cur_state.blend.rgb_equation ||
+            blend.a_equation != cur_state.blend.a_equation) {
+            glBlendEquationSeparate(blend.rgb_equation, blend.a_equation);
+        }
 
-    // GLES does not support glLogicOp
-    if (!GLES) {
-        if (logic_op != cur_state.logic_op) {
-            glLogicOp(logic_op);
+        // GLES does not support glLogicOp
+        if (!GLES) {
+            if (logic_op != cur_state.logic_op) {
+                glLogicOp(logic_op);
+            }
         }
     }
 
     // Textures
-    for (u32 i = 0; i < texture_units.size(); ++i) {
-        if (texture_units[i].texture_2d != cur_state.texture_units[i].texture_2d) {
-            glActiveTexture(TextureUnits::PicaTexture(i).Enum());
-            glBindTexture(GL_TEXTURE_2D, texture_units[i].texture_2d);
+    if (Changed(texture_units, cur_state.texture_units)) {
+        for (u32 i = 0; i < texture_units.size(); ++i) {
+            if (texture_units[i].texture_2d != cur_state.texture_units[i].texture_2d) {
+                glActiveTexture(TextureUnits::PicaTexture(i).Enum());
+                glBindTexture(GL_TEXTURE_2D, texture_units[i].texture_2d);
+            }
         }
-        if (texture_units[i].sampler != cur_state.texture_units[i].sampler) {
-            glBindSampler(i, texture_units[i].sampler);
+
+        // The PICA samplers use consecutive units, so they can be bound with a single call.
+        // Textures can't, glBindTextures fails for a texture that never was bound to a target.
+        if (GLAD_GL_ARB_multi_bind && !GLES) {
+            std::array<GLuint, 3> samplers;
+            bool samplers_changed = false;
+            for (u32 i = 0; i < texture_units.size(); ++i) {
+                samplers[i] = texture_units[i].sampler;
+                samplers_changed |= samplers[i] != cur_state.texture_units[i].sampler;
+            }
+            if (samplers_changed) {
+                glBindSamplers(0, static_cast<GLsizei>(samplers.size()), samplers.data());
+            }
+        } else {
+            for (u32 i = 0; i < texture_units.size(); ++i) {
+                if (texture_units[i].sampler != cur_state.texture_units[i].sampler) {
+                    glBindSampler(i, texture_units[i].sampler);
+                }
+            }
         }
     }
 
-    if (texture_cube_unit.texture_cube != cur_state.texture_cube_unit.texture_cube) {
-        glActiveTexture(TextureUnits::TextureCube.Enum());
-        glBindTexture(GL_TEXTURE_CUBE_MAP, texture_cube_unit.texture_cube);
-    }
-    if (texture_cube_unit.sampler != cur_state.texture_cube_unit.sampler) {
-        glBindSampler(TextureUnits::TextureCube.id, texture_cube_unit.sampler);
+    if (Changed(texture_cube_unit, cur_state.texture_cube_unit)) {
+        if (texture_cube_unit.texture_cube != cur_state.texture_cube_unit.texture_cube) {
+            glActiveTexture(TextureUnits::TextureCube.Enum());
+            glBindTexture(GL_TEXTURE_CUBE_MAP, texture_cube_unit.texture_cube);
+        }
+        if (texture_cube_unit.sampler != cur_state.texture_cube_unit.sampler) {
+            glBindSampler(TextureUnits::TextureCube.id, texture_cube_unit.sampler);
+        }
     }
 
     // Texture buffer LUTs
@@ -284,60 +325,62 @@ void OpenGLState::Apply() const {
     }
 
     // Framebuffer
-    if (draw.read_framebuffer != cur_state.draw.read_framebuffer) {
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, draw.read_framebuffer);
-    }
-    if (draw.draw_framebuffer != cur_state.draw.draw_framebuffer) {
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw.draw_framebuffer);
-    }
+    if (Changed(draw, cur_state.draw)) {
+        if (draw.read_framebuffer != cur_state.draw.read_framebuffer) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, draw.read_framebuffer);
+        }
+        if (draw.draw_framebuffer != cur_state.draw.draw_framebuffer) {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw.draw_framebuffer);
+        }
 
-    // Vertex array
-    if (draw.vertex_array != cur_state.draw.vertex_array) {
-        glBindVertexArray(draw.vertex_array);
-    }
+        // Vertex array
+        if (draw.vertex_array != cur_state.draw.vertex_array) {
+            glBindVertexArray(draw.vertex_array);
+        }
 
-    // Vertex buffer
-    if (draw.vertex_buffer != cur_state.draw.vertex_buffer) {
-        glBindBuffer(GL_ARRAY_BUFFER, draw.vertex_buffer);
-    }
+        // Vertex buffer
+        if (draw.vertex_buffer != cur_state.draw.vertex_buffer) {
+            glBindBuffer(GL_ARRAY_BUFFER, draw.vertex_buffer);
+        }
 
-    // Uniform buffer
-    if (draw.uniform_buffer != cur_state.draw.uniform_buffer) {
-        glBindBuffer(GL_UNIFORM_BUFFER, draw.uniform_buffer);
-    }
+        // Uniform buffer
+        if (draw.uniform_buffer != cur_state.draw.uniform_buffer) {
+            glBindBuffer(GL_UNIFORM_BUFFER, draw.uniform_buffer);
+        }
 
-    // Shader program
-    if (draw.shader_program != cur_state.draw.shader_program) {
-        glUseProgram(draw.shader_program);
-    }
+        // Shader program
+        if (draw.shader_program != cur_state.draw.shader_program) {
+            glUseProgram(draw.shader_program);
+        }
 
-    // Program pipeline
-    if (draw.program_pipeline != cur_state.draw.program_pipeline) {
-        glBindProgramPipeline(draw.program_pipeline);
+        // Program pipeline
+        if (draw.program_pipeline != cur_state.draw.program_pipeline) {
+            glBindProgramPipeline(draw.program_pipeline);
+        }
     }
 
     // Scissor test
-    if (scissor.enabled != cur_state.scissor.enabled) {
-        if (scissor.enabled) {
-            glEnable(GL_SCISSOR_TEST);
-        } else {
-            glDisable(GL_SCISSOR_TEST);
+    if (Changed(scissor, cur_state.scissor)) {
+        if (scissor.enabled != cur_state.scissor.enabled) {
+            if (scissor.enabled) {
+                glEnable(GL_SCISSOR_TEST);
+            } else {
+                glDisable(GL_SCISSOR_TEST);
+            }
         }
-    }
 
-    if (scissor.x != cur_state.scissor.x || scissor.y != cur_state.scissor.y ||
-        scissor.width != cur_state.scissor.width || scissor.height != cur_state.scissor.height) {
-        glScissor(scissor.x, scissor.y, scissor.width, scissor.height);
+        if (scissor.x != cur_state.scissor.x || scissor.y != cur_state.scissor.y ||
+            scissor.width != cur_state.scissor.width || scissor.height != cur_state.scissor.height) {
+            glScissor(scissor.x, scissor.y, scissor.width, scissor.height);
+        }
     }
 
-    if (viewport.x != cur_state.viewport.x || viewport.y != cur_state.viewport.y ||
-        viewport.width != cur_state.viewport.width ||
-        viewport.height != cur_state.viewport.height) {
+    if (Changed(viewport, cur_state.viewport)) {
         glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
     }
 
     // Clip distance
-    if (!GLES || GLAD_GL_EXT_clip_cull_distance) {
+    if (clip_distance != cur_state.clip_distance && (!GLES || GLAD_GL_EXT_clip_cull_distance)) {
         for (size_t i = 0; i < clip_distance.size(); ++i) {
             if (clip_distance[i] != cur_state.clip_distance[i]) {
                 if (clip_distance[i]) {
@@ -349,6 +392,11 @@ void OpenGLState::Apply() const {
         }
     }
 
+    // Renderbuffer
+    if (renderbuffer != cur_state.renderbuffer) {
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    }
+
     cur_state = *this;
 }
 
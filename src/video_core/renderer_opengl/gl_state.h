@@ -6,6 +6,7 @@
 
 #include <array>
 #include <glad/glad.h>
+#include "common/common_funcs.h"
 
 namespace OpenGL {
 
@@ -173,7 +174,7 @@ public:
     OpenGLState& ResetRenderbuffer(GLuint handle);
 
 private:
-    static OpenGLState cur_state;
+    static INSTANCE_LOCAL OpenGLState cur_state;
 };
 
 } // namespace OpenGL
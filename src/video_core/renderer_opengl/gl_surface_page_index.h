@@ -0,0 +1,185 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace OpenGL {
+
+/**
+ * Spatial index of cached surfaces that buckets them by the 4 KiB pages they touch. Each bucket is
+ * a flat vector sorted by surface address, so a lookup costs one hash probe per page touched and
+ * adding or removing a surface only allocates when a page gets its first surface.
+ *
+ * SurfacePtr is any pointer-like type to an object with addr and end members, which must not
+ * change while the surface is in the index.
+ */
+template <typename SurfacePtr>
+class SurfacePageIndex {
+public:
+    static constexpr u32 PAGE_BITS = 12;
+
+    bool Empty() const {
+        return pages.empty();
+    }
+
+    /// Returns an arbitrary surface of the index, which must not be empty
+    const SurfacePtr& Front() const {
+        ASSERT(!pages.empty());
+        return pages.begin()->second.front();
+    }
+
+    /**
+     * Adds the surface to every page it touches
+     * @param on_pages_cached Called with the address and size of each run of pages that did not
+     *                        hold any surface before
+     */
+    template <typename Func>
+    void Add(const SurfacePtr& surface, Func&& on_pages_cached) {
+        ForEachPageRun(surface, on_pages_cached, [this, &surface](u32 page) {
+            auto& bucket = pages[page];
+            const bool was_empty = bucket.empty();
+            bucket.insert(LowerBound(bucket, surface), surface);
+            return was_empty;
+        });
+    }
+
+    /**
+     * Removes the surface from every page it touches
+     * @param on_pages_uncached Called with the address and size of each run of pages that no
+     *                          longer hold any surface
+     */
+    template <typename Func>
+    void Remove(const SurfacePtr& surface, Func&& on_pages_uncached) {
+        ForEachPageRun(surface, on_pages_uncached, [this, &surface](u32 page) {
+            const auto bucket_it = pages.find(page);
+            ASSERT(bucket_it != pages.end());
+            auto& bucket = bucket_it->second;
+            const auto it = LowerBound(bucket, surface);
+            ASSERT(it != bucket.end() && *it == surface);
+            bucket.erase(it);
+            if (!bucket.empty()) {
+                return false;
+            }
+            pages.erase(bucket_it);
+            return true;
+        });
+    }
+
+    /// Removes all surfaces, calling on_pages_uncached for each run of pages that held any
+    template <typename Func>
+    void Clear(Func&& on_pages_uncached) {
+        std::vector<u32> used_pages;
+        used_pages.reserve(pages.size());
+        for (const auto& pair : pages) {
+            used_pages.push_back(pair.first);
+        }
+        std::sort(used_pages.begin(), used_pages.end());
+
+        for (std::size_t i = 0; i < used_pages.size();) {
+            std::size_t run_end = i + 1;
+            while (run_end < used_pages.size() &&
+                   used_pages[run_end] == used_pages[run_end - 1] + 1) {
+                ++run_end;
+            }
+            on_pages_uncached(used_pages[i] << PAGE_BITS,
+                              static_cast<u32>(run_end - i) << PAGE_BITS);
+            i = run_end;
+        }
+        pages.clear();
+    }
+
+    /**
+     * Calls func once for every surface overlapping [start, end). Surfaces spanning several pages
+     * are only reported from the first page of the range they touch. func must not modify the index.
+     */
+    template <typename Func>
+    void ForEachOverlapping(u32 start, u32 end, Func&& func) const {
+        if (start >= end) {
+            return;
+        }
+        const u32 first_page = start >> PAGE_BITS;
+        const u32 last_page = (end - 1) >> PAGE_BITS;
+
+        const auto visit_bucket = [&](u32 page, const std::vector<SurfacePtr>& bucket) {
+            for (const auto& surface : bucket) {
+                if (surface->addr >= end) {
+                    break;
+                }
+                if (surface->end <= start) {
+                    continue;
+                }
+                if (std::max(surface->addr >> PAGE_BITS, first_page) == page) {
+                    func(surface);
+                }
+            }
+        };
+
+        // Large ranges are cheaper to answer by walking the used pages instead of probing each one
+        if (last_page - first_page >= pages.size()) {
+            for (const auto& [page, bucket] : pages) {
+                if (page >= first_page && page <= last_page) {
+                    visit_bucket(page, bucket);
+                }
+            }
+            return;
+        }
+        for (u32 page = first_page; page <= last_page; ++page) {
+            const auto it = pages.find(page);
+            if (it != pages.end()) {
+                visit_bucket(page, it->second);
+            }
+        }
+    }
+
+private:
+    using Bucket = std::vector<SurfacePtr>;
+
+    static auto LowerBound(Bucket& bucket, const SurfacePtr& surface) {
+        return std::lower_bound(bucket.begin(), bucket.end(), surface,
+                                [](const SurfacePtr& lhs, const SurfacePtr& rhs) {
+                                    return std::make_pair(lhs->addr, &*lhs) <
+                                           std::make_pair(rhs->addr, &*rhs);
+                                });
+    }
+
+    /// Applies update to every page of the surface, reporting runs of pages it returned true for
+    template <typename Func, typename Update>
+    static void ForEachPageRun(const SurfacePtr& surface, Func& on_run, Update&& update) {
+        if (surface->addr >= surface->end) {
+            return;
+        }
+        const u32 first_page = surface->addr >> PAGE_BITS;
+        const u32 last_page = (surface->end - 1) >> PAGE_BITS;
+
+        u32 run_start = 0;
+        u32 run_length = 0;
+        for (u32 page = first_page; page <= last_page; ++page) {
+            if (update(page)) {
+                if (run_length == 0) {
+                    run_start = page;
+                }
+                ++run_length;
+                continue;
+            }
+            if (run_length != 0) {
+                on_run(run_start << PAGE_BITS, run_length << PAGE_BITS);
+                run_length = 0;
+            }
+        }
+        if (run_length != 0) {
+            on_run(run_start << PAGE_BITS, run_length << PAGE_BITS);
+        }
+    }
+
+    std::unordered_map<u32, Bucket> pages;
+};
+
+} // namespace OpenGL
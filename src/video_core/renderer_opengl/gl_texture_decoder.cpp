@@ -0,0 +1,312 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <fmt/format.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+namespace OpenGL {
+
+using PixelFormat = SurfaceParams::PixelFormat;
+
+namespace {
+
+constexpr std::string_view decode_comp = R"(
+layout(local_size_x = 64) in;
+
+layout(std430, binding = 0) readonly buffer Tiled {
+    uint tiled[];
+};
+
+layout(std430, binding = 1) writeonly buffer Texels {
+    uint texels[];
+};
+
+uniform int format;
+uniform uint tile_size;
+uniform uint gl_bytes_per_pixel;
+uniform uint rect_tiles_x;
+uniform uint num_tiles;
+uniform uint rect_height;
+uniform uint stride;
+
+const uint etc1_modifiers[16] =
+    uint[16](2u, 8u, 5u, 17u, 9u, 29u, 13u, 42u, 18u, 60u, 24u, 80u, 33u, 106u, 47u, 183u);
+
+uint ReadByte(uint offset) {
+    return (tiled[offset >> 2] >> ((offset & 3u) * 8u)) & 0xFFu;
+}
+
+uint Read16(uint offset) {
+    return ReadByte(offset) | (ReadByte(offset + 1u) << 8);
+}
+
+uint Read24(uint offset) {
+    return Read16(offset) | (ReadByte(offset + 2u) << 16);
+}
+
+uint Read32(uint offset) {
+    return Read24(offset) | (ReadByte(offset + 3u) << 24);
+}
+
+uint ByteSwap(uint value, uint num_bytes) {
+    uint swapped = 0u;
+    for (uint i = 0u; i < num_bytes; ++i) {
+        swapped |= ((value >> (8u * i)) & 0xFFu) << (8u * (num_bytes - 1u - i));
+    }
+    return swapped;
+}
+
+uint PackRGBA8(uint r, uint g, uint b, uint a) {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+uint MortonInterleave(uint x, uint y) {
+    return (x & 1u) | ((y & 1u) << 1) | ((x & 2u) << 1) | ((y & 2u) << 2) | ((x & 4u) << 2) |
+           ((y & 4u) << 3);
+}
+
+// Color of texel (x, y) of an ETC1 subtile, given as the low and high words of its 64 bits
+uvec3 DecodeETC1(uint lo, uint hi, uint x, uint y) {
+    uint texel = 4u * x + y;
+    bool flip = (hi & 1u) != 0u;
+    bool differential = (hi & 2u) != 0u;
+    bool second_half = (flip ? y : x) >= 2u;
+
+    ivec3 color;
+    if (differential) {
+        ivec3 base = ivec3(uvec3(hi >> 27, hi >> 19, hi >> 11) & 0x1Fu);
+        if (second_half) {
+            ivec3 delta = ivec3(uvec3(hi >> 24, hi >> 16, hi >> 8) & 7u);
+            base += delta - ivec3(greaterThanEqual(delta, ivec3(4))) * 8;
+        }
+        color = (base << 3) | (base >> 2);
+    } else {
+        uvec3 base = second_half ? (uvec3(hi >> 24, hi >> 16, hi >> 8) & 0xFu)
+                                 : (uvec3(hi >> 28, hi >> 20, hi >> 12) & 0xFu);
+        color = ivec3(base * 17u);
+    }
+
+    uint table_index = second_half ? ((hi >> 2) & 7u) : ((hi >> 5) & 7u);
+    int modifier = int(etc1_modifiers[table_index * 2u + ((lo >> texel) & 1u)]);
+    if (((lo >> (16u + texel)) & 1u) != 0u) {
+        modifier = -modifier;
+    }
+    return uvec3(clamp(color + modifier, 0, 255));
+}
+
+// Texel (x, y) of the tile at `base`, packed as the bytes the surface texture expects
+uint DecodeTexel(uint base, uint x, uint y) {
+    uint i = MortonInterleave(x, y);
+    switch (format) {
+    case RGBA8:
+#ifdef CITRA_GLES
+        return ByteSwap(Read32(base + i * 4u), 4u);
+#else
+        return Read32(base + i * 4u);
+#endif
+    case RGB8:
+#ifdef CITRA_GLES
+        return ByteSwap(Read24(base + i * 3u), 3u);
+#else
+        return Read24(base + i * 3u);
+#endif
+    case RGB5A1:
+    case RGB565:
+    case RGBA4:
+    case D16:
+        return Read16(base + i * 2u);
+    case D24:
+        return Read24(base + i * 3u) << 8;
+    case D24S8: {
+        uint value = Read32(base + i * 4u);
+        return (value << 8) | (value >> 24);
+    }
+    case IA8:
+        return PackRGBA8(ReadByte(base + i * 2u + 1u), ReadByte(base + i * 2u + 1u),
+                         ReadByte(base + i * 2u + 1u), ReadByte(base + i * 2u));
+    case RG8:
+        return PackRGBA8(ReadByte(base + i * 2u + 1u), ReadByte(base + i * 2u), 0u, 255u);
+    case I8:
+        return PackRGBA8(ReadByte(base + i), ReadByte(base + i), ReadByte(base + i), 255u);
+    case A8:
+        return PackRGBA8(0u, 0u, 0u, ReadByte(base + i));
+    case IA4: {
+        uint value = ReadByte(base + i);
+        uint intensity = (value >> 4) * 17u;
+        return PackRGBA8(intensity, intensity, intensity, (value & 0xFu) * 17u);
+    }
+    case I4: {
+        uint intensity = ((ReadByte(base + i / 2u) >> (4u * (i % 2u))) & 0xFu) * 17u;
+        return PackRGBA8(intensity, intensity, intensity, 255u);
+    }
+    case A4:
+        return PackRGBA8(0u, 0u, 0u, ((ReadByte(base + i / 2u) >> (4u * (i % 2u))) & 0xFu) * 17u);
+    case ETC1:
+    case ETC1A4: {
+        // Each 8x8 tile is made of four 4x4 subtiles
+        bool has_alpha = format == ETC1A4;
+        uint subtile = base + (x / 4u + 2u * (y / 4u)) * (has_alpha ? 16u : 8u);
+        uint sx = x % 4u;
+        uint sy = y % 4u;
+        uint alpha = 255u;
+        if (has_alpha) {
+            uint nibble = 4u * sx + sy;
+            uint packed_alpha = tiled[(subtile >> 2) + nibble / 8u];
+            alpha = ((packed_alpha >> (4u * (nibble % 8u))) & 0xFu) * 17u;
+            subtile += 8u;
+        }
+        uvec3 rgb = DecodeETC1(tiled[subtile >> 2], tiled[(subtile >> 2) + 1u], sx, sy);
+        return PackRGBA8(rgb.r, rgb.g, rgb.b, alpha);
+    }
+    }
+    return 0u;
+}
+
+void main() {
+    uint tile = gl_GlobalInvocationID.x;
+    if (tile >= num_tiles) {
+        return;
+    }
+    uint tile_x = tile % rect_tiles_x;
+    uint tile_y = tile / rect_tiles_x;
+    uint base = tile * tile_size;
+
+    for (uint y = 0u; y < 8u; ++y) {
+        // Tiles go down the surface while texture rows go up
+        uint row = rect_height - 1u - (tile_y * 8u + y);
+        uint row_word = (row * stride + tile_x * 8u) * gl_bytes_per_pixel / 4u;
+
+        uint words[8] = uint[8](0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u);
+        for (uint x = 0u; x < 8u; ++x) {
+            uint value = DecodeTexel(base, x, y);
+            for (uint i = 0u; i < gl_bytes_per_pixel; ++i) {
+                uint byte_offset = x * gl_bytes_per_pixel + i;
+                words[byte_offset / 4u] |= ((value >> (8u * i)) & 0xFFu)
+                                           << ((byte_offset % 4u) * 8u);
+            }
+        }
+        for (uint i = 0u; i < 2u * gl_bytes_per_pixel; ++i) {
+            texels[row_word + i] = words[i];
+        }
+    }
+}
+)";
+
+} // Anonymous namespace
+
+bool TextureDecoderOpenGL::IsSupported() {
+    if (GLES) {
+        return GLAD_GL_ES_VERSION_3_1;
+    }
+    return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object &&
+           GLAD_GL_ARB_shading_language_420pack;
+}
+
+TextureDecoderOpenGL::TextureDecoderOpenGL() {
+    // Desktop contexts are created as OpenGL 3.3, which only has compute shaders as extensions
+    std::string comp_source = GLES ? "" : R"(
+#extension GL_ARB_compute_shader : require
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+)";
+    for (const auto& [name, format] : {
+             std::pair{"RGBA8", PixelFormat::RGBA8},   std::pair{"RGB8", PixelFormat::RGB8},
+             std::pair{"RGB5A1", PixelFormat::RGB5A1}, std::pair{"RGB565", PixelFormat::RGB565},
+             std::pair{"RGBA4", PixelFormat::RGBA4},   std::pair{"IA8", PixelFormat::IA8},
+             std::pair{"RG8", PixelFormat::RG8},       std::pair{"I8", PixelFormat::I8},
+             std::pair{"A8", PixelFormat::A8},         std::pair{"IA4", PixelFormat::IA4},
+             std::pair{"I4", PixelFormat::I4},         std::pair{"A4", PixelFormat::A4},
+             std::pair{"ETC1", PixelFormat::ETC1},     std::pair{"ETC1A4", PixelFormat::ETC1A4},
+             std::pair{"D16", PixelFormat::D16},       std::pair{"D24", PixelFormat::D24},
+             std::pair{"D24S8", PixelFormat::D24S8},
+         }) {
+        comp_source += fmt::format("#define {} {}\n", name, static_cast<int>(format));
+    }
+    comp_source += decode_comp;
+
+    OGLShader comp;
+    comp.Create(comp_source.c_str(), GL_COMPUTE_SHADER);
+    program.Create(false, {comp.handle});
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program.handle, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+        LOG_WARNING(Render_OpenGL, "Texture decoder shader failed, textures will decode on CPU");
+        program.Release();
+        return;
+    }
+
+    format_location = glGetUniformLocation(program.handle, "format");
+    tile_size_location = glGetUniformLocation(program.handle, "tile_size");
+    gl_bytes_per_pixel_location = glGetUniformLocation(program.handle, "gl_bytes_per_pixel");
+    rect_tiles_x_location = glGetUniformLocation(program.handle, "rect_tiles_x");
+    num_tiles_location = glGetUniformLocation(program.handle, "num_tiles");
+    rect_height_location = glGetUniformLocation(program.handle, "rect_height");
+    stride_location = glGetUniformLocation(program.handle, "stride");
+
+    tiled_buffer.Create();
+    texel_buffer.Create();
+    LOG_INFO(Render_OpenGL, "Decoding tiled textures in a compute shader");
+}
+
+TextureDecoderOpenGL::~TextureDecoderOpenGL() = default;
+
+GLuint TextureDecoderOpenGL::Decode(const u8* source, PixelFormat format,
+                                    const Common::Rectangle<u32>& rect, u32 stride) {
+    ASSERT(IsAvailable());
+    ASSERT(rect.left % 8 == 0 && rect.GetWidth() % 8 == 0 && rect.GetHeight() % 8 == 0);
+
+    const u32 tile_size = SurfaceParams::GetFormatBpp(format) * 64 / 8;
+    const u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
+    const u32 rect_tiles_x = rect.GetWidth() / 8;
+    const u32 num_tiles = rect_tiles_x * (rect.GetHeight() / 8);
+    const auto tiled_size = static_cast<GLsizeiptr>(num_tiles) * tile_size;
+    const auto texel_size =
+        static_cast<GLsizeiptr>((rect.GetHeight() - 1) * stride + rect.GetWidth()) *
+        gl_bytes_per_pixel;
+
+    OpenGLState state = OpenGLState::GetCurState();
+    const OpenGLState prev_state = state;
+    state.draw.shader_program = program.handle;
+    state.Apply();
+
+    // Both buffers are orphaned, as earlier decodes may still be reading from them
+    tiled_buffer_size = std::max(tiled_buffer_size, tiled_size);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tiled_buffer.handle);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, tiled_buffer_size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, tiled_size, source);
+    texel_buffer_size = std::max(texel_buffer_size, texel_size);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, texel_buffer.handle);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, texel_buffer_size, nullptr, GL_STREAM_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, tiled_buffer.handle);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, texel_buffer.handle);
+    glUniform1i(format_location, static_cast<GLint>(format));
+    glUniform1ui(tile_size_location, tile_size);
+    glUniform1ui(gl_bytes_per_pixel_location, gl_bytes_per_pixel);
+    glUniform1ui(rect_tiles_x_location, rect_tiles_x);
+    glUniform1ui(num_tiles_location, num_tiles);
+    glUniform1ui(rect_height_location, rect.GetHeight());
+    glUniform1ui(stride_location, stride);
+    glDispatchCompute((num_tiles + 63) / 64, 1, 1);
+
+    // The texels are unpacked from the buffer into the surface texture next
+    glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+
+    prev_state.Apply();
+    return texel_buffer.handle;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,58 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_surface_params.h"
+
+namespace OpenGL {
+
+/**
+ * Uploads tiled surfaces by copying the raw bytes of 3DS memory to the GPU, where a compute shader
+ * undoes the Morton tiling and converts the texels to the layout of the surface texture. Texture
+ * formats, ETC1 included, are decoded to RGBA8. The CPU does no per-texel work.
+ */
+class TextureDecoderOpenGL : NonCopyable {
+public:
+    TextureDecoderOpenGL();
+    ~TextureDecoderOpenGL();
+
+    /// Returns true if the driver has the compute shaders the decoder needs
+    static bool IsSupported();
+
+    /// Returns true if the decoder shader was built
+    bool IsAvailable() const {
+        return program.handle != 0;
+    }
+
+    /**
+     * Decodes the tiles of `rect`, which must be made of whole tiles laid out contiguously in
+     * `source`. The texels are written to a buffer in the row layout of gl_buffer with the given
+     * stride, starting with the first texel of rect.
+     * @returns the buffer to unpack the texels of rect from, at offset 0
+     */
+    GLuint Decode(const u8* source, SurfaceParams::PixelFormat format,
+                  const Common::Rectangle<u32>& rect, u32 stride);
+
+private:
+    OGLProgram program;
+    OGLBuffer tiled_buffer;
+    OGLBuffer texel_buffer;
+    GLsizeiptr tiled_buffer_size = 0;
+    GLsizeiptr texel_buffer_size = 0;
+
+    GLint format_location{-1};
+    GLint tile_size_location{-1};
+    GLint gl_bytes_per_pixel_location{-1};
+    GLint rect_tiles_x_location{-1};
+    GLint num_tiles_location{-1};
+    GLint rect_height_location{-1};
+    GLint stride_location{-1};
+};
+
+} // namespace OpenGL
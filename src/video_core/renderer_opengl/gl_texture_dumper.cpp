@@ -0,0 +1,157 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <utility>
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/texture.h"
+#include "common/thread.h"
+#include "core/frontend/image_interface.h"
+#include "video_core/renderer_opengl/gl_texture_dumper.h"
+#include "video_core/renderer_opengl/texture_downloader_es.h"
+
+MICROPROFILE_DEFINE(OpenGL_TextureDumpWait, "OpenGL", "Texture Dump Wait", MP_RGB(192, 96, 64));
+MICROPROFILE_DEFINE(OpenGL_TextureDumpEncode, "OpenGL", "Texture Dump Encode",
+                    MP_RGB(192, 128, 64));
+
+namespace OpenGL {
+
+TextureDumper::TextureDumper(std::shared_ptr<Frontend::ImageInterface> image_interface,
+                             std::size_t num_workers)
+    : image_interface(std::move(image_interface)) {
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+TextureDumper::~TextureDumper() {
+    Collect(true);
+    {
+        std::scoped_lock lock{mutex};
+        stop = true;
+    }
+    job_queued.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TextureDumper::Dump(TextureDownloaderES& downloader, u32 width, u32 height,
+                         std::string path) {
+    if (readbacks.size() >= MAX_PENDING_READBACKS) {
+        MICROPROFILE_SCOPE(OpenGL_TextureDumpWait);
+        const Readback& oldest = readbacks.front();
+        while (glClientWaitSync(oldest.fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) ==
+               GL_TIMEOUT_EXPIRED) {
+        }
+    }
+    Poll();
+
+    Readback readback;
+    if (!free_buffers.empty()) {
+        readback.pack = std::move(free_buffers.back());
+        free_buffers.pop_back();
+    } else {
+        readback.pack.buffer.Create();
+    }
+
+    const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pack.buffer.handle);
+    if (size > readback.pack.size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        readback.pack.size = size;
+    }
+    downloader.GetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, height, width, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence.Create();
+    readback.width = width;
+    readback.height = height;
+    readback.path = std::move(path);
+    readbacks.push_back(std::move(readback));
+}
+
+void TextureDumper::Poll() {
+    Collect(false);
+}
+
+void TextureDumper::Collect(bool wait) {
+    while (!readbacks.empty()) {
+        Readback& readback = readbacks.front();
+        GLenum wait_result;
+        if (wait) {
+            MICROPROFILE_SCOPE(OpenGL_TextureDumpWait);
+            do {
+                wait_result = glClientWaitSync(readback.fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                               1000000000);
+            } while (wait_result == GL_TIMEOUT_EXPIRED);
+        } else {
+            wait_result = glClientWaitSync(readback.fence.handle, 0, 0);
+            if (wait_result == GL_TIMEOUT_EXPIRED) {
+                return;
+            }
+        }
+
+        EncodeJob job{{}, readback.width, readback.height, std::move(readback.path)};
+        const GLsizeiptr size = static_cast<GLsizeiptr>(job.width) * job.height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pack.buffer.handle);
+        const u8* data = wait_result == GL_WAIT_FAILED
+                             ? nullptr
+                             : static_cast<const u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                                       size, GL_MAP_READ_BIT));
+        if (data != nullptr) {
+            job.pixels.assign(data, data + size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        free_buffers.push_back(std::move(readback.pack));
+        readbacks.pop_front();
+
+        if (data == nullptr) {
+            LOG_ERROR(Render_OpenGL, "Failed to read back texture for {}", job.path);
+            continue;
+        }
+        Queue(std::move(job));
+    }
+}
+
+void TextureDumper::Queue(EncodeJob job) {
+    {
+        std::unique_lock lock{mutex};
+        job_taken.wait(lock, [this] { return encode_jobs.size() < MAX_QUEUED_ENCODES; });
+        encode_jobs.push_back(std::move(job));
+    }
+    job_queued.notify_one();
+}
+
+void TextureDumper::WorkerLoop() {
+    Common::SetCurrentThreadName("TextureDumper");
+    Common::SetCurrentThreadRole(Common::ThreadRole::Background);
+    while (true) {
+        EncodeJob job;
+        {
+            std::unique_lock lock{mutex};
+            job_queued.wait(lock, [this] { return stop || !encode_jobs.empty(); });
+            // Queued textures are still written when stopping
+            if (encode_jobs.empty()) {
+                break;
+            }
+            job = std::move(encode_jobs.front());
+            encode_jobs.pop_front();
+        }
+        job_taken.notify_one();
+
+        MICROPROFILE_SCOPE(OpenGL_TextureDumpEncode);
+        Common::FlipRGBA8Texture(job.pixels, job.width, job.height);
+        if (!image_interface->EncodePNG(job.path, job.pixels, job.width, job.height)) {
+            LOG_ERROR(Render_OpenGL, "Failed to save decoded texture");
+        }
+    }
+    Common::ClearCurrentThreadRole();
+}
+
+} // namespace OpenGL
@@ -0,0 +1,94 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Frontend {
+class ImageInterface;
+}
+
+namespace OpenGL {
+
+class TextureDownloaderES;
+
+/**
+ * Writes textures to PNG files without stalling the GL thread. Textures are read back into pixel
+ * pack buffers, which are collected once the GPU is done with them, and worker threads flip and
+ * encode the pixels.
+ */
+class TextureDumper : private NonCopyable {
+public:
+    TextureDumper(std::shared_ptr<Frontend::ImageInterface> image_interface,
+                  std::size_t num_workers);
+
+    /// Writes out everything that is still queued. GL thread only.
+    ~TextureDumper();
+
+    /**
+     * Starts reading back the first width x height texels of the texture bound to texture unit 0,
+     * which are written to path as RGBA8 once they arrive. GL thread only.
+     */
+    void Dump(TextureDownloaderES& downloader, u32 width, u32 height, std::string path);
+
+    /// Hands the finished readbacks to the encoders without waiting for the GPU. GL thread only.
+    void Poll();
+
+private:
+    /// Readbacks that may be in flight before Dump waits for the oldest
+    static constexpr std::size_t MAX_PENDING_READBACKS = 16;
+    /// Textures that may wait for an encoder before the GL thread waits for one to be free
+    static constexpr std::size_t MAX_QUEUED_ENCODES = 32;
+
+    struct PackBuffer {
+        OGLBuffer buffer;
+        GLsizeiptr size = 0;
+    };
+
+    struct Readback {
+        PackBuffer pack;
+        OGLSync fence;
+        u32 width;
+        u32 height;
+        std::string path;
+    };
+
+    struct EncodeJob {
+        std::vector<u8> pixels;
+        u32 width;
+        u32 height;
+        std::string path;
+    };
+
+    /// Collects the readbacks in order until one is not done, or all of them if wait is set
+    void Collect(bool wait);
+    void Queue(EncodeJob job);
+    void WorkerLoop();
+
+    std::shared_ptr<Frontend::ImageInterface> image_interface;
+
+    /// GL thread only
+    std::deque<Readback> readbacks;
+    std::vector<PackBuffer> free_buffers;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable job_queued;
+    std::condition_variable job_taken;
+    bool stop = false;
+    std::deque<EncodeJob> encode_jobs;
+};
+
+} // namespace OpenGL
@@ -2,8 +2,26 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <glad/glad.h>
 #include "video_core/renderer_opengl/gl_vars.h"
 
 namespace OpenGL {
 bool GLES;
+FramebufferFetch framebuffer_fetch = FramebufferFetch::None;
+bool texture_barrier = false;
+
+void DetectCapabilities() {
+    framebuffer_fetch = FramebufferFetch::None;
+    texture_barrier = false;
+    if (GLES) {
+        // Both are coherent, which the shadow and logic op emulation rely on
+        if (GLAD_GL_EXT_shader_framebuffer_fetch) {
+            framebuffer_fetch = FramebufferFetch::EXT;
+        } else if (GLAD_GL_ARM_shader_framebuffer_fetch) {
+            framebuffer_fetch = FramebufferFetch::ARM;
+        }
+    } else {
+        texture_barrier = GLAD_GL_ARB_texture_barrier || GLAD_GL_NV_texture_barrier;
+    }
 }
+} // namespace OpenGL
@@ -6,4 +6,14 @@
 
 namespace OpenGL {
 extern bool GLES;
-}
+
+/// Extension through which fragment shaders read the color attachment they write to
+enum class FramebufferFetch { None, EXT, ARM };
+extern FramebufferFetch framebuffer_fetch;
+
+/// Set if a texture barrier makes what earlier draws rendered visible to texture fetches
+extern bool texture_barrier;
+
+/// Detects the optional features above from the extensions of the current context
+void DetectCapabilities();
+} // namespace OpenGL
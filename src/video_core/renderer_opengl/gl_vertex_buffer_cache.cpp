@@ -0,0 +1,150 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include "common/hash.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+#include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vertex_buffer_cache.h"
+#include "video_core/video_core.h"
+
+namespace OpenGL {
+
+MICROPROFILE_DEFINE(OpenGL_VertexBufferUpload, "OpenGL", "Vertex Buffer Upload",
+                    MP_RGB(128, 192, 128));
+
+VertexBufferCache::VertexBufferCache(RasterizerCacheOpenGL& owner) : owner{owner} {}
+
+VertexBufferCache::~VertexBufferCache() = default;
+
+std::optional<VertexBufferCache::Binding> VertexBufferCache::Get(PAddr addr, u32 size) {
+    if (size < MinArraySize || size > MaxArraySize) {
+        return std::nullopt;
+    }
+    const PAddr end = addr + size;
+
+    auto it = FindFirstOverlapping(addr);
+    if (it != entries.end() && it->first <= addr && it->second.end >= end) {
+        it->second.last_used_frame = current_frame;
+        return Binding{it->second.buffer.handle, static_cast<GLintptr>(addr - it->first)};
+    }
+
+    // Arrays overlapping cached ones are merged with them, as draws often read sub-ranges of the
+    // same vertex buffer. Data that was already cached does not need to prove it is static.
+    PAddr start = addr;
+    PAddr stop = end;
+    for (auto overlap = it; overlap != entries.end() && overlap->first < stop; ++overlap) {
+        start = std::min(start, overlap->first);
+        stop = std::max(stop, overlap->second.end);
+    }
+    if (stop - start > MaxArraySize) {
+        return std::nullopt;
+    }
+
+    const u8* data = VideoCore::g_memory->GetPhysicalPointer(start);
+    if (data == nullptr) {
+        return std::nullopt;
+    }
+
+    if (start == addr && stop == end) {
+        auto candidate = candidates.find(addr);
+        if (candidate != candidates.end() && candidate->second.size == size &&
+            candidate->second.frame == current_frame) {
+            return std::nullopt;
+        }
+        const u64 hash = Common::ComputeFastHash64(data, size);
+        if (candidate == candidates.end() || candidate->second.size != size ||
+            candidate->second.hash != hash) {
+            candidates[addr] = {size, hash, current_frame};
+            return std::nullopt;
+        }
+        candidates.erase(candidate);
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_VertexBufferUpload);
+    while (it != entries.end() && it->first < stop) {
+        it = Remove(it);
+    }
+
+    Entry entry{stop, {}, current_frame};
+    entry.buffer.Create();
+    OpenGLState state = OpenGLState::GetCurState();
+    state.draw.vertex_buffer = entry.buffer.handle;
+    state.Apply();
+    glBufferData(GL_ARRAY_BUFFER, stop - start, data, GL_STATIC_DRAW);
+
+    const GLuint handle = entry.buffer.handle;
+    entries.emplace(start, std::move(entry));
+    memory += stop - start;
+    owner.UpdatePagesCachedCount(start, stop - start, 1);
+    return Binding{handle, static_cast<GLintptr>(addr - start)};
+}
+
+void VertexBufferCache::InvalidateRegion(PAddr addr, u32 size) {
+    const PAddr end = addr + size;
+    auto it = FindFirstOverlapping(addr);
+    while (it != entries.end() && it->first < end) {
+        it = Remove(it);
+    }
+}
+
+void VertexBufferCache::Clear() {
+    auto it = entries.begin();
+    while (it != entries.end()) {
+        it = Remove(it);
+    }
+    candidates.clear();
+}
+
+void VertexBufferCache::TickFrame() {
+    current_frame++;
+
+    // Candidates that were not seen again in the frame after they were added changed or are gone
+    for (auto it = candidates.begin(); it != candidates.end();) {
+        if (it->second.frame + 1 < current_frame) {
+            it = candidates.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (memory <= CacheBudget) {
+        return;
+    }
+    std::vector<EntryMap::iterator> by_age;
+    by_age.reserve(entries.size());
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        by_age.push_back(it);
+    }
+    std::sort(by_age.begin(), by_age.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs->second.last_used_frame < rhs->second.last_used_frame;
+    });
+    for (const auto& it : by_age) {
+        if (memory <= CacheBudget) {
+            break;
+        }
+        Remove(it);
+    }
+}
+
+VertexBufferCache::EntryMap::iterator VertexBufferCache::FindFirstOverlapping(PAddr addr) {
+    auto it = entries.upper_bound(addr);
+    if (it != entries.begin() && std::prev(it)->second.end > addr) {
+        --it;
+    }
+    return it;
+}
+
+VertexBufferCache::EntryMap::iterator VertexBufferCache::Remove(EntryMap::iterator it) {
+    const u32 size = it->second.end - it->first;
+    owner.UpdatePagesCachedCount(it->first, size, -1);
+    memory -= size;
+    return entries.erase(it);
+}
+
+} // namespace OpenGL
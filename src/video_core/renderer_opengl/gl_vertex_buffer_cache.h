@@ -0,0 +1,88 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+class RasterizerCacheOpenGL;
+
+/**
+ * Keeps the vertex arrays of accelerated draws in GPU buffers, so that the arrays a game draws
+ * again and again are not copied out of 3DS memory on every draw. The pages of the cached arrays
+ * are marked as cached through the surface cache, so CPU writes to them invalidate the arrays like
+ * they do surfaces.
+ */
+class VertexBufferCache : NonCopyable {
+public:
+    explicit VertexBufferCache(RasterizerCacheOpenGL& owner);
+    ~VertexBufferCache();
+
+    /// Arrays smaller than this are cheaper to stream than to track
+    static constexpr u32 MinArraySize = 4 * 1024;
+    /// Arrays larger than this are always streamed
+    static constexpr u32 MaxArraySize = 4 * 1024 * 1024;
+    /// Buffer memory the cached arrays may use before the least recently used are evicted
+    static constexpr std::size_t CacheBudget = 64 * 1024 * 1024;
+
+    struct Binding {
+        GLuint buffer;
+        GLintptr offset;
+    };
+
+    /**
+     * Looks up the buffer holding the vertex data at [addr, addr + size), uploading it on a miss.
+     * Arrays are only cached once they were read unchanged in two consecutive frames, so that the
+     * data games rewrite every frame keeps being streamed. The region must have been flushed.
+     * @returns the buffer and the offset of addr in it, or nullopt if the data should be streamed
+     */
+    std::optional<Binding> Get(PAddr addr, u32 size);
+
+    /// Drops the arrays overlapping the region
+    void InvalidateRegion(PAddr addr, u32 size);
+
+    /// Drops all arrays
+    void Clear();
+
+    /// Called once per frame. Evicts the arrays used least recently while over CacheBudget.
+    void TickFrame();
+
+private:
+    struct Entry {
+        PAddr end;
+        OGLBuffer buffer;
+        u64 last_used_frame;
+    };
+
+    /// An array seen once, which is cached if it is read again in the next frame
+    struct Candidate {
+        u32 size;
+        u64 hash;
+        u64 frame;
+    };
+
+    using EntryMap = std::map<PAddr, Entry>;
+
+    /// Returns the first entry that ends after addr
+    EntryMap::iterator FindFirstOverlapping(PAddr addr);
+
+    EntryMap::iterator Remove(EntryMap::iterator it);
+
+    RasterizerCacheOpenGL& owner;
+    /// Cached arrays by start address. Entries never overlap.
+    EntryMap entries;
+    std::unordered_map<PAddr, Candidate> candidates;
+    std::size_t memory = 0;
+    u64 current_frame = 0;
+};
+
+} // namespace OpenGL
@@ -3,9 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdlib>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -13,6 +20,7 @@
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/dumping/backend.h"
+#include "core/frame_counters.h"
 #include "core/frontend/emu_window.h"
 #include "core/frontend/framebuffer_layout.h"
 #include "core/hw/gpu.h"
@@ -29,8 +37,88 @@
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
 
+namespace Frontend {
+
+struct Frame {
+    u32 width = 0;
+    u32 height = 0;
+    bool color_reloaded = false;   ///< The present thread has to reattach color
+    OpenGL::OGLRenderbuffer color; ///< Shared between the contexts
+    OpenGL::OGLFramebuffer render; ///< Emulation thread framebuffer
+    GLuint present = 0;            ///< Present thread framebuffer
+    OpenGL::OGLSync render_fence;  ///< Signaled when the frame has been drawn
+    OpenGL::OGLSync present_fence; ///< Signaled when the frame has been presented
+};
+
+} // namespace Frontend
+
 namespace OpenGL {
 
+/**
+ * Triple buffered mailbox: one frame is presented, one is drawn and one is queued or free. The
+ * threads only wait on each other through GL fences, on the GPU.
+ */
+class OGLTextureMailbox : public Frontend::TextureMailbox {
+public:
+    OGLTextureMailbox() {
+        for (auto& frame : frames) {
+            free_queue.push_back(&frame);
+        }
+    }
+
+    Frontend::Frame* GetRenderFrame() override {
+        Frontend::Frame* frame;
+        {
+            std::scoped_lock lock{mutex};
+            // At most one frame is queued and one presented, so there is always a free one
+            frame = free_queue.front();
+            free_queue.pop_front();
+        }
+
+        // Don't overwrite the frame while the present thread may still read it
+        if (frame->present_fence.handle) {
+            glWaitSync(frame->present_fence.handle, 0, GL_TIMEOUT_IGNORED);
+            frame->present_fence.Release();
+        }
+        return frame;
+    }
+
+    void ReleaseRenderFrame(Frontend::Frame* frame) override {
+        {
+            std::scoped_lock lock{mutex};
+            // Latest frame wins, the one that was never presented is recycled
+            if (!present_queue.empty()) {
+                free_queue.push_back(present_queue.front());
+                present_queue.pop_front();
+            }
+            present_queue.push_back(frame);
+        }
+        present_cv.notify_one();
+    }
+
+    Frontend::Frame* TryGetPresentFrame(int timeout_ms) override {
+        std::unique_lock lock{mutex};
+        present_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                            [this] { return !present_queue.empty(); });
+        if (!present_queue.empty()) {
+            if (present_frame) {
+                free_queue.push_back(present_frame);
+            }
+            present_frame = present_queue.front();
+            present_queue.pop_front();
+        }
+        return present_frame;
+    }
+
+private:
+    std::array<Frontend::Frame, 3> frames;
+    std::mutex mutex;
+    std::condition_variable present_cv;
+    std::deque<Frontend::Frame*> free_queue;
+    std::deque<Frontend::Frame*> present_queue;
+    Frontend::Frame* present_frame = nullptr; ///< Owned by the present thread
+};
+
 static const char vertex_shader[] = R"(
 in vec2 vert_position;
 in vec2 vert_tex_coord;
@@ -122,6 +210,7 @@ void main() {
  * Vertex structure that the drawn screen rectangles are composed of.
  */
 struct ScreenRectVertex {
+    ScreenRectVertex() = default;
     ScreenRectVertex(GLfloat x, GLfloat y, GLfloat u, GLfloat v) {
         position[0] = x;
         position[1] = y;
@@ -152,17 +241,39 @@ static std::array<GLfloat, 3 * 2> MakeOrthographicMatrix(const float width, cons
     return matrix;
 }
 
+/// 3x5 pixel glyphs of the digits, one bit per pixel from the top-left, for the counter overlay
+static constexpr std::array<u16, 10> digit_glyphs{0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9,
+                                                  0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF};
+
+/// Colors of the swatches that identify the rows of the counter overlay, in FrameCounter order
+static constexpr std::array<std::array<GLfloat, 3>, Core::NumFrameCounters> counter_colors{{
+    {1.0f, 1.0f, 1.0f}, // Draws
+    {1.0f, 0.2f, 0.2f}, // Surface cache misses
+    {1.0f, 0.6f, 0.0f}, // Texture uploads
+    {0.8f, 0.4f, 1.0f}, // LUT uploads
+    {1.0f, 1.0f, 0.0f}, // Shader compiles
+    {0.2f, 0.9f, 0.2f}, // SVCs
+    {0.3f, 0.6f, 1.0f}, // IPC requests
+}};
+
 RendererOpenGL::RendererOpenGL(Frontend::EmuWindow& window) : RendererBase{window} {}
 RendererOpenGL::~RendererOpenGL() = default;
 
 /// Swap buffers (render frame)
 void RendererOpenGL::SwapBuffers() {
+    if (frame_skip_position != 0) {
+        SkipFrame();
+        return;
+    }
+
     // Maintain the rasterizer's state as a priority
     OpenGLState prev_state = OpenGLState::GetCurState();
     state.Apply();
 
     render_window.SetupFramebuffer();
 
+    // Set while every screen still shows the same, unwritten surface region as the last frame
+    bool screens_repeated = true;
     for (int i : {0, 1, 2}) {
         int fb_id = i == 2 ? 1 : 0;
         const auto& framebuffer = GPU::g_regs.framebuffer_config[fb_id];
@@ -181,7 +292,12 @@ void RendererOpenGL::SwapBuffers() {
             // Resize the texture in case the framebuffer size has changed
             screen_infos[i].texture.width = 1;
             screen_infos[i].texture.height = 1;
+            screens_repeated = false;
         } else {
+            const GLuint last_texture = screen_infos[i].display_texture;
+            const Common::Rectangle<float> last_texcoords = screen_infos[i].display_texcoords;
+            const u64 last_write_tick = screen_infos[i].display_write_tick;
+
             if (screen_infos[i].texture.width != (GLsizei)framebuffer.width ||
                 screen_infos[i].texture.height != (GLsizei)framebuffer.height ||
                 screen_infos[i].texture.format != framebuffer.color_format) {
@@ -195,8 +311,21 @@ void RendererOpenGL::SwapBuffers() {
             // Resize the texture in case the framebuffer size has changed
             screen_infos[i].texture.width = framebuffer.width;
             screen_infos[i].texture.height = framebuffer.height;
+
+            const ScreenInfo& screen = screen_infos[i];
+            screens_repeated &= screen.display_write_tick != 0 &&
+                                screen.display_write_tick == last_write_tick &&
+                                screen.display_texture == last_texture &&
+                                screen.display_texcoords == last_texcoords;
         }
     }
+    // Pending changes to how the screens are drawn need them to be drawn again
+    screens_repeated &= !VideoCore::g_renderer_bg_color_update_requested &&
+                        !VideoCore::g_renderer_sampler_update_requested &&
+                        !VideoCore::g_renderer_shader_update_requested;
+
+    // The screens may hold on to surfaces, so evict only once they have been loaded
+    Rasterizer()->TickFrame();
 
     if (VideoCore::g_renderer_screenshot_requested) {
         // Draw this frame to the screenshot framebuffer
@@ -240,34 +369,67 @@ void RendererOpenGL::SwapBuffers() {
         }
 
         const auto& layout = Core::System::GetInstance().VideoDumper().GetLayout();
+        // Repeats go through the slots too, so that the frames reach the dumper in order
+        const bool repeat = screens_repeated && dumped_frame_read;
         glBindFramebuffer(GL_READ_FRAMEBUFFER, frame_dumping_framebuffer.handle);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frame_dumping_framebuffer.handle);
-        DrawScreens(layout);
+        if (!repeat) {
+            DrawScreens(layout);
+        }
 
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, frame_dumping_pbos[current_pbo].handle);
-        glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, 0);
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, frame_dumping_pbos[next_pbo].handle);
+        if (pending_pbos == frame_dumping_pbos.size() && !PopDumpedFrame(layout, true)) {
+            // Every PBO is still in use and the oldest frame did not arrive in time, drop it
+            frame_dumping_fences[next_pbo].Release();
+            pending_pbos--;
+            LOG_WARNING(Render, "Dumped frame dropped: read back timed out");
+        }
+        frame_dumping_repeats[next_pbo] = repeat;
+        if (!repeat) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, frame_dumping_pbos[next_pbo].handle);
+            glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
+                         0);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            frame_dumping_fences[next_pbo].Create();
+            dumped_frame_read = true;
+        }
+        next_pbo = (next_pbo + 1) % frame_dumping_pbos.size();
+        pending_pbos++;
 
-        GLubyte* pixels = static_cast<GLubyte*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
-        VideoDumper::VideoFrame frame_data{layout.width, layout.height, pixels};
-        Core::System::GetInstance().VideoDumper().AddVideoFrame(frame_data);
+        // Hand off the frames the GPU is done with
+        while (pending_pbos > 0 && PopDumpedFrame(layout, false)) {
+        }
 
-        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
         glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-        current_pbo = (current_pbo + 1) % 2;
-        next_pbo = (current_pbo + 1) % 2;
     }
 
-    DrawScreens(render_window.GetFramebufferLayout());
+    // A repeated frame is neither composited nor presented. The window keeps showing the last
+    // one, which also lets VRR displays wait for the next new frame instead of refreshing.
+    const auto& window_layout = render_window.GetFramebufferLayout();
+    const bool present = !screens_repeated || Settings::values.show_frame_counters ||
+                         !composition_key ||
+                         !(*composition_key == MakeCompositionKey(window_layout));
+    if (present && render_window.mailbox) {
+        DrawToMailbox(window_layout);
+    } else if (present) {
+        DrawScreens(window_layout);
+        DrawFrameCounters(window_layout);
+    }
     m_current_frame++;
 
     Core::System::GetInstance().perf_stats->EndSystemFrame();
 
-    // Swap buffers
-    render_window.PollEvents();
-    render_window.SwapBuffers();
+    if (present) {
+        // Swap buffers
+        const auto present_start = Core::PerfStats::Clock::now();
+        render_window.PollEvents();
+        render_window.SwapBuffers();
+        Core::System::GetInstance().perf_stats->RecordPresentTime(
+            Core::PerfStats::Clock::now() - present_start);
+    } else {
+        render_window.PollEvents();
+        render_window.SkipFrame();
+    }
 
     Core::System::GetInstance().frame_limiter.DoFrameLimiting(
         Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
@@ -279,6 +441,38 @@ void RendererOpenGL::SwapBuffers() {
     if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
         Pica::g_debug_context->recorder->FrameFinished();
     }
+    UpdateFrameSkip();
+}
+
+void RendererOpenGL::SkipFrame() {
+    OpenGLState prev_state = OpenGLState::GetCurState();
+    state.Apply();
+    Rasterizer()->TickFrame();
+    m_current_frame++;
+
+    auto& system = Core::System::GetInstance();
+    system.perf_stats->EndSystemFrame();
+    render_window.PollEvents();
+    render_window.SkipFrame();
+    system.frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
+    system.perf_stats->BeginSystemFrame();
+
+    prev_state.Apply();
+    RefreshRasterizerSetting();
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->FrameFinished();
+    }
+    UpdateFrameSkip();
+}
+
+void RendererOpenGL::UpdateFrameSkip() {
+    // Dumped videos keep every frame
+    const u32 frame_skip = Settings::values.frame_skip;
+    const bool fast_forward = frame_skip != 0 && render_window.IsFastForwarding() &&
+                              !Core::System::GetInstance().VideoDumper().IsDumping();
+    frame_skip_position = fast_forward ? (frame_skip_position + 1) % (frame_skip + 1) : 0;
+    Rasterizer()->SetFrameSkipped(frame_skip_position != 0);
 }
 
 /**
@@ -314,6 +508,7 @@ void RendererOpenGL::LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& fram
         // Reset the screen info's display texture to its own permanent texture
         screen_info.display_texture = screen_info.texture.resource.handle;
         screen_info.display_texcoords = Common::Rectangle<float>(0.f, 0.f, 1.f, 1.f);
+        screen_info.display_write_tick = 0;
 
         Memory::RasterizerFlushRegion(framebuffer_addr, framebuffer.stride * framebuffer.height);
 
@@ -384,7 +579,8 @@ void RendererOpenGL::InitOpenGLObjects() {
     state.Apply();
 
     // Attach vertex data to VAO
-    glBufferData(GL_ARRAY_BUFFER, sizeof(ScreenRectVertex) * 4, nullptr, GL_STREAM_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(ScreenRectVertex) * 4 * MaxScreenQuads, nullptr,
+                 GL_DYNAMIC_DRAW);
     glVertexAttribPointer(attrib_position, 2, GL_FLOAT, GL_FALSE, sizeof(ScreenRectVertex),
                           (GLvoid*)offsetof(ScreenRectVertex, position));
     glVertexAttribPointer(attrib_tex_coord, 2, GL_FLOAT, GL_FALSE, sizeof(ScreenRectVertex),
@@ -559,143 +755,186 @@ void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
     state.Apply();
 }
 
-/**
- * Draws a single texture to the emulator window, rotating the texture to correct for the 3DS's LCD
- * rotation.
- */
-void RendererOpenGL::DrawSingleScreenRotated(const ScreenInfo& screen_info, float x, float y,
-                                             float w, float h) {
-    const auto& texcoords = screen_info.display_texcoords;
-
-    const std::array<ScreenRectVertex, 4> vertices = {{
-        ScreenRectVertex(x, y, texcoords.bottom, texcoords.left),
-        ScreenRectVertex(x + w, y, texcoords.bottom, texcoords.right),
-        ScreenRectVertex(x, y + h, texcoords.top, texcoords.left),
-        ScreenRectVertex(x + w, y + h, texcoords.top, texcoords.right),
-    }};
-
-    // As this is the "DrawSingleScreenRotated" function, the output resolution dimensions have been
-    // swapped. If a non-rotated draw-screen function were to be added for book-mode games, those
-    // should probably be set to the standard (w, h, 1.0 / w, 1.0 / h) ordering.
-    const u16 scale_factor = VideoCore::GetResolutionScaleFactor();
-    glUniform4f(uniform_i_resolution, static_cast<float>(screen_info.texture.width * scale_factor),
-                static_cast<float>(screen_info.texture.height * scale_factor),
-                1.0f / static_cast<float>(screen_info.texture.width * scale_factor),
-                1.0f / static_cast<float>(screen_info.texture.height * scale_factor));
-    glUniform4f(uniform_o_resolution, h, w, 1.0f / h, 1.0f / w);
-    state.texture_units[0].texture_2d = screen_info.display_texture;
-    state.texture_units[0].sampler = filter_sampler.handle;
-    state.Apply();
-
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices.data());
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+bool RendererOpenGL::CompositionKey::operator==(const CompositionKey& other) const {
+    const auto rect_tie = [](const auto& rect) {
+        return std::tie(rect.left, rect.top, rect.right, rect.bottom);
+    };
+    const auto layout_tie = [&](const Layout::FramebufferLayout& l) {
+        return std::tuple_cat(std::tie(l.width, l.height, l.top_screen_enabled,
+                                       l.bottom_screen_enabled, l.is_rotated,
+                                       l.cardboard.top_screen_right_eye,
+                                       l.cardboard.bottom_screen_right_eye),
+                              rect_tie(l.top_screen), rect_tie(l.bottom_screen));
+    };
+    return layout_tie(layout) == layout_tie(other.layout) && render_3d == other.render_3d &&
+           std::equal(texcoords.begin(), texcoords.end(), other.texcoords.begin(),
+                      other.texcoords.end(), [&](const auto& a, const auto& b) {
+                          return rect_tie(a) == rect_tie(b);
+                      });
+}
 
-    state.texture_units[0].texture_2d = 0;
-    state.texture_units[0].sampler = 0;
-    state.Apply();
+RendererOpenGL::CompositionKey RendererOpenGL::MakeCompositionKey(
+    const Layout::FramebufferLayout& layout) const {
+    CompositionKey key{layout, Settings::values.render_3d, {}};
+    for (std::size_t i = 0; i < screen_infos.size(); ++i) {
+        key.texcoords[i] = screen_infos[i].display_texcoords;
+    }
+    return key;
 }
 
-void RendererOpenGL::DrawSingleScreen(const ScreenInfo& screen_info, float x, float y, float w,
-                                      float h) {
-    const auto& texcoords = screen_info.display_texcoords;
+/**
+ * Builds the vertices of every screen quad of the layout into the vertex buffer. This only runs
+ * when the layout, the stereo mode or the region of a screen texture that is displayed changes.
+ */
+void RendererOpenGL::UpdateComposition(const Layout::FramebufferLayout& layout) {
+    const CompositionKey key = MakeCompositionKey(layout);
+    if (composition_key && *composition_key == key) {
+        return;
+    }
+    composition_key = key;
 
-    const std::array<ScreenRectVertex, 4> vertices = {{
-        ScreenRectVertex(x, y, texcoords.bottom, texcoords.right),
-        ScreenRectVertex(x + w, y, texcoords.top, texcoords.right),
-        ScreenRectVertex(x, y + h, texcoords.bottom, texcoords.left),
-        ScreenRectVertex(x + w, y + h, texcoords.top, texcoords.left),
-    }};
+    std::array<ScreenRectVertex, 4 * MaxScreenQuads> vertices{};
+    screen_quads.clear();
 
-    const u16 scale_factor = VideoCore::GetResolutionScaleFactor();
-    glUniform4f(uniform_i_resolution, static_cast<float>(screen_info.texture.width * scale_factor),
-                static_cast<float>(screen_info.texture.height * scale_factor),
-                1.0f / static_cast<float>(screen_info.texture.width * scale_factor),
-                1.0f / static_cast<float>(screen_info.texture.height * scale_factor));
-    glUniform4f(uniform_o_resolution, w, h, 1.0f / w, 1.0f / h);
-    state.texture_units[0].texture_2d = screen_info.display_texture;
-    state.texture_units[0].sampler = filter_sampler.handle;
-    state.Apply();
+    const auto add_quad = [&](std::size_t screen_l, std::size_t screen_r, GLint layer, float x,
+                              float y, float w, float h) {
+        const auto& texcoords = screen_infos[screen_l].display_texcoords;
+        const std::size_t first = screen_quads.size() * 4;
+        // The 3DS LCDs are rotated, so the texture is drawn rotated unless the layout is upright
+        if (layout.is_rotated) {
+            vertices[first] = ScreenRectVertex(x, y, texcoords.bottom, texcoords.left);
+            vertices[first + 1] = ScreenRectVertex(x + w, y, texcoords.bottom, texcoords.right);
+            vertices[first + 2] = ScreenRectVertex(x, y + h, texcoords.top, texcoords.left);
+            vertices[first + 3] = ScreenRectVertex(x + w, y + h, texcoords.top, texcoords.right);
+        } else {
+            vertices[first] = ScreenRectVertex(x, y, texcoords.bottom, texcoords.right);
+            vertices[first + 1] = ScreenRectVertex(x + w, y, texcoords.top, texcoords.right);
+            vertices[first + 2] = ScreenRectVertex(x, y + h, texcoords.bottom, texcoords.left);
+            vertices[first + 3] = ScreenRectVertex(x + w, y + h, texcoords.top, texcoords.left);
+        }
+        // The output resolution of rotated screens is in the orientation of the texture
+        const float out_w = layout.is_rotated ? h : w;
+        const float out_h = layout.is_rotated ? w : h;
+        screen_quads.push_back({static_cast<GLint>(first), screen_l, screen_r, layer,
+                                {out_w, out_h, 1.0f / out_w, 1.0f / out_h}});
+    };
+
+    const auto add_screen = [&](const Common::Rectangle<u32>& rect, std::size_t screen_l,
+                                std::size_t screen_r, float cardboard_right_eye) {
+        const float x = static_cast<float>(rect.left);
+        const float y = static_cast<float>(rect.top);
+        const float w = static_cast<float>(rect.GetWidth());
+        const float h = static_cast<float>(rect.GetHeight());
+        const float half_width = static_cast<float>(layout.width) / 2;
+
+        switch (Settings::values.render_3d) {
+        case Settings::StereoRenderOption::Off:
+            add_quad(screen_l, screen_l, 0, x, y, w, h);
+            break;
+        case Settings::StereoRenderOption::SideBySide:
+            add_quad(screen_l, screen_l, 0, x / 2, y, w / 2, h);
+            add_quad(screen_r, screen_r, 1, x / 2 + half_width, y, w / 2, h);
+            break;
+        case Settings::StereoRenderOption::CardboardVR:
+            add_quad(screen_l, screen_l, 0, x, y, w, h);
+            add_quad(screen_r, screen_r, 1, cardboard_right_eye + half_width, y, w, h);
+            break;
+        case Settings::StereoRenderOption::Anaglyph:
+        case Settings::StereoRenderOption::Interlaced:
+        case Settings::StereoRenderOption::ReverseInterlaced:
+            // The shader samples both eyes
+            add_quad(screen_l, screen_r, 0, x, y, w, h);
+            break;
+        }
+    };
 
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices.data());
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    if (layout.top_screen_enabled) {
+        add_screen(layout.top_screen, 0, 1, layout.cardboard.top_screen_right_eye);
+    }
+    // The bottom screen has no right eye image
+    if (layout.bottom_screen_enabled) {
+        add_screen(layout.bottom_screen, 2, 2, layout.cardboard.bottom_screen_right_eye);
+    }
 
-    state.texture_units[0].texture_2d = 0;
-    state.texture_units[0].sampler = 0;
     state.Apply();
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(ScreenRectVertex) * 4 * screen_quads.size(),
+                    vertices.data());
 }
 
 /**
- * Draws a single texture to the emulator window, rotating the texture to correct for the 3DS's LCD
- * rotation.
+ * Draws the emulated screens into a frame of the mailbox and hands it to the present thread.
  */
-void RendererOpenGL::DrawSingleScreenStereoRotated(const ScreenInfo& screen_info_l,
-                                                   const ScreenInfo& screen_info_r, float x,
-                                                   float y, float w, float h) {
-    const auto& texcoords = screen_info_l.display_texcoords;
-
-    const std::array<ScreenRectVertex, 4> vertices = {{
-        ScreenRectVertex(x, y, texcoords.bottom, texcoords.left),
-        ScreenRectVertex(x + w, y, texcoords.bottom, texcoords.right),
-        ScreenRectVertex(x, y + h, texcoords.top, texcoords.left),
-        ScreenRectVertex(x + w, y + h, texcoords.top, texcoords.right),
-    }};
+void RendererOpenGL::DrawToMailbox(const Layout::FramebufferLayout& layout) {
+    Frontend::Frame* frame = render_window.mailbox->GetRenderFrame();
 
-    const u16 scale_factor = VideoCore::GetResolutionScaleFactor();
-    glUniform4f(uniform_i_resolution,
-                static_cast<float>(screen_info_l.texture.width * scale_factor),
-                static_cast<float>(screen_info_l.texture.height * scale_factor),
-                1.0f / static_cast<float>(screen_info_l.texture.width * scale_factor),
-                1.0f / static_cast<float>(screen_info_l.texture.height * scale_factor));
-    glUniform4f(uniform_o_resolution, h, w, 1.0f / h, 1.0f / w);
-    state.texture_units[0].texture_2d = screen_info_l.display_texture;
-    state.texture_units[1].texture_2d = screen_info_r.display_texture;
-    state.texture_units[0].sampler = filter_sampler.handle;
-    state.texture_units[1].sampler = filter_sampler.handle;
+    if (frame->width != layout.width || frame->height != layout.height) {
+        frame->color.Release();
+        frame->color.Create();
+        state.renderbuffer = frame->color.handle;
+        state.Apply();
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, layout.width, layout.height);
+
+        frame->render.Release();
+        frame->render.Create();
+        state.draw.draw_framebuffer = frame->render.handle;
+        state.Apply();
+        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                  frame->color.handle);
+
+        frame->width = layout.width;
+        frame->height = layout.height;
+        frame->color_reloaded = true;
+    }
+
+    const GLuint old_draw_fb = state.draw.draw_framebuffer;
+    state.draw.draw_framebuffer = frame->render.handle;
     state.Apply();
 
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices.data());
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    DrawScreens(layout);
+    DrawFrameCounters(layout);
 
-    state.texture_units[0].texture_2d = 0;
-    state.texture_units[1].texture_2d = 0;
-    state.texture_units[0].sampler = 0;
-    state.texture_units[1].sampler = 0;
+    // The other context only sees the commands once they have been flushed
+    frame->render_fence.Release();
+    frame->render_fence.Create();
+    glFlush();
+
+    state.draw.draw_framebuffer = old_draw_fb;
     state.Apply();
+
+    render_window.mailbox->ReleaseRenderFrame(frame);
 }
 
-void RendererOpenGL::DrawSingleScreenStereo(const ScreenInfo& screen_info_l,
-                                            const ScreenInfo& screen_info_r, float x, float y,
-                                            float w, float h) {
-    const auto& texcoords = screen_info_l.display_texcoords;
+void RendererOpenGL::TryPresent(int timeout_ms) {
+    Frontend::Frame* frame = render_window.mailbox->TryGetPresentFrame(timeout_ms);
+    if (!frame) {
+        return;
+    }
 
-    const std::array<ScreenRectVertex, 4> vertices = {{
-        ScreenRectVertex(x, y, texcoords.bottom, texcoords.right),
-        ScreenRectVertex(x + w, y, texcoords.top, texcoords.right),
-        ScreenRectVertex(x, y + h, texcoords.bottom, texcoords.left),
-        ScreenRectVertex(x + w, y + h, texcoords.top, texcoords.left),
-    }};
+    // This runs on the present context, which OpenGLState does not track
+    if (frame->color_reloaded) {
+        glDeleteFramebuffers(1, &frame->present);
+        glGenFramebuffers(1, &frame->present);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, frame->present);
+        glFramebufferRenderbuffer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                  frame->color.handle);
+        frame->color_reloaded = false;
+    }
 
-    const u16 scale_factor = VideoCore::GetResolutionScaleFactor();
-    glUniform4f(uniform_i_resolution,
-                static_cast<float>(screen_info_l.texture.width * scale_factor),
-                static_cast<float>(screen_info_l.texture.height * scale_factor),
-                1.0f / static_cast<float>(screen_info_l.texture.width * scale_factor),
-                1.0f / static_cast<float>(screen_info_l.texture.height * scale_factor));
-    glUniform4f(uniform_o_resolution, w, h, 1.0f / w, 1.0f / h);
-    state.texture_units[0].texture_2d = screen_info_l.display_texture;
-    state.texture_units[1].texture_2d = screen_info_r.display_texture;
-    state.texture_units[0].sampler = filter_sampler.handle;
-    state.texture_units[1].sampler = filter_sampler.handle;
-    state.Apply();
+    if (frame->render_fence.handle) {
+        glWaitSync(frame->render_fence.handle, 0, GL_TIMEOUT_IGNORED);
+        frame->render_fence.Release();
+    }
 
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices.data());
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    const auto& layout = render_window.GetFramebufferLayout();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, frame->present);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, frame->width, frame->height, 0, 0, layout.width, layout.height,
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 
-    state.texture_units[0].texture_2d = 0;
-    state.texture_units[1].texture_2d = 0;
-    state.texture_units[0].sampler = 0;
-    state.texture_units[1].sampler = 0;
-    state.Apply();
+    frame->present_fence.Release();
+    frame->present_fence.Create();
+    glFlush();
 }
 
 /**
@@ -720,8 +959,7 @@ void RendererOpenGL::DrawScreens(const Layout::FramebufferLayout& layout) {
         ReloadShader();
     }
 
-    const auto& top_screen = layout.top_screen;
-    const auto& bottom_screen = layout.bottom_screen;
+    UpdateComposition(layout);
 
     glViewport(0, 0, layout.width, layout.height);
 
@@ -747,127 +985,85 @@ void RendererOpenGL::DrawScreens(const Layout::FramebufferLayout& layout) {
         glUniform1i(uniform_color_texture_r, 1);
     }
 
-    glUniform1i(uniform_layer, 0);
-    if (layout.top_screen_enabled) {
-        if (layout.is_rotated) {
-            if (Settings::values.render_3d == Settings::StereoRenderOption::Off) {
-                DrawSingleScreenRotated(screen_infos[0], (float)top_screen.left,
-                                        (float)top_screen.top, (float)top_screen.GetWidth(),
-                                        (float)top_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::SideBySide) {
-                DrawSingleScreenRotated(screen_infos[0], (float)top_screen.left / 2,
-                                        (float)top_screen.top, (float)top_screen.GetWidth() / 2,
-                                        (float)top_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreenRotated(screen_infos[1],
-                                        ((float)top_screen.left / 2) + ((float)layout.width / 2),
-                                        (float)top_screen.top, (float)top_screen.GetWidth() / 2,
-                                        (float)top_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::CardboardVR) {
-                DrawSingleScreenRotated(screen_infos[0], layout.top_screen.left,
-                                        layout.top_screen.top, layout.top_screen.GetWidth(),
-                                        layout.top_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreenRotated(screen_infos[1],
-                                        layout.cardboard.top_screen_right_eye +
-                                            ((float)layout.width / 2),
-                                        layout.top_screen.top, layout.top_screen.GetWidth(),
-                                        layout.top_screen.GetHeight());
-            } else if (stereo_single_screen) {
-                DrawSingleScreenStereoRotated(
-                    screen_infos[0], screen_infos[1], (float)top_screen.left, (float)top_screen.top,
-                    (float)top_screen.GetWidth(), (float)top_screen.GetHeight());
-            }
-        } else {
-            if (Settings::values.render_3d == Settings::StereoRenderOption::Off) {
-                DrawSingleScreen(screen_infos[0], (float)top_screen.left, (float)top_screen.top,
-                                 (float)top_screen.GetWidth(), (float)top_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::SideBySide) {
-                DrawSingleScreen(screen_infos[0], (float)top_screen.left / 2, (float)top_screen.top,
-                                 (float)top_screen.GetWidth() / 2, (float)top_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreen(screen_infos[1],
-                                 ((float)top_screen.left / 2) + ((float)layout.width / 2),
-                                 (float)top_screen.top, (float)top_screen.GetWidth() / 2,
-                                 (float)top_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::CardboardVR) {
-                DrawSingleScreen(screen_infos[0], layout.top_screen.left, layout.top_screen.top,
-                                 layout.top_screen.GetWidth(), layout.top_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreen(screen_infos[1],
-                                 layout.cardboard.top_screen_right_eye + ((float)layout.width / 2),
-                                 layout.top_screen.top, layout.top_screen.GetWidth(),
-                                 layout.top_screen.GetHeight());
-            } else if (stereo_single_screen) {
-                DrawSingleScreenStereo(screen_infos[0], screen_infos[1], (float)top_screen.left,
-                                       (float)top_screen.top, (float)top_screen.GetWidth(),
-                                       (float)top_screen.GetHeight());
-            }
+    // Every quad is drawn from the cached vertex buffer with the same shader, so only the
+    // textures and the resolution uniforms change between draws
+    const u16 scale_factor = VideoCore::GetResolutionScaleFactor();
+    state.texture_units[0].sampler = filter_sampler.handle;
+    state.texture_units[1].sampler = stereo_single_screen ? filter_sampler.handle : 0;
+    for (const ScreenQuad& quad : screen_quads) {
+        const TextureInfo& texture = screen_infos[quad.screen_l].texture;
+        const float width = static_cast<float>(texture.width * scale_factor);
+        const float height = static_cast<float>(texture.height * scale_factor);
+        glUniform4f(uniform_i_resolution, width, height, 1.0f / width, 1.0f / height);
+        glUniform4fv(uniform_o_resolution, 1, quad.o_resolution.data());
+        glUniform1i(uniform_layer, quad.layer);
+
+        state.texture_units[0].texture_2d = screen_infos[quad.screen_l].display_texture;
+        if (stereo_single_screen) {
+            state.texture_units[1].texture_2d = screen_infos[quad.screen_r].display_texture;
         }
+        state.Apply();
+        glDrawArrays(GL_TRIANGLE_STRIP, quad.first_vertex, 4);
     }
-    glUniform1i(uniform_layer, 0);
-    if (layout.bottom_screen_enabled) {
-        if (layout.is_rotated) {
-            if (Settings::values.render_3d == Settings::StereoRenderOption::Off) {
-                DrawSingleScreenRotated(screen_infos[2], (float)bottom_screen.left,
-                                        (float)bottom_screen.top, (float)bottom_screen.GetWidth(),
-                                        (float)bottom_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::SideBySide) {
-                DrawSingleScreenRotated(
-                    screen_infos[2], (float)bottom_screen.left / 2, (float)bottom_screen.top,
-                    (float)bottom_screen.GetWidth() / 2, (float)bottom_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreenRotated(
-                    screen_infos[2], ((float)bottom_screen.left / 2) + ((float)layout.width / 2),
-                    (float)bottom_screen.top, (float)bottom_screen.GetWidth() / 2,
-                    (float)bottom_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::CardboardVR) {
-                DrawSingleScreenRotated(screen_infos[2], layout.bottom_screen.left,
-                                        layout.bottom_screen.top, layout.bottom_screen.GetWidth(),
-                                        layout.bottom_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreenRotated(screen_infos[2],
-                                        layout.cardboard.bottom_screen_right_eye +
-                                            ((float)layout.width / 2),
-                                        layout.bottom_screen.top, layout.bottom_screen.GetWidth(),
-                                        layout.bottom_screen.GetHeight());
-            } else if (stereo_single_screen) {
-                DrawSingleScreenStereoRotated(screen_infos[2], screen_infos[2],
-                                              (float)bottom_screen.left, (float)bottom_screen.top,
-                                              (float)bottom_screen.GetWidth(),
-                                              (float)bottom_screen.GetHeight());
-            }
-        } else {
-            if (Settings::values.render_3d == Settings::StereoRenderOption::Off) {
-                DrawSingleScreen(screen_infos[2], (float)bottom_screen.left,
-                                 (float)bottom_screen.top, (float)bottom_screen.GetWidth(),
-                                 (float)bottom_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::SideBySide) {
-                DrawSingleScreen(screen_infos[2], (float)bottom_screen.left / 2,
-                                 (float)bottom_screen.top, (float)bottom_screen.GetWidth() / 2,
-                                 (float)bottom_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreen(screen_infos[2],
-                                 ((float)bottom_screen.left / 2) + ((float)layout.width / 2),
-                                 (float)bottom_screen.top, (float)bottom_screen.GetWidth() / 2,
-                                 (float)bottom_screen.GetHeight());
-            } else if (Settings::values.render_3d == Settings::StereoRenderOption::CardboardVR) {
-                DrawSingleScreen(screen_infos[2], layout.bottom_screen.left,
-                                 layout.bottom_screen.top, layout.bottom_screen.GetWidth(),
-                                 layout.bottom_screen.GetHeight());
-                glUniform1i(uniform_layer, 1);
-                DrawSingleScreen(screen_infos[2],
-                                 layout.cardboard.bottom_screen_right_eye +
-                                     ((float)layout.width / 2),
-                                 layout.bottom_screen.top, layout.bottom_screen.GetWidth(),
-                                 layout.bottom_screen.GetHeight());
-            } else if (stereo_single_screen) {
-                DrawSingleScreenStereo(screen_infos[2], screen_infos[2], (float)bottom_screen.left,
-                                       (float)bottom_screen.top, (float)bottom_screen.GetWidth(),
-                                       (float)bottom_screen.GetHeight());
+
+    state.texture_units[0].texture_2d = 0;
+    state.texture_units[1].texture_2d = 0;
+    state.texture_units[0].sampler = 0;
+    state.texture_units[1].sampler = 0;
+    state.Apply();
+}
+
+void RendererOpenGL::DrawFrameCounters(const Layout::FramebufferLayout& layout) {
+    if (!Settings::values.show_frame_counters) {
+        return;
+    }
+    const Core::FrameCounterValues counters =
+        Core::System::GetInstance().perf_stats->GetLastFrameCounters();
+
+    // Everything is drawn by clearing scissored rectangles, which needs no extra GL objects
+    const GLint scale = std::max<GLint>(2, static_cast<GLint>(layout.height) / 240);
+    const auto fill = [&](GLint x, GLint y, GLsizei width, const std::array<GLfloat, 3>& color) {
+        state.scissor.x = x * scale;
+        state.scissor.y = static_cast<GLint>(layout.height) - (y + 1) * scale;
+        state.scissor.width = width * scale;
+        state.scissor.height = scale;
+        state.Apply();
+        glClearColor(color[0], color[1], color[2], 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    };
+
+    // One row per counter in the top-left corner: a colored swatch, then the value
+    constexpr std::array<GLfloat, 3> text_color{1.0f, 1.0f, 1.0f};
+    state.scissor.enabled = true;
+    for (std::size_t i = 0; i < counters.size(); ++i) {
+        const GLint top = 2 + static_cast<GLint>(i) * 7;
+        for (GLint row = 0; row < 5; ++row) {
+            fill(2, top + row, 3, counter_colors[i]);
+        }
+
+        const std::string digits = std::to_string(counters[i]);
+        for (std::size_t d = 0; d < digits.size(); ++d) {
+            const u16 glyph = digit_glyphs[digits[d] - '0'];
+            const GLint left = 7 + static_cast<GLint>(d) * 4;
+            for (GLint row = 0; row < 5; ++row) {
+                // Merge the lit pixels of the row into runs
+                for (GLint column = 0; column < 3;) {
+                    GLint end = column;
+                    while (end < 3 && (glyph >> (14 - row * 3 - end)) & 1) {
+                        ++end;
+                    }
+                    if (end > column) {
+                        fill(left + column, top + row, end - column, text_color);
+                    }
+                    column = end + 1;
+                }
             }
         }
     }
+    state.scissor.enabled = false;
+    state.Apply();
+    glClearColor(Settings::values.bg_red, Settings::values.bg_green, Settings::values.bg_blue,
+                 0.0f);
 }
 
 /// Updates the framerate
@@ -909,6 +1105,47 @@ void RendererOpenGL::ReleaseVideoDumpingGLObjects() {
     for (auto& buffer : frame_dumping_pbos) {
         buffer.Release();
     }
+    // Frames still being read back are dropped, the dumper has stopped already
+    for (auto& fence : frame_dumping_fences) {
+        fence.Release();
+    }
+    frame_dumping_repeats.fill(false);
+    next_pbo = 0;
+    pending_pbos = 0;
+    dumped_frame_read = false;
+}
+
+bool RendererOpenGL::PopDumpedFrame(const Layout::FramebufferLayout& layout, bool wait) {
+    const std::size_t index =
+        (next_pbo + frame_dumping_pbos.size() - pending_pbos) % frame_dumping_pbos.size();
+    if (frame_dumping_repeats[index]) {
+        frame_dumping_repeats[index] = false;
+        pending_pbos--;
+        Core::System::GetInstance().VideoDumper().AddVideoFrame(
+            VideoDumper::VideoFrame::Repeat(layout.width, layout.height));
+        return true;
+    }
+    OGLSync& fence = frame_dumping_fences[index];
+    // Waits are bounded so that a lost context cannot hang the emulation
+    const GLenum result = glClientWaitSync(fence.handle, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                           wait ? 1'000'000'000 : 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+    fence.Release();
+    pending_pbos--;
+
+    const GLsizeiptr size = layout.width * layout.height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, frame_dumping_pbos[index].handle);
+    auto* pixels =
+        static_cast<GLubyte*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    if (pixels) {
+        Core::System::GetInstance().VideoDumper().AddVideoFrame(
+            VideoDumper::VideoFrame{layout.width, layout.height, pixels});
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
 }
 
 static const char* GetSource(GLenum source) {
@@ -1003,14 +1240,21 @@ VideoCore::ResultStatus RendererOpenGL::Init() {
         return VideoCore::ResultStatus::ErrorBelowGL33;
     }
 
+    DetectCapabilities();
     InitOpenGLObjects();
 
+    if (render_window.IsPresentedOnSeparateThread()) {
+        render_window.mailbox = std::make_unique<OGLTextureMailbox>();
+    }
+
     RefreshRasterizerSetting();
 
     return VideoCore::ResultStatus::Success;
 }
 
 /// Shutdown the renderer
-void RendererOpenGL::ShutDown() {}
+void RendererOpenGL::ShutDown() {
+    render_window.mailbox.reset();
+}
 
 } // namespace OpenGL
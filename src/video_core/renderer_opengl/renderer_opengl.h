@@ -5,18 +5,18 @@
 #pragma once
 
 #include <array>
+#include <optional>
+#include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "common/math_util.h"
+#include "core/frontend/framebuffer_layout.h"
 #include "core/hw/gpu.h"
+#include "core/settings.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 
-namespace Layout {
-struct FramebufferLayout;
-}
-
 namespace OpenGL {
 
 /// Structure used for storing information about the textures for each 3DS screen
@@ -34,6 +34,8 @@ struct ScreenInfo {
     GLuint display_texture;
     Common::Rectangle<float> display_texcoords;
     TextureInfo texture;
+    /// write_tick of the cached surface that is displayed, 0 when the screen is not one
+    u64 display_write_tick = 0;
 };
 
 class RendererOpenGL : public RendererBase {
@@ -44,6 +46,9 @@ public:
     /// Swap buffers (render frame)
     void SwapBuffers() override;
 
+    /// Draws the newest mailbox frame to the default framebuffer. Present thread only.
+    void TryPresent(int timeout_ms) override;
+
     /// Initialize the renderer
     VideoCore::ResultStatus Init() override;
 
@@ -57,19 +62,22 @@ public:
     void CleanupVideoDumping() override;
 
 private:
+    /// Finishes a frame that was not rendered, without loading or presenting the screens
+    void SkipFrame();
+    /// Picks whether the next frame is rendered, which only every frame_skip + 1th frame is
+    /// while fast-forwarding
+    void UpdateFrameSkip();
+
     void InitOpenGLObjects();
     void ReloadSampler();
     void ReloadShader();
     void ConfigureFramebufferTexture(TextureInfo& texture,
                                      const GPU::Regs::FramebufferConfig& framebuffer);
     void DrawScreens(const Layout::FramebufferLayout& layout);
-    void DrawSingleScreenRotated(const ScreenInfo& screen_info, float x, float y, float w, float h);
-    void DrawSingleScreen(const ScreenInfo& screen_info, float x, float y, float w, float h);
-    void DrawSingleScreenStereoRotated(const ScreenInfo& screen_info_l,
-                                       const ScreenInfo& screen_info_r, float x, float y, float w,
-                                       float h);
-    void DrawSingleScreenStereo(const ScreenInfo& screen_info_l, const ScreenInfo& screen_info_r,
-                                float x, float y, float w, float h);
+    void DrawToMailbox(const Layout::FramebufferLayout& layout);
+    /// Draws the FrameCounter events of the previous frame over the screens, if enabled
+    void DrawFrameCounters(const Layout::FramebufferLayout& layout);
+    void UpdateComposition(const Layout::FramebufferLayout& layout);
     void UpdateFramerate();
 
     // Loads framebuffer from emulated memory into the display information structure
@@ -80,6 +88,9 @@ private:
 
     void InitVideoDumpingGLObjects();
     void ReleaseVideoDumpingGLObjects();
+    /// Hands the oldest frame read back to a PBO to the video dumper. Unless wait is set, this
+    /// does nothing and returns false if the GPU has not finished writing it yet.
+    bool PopDumpedFrame(const Layout::FramebufferLayout& layout, bool wait);
 
     OpenGLState state;
 
@@ -93,6 +104,36 @@ private:
     /// Display information for top and bottom screens respectively
     std::array<ScreenInfo, 3> screen_infos;
 
+    /// Two eyes of both screens
+    static constexpr std::size_t MaxScreenQuads = 4;
+
+    /// Screen quad of the composition, whose vertices are in vertex_buffer
+    struct ScreenQuad {
+        GLint first_vertex;
+        std::size_t screen_l; ///< Index of the screen_infos drawn
+        std::size_t screen_r; ///< Screen bound to the second texture unit by stereo shaders
+        GLint layer;
+        std::array<GLfloat, 4> o_resolution;
+    };
+
+    /// What the composition was built from
+    struct CompositionKey {
+        Layout::FramebufferLayout layout;
+        Settings::StereoRenderOption render_3d;
+        std::array<Common::Rectangle<float>, 3> texcoords;
+
+        bool operator==(const CompositionKey& other) const;
+    };
+
+    /// Returns what the composition of the layout is built from with the current screens
+    CompositionKey MakeCompositionKey(const Layout::FramebufferLayout& layout) const;
+
+    std::vector<ScreenQuad> screen_quads;
+    std::optional<CompositionKey> composition_key;
+
+    /// Index of the current frame since the last one that was rendered, 0 if it is rendered
+    u32 frame_skip_position = 0;
+
     // Shader uniform location indices
     GLuint uniform_modelview_matrix;
     GLuint uniform_color_texture;
@@ -116,10 +157,16 @@ private:
     std::atomic_bool prepare_video_dumping = false;
     std::atomic_bool cleanup_video_dumping = false;
 
-    // PBOs used to dump frames faster
-    std::array<OGLBuffer, 2> frame_dumping_pbos;
-    GLuint current_pbo = 1;
-    GLuint next_pbo = 0;
+    // PBOs the dumped frames are read back to, with the fences signaled once each read is done.
+    // Frames are only mapped once their fence is, so that dumping does not stall on the GPU.
+    std::array<OGLBuffer, 3> frame_dumping_pbos;
+    std::array<OGLSync, 3> frame_dumping_fences;
+    /// Set for the slots that hold a repeat of the previous frame, which are not read back
+    std::array<bool, 3> frame_dumping_repeats{};
+    /// Whether a frame has been read back since dumping started, which a repeat needs
+    bool dumped_frame_read = false;
+    std::size_t next_pbo = 0;     ///< PBO the next frame is read back to
+    std::size_t pending_pbos = 0; ///< Number of PBOs holding frames not handed to the dumper yet
 };
 
 } // namespace OpenGL
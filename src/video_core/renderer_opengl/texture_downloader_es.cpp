@@ -3,12 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <chrono>
+#include <cstring>
 #include <vector>
 
 #include <fmt/chrono.h>
+#include <fmt/format.h>
 
 #include "common/logging/log.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/texture_downloader_es.h"
@@ -19,6 +22,100 @@
 
 namespace OpenGL {
 
+using PixelFormat = SurfaceParams::PixelFormat;
+
+constexpr std::string_view tiled_download_comp = R"(
+layout(local_size_x = 64) in;
+
+layout(std430, binding = 0) buffer Tiled {
+    highp uint words[];
+};
+
+uniform highp sampler2D source;
+uniform highp usampler2D stencil_source;
+uniform int format;
+uniform uint bytes_per_pixel;
+uniform uint rect_tiles_x;
+uniform uint num_tiles;
+uniform ivec2 origin;
+uniform bool stencil_pass;
+
+uint Quantize(float value, int bits) {
+    return uint(value * (exp2(float(bits)) - 1.0) + 0.5);
+}
+
+// Packs the texel the way the 3DS stores it, in a little endian word
+uint Encode(vec4 texel) {
+    switch (format) {
+    case RGBA8:
+        return (Quantize(texel.r, 8) << 24) | (Quantize(texel.g, 8) << 16) |
+               (Quantize(texel.b, 8) << 8) | Quantize(texel.a, 8);
+    case RGB8:
+        return (Quantize(texel.r, 8) << 16) | (Quantize(texel.g, 8) << 8) | Quantize(texel.b, 8);
+    case RGB5A1:
+        return (Quantize(texel.r, 5) << 11) | (Quantize(texel.g, 5) << 6) |
+               (Quantize(texel.b, 5) << 1) | Quantize(texel.a, 1);
+    case RGB565:
+        return (Quantize(texel.r, 5) << 11) | (Quantize(texel.g, 6) << 5) | Quantize(texel.b, 5);
+    case RGBA4:
+        return (Quantize(texel.r, 4) << 12) | (Quantize(texel.g, 4) << 8) |
+               (Quantize(texel.b, 4) << 4) | Quantize(texel.a, 4);
+    case D16:
+        return Quantize(texel.r, 16);
+    case D24:
+    case D24S8:
+        return Quantize(texel.r, 24);
+    }
+    return 0u;
+}
+
+uint MortonInterleave(uint x, uint y) {
+    return (x & 1u) | ((y & 1u) << 1) | ((x & 2u) << 1) | ((y & 2u) << 2) | ((x & 4u) << 2) |
+           ((y & 4u) << 3);
+}
+
+void main() {
+    uint tile = gl_GlobalInvocationID.x;
+    if (tile >= num_tiles) {
+        return;
+    }
+    // Tiles go down the surface while texture rows go up
+    ivec2 tile_origin =
+        origin + ivec2(int(tile % rect_tiles_x) * 8, -int(tile / rect_tiles_x) * 8);
+    uint words_per_tile = 16u * bytes_per_pixel;
+    uint base = tile * words_per_tile;
+
+    if (stencil_pass) {
+        // D24S8 keeps the stencil in the top byte of each texel
+        for (uint y = 0u; y < 8u; ++y) {
+            for (uint x = 0u; x < 8u; ++x) {
+                uint stencil = texelFetch(stencil_source, tile_origin + ivec2(x, -int(y)), 0).r;
+                words[base + MortonInterleave(x, y)] |= (stencil & 0xFFu) << 24;
+            }
+        }
+        return;
+    }
+
+    uint tile_words[64];
+    for (uint i = 0u; i < words_per_tile; ++i) {
+        tile_words[i] = 0u;
+    }
+    for (uint y = 0u; y < 8u; ++y) {
+        for (uint x = 0u; x < 8u; ++x) {
+            uint raw = Encode(texelFetch(source, tile_origin + ivec2(x, -int(y)), 0));
+            uint byte_offset = MortonInterleave(x, y) * bytes_per_pixel;
+            for (uint i = 0u; i < bytes_per_pixel; ++i, ++byte_offset) {
+                tile_words[byte_offset >> 2] |= ((raw >> (8u * i)) & 0xFFu)
+                                                << ((byte_offset & 3u) * 8u);
+            }
+        }
+    }
+    for (uint i = 0u; i < words_per_tile; ++i) {
+        words[base + i] = tile_words[i];
+    }
+}
+)";
+
 /**
  * Self tests for the texture downloader
  */
@@ -145,6 +242,56 @@ void main(){
                               r16_renderbuffer.handle);
 
     cur_state.Apply();
+
+    if (GLES && GLAD_GL_ES_VERSION_3_1) {
+        std::string comp_source = fmt::format(R"(
+#define RGBA8 {}
+#define RGB8 {}
+#define RGB5A1 {}
+#define RGB565 {}
+#define RGBA4 {}
+#define D16 {}
+#define D24 {}
+#define D24S8 {}
+)",
+                                              static_cast<int>(PixelFormat::RGBA8),
+                                              static_cast<int>(PixelFormat::RGB8),
+                                              static_cast<int>(PixelFormat::RGB5A1),
+                                              static_cast<int>(PixelFormat::RGB565),
+                                              static_cast<int>(PixelFormat::RGBA4),
+                                              static_cast<int>(PixelFormat::D16),
+                                              static_cast<int>(PixelFormat::D24),
+                                              static_cast<int>(PixelFormat::D24S8));
+        comp_source += tiled_download_comp;
+
+        OGLShader comp;
+        comp.Create(comp_source.c_str(), GL_COMPUTE_SHADER);
+        tiled_shader.program.Create(false, {comp.handle});
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(tiled_shader.program.handle, GL_LINK_STATUS, &linked);
+        if (linked != GL_TRUE) {
+            LOG_WARNING(Render_OpenGL, "Tiled download shader failed, flushes will swizzle on CPU");
+            tiled_shader.program.Release();
+            return;
+        }
+
+        const GLuint handle = tiled_shader.program.handle;
+        tiled_shader.format_location = glGetUniformLocation(handle, "format");
+        tiled_shader.bytes_per_pixel_location = glGetUniformLocation(handle, "bytes_per_pixel");
+        tiled_shader.rect_tiles_x_location = glGetUniformLocation(handle, "rect_tiles_x");
+        tiled_shader.num_tiles_location = glGetUniformLocation(handle, "num_tiles");
+        tiled_shader.origin_location = glGetUniformLocation(handle, "origin");
+        tiled_shader.stencil_pass_location = glGetUniformLocation(handle, "stencil_pass");
+
+        state.draw.shader_program = handle;
+        state.Apply();
+        glUniform1i(glGetUniformLocation(handle, "source"), 0);
+        glUniform1i(glGetUniformLocation(handle, "stencil_source"), 1);
+        cur_state.Apply();
+
+        tiled_buffer.Create();
+    }
 }
 
 /**
@@ -251,4 +398,66 @@ void TextureDownloaderES::GetTexImage(GLenum target, GLuint level, GLenum format
     state.Apply();
 }
 
+void TextureDownloaderES::DownloadTiled(GLuint texture, PixelFormat format,
+                                        const Common::Rectangle<u32>& rect, u8* tiled) {
+    ASSERT(CanDownloadTiled());
+    ASSERT(rect.left % 8 == 0 && rect.GetWidth() % 8 == 0 && rect.GetHeight() % 8 == 0);
+
+    const u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
+    const u32 rect_tiles_x = rect.GetWidth() / 8;
+    const u32 num_tiles = rect_tiles_x * (rect.GetHeight() / 8);
+    const auto size = static_cast<GLsizeiptr>(num_tiles) * 64 * bytes_per_pixel;
+
+    const OpenGLState cur_state = OpenGLState::GetCurState();
+    OpenGLState state;
+    state.texture_units[0] = {texture, sampler.handle};
+    state.draw.shader_program = tiled_shader.program.handle;
+    state.Apply();
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tiled_buffer.handle);
+    if (size > tiled_buffer_size) {
+        tiled_buffer_size = size;
+        glBufferData(GL_SHADER_STORAGE_BUFFER, tiled_buffer_size, nullptr, GL_STREAM_READ);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, tiled_buffer.handle);
+
+    glUniform1i(tiled_shader.format_location, static_cast<GLint>(format));
+    glUniform1ui(tiled_shader.bytes_per_pixel_location, bytes_per_pixel);
+    glUniform1ui(tiled_shader.rect_tiles_x_location, rect_tiles_x);
+    glUniform1ui(tiled_shader.num_tiles_location, num_tiles);
+    glUniform2i(tiled_shader.origin_location, static_cast<GLint>(rect.left),
+                static_cast<GLint>(rect.top) - 1);
+    glUniform1i(tiled_shader.stencil_pass_location, GL_FALSE);
+    const GLuint num_groups = (num_tiles + 63) / 64;
+    glDispatchCompute(num_groups, 1, 1);
+
+    if (format == PixelFormat::D24S8) {
+        // In GLES, a depth stencil texture samples either its depth or its stencil
+        state.texture_units[1] = {texture, sampler.handle};
+        state.Apply();
+        glActiveTexture(GL_TEXTURE1);
+        glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_STENCIL_INDEX);
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        glUniform1i(tiled_shader.stencil_pass_location, GL_TRUE);
+        glDispatchCompute(num_groups, 1, 1);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_DEPTH_COMPONENT);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    const void* data = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (data != nullptr) {
+        std::memcpy(tiled, data, static_cast<std::size_t>(size));
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    } else {
+        LOG_ERROR(Render_OpenGL, "Could not map the tiled download buffer");
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    cur_state.Apply();
+}
+
 } // namespace OpenGL
@@ -5,7 +5,9 @@
 #pragma once
 
 #include "common/common_types.h"
+#include "common/math_util.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_surface_params.h"
 
 namespace OpenGL {
 class OpenGLState;
@@ -23,6 +25,19 @@ class TextureDownloaderES {
     } d24_r32ui_conversion_shader, d16_r16_conversion_shader, d24s8_r32ui_conversion_shader;
     OGLSampler sampler;
 
+    /// Compute shader writing texels in the 3DS tiled layout, only available on GLES 3.1+
+    struct TiledShader {
+        OGLProgram program;
+        GLint format_location{-1};
+        GLint bytes_per_pixel_location{-1};
+        GLint rect_tiles_x_location{-1};
+        GLint num_tiles_location{-1};
+        GLint origin_location{-1};
+        GLint stencil_pass_location{-1};
+    } tiled_shader;
+    OGLBuffer tiled_buffer;
+    GLsizeiptr tiled_buffer_size = 0;
+
     void Test();
     GLuint ConvertDepthToColor(GLuint level, GLenum& format, GLenum& type, GLint height,
                                GLint width);
@@ -32,5 +47,19 @@ public:
 
     void GetTexImage(GLenum target, GLuint level, GLenum format, const GLenum type, GLint height,
                      GLint width, void* pixels);
+
+    /// Returns true if DownloadTiled can be used
+    bool CanDownloadTiled() const {
+        return tiled_shader.program.handle != 0;
+    }
+
+    /**
+     * Reads the texels of rect, which must be made of whole tiles, and writes them to `tiled` in
+     * the layout the 3DS stores tiled surfaces in, with the Morton swizzle already applied. Tiles
+     * are written left to right then top to bottom, as if the rect were a surface of its own.
+     * Depth and depth stencil textures are read directly.
+     */
+    void DownloadTiled(GLuint texture, SurfaceParams::PixelFormat format,
+                       const Common::Rectangle<u32>& rect, u8* tiled);
 };
 } // namespace OpenGL
@@ -31,6 +31,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/texture_filters/anime4k/anime4k_ultrafast.h"
 
 #include "shaders/refine.frag"
@@ -92,7 +93,7 @@ void Anime4kUltrafast::Filter(GLuint src_tex, const Common::Rectangle<u32>& src_
         state.Apply();
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, texture.tex.handle);
-        if (GL_ARB_texture_storage) {
+        if (GLAD_GL_ARB_texture_storage || GLES) {
             glTexStorage2D(GL_TEXTURE_2D, 1, internal_format,
                            src_rect.GetWidth() * internal_scale_factor,
                            src_rect.GetHeight() * internal_scale_factor);
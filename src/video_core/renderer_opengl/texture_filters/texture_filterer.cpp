@@ -6,6 +6,9 @@
 #include <functional>
 #include <unordered_map>
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/texture_filters/anime4k/anime4k_ultrafast.h"
 #include "video_core/renderer_opengl/texture_filters/bicubic/bicubic.h"
 #include "video_core/renderer_opengl/texture_filters/scale_force/scale_force.h"
@@ -51,6 +54,7 @@ bool TextureFilterer::Reset(std::string_view new_filter_name, u16 new_scale_fact
 
     filter_name = iter->first;
     filter = iter->second(new_scale_factor);
+    ClearCache();
     return true;
 }
 
@@ -61,15 +65,105 @@ bool TextureFilterer::IsNull() const {
 bool TextureFilterer::Filter(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint dst_tex,
                              const Common::Rectangle<u32>& dst_rect,
                              SurfaceParams::SurfaceType type, GLuint read_fb_handle,
-                             GLuint draw_fb_handle) {
+                             GLuint draw_fb_handle, const std::optional<SourceKey>& source_key) {
     // depth / stencil texture filtering is not supported for now
     if (IsNull() ||
         (type != SurfaceParams::SurfaceType::Color && type != SurfaceParams::SurfaceType::Texture))
         return false;
+
+    // Allocating cached textures needs immutable storage
+    if (!source_key || !(GLES || GLAD_GL_ARB_texture_storage)) {
+        filter->Filter(src_tex, src_rect, dst_tex, dst_rect, read_fb_handle, draw_fb_handle);
+        return true;
+    }
+
+    const CacheKey key{source_key->hash,   source_key->format,  src_rect.GetWidth(),
+                       src_rect.GetHeight(), dst_rect.GetWidth(), dst_rect.GetHeight()};
+    if (CopyCached(key, dst_tex, dst_rect, read_fb_handle, draw_fb_handle)) {
+        return true;
+    }
     filter->Filter(src_tex, src_rect, dst_tex, dst_rect, read_fb_handle, draw_fb_handle);
+    AddToCache(key, source_key->internal_format, dst_tex, dst_rect, read_fb_handle,
+               draw_fb_handle);
+    return true;
+}
+
+/// Copies the color texels of src_rect of src_tex to dst_rect of dst_tex, which are the same size
+static void CopyTexture(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint dst_tex,
+                        const Common::Rectangle<u32>& dst_rect, GLuint read_fb_handle,
+                        GLuint draw_fb_handle) {
+    OpenGLState prev_state = OpenGLState::GetCurState();
+    SCOPE_EXIT({ prev_state.Apply(); });
+
+    OpenGLState state;
+    state.draw.read_framebuffer = read_fb_handle;
+    state.draw.draw_framebuffer = draw_fb_handle;
+    state.Apply();
+
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, src_tex, 0);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst_tex, 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    glBlitFramebuffer(src_rect.left, src_rect.bottom, src_rect.right, src_rect.top, dst_rect.left,
+                      dst_rect.bottom, dst_rect.right, dst_rect.top, GL_COLOR_BUFFER_BIT,
+                      GL_NEAREST);
+}
+
+bool TextureFilterer::CopyCached(const CacheKey& key, GLuint dst_tex,
+                                 const Common::Rectangle<u32>& dst_rect, GLuint read_fb_handle,
+                                 GLuint draw_fb_handle) {
+    const auto it = cache_lookup.find(key);
+    if (it == cache_lookup.end()) {
+        return false;
+    }
+    cache.splice(cache.begin(), cache, it->second);
+    const Common::Rectangle<u32> cached_rect{0, dst_rect.GetHeight(), dst_rect.GetWidth(), 0};
+    CopyTexture(it->second->texture.handle, cached_rect, dst_tex, dst_rect, read_fb_handle,
+                draw_fb_handle);
     return true;
 }
 
+void TextureFilterer::AddToCache(const CacheKey& key, GLenum internal_format, GLuint dst_tex,
+                                 const Common::Rectangle<u32>& dst_rect, GLuint read_fb_handle,
+                                 GLuint draw_fb_handle) {
+    // Filters write 8 bit color, so this is close enough for the formats they are used on
+    const std::size_t memory = static_cast<std::size_t>(dst_rect.GetWidth()) *
+                               dst_rect.GetHeight() * 4;
+    if (memory > CacheBudget / 4) {
+        return;
+    }
+    while (cache_memory + memory > CacheBudget) {
+        cache_memory -= cache.back().memory;
+        cache_lookup.erase(cache.back().key);
+        cache.pop_back();
+    }
+
+    OGLTexture texture;
+    texture.Create();
+    {
+        OpenGLState prev_state = OpenGLState::GetCurState();
+        OpenGLState state = prev_state;
+        state.texture_units[0].texture_2d = texture.handle;
+        state.Apply();
+        glActiveTexture(GL_TEXTURE0);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, dst_rect.GetWidth(),
+                       dst_rect.GetHeight());
+        prev_state.Apply();
+    }
+    const Common::Rectangle<u32> cached_rect{0, dst_rect.GetHeight(), dst_rect.GetWidth(), 0};
+    CopyTexture(dst_tex, dst_rect, texture.handle, cached_rect, read_fb_handle, draw_fb_handle);
+
+    cache.push_front({key, std::move(texture), memory});
+    cache_lookup.emplace(key, cache.begin());
+    cache_memory += memory;
+}
+
+void TextureFilterer::ClearCache() {
+    cache_lookup.clear();
+    cache.clear();
+    cache_memory = 0;
+}
+
 std::vector<std::string_view> TextureFilterer::GetFilterNames() {
     std::vector<std::string_view> ret;
     std::transform(filter_map.begin(), filter_map.end(), std::back_inserter(ret),
@@ -4,12 +4,17 @@
 
 #pragma once
 
+#include <list>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string_view>
+#include <tuple>
 #include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "common/math_util.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_surface_params.h"
 #include "video_core/renderer_opengl/texture_filters/texture_filter_base.h"
 
@@ -19,21 +24,52 @@ class TextureFilterer {
 public:
     static constexpr std::string_view NONE = "none";
 
+    /// Texture memory kept for filtered textures that may be uploaded again
+    static constexpr std::size_t CacheBudget = 256 * 1024 * 1024;
+
+    /// Identifies the texels given to the filter, so that its output can be reused
+    struct SourceKey {
+        u64 hash; ///< Hash of the 3DS memory the texels were decoded from
+        SurfaceParams::PixelFormat format;
+        GLenum internal_format; ///< Internal format of the destination texture
+    };
+
     explicit TextureFilterer(std::string_view filter_name, u16 scale_factor);
     // returns true if the filter actually changed
     bool Reset(std::string_view new_filter_name, u16 new_scale_factor);
     // returns true if there is no active filter
     bool IsNull() const;
-    // returns true if the texture was able to be filtered
+    // returns true if the texture was able to be filtered. With a source key, the output is
+    // cached and copied instead of filtered again the next time the same texels are given.
     bool Filter(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint dst_tex,
                 const Common::Rectangle<u32>& dst_rect, SurfaceParams::SurfaceType type,
-                GLuint read_fb_handle, GLuint draw_fb_handle);
+                GLuint read_fb_handle, GLuint draw_fb_handle,
+                const std::optional<SourceKey>& source_key = std::nullopt);
 
     static std::vector<std::string_view> GetFilterNames();
 
 private:
+    using CacheKey = std::tuple<u64, SurfaceParams::PixelFormat, u32, u32, u32, u32>;
+    struct CacheEntry {
+        CacheKey key;
+        OGLTexture texture;
+        std::size_t memory;
+    };
+
+    bool CopyCached(const CacheKey& key, GLuint dst_tex, const Common::Rectangle<u32>& dst_rect,
+                    GLuint read_fb_handle, GLuint draw_fb_handle);
+    void AddToCache(const CacheKey& key, GLenum internal_format, GLuint dst_tex,
+                    const Common::Rectangle<u32>& dst_rect, GLuint read_fb_handle,
+                    GLuint draw_fb_handle);
+    void ClearCache();
+
     std::string_view filter_name = NONE;
     std::unique_ptr<TextureFilterBase> filter;
+
+    /// Filtered textures, the most recently used first
+    std::list<CacheEntry> cache;
+    std::map<CacheKey, std::list<CacheEntry>::iterator> cache_lookup;
+    std::size_t cache_memory = 0;
 };
 
 } // namespace OpenGL
@@ -5,6 +5,7 @@
 #include <cmath>
 #include <cstring>
 #include "common/bit_set.h"
+#include "common/common_funcs.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "video_core/pica_state.h"
@@ -12,9 +13,11 @@
 #include "video_core/regs_shader.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_interpreter.h"
-#ifdef ARCHITECTURE_x86_64
+#if defined(ARCHITECTURE_x86_64)
 #include "video_core/shader/shader_jit_x64.h"
-#endif // ARCHITECTURE_x86_64
+#elif defined(ARCHITECTURE_ARM64)
+#include "video_core/shader/shader_jit_a64.h"
+#endif
 #include "video_core/video_core.h"
 
 namespace Pica::Shader {
@@ -134,29 +137,42 @@ void GSUnitState::ConfigOutput(const ShaderRegs& config) {
 
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
 
-#ifdef ARCHITECTURE_x86_64
-static std::unique_ptr<JitX64Engine> jit_engine;
-#endif // ARCHITECTURE_x86_64
-static InterpreterEngine interpreter_engine;
+void ShaderEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                            const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                            std::size_t count) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        state.LoadInput(config, inputs[i]);
+        Run(setup, state);
+        state.WriteOutput(config, outputs[i]);
+    }
+}
+
+// The engines cache the programs of the console running on this thread
+#if defined(ARCHITECTURE_x86_64)
+static INSTANCE_LOCAL std::unique_ptr<JitX64Engine> jit_engine;
+#elif defined(ARCHITECTURE_ARM64)
+static INSTANCE_LOCAL std::unique_ptr<JitA64Engine> jit_engine;
+#endif
+static INSTANCE_LOCAL InterpreterEngine interpreter_engine;
 
 ShaderEngine* GetEngine() {
-#ifdef ARCHITECTURE_x86_64
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
     // TODO(yuriks): Re-initialize on each change rather than being persistent
     if (VideoCore::g_shader_jit_enabled) {
         if (jit_engine == nullptr) {
-            jit_engine = std::make_unique<JitX64Engine>();
+            jit_engine = std::make_unique<decltype(jit_engine)::element_type>();
         }
         return jit_engine.get();
     }
-#endif // ARCHITECTURE_x86_64
+#endif
 
     return &interpreter_engine;
 }
 
 void Shutdown() {
-#ifdef ARCHITECTURE_x86_64
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
     jit_engine = nullptr;
-#endif // ARCHITECTURE_x86_64
+#endif
 }
 
 } // namespace Pica::Shader
@@ -278,6 +278,9 @@ struct ShaderSetup {
         unsigned int entry_point;
         /// Used by the JIT, points to a compiled shader object.
         const void* cached_shader = nullptr;
+        /// Used by the x64 JIT, points to the compiled shader running two vertices per call, if
+        /// the host supports AVX2.
+        const void* cached_pair_shader = nullptr;
     } engine_data;
 
     void MarkProgramCodeDirty() {
@@ -290,7 +293,7 @@ struct ShaderSetup {
 
     u64 GetProgramCodeHash() {
         if (program_code_hash_dirty) {
-            program_code_hash = Common::ComputeHash64(&program_code, sizeof(program_code));
+            program_code_hash = Common::ComputeFastHash64(&program_code, sizeof(program_code));
             program_code_hash_dirty = false;
         }
         return program_code_hash;
@@ -298,7 +301,7 @@ struct ShaderSetup {
 
     u64 GetSwizzleDataHash() {
         if (swizzle_data_hash_dirty) {
-            swizzle_data_hash = Common::ComputeHash64(&swizzle_data, sizeof(swizzle_data));
+            swizzle_data_hash = Common::ComputeFastHash64(&swizzle_data, sizeof(swizzle_data));
             swizzle_data_hash_dirty = false;
         }
         return swizzle_data_hash;
@@ -340,6 +343,21 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader once per input, which saves the per-vertex dispatch
+     * overhead of calling Run in a loop.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param config Shader registers, describing how inputs and outputs map to shader registers.
+     * @param state Shader unit state, the input registers are loaded for each invocation.
+     * @param inputs Input attributes of each invocation.
+     * @param outputs Receives the output attributes of each invocation.
+     * @param count Number of invocations.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                          const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                          std::size_t count) const;
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
@@ -5,7 +5,12 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <numeric>
+#include <vector>
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
 #include <boost/container/static_vector.hpp>
 #include <boost/range/algorithm/fill.hpp>
 #include <nihstro/shader_bytecode.h>
@@ -27,6 +32,241 @@ using nihstro::SwizzlePattern;
 
 namespace Pica::Shader {
 
+static_assert(sizeof(Common::Vec4<float24>) == 4 * sizeof(float),
+              "float24 vectors are operated on as 4 floats");
+
+namespace {
+
+/**
+ * A vec4 of float24 in a host SIMD register. Every operation matches the result of the scalar
+ * float24 operators exactly: products are rounded before any sum, and multiplying 0 by inf gives 0.
+ */
+#if defined(ARCHITECTURE_x86_64)
+struct Vec4Reg {
+    __m128 v;
+
+    static Vec4Reg Load(const float24* src) {
+        return {_mm_loadu_ps(reinterpret_cast<const float*>(src))};
+    }
+    void Store(float24* dest) const {
+        _mm_storeu_ps(reinterpret_cast<float*>(dest), v);
+    }
+    static Vec4Reg LoadMask(const std::array<u32, 4>& mask) {
+        return {_mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.data())))};
+    }
+
+    Vec4Reg operator-() const {
+        return {_mm_xor_ps(v, _mm_set1_ps(-0.0f))};
+    }
+    Vec4Reg operator+(Vec4Reg other) const {
+        return {_mm_add_ps(v, other.v)};
+    }
+    Vec4Reg operator*(Vec4Reg other) const {
+        const __m128 product = _mm_mul_ps(v, other.v);
+        const __m128 nan_product = _mm_cmpunord_ps(product, product);
+        const __m128 nan_input = _mm_cmpunord_ps(v, other.v);
+        return {_mm_andnot_ps(_mm_andnot_ps(nan_input, nan_product), product)};
+    }
+    // MAXPS and MINPS return the second operand unless the comparison holds, as MAX and MIN do
+    static Vec4Reg Max(Vec4Reg a, Vec4Reg b) {
+        return {_mm_max_ps(a.v, b.v)};
+    }
+    static Vec4Reg Min(Vec4Reg a, Vec4Reg b) {
+        return {_mm_min_ps(a.v, b.v)};
+    }
+    static Vec4Reg GreaterEqual(Vec4Reg a, Vec4Reg b) {
+        return {_mm_and_ps(_mm_cmpge_ps(a.v, b.v), _mm_set1_ps(1.0f))};
+    }
+    static Vec4Reg LessThan(Vec4Reg a, Vec4Reg b) {
+        return {_mm_and_ps(_mm_cmplt_ps(a.v, b.v), _mm_set1_ps(1.0f))};
+    }
+    /// Takes the components of `a` where `mask` is set and those of `b` elsewhere
+    static Vec4Reg Select(Vec4Reg mask, Vec4Reg a, Vec4Reg b) {
+        return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+    }
+};
+#elif defined(ARCHITECTURE_ARM64)
+struct Vec4Reg {
+    float32x4_t v;
+
+    static Vec4Reg Load(const float24* src) {
+        return {vld1q_f32(reinterpret_cast<const float*>(src))};
+    }
+    void Store(float24* dest) const {
+        vst1q_f32(reinterpret_cast<float*>(dest), v);
+    }
+    static Vec4Reg LoadMask(const std::array<u32, 4>& mask) {
+        return {vreinterpretq_f32_u32(vld1q_u32(mask.data()))};
+    }
+
+    Vec4Reg operator-() const {
+        return {vnegq_f32(v)};
+    }
+    Vec4Reg operator+(Vec4Reg other) const {
+        return {vaddq_f32(v, other.v)};
+    }
+    Vec4Reg operator*(Vec4Reg other) const {
+        const float32x4_t product = vmulq_f32(v, other.v);
+        const uint32x4_t nan_product = vmvnq_u32(vceqq_f32(product, product));
+        const uint32x4_t valid_input = vandq_u32(vceqq_f32(v, v), vceqq_f32(other.v, other.v));
+        return {vbslq_f32(vandq_u32(nan_product, valid_input), vdupq_n_f32(0.0f), product)};
+    }
+    // FMAX and FMIN propagate NaNs differently, so these select on the comparison
+    static Vec4Reg Max(Vec4Reg a, Vec4Reg b) {
+        return {vbslq_f32(vcgtq_f32(a.v, b.v), a.v, b.v)};
+    }
+    static Vec4Reg Min(Vec4Reg a, Vec4Reg b) {
+        return {vbslq_f32(vcltq_f32(a.v, b.v), a.v, b.v)};
+    }
+    static Vec4Reg GreaterEqual(Vec4Reg a, Vec4Reg b) {
+        return {vbslq_f32(vcgeq_f32(a.v, b.v), vdupq_n_f32(1.0f), vdupq_n_f32(0.0f))};
+    }
+    static Vec4Reg LessThan(Vec4Reg a, Vec4Reg b) {
+        return {vbslq_f32(vcltq_f32(a.v, b.v), vdupq_n_f32(1.0f), vdupq_n_f32(0.0f))};
+    }
+    /// Takes the components of `a` where `mask` is set and those of `b` elsewhere
+    static Vec4Reg Select(Vec4Reg mask, Vec4Reg a, Vec4Reg b) {
+        return {vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)};
+    }
+};
+#else
+struct Vec4Reg {
+    std::array<float24, 4> v;
+
+    template <typename F>
+    static Vec4Reg Map(F&& f) {
+        return {{f(0), f(1), f(2), f(3)}};
+    }
+
+    static Vec4Reg Load(const float24* src) {
+        return {{src[0], src[1], src[2], src[3]}};
+    }
+    void Store(float24* dest) const {
+        std::copy(v.begin(), v.end(), dest);
+    }
+    static Vec4Reg LoadMask(const std::array<u32, 4>& mask) {
+        return Map([&](int i) { return float24::FromFloat32(mask[i] != 0 ? 1.0f : 0.0f); });
+    }
+
+    Vec4Reg operator-() const {
+        return Map([&](int i) { return -v[i]; });
+    }
+    Vec4Reg operator+(Vec4Reg other) const {
+        return Map([&](int i) { return v[i] + other.v[i]; });
+    }
+    Vec4Reg operator*(Vec4Reg other) const {
+        return Map([&](int i) { return v[i] * other.v[i]; });
+    }
+    static Vec4Reg Max(Vec4Reg a, Vec4Reg b) {
+        return Map([&](int i) { return (a.v[i] > b.v[i]) ? a.v[i] : b.v[i]; });
+    }
+    static Vec4Reg Min(Vec4Reg a, Vec4Reg b) {
+        return Map([&](int i) { return (a.v[i] < b.v[i]) ? a.v[i] : b.v[i]; });
+    }
+    static Vec4Reg GreaterEqual(Vec4Reg a, Vec4Reg b) {
+        return Map([&](int i) { return float24::FromFloat32(a.v[i] >= b.v[i] ? 1.0f : 0.0f); });
+    }
+    static Vec4Reg LessThan(Vec4Reg a, Vec4Reg b) {
+        return Map([&](int i) { return float24::FromFloat32(a.v[i] < b.v[i] ? 1.0f : 0.0f); });
+    }
+    /// Takes the components of `a` where `mask` is set and those of `b` elsewhere
+    static Vec4Reg Select(Vec4Reg mask, Vec4Reg a, Vec4Reg b) {
+        return Map([&](int i) { return mask.v[i].ToFloat32() != 0.0f ? a.v[i] : b.v[i]; });
+    }
+};
+#endif
+
+/// A source operand with its swizzle resolved
+struct DecodedSource {
+    SourceRegister reg;
+    /// Whether the address register of the instruction offsets the register index
+    bool is_relative;
+    bool negate;
+    std::array<u8, 4> selectors;
+};
+
+} // Anonymous namespace
+
+/**
+ * An instruction with its operand descriptor looked up, so that executing it does not decode the
+ * swizzle pattern again.
+ */
+struct DecodedInstruction {
+    Instruction instr;
+    OpCode::Type type;
+    OpCode::Id opcode; ///< Effective opcode of arithmetic and multiply-add instructions
+    std::array<DecodedSource, 3> src;
+    DestRegister dest;
+    u32 address_register_index;
+    /// All bits set in the enabled components of the destination
+    std::array<u32, 4> dest_mask;
+};
+
+struct DecodedProgram {
+    std::array<DecodedInstruction, MAX_PROGRAM_CODE_LENGTH> instructions;
+};
+
+static std::unique_ptr<DecodedProgram> DecodeProgram(const ProgramCode& program_code,
+                                                     const SwizzleData& swizzle_data) {
+    auto program = std::make_unique<DecodedProgram>();
+    for (std::size_t i = 0; i < program_code.size(); ++i) {
+        DecodedInstruction& decoded = program->instructions[i];
+        const Instruction instr = {program_code[i]};
+        decoded.instr = instr;
+        decoded.type = instr.opcode.Value().GetInfo().type;
+        decoded.opcode = instr.opcode.Value().EffectiveOpCode();
+
+        const bool is_mad = decoded.type == OpCode::Type::MultiplyAdd;
+        if (!is_mad && decoded.type != OpCode::Type::Arithmetic) {
+            continue;
+        }
+        const u32 operand_desc_id =
+            is_mad ? instr.mad.operand_desc_id.Value() : instr.common.operand_desc_id.Value();
+        const SwizzlePattern swizzle = {swizzle_data[operand_desc_id]};
+
+        for (int c = 0; c < 4; ++c) {
+            decoded.dest_mask[c] = swizzle.DestComponentEnabled(c) ? 0xFFFFFFFF : 0;
+        }
+        decoded.src[0].selectors = {static_cast<u8>(swizzle.src1_selector_0.Value()),
+                                    static_cast<u8>(swizzle.src1_selector_1.Value()),
+                                    static_cast<u8>(swizzle.src1_selector_2.Value()),
+                                    static_cast<u8>(swizzle.src1_selector_3.Value())};
+        decoded.src[1].selectors = {static_cast<u8>(swizzle.src2_selector_0.Value()),
+                                    static_cast<u8>(swizzle.src2_selector_1.Value()),
+                                    static_cast<u8>(swizzle.src2_selector_2.Value()),
+                                    static_cast<u8>(swizzle.src2_selector_3.Value())};
+        decoded.src[2].selectors = {static_cast<u8>(swizzle.src3_selector_0.Value()),
+                                    static_cast<u8>(swizzle.src3_selector_1.Value()),
+                                    static_cast<u8>(swizzle.src3_selector_2.Value()),
+                                    static_cast<u8>(swizzle.src3_selector_3.Value())};
+        decoded.src[0].negate = swizzle.negate_src1 != 0;
+        decoded.src[1].negate = swizzle.negate_src2 != 0;
+        decoded.src[2].negate = swizzle.negate_src3 != 0;
+
+        if (is_mad) {
+            const bool is_inverted = decoded.opcode == OpCode::Id::MADI;
+            decoded.src[0].reg = instr.mad.GetSrc1(is_inverted);
+            decoded.src[1].reg = instr.mad.GetSrc2(is_inverted);
+            decoded.src[2].reg = instr.mad.GetSrc3(is_inverted);
+            decoded.src[0].is_relative = false;
+            decoded.src[1].is_relative = !is_inverted;
+            decoded.src[2].is_relative = is_inverted;
+            decoded.dest = instr.mad.dest.Value();
+            decoded.address_register_index = instr.mad.address_register_index;
+        } else {
+            const bool is_inverted =
+                0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed);
+            decoded.src[0].reg = instr.common.GetSrc1(is_inverted);
+            decoded.src[1].reg = instr.common.GetSrc2(is_inverted);
+            decoded.src[0].is_relative = !is_inverted;
+            decoded.src[1].is_relative = is_inverted;
+            decoded.dest = instr.common.dest.Value();
+            decoded.address_register_index = instr.common.address_register_index;
+        }
+    }
+    return program;
+}
+
 struct CallStackElement {
     u32 final_address;  // Address upon which we jump to return_address
     u32 return_address; // Where to jump when leaving scope
@@ -37,8 +277,8 @@ struct CallStackElement {
 };
 
 template <bool Debug>
-static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData<Debug>& debug_data,
-                           unsigned offset) {
+static void RunInterpreter(const ShaderSetup& setup, const DecodedProgram& program,
+                           UnitState& state, DebugData<Debug>& debug_data, unsigned offset) {
     // TODO: Is there a maximal size for this?
     boost::container::static_vector<CallStackElement, 16> call_stack;
     u32 program_counter = offset;
@@ -77,8 +317,6 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
     };
 
     const auto& uniforms = setup.uniforms;
-    const auto& swizzle_data = setup.swizzle_data;
-    const auto& program_code = setup.program_code;
 
     // Placeholder for invalid inputs
     static float24 dummy_vec4_float24[4];
@@ -103,8 +341,8 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
             }
         }
 
-        const Instruction instr = {program_code[program_counter]};
-        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        const DecodedInstruction& decoded = program.instructions[program_counter];
+        const Instruction instr = decoded.instr;
 
         Record<DebugDataRecord::CUR_INSTR>(debug_data, iteration, program_counter);
         if (iteration > 0)
@@ -128,70 +366,61 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
             }
         };
 
-        switch (instr.opcode.Value().GetInfo().type) {
-        case OpCode::Type::Arithmetic: {
-            const bool is_inverted =
-                (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+        // Swizzles and negates a source operand into `values`, which the debug records read
+        auto LoadSource = [&](const DecodedSource& source, int address_offset,
+                              float24 (&values)[4]) {
+            const float24* reg =
+                LookupSourceRegister(source.reg + (source.is_relative ? address_offset : 0));
+            for (int i = 0; i < 4; ++i) {
+                values[i] = reg[source.selectors[i]];
+            }
+            Vec4Reg value = Vec4Reg::Load(values);
+            if (source.negate) {
+                value = -value;
+                if constexpr (Debug) {
+                    value.Store(values);
+                }
+            }
+            return value;
+        };
+
+        auto LookupDest = [&]() -> float24* {
+            return (decoded.dest < 0x10)
+                       ? &state.registers.output[decoded.dest.GetIndex()][0]
+                       : (decoded.dest < 0x20)
+                             ? &state.registers.temporary[decoded.dest.GetIndex()][0]
+                             : dummy_vec4_float24;
+        };
 
+        // Writes the enabled components of `value` to `dest`
+        auto WriteDest = [&](float24* dest, Vec4Reg value) {
+            const Vec4Reg old_value = Vec4Reg::Load(dest);
+            Vec4Reg::Select(Vec4Reg::LoadMask(decoded.dest_mask), value, old_value).Store(dest);
+        };
+
+        switch (decoded.type) {
+        case OpCode::Type::Arithmetic: {
             const int address_offset =
-                (instr.common.address_register_index == 0)
+                (decoded.address_register_index == 0)
                     ? 0
-                    : state.address_registers[instr.common.address_register_index - 1];
-
-            const float24* src1_ = LookupSourceRegister(instr.common.GetSrc1(is_inverted) +
-                                                        (is_inverted ? 0 : address_offset));
-            const float24* src2_ = LookupSourceRegister(instr.common.GetSrc2(is_inverted) +
-                                                        (is_inverted ? address_offset : 0));
-
-            const bool negate_src1 = ((bool)swizzle.negate_src1 != false);
-            const bool negate_src2 = ((bool)swizzle.negate_src2 != false);
-
-            float24 src1[4] = {
-                src1_[(int)swizzle.src1_selector_0.Value()],
-                src1_[(int)swizzle.src1_selector_1.Value()],
-                src1_[(int)swizzle.src1_selector_2.Value()],
-                src1_[(int)swizzle.src1_selector_3.Value()],
-            };
-            if (negate_src1) {
-                src1[0] = -src1[0];
-                src1[1] = -src1[1];
-                src1[2] = -src1[2];
-                src1[3] = -src1[3];
-            }
-            float24 src2[4] = {
-                src2_[(int)swizzle.src2_selector_0.Value()],
-                src2_[(int)swizzle.src2_selector_1.Value()],
-                src2_[(int)swizzle.src2_selector_2.Value()],
-                src2_[(int)swizzle.src2_selector_3.Value()],
-            };
-            if (negate_src2) {
-                src2[0] = -src2[0];
-                src2[1] = -src2[1];
-                src2[2] = -src2[2];
-                src2[3] = -src2[3];
-            }
+                    : state.address_registers[decoded.address_register_index - 1];
+
+            float24 src1[4];
+            float24 src2[4];
+            const Vec4Reg src1_vec = LoadSource(decoded.src[0], address_offset, src1);
+            const Vec4Reg src2_vec = LoadSource(decoded.src[1], address_offset, src2);
 
-            float24* dest =
-                (instr.common.dest.Value() < 0x10)
-                    ? &state.registers.output[instr.common.dest.Value().GetIndex()][0]
-                    : (instr.common.dest.Value() < 0x20)
-                          ? &state.registers.temporary[instr.common.dest.Value().GetIndex()][0]
-                          : dummy_vec4_float24;
+            float24* dest = LookupDest();
 
             debug_data.max_opdesc_id =
                 std::max<u32>(debug_data.max_opdesc_id, 1 + instr.common.operand_desc_id);
 
-            switch (instr.opcode.Value().EffectiveOpCode()) {
+            switch (decoded.opcode) {
             case OpCode::Id::ADD: {
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] + src2[i];
-                }
+                WriteDest(dest, src1_vec + src2_vec);
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
             }
@@ -200,12 +429,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] * src2[i];
-                }
+                WriteDest(dest, src1_vec * src2_vec);
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
             }
@@ -214,7 +438,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!decoded.dest_mask[i])
                         continue;
 
                     dest[i] = float24::FromFloat32(std::floor(src1[i].ToFloat32()));
@@ -226,15 +450,10 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    // NOTE: Exact form required to match NaN semantics to hardware:
-                    //   max(0, NaN) -> NaN
-                    //   max(NaN, 0) -> 0
-                    dest[i] = (src1[i] > src2[i]) ? src1[i] : src2[i];
-                }
+                // NOTE: Exact form required to match NaN semantics to hardware:
+                //   max(0, NaN) -> NaN
+                //   max(NaN, 0) -> 0
+                WriteDest(dest, Vec4Reg::Max(src1_vec, src2_vec));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
 
@@ -242,15 +461,10 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    // NOTE: Exact form required to match NaN semantics to hardware:
-                    //   min(0, NaN) -> NaN
-                    //   min(NaN, 0) -> 0
-                    dest[i] = (src1[i] < src2[i]) ? src1[i] : src2[i];
-                }
+                // NOTE: Exact form required to match NaN semantics to hardware:
+                //   min(0, NaN) -> NaN
+                //   min(NaN, 0) -> 0
+                WriteDest(dest, Vec4Reg::Min(src1_vec, src2_vec));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
 
@@ -262,16 +476,24 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
 
-                OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
-                if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
+                OpCode::Id opcode = decoded.opcode;
+                Vec4Reg dot_src1 = src1_vec;
+                if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI) {
                     src1[3] = float24::FromFloat32(1.0f);
+                    dot_src1 = Vec4Reg::Load(src1);
+                }
 
+                // The products are summed in order, as the rounding of each sum depends on it
+                float24 products[4];
+                (dot_src1 * src2_vec).Store(products);
                 int num_components = (opcode == OpCode::Id::DP3) ? 3 : 4;
-                float24 dot = std::inner_product(src1, src1 + num_components, src2,
-                                                 float24::FromFloat32(0.f));
+                float24 dot = float24::FromFloat32(0.f);
+                for (int i = 0; i < num_components; ++i) {
+                    dot = dot + products[i];
+                }
 
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!decoded.dest_mask[i])
                         continue;
 
                     dest[i] = dot;
@@ -286,7 +508,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
                 float24 rcp_res = float24::FromFloat32(1.0f / src1[0].ToFloat32());
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!decoded.dest_mask[i])
                         continue;
 
                     dest[i] = rcp_res;
@@ -301,7 +523,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
                 float24 rsq_res = float24::FromFloat32(1.0f / std::sqrt(src1[0].ToFloat32()));
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!decoded.dest_mask[i])
                         continue;
 
                     dest[i] = rsq_res;
@@ -313,7 +535,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
             case OpCode::Id::MOVA: {
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 for (int i = 0; i < 2; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!decoded.dest_mask[i])
                         continue;
 
                     // TODO: Figure out how the rounding is done on hardware
@@ -327,12 +549,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
             case OpCode::Id::MOV: {
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i];
-                }
+                WriteDest(dest, src1_vec);
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
             }
@@ -342,13 +559,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = (src1[i] >= src2[i]) ? float24::FromFloat32(1.0f)
-                                                   : float24::FromFloat32(0.0f);
-                }
+                WriteDest(dest, Vec4Reg::GreaterEqual(src1_vec, src2_vec));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
 
@@ -357,16 +568,9 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = (src1[i] < src2[i]) ? float24::FromFloat32(1.0f)
-                                                  : float24::FromFloat32(0.0f);
-                }
+                WriteDest(dest, Vec4Reg::LessThan(src1_vec, src2_vec));
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
                 break;
-
             case OpCode::Id::CMP:
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
@@ -416,7 +620,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 // EX2 only takes first component exp2 and writes it to all dest components
                 float24 ex2_res = float24::FromFloat32(std::exp2(src1[0].ToFloat32()));
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!decoded.dest_mask[i])
                         continue;
 
                     dest[i] = ex2_res;
@@ -433,7 +637,7 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
                 // LG2 only takes the first component log2 and writes it to all dest components
                 float24 lg2_res = float24::FromFloat32(std::log2(src1[0].ToFloat32()));
                 for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
+                    if (!decoded.dest_mask[i])
                         continue;
 
                     dest[i] = lg2_res;
@@ -455,82 +659,26 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
         }
 
         case OpCode::Type::MultiplyAdd: {
-            if ((instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD) ||
-                (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI)) {
-                const SwizzlePattern& swizzle = *reinterpret_cast<const SwizzlePattern*>(
-                    &swizzle_data[instr.mad.operand_desc_id]);
-
-                bool is_inverted = (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI);
-
+            if ((decoded.opcode == OpCode::Id::MAD) || (decoded.opcode == OpCode::Id::MADI)) {
                 const int address_offset =
-                    (instr.mad.address_register_index == 0)
+                    (decoded.address_register_index == 0)
                         ? 0
-                        : state.address_registers[instr.mad.address_register_index - 1];
-
-                const float24* src1_ = LookupSourceRegister(instr.mad.GetSrc1(is_inverted));
-                const float24* src2_ = LookupSourceRegister(instr.mad.GetSrc2(is_inverted) +
-                                                            (!is_inverted * address_offset));
-                const float24* src3_ = LookupSourceRegister(instr.mad.GetSrc3(is_inverted) +
-                                                            (is_inverted * address_offset));
-
-                const bool negate_src1 = ((bool)swizzle.negate_src1 != false);
-                const bool negate_src2 = ((bool)swizzle.negate_src2 != false);
-                const bool negate_src3 = ((bool)swizzle.negate_src3 != false);
-
-                float24 src1[4] = {
-                    src1_[(int)swizzle.src1_selector_0.Value()],
-                    src1_[(int)swizzle.src1_selector_1.Value()],
-                    src1_[(int)swizzle.src1_selector_2.Value()],
-                    src1_[(int)swizzle.src1_selector_3.Value()],
-                };
-                if (negate_src1) {
-                    src1[0] = -src1[0];
-                    src1[1] = -src1[1];
-                    src1[2] = -src1[2];
-                    src1[3] = -src1[3];
-                }
-                float24 src2[4] = {
-                    src2_[(int)swizzle.src2_selector_0.Value()],
-                    src2_[(int)swizzle.src2_selector_1.Value()],
-                    src2_[(int)swizzle.src2_selector_2.Value()],
-                    src2_[(int)swizzle.src2_selector_3.Value()],
-                };
-                if (negate_src2) {
-                    src2[0] = -src2[0];
-                    src2[1] = -src2[1];
-                    src2[2] = -src2[2];
-                    src2[3] = -src2[3];
-                }
-                float24 src3[4] = {
-                    src3_[(int)swizzle.src3_selector_0.Value()],
-                    src3_[(int)swizzle.src3_selector_1.Value()],
-                    src3_[(int)swizzle.src3_selector_2.Value()],
-                    src3_[(int)swizzle.src3_selector_3.Value()],
-                };
-                if (negate_src3) {
-                    src3[0] = -src3[0];
-                    src3[1] = -src3[1];
-                    src3[2] = -src3[2];
-                    src3[3] = -src3[3];
-                }
+                        : state.address_registers[decoded.address_register_index - 1];
+
+                float24 src1[4];
+                float24 src2[4];
+                float24 src3[4];
+                const Vec4Reg src1_vec = LoadSource(decoded.src[0], address_offset, src1);
+                const Vec4Reg src2_vec = LoadSource(decoded.src[1], address_offset, src2);
+                const Vec4Reg src3_vec = LoadSource(decoded.src[2], address_offset, src3);
 
-                float24* dest =
-                    (instr.mad.dest.Value() < 0x10)
-                        ? &state.registers.output[instr.mad.dest.Value().GetIndex()][0]
-                        : (instr.mad.dest.Value() < 0x20)
-                              ? &state.registers.temporary[instr.mad.dest.Value().GetIndex()][0]
-                              : dummy_vec4_float24;
+                float24* dest = LookupDest();
 
                 Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
                 Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
                 Record<DebugDataRecord::SRC3>(debug_data, iteration, src3);
                 Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] * src2[i] + src3[i];
-                }
+                WriteDest(dest, src1_vec * src2_vec + src3_vec);
                 Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
             } else {
                 LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x{:02x} ({}): 0x{:08x}",
@@ -666,19 +814,34 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
     }
 }
 
+InterpreterEngine::InterpreterEngine() = default;
+InterpreterEngine::~InterpreterEngine() = default;
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
+
+    const u64 cache_key = setup.GetProgramCodeHash() ^ setup.GetSwizzleDataHash();
+    auto iter = cache.find(cache_key);
+    if (iter != cache.end()) {
+        setup.engine_data.cached_shader = iter->second.get();
+    } else {
+        auto program = DecodeProgram(setup.program_code, setup.swizzle_data);
+        setup.engine_data.cached_shader = program.get();
+        cache.emplace_hint(iter, cache_key, std::move(program));
+    }
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void InterpreterEngine::Run(const ShaderSetup& setup, UnitState& state) const {
+    ASSERT(setup.engine_data.cached_shader != nullptr);
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
+    const auto& program = *static_cast<const DecodedProgram*>(setup.engine_data.cached_shader);
     DebugData<false> dummy_debug_data;
-    RunInterpreter(setup, state, dummy_debug_data, setup.engine_data.entry_point);
+    RunInterpreter(setup, program, state, dummy_debug_data, setup.engine_data.entry_point);
 }
 
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
@@ -687,10 +850,13 @@ DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
     UnitState state;
     DebugData<true> debug_data;
 
+    // The setup may have been prepared by another engine, so the program is decoded again
+    const auto program = DecodeProgram(setup.program_code, setup.swizzle_data);
+
     // Setup input register table
     boost::fill(state.registers.input, Common::Vec4<float24>::AssignToAll(float24::Zero()));
     state.LoadInput(config, input);
-    RunInterpreter(setup, state, debug_data, setup.engine_data.entry_point);
+    RunInterpreter(setup, *program, state, debug_data, setup.engine_data.entry_point);
     return debug_data;
 }
 
@@ -4,13 +4,25 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include "common/common_types.h"
 #include "video_core/shader/debug_data.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Shader {
 
+struct DecodedProgram;
+
+/**
+ * Interprets shaders from a copy of the program decoded once per program and swizzle data, with
+ * the vec4 operations in host SIMD registers.
+ */
 class InterpreterEngine final : public ShaderEngine {
 public:
+    InterpreterEngine();
+    ~InterpreterEngine() override;
+
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
 
@@ -23,6 +35,9 @@ public:
      */
     DebugData<true> ProduceDebugInfo(const ShaderSetup& setup, const AttributeBuffer& input,
                                      const ShaderRegs& config) const;
+
+private:
+    std::unordered_map<u64, std::unique_ptr<DecodedProgram>> cache;
 };
 
 } // namespace Pica::Shader
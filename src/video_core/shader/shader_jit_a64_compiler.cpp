@@ -0,0 +1,1063 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <nihstro/shader_bytecode.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/vector_math.h"
+#include "video_core/pica_state.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_a64_compiler.h"
+
+using namespace Common::A64;
+
+namespace Pica::Shader {
+
+typedef void (JitShader::*JitFunction)(Instruction instr);
+
+const JitFunction instr_table[64] = {
+    &JitShader::Compile_ADD,    // add
+    &JitShader::Compile_DP3,    // dp3
+    &JitShader::Compile_DP4,    // dp4
+    &JitShader::Compile_DPH,    // dph
+    nullptr,                    // unknown
+    &JitShader::Compile_EX2,    // ex2
+    &JitShader::Compile_LG2,    // lg2
+    nullptr,                    // unknown
+    &JitShader::Compile_MUL,    // mul
+    &JitShader::Compile_SGE,    // sge
+    &JitShader::Compile_SLT,    // slt
+    &JitShader::Compile_FLR,    // flr
+    &JitShader::Compile_MAX,    // max
+    &JitShader::Compile_MIN,    // min
+    &JitShader::Compile_RCP,    // rcp
+    &JitShader::Compile_RSQ,    // rsq
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    &JitShader::Compile_MOVA,   // mova
+    &JitShader::Compile_MOV,    // mov
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    &JitShader::Compile_DPH,    // dphi
+    nullptr,                    // unknown
+    &JitShader::Compile_SGE,    // sgei
+    &JitShader::Compile_SLT,    // slti
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    &JitShader::Compile_NOP,    // nop
+    &JitShader::Compile_END,    // end
+    &JitShader::Compile_BREAKC, // breakc
+    &JitShader::Compile_CALL,   // call
+    &JitShader::Compile_CALLC,  // callc
+    &JitShader::Compile_CALLU,  // callu
+    &JitShader::Compile_IF,     // ifu
+    &JitShader::Compile_IF,     // ifc
+    &JitShader::Compile_LOOP,   // loop
+    &JitShader::Compile_EMIT,   // emit
+    &JitShader::Compile_SETE,   // sete
+    &JitShader::Compile_JMP,    // jmpc
+    &JitShader::Compile_JMP,    // jmpu
+    &JitShader::Compile_CMP,    // cmp
+    &JitShader::Compile_CMP,    // cmp
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+};
+
+// The following is used to alias some commonly used registers. Generally, X0-X1, X16 and V0-V6 can
+// be used as scratch registers within a compiler function. The other registers have designated
+// purposes, as documented below. They are all callee saved in AAPCS64, so they survive calls into
+// host functions.
+
+/// Pointer to the uniform memory
+constexpr XReg UNIFORMS = X19;
+/// Pointer to the UnitState instance for the current VS unit
+constexpr XReg STATE = X20;
+/// The two 32-bit VS address offset registers set by the MOVA instruction
+constexpr XReg ADDROFFS_REG_0 = X21;
+constexpr XReg ADDROFFS_REG_1 = X22;
+/// VS loop count register (Multiplied by 16)
+constexpr WReg LOOPCOUNT_REG = W23;
+/// Current VS loop iteration number (we could probably use LOOPCOUNT_REG, but this quicker)
+constexpr WReg LOOPCOUNT = W24;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration (Multiplied by 16)
+constexpr WReg LOOPINC = W25;
+/// Result of the previous CMP instruction for the X-component comparison
+constexpr XReg COND0 = X26;
+/// Result of the previous CMP instruction for the Y-component comparison
+constexpr XReg COND1 = X27;
+/// Scratch register used to address relative source registers and to call host functions
+constexpr XReg XSCRATCH = X16;
+/// SIMD scratch register
+constexpr VReg SCRATCH = V0;
+/// Loaded with the first swizzled source register, otherwise can be used as a scratch register
+constexpr VReg SRC1 = V1;
+/// Loaded with the second swizzled source register, otherwise can be used as a scratch register
+constexpr VReg SRC2 = V2;
+/// Loaded with the third swizzled source register, otherwise can be used as a scratch register
+constexpr VReg SRC3 = V3;
+/// Additional scratch register
+constexpr VReg SCRATCH2 = V4;
+/// Holds the unswizzled source while Compile_SwizzleSrc rearranges its components
+constexpr VReg SWIZZLE_TEMP = V5;
+/// Holds the constants of the prelude subroutines
+constexpr VReg CONSTANT = V6;
+
+/// Size of the frame that saves the callee saved registers of the host
+constexpr s32 FRAME_SIZE = 96;
+
+/// Raw constant for the source register selector that indicates no swizzling is performed
+static const u8 NO_SRC_REG_SWIZZLE = 0x1b;
+/// Raw constant for the destination register enable mask that indicates all components are enabled
+static const u8 NO_DEST_REG_MASK = 0xf;
+
+static void LogCritical(const char* msg) {
+    LOG_CRITICAL(HW_GPU, "{}", msg);
+}
+
+template <typename T>
+void JitShader::Compile_CallHost(T* function) {
+    // Preserve the link register, which may hold the return address of a shader subroutine
+    stp(X30, XZR, SP, -16, IndexMode::PreIndex);
+    mov(XSCRATCH, reinterpret_cast<std::uintptr_t>(function));
+    blr(XSCRATCH);
+    ldp(X30, XZR, SP, 16, IndexMode::PostIndex);
+}
+
+void JitShader::Compile_Assert(bool condition, const char* msg) {
+    if (!condition) {
+        mov(X0, reinterpret_cast<std::uintptr_t>(msg));
+        Compile_CallHost(LogCritical);
+    }
+}
+
+/**
+ * Loads and swizzles a source register into the specified SIMD register.
+ * @param instr VS instruction, used for determining how to load the source register
+ * @param src_num Number indicating which source register to load (1 = src1, 2 = src2, 3 = src3)
+ * @param src_reg SourceRegister object corresponding to the source register to load
+ * @param dest Destination SIMD register to store the loaded, swizzled source register
+ */
+void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
+                                   VReg dest) {
+    XReg src_ptr;
+    std::size_t src_offset;
+
+    if (src_reg.GetRegisterType() == RegisterType::FloatUniform) {
+        src_ptr = UNIFORMS;
+        src_offset = Uniforms::GetFloatUniformOffset(src_reg.GetIndex());
+    } else {
+        src_ptr = STATE;
+        src_offset = UnitState::InputOffset(src_reg);
+    }
+
+    unsigned operand_desc_id;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    unsigned address_register_index;
+    unsigned offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    if (src_num == offset_src && address_register_index != 0) {
+        switch (address_register_index) {
+        case 1: // address offset 1
+            add(XSCRATCH, src_ptr, ADDROFFS_REG_0);
+            break;
+        case 2: // address offset 2
+            add(XSCRATCH, src_ptr, ADDROFFS_REG_1);
+            break;
+        case 3: // address offset 3, 32-bit writes to LOOPCOUNT_REG keep its upper half zero
+            add(XSCRATCH, src_ptr, XReg{LOOPCOUNT_REG.index});
+            break;
+        default:
+            UNREACHABLE();
+            break;
+        }
+        ldr(dest.Q(), XSCRATCH, static_cast<u32>(src_offset));
+    } else {
+        // Load the source
+        ldr(dest.Q(), src_ptr, static_cast<u32>(src_offset));
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    // Generate instructions for source register swizzling as needed
+    const u8 sel = swiz.GetRawSelector(src_num);
+    if (sel != NO_SRC_REG_SWIZZLE) {
+        // The selector of the X component is stored in the topmost bits
+        const auto component = [sel](u32 lane) { return (sel >> (6 - 2 * lane)) & 3; };
+        if (component(0) == component(1) && component(0) == component(2) &&
+            component(0) == component(3)) {
+            dup(dest, dest[component(0)]);
+        } else {
+            orr(SWIZZLE_TEMP, dest, dest);
+            for (u32 lane = 0; lane < 4; ++lane) {
+                if (component(lane) != lane) {
+                    ins(dest[lane], SWIZZLE_TEMP[component(lane)]);
+                }
+            }
+        }
+    }
+
+    // If the source register should be negated, flip the negative bit
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        fneg(dest, dest);
+    }
+}
+
+void JitShader::Compile_DestEnable(Instruction instr, VReg src) {
+    DestRegister dest;
+    unsigned operand_desc_id;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        dest = instr.mad.dest.Value();
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        dest = instr.common.dest.Value();
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    const u32 dest_offset_disp = static_cast<u32>(UnitState::OutputOffset(dest));
+
+    // If all components are enabled, write the result to the destination register
+    if (swiz.dest_mask == NO_DEST_REG_MASK) {
+        // Store dest back to memory
+        str(src.Q(), STATE, dest_offset_disp);
+
+    } else {
+        // Not all components are enabled, so only copy the enabled ones into the destination
+        // register...
+        ldr(SCRATCH.Q(), STATE, dest_offset_disp);
+        for (u32 lane = 0; lane < 4; ++lane) {
+            if (swiz.DestComponentEnabled(lane)) {
+                ins(SCRATCH[lane], src[lane]);
+            }
+        }
+
+        // Store dest back to memory
+        str(SCRATCH.Q(), STATE, dest_offset_disp);
+    }
+}
+
+void JitShader::Compile_SanitizedMul(VReg src1, VReg src2, VReg scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN. FMULX returns 2 for these
+    // products instead of NaN, so its result is only NaN where one of the sources was. Where the
+    // FMUL result is NaN but the FMULX one is not, the NaN was generated by a 0 * inf
+    // multiplication, and so the result should be transformed to 0 to match PICA fp rules.
+    fmulx(scratch, src1, src2);
+    fmul(src1, src1, src2);
+
+    // Set src2 to mask of (result != NaN) and scratch to mask of (src1 != NaN and src2 != NaN)
+    fcmeq(src2, src1, src1);
+    fcmeq(scratch, scratch, scratch);
+
+    // Clear components where the result is NaN while neither source was
+    orn(src2, src2, scratch);
+    and_(src1, src1, src2);
+}
+
+void JitShader::Compile_EvaluateCondition(Instruction instr) {
+    // Flipping the condition codes that are compared against 0 turns the test into an equality
+    const auto load_condition = [this](WReg dest, XReg cond, u32 ref) {
+        if (ref == 0) {
+            eor(dest, ToW(cond), 1);
+        } else {
+            mov(XReg{dest.index}, cond);
+        }
+    };
+
+    switch (instr.flow_control.op) {
+    case Instruction::FlowControlType::Or:
+        load_condition(W0, COND0, instr.flow_control.refx.Value());
+        load_condition(W1, COND1, instr.flow_control.refy.Value());
+        orr(W0, W0, W1);
+        break;
+
+    case Instruction::FlowControlType::And:
+        load_condition(W0, COND0, instr.flow_control.refx.Value());
+        load_condition(W1, COND1, instr.flow_control.refy.Value());
+        and_(W0, W0, W1);
+        break;
+
+    case Instruction::FlowControlType::JustX:
+        load_condition(W0, COND0, instr.flow_control.refx.Value());
+        break;
+
+    case Instruction::FlowControlType::JustY:
+        load_condition(W0, COND1, instr.flow_control.refy.Value());
+        break;
+    }
+}
+
+void JitShader::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    ldrb(W0, UNIFORMS, static_cast<u32>(offset));
+}
+
+void JitShader::Compile_ADD(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    fadd(SRC1, SRC1, SRC2);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_DP3(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    // Clear the W product, then sum all components with pairwise additions
+    ins(SRC1[3], WZR);
+    faddp(SRC1, SRC1, SRC1);
+    faddp(SRC1, SRC1, SRC1);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_DP4(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    faddp(SRC1, SRC1, SRC1);
+    faddp(SRC1, SRC1, SRC1);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_DPH(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    // Set 4th component to 1.0
+    fmov(SCRATCH, 1.0f);
+    ins(SRC1[3], SCRATCH[0]);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    faddp(SRC1, SRC1, SRC1);
+    faddp(SRC1, SRC1, SRC1);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_EX2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    stp(X30, XZR, SP, -16, IndexMode::PreIndex);
+    bl(exp2_subroutine);
+    ldp(X30, XZR, SP, 16, IndexMode::PostIndex);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_LG2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    stp(X30, XZR, SP, -16, IndexMode::PreIndex);
+    bl(log2_subroutine);
+    ldp(X30, XZR, SP, 16, IndexMode::PostIndex);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_MUL(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_SGE(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    fcmge(SRC2, SRC1, SRC2);
+    fmov(SCRATCH, 1.0f);
+    and_(SRC2, SRC2, SCRATCH);
+
+    Compile_DestEnable(instr, SRC2);
+}
+
+void JitShader::Compile_SLT(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    fcmgt(SRC1, SRC2, SRC1);
+    fmov(SCRATCH, 1.0f);
+    and_(SRC1, SRC1, SCRATCH);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_FLR(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    frintm(SRC1, SRC1);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_MAX(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    // FMAX propagates NaNs, while the PICA200 returns SRC2 in case of NaN. Select by comparison.
+    fcmgt(SCRATCH, SRC1, SRC2);
+    bsl(SCRATCH, SRC1, SRC2);
+    Compile_DestEnable(instr, SCRATCH);
+}
+
+void JitShader::Compile_MIN(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    // FMIN propagates NaNs, while the PICA200 returns SRC2 in case of NaN. Select by comparison.
+    fcmgt(SCRATCH, SRC2, SRC1);
+    bsl(SCRATCH, SRC1, SRC2);
+    Compile_DestEnable(instr, SCRATCH);
+}
+
+void JitShader::Compile_MOVA(Instruction instr) {
+    SwizzlePattern swiz = {(*swizzle_data)[instr.common.operand_desc_id]};
+
+    if (!swiz.DestComponentEnabled(0) && !swiz.DestComponentEnabled(1)) {
+        return; // NoOp
+    }
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // Convert floats to integers using truncation (only care about X and Y components)
+    fcvtzs(SRC1, SRC1);
+
+    // Move and sign-extend each enabled component, multiplied by 16 to be used as an offset later
+    if (swiz.DestComponentEnabled(0)) {
+        smov(ADDROFFS_REG_0, SRC1[0]);
+        lsl(ADDROFFS_REG_0, ADDROFFS_REG_0, 4);
+    }
+    if (swiz.DestComponentEnabled(1)) {
+        smov(ADDROFFS_REG_1, SRC1[1]);
+        lsl(ADDROFFS_REG_1, ADDROFFS_REG_1, 4);
+    }
+}
+
+void JitShader::Compile_MOV(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // FRECPE is far less accurate than RCPSS, so perform the division like the interpreter does
+    fmov(SCRATCH.S(), 1.0f);
+    fdiv(SRC1.S(), SCRATCH.S(), SRC1.S());
+    dup(SRC1, SRC1[0]); // XYWZ -> XXXX
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // FRSQRTE is far less accurate than RSQRTSS, so compute it like the interpreter does
+    fsqrt(SRC1.S(), SRC1.S());
+    fmov(SCRATCH.S(), 1.0f);
+    fdiv(SRC1.S(), SCRATCH.S(), SRC1.S());
+    dup(SRC1, SRC1[0]); // XYWZ -> XXXX
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_NOP(Instruction instr) {}
+
+void JitShader::Compile_END(Instruction instr) {
+    // Save conditional code
+    strb(ToW(COND0), STATE, offsetof(UnitState, conditional_code[0]));
+    strb(ToW(COND1), STATE, offsetof(UnitState, conditional_code[1]));
+
+    // Save address/loop registers
+    asr(ADDROFFS_REG_0, ADDROFFS_REG_0, 4);
+    asr(ADDROFFS_REG_1, ADDROFFS_REG_1, 4);
+    asr(LOOPCOUNT_REG, LOOPCOUNT_REG, 4);
+    str(ToW(ADDROFFS_REG_0), STATE, offsetof(UnitState, address_registers[0]));
+    str(ToW(ADDROFFS_REG_1), STATE, offsetof(UnitState, address_registers[1]));
+    str(LOOPCOUNT_REG, STATE, offsetof(UnitState, address_registers[2]));
+
+    // The frame pointer still points at the saved registers if END is inside a subroutine
+    mov(SP, X29);
+    ldp(X19, X20, SP, 16);
+    ldp(X21, X22, SP, 32);
+    ldp(X23, X24, SP, 48);
+    ldp(X25, X26, SP, 64);
+    ldp(X27, X28, SP, 80);
+    ldp(X29, X30, SP, FRAME_SIZE, IndexMode::PostIndex);
+    ret();
+}
+
+void JitShader::Compile_BREAKC(Instruction instr) {
+    Compile_Assert(looping, "BREAKC must be inside a LOOP");
+    if (looping) {
+        Compile_EvaluateCondition(instr);
+        ASSERT(loop_break_label);
+        cbnz(W0, *loop_break_label);
+    }
+}
+
+void JitShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return, along with the return address of the current subroutine
+    mov(W0, instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+    stp(X0, X30, SP, -16, IndexMode::PreIndex);
+
+    // Call the subroutine
+    bl(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Skip over the return offset that's on the stack
+    ldp(X0, X30, SP, 16, IndexMode::PostIndex);
+}
+
+void JitShader::Compile_CALLC(Instruction instr) {
+    Compile_EvaluateCondition(instr);
+    Label b;
+    cbz(W0, b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    cbz(W0, b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitShader::Compile_CMP(Instruction instr) {
+    using Op = Instruction::Common::CompareOpType::Op;
+    Op op_x = instr.common.compare_op.x;
+    Op op_y = instr.common.compare_op.y;
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    // Sets every lane of dest to all ones where the comparison holds. NaNs compare unequal.
+    const auto compare = [this](Op op, VReg dest) {
+        switch (op) {
+        case Op::Equal:
+            fcmeq(dest, SRC1, SRC2);
+            break;
+        case Op::NotEqual:
+            fcmeq(dest, SRC1, SRC2);
+            mvn(dest, dest);
+            break;
+        case Op::LessThan:
+            fcmgt(dest, SRC2, SRC1);
+            break;
+        case Op::LessEqual:
+            fcmge(dest, SRC2, SRC1);
+            break;
+        case Op::GreaterThan:
+            fcmgt(dest, SRC1, SRC2);
+            break;
+        case Op::GreaterEqual:
+            fcmge(dest, SRC1, SRC2);
+            break;
+        default:
+            UNREACHABLE();
+            break;
+        }
+    };
+
+    if (op_x == op_y) {
+        // Compare X-component and Y-component together
+        compare(op_x, SCRATCH);
+        umov(ToW(COND0), SCRATCH[0]);
+        umov(ToW(COND1), SCRATCH[1]);
+    } else {
+        compare(op_x, SCRATCH);
+        compare(op_y, SCRATCH2);
+        umov(ToW(COND0), SCRATCH[0]);
+        umov(ToW(COND1), SCRATCH2[1]);
+    }
+
+    lsr(ToW(COND0), ToW(COND0), 31);
+    lsr(ToW(COND1), ToW(COND1), 31);
+}
+
+void JitShader::Compile_MAD(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.mad.src1, SRC1);
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2i, SRC2);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3i, SRC3);
+    } else {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2, SRC2);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3, SRC3);
+    }
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+    fadd(SRC1, SRC1, SRC3);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_IF(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards if-statements not supported");
+    Label l_else, l_endif;
+
+    // Evaluate the "IF" condition
+    if (instr.opcode.Value() == OpCode::Id::IFU) {
+        Compile_UniformCondition(instr);
+    } else if (instr.opcode.Value() == OpCode::Id::IFC) {
+        Compile_EvaluateCondition(instr);
+    }
+    cbz(W0, l_else);
+
+    // Compile the code that corresponds to the condition evaluating as true
+    Compile_Block(instr.flow_control.dest_offset);
+
+    // If there isn't an "ELSE" condition, we are done here
+    if (instr.flow_control.num_instructions == 0) {
+        L(l_else);
+        return;
+    }
+
+    b(l_endif);
+
+    L(l_else);
+    // This code corresponds to the "ELSE" condition
+    // Comple the code that corresponds to the condition evaluating as false
+    Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+
+    L(l_endif);
+}
+
+void JitShader::Compile_LOOP(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards loops not supported");
+    Compile_Assert(!looping, "Nested loops not supported");
+
+    looping = true;
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
+    // The Y (LOOPCOUNT_REG) and Z (LOOPINC) component are kept multiplied by 16 (Left shifted by
+    // 4 bits) to be used as an offset into the 16-byte vector registers later
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    ldr(LOOPCOUNT, UNIFORMS, static_cast<u32>(offset));
+    lsr(LOOPCOUNT_REG, LOOPCOUNT, 4);
+    and_(LOOPCOUNT_REG, LOOPCOUNT_REG, 0xFF0); // Y-component is the start
+    lsr(LOOPINC, LOOPCOUNT, 12);
+    and_(LOOPINC, LOOPINC, 0xFF0);     // Z-component is the incrementer
+    and_(LOOPCOUNT, LOOPCOUNT, 0xFF);  // X-component is iteration count
+    add(LOOPCOUNT, LOOPCOUNT, 1);      // Iteration count is X-component + 1
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    loop_break_label.emplace();
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    add(XReg{LOOPCOUNT_REG.index}, XReg{LOOPCOUNT_REG.index}, XReg{LOOPINC.index});
+    subs(LOOPCOUNT, LOOPCOUNT, 1); // Decrement loop count by 1
+    b(Cond::NE, l_loop_start);     // Loop if not equal
+    L(*loop_break_label);
+    loop_break_label.reset();
+
+    looping = false;
+}
+
+void JitShader::Compile_JMP(Instruction instr) {
+    if (instr.opcode.Value() == OpCode::Id::JMPC)
+        Compile_EvaluateCondition(instr);
+    else if (instr.opcode.Value() == OpCode::Id::JMPU)
+        Compile_UniformCondition(instr);
+    else
+        UNREACHABLE();
+
+    bool inverted_condition =
+        (instr.opcode.Value() == OpCode::Id::JMPU) && (instr.flow_control.num_instructions & 1);
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        cbz(W0, b);
+    } else {
+        cbnz(W0, b);
+    }
+}
+
+static void Emit(GSEmitter* emitter, Common::Vec4<float24> (*output)[16]) {
+    emitter->Emit(*output);
+}
+
+void JitShader::Compile_EMIT(Instruction instr) {
+    Label have_emitter, end;
+    ldr(X0, STATE, offsetof(UnitState, emitter_ptr));
+    cbnz(X0, have_emitter);
+
+    mov(X0, reinterpret_cast<std::uintptr_t>("Execute EMIT on VS"));
+    Compile_CallHost(LogCritical);
+    b(end);
+
+    L(have_emitter);
+    add(X1, STATE, static_cast<u32>(offsetof(UnitState, registers.output)));
+    Compile_CallHost(Pica::Shader::Emit); // Qualified, CodeGenerator::Emit would hide it
+    L(end);
+}
+
+void JitShader::Compile_SETE(Instruction instr) {
+    Label have_emitter, end;
+    ldr(X0, STATE, offsetof(UnitState, emitter_ptr));
+    cbnz(X0, have_emitter);
+
+    mov(X0, reinterpret_cast<std::uintptr_t>("Execute SETEMIT on VS"));
+    Compile_CallHost(LogCritical);
+    b(end);
+
+    L(have_emitter);
+    mov(W1, instr.setemit.vertex_id);
+    strb(W1, X0, offsetof(GSEmitter, vertex_id));
+    mov(W1, instr.setemit.prim_emit);
+    strb(W1, X0, offsetof(GSEmitter, prim_emit));
+    mov(W1, instr.setemit.winding);
+    strb(W1, X0, offsetof(GSEmitter, winding));
+    L(end);
+}
+
+void JitShader::Compile_Block(unsigned end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    ldr(W0, SP, 0);
+    cmp(W0, program_counter);
+
+    // If so, jump back to before CALL
+    Label b;
+    this->b(Cond::NE, b);
+    ret();
+    L(b);
+}
+
+void JitShader::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    Instruction instr = {(*program_code)[program_counter++]};
+
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = instr_table[static_cast<unsigned>(opcode)];
+
+    if (instr_func) {
+        // JIT the instruction!
+        ((*this).*instr_func)(instr);
+    } else {
+        // Unhandled instruction
+        LOG_CRITICAL(HW_GPU, "Unhandled instruction: 0x{:02x} (0x{:08x})",
+                     static_cast<u32>(instr.opcode.Value().EffectiveOpCode()), instr.hex);
+    }
+}
+
+void JitShader::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+
+    // Reset flow control state
+    program = reinterpret_cast<CompiledShader*>(const_cast<u8*>(GetCurr()));
+    program_counter = 0;
+    looping = false;
+    instruction_labels.fill(Label());
+
+    // Find all `CALL` instructions and identify return locations
+    FindReturnOffsets();
+
+    // Save the callee saved registers below a frame record
+    stp(X29, X30, SP, -FRAME_SIZE, IndexMode::PreIndex);
+    mov(X29, SP);
+    stp(X19, X20, SP, 16);
+    stp(X21, X22, SP, 32);
+    stp(X23, X24, SP, 48);
+    stp(X25, X26, SP, 64);
+    stp(X27, X28, SP, 80);
+
+    mov(UNIFORMS, X0);
+    mov(STATE, X1);
+
+    // Push a dummy return offset, to catch any potential return checks (see Compile_Return) that
+    // happen in shader main routine.
+    mov(X0, 0xFFFFFFFFFFFFFFFFULL);
+    stp(X0, XZR, SP, -16, IndexMode::PreIndex);
+
+    // Load address/loop registers
+    ldr(W0, STATE, offsetof(UnitState, address_registers[0]));
+    ldr(W1, STATE, offsetof(UnitState, address_registers[1]));
+    ldr(LOOPCOUNT_REG, STATE, offsetof(UnitState, address_registers[2]));
+    ins(SCRATCH[0], W0);
+    ins(SCRATCH[1], W1);
+    smov(ADDROFFS_REG_0, SCRATCH[0]);
+    smov(ADDROFFS_REG_1, SCRATCH[1]);
+    lsl(ADDROFFS_REG_0, ADDROFFS_REG_0, 4);
+    lsl(ADDROFFS_REG_1, ADDROFFS_REG_1, 4);
+    lsl(XReg{LOOPCOUNT_REG.index}, XReg{LOOPCOUNT_REG.index}, 4);
+
+    // Load conditional code
+    ldrb(ToW(COND0), STATE, offsetof(UnitState, conditional_code[0]));
+    ldrb(ToW(COND1), STATE, offsetof(UnitState, conditional_code[1]));
+
+    // Jump to start of the shader program
+    br(X2);
+
+    // Compile entire program
+    Compile_Block(static_cast<unsigned>(program_code->size()));
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    Ready();
+
+    ASSERT_MSG(GetSize() <= MAX_SHADER_SIZE, "Compiled a shader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled shader size={}", GetSize());
+}
+
+JitShader::JitShader() : Common::A64::CodeGenerator(MAX_SHADER_SIZE) {
+    CompilePrelude();
+}
+
+void JitShader::CompilePrelude() {
+    CompilePrelude_Log2();
+    CompilePrelude_Exp2();
+}
+
+void JitShader::CompilePrelude_Log2() {
+    // There is no log instruction, thus we must approximate.
+    // We perform this approximation first performaing a range reduction into the range [1.0, 2.0).
+    // A minimax polynomial which was fit for the function log2(x) / (x - 1) is then evaluated.
+    // We multiply the result by (x - 1) then restore the result into the appropriate range.
+    // This matches the x86_64 JIT step for step.
+
+    // Coefficients for the minimax polynomial.
+    // f(x) computes approximately log2(x) / (x - 1).
+    // f(x) = c4 + x * (c3 + x * (c2 + x * (c1 + x * c0)).
+    Label c0, c1, c2, c3, c4;
+    L(c0);
+    DW(0x3d74552f);
+    L(c1);
+    DW(0xbeee7397);
+    L(c2);
+    DW(0x3fbd96dd);
+    L(c3);
+    DW(0xc02153f6);
+    L(c4);
+    DW(0x4038d96c);
+
+    Label input_is_nan, input_is_zero, input_out_of_range;
+
+    L(log2_subroutine);
+
+    // Here we handle edge cases: input in {NaN, 0, -Inf, Negative}.
+    fcmp(SRC1.S());
+    b(Cond::VS, input_is_nan);
+    b(Cond::LS, input_out_of_range);
+
+    // Split input
+    fmov(W0, SRC1.S());
+    and_(W1, W0, 0x007fffff);
+    orr(W1, W1, 0x3f800000);
+    ldr(SCRATCH.S(), c0); // Preload c0.
+    fmov(SRC1.S(), W1);
+    // SRC1 now contains the mantissa of the input.
+    fmul(SCRATCH.S(), SCRATCH.S(), SRC1.S());
+    lsr(W0, W0, 23);
+    sub(W0, W0, 0x7f);
+    scvtf(SCRATCH2.S(), W0);
+    // SCRATCH2 now contains the exponent of the input.
+
+    // Complete computation of polynomial
+    ldr(CONSTANT.S(), c1);
+    fadd(SCRATCH.S(), SCRATCH.S(), CONSTANT.S());
+    fmul(SCRATCH.S(), SCRATCH.S(), SRC1.S());
+    ldr(CONSTANT.S(), c2);
+    fadd(SCRATCH.S(), SCRATCH.S(), CONSTANT.S());
+    fmul(SCRATCH.S(), SCRATCH.S(), SRC1.S());
+    ldr(CONSTANT.S(), c3);
+    fadd(SCRATCH.S(), SCRATCH.S(), CONSTANT.S());
+    fmul(SCRATCH.S(), SCRATCH.S(), SRC1.S());
+    fmov(CONSTANT.S(), 1.0f);
+    fsub(SRC1.S(), SRC1.S(), CONSTANT.S());
+    ldr(CONSTANT.S(), c4);
+    fadd(SCRATCH.S(), SCRATCH.S(), CONSTANT.S());
+    fmul(SCRATCH.S(), SCRATCH.S(), SRC1.S());
+    fadd(SCRATCH2.S(), SCRATCH2.S(), SCRATCH.S());
+
+    // Duplicate result across vector
+    dup(SRC1, SCRATCH2[0]);
+    ret();
+
+    // The flags still hold the comparison against zero
+    L(input_out_of_range);
+    b(Cond::EQ, input_is_zero);
+    mov(W0, 0x7fc00000); // Default quiet NaN
+    dup(SRC1, W0);
+    ret();
+    L(input_is_zero);
+    mov(W0, 0xff800000); // Negative infinity
+    dup(SRC1, W0);
+    ret();
+
+    L(input_is_nan);
+    dup(SRC1, SRC1[0]);
+    ret();
+}
+
+void JitShader::CompilePrelude_Exp2() {
+    // There is no exp instruction, thus we must approximate.
+    // We perform this approximation first performaing a range reduction into the range [-0.5, 0.5).
+    // A minimax polynomial which was fit for the function exp2(x) is then evaluated.
+    // We then restore the result into the appropriate range.
+    // This matches the x86_64 JIT step for step.
+
+    Label input_max, input_min, c0, half, c1, c2, c3, c4;
+    L(input_max);
+    DW(0x43010000);
+    L(input_min);
+    DW(0xc2fdffff);
+    L(c0);
+    DW(0x3c5dbe69);
+    L(half);
+    DW(0x3f000000);
+    L(c1);
+    DW(0x3d5509f9);
+    L(c2);
+    DW(0x3e773cc5);
+    L(c3);
+    DW(0x3f3168b3);
+    L(c4);
+    DW(0x3f800016);
+
+    Label ret_label;
+
+    L(exp2_subroutine);
+
+    // Handle edge cases
+    fcmp(SRC1.S());
+    b(Cond::VS, ret_label);
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    ldr(CONSTANT.S(), input_max);
+    fmin(SRC1.S(), SRC1.S(), CONSTANT.S());
+    ldr(CONSTANT.S(), input_min);
+    fmax(SRC1.S(), SRC1.S(), CONSTANT.S());
+
+    // Decompose input
+    ldr(CONSTANT.S(), half);
+    fsub(SCRATCH.S(), SRC1.S(), CONSTANT.S());
+    ldr(SCRATCH2.S(), c0); // Preload c0.
+    fcvtns(W0, SCRATCH.S());
+    scvtf(SCRATCH.S(), W0);
+    // SCRATCH now contains input rounded to the nearest integer.
+    add(W0, W0, 0x7f);
+    fsub(SRC1.S(), SRC1.S(), SCRATCH.S());
+    // SRC1 contains input - round(input), which is in [-0.5, 0.5).
+    fmul(SCRATCH2.S(), SCRATCH2.S(), SRC1.S());
+    lsl(X0, X0, 23);
+    fmov(SCRATCH.S(), W0);
+    // SCRATCH contains 2^(round(input)).
+
+    // Complete computation of polynomial.
+    ldr(CONSTANT.S(), c1);
+    fadd(SCRATCH2.S(), SCRATCH2.S(), CONSTANT.S());
+    fmul(SCRATCH2.S(), SCRATCH2.S(), SRC1.S());
+    ldr(CONSTANT.S(), c2);
+    fadd(SCRATCH2.S(), SCRATCH2.S(), CONSTANT.S());
+    fmul(SCRATCH2.S(), SCRATCH2.S(), SRC1.S());
+    ldr(CONSTANT.S(), c3);
+    fadd(SCRATCH2.S(), SCRATCH2.S(), CONSTANT.S());
+    fmul(SRC1.S(), SRC1.S(), SCRATCH2.S());
+    ldr(CONSTANT.S(), c4);
+    fadd(SRC1.S(), SRC1.S(), CONSTANT.S());
+    fmul(SRC1.S(), SRC1.S(), SCRATCH.S());
+
+    // Duplicate result across vector
+    L(ret_label);
+    dup(SRC1, SRC1[0]);
+    ret();
+}
+
+} // namespace Pica::Shader
@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include "common/microprofile.h"
+#include "common/x64/cpu_detect.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
+#include "video_core/shader/shader_jit_x64_pair_compiler.h"
 
 namespace Pica::Shader {
 
@@ -29,6 +31,19 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
         setup.engine_data.cached_shader = shader.get();
         cache.emplace_hint(iter, cache_key, std::move(shader));
     }
+
+    if (!Common::GetCPUCaps().avx2) {
+        return;
+    }
+    auto pair_iter = pair_cache.find(cache_key);
+    if (pair_iter != pair_cache.end()) {
+        setup.engine_data.cached_pair_shader = pair_iter->second.get();
+    } else {
+        auto shader = std::make_unique<JitPairShader>();
+        shader->Compile(&setup.program_code, &setup.swizzle_data);
+        setup.engine_data.cached_pair_shader = shader.get();
+        pair_cache.emplace_hint(pair_iter, cache_key, std::move(shader));
+    }
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
@@ -42,4 +57,40 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     shader->Run(setup, state, setup.engine_data.entry_point);
 }
 
+void JitX64Engine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                   const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                   std::size_t count) const {
+    ASSERT(setup.engine_data.cached_shader != nullptr);
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitShader* shader = static_cast<const JitShader*>(setup.engine_data.cached_shader);
+    const auto run_vertex = [&](std::size_t i) {
+        state.LoadInput(config, inputs[i]);
+        shader->Run(setup, state, setup.engine_data.entry_point);
+        state.WriteOutput(config, outputs[i]);
+    };
+
+    std::size_t i = 0;
+    if (setup.engine_data.cached_pair_shader != nullptr && count >= 2) {
+        // Vertices are run two at a time. The pair runs one vertex at a time if they take
+        // different branches.
+        const JitPairShader* pair_shader =
+            static_cast<const JitPairShader*>(setup.engine_data.cached_pair_shader);
+        PairUnitState pair_state(state);
+        for (; i + 1 < count; i += 2) {
+            pair_state.LoadInput(config, inputs[i], inputs[i + 1]);
+            if (pair_shader->Run(setup, pair_state, setup.engine_data.entry_point)) {
+                pair_state.WriteOutput(config, outputs[i], outputs[i + 1]);
+            } else {
+                run_vertex(i);
+                run_vertex(i + 1);
+            }
+        }
+    }
+    for (; i < count; ++i) {
+        run_vertex(i);
+    }
+}
+
 } // namespace Pica::Shader
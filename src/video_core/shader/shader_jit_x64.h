@@ -12,6 +12,7 @@
 namespace Pica::Shader {
 
 class JitShader;
+class JitPairShader;
 
 class JitX64Engine final : public ShaderEngine {
 public:
@@ -20,9 +21,13 @@ public:
 
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, UnitState& state,
+                  const AttributeBuffer* inputs, AttributeBuffer* outputs,
+                  std::size_t count) const override;
 
 private:
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    std::unordered_map<u64, std::unique_ptr<JitPairShader>> pair_cache;
 };
 
 } // namespace Pica::Shader
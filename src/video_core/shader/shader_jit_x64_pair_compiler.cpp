@@ -0,0 +1,1063 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <nihstro/shader_bytecode.h>
+#include <smmintrin.h>
+#include <xmmintrin.h>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/logging/log.h"
+#include "common/x64/xbyak_abi.h"
+#include "common/x64/xbyak_util.h"
+#include "video_core/shader/shader_jit_x64_pair_compiler.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+using Xbyak::Ymm;
+
+namespace Pica::Shader {
+
+PairUnitState::PairUnitState(const UnitState& state) {
+    for (std::size_t reg = 0; reg < 16; ++reg) {
+        for (std::size_t vertex = 0; vertex < 2; ++vertex) {
+            registers.input[reg][vertex] = state.registers.input[reg];
+            registers.temporary[reg][vertex] = state.registers.temporary[reg];
+            registers.output[reg][vertex] = state.registers.output[reg];
+        }
+    }
+    std::copy(std::begin(state.conditional_code), std::end(state.conditional_code),
+              std::begin(conditional_code));
+    std::copy(std::begin(state.address_registers), std::end(state.address_registers),
+              std::begin(address_registers));
+}
+
+void PairUnitState::LoadInput(const ShaderRegs& config, const AttributeBuffer& input0,
+                              const AttributeBuffer& input1) {
+    const unsigned max_attribute = config.max_input_attribute_index;
+
+    for (unsigned attr = 0; attr <= max_attribute; ++attr) {
+        const unsigned reg = config.GetRegisterForAttribute(attr);
+        registers.input[reg][0] = input0.attr[attr];
+        registers.input[reg][1] = input1.attr[attr];
+    }
+}
+
+void PairUnitState::WriteOutput(const ShaderRegs& config, AttributeBuffer& output0,
+                                AttributeBuffer& output1) const {
+    int output_i = 0;
+    for (int reg : Common::BitSet<u32>(config.output_mask)) {
+        output0.attr[output_i] = registers.output[reg][0];
+        output1.attr[output_i] = registers.output[reg][1];
+        ++output_i;
+    }
+}
+
+typedef void (JitPairShader::*JitFunction)(Instruction instr);
+
+const JitFunction pair_instr_table[64] = {
+    &JitPairShader::Compile_ADD,      // add
+    &JitPairShader::Compile_DP3,      // dp3
+    &JitPairShader::Compile_DP4,      // dp4
+    &JitPairShader::Compile_DPH,      // dph
+    nullptr,                          // unknown
+    &JitPairShader::Compile_EX2,      // ex2
+    &JitPairShader::Compile_LG2,      // lg2
+    nullptr,                          // unknown
+    &JitPairShader::Compile_MUL,      // mul
+    &JitPairShader::Compile_SGE,      // sge
+    &JitPairShader::Compile_SLT,      // slt
+    &JitPairShader::Compile_FLR,      // flr
+    &JitPairShader::Compile_MAX,      // max
+    &JitPairShader::Compile_MIN,      // min
+    &JitPairShader::Compile_RCP,      // rcp
+    &JitPairShader::Compile_RSQ,      // rsq
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    &JitPairShader::Compile_MOVA,     // mova
+    &JitPairShader::Compile_MOV,      // mov
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    &JitPairShader::Compile_DPH,      // dphi
+    nullptr,                          // unknown
+    &JitPairShader::Compile_SGE,      // sgei
+    &JitPairShader::Compile_SLT,      // slti
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    nullptr,                          // unknown
+    &JitPairShader::Compile_NOP,      // nop
+    &JitPairShader::Compile_END,      // end
+    &JitPairShader::Compile_BREAKC,   // breakc
+    &JitPairShader::Compile_CALL,     // call
+    &JitPairShader::Compile_CALLC,    // callc
+    &JitPairShader::Compile_CALLU,    // callu
+    &JitPairShader::Compile_IF,       // ifu
+    &JitPairShader::Compile_IF,       // ifc
+    &JitPairShader::Compile_LOOP,     // loop
+    &JitPairShader::Compile_Fallback, // emit
+    &JitPairShader::Compile_Fallback, // sete
+    &JitPairShader::Compile_JMP,      // jmpc
+    &JitPairShader::Compile_JMP,      // jmpu
+    &JitPairShader::Compile_CMP,      // cmp
+    &JitPairShader::Compile_CMP,      // cmp
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // madi
+    &JitPairShader::Compile_MAD,      // mad
+    &JitPairShader::Compile_MAD,      // mad
+    &JitPairShader::Compile_MAD,      // mad
+    &JitPairShader::Compile_MAD,      // mad
+    &JitPairShader::Compile_MAD,      // mad
+    &JitPairShader::Compile_MAD,      // mad
+    &JitPairShader::Compile_MAD,      // mad
+    &JitPairShader::Compile_MAD,      // mad
+};
+
+// The registers are assigned as in the scalar JIT, except that each vertex has its own address
+// registers, and that the conditional codes hold one bit per vertex. Bit 0 is the first vertex
+// and bit 1 the second one. RAX, RCX, RDX and YMM0-YMM4 can be used as scratch registers.
+
+/// Pointer to the uniform memory
+constexpr Reg64 UNIFORMS = r9;
+/// The two VS address offset registers of the first vertex, multiplied by 16
+constexpr Reg64 ADDROFFS_REG_0 = r10;
+constexpr Reg64 ADDROFFS_REG_1 = r11;
+/// The two VS address offset registers of the second vertex, multiplied by 16
+constexpr Reg64 ADDROFFS_REG_0_HI = r8;
+constexpr Reg64 ADDROFFS_REG_1_HI = rbp;
+/// VS loop count register (Multiplied by 16), shared by both vertices
+constexpr Reg32 LOOPCOUNT_REG = r12d;
+/// Current VS loop iteration number
+constexpr Reg32 LOOPCOUNT = esi;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration (Multiplied by 16)
+constexpr Reg32 LOOPINC = edi;
+/// Results of the previous CMP instruction for the X-component comparison of each vertex
+constexpr Reg64 COND0 = r13;
+/// Results of the previous CMP instruction for the Y-component comparison of each vertex
+constexpr Reg64 COND1 = r14;
+/// Pointer to the PairUnitState instance
+constexpr Reg64 STATE = r15;
+/// Stack pointer after the prologue, which the fallback exit unwinds any subroutine calls to
+constexpr Reg64 STACK_BASE = rbx;
+/// SIMD scratch register
+constexpr Ymm SCRATCH = ymm0;
+/// Loaded with the first swizzled source register, otherwise can be used as a scratch register
+constexpr Ymm SRC1 = ymm1;
+/// Loaded with the second swizzled source register, otherwise can be used as a scratch register
+constexpr Ymm SRC2 = ymm2;
+/// Loaded with the third swizzled source register, otherwise can be used as a scratch register
+constexpr Ymm SRC3 = ymm3;
+/// Additional scratch register
+constexpr Ymm SCRATCH2 = ymm4;
+/// Constant vector of 1.0f, used to efficiently set a vector to one
+constexpr Ymm ONE = ymm14;
+/// Constant vector of -0.f, used to efficiently negate a vector with XOR
+constexpr Ymm NEGBIT = ymm15;
+
+/// Raw constant for the source register selector that indicates no swizzling is performed
+static const u8 NO_SRC_REG_SWIZZLE = 0x1b;
+/// Raw constant for the destination register enable mask that indicates all components are enabled
+static const u8 NO_DEST_REG_MASK = 0xf;
+
+/// Returns the XMM register aliasing the first vertex of a YMM register
+static Xmm LowLane(const Ymm& reg) {
+    return Xmm(reg.getIdx());
+}
+
+void JitPairShader::Compile_Assert(bool condition) {
+    if (!condition) {
+        jmp(fallback_label, T_NEAR);
+    }
+}
+
+void JitPairShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
+                                       Ymm dest) {
+    const bool is_uniform = src_reg.GetRegisterType() == RegisterType::FloatUniform;
+    const std::size_t src_offset = is_uniform ? Uniforms::GetFloatUniformOffset(src_reg.GetIndex())
+                                              : PairUnitState::InputOffset(src_reg);
+
+    int src_offset_disp = (int)src_offset;
+    ASSERT_MSG(src_offset == src_offset_disp, "Source register offset too large for int type");
+
+    unsigned operand_desc_id;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    unsigned address_register_index;
+    unsigned offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    if (src_num == offset_src && address_register_index != 0) {
+        Reg64 offset_lo, offset_hi;
+        switch (address_register_index) {
+        case 1: // address offset 1
+            offset_lo = ADDROFFS_REG_0;
+            offset_hi = ADDROFFS_REG_0_HI;
+            break;
+        case 2: // address offset 2
+            offset_lo = ADDROFFS_REG_1;
+            offset_hi = ADDROFFS_REG_1_HI;
+            break;
+        case 3: // address offset 3
+            offset_lo = offset_hi = LOOPCOUNT_REG.cvt64();
+            break;
+        default:
+            UNREACHABLE();
+            break;
+        }
+
+        // The offsets are in units of one register of one vertex. Uniforms are shared by both
+        // vertices, while the per-vertex registers are twice as far apart.
+        if (is_uniform && address_register_index == 3) {
+            vbroadcastf128(dest, xword[UNIFORMS + offset_lo + src_offset_disp]);
+        } else if (is_uniform) {
+            vmovaps(LowLane(dest), xword[UNIFORMS + offset_lo + src_offset_disp]);
+            vinsertf128(dest, dest, xword[UNIFORMS + offset_hi + src_offset_disp], 1);
+        } else if (address_register_index == 3) {
+            vmovaps(dest, yword[STATE + offset_lo * 2 + src_offset_disp]);
+        } else {
+            vmovaps(LowLane(dest), xword[STATE + offset_lo * 2 + src_offset_disp]);
+            vinsertf128(dest, dest, xword[STATE + offset_hi * 2 + (src_offset_disp + 16)], 1);
+        }
+    } else if (is_uniform) {
+        vbroadcastf128(dest, xword[UNIFORMS + src_offset_disp]);
+    } else {
+        vmovaps(dest, yword[STATE + src_offset_disp]);
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    // VSHUFPS shuffles each 128-bit lane with the same selector, which swizzles both vertices
+    u8 sel = swiz.GetRawSelector(src_num);
+    if (sel != NO_SRC_REG_SWIZZLE) {
+        // Selector component order needs to be reversed for the SHUFPS instruction
+        sel = ((sel & 0xc0) >> 6) | ((sel & 3) << 6) | ((sel & 0xc) << 2) | ((sel & 0x30) >> 2);
+        vshufps(dest, dest, dest, sel);
+    }
+
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        vxorps(dest, dest, NEGBIT);
+    }
+}
+
+void JitPairShader::Compile_DestEnable(Instruction instr, Ymm src) {
+    DestRegister dest;
+    unsigned operand_desc_id;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        dest = instr.mad.dest.Value();
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        dest = instr.common.dest.Value();
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    std::size_t dest_offset_disp = PairUnitState::OutputOffset(dest);
+
+    if (swiz.dest_mask == NO_DEST_REG_MASK) {
+        vmovaps(yword[STATE + dest_offset_disp], src);
+    } else {
+        // The blend mask covers the components of both vertices
+        const u8 mask = ((swiz.dest_mask & 1) << 3) | ((swiz.dest_mask & 8) >> 3) |
+                        ((swiz.dest_mask & 2) << 1) | ((swiz.dest_mask & 4) >> 1);
+        vblendps(SCRATCH, src, yword[STATE + dest_offset_disp], (~mask & 0xf) * 0x11);
+        vmovaps(yword[STATE + dest_offset_disp], SCRATCH);
+    }
+}
+
+void JitPairShader::Compile_SanitizedMul(Ymm src1, Ymm src2, Ymm scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN, see JitShader
+    vcmpordps(scratch, src1, src2);
+    vmulps(src1, src1, src2);
+    vcmpunordps(src2, src1, src1);
+    vxorps(scratch, scratch, src2);
+    vandps(src1, src1, scratch);
+}
+
+void JitPairShader::Compile_CallPerVertex(const Label& subroutine) {
+    // The subroutines take and return SRC1 and only clobber SCRATCH, SCRATCH2, EAX and EDX
+    vextractf128(LowLane(SRC3), SRC1, 1);
+    call(subroutine);
+    vmovaps(LowLane(SRC2), LowLane(SRC1));
+    vmovaps(LowLane(SRC1), LowLane(SRC3));
+    call(subroutine);
+    vinsertf128(SRC1, SRC2, LowLane(SRC1), 1);
+}
+
+void JitPairShader::Compile_EvaluateCondition(Instruction instr) {
+    // Each reference value is compared with the bits of both vertices
+    const u32 refx = (instr.flow_control.refx.Value() ^ 1) * 3;
+    const u32 refy = (instr.flow_control.refy.Value() ^ 1) * 3;
+
+    switch (instr.flow_control.op) {
+    case Instruction::FlowControlType::Or:
+        mov(eax, COND0.cvt32());
+        mov(ecx, COND1.cvt32());
+        xor_(eax, refx);
+        xor_(ecx, refy);
+        or_(eax, ecx);
+        break;
+
+    case Instruction::FlowControlType::And:
+        mov(eax, COND0.cvt32());
+        mov(ecx, COND1.cvt32());
+        xor_(eax, refx);
+        xor_(ecx, refy);
+        and_(eax, ecx);
+        break;
+
+    case Instruction::FlowControlType::JustX:
+        mov(eax, COND0.cvt32());
+        xor_(eax, refx);
+        break;
+
+    case Instruction::FlowControlType::JustY:
+        mov(eax, COND1.cvt32());
+        xor_(eax, refy);
+        break;
+    }
+
+    // EAX is 1 or 2 if the condition only holds for one vertex
+    lea(ecx, ptr[eax - 1]);
+    cmp(ecx, 1);
+    jbe(fallback_label, T_NEAR);
+    test(eax, eax);
+}
+
+void JitPairShader::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    cmp(byte[UNIFORMS + offset], 0);
+}
+
+void JitPairShader::Compile_ADD(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    vaddps(SRC1, SRC1, SRC2);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_DP3(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    vshufps(SRC2, SRC1, SRC1, _MM_SHUFFLE(1, 1, 1, 1));
+    vshufps(SRC3, SRC1, SRC1, _MM_SHUFFLE(2, 2, 2, 2));
+    vshufps(SRC1, SRC1, SRC1, _MM_SHUFFLE(0, 0, 0, 0));
+    vaddps(SRC1, SRC1, SRC2);
+    vaddps(SRC1, SRC1, SRC3);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_DP4(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    vhaddps(SRC1, SRC1, SRC1);
+    vhaddps(SRC1, SRC1, SRC1);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_DPH(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    // Set 4th component of both vertices to 1.0
+    vblendps(SRC1, SRC1, ONE, 0b10001000);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    vhaddps(SRC1, SRC1, SRC1);
+    vhaddps(SRC1, SRC1, SRC1);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_EX2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_CallPerVertex(exp2_subroutine);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_LG2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_CallPerVertex(log2_subroutine);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_MUL(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_SGE(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    vcmpleps(SRC2, SRC2, SRC1);
+    vandps(SRC2, SRC2, ONE);
+
+    Compile_DestEnable(instr, SRC2);
+}
+
+void JitPairShader::Compile_SLT(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    vcmpltps(SRC1, SRC1, SRC2);
+    vandps(SRC1, SRC1, ONE);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_FLR(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    vroundps(SRC1, SRC1, _MM_FROUND_FLOOR);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_MAX(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+    vmaxps(SRC1, SRC1, SRC2);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_MIN(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+    vminps(SRC1, SRC1, SRC2);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_MOVA(Instruction instr) {
+    SwizzlePattern swiz = {(*swizzle_data)[instr.common.operand_desc_id]};
+
+    if (!swiz.DestComponentEnabled(0) && !swiz.DestComponentEnabled(1)) {
+        return; // NoOp
+    }
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // Convert floats to integers using truncation (only care about X and Y components)
+    vcvttps2dq(SRC1, SRC1);
+
+    // Get the X and Y components of each vertex
+    vmovq(rax, LowLane(SRC1));
+    vextractf128(LowLane(SCRATCH), SRC1, 1);
+    vmovq(rcx, LowLane(SCRATCH));
+
+    if (swiz.DestComponentEnabled(0)) {
+        // Move and sign-extend low 32 bits, multiplied by 16 to be used as an offset later
+        movsxd(ADDROFFS_REG_0, eax);
+        movsxd(ADDROFFS_REG_0_HI, ecx);
+        shl(ADDROFFS_REG_0, 4);
+        shl(ADDROFFS_REG_0_HI, 4);
+    }
+    if (swiz.DestComponentEnabled(1)) {
+        // Move and sign-extend high 32 bits, multiplied by 16 to be used as an offset later
+        shr(rax, 32);
+        shr(rcx, 32);
+        movsxd(ADDROFFS_REG_1, eax);
+        movsxd(ADDROFFS_REG_1_HI, ecx);
+        shl(ADDROFFS_REG_1, 4);
+        shl(ADDROFFS_REG_1_HI, 4);
+    }
+}
+
+void JitPairShader::Compile_MOV(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // VRCPPS gives the same approximation as the RCPSS of the scalar JIT
+    vrcpps(SRC1, SRC1);
+    vshufps(SRC1, SRC1, SRC1, _MM_SHUFFLE(0, 0, 0, 0)); // XYWZ -> XXXX
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // VRSQRTPS gives the same approximation as the RSQRTSS of the scalar JIT
+    vrsqrtps(SRC1, SRC1);
+    vshufps(SRC1, SRC1, SRC1, _MM_SHUFFLE(0, 0, 0, 0)); // XYWZ -> XXXX
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_NOP(Instruction instr) {}
+
+void JitPairShader::Compile_END(Instruction instr) {
+    // Save the conditional code and address/loop registers of the second vertex
+    mov(eax, COND0.cvt32());
+    mov(ecx, COND1.cvt32());
+    shr(eax, 1);
+    shr(ecx, 1);
+    mov(byte[STATE + offsetof(PairUnitState, conditional_code[0])], al);
+    mov(byte[STATE + offsetof(PairUnitState, conditional_code[1])], cl);
+
+    sar(ADDROFFS_REG_0_HI, 4);
+    sar(ADDROFFS_REG_1_HI, 4);
+    sar(LOOPCOUNT_REG, 4);
+    mov(dword[STATE + offsetof(PairUnitState, address_registers[0])], ADDROFFS_REG_0_HI.cvt32());
+    mov(dword[STATE + offsetof(PairUnitState, address_registers[1])], ADDROFFS_REG_1_HI.cvt32());
+    mov(dword[STATE + offsetof(PairUnitState, address_registers[2])], LOOPCOUNT_REG);
+
+    mov(rsp, STACK_BASE);
+    vzeroupper();
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(eax, 1);
+    ret();
+}
+
+void JitPairShader::Compile_Fallback(Instruction instr) {
+    jmp(fallback_label, T_NEAR);
+}
+
+void JitPairShader::Compile_BREAKC(Instruction instr) {
+    Compile_Assert(looping);
+    if (looping) {
+        Compile_EvaluateCondition(instr);
+        ASSERT(loop_break_label);
+        jnz(*loop_break_label, T_NEAR);
+    }
+}
+
+void JitPairShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return
+    push(qword, (instr.flow_control.dest_offset + instr.flow_control.num_instructions));
+
+    // Call the subroutine
+    call(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Skip over the return offset that's on the stack
+    add(rsp, 8);
+}
+
+void JitPairShader::Compile_CALLC(Instruction instr) {
+    Compile_EvaluateCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitPairShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitPairShader::Compile_CMP(Instruction instr) {
+    using Op = Instruction::Common::CompareOpType::Op;
+    Op op_x = instr.common.compare_op.x;
+    Op op_y = instr.common.compare_op.y;
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    // GT and GE are emulated by swapping the operands of LT and LE, see JitShader
+    static const u8 cmp[] = {CMP_EQ, CMP_NEQ, CMP_LT, CMP_LE, CMP_LT, CMP_LE};
+
+    bool invert_op_x = (op_x == Op::GreaterThan || op_x == Op::GreaterEqual);
+    Ymm lhs_x = invert_op_x ? SRC2 : SRC1;
+    Ymm rhs_x = invert_op_x ? SRC1 : SRC2;
+
+    if (op_x == op_y) {
+        // Compare X-component and Y-component together
+        vcmpps(SCRATCH, lhs_x, rhs_x, cmp[op_x]);
+        vmovmskps(eax, SCRATCH);
+        mov(ecx, eax);
+    } else {
+        bool invert_op_y = (op_y == Op::GreaterThan || op_y == Op::GreaterEqual);
+        Ymm lhs_y = invert_op_y ? SRC2 : SRC1;
+        Ymm rhs_y = invert_op_y ? SRC1 : SRC2;
+
+        vcmpps(SCRATCH, lhs_x, rhs_x, cmp[op_x]);
+        vcmpps(SCRATCH2, lhs_y, rhs_y, cmp[op_y]);
+        vmovmskps(eax, SCRATCH);
+        vmovmskps(ecx, SCRATCH2);
+    }
+
+    // The masks hold the X-component of the vertices in bits 0 and 4, and the Y-component in bits
+    // 1 and 5. Gather them into one bit per vertex.
+    const auto pack_condition = [this](Reg64 cond, Reg32 mask, int component) {
+        mov(cond.cvt32(), mask);
+        shr(cond.cvt32(), component);
+        mov(edx, cond.cvt32());
+        and_(cond.cvt32(), 1);
+        shr(edx, 3);
+        and_(edx, 2);
+        or_(cond.cvt32(), edx);
+    };
+    pack_condition(COND0, eax, 0);
+    pack_condition(COND1, ecx, 1);
+}
+
+void JitPairShader::Compile_MAD(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.mad.src1, SRC1);
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2i, SRC2);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3i, SRC3);
+    } else {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2, SRC2);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3, SRC3);
+    }
+
+    // Not fused, as the rounding has to match the scalar JIT
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+    vaddps(SRC1, SRC1, SRC3);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitPairShader::Compile_IF(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter);
+    Label l_else, l_endif;
+
+    // Evaluate the "IF" condition
+    if (instr.opcode.Value() == OpCode::Id::IFU) {
+        Compile_UniformCondition(instr);
+    } else if (instr.opcode.Value() == OpCode::Id::IFC) {
+        Compile_EvaluateCondition(instr);
+    }
+    jz(l_else, T_NEAR);
+
+    // Compile the code that corresponds to the condition evaluating as true
+    Compile_Block(instr.flow_control.dest_offset);
+
+    // If there isn't an "ELSE" condition, we are done here
+    if (instr.flow_control.num_instructions == 0) {
+        L(l_else);
+        return;
+    }
+
+    jmp(l_endif, T_NEAR);
+
+    L(l_else);
+    // Compile the code that corresponds to the condition evaluating as false
+    Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+
+    L(l_endif);
+}
+
+void JitPairShader::Compile_LOOP(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter);
+    Compile_Assert(!looping);
+
+    looping = true;
+
+    // Decodes the integer uniform as the scalar JIT does, see JitShader::Compile_LOOP
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+    mov(LOOPCOUNT_REG, LOOPCOUNT);
+    shr(LOOPCOUNT_REG, 4);
+    and_(LOOPCOUNT_REG, 0xFF0); // Y-component is the start
+    mov(LOOPINC, LOOPCOUNT);
+    shr(LOOPINC, 12);
+    and_(LOOPINC, 0xFF0);               // Z-component is the incrementer
+    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    loop_break_label = Xbyak::Label();
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    add(LOOPCOUNT_REG, LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    sub(LOOPCOUNT, 1);           // Increment loop count by 1
+    jnz(l_loop_start, T_NEAR);   // Loop if not equal
+    L(*loop_break_label);
+    loop_break_label.reset();
+
+    looping = false;
+}
+
+void JitPairShader::Compile_JMP(Instruction instr) {
+    if (instr.opcode.Value() == OpCode::Id::JMPC)
+        Compile_EvaluateCondition(instr);
+    else if (instr.opcode.Value() == OpCode::Id::JMPU)
+        Compile_UniformCondition(instr);
+    else
+        UNREACHABLE();
+
+    bool inverted_condition =
+        (instr.opcode.Value() == OpCode::Id::JMPU) && (instr.flow_control.num_instructions & 1);
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        jz(b, T_NEAR);
+    } else {
+        jnz(b, T_NEAR);
+    }
+}
+
+void JitPairShader::Compile_Block(unsigned end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitPairShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    mov(rax, qword[rsp + 8]);
+    cmp(eax, (program_counter));
+
+    // If so, jump back to before CALL
+    Label b;
+    jnz(b);
+    ret();
+    L(b);
+}
+
+void JitPairShader::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    Instruction instr = {(*program_code)[program_counter++]};
+
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = pair_instr_table[static_cast<unsigned>(opcode)];
+
+    // Unhandled instructions are already reported by the scalar JIT
+    if (instr_func) {
+        ((*this).*instr_func)(instr);
+    }
+}
+
+void JitPairShader::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+void JitPairShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                            const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+
+    // Reset flow control state
+    program = (CompiledShader*)getCurr();
+    program_counter = 0;
+    looping = false;
+    instruction_labels.fill(Xbyak::Label());
+    fallback_label = Xbyak::Label();
+
+    FindReturnOffsets();
+
+    // The stack is set up as in the scalar JIT, see JitShader::Compile
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+    mov(STACK_BASE, rsp);
+
+    // The third parameter is R8 on Windows, which holds an address register here
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+    mov(rax, ABI_PARAM3);
+
+    // Both vertices start from the same address/loop registers
+    movsxd(ADDROFFS_REG_0, dword[STATE + offsetof(PairUnitState, address_registers[0])]);
+    movsxd(ADDROFFS_REG_1, dword[STATE + offsetof(PairUnitState, address_registers[1])]);
+    mov(LOOPCOUNT_REG, dword[STATE + offsetof(PairUnitState, address_registers[2])]);
+    shl(ADDROFFS_REG_0, 4);
+    shl(ADDROFFS_REG_1, 4);
+    shl(LOOPCOUNT_REG, 4);
+    mov(ADDROFFS_REG_0_HI, ADDROFFS_REG_0);
+    mov(ADDROFFS_REG_1_HI, ADDROFFS_REG_1);
+
+    // Load conditional code, setting the bits of both vertices
+    movzx(COND0.cvt32(), byte[STATE + offsetof(PairUnitState, conditional_code[0])]);
+    movzx(COND1.cvt32(), byte[STATE + offsetof(PairUnitState, conditional_code[1])]);
+    imul(COND0.cvt32(), COND0.cvt32(), 3);
+    imul(COND1.cvt32(), COND1.cvt32(), 3);
+
+    static const float one = 1.f;
+    mov(rcx, reinterpret_cast<std::size_t>(&one));
+    vbroadcastss(ONE, dword[rcx]);
+
+    static const float neg = -0.f;
+    mov(rcx, reinterpret_cast<std::size_t>(&neg));
+    vbroadcastss(NEGBIT, dword[rcx]);
+
+    // Jump to start of the shader program
+    jmp(rax);
+
+    // Compile entire program
+    Compile_Block(static_cast<unsigned>(program_code->size()));
+
+    // Leaves any subroutine calls and returns false, the registers of the unit state are left for
+    // the caller to discard
+    L(fallback_label);
+    mov(rsp, STACK_BASE);
+    vzeroupper();
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    xor_(eax, eax);
+    ret();
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_PAIR_SHADER_SIZE,
+               "Compiled a shader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled pair shader size={}", getSize());
+}
+
+JitPairShader::JitPairShader() : Xbyak::CodeGenerator(MAX_PAIR_SHADER_SIZE) {
+    CompilePrelude();
+}
+
+void JitPairShader::CompilePrelude() {
+    log2_subroutine = CompilePrelude_Log2();
+    exp2_subroutine = CompilePrelude_Exp2();
+}
+
+// The subroutines below are the ones of the scalar JIT with VEX encoded instructions, which avoid
+// the penalty of mixing legacy SSE instructions with the dirty upper halves of the YMM registers.
+// They operate on the low lane of SRC1.
+
+Xbyak::Label JitPairShader::CompilePrelude_Log2() {
+    Xbyak::Label subroutine;
+
+    // Coefficients for the minimax polynomial, see JitShader::CompilePrelude_Log2
+    align(64);
+    const void* c0 = getCurr();
+    dd(0x3d74552f);
+    const void* c1 = getCurr();
+    dd(0xbeee7397);
+    const void* c2 = getCurr();
+    dd(0x3fbd96dd);
+    const void* c3 = getCurr();
+    dd(0xc02153f6);
+    const void* c4 = getCurr();
+    dd(0x4038d96c);
+
+    align(16);
+    const void* negative_infinity_vector = getCurr();
+    dd(0xff800000);
+    dd(0xff800000);
+    dd(0xff800000);
+    dd(0xff800000);
+    const void* default_qnan_vector = getCurr();
+    dd(0x7fc00000);
+    dd(0x7fc00000);
+    dd(0x7fc00000);
+    dd(0x7fc00000);
+
+    const Xmm src1 = LowLane(SRC1);
+    const Xmm scratch = LowLane(SCRATCH);
+    const Xmm scratch2 = LowLane(SCRATCH2);
+
+    Xbyak::Label input_is_nan, input_is_zero, input_out_of_range;
+
+    align(16);
+    L(input_out_of_range);
+    je(input_is_zero);
+    vmovaps(src1, xword[rip + default_qnan_vector]);
+    ret();
+    L(input_is_zero);
+    vmovaps(src1, xword[rip + negative_infinity_vector]);
+    ret();
+
+    align(16);
+    L(subroutine);
+
+    // Here we handle edge cases: input in {NaN, 0, -Inf, Negative}.
+    vxorps(scratch, scratch, scratch);
+    vucomiss(scratch, src1);
+    jp(input_is_nan);
+    jae(input_out_of_range);
+
+    // Split input
+    vmovd(eax, src1);
+    mov(edx, eax);
+    and_(eax, 0x7f800000);
+    and_(edx, 0x007fffff);
+    vmovss(scratch, dword[rip + c0]); // Preload c0.
+    or_(edx, 0x3f800000);
+    vmovd(src1, edx);
+    // SRC1 now contains the mantissa of the input.
+    vmulss(scratch, scratch, src1);
+    shr(eax, 23);
+    sub(eax, 0x7f);
+    vcvtsi2ss(scratch2, scratch2, eax);
+    // SCRATCH2 now contains the exponent of the input.
+
+    // Complete computation of polynomial
+    vaddss(scratch, scratch, dword[rip + c1]);
+    vmulss(scratch, scratch, src1);
+    vaddss(scratch, scratch, dword[rip + c2]);
+    vmulss(scratch, scratch, src1);
+    vaddss(scratch, scratch, dword[rip + c3]);
+    vmulss(scratch, scratch, src1);
+    vsubss(src1, src1, LowLane(ONE));
+    vaddss(scratch, scratch, dword[rip + c4]);
+    vmulss(scratch, scratch, src1);
+    vaddss(src1, scratch2, scratch);
+
+    // Duplicate result across vector
+    L(input_is_nan);
+    vshufps(src1, src1, src1, _MM_SHUFFLE(0, 0, 0, 0));
+
+    ret();
+
+    return subroutine;
+}
+
+Xbyak::Label JitPairShader::CompilePrelude_Exp2() {
+    Xbyak::Label subroutine;
+
+    // Range reduction and minimax polynomial, see JitShader::CompilePrelude_Exp2
+    align(64);
+    const void* input_max = getCurr();
+    dd(0x43010000);
+    const void* input_min = getCurr();
+    dd(0xc2fdffff);
+    const void* c0 = getCurr();
+    dd(0x3c5dbe69);
+    const void* half = getCurr();
+    dd(0x3f000000);
+    const void* c1 = getCurr();
+    dd(0x3d5509f9);
+    const void* c2 = getCurr();
+    dd(0x3e773cc5);
+    const void* c3 = getCurr();
+    dd(0x3f3168b3);
+    const void* c4 = getCurr();
+    dd(0x3f800016);
+
+    const Xmm src1 = LowLane(SRC1);
+    const Xmm scratch = LowLane(SCRATCH);
+    const Xmm scratch2 = LowLane(SCRATCH2);
+
+    Xbyak::Label ret_label;
+
+    align(16);
+    L(subroutine);
+
+    // Handle edge cases
+    vucomiss(src1, src1);
+    jp(ret_label);
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    vminss(src1, src1, dword[rip + input_max]);
+    vmaxss(src1, src1, dword[rip + input_min]);
+
+    // Decompose input
+    vsubss(scratch, src1, dword[rip + half]);
+    vmovss(scratch2, dword[rip + c0]); // Preload c0.
+    vcvtss2si(eax, scratch);
+    vcvtsi2ss(scratch, scratch, eax);
+    // SCRATCH now contains input rounded to the nearest integer.
+    add(eax, 0x7f);
+    vsubss(src1, src1, scratch);
+    // SRC1 contains input - round(input), which is in [-0.5, 0.5).
+    vmulss(scratch2, scratch2, src1);
+    shl(eax, 23);
+    vmovd(scratch, eax);
+    // SCRATCH contains 2^(round(input)).
+
+    // Complete computation of polynomial.
+    vaddss(scratch2, scratch2, dword[rip + c1]);
+    vmulss(scratch2, scratch2, src1);
+    vaddss(scratch2, scratch2, dword[rip + c2]);
+    vmulss(scratch2, scratch2, src1);
+    vaddss(scratch2, scratch2, dword[rip + c3]);
+    vmulss(src1, src1, scratch2);
+    vaddss(src1, src1, dword[rip + c4]);
+    vmulss(src1, src1, scratch);
+
+    // Duplicate result across vector
+    L(ret_label);
+    vshufps(src1, src1, src1, _MM_SHUFFLE(0, 0, 0, 0));
+
+    ret();
+
+    return subroutine;
+}
+
+} // namespace Pica::Shader
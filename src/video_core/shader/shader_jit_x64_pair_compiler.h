@@ -0,0 +1,193 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SwizzlePattern;
+
+namespace Pica::Shader {
+
+/// Memory allocated for each compiled pair shader
+constexpr std::size_t MAX_PAIR_SHADER_SIZE = MAX_PROGRAM_CODE_LENGTH * 96;
+
+/**
+ * State of two vertex shader invocations run together. Each register holds the registers of both
+ * vertices side by side, so that a YMM register loads both with a single access.
+ */
+struct PairUnitState {
+    /// Starts both vertices from the registers of a unit state
+    explicit PairUnitState(const UnitState& state);
+
+    struct Registers {
+        alignas(32) Common::Vec4<float24> input[16][2];
+        alignas(32) Common::Vec4<float24> temporary[16][2];
+        alignas(32) Common::Vec4<float24> output[16][2];
+    } registers;
+
+    /// Start values of the conditional codes and address registers, which are shared by both
+    /// vertices. The values of the second vertex are stored back when the program ends.
+    bool conditional_code[2];
+    s32 address_registers[3];
+
+    static std::size_t InputOffset(const SourceRegister& reg) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Input:
+            return offsetof(PairUnitState, registers.input) + reg.GetIndex() * RegisterStride;
+
+        case RegisterType::Temporary:
+            return offsetof(PairUnitState, registers.temporary) + reg.GetIndex() * RegisterStride;
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+
+    static std::size_t OutputOffset(const DestRegister& reg) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Output:
+            return offsetof(PairUnitState, registers.output) + reg.GetIndex() * RegisterStride;
+
+        case RegisterType::Temporary:
+            return offsetof(PairUnitState, registers.temporary) + reg.GetIndex() * RegisterStride;
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+
+    /// Loads the input registers of both vertices
+    void LoadInput(const ShaderRegs& config, const AttributeBuffer& input0,
+                   const AttributeBuffer& input1);
+
+    void WriteOutput(const ShaderRegs& config, AttributeBuffer& output0,
+                     AttributeBuffer& output1) const;
+
+    static constexpr std::size_t RegisterStride = 2 * sizeof(Common::Vec4<float24>);
+};
+
+/**
+ * Recompiles a Pica shader program into AVX2 code that runs two vertices per call, one in each
+ * 128-bit lane of the YMM registers. Uniform flow control is shared by both vertices. When a
+ * conditional branch goes a different way for each vertex, or the program reaches an instruction
+ * that the variant doesn't handle, Run returns false and the caller runs both vertices again with
+ * the scalar JitShader. This is exact as the inputs are left untouched.
+ */
+class JitPairShader : public Xbyak::CodeGenerator {
+public:
+    JitPairShader();
+
+    /// Returns false if the vertices have to be run one at a time instead
+    bool Run(const ShaderSetup& setup, PairUnitState& state, unsigned offset) const {
+        return program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+    }
+
+    void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_EX2(Instruction instr);
+    void Compile_LG2(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOVA(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_BREAKC(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLC(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_JMP(Instruction instr);
+    void Compile_CMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+    void Compile_Fallback(Instruction instr);
+
+private:
+    void Compile_Block(unsigned end);
+    void Compile_NextInstr();
+
+    void Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
+                            Xbyak::Ymm dest);
+    void Compile_DestEnable(Instruction instr, Xbyak::Ymm dest);
+
+    /**
+     * Compiles a `MUL src1, src2` operation, properly handling the PICA semantics when multiplying
+     * zero by inf. Clobbers `src2` and `scratch`.
+     */
+    void Compile_SanitizedMul(Xbyak::Ymm src1, Xbyak::Ymm src2, Xbyak::Ymm scratch);
+
+    /// Calls a scalar subroutine of the prelude on each vertex of SRC1
+    void Compile_CallPerVertex(const Xbyak::Label& subroutine);
+
+    /**
+     * Evaluates a conditional code condition for both vertices, leaving ZF clear if it holds.
+     * Leaves the program if it only holds for one of them.
+     */
+    void Compile_EvaluateCondition(Instruction instr);
+    void Compile_UniformCondition(Instruction instr);
+
+    /// Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction
+    void Compile_Return();
+
+    /// Leaves the program for the scalar shader to run, if the condition doesn't hold
+    void Compile_Assert(bool condition);
+
+    void FindReturnOffsets();
+
+    void CompilePrelude();
+    Xbyak::Label CompilePrelude_Log2();
+    Xbyak::Label CompilePrelude_Exp2();
+
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /// Label pointing to the end of the current LOOP block
+    std::optional<Xbyak::Label> loop_break_label;
+
+    /// Label of the exit taken when the vertices have to be run by the scalar shader
+    Xbyak::Label fallback_label;
+
+    /// Offsets in code where a return needs to be inserted
+    std::vector<unsigned> return_offsets;
+
+    unsigned program_counter = 0; ///< Offset of the next instruction to decode
+    bool looping = false;         ///< True if compiling a loop, used to check for nested loops
+
+    using CompiledShader = bool(const void* setup, void* state, const u8* start_addr);
+    CompiledShader* program = nullptr;
+
+    Xbyak::Label log2_subroutine;
+    Xbyak::Label exp2_subroutine;
+};
+
+} // namespace Pica::Shader
@@ -114,7 +114,7 @@ void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const Outpu
     static const float24 EPSILON = float24::FromFloat32(0.00001f);
     static const float24 f0 = float24::FromFloat32(0.0);
     static const float24 f1 = float24::FromFloat32(1.0);
-    static const std::array<ClippingEdge, 7> clipping_edges = {{
+    std::array<ClippingEdge, 7> clipping_edges = {{
         {Common::MakeVec(-f1, f0, f0, f1)}, // x = +w
         {Common::MakeVec(f1, f0, f0, f1)},  // x = -w
         {Common::MakeVec(f0, -f1, f0, f1)}, // y = +w
@@ -125,6 +125,28 @@ void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const Outpu
          Common::Vec4<float24>(f0, f0, f0, EPSILON)}, // w = EPSILON
     }};
 
+    // When the rasterizer leaves out the pixels outside the viewport, x and y only have to be
+    // clipped where the screen coordinates would leave the guard band, so that most triangles
+    // crossing the viewport edges pass without being clipped
+    if (Rasterizer::GetGuardBandViewport()) {
+        const auto& regs = g_state.regs.rasterizer;
+        const float halfsize_x = float24::FromRaw(regs.viewport_size_x).ToFloat32();
+        const float halfsize_y = float24::FromRaw(regs.viewport_size_y).ToFloat32();
+        const float offset_x = static_cast<float>(regs.viewport_corner.x);
+        const float offset_y = static_cast<float>(regs.viewport_corner.y);
+        const float max_screen = Rasterizer::GUARD_BAND_SIZE - 1.0f;
+        const auto low = [](float halfsize, float offset) {
+            return float24::FromFloat32(-offset / halfsize - 1.0f);
+        };
+        const auto high = [&](float halfsize, float offset) {
+            return float24::FromFloat32((max_screen - offset) / halfsize - 1.0f);
+        };
+        clipping_edges[0] = {Common::MakeVec(-f1, f0, f0, high(halfsize_x, offset_x))};
+        clipping_edges[1] = {Common::MakeVec(f1, f0, f0, -low(halfsize_x, offset_x))};
+        clipping_edges[2] = {Common::MakeVec(f0, -f1, f0, high(halfsize_y, offset_y))};
+        clipping_edges[3] = {Common::MakeVec(f0, f1, f0, -low(halfsize_y, offset_y))};
+    }
+
     // Simple implementation of the Sutherland-Hodgman clipping algorithm.
     // TODO: Make this less inefficient (currently lots of useless buffering overhead happens here)
     auto Clip = [&](const ClippingEdge& edge) {
@@ -148,19 +170,30 @@ void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const Outpu
         }
     };
 
-    for (auto edge : clipping_edges) {
-        Clip(edge);
-
+    // Returns false if nothing of the polygon is left. Edges that all vertices are inside of
+    // leave the polygon as is, so it isn't copied for them.
+    auto ClipIfCrossed = [&](const ClippingEdge& edge) {
+        const auto inside =
+            std::count_if(output_list->begin(), output_list->end(),
+                          [&](const Vertex& vertex) { return edge.IsInside(vertex); });
+        if (inside == 0) {
+            return false;
+        }
+        if (static_cast<std::size_t>(inside) != output_list->size()) {
+            Clip(edge);
+        }
         // Need to have at least a full triangle to continue...
-        if (output_list->size() < 3)
+        return output_list->size() >= 3;
+    };
+
+    for (const auto& edge : clipping_edges) {
+        if (!ClipIfCrossed(edge))
             return;
     }
 
     if (g_state.regs.rasterizer.clip_enable) {
         ClippingEdge custom_edge{g_state.regs.rasterizer.GetClipCoef()};
-        Clip(custom_edge);
-
-        if (output_list->size() < 3)
+        if (!ClipIfCrossed(custom_edge))
             return;
     }
 
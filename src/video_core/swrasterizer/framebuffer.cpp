@@ -3,10 +3,13 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/math_util.h"
 #include "common/vector_math.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
@@ -18,20 +21,141 @@
 
 namespace Pica::Rasterizer {
 
-void DrawPixel(int x, int y, const Common::Vec4<u8>& color) {
+/// Side length in pixels of the largest tile a thread caches the render targets of
+constexpr int MAX_CACHED_TILE_SIZE = 32;
+
+/// Linear copy of the pixels of one render target inside the cached tile
+struct CachedTarget {
+    PAddr addr;
+    u32 bytes_per_pixel;
+    bool loaded;
+    bool dirty;
+    std::array<u8, MAX_CACHED_TILE_SIZE * MAX_CACHED_TILE_SIZE * 4> data;
+};
+
+/// Render targets of the tile that this thread draws, see BeginTileCache
+struct TileCache {
+    bool active = false;
+    Common::Rectangle<int> pixels;
+    CachedTarget color;
+    CachedTarget depth;
+};
+
+static thread_local TileCache tile_cache;
+
+/// Returns the guest memory of a pixel of a render target
+static u8* GetTargetPixel(PAddr addr, u32 bytes_per_pixel, int x, int y) {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
 
     // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
     // NOTE: The framebuffer height register contains the actual FB height minus one.
     y = framebuffer.height - y;
 
     const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
+    const u32 offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
+                       coarse_y * framebuffer.width * bytes_per_pixel;
+    return VideoCore::g_memory->GetPhysicalPointer(addr) + offset;
+}
+
+/// Copies the pixels of the cached tile between guest memory and the linear copy of a target
+static void TransferCachedTarget(CachedTarget& target, bool store) {
+    const auto& pixels = tile_cache.pixels;
+    const u32 bytes_per_pixel = target.bytes_per_pixel;
+    u8* linear = target.data.data();
+    for (int y = pixels.top; y < pixels.bottom; ++y) {
+        for (int x = pixels.left; x < pixels.right; ++x) {
+            u8* guest = GetTargetPixel(target.addr, bytes_per_pixel, x, y);
+            if (store) {
+                std::memcpy(guest, linear, bytes_per_pixel);
+            } else {
+                std::memcpy(linear, guest, bytes_per_pixel);
+            }
+            linear += bytes_per_pixel;
+        }
+    }
+}
+
+/**
+ * Returns the memory of a pixel of a render target, which is the linear copy of the target if the
+ * pixel is inside the cached tile. The copy is loaded on first use.
+ */
+static u8* GetPixelPointer(CachedTarget& target, PAddr addr, u32 bytes_per_pixel, int x, int y,
+                           bool write) {
+    const auto& pixels = tile_cache.pixels;
+    if (!tile_cache.active || x < pixels.left || x >= pixels.right || y < pixels.top ||
+        y >= pixels.bottom) {
+        return GetTargetPixel(addr, bytes_per_pixel, x, y);
+    }
+    if (!target.loaded) {
+        target.addr = addr;
+        target.bytes_per_pixel = bytes_per_pixel;
+        TransferCachedTarget(target, false);
+        target.loaded = true;
+    }
+    target.dirty |= write;
+    const int index = (y - pixels.top) * pixels.GetWidth() + (x - pixels.left);
+    return target.data.data() + index * bytes_per_pixel;
+}
+
+static u8* GetColorPixel(int x, int y, bool write) {
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const u32 bytes_per_pixel =
         GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + dst_offset;
+    return GetPixelPointer(tile_cache.color, framebuffer.GetColorBufferPhysicalAddress(),
+                           bytes_per_pixel, x, y, write);
+}
+
+static u8* GetDepthPixel(int x, int y, bool write) {
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
+    return GetPixelPointer(tile_cache.depth, framebuffer.GetDepthBufferPhysicalAddress(),
+                           bytes_per_pixel, x, y, write);
+}
+
+void BeginTileCache(const Common::Rectangle<int>& pixels) {
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    ASSERT(pixels.GetWidth() <= MAX_CACHED_TILE_SIZE &&
+           pixels.GetHeight() <= MAX_CACHED_TILE_SIZE);
+
+    const u32 num_pixels = framebuffer.GetWidth() * framebuffer.GetHeight();
+    const PAddr color_start = framebuffer.GetColorBufferPhysicalAddress();
+    const PAddr color_end =
+        color_start + num_pixels * FramebufferRegs::BytesPerColorPixel(framebuffer.color_format);
+    const PAddr depth_start = framebuffer.GetDepthBufferPhysicalAddress();
+    const PAddr depth_end =
+        depth_start + num_pixels * FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
+    if (color_start < depth_end && depth_start < color_end) {
+        // The copies of aliased targets would go out of sync
+        return;
+    }
+
+    tile_cache.pixels = {std::max(pixels.left, 0), std::max(pixels.top, 0),
+                         std::min<int>(pixels.right, framebuffer.GetWidth()),
+                         std::min<int>(pixels.bottom, framebuffer.GetHeight())};
+    if (tile_cache.pixels.left >= tile_cache.pixels.right ||
+        tile_cache.pixels.top >= tile_cache.pixels.bottom) {
+        return;
+    }
+    tile_cache.active = true;
+    tile_cache.color.loaded = tile_cache.color.dirty = false;
+    tile_cache.depth.loaded = tile_cache.depth.dirty = false;
+}
+
+void EndTileCache() {
+    if (!tile_cache.active) {
+        return;
+    }
+    for (CachedTarget* target : {&tile_cache.color, &tile_cache.depth}) {
+        if (target->dirty) {
+            TransferCachedTarget(*target, true);
+        }
+    }
+    tile_cache.active = false;
+}
+
+void DrawPixel(int x, int y, const Common::Vec4<u8>& color) {
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    u8* dst_pixel = GetColorPixel(x, y, true);
 
     switch (framebuffer.color_format) {
     case FramebufferRegs::ColorFormat::RGBA8:
@@ -63,16 +187,7 @@ void DrawPixel(int x, int y, const Common::Vec4<u8>& color) {
 
 const Common::Vec4<u8> GetPixel(int x, int y) {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* src_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + src_offset;
+    const u8* src_pixel = GetColorPixel(x, y, false);
 
     switch (framebuffer.color_format) {
     case FramebufferRegs::ColorFormat::RGBA8:
@@ -101,17 +216,7 @@ const Common::Vec4<u8> GetPixel(int x, int y) {
 
 u32 GetDepth(int x, int y) {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
+    const u8* src_pixel = GetDepthPixel(x, y, false);
 
     switch (framebuffer.depth_format) {
     case FramebufferRegs::DepthFormat::D16:
@@ -130,17 +235,7 @@ u32 GetDepth(int x, int y) {
 
 u8 GetStencil(int x, int y) {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
+    const u8* src_pixel = GetDepthPixel(x, y, false);
 
     switch (framebuffer.depth_format) {
     case FramebufferRegs::DepthFormat::D24S8:
@@ -157,17 +252,7 @@ u8 GetStencil(int x, int y) {
 
 void SetDepth(int x, int y, u32 value) {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
+    u8* dst_pixel = GetDepthPixel(x, y, true);
 
     switch (framebuffer.depth_format) {
     case FramebufferRegs::DepthFormat::D16:
@@ -192,17 +277,7 @@ void SetDepth(int x, int y, u32 value) {
 
 void SetStencil(int x, int y, u8 value) {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
+    u8* dst_pixel = GetDepthPixel(x, y, true);
 
     switch (framebuffer.depth_format) {
     case Pica::FramebufferRegs::DepthFormat::D16:
@@ -378,15 +453,8 @@ static void EncodeX24S8Shadow(u8 stencil, u8* bytes) {
 void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) {
     const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
     const auto& shadow = g_state.regs.framebuffer.shadow;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = 4;
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + dst_offset;
+    // Shadow maps bypass the tile cache, as no other accessor touches them in the same draw
+    u8* dst_pixel = GetTargetPixel(framebuffer.GetColorBufferPhysicalAddress(), 4, x, y);
 
     auto ref = DecodeD24S8Shadow(dst_pixel);
     u32 ref_z = ref.x;
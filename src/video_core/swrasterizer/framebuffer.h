@@ -5,11 +5,21 @@
 #pragma once
 
 #include "common/common_types.h"
+#include "common/math_util.h"
 #include "common/vector_math.h"
 #include "video_core/regs_framebuffer.h"
 
 namespace Pica::Rasterizer {
 
+/**
+ * Makes the pixel accessors below work on linear copies of the render targets inside a rectangle
+ * of at most 32x32 pixels, so that the Morton offsets of the tile are computed once when a target
+ * is first used. EndTileCache writes back the targets that were changed. Each thread has its own
+ * cache, the tiles of concurrent threads must not overlap.
+ */
+void BeginTileCache(const Common::Rectangle<int>& pixels);
+void EndTileCache();
+
 void DrawPixel(int x, int y, const Common::Vec4<u8>& color);
 const Common::Vec4<u8> GetPixel(int x, int y);
 u32 GetDepth(int x, int y);
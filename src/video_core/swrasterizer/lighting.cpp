@@ -3,25 +3,55 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include "video_core/swrasterizer/lighting.h"
 
 namespace Pica {
 
-static float LookupLightingLut(const Pica::State::Lighting& lighting, std::size_t lut_index,
-                               u8 index, float delta) {
-    ASSERT_MSG(lut_index < lighting.luts.size(), "Out of range lut");
-    ASSERT_MSG(index < lighting.luts[lut_index].size(), "Out of range index");
+static float LookupLightingLut(const LightingCache& cache, std::size_t lut_index, u8 index,
+                               float delta) {
+    ASSERT_MSG(lut_index < cache.luts.size(), "Out of range lut");
+    ASSERT_MSG(index < cache.luts[lut_index].size(), "Out of range index");
 
-    const auto& lut = lighting.luts[lut_index][index];
+    const auto& lut = cache.luts[lut_index][index];
+    return lut.x + lut.y * delta;
+}
 
-    float lut_value = lut.ToFloat();
-    float lut_diff = lut.DiffToFloat();
+void UpdateLightingCache(LightingCache& cache, const Pica::LightingRegs& lighting,
+                         const Pica::State::Lighting& lighting_state) {
+    for (std::size_t i = 0; i < cache.lights.size(); ++i) {
+        const auto& light_config = lighting.light[i];
+        auto& light = cache.lights[i];
+        light.position = {float16::FromRaw(light_config.x).ToFloat32(),
+                          float16::FromRaw(light_config.y).ToFloat32(),
+                          float16::FromRaw(light_config.z).ToFloat32()};
+        const Common::Vec3<s32> spot_dir{light_config.spot_x.Value(), light_config.spot_y.Value(),
+                                         light_config.spot_z.Value()};
+        light.spot_direction = spot_dir.Cast<float>() / 2047.0f;
+        light.specular_0 = light_config.specular_0.ToVec3f();
+        light.specular_1 = light_config.specular_1.ToVec3f();
+        light.diffuse = light_config.diffuse.ToVec3f();
+        light.ambient = light_config.ambient.ToVec3f();
+        light.dist_atten_scale = Pica::float20::FromRaw(light_config.dist_atten_scale).ToFloat32();
+        light.dist_atten_bias = Pica::float20::FromRaw(light_config.dist_atten_bias).ToFloat32();
+    }
+    cache.global_ambient = lighting.global_ambient.ToVec3f();
 
-    return lut_value + lut_diff * delta;
+    for (std::size_t i = 0; i < cache.luts.size(); ++i) {
+        const auto& lut = lighting_state.luts[i];
+        auto& raw = cache.raw_luts[i];
+        if (std::memcmp(raw.data(), lut.data(), sizeof(raw)) == 0) {
+            continue;
+        }
+        std::memcpy(raw.data(), lut.data(), sizeof(raw));
+        for (std::size_t entry = 0; entry < lut.size(); ++entry) {
+            cache.luts[i][entry] = {lut[entry].ToFloat(), lut[entry].DiffToFloat()};
+        }
+    }
 }
 
 std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
-    const Pica::LightingRegs& lighting, const Pica::State::Lighting& lighting_state,
+    const Pica::LightingRegs& lighting, const LightingCache& cache,
     const Common::Quaternion<float>& normquat, const Common::Vec3<float>& view,
     const Common::Vec4<u8> (&texture_color)[4]) {
 
@@ -68,14 +98,15 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
     Common::Vec4<float> diffuse_sum = {0.0f, 0.0f, 0.0f, 1.0f};
     Common::Vec4<float> specular_sum = {0.0f, 0.0f, 0.0f, 1.0f};
 
+    const Common::Vec3<float> norm_view = view.Normalized();
+
     for (unsigned light_index = 0; light_index <= lighting.max_light_index; ++light_index) {
         unsigned num = lighting.light_enable.GetNum(light_index);
         const auto& light_config = lighting.light[num];
+        const auto& light = cache.lights[num];
 
         Common::Vec3<float> refl_value = {};
-        Common::Vec3<float> position = {float16::FromRaw(light_config.x).ToFloat32(),
-                                        float16::FromRaw(light_config.y).ToFloat32(),
-                                        float16::FromRaw(light_config.z).ToFloat32()};
+        const Common::Vec3<float>& position = light.position;
         Common::Vec3<float> light_vector;
 
         if (light_config.config.directional)
@@ -85,14 +116,14 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
 
         light_vector.Normalize();
 
-        Common::Vec3<float> norm_view = view.Normalized();
         Common::Vec3<float> half_vector = norm_view + light_vector;
+        const Common::Vec3<float> norm_half_vector = half_vector.Normalized();
 
         float dist_atten = 1.0f;
         if (!lighting.IsDistAttenDisabled(num)) {
             auto distance = (-view - position).Length();
-            float scale = Pica::float20::FromRaw(light_config.dist_atten_scale).ToFloat32();
-            float bias = Pica::float20::FromRaw(light_config.dist_atten_bias).ToFloat32();
+            float scale = light.dist_atten_scale;
+            float bias = light.dist_atten_bias;
             std::size_t lut =
                 static_cast<std::size_t>(LightingRegs::LightingSampler::DistanceAttenuation) + num;
 
@@ -101,7 +132,7 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
             u8 lutindex =
                 static_cast<u8>(std::clamp(std::floor(sample_loc * 256.0f), 0.0f, 255.0f));
             float delta = sample_loc * 256 - lutindex;
-            dist_atten = LookupLightingLut(lighting_state, lut, lutindex, delta);
+            dist_atten = LookupLightingLut(cache, lut, lutindex, delta);
         }
 
         auto GetLutValue = [&](LightingRegs::LightingLutInput input, bool abs,
@@ -111,11 +142,11 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
 
             switch (input) {
             case LightingRegs::LightingLutInput::NH:
-                result = Common::Dot(normal, half_vector.Normalized());
+                result = Common::Dot(normal, norm_half_vector);
                 break;
 
             case LightingRegs::LightingLutInput::VH:
-                result = Common::Dot(norm_view, half_vector.Normalized());
+                result = Common::Dot(norm_view, norm_half_vector);
                 break;
 
             case LightingRegs::LightingLutInput::NV:
@@ -126,15 +157,12 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
                 result = Common::Dot(light_vector, normal);
                 break;
 
-            case LightingRegs::LightingLutInput::SP: {
-                Common::Vec3<s32> spot_dir{light_config.spot_x.Value(), light_config.spot_y.Value(),
-                                           light_config.spot_z.Value()};
-                result = Common::Dot(light_vector, spot_dir.Cast<float>() / 2047.0f);
+            case LightingRegs::LightingLutInput::SP:
+                result = Common::Dot(light_vector, light.spot_direction);
                 break;
-            }
+
             case LightingRegs::LightingLutInput::CP:
                 if (lighting.config0.config == LightingRegs::LightingConfig::Config7) {
-                    const Common::Vec3<float> norm_half_vector = half_vector.Normalized();
                     const Common::Vec3<float> half_vector_proj =
                         norm_half_vector - normal * Common::Dot(normal, norm_half_vector);
                     result = Common::Dot(half_vector_proj, tangent);
@@ -168,8 +196,8 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
             }
 
             float scale = lighting.lut_scale.GetScale(scale_enum);
-            return scale * LookupLightingLut(lighting_state, static_cast<std::size_t>(sampler),
-                                             index, delta);
+            return scale *
+                   LookupLightingLut(cache, static_cast<std::size_t>(sampler), index, delta);
         };
 
         // If enabled, compute spot light attenuation value
@@ -192,7 +220,7 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
                             lighting.lut_scale.d0, LightingRegs::LightingSampler::Distribution0);
         }
 
-        Common::Vec3<float> specular_0 = d0_lut_value * light_config.specular_0.ToVec3f();
+        Common::Vec3<float> specular_0 = d0_lut_value * light.specular_0;
 
         // If enabled, lookup ReflectRed value, otherwise, 1.0 is used
         if (lighting.config1.disable_lut_rr == 0 &&
@@ -238,7 +266,7 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
         }
 
         Common::Vec3<float> specular_1 =
-            d1_lut_value * refl_value * light_config.specular_1.ToVec3f();
+            d1_lut_value * refl_value * light.specular_1;
 
         // Fresnel
         // Note: only the last entry in the light slots applies the Fresnel factor
@@ -283,9 +311,7 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
             }
         }
 
-        auto diffuse =
-            (light_config.diffuse.ToVec3f() * dot_product + light_config.ambient.ToVec3f()) *
-            dist_atten * spot_atten;
+        auto diffuse = (light.diffuse * dot_product + light.ambient) * dist_atten * spot_atten;
         auto specular = (specular_0 + specular_1) * clamp_highlights * dist_atten * spot_atten;
 
         if (!lighting.IsShadowDisabled(num)) {
@@ -314,7 +340,7 @@ std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
         }
     }
 
-    diffuse_sum += Common::MakeVec(lighting.global_ambient.ToVec3f(), 0.0f);
+    diffuse_sum += Common::MakeVec(cache.global_ambient, 0.0f);
 
     auto diffuse = Common::MakeVec<float>(std::clamp(diffuse_sum.x, 0.0f, 1.0f) * 255,
                                           std::clamp(diffuse_sum.y, 0.0f, 1.0f) * 255,
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
 #include "common/quaternion.h"
 #include "common/vector_math.h"
@@ -11,8 +12,37 @@
 
 namespace Pica {
 
+/**
+ * Lighting LUTs and light parameters of a draw converted to native floats, so that fragments
+ * don't decode the bit fields again for every lookup.
+ */
+struct LightingCache {
+    struct Light {
+        Common::Vec3<float> position;
+        Common::Vec3<float> spot_direction;
+        Common::Vec3<float> specular_0;
+        Common::Vec3<float> specular_1;
+        Common::Vec3<float> diffuse;
+        Common::Vec3<float> ambient;
+        float dist_atten_scale;
+        float dist_atten_bias;
+    };
+
+    std::array<Light, 8> lights;
+    Common::Vec3<float> global_ambient;
+
+    /// Value and difference of each LUT entry
+    std::array<std::array<Common::Vec2<float>, 256>, 24> luts{};
+    /// Raw entries the LUTs were converted from, only changed LUTs are converted again
+    std::array<std::array<u32, 256>, 24> raw_luts{};
+};
+
+/// Converts the lighting state for the next draw
+void UpdateLightingCache(LightingCache& cache, const Pica::LightingRegs& lighting,
+                         const Pica::State::Lighting& lighting_state);
+
 std::tuple<Common::Vec4<u8>, Common::Vec4<u8>> ComputeFragmentsColors(
-    const Pica::LightingRegs& lighting, const Pica::State::Lighting& lighting_state,
+    const Pica::LightingRegs& lighting, const LightingCache& cache,
     const Common::Quaternion<float>& normquat, const Common::Vec3<float>& view,
     const Common::Vec4<u8> (&texture_color)[4]);
 
@@ -4,6 +4,7 @@
 
 #include <array>
 #include <cmath>
+#include <cstring>
 #include "common/math_util.h"
 #include "video_core/swrasterizer/proctex.h"
 
@@ -14,14 +15,47 @@ using ProcTexShift = TexturingRegs::ProcTexShift;
 using ProcTexCombiner = TexturingRegs::ProcTexCombiner;
 using ProcTexFilter = TexturingRegs::ProcTexFilter;
 
-static float LookupLUT(const std::array<State::ProcTex::ValueEntry, 128>& lut, float coord) {
+static float LookupLUT(const std::array<Common::Vec2<float>, 128>& lut, float coord) {
     // For NoiseLUT/ColorMap/AlphaMap, coord=0.0 is lut[0], coord=127.0/128.0 is lut[127] and
     // coord=1.0 is lut[127]+lut_diff[127]. For other indices, the result is interpolated using
     // value entries and difference entries.
     coord *= 128;
     const int index_int = std::min(static_cast<int>(coord), 127);
     const float frac = coord - index_int;
-    return lut[index_int].ToFloat() + frac * lut[index_int].DiffToFloat();
+    return lut[index_int].x + frac * lut[index_int].y;
+}
+
+void UpdateProcTexCache(ProcTexCache& cache, const TexturingRegs& regs,
+                        const State::ProcTex& state) {
+    cache.noise_freq_u = float16::FromRaw(regs.proctex_noise_frequency.u).ToFloat32();
+    cache.noise_freq_v = float16::FromRaw(regs.proctex_noise_frequency.v).ToFloat32();
+    cache.noise_phase_u = float16::FromRaw(regs.proctex_noise_u.phase).ToFloat32();
+    cache.noise_phase_v = float16::FromRaw(regs.proctex_noise_v.phase).ToFloat32();
+
+    const auto convert_values = [](auto& table, const auto& raw_table, auto& raw) {
+        if (std::memcmp(raw.data(), raw_table.data(), sizeof(raw)) == 0) {
+            return;
+        }
+        std::memcpy(raw.data(), raw_table.data(), sizeof(raw));
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            table[i] = {raw_table[i].ToFloat(), raw_table[i].DiffToFloat()};
+        }
+    };
+    convert_values(cache.noise_table, state.noise_table, cache.raw.noise_table);
+    convert_values(cache.color_map_table, state.color_map_table, cache.raw.color_map_table);
+    convert_values(cache.alpha_map_table, state.alpha_map_table, cache.raw.alpha_map_table);
+
+    const auto convert_colors = [](auto& table, const auto& raw_table, auto& raw) {
+        if (std::memcmp(raw.data(), raw_table.data(), sizeof(raw)) == 0) {
+            return;
+        }
+        std::memcpy(raw.data(), raw_table.data(), sizeof(raw));
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            table[i] = raw_table[i].ToVector().template Cast<float>();
+        }
+    };
+    convert_colors(cache.color_table, state.color_table, cache.raw.color_table);
+    convert_colors(cache.color_diff_table, state.color_diff_table, cache.raw.color_diff_table);
 }
 
 // These function are used to generate random noise for procedural texture. Their results are
@@ -45,13 +79,9 @@ static float NoiseRand2D(unsigned int x, unsigned int y) {
     return -1.0f + v2 * 2.0f / 15.0f;
 }
 
-static float NoiseCoef(float u, float v, const TexturingRegs& regs, const State::ProcTex& state) {
-    const float freq_u = float16::FromRaw(regs.proctex_noise_frequency.u).ToFloat32();
-    const float freq_v = float16::FromRaw(regs.proctex_noise_frequency.v).ToFloat32();
-    const float phase_u = float16::FromRaw(regs.proctex_noise_u.phase).ToFloat32();
-    const float phase_v = float16::FromRaw(regs.proctex_noise_v.phase).ToFloat32();
-    const float x = 9 * freq_u * std::abs(u + phase_u);
-    const float y = 9 * freq_v * std::abs(v + phase_v);
+static float NoiseCoef(float u, float v, const ProcTexCache& cache) {
+    const float x = 9 * cache.noise_freq_u * std::abs(u + cache.noise_phase_u);
+    const float y = 9 * cache.noise_freq_v * std::abs(v + cache.noise_phase_v);
     const int x_int = static_cast<int>(x);
     const int y_int = static_cast<int>(y);
     const float x_frac = x - x_int;
@@ -61,8 +91,8 @@ static float NoiseCoef(float u, float v, const TexturingRegs& regs, const State:
     const float g1 = NoiseRand2D(x_int + 1, y_int) * (x_frac + y_frac - 1);
     const float g2 = NoiseRand2D(x_int, y_int + 1) * (x_frac + y_frac - 1);
     const float g3 = NoiseRand2D(x_int + 1, y_int + 1) * (x_frac + y_frac - 2);
-    const float x_noise = LookupLUT(state.noise_table, x_frac);
-    const float y_noise = LookupLUT(state.noise_table, y_frac);
+    const float x_noise = LookupLUT(cache.noise_table, x_frac);
+    const float y_noise = LookupLUT(cache.noise_table, y_frac);
     return Common::BilinearInterp(g0, g1, g2, g3, x_noise, y_noise);
 }
 
@@ -113,7 +143,7 @@ static void ClampCoord(float& coord, ProcTexClamp mode) {
 }
 
 static float CombineAndMap(float u, float v, ProcTexCombiner combiner,
-                           const std::array<State::ProcTex::ValueEntry, 128>& map_table) {
+                           const std::array<Common::Vec2<float>, 128>& map_table) {
     float f;
     switch (combiner) {
     case ProcTexCombiner::U:
@@ -154,7 +184,7 @@ static float CombineAndMap(float u, float v, ProcTexCombiner combiner,
     return LookupLUT(map_table, f);
 }
 
-Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const State::ProcTex& state) {
+Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const ProcTexCache& cache) {
     u = std::abs(u);
     v = std::abs(v);
 
@@ -164,7 +194,7 @@ Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const Stat
 
     // Generate noise
     if (regs.proctex.noise_enable) {
-        float noise = NoiseCoef(u, v, regs, state);
+        float noise = NoiseCoef(u, v, cache);
         u += noise * regs.proctex_noise_u.amplitude / 4095.0f;
         v += noise * regs.proctex_noise_v.amplitude / 4095.0f;
         u = std::abs(u);
@@ -180,7 +210,7 @@ Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const Stat
     ClampCoord(v, regs.proctex.v_clamp);
 
     // Combine and map
-    const float lut_coord = CombineAndMap(u, v, regs.proctex.color_combiner, state.color_map_table);
+    const float lut_coord = CombineAndMap(u, v, regs.proctex.color_combiner, cache.color_map_table);
 
     // Look up the color
     // For the color lut, coord=0.0 is lut[offset] and coord=1.0 is lut[offset+width-1]
@@ -195,15 +225,15 @@ Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const Stat
     case ProcTexFilter::LinearMipmapNearest: {
         const int index_int = static_cast<int>(index);
         const float frac = index - index_int;
-        const auto color_value = state.color_table[index_int].ToVector().Cast<float>();
-        const auto color_diff = state.color_diff_table[index_int].ToVector().Cast<float>();
+        const auto& color_value = cache.color_table[index_int];
+        const auto& color_diff = cache.color_diff_table[index_int];
         final_color = (color_value + frac * color_diff).Cast<u8>();
         break;
     }
     case ProcTexFilter::Nearest:
     case ProcTexFilter::NearestMipmapLinear:
     case ProcTexFilter::NearestMipmapNearest:
-        final_color = state.color_table[static_cast<int>(std::round(index))].ToVector();
+        final_color = cache.color_table[static_cast<int>(std::round(index))].Cast<u8>();
         break;
     }
 
@@ -211,7 +241,7 @@ Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const Stat
         // Note: in separate alpha mode, the alpha channel skips the color LUT look up stage. It
         // uses the output of CombineAndMap directly instead.
         const float final_alpha =
-            CombineAndMap(u, v, regs.proctex.alpha_combiner, state.alpha_map_table);
+            CombineAndMap(u, v, regs.proctex.alpha_combiner, cache.alpha_map_table);
         return Common::MakeVec<u8>(final_color.rgb(), static_cast<u8>(final_alpha * 255));
     } else {
         return final_color;
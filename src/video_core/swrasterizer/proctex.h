@@ -4,13 +4,39 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/pica_state.h"
 
 namespace Pica::Rasterizer {
 
+/**
+ * Procedural texture LUTs and noise parameters of a draw converted to native floats, so that
+ * fragments don't decode the bit fields again for every lookup.
+ */
+struct ProcTexCache {
+    float noise_freq_u;
+    float noise_freq_v;
+    float noise_phase_u;
+    float noise_phase_v;
+
+    /// Value and difference of each entry of the noise, color map and alpha map LUTs
+    std::array<Common::Vec2<float>, 128> noise_table{};
+    std::array<Common::Vec2<float>, 128> color_map_table{};
+    std::array<Common::Vec2<float>, 128> alpha_map_table{};
+    std::array<Common::Vec4<float>, 256> color_table{};
+    std::array<Common::Vec4<float>, 256> color_diff_table{};
+
+    /// Tables the LUTs were converted from, they are only converted again when they change
+    State::ProcTex raw{};
+};
+
+/// Converts the procedural texture state for the next draw
+void UpdateProcTexCache(ProcTexCache& cache, const TexturingRegs& regs,
+                        const State::ProcTex& state);
+
 /// Generates procedural texture color for the given coordinates
-Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const State::ProcTex& state);
+Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const ProcTexCache& cache);
 
 } // namespace Pica::Rasterizer
@@ -4,13 +4,25 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
+#include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/color.h"
+#include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/quaternion.h"
 #include "common/vector_math.h"
@@ -32,6 +44,14 @@
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
 
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#define RASTERIZER_HAVE_SSE2
+#elif defined(ARCHITECTURE_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define RASTERIZER_HAVE_NEON
+#endif
+
 namespace Pica::Rasterizer {
 
 // NOTE: Assuming that rasterizer coordinates are 12.4 fixed-point values
@@ -119,24 +139,236 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+/// Number of horizontally adjacent pixels whose coverage and depth are computed at once
+constexpr u32 SPAN_WIDTH = 4;
+
 /**
- * Helper function for ProcessTriangle with the "reversed" flag to allow for implementing
- * culling via recursion.
+ * Edge function values of the pixels in a span, along with the per-triangle constants needed to
+ * compute their depth. The edge functions are linear in x, so moving to the next span adds a
+ * constant step to them.
  */
-static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                                    bool reversed = false) {
-    const auto& regs = g_state.regs;
-    MICROPROFILE_SCOPE(GPU_Rasterization);
+struct SpanSetup {
+    alignas(16) std::array<std::array<s32, SPAN_WIDTH>, 3> w;
+    std::array<s32, 3> step; ///< Increment of w between two spans
+    std::array<float, 3> z;  ///< Screen space z of the vertices
+    float depth_scale;
+    float depth_offset;
+};
+
+/// Coverage, barycentric coordinates and depth of the pixels in a span
+struct Span {
+    alignas(16) std::array<std::array<s32, SPAN_WIDTH>, 3> w;
+    /// Z-Buffer depth, before W-buffering and clamping are applied
+    alignas(16) std::array<float, SPAN_WIDTH> depth;
+    /// Bit i is set if pixel i is covered by the triangle
+    u32 coverage;
+};
+
+/**
+ * Computes the span at the current position of setup, then advances setup to the next span. The
+ * depth is only valid for covered pixels and follows the operation order of the scalar formula
+ * (z0 * w0 + z1 * w1 + z2 * w2) / wsum * scale + offset, so the results are bit-exact.
+ */
+static void ComputeSpan(SpanSetup& setup, Span& span) {
+#if defined(RASTERIZER_HAVE_SSE2)
+    const __m128i w0 = _mm_load_si128(reinterpret_cast<const __m128i*>(setup.w[0].data()));
+    const __m128i w1 = _mm_load_si128(reinterpret_cast<const __m128i*>(setup.w[1].data()));
+    const __m128i w2 = _mm_load_si128(reinterpret_cast<const __m128i*>(setup.w[2].data()));
+    _mm_store_si128(reinterpret_cast<__m128i*>(span.w[0].data()), w0);
+    _mm_store_si128(reinterpret_cast<__m128i*>(span.w[1].data()), w1);
+    _mm_store_si128(reinterpret_cast<__m128i*>(span.w[2].data()), w2);
+    _mm_store_si128(reinterpret_cast<__m128i*>(setup.w[0].data()),
+                    _mm_add_epi32(w0, _mm_set1_epi32(setup.step[0])));
+    _mm_store_si128(reinterpret_cast<__m128i*>(setup.w[1].data()),
+                    _mm_add_epi32(w1, _mm_set1_epi32(setup.step[1])));
+    _mm_store_si128(reinterpret_cast<__m128i*>(setup.w[2].data()),
+                    _mm_add_epi32(w2, _mm_set1_epi32(setup.step[2])));
+
+    // A pixel is covered if none of its edge functions is negative
+    const __m128i any_negative = _mm_or_si128(_mm_or_si128(w0, w1), w2);
+    span.coverage = ~_mm_movemask_ps(_mm_castsi128_ps(any_negative)) & 0xF;
+    if (span.coverage == 0) {
+        return;
+    }
+
+    const __m128i wsum = _mm_add_epi32(_mm_add_epi32(w0, w1), w2);
+    const __m128 z_over_w = _mm_div_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(setup.z[0]), _mm_cvtepi32_ps(w0)),
+                              _mm_mul_ps(_mm_set1_ps(setup.z[1]), _mm_cvtepi32_ps(w1))),
+                   _mm_mul_ps(_mm_set1_ps(setup.z[2]), _mm_cvtepi32_ps(w2))),
+        _mm_cvtepi32_ps(wsum));
+    _mm_store_ps(span.depth.data(), _mm_add_ps(_mm_mul_ps(z_over_w, _mm_set1_ps(setup.depth_scale)),
+                                               _mm_set1_ps(setup.depth_offset)));
+#elif defined(RASTERIZER_HAVE_NEON)
+    const int32x4_t w0 = vld1q_s32(setup.w[0].data());
+    const int32x4_t w1 = vld1q_s32(setup.w[1].data());
+    const int32x4_t w2 = vld1q_s32(setup.w[2].data());
+    vst1q_s32(span.w[0].data(), w0);
+    vst1q_s32(span.w[1].data(), w1);
+    vst1q_s32(span.w[2].data(), w2);
+    vst1q_s32(setup.w[0].data(), vaddq_s32(w0, vdupq_n_s32(setup.step[0])));
+    vst1q_s32(setup.w[1].data(), vaddq_s32(w1, vdupq_n_s32(setup.step[1])));
+    vst1q_s32(setup.w[2].data(), vaddq_s32(w2, vdupq_n_s32(setup.step[2])));
+
+    // A pixel is covered if none of its edge functions is negative
+    static constexpr int32_t lane_shifts[SPAN_WIDTH] = {0, 1, 2, 3};
+    const uint32x4_t covered = vshrq_n_u32(
+        vreinterpretq_u32_s32(vmvnq_s32(vorrq_s32(vorrq_s32(w0, w1), w2))), 31);
+    span.coverage = vaddvq_u32(vshlq_u32(covered, vld1q_s32(lane_shifts)));
+    if (span.coverage == 0) {
+        return;
+    }
 
-    // vertex positions in rasterizer coordinates
+    const int32x4_t wsum = vaddq_s32(vaddq_s32(w0, w1), w2);
+    const float32x4_t z_over_w =
+        vdivq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(vcvtq_f32_s32(w0), setup.z[0]),
+                                      vmulq_n_f32(vcvtq_f32_s32(w1), setup.z[1])),
+                            vmulq_n_f32(vcvtq_f32_s32(w2), setup.z[2])),
+                  vcvtq_f32_s32(wsum));
+    vst1q_f32(span.depth.data(), vaddq_f32(vmulq_n_f32(z_over_w, setup.depth_scale),
+                                           vdupq_n_f32(setup.depth_offset)));
+#else
+    span.w = setup.w;
+    span.coverage = 0;
+    for (u32 i = 0; i < SPAN_WIDTH; ++i) {
+        const s32 w0 = span.w[0][i];
+        const s32 w1 = span.w[1][i];
+        const s32 w2 = span.w[2][i];
+        for (u32 edge = 0; edge < 3; ++edge) {
+            setup.w[edge][i] = static_cast<s32>(static_cast<u32>(setup.w[edge][i]) +
+                                                static_cast<u32>(setup.step[edge]));
+        }
+        if (w0 < 0 || w1 < 0 || w2 < 0) {
+            continue;
+        }
+        span.coverage |= 1u << i;
+        const float z_over_w = (setup.z[0] * w0 + setup.z[1] * w1 + setup.z[2] * w2) /
+                               static_cast<s32>(static_cast<u32>(w0) + w1 + w2);
+        span.depth[i] = z_over_w * setup.depth_scale + setup.depth_offset;
+    }
+#endif
+}
+
+/// Vertex position in rasterizer coordinates
+static Common::Vec3<Fix12P4> ScreenToRasterizerCoordinates(const Common::Vec3<float24>& vec) {
     static auto FloatToFix = [](float24 flt) {
         // TODO: Rounding here is necessary to prevent garbage pixels at
         //       triangle borders. Is it that the correct solution, though?
         return Fix12P4(static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f)));
     };
-    static auto ScreenToRasterizerCoordinates = [](const Common::Vec3<float24>& vec) {
-        return Common::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
-    };
+    return Common::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
+}
+
+/**
+ * Calculates the area a triangle may cover, clipped to the scissor box if the scissor mode is set
+ * to Include. The bounds are 12.4 fixed point values aligned to whole pixels, right and bottom are
+ * exclusive.
+ */
+std::optional<Common::Rectangle<u16>> GetGuardBandViewport() {
+    const auto& regs = g_state.regs.rasterizer;
+    const float width = float24::FromRaw(regs.viewport_size_x).ToFloat32() * 2.0f;
+    const float height = float24::FromRaw(regs.viewport_size_y).ToFloat32() * 2.0f;
+    const s32 x = regs.viewport_corner.x;
+    const s32 y = regs.viewport_corner.y;
+    if (x < 0 || y < 0 || !(width > 0.0f) || !(height > 0.0f) || width != std::floor(width) ||
+        height != std::floor(height) || x + width >= GUARD_BAND_SIZE ||
+        y + height >= GUARD_BAND_SIZE) {
+        return std::nullopt;
+    }
+    return Common::Rectangle<u16>{static_cast<u16>(x << 4), static_cast<u16>(y << 4),
+                                  static_cast<u16>((x + static_cast<s32>(width)) << 4),
+                                  static_cast<u16>((y + static_cast<s32>(height)) << 4)};
+}
+
+static Common::Rectangle<u16> GetBoundingBox(const Common::Vec3<Fix12P4> (&vtxpos)[3]) {
+    const auto& regs = g_state.regs;
+
+    u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
+    u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+    u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
+    u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+
+    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
+        // Convert the scissor box coordinates to 12.4 fixed point
+        u16 scissor_x1 = (u16)(regs.rasterizer.scissor_test.x1 << 4);
+        u16 scissor_y1 = (u16)(regs.rasterizer.scissor_test.y1 << 4);
+        // x2,y2 have +1 added to cover the entire sub-pixel area
+        u16 scissor_x2 = (u16)((regs.rasterizer.scissor_test.x2 + 1) << 4);
+        u16 scissor_y2 = (u16)((regs.rasterizer.scissor_test.y2 + 1) << 4);
+
+        // Calculate the new bounds
+        min_x = std::max(min_x, scissor_x1);
+        min_y = std::max(min_y, scissor_y1);
+        max_x = std::min(max_x, scissor_x2);
+        max_y = std::min(max_y, scissor_y2);
+    }
+
+    // Triangles are only clipped to the guard band, which may reach past the viewport
+    if (const auto viewport = GetGuardBandViewport()) {
+        min_x = std::max(min_x, viewport->left);
+        min_y = std::max(min_y, viewport->top);
+        max_x = std::min(max_x, viewport->right);
+        max_y = std::min(max_y, viewport->bottom);
+    }
+
+    min_x &= Fix12P4::IntMask();
+    min_y &= Fix12P4::IntMask();
+    max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
+    max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
+
+    return {min_x, min_y, max_x, max_y};
+}
+
+/// A texture tile decoded in full, so that further samples of it only need a lookup
+struct DecodedTile {
+    const u8* source = nullptr;
+    TexturingRegs::TextureFormat format{};
+    u64 generation = 0;
+    std::array<Common::Vec4<u8>, 64> texels;
+};
+
+/// Tiles decoded by this thread, direct mapped by their address
+static thread_local std::array<DecodedTile, 64> decoded_tiles;
+
+/**
+ * Decoded tiles are only valid during the draw that decoded them, as texture memory may change
+ * between draws. Zero disables the cache, for draws that may sample what they render.
+ */
+static INSTANCE_LOCAL u64 decoded_tiles_generation = 0;
+static INSTANCE_LOCAL u64 next_decoded_tiles_generation = 1;
+
+static Common::Vec4<u8> SampleTexture(const u8* texture_data, int s, int t,
+                                      const Texture::TextureInfo& info) {
+    if (decoded_tiles_generation == 0) {
+        return Texture::LookupTexture(texture_data, s, t, info);
+    }
+
+    const u8* tile_data = texture_data + (t / 8) * info.stride +
+                          (s / 8) * Texture::CalculateTileSize(info.format);
+    const u64 address = reinterpret_cast<std::uintptr_t>(tile_data);
+    DecodedTile& tile = decoded_tiles[(address * 0x9E3779B97F4A7C15ULL) >> 58];
+    if (tile.source != tile_data || tile.format != info.format ||
+        tile.generation != decoded_tiles_generation) {
+        Texture::DecodeTile(tile_data, info, tile.texels);
+        tile.source = tile_data;
+        tile.format = info.format;
+        tile.generation = decoded_tiles_generation;
+    }
+    return tile.texels[s % 8 + 8 * (t % 8)];
+}
+
+/// Lighting and procedural texture state of the current draw, converted by DrawTriangles
+static INSTANCE_LOCAL LightingCache lighting_cache;
+static INSTANCE_LOCAL ProcTexCache proctex_cache;
+
+/**
+ * Helper function for ProcessTriangle with the "reversed" flag to allow for implementing
+ * culling via recursion. Only the pixels inside tile are drawn.
+ */
+static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                                    const Common::Rectangle<u16>& tile, bool reversed = false) {
+    const auto& regs = g_state.regs;
+    MICROPROFILE_SCOPE(GPU_Rasterization);
 
     Common::Vec3<Fix12P4> vtxpos[3]{ScreenToRasterizerCoordinates(v0.screenpos),
                                     ScreenToRasterizerCoordinates(v1.screenpos),
@@ -145,13 +377,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, tile, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, tile, true);
             return;
         }
 
@@ -160,10 +392,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             return;
     }
 
-    u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
-    u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
-    u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
-    u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+    const auto bounds = GetBoundingBox(vtxpos);
+    const u16 min_x = std::max(bounds.left, tile.left);
+    const u16 min_y = std::max(bounds.top, tile.top);
+    const u16 max_x = std::min(bounds.right, tile.right);
+    const u16 max_y = std::min(bounds.bottom, tile.bottom);
 
     // Convert the scissor box coordinates to 12.4 fixed point
     u16 scissor_x1 = (u16)(regs.rasterizer.scissor_test.x1 << 4);
@@ -172,19 +405,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     u16 scissor_x2 = (u16)((regs.rasterizer.scissor_test.x2 + 1) << 4);
     u16 scissor_y2 = (u16)((regs.rasterizer.scissor_test.y2 + 1) << 4);
 
-    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
-        // Calculate the new bounds
-        min_x = std::max(min_x, scissor_x1);
-        min_y = std::max(min_y, scissor_y1);
-        max_x = std::min(max_x, scissor_x2);
-        max_y = std::min(max_y, scissor_y2);
-    }
-
-    min_x &= Fix12P4::IntMask();
-    min_y &= Fix12P4::IntMask();
-    max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
-    max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
-
     // Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
     // drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
     // values which are added to the barycentric coordinates w0, w1 and w2, respectively.
@@ -220,10 +440,53 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
         g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
     const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
 
+    SpanSetup span_setup;
+    span_setup.z = {v0.screenpos[2].ToFloat32(), v1.screenpos[2].ToFloat32(),
+                    v2.screenpos[2].ToFloat32()};
+    // Not fully accurate. About 3 bits in precision are missing.
+    // Z-Buffer (z / w * scale + offset)
+    span_setup.depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    span_setup.depth_offset =
+        float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+
+    // The edge function of the edge from a to b decreases by (b.y - a.y) per 12.4 unit along x
+    const std::array<std::pair<int, int>, 3> edges{{{1, 2}, {2, 0}, {0, 1}}};
+    const std::array<int, 3> biases{bias0, bias1, bias2};
+    std::array<u32, 3> pixel_step;
+    for (u32 edge = 0; edge < 3; ++edge) {
+        const auto [a, b] = edges[edge];
+        pixel_step[edge] = static_cast<u32>(((int)vtxpos[a].y - (int)vtxpos[b].y) * 0x10);
+        span_setup.step[edge] = static_cast<s32>(pixel_step[edge] * SPAN_WIDTH);
+    }
+
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+    for (u32 y = min_y + 8; y < max_y; y += 0x10) {
+        // Calculate the barycentric coordinates w0, w1 and w2 of the first span in this row
+        const Common::Vec2<Fix12P4> row_start{static_cast<u16>(min_x + 8), static_cast<u16>(y)};
+        for (u32 edge = 0; edge < 3; ++edge) {
+            const auto [a, b] = edges[edge];
+            const u32 w = biases[edge] + SignedArea(vtxpos[a].xy(), vtxpos[b].xy(), row_start);
+            for (u32 i = 0; i < SPAN_WIDTH; ++i) {
+                span_setup.w[edge][i] = static_cast<s32>(w + pixel_step[edge] * i);
+            }
+        }
+
+        Span span;
+        for (u32 x = min_x + 8; x < max_x; x += 0x10) {
+            const u32 lane = ((x - min_x) >> 4) % SPAN_WIDTH;
+            if (lane == 0) {
+                ComputeSpan(span_setup, span);
+                if (span.coverage == 0) {
+                    // Skip the remaining pixels of the span
+                    x += 0x10 * (SPAN_WIDTH - 1);
+                    continue;
+                }
+            }
+
+            // If current pixel is not covered by the current primitive
+            if ((span.coverage & (1u << lane)) == 0)
+                continue;
 
             // Do not process the pixel if it's inside the scissor box and the scissor mode is set
             // to Exclude
@@ -232,16 +495,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     continue;
             }
 
-            // Calculate the barycentric coordinates w0, w1 and w2
-            int w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-            int w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-            int w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
+            int w0 = span.w[0][lane];
+            int w1 = span.w[1][lane];
+            int w2 = span.w[2][lane];
             int wsum = w0 + w1 + w2;
 
-            // If current pixel is not covered by the current primitive
-            if (w0 < 0 || w1 < 0 || w2 < 0)
-                continue;
-
             auto baricentric_coordinates =
                 Common::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
                                 float24::FromFloat32(static_cast<float>(w1)),
@@ -249,18 +507,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             float24 interpolated_w_inverse =
                 float24::FromFloat32(1.0f) / Common::Dot(w_inverse, baricentric_coordinates);
 
-            // interpolated_z = z / w
-            float interpolated_z_over_w =
-                (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                 v2.screenpos[2].ToFloat32() * w2) /
-                wsum;
-
-            // Not fully accurate. About 3 bits in precision are missing.
-            // Z-Buffer (z / w * scale + offset)
-            float depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-            float depth_offset =
-                float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-            float depth = interpolated_z_over_w * depth_scale + depth_offset;
+            float depth = span.depth[lane];
 
             // Potentially switch to W-Buffer
             if (regs.rasterizer.depthmap_enable ==
@@ -413,7 +660,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                         Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
 
                     // TODO: Apply the min and mag filters to the texture
-                    texture_color[i] = Texture::LookupTexture(texture_data, s, t, info);
+                    texture_color[i] = SampleTexture(texture_data, s, t, info);
                 }
 
                 if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -437,7 +684,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             if (regs.texturing.main_config.texture3_enable) {
                 const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
                 texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
-                                           g_state.regs.texturing, g_state.proctex);
+                                           g_state.regs.texturing, proctex_cache);
             }
 
             // Texture environment - consists of 6 stages of color and alpha combining.
@@ -475,7 +722,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     GetInterpolatedAttribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
                 };
                 std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
-                    g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
+                    g_state.regs.lighting, lighting_cache, normquat, view, texture_color);
             }
 
             for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
@@ -894,8 +1141,257 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     }
 }
 
+namespace {
+
+/// Side length of the square screen tiles triangles are binned into, in pixels
+constexpr u32 TILE_SIZE_LOG2 = 5;
+/// The 12.4 fixed point rasterizer coordinates span 4096 pixels on each axis
+constexpr u32 TILES_PER_ROW = 4096 >> TILE_SIZE_LOG2;
+
+struct Triangle {
+    Vertex v0;
+    Vertex v1;
+    Vertex v2;
+};
+
+/// Returns the area covered by a tile in 12.4 fixed point
+Common::Rectangle<u16> GetTileBounds(u32 tile_index) {
+    const u32 tile_x = tile_index % TILES_PER_ROW;
+    const u32 tile_y = tile_index / TILES_PER_ROW;
+    const u32 tile_size = 16 << TILE_SIZE_LOG2;
+    // The last tile would end at 0x10000, 0xFFFF is past every pixel center visited as well
+    const auto end = [](u32 start) {
+        return static_cast<u16>(std::min(start + tile_size, 0xFFFFu));
+    };
+    return {static_cast<u16>(tile_x * tile_size), static_cast<u16>(tile_y * tile_size),
+            end(tile_x * tile_size), end(tile_y * tile_size)};
+}
+
+/**
+ * Threads that rasterize the tiles of a batch. The calling thread takes part in the work, so a
+ * batch is shaded on hardware_concurrency threads in total. Multi-instance builds have none, as
+ * the workers would not see the state of the console, and the consoles run in parallel already.
+ */
+class TileWorkers {
+public:
+    TileWorkers() {
+#ifdef CITRA_MULTI_INSTANCE
+        const std::size_t num_workers = 0;
+#else
+        const std::size_t num_workers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+#endif
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            threads.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~TileWorkers() {
+        {
+            std::lock_guard lock{mutex};
+            stop = true;
+        }
+        work_cv.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    bool HasWorkers() const {
+        return !threads.empty();
+    }
+
+    /// Calls func for every index in [0, count) and returns once all calls finished
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func) {
+        {
+            std::lock_guard lock{mutex};
+            job = &func;
+            job_count = count;
+            next_index = 0;
+            num_finished = 0;
+            ++generation;
+        }
+        work_cv.notify_all();
+        RunJobs();
+
+        // Wait for every worker to see this generation, so none of them reads a later job early
+        std::unique_lock lock{mutex};
+        done_cv.wait(lock, [this] { return num_finished == threads.size(); });
+        job = nullptr;
+    }
+
+private:
+    void WorkerLoop() {
+        u64 seen_generation = 0;
+        std::unique_lock lock{mutex};
+        while (true) {
+            work_cv.wait(lock, [&] { return stop || generation != seen_generation; });
+            if (stop) {
+                return;
+            }
+            seen_generation = generation;
+
+            lock.unlock();
+            RunJobs();
+            lock.lock();
+
+            if (++num_finished == threads.size()) {
+                done_cv.notify_one();
+            }
+        }
+    }
+
+    void RunJobs() {
+        std::size_t index;
+        while ((index = next_index.fetch_add(1)) < job_count) {
+            (*job)(index);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    bool stop = false;
+    u64 generation = 0;
+    std::size_t num_finished = 0;
+
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::size_t job_count = 0;
+    std::atomic<std::size_t> next_index{0};
+};
+
+/// Triangles submitted since the last DrawTriangles, in submission order
+INSTANCE_LOCAL std::vector<Triangle> triangles;
+/// Indices of the triangles overlapping each tile, in submission order
+INSTANCE_LOCAL std::vector<std::vector<u32>> tile_bins(TILES_PER_ROW * TILES_PER_ROW);
+/// Tiles with a non-empty bin
+INSTANCE_LOCAL std::vector<u32> active_tiles;
+
+// Worker threads should never outlive the bins, so they are declared last
+INSTANCE_LOCAL std::unique_ptr<TileWorkers> tile_workers;
+
+/// Returns the physical memory range [start, end) of the texture bound to a unit
+std::pair<PAddr, PAddr> GetTextureRange(const TexturingRegs::FullTextureConfig& texture) {
+    if (texture.config.type == TexturingRegs::TextureConfig::TextureCube ||
+        texture.config.type == TexturingRegs::TextureConfig::ShadowCube) {
+        // The faces may lie anywhere, assume the worst
+        return {0, std::numeric_limits<PAddr>::max()};
+    }
+    const PAddr start = texture.config.GetPhysicalAddress();
+    const std::size_t size = Texture::CalculateTileSize(texture.format) * texture.config.width *
+                             texture.config.height / 64;
+    return {start, static_cast<PAddr>(start + size)};
+}
+
+/**
+ * Checks whether the current draw may sample a texture it also renders to. Tiles are independent
+ * only if that is not the case, as the result would otherwise depend on the order tiles finish in.
+ */
+bool TexturesOverlapRenderTargets() {
+    const auto& regs = g_state.regs;
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+
+    const u32 num_pixels = framebuffer.GetWidth() * framebuffer.GetHeight();
+    const PAddr color_start = framebuffer.GetColorBufferPhysicalAddress();
+    const PAddr color_end =
+        color_start + num_pixels * FramebufferRegs::BytesPerColorPixel(framebuffer.color_format);
+    const PAddr depth_start = framebuffer.GetDepthBufferPhysicalAddress();
+    const PAddr depth_end =
+        depth_start + num_pixels * FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
+
+    for (const auto& texture : regs.texturing.GetTextures()) {
+        if (!texture.enabled || texture.config.address == 0) {
+            continue;
+        }
+        const auto [start, end] = GetTextureRange(texture);
+        if ((start < color_end && color_start < end) || (start < depth_end && depth_start < end)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DrawTile(u32 tile_index) {
+    const auto tile = GetTileBounds(tile_index);
+    BeginTileCache({tile.left >> 4, tile.top >> 4, tile.right >> 4, tile.bottom >> 4});
+    for (const u32 triangle_index : tile_bins[tile_index]) {
+        const auto& triangle = triangles[triangle_index];
+        ProcessTriangleInternal(triangle.v0, triangle.v1, triangle.v2, tile);
+    }
+    EndTileCache();
+}
+
+} // Anonymous namespace
+
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
-    ProcessTriangleInternal(v0, v1, v2);
+    const u32 triangle_index = static_cast<u32>(triangles.size());
+
+    // Bin the triangle by its bounding box. Culling is left to the tiles, which repeat the setup.
+    const Common::Vec3<Fix12P4> vtxpos[3]{ScreenToRasterizerCoordinates(v0.screenpos),
+                                          ScreenToRasterizerCoordinates(v1.screenpos),
+                                          ScreenToRasterizerCoordinates(v2.screenpos)};
+    const auto bounds = GetBoundingBox(vtxpos);
+    if (bounds.left >= bounds.right || bounds.top >= bounds.bottom) {
+        return;
+    }
+
+    constexpr u32 shift = TILE_SIZE_LOG2 + 4;
+    for (u32 tile_y = bounds.top >> shift; tile_y <= (bounds.bottom - 1u) >> shift; ++tile_y) {
+        for (u32 tile_x = bounds.left >> shift; tile_x <= (bounds.right - 1u) >> shift; ++tile_x) {
+            const u32 tile_index = tile_y * TILES_PER_ROW + tile_x;
+            auto& bin = tile_bins[tile_index];
+            if (bin.empty()) {
+                active_tiles.push_back(tile_index);
+            }
+            bin.push_back(triangle_index);
+        }
+    }
+    triangles.push_back({v0, v1, v2});
+}
+
+void DrawTriangles() {
+    if (active_tiles.empty()) {
+        triangles.clear();
+        return;
+    }
+
+    if (!tile_workers) {
+        tile_workers = std::make_unique<TileWorkers>();
+    }
+
+    const auto& regs = g_state.regs;
+    if (!regs.lighting.disable) {
+        UpdateLightingCache(lighting_cache, regs.lighting, g_state.lighting);
+    }
+    if (regs.texturing.main_config.texture3_enable) {
+        UpdateProcTexCache(proctex_cache, regs.texturing, g_state.proctex);
+    }
+
+    const bool feedback = TexturesOverlapRenderTargets();
+    decoded_tiles_generation = feedback ? 0 : next_decoded_tiles_generation++;
+
+    if (feedback) {
+        // Keep the submission order across the whole framebuffer
+        for (std::size_t i = 0; i < triangles.size(); ++i) {
+            const auto& triangle = triangles[i];
+            ProcessTriangleInternal(triangle.v0, triangle.v1, triangle.v2,
+                                    {0, 0, 0xFFFF, 0xFFFF});
+        }
+    } else if (active_tiles.size() == 1 || !tile_workers->HasWorkers()) {
+        // Tiles are still drawn one by one, so that their render targets stay in the tile cache
+        for (const u32 tile_index : active_tiles) {
+            DrawTile(tile_index);
+        }
+    } else {
+        tile_workers->ParallelFor(active_tiles.size(),
+                                  [](std::size_t i) { DrawTile(active_tiles[i]); });
+    }
+
+    for (const u32 tile_index : active_tiles) {
+        tile_bins[tile_index].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
 }
 
 } // namespace Pica::Rasterizer
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <optional>
+#include "common/math_util.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Rasterizer {
@@ -39,6 +41,23 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
+/// Screen coordinates from 0 up to this bound stay within the 12.4 fixed point edge functions
+constexpr float GUARD_BAND_SIZE = 2048.0f;
+
+/**
+ * Returns the viewport in 12.4 fixed point if it covers whole pixels inside the guard band. The
+ * rasterizer then leaves out the pixels outside the viewport, so that triangles only have to be
+ * clipped to the guard band in x and y.
+ */
+std::optional<Common::Rectangle<u16>> GetGuardBandViewport();
+
+/**
+ * Queues a triangle for rasterization. Triangles are binned into screen tiles, which are drawn on
+ * worker threads by DrawTriangles. The Pica registers must not change until then.
+ */
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/// Draws the triangles queued since the last call, preserving their order within every pixel
+void DrawTriangles();
+
 } // namespace Pica::Rasterizer
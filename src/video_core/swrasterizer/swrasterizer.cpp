@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "video_core/gpu_thread.h"
 #include "video_core/swrasterizer/clipper.h"
+#include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/swrasterizer.h"
 
 namespace VideoCore {
@@ -13,4 +15,28 @@ void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
 
+void SWRasterizer::DrawTriangles() {
+    Pica::Rasterizer::DrawTriangles();
+}
+
+void SWRasterizer::FlushAll() {
+    GPUThread::Synchronize();
+}
+
+void SWRasterizer::FlushRegion(PAddr addr, u32 size) {
+    GPUThread::Synchronize();
+}
+
+void SWRasterizer::InvalidateRegion(PAddr addr, u32 size) {
+    GPUThread::Synchronize();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    GPUThread::Synchronize();
+}
+
+void SWRasterizer::ClearAll(bool flush) {
+    GPUThread::Synchronize();
+}
+
 } // namespace VideoCore
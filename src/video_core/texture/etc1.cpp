@@ -115,6 +115,46 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    void Decode(std::array<Common::Vec3<u8>, 16>& texels) const {
+        // Base values of the two halves
+        std::array<Common::Vec3<int>, 2> base;
+        if (differential_mode) {
+            const int r = static_cast<int>(differential.r);
+            const int g = static_cast<int>(differential.g);
+            const int b = static_cast<int>(differential.b);
+            const int r2 = r + static_cast<int>(differential.dr);
+            const int g2 = g + static_cast<int>(differential.dg);
+            const int b2 = b + static_cast<int>(differential.db);
+            base[0] = {Color::Convert5To8(r), Color::Convert5To8(g), Color::Convert5To8(b)};
+            base[1] = {Color::Convert5To8(r2), Color::Convert5To8(g2), Color::Convert5To8(b2)};
+        } else {
+            base[0] = {Color::Convert4To8(static_cast<u8>(separate.r1)),
+                       Color::Convert4To8(static_cast<u8>(separate.g1)),
+                       Color::Convert4To8(static_cast<u8>(separate.b1))};
+            base[1] = {Color::Convert4To8(static_cast<u8>(separate.r2)),
+                       Color::Convert4To8(static_cast<u8>(separate.g2)),
+                       Color::Convert4To8(static_cast<u8>(separate.b2))};
+        }
+        const std::array<unsigned, 2> table_indices{static_cast<unsigned>(table_index_1.Value()),
+                                                    static_cast<unsigned>(table_index_2.Value())};
+
+        for (unsigned int x = 0; x < 4; ++x) {
+            for (unsigned int y = 0; y < 4; ++y) {
+                const unsigned texel = 4 * x + y;
+                const unsigned half = ((flip ? y : x) >= 2) ? 1 : 0;
+
+                int modifier = etc1_modifier_table[table_indices[half]][GetTableSubIndex(texel)];
+                if (GetNegationFlag(texel))
+                    modifier *= -1;
+
+                const Common::Vec3<int>& color = base[half];
+                texels[x + 4 * y] = {static_cast<u8>(std::clamp(color.r() + modifier, 0, 255)),
+                                     static_cast<u8>(std::clamp(color.g() + modifier, 0, 255)),
+                                     static_cast<u8>(std::clamp(color.b() + modifier, 0, 255))};
+            }
+        }
+    }
 };
 
 } // anonymous namespace
@@ -124,4 +164,9 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, std::array<Common::Vec3<u8>, 16>& texels) {
+    ETC1Tile tile{value};
+    tile.Decode(texels);
+}
+
 } // namespace Pica::Texture
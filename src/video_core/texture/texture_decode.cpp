@@ -13,6 +13,21 @@
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 
+#if defined(ARCHITECTURE_x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#define TEXTURE_DECODE_HAVE_SSSE3
+#elif defined(ARCHITECTURE_ARM64) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TEXTURE_DECODE_HAVE_NEON
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TEXTURE_DECODE_TARGET(isa)
+#else
+#define TEXTURE_DECODE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
 using TextureFormat = Pica::TexturingRegs::TextureFormat;
 
 namespace Pica::Texture {
@@ -20,6 +35,182 @@ namespace Pica::Texture {
 constexpr std::size_t TILE_SIZE = 8 * 8;
 constexpr std::size_t ETC1_SUBTILES = 2 * 2;
 
+namespace {
+
+using TileTexels = std::array<Common::Vec4<u8>, TILE_SIZE>;
+static_assert(sizeof(TileTexels) == TILE_SIZE * 4, "Decoded texels must be tightly packed");
+
+/// Position x + 8 * y in a tile of each texel in Morton order
+constexpr std::array<u8, TILE_SIZE> morton_to_linear = [] {
+    std::array<u8, TILE_SIZE> table{};
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            table[VideoCore::MortonInterleave(x, y)] = static_cast<u8>(x + 8 * y);
+        }
+    }
+    return table;
+}();
+
+template <typename Decode>
+void DecodeTexels(TileTexels& texels, Decode&& decode) {
+    for (u32 i = 0; i < TILE_SIZE; ++i) {
+        texels[i] = decode(i);
+    }
+}
+
+/// Decodes the texels of a tile in the order they are stored in
+void DecodeTileScalar(const u8* source, TextureFormat format, TileTexels& texels) {
+    switch (format) {
+    case TextureFormat::RGBA8:
+        DecodeTexels(texels, [source](u32 i) { return Color::DecodeRGBA8(source + i * 4); });
+        break;
+    case TextureFormat::RGB8:
+        DecodeTexels(texels, [source](u32 i) { return Color::DecodeRGB8(source + i * 3); });
+        break;
+    case TextureFormat::RGB5A1:
+        DecodeTexels(texels, [source](u32 i) { return Color::DecodeRGB5A1(source + i * 2); });
+        break;
+    case TextureFormat::RGB565:
+        DecodeTexels(texels, [source](u32 i) { return Color::DecodeRGB565(source + i * 2); });
+        break;
+    case TextureFormat::RGBA4:
+        DecodeTexels(texels, [source](u32 i) { return Color::DecodeRGBA4(source + i * 2); });
+        break;
+    case TextureFormat::IA8:
+        DecodeTexels(texels, [source](u32 i) {
+            const u8 intensity = source[i * 2 + 1];
+            return Common::Vec4<u8>{intensity, intensity, intensity, source[i * 2]};
+        });
+        break;
+    case TextureFormat::RG8:
+        DecodeTexels(texels, [source](u32 i) { return Color::DecodeRG8(source + i * 2); });
+        break;
+    case TextureFormat::I8:
+        DecodeTexels(texels, [source](u32 i) {
+            return Common::Vec4<u8>{source[i], source[i], source[i], 255};
+        });
+        break;
+    case TextureFormat::A8:
+        DecodeTexels(texels, [source](u32 i) { return Common::Vec4<u8>{0, 0, 0, source[i]}; });
+        break;
+    case TextureFormat::IA4:
+        DecodeTexels(texels, [source](u32 i) {
+            const u8 intensity = Color::Convert4To8(source[i] >> 4);
+            return Common::Vec4<u8>{intensity, intensity, intensity,
+                                    Color::Convert4To8(source[i] & 0xF)};
+        });
+        break;
+    case TextureFormat::I4:
+        DecodeTexels(texels, [source](u32 i) {
+            const u8 intensity = Color::Convert4To8((source[i / 2] >> (4 * (i % 2))) & 0xF);
+            return Common::Vec4<u8>{intensity, intensity, intensity, 255};
+        });
+        break;
+    case TextureFormat::A4:
+        DecodeTexels(texels, [source](u32 i) {
+            const u8 alpha = Color::Convert4To8((source[i / 2] >> (4 * (i % 2))) & 0xF);
+            return Common::Vec4<u8>{0, 0, 0, alpha};
+        });
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown texture format: {:x}", (u32)format);
+        DEBUG_ASSERT(false);
+        texels.fill({});
+        break;
+    }
+}
+
+#ifdef TEXTURE_DECODE_HAVE_SSSE3
+
+TEXTURE_DECODE_TARGET("ssse3")
+bool DecodeTileSSSE3(const u8* source, TextureFormat format, TileTexels& texels) {
+    u8* out = reinterpret_cast<u8*>(texels.data());
+    const __m128i opaque = _mm_set1_epi32(0xFF000000);
+
+    switch (format) {
+    case TextureFormat::RGBA8: {
+        const __m128i swap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+        for (u32 i = 0; i < TILE_SIZE * 4; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(v, swap));
+        }
+        return true;
+    }
+    case TextureFormat::RGB8: {
+        // Every 16 byte load covers four texels and a bit. The last group would read past the
+        // tile, so it is decoded on its own.
+        const __m128i expand =
+            _mm_set_epi8(-1, 9, 10, 11, -1, 6, 7, 8, -1, 3, 4, 5, -1, 0, 1, 2);
+        for (u32 i = 0; i < TILE_SIZE - 4; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4),
+                             _mm_or_si128(_mm_shuffle_epi8(v, expand), opaque));
+        }
+        for (u32 i = TILE_SIZE - 4; i < TILE_SIZE; ++i) {
+            texels[i] = Color::DecodeRGB8(source + i * 3);
+        }
+        return true;
+    }
+    case TextureFormat::I8: {
+        for (u32 i = 0; i < TILE_SIZE; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            for (int quarter = 0; quarter < 4; ++quarter) {
+                const char b = static_cast<char>(quarter * 4);
+                const __m128i broadcast =
+                    _mm_set_epi8(-1, b + 3, b + 3, b + 3, -1, b + 2, b + 2, b + 2, -1, b + 1, b + 1,
+                                 b + 1, -1, b, b, b);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i + quarter * 4) * 4),
+                                 _mm_or_si128(_mm_shuffle_epi8(v, broadcast), opaque));
+            }
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+#endif
+
+#ifdef TEXTURE_DECODE_HAVE_NEON
+
+bool DecodeTileNEON(const u8* source, TextureFormat format, TileTexels& texels) {
+    u8* out = reinterpret_cast<u8*>(texels.data());
+    const uint8x16_t opaque = vdupq_n_u8(255);
+
+    switch (format) {
+    case TextureFormat::RGBA8:
+        for (u32 i = 0; i < TILE_SIZE * 4; i += 16) {
+            vst1q_u8(out + i, vrev32q_u8(vld1q_u8(source + i)));
+        }
+        return true;
+    case TextureFormat::RGB8:
+        for (u32 i = 0; i < TILE_SIZE; i += 16) {
+            const uint8x16x3_t bgr = vld3q_u8(source + i * 3);
+            vst4q_u8(out + i * 4, uint8x16x4_t{{bgr.val[2], bgr.val[1], bgr.val[0], opaque}});
+        }
+        return true;
+    case TextureFormat::IA8:
+        for (u32 i = 0; i < TILE_SIZE; i += 16) {
+            const uint8x16x2_t ai = vld2q_u8(source + i * 2);
+            vst4q_u8(out + i * 4, uint8x16x4_t{{ai.val[1], ai.val[1], ai.val[1], ai.val[0]}});
+        }
+        return true;
+    case TextureFormat::I8:
+        for (u32 i = 0; i < TILE_SIZE; i += 16) {
+            const uint8x16_t intensity = vld1q_u8(source + i);
+            vst4q_u8(out + i * 4, uint8x16x4_t{{intensity, intensity, intensity, opaque}});
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+#endif
+
+} // Anonymous namespace
+
 size_t CalculateTileSize(TextureFormat format) {
     switch (format) {
     case TextureFormat::RGBA8:
@@ -211,6 +402,59 @@ Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned in
     }
 }
 
+void DecodeTile(const u8* source, const TextureInfo& info,
+                std::array<Common::Vec4<u8>, 64>& texels) {
+    if (info.format == TextureFormat::ETC1 || info.format == TextureFormat::ETC1A4) {
+        DecodeETC1Tile(source, info.format == TextureFormat::ETC1A4, texels);
+        return;
+    }
+
+    TileTexels morton_texels;
+#if defined(TEXTURE_DECODE_HAVE_SSSE3)
+    static const bool has_ssse3 = Common::GetCPUCaps().ssse3;
+    const bool decoded = has_ssse3 && DecodeTileSSSE3(source, info.format, morton_texels);
+#elif defined(TEXTURE_DECODE_HAVE_NEON)
+    const bool decoded = DecodeTileNEON(source, info.format, morton_texels);
+#else
+    const bool decoded = false;
+#endif
+    if (!decoded) {
+        DecodeTileScalar(source, info.format, morton_texels);
+    }
+
+    for (u32 i = 0; i < TILE_SIZE; ++i) {
+        texels[morton_to_linear[i]] = morton_texels[i];
+    }
+}
+
+void DecodeETC1Tile(const u8* source, bool has_alpha, std::array<Common::Vec4<u8>, 64>& texels) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+    std::array<Common::Vec3<u8>, 16> rgb;
+
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+
+        u64_le packed_alpha = 0xFFFFFFFFFFFFFFFF;
+        if (has_alpha) {
+            memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Subtile(subtile_data, rgb);
+
+        const unsigned int base_x = (subtile_index % 2) * 4;
+        const unsigned int base_y = (subtile_index / 2) * 4;
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                const u8 alpha = Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                texels[base_x + x + 8 * (base_y + y)] = Common::MakeVec(rgb[x + 4 * y], alpha);
+            }
+        }
+    }
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
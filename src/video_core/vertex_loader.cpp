@@ -1,12 +1,17 @@
+#include <algorithm>
 #include <memory>
+#include <unordered_map>
 #include <boost/range/algorithm/fill.hpp>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
+#include "common/common_funcs.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
@@ -15,8 +20,28 @@
 #include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/vertex_loader_jit_x64.h"
+#endif
+
 namespace Pica {
 
+#ifdef ARCHITECTURE_x86_64
+/// Compiled loaders, keyed by the hash of their attribute layout
+static INSTANCE_LOCAL std::unordered_map<u64, std::unique_ptr<VertexLoaderJit>> jit_cache;
+#endif
+
+static u32 GetElementSize(PipelineRegs::VertexAttributeFormat format) {
+    switch (format) {
+    case PipelineRegs::VertexAttributeFormat::FLOAT:
+        return 4;
+    case PipelineRegs::VertexAttributeFormat::SHORT:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
 void VertexLoader::Setup(const PipelineRegs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
@@ -69,89 +94,125 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
     }
 
     is_setup = true;
+
+#ifdef ARCHITECTURE_x86_64
+    if (!Settings::values.use_shader_jit) {
+        return;
+    }
+
+    VertexLoaderLayout layout{};
+    layout.num_attributes = num_total_attributes;
+    for (int i = 0; i < num_total_attributes; ++i) {
+        layout.elements[i] = vertex_attribute_elements[i];
+        layout.is_default[i] = vertex_attribute_is_default[i];
+        if (layout.elements[i] != 0) {
+            layout.strides[i] = vertex_attribute_strides[i];
+            layout.formats[i] = vertex_attribute_formats[i];
+        }
+    }
+
+    const u64 layout_hash = Common::ComputeStructHash64(layout);
+    auto iter = jit_cache.find(layout_hash);
+    if (iter == jit_cache.end()) {
+        iter = jit_cache.emplace_hint(iter, layout_hash, std::make_unique<VertexLoaderJit>(layout));
+    }
+    jit = iter->second.get();
+#endif
+}
+
+template <typename T>
+static void LoadAttribute(u32 base_address, u32 source, u32 stride, u32 elements,
+                          const u32* vertices, std::size_t count, unsigned attribute,
+                          Shader::AttributeBuffer* inputs) {
+    for (std::size_t v = 0; v < count; ++v) {
+        const T* srcdata = reinterpret_cast<const T*>(
+            VideoCore::g_memory->GetPhysicalPointer(base_address + source + stride * vertices[v]));
+        auto& attr = inputs[v].attr[attribute];
+        for (unsigned int comp = 0; comp < elements; ++comp) {
+            attr[comp] = float24::FromFloat32(srcdata[comp]);
+        }
+
+        // Default attribute values set if array elements have < 4 components. This
+        // is *not* carried over from the default attribute settings even if they're
+        // enabled for this attribute.
+        for (unsigned int comp = elements; comp < 4; ++comp) {
+            attr[comp] = comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+        }
+    }
 }
 
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
                               Shader::AttributeBuffer& input,
                               DebugUtils::MemoryAccessTracker& memory_accesses) {
+    const u32 batch_index = static_cast<u32>(index);
+    const u32 batch_vertex = static_cast<u32>(vertex);
+    LoadVertices(base_address, &batch_index, &batch_vertex, 1, &input, memory_accesses);
+}
+
+void VertexLoader::LoadVertices(u32 base_address, const u32* indices, const u32* vertices,
+                                std::size_t count, Shader::AttributeBuffer* inputs,
+                                DebugUtils::MemoryAccessTracker& memory_accesses) {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
+    if (jit && !(g_debug_context && g_debug_context->recorder) &&
+        LoadVerticesJit(base_address, vertices, count, inputs)) {
+        return;
+    }
+
     for (int i = 0; i < num_total_attributes; ++i) {
         if (vertex_attribute_elements[i] != 0) {
             // Load per-vertex data from the loader arrays
-            u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
+            const u32 source = vertex_attribute_sources[i];
+            const u32 stride = vertex_attribute_strides[i];
+            const u32 elements = vertex_attribute_elements[i];
 
             if (g_debug_context && Pica::g_debug_context->recorder) {
-                memory_accesses.AddAccess(
-                    source_addr,
-                    vertex_attribute_elements[i] *
-                        ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
-                             ? 4
-                             : (vertex_attribute_formats[i] ==
-                                PipelineRegs::VertexAttributeFormat::SHORT)
-                                   ? 2
-                                   : 1));
+                const u32 element_size = GetElementSize(vertex_attribute_formats[i]);
+                for (std::size_t v = 0; v < count; ++v) {
+                    memory_accesses.AddAccess(base_address + source + stride * vertices[v],
+                                              elements * element_size);
+                }
             }
 
             switch (vertex_attribute_formats[i]) {
-            case PipelineRegs::VertexAttributeFormat::BYTE: {
-                const s8* srcdata = reinterpret_cast<const s8*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::BYTE:
+                LoadAttribute<s8>(base_address, source, stride, elements, vertices, count, i,
+                                  inputs);
                 break;
-            }
-            case PipelineRegs::VertexAttributeFormat::UBYTE: {
-                const u8* srcdata = reinterpret_cast<const u8*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::UBYTE:
+                LoadAttribute<u8>(base_address, source, stride, elements, vertices, count, i,
+                                  inputs);
                 break;
-            }
-            case PipelineRegs::VertexAttributeFormat::SHORT: {
-                const s16* srcdata = reinterpret_cast<const s16*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::SHORT:
+                LoadAttribute<s16>(base_address, source, stride, elements, vertices, count, i,
+                                   inputs);
                 break;
-            }
-            case PipelineRegs::VertexAttributeFormat::FLOAT: {
-                const float* srcdata = reinterpret_cast<const float*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
+            case PipelineRegs::VertexAttributeFormat::FLOAT:
+                LoadAttribute<float>(base_address, source, stride, elements, vertices, count, i,
+                                     inputs);
                 break;
             }
-            }
 
-            // Default attribute values set if array elements have < 4 components. This
-            // is *not* carried over from the default attribute settings even if they're
-            // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
-                input.attr[i][comp] =
-                    comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+            for (std::size_t v = 0; v < count; ++v) {
+                const auto& attr = inputs[v].attr[i];
+                LOG_TRACE(HW_GPU,
+                          "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) "
+                          "from 0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
+                          elements, i, vertices[v], indices[v], base_address, source,
+                          stride * vertices[v], attr[0].ToFloat32(), attr[1].ToFloat32(),
+                          attr[2].ToFloat32(), attr[3].ToFloat32());
             }
-
-            LOG_TRACE(HW_GPU,
-                      "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
-                      "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
-                      input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                      input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
         } else if (vertex_attribute_is_default[i]) {
             // Load the default attribute if we're configured to do so
-            input.attr[i] = g_state.input_default_attributes.attr[i];
-            LOG_TRACE(
-                HW_GPU,
-                "Loaded default attribute {:x} for vertex {:x} (index {:x}): ({}, {}, {}, {})", i,
-                vertex, index, input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
+            for (std::size_t v = 0; v < count; ++v) {
+                auto& attr = inputs[v].attr[i];
+                attr = g_state.input_default_attributes.attr[i];
+                LOG_TRACE(HW_GPU,
+                          "Loaded default attribute {:x} for vertex {:x} (index {:x}): ({}, {}, "
+                          "{}, {})",
+                          i, vertices[v], indices[v], attr[0].ToFloat32(), attr[1].ToFloat32(),
+                          attr[2].ToFloat32(), attr[3].ToFloat32());
+            }
         } else {
             // TODO(yuriks): In this case, no data gets loaded and the vertex
             // remains with the last value it had. This isn't currently maintained
@@ -160,4 +221,44 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
     }
 }
 
+bool VertexLoader::LoadVerticesJit(u32 base_address, const u32* vertices, std::size_t count,
+                                   Shader::AttributeBuffer* inputs) const {
+#ifdef ARCHITECTURE_x86_64
+    if (count == 0) {
+        return true;
+    }
+
+    // The compiled loader indexes host memory directly, so every vertex must be inside one block
+    const u64 max_vertex = *std::max_element(vertices, vertices + count);
+    std::array<const u8*, 16> sources{};
+    for (int i = 0; i < num_total_attributes; ++i) {
+        if (vertex_attribute_elements[i] != 0) {
+            const u64 first = u64{base_address} + vertex_attribute_sources[i];
+            const u64 last = first + vertex_attribute_strides[i] * max_vertex +
+                             vertex_attribute_elements[i] *
+                                 GetElementSize(vertex_attribute_formats[i]) -
+                             1;
+            if (last > 0xFFFFFFFF) {
+                return false;
+            }
+            const u8* first_pointer =
+                VideoCore::g_memory->GetPhysicalPointer(static_cast<PAddr>(first));
+            const u8* last_pointer =
+                VideoCore::g_memory->GetPhysicalPointer(static_cast<PAddr>(last));
+            if (first_pointer == nullptr || last_pointer != first_pointer + (last - first)) {
+                return false;
+            }
+            sources[i] = first_pointer;
+        } else if (vertex_attribute_is_default[i]) {
+            sources[i] = reinterpret_cast<const u8*>(&g_state.input_default_attributes.attr[i]);
+        }
+    }
+
+    jit->Load(sources.data(), vertices, count, inputs);
+    return true;
+#else
+    return false;
+#endif
+}
+
 } // namespace Pica
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include "common/common_types.h"
 #include "video_core/regs_pipeline.h"
 
@@ -14,6 +15,8 @@ namespace Shader {
 struct AttributeBuffer;
 }
 
+class VertexLoaderJit;
+
 class VertexLoader {
 public:
     VertexLoader() = default;
@@ -25,11 +28,27 @@ public:
     void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input,
                     DebugUtils::MemoryAccessTracker& memory_accesses);
 
+    /**
+     * Loads a batch of vertices. The batch is traversed one attribute at a time, so the attribute
+     * format is dispatched once per batch instead of once per vertex.
+     * @param indices Index of each vertex in the draw, only used for logging
+     * @param vertices Id of each vertex to load
+     * @param count Number of vertices in the batch
+     * @param inputs Buffers to load the vertices into, one per vertex
+     */
+    void LoadVertices(u32 base_address, const u32* indices, const u32* vertices, std::size_t count,
+                      Shader::AttributeBuffer* inputs,
+                      DebugUtils::MemoryAccessTracker& memory_accesses);
+
     int GetNumTotalAttributes() const {
         return num_total_attributes;
     }
 
 private:
+    /// Loads a batch with the compiled loader. Returns false if a vertex is outside host memory.
+    bool LoadVerticesJit(u32 base_address, const u32* vertices, std::size_t count,
+                         Shader::AttributeBuffer* inputs) const;
+
     std::array<u32, 16> vertex_attribute_sources;
     std::array<u32, 16> vertex_attribute_strides{};
     std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
@@ -37,6 +56,9 @@ private:
     std::array<bool, 16> vertex_attribute_is_default;
     int num_total_attributes = 0;
     bool is_setup = false;
+
+    /// Loader compiled for the attribute layout, if the shader JIT is enabled
+    const VertexLoaderJit* jit = nullptr;
 };
 
 } // namespace Pica
@@ -0,0 +1,105 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include "common/vector_math.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg64;
+
+namespace Pica {
+
+/// Memory allocated for each compiled loader, enough for 16 attributes of 4 components
+constexpr std::size_t MAX_LOADER_SIZE = 8 * 1024;
+
+/// Raw value of 1.0f, which fills the w component of attributes that have fewer components
+constexpr u32 ONE_FLOAT = 0x3F800000;
+
+// Only caller-saved registers are used, so that nothing has to be saved on either ABI
+static const Reg64 SOURCES{ABI_PARAM1.getIdx()};
+static const Reg64 VERTICES{ABI_PARAM2.getIdx()};
+static const Reg64 COUNT{ABI_PARAM3.getIdx()};
+static const Reg64 INPUTS{ABI_PARAM4.getIdx()};
+constexpr Reg64 VERTEX = rax;
+constexpr Reg64 SOURCE = r10;
+constexpr Reg64 SCRATCH = r11;
+
+VertexLoaderJit::VertexLoaderJit(const VertexLoaderLayout& layout)
+    : Xbyak::CodeGenerator(MAX_LOADER_SIZE) {
+    using Format = PipelineRegs::VertexAttributeFormat;
+
+    Label loop;
+    Label end;
+
+    test(COUNT, COUNT);
+    jz(end);
+
+    L(loop);
+    mov(VERTEX.cvt32(), dword[VERTICES]);
+    for (int i = 0; i < layout.num_attributes; ++i) {
+        const std::size_t offset =
+            offsetof(Shader::AttributeBuffer, attr) + i * sizeof(Common::Vec4<float24>);
+        const u32 elements = layout.elements[i];
+
+        if (elements == 0) {
+            if (layout.is_default[i]) {
+                mov(SOURCE, qword[SOURCES + i * sizeof(u8*)]);
+                movups(xmm0, xword[SOURCE]);
+                movups(xword[INPUTS + offset], xmm0);
+            }
+            continue;
+        }
+
+        mov(SOURCE, qword[SOURCES + i * sizeof(u8*)]);
+        imul(SCRATCH, VERTEX, static_cast<int>(layout.strides[i]));
+        add(SOURCE, SCRATCH);
+
+        for (u32 comp = 0; comp < elements; ++comp) {
+            const auto dest = dword[INPUTS + offset + comp * sizeof(float24)];
+            switch (layout.formats[i]) {
+            case Format::FLOAT:
+                mov(SCRATCH.cvt32(), dword[SOURCE + comp * sizeof(float)]);
+                mov(dest, SCRATCH.cvt32());
+                continue;
+            case Format::BYTE:
+                movsx(SCRATCH.cvt32(), byte[SOURCE + comp]);
+                break;
+            case Format::UBYTE:
+                movzx(SCRATCH.cvt32(), byte[SOURCE + comp]);
+                break;
+            case Format::SHORT:
+                movsx(SCRATCH.cvt32(), word[SOURCE + comp * sizeof(s16)]);
+                break;
+            }
+            // Clears xmm0 first, as cvtsi2ss would otherwise wait for its previous value
+            xorps(xmm0, xmm0);
+            cvtsi2ss(xmm0, SCRATCH.cvt32());
+            movss(dest, xmm0);
+        }
+
+        // Components that the array doesn't hold default to (0, 0, 0, 1)
+        for (u32 comp = elements; comp < 4; ++comp) {
+            mov(dword[INPUTS + offset + comp * sizeof(float24)], comp == 3 ? ONE_FLOAT : 0);
+        }
+    }
+
+    add(INPUTS, static_cast<u32>(sizeof(Shader::AttributeBuffer)));
+    add(VERTICES, static_cast<u32>(sizeof(u32)));
+    dec(COUNT);
+    jnz(loop);
+
+    L(end);
+    ret();
+
+    ready();
+    program = getCode<CompiledLoader*>();
+}
+
+} // namespace Pica
@@ -0,0 +1,56 @@
+// Copyright 2026 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/regs_pipeline.h"
+
+namespace Pica {
+
+namespace Shader {
+struct AttributeBuffer;
+}
+
+/// Layout of the attributes that a vertex loader is compiled for
+struct VertexLoaderLayout {
+    int num_attributes;
+    std::array<u32, 16> strides;
+    std::array<PipelineRegs::VertexAttributeFormat, 16> formats;
+    std::array<u32, 16> elements; ///< 0 if the attribute is not loaded from the vertex arrays
+    std::array<bool, 16> is_default;
+};
+
+/**
+ * Loads batches of vertices with x64 code compiled for one attribute layout. Each attribute is
+ * read with a fixed sequence of loads and conversions, replacing the format dispatch and the
+ * memory lookup that VertexLoader does for each vertex.
+ */
+class VertexLoaderJit : public Xbyak::CodeGenerator {
+public:
+    explicit VertexLoaderJit(const VertexLoaderLayout& layout);
+
+    /**
+     * Loads a batch of vertices.
+     * @param sources Host pointer to the first vertex of each attribute loaded from the vertex
+     *                arrays, and to the value of each default attribute
+     * @param vertices Id of each vertex to load
+     * @param count Number of vertices in the batch
+     * @param inputs Buffers to load the vertices into, one per vertex
+     */
+    void Load(const u8* const* sources, const u32* vertices, std::size_t count,
+              Shader::AttributeBuffer* inputs) const {
+        program(sources, vertices, count, inputs);
+    }
+
+private:
+    using CompiledLoader = void(const u8* const* sources, const u32* vertices, std::size_t count,
+                                Shader::AttributeBuffer* inputs);
+    CompiledLoader* program = nullptr;
+};
+
+} // namespace Pica
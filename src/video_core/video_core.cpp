@@ -6,6 +6,8 @@
 #include "common/archives.h"
 #include "common/logging/log.h"
 #include "core/settings.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
@@ -18,7 +20,7 @@
 
 namespace VideoCore {
 
-std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+INSTANCE_LOCAL std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
 
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
@@ -36,7 +38,19 @@ void* g_screenshot_bits;
 std::function<void()> g_screenshot_complete_callback;
 Layout::FramebufferLayout g_screenshot_framebuffer_layout;
 
-Memory::MemorySystem* g_memory;
+INSTANCE_LOCAL Memory::MemorySystem* g_memory;
+
+std::unique_ptr<RendererBase> CreateRenderer(Frontend::EmuWindow& emu_window) {
+    switch (Settings::values.graphics_api) {
+    case Settings::GraphicsAPI::OpenGL:
+        break;
+    default:
+        LOG_ERROR(Render, "Graphics API {} is not available in this build, using OpenGL",
+                  static_cast<u32>(Settings::values.graphics_api));
+        break;
+    }
+    return std::make_unique<OpenGL::RendererOpenGL>(emu_window);
+}
 
 /// Initialize the video core
 ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory) {
@@ -45,8 +59,23 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory)
 
     OpenGL::GLES = Settings::values.use_gles;
 
+    // The hardware renderer can only issue GL calls from the thread owning the context, and the
+    // debugger inspects the PICA state from the frontend thread. Multi-instance builds keep the
+    // PICA state of each console on the thread running it.
+    if (Settings::values.use_gpu_thread) {
+#ifdef CITRA_MULTI_INSTANCE
+        LOG_WARNING(Render, "GPU thread is not supported by multi-instance builds");
+#else
+        if (Settings::values.use_hw_renderer || Pica::g_debug_context) {
+            LOG_WARNING(Render, "GPU thread is only supported by the software renderer");
+        } else {
+            GPUThread::Start();
+        }
+#endif
+    }
+
     if (!emu_window.ShouldDeferRendererInit()) {
-        g_renderer = std::make_unique<OpenGL::RendererOpenGL>(emu_window);
+        g_renderer = CreateRenderer(emu_window);
         ResultStatus result = g_renderer->Init();
 
         if (result != ResultStatus::Success) {
@@ -64,6 +93,7 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory)
 
 /// Shutdown the video core
 void Shutdown() {
+    GPUThread::Stop();
     Pica::Shutdown();
 
     g_renderer->ShutDown();
@@ -97,6 +127,7 @@ u16 GetResolutionScaleFactor() {
 
 template <class Archive>
 void serialize(Archive& ar, const unsigned int) {
+    GPUThread::Synchronize();
     ar& Pica::g_state;
 }
 
@@ -7,6 +7,7 @@
 #include <atomic>
 #include <iostream>
 #include <memory>
+#include "common/common_funcs.h"
 #include "core/frontend/emu_window.h"
 
 namespace Frontend {
@@ -24,7 +25,7 @@ class MemorySystem;
 
 namespace VideoCore {
 
-extern std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+extern INSTANCE_LOCAL std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
 
 // TODO: Wrap these in a user settings struct along with any other graphics settings (often set from
 // qt ui)
@@ -44,7 +45,7 @@ extern void* g_screenshot_bits;
 extern std::function<void()> g_screenshot_complete_callback;
 extern Layout::FramebufferLayout g_screenshot_framebuffer_layout;
 
-extern Memory::MemorySystem* g_memory;
+extern INSTANCE_LOCAL Memory::MemorySystem* g_memory;
 
 enum class ResultStatus {
     Success,
@@ -52,6 +53,9 @@ enum class ResultStatus {
     ErrorBelowGL33,
 };
 
+/// Creates the renderer of the graphics API selected in the settings
+std::unique_ptr<RendererBase> CreateRenderer(Frontend::EmuWindow& emu_window);
+
 /// Initialize the video core
 ResultStatus Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory);
 
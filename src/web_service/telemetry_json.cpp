@@ -3,7 +3,6 @@
 // Refer to the license.txt file included.
 
 #include <json.hpp>
-#include "common/detached_tasks.h"
 #include "common/web_result.h"
 #include "web_service/telemetry_json.h"
 #include "web_service/web_backend.h"
@@ -108,9 +107,10 @@ void TelemetryJson::Complete() {
     impl->SerializeSection(Telemetry::FieldType::UserSystem, "UserSystem");
 
     auto content = impl->TopSection().dump();
-    // Send the telemetry async but don't handle the errors since they were written to the log
-    Common::DetachedTasks::AddTask([host{impl->host}, content]() {
-        Client{host, "", ""}.PostJson("/telemetry", content, true);
+    // Send the telemetry async but don't handle the errors since they were written to the log.
+    // Sessions that end close together share the connection.
+    QueueRequest(impl->host, "", "", [content{std::move(content)}](Client& client) {
+        client.PostJson("/telemetry", content, true);
     });
 }
 
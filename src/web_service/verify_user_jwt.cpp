@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <mutex>
 #include <system_error>
 #include <jwt/jwt.hpp>
 #include "common/logging/log.h"
@@ -11,24 +13,69 @@
 
 namespace WebService {
 
-static std::string public_key;
+/// How long a fetched public key is used before it is fetched again, in case it was rotated
+constexpr std::chrono::hours PUBLIC_KEY_TTL{6};
+
+namespace {
+struct PublicKeyCache {
+    std::mutex mutex;
+    std::string host;
+    std::string key;
+    std::chrono::steady_clock::time_point fetch_time;
+    bool fetching = false;
+};
+
+PublicKeyCache public_key_cache;
+
+void StorePublicKey(const std::string& host, const std::string& key) {
+    std::lock_guard lock{public_key_cache.mutex};
+    public_key_cache.fetching = false;
+    if (key.empty()) {
+        LOG_ERROR(WebService, "Could not fetch external JWT public key, verification may fail");
+        return;
+    }
+    LOG_INFO(WebService, "Fetched external JWT public key (size={})", key.size());
+    public_key_cache.host = host;
+    public_key_cache.key = key;
+    public_key_cache.fetch_time = std::chrono::steady_clock::now();
+}
+
+/// Returns the cached public key of the host, and starts fetching a new one if it expired
 std::string GetPublicKey(const std::string& host) {
-    if (public_key.empty()) {
-        Client client(host, "", ""); // no need for credentials here
-        public_key = client.GetPlain("/jwt/external/key.pem", true).returned_data;
-        if (public_key.empty()) {
-            LOG_ERROR(WebService, "Could not fetch external JWT public key, verification may fail");
-        } else {
-            LOG_INFO(WebService, "Fetched external JWT public key (size={})", public_key.size());
-        }
+    std::lock_guard lock{public_key_cache.mutex};
+    const bool cached = public_key_cache.host == host && !public_key_cache.key.empty();
+    const bool expired = !cached || std::chrono::steady_clock::now() - public_key_cache.fetch_time >
+                                        PUBLIC_KEY_TTL;
+    if (expired && !public_key_cache.fetching) {
+        public_key_cache.fetching = true;
+        // no need for credentials here
+        QueueRequest(host, "", "", [host](Client& client) {
+            StorePublicKey(host, client.GetPlain("/jwt/external/key.pem", true).returned_data);
+        });
     }
-    return public_key;
+    return cached ? public_key_cache.key : std::string{};
 }
+} // namespace
 
-VerifyUserJWT::VerifyUserJWT(const std::string& host) : pub_key(GetPublicKey(host)) {}
+VerifyUserJWT::VerifyUserJWT(const std::string& host) : host(host) {
+    {
+        std::lock_guard lock{public_key_cache.mutex};
+        if (public_key_cache.host == host && !public_key_cache.key.empty()) {
+            return;
+        }
+    }
+    // The key is only fetched in the foreground at startup, before any member can join
+    Client client(host, "", "");
+    StorePublicKey(host, client.GetPlain("/jwt/external/key.pem", true).returned_data);
+}
 
 Network::VerifyUser::UserData VerifyUserJWT::LoadUserData(const std::string& verify_UID,
                                                           const std::string& token) {
+    const std::string pub_key = GetPublicKey(host);
+    if (pub_key.empty()) {
+        LOG_INFO(WebService, "Verification failed: no public key");
+        return {};
+    }
     const std::string audience = fmt::format("external-{}", verify_UID);
     using namespace jwt::params;
     std::error_code error;
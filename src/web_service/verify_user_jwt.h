@@ -12,14 +12,16 @@ namespace WebService {
 
 class VerifyUserJWT final : public Network::VerifyUser::Backend {
 public:
+    /// Fetches the public key of the host unless it is already cached
     VerifyUserJWT(const std::string& host);
     ~VerifyUserJWT() = default;
 
+    /// Never waits for the network: an expired public key is used while a new one is fetched
     Network::VerifyUser::UserData LoadUserData(const std::string& verify_UID,
                                                const std::string& token) override;
 
 private:
-    std::string pub_key;
+    std::string host;
 };
 
 } // namespace WebService
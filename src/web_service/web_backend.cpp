@@ -4,14 +4,18 @@
 
 #include <array>
 #include <cstdlib>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <string>
+#include <tuple>
 #include <fmt/format.h>
 #if defined(__ANDROID__)
 #include <ifaddrs.h>
 #endif
 #include <httplib.h>
 #include "common/common_types.h"
+#include "common/detached_tasks.h"
 #include "common/logging/log.h"
 #include "common/web_result.h"
 #include "web_service/web_backend.h"
@@ -74,13 +78,12 @@ struct Client::Impl {
             cli->set_connection_timeout(TIMEOUT_SECONDS);
             cli->set_read_timeout(TIMEOUT_SECONDS);
             cli->set_write_timeout(TIMEOUT_SECONDS);
+            cli->set_keep_alive(true);
         }
         if (!cli->is_valid()) {
             LOG_ERROR(WebService, "Invalid URL {}", host + path);
             return Common::WebResult{Common::WebResult::Code::InvalidURL, "Invalid URL"};
         }
-        LOG_ERROR(WebService, "{}", host);
-
         httplib::Headers params;
         if (!jwt.empty()) {
             params = {
@@ -200,4 +203,57 @@ Common::WebResult Client::GetExternalJWT(const std::string& audience) {
                                 "text/html");
 }
 
+namespace {
+struct RequestQueue {
+    struct Request {
+        std::string host;
+        std::string username;
+        std::string token;
+        std::function<void(Client&)> run;
+    };
+
+    std::mutex mutex;
+    std::deque<Request> requests;
+    bool draining = false;
+
+    /// Only used by the task draining the queue
+    std::map<std::tuple<std::string, std::string, std::string>, std::unique_ptr<Client>> clients;
+};
+
+RequestQueue request_queue;
+
+void DrainRequests() {
+    while (true) {
+        RequestQueue::Request request;
+        {
+            std::lock_guard lock{request_queue.mutex};
+            if (request_queue.requests.empty()) {
+                request_queue.draining = false;
+                return;
+            }
+            request = std::move(request_queue.requests.front());
+            request_queue.requests.pop_front();
+        }
+
+        auto& client =
+            request_queue.clients[std::make_tuple(request.host, request.username, request.token)];
+        if (!client) {
+            client = std::make_unique<Client>(request.host, request.username, request.token);
+        }
+        request.run(*client);
+    }
+}
+} // namespace
+
+void QueueRequest(std::string host, std::string username, std::string token,
+                  std::function<void(Client&)> request) {
+    std::lock_guard lock{request_queue.mutex};
+    request_queue.requests.push_back(
+        {std::move(host), std::move(username), std::move(token), std::move(request)});
+    if (!request_queue.draining) {
+        request_queue.draining = true;
+        Common::DetachedTasks::AddTask(DrainRequests);
+    }
+}
+
 } // namespace WebService
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -74,4 +75,14 @@ private:
     std::unique_ptr<Impl> impl;
 };
 
+/**
+ * Runs request in the background with the Client of the given host and credentials, so that the
+ * caller never waits for the network. Requests run one after another in the order they were
+ * queued, on a Common::DetachedTasks task that the frontends wait for at exit. The Clients are kept
+ * between requests, so requests to the same host reuse a kept-alive connection instead of going
+ * through the TCP and TLS handshakes again.
+ */
+void QueueRequest(std::string host, std::string username, std::string token,
+                  std::function<void(Client&)> request);
+
 } // namespace WebService